@@ -137,7 +137,7 @@ install_ffmpeg()
         --disable-ffplay --disable-ffserver --disable-filters --disable-vaapi --disable-avdevice --disable-doc --disable-symver \
         --disable-debug --disable-indevs --disable-outdevs --disable-devices --disable-hwaccels --disable-encoders \
         --enable-zlib --enable-libopus --enable-libvpx --enable-libfdk_aac \
-        --enable-encoder=libvpx_vp8,libvpx_vp9,libopus,libfdk_aac \
+        --enable-encoder=libvpx_vp8,libvpx_vp9,libopus,libfdk_aac,mjpeg \
         --disable-decoder=tiff \
         --enable-filter=asetnsamples,aresample,aformat,channelmap,channelsplit,scale,transpose,fps,settb,asettb
 
@@ -9,8 +9,58 @@
 #include "application.h"
 #include "application_private.h"
 
+#include <sys/stat.h>
+
+#include <map>
+#include <mutex>
+
 namespace info
 {
+	// The applications of a host use the same certificate files, so the files are loaded once
+	// (they are loaded again when they are modified, e.g. the certificate is renewed and the configs are reloaded)
+	//
+	// key_path: empty for the chain certificate
+	static std::shared_ptr<ov::Error> LoadCertificate(const ov::String &cert_path, const ov::String &key_path, std::shared_ptr<Certificate> *certificate)
+	{
+		static std::mutex cache_mutex;
+		static std::map<ov::String, std::shared_ptr<Certificate>> cache;
+
+		ov::String cache_key = ov::String::FormatString("%s\n%s", cert_path.CStr(), key_path.CStr());
+
+		for(const auto &path : { cert_path, key_path })
+		{
+			struct stat file_stat {};
+
+			if((path.IsEmpty() == false) && (::stat(path.CStr(), &file_stat) == 0))
+			{
+				cache_key.AppendFormat("\n%ld.%ld", static_cast<long>(file_stat.st_mtim.tv_sec), static_cast<long>(file_stat.st_mtim.tv_nsec));
+			}
+		}
+
+		std::lock_guard<std::mutex> lock_guard(cache_mutex);
+
+		auto item = cache.find(cache_key);
+
+		if(item != cache.end())
+		{
+			*certificate = item->second;
+			return nullptr;
+		}
+
+		auto new_certificate = std::make_shared<Certificate>();
+		auto error = key_path.IsEmpty() ? new_certificate->GenerateFromPem(cert_path, true) : new_certificate->GenerateFromPem(cert_path, key_path);
+
+		if(error != nullptr)
+		{
+			return error;
+		}
+
+		cache[cache_key] = new_certificate;
+		*certificate = new_certificate;
+
+		return nullptr;
+	}
+
 	Application::Application(const cfg::Application &application)
 		: cfg::Application(application)
 	{
@@ -59,8 +109,6 @@ namespace info
 			);
 		}
 
-		_certificate = std::make_shared<Certificate>();
-
 		logti("Trying to create a certificate using\n"
 		      "\tCert file path: %s\n"
 		      "\tPrivate key file path: %s",
@@ -68,7 +116,7 @@ namespace info
 		      key_path.CStr()
 		);
 
-		auto error = _certificate->GenerateFromPem(cert_path, key_path);
+		auto error = LoadCertificate(cert_path, key_path, &_certificate);
 
 		if(error != nullptr)
 		{
@@ -84,14 +132,12 @@ namespace info
 			return nullptr;
 		}
 
-		_chain_certificate = std::make_shared<Certificate>();
-
 		logti("Trying to create a chain certificate using\n"
 		      "\tChain cert file path: %s",
 		      chain_cert_path.CStr()
 		);
 
-		error = _chain_certificate->GenerateFromPem(chain_cert_path, true);
+		error = LoadCertificate(chain_cert_path, "", &_chain_certificate);
 
 		if(error != nullptr)
 		{
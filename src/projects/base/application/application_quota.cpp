@@ -0,0 +1,271 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "application_quota.h"
+
+#include <algorithm>
+#include <chrono>
+
+#define OV_LOG_TAG "ApplicationQuota"
+
+ApplicationQuotaStatistics::ApplicationQuotaStatistics(info::application_id_t application_id, const ov::String &application_name, const cfg::Quota &quota)
+	: _application_id(application_id),
+	  _application_name(application_name)
+{
+	_weight = static_cast<uint32_t>(std::max(quota.GetWeight(), 1));
+	_max_transcode_share = static_cast<uint32_t>(std::min(std::max(quota.GetMaxTranscodeShare(), 0), 100));
+	_max_egress_bitrate = static_cast<uint64_t>(std::max(quota.GetMaxEgressBitrate(), 0)) * 1000000ULL;
+	_max_session_count = std::max(quota.GetMaxSessions(), 0);
+	_max_ingest_bitrate = static_cast<uint64_t>(std::max(quota.GetMaxIngestBitrate(), 0)) * 1000000ULL;
+}
+
+uint64_t ApplicationQuotaStatistics::SampleBitrate(RateSample &sample, uint64_t bytes)
+{
+	int64_t current_time = ApplicationQuota::GetCurrentMilliseconds();
+
+	if(sample.sampled == false)
+	{
+		sample.sampled = true;
+		sample.time = current_time;
+		sample.bytes = bytes;
+
+		return 0;
+	}
+
+	int64_t elapsed = current_time - sample.time;
+
+	if(elapsed >= APPLICATION_QUOTA_RATE_INTERVAL_MS)
+	{
+		sample.bitrate = (bytes - sample.bytes) * 8 * 1000 / static_cast<uint64_t>(elapsed);
+		sample.time = current_time;
+		sample.bytes = bytes;
+	}
+
+	return sample.bitrate;
+}
+
+uint64_t ApplicationQuotaStatistics::GetEgressBitrate()
+{
+	std::lock_guard<std::mutex> lock(_rate_mutex);
+
+	return SampleBitrate(_egress_sample, GetEgressBytes());
+}
+
+uint64_t ApplicationQuotaStatistics::GetIngestBitrate()
+{
+	std::lock_guard<std::mutex> lock(_rate_mutex);
+
+	return SampleBitrate(_ingest_sample, GetIngestBytes());
+}
+
+uint64_t ApplicationQuotaStatistics::GetEgressBitrateShare() const
+{
+	if(_max_egress_bitrate == 0)
+	{
+		return 0;
+	}
+
+	return _max_egress_bitrate / static_cast<uint64_t>(std::max(GetSessionCount(), static_cast<int64_t>(1)));
+}
+
+void ApplicationQuotaStatistics::AddBusyTime(ApplicationQuotaScheduler scheduler, int64_t current_time, uint64_t busy_time)
+{
+	auto &usage = _schedulers[static_cast<int>(scheduler)];
+	int64_t window_index = current_time / APPLICATION_QUOTA_WINDOW_MS;
+	int64_t old_window_index = usage.window_index.load(std::memory_order_relaxed);
+
+	// The first thread of the new window resets it (the time of the other threads at the same moment may be lost,
+	// it is a share, not an account)
+	if((old_window_index != window_index) && usage.window_index.compare_exchange_strong(old_window_index, window_index, std::memory_order_relaxed))
+	{
+		usage.window_time.store(0, std::memory_order_relaxed);
+	}
+
+	usage.window_time.fetch_add(busy_time, std::memory_order_relaxed);
+	usage.total_time.fetch_add(busy_time, std::memory_order_relaxed);
+}
+
+uint64_t ApplicationQuotaStatistics::GetWindowBusyTime(ApplicationQuotaScheduler scheduler, int64_t current_time) const
+{
+	auto &usage = _schedulers[static_cast<int>(scheduler)];
+
+	if(usage.window_index.load(std::memory_order_relaxed) != (current_time / APPLICATION_QUOTA_WINDOW_MS))
+	{
+		return 0;
+	}
+
+	return usage.window_time.load(std::memory_order_relaxed);
+}
+
+bool ApplicationQuotaStatistics::IsActive(ApplicationQuotaScheduler scheduler, int64_t current_time) const
+{
+	auto &usage = _schedulers[static_cast<int>(scheduler)];
+
+	return usage.window_index.load(std::memory_order_relaxed) >= ((current_time / APPLICATION_QUOTA_WINDOW_MS) - 1);
+}
+
+uint64_t ApplicationQuotaStatistics::GetWindowBusyLimit(ApplicationQuotaScheduler scheduler, uint32_t thread_count) const
+{
+	if((scheduler != ApplicationQuotaScheduler::Transcoder) || (_max_transcode_share == 0))
+	{
+		return 0;
+	}
+
+	return static_cast<uint64_t>(thread_count) * APPLICATION_QUOTA_WINDOW_MS * 1000 * _max_transcode_share / 100;
+}
+
+ov::String ApplicationQuotaStatistics::GetSessionRejectReason()
+{
+	ov::String reason;
+
+	if((_max_session_count > 0) && (GetSessionCount() >= _max_session_count))
+	{
+		reason.Format("session quota: %" PRId64 " sessions", GetSessionCount());
+	}
+	else if(_max_egress_bitrate > 0)
+	{
+		uint64_t bitrate = GetEgressBitrate();
+
+		if(bitrate >= _max_egress_bitrate)
+		{
+			reason.Format("egress quota: %" PRIu64 " bps", bitrate);
+		}
+	}
+
+	if(reason.IsEmpty() == false)
+	{
+		_rejected_session_count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return reason;
+}
+
+ov::String ApplicationQuotaStatistics::GetStreamRejectReason()
+{
+	ov::String reason;
+
+	if(_max_ingest_bitrate > 0)
+	{
+		uint64_t bitrate = GetIngestBitrate();
+
+		if(bitrate >= _max_ingest_bitrate)
+		{
+			reason.Format("ingest quota: %" PRIu64 " bps", bitrate);
+			_rejected_stream_count.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	return reason;
+}
+
+std::shared_ptr<ApplicationQuotaStatistics> ApplicationQuota::GetStatistics(const info::Application &application_info)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto &statistics = _statistics_map[application_info.GetId()];
+
+	if(statistics == nullptr)
+	{
+		statistics = std::make_shared<ApplicationQuotaStatistics>(application_info.GetId(), application_info.GetName(), application_info.GetQuota());
+
+		if(application_info.GetQuota().IsParsed())
+		{
+			auto &quota = application_info.GetQuota();
+
+			logti("Quota of the application %s: weight %u, transcode share %d%%, egress %d Mbps, sessions %d, ingest %d Mbps (0: unlimited)",
+				  application_info.GetName().CStr(), statistics->GetWeight(), quota.GetMaxTranscodeShare(),
+				  quota.GetMaxEgressBitrate(), quota.GetMaxSessions(), quota.GetMaxIngestBitrate());
+		}
+	}
+
+	return statistics;
+}
+
+std::shared_ptr<ApplicationQuotaStatistics> ApplicationQuota::FindStatistics(const ov::String &application_name) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	// The newest application of the name
+	for(auto item = _statistics_map.rbegin(); item != _statistics_map.rend(); ++item)
+	{
+		if(item->second->GetApplicationName() == application_name)
+		{
+			return item->second;
+		}
+	}
+
+	return nullptr;
+}
+
+void ApplicationQuota::GetAllStatistics(std::vector<std::shared_ptr<ApplicationQuotaStatistics>> &statistics_list) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for(auto &item : _statistics_map)
+	{
+		statistics_list.push_back(item.second);
+	}
+}
+
+uint64_t ApplicationQuota::GetActiveWeight(ApplicationQuotaScheduler scheduler, int64_t current_time)
+{
+	auto &active_weight = _active_weights[static_cast<int>(scheduler)];
+	int64_t window_index = current_time / APPLICATION_QUOTA_WINDOW_MS;
+	int64_t old_window_index = active_weight.window_index.load(std::memory_order_relaxed);
+
+	if((old_window_index != window_index) && active_weight.window_index.compare_exchange_strong(old_window_index, window_index, std::memory_order_relaxed))
+	{
+		uint64_t weight = 0;
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			for(auto &item : _statistics_map)
+			{
+				if(item.second->IsActive(scheduler, current_time))
+				{
+					weight += item.second->GetWeight();
+				}
+			}
+		}
+
+		active_weight.weight.store(std::max<uint64_t>(weight, 1), std::memory_order_relaxed);
+	}
+
+	return active_weight.weight.load(std::memory_order_relaxed);
+}
+
+bool ApplicationQuota::IsOverShare(const std::shared_ptr<ApplicationQuotaStatistics> &statistics, ApplicationQuotaScheduler scheduler, int64_t current_time, uint32_t thread_count)
+{
+	if(statistics == nullptr)
+	{
+		return false;
+	}
+
+	uint64_t capacity = static_cast<uint64_t>(std::max(thread_count, 1u)) * APPLICATION_QUOTA_WINDOW_MS * 1000;
+	// The application which has just become active is not counted yet, so it gets the share of its weight at least
+	uint64_t weight = std::max<uint64_t>(GetActiveWeight(scheduler, current_time), statistics->GetWeight());
+
+	return statistics->GetWindowBusyTime(scheduler, current_time) > (capacity * statistics->GetWeight() / weight);
+}
+
+bool ApplicationQuota::IsOverLimit(const std::shared_ptr<ApplicationQuotaStatistics> &statistics, ApplicationQuotaScheduler scheduler, int64_t current_time, uint32_t thread_count)
+{
+	if(statistics == nullptr)
+	{
+		return false;
+	}
+
+	uint64_t limit = statistics->GetWindowBusyLimit(scheduler, thread_count);
+
+	return (limit > 0) && (statistics->GetWindowBusyTime(scheduler, current_time) >= limit);
+}
+
+int64_t ApplicationQuota::GetCurrentMilliseconds()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
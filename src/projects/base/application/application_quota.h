@@ -0,0 +1,231 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include "application.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// The busy time of the shared schedulers is accounted in windows of this interval (ms)
+#define APPLICATION_QUOTA_WINDOW_MS				100
+// The bitrates are sampled when they are requested, but at most once in this interval (ms)
+#define APPLICATION_QUOTA_RATE_INTERVAL_MS		1000
+
+// Schedulers shared by the applications
+enum class ApplicationQuotaScheduler : uint8_t
+{
+	Transcoder,
+	StreamWorker,
+
+	NumberOfSchedulers
+};
+
+// <Quota> of an application and its usage
+//
+// - The modules keep this object and update it without the lock
+class ApplicationQuotaStatistics
+{
+public:
+	ApplicationQuotaStatistics(info::application_id_t application_id, const ov::String &application_name, const cfg::Quota &quota);
+
+	info::application_id_t GetApplicationId() const
+	{
+		return _application_id;
+	}
+
+	const ov::String &GetApplicationName() const
+	{
+		return _application_name;
+	}
+
+	uint32_t GetWeight() const
+	{
+		return _weight;
+	}
+
+	// bps (0: unlimited)
+	uint64_t GetMaxEgressBitrate() const
+	{
+		return _max_egress_bitrate;
+	}
+
+	uint64_t GetMaxIngestBitrate() const
+	{
+		return _max_ingest_bitrate;
+	}
+
+	// Sessions of the stream workers
+	void AddSessionCount(int64_t delta)
+	{
+		_session_count.fetch_add(delta, std::memory_order_relaxed);
+	}
+
+	int64_t GetSessionCount() const
+	{
+		return _session_count.load(std::memory_order_relaxed);
+	}
+
+	void AddEgressBytes(uint64_t bytes)
+	{
+		_egress_bytes.fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	uint64_t GetEgressBytes() const
+	{
+		return _egress_bytes.load(std::memory_order_relaxed);
+	}
+
+	void AddIngestBytes(uint64_t bytes)
+	{
+		_ingest_bytes.fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	uint64_t GetIngestBytes() const
+	{
+		return _ingest_bytes.load(std::memory_order_relaxed);
+	}
+
+	// bps of the last interval
+	uint64_t GetEgressBitrate();
+	uint64_t GetIngestBitrate();
+
+	// Limit of the pacing rate of a session: MaxEgressBitrate is divided by the sessions (bps, 0: unlimited)
+	uint64_t GetEgressBitrateShare() const;
+
+	// Time which the scheduler has run the tasks of the application (us)
+	void AddBusyTime(ApplicationQuotaScheduler scheduler, int64_t current_time, uint64_t busy_time);
+	// us of the total
+	uint64_t GetBusyTime(ApplicationQuotaScheduler scheduler) const
+	{
+		return _schedulers[static_cast<int>(scheduler)].total_time.load(std::memory_order_relaxed);
+	}
+	// us in the window of current_time (ms)
+	uint64_t GetWindowBusyTime(ApplicationQuotaScheduler scheduler, int64_t current_time) const;
+	// The application ran on the scheduler in the current or the previous window
+	bool IsActive(ApplicationQuotaScheduler scheduler, int64_t current_time) const;
+
+	// us of the window which the application can use regardless of the other applications (0: unlimited)
+	uint64_t GetWindowBusyLimit(ApplicationQuotaScheduler scheduler, uint32_t thread_count) const;
+
+	// Returns the reason if a new session exceeds the quota (empty if it can be served)
+	ov::String GetSessionRejectReason();
+	// Returns the reason if a new stream exceeds the quota (empty if it can be received)
+	ov::String GetStreamRejectReason();
+
+	uint64_t GetRejectedSessionCount() const
+	{
+		return _rejected_session_count.load(std::memory_order_relaxed);
+	}
+
+	uint64_t GetRejectedStreamCount() const
+	{
+		return _rejected_stream_count.load(std::memory_order_relaxed);
+	}
+
+	// Times which the schedulers deferred the tasks of the application for the fair share
+	void AddDeferredCount(ApplicationQuotaScheduler scheduler)
+	{
+		_schedulers[static_cast<int>(scheduler)].deferred_count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	uint64_t GetDeferredCount(ApplicationQuotaScheduler scheduler) const
+	{
+		return _schedulers[static_cast<int>(scheduler)].deferred_count.load(std::memory_order_relaxed);
+	}
+
+private:
+	struct SchedulerUsage
+	{
+		// Index of the window (current_time / APPLICATION_QUOTA_WINDOW_MS)
+		std::atomic<int64_t> window_index { -1 };
+		std::atomic<uint64_t> window_time { 0 };
+		std::atomic<uint64_t> total_time { 0 };
+		std::atomic<uint64_t> deferred_count { 0 };
+	};
+
+	struct RateSample
+	{
+		bool sampled = false;
+		int64_t time = 0;
+		uint64_t bytes = 0;
+		uint64_t bitrate = 0;
+	};
+
+	// _rate_mutex must be locked
+	static uint64_t SampleBitrate(RateSample &sample, uint64_t bytes);
+
+	info::application_id_t _application_id;
+	ov::String _application_name;
+
+	uint32_t _weight = 1;
+	uint32_t _max_transcode_share = 0;
+	uint64_t _max_egress_bitrate = 0;
+	int64_t _max_session_count = 0;
+	uint64_t _max_ingest_bitrate = 0;
+
+	std::atomic<int64_t> _session_count { 0 };
+	std::atomic<uint64_t> _egress_bytes { 0 };
+	std::atomic<uint64_t> _ingest_bytes { 0 };
+
+	std::mutex _rate_mutex;
+	RateSample _egress_sample;
+	RateSample _ingest_sample;
+
+	SchedulerUsage _schedulers[static_cast<int>(ApplicationQuotaScheduler::NumberOfSchedulers)];
+
+	std::atomic<uint64_t> _rejected_session_count { 0 };
+	std::atomic<uint64_t> _rejected_stream_count { 0 };
+};
+
+// Quotas of all the applications, the shared schedulers give each application the share of its weight
+//
+// - An application which uses more than its share of the window is deferred while the others are waiting,
+//   so a busy application uses the idle threads, but not the share of the others
+// - The statistics are kept after the application is deleted (the ids are not reused)
+class ApplicationQuota : public ov::Singleton<ApplicationQuota>
+{
+public:
+	friend class ov::Singleton<ApplicationQuota>;
+
+	// Created with <Quota> of the application when it is requested first
+	std::shared_ptr<ApplicationQuotaStatistics> GetStatistics(const info::Application &application_info);
+	// nullptr if no module of the application has requested it
+	std::shared_ptr<ApplicationQuotaStatistics> FindStatistics(const ov::String &application_name) const;
+
+	void GetAllStatistics(std::vector<std::shared_ptr<ApplicationQuotaStatistics>> &statistics_list) const;
+
+	// The statistics exceeds its weighted share of the current window (nullptr: the tasks which don't belong to an application)
+	bool IsOverShare(const std::shared_ptr<ApplicationQuotaStatistics> &statistics, ApplicationQuotaScheduler scheduler, int64_t current_time, uint32_t thread_count);
+	// The statistics exceeds its limit (e.g. <MaxTranscodeShare>) of the current window, the task must wait for the next window
+	static bool IsOverLimit(const std::shared_ptr<ApplicationQuotaStatistics> &statistics, ApplicationQuotaScheduler scheduler, int64_t current_time, uint32_t thread_count);
+
+	static int64_t GetCurrentMilliseconds();
+
+protected:
+	ApplicationQuota() = default;
+
+	// Sum of the weights of the active applications (recalculated once per window)
+	uint64_t GetActiveWeight(ApplicationQuotaScheduler scheduler, int64_t current_time);
+
+	mutable std::mutex _mutex;
+	std::map<info::application_id_t, std::shared_ptr<ApplicationQuotaStatistics>> _statistics_map;
+
+	struct ActiveWeight
+	{
+		std::atomic<int64_t> window_index { -1 };
+		std::atomic<uint64_t> weight { 1 };
+	};
+
+	ActiveWeight _active_weights[static_cast<int>(ApplicationQuotaScheduler::NumberOfSchedulers)];
+};
@@ -34,6 +34,7 @@ MediaTrack::MediaTrack(const MediaTrack &media_track)
 	_framerate = media_track._framerate;
 	_width = media_track._width;
 	_height = media_track._height;
+	_temporal_layer_count = media_track._temporal_layer_count;
 
 	// 오디오
 	// _sample_rate = T._sample_rate;
@@ -51,6 +51,10 @@ namespace info
 					codec_name = "avc";
 					break;
 
+				case common::MediaCodecId::H265:
+					codec_name = "hevc";
+					break;
+
 				case common::MediaCodecId::Vp8:
 					codec_name = "vp8";
 					break;
@@ -0,0 +1,341 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "stream_capture.h"
+#include "application_private.h"
+
+#include <base/ovlibrary/byte_io.h>
+
+#include <algorithm>
+
+// time(8) | track id(4) | media type(1) | flags(1) | pts(8) | cts(8) | fragment count(2)
+#define STREAM_CAPTURE_RECORD_HEADER_SIZE			32
+
+static ov::String SerializeStreamInfo(const std::shared_ptr<StreamInfo> &stream_info)
+{
+	ov::String serialize = ov::String::FormatString("%s\n", stream_info->GetName().CStr());
+
+	for(auto &track_item : stream_info->GetTracks())
+	{
+		auto &track = track_item.second;
+
+		serialize.AppendFormat(
+			// framerate|width|height
+			"%.6f|%d|%d|"
+			// samplerate|format|layout
+			"%d|%d|%d|"
+			// track_id|codec_id|media_type|timebase.num|timebase.den|bitrate|start_frame_time|last_frame_time
+			"%d|%d|%d|%d|%d|%d|%lld|%lld\n",
+			track->GetFrameRate(), track->GetWidth(), track->GetHeight(),
+			track->GetSampleRate(), track->GetSample().GetFormat(), track->GetChannel().GetLayout(),
+			track->GetId(), track->GetCodecId(), track->GetMediaType(), track->GetTimeBase().GetNum(), track->GetTimeBase().GetDen(), track->GetBitrate(),
+			static_cast<long long>(track->GetStartFrameTime()), static_cast<long long>(track->GetLastFrameTime()));
+	}
+
+	return serialize;
+}
+
+static bool DeserializeStreamInfo(const ov::String &serialized, StreamInfo *stream_info)
+{
+	auto lines = serialized.Split("\n");
+
+	if(lines.empty())
+	{
+		return false;
+	}
+
+	stream_info->SetName(lines[0]);
+
+	for(size_t line_index = 1; line_index < lines.size(); line_index++)
+	{
+		auto &line = lines[line_index];
+
+		if(line.IsEmpty())
+		{
+			continue;
+		}
+
+		auto info = line.Split("|");
+
+		if(info.size() != 14)
+		{
+			logte("Invalid track of the capture: [%s]", line.CStr());
+			return false;
+		}
+
+		auto track = std::make_shared<MediaTrack>();
+		int index = 0;
+
+		track->SetFrameRate(ov::Converter::ToDouble(info[index++]));
+		track->SetWidth(ov::Converter::ToInt32(info[index++]));
+		track->SetHeight(ov::Converter::ToInt32(info[index++]));
+
+		track->SetSampleRate(ov::Converter::ToInt32(info[index++]));
+		track->GetSample().SetFormat(static_cast<common::AudioSample::Format>(ov::Converter::ToInt32(info[index++])));
+		track->GetChannel().SetLayout(static_cast<common::AudioChannel::Layout>(ov::Converter::ToInt32(info[index++])));
+
+		track->SetId(ov::Converter::ToUInt32(info[index++]));
+		track->SetCodecId(static_cast<common::MediaCodecId>(ov::Converter::ToInt32(info[index++])));
+		track->SetMediaType(static_cast<common::MediaType>(ov::Converter::ToInt32(info[index++])));
+		int num = ov::Converter::ToInt32(info[index++]);
+		int den = ov::Converter::ToInt32(info[index++]);
+		track->SetTimeBase(num, den);
+		track->SetBitrate(ov::Converter::ToInt32(info[index++]));
+		track->SetStartFrameTime(ov::Converter::ToInt64(info[index++]));
+		track->SetLastFrameTime(ov::Converter::ToInt64(info[index++]));
+
+		stream_info->AddTrack(track);
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// StreamCaptureWriter
+//====================================================================================================
+StreamCaptureWriter::~StreamCaptureWriter()
+{
+	Close();
+}
+
+std::shared_ptr<StreamCaptureWriter> StreamCaptureWriter::Create(const ov::String &path, const std::shared_ptr<StreamInfo> &stream_info, uint64_t max_size)
+{
+	auto writer = std::shared_ptr<StreamCaptureWriter>(new StreamCaptureWriter());
+
+	writer->_path = path;
+	writer->_max_size = max_size;
+	writer->_file = ::fopen(path.CStr(), "wb");
+
+	if(writer->_file == nullptr)
+	{
+		logte("Could not create the capture %s: %s", path.CStr(), ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		return nullptr;
+	}
+
+	::setvbuf(writer->_file, nullptr, _IOFBF, STREAM_CAPTURE_FILE_BUFFER_SIZE);
+
+	auto info = SerializeStreamInfo(stream_info);
+	uint8_t length[4];
+
+	ByteWriter<uint32_t>::WriteBigEndian(length, static_cast<uint32_t>(info.GetLength()));
+
+	if((writer->WriteData(STREAM_CAPTURE_MAGIC, STREAM_CAPTURE_MAGIC_LENGTH) == false) ||
+	   (writer->WriteData(length, sizeof(length)) == false) ||
+	   (writer->WriteData(info.CStr(), info.GetLength()) == false))
+	{
+		return nullptr;
+	}
+
+	return writer;
+}
+
+bool StreamCaptureWriter::Write(const MediaPacket &packet)
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	if(_file == nullptr)
+	{
+		return false;
+	}
+
+	// The ingest time is set by the providers when the packet is received (the time of the capture is used otherwise)
+	int64_t time = (packet.GetIngestTime() > 0) ? packet.GetIngestTime() : ov::LatencyHistogram::GetCurrentMicroseconds();
+
+	if(_start_time < 0)
+	{
+		_start_time = time;
+	}
+
+	auto &payload = packet.GetData();
+	auto frag_header = packet._frag_hdr.get();
+	uint16_t fragment_count = std::min<uint16_t>(frag_header->fragmentation_vector_size, MAX_FRAG_COUNT);
+	size_t record_size = STREAM_CAPTURE_RECORD_HEADER_SIZE + (fragment_count * 8) + payload->GetLength();
+
+	if((_max_size > 0) && ((_size + record_size + 4) > _max_size))
+	{
+		logtw("The capture %s is closed: reached the maximum size (%llu bytes)", _path.CStr(), static_cast<unsigned long long>(_max_size));
+
+		::fclose(_file);
+		_file = nullptr;
+
+		return false;
+	}
+
+	_record.Clear();
+	ov::ByteStream stream(&_record);
+
+	stream.WriteBE32(static_cast<uint32_t>(record_size));
+	stream.WriteBE64(static_cast<uint64_t>(std::max<int64_t>(time - _start_time, 0)));
+	stream.WriteBE32(static_cast<uint32_t>(packet.GetTrackId()));
+	stream.Write8(static_cast<uint8_t>(packet.GetMediaType()));
+	stream.Write8(static_cast<uint8_t>(packet.GetFlags()));
+	stream.WriteBE64(static_cast<uint64_t>(packet.GetPts()));
+	stream.WriteBE64(static_cast<uint64_t>(packet.GetCts()));
+	stream.WriteBE16(fragment_count);
+
+	for(uint16_t index = 0; index < fragment_count; index++)
+	{
+		stream.WriteBE32(static_cast<uint32_t>(frag_header->fragmentation_offset[index]));
+		stream.WriteBE32(static_cast<uint32_t>(frag_header->fragmentation_length[index]));
+	}
+
+	return WriteData(_record.GetData(), _record.GetLength()) && WriteData(payload->GetData(), payload->GetLength());
+}
+
+void StreamCaptureWriter::Close()
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	if(_file != nullptr)
+	{
+		::fclose(_file);
+		_file = nullptr;
+
+		logti("The capture %s is closed (%llu bytes)", _path.CStr(), static_cast<unsigned long long>(_size));
+	}
+}
+
+bool StreamCaptureWriter::WriteData(const void *data, size_t length)
+{
+	if((length > 0) && (::fwrite(data, 1, length, _file) != length))
+	{
+		logte("Could not write the capture %s: %s", _path.CStr(), ov::Error::CreateErrorFromErrno()->ToString().CStr());
+
+		::fclose(_file);
+		_file = nullptr;
+
+		return false;
+	}
+
+	_size += length;
+
+	return true;
+}
+
+//====================================================================================================
+// StreamCaptureReader
+//====================================================================================================
+StreamCaptureReader::~StreamCaptureReader()
+{
+	if(_file != nullptr)
+	{
+		::fclose(_file);
+	}
+}
+
+std::shared_ptr<StreamCaptureReader> StreamCaptureReader::Open(const ov::String &path)
+{
+	auto reader = std::shared_ptr<StreamCaptureReader>(new StreamCaptureReader());
+
+	reader->_path = path;
+	reader->_file = ::fopen(path.CStr(), "rb");
+
+	if(reader->_file == nullptr)
+	{
+		logte("Could not open the capture %s: %s", path.CStr(), ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		return nullptr;
+	}
+
+	::setvbuf(reader->_file, nullptr, _IOFBF, STREAM_CAPTURE_FILE_BUFFER_SIZE);
+
+	char magic[STREAM_CAPTURE_MAGIC_LENGTH];
+	uint8_t length[4];
+
+	if((reader->ReadData(magic, sizeof(magic)) == false) || (::memcmp(magic, STREAM_CAPTURE_MAGIC, sizeof(magic)) != 0) ||
+	   (reader->ReadData(length, sizeof(length)) == false))
+	{
+		logte("Invalid capture: %s", path.CStr());
+		return nullptr;
+	}
+
+	uint32_t info_length = ByteReader<uint32_t>::ReadBigEndian(length);
+
+	if((info_length == 0) || (info_length > STREAM_CAPTURE_MAX_RECORD_SIZE) || (reader->_record.SetLength(info_length) == false) ||
+	   (reader->ReadData(reader->_record.GetWritableData(), info_length) == false) ||
+	   (DeserializeStreamInfo(ov::String(reader->_record.GetDataAs<char>(), info_length), &(reader->_stream_info)) == false))
+	{
+		logte("Invalid stream information of the capture: %s", path.CStr());
+		return nullptr;
+	}
+
+	reader->_first_record_offset = ::ftell(reader->_file);
+
+	return reader;
+}
+
+bool StreamCaptureReader::Read(StreamCapturePacket *capture_packet)
+{
+	uint8_t length[4];
+
+	if(ReadData(length, sizeof(length)) == false)
+	{
+		// End of the capture
+		return false;
+	}
+
+	uint32_t record_size = ByteReader<uint32_t>::ReadBigEndian(length);
+
+	if((record_size < STREAM_CAPTURE_RECORD_HEADER_SIZE) || (record_size > STREAM_CAPTURE_MAX_RECORD_SIZE) ||
+	   (_record.SetLength(record_size) == false) || (ReadData(_record.GetWritableData(), record_size) == false))
+	{
+		logtw("The capture %s is truncated", _path.CStr());
+		return false;
+	}
+
+	ov::ByteStream stream(&_record);
+
+	int64_t time = static_cast<int64_t>(stream.ReadBE64());
+	int32_t track_id = static_cast<int32_t>(stream.ReadBE32());
+	auto media_type = static_cast<common::MediaType>(static_cast<int8_t>(stream.Read8()));
+	auto flags = static_cast<MediaPacketFlag>(stream.Read8());
+	int64_t pts = static_cast<int64_t>(stream.ReadBE64());
+	int64_t cts = static_cast<int64_t>(stream.ReadBE64());
+	uint16_t fragment_count = stream.ReadBE16();
+
+	if((fragment_count > MAX_FRAG_COUNT) || (stream.Remained() < (fragment_count * 8U)))
+	{
+		logtw("Invalid record of the capture %s", _path.CStr());
+		return false;
+	}
+
+	size_t offsets[MAX_FRAG_COUNT];
+	size_t lengths[MAX_FRAG_COUNT];
+
+	for(uint16_t index = 0; index < fragment_count; index++)
+	{
+		offsets[index] = stream.ReadBE32();
+		lengths[index] = stream.ReadBE32();
+	}
+
+	auto packet = std::make_unique<MediaPacket>(media_type, track_id, _record.GetDataAs<uint8_t>() + stream.GetOffset(), static_cast<int32_t>(stream.Remained()), pts, flags, cts);
+
+	if(fragment_count > 0)
+	{
+		packet->_frag_hdr->VerifyAndAllocateFragmentationHeader(fragment_count);
+
+		for(uint16_t index = 0; index < fragment_count; index++)
+		{
+			packet->_frag_hdr->fragmentation_offset[index] = offsets[index];
+			packet->_frag_hdr->fragmentation_length[index] = lengths[index];
+		}
+	}
+
+	capture_packet->time = time;
+	capture_packet->packet = std::move(packet);
+
+	return true;
+}
+
+bool StreamCaptureReader::Rewind()
+{
+	return ::fseek(_file, _first_record_offset, SEEK_SET) == 0;
+}
+
+bool StreamCaptureReader::ReadData(void *data, size_t length)
+{
+	return ::fread(data, 1, length, _file) == length;
+}
@@ -0,0 +1,107 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+#include <base/media_route/media_buffer.h>
+
+#include "stream_info.h"
+
+#include <stdio.h>
+
+#include <memory>
+#include <mutex>
+
+#define STREAM_CAPTURE_MAGIC						"OVCAP/1\n"
+#define STREAM_CAPTURE_MAGIC_LENGTH					8
+// Buffer of the file (the packets are written by fwrite() on the thread of the provider)
+#define STREAM_CAPTURE_FILE_BUFFER_SIZE				(1024 * 1024)
+// The records which are larger than this are treated as corrupted
+#define STREAM_CAPTURE_MAX_RECORD_SIZE				(64 * 1024 * 1024)
+
+// A packet of the capture
+struct StreamCapturePacket
+{
+	// us since the first packet of the capture (the interval of the ingest)
+	int64_t time = 0;
+	std::unique_ptr<MediaPacket> packet;
+};
+
+// Capture of the packets which are received by a provider (before the bitstream conversion of the router),
+// which is replayed by ReplayProvider to reproduce the workload (odd GOPs, B-frames, bursty audio, timestamp jumps)
+//
+// File (big endian):
+//   "OVCAP/1\n" | info length(4) | stream info (text, same as CreateStream of the relay: <name>\n<track>\n...)
+//   record: length(4) | time(8) | track id(4) | media type(1) | flags(1) | pts(8) | cts(8)
+//           | fragment count(2) | [offset(4) | length(4)] * fragment count | payload
+class StreamCaptureWriter
+{
+public:
+	~StreamCaptureWriter();
+
+	// max_size: bytes (0: unlimited), the packets after it are not written
+	static std::shared_ptr<StreamCaptureWriter> Create(const ov::String &path, const std::shared_ptr<StreamInfo> &stream_info, uint64_t max_size);
+
+	bool Write(const MediaPacket &packet);
+	void Close();
+
+	const ov::String &GetPath() const
+	{
+		return _path;
+	}
+
+	uint64_t GetSize() const
+	{
+		return _size;
+	}
+
+protected:
+	StreamCaptureWriter() = default;
+
+	bool WriteData(const void *data, size_t length);
+
+	ov::String _path;
+	uint64_t _max_size = 0;
+
+	std::mutex _mutex;
+	FILE *_file = nullptr;
+	uint64_t _size = 0;
+	// The first packet
+	int64_t _start_time = -1;
+	ov::Data _record;
+};
+
+class StreamCaptureReader
+{
+public:
+	~StreamCaptureReader();
+
+	static std::shared_ptr<StreamCaptureReader> Open(const ov::String &path);
+
+	// The tracks of the stream (the name and the id are set by the caller)
+	const StreamInfo &GetStreamInfo() const
+	{
+		return _stream_info;
+	}
+
+	// false: the end of the file (or a corrupted record)
+	bool Read(StreamCapturePacket *capture_packet);
+	// To the first record (loop)
+	bool Rewind();
+
+protected:
+	StreamCaptureReader() = default;
+
+	bool ReadData(void *data, size_t length);
+
+	ov::String _path;
+	FILE *_file = nullptr;
+	long _first_record_offset = 0;
+	StreamInfo _stream_info;
+	ov::Data _record;
+};
@@ -0,0 +1,137 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "stream_demand.h"
+
+#include <algorithm>
+
+#define OV_LOG_TAG "StreamDemand"
+
+void StreamDemand::AddSession(info::application_id_t application_id, const ov::String &stream_name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto key = std::make_pair(application_id, stream_name);
+	auto &session_count = _session_counts[key];
+
+	session_count++;
+	UpdateInputSessionCount(GetInputStreamKey(key), 1);
+	_version.fetch_add(1, std::memory_order_release);
+
+	logtd("Session is added to %s (sessions: %zu)", stream_name.CStr(), session_count);
+}
+
+void StreamDemand::RemoveSession(info::application_id_t application_id, const ov::String &stream_name, size_t count)
+{
+	if(count == 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto item = _session_counts.find(std::make_pair(application_id, stream_name));
+
+	if(item == _session_counts.end())
+	{
+		logtw("Stream %s does not have any session", stream_name.CStr());
+		return;
+	}
+
+	count = std::min(item->second, count);
+	item->second -= count;
+	UpdateInputSessionCount(GetInputStreamKey(item->first), -static_cast<ssize_t>(count));
+
+	logtd("Session is removed from %s (sessions: %zu)", stream_name.CStr(), item->second);
+
+	if(item->second == 0)
+	{
+		_session_counts.erase(item);
+	}
+
+	_version.fetch_add(1, std::memory_order_release);
+}
+
+size_t StreamDemand::GetSessionCount(info::application_id_t application_id, const ov::String &stream_name) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto item = _session_counts.find(std::make_pair(application_id, stream_name));
+
+	return (item != _session_counts.end()) ? item->second : 0;
+}
+
+void StreamDemand::SetInputStream(info::application_id_t application_id, const ov::String &output_stream_name, const ov::String &input_stream_name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto key = std::make_pair(application_id, output_stream_name);
+	auto session_count = _session_counts.find(key);
+	auto count = static_cast<ssize_t>((session_count != _session_counts.end()) ? session_count->second : 0);
+
+	// Move the sessions which are already attached to the new input stream
+	UpdateInputSessionCount(GetInputStreamKey(key), -count);
+	_input_stream_names[key] = input_stream_name;
+	UpdateInputSessionCount(GetInputStreamKey(key), count);
+
+	_version.fetch_add(1, std::memory_order_release);
+}
+
+void StreamDemand::RemoveInputStream(info::application_id_t application_id, const ov::String &output_stream_name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto key = std::make_pair(application_id, output_stream_name);
+	auto input_stream_name = _input_stream_names.find(key);
+
+	if(input_stream_name == _input_stream_names.end())
+	{
+		return;
+	}
+
+	auto session_count = _session_counts.find(key);
+	auto count = static_cast<ssize_t>((session_count != _session_counts.end()) ? session_count->second : 0);
+
+	UpdateInputSessionCount(GetInputStreamKey(key), -count);
+	_input_stream_names.erase(input_stream_name);
+	UpdateInputSessionCount(key, count);
+
+	_version.fetch_add(1, std::memory_order_release);
+}
+
+size_t StreamDemand::GetInputSessionCount(info::application_id_t application_id, const ov::String &input_stream_name) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto item = _input_session_counts.find(std::make_pair(application_id, input_stream_name));
+
+	return (item != _input_session_counts.end()) ? item->second : 0;
+}
+
+StreamDemand::StreamKey StreamDemand::GetInputStreamKey(const StreamKey &key) const
+{
+	auto input_stream_name = _input_stream_names.find(key);
+
+	return (input_stream_name != _input_stream_names.end()) ? std::make_pair(key.first, input_stream_name->second) : key;
+}
+
+void StreamDemand::UpdateInputSessionCount(const StreamKey &input_key, ssize_t delta)
+{
+	if(delta == 0)
+	{
+		return;
+	}
+
+	auto &session_count = _input_session_counts[input_key];
+
+	session_count = static_cast<size_t>(std::max<ssize_t>(static_cast<ssize_t>(session_count) + delta, 0));
+
+	if(session_count == 0)
+	{
+		_input_session_counts.erase(input_key);
+	}
+}
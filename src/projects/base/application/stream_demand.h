@@ -0,0 +1,68 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include "application.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+
+// Number of the sessions attached to each output stream, reported by the publishers
+//
+// - The transcoder runs the encoders of the on-demand streams only while they have sessions
+// - The publishers which do not manage the sessions (e.g. HLS, DASH) do not report anything,
+//   so only the streams which enable <OnDemand> depend on this
+// - The sessions of the output streams are also counted for their input stream (see SetInputStream()),
+//   so the providers can pull the input stream only while it is watched (e.g. RelayClient)
+class StreamDemand : public ov::Singleton<StreamDemand>
+{
+public:
+	friend class ov::Singleton<StreamDemand>;
+
+	void AddSession(info::application_id_t application_id, const ov::String &stream_name);
+	// count: number of the sessions removed at once (e.g. when the stream is stopped)
+	void RemoveSession(info::application_id_t application_id, const ov::String &stream_name, size_t count = 1);
+
+	size_t GetSessionCount(info::application_id_t application_id, const ov::String &stream_name) const;
+
+	// The output stream is created from the input stream (e.g. by the transcoder)
+	void SetInputStream(info::application_id_t application_id, const ov::String &output_stream_name, const ov::String &input_stream_name);
+	void RemoveInputStream(info::application_id_t application_id, const ov::String &output_stream_name);
+
+	// Sum of the sessions of the output streams created from the input stream
+	// (If the stream is not an input of any stream, the sessions of the stream itself)
+	size_t GetInputSessionCount(info::application_id_t application_id, const ov::String &input_stream_name) const;
+
+	// Increased whenever the session count of any stream is changed (the users can skip the lookup if it is not changed)
+	uint64_t GetVersion() const
+	{
+		return _version.load(std::memory_order_acquire);
+	}
+
+protected:
+	StreamDemand() = default;
+
+	typedef std::pair<info::application_id_t, ov::String> StreamKey;
+
+	// _mutex must be locked
+	StreamKey GetInputStreamKey(const StreamKey &key) const;
+	void UpdateInputSessionCount(const StreamKey &input_key, ssize_t delta);
+
+	mutable std::mutex _mutex;
+	std::map<StreamKey, size_t> _session_counts;
+
+	// key: output stream, value: input stream name
+	std::map<StreamKey, ov::String> _input_stream_names;
+	// key: input stream
+	std::map<StreamKey, size_t> _input_session_counts;
+
+	std::atomic<uint64_t> _version { 0 };
+};
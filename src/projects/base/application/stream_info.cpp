@@ -23,6 +23,7 @@ StreamInfo::StreamInfo(const StreamInfo &stream_info)
 {
 	_id = stream_info._id;
 	_name = stream_info._name;
+	_origin_stream_name = stream_info._origin_stream_name;
 
 	for(auto &track : stream_info._tracks)
 	{
@@ -56,18 +57,53 @@ void StreamInfo::SetName(ov::String name)
 	_name = name;
 }
 
+const ov::String &StreamInfo::GetOriginStreamName() const
+{
+	return _origin_stream_name;
+}
+
+void StreamInfo::SetOriginStreamName(const ov::String &name)
+{
+	_origin_stream_name = name;
+}
+
 bool StreamInfo::AddTrack(std::shared_ptr<MediaTrack> track)
 {
-	return _tracks.insert(std::make_pair(track->GetId(), track)).second;
+	int32_t id = track->GetId();
+
+	if(_tracks.insert(std::make_pair(id, track)).second == false)
+	{
+		return false;
+	}
+
+	if((id >= 0) && (id < STREAM_INFO_TRACK_TABLE_SIZE))
+	{
+		if(static_cast<size_t>(id) >= _track_table.size())
+		{
+			_track_table.resize(id + 1);
+		}
+
+		_track_table[id] = std::move(track);
+	}
+
+	return true;
 }
 
-const std::shared_ptr<MediaTrack> StreamInfo::GetTrack(int32_t id) const
+const std::shared_ptr<MediaTrack> &StreamInfo::GetTrack(int32_t id) const
 {
+	static const std::shared_ptr<MediaTrack> empty_track;
+
+	if((id >= 0) && (id < STREAM_INFO_TRACK_TABLE_SIZE))
+	{
+		// The table has all tracks in the range
+		return (static_cast<size_t>(id) < _track_table.size()) ? _track_table[id] : empty_track;
+	}
+
 	auto item = _tracks.find(id);
 
 	if(item == _tracks.end())
 	{
-		return nullptr;
+		return empty_track;
 	}
 
 	return item->second;
@@ -95,6 +131,10 @@ void StreamInfo::ShowInfo()
 				codec_name = "avc";
 				break;
 
+			case MediaCodecId::H265:
+				codec_name = "hevc";
+				break;
+
 			case MediaCodecId::Vp8:
 				codec_name = "vp8";
 				break;
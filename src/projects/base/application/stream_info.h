@@ -3,6 +3,9 @@
 #include "base/common_types.h"
 #include "base/application/media_track.h"
 
+// The tracks of the ids in [0, STREAM_INFO_TRACK_TABLE_SIZE) are also indexed by the id (e.g. the payload types of WebRTC)
+#define STREAM_INFO_TRACK_TABLE_SIZE	128
+
 class StreamInfo
 {
 public:
@@ -25,8 +28,14 @@ public:
 	ov::String GetName();
 	void SetName(ov::String name);
 
+	// Name of the input stream of the transcoder, which is same for all outputs (renditions) of the input
+	// (empty if the stream is not an output of the transcoder)
+	const ov::String &GetOriginStreamName() const;
+	void SetOriginStreamName(const ov::String &name);
+
 	bool AddTrack(std::shared_ptr<MediaTrack> track);
-	const std::shared_ptr<MediaTrack> GetTrack(int32_t id) const;
+	// The returned reference is valid while the stream info is alive (nullptr if not found)
+	const std::shared_ptr<MediaTrack> &GetTrack(int32_t id) const;
 	const std::map<int32_t, std::shared_ptr<MediaTrack>> &GetTracks() const;
 
 	void ShowInfo();
@@ -34,8 +43,11 @@ public:
 protected:
 	uint32_t _id;
 	ov::String _name;
+	ov::String _origin_stream_name;
 
 	// MediaTrack ID 값을 Key로 활용함
 	std::map<int32_t, std::shared_ptr<MediaTrack>> _tracks;
+	// Dense table of _tracks for the lookups per packet (index: track id, nullptr if there is no track of the id)
+	std::vector<std::shared_ptr<MediaTrack>> _track_table;
 
 };
@@ -0,0 +1,74 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "stream_key_frame_advisory.h"
+
+void StreamKeyFrameAdvice::Add(int64_t interval)
+{
+	if(interval <= 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_intervals.insert(interval);
+	UpdateInterval();
+}
+
+void StreamKeyFrameAdvice::Remove(int64_t interval)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto item = _intervals.find(interval);
+
+	if(item != _intervals.end())
+	{
+		_intervals.erase(item);
+		UpdateInterval();
+	}
+}
+
+void StreamKeyFrameAdvice::UpdateInterval()
+{
+	int64_t interval = 0;
+
+	for(auto item : _intervals)
+	{
+		// Euclidean algorithm
+		while(item != 0)
+		{
+			auto remainder = interval % item;
+
+			interval = item;
+			item = remainder;
+		}
+	}
+
+	_interval.store(interval, std::memory_order_relaxed);
+}
+
+std::shared_ptr<StreamKeyFrameAdvice> StreamKeyFrameAdvisory::GetAdvice(info::application_id_t application_id, const ov::String &stream_name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto &advice = _advice_map[std::make_pair(application_id, stream_name)];
+
+	if(advice == nullptr)
+	{
+		advice = std::make_shared<StreamKeyFrameAdvice>();
+	}
+
+	return advice;
+}
+
+void StreamKeyFrameAdvisory::RemoveAdvice(info::application_id_t application_id, const ov::String &stream_name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_advice_map.erase(std::make_pair(application_id, stream_name));
+}
@@ -0,0 +1,63 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include "application.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+// Key frame intervals which the publishers ask for a stream (e.g. the segment duration of HLS/DASH)
+//
+// - The publishers add their intervals, the encoder of the stream reads the interval without the lock
+class StreamKeyFrameAdvice
+{
+public:
+	// milliseconds
+	void Add(int64_t interval);
+	void Remove(int64_t interval);
+
+	// The greatest common divisor of the intervals, so every publisher can cut at the key frames (milliseconds, 0: no advice)
+	int64_t GetInterval() const
+	{
+		return _interval.load(std::memory_order_relaxed);
+	}
+
+private:
+	void UpdateInterval();
+
+	std::mutex _mutex;
+	std::multiset<int64_t> _intervals;
+
+	std::atomic<int64_t> _interval { 0 };
+};
+
+// Advices of all the streams, found by the name of the input stream of the transcoder
+// (The transcoder removes it when the input stream is deleted)
+class StreamKeyFrameAdvisory : public ov::Singleton<StreamKeyFrameAdvisory>
+{
+public:
+	friend class ov::Singleton<StreamKeyFrameAdvisory>;
+
+	// Created when it is requested first
+	std::shared_ptr<StreamKeyFrameAdvice> GetAdvice(info::application_id_t application_id, const ov::String &stream_name);
+	void RemoveAdvice(info::application_id_t application_id, const ov::String &stream_name);
+
+protected:
+	StreamKeyFrameAdvisory() = default;
+
+	typedef std::pair<info::application_id_t, ov::String> StreamKey;
+
+	std::mutex _mutex;
+	std::map<StreamKey, std::shared_ptr<StreamKeyFrameAdvice>> _advice_map;
+};
@@ -0,0 +1,64 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "stream_latency.h"
+
+const char *StreamLatencyStatistics::GetStageName(StreamLatencyStage stage)
+{
+	switch(stage)
+	{
+		case StreamLatencyStage::Ingest:
+			return "ingest";
+		case StreamLatencyStage::RouterQueue:
+			return "router_queue";
+		case StreamLatencyStage::Decode:
+			return "decode";
+		case StreamLatencyStage::Filter:
+			return "filter";
+		case StreamLatencyStage::Encode:
+			return "encode";
+		case StreamLatencyStage::PublisherQueue:
+			return "publisher_queue";
+		case StreamLatencyStage::Send:
+			return "send";
+		case StreamLatencyStage::NumberOfStages:
+			break;
+	}
+
+	return "unknown";
+}
+
+std::shared_ptr<StreamLatencyStatistics> StreamLatency::GetStatistics(info::application_id_t application_id, const ov::String &application_name, const ov::String &stream_name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto &statistics = _statistics_map[std::make_pair(application_id, stream_name)];
+
+	if(statistics == nullptr)
+	{
+		statistics = std::make_shared<StreamLatencyStatistics>(application_name, stream_name);
+	}
+
+	return statistics;
+}
+
+void StreamLatency::RemoveStatistics(info::application_id_t application_id, const ov::String &stream_name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_statistics_map.erase(std::make_pair(application_id, stream_name));
+}
+
+void StreamLatency::GetAllStatistics(std::vector<std::shared_ptr<StreamLatencyStatistics>> &statistics_list) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for(auto &item : _statistics_map)
+	{
+		statistics_list.push_back(item.second);
+	}
+}
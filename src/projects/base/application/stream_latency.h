@@ -0,0 +1,99 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include "application.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Stages of the media pipeline which are measured for each stream
+enum class StreamLatencyStage : uint8_t
+{
+	// Received by the provider (e.g. RtmpChunkStream) -> pushed to MediaRouteStream (with the bitstream conversion)
+	Ingest,
+	// MediaRouteStream::Push() -> MediaRouteStream::Pop() (with the jitter buffer)
+	RouterQueue,
+	// Processing time of each stage of the transcoder (recorded for the input stream)
+	Decode,
+	Filter,
+	Encode,
+	// Queued to the worker of the publisher application -> popped
+	PublisherQueue,
+	// Queued to StreamWorker -> sent to the sessions (in milliseconds resolution)
+	Send,
+
+	NumberOfStages
+};
+
+// Latencies of a stream (in microseconds)
+//
+// - The stages keep this object and record it without the lock
+class StreamLatencyStatistics
+{
+public:
+	StreamLatencyStatistics(const ov::String &application_name, const ov::String &stream_name)
+		: _application_name(application_name),
+		  _stream_name(stream_name)
+	{
+	}
+
+	void Record(StreamLatencyStage stage, int64_t latency)
+	{
+		_histograms[static_cast<int>(stage)].Record(latency);
+	}
+
+	const ov::LatencyHistogram &GetHistogram(StreamLatencyStage stage) const
+	{
+		return _histograms[static_cast<int>(stage)];
+	}
+
+	const ov::String &GetApplicationName() const
+	{
+		return _application_name;
+	}
+
+	const ov::String &GetStreamName() const
+	{
+		return _stream_name;
+	}
+
+	static const char *GetStageName(StreamLatencyStage stage);
+
+private:
+	ov::String _application_name;
+	ov::String _stream_name;
+
+	ov::LatencyHistogram _histograms[static_cast<int>(StreamLatencyStage::NumberOfStages)];
+};
+
+// Latencies of all the streams, the modules of the pipeline find the statistics of a stream by the name
+// (The stream is removed by MediaRouter when it is deleted, the stages may keep the statistics until they are deleted)
+class StreamLatency : public ov::Singleton<StreamLatency>
+{
+public:
+	friend class ov::Singleton<StreamLatency>;
+
+	// Created when it is requested first
+	std::shared_ptr<StreamLatencyStatistics> GetStatistics(info::application_id_t application_id, const ov::String &application_name, const ov::String &stream_name);
+	void RemoveStatistics(info::application_id_t application_id, const ov::String &stream_name);
+
+	void GetAllStatistics(std::vector<std::shared_ptr<StreamLatencyStatistics>> &statistics_list) const;
+
+protected:
+	StreamLatency() = default;
+
+	typedef std::pair<info::application_id_t, ov::String> StreamKey;
+
+	mutable std::mutex _mutex;
+	std::map<StreamKey, std::shared_ptr<StreamLatencyStatistics>> _statistics_map;
+};
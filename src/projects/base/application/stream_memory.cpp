@@ -0,0 +1,56 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "stream_memory.h"
+
+const char *StreamMemoryStatistics::GetComponentName(StreamMemoryComponent component)
+{
+	switch(component)
+	{
+		case StreamMemoryComponent::TranscoderPacketQueue:
+			return "transcoder_packet_queue";
+		case StreamMemoryComponent::TranscoderDecodedQueue:
+			return "transcoder_decoded_queue";
+		case StreamMemoryComponent::TranscoderFilteredQueue:
+			return "transcoder_filtered_queue";
+		case StreamMemoryComponent::NumberOfComponents:
+			break;
+	}
+
+	return "unknown";
+}
+
+std::shared_ptr<StreamMemoryStatistics> StreamMemory::GetStatistics(info::application_id_t application_id, const ov::String &application_name, const ov::String &stream_name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto &statistics = _statistics_map[std::make_pair(application_id, stream_name)];
+
+	if(statistics == nullptr)
+	{
+		statistics = std::make_shared<StreamMemoryStatistics>(application_name, stream_name);
+	}
+
+	return statistics;
+}
+
+void StreamMemory::RemoveStatistics(info::application_id_t application_id, const ov::String &stream_name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_statistics_map.erase(std::make_pair(application_id, stream_name));
+}
+
+void StreamMemory::GetAllStatistics(std::vector<std::shared_ptr<StreamMemoryStatistics>> &statistics_list) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for(auto &item : _statistics_map)
+	{
+		statistics_list.push_back(item.second);
+	}
+}
@@ -0,0 +1,93 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include "application.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Containers of the media pipeline which count the bytes of their items for each stream
+// (the publishers and the sessions are reported by the publishers, see Stream::GetMetrics())
+enum class StreamMemoryComponent : uint8_t
+{
+	// Input queues of the stages of the transcoder
+	TranscoderPacketQueue,
+	TranscoderDecodedQueue,
+	TranscoderFilteredQueue,
+
+	NumberOfComponents
+};
+
+// Bytes of the containers of a stream
+//
+// - The containers keep this object and update it without the lock
+class StreamMemoryStatistics
+{
+public:
+	StreamMemoryStatistics(const ov::String &application_name, const ov::String &stream_name)
+		: _application_name(application_name),
+		  _stream_name(stream_name)
+	{
+	}
+
+	void Add(StreamMemoryComponent component, int64_t bytes)
+	{
+		_bytes[static_cast<int>(component)].fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	int64_t GetBytes(StreamMemoryComponent component) const
+	{
+		return _bytes[static_cast<int>(component)].load(std::memory_order_relaxed);
+	}
+
+	const ov::String &GetApplicationName() const
+	{
+		return _application_name;
+	}
+
+	const ov::String &GetStreamName() const
+	{
+		return _stream_name;
+	}
+
+	static const char *GetComponentName(StreamMemoryComponent component);
+
+private:
+	ov::String _application_name;
+	ov::String _stream_name;
+
+	std::atomic<int64_t> _bytes[static_cast<int>(StreamMemoryComponent::NumberOfComponents)] {};
+};
+
+// Memory of all the streams, the containers find the statistics of a stream by the name
+// (The owner of the containers removes it when the stream is deleted)
+class StreamMemory : public ov::Singleton<StreamMemory>
+{
+public:
+	friend class ov::Singleton<StreamMemory>;
+
+	// Created when it is requested first
+	std::shared_ptr<StreamMemoryStatistics> GetStatistics(info::application_id_t application_id, const ov::String &application_name, const ov::String &stream_name);
+	void RemoveStatistics(info::application_id_t application_id, const ov::String &stream_name);
+
+	void GetAllStatistics(std::vector<std::shared_ptr<StreamMemoryStatistics>> &statistics_list) const;
+
+protected:
+	StreamMemory() = default;
+
+	typedef std::pair<info::application_id_t, ov::String> StreamKey;
+
+	mutable std::mutex _mutex;
+	std::map<StreamKey, std::shared_ptr<StreamMemoryStatistics>> _statistics_map;
+};
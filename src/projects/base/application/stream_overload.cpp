@@ -0,0 +1,60 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "stream_overload.h"
+
+const char *StreamOverloadStatistics::GetLevelName(StreamOverloadLevel level)
+{
+	switch(level)
+	{
+		case StreamOverloadLevel::Normal:
+			return "normal";
+		case StreamOverloadLevel::SkipNonReference:
+			return "skip_non_reference";
+		case StreamOverloadLevel::ReduceFrameRate:
+			return "reduce_frame_rate";
+		case StreamOverloadLevel::FastEncoding:
+			return "fast_encoding";
+		case StreamOverloadLevel::SuspendRenditions:
+			return "suspend_renditions";
+		case StreamOverloadLevel::NumberOfLevels:
+			break;
+	}
+
+	return "unknown";
+}
+
+std::shared_ptr<StreamOverloadStatistics> StreamOverload::GetStatistics(info::application_id_t application_id, const ov::String &application_name, const ov::String &stream_name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto &statistics = _statistics_map[std::make_pair(application_id, stream_name)];
+
+	if(statistics == nullptr)
+	{
+		statistics = std::make_shared<StreamOverloadStatistics>(application_name, stream_name);
+	}
+
+	return statistics;
+}
+
+void StreamOverload::RemoveStatistics(info::application_id_t application_id, const ov::String &stream_name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_statistics_map.erase(std::make_pair(application_id, stream_name));
+}
+
+void StreamOverload::GetAllStatistics(std::vector<std::shared_ptr<StreamOverloadStatistics>> &statistics_list) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for(auto &item : _statistics_map)
+	{
+		statistics_list.push_back(item.second);
+	}
+}
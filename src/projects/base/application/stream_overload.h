@@ -0,0 +1,143 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include "application.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Steps of the degradation of the transcoder, each level includes the lower levels
+enum class StreamOverloadLevel : uint8_t
+{
+	Normal,
+	// The decoders discard the non-reference frames
+	SkipNonReference,
+	// Every other video frame is dropped before the filters
+	ReduceFrameRate,
+	// The encoders use the fastest settings
+	FastEncoding,
+	// The renditions are suspended from the lowest priority (the last rendition of <Encodes>)
+	SuspendRenditions,
+
+	NumberOfLevels
+};
+
+// Degradation of the transcoder of a stream
+//
+// - The stages keep this object and update it without the lock
+class StreamOverloadStatistics
+{
+public:
+	StreamOverloadStatistics(const ov::String &application_name, const ov::String &stream_name)
+		: _application_name(application_name),
+		  _stream_name(stream_name)
+	{
+	}
+
+	StreamOverloadLevel GetLevel() const
+	{
+		return _level.load(std::memory_order_relaxed);
+	}
+
+	void SetLevel(StreamOverloadLevel level)
+	{
+		auto old_level = _level.exchange(level, std::memory_order_relaxed);
+
+		if(level > old_level)
+		{
+			_level_up_count.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	// The longest waiting time of the input packets in the last interval (in milliseconds)
+	int64_t GetQueueDelay() const
+	{
+		return _queue_delay.load(std::memory_order_relaxed);
+	}
+
+	void SetQueueDelay(int64_t queue_delay)
+	{
+		_queue_delay.store(queue_delay, std::memory_order_relaxed);
+	}
+
+	// Number of the times which the level is raised
+	uint64_t GetLevelUpCount() const
+	{
+		return _level_up_count.load(std::memory_order_relaxed);
+	}
+
+	uint64_t GetDroppedFrameCount() const
+	{
+		return _dropped_frame_count.load(std::memory_order_relaxed);
+	}
+
+	void AddDroppedFrame()
+	{
+		_dropped_frame_count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	uint32_t GetSuspendedRenditionCount() const
+	{
+		return _suspended_rendition_count.load(std::memory_order_relaxed);
+	}
+
+	void SetSuspendedRenditionCount(uint32_t count)
+	{
+		_suspended_rendition_count.store(count, std::memory_order_relaxed);
+	}
+
+	const ov::String &GetApplicationName() const
+	{
+		return _application_name;
+	}
+
+	const ov::String &GetStreamName() const
+	{
+		return _stream_name;
+	}
+
+	static const char *GetLevelName(StreamOverloadLevel level);
+
+private:
+	ov::String _application_name;
+	ov::String _stream_name;
+
+	std::atomic<StreamOverloadLevel> _level { StreamOverloadLevel::Normal };
+	std::atomic<int64_t> _queue_delay { 0 };
+	std::atomic<uint64_t> _level_up_count { 0 };
+	std::atomic<uint64_t> _dropped_frame_count { 0 };
+	std::atomic<uint32_t> _suspended_rendition_count { 0 };
+};
+
+// Degradation of all the streams which are transcoded
+// (The transcoder removes it when the stream is deleted)
+class StreamOverload : public ov::Singleton<StreamOverload>
+{
+public:
+	friend class ov::Singleton<StreamOverload>;
+
+	// Created when it is requested first
+	std::shared_ptr<StreamOverloadStatistics> GetStatistics(info::application_id_t application_id, const ov::String &application_name, const ov::String &stream_name);
+	void RemoveStatistics(info::application_id_t application_id, const ov::String &stream_name);
+
+	void GetAllStatistics(std::vector<std::shared_ptr<StreamOverloadStatistics>> &statistics_list) const;
+
+protected:
+	StreamOverload() = default;
+
+	typedef std::pair<info::application_id_t, ov::String> StreamKey;
+
+	mutable std::mutex _mutex;
+	std::map<StreamKey, std::shared_ptr<StreamOverloadStatistics>> _statistics_map;
+};
@@ -0,0 +1,297 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "stream_qoe.h"
+
+#include <chrono>
+
+namespace
+{
+	// The sessions which are sampled are spread over the ids/addresses (Fibonacci hashing)
+	uint64_t MixHash(uint64_t value)
+	{
+		return (value * 0x9E3779B97F4A7C15ULL) >> 32;
+	}
+
+	// FNV-1a
+	uint64_t HashString(const ov::String &value)
+	{
+		uint64_t hash = 0xCBF29CE484222325ULL;
+
+		for(size_t index = 0; index < value.GetLength(); index++)
+		{
+			hash ^= static_cast<uint8_t>(value[index]);
+			hash *= 0x100000001B3ULL;
+		}
+
+		return hash;
+	}
+}
+
+StreamQoeStatistics::StreamQoeStatistics(const ov::String &application_name, const ov::String &stream_name, const cfg::Qoe &config)
+	: _application_name(application_name),
+	  _stream_name(stream_name)
+{
+	float sample_percent = std::min(std::max(config.GetSamplePercent(), 0.0f), 100.0f);
+
+	_sample_threshold = static_cast<uint32_t>(sample_percent * 100.0f);
+	_max_sampled_sessions = static_cast<size_t>(std::max(config.GetMaxSampledSessions(), 0));
+	_session_timeout = static_cast<int64_t>(std::max(config.GetSessionTimeout(), 1)) * 1000;
+}
+
+const char *StreamQoeStatistics::GetMetricName(StreamQoeMetric metric)
+{
+	switch(metric)
+	{
+		case StreamQoeMetric::Loss:
+			return "loss";
+		case StreamQoeMetric::Jitter:
+			return "jitter";
+		case StreamQoeMetric::Rtt:
+			return "rtt";
+		case StreamQoeMetric::Download:
+			return "download";
+		case StreamQoeMetric::RequestInterval:
+			return "request_interval";
+		case StreamQoeMetric::Rebuffer:
+			return "rebuffer";
+		case StreamQoeMetric::NumberOfMetrics:
+			break;
+	}
+
+	return "unknown";
+}
+
+void StreamQoeStatistics::OnReceiverReport(uint32_t session_id, uint8_t fraction_lost, int32_t packet_lost, int64_t jitter, int64_t rtt)
+{
+	uint32_t loss = static_cast<uint32_t>(fraction_lost) * 1000 / 256;
+
+	_report_count.fetch_add(1, std::memory_order_relaxed);
+
+	_histograms[static_cast<int>(StreamQoeMetric::Loss)].Record(loss);
+
+	if(jitter >= 0)
+	{
+		_histograms[static_cast<int>(StreamQoeMetric::Jitter)].Record(jitter);
+	}
+
+	if(rtt >= 0)
+	{
+		_histograms[static_cast<int>(StreamQoeMetric::Rtt)].Record(rtt);
+	}
+
+	if(IsSampled(MixHash(session_id)) == false)
+	{
+		return;
+	}
+
+	auto current_time = GetCurrentMilliseconds();
+
+	std::lock_guard<std::mutex> lock(_session_mutex);
+
+	auto session = GetSampledSession(ov::String::FormatString("webrtc/%u", session_id), current_time);
+
+	if(session == nullptr)
+	{
+		return;
+	}
+
+	session->report_count++;
+	session->loss = loss;
+	session->packet_lost = packet_lost;
+
+	if(jitter >= 0)
+	{
+		session->jitter = jitter;
+	}
+
+	if(rtt >= 0)
+	{
+		session->rtt = rtt;
+	}
+}
+
+void StreamQoeStatistics::OnSegmentRequest(const char *protocol, const ov::String &player, const ov::String &segment, int64_t duration, int64_t download_time)
+{
+	_request_count.fetch_add(1, std::memory_order_relaxed);
+
+	_histograms[static_cast<int>(StreamQoeMetric::Download)].Record(download_time);
+
+	if(IsSampled(MixHash(HashString(player))) == false)
+	{
+		return;
+	}
+
+	auto current_time = GetCurrentMilliseconds();
+
+	std::lock_guard<std::mutex> lock(_session_mutex);
+
+	auto session = GetSampledSession(ov::String::FormatString("%s/%s", protocol, player.CStr()), current_time);
+
+	if(session == nullptr)
+	{
+		return;
+	}
+
+	session->request_count++;
+	session->download_time = download_time;
+
+	// The retries and the ranges of the same segment, the audio of DASH (duration: 0)
+	if((duration <= 0) || (segment == session->last_segment))
+	{
+		return;
+	}
+
+	int64_t now = current_time * 1000;
+
+	if(session->last_segment.IsEmpty())
+	{
+		session->play_start_time = now;
+	}
+	else
+	{
+		_histograms[static_cast<int>(StreamQoeMetric::RequestInterval)].Record(now - session->last_request_time);
+
+		// The segment is received after the player has played all the received segments
+		int64_t stall = (now - session->play_start_time) - session->received_duration;
+
+		if(stall > 0)
+		{
+			session->rebuffer_count++;
+			session->rebuffer_time += stall;
+			_histograms[static_cast<int>(StreamQoeMetric::Rebuffer)].Record(stall);
+
+			// The playback is resumed with this segment
+			session->play_start_time += stall;
+		}
+	}
+
+	session->last_segment = segment;
+	session->last_request_time = now;
+	session->received_duration += duration;
+}
+
+bool StreamQoeStatistics::IsSampled(uint64_t hash) const
+{
+	return (hash % 10000) < _sample_threshold;
+}
+
+StreamQoeSession *StreamQoeStatistics::GetSampledSession(const ov::String &key, int64_t current_time)
+{
+	RemoveExpiredSessions(current_time);
+
+	auto item = _sessions.find(key);
+
+	if(item == _sessions.end())
+	{
+		if(_sessions.size() >= _max_sampled_sessions)
+		{
+			_skipped_session_count.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		StreamQoeSession session;
+
+		session.key = key;
+		session.start_time = time(nullptr);
+
+		item = _sessions.emplace(key, session).first;
+	}
+
+	item->second.last_update_time = current_time;
+
+	return &(item->second);
+}
+
+void StreamQoeStatistics::RemoveExpiredSessions(int64_t current_time)
+{
+	// At most once per second
+	if((current_time - _last_expire_time) < 1000)
+	{
+		return;
+	}
+
+	_last_expire_time = current_time;
+
+	for(auto item = _sessions.begin(); item != _sessions.end();)
+	{
+		if((current_time - item->second.last_update_time) > _session_timeout)
+		{
+			item = _sessions.erase(item);
+		}
+		else
+		{
+			++item;
+		}
+	}
+}
+
+void StreamQoeStatistics::GetSampledSessions(std::vector<StreamQoeSession> &sessions)
+{
+	std::lock_guard<std::mutex> lock(_session_mutex);
+
+	RemoveExpiredSessions(GetCurrentMilliseconds());
+
+	for(const auto &item : _sessions)
+	{
+		sessions.push_back(item.second);
+	}
+}
+
+size_t StreamQoeStatistics::GetSampledSessionCount()
+{
+	std::lock_guard<std::mutex> lock(_session_mutex);
+
+	RemoveExpiredSessions(GetCurrentMilliseconds());
+
+	return _sessions.size();
+}
+
+int64_t StreamQoeStatistics::GetCurrentMilliseconds()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::shared_ptr<StreamQoeStatistics> StreamQoe::GetStatistics(const info::Application &application_info, const ov::String &stream_name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto &statistics = _statistics_map[std::make_pair(application_info.GetName(), stream_name)];
+
+	if(statistics == nullptr)
+	{
+		statistics = std::make_shared<StreamQoeStatistics>(application_info.GetName(), stream_name, application_info.GetQoe());
+	}
+
+	return statistics;
+}
+
+std::shared_ptr<StreamQoeStatistics> StreamQoe::FindStatistics(const ov::String &application_name, const ov::String &stream_name) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto item = _statistics_map.find(std::make_pair(application_name, stream_name));
+
+	return (item != _statistics_map.end()) ? item->second : nullptr;
+}
+
+void StreamQoe::RemoveStatistics(const ov::String &application_name, const ov::String &stream_name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_statistics_map.erase(std::make_pair(application_name, stream_name));
+}
+
+void StreamQoe::GetAllStatistics(std::vector<std::shared_ptr<StreamQoeStatistics>> &statistics_list) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for(auto &item : _statistics_map)
+	{
+		statistics_list.push_back(item.second);
+	}
+}
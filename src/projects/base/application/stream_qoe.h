@@ -0,0 +1,174 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include "application.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Quality of experience of the players which is measured for each stream
+enum class StreamQoeMetric : uint8_t
+{
+	// From the RTCP receiver reports of the WebRTC players (RtpRtcp)
+	// - Fraction lost of the report block (per mille)
+	Loss,
+	// - Interarrival jitter (microseconds, not recorded if the clock rate of the SSRC is unknown)
+	Jitter,
+	// - Round trip time by LSR/DLSR (microseconds, not recorded if the player doesn't report them)
+	Rtt,
+	// From the segment requests of the HLS/DASH players (SegmentStreamServer)
+	// - Time until the socket has written the whole segment to the kernel (microseconds, from the lookup of the
+	//   segment, the chunked transfer is not recorded)
+	Download,
+	// - Interval between the requests of the next segments (microseconds, sampled players only)
+	RequestInterval,
+	// - Estimated stall: the player has played more than it has received (microseconds, sampled players only)
+	Rebuffer,
+
+	NumberOfMetrics
+};
+
+// Details of a sampled session
+struct StreamQoeSession
+{
+	// "webrtc/<session id>" or "<hls|dash>/<address of the player>"
+	ov::String key;
+	time_t start_time = 0;
+	// ms (monotonic)
+	int64_t last_update_time = 0;
+
+	// RTCP receiver reports (the last report block)
+	uint64_t report_count = 0;
+	uint32_t loss = 0;
+	int32_t packet_lost = 0;
+	int64_t jitter = 0;
+	int64_t rtt = 0;
+
+	// Segment requests
+	uint64_t request_count = 0;
+	int64_t download_time = 0;
+	uint64_t rebuffer_count = 0;
+	int64_t rebuffer_time = 0;
+
+	// Rebuffer estimation (microseconds): the player should have played (now - play_start_time) of received_duration
+	ov::String last_segment;
+	int64_t last_request_time = 0;
+	int64_t play_start_time = 0;
+	int64_t received_duration = 0;
+};
+
+// QoE of a stream
+//
+// - All sessions record the histograms without the lock (a report or a request, not a packet)
+// - The details are kept only for the sampled sessions (selected by the hash of the key, so a session is
+//   sampled or not through its lifetime), so the cost doesn't grow with the sessions
+class StreamQoeStatistics
+{
+public:
+	StreamQoeStatistics(const ov::String &application_name, const ov::String &stream_name, const cfg::Qoe &config);
+
+	// Report block of a RTCP RR (jitter/rtt: microseconds, < 0: unknown)
+	void OnReceiverReport(uint32_t session_id, uint8_t fraction_lost, int32_t packet_lost, int64_t jitter, int64_t rtt);
+	// A segment has been sent (duration: microseconds of the media, 0 if the segment is not counted for the rebuffer)
+	void OnSegmentRequest(const char *protocol, const ov::String &player, const ov::String &segment, int64_t duration, int64_t download_time);
+
+	const ov::LatencyHistogram &GetHistogram(StreamQoeMetric metric) const
+	{
+		return _histograms[static_cast<int>(metric)];
+	}
+
+	uint64_t GetReportCount() const
+	{
+		return _report_count;
+	}
+
+	uint64_t GetRequestCount() const
+	{
+		return _request_count;
+	}
+
+	// Sessions which are not sampled because of MaxSampledSessions
+	uint64_t GetSkippedSessionCount() const
+	{
+		return _skipped_session_count;
+	}
+
+	// Copies the sampled sessions (the expired sessions are removed)
+	void GetSampledSessions(std::vector<StreamQoeSession> &sessions);
+	size_t GetSampledSessionCount();
+
+	const ov::String &GetApplicationName() const
+	{
+		return _application_name;
+	}
+
+	const ov::String &GetStreamName() const
+	{
+		return _stream_name;
+	}
+
+	static const char *GetMetricName(StreamQoeMetric metric);
+
+protected:
+	bool IsSampled(uint64_t hash) const;
+	// Returns the sampled session of the key (nullptr if it is not sampled), _session_mutex must be locked
+	StreamQoeSession *GetSampledSession(const ov::String &key, int64_t current_time);
+	// _session_mutex must be locked
+	void RemoveExpiredSessions(int64_t current_time);
+
+	static int64_t GetCurrentMilliseconds();
+
+	ov::String _application_name;
+	ov::String _stream_name;
+
+	// 1/10000 of the sessions
+	uint32_t _sample_threshold = 0;
+	size_t _max_sampled_sessions = 0;
+	// ms
+	int64_t _session_timeout = 0;
+
+	ov::LatencyHistogram _histograms[static_cast<int>(StreamQoeMetric::NumberOfMetrics)];
+
+	std::atomic<uint64_t> _report_count { 0 };
+	std::atomic<uint64_t> _request_count { 0 };
+	std::atomic<uint64_t> _skipped_session_count { 0 };
+
+	std::mutex _session_mutex;
+	std::map<ov::String, StreamQoeSession> _sessions;
+	int64_t _last_expire_time = 0;
+};
+
+// QoE of all the streams, the publishers find the statistics of a stream by the name
+// (The stream is removed by MediaRouter when it is deleted, the publishers may keep the statistics until they are deleted)
+class StreamQoe : public ov::Singleton<StreamQoe>
+{
+public:
+	friend class ov::Singleton<StreamQoe>;
+
+	// Created when it is requested first
+	std::shared_ptr<StreamQoeStatistics> GetStatistics(const info::Application &application_info, const ov::String &stream_name);
+	// nullptr if no publisher has created it
+	std::shared_ptr<StreamQoeStatistics> FindStatistics(const ov::String &application_name, const ov::String &stream_name) const;
+	void RemoveStatistics(const ov::String &application_name, const ov::String &stream_name);
+
+	void GetAllStatistics(std::vector<std::shared_ptr<StreamQoeStatistics>> &statistics_list) const;
+
+protected:
+	StreamQoe() = default;
+
+	typedef std::pair<ov::String, ov::String> StreamKey;
+
+	mutable std::mutex _mutex;
+	std::map<StreamKey, std::shared_ptr<StreamQoeStatistics>> _statistics_map;
+};
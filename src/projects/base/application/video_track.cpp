@@ -38,3 +38,33 @@ int32_t VideoTrack::GetHeight()
 	return _height;
 }
 
+void VideoTrack::SetTemporalLayerCount(uint8_t count)
+{
+	_temporal_layer_count = count;
+}
+
+uint8_t VideoTrack::GetTemporalLayerCount() const
+{
+	return _temporal_layer_count;
+}
+
+int VideoTrack::GetTemporalLayerBitrateRatio(uint8_t layer_count, uint8_t layer)
+{
+	if(layer + 1 >= layer_count)
+	{
+		return 100;
+	}
+
+	switch(layer_count)
+	{
+		case 2:
+			return 60;
+
+		case 3:
+			return (layer == 0) ? 40 : 60;
+
+		default:
+			return 100;
+	}
+}
+
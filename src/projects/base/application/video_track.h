@@ -22,8 +22,16 @@ public:
 	void SetHeight(int32_t height);
 	int32_t GetHeight();
 
+	// Temporal layers of the encoded video (1: no layer)
+	void SetTemporalLayerCount(uint8_t count);
+	uint8_t GetTemporalLayerCount() const;
+
+	// Percent of the bitrate used by the temporal layers up to the layer (the encoders split the bitrate by it)
+	static int GetTemporalLayerBitrateRatio(uint8_t layer_count, uint8_t layer);
+
 protected:
 	double _framerate;
 	int32_t _width;
 	int32_t _height;
+	uint8_t _temporal_layer_count = 1;
 };
@@ -39,7 +39,7 @@ public:
 	size_t fragmentation_length[MAX_FRAG_COUNT] {};
 	// Timestamp difference relative "now" for each fragmentation
 	uint16_t fragmentation_time_diff[MAX_FRAG_COUNT] {};
-	// Payload type of each fragmentation
+	// Payload type of each fragmentation (NAL unit type for H264)
 	uint8_t fragmentation_pl_type[MAX_FRAG_COUNT] {};
 
 	void VerifyAndAllocateFragmentationHeader(const size_t size) {
@@ -76,6 +76,9 @@ public:
 	}
 };
 
+// base/media_route/media_bitstream.h
+class VideoBitstream;
+
 struct EncodedFrame
 {
 public:
@@ -94,6 +97,9 @@ public:
 	size_t _length = 0;
 	size_t _size = 0;
 	bool _complete_frame = false;
+
+	// NAL index/AVCC form of the H.264/H.265 frame, which is shared by the publishers (nullptr if it is not provided)
+	std::shared_ptr<VideoBitstream> _bitstream;
 };
 
 struct CodecSpecificInfoGeneric
@@ -170,3 +176,18 @@ struct CodecSpecificInfo
 	const char *codec_name = nullptr;
 	CodecSpecificInfoUnion codec_specific = { 0 };
 };
+
+// A frame which is delivered to the publishers, the frame, the codec info and the fragmentation are in one allocation
+struct EncodedFrameDescriptor
+{
+public:
+	EncodedFrameDescriptor(std::shared_ptr<ov::Data> buffer, size_t length)
+		: encoded_frame(std::move(buffer), length, 0)
+	{
+	}
+
+	EncodedFrame encoded_frame;
+	// codec_type is CodecType::Unknown if the codec doesn't need it
+	CodecSpecificInfo codec_info;
+	FragmentationHeader fragmentation;
+};
@@ -0,0 +1,130 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "media_type.h"
+
+// Length of the NAL unit size field of the AVCC (ISO/IEC 14496-15) samples
+#define VIDEO_BITSTREAM_AVCC_LENGTH_SIZE		4
+
+// Forms of a video frame (H.264/H.265) which are shared by the publishers of the stream
+//
+// - The Annex-B bitstream is the original data of the MediaPacket
+// - The NAL index and the AVCC form are made when they are requested first, and at most once
+// - It is immutable after it is made, so several publishers (threads) can use it at the same time
+class VideoBitstream
+{
+public:
+	VideoBitstream(common::MediaCodecId codec_id, const std::shared_ptr<ov::Data> &annexb)
+		: _codec_id(codec_id),
+		  _annexb(annexb)
+	{
+	}
+
+	common::MediaCodecId GetCodecId() const noexcept
+	{
+		return _codec_id;
+	}
+
+	const std::shared_ptr<ov::Data> &GetAnnexB() const noexcept
+	{
+		return _annexb;
+	}
+
+	// NAL units of the Annex-B bitstream (the offsets are relative to GetAnnexB())
+	const std::vector<ov::NalUnit> &GetNalUnits()
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		MakeNalUnits();
+
+		return _nal_units;
+	}
+
+	// Length-prefixed NAL units (the parameter sets and the AUDs are excluded, they are in the initialization segment)
+	std::shared_ptr<ov::Data> GetAvcc()
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		if(_avcc != nullptr)
+		{
+			return _avcc;
+		}
+
+		MakeNalUnits();
+
+		size_t avcc_length = 0;
+
+		for(auto &nal_unit : _nal_units)
+		{
+			if(IsParameterSet(nal_unit) == false)
+			{
+				avcc_length += VIDEO_BITSTREAM_AVCC_LENGTH_SIZE + nal_unit.length;
+			}
+		}
+
+		auto avcc = std::make_shared<ov::Data>(avcc_length);
+		auto buffer = _annexb->GetDataAs<uint8_t>();
+
+		for(auto &nal_unit : _nal_units)
+		{
+			if(IsParameterSet(nal_unit))
+			{
+				continue;
+			}
+
+			uint32_t length = ov::HostToBE32(static_cast<uint32_t>(nal_unit.length));
+
+			avcc->Append(&length, sizeof(length));
+			avcc->Append(buffer + nal_unit.offset, nal_unit.length);
+		}
+
+		_avcc = avcc;
+
+		return _avcc;
+	}
+
+protected:
+	// _mutex must be locked
+	void MakeNalUnits()
+	{
+		if(_nal_units_made == false)
+		{
+			_nal_units = ov::SplitNalUnits(_annexb->GetDataAs<uint8_t>(), _annexb->GetLength());
+			_nal_units_made = true;
+		}
+	}
+
+	bool IsParameterSet(const ov::NalUnit &nal_unit) const
+	{
+		if(_codec_id == common::MediaCodecId::H265)
+		{
+			// VPS(32), SPS(33), PPS(34), AUD(35)
+			uint8_t type = (nal_unit.header >> 1) & 0x3F;
+			return (type >= 32) && (type <= 35);
+		}
+
+		// SPS(7), PPS(8), AUD(9)
+		uint8_t type = nal_unit.header & 0x1F;
+		return (type >= 7) && (type <= 9);
+	}
+
+	common::MediaCodecId _codec_id;
+	std::shared_ptr<ov::Data> _annexb;
+
+	std::mutex _mutex;
+
+	bool _nal_units_made = false;
+	std::vector<ov::NalUnit> _nal_units;
+
+	std::shared_ptr<ov::Data> _avcc;
+};
@@ -14,10 +14,16 @@
 #include <cstdint>
 #include <vector>
 #include <map>
+#include <memory>
 
 #include "media_type.h"
+#include "media_bitstream.h"
 #include "base/common_types.h"
 
+// Space reserved in front of the payload, so that the bitstream filters can prepend the headers without moving the payload
+// (e.g. 2 bytes of the FLV AAC header are replaced by 7 bytes of the ADTS header)
+#define MEDIA_PACKET_HEADROOM		16
+
 enum class MediaPacketFlag : uint8_t
 {
 	NoFlag,
@@ -34,6 +40,7 @@ public:
 		  _flags(flags),
 		  _cts(cts)
 	{
+		_data->ReserveHeadroom(MEDIA_PACKET_HEADROOM, data_size);
 		_data->Append(data, data_size);
 	}
 
@@ -47,6 +54,17 @@ public:
 		_data->Append(data.get());
 	}
 
+	// Takes the data without copying it (e.g. a buffer which is assembled by the relay client)
+	MediaPacket(common::MediaType media_type, int32_t track_id, std::shared_ptr<ov::Data> &&data, int64_t pts, MediaPacketFlag flags, int64_t cts = 0)
+		: _media_type(media_type),
+		  _track_id(track_id),
+		  _data(std::move(data)),
+		  _pts(pts),
+		  _flags(flags),
+		  _cts(cts)
+	{
+	}
+
 	common::MediaType GetMediaType() const noexcept
 	{
 		return _media_type;
@@ -67,6 +85,11 @@ public:
 		return _pts;
 	}
 
+	void SetPts(int64_t pts)
+	{
+		_pts = pts;
+	}
+
 	int32_t GetTrackId() const noexcept
 	{
 		return _track_id;
@@ -92,6 +115,50 @@ public:
         _cts = cts;
     }
 
+	// Monotonic time (ov::LatencyHistogram::GetCurrentMicroseconds()) when the packet is received by the provider (0: unknown)
+	int64_t GetIngestTime() const noexcept
+	{
+		return _ingest_time;
+	}
+
+	void SetIngestTime(int64_t ingest_time)
+	{
+		_ingest_time = ingest_time;
+	}
+
+	// Monotonic time when the packet is queued to the current stage (e.g. MediaRouteStream)
+	int64_t GetQueuedTime() const noexcept
+	{
+		return _queued_time;
+	}
+
+	void SetQueuedTime(int64_t queued_time)
+	{
+		_queued_time = queued_time;
+	}
+
+	// Flow of ov::Tracer which the packet belongs to (0: not traced)
+	uint64_t GetTraceId() const noexcept
+	{
+		return _trace_id;
+	}
+
+	void SetTraceId(uint64_t trace_id)
+	{
+		_trace_id = trace_id;
+	}
+
+	// Temporal layer of the video frame (0: the base layer, the frames of the upper layers can be dropped)
+	uint8_t GetTemporalLayer() const noexcept
+	{
+		return _temporal_layer;
+	}
+
+	void SetTemporalLayer(uint8_t temporal_layer)
+	{
+		_temporal_layer = temporal_layer;
+	}
+
 	std::unique_ptr<FragmentationHeader> _frag_hdr = std::make_unique<FragmentationHeader>();
 
 	std::unique_ptr<MediaPacket> ClonePacket()
@@ -105,9 +172,51 @@ public:
             GetCts()
 		);
 		::memcpy(packet->_frag_hdr.get(), _frag_hdr.get(), sizeof(FragmentationHeader));
+		packet->_ingest_time = _ingest_time;
+		packet->_trace_id = _trace_id;
+		packet->_temporal_layer = _temporal_layer;
 		return packet;
 	}
 
+	// Unlike ClonePacket(), the data is not copied but shared with this packet (e.g. the router passes a packet to several observers)
+	// - The data must be treated as immutable by both of the packets
+	std::unique_ptr<MediaPacket> SharePacket()
+	{
+		auto data = _data;
+
+		auto packet = std::make_unique<MediaPacket>(
+			GetMediaType(),
+			GetTrackId(),
+			std::move(data),
+			GetPts(),
+			GetFlags(),
+			GetCts()
+		);
+		::memcpy(packet->_frag_hdr.get(), _frag_hdr.get(), sizeof(FragmentationHeader));
+		packet->_ingest_time = _ingest_time;
+		packet->_trace_id = _trace_id;
+		packet->_temporal_layer = _temporal_layer;
+
+		std::lock_guard<std::mutex> lock_guard(_bitstream_mutex);
+		packet->_bitstream = _bitstream;
+
+		return packet;
+	}
+
+	// Shared by the publishers of the packet, the conversions are done at most once per packet
+	// (The data must not be modified after it is called)
+	std::shared_ptr<VideoBitstream> GetVideoBitstream(common::MediaCodecId codec_id)
+	{
+		std::lock_guard<std::mutex> lock_guard(_bitstream_mutex);
+
+		if(_bitstream == nullptr)
+		{
+			_bitstream = std::make_shared<VideoBitstream>(codec_id, _data);
+		}
+
+		return _bitstream;
+	}
+
 protected:
 	common::MediaType _media_type = common::MediaType::Unknown;
 	int32_t _track_id = -1;
@@ -117,6 +226,14 @@ protected:
 	int64_t _pts = -1;
 	MediaPacketFlag _flags = MediaPacketFlag::NoFlag;
     int64_t _cts = 0; // cts = pts - dts
+
+	int64_t _ingest_time = 0;
+	int64_t _queued_time = 0;
+	uint64_t _trace_id = 0;
+	uint8_t _temporal_layer = 0;
+
+	std::mutex _bitstream_mutex;
+	std::shared_ptr<VideoBitstream> _bitstream;
 };
 
 class MediaFrame
@@ -272,6 +389,17 @@ public:
 		_pts = pts;
 	}
 
+	// Flow of ov::Tracer which the frame belongs to (0: not traced)
+	uint64_t GetTraceId() const noexcept
+	{
+		return _trace_id;
+	}
+
+	void SetTraceId(uint64_t trace_id)
+	{
+		_trace_id = trace_id;
+	}
+
 	void SetOffset(size_t offset)
 	{
 		_offset = offset;
@@ -424,17 +552,50 @@ public:
 		return _flags;
 	}
 
+	// Reference of the decoded picture (AVFrame of the transcoder, in the system memory or in the memory of the hardware device)
+	// If it is set, the planes are empty and the picture is passed between the decoder, the filter and the encoder without copying
+	void SetNativeFrame(std::shared_ptr<void> frame)
+	{
+		_native_frame = std::move(frame);
+	}
+
+	const std::shared_ptr<void> &GetNativeFrame() const
+	{
+		return _native_frame;
+	}
+
+	// Bytes of the planes (a native video frame is estimated as YUV 4:2:0, and it is counted for each reference)
+	size_t GetMemoryUsage() const
+	{
+		size_t memory_usage = 0;
+
+		for(const auto &item : _data_buffer)
+		{
+			memory_usage += item.second.capacity();
+		}
+
+		if((memory_usage == 0) && (_native_frame != nullptr) && (_width > 0) && (_height > 0))
+		{
+			memory_usage = static_cast<size_t>(_width) * static_cast<size_t>(_height) * 3 / 2;
+		}
+
+		return memory_usage;
+	}
+
 	// This function should only be called before filtering (_track_id 0, 1)
 	std::unique_ptr<MediaFrame> CloneFrame()
 	{
 		auto frame = std::make_unique<MediaFrame>();
 
+		frame->SetTraceId(_trace_id);
+
 		if(_track_id == (int32_t)common::MediaType::Video)
 		{
 			frame->SetWidth(_width);
 			frame->SetHeight(_height);
 			frame->SetFormat(_format);
 			frame->SetPts(_pts);
+			frame->SetNativeFrame(_native_frame);
 
 			for(int i = 0; i < 3; ++i)
 			{
@@ -490,6 +651,7 @@ private:
 	// 공통 시간 정보
 	int64_t _pts = 0LL;
 	size_t _offset = 0;
+	uint64_t _trace_id = 0;
 
 	std::map<int32_t, int32_t> _stride;
 
@@ -506,4 +668,6 @@ private:
 	int32_t _sample_rate = 0;
 
 	int32_t _flags = 0;    // Key, non-Key
+
+	std::shared_ptr<void> _native_frame;
 };
@@ -9,114 +9,314 @@
 //
 //==============================================================================
 
-#include <queue>
-#include <thread>
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// Default number of items that can be stored in a MediaQueue (rounded up to the power of 2)
+#define MEDIA_QUEUE_DEFAULT_CAPACITY		4096
+// A warning is printed every MEDIA_QUEUE_DROP_LOG_INTERVAL drops
+#define MEDIA_QUEUE_DROP_LOG_INTERVAL		100
+
+// Bounded lock-free multi-producer/single-consumer queue
+//
+// - push() can be called by multiple threads at the same time, pop() must be called by only one thread
+// - If the queue is full, push() drops the item and returns false
+// - The consumer sleeps using condition variable (default) or futex, and producers wake it up only when it is sleeping
 template<typename T>
 class MediaQueue
 {
 public:
+	enum class WakeupMode
+	{
+		Condition,
+		Futex
+	};
 
-	MediaQueue()
+	explicit MediaQueue(size_t capacity = MEDIA_QUEUE_DEFAULT_CAPACITY, WakeupMode wakeup_mode = WakeupMode::Condition)
+		: _wakeup_mode(wakeup_mode)
 	{
+		size_t cell_count = 2;
+
+		while(cell_count < capacity)
+		{
+			cell_count <<= 1;
+		}
+
+		_mask = cell_count - 1;
+		_cells = std::make_unique<Cell[]>(cell_count);
+
+		for(size_t index = 0; index < cell_count; index++)
+		{
+			_cells[index].sequence.store(index, std::memory_order_relaxed);
+		}
+
 		_abort = false;
 	}
 
+	void SetAlias(const ov::String &alias)
+	{
+		_alias = alias;
+	}
+
 	T pop()
 	{
-		if(_abort)
-		{
-			return static_cast<T>(nullptr);
-		}
+		T item = static_cast<T>(nullptr);
 
-		std::unique_lock<std::mutex> mlock(_mutex);
-		while(_queue.empty())
+		while(TryPop(item) == false)
 		{
-			_cond.wait(mlock);
-
 			if(_abort)
 			{
 				return static_cast<T>(nullptr);
 			}
-		}
 
-		auto item = _queue.front();
-		_queue.pop();
+			Sleep();
+		}
 
 		return item;
 	}
 
 	T pop_unique()
 	{
-		if(_abort)
-		{
-			return static_cast<T>(nullptr);
-		}
+		return pop();
+	}
 
-		std::unique_lock<std::mutex> mlock(_mutex);
-		while(_queue.empty())
+	// Returns false if the queue has been aborted (item is not changed)
+	bool pop(T &item)
+	{
+		while(TryPop(item) == false)
 		{
-			_cond.wait(mlock);
-
 			if(_abort)
 			{
-				return static_cast<T>(nullptr);
+				return false;
 			}
+
+			Sleep();
 		}
 
-		auto item = std::move(_queue.front());
+		return true;
+	}
 
-		_queue.pop();
+	// Returns false immediately if the queue is empty (for the consumers which are not allowed to sleep)
+	bool try_pop(T &item)
+	{
+		return TryPop(item);
+	}
 
-		return item;
+	bool push(const T &item)
+	{
+		T copied_item = item;
+
+		return push(std::move(copied_item));
 	}
 
-	void pop(T &item)
+	bool push(T &&item)
 	{
-		std::unique_lock<std::mutex> mlock(_mutex);
+		Cell *cell = nullptr;
+		size_t position = _enqueue_position.load(std::memory_order_relaxed);
 
-		while(_queue.empty())
+		while(true)
 		{
-			_cond.wait(mlock);
+			cell = &(_cells[position & _mask]);
+
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+			if(diff == 0)
+			{
+				if(_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if(diff < 0)
+			{
+				// The queue is full
+				auto drop_count = ++_drop_count;
+
+				if((drop_count % MEDIA_QUEUE_DROP_LOG_INTERVAL) == 1)
+				{
+					logw("MediaQueue", "Queue%s%s is full (capacity: %zu), %llu items have been dropped",
+					     _alias.IsEmpty() ? "" : " ", _alias.CStr(), _mask + 1, static_cast<unsigned long long>(drop_count));
+				}
+
+				return false;
+			}
+			else
+			{
+				position = _enqueue_position.load(std::memory_order_relaxed);
+			}
 		}
 
-		item = _queue.front();
-		_queue.pop();
+		cell->data = std::move(item);
+		cell->sequence.store(position + 1, std::memory_order_release);
+
+		UpdateHighWaterMark();
+		WakeUp();
+
+		return true;
 	}
 
-	void push(const T &item)
+	size_t size() const
 	{
-		std::unique_lock<std::mutex> mlock(_mutex);
-		_queue.push(item);
-		mlock.unlock();
-		_cond.notify_one();
+		size_t enqueue_position = _enqueue_position.load(std::memory_order_relaxed);
+		size_t dequeue_position = _dequeue_position.load(std::memory_order_relaxed);
+
+		return (enqueue_position > dequeue_position) ? (enqueue_position - dequeue_position) : 0;
 	}
 
-	void push(T &&item)
+	size_t capacity() const
 	{
-		std::unique_lock<std::mutex> mlock(_mutex);
-		_queue.push(std::move(item));
-		mlock.unlock();
-		_cond.notify_one();
+		return _mask + 1;
+	}
+
+	// The largest number of items that have been queued at the same time
+	size_t high_water_mark() const
+	{
+		return _high_water_mark.load(std::memory_order_relaxed);
 	}
 
-	size_t size()
+	uint64_t drop_count() const
 	{
-		return _queue.size();
+		return _drop_count.load(std::memory_order_relaxed);
 	}
 
-	// TODO: Abort
 	void abort()
 	{
 		_abort = true;
-		_cond.notify_one();
+
+		WakeUp(true);
 	}
 
 private:
-	std::queue<T> _queue;
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+	// Called by the consumer only
+	bool TryPop(T &item)
+	{
+		size_t position = _dequeue_position.load(std::memory_order_relaxed);
+		Cell &cell = _cells[position & _mask];
+
+		size_t sequence = cell.sequence.load(std::memory_order_acquire);
+
+		if(static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1) < 0)
+		{
+			// The queue is empty (or the producer has not finished writing yet)
+			return false;
+		}
+
+		item = std::move(cell.data);
+		cell.data = static_cast<T>(nullptr);
+
+		// Make the cell available for the next round
+		cell.sequence.store(position + _mask + 1, std::memory_order_release);
+		_dequeue_position.store(position + 1, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	bool IsReadable() const
+	{
+		size_t position = _dequeue_position.load(std::memory_order_relaxed);
+		size_t sequence = _cells[position & _mask].sequence.load(std::memory_order_acquire);
+
+		return (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1)) >= 0;
+	}
+
+	void Sleep()
+	{
+		if(_wakeup_mode == WakeupMode::Futex)
+		{
+			int futex_value = _futex_word.load(std::memory_order_acquire);
+
+			_sleeping.store(true, std::memory_order_seq_cst);
+			// Pairs with the fence in WakeUp(): the store of _sleeping must not be reordered after the load of IsReadable()
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if((IsReadable() == false) && (_abort == false))
+			{
+				::syscall(SYS_futex, reinterpret_cast<int *>(&_futex_word), FUTEX_WAIT_PRIVATE, futex_value, nullptr, nullptr, 0);
+			}
+
+			_sleeping.store(false, std::memory_order_relaxed);
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		_sleeping.store(true, std::memory_order_seq_cst);
+		// Pairs with the fence in WakeUp() (see above)
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if((IsReadable() == false) && (_abort == false))
+		{
+			_cond.wait(lock);
+		}
+
+		_sleeping.store(false, std::memory_order_relaxed);
+	}
+
+	void WakeUp(bool force = false)
+	{
+		// Pairs with the fence in Sleep(): either the producer sees _sleeping, or the consumer sees the item
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if((force == false) && (_sleeping.load(std::memory_order_seq_cst) == false))
+		{
+			// The consumer is awake, so it will check the queue again
+			return;
+		}
+
+		if(_wakeup_mode == WakeupMode::Futex)
+		{
+			_futex_word.fetch_add(1, std::memory_order_release);
+			::syscall(SYS_futex, reinterpret_cast<int *>(&_futex_word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		_cond.notify_one();
+	}
+
+	void UpdateHighWaterMark()
+	{
+		size_t current_size = size();
+		size_t high_water_mark = _high_water_mark.load(std::memory_order_relaxed);
+
+		while((current_size > high_water_mark) &&
+		      (_high_water_mark.compare_exchange_weak(high_water_mark, current_size, std::memory_order_relaxed) == false))
+		{
+		}
+	}
+
+	std::unique_ptr<Cell[]> _cells;
+	size_t _mask;
+
+	// Producers and the consumer update different positions, so keep them in different cache lines
+	alignas(64) std::atomic<size_t> _enqueue_position { 0 };
+	alignas(64) std::atomic<size_t> _dequeue_position { 0 };
+
+	alignas(64) std::atomic<bool> _sleeping { false };
+	std::atomic<int> _futex_word { 0 };
+	WakeupMode _wakeup_mode;
+
 	std::mutex _mutex;
 	std::condition_variable _cond;
-	bool _abort;
-};
\ No newline at end of file
+	std::atomic<bool> _abort;
+
+	std::atomic<size_t> _high_water_mark { 0 };
+	std::atomic<uint64_t> _drop_count { 0 };
+
+	ov::String _alias;
+};
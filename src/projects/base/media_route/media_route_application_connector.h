@@ -62,6 +62,13 @@ public:
 		return ConnectorType::Provider;
 	}
 
+	// The observers of the stream ask for a key frame of the track (the requests are coalesced by MediaRouteApplication)
+	// - Returns false if the connector cannot make a key frame
+	virtual bool OnKeyFrameRequested(const std::shared_ptr<StreamInfo> &stream_info, int32_t track_id)
+	{
+		return false;
+	}
+
 	////////////////////////////////////////////////////////////////////////////////////////////////
 	// 연동 모듈
 	////////////////////////////////////////////////////////////////////////////////////////////////
@@ -33,7 +33,28 @@ public:
 		return false;
 	}
 
+	// An observer asks for a key frame of the track (e.g. the players lost the packets),
+	// the request is forwarded to the connector which created the stream
+	virtual bool OnRequestKeyFrame(uint32_t stream_id, int32_t track_id)
+	{
+		return false;
+	}
+
 	virtual std::shared_ptr<RelayClient> GetOriginConnector() = 0;
 	virtual const std::map<uint32_t, std::shared_ptr<MediaRouteStream>> GetStreams() const = 0;
+
+	// Lookups which doesn't copy the stream list (called per packet)
+	virtual std::shared_ptr<MediaRouteStream> GetStream(uint32_t stream_id) const
+	{
+		auto streams = GetStreams();
+		auto stream = streams.find(stream_id);
+
+		return (stream != streams.end()) ? stream->second : nullptr;
+	}
+
+	virtual size_t GetStreamCount() const
+	{
+		return GetStreams().size();
+	}
 };
 
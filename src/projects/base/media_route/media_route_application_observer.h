@@ -31,10 +31,10 @@ public:
 	virtual bool OnDeleteStream(std::shared_ptr<StreamInfo> info) = 0;
 
 	// 인코딩 된 비디오 프레임 전달
-	virtual bool OnSendVideoFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrame> encoded_frame, std::unique_ptr<CodecSpecificInfo> codec_info, std::unique_ptr<FragmentationHeader> fragmentation) = 0;
+	virtual bool OnSendVideoFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrameDescriptor> frame) = 0;
 
 	// 인코딩 된 오디오 프레임 전달
-	virtual bool OnSendAudioFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrame> encoded_frame, std::unique_ptr<CodecSpecificInfo> codec_info, std::unique_ptr<FragmentationHeader> fragmentation) = 0;
+	virtual bool OnSendAudioFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrameDescriptor> frame) = 0;
 
 	// Provider 등에서 전달 받은 비디오/오디오 프레임 전달
 	virtual bool OnSendFrame(std::shared_ptr<StreamInfo> info, std::unique_ptr<MediaPacket> packet)
@@ -46,5 +46,40 @@ public:
 	{
 		return ObserverType::Publisher;
 	}
+
+	// MediaRouteApplication -> Key frame request to the connector of the stream (can be called by any thread)
+	inline bool RequestKeyFrame(uint32_t stream_id, int32_t track_id)
+	{
+		auto route_application = std::atomic_load(&_media_route_application);
+
+		if(route_application == nullptr)
+		{
+			return false;
+		}
+
+		return route_application->OnRequestKeyFrame(stream_id, track_id);
+	}
+
+	// The stream of the router (e.g. for the GOP cache), nullptr if the observer is not registered (can be called by any thread)
+	inline std::shared_ptr<MediaRouteStream> GetRouteStream(uint32_t stream_id)
+	{
+		auto route_application = std::atomic_load(&_media_route_application);
+
+		if(route_application == nullptr)
+		{
+			return nullptr;
+		}
+
+		return route_application->GetStream(stream_id);
+	}
+
+	// @see: media_router_application.cpp / MediaRouteApplication::RegisterObserverApp
+	inline void SetMediaRouteApplication(const std::shared_ptr<MediaRouteApplicationInterface> &route_application)
+	{
+		std::atomic_store(&_media_route_application, route_application);
+	}
+
+private:
+	std::shared_ptr<MediaRouteApplicationInterface> _media_route_application;
 };
 
@@ -35,6 +35,7 @@ namespace common
 	{
 		None = 0,
 		H264,
+		H265,
 		Vp8,
 		Vp9,
 		Flv,
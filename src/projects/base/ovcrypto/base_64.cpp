@@ -9,83 +9,78 @@
 #include "base_64.h"
 #include "ovcrypto_private.h"
 
-#include <openssl/bio.h>
-#include <openssl/evp.h>
-#include <openssl/buffer.h>
-
 namespace ov
 {
-	ov::String Base64::Encode(const std::shared_ptr<const Data> &data)
+	namespace
 	{
-		if(data->GetLength() == 0L)
-		{
-			return "";
-		}
-
-		BIO *mem = BIO_new(BIO_s_mem());
-		BIO *b64 = BIO_new(BIO_f_base64());
+		constexpr char encode_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-		BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-
-		// b64의 결과를 mem이 받을 수 있게 함
-		BIO_push(b64, mem);
-
-		// base64 계산
-		int result;
-		int retry = 0;
-
-		while(true)
+		// 0xFF: not a character of base64
+		struct DecodeTable
 		{
-			result = BIO_write(b64, data->GetData(), static_cast<int>(data->GetLength()));
+			uint8_t table[256];
 
-			if(result > 0)
+			constexpr DecodeTable()
+				: table {}
 			{
-				OV_ASSERT2(result == data->GetLength());
-				// 성공
-				break;
-			}
-
-			if(BIO_should_retry(b64))
-			{
-				// 계속 진행
-
-				retry++;
-
-				if(retry == 10)
+				for(int index = 0; index < 256; index++)
 				{
-					// 10회만 재시도 하고 종료
-					OV_ASSERT2(false);
-					break;
+					table[index] = 0xFF;
 				}
 
-				continue;
+				for(int index = 0; index < 64; index++)
+				{
+					table[static_cast<uint8_t>(encode_table[index])] = static_cast<uint8_t>(index);
+				}
 			}
+		};
 
-			// 오류 발생
-			break;
+		constexpr DecodeTable decode_table;
+	}
+
+	// 3 bytes are converted to 4 characters at once, instead of BIO of OpenSSL (which allocates the BIOs for each call)
+	ov::String Base64::Encode(const std::shared_ptr<const Data> &data)
+	{
+		if(data->GetLength() == 0L)
+		{
+			return "";
 		}
 
+		auto source = data->GetDataAs<uint8_t>();
+		size_t length = data->GetLength();
+
 		ov::String base64;
+		base64.SetLength(((length + 2) / 3) * 4);
 
-		if(result > 0)
-		{
-			// 성공
-			BIO_flush(b64);
+		char *destination = base64.GetBuffer();
+		size_t index = 0;
 
-			// 결과값 받음
-			char *buffer;
-			long length = BIO_get_mem_data(mem, &buffer);
+		for(; (index + 3) <= length; index += 3)
+		{
+			uint32_t value = (static_cast<uint32_t>(source[index]) << 16) | (static_cast<uint32_t>(source[index + 1]) << 8) | source[index + 2];
 
-			base64 = ov::String(buffer, length);
+			*destination++ = encode_table[(value >> 18) & 0x3F];
+			*destination++ = encode_table[(value >> 12) & 0x3F];
+			*destination++ = encode_table[(value >> 6) & 0x3F];
+			*destination++ = encode_table[value & 0x3F];
 		}
-		else
+
+		size_t remaining = length - index;
+
+		if(remaining > 0)
 		{
-			// 오류 발생
-			logtw("An error occurred while generate base64");
-			OV_ASSERT2(false);
-		}
+			uint32_t value = static_cast<uint32_t>(source[index]) << 16;
 
-		BIO_free_all(b64);
+			if(remaining == 2)
+			{
+				value |= static_cast<uint32_t>(source[index + 1]) << 8;
+			}
+
+			*destination++ = encode_table[(value >> 18) & 0x3F];
+			*destination++ = encode_table[(value >> 12) & 0x3F];
+			*destination++ = (remaining == 2) ? encode_table[(value >> 6) & 0x3F] : '=';
+			*destination++ = '=';
+		}
 
 		return base64;
 	}
@@ -97,68 +92,74 @@ namespace ov
 			return nullptr;
 		}
 
-		BIO *b64 = BIO_new(BIO_f_base64());
-		BIO *mem = BIO_new_mem_buf(text.CStr(), static_cast<int>(text.GetLength()));
+		auto source = reinterpret_cast<const uint8_t *>(text.CStr());
+		size_t length = text.GetLength();
 
-		BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
+		// The padding is optional
+		while((length > 0) && (source[length - 1] == '='))
+		{
+			length--;
+		}
 
-		// b64의 결과를 mem이 받을 수 있게 함
-		mem = BIO_push(b64, mem);
+		if((length % 4) == 1)
+		{
+			logtw("Invalid length of base64: %zu", text.GetLength());
+			return nullptr;
+		}
 
-		// [base64 문자열 길이 / 4 * 3] + [null 문자] = (length / 4 * 3) + 1
-		auto max_length = static_cast<int>((text.GetLength() / 4 * 3) + 1);
+		const auto &table = decode_table.table;
 
-		auto data = std::make_shared<ov::Data>(max_length);
-		data->SetLength(max_length);
+		auto data = std::make_shared<ov::Data>((length / 4 * 3) + 3);
+		data->SetLength((length / 4 * 3) + (((length % 4) != 0) ? ((length % 4) - 1) : 0));
 
-		// base64 계산
-		int result;
-		int retry = 0;
+		auto destination = data->GetWritableDataAs<uint8_t>();
+		size_t index = 0;
 
-		while(true)
+		for(; (index + 4) <= length; index += 4)
 		{
-			result = BIO_read(b64, data->GetWritableData(), max_length);
+			uint32_t a = table[source[index]];
+			uint32_t b = table[source[index + 1]];
+			uint32_t c = table[source[index + 2]];
+			uint32_t d = table[source[index + 3]];
 
-			if(result > 0)
+			// One of them is 0xFF
+			if((a | b | c | d) & 0x80)
 			{
-				// 성공
-				data->SetLength(result);
-
-				break;
+				logtw("An invalid character of base64 is found at %zu", index);
+				return nullptr;
 			}
 
-			if(BIO_should_retry(b64))
-			{
-				// 계속 진행
+			uint32_t value = (a << 18) | (b << 12) | (c << 6) | d;
 
-				retry++;
+			*destination++ = static_cast<uint8_t>(value >> 16);
+			*destination++ = static_cast<uint8_t>(value >> 8);
+			*destination++ = static_cast<uint8_t>(value);
+		}
 
-				if(retry == 10)
-				{
-					// 10회만 재시도 하고 종료
-					OV_ASSERT2(false);
-					break;
-				}
+		size_t remaining = length - index;
 
-				continue;
+		if(remaining > 0)
+		{
+			uint32_t a = table[source[index]];
+			uint32_t b = table[source[index + 1]];
+			uint32_t c = (remaining == 3) ? table[source[index + 2]] : 0;
+
+			if((a | b | c) & 0x80)
+			{
+				logtw("An invalid character of base64 is found at %zu", index);
+				return nullptr;
 			}
 
-			// 오류 발생
-			break;
-		}
+			uint32_t value = (a << 18) | (b << 12) | (c << 6);
 
-		ov::String base64;
+			*destination++ = static_cast<uint8_t>(value >> 16);
 
-		if(result <= 0)
-		{
-			// 오류 발생
-			logtw("An error occurred while generate base64");
-			OV_ASSERT2(false);
-			data = nullptr;
+			if(remaining == 3)
+			{
+				*destination++ = static_cast<uint8_t>(value >> 8);
+			}
 		}
 
-		BIO_free_all(b64);
-
 		return data;
 	}
 }
@@ -8,55 +8,240 @@
 //==============================================================================
 #include "crc_32.h"
 
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+// The folding kernel is compiled with the target attribute and used only if the CPU supports PCLMULQDQ
+#	define OV_CRC32_USE_PCLMUL
+#	include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+// CRC32X/CRC32B use the same polynomial as RFC1952 (not CRC32C)
+#	define OV_CRC32_USE_ARMV8
+#	include <arm_acle.h>
+#endif
+
+// The buffers which are shorter than this are calculated by the table (the setup of the folding costs more)
+#define OV_CRC32_PCLMUL_MIN_LENGTH		64
+
 namespace ov
 {
-	static unsigned long crc_table[256];
-	static int crc_table_computed = false;
-
-	static void MakeCrcTable()
+	// Slicing-by-8: table[0] is the table of RFC1952, table[n] is the CRC of the byte followed by n zero bytes,
+	// so 8 bytes are processed by 8 lookups at once
+	namespace
 	{
-		unsigned long c;
-
-		int n, k;
-		for(n = 0; n < 256; n++)
+		struct CrcTable
 		{
-			c = (unsigned long)n;
-			for(k = 0; k < 8; k++)
+			uint32_t table[8][256];
+
+			constexpr CrcTable()
+				: table {}
 			{
-				if(c & 1)
+				for(uint32_t n = 0; n < 256; n++)
 				{
-					c = 0xEDB88320L ^ (c >> 1L);
+					uint32_t c = n;
+
+					for(int k = 0; k < 8; k++)
+					{
+						c = (c & 1) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+					}
+
+					table[0][n] = c;
 				}
-				else
+
+				for(uint32_t n = 0; n < 256; n++)
 				{
-					c = c >> 1;
+					for(int slice = 1; slice < 8; slice++)
+					{
+						table[slice][n] = (table[slice - 1][n] >> 8) ^ table[0][table[slice - 1][n] & 0xFF];
+					}
 				}
 			}
-			crc_table[n] = c;
+		};
+
+		// Generated at compile time, so there is nothing to initialize on the first use
+		constexpr CrcTable crc_table;
+
+		// c: the inverted CRC
+		uint32_t UpdateCrcTable(uint32_t c, const uint8_t *buf, ssize_t len)
+		{
+			const auto &table = crc_table.table;
+
+			for(; len >= 8; len -= 8, buf += 8)
+			{
+				uint32_t low = c ^ (static_cast<uint32_t>(buf[0]) | (static_cast<uint32_t>(buf[1]) << 8) | (static_cast<uint32_t>(buf[2]) << 16) | (static_cast<uint32_t>(buf[3]) << 24));
+				uint32_t high = static_cast<uint32_t>(buf[4]) | (static_cast<uint32_t>(buf[5]) << 8) | (static_cast<uint32_t>(buf[6]) << 16) | (static_cast<uint32_t>(buf[7]) << 24);
+
+				c = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+				    table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^ table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+			}
+
+			for(; len > 0; len--, buf++)
+			{
+				c = table[0][(c ^ *buf) & 0xFF] ^ (c >> 8);
+			}
+
+			return c;
 		}
 
-		crc_table_computed = true;
-	}
+#if defined(OV_CRC32_USE_PCLMUL)
+		bool HasPclmul()
+		{
+			static const bool has_pclmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
 
-	static unsigned long UpdateCrc(unsigned long initial, const unsigned char *buf, ssize_t len)
-	{
-		unsigned long c = initial ^0xFFFFFFFFL;
-		ssize_t n;
+			return has_pclmul;
+		}
 
-		if(crc_table_computed == false)
+		// Folds 64 bytes at once by the carry-less multiplications, and reduces the remainder by Barrett reduction
+		// ("Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction", Intel)
+		// - len must be a multiple of 16, and OV_CRC32_PCLMUL_MIN_LENGTH or more
+		__attribute__((target("pclmul,sse4.1")))
+		uint32_t UpdateCrcPclmul(uint32_t c, const uint8_t *buf, ssize_t len)
 		{
-			MakeCrcTable();
+			// Constants of the bit-reflected domain
+			alignas(16) static const uint64_t k1k2[] = {0x0154442bd4ULL, 0x01c6e41596ULL};
+			alignas(16) static const uint64_t k3k4[] = {0x01751997d0ULL, 0x00ccaa009eULL};
+			alignas(16) static const uint64_t k5k0[] = {0x0163cd6124ULL, 0x0000000000ULL};
+			alignas(16) static const uint64_t poly[] = {0x01db710641ULL, 0x01f7011641ULL};
+
+			__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+			x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x00));
+			x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x10));
+			x3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x20));
+			x4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x30));
+
+			x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(c)));
+			x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k1k2));
+
+			buf += 64;
+			len -= 64;
+
+			// Fold 4 blocks in parallel
+			while(len >= 64)
+			{
+				x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+				x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+				x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+				x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+				x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+				x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+				x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+				x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+				x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x00)));
+				x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x10)));
+				x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x20)));
+				x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x30)));
+
+				buf += 64;
+				len -= 64;
+			}
+
+			// Fold into 128 bits
+			x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k3k4));
+
+			x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+			x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+			x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+			// Fold the remaining blocks of 16 bytes
+			while(len >= 16)
+			{
+				x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf));
+
+				x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+				x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+				x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+				buf += 16;
+				len -= 16;
+			}
+
+			// Fold 128 bits into 64 bits
+			x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+			x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+			x1 = _mm_srli_si128(x1, 8);
+			x1 = _mm_xor_si128(x1, x2);
+
+			x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(k5k0));
+
+			x2 = _mm_srli_si128(x1, 4);
+			x1 = _mm_and_si128(x1, x3);
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x1 = _mm_xor_si128(x1, x2);
+
+			// Barrett reduction into 32 bits
+			x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(poly));
+
+			x2 = _mm_and_si128(x1, x3);
+			x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+			x2 = _mm_and_si128(x2, x3);
+			x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+			x1 = _mm_xor_si128(x1, x2);
+
+			return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
 		}
-		for(n = 0; n < len; n++)
+#endif // OV_CRC32_USE_PCLMUL
+
+#if defined(OV_CRC32_USE_ARMV8)
+		uint32_t UpdateCrcArmv8(uint32_t c, const uint8_t *buf, ssize_t len)
 		{
-			c = crc_table[(c ^ buf[n]) & 0xFF] ^ (c >> 8);
+			for(; len >= 8; len -= 8, buf += 8)
+			{
+				uint64_t value;
+				::memcpy(&value, buf, sizeof(value));
+
+				c = __crc32d(c, value);
+			}
+
+			for(; len > 0; len--, buf++)
+			{
+				c = __crc32b(c, *buf);
+			}
+
+			return c;
+		}
+#endif // OV_CRC32_USE_ARMV8
+	}
+
+	static uint32_t UpdateCrc(uint32_t initial, const uint8_t *buf, ssize_t len)
+	{
+		uint32_t c = initial ^ 0xFFFFFFFFU;
+
+#if defined(OV_CRC32_USE_PCLMUL)
+		if((len >= OV_CRC32_PCLMUL_MIN_LENGTH) && HasPclmul())
+		{
+			// The kernel processes the blocks of 16 bytes from the beginning, the remaining bytes are processed by the table
+			ssize_t folded_length = len & ~static_cast<ssize_t>(15);
+
+			c = UpdateCrcPclmul(c, buf, folded_length);
+
+			buf += folded_length;
+			len -= folded_length;
 		}
-		return c ^ 0xFFFFFFFFL;
+
+		c = UpdateCrcTable(c, buf, len);
+#elif defined(OV_CRC32_USE_ARMV8)
+		c = UpdateCrcArmv8(c, buf, len);
+#else
+		c = UpdateCrcTable(c, buf, len);
+#endif
+
+		return c ^ 0xFFFFFFFFU;
 	}
 
 	uint32_t Crc32::Update(uint32_t initial, const void *buffer, ssize_t length)
 	{
-		return static_cast<uint32_t>(UpdateCrc(initial, static_cast<const uint8_t *>(buffer), length));
+		return UpdateCrc(initial, static_cast<const uint8_t *>(buffer), length);
 	}
 
 	uint32_t Crc32::Update(uint32_t initial, const ov::Data *data)
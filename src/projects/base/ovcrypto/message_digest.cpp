@@ -330,4 +330,147 @@ namespace ov
 	{
 		return ComputeDigest(algorithm, input->GetData(), input->GetLength());
 	}
+
+	static const EVP_MD *GetEvpMd(CryptoAlgorithm algorithm)
+	{
+		switch(algorithm)
+		{
+			case CryptoAlgorithm::Md5:
+				return EVP_md5();
+
+			case CryptoAlgorithm::Sha1:
+				return EVP_sha1();
+
+			case CryptoAlgorithm::Sha224:
+				return EVP_sha224();
+
+			case CryptoAlgorithm::Sha256:
+				return EVP_sha256();
+
+			default:
+				// 현재 코드에서는 SHA-256 이하만 처리 가능 (block length: 64)
+				return nullptr;
+		}
+	}
+
+	Hmac::~Hmac()
+	{
+		Destroy();
+	}
+
+	bool Hmac::Create(CryptoAlgorithm algorithm, const void *key, size_t key_length)
+	{
+		Destroy();
+
+		const EVP_MD *md = GetEvpMd(algorithm);
+
+		if(md == nullptr)
+		{
+			logtw("Could not create Hmac for algorithm: %d", algorithm);
+			return false;
+		}
+
+		constexpr unsigned int block_length = 64;
+		uint8_t new_key[block_length] = { 0 };
+
+		if(key_length > block_length)
+		{
+			if(MessageDigest::ComputeDigest(algorithm, key, key_length, new_key, block_length) == false)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			::memcpy(new_key, key, key_length);
+		}
+
+		uint8_t input_pad[block_length];
+		uint8_t output_pad[block_length];
+
+		for(unsigned int index = 0; index < block_length; index++)
+		{
+			input_pad[index] = 0x36 ^ new_key[index];
+			output_pad[index] = 0x5C ^ new_key[index];
+		}
+
+		EVP_MD_CTX *inner_context = EVP_MD_CTX_new();
+		EVP_MD_CTX *outer_context = EVP_MD_CTX_new();
+
+		if((inner_context == nullptr) || (outer_context == nullptr) ||
+		   (EVP_DigestInit_ex(inner_context, md, nullptr) != 1) || (EVP_DigestUpdate(inner_context, input_pad, block_length) != 1) ||
+		   (EVP_DigestInit_ex(outer_context, md, nullptr) != 1) || (EVP_DigestUpdate(outer_context, output_pad, block_length) != 1))
+		{
+			logtw("Could not initialize the contexts of Hmac");
+
+			EVP_MD_CTX_free(inner_context);
+			EVP_MD_CTX_free(outer_context);
+
+			return false;
+		}
+
+		_algorithm = algorithm;
+		_inner_context = inner_context;
+		_outer_context = outer_context;
+
+		return true;
+	}
+
+	void Hmac::Destroy()
+	{
+		if(_inner_context != nullptr)
+		{
+			EVP_MD_CTX_free(static_cast<EVP_MD_CTX *>(_inner_context));
+			_inner_context = nullptr;
+		}
+
+		if(_outer_context != nullptr)
+		{
+			EVP_MD_CTX_free(static_cast<EVP_MD_CTX *>(_outer_context));
+			_outer_context = nullptr;
+		}
+
+		_algorithm = CryptoAlgorithm::Unknown;
+	}
+
+	bool Hmac::Compute(const void *input, size_t input_length, void *output, size_t output_length) const
+	{
+		if(_inner_context == nullptr)
+		{
+			OV_ASSERT(false, "Hmac is not created");
+			return false;
+		}
+
+		unsigned int digest_size = MessageDigest::Size(_algorithm);
+
+		if(output_length < digest_size)
+		{
+			OV_ASSERT(false, "Not enough buffer");
+			return false;
+		}
+
+		// The working context is reused by each thread
+		thread_local std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> context(EVP_MD_CTX_new(), &EVP_MD_CTX_free);
+
+		if(context == nullptr)
+		{
+			return false;
+		}
+
+		uint8_t inner[EVP_MAX_MD_SIZE];
+		unsigned int inner_length = 0;
+		unsigned int final_length = 0;
+
+		bool result =
+			// inner hash
+			(EVP_MD_CTX_copy_ex(context.get(), static_cast<const EVP_MD_CTX *>(_inner_context)) == 1) &&
+			(EVP_DigestUpdate(context.get(), input, input_length) == 1) &&
+			(EVP_DigestFinal_ex(context.get(), inner, &inner_length) == 1) &&
+			// outer hash
+			(EVP_MD_CTX_copy_ex(context.get(), static_cast<const EVP_MD_CTX *>(_outer_context)) == 1) &&
+			(EVP_DigestUpdate(context.get(), inner, inner_length) == 1) &&
+			(EVP_DigestFinal_ex(context.get(), static_cast<unsigned char *>(output), &final_length) == 1);
+
+		return result && (final_length == digest_size);
+	}
 }
@@ -56,4 +56,35 @@ namespace ov
 		// 실제로는 EVP_MD_CTX * 타입. openssl을 외부로 부터 감추기 위해 void *로 선언함
 		void *_context;
 	};
+
+	// HMAC with a fixed key (e.g. the ICE password of a session)
+	//
+	// The padded keys (K XOR ipad, K XOR opad) are digested once in Create(),
+	// so Compute() only copies the states and digests the input (ComputeHmac() derives the key every time)
+	class Hmac
+	{
+	public:
+		Hmac() = default;
+		~Hmac();
+
+		Hmac(const Hmac &) = delete;
+		Hmac &operator =(const Hmac &) = delete;
+
+		bool Create(CryptoAlgorithm algorithm, const void *key, size_t key_length);
+		void Destroy();
+
+		bool IsCreated() const noexcept
+		{
+			return (_inner_context != nullptr);
+		}
+
+		// It can be called from several threads at once (the states are copied to the context of the calling thread)
+		bool Compute(const void *input, size_t input_length, void *output, size_t output_length) const;
+
+	protected:
+		CryptoAlgorithm _algorithm = CryptoAlgorithm::Unknown;
+		// EVP_MD_CTX *
+		void *_inner_context = nullptr;
+		void *_outer_context = nullptr;
+	};
 }
@@ -8,8 +8,33 @@
 //==============================================================================
 #include "tls.h"
 
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <openssl/kdf.h>
+
 #include <utility>
 
+#if defined(__linux__) && defined(__has_include)
+#	if __has_include(<linux/tls.h>)
+#		include <linux/tls.h>
+#	endif
+#endif
+
+// The TLS ULP and the TLS 1.2 AES-GCM offload are available since Linux 4.13
+#if defined(TLS_TX) && defined(TLS_CIPHER_AES_GCM_128)
+#	define OV_KTLS_SUPPORTED                    1
+#	ifndef SOL_TLS
+#		define SOL_TLS                          282
+#	endif
+#	ifndef TCP_ULP
+#		define TCP_ULP                          31
+#	endif
+#else
+#	define OV_KTLS_SUPPORTED                    0
+#endif
+
 #define OV_LOG_TAG "OpenSSL"
 
 #define DO_CALLBACK_IF_AVAILBLE(return_type, default_value, object, callback_name, ...) \
@@ -74,6 +99,25 @@ namespace ov
 		return result;
 	};
 
+	bool Tls::Initialize(const std::shared_ptr<TlsContext> &context, TlsCallback callback)
+	{
+		OV_ASSERT2(context != nullptr);
+		OV_ASSERT2(context->GetSslContext() != nullptr);
+
+		_callback = std::move(callback);
+		_context = context;
+
+		if((PrepareBio() && PrepareSsl(nullptr)) == false)
+		{
+			_callback = TlsCallback();
+			_context = nullptr;
+
+			return false;
+		}
+
+		return true;
+	}
+
 	bool Tls::PrepareSslContext(const SSL_METHOD *method, const std::shared_ptr<Certificate> &certificate, const std::shared_ptr<Certificate> &chain_certificate, const ov::String &cipher_list)
 	{
 		do
@@ -89,22 +133,8 @@ namespace ov
 				break;
 			}
 
-			if(::SSL_CTX_use_certificate(ctx, certificate->GetX509()) != 1)
+			if(TlsContext::UseCertificate(ctx, certificate, chain_certificate) == false)
 			{
-				logte("Cannot use certficate: %s", ov::Error::CreateErrorFromOpenSsl()->ToString().CStr());
-				break;
-			}
-
-			if((chain_certificate != nullptr) && (::SSL_CTX_add1_chain_cert(ctx, chain_certificate->GetX509()) != 1))
-			{
-				logte("Cannot use chain certificate: %s", ov::Error::CreateErrorFromOpenSsl()->ToString().CStr());
-
-				break;
-			}
-
-			if(::SSL_CTX_use_PrivateKey(ctx, certificate->GetPkey()) != 1)
-			{
-				logte("Cannot use private key: %s", ov::Error::CreateErrorFromOpenSsl()->ToString().CStr());
 				break;
 			}
 
@@ -242,11 +272,13 @@ namespace ov
 
 	bool Tls::PrepareSsl(void *app_data)
 	{
-		OV_ASSERT2(_ssl_ctx != nullptr);
+		SSL_CTX *ssl_ctx = (_context != nullptr) ? _context->GetSslContext() : static_cast<SSL_CTX *>(_ssl_ctx);
+
+		OV_ASSERT2(ssl_ctx != nullptr);
 		OV_ASSERT2(_bio != nullptr);
 
 		// SSL 세션 생성
-		decltype(_ssl) ssl(::SSL_new(_ssl_ctx));
+		decltype(_ssl) ssl(::SSL_new(ssl_ctx));
 
 		if(ssl == nullptr)
 		{
@@ -333,6 +365,64 @@ namespace ov
 		return error;
 	}
 
+	int Tls::Connect()
+	{
+		if(_ssl == nullptr)
+		{
+			logte("Ssl is null");
+			return -1;
+		}
+
+		int result = ::SSL_connect(_ssl);
+
+		if(result == 1)
+		{
+			// The TLS/SSL handshake was successfully completed
+			return SSL_ERROR_NONE;
+		}
+
+		int error = GetError(result);
+
+		switch(error)
+		{
+			case SSL_ERROR_WANT_READ:
+			case SSL_ERROR_WANT_WRITE:
+				// The operation did not complete; the same TLS/SSL I/O function should be called again later.
+				break;
+
+			default:
+				logte("An error occurred while connect SSL connection: %s", ov::Error::CreateErrorFromOpenSsl()->ToString().CStr());
+				break;
+		}
+
+		return error;
+	}
+
+	bool Tls::IsSessionReused() const
+	{
+		return (_ssl != nullptr) && (::SSL_session_reused(const_cast<SSL *>(static_cast<const SSL *>(_ssl))) == 1);
+	}
+
+	ov::String Tls::GetSelectedAlpnProtocol() const
+	{
+		if(_ssl == nullptr)
+		{
+			return "";
+		}
+
+		const unsigned char *protocol = nullptr;
+		unsigned int length = 0;
+
+		::SSL_get0_alpn_selected(static_cast<const SSL *>(_ssl), &protocol, &length);
+
+		if((protocol == nullptr) || (length == 0))
+		{
+			return "";
+		}
+
+		return ov::String(reinterpret_cast<const char *>(protocol), length);
+	}
+
 	int Tls::Read(void *buffer, size_t length, size_t *read_bytes)
 	{
 		OV_ASSERT2(_ssl != nullptr);
@@ -581,4 +671,169 @@ namespace ov
 
 		return true;
 	}
+
+#if OV_KTLS_SUPPORTED
+	bool Tls::EnableKernelTlsTx(int socket)
+	{
+		OV_ASSERT2(_ssl != nullptr);
+
+		if(_is_kernel_tls_tx_enabled)
+		{
+			return true;
+		}
+
+		if(::SSL_version(_ssl) != TLS1_2_VERSION)
+		{
+			logtd("[#%d] Kernel TLS is not used: TLS 1.2 is not negotiated", socket);
+			return false;
+		}
+
+		const SSL_CIPHER *cipher = ::SSL_get_current_cipher(_ssl);
+
+		if(cipher == nullptr)
+		{
+			return false;
+		}
+
+		size_t key_len;
+		const EVP_MD *prf_md;
+
+		switch(::SSL_CIPHER_get_id(cipher))
+		{
+			case TLS1_CK_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256:
+			case TLS1_CK_ECDHE_RSA_WITH_AES_128_GCM_SHA256:
+			case TLS1_CK_DHE_RSA_WITH_AES_128_GCM_SHA256:
+			case TLS1_CK_RSA_WITH_AES_128_GCM_SHA256:
+				key_len = 16L;
+				prf_md = ::EVP_sha256();
+				break;
+
+#if defined(TLS_CIPHER_AES_GCM_256)
+			case TLS1_CK_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384:
+			case TLS1_CK_ECDHE_RSA_WITH_AES_256_GCM_SHA384:
+			case TLS1_CK_DHE_RSA_WITH_AES_256_GCM_SHA384:
+			case TLS1_CK_RSA_WITH_AES_256_GCM_SHA384:
+				key_len = 32L;
+				prf_md = ::EVP_sha384();
+				break;
+#endif	// defined(TLS_CIPHER_AES_GCM_256)
+
+			default:
+				logtd("[#%d] Kernel TLS is not used: %s is not supported", socket, ::SSL_CIPHER_get_name(cipher));
+				return false;
+		}
+
+		// RFC 5246 - 6.3. Key Calculation
+		// key_block = PRF(master_secret, "key expansion", server_random + client_random)
+		//   client_write_key[key_len] | server_write_key[key_len] | client_write_IV[4] | server_write_IV[4] (AEAD: no MAC keys)
+		uint8_t master_key[SSL_MAX_MASTER_KEY_LENGTH];
+		uint8_t server_random[SSL3_RANDOM_SIZE];
+		uint8_t client_random[SSL3_RANDOM_SIZE];
+		uint8_t key_block[(32 + 4) * 2];
+
+		size_t master_key_len = ::SSL_SESSION_get_master_key(::SSL_get_session(_ssl), master_key, sizeof(master_key));
+		size_t key_block_len = (key_len + 4) * 2;
+		bool derived = false;
+
+		if(
+			(master_key_len > 0) &&
+			(::SSL_get_server_random(_ssl, server_random, sizeof(server_random)) == sizeof(server_random)) &&
+			(::SSL_get_client_random(_ssl, client_random, sizeof(client_random)) == sizeof(client_random)))
+		{
+			EVP_PKEY_CTX *context = ::EVP_PKEY_CTX_new_id(EVP_PKEY_TLS1_PRF, nullptr);
+
+			derived =
+				(context != nullptr) &&
+				(::EVP_PKEY_derive_init(context) > 0) &&
+				(::EVP_PKEY_CTX_set_tls1_prf_md(context, prf_md) > 0) &&
+				(::EVP_PKEY_CTX_set1_tls1_prf_secret(context, master_key, static_cast<int>(master_key_len)) > 0) &&
+				(::EVP_PKEY_CTX_add1_tls1_prf_seed(context, reinterpret_cast<const unsigned char *>("key expansion"), 13) > 0) &&
+				(::EVP_PKEY_CTX_add1_tls1_prf_seed(context, server_random, sizeof(server_random)) > 0) &&
+				(::EVP_PKEY_CTX_add1_tls1_prf_seed(context, client_random, sizeof(client_random)) > 0) &&
+				(::EVP_PKEY_derive(context, key_block, &key_block_len) > 0);
+
+			::EVP_PKEY_CTX_free(context);
+		}
+
+		::OPENSSL_cleanse(master_key, sizeof(master_key));
+
+		if(derived == false)
+		{
+			logtw("[#%d] Kernel TLS is not used: could not derive the keys", socket);
+			::OPENSSL_cleanse(key_block, sizeof(key_block));
+			return false;
+		}
+
+		const uint8_t *server_write_key = key_block + key_len;
+		const uint8_t *server_write_iv = key_block + (key_len * 2) + 4;
+
+		// The Finished message of the server was the first record (#0) of the keys
+		uint8_t record_sequence[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+		// The explicit nonce starts from the sequence number, the kernel increases it for each record
+		union
+		{
+			tls12_crypto_info_aes_gcm_128 aes_gcm_128;
+#if defined(TLS_CIPHER_AES_GCM_256)
+			tls12_crypto_info_aes_gcm_256 aes_gcm_256;
+#endif	// defined(TLS_CIPHER_AES_GCM_256)
+		} crypto_info {};
+		socklen_t crypto_info_len;
+
+		if(key_len == 16L)
+		{
+			auto &info = crypto_info.aes_gcm_128;
+
+			info.info.version = TLS_1_2_VERSION;
+			info.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+			::memcpy(info.key, server_write_key, sizeof(info.key));
+			::memcpy(info.salt, server_write_iv, sizeof(info.salt));
+			::memcpy(info.iv, record_sequence, sizeof(info.iv));
+			::memcpy(info.rec_seq, record_sequence, sizeof(info.rec_seq));
+
+			crypto_info_len = sizeof(info);
+		}
+#if defined(TLS_CIPHER_AES_GCM_256)
+		else
+		{
+			auto &info = crypto_info.aes_gcm_256;
+
+			info.info.version = TLS_1_2_VERSION;
+			info.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+			::memcpy(info.key, server_write_key, sizeof(info.key));
+			::memcpy(info.salt, server_write_iv, sizeof(info.salt));
+			::memcpy(info.iv, record_sequence, sizeof(info.iv));
+			::memcpy(info.rec_seq, record_sequence, sizeof(info.rec_seq));
+
+			crypto_info_len = sizeof(info);
+		}
+#endif	// defined(TLS_CIPHER_AES_GCM_256)
+
+		::OPENSSL_cleanse(key_block, sizeof(key_block));
+
+		bool result =
+			(::setsockopt(socket, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) == 0) &&
+			(::setsockopt(socket, SOL_TLS, TLS_TX, &crypto_info, crypto_info_len) == 0);
+
+		::OPENSSL_cleanse(&crypto_info, sizeof(crypto_info));
+
+		if(result == false)
+		{
+			// The tls module of the kernel might not be loaded (modprobe tls)
+			logtd("[#%d] Kernel TLS is not used: %s", socket, ::strerror(errno));
+			return false;
+		}
+
+		logtd("[#%d] Kernel TLS is enabled (%s)", socket, ::SSL_CIPHER_get_name(cipher));
+
+		_is_kernel_tls_tx_enabled = true;
+
+		return true;
+	}
+#else	// OV_KTLS_SUPPORTED
+	bool Tls::EnableKernelTlsTx(int socket)
+	{
+		return false;
+	}
+#endif	// OV_KTLS_SUPPORTED
 };
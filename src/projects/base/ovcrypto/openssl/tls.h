@@ -23,6 +23,8 @@
 #include <base/ovlibrary/ovlibrary.h>
 #include <base/ovcrypto/ovcrypto.h>
 
+#include "tls_context.h"
+
 namespace ov
 {
 	class Tls;
@@ -118,9 +120,20 @@ namespace ov
 
 		// method: DTLS_server_method(), TLS_server_method()
 		bool Initialize(const SSL_METHOD *method, const std::shared_ptr<Certificate> &certificate, const std::shared_ptr<Certificate> &chain_certificate, const ov::String &cipher_list, TlsCallback callback);
+		// Uses the SSL_CTX of the context (create_callback/verify_callback are not called, the context is shared)
+		bool Initialize(const std::shared_ptr<TlsContext> &context, TlsCallback callback);
 
 		// @return Returns SSL_ERROR_NONE on success
 		int Accept();
+		// The client side of Accept() (e.g. DTLS_client_method() for the headless WebRTC subscribers)
+		// @return Returns SSL_ERROR_NONE on success
+		int Connect();
+
+		// Whether the session is resumed (by the session ID or the session ticket) without a full handshake
+		bool IsSessionReused() const;
+
+		// The protocol selected by ALPN (empty if ALPN is not negotiated)
+		ov::String GetSelectedAlpnProtocol() const;
 
 		// @return Returns SSL_ERROR_NONE on success
 		int Read(void *buffer, size_t length, size_t *read_bytes);
@@ -148,6 +161,16 @@ namespace ov
 
 		bool GetKeySaltLen(unsigned long crypto_suite, size_t *key_len, size_t *salt_len) const;
 
+		// Kernel TLS (TLS_TX): the records to send are encrypted by the kernel (or the NIC) after the handshake
+		// - Only TLS 1.2 with AES-GCM is supported, returns false otherwise (the data is encrypted by Write() as before)
+		// - Once it is enabled, the plain data must be sent to the socket directly instead of Write()
+		bool EnableKernelTlsTx(int socket);
+
+		bool IsKernelTlsTxEnabled() const
+		{
+			return _is_kernel_tls_tx_enabled;
+		}
+
 	protected:
 		static BIO_METHOD *PrepareBioMethod();
 
@@ -191,6 +214,11 @@ namespace ov
 		TlsUniquePtr<SSL_CTX, void, ::SSL_CTX_free> _ssl_ctx = nullptr;
 		TlsUniquePtr<BIO, int, ::BIO_free> _bio = nullptr;
 
+		// The context shared with the other connections (_ssl_ctx is not used if it is set)
+		std::shared_ptr<TlsContext> _context;
+
 		TlsCallback _callback;
+
+		bool _is_kernel_tls_tx_enabled = false;
 	};
 }
@@ -0,0 +1,271 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "tls_context.h"
+
+#include <openssl/rand.h>
+
+#define OV_LOG_TAG "OpenSSL"
+
+// Used to distinguish the sessions of OvenMediaEngine in the session cache
+#define OV_TLS_SESSION_ID_CONTEXT               "OvenMediaEngine"
+
+namespace ov
+{
+	TlsContext::~TlsContext()
+	{
+		if(_ssl_ctx != nullptr)
+		{
+			::SSL_CTX_free(_ssl_ctx);
+			_ssl_ctx = nullptr;
+		}
+
+		::OPENSSL_cleanse(&_current_ticket_key, sizeof(_current_ticket_key));
+		::OPENSSL_cleanse(&_previous_ticket_key, sizeof(_previous_ticket_key));
+	}
+
+	bool TlsContext::Prepare(const SSL_METHOD *method, const std::shared_ptr<Certificate> &certificate, const std::shared_ptr<Certificate> &chain_certificate, const ov::String &cipher_list)
+	{
+		OV_ASSERT2(_ssl_ctx == nullptr);
+
+		SSL_CTX *ctx = ::SSL_CTX_new(method);
+
+		if(ctx == nullptr)
+		{
+			logte("Cannot create SSL context");
+			return false;
+		}
+
+		if((UseCertificate(ctx, certificate, chain_certificate) == false) || (PrepareSessionCache(ctx) == false))
+		{
+			::SSL_CTX_free(ctx);
+			return false;
+		}
+
+		// https://wiki.mozilla.org/Security/Server_Side_TLS
+		::SSL_CTX_set_cipher_list(ctx, cipher_list.CStr());
+
+		_ssl_ctx = ctx;
+
+		return true;
+	}
+
+	bool TlsContext::SetAlpnProtocols(const std::vector<ov::String> &protocols)
+	{
+		if(_ssl_ctx == nullptr)
+		{
+			OV_ASSERT2(false);
+			return false;
+		}
+
+		std::vector<uint8_t> alpn_protocols;
+
+		for(const auto &protocol : protocols)
+		{
+			if((protocol.GetLength() == 0) || (protocol.GetLength() > 255))
+			{
+				logte("Invalid ALPN protocol: %s", protocol.CStr());
+				return false;
+			}
+
+			alpn_protocols.push_back(static_cast<uint8_t>(protocol.GetLength()));
+			alpn_protocols.insert(alpn_protocols.end(), protocol.CStr(), protocol.CStr() + protocol.GetLength());
+		}
+
+		_alpn_protocols = std::move(alpn_protocols);
+
+		::SSL_CTX_set_alpn_select_cb(_ssl_ctx, OnAlpnSelect, this);
+
+		return true;
+	}
+
+	int TlsContext::OnAlpnSelect(SSL *ssl, const unsigned char **out, unsigned char *out_length, const unsigned char *in, unsigned int in_length, void *arg)
+	{
+		auto context = static_cast<TlsContext *>(arg);
+
+		if((context == nullptr) || context->_alpn_protocols.empty())
+		{
+			return SSL_TLSEXT_ERR_NOACK;
+		}
+
+		// The order of the server is preferred
+		unsigned char *selected = nullptr;
+
+		if(::SSL_select_next_proto(&selected, out_length,
+								   context->_alpn_protocols.data(), static_cast<unsigned int>(context->_alpn_protocols.size()),
+								   in, in_length) != OPENSSL_NPN_NEGOTIATED)
+		{
+			// None of the protocols is offered by the client
+			return SSL_TLSEXT_ERR_NOACK;
+		}
+
+		*out = selected;
+
+		return SSL_TLSEXT_ERR_OK;
+	}
+
+	bool TlsContext::UseCertificate(SSL_CTX *ctx, const std::shared_ptr<Certificate> &certificate, const std::shared_ptr<Certificate> &chain_certificate)
+	{
+		if(::SSL_CTX_use_certificate(ctx, certificate->GetX509()) != 1)
+		{
+			logte("Cannot use certficate: %s", ov::Error::CreateErrorFromOpenSsl()->ToString().CStr());
+			return false;
+		}
+
+		if((chain_certificate != nullptr) && (::SSL_CTX_add1_chain_cert(ctx, chain_certificate->GetX509()) != 1))
+		{
+			logte("Cannot use chain certificate: %s", ov::Error::CreateErrorFromOpenSsl()->ToString().CStr());
+			return false;
+		}
+
+		if(::SSL_CTX_use_PrivateKey(ctx, certificate->GetPkey()) != 1)
+		{
+			logte("Cannot use private key: %s", ov::Error::CreateErrorFromOpenSsl()->ToString().CStr());
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TlsContext::PrepareSessionCache(SSL_CTX *ctx)
+	{
+		// Session ID (RFC 5246 - 7.4.1.2)
+		SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+		SSL_CTX_sess_set_cache_size(ctx, OV_TLS_SESSION_CACHE_SIZE);
+		::SSL_CTX_set_timeout(ctx, OV_TLS_SESSION_TIMEOUT);
+
+		if(::SSL_CTX_set_session_id_context(ctx, reinterpret_cast<const unsigned char *>(OV_TLS_SESSION_ID_CONTEXT), sizeof(OV_TLS_SESSION_ID_CONTEXT) - 1) != 1)
+		{
+			logte("Cannot set the session id context: %s", ov::Error::CreateErrorFromOpenSsl()->ToString().CStr());
+			return false;
+		}
+
+		// Session ticket (RFC 5077): the keys are owned by the context to rotate them
+		{
+			std::lock_guard<std::mutex> lock_guard(_ticket_key_mutex);
+
+			if(RotateTicketKeyIfNeeded(::time(nullptr)) == false)
+			{
+				return false;
+			}
+		}
+
+		SSL_CTX_set_app_data(ctx, this);
+		SSL_CTX_set_tlsext_ticket_key_cb(ctx, OnTicketKey);
+
+		return true;
+	}
+
+	bool TlsContext::RotateTicketKeyIfNeeded(time_t current_time)
+	{
+		if((_current_ticket_key.created_time != 0) && ((current_time - _current_ticket_key.created_time) < OV_TLS_TICKET_KEY_ROTATION_INTERVAL))
+		{
+			return true;
+		}
+
+		TicketKey ticket_key;
+
+		if(
+			(::RAND_bytes(ticket_key.name, sizeof(ticket_key.name)) != 1) ||
+			(::RAND_bytes(ticket_key.aes_key, sizeof(ticket_key.aes_key)) != 1) ||
+			(::RAND_bytes(ticket_key.hmac_key, sizeof(ticket_key.hmac_key)) != 1))
+		{
+			logte("Cannot generate the session ticket key: %s", ov::Error::CreateErrorFromOpenSsl()->ToString().CStr());
+			::OPENSSL_cleanse(&ticket_key, sizeof(ticket_key));
+			return false;
+		}
+
+		ticket_key.created_time = current_time;
+
+		_has_previous_ticket_key = (_current_ticket_key.created_time != 0);
+		_previous_ticket_key = _current_ticket_key;
+		_current_ticket_key = ticket_key;
+
+		::OPENSSL_cleanse(&ticket_key, sizeof(ticket_key));
+
+		logtd("The session ticket key is rotated");
+
+		return true;
+	}
+
+	int TlsContext::OnTicketKey(SSL *ssl, unsigned char key_name[16], unsigned char *iv, EVP_CIPHER_CTX *cipher_context, HMAC_CTX *hmac_context, int enc)
+	{
+		auto context = static_cast<TlsContext *>(SSL_CTX_get_app_data(::SSL_get_SSL_CTX(ssl)));
+
+		if(context == nullptr)
+		{
+			OV_ASSERT2(false);
+			return -1;
+		}
+
+		return context->ProcessTicketKey(key_name, iv, cipher_context, hmac_context, enc);
+	}
+
+	// Return value (SSL_CTX_set_tlsext_ticket_key_cb):
+	//   Encryption: 1 (the ticket is issued), 0 (no ticket), -1 (error)
+	//   Decryption: 1 (the ticket is accepted), 2 (accepted, and a new ticket is issued), 0 (full handshake), -1 (error)
+	int TlsContext::ProcessTicketKey(unsigned char key_name[16], unsigned char *iv, EVP_CIPHER_CTX *cipher_context, HMAC_CTX *hmac_context, int enc)
+	{
+		std::lock_guard<std::mutex> lock_guard(_ticket_key_mutex);
+
+		const TicketKey *ticket_key = nullptr;
+		int result = 1;
+
+		if(enc == 1)
+		{
+			if(RotateTicketKeyIfNeeded(::time(nullptr)) == false)
+			{
+				// Without the ticket, the session can still be resumed by the session ID
+				return 0;
+			}
+
+			ticket_key = &_current_ticket_key;
+
+			if(::RAND_bytes(iv, ::EVP_CIPHER_iv_length(::EVP_aes_256_cbc())) != 1)
+			{
+				return -1;
+			}
+
+			::memcpy(key_name, ticket_key->name, sizeof(ticket_key->name));
+
+			if(::EVP_EncryptInit_ex(cipher_context, ::EVP_aes_256_cbc(), nullptr, ticket_key->aes_key, iv) != 1)
+			{
+				return -1;
+			}
+		}
+		else
+		{
+			if(::memcmp(key_name, _current_ticket_key.name, sizeof(_current_ticket_key.name)) == 0)
+			{
+				ticket_key = &_current_ticket_key;
+			}
+			else if(_has_previous_ticket_key && (::memcmp(key_name, _previous_ticket_key.name, sizeof(_previous_ticket_key.name)) == 0))
+			{
+				// Renew the ticket with the current key
+				ticket_key = &_previous_ticket_key;
+				result = 2;
+			}
+			else
+			{
+				// Unknown (or expired) key
+				return 0;
+			}
+
+			if(::EVP_DecryptInit_ex(cipher_context, ::EVP_aes_256_cbc(), nullptr, ticket_key->aes_key, iv) != 1)
+			{
+				return -1;
+			}
+		}
+
+		if(::HMAC_Init_ex(hmac_context, ticket_key->hmac_key, sizeof(ticket_key->hmac_key), ::EVP_sha256(), nullptr) != 1)
+		{
+			return -1;
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,88 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <ctime>
+#include <memory>
+#include <mutex>
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/ssl.h>
+
+#include <base/ovlibrary/ovlibrary.h>
+#include <base/ovcrypto/certificate.h>
+
+// Number of the sessions kept by the server-side session cache
+#define OV_TLS_SESSION_CACHE_SIZE               20480
+// Lifetime of the cached sessions and the session tickets (seconds)
+#define OV_TLS_SESSION_TIMEOUT                  (2 * 60 * 60)
+// The ticket key is replaced with a new one periodically (seconds)
+// The previous key is still accepted for an interval, and the ticket is renewed with the new key
+#define OV_TLS_TICKET_KEY_ROTATION_INTERVAL     (60 * 60)
+
+namespace ov
+{
+	// SSL_CTX which is shared by the connections of a server
+	//
+	// - The certificates are loaded once, instead of every connection
+	// - The sessions can be resumed by the session ID (server-side cache) or by the stateless session ticket (RFC 5077),
+	//   so the players which reconnect for each segment don't need a full handshake
+	class TlsContext
+	{
+	public:
+		TlsContext() = default;
+		~TlsContext();
+
+		// method: TLS_server_method()
+		bool Prepare(const SSL_METHOD *method, const std::shared_ptr<Certificate> &certificate, const std::shared_ptr<Certificate> &chain_certificate, const ov::String &cipher_list);
+
+		SSL_CTX *GetSslContext()
+		{
+			return _ssl_ctx;
+		}
+
+		// ALPN (RFC 7301): the first protocol of the list which is offered by the client is selected
+		// - The handshake goes on without ALPN if the client offers none of them (e.g. HTTP/1.1 only clients)
+		// - Must be called before the first connection
+		bool SetAlpnProtocols(const std::vector<ov::String> &protocols);
+
+		// Loads the certificate, the chain certificate and the private key to the context
+		static bool UseCertificate(SSL_CTX *ctx, const std::shared_ptr<Certificate> &certificate, const std::shared_ptr<Certificate> &chain_certificate);
+
+	protected:
+		struct TicketKey
+		{
+			uint8_t name[16] {};
+			uint8_t aes_key[32] {};
+			uint8_t hmac_key[32] {};
+
+			time_t created_time = 0;
+		};
+
+		bool PrepareSessionCache(SSL_CTX *ctx);
+
+		// _ticket_key_mutex must be locked
+		bool RotateTicketKeyIfNeeded(time_t current_time);
+
+		static int OnTicketKey(SSL *ssl, unsigned char key_name[16], unsigned char *iv, EVP_CIPHER_CTX *cipher_context, HMAC_CTX *hmac_context, int enc);
+		int ProcessTicketKey(unsigned char key_name[16], unsigned char *iv, EVP_CIPHER_CTX *cipher_context, HMAC_CTX *hmac_context, int enc);
+
+		static int OnAlpnSelect(SSL *ssl, const unsigned char **out, unsigned char *out_length, const unsigned char *in, unsigned int in_length, void *arg);
+
+		SSL_CTX *_ssl_ctx = nullptr;
+
+		// Protocol list of ALPN (wire format: length-prefixed names)
+		std::vector<uint8_t> _alpn_protocols;
+
+		std::mutex _ticket_key_mutex;
+		TicketKey _current_ticket_key;
+		TicketKey _previous_ticket_key;
+		bool _has_previous_ticket_key = false;
+	};
+}
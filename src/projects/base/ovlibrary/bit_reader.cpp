@@ -0,0 +1,126 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./bit_reader.h"
+#include "./byte_ordering.h"
+
+namespace ov
+{
+	BitReader::BitReader(const uint8_t *data, size_t length)
+		: _data(data),
+		  _length(length)
+	{
+	}
+
+	void BitReader::Refill()
+	{
+		if((_byte_offset + sizeof(uint64_t)) <= _length)
+		{
+			// Whole bytes of the word which fit in the cache
+			size_t bytes = static_cast<size_t>(64 - _cached_bits) / 8;
+
+			_cache |= (LoadBE<uint64_t>(_data + _byte_offset) >> _cached_bits);
+			_byte_offset += bytes;
+			_cached_bits += static_cast<int>(bytes * 8);
+
+			if(_cached_bits < 64)
+			{
+				// The bits of the next byte are cached again by the next refill
+				_cache &= ~(UINT64_MAX >> _cached_bits);
+			}
+
+			return;
+		}
+
+		while((_cached_bits <= 56) && (_byte_offset < _length))
+		{
+			_cache |= static_cast<uint64_t>(_data[_byte_offset]) << (56 - _cached_bits);
+			_byte_offset++;
+			_cached_bits += 8;
+		}
+	}
+
+	uint32_t BitReader::ReadBits(int count)
+	{
+		if(count <= 0)
+		{
+			return 0;
+		}
+
+		if(_cached_bits < count)
+		{
+			Refill();
+
+			if(_cached_bits < count)
+			{
+				_overflow = true;
+				return 0;
+			}
+		}
+
+		auto value = static_cast<uint32_t>(_cache >> (64 - count));
+
+		_cache <<= count;
+		_cached_bits -= count;
+
+		return value;
+	}
+
+	uint32_t BitReader::ReadUe()
+	{
+		int leading_zero_bits = 0;
+
+		while((ReadBit() == false) && (_overflow == false))
+		{
+			leading_zero_bits++;
+
+			if(leading_zero_bits > 31)
+			{
+				_overflow = true;
+				return 0;
+			}
+		}
+
+		if(leading_zero_bits == 0)
+		{
+			return 0;
+		}
+
+		return ((1U << leading_zero_bits) - 1) + ReadBits(leading_zero_bits);
+	}
+
+	int32_t BitReader::ReadSe()
+	{
+		uint32_t value = ReadUe();
+
+		return (value & 0x01) ? static_cast<int32_t>((value + 1) / 2) : -static_cast<int32_t>(value / 2);
+	}
+
+	void BitReader::SkipBits(size_t count)
+	{
+		if(count <= static_cast<size_t>(_cached_bits))
+		{
+			_cache = (count == 64) ? 0 : (_cache << count);
+			_cached_bits -= static_cast<int>(count);
+			return;
+		}
+
+		count -= _cached_bits;
+		_cache = 0;
+		_cached_bits = 0;
+
+		if((count / 8) > (_length - _byte_offset))
+		{
+			_byte_offset = _length;
+			_overflow = true;
+			return;
+		}
+
+		_byte_offset += count / 8;
+		ReadBits(static_cast<int>(count % 8));
+	}
+}
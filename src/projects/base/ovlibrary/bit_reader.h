@@ -0,0 +1,71 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ov
+{
+	// Reads the bits from MSB (e.g. SPS, ADTS header, the sections of TS)
+	//
+	// - The bits are cached in a 64-bit accumulator which is refilled by a word (or the remaining bytes),
+	//   so the bounds are checked once per refill instead of once per bit
+	// - Reading after the end returns 0, and IsOverflow() becomes true
+	// - The emulation prevention bytes of the RBSP are not removed
+	class BitReader
+	{
+	public:
+		BitReader() = default;
+		BitReader(const uint8_t *data, size_t length);
+
+		// count: 0 ~ 32
+		uint32_t ReadBits(int count);
+
+		bool ReadBit()
+		{
+			return ReadBits(1) != 0;
+		}
+
+		// ue(v)
+		uint32_t ReadUe();
+		// se(v)
+		int32_t ReadSe();
+
+		void SkipBits(size_t count);
+
+		size_t GetBitOffset() const
+		{
+			return (_byte_offset * 8) - _cached_bits;
+		}
+
+		size_t GetRemainedBits() const
+		{
+			return ((_length - _byte_offset) * 8) + _cached_bits;
+		}
+
+		bool IsOverflow() const
+		{
+			return _overflow;
+		}
+
+	protected:
+		void Refill();
+
+		const uint8_t *_data = nullptr;
+		size_t _length = 0;
+		// Next byte to be cached
+		size_t _byte_offset = 0;
+
+		// The cached bits are aligned to MSB (the other bits are 0)
+		uint64_t _cache = 0;
+		int _cached_bits = 0;
+
+		bool _overflow = false;
+	};
+}
@@ -0,0 +1,414 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./buffer_pool.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace ov
+{
+	namespace
+	{
+		constexpr int SizeClassCount = static_cast<int>(BufferPool::SizeClass::NumberOfSizeClass);
+
+		constexpr size_t SizeClassCapacity[SizeClassCount] = {
+			OV_BUFFER_POOL_SMALL_SIZE,
+			OV_BUFFER_POOL_MTU_SIZE
+		};
+
+		struct Counters
+		{
+			std::atomic<uint64_t> allocation_count { 0 };
+			std::atomic<uint64_t> local_hit_count { 0 };
+			std::atomic<uint64_t> global_hit_count { 0 };
+			std::atomic<uint64_t> miss_count { 0 };
+			std::atomic<uint64_t> release_count { 0 };
+			std::atomic<uint64_t> discard_count { 0 };
+		};
+
+		struct GlobalPool
+		{
+			std::mutex mutex[SizeClassCount];
+			std::vector<BufferPool::Buffer *> buffers[SizeClassCount];
+			Counters counters[SizeClassCount];
+		};
+
+		GlobalPool &GetGlobalPool()
+		{
+			// Never destroyed, because buffers can be released while static objects are being destroyed
+			static GlobalPool *pool = new GlobalPool();
+
+			return *pool;
+		}
+
+		// Once the cache of a thread is destroyed (at thread exit), the buffers go to the global pool directly
+		thread_local bool local_cache_destroyed = false;
+
+		struct LocalCache
+		{
+			~LocalCache()
+			{
+				auto &pool = GetGlobalPool();
+
+				for(int size_class = 0; size_class < SizeClassCount; size_class++)
+				{
+					std::lock_guard<std::mutex> lock(pool.mutex[size_class]);
+
+					for(auto buffer : buffers[size_class])
+					{
+						if(pool.buffers[size_class].size() < OV_BUFFER_POOL_GLOBAL_CACHE_SIZE)
+						{
+							pool.buffers[size_class].push_back(buffer);
+						}
+						else
+						{
+							delete buffer;
+						}
+					}
+				}
+
+				local_cache_destroyed = true;
+			}
+
+			std::vector<BufferPool::Buffer *> buffers[SizeClassCount];
+		};
+
+		thread_local LocalCache local_cache;
+
+		// Recycles the blocks of the shared_ptr control block (they have the same size for each T)
+		thread_local bool control_block_cache_destroyed = false;
+
+		struct ControlBlockCache
+		{
+			~ControlBlockCache()
+			{
+				for(auto block : blocks)
+				{
+					::operator delete(block);
+				}
+
+				control_block_cache_destroyed = true;
+			}
+
+			std::vector<void *> blocks;
+		};
+
+		thread_local ControlBlockCache control_block_cache;
+
+		template<typename T>
+		class ControlBlockAllocator
+		{
+		public:
+			typedef T value_type;
+
+			ControlBlockAllocator() = default;
+
+			template<typename U>
+			ControlBlockAllocator(const ControlBlockAllocator<U> &other) noexcept // NOLINT
+			{
+			}
+
+			T *allocate(size_t count)
+			{
+				// Only one type of control block is allocated by BufferPool, so all blocks have the same size
+				if((count == 1) && (control_block_cache_destroyed == false) && (control_block_cache.blocks.empty() == false))
+				{
+					void *block = control_block_cache.blocks.back();
+					control_block_cache.blocks.pop_back();
+
+					return static_cast<T *>(block);
+				}
+
+				return static_cast<T *>(::operator new(count * sizeof(T)));
+			}
+
+			void deallocate(T *block, size_t count)
+			{
+				if((count == 1) && (control_block_cache_destroyed == false) && (control_block_cache.blocks.size() < OV_BUFFER_POOL_LOCAL_CACHE_SIZE))
+				{
+					control_block_cache.blocks.push_back(block);
+					return;
+				}
+
+				::operator delete(block);
+			}
+
+			template<typename U>
+			bool operator ==(const ControlBlockAllocator<U> &other) const noexcept
+			{
+				return true;
+			}
+
+			template<typename U>
+			bool operator !=(const ControlBlockAllocator<U> &other) const noexcept
+			{
+				return false;
+			}
+		};
+
+		void Release(BufferPool::Buffer *buffer)
+		{
+			size_t capacity = buffer->capacity();
+			int size_class = SizeClassCount - 1;
+
+			while((size_class >= 0) && (capacity < SizeClassCapacity[size_class]))
+			{
+				size_class--;
+			}
+
+			auto &pool = GetGlobalPool();
+
+			// Very large buffers (grown by Append()) are not kept
+			if((size_class < 0) || (capacity > SizeClassCapacity[size_class] * 4))
+			{
+				if(size_class >= 0)
+				{
+					pool.counters[size_class].discard_count.fetch_add(1, std::memory_order_relaxed);
+				}
+
+				delete buffer;
+				return;
+			}
+
+			auto &counters = pool.counters[size_class];
+
+			buffer->clear();
+
+			if(local_cache_destroyed == false)
+			{
+				auto &buffers = local_cache.buffers[size_class];
+
+				if(buffers.size() < OV_BUFFER_POOL_LOCAL_CACHE_SIZE)
+				{
+					buffers.push_back(buffer);
+					counters.release_count.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+
+				// Move some buffers to the global pool so that other threads can use them
+				std::lock_guard<std::mutex> lock(pool.mutex[size_class]);
+
+				for(int count = 0; (count < OV_BUFFER_POOL_TRANSFER_COUNT) && (buffers.empty() == false); count++)
+				{
+					if(pool.buffers[size_class].size() >= OV_BUFFER_POOL_GLOBAL_CACHE_SIZE)
+					{
+						break;
+					}
+
+					pool.buffers[size_class].push_back(buffers.back());
+					buffers.pop_back();
+				}
+
+				if(buffers.size() < OV_BUFFER_POOL_LOCAL_CACHE_SIZE)
+				{
+					buffers.push_back(buffer);
+					counters.release_count.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+			}
+			else
+			{
+				std::lock_guard<std::mutex> lock(pool.mutex[size_class]);
+
+				if(pool.buffers[size_class].size() < OV_BUFFER_POOL_GLOBAL_CACHE_SIZE)
+				{
+					pool.buffers[size_class].push_back(buffer);
+					counters.release_count.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+			}
+
+			counters.discard_count.fetch_add(1, std::memory_order_relaxed);
+			delete buffer;
+		}
+
+		// Deleter of all the buffers of BufferPool, it keeps the bytes which are charged to the tag
+		struct Recycler
+		{
+			MemoryTag tag;
+			size_t charged_capacity;
+			bool pooled;
+
+			void operator()(BufferPool::Buffer *buffer) const
+			{
+				MemoryAccounting::Add(tag, -static_cast<int64_t>(charged_capacity));
+
+				if(pooled)
+				{
+					Release(buffer);
+				}
+				else
+				{
+					delete buffer;
+				}
+			}
+		};
+
+		BufferPool::Buffer *AllocateFromPool(int size_class)
+		{
+			auto &pool = GetGlobalPool();
+			auto &counters = pool.counters[size_class];
+
+			counters.allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+			if(local_cache_destroyed == false)
+			{
+				auto &buffers = local_cache.buffers[size_class];
+
+				if(buffers.empty() == false)
+				{
+					auto buffer = buffers.back();
+					buffers.pop_back();
+
+					counters.local_hit_count.fetch_add(1, std::memory_order_relaxed);
+					return buffer;
+				}
+
+				// Take some buffers from the global pool at once
+				std::lock_guard<std::mutex> lock(pool.mutex[size_class]);
+				auto &global_buffers = pool.buffers[size_class];
+
+				for(int count = 0; (count < OV_BUFFER_POOL_TRANSFER_COUNT) && (global_buffers.empty() == false); count++)
+				{
+					buffers.push_back(global_buffers.back());
+					global_buffers.pop_back();
+				}
+
+				if(buffers.empty() == false)
+				{
+					auto buffer = buffers.back();
+					buffers.pop_back();
+
+					counters.global_hit_count.fetch_add(1, std::memory_order_relaxed);
+					return buffer;
+				}
+			}
+			else
+			{
+				std::lock_guard<std::mutex> lock(pool.mutex[size_class]);
+				auto &global_buffers = pool.buffers[size_class];
+
+				if(global_buffers.empty() == false)
+				{
+					auto buffer = global_buffers.back();
+					global_buffers.pop_back();
+
+					counters.global_hit_count.fetch_add(1, std::memory_order_relaxed);
+					return buffer;
+				}
+			}
+
+			counters.miss_count.fetch_add(1, std::memory_order_relaxed);
+
+			auto buffer = new BufferPool::Buffer();
+			buffer->reserve(SizeClassCapacity[size_class]);
+
+			return buffer;
+		}
+	}
+
+	std::shared_ptr<BufferPool::Buffer> BufferPool::Allocate(size_t capacity)
+	{
+		Buffer *buffer = nullptr;
+		bool pooled = (capacity > 0) && (capacity <= OV_BUFFER_POOL_MTU_SIZE);
+
+		if(pooled)
+		{
+			int size_class = 0;
+
+			while(SizeClassCapacity[size_class] < capacity)
+			{
+				size_class++;
+			}
+
+			buffer = AllocateFromPool(size_class);
+		}
+		else
+		{
+			buffer = new Buffer();
+			buffer->reserve(capacity);
+
+			HugePages::Advise(buffer->data(), buffer->capacity());
+		}
+
+		auto tag = MemoryAccounting::GetCurrentTag();
+		MemoryAccounting::Add(tag, static_cast<int64_t>(buffer->capacity()));
+
+		return std::shared_ptr<Buffer>(buffer, Recycler { tag, buffer->capacity(), pooled }, ControlBlockAllocator<Buffer>());
+	}
+
+	void BufferPool::UpdateAccounting(const std::shared_ptr<Buffer> &buffer)
+	{
+		auto recycler = std::get_deleter<Recycler>(buffer);
+
+		if((recycler == nullptr) || (recycler->charged_capacity == buffer->capacity()))
+		{
+			// Not allocated by BufferPool, or not grown
+			return;
+		}
+
+		MemoryAccounting::Add(recycler->tag, static_cast<int64_t>(buffer->capacity()) - static_cast<int64_t>(recycler->charged_capacity));
+		recycler->charged_capacity = buffer->capacity();
+
+		// The buffer is reallocated
+		HugePages::Advise(buffer->data(), buffer->capacity());
+	}
+
+	BufferPoolStatistics BufferPool::GetStatistics(SizeClass size_class)
+	{
+		BufferPoolStatistics statistics;
+		auto &counters = GetGlobalPool().counters[static_cast<int>(size_class)];
+
+		statistics.allocation_count = counters.allocation_count.load(std::memory_order_relaxed);
+		statistics.local_hit_count = counters.local_hit_count.load(std::memory_order_relaxed);
+		statistics.global_hit_count = counters.global_hit_count.load(std::memory_order_relaxed);
+		statistics.miss_count = counters.miss_count.load(std::memory_order_relaxed);
+		statistics.release_count = counters.release_count.load(std::memory_order_relaxed);
+		statistics.discard_count = counters.discard_count.load(std::memory_order_relaxed);
+
+		return statistics;
+	}
+
+	const char *BufferPool::GetSizeClassString(SizeClass size_class)
+	{
+		switch(size_class)
+		{
+			case SizeClass::Small:
+				return "small";
+			case SizeClass::Mtu:
+				return "mtu";
+			default:
+				return "unknown";
+		}
+	}
+
+	String BufferPool::GetStatisticsString()
+	{
+		String description;
+
+		for(int size_class = 0; size_class < SizeClassCount; size_class++)
+		{
+			auto type = static_cast<SizeClass>(size_class);
+			auto statistics = GetStatistics(type);
+
+			description.AppendFormat("%s(%zu): alloc: %llu, local hit: %llu, global hit: %llu, miss: %llu, release: %llu, discard: %llu, hit rate: %.2f%%\n",
+			                         GetSizeClassString(type), SizeClassCapacity[size_class],
+			                         static_cast<unsigned long long>(statistics.allocation_count),
+			                         static_cast<unsigned long long>(statistics.local_hit_count),
+			                         static_cast<unsigned long long>(statistics.global_hit_count),
+			                         static_cast<unsigned long long>(statistics.miss_count),
+			                         static_cast<unsigned long long>(statistics.release_count),
+			                         static_cast<unsigned long long>(statistics.discard_count),
+			                         statistics.GetHitRate());
+		}
+
+		description.Append(HugePages::GetStatisticsString());
+
+		return description;
+	}
+}
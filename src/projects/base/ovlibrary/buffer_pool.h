@@ -0,0 +1,84 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "./string.h"
+#include "./memory_accounting.h"
+#include "./huge_pages.h"
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+// Capacity of the buffers of each size class
+#define OV_BUFFER_POOL_SMALL_SIZE				256
+// Enough for an RTP packet (DEFAULT_MAX_PACKET_SIZE) + SRTP trailer
+#define OV_BUFFER_POOL_MTU_SIZE					2048
+// Maximum number of buffers cached by each thread (per size class)
+#define OV_BUFFER_POOL_LOCAL_CACHE_SIZE			256
+// Maximum number of buffers shared by all threads (per size class)
+#define OV_BUFFER_POOL_GLOBAL_CACHE_SIZE		8192
+// Number of buffers moved between the thread cache and the global pool at once
+#define OV_BUFFER_POOL_TRANSFER_COUNT			64
+
+namespace ov
+{
+	struct BufferPoolStatistics
+	{
+		// Number of allocations of the size class
+		uint64_t allocation_count = 0;
+		// Allocations served from the cache of the thread
+		uint64_t local_hit_count = 0;
+		// Allocations served from the global pool
+		uint64_t global_hit_count = 0;
+		// Allocations served from the heap
+		uint64_t miss_count = 0;
+		// Buffers returned to the pool
+		uint64_t release_count = 0;
+		// Buffers returned to the heap because the pool is full
+		uint64_t discard_count = 0;
+
+		double GetHitRate() const
+		{
+			return (allocation_count > 0) ? (static_cast<double>(local_hit_count + global_hit_count) * 100.0 / allocation_count) : 0.0;
+		}
+	};
+
+	// Size-class pool of the byte buffers used by ov::Data
+	//
+	// - Each thread caches the released buffers, so most allocations do not need any lock
+	// - A buffer released by another thread (e.g. allocated by a packetizer and released by a stream worker)
+	//   goes to the cache of the releasing thread, and overflows to the global pool to be reused by the allocating thread
+	// - Buffers larger than OV_BUFFER_POOL_MTU_SIZE are allocated from the heap as before
+	//   (the buffers of OV_HUGE_PAGE_SIZE or larger, e.g. the segments, are advised to the huge pages if enabled)
+	class BufferPool
+	{
+	public:
+		typedef std::vector<uint8_t> Buffer;
+
+		enum class SizeClass : int
+		{
+			Small = 0,
+			Mtu,
+
+			NumberOfSizeClass
+		};
+
+		// Returns an empty buffer whose capacity is at least <capacity>.
+		// The buffer returns to the pool when the last reference is released.
+		// The capacity is charged to the memory tag of the current thread (MemoryAccounting)
+		static std::shared_ptr<Buffer> Allocate(size_t capacity);
+
+		// Charges the growth of the buffer to its tag (called after the buffer is modified)
+		static void UpdateAccounting(const std::shared_ptr<Buffer> &buffer);
+
+		static BufferPoolStatistics GetStatistics(SizeClass size_class);
+		static const char *GetSizeClassString(SizeClass size_class);
+		static String GetStatisticsString();
+	};
+}
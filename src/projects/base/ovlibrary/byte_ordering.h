@@ -9,6 +9,7 @@
 #pragma once
 
 #include <cinttypes>
+#include <cstring>
 #include <endian.h>
 
 #if (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
@@ -38,12 +39,12 @@
 // 이를 해결하기 위해 재정의
 namespace ov
 {
-	inline bool IsLittleEndian() noexcept
+	constexpr bool IsLittleEndian() noexcept
 	{
-		return OV_SELECT_BY_ENDIAN(false, true);
+		return OV_SELECT_BY_ENDIAN(true, false);
 	}
 
-	inline bool IsBigEndian() noexcept
+	constexpr bool IsBigEndian() noexcept
 	{
 		return OV_SELECT_BY_ENDIAN(false, true);
 	}
@@ -94,4 +95,67 @@ namespace ov
 
 	OV_DECLARE_ENDIAN_FUNCTION(uint64_t, NetworkToHost64, be64toh);
 
+	constexpr uint8_t ByteSwap(uint8_t value) noexcept
+	{
+		return value;
+	}
+
+	constexpr uint16_t ByteSwap(uint16_t value) noexcept
+	{
+		return __builtin_bswap16(value);
+	}
+
+	constexpr uint32_t ByteSwap(uint32_t value) noexcept
+	{
+		return __builtin_bswap32(value);
+	}
+
+	constexpr uint64_t ByteSwap(uint64_t value) noexcept
+	{
+		return __builtin_bswap64(value);
+	}
+
+	// 정렬되지 않은 버퍼에서 고정 크기의 값을 읽고 씀 (T: uint8_t ~ uint64_t)
+	// 변환 여부는 compile time에 결정되므로, 한 번의 load/store와 bswap으로 처리됨
+	//
+	// 사용 방법)
+	// uint32_t ssrc = LoadBE<uint32_t>(buffer + 8);
+	// StoreBE<uint16_t>(buffer + 2, sequence_number);
+	template<typename T>
+	inline T LoadHost(const void *buffer) noexcept
+	{
+		T value;
+		::memcpy(&value, buffer, sizeof(T));
+		return value;
+	}
+
+	template<typename T>
+	inline void StoreHost(void *buffer, T value) noexcept
+	{
+		::memcpy(buffer, &value, sizeof(T));
+	}
+
+	template<typename T>
+	inline T LoadBE(const void *buffer) noexcept
+	{
+		return OV_SELECT_BY_ENDIAN(ByteSwap(LoadHost<T>(buffer)), LoadHost<T>(buffer));
+	}
+
+	template<typename T>
+	inline T LoadLE(const void *buffer) noexcept
+	{
+		return OV_SELECT_BY_ENDIAN(LoadHost<T>(buffer), ByteSwap(LoadHost<T>(buffer)));
+	}
+
+	template<typename T>
+	inline void StoreBE(void *buffer, T value) noexcept
+	{
+		StoreHost<T>(buffer, OV_SELECT_BY_ENDIAN(ByteSwap(value), value));
+	}
+
+	template<typename T>
+	inline void StoreLE(void *buffer, T value) noexcept
+	{
+		StoreHost<T>(buffer, OV_SELECT_BY_ENDIAN(value, ByteSwap(value)));
+	}
 }
@@ -38,32 +38,51 @@ namespace ov
 	{
 	}
 
-	bool ByteStream::Write(const void *data, size_t bytes) noexcept
+	uint8_t *ByteStream::WriteBlock(size_t bytes) noexcept
 	{
 		if(_data == nullptr)
 		{
 			OV_ASSERT(false, "Cannot write to read-only data");
-			return false;
+			return nullptr;
 		}
 
 		if((_offset + bytes) > _data->GetLength())
 		{
-			// 데이터가 저장될 공간이 없으므로, 메모리를 확장한 뒤,
+			// 데이터가 저장될 공간이 없으므로, 메모리를 확장함
 			if(_data->SetLength(static_cast<size_t>(_offset + bytes)) == false)
 			{
-				return false;
+				return nullptr;
 			}
-
-			// 데이터 복사
 		}
 		else
 		{
 			// _data에 데이터가 충분히 들어갈 공간이 있음
 		}
 
-		::memcpy(_data->GetWritableDataAs<uint8_t>() + _offset, data, bytes);
+		auto buffer = _data->GetWritableDataAs<uint8_t>();
+
+		if(buffer == nullptr)
+		{
+			return nullptr;
+		}
+
+		buffer += _offset;
 		_offset += bytes;
 
+		return buffer;
+	}
+
+	bool ByteStream::Write(const void *data, size_t bytes) noexcept
+	{
+		auto buffer = WriteBlock(bytes);
+
+		if(buffer == nullptr)
+		{
+			return false;
+		}
+
+		::memcpy(buffer, data, bytes);
+
 		return true;
 	}
 
@@ -14,16 +14,24 @@
 
 #include <memory>
 
-#define OV_DECLARE_READ_FUNCTION(type, name, func) \
+// load/store: LoadHost/LoadLE/LoadBE, StoreHost/StoreLE/StoreBE (byte_ordering.h)
+#define OV_DECLARE_READ_FUNCTION(type, name, load) \
     inline type name() noexcept \
     { \
-        return func(*Read<type>()); \
+        auto buffer = ReadBlock(sizeof(type)); \
+        return (buffer != nullptr) ? load<type>(buffer) : 0; \
     }
 
-#define OV_DECLARE_WRITE_FUNCTION(type, name, func) \
+#define OV_DECLARE_WRITE_FUNCTION(type, name, store) \
     inline bool name(type value) noexcept \
     { \
-        return Write<type>(func(value)); \
+        auto buffer = WriteBlock(sizeof(type)); \
+        if(buffer == nullptr) \
+        { \
+            return false; \
+        } \
+        store<type>(buffer, value); \
+        return true; \
     }
 
 namespace ov
@@ -165,6 +173,27 @@ namespace ov
 			return buffer;
 		}
 
+		/// bytes 만큼의 영역을 읽음. 범위는 한 번만 검사되며, 읽은 뒤엔 현재 위치가 bytes 만큼 변경됨
+		///
+		/// @param bytes 읽을 바이트 수
+		///
+		/// @return 영역의 시작 위치. 남은 데이터가 bytes보다 적으면 nullptr이 반환되며, 현재 위치는 변경되지 않음
+		///
+		/// @remarks
+		/// 여러 field로 이루어진 고정 크기의 header는 한 번에 읽은 뒤 LoadBE<T>() 등으로 읽을 것 (예: RTP, STUN, TS header)
+		inline const uint8_t *ReadBlock(size_t bytes) noexcept
+		{
+			if(IsRemained(bytes) == false)
+			{
+				return nullptr;
+			}
+
+			auto buffer = CurrentBuffer<uint8_t>();
+			_offset += bytes;
+
+			return buffer;
+		}
+
 		// byte order를 고려하여 읽을 수 있는 유틸리티 함수
 		// 사용 방법)
 		// uint8_t b = stream.Read8();
@@ -175,64 +204,74 @@ namespace ov
 		/// 현재 offset 위치의 데이터를 8bit 데이터 형식으로 읽음
 		///
 		/// @return 8bit 데이터 형식의 데이터
-		OV_DECLARE_READ_FUNCTION(uint8_t, Read8,);
+		OV_DECLARE_READ_FUNCTION(uint8_t, Read8, LoadHost);
 		/// 현재 offset 위치의 데이터를 16bit 데이터 형식으로 읽음 (endian을 별도로 지정하지 않음)
 		///
 		/// @return 16bit 데이터 형식의 데이터
-		OV_DECLARE_READ_FUNCTION(uint16_t, Read16,);
+		OV_DECLARE_READ_FUNCTION(uint16_t, Read16, LoadHost);
 		/// 현재 offset 위치의 데이터를 32bit 데이터 형식으로 읽음 (endian을 별도로 지정하지 않음)
 		///
 		/// @return 32bit 데이터 형식의 데이터
-		OV_DECLARE_READ_FUNCTION(uint32_t, Read32,);
+		OV_DECLARE_READ_FUNCTION(uint32_t, Read32, LoadHost);
 		/// 현재 offset 위치의 데이터를 64bit 데이터 형식으로 읽음 (endian을 별도로 지정하지 않음)
 		///
 		/// @return 64bit 데이터 형식의 데이터
-		OV_DECLARE_READ_FUNCTION(uint64_t, Read64,);
+		OV_DECLARE_READ_FUNCTION(uint64_t, Read64, LoadHost);
 
 		// LE => HE (Data안에 Little Endian으로 저장되어 있는 것을 Host endian으로 읽음)
 
 		/// 현재 offset 위치의 데이터를 little endian 16bit 데이터로 간주하고 host endian으로 변환하여 읽음
 		///
 		/// @return 16bit 데이터 형식의 데이터
-		OV_DECLARE_READ_FUNCTION(uint16_t, ReadLE16, LE16ToHost);
+		OV_DECLARE_READ_FUNCTION(uint16_t, ReadLE16, LoadLE);
 		/// 현재 offset 위치의 데이터를 little endian 32bit 데이터로 간주하고 host endian으로 변환하여 읽음
 		///
 		/// @return 32bit 데이터 형식의 데이터
-		OV_DECLARE_READ_FUNCTION(uint32_t, ReadLE32, LE32ToHost);
+		OV_DECLARE_READ_FUNCTION(uint32_t, ReadLE32, LoadLE);
 		/// 현재 offset 위치의 데이터를 little endian 64bit 데이터로 간주하고 host endian으로 변환하여 읽음
 		///
 		/// @return 64bit 데이터 형식의 데이터
-		OV_DECLARE_READ_FUNCTION(uint64_t, ReadLE64, LE64ToHost);
+		OV_DECLARE_READ_FUNCTION(uint64_t, ReadLE64, LoadLE);
 
 		// BE => HE (Data안에 Big Endian으로 저장되어 있는 것을 Host endian으로 읽음)
 
 		/// 현재 offset 위치의 데이터를 big endian 16bit 데이터로 간주하고 host endian으로 변환하여 읽음
 		///
 		/// @return 16bit 데이터 형식의 데이터
-		OV_DECLARE_READ_FUNCTION(uint16_t, ReadBE16, BE16ToHost);
+		OV_DECLARE_READ_FUNCTION(uint16_t, ReadBE16, LoadBE);
 		/// 현재 offset 위치의 데이터를 big endian 32bit 데이터로 간주하고 host endian으로 변환하여 읽음
 		///
 		/// @return 32bit 데이터 형식의 데이터
-		OV_DECLARE_READ_FUNCTION(uint32_t, ReadBE32, BE32ToHost);
+		OV_DECLARE_READ_FUNCTION(uint32_t, ReadBE32, LoadBE);
 		/// 현재 offset 위치의 데이터를 big endian 64bit 데이터로 간주하고 host endian으로 변환하여 읽음
 		///
 		/// @return 64bit 데이터 형식의 데이터
-		OV_DECLARE_READ_FUNCTION(uint64_t, ReadBE64, BE64ToHost);
+		OV_DECLARE_READ_FUNCTION(uint64_t, ReadBE64, LoadBE);
 
 		// NE => HE (Data안에 Network Endian으로 저장되어 있는 것을 Host endian으로 읽음)
 
 		/// 현재 offset 위치의 데이터를 network endian 16bit 데이터로 간주하고 host endian으로 변환하여 읽음
 		///
 		/// @return 16bit 데이터 형식의 데이터
-		OV_DECLARE_READ_FUNCTION(uint16_t, ReadNE16, NetworkToHost16);
+		OV_DECLARE_READ_FUNCTION(uint16_t, ReadNE16, LoadBE);
 		/// 현재 offset 위치의 데이터를 network endian 32bit 데이터로 간주하고 host endian으로 변환하여 읽음
 		///
 		/// @return 32bit 데이터 형식의 데이터
-		OV_DECLARE_READ_FUNCTION(uint32_t, ReadNE32, NetworkToHost32);
+		OV_DECLARE_READ_FUNCTION(uint32_t, ReadNE32, LoadBE);
 		/// 현재 offset 위치의 데이터를 network endian 64bit 데이터로 간주하고 host endian으로 변환하여 읽음
 		///
 		/// @return 64bit 데이터 형식의 데이터
-		OV_DECLARE_READ_FUNCTION(uint64_t, ReadNE64, NetworkToHost64);
+		OV_DECLARE_READ_FUNCTION(uint64_t, ReadNE64, LoadBE);
+
+		/// 현재 위치(offset)부터 bytes 만큼 기록할 영역을 확보함. 공간은 한 번만 확보되며, 현재 위치가 bytes 만큼 변경됨
+		///
+		/// @param bytes 기록할 바이트 수
+		///
+		/// @return 기록할 영역의 시작 위치. 실패하면 nullptr
+		///
+		/// @remarks
+		/// 고정 크기의 header는 한 번에 확보한 뒤 StoreBE<T>() 등으로 기록할 것
+		uint8_t *WriteBlock(size_t bytes) noexcept;
 
 		/// 데이터를 현재 위치(offset)에 bytes만큼 기록함. 기록 후 현재 위치가 변경됨.
 		///
@@ -359,64 +398,64 @@ namespace ov
 		/// 현재 offset 위치에 8bit 데이터를 기록함 (endian을 별도로 지정하지 않음)
 		///
 		/// @return 8bit 데이터 형식의 데이터
-		OV_DECLARE_WRITE_FUNCTION(uint8_t, Write8,);
+		OV_DECLARE_WRITE_FUNCTION(uint8_t, Write8, StoreHost);
 		/// 현재 offset 위치에 16bit 데이터를 기록함 (endian을 별도로 지정하지 않음)
 		///
 		/// @return 16bit 데이터 형식의 데이터
-		OV_DECLARE_WRITE_FUNCTION(uint16_t, Write16,);
+		OV_DECLARE_WRITE_FUNCTION(uint16_t, Write16, StoreHost);
 		/// 현재 offset 위치에 32bit 데이터를 기록함 (endian을 별도로 지정하지 않음)
 		///
 		/// @return 32bit 데이터 형식의 데이터
-		OV_DECLARE_WRITE_FUNCTION(uint32_t, Write32,);
+		OV_DECLARE_WRITE_FUNCTION(uint32_t, Write32, StoreHost);
 		/// 현재 offset 위치에 64bit 데이터를 기록함 (endian을 별도로 지정하지 않음)
 		///
 		/// @return 64bit 데이터 형식의 데이터
-		OV_DECLARE_WRITE_FUNCTION(uint64_t, Write64,);
+		OV_DECLARE_WRITE_FUNCTION(uint64_t, Write64, StoreHost);
 
 		// LE => HE (Data안에 Little Endian으로 저장되어 있는 것을 Host endian으로 읽음)
 
 		/// 현재 offset 위치에 host endian 데이터를 little endian 16bit 데이터로 변환하여 기록함
 		///
 		/// @return 16bit 데이터 형식의 데이터
-		OV_DECLARE_WRITE_FUNCTION(uint16_t, WriteLE16, HostToLE16);
+		OV_DECLARE_WRITE_FUNCTION(uint16_t, WriteLE16, StoreLE);
 		/// 현재 offset 위치에 host endian 데이터를 little endian 32bit 데이터로 변환하여 기록함
 		///
 		/// @return 32bit 데이터 형식의 데이터
-		OV_DECLARE_WRITE_FUNCTION(uint32_t, WriteLE32, HostToLE32);
+		OV_DECLARE_WRITE_FUNCTION(uint32_t, WriteLE32, StoreLE);
 		/// 현재 offset 위치에 host endian 데이터를 little endian 64bit 데이터로 변환하여 기록함
 		///
 		/// @return 64bit 데이터 형식의 데이터
-		OV_DECLARE_WRITE_FUNCTION(uint64_t, WriteLE64, HostToLE64);
+		OV_DECLARE_WRITE_FUNCTION(uint64_t, WriteLE64, StoreLE);
 
 		// BE => HE (Data안에 Big Endian으로 저장되어 있는 것을 Host endian으로 읽음)
 
 		/// 현재 offset 위치에 host endian 데이터를 big endian 16bit 데이터로 변환하여 기록함
 		///
 		/// @return 16bit 데이터 형식의 데이터
-		OV_DECLARE_WRITE_FUNCTION(uint16_t, WriteBE16, HostToBE16);
+		OV_DECLARE_WRITE_FUNCTION(uint16_t, WriteBE16, StoreBE);
 		/// 현재 offset 위치에 host endian 데이터를 big endian 32bit 데이터로 변환하여 기록함
 		///
 		/// @return 32bit 데이터 형식의 데이터
-		OV_DECLARE_WRITE_FUNCTION(uint32_t, WriteBE32, HostToBE32);
+		OV_DECLARE_WRITE_FUNCTION(uint32_t, WriteBE32, StoreBE);
 		/// 현재 offset 위치에 host endian 데이터를 big endian 64bit 데이터로 변환하여 기록함
 		///
 		/// @return 64bit 데이터 형식의 데이터
-		OV_DECLARE_WRITE_FUNCTION(uint64_t, WriteBE64, HostToBE64);
+		OV_DECLARE_WRITE_FUNCTION(uint64_t, WriteBE64, StoreBE);
 
 		// NE => HE (Data안에 Network Endian으로 저장되어 있는 것을 Host endian으로 읽음)
 
 		/// 현재 offset 위치에 host endian 데이터를 network endian 16bit 데이터로 변환하여 기록함
 		///
 		/// @return 16bit 데이터 형식의 데이터
-		OV_DECLARE_WRITE_FUNCTION(uint16_t, WriteNE16, HostToNetwork16);
+		OV_DECLARE_WRITE_FUNCTION(uint16_t, WriteNE16, StoreBE);
 		/// 현재 offset 위치에 host endian 데이터를 network endian 32bit 데이터로 변환하여 기록함
 		///
 		/// @return 32bit 데이터 형식의 데이터
-		OV_DECLARE_WRITE_FUNCTION(uint32_t, WriteNE32, HostToNetwork32);
+		OV_DECLARE_WRITE_FUNCTION(uint32_t, WriteNE32, StoreBE);
 		/// 현재 offset 위치에 host endian 데이터를 network endian 64bit 데이터로 변환하여 기록함
 		///
 		/// @return 64bit 데이터 형식의 데이터
-		OV_DECLARE_WRITE_FUNCTION(uint64_t, WriteNE64, HostToNetwork64);
+		OV_DECLARE_WRITE_FUNCTION(uint64_t, WriteNE64, StoreBE);
 
 		/// T 형태로 변환하였을 때, 남은(읽을 수 있는) 데이터 수. length와 offset만 고려하며, capacity와는 무관함
 		///
@@ -9,6 +9,7 @@
 #include "data.h"
 #include "./assert.h"
 #include "./dump_utilities.h"
+#include "./buffer_pool.h"
 
 #include <cstdint>
 
@@ -48,14 +49,18 @@ namespace ov
 
 	Data::Data(const Data &data)
 	{
-		_reference_data = data._reference_data;
 		if(data._allocated_data != nullptr)
 		{
-			_allocated_data = std::make_shared<std::vector<uint8_t>>();
+			// Copy the data only (the headroom is not copied)
+			_allocated_data = BufferPool::Allocate(data._length);
 			Append(&data);
 		}
-		_offset = data._offset;
-		_length = data._length;
+		else
+		{
+			_reference_data = data._reference_data;
+			_offset = data._offset;
+			_length = data._length;
+		}
 	}
 
 	Data::Data(Data &&data) noexcept
@@ -214,8 +219,8 @@ namespace ov
 		// Reset the offset
 		_offset = 0L;
 
-		_allocated_data = std::make_shared<std::vector<uint8_t>>(begin, end);
-		_allocated_data->reserve(old_data->capacity() - old_offset);
+		_allocated_data = BufferPool::Allocate(old_data->capacity() - old_offset);
+		_allocated_data->assign(begin, end);
 
 		return (_allocated_data != nullptr);
 	}
@@ -233,10 +238,88 @@ namespace ov
 		}
 		else
 		{
-			_allocated_data = std::make_shared<std::vector<uint8_t>>();
+			// MTU-sized and small buffers are recycled by the pool
+			_allocated_data = BufferPool::Allocate(capacity);
+		}
+
+		_allocated_data->reserve(_offset + capacity);
+		BufferPool::UpdateAccounting(_allocated_data);
+
+		return true;
+	}
+
+	bool Data::ReserveHeadroom(size_t headroom, size_t capacity)
+	{
+		if(((_reference_data != nullptr) || (_allocated_data != nullptr)) && (Detach() == false))
+		{
+			return false;
+		}
+
+		if(_allocated_data == nullptr)
+		{
+			_allocated_data = BufferPool::Allocate(0);
+		}
+
+		capacity = std::max(capacity, _length);
+
+		if(static_cast<size_t>(_offset) >= headroom)
+		{
+			_allocated_data->reserve(_offset + capacity);
+			BufferPool::UpdateAccounting(_allocated_data);
+			return true;
+		}
+
+		auto new_data = BufferPool::Allocate(headroom + capacity);
+		auto begin = _allocated_data->begin() + _offset;
+
+		new_data->resize(headroom);
+		new_data->insert(new_data->end(), begin, begin + _length);
+		BufferPool::UpdateAccounting(new_data);
+
+		_allocated_data = new_data;
+		_offset = headroom;
+
+		return true;
+	}
+
+	bool Data::Prepend(const void *data, size_t length)
+	{
+		if(data == nullptr)
+		{
+			OV_ASSERT(false, "Invalid parameter: data must not be NULL");
+			return false;
 		}
 
-		_allocated_data->reserve(capacity);
+		if(Detach() == false)
+		{
+			return false;
+		}
+
+		if(static_cast<size_t>(_offset) < length)
+		{
+			// Not enough headroom
+			return Insert(data, 0, length);
+		}
+
+		_offset -= length;
+		_length += length;
+
+		::memcpy(_allocated_data->data() + _offset, data, length);
+
+		return true;
+	}
+
+	bool Data::TrimFront(size_t length)
+	{
+		if(length > _length)
+		{
+			OV_ASSERT(false, "Invalid length: %zu (current length: %zu)", length, _length);
+			return false;
+		}
+
+		// The buffer is not modified, so it does not need to be detached
+		_offset += length;
+		_length -= length;
 
 		return true;
 	}
@@ -245,7 +328,7 @@ namespace ov
 	{
 		// Reallocate the buffer (this method is faster than Detach() & clear());
 		_reference_data = nullptr;
-		_allocated_data = std::make_shared<std::vector<uint8_t>>();
+		_allocated_data = BufferPool::Allocate(0);
 		_offset = 0;
 		_length = 0;
 
@@ -286,6 +369,9 @@ namespace ov
 		_allocated_data->insert(_allocated_data->begin() + (_offset + offset), source, source + length);
 		_length += length;
 
+		// The buffer can be grown by insert()
+		BufferPool::UpdateAccounting(_allocated_data);
+
 		return true;
 	}
 
@@ -316,15 +402,16 @@ namespace ov
 			return false;
 		}
 
-		if((offset < 0) || (offset + length >= _length))
+		if((offset < 0) || (offset + length > _length))
 		{
 			OV_ASSERT(false, "Invalid offset: %jd, length: %zu (current length: %zu)", offset, length, _length);
+			return false;
 		}
 
-		_allocated_data->erase(_allocated_data->begin() + offset, _allocated_data->begin() + length);
-		_length -= length;
+		auto begin = _allocated_data->begin() + (_offset + offset);
 
-		OV_ASSERT2(_length = _allocated_data->size());
+		_allocated_data->erase(begin, begin + length);
+		_length -= length;
 
 		return true;
 	}
@@ -346,6 +433,6 @@ namespace ov
 
 	String Data::ToString() const
 	{
-		return ToHexString(static_cast<const uint8_t *>(GetData()) + _offset, GetLength());
+		return ToHexString(static_cast<const uint8_t *>(GetData()), GetLength());
 	}
 }
\ No newline at end of file
@@ -22,6 +22,8 @@ namespace ov
 	class Data
 	{
 	public:
+		friend class DataView;
+
 		// Default constructor
 		Data();
 
@@ -57,7 +59,7 @@ namespace ov
 		/// @return read-only pointer
 		inline const void *GetData() const
 		{
-			return (_reference_data != nullptr) ? _reference_data : _allocated_data->data() + _offset;
+			return (_reference_data != nullptr) ? static_cast<const uint8_t *>(_reference_data) + _offset : _allocated_data->data() + _offset;
 		}
 
 		template<typename T>
@@ -98,7 +100,7 @@ namespace ov
 			// Detach() will called in Reserve()
 			if(Reserve(length))
 			{
-				_allocated_data->resize(length);
+				_allocated_data->resize(_offset + length);
 				_length = length;
 				return true;
 			}
@@ -140,6 +142,29 @@ namespace ov
 
 		bool Erase(off_t offset, size_t length);
 
+		/// 데이터 앞에 headroom byte만큼 빈 공간을 확보 (이후 Prepend()/TrimFront()는 데이터를 이동하지 않음)
+		///
+		/// @param headroom 확보할 앞 공간의 크기
+		/// @param capacity headroom 뒤에 확보할 메모리 크기 (0: 현재 데이터 크기)
+		///
+		/// @return 메모리가 정상적으로 할당되었는지 여부
+		///
+		/// @remarks 이미 headroom이 충분하면 아무 것도 하지 않음. 다른 instance와 공유 중이면 cow가 발생하며,
+		///          cow로 복사된 데이터에는 headroom이 없음
+		bool ReserveHeadroom(size_t headroom, size_t capacity = 0);
+
+		/// 데이터 앞에 남아 있는 빈 공간의 크기
+		inline size_t GetHeadroom() const noexcept
+		{
+			return ((_reference_data == nullptr) && (_allocated_data != nullptr)) ? static_cast<size_t>(_offset) : 0;
+		}
+
+		/// 데이터 앞에 추가. headroom이 충분하면 O(1)이며, 부족하면 Insert()와 같이 동작함
+		bool Prepend(const void *data, size_t length);
+
+		/// 앞에서 length byte를 제거. 데이터를 이동하지 않으며, 제거된 공간은 headroom이 됨
+		bool TrimFront(size_t length);
+
 		/// this 데이터의 일부 영역만 참조하는 Data instance 생성
 		///
 		/// @param offset 원본 데이터에서 참조할 offset. 만약 offset이 음수라면, <GetLength() + offset> 부분부터 참조하는 instance를 생성함
@@ -151,6 +176,7 @@ namespace ov
 		/// 다른 Data instance가 입력될 경우, 기본적으로 copy-on-write 모드로 동작함.
 		/// 즉, 원본 데이터나 this에 아무런 조작을 하지 않을 경우 포인터만 보관하고 있으며,
 		/// 다른 Data instance의 데이터 혹은 this instance의 데이터가 변경되면 그 때 메모리 복사가 이루어짐.
+		/// 자주 호출되는 경로에서는 instance를 할당하지 않는 DataView를 사용할 것
 		std::shared_ptr<Data> Subdata(off_t offset, size_t length);
 		std::shared_ptr<const Data> Subdata(off_t offset, size_t length) const;
 		std::shared_ptr<Data> Subdata(off_t offset);
@@ -0,0 +1,140 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "./data.h"
+
+#include <memory>
+#include <vector>
+
+namespace ov
+{
+	// A range of the bytes of a Data (e.g. a sample of a fragment, the remaining bytes of a received packet)
+	//
+	// - Unlike Data::Subdata(), nothing is allocated: the view is a value (a pointer, a length and the buffer)
+	// - The buffer of the Data is shared by the view, so the view is never changed:
+	//   if the Data is modified later, the Data is detached (copy-on-write) instead
+	// - If the Data refers the memory (reference_only), or the view is created from a pointer,
+	//   the memory is not owned by the view, so the owner must outlive the view (like StringView)
+	class DataView
+	{
+	public:
+		DataView() = default;
+
+		DataView(const void *data, size_t length)
+			: _data(static_cast<const uint8_t *>(data)),
+			  _length(length)
+		{
+		}
+
+		explicit DataView(const Data &data)
+			: _buffer(data._reference_data == nullptr ? data._allocated_data : nullptr),
+			  _data(data.GetDataAs<uint8_t>()),
+			  _length(data.GetLength())
+		{
+		}
+
+		explicit DataView(const std::shared_ptr<const Data> &data)
+		{
+			if(data != nullptr)
+			{
+				*this = DataView(*data);
+			}
+		}
+
+		DataView(const std::shared_ptr<const Data> &data, size_t offset, size_t length)
+			: DataView(data)
+		{
+			*this = Subdata(offset, length);
+		}
+
+		const void *GetData() const noexcept
+		{
+			return _data;
+		}
+
+		template<typename T>
+		const T *GetDataAs() const noexcept
+		{
+			return reinterpret_cast<const T *>(_data);
+		}
+
+		size_t GetLength() const noexcept
+		{
+			return _length;
+		}
+
+		bool IsEmpty() const noexcept
+		{
+			return _length == 0;
+		}
+
+		uint8_t operator [](size_t index) const noexcept
+		{
+			return _data[index];
+		}
+
+		// Owns (or shares) the buffer, so the view is valid after the source is released
+		bool IsOwned() const noexcept
+		{
+			return _buffer != nullptr;
+		}
+
+		/// The range of this view
+		///
+		/// @remarks If the range is out of this view, it is clamped (like std::string::substr())
+		DataView Subdata(size_t offset, size_t length) const noexcept
+		{
+			DataView view(*this);
+
+			offset = std::min(offset, _length);
+			view._data = _data + offset;
+			view._length = std::min(length, _length - offset);
+
+			return view;
+		}
+
+		DataView Subdata(size_t offset) const noexcept
+		{
+			return Subdata(offset, _length);
+		}
+
+		/// A Data which refers the range, for the APIs which take a Data (e.g. sending)
+		///
+		/// @remarks The buffer is shared without copying (copy-on-write).
+		///          If the view doesn't own the memory, the Data refers the memory too (reference_only)
+		std::shared_ptr<const Data> ToData() const
+		{
+			if(_buffer == nullptr)
+			{
+				return std::make_shared<Data>(_data, _length, true);
+			}
+
+			auto data = std::make_shared<Data>();
+
+			data->_allocated_data = std::const_pointer_cast<std::vector<uint8_t>>(_buffer);
+			data->_offset = _data - _buffer->data();
+			data->_length = _length;
+
+			return data;
+		}
+
+		// Copies the range
+		std::shared_ptr<Data> Clone() const
+		{
+			return std::make_shared<Data>(_data, _length);
+		}
+
+	protected:
+		// nullptr if the memory is not owned
+		std::shared_ptr<const std::vector<uint8_t>> _buffer;
+
+		const uint8_t *_data = nullptr;
+		size_t _length = 0;
+	};
+}
@@ -0,0 +1,91 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./drain_mode.h"
+#include "./log.h"
+#include "./ovlibrary_private.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace ov
+{
+	void DrainMode::SetConfig(const DrainConfig &config)
+	{
+		_config = config;
+		_config.timeout = std::max(_config.timeout, 0);
+		_config.stagger_window = std::min(std::max(_config.stagger_window, 0), _config.timeout);
+		_config.retry_after = std::max(_config.retry_after, 1);
+	}
+
+	bool DrainMode::Start()
+	{
+		if(_draining)
+		{
+			return false;
+		}
+
+		_start_time = GetCurrentTime();
+		_draining = true;
+
+		logtw("Draining is started - timeout(%d ms) stagger window(%d ms) redirect(%s)",
+		      _config.timeout, _config.stagger_window, _config.redirect_url.empty() ? "none" : _config.redirect_url.c_str());
+
+		return true;
+	}
+
+	int64_t DrainMode::GetElapsedTime() const
+	{
+		if(IsDraining() == false)
+		{
+			return 0;
+		}
+
+		return GetCurrentTime() - _start_time.load(std::memory_order_relaxed);
+	}
+
+	bool DrainMode::IsStaggered() const
+	{
+		return IsDraining() && (GetElapsedTime() >= _config.stagger_window);
+	}
+
+	bool DrainMode::IsExpired() const
+	{
+		return IsDraining() && (GetElapsedTime() >= _config.timeout);
+	}
+
+	bool DrainMode::ShouldMove(uint64_t key) const
+	{
+		if(IsDraining() == false)
+		{
+			return false;
+		}
+
+		int64_t elapsed = GetElapsedTime();
+
+		if(elapsed >= _config.stagger_window)
+		{
+			return true;
+		}
+
+		// Mixes the key (splitmix64), the ids/hashes of the clients may not be uniform
+		key += 0x9E3779B97F4A7C15ULL;
+		key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+		key ^= (key >> 31);
+
+		// Share of the moved clients (1/1000)
+		uint64_t share = static_cast<uint64_t>(elapsed) * 1000ULL / static_cast<uint64_t>(_config.stagger_window);
+
+		return (key % 1000ULL) < share;
+	}
+
+	int64_t DrainMode::GetCurrentTime()
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
@@ -0,0 +1,82 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "./singleton.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace ov
+{
+	struct DrainConfig
+	{
+		// ms, the remaining sessions are closed at the deadline
+		int timeout = 30000;
+		// ms, the clients are moved to the other nodes gradually in this window (from the start of the drain)
+		int stagger_window = 10000;
+		// Seconds of Retry-After of 503
+		int retry_after = 5;
+		// The playlists are redirected to this url + the path of the request (empty: 503)
+		std::string redirect_url;
+	};
+
+	// Graceful drain before the process is terminated (zero-downtime deploys)
+	//
+	// - Started by SIGTERM if <Drain> is configured: the new signalling/WHIP/WHEP requests and the new ingest streams are refused
+	// - The existing clients are not dropped at once: the share of the clients which are moved
+	//   (the WebRTC clients are asked to reconnect, the playlists are redirected or respond 503) rises from 0 to 100%
+	//   linearly in the stagger window, so the other nodes receive them gradually
+	// - The modules check IsDraining() (lock-free) and ShouldMove() with a stable key of the client
+	class DrainMode : public Singleton<DrainMode>
+	{
+	public:
+		friend class Singleton<DrainMode>;
+
+		// Must be called before Start()
+		void SetConfig(const DrainConfig &config);
+
+		const DrainConfig &GetConfig() const
+		{
+			return _config;
+		}
+
+		// Returns false if it is already draining
+		bool Start();
+
+		bool IsDraining() const
+		{
+			return _draining.load(std::memory_order_relaxed);
+		}
+
+		// ms since the drain is started (0 if not draining)
+		int64_t GetElapsedTime() const;
+
+		// true if the stagger window is passed (all clients are asked to move)
+		bool IsStaggered() const;
+		// true if the deadline is passed
+		bool IsExpired() const;
+
+		// Whether the client should be moved to another node now
+		// - key: a stable value of the client (ex: the id of the session, the hash of the address),
+		//   so a client which is moved keeps being moved
+		bool ShouldMove(uint64_t key) const;
+
+	protected:
+		DrainMode() = default;
+
+		static int64_t GetCurrentTime();
+
+		DrainConfig _config;
+
+		std::atomic<bool> _draining { false };
+		// ms (monotonic)
+		std::atomic<int64_t> _start_time { 0 };
+	};
+}
@@ -0,0 +1,287 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Minimum number of the slots (must be a power of 2)
+#define OV_HASH_TABLE_MIN_CAPACITY		16
+// The table grows when the used and the deleted slots exceed 3/4 of the slots
+#define OV_HASH_TABLE_MAX_LOAD(capacity)	(((capacity) >> 1) + ((capacity) >> 2))
+
+namespace ov
+{
+	// FNV-1a (64 bits)
+	inline uint64_t HashBytes(const void *data, size_t length)
+	{
+		auto bytes = static_cast<const uint8_t *>(data);
+		uint64_t hash = 14695981039346656037ULL;
+
+		for(size_t index = 0; index < length; index++)
+		{
+			hash ^= bytes[index];
+			hash *= 1099511628211ULL;
+		}
+
+		return hash;
+	}
+
+	// Open addressing hash table (linear probing)
+	//
+	// - The slots are stored in a contiguous array, so a lookup usually touches a cache line or two
+	// - The hash of the key is kept in the slot, the keys are compared only if the hashes are same
+	// - Erased slots are marked as deleted (tombstone), and they are removed when the table is rehashed
+	// - Not thread-safe (the owner guards it, e.g. with a shared lock for the readers)
+	template<typename Tkey, typename Tvalue, typename Thash = std::hash<Tkey>>
+	class HashTable
+	{
+	public:
+		explicit HashTable(size_t capacity = OV_HASH_TABLE_MIN_CAPACITY)
+		{
+			size_t slot_count = OV_HASH_TABLE_MIN_CAPACITY;
+
+			while(OV_HASH_TABLE_MAX_LOAD(slot_count) < capacity)
+			{
+				slot_count <<= 1;
+			}
+
+			_slots.resize(slot_count);
+		}
+
+		// Inserts the value, or replaces the value of the key
+		void Insert(const Tkey &key, const Tvalue &value)
+		{
+			uint64_t hash = Thash()(key);
+			Slot *deleted_slot = nullptr;
+			size_t mask = _slots.size() - 1;
+
+			for(size_t index = hash & mask;; index = (index + 1) & mask)
+			{
+				auto &slot = _slots[index];
+
+				if(slot.state == SlotState::Empty)
+				{
+					break;
+				}
+
+				if(slot.state == SlotState::Deleted)
+				{
+					if(deleted_slot == nullptr)
+					{
+						deleted_slot = &slot;
+					}
+				}
+				else if((slot.hash == hash) && (slot.key == key))
+				{
+					slot.value = value;
+					return;
+				}
+			}
+
+			if(deleted_slot != nullptr)
+			{
+				// Reuse the tombstone
+				deleted_slot->state = SlotState::Used;
+				deleted_slot->hash = hash;
+				deleted_slot->key = key;
+				deleted_slot->value = value;
+
+				_deleted_count--;
+				_count++;
+				return;
+			}
+
+			if((_count + _deleted_count + 1) > OV_HASH_TABLE_MAX_LOAD(_slots.size()))
+			{
+				// Grow if the table is full of the used slots, otherwise the tombstones are removed
+				Rehash(((_count + 1) > (OV_HASH_TABLE_MAX_LOAD(_slots.size()) / 2)) ? (_slots.size() << 1) : _slots.size());
+			}
+
+			auto &slot = FindEmptySlot(hash);
+
+			slot.state = SlotState::Used;
+			slot.hash = hash;
+			slot.key = key;
+			slot.value = value;
+
+			_count++;
+		}
+
+		// nullptr if the key is not found (the pointer is valid until the table is modified)
+		Tvalue *Find(const Tkey &key)
+		{
+			auto slot = FindSlot(key);
+
+			return (slot != nullptr) ? &(slot->value) : nullptr;
+		}
+
+		const Tvalue *Find(const Tkey &key) const
+		{
+			auto slot = const_cast<HashTable *>(this)->FindSlot(key);
+
+			return (slot != nullptr) ? &(slot->value) : nullptr;
+		}
+
+		bool Contains(const Tkey &key) const
+		{
+			return Find(key) != nullptr;
+		}
+
+		bool Erase(const Tkey &key)
+		{
+			auto slot = FindSlot(key);
+
+			if(slot == nullptr)
+			{
+				return false;
+			}
+
+			EraseSlot(*slot);
+
+			return true;
+		}
+
+		// Erases the items which function(key, value) returns true, returns the number of the erased items
+		template<typename Tfunction>
+		size_t EraseIf(Tfunction function)
+		{
+			size_t erased_count = 0;
+
+			for(auto &slot : _slots)
+			{
+				if((slot.state == SlotState::Used) && function(slot.key, slot.value))
+				{
+					EraseSlot(slot);
+					erased_count++;
+				}
+			}
+
+			return erased_count;
+		}
+
+		// Calls function(key, value) for each item (the order is not defined)
+		template<typename Tfunction>
+		void ForEach(Tfunction function) const
+		{
+			for(auto &slot : _slots)
+			{
+				if(slot.state == SlotState::Used)
+				{
+					function(slot.key, slot.value);
+				}
+			}
+		}
+
+		void Clear()
+		{
+			for(auto &slot : _slots)
+			{
+				slot = Slot();
+			}
+
+			_count = 0;
+			_deleted_count = 0;
+		}
+
+		size_t GetCount() const
+		{
+			return _count;
+		}
+
+		bool IsEmpty() const
+		{
+			return _count == 0;
+		}
+
+	protected:
+		enum class SlotState : uint8_t
+		{
+			Empty,
+			Used,
+			Deleted
+		};
+
+		struct Slot
+		{
+			SlotState state = SlotState::Empty;
+			uint64_t hash = 0;
+			Tkey key {};
+			Tvalue value {};
+		};
+
+		Slot *FindSlot(const Tkey &key)
+		{
+			uint64_t hash = Thash()(key);
+			size_t mask = _slots.size() - 1;
+
+			for(size_t index = hash & mask;; index = (index + 1) & mask)
+			{
+				auto &slot = _slots[index];
+
+				if(slot.state == SlotState::Empty)
+				{
+					return nullptr;
+				}
+
+				if((slot.state == SlotState::Used) && (slot.hash == hash) && (slot.key == key))
+				{
+					return &slot;
+				}
+			}
+		}
+
+		Slot &FindEmptySlot(uint64_t hash)
+		{
+			size_t mask = _slots.size() - 1;
+			size_t index = hash & mask;
+
+			while(_slots[index].state != SlotState::Empty)
+			{
+				index = (index + 1) & mask;
+			}
+
+			return _slots[index];
+		}
+
+		void EraseSlot(Slot &slot)
+		{
+			// Release the key and the value (e.g. shared_ptr) now
+			slot.key = Tkey();
+			slot.value = Tvalue();
+			slot.state = SlotState::Deleted;
+
+			_count--;
+			_deleted_count++;
+		}
+
+		void Rehash(size_t slot_count)
+		{
+			std::vector<Slot> old_slots(slot_count);
+			old_slots.swap(_slots);
+
+			_deleted_count = 0;
+
+			for(auto &old_slot : old_slots)
+			{
+				if(old_slot.state == SlotState::Used)
+				{
+					auto &slot = FindEmptySlot(old_slot.hash);
+					slot = std::move(old_slot);
+				}
+			}
+		}
+
+		std::vector<Slot> _slots;
+		size_t _count = 0;
+		size_t _deleted_count = 0;
+	};
+}
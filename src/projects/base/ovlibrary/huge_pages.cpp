@@ -0,0 +1,193 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./huge_pages.h"
+#include "./log.h"
+#include "./ovlibrary_private.h"
+#include "./platform.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace ov
+{
+	namespace
+	{
+		struct Counters
+		{
+			std::atomic<uint64_t> advised_count { 0 };
+			std::atomic<uint64_t> advised_bytes { 0 };
+			std::atomic<uint64_t> failed_count { 0 };
+			std::atomic<int64_t> hugetlb_count { 0 };
+			std::atomic<int64_t> hugetlb_bytes { 0 };
+		};
+
+		Counters &GetCounters()
+		{
+			// Never destroyed, because buffers can be released while static objects are being destroyed
+			static Counters *counters = new Counters();
+
+			return *counters;
+		}
+
+		// "always [madvise] never" (empty: not supported)
+		String ReadTransparentHugePageMode()
+		{
+#if IS_LINUX
+			FILE *file = ::fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+
+			if(file == nullptr)
+			{
+				return "";
+			}
+
+			char line[128] = { 0 };
+			bool read = (::fgets(line, sizeof(line), file) != nullptr);
+
+			::fclose(file);
+
+			if(read == false)
+			{
+				return "";
+			}
+
+			const char *begin = ::strchr(line, '[');
+			const char *end = (begin != nullptr) ? ::strchr(begin, ']') : nullptr;
+
+			return (end != nullptr) ? String(begin + 1, static_cast<size_t>(end - begin - 1)) : "";
+#else
+			return "";
+#endif
+		}
+
+		uint64_t ReadAnonHugeBytes()
+		{
+#if IS_LINUX
+			FILE *file = ::fopen("/proc/self/smaps_rollup", "r");
+
+			if(file == nullptr)
+			{
+				return 0;
+			}
+
+			char line[256];
+			unsigned long long kilobytes = 0;
+
+			while(::fgets(line, sizeof(line), file) != nullptr)
+			{
+				if(::sscanf(line, "AnonHugePages: %llu kB", &kilobytes) == 1)
+				{
+					break;
+				}
+			}
+
+			::fclose(file);
+
+			return static_cast<uint64_t>(kilobytes) * 1024ULL;
+#else
+			return 0;
+#endif
+		}
+	}
+
+	std::atomic<bool> HugePages::_enabled { false };
+
+	bool HugePages::SetEnabled(bool enabled)
+	{
+		if(enabled == false)
+		{
+			_enabled = false;
+			return true;
+		}
+
+		auto mode = ReadTransparentHugePageMode();
+
+		if(mode.IsEmpty() || (mode == "never"))
+		{
+			logtw("Huge pages are disabled (transparent huge pages are not available: %s)", mode.IsEmpty() ? "not supported" : mode.CStr());
+
+			_enabled = false;
+			return false;
+		}
+
+		logti("Huge pages are enabled (transparent huge pages: %s)", mode.CStr());
+
+		_enabled = true;
+		return true;
+	}
+
+	void HugePages::Advise(const void *address, size_t length)
+	{
+		if((IsEnabled() == false) || (address == nullptr) || (length < OV_HUGE_PAGE_SIZE))
+		{
+			return;
+		}
+
+		// Only the huge pages inside the buffer (the rest may be shared with the other allocations)
+		uintptr_t begin = Align(reinterpret_cast<uintptr_t>(address));
+		uintptr_t end = (reinterpret_cast<uintptr_t>(address) + length) & ~static_cast<uintptr_t>(OV_HUGE_PAGE_SIZE - 1);
+
+		if(begin >= end)
+		{
+			return;
+		}
+
+		auto &counters = GetCounters();
+
+#if IS_LINUX
+		if(::madvise(reinterpret_cast<void *>(begin), end - begin, MADV_HUGEPAGE) == 0)
+		{
+			counters.advised_count.fetch_add(1, std::memory_order_relaxed);
+			counters.advised_bytes.fetch_add(end - begin, std::memory_order_relaxed);
+			return;
+		}
+#endif
+
+		counters.failed_count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void HugePages::AddHugeTlbRegion(int64_t bytes)
+	{
+		auto &counters = GetCounters();
+
+		counters.hugetlb_count.fetch_add((bytes >= 0) ? 1 : -1, std::memory_order_relaxed);
+		counters.hugetlb_bytes.fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	HugePageStatistics HugePages::GetStatistics()
+	{
+		HugePageStatistics statistics;
+		auto &counters = GetCounters();
+
+		statistics.advised_count = counters.advised_count.load(std::memory_order_relaxed);
+		statistics.advised_bytes = counters.advised_bytes.load(std::memory_order_relaxed);
+		statistics.failed_count = counters.failed_count.load(std::memory_order_relaxed);
+		statistics.hugetlb_count = static_cast<uint64_t>(std::max(counters.hugetlb_count.load(std::memory_order_relaxed), static_cast<int64_t>(0)));
+		statistics.hugetlb_bytes = static_cast<uint64_t>(std::max(counters.hugetlb_bytes.load(std::memory_order_relaxed), static_cast<int64_t>(0)));
+		statistics.anon_huge_bytes = ReadAnonHugeBytes();
+
+		return statistics;
+	}
+
+	String HugePages::GetStatisticsString()
+	{
+		auto statistics = GetStatistics();
+
+		return String::FormatString("huge pages(%s): advised: %llu (%llu bytes), failed: %llu, hugetlb: %llu (%llu bytes), anon huge: %llu bytes\n",
+		                            IsEnabled() ? "on" : "off",
+		                            static_cast<unsigned long long>(statistics.advised_count),
+		                            static_cast<unsigned long long>(statistics.advised_bytes),
+		                            static_cast<unsigned long long>(statistics.failed_count),
+		                            static_cast<unsigned long long>(statistics.hugetlb_count),
+		                            static_cast<unsigned long long>(statistics.hugetlb_bytes),
+		                            static_cast<unsigned long long>(statistics.anon_huge_bytes));
+	}
+}
@@ -0,0 +1,73 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "./string.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Size of a huge page of x86-64/AArch64 (4KB base pages)
+#define OV_HUGE_PAGE_SIZE						(2 * 1024 * 1024)
+
+namespace ov
+{
+	struct HugePageStatistics
+	{
+		// Buffers which are advised to be backed by the transparent huge pages (accumulated)
+		uint64_t advised_count = 0;
+		uint64_t advised_bytes = 0;
+		// madvise() is failed
+		uint64_t failed_count = 0;
+
+		// Regions which are mapped from the huge page pool (MAP_HUGETLB/MFD_HUGETLB) now
+		uint64_t hugetlb_count = 0;
+		uint64_t hugetlb_bytes = 0;
+
+		// Anonymous memory of the process which is backed by the huge pages now (AnonHugePages of /proc/self/smaps_rollup)
+		uint64_t anon_huge_bytes = 0;
+	};
+
+	// Huge pages for the large media buffers (fewer TLB misses with many streams)
+	//
+	// - The buffers of ov::Data/BufferPool and the RTMP message pool are std::vector (std::allocator),
+	//   so the 2MB-aligned part of the large buffers is advised to the transparent huge pages (MADV_HUGEPAGE)
+	//   instead of being mapped from the huge page pool
+	// - The regions which are mapped by OME itself (e.g. the relay rings) try MAP_HUGETLB first,
+	//   and fall back to the normal pages if the pool of the huge pages is empty
+	// - Disabled by default, and it is disabled again if the kernel doesn't support THP (or it is "never")
+	class HugePages
+	{
+	public:
+		static bool SetEnabled(bool enabled);
+
+		static bool IsEnabled()
+		{
+			return _enabled.load(std::memory_order_relaxed);
+		}
+
+		// No-op if it is disabled, or the buffer doesn't contain an aligned huge page
+		static void Advise(const void *address, size_t length);
+
+		// Called by the users of MAP_HUGETLB/MFD_HUGETLB (bytes < 0: unmapped)
+		static void AddHugeTlbRegion(int64_t bytes);
+
+		// Rounds up to the size of the huge pages
+		static size_t Align(size_t length)
+		{
+			return (length + OV_HUGE_PAGE_SIZE - 1) & ~static_cast<size_t>(OV_HUGE_PAGE_SIZE - 1);
+		}
+
+		static HugePageStatistics GetStatistics();
+		static String GetStatisticsString();
+
+	protected:
+		static std::atomic<bool> _enabled;
+	};
+}
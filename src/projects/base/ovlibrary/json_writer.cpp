@@ -0,0 +1,363 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./json_writer.h"
+#include "./assert.h"
+#include "./ovlibrary_private.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ov
+{
+	JsonWriter::JsonWriter(size_t capacity)
+	{
+		_buffer.reserve(capacity);
+	}
+
+	void JsonWriter::Clear()
+	{
+		_buffer.clear();
+
+		_depth = 0;
+		_has_element[0] = false;
+		_after_key = false;
+	}
+
+	void JsonWriter::BeginValue()
+	{
+		if(_after_key)
+		{
+			// "key": is already written
+			_after_key = false;
+			return;
+		}
+
+		if(_has_element[_depth])
+		{
+			Append(',');
+		}
+
+		_has_element[_depth] = true;
+	}
+
+	JsonWriter &JsonWriter::BeginContainer(char c)
+	{
+		if(_depth >= OV_JSON_WRITER_MAX_DEPTH)
+		{
+			OV_ASSERT(false, "Too deep JSON: %d", _depth);
+			return *this;
+		}
+
+		BeginValue();
+		Append(c);
+
+		_depth++;
+		_has_element[_depth] = false;
+
+		return *this;
+	}
+
+	JsonWriter &JsonWriter::EndContainer(char c)
+	{
+		if(_depth <= 0)
+		{
+			OV_ASSERT(false, "There is no object/array to close");
+			return *this;
+		}
+
+		_depth--;
+		Append(c);
+
+		return *this;
+	}
+
+	JsonWriter &JsonWriter::BeginObject()
+	{
+		return BeginContainer('{');
+	}
+
+	JsonWriter &JsonWriter::EndObject()
+	{
+		return EndContainer('}');
+	}
+
+	JsonWriter &JsonWriter::BeginArray()
+	{
+		return BeginContainer('[');
+	}
+
+	JsonWriter &JsonWriter::EndArray()
+	{
+		return EndContainer(']');
+	}
+
+	JsonWriter &JsonWriter::Key(const StringView &name)
+	{
+		BeginValue();
+		AppendString(name);
+		Append(':');
+
+		_after_key = true;
+
+		return *this;
+	}
+
+	JsonWriter &JsonWriter::Value(const char *value)
+	{
+		if(value == nullptr)
+		{
+			return Null();
+		}
+
+		return Value(StringView(value));
+	}
+
+	JsonWriter &JsonWriter::Value(const String &value)
+	{
+		return Value(StringView(value));
+	}
+
+	JsonWriter &JsonWriter::Value(const StringView &value)
+	{
+		BeginValue();
+		AppendString(value);
+
+		return *this;
+	}
+
+	JsonWriter &JsonWriter::Value(bool value)
+	{
+		BeginValue();
+
+		if(value)
+		{
+			Append("true", 4);
+		}
+		else
+		{
+			Append("false", 5);
+		}
+
+		return *this;
+	}
+
+	JsonWriter &JsonWriter::Value(int value)
+	{
+		return Value(static_cast<long>(value));
+	}
+
+	JsonWriter &JsonWriter::Value(unsigned int value)
+	{
+		return Value(static_cast<unsigned long>(value));
+	}
+
+	JsonWriter &JsonWriter::Value(long value)
+	{
+		char number[32];
+		int length = ::snprintf(number, sizeof(number), "%ld", value);
+
+		BeginValue();
+		Append(number, static_cast<size_t>(length));
+
+		return *this;
+	}
+
+	JsonWriter &JsonWriter::Value(unsigned long value)
+	{
+		char number[32];
+		int length = ::snprintf(number, sizeof(number), "%lu", value);
+
+		BeginValue();
+		Append(number, static_cast<size_t>(length));
+
+		return *this;
+	}
+
+	JsonWriter &JsonWriter::Value(double value)
+	{
+		if(std::isfinite(value) == false)
+		{
+			// NaN/Infinity can't be represented in JSON
+			return Null();
+		}
+
+		char number[32];
+		int length = ::snprintf(number, sizeof(number), "%.17g", value);
+
+		BeginValue();
+		Append(number, static_cast<size_t>(length));
+
+		return *this;
+	}
+
+	JsonWriter &JsonWriter::Value(double value, int precision)
+	{
+		if(std::isfinite(value) == false)
+		{
+			return Null();
+		}
+
+		char number[64];
+		int length = ::snprintf(number, sizeof(number), "%.*f", precision, value);
+
+		BeginValue();
+		Append(number, std::min(static_cast<size_t>(length), sizeof(number) - 1));
+
+		return *this;
+	}
+
+	JsonWriter &JsonWriter::Null()
+	{
+		BeginValue();
+		Append("null", 4);
+
+		return *this;
+	}
+
+	JsonWriter &JsonWriter::Value(const ::Json::Value &value)
+	{
+		switch(value.type())
+		{
+			case ::Json::ValueType::nullValue:
+				return Null();
+
+			case ::Json::ValueType::intValue:
+				return Value(static_cast<long>(value.asInt64()));
+
+			case ::Json::ValueType::uintValue:
+				return Value(static_cast<unsigned long>(value.asUInt64()));
+
+			case ::Json::ValueType::realValue:
+				return Value(value.asDouble());
+
+			case ::Json::ValueType::stringValue:
+			{
+				const char *begin = nullptr;
+				const char *end = nullptr;
+
+				value.getString(&begin, &end);
+
+				return Value(StringView(begin, end - begin));
+			}
+
+			case ::Json::ValueType::booleanValue:
+				return Value(value.asBool());
+
+			case ::Json::ValueType::arrayValue:
+				BeginArray();
+
+				for(const auto &item : value)
+				{
+					Value(item);
+				}
+
+				return EndArray();
+
+			case ::Json::ValueType::objectValue:
+				BeginObject();
+
+				for(auto iterator = value.begin(); iterator != value.end(); ++iterator)
+				{
+					const char *key_end = nullptr;
+					const char *key = iterator.memberName(&key_end);
+
+					Key(StringView(key, key_end - key));
+					Value(*iterator);
+				}
+
+				return EndObject();
+		}
+
+		return *this;
+	}
+
+	JsonWriter &JsonWriter::RawValue(const StringView &json)
+	{
+		BeginValue();
+		Append(json.GetData(), json.GetLength());
+
+		return *this;
+	}
+
+	JsonWriter &JsonWriter::RawText(const StringView &text)
+	{
+		Append(text.GetData(), text.GetLength());
+
+		return *this;
+	}
+
+	void JsonWriter::AppendString(const StringView &value)
+	{
+		static const char hex[] = "0123456789abcdef";
+
+		Append('"');
+
+		const char *data = value.GetData();
+		size_t length = value.GetLength();
+		size_t begin = 0;
+
+		for(size_t index = 0; index < length; index++)
+		{
+			auto c = static_cast<unsigned char>(data[index]);
+
+			if((c >= 0x20) && (c != '"') && (c != '\\'))
+			{
+				// UTF-8 sequences are written as they are
+				continue;
+			}
+
+			// Writes the characters which don't need to be escaped at once
+			Append(data + begin, index - begin);
+			begin = index + 1;
+
+			switch(c)
+			{
+				case '"':
+					Append("\\\"", 2);
+					break;
+				case '\\':
+					Append("\\\\", 2);
+					break;
+				case '\b':
+					Append("\\b", 2);
+					break;
+				case '\f':
+					Append("\\f", 2);
+					break;
+				case '\n':
+					Append("\\n", 2);
+					break;
+				case '\r':
+					Append("\\r", 2);
+					break;
+				case '\t':
+					Append("\\t", 2);
+					break;
+				default:
+				{
+					char escaped[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0F] };
+					Append(escaped, sizeof(escaped));
+					break;
+				}
+			}
+		}
+
+		Append(data + begin, length - begin);
+		Append('"');
+	}
+
+	ov::String JsonWriter::ToString() const
+	{
+		return ov::String(_buffer.data(), _buffer.size());
+	}
+
+	std::shared_ptr<const ov::Data> JsonWriter::ToData() const
+	{
+		return std::make_shared<ov::Data>(_buffer.data(), _buffer.size(), true);
+	}
+}
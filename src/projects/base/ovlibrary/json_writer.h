@@ -0,0 +1,125 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "./string.h"
+#include "./string_view.h"
+#include "./data.h"
+#include "./json_object.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Initial capacity of the buffer (grows as needed, and is kept by Clear())
+#define OV_JSON_WRITER_DEFAULT_CAPACITY			1024
+// Maximum depth of the nested objects/arrays
+#define OV_JSON_WRITER_MAX_DEPTH				32
+
+namespace ov
+{
+	// Writes JSON to the buffer directly, without building the tree of ::Json::Value (SAX style)
+	//
+	// - The separators are inserted by the writer, so the values are written in order:
+	//   ex) writer.BeginObject().Key("command").Value("offer").Key("id").Value(id).EndObject();
+	// - The buffer is reused after Clear(), so a writer which is kept by the thread doesn't allocate in the steady state
+	// - jsoncpp (ov::Json::Parse) is still used to parse the input from the outside
+	class JsonWriter
+	{
+	public:
+		explicit JsonWriter(size_t capacity = OV_JSON_WRITER_DEFAULT_CAPACITY);
+
+		// Removes the contents (the capacity of the buffer is kept)
+		void Clear();
+
+		JsonWriter &BeginObject();
+		JsonWriter &EndObject();
+		JsonWriter &BeginArray();
+		JsonWriter &EndArray();
+
+		// Name of the next value (in an object)
+		JsonWriter &Key(const StringView &name);
+
+		JsonWriter &Value(const char *value);
+		JsonWriter &Value(const String &value);
+		JsonWriter &Value(const StringView &value);
+		JsonWriter &Value(bool value);
+		JsonWriter &Value(int value);
+		JsonWriter &Value(unsigned int value);
+		JsonWriter &Value(long value);
+		JsonWriter &Value(unsigned long value);
+		JsonWriter &Value(double value);
+		// Fixed number of the digits after the decimal point (ex: timestamps in microseconds)
+		JsonWriter &Value(double value, int precision);
+		JsonWriter &Null();
+
+		// Writes the value which is parsed by jsoncpp (ex: a part of the message from the client is forwarded to the other peer)
+		JsonWriter &Value(const ::Json::Value &value);
+
+		// Writes the JSON text as a value (which must be valid JSON)
+		JsonWriter &RawValue(const StringView &json);
+
+		// Writes the text between the values without a separator (ex: a line feed to make the output readable)
+		JsonWriter &RawText(const StringView &text);
+
+		// Convenience methods for the members of an object
+		template<typename T>
+		JsonWriter &Member(const StringView &name, const T &value)
+		{
+			return Key(name).Value(value);
+		}
+
+		// All the objects/arrays are closed
+		bool IsCompleted() const
+		{
+			return (_depth == 0) && (_buffer.empty() == false);
+		}
+
+		const char *GetBuffer() const
+		{
+			return _buffer.data();
+		}
+
+		size_t GetLength() const
+		{
+			return _buffer.size();
+		}
+
+		ov::String ToString() const;
+
+		// Refers to the buffer of the writer (no copy), which is valid until the writer is modified
+		std::shared_ptr<const ov::Data> ToData() const;
+
+	protected:
+		// Writes the separator of the value (and marks that the container has an element)
+		void BeginValue();
+
+		void Append(char c)
+		{
+			_buffer.push_back(c);
+		}
+
+		void Append(const char *data, size_t length)
+		{
+			_buffer.insert(_buffer.end(), data, data + length);
+		}
+
+		void AppendString(const StringView &value);
+
+		JsonWriter &BeginContainer(char c);
+		JsonWriter &EndContainer(char c);
+
+		std::vector<char> _buffer;
+
+		int _depth = 0;
+		// Whether the container of each depth has an element
+		bool _has_element[OV_JSON_WRITER_MAX_DEPTH + 1] {};
+		// Key() is written, and waiting for the value
+		bool _after_key = false;
+	};
+}
@@ -0,0 +1,129 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./latency_histogram.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace ov
+{
+	LatencyHistogram::LatencyHistogram()
+	{
+		for(auto &bucket : _buckets)
+		{
+			bucket = 0;
+		}
+	}
+
+	int64_t LatencyHistogram::GetCurrentMicroseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	int LatencyHistogram::GetBucketIndex(int64_t value)
+	{
+		if(value < SubBucketCount)
+		{
+			// The small values are counted exactly
+			return static_cast<int>(value);
+		}
+
+		// The sub bucket of the value is in [HalfSubBucketCount, SubBucketCount)
+		int exponent = 63 - __builtin_clzll(static_cast<uint64_t>(value));
+		int shift = exponent - (OV_LATENCY_HISTOGRAM_SUB_BUCKET_BITS - 1);
+
+		return (shift * HalfSubBucketCount) + static_cast<int>(value >> shift);
+	}
+
+	int64_t LatencyHistogram::GetBucketValue(int index)
+	{
+		if(index < SubBucketCount)
+		{
+			return index;
+		}
+
+		int shift = (index / HalfSubBucketCount) - 1;
+		int64_t sub_bucket = index - (shift * HalfSubBucketCount);
+
+		return ((sub_bucket + 1) << shift) - 1;
+	}
+
+	void LatencyHistogram::Record(int64_t latency)
+	{
+		latency = std::min(std::max(latency, static_cast<int64_t>(0)), static_cast<int64_t>(OV_LATENCY_HISTOGRAM_MAX_VALUE));
+
+		_buckets[GetBucketIndex(latency)].fetch_add(1, std::memory_order_relaxed);
+		_count.fetch_add(1, std::memory_order_relaxed);
+		_sum.fetch_add(latency, std::memory_order_relaxed);
+
+		int64_t max = _max.load(std::memory_order_relaxed);
+
+		while((latency > max) && (_max.compare_exchange_weak(max, latency, std::memory_order_relaxed) == false))
+		{
+		}
+	}
+
+	void LatencyHistogram::Reset()
+	{
+		for(auto &bucket : _buckets)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+
+		_count = 0;
+		_sum = 0;
+		_max = 0;
+	}
+
+	uint64_t LatencyHistogram::GetCount() const
+	{
+		return _count.load(std::memory_order_relaxed);
+	}
+
+	int64_t LatencyHistogram::GetMax() const
+	{
+		return _max.load(std::memory_order_relaxed);
+	}
+
+	double LatencyHistogram::GetMean() const
+	{
+		uint64_t count = GetCount();
+
+		return (count > 0) ? (static_cast<double>(_sum.load(std::memory_order_relaxed)) / static_cast<double>(count)) : 0.0;
+	}
+
+	int64_t LatencyHistogram::GetPercentile(double percentile) const
+	{
+		uint64_t count = GetCount();
+
+		if(count == 0)
+		{
+			return 0;
+		}
+
+		percentile = std::min(std::max(percentile, 0.0), 100.0);
+
+		// Rank of the value (1 ~ count)
+		auto rank = std::max(static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(count) / 100.0)), static_cast<uint64_t>(1));
+		uint64_t accumulated = 0;
+
+		for(int index = 0; index < BucketCount; index++)
+		{
+			accumulated += _buckets[index].load(std::memory_order_relaxed);
+
+			if(accumulated >= rank)
+			{
+				// The bucket value can be greater than the max value
+				return std::min(GetBucketValue(index), GetMax());
+			}
+		}
+
+		return GetMax();
+	}
+}
@@ -0,0 +1,58 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Each power of two range is divided into 2^(BITS - 1) buckets (the error of a value is less than 1 / 2^(BITS - 1), about 3%)
+#define OV_LATENCY_HISTOGRAM_SUB_BUCKET_BITS		6
+// The values above it are counted as it (in microseconds, about 68 seconds)
+#define OV_LATENCY_HISTOGRAM_MAX_VALUE				((1LL << 36) - 1)
+
+namespace ov
+{
+	// Histogram of the latencies with the logarithmic buckets (like HdrHistogram)
+	//
+	// - Record() doesn't lock anything, so it can be called by several threads at the same time
+	// - The readers can see the counts which are being recorded, so the percentiles are approximate
+	class LatencyHistogram
+	{
+	public:
+		LatencyHistogram();
+
+		// latency: in microseconds (the negative values are counted as 0)
+		void Record(int64_t latency);
+		void Reset();
+
+		uint64_t GetCount() const;
+		int64_t GetMax() const;
+		double GetMean() const;
+
+		// percentile: 0 ~ 100 (the highest value of the bucket, 0 if there is no value)
+		int64_t GetPercentile(double percentile) const;
+
+		// Monotonic time to calculate the latencies (in microseconds)
+		static int64_t GetCurrentMicroseconds();
+
+	protected:
+		static int GetBucketIndex(int64_t value);
+		static int64_t GetBucketValue(int index);
+
+		static constexpr int SubBucketCount = (1 << OV_LATENCY_HISTOGRAM_SUB_BUCKET_BITS);
+		static constexpr int HalfSubBucketCount = (SubBucketCount / 2);
+		// Buckets which are needed for OV_LATENCY_HISTOGRAM_MAX_VALUE (36 bits)
+		static constexpr int BucketCount = (36 - OV_LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) * HalfSubBucketCount + HalfSubBucketCount;
+
+		std::atomic<uint64_t> _buckets[BucketCount];
+
+		std::atomic<uint64_t> _count { 0 };
+		std::atomic<int64_t> _sum { 0 };
+		std::atomic<int64_t> _max { 0 };
+	};
+}
@@ -0,0 +1,112 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./lock_profiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace ov
+{
+	std::atomic<bool> LockProfiler::_enabled { false };
+
+	void LockStatistics::RecordLock(bool contended, int64_t wait_time)
+	{
+		_lock_count.fetch_add(1, std::memory_order_relaxed);
+
+		if(contended)
+		{
+			_contention_count.fetch_add(1, std::memory_order_relaxed);
+			_total_wait_time.fetch_add(wait_time, std::memory_order_relaxed);
+			_wait_histogram.Record(wait_time / 1000);
+		}
+	}
+
+	void LockStatistics::RecordHold(int64_t hold_time)
+	{
+		_total_hold_time.fetch_add(hold_time, std::memory_order_relaxed);
+
+		int64_t max = _max_hold_time.load(std::memory_order_relaxed);
+
+		while((hold_time > max) && (_max_hold_time.compare_exchange_weak(max, hold_time, std::memory_order_relaxed) == false))
+		{
+		}
+	}
+
+	void LockStatistics::Reset()
+	{
+		_lock_count = 0;
+		_contention_count = 0;
+		_total_wait_time = 0;
+		_total_hold_time = 0;
+		_max_hold_time = 0;
+
+		_wait_histogram.Reset();
+	}
+
+	int64_t LockProfiler::GetCurrentNanoseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	std::shared_ptr<LockStatistics> LockProfiler::GetStatistics(const ov::String &name)
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		auto &statistics = _statistics_map[name];
+
+		if(statistics == nullptr)
+		{
+			statistics = std::make_shared<LockStatistics>(name);
+		}
+
+		return statistics;
+	}
+
+	std::vector<std::shared_ptr<LockStatistics>> LockProfiler::GetTopContended(size_t count)
+	{
+		// The wait times are changed while sorting, so they are copied first
+		std::vector<std::pair<int64_t, std::shared_ptr<LockStatistics>>> sorted_list;
+
+		{
+			std::lock_guard<std::mutex> lock_guard(_mutex);
+
+			for(const auto &item : _statistics_map)
+			{
+				sorted_list.emplace_back(item.second->GetTotalWaitTime(), item.second);
+			}
+		}
+
+		std::stable_sort(sorted_list.begin(), sorted_list.end(), [](const auto &lhs, const auto &rhs) -> bool {
+			return lhs.first > rhs.first;
+		});
+
+		if((count > 0) && (sorted_list.size() > count))
+		{
+			sorted_list.resize(count);
+		}
+
+		std::vector<std::shared_ptr<LockStatistics>> statistics_list;
+
+		for(const auto &item : sorted_list)
+		{
+			statistics_list.push_back(item.second);
+		}
+
+		return statistics_list;
+	}
+
+	void LockProfiler::Reset()
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		for(const auto &item : _statistics_map)
+		{
+			item.second->Reset();
+		}
+	}
+}
@@ -0,0 +1,307 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "./singleton.h"
+#include "./string.h"
+#include "./latency_histogram.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+// Number of the locks which are reported by default (ordered by the total wait time)
+#define OV_LOCK_PROFILER_DEFAULT_TOP_COUNT		20
+
+namespace ov
+{
+	// Statistics of all the locks which have the same name (e.g. _packet_queue_guard of every StreamWorker)
+	class LockStatistics
+	{
+	public:
+		explicit LockStatistics(const ov::String &name)
+			: _name(name)
+		{
+		}
+
+		const ov::String &GetName() const
+		{
+			return _name;
+		}
+
+		void RecordLock(bool contended, int64_t wait_time);
+		void RecordHold(int64_t hold_time);
+		void Reset();
+
+		uint64_t GetLockCount() const
+		{
+			return _lock_count.load(std::memory_order_relaxed);
+		}
+
+		uint64_t GetContentionCount() const
+		{
+			return _contention_count.load(std::memory_order_relaxed);
+		}
+
+		// in nanoseconds
+		int64_t GetTotalWaitTime() const
+		{
+			return _total_wait_time.load(std::memory_order_relaxed);
+		}
+
+		int64_t GetTotalHoldTime() const
+		{
+			return _total_hold_time.load(std::memory_order_relaxed);
+		}
+
+		int64_t GetMaxHoldTime() const
+		{
+			return _max_hold_time.load(std::memory_order_relaxed);
+		}
+
+		// Wait times of the contended locks (in microseconds)
+		const LatencyHistogram &GetWaitHistogram() const
+		{
+			return _wait_histogram;
+		}
+
+	protected:
+		ov::String _name;
+
+		std::atomic<uint64_t> _lock_count { 0 };
+		std::atomic<uint64_t> _contention_count { 0 };
+		std::atomic<int64_t> _total_wait_time { 0 };
+		std::atomic<int64_t> _total_hold_time { 0 };
+		std::atomic<int64_t> _max_hold_time { 0 };
+
+		LatencyHistogram _wait_histogram;
+	};
+
+	// Registry of the named locks
+	//
+	// - Profiling is disabled by default, and it can be enabled/disabled at runtime (the locks don't read the clock while disabled)
+	// - The statistics are never removed, so the locks can keep the pointer
+	class LockProfiler : public Singleton<LockProfiler>
+	{
+	public:
+		friend class Singleton<LockProfiler>;
+
+		static void SetEnabled(bool enabled)
+		{
+			_enabled.store(enabled, std::memory_order_relaxed);
+		}
+
+		static bool IsEnabled()
+		{
+			return _enabled.load(std::memory_order_relaxed);
+		}
+
+		// Monotonic time (in nanoseconds)
+		static int64_t GetCurrentNanoseconds();
+
+		std::shared_ptr<LockStatistics> GetStatistics(const ov::String &name);
+
+		// The locks of which the total wait time is the longest first (count: 0 = all)
+		std::vector<std::shared_ptr<LockStatistics>> GetTopContended(size_t count = OV_LOCK_PROFILER_DEFAULT_TOP_COUNT);
+
+		void Reset();
+
+	protected:
+		LockProfiler() = default;
+
+		static std::atomic<bool> _enabled;
+
+		std::mutex _mutex;
+		std::map<ov::String, std::shared_ptr<LockStatistics>> _statistics_map;
+	};
+
+	// std::mutex which records the wait/hold time and the contentions (Lockable, so it can be used with std::lock_guard/std::unique_lock)
+	//
+	// - Use std::condition_variable_any to wait with it
+	class ProfiledMutex
+	{
+	public:
+		explicit ProfiledMutex(const char *name)
+			: _statistics(LockProfiler::Instance()->GetStatistics(name))
+		{
+		}
+
+		ProfiledMutex(const ProfiledMutex &) = delete;
+		ProfiledMutex &operator=(const ProfiledMutex &) = delete;
+
+		void lock()
+		{
+			if(LockProfiler::IsEnabled() == false)
+			{
+				_mutex.lock();
+				return;
+			}
+
+			if(_mutex.try_lock())
+			{
+				_statistics->RecordLock(false, 0);
+			}
+			else
+			{
+				int64_t start_time = LockProfiler::GetCurrentNanoseconds();
+				_mutex.lock();
+				_statistics->RecordLock(true, LockProfiler::GetCurrentNanoseconds() - start_time);
+			}
+
+			_locked_time = LockProfiler::GetCurrentNanoseconds();
+		}
+
+		bool try_lock()
+		{
+			if(_mutex.try_lock() == false)
+			{
+				return false;
+			}
+
+			if(LockProfiler::IsEnabled())
+			{
+				_statistics->RecordLock(false, 0);
+				_locked_time = LockProfiler::GetCurrentNanoseconds();
+			}
+
+			return true;
+		}
+
+		void unlock()
+		{
+			// The lock which is taken before profiling is enabled isn't measured
+			if(_locked_time != 0)
+			{
+				_statistics->RecordHold(LockProfiler::GetCurrentNanoseconds() - _locked_time);
+				_locked_time = 0;
+			}
+
+			_mutex.unlock();
+		}
+
+	protected:
+		std::mutex _mutex;
+		std::shared_ptr<LockStatistics> _statistics;
+
+		// Written by the owner of the lock only
+		int64_t _locked_time = 0;
+	};
+
+	// std::shared_timed_mutex version of ProfiledMutex (SharedLockable, so it can be used with std::shared_lock)
+	//
+	// - The hold time is measured for the exclusive locks only
+	class ProfiledSharedMutex
+	{
+	public:
+		explicit ProfiledSharedMutex(const char *name)
+			: _statistics(LockProfiler::Instance()->GetStatistics(name))
+		{
+		}
+
+		ProfiledSharedMutex(const ProfiledSharedMutex &) = delete;
+		ProfiledSharedMutex &operator=(const ProfiledSharedMutex &) = delete;
+
+		void lock()
+		{
+			if(LockProfiler::IsEnabled() == false)
+			{
+				_mutex.lock();
+				return;
+			}
+
+			if(_mutex.try_lock())
+			{
+				_statistics->RecordLock(false, 0);
+			}
+			else
+			{
+				int64_t start_time = LockProfiler::GetCurrentNanoseconds();
+				_mutex.lock();
+				_statistics->RecordLock(true, LockProfiler::GetCurrentNanoseconds() - start_time);
+			}
+
+			_locked_time = LockProfiler::GetCurrentNanoseconds();
+		}
+
+		bool try_lock()
+		{
+			if(_mutex.try_lock() == false)
+			{
+				return false;
+			}
+
+			if(LockProfiler::IsEnabled())
+			{
+				_statistics->RecordLock(false, 0);
+				_locked_time = LockProfiler::GetCurrentNanoseconds();
+			}
+
+			return true;
+		}
+
+		void unlock()
+		{
+			if(_locked_time != 0)
+			{
+				_statistics->RecordHold(LockProfiler::GetCurrentNanoseconds() - _locked_time);
+				_locked_time = 0;
+			}
+
+			_mutex.unlock();
+		}
+
+		void lock_shared()
+		{
+			if(LockProfiler::IsEnabled() == false)
+			{
+				_mutex.lock_shared();
+				return;
+			}
+
+			if(_mutex.try_lock_shared())
+			{
+				_statistics->RecordLock(false, 0);
+			}
+			else
+			{
+				int64_t start_time = LockProfiler::GetCurrentNanoseconds();
+				_mutex.lock_shared();
+				_statistics->RecordLock(true, LockProfiler::GetCurrentNanoseconds() - start_time);
+			}
+		}
+
+		bool try_lock_shared()
+		{
+			if(_mutex.try_lock_shared() == false)
+			{
+				return false;
+			}
+
+			if(LockProfiler::IsEnabled())
+			{
+				_statistics->RecordLock(false, 0);
+			}
+
+			return true;
+		}
+
+		void unlock_shared()
+		{
+			_mutex.unlock_shared();
+		}
+
+	protected:
+		std::shared_timed_mutex _mutex;
+		std::shared_ptr<LockStatistics> _statistics;
+
+		int64_t _locked_time = 0;
+	};
+}
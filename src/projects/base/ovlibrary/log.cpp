@@ -9,6 +9,8 @@
 #include "log.h"
 #include "log_internal.h"
 
+uint32_t g_ov_log_generation = 1;
+
 static ov::LogInternal g_log_internal;
 
 // log level 지정
@@ -38,7 +40,27 @@ void ov_log_internal(OVLogLevel level, const char *tag, const char *file, int li
 	va_end(arg_list);
 }
 
+void ov_log_internal_enabled(OVLogLevel level, const char *tag, const char *file, int line, const char *method, const char *format, ...)
+{
+	va_list arg_list;
+	va_start(arg_list, format);
+
+	g_log_internal.LogEnabled(level, tag, file, line, method, format, arg_list);
+
+	va_end(arg_list);
+}
+
+uint64_t ov_log_resolve_tag_cache(OVLogTagCache *cache, const char *tag)
+{
+	return g_log_internal.ResolveTagCache(cache, tag);
+}
+
 void ov_log_set_path(const char *log_path)
 {
     g_log_internal.SetLogPath(log_path);
+}
+
+void ov_log_flush()
+{
+	g_log_internal.Flush();
 }
\ No newline at end of file
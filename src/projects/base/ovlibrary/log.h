@@ -8,6 +8,8 @@
 //==============================================================================
 #pragma once
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -51,8 +53,45 @@ typedef enum OVLogLevel
 		OVLogLevelCritical
 } OVLogLevel;
 
+// Whether the logs of a call site are enabled, resolved once per generation of the log settings
+// - state: (generation << 32) | (bit mask of the enabled levels)
+// - The tag of a call site must be a constant (e.g. OV_LOG_TAG)
+typedef struct OVLogTagCache
+{
+	uint64_t state;
+} OVLogTagCache;
+
+// Increased when the level or the enable list is changed (starts from 1, so a zeroed cache is stale)
+extern uint32_t g_ov_log_generation;
+
+uint64_t ov_log_resolve_tag_cache(OVLogTagCache *cache, const char *tag);
+
+static inline int ov_log_is_enabled(OVLogTagCache *cache, OVLogLevel level, const char *tag)
+{
+	uint64_t state = __atomic_load_n(&(cache->state), __ATOMIC_RELAXED);
+
+	if((state >> 32) != __atomic_load_n(&g_ov_log_generation, __ATOMIC_RELAXED))
+	{
+		state = ov_log_resolve_tag_cache(cache, tag);
+	}
+
+	return (state & (1U << level)) != 0;
+}
+
+// The disabled logs cost an atomic load per call (no lock, no regex, no formatting)
+#define OV_LOG_CACHED(level, tag, format, ...)                                                                                    \
+	do                                                                                                                            \
+	{                                                                                                                             \
+		static OVLogTagCache ov_log_tag_cache = { 0 };                                                                            \
+                                                                                                                                  \
+		if(ov_log_is_enabled(&ov_log_tag_cache, level, tag))                                                                      \
+		{                                                                                                                         \
+			ov_log_internal_enabled(level, tag, __FILE__, __LINE__, __PRETTY_FUNCTION__, format, ## __VA_ARGS__); /* NOLINT */    \
+		}                                                                                                                         \
+	} while(0)
+
 #if DEBUG
-#   define logd(tag, format, ...)                     ov_log_internal(OVLogLevelDebug,          tag, __FILE__, __LINE__, __PRETTY_FUNCTION__, format, ## __VA_ARGS__) // NOLINT
+#   define logd(tag, format, ...)                     OV_LOG_CACHED(OVLogLevelDebug,            tag, format, ## __VA_ARGS__) // NOLINT
 #else
 #   define logd                                       ov_log_dummy
 
@@ -61,10 +100,10 @@ constexpr void ov_log_dummy(...)
 }
 
 #endif // DEBUG
-#define logi(tag, format, ...)                        ov_log_internal(OVLogLevelInformation,    tag, __FILE__, __LINE__, __PRETTY_FUNCTION__, format, ## __VA_ARGS__) // NOLINT
-#define logw(tag, format, ...)                        ov_log_internal(OVLogLevelWarning,        tag, __FILE__, __LINE__, __PRETTY_FUNCTION__, format, ## __VA_ARGS__) // NOLINT
-#define loge(tag, format, ...)                        ov_log_internal(OVLogLevelError,          tag, __FILE__, __LINE__, __PRETTY_FUNCTION__, format, ## __VA_ARGS__) // NOLINT
-#define logc(tag, format, ...)                        ov_log_internal(OVLogLevelCritical,       tag, __FILE__, __LINE__, __PRETTY_FUNCTION__, format, ## __VA_ARGS__) // NOLINT
+#define logi(tag, format, ...)                        OV_LOG_CACHED(OVLogLevelInformation,      tag, format, ## __VA_ARGS__) // NOLINT
+#define logw(tag, format, ...)                        OV_LOG_CACHED(OVLogLevelWarning,          tag, format, ## __VA_ARGS__) // NOLINT
+#define loge(tag, format, ...)                        OV_LOG_CACHED(OVLogLevelError,            tag, format, ## __VA_ARGS__) // NOLINT
+#define logc(tag, format, ...)                        OV_LOG_CACHED(OVLogLevelCritical,         tag, format, ## __VA_ARGS__) // NOLINT
 
 #define logtd(format, ...)                            logd(OV_LOG_TAG, format, ## __VA_ARGS__) // NOLINT
 #define logtp(format, ...)                            logd(OV_LOG_TAG ".Packet", format, ## __VA_ARGS__) // NOLINT
@@ -96,9 +135,14 @@ void ov_log_reset_enable();
 void ov_log_set_enable(const char *tag_regex, OVLogLevel level, bool is_enabled);
 
 void ov_log_internal(OVLogLevel level, const char *tag, const char *file, int line, const char *method, const char *format, ...);
+// Same as ov_log_internal(), but the tag is already checked by ov_log_is_enabled()
+void ov_log_internal_enabled(OVLogLevel level, const char *tag, const char *file, int line, const char *method, const char *format, ...);
 
 void ov_log_set_path(const char *log_path);
 
+// Writes the queued logs (e.g. before the process is terminated)
+void ov_log_flush();
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
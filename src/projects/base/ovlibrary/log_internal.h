@@ -17,11 +17,13 @@
 #include <sys/syscall.h>
 #include <sys/types.h>
 
+#include <atomic>
 #include <cstdio>
 #include <ctime>
 #include <chrono>
 #include <regex>
 #include <mutex>
+#include <thread>
 
 #if DEBUG
 #   define OV_LOG_SHOW_FILE_NAME                1
@@ -31,6 +33,11 @@
 #   define OV_LOG_SHOW_FUNCTION_NAME            0
 #endif // DEBUG
 
+// Records which are waiting for the writer thread (must be a power of 2, the logs are dropped when it is full)
+#define OV_LOG_QUEUE_SIZE                       8192
+// The writer thread sleeps for this interval (ms) when the queue is empty
+#define OV_LOG_WRITER_INTERVAL                  10
+
 #define OV_LOG_COLOR_RESET                      "\x1B[0m"
 
 #define OV_LOG_COLOR_FG_BLACK                   "\x1B[30m"
@@ -71,6 +78,90 @@
 
 namespace ov
 {
+	// Formatted logs from the threads to the writer thread (multiple producers, single consumer)
+	// - A bounded queue of the sequenced slots, so Push() doesn't lock
+	// - Pop() must be called by one thread at a time
+	class LogQueue
+	{
+	public:
+		LogQueue()
+		{
+			for(size_t index = 0; index < OV_LOG_QUEUE_SIZE; index++)
+			{
+				_records[index].sequence.store(index, std::memory_order_relaxed);
+			}
+		}
+
+		// Returns false if the queue is full
+		bool Push(OVLogLevel level, std::unique_ptr<ov::String> log)
+		{
+			size_t position = _enqueue_position.load(std::memory_order_relaxed);
+			Record *record;
+
+			while(true)
+			{
+				record = &(_records[position & (OV_LOG_QUEUE_SIZE - 1)]);
+
+				size_t sequence = record->sequence.load(std::memory_order_acquire);
+				auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+				if(difference == 0)
+				{
+					if(_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if(difference < 0)
+				{
+					return false;
+				}
+				else
+				{
+					position = _enqueue_position.load(std::memory_order_relaxed);
+				}
+			}
+
+			record->level = level;
+			record->log = std::move(log);
+			record->sequence.store(position + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		std::unique_ptr<ov::String> Pop(OVLogLevel *level)
+		{
+			Record *record = &(_records[_dequeue_position & (OV_LOG_QUEUE_SIZE - 1)]);
+
+			if(record->sequence.load(std::memory_order_acquire) != (_dequeue_position + 1))
+			{
+				// Empty (or the producer is writing the slot)
+				return nullptr;
+			}
+
+			*level = record->level;
+			auto log = std::move(record->log);
+
+			record->sequence.store(_dequeue_position + OV_LOG_QUEUE_SIZE, std::memory_order_release);
+			_dequeue_position++;
+
+			return log;
+		}
+
+	protected:
+		struct Record
+		{
+			std::atomic<size_t> sequence { 0 };
+			OVLogLevel level = OVLogLevelDebug;
+			std::unique_ptr<ov::String> log;
+		};
+
+		Record _records[OV_LOG_QUEUE_SIZE];
+
+		std::atomic<size_t> _enqueue_position { 0 };
+		size_t _dequeue_position = 0;
+	};
+
 	class LogInternal
 	{
 	public:
@@ -79,12 +170,26 @@ namespace ov
 		{
 		}
 
+		~LogInternal()
+		{
+			_writer_running = false;
+
+			if(_writer_thread.joinable())
+			{
+				_writer_thread.join();
+			}
+
+			Flush();
+		}
+
 		/// 모든 log에 1차적으로 적용되는 filter 규칙
 		///
 		/// @param level level 이상의 로그만 표시함
 		inline void SetLogLevel(OVLogLevel level)
 		{
 			_level = level;
+
+			IncreaseGeneration();
 		}
 
 		inline void ResetEnable()
@@ -94,6 +199,8 @@ namespace ov
 			_enable_map.clear();
 
 			_enable_list.clear();
+
+			IncreaseGeneration();
 		}
 
 		/// @param tag_regex tag 패턴
@@ -120,11 +227,35 @@ namespace ov
 				.level = level,
 				.is_enabled = is_enabled
 			});
+
+			IncreaseGeneration();
 		}
 
 		inline int64_t GetThreadId()
 		{
-			return (int64_t)::syscall(SYS_gettid); // NOLINT
+			static thread_local int64_t thread_id = (int64_t)::syscall(SYS_gettid); // NOLINT
+
+			return thread_id;
+		}
+
+		// Resolves the enabled levels of the tag (with the lock and the regex), and stores it to the cache of the call site
+		inline uint64_t ResolveTagCache(OVLogTagCache *cache, const char *tag)
+		{
+			// If the settings are changed while resolving, the cache is resolved again by the next call
+			uint64_t generation = __atomic_load_n(&g_ov_log_generation, __ATOMIC_ACQUIRE);
+			uint64_t state = generation << 32;
+
+			for(int level = OVLogLevelDebug; level <= OVLogLevelCritical; level++)
+			{
+				if((level >= _level) && IsEnabled((tag != nullptr) ? tag : "", static_cast<OVLogLevel>(level)))
+				{
+					state |= (1U << level);
+				}
+			}
+
+			__atomic_store_n(&(cache->state), state, __ATOMIC_RELAXED);
+
+			return state;
 		}
 
 		inline bool IsEnabled(const char *tag, OVLogLevel level)
@@ -197,6 +328,17 @@ namespace ov
 				return;
 			}
 
+			LogEnabled(level, tag, file, line, method, format, arg_list);
+		}
+
+		// The tag and the level are already checked (by ResolveTagCache())
+		inline void LogEnabled(OVLogLevel level, const char *tag, const char *file, int line, const char *method, const char *format, va_list &arg_list)
+		{
+			if(tag == nullptr)
+			{
+				tag = "";
+			}
+
 			const char *log_level[] = {
 				"D",
 				"I",
@@ -205,32 +347,23 @@ namespace ov
 				"C"
 			};
 
-			const char *color_prefix[] = {
-				OV_LOG_COLOR_FG_CYAN,
-				OV_LOG_COLOR_FG_WHITE,
-				OV_LOG_COLOR_FG_YELLOW,
-				OV_LOG_COLOR_FG_BR_RED,
-				OV_LOG_COLOR_FG_BR_WHITE OV_LOG_COLOR_BG_RED // NOLINT
-			};
-
-			const char *color_suffix[] = {
-				OV_LOG_COLOR_RESET,
-				OV_LOG_COLOR_RESET,
-				OV_LOG_COLOR_RESET,
-				OV_LOG_COLOR_RESET,
-				OV_LOG_COLOR_RESET
-			};
-
 			// 현재 시각의 milliseconds를 얻어옴
-			auto current = std::chrono::system_clock::now();
-			auto mseconds = std::chrono::duration_cast<std::chrono::milliseconds>(current.time_since_epoch()).count() % 1000;
+			auto current = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+			auto mseconds = current % 1000;
 
-			// 시/분/초를 얻어옴
-			std::time_t time = std::time(nullptr);
-			std::tm localTime {};
-			::localtime_r(&time, &localTime);
+			// 시/분/초를 얻어옴 (localtime_r() is called once per second for each thread)
+			static thread_local std::time_t last_time = -1;
+			static thread_local std::tm localTime {};
+			std::time_t time = static_cast<std::time_t>(current / 1000);
+
+			if(time != last_time)
+			{
+				::localtime_r(&time, &localTime);
+				last_time = time;
+			}
 
-			ov::String log;
+			auto log_pointer = std::make_unique<ov::String>();
+			ov::String &log = *log_pointer;
 
 #if OV_LOG_SHOW_FILE_NAME
 			ov::String fileName = file;
@@ -317,32 +450,148 @@ namespace ov
 			// 맨 뒤에 <message> 추가
 			log.AppendVFormat(format, &(arg_list[0]));
 
-			if(level < OVLogLevelWarning)
+			if(level == OVLogLevelCritical)
 			{
-                fprintf(stdout, "%s%s%s\n", color_prefix[level], log.CStr(), color_suffix[level]);
-				fflush(stdout);
+				// The process may be terminated right after this log (e.g. the signal handler), so it is written now
+				std::lock_guard<std::mutex> lock(_write_mutex);
+
+				FlushInternal();
+				WriteRecord(level, log);
+				FlushStreams();
+
+				return;
 			}
-			else
+
+			std::call_once(_writer_once_flag, [this]() {
+				_writer_running = true;
+				_writer_thread = std::thread(&LogInternal::WriterThread, this);
+			});
+
+			if(_queue.Push(level, std::move(log_pointer)) == false)
 			{
-                fprintf(stderr, "%s%s%s\n", color_prefix[level], log.CStr(), color_suffix[level]);
-                fflush(stderr);
+				_dropped_count++;
 			}
-
-            _log_file.Write(log.CStr());
 		}
 
         inline void SetLogPath(const char* log_path)
         {
+            std::lock_guard<std::mutex> lock(_write_mutex);
+
             _log_file.SetLogPath(log_path);
         }
 
+		// Writes the queued logs by the calling thread
+		inline void Flush()
+		{
+			std::lock_guard<std::mutex> lock(_write_mutex);
+
+			FlushInternal();
+		}
+
 	protected:
+		inline void IncreaseGeneration()
+		{
+			__atomic_add_fetch(&g_ov_log_generation, 1, __ATOMIC_RELEASE);
+		}
+
+		void WriterThread()
+		{
+			while(_writer_running)
+			{
+				size_t count;
+
+				{
+					std::lock_guard<std::mutex> lock(_write_mutex);
+
+					count = FlushInternal();
+				}
+
+				if(count == 0)
+				{
+					std::this_thread::sleep_for(std::chrono::milliseconds(OV_LOG_WRITER_INTERVAL));
+				}
+			}
+		}
+
+		// _write_mutex must be locked, returns the number of the written logs
+		size_t FlushInternal()
+		{
+			size_t count = 0;
+			OVLogLevel level;
+
+			while(auto log = _queue.Pop(&level))
+			{
+				WriteRecord(level, *log);
+				count++;
+			}
+
+			uint64_t dropped_count = _dropped_count.exchange(0);
+
+			if(dropped_count > 0)
+			{
+				ov::String log;
+
+				log.Format("[Log] %llu logs are dropped (the queue is full)", static_cast<unsigned long long>(dropped_count));
+				WriteRecord(OVLogLevelWarning, log);
+				count++;
+			}
+
+			if(count > 0)
+			{
+				FlushStreams();
+			}
+
+			return count;
+		}
+
+		// _write_mutex must be locked
+		void WriteRecord(OVLogLevel level, const ov::String &log)
+		{
+			const char *color_prefix[] = {
+				OV_LOG_COLOR_FG_CYAN,
+				OV_LOG_COLOR_FG_WHITE,
+				OV_LOG_COLOR_FG_YELLOW,
+				OV_LOG_COLOR_FG_BR_RED,
+				OV_LOG_COLOR_FG_BR_WHITE OV_LOG_COLOR_BG_RED // NOLINT
+			};
+
+			const char *color_suffix[] = {
+				OV_LOG_COLOR_RESET,
+				OV_LOG_COLOR_RESET,
+				OV_LOG_COLOR_RESET,
+				OV_LOG_COLOR_RESET,
+				OV_LOG_COLOR_RESET
+			};
+
+			::fprintf((level < OVLogLevelWarning) ? stdout : stderr, "%s%s%s\n", color_prefix[level], log.CStr(), color_suffix[level]);
+
+			_log_file.Write(log.CStr());
+		}
+
+		// _write_mutex must be locked
+		void FlushStreams()
+		{
+			::fflush(stdout);
+			::fflush(stderr);
+
+			_log_file.Flush();
+		}
+
 		OVLogLevel _level;
 
 		std::mutex _mutex;
 
+		// Serializes the consumer of _queue and the outputs (stdout, stderr, _log_file)
+		std::mutex _write_mutex;
         LogWrite _log_file;
 
+		LogQueue _queue;
+		std::atomic<uint64_t> _dropped_count { 0 };
+
+		std::once_flag _writer_once_flag;
+		std::atomic<bool> _writer_running { false };
+		std::thread _writer_thread;
+
 		struct EnableItem
 		{
 			std::shared_ptr<std::regex> regex;
@@ -83,7 +83,11 @@ namespace ov
             Initialize();
         }
 
-        _log_stream << log << std::endl;
+        _log_stream << log << '\n';
+    }
+
+    void LogWrite::Flush()
+    {
         _log_stream.flush();
     }
 }
\ No newline at end of file
@@ -17,7 +17,9 @@ namespace ov
     public:
         LogWrite();
         virtual ~LogWrite() = default;
+        // The log is buffered until Flush() is called
         void Write(const char* log);
+        void Flush();
         void SetLogPath(const char* log_path);
 
         static void Initialize(bool start_service);
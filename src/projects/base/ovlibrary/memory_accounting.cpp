@@ -0,0 +1,57 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./memory_accounting.h"
+
+namespace ov
+{
+	namespace
+	{
+		thread_local MemoryTag current_tag = MemoryTag::Untagged;
+	}
+
+	std::atomic<int64_t> MemoryAccounting::_bytes[static_cast<int>(MemoryTag::NumberOfTags)] {};
+
+	MemoryTag MemoryAccounting::GetCurrentTag()
+	{
+		return current_tag;
+	}
+
+	const char *MemoryAccounting::GetTagName(MemoryTag tag)
+	{
+		switch(tag)
+		{
+			case MemoryTag::Untagged:
+				return "untagged";
+			case MemoryTag::Ingest:
+				return "ingest";
+			case MemoryTag::Transcoder:
+				return "transcoder";
+			case MemoryTag::Packetizer:
+				return "packetizer";
+			case MemoryTag::Segment:
+				return "segment";
+			case MemoryTag::Session:
+				return "session";
+			case MemoryTag::NumberOfTags:
+				break;
+		}
+
+		return "unknown";
+	}
+
+	MemoryTagScope::MemoryTagScope(MemoryTag tag)
+		: _previous_tag(current_tag)
+	{
+		current_tag = tag;
+	}
+
+	MemoryTagScope::~MemoryTagScope()
+	{
+		current_tag = _previous_tag;
+	}
+}
@@ -0,0 +1,72 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace ov
+{
+	// Owner of the buffers of ov::Data (the tag of the thread which allocates the buffer)
+	enum class MemoryTag : uint8_t
+	{
+		Untagged,
+		// Receive/message buffers of the providers (e.g. RTMP chunks)
+		Ingest,
+		// Packets and frames of the transcoder
+		Transcoder,
+		// RTP packets, FEC and the media segments being made (e.g. TS/M4S writers)
+		Packetizer,
+		// Segments stored to be served (HLS/DASH)
+		Segment,
+		// Buffers of the sessions (e.g. SRTP send buffers, RTX)
+		Session,
+
+		NumberOfTags
+	};
+
+	// Bytes of the buffers of ov::Data for each tag
+	//
+	// - The buffers are charged to the tag of the thread when they are allocated (see MemoryTagScope),
+	//   and the growth of a buffer is charged to the same tag
+	// - Buffers which are cached by BufferPool are not counted
+	class MemoryAccounting
+	{
+	public:
+		static MemoryTag GetCurrentTag();
+
+		static void Add(MemoryTag tag, int64_t bytes)
+		{
+			_bytes[static_cast<int>(tag)].fetch_add(bytes, std::memory_order_relaxed);
+		}
+
+		static int64_t GetBytes(MemoryTag tag)
+		{
+			return _bytes[static_cast<int>(tag)].load(std::memory_order_relaxed);
+		}
+
+		static const char *GetTagName(MemoryTag tag);
+
+	protected:
+		static std::atomic<int64_t> _bytes[static_cast<int>(MemoryTag::NumberOfTags)];
+	};
+
+	// Sets the tag of the current thread until the scope is finished (the scopes can be nested)
+	class MemoryTagScope
+	{
+	public:
+		explicit MemoryTagScope(MemoryTag tag);
+		~MemoryTagScope();
+
+		MemoryTagScope(const MemoryTagScope &) = delete;
+		MemoryTagScope &operator=(const MemoryTagScope &) = delete;
+
+	protected:
+		MemoryTag _previous_tag;
+	};
+}
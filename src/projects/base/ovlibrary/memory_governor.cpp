@@ -0,0 +1,453 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./memory_governor.h"
+#include "./log.h"
+#include "./ovlibrary_private.h"
+#include "./platform.h"
+#include "./string.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+// The limit of the cgroup v1 which is not set (PAGE_COUNTER_MAX)
+#define OV_MEMORY_GOVERNOR_UNLIMITED				(1ULL << 60)
+
+namespace ov
+{
+	MemoryGovernor::~MemoryGovernor()
+	{
+		Stop();
+	}
+
+	bool MemoryGovernor::Start(const MemoryGovernorConfig &config)
+	{
+		if(_thread.joinable())
+		{
+			return true;
+		}
+
+		_config = config;
+		_config.interval = std::max(_config.interval, 100);
+
+		FindCgroup();
+
+		uint64_t limit = _config.limit;
+
+		if((limit == 0) && (_cgroup_limit_path.empty() == false))
+		{
+			ReadValue(_cgroup_limit_path.c_str(), &limit);
+		}
+
+		if(limit == 0)
+		{
+			logtw("Memory governor is disabled (neither <Limit> nor the limit of the cgroup is set)");
+			return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock_guard(_status_mutex);
+			_status.limit = limit;
+		}
+
+		_stop = false;
+		_thread = std::thread(&MemoryGovernor::ThreadProc, this);
+
+		logti("Memory governor is started - limit(%llu MB) thresholds(%d/%d/%d/%d%%) pressure(%d%%) cgroup(%s)",
+		      static_cast<unsigned long long>(limit / (1024ULL * 1024ULL)),
+		      _config.shrink_threshold, _config.cap_queues_threshold, _config.refuse_new_threshold, _config.shed_streams_threshold,
+		      _config.pressure_threshold, _cgroup_usage_path.empty() ? "none" : _cgroup_usage_path.c_str());
+
+		return true;
+	}
+
+	void MemoryGovernor::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock_guard(_stop_mutex);
+
+			_stop = true;
+		}
+
+		_stop_condition.notify_all();
+
+		if(_thread.joinable())
+		{
+			_thread.join();
+		}
+
+		_level = MemoryGovernorLevel::Normal;
+	}
+
+	MemoryGovernorStatus MemoryGovernor::GetStatus()
+	{
+		std::lock_guard<std::mutex> lock_guard(_status_mutex);
+
+		return _status;
+	}
+
+	void MemoryGovernor::AddShedder(MemoryShedder *shedder)
+	{
+		std::lock_guard<std::mutex> lock_guard(_shedder_mutex);
+
+		_shedders.push_back(shedder);
+	}
+
+	void MemoryGovernor::RemoveShedder(MemoryShedder *shedder)
+	{
+		// Waits for Shed() which is calling the shedder
+		std::lock_guard<std::mutex> lock_guard(_shedder_mutex);
+
+		_shedders.erase(std::remove(_shedders.begin(), _shedders.end(), shedder), _shedders.end());
+	}
+
+	const char *MemoryGovernor::GetLevelName(MemoryGovernorLevel level)
+	{
+		switch(level)
+		{
+			case MemoryGovernorLevel::Normal:
+				return "Normal";
+			case MemoryGovernorLevel::Shrink:
+				return "Shrink";
+			case MemoryGovernorLevel::CapQueues:
+				return "CapQueues";
+			case MemoryGovernorLevel::RefuseNew:
+				return "RefuseNew";
+			case MemoryGovernorLevel::ShedStreams:
+				return "ShedStreams";
+			default:
+				return "Unknown";
+		}
+	}
+
+	void MemoryGovernor::ThreadProc()
+	{
+		std::unique_lock<std::mutex> lock(_stop_mutex);
+
+		while(_stop == false)
+		{
+			lock.unlock();
+
+			Sample();
+
+			if(IsLevel(MemoryGovernorLevel::ShedStreams))
+			{
+				Shed();
+			}
+
+			lock.lock();
+
+			_stop_condition.wait_for(lock, std::chrono::milliseconds(_config.interval), [this]() -> bool {
+				return _stop;
+			});
+		}
+	}
+
+	void MemoryGovernor::FindCgroup()
+	{
+#if IS_LINUX
+		FILE *file = ::fopen("/proc/self/cgroup", "r");
+
+		if(file != nullptr)
+		{
+			char line[1024];
+			std::string v1_path;
+			std::string v2_path;
+
+			while(::fgets(line, sizeof(line), file) != nullptr)
+			{
+				// <id>:<controllers>:<path>
+				char *controllers = ::strchr(line, ':');
+				char *path = (controllers != nullptr) ? ::strchr(controllers + 1, ':') : nullptr;
+
+				if(path == nullptr)
+				{
+					continue;
+				}
+
+				*path = '\0';
+				path++;
+				path[::strcspn(path, "\n")] = '\0';
+
+				if(::strcmp(line, "0") == 0)
+				{
+					// 0::<path> (v2)
+					v2_path = std::string("/sys/fs/cgroup") + path;
+				}
+				else if(::strstr(controllers + 1, "memory") != nullptr)
+				{
+					v1_path = std::string("/sys/fs/cgroup/memory") + path;
+				}
+			}
+
+			::fclose(file);
+
+			if((v2_path.empty() == false) && (::access((v2_path + "/memory.current").c_str(), R_OK) == 0))
+			{
+				_cgroup_limit_path = v2_path + "/memory.max";
+				_cgroup_usage_path = v2_path + "/memory.current";
+				_cgroup_stat_path = v2_path + "/memory.stat";
+				_inactive_file_key = "inactive_file";
+
+				if(::access((v2_path + "/memory.pressure").c_str(), R_OK) == 0)
+				{
+					_pressure_path = v2_path + "/memory.pressure";
+				}
+			}
+			else if((v1_path.empty() == false) && (::access((v1_path + "/memory.usage_in_bytes").c_str(), R_OK) == 0))
+			{
+				_cgroup_limit_path = v1_path + "/memory.limit_in_bytes";
+				_cgroup_usage_path = v1_path + "/memory.usage_in_bytes";
+				_cgroup_stat_path = v1_path + "/memory.stat";
+				_inactive_file_key = "total_inactive_file";
+			}
+		}
+
+		if(_pressure_path.empty() && (::access("/proc/pressure/memory", R_OK) == 0))
+		{
+			_pressure_path = "/proc/pressure/memory";
+		}
+#endif
+	}
+
+	void MemoryGovernor::Sample()
+	{
+		MemoryGovernorStatus status = GetStatus();
+
+		uint64_t usage = 0;
+		ReadResidentBytes(&usage);
+
+		uint64_t cgroup_usage = 0;
+
+		if((_cgroup_usage_path.empty() == false) && ReadValue(_cgroup_usage_path.c_str(), &cgroup_usage))
+		{
+			uint64_t inactive_file = 0;
+
+			if(ReadStatValue(_cgroup_stat_path.c_str(), _inactive_file_key, &inactive_file))
+			{
+				cgroup_usage -= std::min(cgroup_usage, inactive_file);
+			}
+
+			// The other processes of the cgroup (e.g. the sidecars) are charged to the same limit
+			usage = std::max(usage, cgroup_usage);
+		}
+
+		status.usage = usage;
+		status.pressure = 0.0;
+
+		if(_pressure_path.empty() == false)
+		{
+			ReadPressure(_pressure_path.c_str(), &status.pressure);
+		}
+
+		auto old_level = status.level;
+		status.level = GetTargetLevel(status);
+
+		{
+			std::lock_guard<std::mutex> lock_guard(_status_mutex);
+			_status = status;
+		}
+
+		_level = status.level;
+
+		if(status.level != old_level)
+		{
+			auto message = ov::String::FormatString("Memory governor level is changed: %s -> %s (usage: %llu / %llu MB, pressure: %.2f%%)",
+			                                        GetLevelName(old_level), GetLevelName(status.level),
+			                                        static_cast<unsigned long long>(status.usage / (1024ULL * 1024ULL)),
+			                                        static_cast<unsigned long long>(status.limit / (1024ULL * 1024ULL)), status.pressure);
+
+			if(status.level > old_level)
+			{
+				logtw("%s", message.CStr());
+			}
+			else
+			{
+				logti("%s", message.CStr());
+			}
+		}
+	}
+
+	MemoryGovernorLevel MemoryGovernor::GetTargetLevel(const MemoryGovernorStatus &status) const
+	{
+		const int thresholds[] = {
+			_config.shrink_threshold,
+			_config.cap_queues_threshold,
+			_config.refuse_new_threshold,
+			_config.shed_streams_threshold
+		};
+
+		double usage = static_cast<double>(status.usage) * 100.0 / static_cast<double>(status.limit);
+
+		// The highest level whose threshold is exceeded (hysteresis: the threshold of the levels up to the current one is lowered)
+		int level = 0;
+
+		for(int index = 0; index < static_cast<int>(sizeof(thresholds) / sizeof(thresholds[0])); index++)
+		{
+			int threshold = thresholds[index];
+
+			if(threshold <= 0)
+			{
+				continue;
+			}
+
+			if((index + 1) <= static_cast<int>(status.level))
+			{
+				threshold -= OV_MEMORY_GOVERNOR_HYSTERESIS;
+			}
+
+			if(usage >= threshold)
+			{
+				level = index + 1;
+			}
+		}
+
+		// The stalls are caused by the reclaim before the usage reaches the limit (e.g. the page cache of the other processes)
+		if((_config.pressure_threshold > 0) && (status.pressure >= _config.pressure_threshold))
+		{
+			level = std::min(level + 1, static_cast<int>(MemoryGovernorLevel::ShedStreams));
+		}
+
+		return static_cast<MemoryGovernorLevel>(level);
+	}
+
+	void MemoryGovernor::Shed()
+	{
+		std::lock_guard<std::mutex> lock_guard(_shedder_mutex);
+
+		MemoryShedder *candidate = nullptr;
+		size_t candidate_session_count = 0;
+
+		for(auto shedder : _shedders)
+		{
+			size_t session_count = 0;
+
+			if(shedder->GetShedCandidate(&session_count) && ((candidate == nullptr) || (session_count < candidate_session_count)))
+			{
+				candidate = shedder;
+				candidate_session_count = session_count;
+			}
+		}
+
+		// One stream per interval, so the usage can be sampled again before the next one is dropped
+		if((candidate != nullptr) && candidate->ShedStream())
+		{
+			logtw("A stream is dropped by the memory governor (viewers: %zu)", candidate_session_count);
+		}
+	}
+
+	bool MemoryGovernor::ReadResidentBytes(uint64_t *bytes)
+	{
+#if IS_LINUX
+		FILE *file = ::fopen("/proc/self/statm", "r");
+
+		if(file == nullptr)
+		{
+			return false;
+		}
+
+		// <size> <resident> ... (pages)
+		unsigned long long size = 0;
+		unsigned long long resident = 0;
+		int count = ::fscanf(file, "%llu %llu", &size, &resident);
+
+		::fclose(file);
+
+		if(count != 2)
+		{
+			return false;
+		}
+
+		*bytes = static_cast<uint64_t>(resident) * static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool MemoryGovernor::ReadValue(const char *path, uint64_t *value)
+	{
+		FILE *file = ::fopen(path, "r");
+
+		if(file == nullptr)
+		{
+			return false;
+		}
+
+		// "max" is not parsed
+		unsigned long long read_value = 0;
+		int count = ::fscanf(file, "%llu", &read_value);
+
+		::fclose(file);
+
+		if((count != 1) || (read_value >= OV_MEMORY_GOVERNOR_UNLIMITED))
+		{
+			return false;
+		}
+
+		*value = static_cast<uint64_t>(read_value);
+
+		return true;
+	}
+
+	bool MemoryGovernor::ReadStatValue(const char *path, const char *key, uint64_t *value)
+	{
+		FILE *file = ::fopen(path, "r");
+
+		if(file == nullptr)
+		{
+			return false;
+		}
+
+		char name[64];
+		unsigned long long read_value = 0;
+		bool found = false;
+
+		while(::fscanf(file, "%63s %llu", name, &read_value) == 2)
+		{
+			if(::strcmp(name, key) == 0)
+			{
+				*value = static_cast<uint64_t>(read_value);
+				found = true;
+				break;
+			}
+		}
+
+		::fclose(file);
+
+		return found;
+	}
+
+	bool MemoryGovernor::ReadPressure(const char *path, double *pressure)
+	{
+		FILE *file = ::fopen(path, "r");
+
+		if(file == nullptr)
+		{
+			return false;
+		}
+
+		// some avg10=<%> avg60=<%> avg300=<%> total=<us>
+		double avg10 = 0.0;
+		int count = ::fscanf(file, "some avg10=%lf", &avg10);
+
+		::fclose(file);
+
+		if(count != 1)
+		{
+			return false;
+		}
+
+		*pressure = avg10;
+
+		return true;
+	}
+}
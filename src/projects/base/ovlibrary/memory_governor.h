@@ -0,0 +1,163 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "./singleton.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The GOP caches are reduced to (the maximum size / this) at MemoryGovernorLevel::Shrink
+#define OV_MEMORY_GOVERNOR_GOP_CACHE_DIVISOR		4
+// Maximum length of the queues of the transcoder at MemoryGovernorLevel::CapQueues
+#define OV_MEMORY_GOVERNOR_CAPPED_QUEUE_SIZE		16
+// The level is lowered when the usage is below the threshold of the current level by this (%)
+#define OV_MEMORY_GOVERNOR_HYSTERESIS				5
+
+namespace ov
+{
+	// Stages of the load shedding, each level includes the lower levels
+	enum class MemoryGovernorLevel : uint8_t
+	{
+		Normal,
+		// The saved segments outside the playlists are evicted, and the GOP caches are reduced
+		Shrink,
+		// The queues of the transcoder are shortened (the frames are dropped earlier)
+		CapQueues,
+		// The new streams and the new sessions are refused
+		RefuseNew,
+		// The streams are dropped from the lowest priority (the fewest viewers), one per interval
+		ShedStreams,
+
+		NumberOfLevels
+	};
+
+	struct MemoryGovernorConfig
+	{
+		// Bytes (0: the limit of the cgroup, the governor is disabled if there is no limit)
+		uint64_t limit = 0;
+
+		// Usage (%) of the limit to enter each level (0: the level is not used)
+		int shrink_threshold = 75;
+		int cap_queues_threshold = 85;
+		int refuse_new_threshold = 90;
+		int shed_streams_threshold = 95;
+
+		// The level is raised by one if the memory pressure (PSI: "some avg10", %) exceeds it (0: not used)
+		int pressure_threshold = 0;
+
+		// ms
+		int interval = 1000;
+	};
+
+	struct MemoryGovernorStatus
+	{
+		MemoryGovernorLevel level = MemoryGovernorLevel::Normal;
+
+		// Bytes (RSS of the process, or the usage of the cgroup if it is larger)
+		uint64_t usage = 0;
+		uint64_t limit = 0;
+		// PSI "some avg10" (%)
+		double pressure = 0.0;
+	};
+
+	// The streams which can be dropped by the governor (e.g. the applications of the media router)
+	class MemoryShedder
+	{
+	public:
+		virtual ~MemoryShedder() = default;
+
+		// Number of the viewers of the stream which would be dropped next (false: there is no stream to drop)
+		virtual bool GetShedCandidate(size_t *session_count) = 0;
+		// Drops the stream which is returned by GetShedCandidate()
+		virtual bool ShedStream() = 0;
+	};
+
+	// Memory-pressure aware load shedding
+	//
+	// - The usage is sampled every interval by the thread of the governor
+	//   (Linux: /proc/self/statm, memory.max/memory.current/memory.pressure of the cgroup v2 (or v1), /proc/pressure/memory)
+	// - The modules check GetLevel() (lock-free) when they allocate: the segment rings, the GOP caches,
+	//   the transcoder queues, and the creation of the streams and the sessions
+	// - The usage of the cgroup excludes the inactive page cache (e.g. the recorded files), like the working set of the kubelet
+	// - The level is lowered only when the usage is below the threshold of the current level by OV_MEMORY_GOVERNOR_HYSTERESIS
+	class MemoryGovernor : public Singleton<MemoryGovernor>
+	{
+	public:
+		friend class Singleton<MemoryGovernor>;
+
+		~MemoryGovernor() override;
+
+		bool Start(const MemoryGovernorConfig &config);
+		void Stop();
+
+		MemoryGovernorLevel GetLevel() const
+		{
+			return _level.load(std::memory_order_relaxed);
+		}
+
+		bool IsLevel(MemoryGovernorLevel level) const
+		{
+			return GetLevel() >= level;
+		}
+
+		MemoryGovernorStatus GetStatus();
+
+		void AddShedder(MemoryShedder *shedder);
+		// The shedder is not called after this returns
+		void RemoveShedder(MemoryShedder *shedder);
+
+		static const char *GetLevelName(MemoryGovernorLevel level);
+
+	protected:
+		MemoryGovernor() = default;
+
+		void ThreadProc();
+
+		// The files of the cgroup of this process
+		void FindCgroup();
+		void Sample();
+		MemoryGovernorLevel GetTargetLevel(const MemoryGovernorStatus &status) const;
+		void Shed();
+
+		static bool ReadResidentBytes(uint64_t *bytes);
+		// false: the value is "max" or the file doesn't exist
+		static bool ReadValue(const char *path, uint64_t *value);
+		// <key> <value> of memory.stat
+		static bool ReadStatValue(const char *path, const char *key, uint64_t *value);
+		static bool ReadPressure(const char *path, double *pressure);
+
+		MemoryGovernorConfig _config;
+
+		// Files of the cgroup of the process (empty: not found)
+		std::string _cgroup_limit_path;
+		std::string _cgroup_usage_path;
+		std::string _cgroup_stat_path;
+		// memory.stat of the cgroup v1 has the prefix "total_"
+		const char *_inactive_file_key = "inactive_file";
+		std::string _pressure_path;
+
+		std::atomic<MemoryGovernorLevel> _level { MemoryGovernorLevel::Normal };
+
+		std::mutex _status_mutex;
+		MemoryGovernorStatus _status;
+
+		std::mutex _shedder_mutex;
+		std::vector<MemoryShedder *> _shedders;
+
+		std::thread _thread;
+		std::mutex _stop_mutex;
+		std::condition_variable _stop_condition;
+		bool _stop = true;
+	};
+}
@@ -0,0 +1,125 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "nal_utilities.h"
+
+#if defined(__SSE2__)
+#	define OV_NAL_USE_SSE2
+#	include <emmintrin.h>
+#elif defined(__aarch64__)
+#	define OV_NAL_USE_NEON
+#	include <arm_neon.h>
+#endif
+
+namespace ov
+{
+	const uint8_t *FindNalStartCode(const uint8_t *data, const uint8_t *end)
+	{
+		const uint8_t *position = data;
+
+		if((data == nullptr) || (end <= data))
+		{
+			return end;
+		}
+
+		// Each block compares the positions [0, 16), so 18 bytes must be readable
+#if defined(OV_NAL_USE_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i one = _mm_set1_epi8(1);
+
+		while((end - position) >= 18)
+		{
+			__m128i byte0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(position));
+			__m128i byte1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(position + 1));
+			__m128i byte2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(position + 2));
+
+			// position[i] == 0 && position[i + 1] == 0 && position[i + 2] == 1
+			__m128i match = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(byte0, zero), _mm_cmpeq_epi8(byte1, zero)),
+			                              _mm_cmpeq_epi8(byte2, one));
+			int mask = _mm_movemask_epi8(match);
+
+			if(mask != 0)
+			{
+				return position + __builtin_ctz(static_cast<unsigned int>(mask));
+			}
+
+			position += 16;
+		}
+#elif defined(OV_NAL_USE_NEON)
+		const uint8x16_t zero = vdupq_n_u8(0);
+		const uint8x16_t one = vdupq_n_u8(1);
+
+		while((end - position) >= 18)
+		{
+			uint8x16_t byte0 = vld1q_u8(position);
+			uint8x16_t byte1 = vld1q_u8(position + 1);
+			uint8x16_t byte2 = vld1q_u8(position + 2);
+
+			uint8x16_t match = vandq_u8(vandq_u8(vceqq_u8(byte0, zero), vceqq_u8(byte1, zero)), vceqq_u8(byte2, one));
+
+			if(vmaxvq_u8(match) != 0)
+			{
+				// There is a start code in this block, the scalar loop finds the position
+				break;
+			}
+
+			position += 16;
+		}
+#endif
+
+		for(; (position + 3) <= end; position++)
+		{
+			if((position[0] == 0x00) && (position[1] == 0x00) && (position[2] == 0x01))
+			{
+				return position;
+			}
+		}
+
+		return end;
+	}
+
+	std::vector<NalUnit> SplitNalUnits(const uint8_t *data, size_t length)
+	{
+		std::vector<NalUnit> nal_units;
+
+		if((data == nullptr) || (length == 0))
+		{
+			return nal_units;
+		}
+
+		const uint8_t *end = data + length;
+		const uint8_t *start_code = FindNalStartCode(data, end);
+
+		while(start_code != end)
+		{
+			const uint8_t *payload = start_code + 3;
+			const uint8_t *next_start_code = FindNalStartCode(payload, end);
+			const uint8_t *payload_end = next_start_code;
+
+			// Exclude the leading zero of the next start code (00 00 00 01) and the trailing zeros
+			while((payload_end > payload) && (payload_end[-1] == 0x00))
+			{
+				payload_end--;
+			}
+
+			if(payload_end > payload)
+			{
+				NalUnit nal_unit;
+
+				nal_unit.offset = static_cast<size_t>(payload - data);
+				nal_unit.length = static_cast<size_t>(payload_end - payload);
+				nal_unit.header = payload[0];
+
+				nal_units.push_back(nal_unit);
+			}
+
+			start_code = next_start_code;
+		}
+
+		return nal_units;
+	}
+}
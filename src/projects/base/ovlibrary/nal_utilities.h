@@ -0,0 +1,32 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace ov
+{
+	// Returns the position of the first start code (00 00 01) in [data, end), or end if there is no start code
+	// - If the start code is 00 00 00 01, the position of 00 00 01 is returned (the caller checks the leading zero)
+	// - Vectorized (SSE2 on x86, NEON on AArch64), 16 positions are compared at once
+	const uint8_t *FindNalStartCode(const uint8_t *data, const uint8_t *end);
+
+	struct NalUnit
+	{
+		// Position of the NAL unit in the bitstream (the start code is not included)
+		size_t offset = 0;
+		size_t length = 0;
+		// The first byte of the NAL unit (forbidden_zero_bit | nal_ref_idc | nal_unit_type for H.264)
+		uint8_t header = 0;
+	};
+
+	// Splits the Annex-B bitstream into the NAL units (the trailing zeros of each NAL unit are not included)
+	std::vector<NalUnit> SplitNalUnits(const uint8_t *data, size_t length);
+}
@@ -15,17 +15,35 @@
 #include "./assert.h"
 #include "./byte_ordering.h"
 #include "./delay_queue.h"
+#include "./timer_wheel.h"
+#include "./shared_timer_wheel.h"
+#include "./system_load.h"
+#include "./memory_governor.h"
+#include "./huge_pages.h"
+#include "./drain_mode.h"
+#include "./thread_topology.h"
+#include "./latency_histogram.h"
+#include "./lock_profiler.h"
+#include "./tracer.h"
+#include "./hash_table.h"
 #include "./converter.h"
+#include "./memory_accounting.h"
+#include "./buffer_pool.h"
 #include "./data.h"
+#include "./data_view.h"
 #include "./dump_utilities.h"
 #include "./byte_stream.h"
+#include "./bit_reader.h"
 #include "./enable_shared_from_this.h"
 #include "./error.h"
 #include "./log.h"
 #include "./string.h"
+#include "./string_view.h"
 #include "./singleton.h"
 #include "./stop_watch.h"
 #include "./json.h"
+#include "./json_writer.h"
 #include "./random.h"
 #include "./pcm_utilities.h"
+#include "./nal_utilities.h"
 #include "./stack_trace.h"
\ No newline at end of file
@@ -8,3 +8,489 @@
 //==============================================================================
 #include "pcm_utilities.h"
 
+#include <cmath>
+
+#if defined(__SSE2__)
+#	define OV_PCM_USE_SSE2
+#	include <emmintrin.h>
+// The AVX2 kernels are compiled with the target attribute and used only if the CPU supports them,
+// so the binary still runs on the CPUs without AVX2
+#	if defined(__GNUC__)
+#		define OV_PCM_USE_AVX2
+#		include <immintrin.h>
+#	endif
+#elif defined(__aarch64__)
+#	define OV_PCM_USE_NEON
+#	include <arm_neon.h>
+#endif
+
+namespace ov
+{
+	namespace
+	{
+		// Each kernel processes the samples from the beginning and returns the number of the processed samples,
+		// the remaining samples are processed by the scalar loop
+		inline int16_t FloatToS16(float value)
+		{
+			float scaled = value * 32768.0f;
+
+			if(scaled >= 32767.0f)
+			{
+				return 32767;
+			}
+
+			if(scaled <= -32768.0f)
+			{
+				return -32768;
+			}
+
+			// Same rounding as the vector kernels (to the nearest even)
+			return static_cast<int16_t>(::lrintf(scaled));
+		}
+
+#if defined(OV_PCM_USE_AVX2)
+		bool HasAvx2()
+		{
+			static const bool has_avx2 = __builtin_cpu_supports("avx2");
+
+			return has_avx2;
+		}
+
+		__attribute__((target("avx2")))
+		int InterleaveS16Avx2(int16_t *dst, const int16_t *l, const int16_t *r, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 16 <= samples; sample += 16)
+			{
+				__m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(l + sample));
+				__m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(r + sample));
+
+				// L0 R0 ... L3 R3 | L8 R8 ... L11 R11, L4 R4 ... L7 R7 | L12 R12 ... L15 R15
+				__m256i low = _mm256_unpacklo_epi16(left, right);
+				__m256i high = _mm256_unpackhi_epi16(left, right);
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + sample * 2), _mm256_permute2x128_si256(low, high, 0x20));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + sample * 2 + 16), _mm256_permute2x128_si256(low, high, 0x31));
+			}
+
+			return sample;
+		}
+
+		__attribute__((target("avx2")))
+		int InterleaveFloatAvx2(float *dst, const float *l, const float *r, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 8 <= samples; sample += 8)
+			{
+				__m256 left = _mm256_loadu_ps(l + sample);
+				__m256 right = _mm256_loadu_ps(r + sample);
+
+				__m256 low = _mm256_unpacklo_ps(left, right);
+				__m256 high = _mm256_unpackhi_ps(left, right);
+
+				_mm256_storeu_ps(dst + sample * 2, _mm256_permute2f128_ps(low, high, 0x20));
+				_mm256_storeu_ps(dst + sample * 2 + 8, _mm256_permute2f128_ps(low, high, 0x31));
+			}
+
+			return sample;
+		}
+
+		__attribute__((target("avx2")))
+		int DeinterleaveS16Avx2(int16_t *l, int16_t *r, const int16_t *src, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 16 <= samples; sample += 16)
+			{
+				__m256i source0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + sample * 2));
+				__m256i source1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + sample * 2 + 16));
+
+				// The low 16 bits of each 32 bits are the left samples
+				__m256i left = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_slli_epi32(source0, 16), 16), _mm256_srai_epi32(_mm256_slli_epi32(source1, 16), 16));
+				__m256i right = _mm256_packs_epi32(_mm256_srai_epi32(source0, 16), _mm256_srai_epi32(source1, 16));
+
+				// packs works in each 128 bits lane
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(l + sample), _mm256_permute4x64_epi64(left, _MM_SHUFFLE(3, 1, 2, 0)));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(r + sample), _mm256_permute4x64_epi64(right, _MM_SHUFFLE(3, 1, 2, 0)));
+			}
+
+			return sample;
+		}
+
+		__attribute__((target("avx2")))
+		int DeinterleaveFloatAvx2(float *l, float *r, const float *src, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 8 <= samples; sample += 8)
+			{
+				__m256 source0 = _mm256_loadu_ps(src + sample * 2);
+				__m256 source1 = _mm256_loadu_ps(src + sample * 2 + 8);
+
+				// L0 R0 L1 R1 | L4 R4 L5 R5, L2 R2 L3 R3 | L6 R6 L7 R7
+				__m256 low = _mm256_permute2f128_ps(source0, source1, 0x20);
+				__m256 high = _mm256_permute2f128_ps(source0, source1, 0x31);
+
+				_mm256_storeu_ps(l + sample, _mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+				_mm256_storeu_ps(r + sample, _mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+			}
+
+			return sample;
+		}
+
+		__attribute__((target("avx2")))
+		inline __m256i FloatToS32Avx2(const float *source)
+		{
+			__m256 scaled = _mm256_mul_ps(_mm256_loadu_ps(source), _mm256_set1_ps(32768.0f));
+
+			scaled = _mm256_max_ps(_mm256_min_ps(scaled, _mm256_set1_ps(32767.0f)), _mm256_set1_ps(-32768.0f));
+
+			return _mm256_cvtps_epi32(scaled);
+		}
+
+		__attribute__((target("avx2")))
+		int ConvertFloatToS16Avx2(int16_t *dst, const float *src, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 16 <= samples; sample += 16)
+			{
+				__m256i packed = _mm256_packs_epi32(FloatToS32Avx2(src + sample), FloatToS32Avx2(src + sample + 8));
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + sample), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+			}
+
+			return sample;
+		}
+
+		__attribute__((target("avx2")))
+		int InterleaveFloatToS16Avx2(int16_t *dst, const float *l, const float *r, int samples)
+		{
+			// L0 R0 L1 R1 L2 R2 L3 R3 in each lane of (L0 L1 L2 L3 R0 R1 R2 R3)
+			const __m256i order = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15,
+			                                       0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+			int sample = 0;
+
+			for(; sample + 8 <= samples; sample += 8)
+			{
+				__m256i packed = _mm256_packs_epi32(FloatToS32Avx2(l + sample), FloatToS32Avx2(r + sample));
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + sample * 2), _mm256_shuffle_epi8(packed, order));
+			}
+
+			return sample;
+		}
+#endif // OV_PCM_USE_AVX2
+
+#if defined(OV_PCM_USE_SSE2)
+		int InterleaveS16Sse2(int16_t *dst, const int16_t *l, const int16_t *r, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 8 <= samples; sample += 8)
+			{
+				__m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i *>(l + sample));
+				__m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i *>(r + sample));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + sample * 2), _mm_unpacklo_epi16(left, right));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + sample * 2 + 8), _mm_unpackhi_epi16(left, right));
+			}
+
+			return sample;
+		}
+
+		int InterleaveFloatSse2(float *dst, const float *l, const float *r, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 4 <= samples; sample += 4)
+			{
+				__m128 left = _mm_loadu_ps(l + sample);
+				__m128 right = _mm_loadu_ps(r + sample);
+
+				_mm_storeu_ps(dst + sample * 2, _mm_unpacklo_ps(left, right));
+				_mm_storeu_ps(dst + sample * 2 + 4, _mm_unpackhi_ps(left, right));
+			}
+
+			return sample;
+		}
+
+		int DeinterleaveS16Sse2(int16_t *l, int16_t *r, const int16_t *src, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 8 <= samples; sample += 8)
+			{
+				__m128i source0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + sample * 2));
+				__m128i source1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + sample * 2 + 8));
+
+				// The low 16 bits of each 32 bits are the left samples
+				__m128i left = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(source0, 16), 16), _mm_srai_epi32(_mm_slli_epi32(source1, 16), 16));
+				__m128i right = _mm_packs_epi32(_mm_srai_epi32(source0, 16), _mm_srai_epi32(source1, 16));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(l + sample), left);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(r + sample), right);
+			}
+
+			return sample;
+		}
+
+		int DeinterleaveFloatSse2(float *l, float *r, const float *src, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 4 <= samples; sample += 4)
+			{
+				__m128 source0 = _mm_loadu_ps(src + sample * 2);
+				__m128 source1 = _mm_loadu_ps(src + sample * 2 + 4);
+
+				_mm_storeu_ps(l + sample, _mm_shuffle_ps(source0, source1, _MM_SHUFFLE(2, 0, 2, 0)));
+				_mm_storeu_ps(r + sample, _mm_shuffle_ps(source0, source1, _MM_SHUFFLE(3, 1, 3, 1)));
+			}
+
+			return sample;
+		}
+
+		inline __m128i FloatToS32Sse2(const float *source)
+		{
+			__m128 scaled = _mm_mul_ps(_mm_loadu_ps(source), _mm_set1_ps(32768.0f));
+
+			scaled = _mm_max_ps(_mm_min_ps(scaled, _mm_set1_ps(32767.0f)), _mm_set1_ps(-32768.0f));
+
+			return _mm_cvtps_epi32(scaled);
+		}
+
+		int ConvertFloatToS16Sse2(int16_t *dst, const float *src, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 8 <= samples; sample += 8)
+			{
+				__m128i packed = _mm_packs_epi32(FloatToS32Sse2(src + sample), FloatToS32Sse2(src + sample + 4));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + sample), packed);
+			}
+
+			return sample;
+		}
+
+		int InterleaveFloatToS16Sse2(int16_t *dst, const float *l, const float *r, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 8 <= samples; sample += 8)
+			{
+				__m128i left = _mm_packs_epi32(FloatToS32Sse2(l + sample), FloatToS32Sse2(l + sample + 4));
+				__m128i right = _mm_packs_epi32(FloatToS32Sse2(r + sample), FloatToS32Sse2(r + sample + 4));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + sample * 2), _mm_unpacklo_epi16(left, right));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + sample * 2 + 8), _mm_unpackhi_epi16(left, right));
+			}
+
+			return sample;
+		}
+#endif // OV_PCM_USE_SSE2
+
+#if defined(OV_PCM_USE_NEON)
+		int InterleaveS16Neon(int16_t *dst, const int16_t *l, const int16_t *r, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 8 <= samples; sample += 8)
+			{
+				int16x8x2_t stereo = { { vld1q_s16(l + sample), vld1q_s16(r + sample) } };
+
+				vst2q_s16(dst + sample * 2, stereo);
+			}
+
+			return sample;
+		}
+
+		int InterleaveFloatNeon(float *dst, const float *l, const float *r, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 4 <= samples; sample += 4)
+			{
+				float32x4x2_t stereo = { { vld1q_f32(l + sample), vld1q_f32(r + sample) } };
+
+				vst2q_f32(dst + sample * 2, stereo);
+			}
+
+			return sample;
+		}
+
+		int DeinterleaveS16Neon(int16_t *l, int16_t *r, const int16_t *src, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 8 <= samples; sample += 8)
+			{
+				int16x8x2_t stereo = vld2q_s16(src + sample * 2);
+
+				vst1q_s16(l + sample, stereo.val[0]);
+				vst1q_s16(r + sample, stereo.val[1]);
+			}
+
+			return sample;
+		}
+
+		int DeinterleaveFloatNeon(float *l, float *r, const float *src, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 4 <= samples; sample += 4)
+			{
+				float32x4x2_t stereo = vld2q_f32(src + sample * 2);
+
+				vst1q_f32(l + sample, stereo.val[0]);
+				vst1q_f32(r + sample, stereo.val[1]);
+			}
+
+			return sample;
+		}
+
+		inline int16x8_t FloatToS16Neon(const float *source)
+		{
+			const float32x4_t max_value = vdupq_n_f32(32767.0f);
+			const float32x4_t min_value = vdupq_n_f32(-32768.0f);
+
+			float32x4_t scaled0 = vmaxq_f32(vminq_f32(vmulq_n_f32(vld1q_f32(source), 32768.0f), max_value), min_value);
+			float32x4_t scaled1 = vmaxq_f32(vminq_f32(vmulq_n_f32(vld1q_f32(source + 4), 32768.0f), max_value), min_value);
+
+			return vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(scaled0)), vqmovn_s32(vcvtnq_s32_f32(scaled1)));
+		}
+
+		int ConvertFloatToS16Neon(int16_t *dst, const float *src, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 8 <= samples; sample += 8)
+			{
+				vst1q_s16(dst + sample, FloatToS16Neon(src + sample));
+			}
+
+			return sample;
+		}
+
+		int InterleaveFloatToS16Neon(int16_t *dst, const float *l, const float *r, int samples)
+		{
+			int sample = 0;
+
+			for(; sample + 8 <= samples; sample += 8)
+			{
+				int16x8x2_t stereo = { { FloatToS16Neon(l + sample), FloatToS16Neon(r + sample) } };
+
+				vst2q_s16(dst + sample * 2, stereo);
+			}
+
+			return sample;
+		}
+#endif // OV_PCM_USE_NEON
+
+		// Runs the best kernel for the CPU
+#if defined(OV_PCM_USE_AVX2)
+#	define OV_PCM_RUN_KERNEL(name, ...)			(HasAvx2() ? name ## Avx2(__VA_ARGS__) : name ## Sse2(__VA_ARGS__))
+#elif defined(OV_PCM_USE_SSE2)
+#	define OV_PCM_RUN_KERNEL(name, ...)			name ## Sse2(__VA_ARGS__)
+#elif defined(OV_PCM_USE_NEON)
+#	define OV_PCM_RUN_KERNEL(name, ...)			name ## Neon(__VA_ARGS__)
+#else
+#	define OV_PCM_RUN_KERNEL(name, ...)			0
+#endif
+	}
+
+	template<>
+	bool Interleave<int16_t>(void *destination, const void *left, const void *right, int samples)
+	{
+		auto dst = static_cast<int16_t *>(destination);
+		auto l = static_cast<const int16_t *>(left);
+		auto r = static_cast<const int16_t *>(right);
+
+		for(int sample = OV_PCM_RUN_KERNEL(InterleaveS16, dst, l, r, samples); sample < samples; ++sample)
+		{
+			dst[sample * 2] = l[sample];
+			dst[sample * 2 + 1] = r[sample];
+		}
+
+		return true;
+	}
+
+	template<>
+	bool Interleave<float>(void *destination, const void *left, const void *right, int samples)
+	{
+		auto dst = static_cast<float *>(destination);
+		auto l = static_cast<const float *>(left);
+		auto r = static_cast<const float *>(right);
+
+		for(int sample = OV_PCM_RUN_KERNEL(InterleaveFloat, dst, l, r, samples); sample < samples; ++sample)
+		{
+			dst[sample * 2] = l[sample];
+			dst[sample * 2 + 1] = r[sample];
+		}
+
+		return true;
+	}
+
+	template<>
+	bool Deinterleave<int16_t>(void *left, void *right, const void *source, int samples)
+	{
+		auto l = static_cast<int16_t *>(left);
+		auto r = static_cast<int16_t *>(right);
+		auto src = static_cast<const int16_t *>(source);
+
+		for(int sample = OV_PCM_RUN_KERNEL(DeinterleaveS16, l, r, src, samples); sample < samples; ++sample)
+		{
+			l[sample] = src[sample * 2];
+			r[sample] = src[sample * 2 + 1];
+		}
+
+		return true;
+	}
+
+	template<>
+	bool Deinterleave<float>(void *left, void *right, const void *source, int samples)
+	{
+		auto l = static_cast<float *>(left);
+		auto r = static_cast<float *>(right);
+		auto src = static_cast<const float *>(source);
+
+		for(int sample = OV_PCM_RUN_KERNEL(DeinterleaveFloat, l, r, src, samples); sample < samples; ++sample)
+		{
+			l[sample] = src[sample * 2];
+			r[sample] = src[sample * 2 + 1];
+		}
+
+		return true;
+	}
+
+	bool ConvertFloatToS16(void *destination, const void *source, int samples)
+	{
+		auto dst = static_cast<int16_t *>(destination);
+		auto src = static_cast<const float *>(source);
+
+		for(int sample = OV_PCM_RUN_KERNEL(ConvertFloatToS16, dst, src, samples); sample < samples; ++sample)
+		{
+			dst[sample] = FloatToS16(src[sample]);
+		}
+
+		return true;
+	}
+
+	bool InterleaveFloatToS16(void *destination, const void *left, const void *right, int samples)
+	{
+		auto dst = static_cast<int16_t *>(destination);
+		auto l = static_cast<const float *>(left);
+		auto r = static_cast<const float *>(right);
+
+		for(int sample = OV_PCM_RUN_KERNEL(InterleaveFloatToS16, dst, l, r, samples); sample < samples; ++sample)
+		{
+			dst[sample * 2] = FloatToS16(l[sample]);
+			dst[sample * 2 + 1] = FloatToS16(r[sample]);
+		}
+
+		return true;
+	}
+}
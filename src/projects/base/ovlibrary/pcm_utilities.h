@@ -8,9 +8,67 @@
 //==============================================================================
 #pragma once
 
+#include <cstdint>
+
 namespace ov
 {
-// Interleave data of source and store it in destination
+	// Interleave left & right channel data into destination
+	// For example, the source will be interleaved while samples = 5
+	// Left:
+	//  00 01 02 03 04
+	//  L0 L1 L2 L3 L4
+	// Right:
+	//  05 06 07 08 09
+	//  R0 R1 R2 R3 R4
+	// Destination:
+	//  00 05 01 06 02 07 03 08 04 09
+	//  L0 R0 L1 R1 L2 R2 L3 R3 L4 R4
+	template<typename T>
+	bool Interleave(void *destination, const void *left, const void *right, int samples)
+	{
+		T *dst = static_cast<T *>(destination);
+		const T *l = static_cast<const T *>(left);
+		const T *r = static_cast<const T *>(right);
+
+		for(int sample = 0; sample < samples; ++sample)
+		{
+			// copy left channel data into dst
+			*dst++ = *l++;
+			// copy right channel data into dst
+			*dst++ = *r++;
+		}
+
+		return true;
+	}
+
+	// Deinterleave source into left & right channel data (the reverse of Interleave())
+	template<typename T>
+	bool Deinterleave(void *left, void *right, const void *source, int samples)
+	{
+		const T *src = static_cast<const T *>(source);
+		T *l = static_cast<T *>(left);
+		T *r = static_cast<T *>(right);
+
+		for(int sample = 0; sample < samples; ++sample)
+		{
+			*l++ = *src++;
+			*r++ = *src++;
+		}
+
+		return true;
+	}
+
+	// s16/f32 stereo are vectorized (SSE2/AVX2 on x86, NEON on AArch64) in pcm_utilities.cpp
+	template<>
+	bool Interleave<int16_t>(void *destination, const void *left, const void *right, int samples);
+	template<>
+	bool Interleave<float>(void *destination, const void *left, const void *right, int samples);
+	template<>
+	bool Deinterleave<int16_t>(void *left, void *right, const void *source, int samples);
+	template<>
+	bool Deinterleave<float>(void *left, void *right, const void *source, int samples);
+
+	// Interleave data of source and store it in destination
 	// For example, the source will be interleaved while channels = 2, samples = 5
 	// Source:
 	//  00 01 02 03 04 05 06 07 08 09
@@ -24,6 +82,11 @@ namespace ov
 	{
 		const T *src = static_cast<const T *>(source);
 
+		if(channels == 2)
+		{
+			return Interleave<T>(destination, src, src + samples, samples);
+		}
+
 		for(int channel = 0; channel < channels; ++channel)
 		{
 			T *dst = static_cast<T *>(destination) + channel;
@@ -39,32 +102,34 @@ namespace ov
 		return true;
 	}
 
-	// Interleave left & right channel data into destination
-	// For example, the source will be interleaved while samples = 5
-	// Left:
-	//  00 01 02 03 04
-	//  L0 L1 L2 L3 L4
-	// Right:
-	//  05 06 07 08 09
-	//  R0 R1 R2 R3 R4
-	// Destination:
-	//  00 05 01 06 02 07 03 08 04 09
-	//  L0 R0 L1 R1 L2 R2 L3 R3 L4 R4
+	// Deinterleave data of source and store it in destination (the reverse of Interleave())
 	template<typename T>
-	bool Interleave(void *destination, const void *left, const void *right, int samples)
+	bool Deinterleave(void *destination, const void *source, int channels, int samples)
 	{
 		T *dst = static_cast<T *>(destination);
-		const T *l = static_cast<const T *>(left);
-		const T *r = static_cast<const T *>(right);
 
-		for(int sample = 0; sample < samples; ++sample)
+		if(channels == 2)
 		{
-			// copy left channel data into dst
-			*dst++ = *l++;
-			// copy right channel data into dst
-			*dst++ = *r++;
+			return Deinterleave<T>(dst, dst + samples, source, samples);
+		}
+
+		for(int channel = 0; channel < channels; ++channel)
+		{
+			const T *src = static_cast<const T *>(source) + channel;
+
+			for(int sample = 0; sample < samples; ++sample)
+			{
+				*dst++ = *src;
+				src += channels;
+			}
 		}
 
 		return true;
 	}
-}
\ No newline at end of file
+
+	// Converts float samples (-1.0 ~ 1.0) into s16 samples (saturated, rounded to the nearest)
+	bool ConvertFloatToS16(void *destination, const void *source, int samples);
+
+	// Interleave + ConvertFloatToS16 in one pass (e.g. FLTP of the AAC decoder -> S16 of the OPUS encoder)
+	bool InterleaveFloatToS16(void *destination, const void *left, const void *right, int samples);
+}
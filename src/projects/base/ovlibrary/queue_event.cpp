@@ -0,0 +1,61 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./queue_event.h"
+
+#include <chrono>
+
+namespace ov
+{
+	void QueueEvent::Notify()
+	{
+		if(_signaled.exchange(true))
+		{
+			// The consumer has not woken up for the previous notification yet
+			return;
+		}
+
+		// The consumer sets _waiting before it checks _signaled, so either it sees the signal or it is notified here
+		if(_waiting.load())
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_condition.notify_one();
+		}
+	}
+
+	void QueueEvent::Wait()
+	{
+		if(_signaled.exchange(false))
+		{
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		_waiting = true;
+		_condition.wait(lock, [this]() -> bool { return _signaled.load(); });
+		_waiting = false;
+
+		_signaled = false;
+	}
+
+	bool QueueEvent::WaitFor(int64_t timeout)
+	{
+		if(_signaled.exchange(false))
+		{
+			return true;
+		}
+
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		_waiting = true;
+		_condition.wait_for(lock, std::chrono::milliseconds(timeout), [this]() -> bool { return _signaled.load(); });
+		_waiting = false;
+
+		return _signaled.exchange(false);
+	}
+}
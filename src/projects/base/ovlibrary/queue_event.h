@@ -0,0 +1,41 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace ov
+{
+	// Wakes up the consumer thread of the queues
+	//
+	// - Unlike Semaphore, the notifications are not counted: Notify() signals only when the event is not signaled yet,
+	//   and it takes the lock only if the consumer is sleeping
+	// - The producers notify when a queue becomes non-empty, and the consumer drains all of the queues after it wakes up
+	//   (the items pushed while draining signal the event again, so nothing is left in the queues)
+	// - Only one thread waits for the event
+	class QueueEvent
+	{
+	public:
+		void Notify();
+
+		void Wait();
+		// Returns false if it is not notified in timeout (ms)
+		bool WaitFor(int64_t timeout);
+
+	private:
+		std::mutex _mutex;
+		std::condition_variable _condition;
+
+		std::atomic<bool> _signaled { false };
+		// true while the consumer is (about to be) sleeping
+		std::atomic<bool> _waiting { false };
+	};
+}
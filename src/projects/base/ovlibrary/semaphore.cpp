@@ -34,6 +34,19 @@ namespace ov
 		--_count;
 	}
 
+	bool Semaphore::WaitFor(int64_t timeout)
+	{
+		std::unique_lock<decltype(_mutex)> lock(_mutex);
+
+		if(_condition.wait_for(lock, std::chrono::milliseconds(timeout), [this]() -> bool { return _count > 0; }) == false)
+		{
+			return false;
+		}
+
+		--_count;
+		return true;
+	}
+
 	bool Semaphore::TryWait()
 	{
 		std::unique_lock<decltype(_mutex)> lock(_mutex);
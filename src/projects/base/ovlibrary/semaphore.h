@@ -18,6 +18,8 @@ namespace ov
 		void Notify();
 
 		void Wait();
+		// Returns false if it is not notified in timeout (ms)
+		bool WaitFor(int64_t timeout);
 
 		bool TryWait();
 
@@ -0,0 +1,167 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./shared_timer_wheel.h"
+
+namespace ov
+{
+	SharedTimerWheel::SharedTimerWheel()
+		: _start_time(std::chrono::steady_clock::now())
+	{
+	}
+
+	SharedTimerWheel::~SharedTimerWheel()
+	{
+		{
+			std::lock_guard<std::mutex> lock_guard(_mutex);
+
+			_stop = true;
+			_condition.notify_all();
+		}
+
+		if(_thread.joinable())
+		{
+			_thread.join();
+		}
+	}
+
+	int64_t SharedTimerWheel::GetCurrentTime() const
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _start_time).count();
+	}
+
+	void SharedTimerWheel::Arm(uint64_t id, Timer &timer, int64_t after)
+	{
+		int64_t current_time = GetCurrentTime();
+
+		// The wheel stays at the time of the last Advance() while the thread is waiting
+		timer.wheel_id = _wheel.Schedule(after + (current_time - _wheel_time), [this, id]() {
+			_expired_ids.push_back(id);
+		});
+
+		if((current_time + after) < _wake_time)
+		{
+			// The thread is waiting for a later timer
+			_condition.notify_one();
+		}
+	}
+
+	uint64_t SharedTimerWheel::Schedule(int64_t after, const SharedTimerFunction &function)
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		if(_started == false)
+		{
+			_started = true;
+			_thread = std::thread(&SharedTimerWheel::ThreadProc, this);
+		}
+
+		uint64_t id = ++_last_id;
+		auto &timer = _timers[id];
+
+		timer.function = function;
+		Arm(id, timer, after);
+
+		return id;
+	}
+
+	void SharedTimerWheel::Cancel(uint64_t id)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		auto item = _timers.find(id);
+
+		if(item != _timers.end())
+		{
+			_wheel.Cancel(item->second.wheel_id);
+			_timers.erase(item);
+		}
+
+		if((_running_id == id) && (std::this_thread::get_id() != _thread.get_id()))
+		{
+			_running_condition.wait(lock, [this, id]() -> bool {
+				return _running_id != id;
+			});
+		}
+	}
+
+	size_t SharedTimerWheel::GetCount() const
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		return _timers.size();
+	}
+
+	void SharedTimerWheel::ThreadProc()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		std::vector<uint64_t> expired_ids;
+
+		while(_stop == false)
+		{
+			int64_t timeout = _wheel.GetNextTimeout();
+
+			if(timeout < 0)
+			{
+				_wake_time = INT64_MAX;
+				_condition.wait(lock);
+			}
+			else
+			{
+				_wake_time = GetCurrentTime() + timeout;
+				_condition.wait_for(lock, std::chrono::milliseconds(timeout));
+			}
+
+			_wake_time = INT64_MAX;
+			_wheel_time = GetCurrentTime();
+			_wheel.Advance(_wheel_time);
+
+			expired_ids.clear();
+			expired_ids.swap(_expired_ids);
+
+			for(auto id : expired_ids)
+			{
+				auto item = _timers.find(id);
+
+				if(item == _timers.end())
+				{
+					// Canceled by the previous function
+					continue;
+				}
+
+				// The function is called without the lock, so it may schedule/cancel the timers
+				auto function = std::move(item->second.function);
+				_running_id = id;
+
+				lock.unlock();
+				int64_t after = function();
+				lock.lock();
+
+				_running_id = 0;
+				_running_condition.notify_all();
+
+				item = _timers.find(id);
+
+				if(item == _timers.end())
+				{
+					// Canceled while the function is running
+					continue;
+				}
+
+				if(after > 0)
+				{
+					item->second.function = std::move(function);
+					Arm(id, item->second, after);
+				}
+				else
+				{
+					_timers.erase(item);
+				}
+			}
+		}
+	}
+}
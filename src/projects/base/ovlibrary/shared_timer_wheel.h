@@ -0,0 +1,86 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "./singleton.h"
+#include "./timer_wheel.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ov
+{
+	// Returns the delay (ms) until the function is called again, or 0 to finish the timer
+	typedef std::function<int64_t()> SharedTimerFunction;
+
+	// A TimerWheel shared by the modules, driven by its own thread
+	//
+	// - Schedule() and Cancel() are O(1) and thread-safe, so a timer can be armed per session/connection
+	//   instead of scanning every item periodically
+	// - The functions are called by the thread of the wheel without the lock of the wheel
+	// - A timer which is extended (e.g. refreshed by a packet) doesn't need to be rescheduled:
+	//   the function returns the remaining time when it is called earlier than the actual deadline
+	class SharedTimerWheel : public Singleton<SharedTimerWheel>
+	{
+	public:
+		friend class Singleton<SharedTimerWheel>;
+
+		~SharedTimerWheel() override;
+
+		// Returns the id of the timer (never 0), the function is called after (ms)
+		uint64_t Schedule(int64_t after, const SharedTimerFunction &function);
+
+		// After Cancel() returns, the function is not running and will not be called
+		// - If the function is running, it waits for the function to be finished (except the function cancels itself),
+		//   so the caller must not hold the lock which the function acquires
+		void Cancel(uint64_t id);
+
+		size_t GetCount() const;
+
+	protected:
+		SharedTimerWheel();
+
+		struct Timer
+		{
+			SharedTimerFunction function;
+			// id of the TimerWheel
+			uint64_t wheel_id;
+		};
+
+		// ms (monotonic) since the wheel is created
+		int64_t GetCurrentTime() const;
+		// _mutex must be locked
+		void Arm(uint64_t id, Timer &timer, int64_t after);
+		void ThreadProc();
+
+		std::chrono::steady_clock::time_point _start_time;
+
+		mutable std::mutex _mutex;
+		std::condition_variable _condition;
+		std::condition_variable _running_condition;
+
+		TimerWheel _wheel;
+		// Time of the last TimerWheel::Advance()
+		int64_t _wheel_time = 0;
+		uint64_t _last_id = 0;
+		std::unordered_map<uint64_t, Timer> _timers;
+		// ids of the timers expired by TimerWheel::Advance()
+		std::vector<uint64_t> _expired_ids;
+		// id of the timer whose function is running (0: none)
+		uint64_t _running_id = 0;
+		// The thread is waked up if a timer expires before this time
+		int64_t _wake_time = INT64_MAX;
+
+		bool _started = false;
+		bool _stop = false;
+		std::thread _thread;
+	};
+}
@@ -33,15 +33,30 @@ namespace ov
 	}
 
 	String::String(String &&string) noexcept
-		: _buffer(string._buffer),
+	{
+		MoveFrom(string);
+	}
 
-		  _length(string._length),
-		  _capacity(string._capacity)
+	void String::MoveFrom(String &other) noexcept
 	{
-		string._buffer = nullptr;
+		if(other.IsInline())
+		{
+			// The inline buffer can't be taken over
+			::memcpy(_inline_buffer, other._inline_buffer, sizeof(_inline_buffer));
+			_buffer = _inline_buffer;
+		}
+		else
+		{
+			_buffer = other._buffer;
+		}
 
-		string._length = 0;
-		string._capacity = 0;
+		_length = other._length;
+		_capacity = other._capacity;
+
+		other._buffer = nullptr;
+
+		other._length = 0;
+		other._capacity = 0;
 	}
 
 	String::~String()
@@ -87,7 +102,20 @@ namespace ov
 			_buffer[0] = '\0';
 		}
 
-		Append(buffer._buffer);
+		Append(buffer._buffer, buffer._length);
+
+		return *this;
+	}
+
+	String &String::operator =(String &&buffer) noexcept
+	{
+		if(this == &buffer)
+		{
+			return *this;
+		}
+
+		Release();
+		MoveFrom(buffer);
 
 		return *this;
 	}
@@ -639,7 +667,6 @@ namespace ov
 		const char *last;
 		size_t token_length;
 		size_t seperator_length;
-		char token[1024];
 
 		if(separator == nullptr)
 		{
@@ -667,21 +694,10 @@ namespace ov
 		{
 			last = ::strstr(string, separator);
 
-			if(last == nullptr)
-			{
-				token_length = ::strlen(string);
-
-				::memcpy(&(token[0]), string, token_length * sizeof(char));
-			}
-			else
-			{
-				token_length = (last - string);
-
-				::memcpy(&(token[0]), string, token_length * sizeof(char));
-			}
+			token_length = (last == nullptr) ? ::strlen(string) : static_cast<size_t>(last - string);
 
-			token[token_length] = '\0';
-			list.emplace_back(token);
+			// The token is copied to the string directly (no intermediate buffer, so there is no limit of the length)
+			list.emplace_back(string, token_length);
 
 			if(last == nullptr)
 			{
@@ -926,6 +942,32 @@ namespace ov
 
 	bool String::Alloc(size_t length, bool alloc_exactly) noexcept
 	{
+		if(length <= OV_STRING_INLINE_CAPACITY)
+		{
+			if(IsInline())
+			{
+				return true;
+			}
+
+			// The allocated buffer is replaced with the inline buffer (e.g. a long string is assigned a short string)
+			size_t old_length = std::min(_length, static_cast<size_t>(OV_STRING_INLINE_CAPACITY));
+
+			::memset(_inline_buffer, 0, sizeof(_inline_buffer));
+
+			if(old_length > 0L)
+			{
+				::memcpy(_inline_buffer, _buffer, sizeof(char) * old_length);
+			}
+
+			Release();
+
+			_buffer = _inline_buffer;
+			_capacity = OV_STRING_INLINE_CAPACITY;
+			_length = old_length;
+
+			return true;
+		}
+
 		if(
 			// 기존에 할당된 버퍼가 충분 하지 않거나
 			(_capacity < length) ||
@@ -993,7 +1035,14 @@ namespace ov
 
 	bool String::Release() noexcept
 	{
-		OV_SAFE_FREE(_buffer);
+		if(IsInline())
+		{
+			_buffer = nullptr;
+		}
+		else
+		{
+			OV_SAFE_FREE(_buffer);
+		}
 
 		_capacity = 0L;
 		_length = 0L;
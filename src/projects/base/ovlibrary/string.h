@@ -18,6 +18,9 @@
 #include <map>
 #include <vector>
 
+// Strings up to this length are stored in the object itself (e.g. the names and the tokens), without allocating the buffer
+#define OV_STRING_INLINE_CAPACITY		23
+
 namespace ov
 {
 	class Data;
@@ -44,6 +47,7 @@ namespace ov
 
 		// 문자열 조작 API
 		String &operator =(const String &buffer) noexcept;
+		String &operator =(String &&buffer) noexcept;
 		String &operator =(const char *buffer) noexcept;
 		const String &operator +=(const char *buffer) noexcept;
 		String operator +(const String &other) noexcept;
@@ -133,6 +137,15 @@ namespace ov
 		bool Release() noexcept;
 
 	private:
+		bool IsInline() const noexcept
+		{
+			return _buffer == _inline_buffer;
+		}
+
+		// Moves the string of other to this (other becomes an empty string)
+		void MoveFrom(String &other) noexcept;
+
+		// _inline_buffer or the allocated buffer (nullptr: empty string which has no buffer)
 		char *_buffer = nullptr;
 
 		// 실제 데이터가 있는 길이
@@ -140,6 +153,8 @@ namespace ov
 
 		// 거의 지수 형태로 증가함
 		size_t _capacity = 0;
+
+		char _inline_buffer[OV_STRING_INLINE_CAPACITY + 1];
 	};
 
 	struct CaseInsensitiveComparator
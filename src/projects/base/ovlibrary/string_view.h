@@ -0,0 +1,244 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "./string.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace ov
+{
+	// A range of the characters which is owned by someone else (e.g. a line of the request which is being parsed)
+	//
+	// - Nothing is copied until ToString() is called, so the owner must outlive the view
+	// - Not null-terminated: use "%.*s" with GetLength() to print it
+	class StringView
+	{
+	public:
+		StringView() = default;
+
+		StringView(const char *data, size_t length)
+			: _data(data),
+			  _length(length)
+		{
+		}
+
+		StringView(const char *string) // NOLINT
+			: _data(string),
+			  _length((string != nullptr) ? ::strlen(string) : 0)
+		{
+		}
+
+		StringView(const String &string) // NOLINT
+			: _data(string.CStr()),
+			  _length(string.GetLength())
+		{
+		}
+
+		const char *GetData() const noexcept
+		{
+			return _data;
+		}
+
+		size_t GetLength() const noexcept
+		{
+			return _length;
+		}
+
+		bool IsEmpty() const noexcept
+		{
+			return _length == 0;
+		}
+
+		char operator [](size_t index) const noexcept
+		{
+			return _data[index];
+		}
+
+		const char *begin() const noexcept
+		{
+			return _data;
+		}
+
+		const char *end() const noexcept
+		{
+			return _data + _length;
+		}
+
+		// -1: not found
+		off_t IndexOf(char c, off_t start_position = 0) const noexcept
+		{
+			for(size_t index = start_position; index < _length; index++)
+			{
+				if(_data[index] == c)
+				{
+					return index;
+				}
+			}
+
+			return -1L;
+		}
+
+		off_t IndexOf(const StringView &string, off_t start_position = 0) const noexcept
+		{
+			if(string._length == 0)
+			{
+				return (static_cast<size_t>(start_position) <= _length) ? start_position : -1L;
+			}
+
+			for(size_t index = start_position; (index + string._length) <= _length; index++)
+			{
+				if(::memcmp(_data + index, string._data, string._length) == 0)
+				{
+					return index;
+				}
+			}
+
+			return -1L;
+		}
+
+		off_t IndexOfRev(char c) const noexcept
+		{
+			for(size_t index = _length; index > 0; index--)
+			{
+				if(_data[index - 1] == c)
+				{
+					return index - 1;
+				}
+			}
+
+			return -1L;
+		}
+
+		StringView Substring(size_t start_position) const noexcept
+		{
+			if(start_position >= _length)
+			{
+				return StringView(end(), 0);
+			}
+
+			return StringView(_data + start_position, _length - start_position);
+		}
+
+		StringView Substring(size_t start_position, size_t length) const noexcept
+		{
+			auto view = Substring(start_position);
+
+			view._length = std::min(view._length, length);
+
+			return view;
+		}
+
+		StringView Left(size_t length) const noexcept
+		{
+			return StringView(_data, std::min(_length, length));
+		}
+
+		StringView Right(size_t length) const noexcept
+		{
+			length = std::min(_length, length);
+
+			return StringView(_data + (_length - length), length);
+		}
+
+		// Removes the whitespaces of both sides (same as String::Trim())
+		StringView Trim() const noexcept
+		{
+			size_t left_index = 0;
+			size_t right_index = _length;
+
+			while((left_index < right_index) && IsWhiteSpace(_data[left_index]))
+			{
+				left_index++;
+			}
+
+			while((right_index > left_index) && IsWhiteSpace(_data[right_index - 1]))
+			{
+				right_index--;
+			}
+
+			return StringView(_data + left_index, right_index - left_index);
+		}
+
+		bool HasPrefix(const StringView &prefix) const noexcept
+		{
+			return (_length >= prefix._length) && (::memcmp(_data, prefix._data, prefix._length) == 0);
+		}
+
+		bool HasSuffix(const StringView &suffix) const noexcept
+		{
+			return (_length >= suffix._length) && (::memcmp(_data + (_length - suffix._length), suffix._data, suffix._length) == 0);
+		}
+
+		// Same as String::Split(), but the tokens refer to this view
+		std::vector<StringView> Split(const StringView &separator) const
+		{
+			std::vector<StringView> list;
+
+			if(separator.IsEmpty())
+			{
+				list.push_back(*this);
+				return list;
+			}
+
+			size_t position = 0;
+
+			while(true)
+			{
+				off_t found = IndexOf(separator, position);
+
+				if(found < 0)
+				{
+					list.emplace_back(_data + position, _length - position);
+					break;
+				}
+
+				list.emplace_back(_data + position, found - position);
+				position = found + separator._length;
+			}
+
+			return list;
+		}
+
+		String ToString() const
+		{
+			return String(_data, _length);
+		}
+
+		bool operator ==(const StringView &other) const noexcept
+		{
+			return (_length == other._length) && ((_length == 0) || (::memcmp(_data, other._data, _length) == 0));
+		}
+
+		bool operator !=(const StringView &other) const noexcept
+		{
+			return (operator ==(other)) == false;
+		}
+
+	protected:
+		static bool IsWhiteSpace(char c) noexcept
+		{
+			switch(c)
+			{
+				case ' ':
+				case '\t':
+				case '\r':
+				case '\n':
+					return true;
+
+				default:
+					return false;
+			}
+		}
+
+		const char *_data = "";
+		size_t _length = 0;
+	};
+}
@@ -0,0 +1,154 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./system_load.h"
+#include "./platform.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace ov
+{
+	SystemLoadInfo SystemLoad::GetLoad()
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		auto current_time = std::chrono::steady_clock::now();
+
+		if((_sampled == false) || (std::chrono::duration_cast<std::chrono::milliseconds>(current_time - _sample_time).count() >= OV_SYSTEM_LOAD_SAMPLE_INTERVAL))
+		{
+			Sample();
+		}
+
+		return _load;
+	}
+
+	void SystemLoad::Sample()
+	{
+		auto current_time = std::chrono::steady_clock::now();
+
+		uint64_t busy_time = 0;
+		uint64_t total_time = 0;
+		uint64_t sent_bytes = 0;
+
+		bool cpu_read = ReadCpuTime(&busy_time, &total_time);
+		bool network_read = ReadSentBytes(&sent_bytes);
+
+		if(_sampled)
+		{
+			auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(current_time - _sample_time).count();
+
+			if(cpu_read && (total_time > _total_time) && (busy_time >= _busy_time))
+			{
+				_load.cpu_usage = static_cast<double>(busy_time - _busy_time) * 100.0 / static_cast<double>(total_time - _total_time);
+			}
+
+			// The counters may be reset (e.g. an interface is removed)
+			if(network_read && (elapsed > 0) && (sent_bytes >= _sent_bytes))
+			{
+				_load.egress_bps = (sent_bytes - _sent_bytes) * 8ULL * 1000000ULL / static_cast<uint64_t>(elapsed);
+			}
+		}
+
+		_busy_time = busy_time;
+		_total_time = total_time;
+		_sent_bytes = sent_bytes;
+		_sample_time = current_time;
+		_sampled = true;
+	}
+
+	bool SystemLoad::ReadCpuTime(uint64_t *busy_time, uint64_t *total_time)
+	{
+#if IS_LINUX
+		FILE *file = ::fopen("/proc/stat", "r");
+
+		if(file == nullptr)
+		{
+			return false;
+		}
+
+		// cpu  <user> <nice> <system> <idle> <iowait> <irq> <softirq> <steal> ...
+		unsigned long long times[8] = { 0 };
+		int count = ::fscanf(file, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+		                     &times[0], &times[1], &times[2], &times[3], &times[4], &times[5], &times[6], &times[7]);
+
+		::fclose(file);
+
+		if(count < 4)
+		{
+			return false;
+		}
+
+		uint64_t total = 0;
+
+		for(auto time : times)
+		{
+			total += time;
+		}
+
+		// idle + iowait
+		*busy_time = total - times[3] - times[4];
+		*total_time = total;
+
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool SystemLoad::ReadSentBytes(uint64_t *sent_bytes)
+	{
+#if IS_LINUX
+		FILE *file = ::fopen("/proc/net/dev", "r");
+
+		if(file == nullptr)
+		{
+			return false;
+		}
+
+		char line[512];
+		uint64_t total = 0;
+
+		while(::fgets(line, sizeof(line), file) != nullptr)
+		{
+			// <interface>: <rx bytes> <packets> <errs> <drop> <fifo> <frame> <compressed> <multicast> <tx bytes> ...
+			char *colon = ::strchr(line, ':');
+
+			if(colon == nullptr)
+			{
+				// Header
+				continue;
+			}
+
+			*colon = '\0';
+
+			char name[64];
+
+			if((::sscanf(line, "%63s", name) != 1) || (::strcmp(name, "lo") == 0))
+			{
+				continue;
+			}
+
+			unsigned long long values[9];
+
+			if(::sscanf(colon + 1, "%llu %llu %llu %llu %llu %llu %llu %llu %llu",
+			            &values[0], &values[1], &values[2], &values[3], &values[4], &values[5], &values[6], &values[7], &values[8]) == 9)
+			{
+				total += values[8];
+			}
+		}
+
+		::fclose(file);
+
+		*sent_bytes = total;
+
+		return true;
+#else
+		return false;
+#endif
+	}
+}
@@ -0,0 +1,59 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "./singleton.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// The load is sampled when it is requested, but at most once in this interval (ms)
+#define OV_SYSTEM_LOAD_SAMPLE_INTERVAL		1000
+
+namespace ov
+{
+	struct SystemLoadInfo
+	{
+		// Usage of all the CPUs (0 ~ 100)
+		double cpu_usage = 0.0;
+		// Bits per second sent by the network interfaces (except the loopback)
+		uint64_t egress_bps = 0;
+	};
+
+	// Load of the machine (Linux: /proc/stat, /proc/net/dev)
+	//
+	// - The values are averages between the two last samples, so they are 0 until the second sample
+	// - Not supported platforms return 0
+	class SystemLoad : public Singleton<SystemLoad>
+	{
+	public:
+		friend class Singleton<SystemLoad>;
+
+		SystemLoadInfo GetLoad();
+
+	protected:
+		SystemLoad() = default;
+
+		void Sample();
+
+		static bool ReadCpuTime(uint64_t *busy_time, uint64_t *total_time);
+		static bool ReadSentBytes(uint64_t *sent_bytes);
+
+		std::mutex _mutex;
+
+		bool _sampled = false;
+		std::chrono::steady_clock::time_point _sample_time;
+
+		uint64_t _busy_time = 0;
+		uint64_t _total_time = 0;
+		uint64_t _sent_bytes = 0;
+
+		SystemLoadInfo _load;
+	};
+}
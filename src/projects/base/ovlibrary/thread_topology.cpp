@@ -0,0 +1,233 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./thread_topology.h"
+#include "./ovlibrary.h"
+#include "./platform.h"
+#include "./ovlibrary_private.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#if IS_LINUX
+#	include <pthread.h>
+#	include <sched.h>
+#	include <unistd.h>
+#	include <sys/syscall.h>
+
+// linux/mempolicy.h
+#	define OV_MPOL_PREFERRED					1
+#endif // IS_LINUX
+
+#ifndef CPU_SETSIZE
+#	define CPU_SETSIZE							1024
+#endif // CPU_SETSIZE
+
+namespace ov
+{
+	bool ThreadTopology::SetPool(const ov::String &name, const ov::String &cpu_list, int numa_node)
+	{
+		Pool pool;
+
+		pool.numa_node = numa_node;
+
+		if(cpu_list.IsEmpty())
+		{
+			if(numa_node < 0)
+			{
+				logtw("Neither the CPUs nor the NUMA node is specified for the thread pool: %s", name.CStr());
+				return false;
+			}
+
+			// All CPUs of the NUMA node
+			ov::String path = ov::String::FormatString("/sys/devices/system/node/node%d/cpulist", numa_node);
+			FILE *file = ::fopen(path.CStr(), "r");
+			char buffer[1024] = { 0 };
+
+			if((file == nullptr) || (::fgets(buffer, sizeof(buffer), file) == nullptr))
+			{
+				if(file != nullptr)
+				{
+					::fclose(file);
+				}
+
+				logtw("Could not read the CPUs of NUMA node %d (pool: %s)", numa_node, name.CStr());
+				return false;
+			}
+
+			::fclose(file);
+
+			if(ParseCpuList(ov::String(buffer).Trim(), &(pool.cpus)) == false)
+			{
+				logtw("Invalid CPU list of NUMA node %d: %s", numa_node, buffer);
+				return false;
+			}
+		}
+		else if(ParseCpuList(cpu_list, &(pool.cpus)) == false)
+		{
+			logtw("Invalid CPU list of the thread pool %s: %s", name.CStr(), cpu_list.CStr());
+			return false;
+		}
+
+		logti("Thread pool %s: %zu CPUs (%s), NUMA node: %d", name.CStr(), pool.cpus.size(), cpu_list.IsEmpty() ? "all CPUs of the node" : cpu_list.CStr(), numa_node);
+
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		_pools[name] = pool;
+
+		return true;
+	}
+
+	bool ThreadTopology::IsPoolSet(const char *name) const
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		return (_pools.find(name) != _pools.end());
+	}
+
+	bool ThreadTopology::BindCurrentThread(const char *name, int index) const
+	{
+		Pool pool;
+
+		{
+			std::lock_guard<std::mutex> lock_guard(_mutex);
+
+			auto item = _pools.find(name);
+
+			if(item == _pools.end())
+			{
+				// Not managed
+				return true;
+			}
+
+			pool = item->second;
+		}
+
+#if IS_LINUX
+		cpu_set_t cpu_set;
+		CPU_ZERO(&cpu_set);
+
+		if(IsPerThreadPool(name))
+		{
+			CPU_SET(pool.cpus[static_cast<size_t>(index) % pool.cpus.size()], &cpu_set);
+		}
+		else
+		{
+			for(auto cpu : pool.cpus)
+			{
+				CPU_SET(cpu, &cpu_set);
+			}
+		}
+
+		int result = ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set), &cpu_set);
+
+		if(result != 0)
+		{
+			logtw("Could not bind the thread #%d of the pool %s: %s", index, name, ::strerror(result));
+			return false;
+		}
+
+		if((pool.numa_node >= 0) && (SetMemoryPolicy(pool.numa_node) == false))
+		{
+			return false;
+		}
+
+		logtd("Thread #%d of the pool %s is bound", index, name);
+
+		return true;
+#else // IS_LINUX
+		return false;
+#endif // IS_LINUX
+	}
+
+	int ThreadTopology::GetCpu(const char *name, int index) const
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		auto item = _pools.find(name);
+
+		if((item == _pools.end()) || (IsPerThreadPool(name) == false))
+		{
+			return -1;
+		}
+
+		auto &cpus = item->second.cpus;
+
+		return cpus[static_cast<size_t>(index) % cpus.size()];
+	}
+
+	bool ThreadTopology::ParseCpuList(const ov::String &cpu_list, std::vector<int> *cpus)
+	{
+		cpus->clear();
+
+		for(auto &token : cpu_list.Split(","))
+		{
+			auto range = token.Trim();
+
+			if(range.IsEmpty())
+			{
+				continue;
+			}
+
+			auto bounds = range.Split("-");
+
+			if((bounds.size() < 1) || (bounds.size() > 2))
+			{
+				return false;
+			}
+
+			int first = ov::Converter::ToInt32(bounds[0].Trim(), 10);
+			int last = (bounds.size() == 2) ? ov::Converter::ToInt32(bounds[1].Trim(), 10) : first;
+
+			if((first < 0) || (last < first) || (last >= CPU_SETSIZE))
+			{
+				return false;
+			}
+
+			for(int cpu = first; cpu <= last; cpu++)
+			{
+				cpus->push_back(cpu);
+			}
+		}
+
+		return (cpus->empty() == false);
+	}
+
+	bool ThreadTopology::IsPerThreadPool(const ov::String &name)
+	{
+		// The port threads are aligned with the RSS queues of the NIC (a socket per CPU)
+		return (name == OV_THREAD_POOL_PORT);
+	}
+
+	bool ThreadTopology::SetMemoryPolicy(int numa_node)
+	{
+#if IS_LINUX
+		// The pages are allocated on the node if possible (or on the other nodes if the node is out of memory)
+		unsigned long node_mask[16] = { 0 };
+		size_t bits = sizeof(unsigned long) * 8;
+
+		if(static_cast<size_t>(numa_node) >= (bits * OV_COUNTOF(node_mask)))
+		{
+			logtw("Invalid NUMA node: %d", numa_node);
+			return false;
+		}
+
+		node_mask[numa_node / bits] |= (1UL << (numa_node % bits));
+
+		if(::syscall(SYS_set_mempolicy, OV_MPOL_PREFERRED, node_mask, bits * OV_COUNTOF(node_mask) + 1) != 0)
+		{
+			logtw("Could not set the memory policy (NUMA node: %d): %s", numa_node, ::strerror(errno));
+			return false;
+		}
+
+		return true;
+#else // IS_LINUX
+		return false;
+#endif // IS_LINUX
+	}
+}
@@ -0,0 +1,68 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "./singleton.h"
+#include "./string.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Names of the thread pools
+// PhysicalPort: a thread per socket (SO_REUSEPORT), each thread is pinned to a CPU of the pool
+#define OV_THREAD_POOL_PORT						"Port"
+// The pools below are pinned to all CPUs of the pool (the scheduler balances the threads among them)
+#define OV_THREAD_POOL_STREAM_WORKER			"StreamWorker"
+#define OV_THREAD_POOL_SEGMENT_WORKER			"SegmentWorker"
+#define OV_THREAD_POOL_TRANSCODER				"Transcoder"
+
+namespace ov
+{
+	// Assigns the thread pools to the CPU sets and the NUMA nodes (Linux only)
+	//
+	// - The pools are set once at the startup (before the threads are created)
+	// - A thread of a pool calls BindCurrentThread() when it is started
+	// - If the NUMA node is given, the thread prefers the memory of the node; otherwise the memory is allocated on the node of
+	//   the CPU which touches it first, so the buffers should be allocated by the thread itself
+	// - Threads of the pools which are not set are not changed
+	class ThreadTopology : public Singleton<ThreadTopology>
+	{
+	public:
+		friend class Singleton<ThreadTopology>;
+
+		// cpu_list: "0-3,8,10-11" (empty: the CPUs of the NUMA node)
+		// numa_node: -1 if not used
+		bool SetPool(const ov::String &name, const ov::String &cpu_list, int numa_node);
+
+		bool IsPoolSet(const char *name) const;
+
+		// index: index of the thread in the pool (used by the pools which pin a thread to a CPU)
+		bool BindCurrentThread(const char *name, int index = 0) const;
+
+		// CPU of the index-th thread of the pool (-1 if the pool isn't set, or the threads aren't pinned to a CPU)
+		int GetCpu(const char *name, int index) const;
+
+		static bool ParseCpuList(const ov::String &cpu_list, std::vector<int> *cpus);
+
+	protected:
+		struct Pool
+		{
+			std::vector<int> cpus;
+			int numa_node = -1;
+		};
+
+		ThreadTopology() = default;
+
+		static bool IsPerThreadPool(const ov::String &name);
+		static bool SetMemoryPolicy(int numa_node);
+
+		mutable std::mutex _mutex;
+		std::map<ov::String, Pool> _pools;
+	};
+}
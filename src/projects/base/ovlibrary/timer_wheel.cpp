@@ -0,0 +1,158 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./timer_wheel.h"
+
+#include <algorithm>
+
+#define SLOT_INDEX(tick, level)			(((tick) >> ((level) * OV_TIMER_WHEEL_SLOT_BITS)) & (OV_TIMER_WHEEL_SLOT_COUNT - 1))
+
+namespace ov
+{
+	TimerWheel::TimerWheel(int64_t current_time)
+		: _current_tick(current_time)
+	{
+	}
+
+	uint64_t TimerWheel::Schedule(int64_t after, const TimerWheelFunction &function)
+	{
+		uint64_t id = ++_last_id;
+
+		_functions[id] = function;
+
+		// The timer is expired at the next tick at least
+		Insert({ id, _current_tick + std::max<int64_t>(after, 1) });
+
+		return id;
+	}
+
+	void TimerWheel::Cancel(uint64_t id)
+	{
+		_functions.erase(id);
+	}
+
+	void TimerWheel::Insert(const TimerItem &item)
+	{
+		int64_t delta = item.expire_tick - _current_tick;
+		int level = 0;
+
+		while((level < (OV_TIMER_WHEEL_LEVEL_COUNT - 1)) && (delta >= (1LL << ((level + 1) * OV_TIMER_WHEEL_SLOT_BITS))))
+		{
+			level++;
+		}
+
+		int64_t expire_tick = item.expire_tick;
+
+		if(delta >= (1LL << (OV_TIMER_WHEEL_LEVEL_COUNT * OV_TIMER_WHEEL_SLOT_BITS)))
+		{
+			// Out of the range, put it to the last slot of the wheel
+			expire_tick = _current_tick + (1LL << (OV_TIMER_WHEEL_LEVEL_COUNT * OV_TIMER_WHEEL_SLOT_BITS)) - 1;
+		}
+
+		_slots[level][SLOT_INDEX(std::max(expire_tick, _current_tick), level)].push_back(item);
+	}
+
+	void TimerWheel::Cascade(int level, int64_t tick)
+	{
+		std::vector<TimerItem> items;
+
+		items.swap(_slots[level][SLOT_INDEX(tick, level)]);
+
+		for(const auto &item : items)
+		{
+			if(_functions.find(item.id) != _functions.end())
+			{
+				Insert(item);
+			}
+		}
+	}
+
+	void TimerWheel::Advance(int64_t current_time)
+	{
+		if(_functions.empty())
+		{
+			// Nothing to expire (the slots may have the canceled timers only)
+			for(auto &level : _slots)
+			{
+				for(auto &slot : level)
+				{
+					slot.clear();
+				}
+			}
+
+			_current_tick = std::max(_current_tick, current_time);
+			return;
+		}
+
+		std::vector<TimerItem> items;
+
+		while(_current_tick < current_time)
+		{
+			_current_tick++;
+
+			// Cascade the upper levels when the lower level wraps around
+			for(int level = 1; level < OV_TIMER_WHEEL_LEVEL_COUNT; level++)
+			{
+				if(SLOT_INDEX(_current_tick, level - 1) != 0)
+				{
+					break;
+				}
+
+				Cascade(level, _current_tick);
+			}
+
+			items.clear();
+			items.swap(_slots[0][SLOT_INDEX(_current_tick, 0)]);
+
+			for(const auto &item : items)
+			{
+				if(item.expire_tick > _current_tick)
+				{
+					// Clamped timer (out of the range), keep it in the wheel
+					Insert(item);
+					continue;
+				}
+
+				auto function_item = _functions.find(item.id);
+
+				if(function_item == _functions.end())
+				{
+					// Canceled
+					continue;
+				}
+
+				auto function = std::move(function_item->second);
+				_functions.erase(function_item);
+
+				// The function may schedule another timer
+				function();
+			}
+		}
+	}
+
+	int64_t TimerWheel::GetNextTimeout() const
+	{
+		if(_functions.empty())
+		{
+			return -1;
+		}
+
+		// Find the slot of the lowest level until the next cascading
+		int64_t remained = OV_TIMER_WHEEL_SLOT_COUNT - SLOT_INDEX(_current_tick, 0);
+
+		for(int64_t offset = 1; offset < remained; offset++)
+		{
+			if(_slots[0][SLOT_INDEX(_current_tick + offset, 0)].empty() == false)
+			{
+				return offset;
+			}
+		}
+
+		// The upper levels are cascaded at the boundary
+		return remained;
+	}
+}
@@ -0,0 +1,73 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// Number of slots of each level (6 bits)
+#define OV_TIMER_WHEEL_SLOT_BITS		6
+#define OV_TIMER_WHEEL_SLOT_COUNT		(1 << OV_TIMER_WHEEL_SLOT_BITS)
+// 4 levels cover 2^24 ms (about 4.6 hours), the longer timer is expired at the end of the wheel
+#define OV_TIMER_WHEEL_LEVEL_COUNT		4
+
+namespace ov
+{
+	typedef std::function<void()> TimerWheelFunction;
+
+	// Hierarchical timer wheel (the tick is 1 ms)
+	//
+	// - Scheduling and canceling are O(1), the timers of the upper levels are cascaded to the lower level
+	//   when the lower level wraps around
+	// - Time is given by the owner (no thread), so a worker can drive many timers in its own loop:
+	//   wait for GetNextTimeout(), then call Advance()
+	// - Not thread-safe (the owner thread uses it)
+	class TimerWheel
+	{
+	public:
+		// current_time: ms (monotonic)
+		explicit TimerWheel(int64_t current_time = 0);
+
+		// Returns the id of the timer, the function is called once after (ms)
+		uint64_t Schedule(int64_t after, const TimerWheelFunction &function);
+		void Cancel(uint64_t id);
+
+		// Calls the functions of the timers which are expired until current_time
+		void Advance(int64_t current_time);
+
+		// ms until the next timer may be expired (-1 if there is no timer)
+		int64_t GetNextTimeout() const;
+
+		size_t GetCount() const
+		{
+			return _functions.size();
+		}
+
+	protected:
+		struct TimerItem
+		{
+			uint64_t id;
+			int64_t expire_tick;
+		};
+
+		void Insert(const TimerItem &item);
+		// Moves the timers of the slot to the lower levels
+		void Cascade(int level, int64_t tick);
+
+		int64_t _current_tick;
+		uint64_t _last_id = 0;
+
+		std::vector<TimerItem> _slots[OV_TIMER_WHEEL_LEVEL_COUNT][OV_TIMER_WHEEL_SLOT_COUNT];
+
+		// id -> function (canceled timers are removed here, and skipped when their slots are expired)
+		std::unordered_map<uint64_t, TimerWheelFunction> _functions;
+	};
+}
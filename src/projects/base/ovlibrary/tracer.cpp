@@ -0,0 +1,320 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "./tracer.h"
+#include "./platform.h"
+#include "./json_writer.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace ov
+{
+	namespace
+	{
+		thread_local uint64_t current_flow_id = 0;
+
+		// Marks the buffer finished when the thread is finished, so it can be removed by the next Start()
+		struct TraceBufferHolder
+		{
+			~TraceBufferHolder()
+			{
+				if(buffer != nullptr)
+				{
+					buffer->SetFinished();
+				}
+			}
+
+			std::shared_ptr<TraceBuffer> buffer;
+		};
+
+		thread_local TraceBufferHolder current_buffer;
+
+		const char *GetFlowPhase(TraceFlow flow)
+		{
+			switch(flow)
+			{
+				case TraceFlow::Start:
+					return "s";
+				case TraceFlow::Step:
+					return "t";
+				case TraceFlow::End:
+					return "f";
+				case TraceFlow::None:
+					break;
+			}
+
+			return nullptr;
+		}
+	}
+
+	std::atomic<bool> Tracer::_enabled { false };
+	std::atomic<int64_t> Tracer::_stop_time { 0 };
+	std::atomic<uint64_t> Tracer::_last_flow_id { 0 };
+
+	TraceBuffer::TraceBuffer()
+		: _thread_id(Platform::GetThreadId()),
+		  _events(OV_TRACER_BUFFER_SIZE)
+	{
+		char name[64] = { 0 };
+
+		if(::pthread_getname_np(::pthread_self(), name, sizeof(name)) == 0)
+		{
+			_thread_name = name;
+		}
+	}
+
+	void TraceBuffer::CopyEvents(int64_t from_time, std::vector<TraceEvent> &events) const
+	{
+		uint64_t end_index = _write_index.load(std::memory_order_acquire);
+		uint64_t begin_index = (end_index > OV_TRACER_BUFFER_SIZE) ? (end_index - OV_TRACER_BUFFER_SIZE) : 0;
+
+		std::vector<TraceEvent> copied_events(_events.begin(), _events.end());
+
+		// The slots from the oldest one may be overwritten while copying (the slot of after_index is being written)
+		uint64_t after_index = _write_index.load(std::memory_order_acquire);
+
+		if((after_index + 1) > OV_TRACER_BUFFER_SIZE)
+		{
+			begin_index = std::max(begin_index, after_index + 1 - OV_TRACER_BUFFER_SIZE);
+		}
+
+		for(uint64_t index = begin_index; index < end_index; index++)
+		{
+			const auto &event = copied_events[index % OV_TRACER_BUFFER_SIZE];
+
+			if(event.begin_time >= from_time)
+			{
+				events.push_back(event);
+			}
+		}
+	}
+
+	void Tracer::Start(int64_t duration)
+	{
+#if defined(OV_TRACER_DISABLED)
+		// The trace points are not compiled
+		return;
+#endif
+
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		// The buffers of the finished threads are not needed any more
+		for(auto iterator = _buffers.begin(); iterator != _buffers.end();)
+		{
+			if((*iterator)->IsFinished())
+			{
+				iterator = _buffers.erase(iterator);
+			}
+			else
+			{
+				++iterator;
+			}
+		}
+
+		int64_t current_time = GetCurrentNanoseconds();
+
+		// The events which are recorded before are not exported (the buffers are written by the owner threads only, so they are not cleared)
+		_start_time = current_time;
+		_stop_time = (duration > 0) ? (current_time + (duration * 1000000LL)) : 0;
+
+		_enabled = true;
+	}
+
+	void Tracer::Stop()
+	{
+		_enabled = false;
+	}
+
+	int64_t Tracer::GetRemainingTime() const
+	{
+		int64_t stop_time = _stop_time.load(std::memory_order_relaxed);
+
+		if((IsEnabled() == false) || (stop_time == 0))
+		{
+			return 0;
+		}
+
+		return std::max<int64_t>((stop_time - GetCurrentNanoseconds()) / 1000000LL, 0);
+	}
+
+	size_t Tracer::GetThreadCount()
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		return _buffers.size();
+	}
+
+	ov::String Tracer::ExportChromeTrace(int64_t last)
+	{
+		std::vector<std::shared_ptr<TraceBuffer>> buffers;
+
+		{
+			std::lock_guard<std::mutex> lock_guard(_mutex);
+			buffers = _buffers;
+		}
+
+		int64_t from_time = _start_time;
+
+		if(last > 0)
+		{
+			from_time = std::max<int64_t>(from_time, GetCurrentNanoseconds() - (last * 1000000LL));
+		}
+
+		auto process_id = Platform::GetProcessId();
+		// Written by the events, instead of building the tree of jsoncpp (a capture has hundreds of thousands of events)
+		JsonWriter writer(OV_TRACER_BUFFER_SIZE);
+		std::vector<TraceEvent> events;
+
+		writer.BeginObject()
+			.Member("displayTimeUnit", "ms")
+			.Key("traceEvents").BeginArray();
+
+		for(const auto &buffer : buffers)
+		{
+			auto thread_id = buffer->GetThreadId();
+
+			writer.BeginObject()
+				.Member("name", "thread_name")
+				.Member("ph", "M")
+				.Member("pid", process_id)
+				.Member("tid", thread_id)
+				.Key("args").BeginObject()
+				.Member("name", buffer->GetThreadName())
+				.EndObject()
+				.EndObject()
+				.RawText("\n");
+
+			events.clear();
+			buffer->CopyEvents(from_time, events);
+
+			for(const auto &event : events)
+			{
+				// microseconds
+				double begin_time = static_cast<double>(event.begin_time) / 1000.0;
+				double duration = static_cast<double>(event.duration) / 1000.0;
+
+				writer.BeginObject()
+					.Member("name", event.name)
+					.Member("cat", event.category);
+
+				if(event.duration > 0)
+				{
+					writer.Member("ph", "X")
+						.Key("ts").Value(begin_time, 3)
+						.Key("dur").Value(duration, 3);
+				}
+				else
+				{
+					writer.Member("ph", "i")
+						.Member("s", "t")
+						.Key("ts").Value(begin_time, 3);
+				}
+
+				writer.Member("pid", process_id)
+					.Member("tid", thread_id)
+					.EndObject()
+					.RawText("\n");
+
+				auto flow_phase = GetFlowPhase(event.flow);
+
+				if(flow_phase != nullptr)
+				{
+					// Bound to the enclosing slice (the middle of the event)
+					writer.BeginObject()
+						.Member("name", "flow")
+						.Member("cat", "flow")
+						.Member("ph", flow_phase)
+						.Member("bp", "e")
+						.Member("id", event.flow_id)
+						.Key("ts").Value(begin_time + (duration / 2.0), 3)
+						.Member("pid", process_id)
+						.Member("tid", thread_id)
+						.EndObject()
+						.RawText("\n");
+				}
+			}
+		}
+
+		writer.EndArray()
+			.EndObject()
+			.RawText("\n");
+
+		return writer.ToString();
+	}
+
+	int64_t Tracer::GetCurrentNanoseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	uint64_t Tracer::GetCurrentFlowId()
+	{
+		return current_flow_id;
+	}
+
+	void Tracer::SetCurrentFlowId(uint64_t flow_id)
+	{
+		current_flow_id = flow_id;
+	}
+
+	uint64_t Tracer::StartFlow(const char *category, const char *name)
+	{
+		if(IsEnabled() == false)
+		{
+			return 0;
+		}
+
+		uint64_t flow_id = _last_flow_id.fetch_add(1, std::memory_order_relaxed) + 1;
+
+		Record({category, name, GetCurrentNanoseconds(), 0, flow_id, TraceFlow::Start});
+
+		return flow_id;
+	}
+
+	void Tracer::RecordFlowStep(const char *category, const char *name, uint64_t flow_id)
+	{
+		if((IsEnabled() == false) || (flow_id == 0))
+		{
+			return;
+		}
+
+		Record({category, name, GetCurrentNanoseconds(), 0, flow_id, TraceFlow::Step});
+	}
+
+	void Tracer::Record(const TraceEvent &event)
+	{
+		int64_t stop_time = _stop_time.load(std::memory_order_relaxed);
+
+		if((stop_time != 0) && (event.begin_time > stop_time))
+		{
+			// The capture is finished
+			_enabled = false;
+			return;
+		}
+
+		auto buffer = Instance()->GetCurrentBuffer();
+
+		buffer->Record(event);
+	}
+
+	TraceBuffer *Tracer::GetCurrentBuffer()
+	{
+		if(current_buffer.buffer == nullptr)
+		{
+			// Allocated when the thread records the first event
+			current_buffer.buffer = std::make_shared<TraceBuffer>();
+
+			std::lock_guard<std::mutex> lock_guard(_mutex);
+			_buffers.push_back(current_buffer.buffer);
+		}
+
+		return current_buffer.buffer.get();
+	}
+}
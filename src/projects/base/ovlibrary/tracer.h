@@ -0,0 +1,235 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "./singleton.h"
+#include "./string.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Number of the events which are kept for each thread (the oldest events are overwritten)
+#define OV_TRACER_BUFFER_SIZE				65536
+// Duration of a capture which is started without the duration (seconds)
+#define OV_TRACER_DEFAULT_DURATION			10
+
+namespace ov
+{
+	// The events of the same flow are connected by the arrows (e.g. a packet from the provider to the socket of the session)
+	enum class TraceFlow : uint8_t
+	{
+		None,
+		Start,
+		Step,
+		End
+	};
+
+	struct TraceEvent
+	{
+		// Must be the string literals (the pointers are kept until the events are exported)
+		const char *category;
+		const char *name;
+
+		// Monotonic time (in nanoseconds)
+		int64_t begin_time;
+		// 0: instant event
+		int64_t duration;
+
+		uint64_t flow_id;
+		TraceFlow flow;
+	};
+
+	// Ring of the events of a thread
+	//
+	// - Written by the owner thread only (no lock), read by the exporter
+	class TraceBuffer
+	{
+	public:
+		TraceBuffer();
+
+		void Record(const TraceEvent &event)
+		{
+			auto index = _write_index.load(std::memory_order_relaxed);
+
+			_events[index % OV_TRACER_BUFFER_SIZE] = event;
+
+			_write_index.store(index + 1, std::memory_order_release);
+		}
+
+		// Copies the events which begin at from_time or later (the events which are overwritten while copying are skipped)
+		void CopyEvents(int64_t from_time, std::vector<TraceEvent> &events) const;
+
+		uint64_t GetThreadId() const
+		{
+			return _thread_id;
+		}
+
+		const ov::String &GetThreadName() const
+		{
+			return _thread_name;
+		}
+
+		// The owner thread is finished
+		void SetFinished()
+		{
+			_finished = true;
+		}
+
+		bool IsFinished() const
+		{
+			return _finished;
+		}
+
+	protected:
+		uint64_t _thread_id;
+		ov::String _thread_name;
+
+		std::vector<TraceEvent> _events;
+		std::atomic<uint64_t> _write_index { 0 };
+		std::atomic<bool> _finished { false };
+	};
+
+	// Trace points of the media pipeline, which can be exported to Perfetto/Chrome trace (JSON)
+	//
+	// - Tracing is disabled by default, and the trace points only read an atomic flag while disabled
+	// - Capture: records the events for the duration, and stops by itself
+	// - Flight recorder: records the events until Stop(), only the last OV_TRACER_BUFFER_SIZE events of each thread are kept
+	// - Define OV_TRACER_DISABLED to remove the trace points at compile time
+	class Tracer : public Singleton<Tracer>
+	{
+	public:
+		friend class Singleton<Tracer>;
+
+		static bool IsEnabled()
+		{
+			return _enabled.load(std::memory_order_relaxed);
+		}
+
+		// duration: milliseconds (0 = flight recorder)
+		void Start(int64_t duration);
+		void Stop();
+
+		bool IsFlightRecorder() const
+		{
+			return _stop_time.load(std::memory_order_relaxed) == 0;
+		}
+
+		// Milliseconds until the capture is stopped (0: stopped or flight recorder)
+		int64_t GetRemainingTime() const;
+
+		size_t GetThreadCount();
+
+		// Chrome trace event format (JSON object format), which can be opened by Perfetto UI and chrome://tracing
+		// - last: only the events of the last N milliseconds (0 = all the events since Start())
+		ov::String ExportChromeTrace(int64_t last = 0);
+
+		// Monotonic time (in nanoseconds)
+		static int64_t GetCurrentNanoseconds();
+
+		// The flow which the current thread is processing (set by TraceFlowScope)
+		static uint64_t GetCurrentFlowId();
+		static void SetCurrentFlowId(uint64_t flow_id);
+
+		// Issues a new flow id and records the start of the flow (0 if tracing is disabled)
+		static uint64_t StartFlow(const char *category, const char *name);
+
+		// Records an instant event which continues the flow (e.g. several flows are processed by one scope)
+		static void RecordFlowStep(const char *category, const char *name, uint64_t flow_id);
+
+		static void Record(const TraceEvent &event);
+
+	protected:
+		Tracer() = default;
+
+		TraceBuffer *GetCurrentBuffer();
+
+		static std::atomic<bool> _enabled;
+		// 0: flight recorder
+		static std::atomic<int64_t> _stop_time;
+		static std::atomic<uint64_t> _last_flow_id;
+
+		std::atomic<int64_t> _start_time { 0 };
+
+		std::mutex _mutex;
+		std::vector<std::shared_ptr<TraceBuffer>> _buffers;
+	};
+
+	// Records the time between the construction and the destruction as an event of the current thread
+	class TraceScope
+	{
+	public:
+		TraceScope(const char *category, const char *name, TraceFlow flow = TraceFlow::Step)
+		{
+			if(Tracer::IsEnabled())
+			{
+				_category = category;
+				_name = name;
+				_flow = flow;
+				_flow_id = Tracer::GetCurrentFlowId();
+				_begin_time = Tracer::GetCurrentNanoseconds();
+			}
+		}
+
+		~TraceScope()
+		{
+			if(_begin_time != 0)
+			{
+				Tracer::Record({_category, _name, _begin_time, Tracer::GetCurrentNanoseconds() - _begin_time,
+				                _flow_id, (_flow_id != 0) ? _flow : TraceFlow::None});
+			}
+		}
+
+		TraceScope(const TraceScope &) = delete;
+		TraceScope &operator=(const TraceScope &) = delete;
+
+	protected:
+		const char *_category = nullptr;
+		const char *_name = nullptr;
+		TraceFlow _flow = TraceFlow::None;
+		uint64_t _flow_id = 0;
+		int64_t _begin_time = 0;
+	};
+
+	// Sets the flow of the current thread until the scope is finished (e.g. while a packet which is popped from a queue is processed)
+	class TraceFlowScope
+	{
+	public:
+		explicit TraceFlowScope(uint64_t flow_id)
+			: _previous_flow_id(Tracer::GetCurrentFlowId())
+		{
+			Tracer::SetCurrentFlowId(flow_id);
+		}
+
+		~TraceFlowScope()
+		{
+			Tracer::SetCurrentFlowId(_previous_flow_id);
+		}
+
+		TraceFlowScope(const TraceFlowScope &) = delete;
+		TraceFlowScope &operator=(const TraceFlowScope &) = delete;
+
+	protected:
+		uint64_t _previous_flow_id;
+	};
+}
+
+#define OV_TRACE_CONCAT_INTERNAL(a, b) a##b
+#define OV_TRACE_CONCAT(a, b) OV_TRACE_CONCAT_INTERNAL(a, b)
+
+#if defined(OV_TRACER_DISABLED)
+#	define OV_TRACE_SCOPE(category, name)
+#	define OV_TRACE_SCOPE_FLOW(category, name, flow)
+#	define OV_TRACE_FLOW(flow_id)
+#else
+// ex) OV_TRACE_SCOPE("router", "Push");
+#	define OV_TRACE_SCOPE(category, name) ov::TraceScope OV_TRACE_CONCAT(__trace_scope_, __LINE__)(category, name)
+#	define OV_TRACE_SCOPE_FLOW(category, name, flow) ov::TraceScope OV_TRACE_CONCAT(__trace_scope_, __LINE__)(category, name, flow)
+#	define OV_TRACE_FLOW(flow_id) ov::TraceFlowScope OV_TRACE_CONCAT(__trace_flow_, __LINE__)(flow_id)
+#endif
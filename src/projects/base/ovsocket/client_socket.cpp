@@ -18,7 +18,40 @@ namespace ov
 	ClientSocket::ClientSocket(SocketWrapper socket, const SocketAddress &remote_address)
 		: Socket(socket, remote_address)
 	{
-		MakeNonBlocking();
+		if(GetType() == SocketType::Tcp)
+		{
+			// Accepted with SOCK_NONBLOCK
+			_is_nonblock = true;
+		}
+		else
+		{
+			MakeNonBlocking();
+		}
+	}
+
+	bool ClientSocket::Close()
+	{
+		CompleteHandshake();
+
+		return Socket::Close();
+	}
+
+	void ClientSocket::StartHandshake(const std::shared_ptr<std::atomic<int>> &pending_handshakes)
+	{
+		_pending_handshakes = pending_handshakes;
+
+		if(_is_handshaking.exchange(true) == false)
+		{
+			(*_pending_handshakes)++;
+		}
+	}
+
+	void ClientSocket::CompleteHandshake()
+	{
+		if(_is_handshaking.exchange(false) && (_pending_handshakes != nullptr))
+		{
+			(*_pending_handshakes)--;
+		}
 	}
 
 	ssize_t ClientSocket::Send(const ov::String &string, bool include_null_char)
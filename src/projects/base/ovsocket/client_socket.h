@@ -10,6 +10,8 @@
 
 #include "socket.h"
 
+#include <atomic>
+
 namespace ov
 {
 	// 일반적으로 사용되는 소켓 (server에서 생성한 client socket)
@@ -40,9 +42,26 @@ namespace ov
 		using Socket::Connect;
 		using Socket::Send;
 		using Socket::Recv;
-		using Socket::Close;
 		using Socket::GetState;
 
+		bool Close() override;
+
+		// The connection is set up (e.g. the first request is received after the TLS handshake),
+		// so it is no longer counted as a pending handshake of the ServerSocket
+		void CompleteHandshake();
+
+		bool IsHandshaking() const
+		{
+			return _is_handshaking;
+		}
+
 		String ToString() const override;
+
+	protected:
+		// Called by ServerSocket (when the handshake tracking is enabled)
+		void StartHandshake(const std::shared_ptr<std::atomic<int>> &pending_handshakes);
+
+		std::atomic<bool> _is_handshaking { false };
+		std::shared_ptr<std::atomic<int>> _pending_handshakes;
 	};
 }
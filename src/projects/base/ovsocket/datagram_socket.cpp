@@ -13,12 +13,12 @@
 
 namespace ov
 {
-	bool DatagramSocket::Prepare(int port)
+	bool DatagramSocket::Prepare(int port, bool reuse_port)
 	{
-		return Prepare(SocketAddress(port));
+		return Prepare(SocketAddress(port), reuse_port);
 	}
 
-	bool DatagramSocket::Prepare(const SocketAddress &address)
+	bool DatagramSocket::Prepare(const SocketAddress &address, bool reuse_port)
 	{
 		CHECK_STATE(== SocketState::Closed, false);
 
@@ -29,6 +29,7 @@ namespace ov
 				PrepareEpoll() &&
 				AddToEpoll(this, static_cast<void *>(this)) &&
 				SetSockOpt<int>(SO_REUSEADDR, 1) &&
+				((reuse_port == false) || SetSockOpt<int>(SO_REUSEPORT, 1)) &&
 				Bind(address)
 			) == false)
 		{
@@ -40,11 +41,44 @@ namespace ov
 		return true;
 	}
 
-	bool DatagramSocket::DispatchEvent(const DatagramCallback& data_callback, int timeout)
+	bool DatagramSocket::EnableIoUring()
 	{
 		CHECK_STATE2(>= SocketState::Created, <= SocketState::Bound, false);
+
+		auto io_uring = std::make_unique<IoUringReceiver>();
+
+		if(io_uring->Prepare(GetSocket().GetSocket()) == false)
+		{
+			return false;
+		}
+
+		_io_uring = std::move(io_uring);
+
+		return true;
+	}
+
+	bool DatagramSocket::DispatchEvent(const DatagramCallback& data_callback, int timeout)
+	{
 		OV_ASSERT2(data_callback != nullptr);
 
+		return DispatchEvent([&](const std::shared_ptr<DatagramSocket> &socket, const std::vector<Datagram> &datagrams) {
+			for(auto &datagram : datagrams)
+			{
+				data_callback(socket, datagram.remote_address, datagram.data);
+			}
+		}, timeout);
+	}
+
+	bool DatagramSocket::DispatchEvent(const DatagramBatchCallback& batch_callback, int timeout)
+	{
+		CHECK_STATE2(>= SocketState::Created, <= SocketState::Bound, false);
+		OV_ASSERT2(batch_callback != nullptr);
+
+		if(_io_uring != nullptr)
+		{
+			return DispatchIoUring(batch_callback, timeout);
+		}
+
 		if(_is_nonblock)
 		{
 			int count = EpollWait(timeout);
@@ -77,17 +111,21 @@ namespace ov
 				{
 					logtd("Trying to read UDP packets...");
 
+					auto self = this->GetSharedPtrAs<DatagramSocket>();
+					std::vector<Datagram> datagrams;
+
+					datagrams.reserve(RecvBatchSize);
+
 					while(true)
 					{
-						std::shared_ptr<Data> data = std::make_shared<ov::Data>(UdpBufferSize);
+						datagrams.clear();
 
 						// socket에서 이벤트 발생
-						std::shared_ptr<SocketAddress> remote;
-						std::shared_ptr<ov::Error> error = RecvFrom(data, &remote);
+						std::shared_ptr<ov::Error> error = RecvBatch(&datagrams);
 
-						if(data->GetLength() > 0L)
+						if(datagrams.empty() == false)
 						{
-							data_callback(this->GetSharedPtrAs<DatagramSocket>(), *(remote.get()), data);
+							batch_callback(self, datagrams);
 						}
 
 						if(error != nullptr)
@@ -97,7 +135,7 @@ namespace ov
 						}
 						else
 						{
-							if(data->GetLength() == 0L)
+							if(datagrams.size() < RecvBatchSize)
 							{
 								// 다음 데이터를 기다려야 함
 								break;
@@ -128,6 +166,103 @@ namespace ov
 		return true;
 	}
 
+	std::shared_ptr<ov::Error> DatagramSocket::RecvBatch(std::vector<Datagram> *datagrams)
+	{
+		OV_ASSERT2(_socket.IsValid());
+
+		if(_recv_headers.empty())
+		{
+			_recv_headers.resize(RecvBatchSize);
+			_recv_iovecs.resize(RecvBatchSize);
+			_recv_addresses.resize(RecvBatchSize);
+			_recv_buffer.resize(RecvBatchSize * UdpBufferSize);
+
+			for(int index = 0; index < RecvBatchSize; index++)
+			{
+				_recv_iovecs[index].iov_base = _recv_buffer.data() + (index * UdpBufferSize);
+				_recv_iovecs[index].iov_len = UdpBufferSize;
+			}
+		}
+
+		// The lengths are overwritten by the previous call
+		for(int index = 0; index < RecvBatchSize; index++)
+		{
+			msghdr &header = _recv_headers[index].msg_hdr;
+
+			header = {};
+			header.msg_name = &(_recv_addresses[index]);
+			header.msg_namelen = sizeof(sockaddr_storage);
+			header.msg_iov = &(_recv_iovecs[index]);
+			header.msg_iovlen = 1;
+
+			_recv_headers[index].msg_len = 0;
+		}
+
+		logtd("[%p] [#%d] Trying to read from the socket...", this, _socket.GetSocket());
+
+		int count = ::recvmmsg(_socket.GetSocket(), _recv_headers.data(), RecvBatchSize, (_is_nonblock ? MSG_DONTWAIT : 0), nullptr);
+
+		if(count < 0)
+		{
+			auto error = Error::CreateErrorFromErrno();
+
+			switch(error->GetCode())
+			{
+				case EAGAIN:
+					// 클라이언트가 보낸 데이터를 끝까지 다 읽었음. 다음 데이터가 올 때까지 대기해야 함
+					return nullptr;
+
+				case ECONNRESET:
+					// Connection reset by peer
+					logtw("[%p] [#%d] Connection reset by peer", this, _socket.GetSocket());
+					SetState(SocketState::Error);
+					return error;
+
+				default:
+					logte("[%p] [#%d] An error occurred while read data: %s", this, _socket.GetSocket(), error->ToString().CStr());
+					SetState(SocketState::Error);
+					return error;
+			}
+		}
+
+		logtd("[%p] [#%d] %d datagrams read", this, _socket.GetSocket(), count);
+
+		for(int index = 0; index < count; index++)
+		{
+			// The datagrams are copied to the buffers of their own length, since the observers may keep them
+			auto data = std::make_shared<ov::Data>(_recv_iovecs[index].iov_base, _recv_headers[index].msg_len);
+
+			datagrams->emplace_back(SocketAddress(_recv_addresses[index]), data);
+		}
+
+		return nullptr;
+	}
+
+	bool DatagramSocket::DispatchIoUring(const DatagramBatchCallback& batch_callback, int timeout)
+	{
+		auto self = this->GetSharedPtrAs<DatagramSocket>();
+		std::vector<Datagram> datagrams;
+
+		bool result = _io_uring->Dispatch([&](const SocketAddress &remote_address, const std::shared_ptr<Data> &data) {
+			datagrams.emplace_back(remote_address, data);
+		}, timeout);
+
+		if(datagrams.empty() == false)
+		{
+			batch_callback(self, datagrams);
+		}
+
+		return result;
+	}
+
+	bool DatagramSocket::Close()
+	{
+		// The requests of io_uring are cancelled before the socket is closed
+		_io_uring.reset();
+
+		return Socket::Close();
+	}
+
 	String DatagramSocket::ToString() const
 	{
 		return Socket::ToString("DatagramSocket");
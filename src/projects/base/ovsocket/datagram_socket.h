@@ -10,9 +10,27 @@
 
 #include "socket.h"
 #include "socket_datastructure.h"
+#include "io_uring_receiver.h"
+
+#include <vector>
 
 namespace ov
 {
+	struct Datagram
+	{
+		Datagram(const SocketAddress &remote_address, const std::shared_ptr<Data> &data)
+			: remote_address(remote_address),
+			  data(data)
+		{
+		}
+
+		SocketAddress remote_address;
+		std::shared_ptr<Data> data;
+	};
+
+	// Called with the datagrams which are received at once (by a recvmmsg() or a wait of io_uring)
+	typedef std::function<void(const std::shared_ptr<ov::DatagramSocket> &client, const std::vector<Datagram> &datagrams)> DatagramBatchCallback;
+
 	class DatagramSocket : public Socket
 	{
 	public:
@@ -20,11 +38,21 @@ namespace ov
 		~DatagramSocket() override = default;
 
 		// 특정 port로 bind
-		bool Prepare(int port);
+		bool Prepare(int port, bool reuse_port = false);
 		// address에 해당하는 주소로 bind
-		bool Prepare(const SocketAddress &address);
+		// reuse_port가 true면 SO_REUSEPORT를 설정하여 같은 address에 여러 DatagramSocket을 bind할 수 있음
+		bool Prepare(const SocketAddress &address, bool reuse_port = false);
+
+		// Receives the datagrams with io_uring instead of epoll (must be called after Prepare())
+		// Returns false if the kernel doesn't support it, the socket keeps using epoll in that case
+		bool EnableIoUring();
+		bool IsIoUringEnabled() const
+		{
+			return _io_uring != nullptr;
+		}
 
 		bool DispatchEvent(const DatagramCallback& data_callback, int timeout = Infinite);
+		bool DispatchEvent(const DatagramBatchCallback& batch_callback, int timeout = Infinite);
 
 		using Socket::Connect;
 		using Socket::GetState;
@@ -32,10 +60,24 @@ namespace ov
 		using Socket::RecvFrom;
 		using Socket::Send;
 		using Socket::SendTo;
-		using Socket::Close;
+
+		bool Close() override;
 
 		String ToString() const override;
 
 	protected:
+		bool DispatchIoUring(const DatagramBatchCallback& batch_callback, int timeout);
+
+		// Receives at most RecvBatchSize datagrams with a recvmmsg() call
+		// The datagrams are appended to the list (it is empty if there is no datagram to read)
+		std::shared_ptr<ov::Error> RecvBatch(std::vector<Datagram> *datagrams);
+
+		std::unique_ptr<IoUringReceiver> _io_uring;
+
+		// Buffers of the recvmmsg() (they are allocated when the first datagram is received)
+		std::vector<mmsghdr> _recv_headers;
+		std::vector<iovec> _recv_iovecs;
+		std::vector<sockaddr_storage> _recv_addresses;
+		std::vector<uint8_t> _recv_buffer;
 	};
 }
@@ -0,0 +1,263 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "dns_resolver.h"
+#include "socket_private.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace ov
+{
+	DnsResolver::~DnsResolver()
+	{
+		{
+			std::lock_guard<std::mutex> lock_guard(_mutex);
+
+			_stop = true;
+			_lookup_queue.clear();
+		}
+
+		_lookup_condition.notify_all();
+		_resolved_condition.notify_all();
+
+		for(auto &thread : _threads)
+		{
+			if(thread.joinable())
+			{
+				thread.join();
+			}
+		}
+	}
+
+	std::vector<SocketAddress> DnsResolver::Resolve(const ov::String &hostname, uint16_t port, int timeout)
+	{
+		std::vector<SocketAddress> addresses;
+
+		if(ParseIpAddress(hostname, port, &addresses))
+		{
+			return addresses;
+		}
+
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		auto &entry = _entries[hostname];
+		int64_t current_time = GetCurrentTime();
+
+		if((entry.expire_time == 0) || (current_time >= entry.expire_time))
+		{
+			StartLookup(hostname, entry);
+		}
+
+		if((entry.expire_time == 0) && (timeout > 0))
+		{
+			// Not resolved yet (the entries are not erased, so the reference is valid after the wait)
+			_resolved_condition.wait_for(lock, std::chrono::milliseconds(timeout), [this, &entry]() -> bool {
+				return _stop || (entry.expire_time != 0);
+			});
+		}
+
+		// The expired addresses are used until the lookup is finished
+		for(auto address : entry.addresses)
+		{
+			address.SetPort(port);
+			addresses.push_back(std::move(address));
+		}
+
+		if(addresses.empty())
+		{
+			logtw("Could not resolve the host [%s]%s", hostname.CStr(), entry.is_resolving ? " (the lookup is in progress)" : "");
+		}
+
+		return addresses;
+	}
+
+	void DnsResolver::Prefetch(const ov::String &hostname)
+	{
+		std::vector<SocketAddress> addresses;
+
+		if(ParseIpAddress(hostname, 0, &addresses))
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		auto &entry = _entries[hostname];
+
+		if((entry.expire_time == 0) || (GetCurrentTime() >= entry.expire_time))
+		{
+			StartLookup(hostname, entry);
+		}
+	}
+
+	bool DnsResolver::ParseIpAddress(const ov::String &hostname, uint16_t port, std::vector<SocketAddress> *addresses)
+	{
+		in6_addr buffer {};
+
+		if(hostname.IsEmpty() ||
+		   (::inet_pton(AF_INET, hostname.CStr(), &buffer) == 1) ||
+		   (::inet_pton(AF_INET6, hostname.CStr(), &buffer) == 1))
+		{
+			// Same as SocketAddress (an empty hostname is INADDR_ANY)
+			addresses->emplace_back(hostname, port);
+			return true;
+		}
+
+		return false;
+	}
+
+	int64_t DnsResolver::GetCurrentTime()
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void DnsResolver::StartLookup(const ov::String &hostname, Entry &entry)
+	{
+		if(entry.is_resolving || _stop)
+		{
+			return;
+		}
+
+		if(_threads.empty())
+		{
+			try
+			{
+				for(int index = 0; index < OV_DNS_RESOLVER_THREAD_COUNT; index++)
+				{
+					_threads.emplace_back(&DnsResolver::ThreadProc, this);
+				}
+			}
+			catch(const std::system_error &e)
+			{
+				logte("Failed to start DNS resolver thread.");
+
+				if(_threads.empty())
+				{
+					return;
+				}
+			}
+		}
+
+		entry.is_resolving = true;
+		_lookup_queue.push_back(hostname);
+
+		_lookup_condition.notify_one();
+	}
+
+	void DnsResolver::ThreadProc()
+	{
+		while(true)
+		{
+			ov::String hostname;
+
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+
+				_lookup_condition.wait(lock, [this]() -> bool {
+					return _stop || (_lookup_queue.empty() == false);
+				});
+
+				if(_stop)
+				{
+					break;
+				}
+
+				hostname = std::move(_lookup_queue.front());
+				_lookup_queue.pop_front();
+			}
+
+			// The lock isn't held while getaddrinfo() is blocked
+			auto addresses = Lookup(hostname);
+
+			{
+				std::lock_guard<std::mutex> lock_guard(_mutex);
+
+				auto &entry = _entries[hostname];
+
+				entry.is_resolving = false;
+
+				if(addresses.empty() == false)
+				{
+					entry.addresses = std::move(addresses);
+					entry.expire_time = GetCurrentTime() + OV_DNS_CACHE_TTL;
+				}
+				else
+				{
+					// The previous addresses (if any) are kept, they are more useful than nothing until the next lookup
+					entry.expire_time = GetCurrentTime() + OV_DNS_NEGATIVE_CACHE_TTL;
+				}
+			}
+
+			_resolved_condition.notify_all();
+		}
+	}
+
+	std::vector<SocketAddress> DnsResolver::Lookup(const ov::String &hostname)
+	{
+		addrinfo hints {};
+
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+
+		addrinfo *result = nullptr;
+		int error = ::getaddrinfo(hostname.CStr(), nullptr, &hints, &result);
+
+		if(error != 0)
+		{
+			logte("An error occurred while resolve DNS for host [%s]: %s", hostname.CStr(), ::gai_strerror(error));
+			return {};
+		}
+
+		std::vector<SocketAddress> ipv4_addresses;
+		std::vector<SocketAddress> ipv6_addresses;
+
+		for(addrinfo *item = result; item != nullptr; item = item->ai_next)
+		{
+			switch(item->ai_family)
+			{
+				case AF_INET:
+					ipv4_addresses.emplace_back(*reinterpret_cast<sockaddr_in *>(item->ai_addr));
+					break;
+
+				case AF_INET6:
+					ipv6_addresses.emplace_back(*reinterpret_cast<sockaddr_in6 *>(item->ai_addr));
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		OV_SAFE_FUNC(result, nullptr, ::freeaddrinfo,);
+
+		// IPv4 is preferred like SocketAddress::SetHostname(), then the families alternate,
+		// so a broken family delays the connection only by an attempt
+		std::vector<SocketAddress> addresses;
+		size_t count = std::max(ipv4_addresses.size(), ipv6_addresses.size());
+
+		for(size_t index = 0; index < count; index++)
+		{
+			if(index < ipv4_addresses.size())
+			{
+				addresses.push_back(ipv4_addresses[index]);
+			}
+
+			if(index < ipv6_addresses.size())
+			{
+				addresses.push_back(ipv6_addresses[index]);
+			}
+		}
+
+		logtd("The host [%s] is resolved: %zu addresses", hostname.CStr(), addresses.size());
+
+		return addresses;
+	}
+}
@@ -0,0 +1,81 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "socket_address.h"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <base/ovlibrary/ovlibrary.h>
+
+// getaddrinfo() doesn't give the TTL of the records, so the addresses are cached for this time (ms)
+#define OV_DNS_CACHE_TTL						(60 * 1000)
+// The failures are cached for this time (ms), so the reconnections don't flood the DNS server
+#define OV_DNS_NEGATIVE_CACHE_TTL				(5 * 1000)
+// Number of the threads which call getaddrinfo()
+#define OV_DNS_RESOLVER_THREAD_COUNT			4
+
+namespace ov
+{
+	// Resolves the hostnames of the outgoing connections (relay, push, upload) on its own threads
+	//
+	// - The lookups of a hostname are coalesced, so a reconnection storm makes only one query
+	// - An expired entry is still returned while it is refreshed in the background
+	// - The threads are started by the first lookup
+	class DnsResolver : public Singleton<DnsResolver>
+	{
+	public:
+		friend class Singleton<DnsResolver>;
+
+		~DnsResolver() override;
+
+		// Returns the addresses of the host with the port (IPv4 first, then the families alternate for Socket::Connect()),
+		// empty if the lookup fails or isn't finished within the timeout (ms, it keeps running and the next call may get the result)
+		std::vector<SocketAddress> Resolve(const ov::String &hostname, uint16_t port, int timeout);
+
+		// Starts the lookup without waiting for it (e.g. when the target is configured)
+		void Prefetch(const ov::String &hostname);
+
+	protected:
+		struct Entry
+		{
+			// The ports are 0
+			std::vector<SocketAddress> addresses;
+			// ms (steady clock), 0: not resolved yet
+			int64_t expire_time = 0;
+			bool is_resolving = false;
+		};
+
+		DnsResolver() = default;
+
+		// Returns true if the hostname is an IP address (the lookup is not needed)
+		static bool ParseIpAddress(const ov::String &hostname, uint16_t port, std::vector<SocketAddress> *addresses);
+		static int64_t GetCurrentTime();
+
+		// _mutex must be locked
+		void StartLookup(const ov::String &hostname, Entry &entry);
+		void ThreadProc();
+		static std::vector<SocketAddress> Lookup(const ov::String &hostname);
+
+		std::mutex _mutex;
+		std::condition_variable _lookup_condition;
+		std::condition_variable _resolved_condition;
+
+		// key: hostname
+		std::map<ov::String, Entry> _entries;
+		std::deque<ov::String> _lookup_queue;
+
+		std::vector<std::thread> _threads;
+		bool _stop = false;
+	};
+}
@@ -0,0 +1,435 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "io_uring_receiver.h"
+#include "socket_private.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#if defined(__linux__) && defined(__has_include)
+#	if __has_include(<linux/io_uring.h>)
+#		include <linux/io_uring.h>
+#	endif
+#endif
+
+// Multishot recvmsg and the provided buffer ring are declared since Linux 6.0
+#if defined(IORING_RECV_MULTISHOT) && defined(__NR_io_uring_setup)
+#	define OV_IO_URING_SUPPORTED                1
+#else
+#	define OV_IO_URING_SUPPORTED                0
+#endif
+
+// user_data of the multishot recvmsg
+#define OV_IO_URING_RECV_USER_DATA              1
+
+namespace ov
+{
+	IoUringReceiver::~IoUringReceiver()
+	{
+		Release();
+	}
+
+#if OV_IO_URING_SUPPORTED
+	bool IoUringReceiver::Prepare(int socket)
+	{
+		OV_ASSERT2(_ring_fd == -1);
+
+		_socket = socket;
+
+		if((SetupRing() == false) || (RegisterBuffers() == false))
+		{
+			Release();
+			return false;
+		}
+
+		// If the kernel doesn't support the multishot recvmsg, the request is failed immediately
+		SubmitRecvMsg();
+
+		if(Enter(_pending_submit_count, 0, 0) < 0)
+		{
+			logtw("[#%d] Could not submit the request of io_uring: %s", _socket, ::strerror(errno));
+			Release();
+			return false;
+		}
+
+		unsigned int head = *_cq_head;
+
+		if(head != __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE))
+		{
+			const io_uring_cqe *cqe = &(_cqes[head & *_cq_mask]);
+
+			if((cqe->res < 0) && (cqe->res != -ENOBUFS))
+			{
+				logtw("[#%d] Multishot recvmsg of io_uring is not supported: %s", _socket, ::strerror(-cqe->res));
+				Release();
+				return false;
+			}
+		}
+
+		logtd("[#%d] io_uring is prepared (buffers: %d x %zu bytes)", _socket, OV_IO_URING_BUFFER_COUNT, _buffer_size);
+
+		return true;
+	}
+
+	bool IoUringReceiver::SetupRing()
+	{
+		io_uring_params params {};
+
+		_ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, OV_IO_URING_QUEUE_DEPTH, &params));
+
+		if(_ring_fd < 0)
+		{
+			logtw("io_uring is not available: %s", ::strerror(errno));
+			return false;
+		}
+
+		if((OV_CHECK_FLAG(params.features, IORING_FEAT_SINGLE_MMAP) == false) || (OV_CHECK_FLAG(params.features, IORING_FEAT_EXT_ARG) == false))
+		{
+			logtw("io_uring of this kernel is too old (features: 0x%08X)", params.features);
+			return false;
+		}
+
+		// The submission queue and the completion queue are mapped at once (IORING_FEAT_SINGLE_MMAP)
+		_ring_size = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned int),
+		                      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+		_ring = ::mmap(nullptr, _ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQ_RING);
+
+		if(_ring == MAP_FAILED)
+		{
+			_ring = nullptr;
+			logte("Could not map the rings of io_uring: %s", ::strerror(errno));
+			return false;
+		}
+
+		_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+		void *sqes = ::mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQES);
+
+		if(sqes == MAP_FAILED)
+		{
+			logte("Could not map the submission entries of io_uring: %s", ::strerror(errno));
+			return false;
+		}
+
+		_sqes = static_cast<io_uring_sqe *>(sqes);
+
+		auto ring = static_cast<uint8_t *>(_ring);
+
+		_sq_head = reinterpret_cast<unsigned int *>(ring + params.sq_off.head);
+		_sq_tail = reinterpret_cast<unsigned int *>(ring + params.sq_off.tail);
+		_sq_mask = reinterpret_cast<unsigned int *>(ring + params.sq_off.ring_mask);
+		_sq_array = reinterpret_cast<unsigned int *>(ring + params.sq_off.array);
+
+		_cq_head = reinterpret_cast<unsigned int *>(ring + params.cq_off.head);
+		_cq_tail = reinterpret_cast<unsigned int *>(ring + params.cq_off.tail);
+		_cq_mask = reinterpret_cast<unsigned int *>(ring + params.cq_off.ring_mask);
+		_cqes = reinterpret_cast<io_uring_cqe *>(ring + params.cq_off.cqes);
+
+		return true;
+	}
+
+	bool IoUringReceiver::RegisterBuffers()
+	{
+		// The ring must be page aligned
+		_buffer_ring_size = OV_IO_URING_BUFFER_COUNT * sizeof(io_uring_buf);
+		void *buffer_ring = ::mmap(nullptr, _buffer_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if(buffer_ring == MAP_FAILED)
+		{
+			logte("Could not allocate the buffer ring of io_uring: %s", ::strerror(errno));
+			return false;
+		}
+
+		_buffer_ring = static_cast<io_uring_buf_ring *>(buffer_ring);
+
+		io_uring_buf_reg reg {};
+
+		reg.ring_addr = reinterpret_cast<uint64_t>(_buffer_ring);
+		reg.ring_entries = OV_IO_URING_BUFFER_COUNT;
+		reg.bgid = OV_IO_URING_BUFFER_GROUP_ID;
+
+		if(::syscall(__NR_io_uring_register, _ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+		{
+			logtw("Provided buffer ring of io_uring is not supported: %s", ::strerror(errno));
+
+			::munmap(_buffer_ring, _buffer_ring_size);
+			_buffer_ring = nullptr;
+
+			return false;
+		}
+
+		// io_uring_recvmsg_out | name | payload
+		_msghdr.msg_namelen = sizeof(sockaddr_storage);
+		_msghdr.msg_controllen = 0;
+
+		_buffer_size = sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_storage) + UdpBufferSize;
+		_buffers.resize(_buffer_size * OV_IO_URING_BUFFER_COUNT);
+
+		_buffer_ring_tail = 0;
+
+		for(uint16_t buffer_id = 0; buffer_id < OV_IO_URING_BUFFER_COUNT; buffer_id++)
+		{
+			AddBuffer(buffer_id);
+		}
+
+		PublishBuffers();
+
+		return true;
+	}
+
+	void IoUringReceiver::Release()
+	{
+		if(_buffer_ring != nullptr)
+		{
+			::munmap(_buffer_ring, _buffer_ring_size);
+			_buffer_ring = nullptr;
+		}
+
+		if(_sqes != nullptr)
+		{
+			::munmap(_sqes, _sqes_size);
+			_sqes = nullptr;
+		}
+
+		if(_ring != nullptr)
+		{
+			::munmap(_ring, _ring_size);
+			_ring = nullptr;
+		}
+
+		if(_ring_fd >= 0)
+		{
+			// The pending requests are cancelled
+			::close(_ring_fd);
+			_ring_fd = -1;
+		}
+
+		_buffers.clear();
+		_buffers.shrink_to_fit();
+
+		_recv_armed = false;
+		_pending_submit_count = 0;
+	}
+
+	void IoUringReceiver::SubmitRecvMsg()
+	{
+		unsigned int tail = *_sq_tail;
+		unsigned int index = tail & *_sq_mask;
+		io_uring_sqe *sqe = &(_sqes[index]);
+
+		::memset(sqe, 0, sizeof(*sqe));
+
+		sqe->opcode = IORING_OP_RECVMSG;
+		sqe->fd = _socket;
+		sqe->addr = reinterpret_cast<uint64_t>(&_msghdr);
+		sqe->len = 1;
+		sqe->flags = IOSQE_BUFFER_SELECT;
+		sqe->buf_group = OV_IO_URING_BUFFER_GROUP_ID;
+		sqe->ioprio = IORING_RECV_MULTISHOT;
+		sqe->user_data = OV_IO_URING_RECV_USER_DATA;
+
+		_sq_array[index] = index;
+		__atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+		_recv_armed = true;
+		_pending_submit_count++;
+	}
+
+	int IoUringReceiver::Enter(unsigned int to_submit, unsigned int min_complete, int timeout)
+	{
+		unsigned int flags = (min_complete > 0) ? IORING_ENTER_GETEVENTS : 0;
+
+		if((min_complete > 0) && (timeout != Infinite))
+		{
+			__kernel_timespec timespec {};
+
+			timespec.tv_sec = timeout / 1000;
+			timespec.tv_nsec = (timeout % 1000) * 1000000LL;
+
+			io_uring_getevents_arg arg {};
+
+			arg.ts = reinterpret_cast<uint64_t>(&timespec);
+
+			int result = static_cast<int>(::syscall(__NR_io_uring_enter, _ring_fd, to_submit, min_complete, flags | IORING_ENTER_EXT_ARG, &arg, sizeof(arg)));
+
+			if(result >= 0)
+			{
+				_pending_submit_count -= std::min(static_cast<unsigned int>(result), _pending_submit_count);
+			}
+
+			return result;
+		}
+
+		int result = static_cast<int>(::syscall(__NR_io_uring_enter, _ring_fd, to_submit, min_complete, flags, nullptr, 0));
+
+		if(result >= 0)
+		{
+			_pending_submit_count -= std::min(static_cast<unsigned int>(result), _pending_submit_count);
+		}
+
+		return result;
+	}
+
+	void IoUringReceiver::AddBuffer(uint16_t buffer_id)
+	{
+		// The tail of the ring is overlaid with bufs[0].resv, so the fields are set one by one
+		// (bufs[] is not used, its offset is not 0 in C++ because of the empty struct of __DECLARE_FLEX_ARRAY)
+		io_uring_buf *buffer = reinterpret_cast<io_uring_buf *>(_buffer_ring) + (_buffer_ring_tail & (OV_IO_URING_BUFFER_COUNT - 1));
+
+		buffer->addr = reinterpret_cast<uint64_t>(_buffers.data() + (buffer_id * _buffer_size));
+		buffer->len = static_cast<uint32_t>(_buffer_size);
+		buffer->bid = buffer_id;
+
+		_buffer_ring_tail++;
+	}
+
+	void IoUringReceiver::PublishBuffers()
+	{
+		__atomic_store_n(&(_buffer_ring->tail), _buffer_ring_tail, __ATOMIC_RELEASE);
+	}
+
+	bool IoUringReceiver::Dispatch(const ReceiveCallback &callback, int timeout)
+	{
+		if(_ring_fd < 0)
+		{
+			return false;
+		}
+
+		if(_recv_armed == false)
+		{
+			SubmitRecvMsg();
+		}
+
+		unsigned int head = *_cq_head;
+
+		if(head == __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE))
+		{
+			// Submits the pending request and waits for the completions with one syscall
+			if(Enter(_pending_submit_count, 1, timeout) < 0)
+			{
+				if((errno == ETIME) || (errno == EINTR) || (errno == EAGAIN) || (errno == EBUSY))
+				{
+					return true;
+				}
+
+				logte("[#%d] Could not wait for the completions of io_uring: %s", _socket, ::strerror(errno));
+				return false;
+			}
+		}
+		else if(_pending_submit_count > 0)
+		{
+			Enter(_pending_submit_count, 0, 0);
+		}
+
+		bool result = true;
+		unsigned int tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+
+		head = *_cq_head;
+
+		while(head != tail)
+		{
+			if(ProcessCompletion(&(_cqes[head & *_cq_mask]), callback) == false)
+			{
+				result = false;
+			}
+
+			head++;
+		}
+
+		__atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+
+		return result;
+	}
+
+	bool IoUringReceiver::ProcessCompletion(const io_uring_cqe *cqe, const ReceiveCallback &callback)
+	{
+		if(cqe->user_data != OV_IO_URING_RECV_USER_DATA)
+		{
+			return true;
+		}
+
+		if(OV_CHECK_FLAG(cqe->flags, IORING_CQE_F_MORE) == false)
+		{
+			// The kernel stopped the multishot request, it is submitted again by the next Dispatch()
+			_recv_armed = false;
+		}
+
+		if(cqe->res < 0)
+		{
+			if(cqe->res == -ENOBUFS)
+			{
+				_no_buffer_count++;
+
+				if((_no_buffer_count % OV_IO_URING_NO_BUFFER_LOG_INTERVAL) == 1)
+				{
+					logtw("[#%d] All the buffers of io_uring are in use (%d buffers), it has happened %llu times",
+					      _socket, OV_IO_URING_BUFFER_COUNT, static_cast<unsigned long long>(_no_buffer_count));
+				}
+
+				return true;
+			}
+
+			logte("[#%d] Could not receive the datagram: %s", _socket, ::strerror(-cqe->res));
+
+			return (cqe->res == -EINTR) || (cqe->res == -EAGAIN);
+		}
+
+		if(OV_CHECK_FLAG(cqe->flags, IORING_CQE_F_BUFFER) == false)
+		{
+			OV_ASSERT2(false);
+			return true;
+		}
+
+		auto buffer_id = static_cast<uint16_t>(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+
+		uint8_t *buffer = _buffers.data() + (buffer_id * _buffer_size);
+		auto out = reinterpret_cast<const io_uring_recvmsg_out *>(buffer);
+
+		const uint8_t *name = buffer + sizeof(io_uring_recvmsg_out);
+		const uint8_t *payload = name + _msghdr.msg_namelen + _msghdr.msg_controllen;
+		size_t payload_length = std::min<size_t>(out->payloadlen, (buffer + _buffer_size) - payload);
+
+		if(OV_CHECK_FLAG(out->flags, MSG_TRUNC))
+		{
+			logtw("[#%d] The datagram is truncated (%u > %zu)", _socket, out->payloadlen, payload_length);
+		}
+
+		sockaddr_storage address {};
+		::memcpy(&address, name, std::min<size_t>(out->namelen, sizeof(address)));
+
+		if(payload_length > 0)
+		{
+			// The payload is copied, so the buffer can be returned to the kernel (the observers may keep the data)
+			callback(SocketAddress(address), std::make_shared<Data>(payload, payload_length));
+		}
+
+		// Returned as soon as it is used, so the kernel doesn't run out of the buffers during a large batch
+		AddBuffer(buffer_id);
+		PublishBuffers();
+
+		return true;
+	}
+#else	// OV_IO_URING_SUPPORTED
+	bool IoUringReceiver::Prepare(int socket)
+	{
+		logtw("[#%d] io_uring is not supported by this build", socket);
+		return false;
+	}
+
+	void IoUringReceiver::Release()
+	{
+	}
+
+	bool IoUringReceiver::Dispatch(const ReceiveCallback &callback, int timeout)
+	{
+		return false;
+	}
+#endif	// OV_IO_URING_SUPPORTED
+}
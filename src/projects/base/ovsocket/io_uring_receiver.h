@@ -0,0 +1,106 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "socket_address.h"
+#include "socket_datastructure.h"
+
+#include <sys/socket.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Entries of the submission queue (only one multishot request is submitted at a time)
+#define OV_IO_URING_QUEUE_DEPTH                 8
+// Number of the provided buffers (must be a power of 2)
+#define OV_IO_URING_BUFFER_COUNT                1024
+#define OV_IO_URING_BUFFER_GROUP_ID             0
+// The warning is logged once per this number of completions without a buffer
+#define OV_IO_URING_NO_BUFFER_LOG_INTERVAL      100
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+namespace ov
+{
+	// Receives the datagrams of a UDP socket with io_uring (instead of epoll_wait() + recvfrom() per datagram)
+	//
+	// - One multishot IORING_OP_RECVMSG keeps receiving into the provided buffer ring, so the datagrams are
+	//   received without the syscalls while the completions are pending
+	// - Requires Linux 6.0 (multishot recvmsg) and the kernel headers, Prepare() returns false if it is not supported
+	//   (the caller falls back to epoll)
+	// - Not thread-safe, Dispatch() must be called by one thread
+	class IoUringReceiver
+	{
+	public:
+		typedef std::function<void(const SocketAddress &remote_address, const std::shared_ptr<Data> &data)> ReceiveCallback;
+
+		IoUringReceiver() = default;
+		~IoUringReceiver();
+
+		bool Prepare(int socket);
+		void Release();
+
+		// Waits for the datagrams at most timeout (ms), and calls the callback for each datagram
+		// Returns false if an error occurred (e.g. the socket is closed)
+		bool Dispatch(const ReceiveCallback &callback, int timeout);
+
+	protected:
+		bool SetupRing();
+		bool RegisterBuffers();
+
+		void SubmitRecvMsg();
+		int Enter(unsigned int to_submit, unsigned int min_complete, int timeout);
+
+		// The buffers are visible to the kernel after PublishBuffers()
+		void AddBuffer(uint16_t buffer_id);
+		void PublishBuffers();
+
+		// Returns false if the request can't be continued
+		bool ProcessCompletion(const io_uring_cqe *cqe, const ReceiveCallback &callback);
+
+		int _socket = -1;
+		int _ring_fd = -1;
+
+		void *_ring = nullptr;
+		size_t _ring_size = 0;
+		io_uring_sqe *_sqes = nullptr;
+		size_t _sqes_size = 0;
+
+		// Submission queue
+		unsigned int *_sq_head = nullptr;
+		unsigned int *_sq_tail = nullptr;
+		unsigned int *_sq_mask = nullptr;
+		unsigned int *_sq_array = nullptr;
+
+		// Completion queue
+		unsigned int *_cq_head = nullptr;
+		unsigned int *_cq_tail = nullptr;
+		unsigned int *_cq_mask = nullptr;
+		io_uring_cqe *_cqes = nullptr;
+
+		// Provided buffers (header of the recvmsg + address + payload)
+		io_uring_buf_ring *_buffer_ring = nullptr;
+		size_t _buffer_ring_size = 0;
+		uint16_t _buffer_ring_tail = 0;
+		size_t _buffer_size = 0;
+		std::vector<uint8_t> _buffers;
+
+		// The kernel takes the lengths of the name/control from it for each datagram
+		msghdr _msghdr {};
+
+		// The multishot request is active (it is submitted again when the kernel stops it, e.g. no buffers)
+		bool _recv_armed = false;
+		unsigned int _pending_submit_count = 0;
+
+		// Completions which have failed because all the buffers were in use (-ENOBUFS)
+		uint64_t _no_buffer_count = 0;
+	};
+}
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "socket_address.h"
+#include "dns_resolver.h"
 
 #include "socket.h"
 
@@ -20,16 +20,18 @@ namespace ov
                                 uint16_t port,
                                 int send_buffer_size,
                                 int recv_buffer_size,
-                                int backlog)
+                                int backlog,
+                                bool reuse_port)
 	{
-		return Prepare(type, SocketAddress(port), send_buffer_size, recv_buffer_size, backlog);
+		return Prepare(type, SocketAddress(port), send_buffer_size, recv_buffer_size, backlog, reuse_port);
 	}
 
 	bool ServerSocket::Prepare(SocketType type,
                                const SocketAddress &address,
                                int send_buffer_size,
                                int recv_buffer_size,
-                               int backlog)
+                               int backlog,
+                               bool reuse_port)
 	{
 		CHECK_STATE(== SocketState::Closed, false);
 
@@ -39,7 +41,7 @@ namespace ov
 				MakeNonBlocking() &&
 				PrepareEpoll() &&
 				AddToEpoll(this, static_cast<void *>(this)) &&
-				SetSocketOptions(type, send_buffer_size, recv_buffer_size) &&
+				SetSocketOptions(type, send_buffer_size, recv_buffer_size, reuse_port) &&
 				Bind(address) &&
 				Listen(backlog)
 			) == false)
@@ -60,6 +62,8 @@ namespace ov
 		OV_ASSERT2(data_callback != nullptr);
 
 		int count = EpollWait(timeout);
+		// The new connections are accepted after the events of the established connections (the media traffic goes first)
+		bool is_listener_ready = false;
 
 		for(int index = 0; index < count; index++)
 		{
@@ -77,6 +81,30 @@ namespace ov
 
 			bool need_to_delete = false;
 
+			if((client_socket != nullptr) && client_socket->IsDraining())
+			{
+				// The client is disconnected already, only the rest of the send queue is sent
+				bool result = OV_CHECK_FLAG(event->events, EPOLLOUT) && client_socket->FlushSendQueue();
+
+				if((result == false) || (client_socket->GetSendQueueBytes() == 0) || OV_CHECK_FLAG(event->events, EPOLLERR) || OV_CHECK_FLAG(event->events, EPOLLHUP))
+				{
+					CloseDrainingClient(client_socket);
+				}
+
+				continue;
+			}
+
+			if((client_socket != nullptr) && OV_CHECK_FLAG(event->events, EPOLLOUT))
+			{
+				// The send buffer is available, the queued data of SendAsync() is sent
+				client_socket->FlushSendQueue();
+
+				if((event->events & (EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLRDHUP)) == 0)
+				{
+					continue;
+				}
+			}
+
 			if(
 				OV_CHECK_FLAG(event->events, EPOLLERR) ||
 				(!OV_CHECK_FLAG(event->events, EPOLLIN))
@@ -111,81 +139,53 @@ namespace ov
 			}
 			else if(epoll_data == static_cast<void *>(this))
 			{
-				// listen된 socket에서 이벤트 발생
-
-				// listen된 socket에 새로운 클라이언트가 접속함
-				int accept_count = 0;
-				std::shared_ptr<ClientSocket> client = nullptr;
-
-				do
-				{
-					client = Accept();
-
-					if(client != nullptr)
-					{
-						logtd("[%p] [#%d] Client #%d is connected - events(%s)", this, _socket.GetSocket(), client->GetSocket().GetSocket(), StringFromEpollEvent(event).CStr());
-
-						// 정상적으로 accept 되었다면 callback
-						need_to_delete = connection_callback(client, SocketConnectionState::Connected);
-
-						// callback의 반환 값이 true면(need_to_delete = true), 아래에서 client 없앰
-
-						accept_count++;
-					}
-				} while(client != nullptr);
-
-				if(accept_count <= 0 && client_socket != nullptr)
-				{
-					// accept 실패. 아래에서 client 없앰 (정상적인 상황이라면, map 자체에 등록되어 있지 않음)
-					need_to_delete = true;
-				}
+				// listen된 socket에 새로운 클라이언트가 접속함 (아래에서 accept)
+				is_listener_ready = true;
 			}
 			else
 			{
 				// client socket에서 데이터를 읽을 준비가 됨
-
-				auto data = std::make_shared<Data>(TcpBufferSize);
-
-				while(client_socket->GetState() == SocketState::Connected)
+				if(client_socket->IsEdgeTriggered())
+				{
+					need_to_delete = DispatchEdgeTriggeredData(client_socket, connection_callback, data_callback);
+				}
+				else
 				{
-					data->SetLength(0);
+					need_to_delete = DispatchData(client_socket, connection_callback, data_callback);
+				}
+			}
 
-					auto error = client_socket->Recv(data);
+			if(need_to_delete)
+			{
+				DisconnectClient(client_socket);
+			}
+		}
 
-					if(data->GetLength() > 0L)
-					{
-						need_to_delete = data_callback(client_socket->GetSharedPtrAs<ClientSocket>(), data);
-						// socket이 error 상태가 되었다면 삭제
-						need_to_delete = need_to_delete || (client_socket->GetState() == SocketState::Error);
-					}
+		if(is_listener_ready)
+		{
+			AcceptClients(connection_callback);
+		}
 
-					if(client_socket->GetState() == SocketState::Error)
-					{
-						logtd("[%p] [#%d] An error occurred on client %s", this, _socket.GetSocket(), client_socket->ToString().CStr());
-						connection_callback(client_socket->GetSharedPtrAs<ClientSocket>(), SocketConnectionState::Error);
-						need_to_delete = true;
-						break;
-					}
+		// The clients which don't receive the rest of the data
+		{
+			std::vector<ClientSocket *> timed_out_list;
 
-					if(error != nullptr)
-					{
-						logtd("[%p] [#%d] Client %s is disconnected", this, _socket.GetSocket(), client_socket->ToString().CStr());
-						connection_callback(client_socket->GetSharedPtrAs<ClientSocket>(), SocketConnectionState::Disconnected);
-						need_to_delete = true;
-						break;
-					}
+			{
+				std::lock_guard<std::mutex> lock(_client_list_mutex);
 
-					if(data->GetLength() == 0L)
+				for(auto &item : _draining_client_list)
+				{
+					if(item.first->IsDrainTimedOut())
 					{
-						// 다음 데이터를 기다려야 함
-						break;
+						timed_out_list.push_back(item.first);
 					}
 				}
 			}
 
-			if(need_to_delete)
+			for(auto client_socket : timed_out_list)
 			{
-				DisconnectClient(client_socket);
+				logtd("[%p] [#%d] Could not send the rest of the data to %s (%zu bytes)", this, _socket.GetSocket(), client_socket->ToString().CStr(), client_socket->GetSendQueueBytes());
+				CloseDrainingClient(client_socket);
 			}
 		}
 
@@ -198,22 +198,173 @@ namespace ov
 		return true;
 	}
 
+	bool ServerSocket::DispatchData(ClientSocket *client_socket, ClientConnectionCallback connection_callback, ClientDataCallback data_callback)
+	{
+		bool need_to_delete = false;
+		auto data = std::make_shared<Data>(TcpBufferSize);
+
+		while(client_socket->GetState() == SocketState::Connected)
+		{
+			data->SetLength(0);
+
+			auto error = client_socket->Recv(data);
+
+			if(data->GetLength() > 0L)
+			{
+				need_to_delete = data_callback(client_socket->GetSharedPtrAs<ClientSocket>(), data);
+				// socket이 error 상태가 되었다면 삭제
+				need_to_delete = need_to_delete || (client_socket->GetState() == SocketState::Error);
+			}
+
+			if(client_socket->GetState() == SocketState::Error)
+			{
+				logtd("[%p] [#%d] An error occurred on client %s", this, _socket.GetSocket(), client_socket->ToString().CStr());
+				connection_callback(client_socket->GetSharedPtrAs<ClientSocket>(), SocketConnectionState::Error);
+				need_to_delete = true;
+				break;
+			}
+
+			if(error != nullptr)
+			{
+				logtd("[%p] [#%d] Client %s is disconnected", this, _socket.GetSocket(), client_socket->ToString().CStr());
+				connection_callback(client_socket->GetSharedPtrAs<ClientSocket>(), SocketConnectionState::Disconnected);
+				need_to_delete = true;
+				break;
+			}
+
+			if(data->GetLength() == 0L)
+			{
+				// 다음 데이터를 기다려야 함
+				break;
+			}
+		}
+
+		return need_to_delete;
+	}
+
+	bool ServerSocket::DispatchEdgeTriggeredData(ClientSocket *client_socket, ClientConnectionCallback connection_callback, ClientDataCallback data_callback)
+	{
+		// The socket is read until EAGAIN (no more notification is given for the data which is read already)
+		while(client_socket->GetState() == SocketState::Connected)
+		{
+			auto data = std::make_shared<Data>(RecvAllChunkSize);
+			bool would_block = false;
+
+			auto error = client_socket->RecvAll(data, RecvAllMaxBytes, &would_block);
+
+			if(data->GetLength() > 0L)
+			{
+				// The data is passed in one call (the consumer may keep the buffer, so a new buffer is allocated for the next)
+				if(data_callback(client_socket->GetSharedPtrAs<ClientSocket>(), data) || (client_socket->GetState() == SocketState::Error))
+				{
+					return true;
+				}
+			}
+
+			if(client_socket->GetState() == SocketState::Error)
+			{
+				logtd("[%p] [#%d] An error occurred on client %s", this, _socket.GetSocket(), client_socket->ToString().CStr());
+				connection_callback(client_socket->GetSharedPtrAs<ClientSocket>(), SocketConnectionState::Error);
+				return true;
+			}
+
+			if(error != nullptr)
+			{
+				logtd("[%p] [#%d] Client %s is disconnected", this, _socket.GetSocket(), client_socket->ToString().CStr());
+				connection_callback(client_socket->GetSharedPtrAs<ClientSocket>(), SocketConnectionState::Disconnected);
+				return true;
+			}
+
+			if(would_block)
+			{
+				// Drained, the next notification is given when new data arrives
+				break;
+			}
+		}
+
+		return false;
+	}
+
+	void ServerSocket::AcceptClients(ClientConnectionCallback connection_callback)
+	{
+		for(int accept_count = 0; accept_count < AcceptBatchSize; accept_count++)
+		{
+			SocketWrapper client_socket;
+			auto client = AcceptInternal(&client_socket);
+
+			if(client == nullptr)
+			{
+				if(client_socket.IsValid())
+				{
+					// Refused by the limits, the next connection is accepted
+					continue;
+				}
+
+				// No more connections
+				break;
+			}
+
+			logtd("[%p] [#%d] Client #%d is connected", this, _socket.GetSocket(), client->GetSocket().GetSocket());
+
+			// 정상적으로 accept 되었다면 callback, 반환 값이 true면 client 없앰
+			if(connection_callback(client, SocketConnectionState::Connected))
+			{
+				DisconnectClient(client.get());
+			}
+		}
+	}
+
 	std::shared_ptr<ClientSocket> ServerSocket::Accept()
+	{
+		SocketWrapper client_socket;
+
+		return AcceptInternal(&client_socket);
+	}
+
+	std::shared_ptr<ClientSocket> ServerSocket::AcceptInternal(SocketWrapper *client_socket)
 	{
 		CHECK_STATE(== SocketState::Listening, nullptr);
 
-		std::shared_ptr<ClientSocket> client = Socket::AcceptClient<ClientSocket>();
+		SocketAddress address;
+		*client_socket = AcceptClientInternal(&address);
+
+		if(client_socket->IsValid() == false)
+		{
+			return nullptr;
+		}
+
+		ConnectionLimit limit;
+
+		{
+			std::lock_guard<std::mutex> lock(_connection_limit_mutex);
+			limit = _connection_limit;
+		}
+
+		bool handshake_tracking = _handshake_tracking;
+
+		if(IsAcceptable(address, limit, handshake_tracking) == false)
+		{
+			RefuseClient(*client_socket);
+			return nullptr;
+		}
+
+		auto client = std::make_shared<ClientSocket>(*client_socket, address);
 
 		if(client != nullptr)
 		{
 			logtd("[%p] [#%d] New client is connected: %s", this, _socket.GetSocket(), client->ToString().CStr());
 
+			if(handshake_tracking)
+			{
+				client->StartHandshake(_pending_handshakes);
+			}
+
 			_client_list_mutex.lock();
 			_client_list[client.get()] = client;
 			logtd("ADD: Client count: %zu", _client_list.size());
 			_client_list_mutex.unlock();
 
-			AddToEpoll(client.get(), static_cast<void *>(client.get()));
+			AddToEpoll(client.get(), static_cast<void *>(client.get()), _edge_triggered);
 
 			return client;
 		}
@@ -225,6 +376,7 @@ namespace ov
 	{
 		_client_list_mutex.lock();
 		auto client_list = std::move(_client_list);
+		auto draining_client_list = std::move(_draining_client_list);
 		_client_list_mutex.unlock();
 
 		for(const auto &client : client_list)
@@ -232,6 +384,11 @@ namespace ov
 			client.second->Close();
 		}
 
+		for(const auto &client : draining_client_list)
+		{
+			client.second->Close();
+		}
+
 		return Socket::Close();
 	}
 
@@ -257,9 +414,25 @@ namespace ov
 
 			if(item != _client_list.end())
 			{
-				_disconnected_client_list[item->first] = item->second;
+				auto client = item->second;
+
 				_client_list.erase(item);
 
+				// A disconnected client isn't counted as a pending handshake (even if it is draining)
+				client_socket->CompleteHandshake();
+
+				if(client_socket->StartDraining())
+				{
+					// The socket is closed when the send queue is flushed (by DispatchEvent())
+					_draining_client_list[client_socket] = client;
+
+					logtd("DEL: Client count: %zu (draining)", _client_list.size());
+
+					return true;
+				}
+
+				_disconnected_client_list[client_socket] = client;
+
 				remove = true;
 			}
 			else
@@ -280,10 +453,161 @@ namespace ov
 
 		logtd("DEL: Client count: %zu", _client_list.size());
 
+		return remove;
+	}
+
+	void ServerSocket::SetConnectionLimit(const ConnectionLimit &limit)
+	{
+		std::lock_guard<std::mutex> lock(_connection_limit_mutex);
+
+		_connection_limit = limit;
+	}
+
+	void ServerSocket::SetHandshakeTracking(bool enable)
+	{
+		_handshake_tracking = enable;
+	}
+
+	void ServerSocket::SetEdgeTriggered(bool enable)
+	{
+		_edge_triggered = enable;
+	}
+
+	bool ServerSocket::IsAcceptable(const SocketAddress &address, const ConnectionLimit &limit, bool handshake_tracking)
+	{
+		if(handshake_tracking && (limit.max_pending_handshakes > 0) && (*_pending_handshakes >= limit.max_pending_handshakes))
+		{
+			if((_refused_count++ % 1000) == 0)
+			{
+				logtw("[%p] [#%d] Too many pending handshakes (%d), the connection from %s is refused (refused: %" PRId64 ")",
+					  this, _socket.GetSocket(), limit.max_pending_handshakes, address.ToString().CStr(), _refused_count);
+			}
+
+			return false;
+		}
+
+		if(limit.rate_per_ip <= 0)
+		{
+			return true;
+		}
+
+		int burst = (limit.burst_per_ip > 0) ? limit.burst_per_ip : limit.rate_per_ip;
+		auto now = std::chrono::steady_clock::now();
+
+		if(std::chrono::duration_cast<std::chrono::milliseconds>(now - _last_bucket_cleanup_time).count() >= ConnectionBucketCleanupInterval)
+		{
+			CleanupConnectionBuckets(limit.rate_per_ip, burst);
+			_last_bucket_cleanup_time = now;
+		}
+
+		// The connections from the same IP address share a bucket
+		auto key = address.GetKey();
+		key.port = 0;
+
+		auto item = _connection_buckets.find(key);
+
+		if(item == _connection_buckets.end())
+		{
+			ConnectionBucket bucket;
+
+			bucket.tokens = burst - 1.0;
+			bucket.last_time = now;
+
+			_connection_buckets.emplace(key, bucket);
+
+			return true;
+		}
+
+		auto &bucket = item->second;
+		double elapsed = std::chrono::duration<double>(now - bucket.last_time).count();
+
+		bucket.tokens = std::min(static_cast<double>(burst), bucket.tokens + (elapsed * limit.rate_per_ip));
+		bucket.last_time = now;
+
+		if(bucket.tokens < 1.0)
+		{
+			if((_refused_count++ % 1000) == 0)
+			{
+				logtw("[%p] [#%d] Too many connections from %s (%d/s), the connection is refused (refused: %" PRId64 ")",
+					  this, _socket.GetSocket(), address.GetIpAddress().CStr(), limit.rate_per_ip, _refused_count);
+			}
+
+			return false;
+		}
+
+		bucket.tokens -= 1.0;
+
 		return true;
 	}
 
-	bool ServerSocket::SetSocketOptions(SocketType type, int send_buffer_size, int recv_buffer_size)
+	void ServerSocket::RefuseClient(SocketWrapper client_socket)
+	{
+		switch(client_socket.GetType())
+		{
+			case SocketType::Tcp:
+			{
+				linger option { 1, 0 };
+
+				::setsockopt(client_socket.GetSocket(), SOL_SOCKET, SO_LINGER, &option, sizeof(option));
+				::close(client_socket.GetSocket());
+				break;
+			}
+
+			case SocketType::Srt:
+				::srt_close(client_socket.GetSocket());
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	void ServerSocket::CleanupConnectionBuckets(int rate, int burst)
+	{
+		auto now = std::chrono::steady_clock::now();
+
+		for(auto item = _connection_buckets.begin(); item != _connection_buckets.end();)
+		{
+			auto &bucket = item->second;
+			double elapsed = std::chrono::duration<double>(now - bucket.last_time).count();
+
+			if((bucket.tokens + (elapsed * rate)) >= burst)
+			{
+				item = _connection_buckets.erase(item);
+			}
+			else
+			{
+				++item;
+			}
+		}
+	}
+
+	void ServerSocket::CloseDrainingClient(ClientSocket *client_socket)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_client_list_mutex);
+
+			auto item = _draining_client_list.find(client_socket);
+
+			if(item == _draining_client_list.end())
+			{
+				return;
+			}
+
+			// Keep the instance while DispatchEvent() is running
+			_disconnected_client_list[item->first] = item->second;
+			_draining_client_list.erase(item);
+		}
+
+		RemoveFromEpoll(client_socket);
+
+		if(client_socket->GetState() != SocketState::Closed)
+		{
+			client_socket->Close();
+		}
+	}
+
+	bool ServerSocket::SetSocketOptions(SocketType type, int send_buffer_size, int recv_buffer_size, bool reuse_port)
 	{
 		// SRT socket is already non-block mode
 		bool result = true;
@@ -292,6 +616,12 @@ namespace ov
 		{
 			result &= SetSockOpt<int>(SO_REUSEADDR, 1);
 
+			if(reuse_port)
+			{
+				// Several listeners are bound to the same address, and the kernel distributes the connections
+				result &= SetSockOpt<int>(SO_REUSEPORT, 1);
+			}
+
             int current_send_buffer_size;
             int current_recv_buffer_size;
             socklen_t data_size = sizeof(int);
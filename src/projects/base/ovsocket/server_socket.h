@@ -11,9 +11,26 @@
 #include "socket.h"
 #include "socket_address.h"
 #include "socket_datastructure.h"
+#include "socket_address_key.h"
+
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
 
 namespace ov
 {
+	// Limits of the new connections of a listener (0: unlimited)
+	struct ConnectionLimit
+	{
+		// New connections per second from an IP address (token bucket), and the bucket size (0: same as the rate)
+		int rate_per_ip = 0;
+		int burst_per_ip = 0;
+
+		// Connections which are accepted but not set up yet (see ClientSocket::CompleteHandshake()),
+		// used only if the handshake tracking is enabled
+		int max_pending_handshakes = 0;
+	};
+
 	// TCP 서버 (UDP는 DatagramSocket 사용)
 	class ServerSocket : public Socket
 	{
@@ -26,17 +43,21 @@ namespace ov
                      uint16_t port,
                      int send_buffer_size,
                      int recv_buffer_size,
-                     int backlog = SOMAXCONN);
+                     int backlog = SOMAXCONN,
+                     bool reuse_port = false);
 
 		// address에 해당하는 주소로 bind
+		// reuse_port가 true면 SO_REUSEPORT를 설정하여 같은 address에 여러 ServerSocket을 bind할 수 있음 (TCP only)
 		bool Prepare(SocketType type,
                     const SocketAddress &address,
                     int send_buffer_size,
                     int recv_buffer_size,
-                    int backlog = SOMAXCONN);
+                    int backlog = SOMAXCONN,
+                    bool reuse_port = false);
 
 		bool DispatchEvent(ClientConnectionCallback connection_callback, ClientDataCallback data_callback, int timeout = Infinite);
 
+		// Returns nullptr if there is no connection to accept, or the connection is refused by the limits
 		std::shared_ptr<ClientSocket> Accept();
 		bool Close() override;
 
@@ -45,14 +66,67 @@ namespace ov
 
 		String ToString() const override;
 
+		// Returns false if the client is not accepted by this socket
 		bool DisconnectClient(ClientSocket *client_socket);
 
+		void SetConnectionLimit(const ConnectionLimit &limit);
+		// The accepted clients are handshaking until the owner calls ClientSocket::CompleteHandshake()
+		void SetHandshakeTracking(bool enable);
+
+		// The clients accepted after this call are edge-triggered (TCP only): each notification drains the socket,
+		// and the data is passed to the data callback in one call (up to RecvAllMaxBytes)
+		void SetEdgeTriggered(bool enable);
+
+		int GetPendingHandshakeCount() const
+		{
+			return *_pending_handshakes;
+		}
+
 	protected:
-		bool SetSocketOptions(SocketType type, int send_buffer_size, int recv_buffer_size);
+		struct ConnectionBucket
+		{
+			double tokens = 0.0;
+			std::chrono::steady_clock::time_point last_time;
+		};
+
+		// Returns true if the client needs to be disconnected
+		bool DispatchData(ClientSocket *client_socket, ClientConnectionCallback connection_callback, ClientDataCallback data_callback);
+		bool DispatchEdgeTriggeredData(ClientSocket *client_socket, ClientConnectionCallback connection_callback, ClientDataCallback data_callback);
+
+		// Accepts up to AcceptBatchSize connections (the listener is level-triggered, so the rest is accepted later)
+		void AcceptClients(ClientConnectionCallback connection_callback);
+		// client_socket: valid if a connection is accepted (even if it is refused)
+		std::shared_ptr<ClientSocket> AcceptInternal(SocketWrapper *client_socket);
+
+		// Returns false if the connection from the address exceeds the limits
+		bool IsAcceptable(const SocketAddress &address, const ConnectionLimit &limit, bool handshake_tracking);
+		// Closes the connection with RST (so the TIME_WAIT isn't left in the server)
+		void RefuseClient(SocketWrapper client_socket);
+		// Removes the buckets which are full (the addresses are not connected recently)
+		void CleanupConnectionBuckets(int rate, int burst);
+
+		bool SetSocketOptions(SocketType type, int send_buffer_size, int recv_buffer_size, bool reuse_port);
+
+		// Closes the client which is flushed (or failed to flush) after it is disconnected
+		void CloseDrainingClient(ClientSocket *client_socket);
 
 		std::mutex _client_list_mutex;
 		std::map<ClientSocket *, std::shared_ptr<ClientSocket>> _client_list;
 		// To keep ClientSocket pointer while DispatchEvent() is running
 		std::map<ClientSocket *, std::shared_ptr<ClientSocket>> _disconnected_client_list;
+		// The disconnected clients which are sending the rest of the send queue
+		std::map<ClientSocket *, std::shared_ptr<ClientSocket>> _draining_client_list;
+
+		mutable std::mutex _connection_limit_mutex;
+		ConnectionLimit _connection_limit;
+		std::atomic<bool> _handshake_tracking { false };
+		std::atomic<bool> _edge_triggered { false };
+		// Shared with the handshaking clients (a client may be closed after the ServerSocket)
+		std::shared_ptr<std::atomic<int>> _pending_handshakes = std::make_shared<std::atomic<int>>(0);
+
+		// Accessed only by the thread of DispatchEvent(), the port of the key is 0
+		std::unordered_map<SocketAddressKey, ConnectionBucket> _connection_buckets;
+		std::chrono::steady_clock::time_point _last_bucket_cleanup_time = std::chrono::steady_clock::now();
+		int64_t _refused_count = 0;
 	};
 }
@@ -11,7 +11,11 @@
 
 #include <unistd.h>
 #include <arpa/inet.h>
+#include <netinet/udp.h>
 #include <sys/fcntl.h>
+#include <poll.h>
+#include <linux/net_tstamp.h>
+#include <time.h>
 #include <algorithm>
 
 #include <base/ovlibrary/ovlibrary.h>
@@ -22,6 +26,17 @@
 
 #define USE_STATS_COUNTER                       0
 
+#ifndef UDP_SEGMENT
+// Defined in linux/udp.h since 4.18 (and in netinet/udp.h since glibc 2.28)
+#	define UDP_SEGMENT                          103
+#endif // UDP_SEGMENT
+
+#ifndef SO_TXTIME
+// Defined in asm-generic/socket.h since 4.19
+#	define SO_TXTIME                            61
+#	define SCM_TXTIME                           SO_TXTIME
+#endif // SO_TXTIME
+
 namespace ov
 {
 #if USE_STATS_COUNTER
@@ -174,6 +189,8 @@ namespace ov
 
 		  _is_nonblock(socket._is_nonblock),
 
+		  _udp_segmentation(socket._udp_segmentation.load()),
+
 		  _epoll(socket._epoll),
 		  _epoll_events(socket._epoll_events),
 		  _last_epoll_event_count(socket._last_epoll_event_count)
@@ -405,10 +422,12 @@ namespace ov
 		{
 			case SocketType::Tcp:
 			{
-				sockaddr_in client_addr {};
+				// sockaddr_in is too small for the clients of an IPv6 listener
+				sockaddr_storage client_addr {};
 				socklen_t client_length = sizeof(client_addr);
 
-				socket_t client_socket = ::accept(_socket.GetSocket(), reinterpret_cast<sockaddr *>(&client_addr), &client_length);
+				// The flags are set without fcntl() calls per connection
+				socket_t client_socket = ::accept4(_socket.GetSocket(), reinterpret_cast<sockaddr *>(&client_addr), &client_length, SOCK_NONBLOCK | SOCK_CLOEXEC);
 
 				if(client_socket != InvalidSocket)
 				{
@@ -486,6 +505,191 @@ namespace ov
 		return error;
 	}
 
+	std::shared_ptr<ov::Error> Socket::Connect(const std::vector<SocketAddress> &endpoints, int timeout)
+	{
+		OV_ASSERT2(_socket.IsValid());
+		CHECK_STATE(== SocketState::Created, ov::Error::CreateError(EINVAL, "Invalid state: %d", static_cast<int>(_state)));
+
+		if(GetType() != SocketType::Tcp)
+		{
+			for(auto &endpoint : endpoints)
+			{
+				if(endpoint.GetFamily() == SocketFamily::Inet)
+				{
+					return Connect(endpoint, timeout);
+				}
+			}
+
+			Close();
+
+			return ov::Error::CreateError(EINVAL, "There is no IPv4 address to connect");
+		}
+
+		struct Attempt
+		{
+			int socket;
+			const SocketAddress *endpoint;
+		};
+
+		std::vector<Attempt> attempts;
+		std::vector<pollfd> poll_fds;
+		std::shared_ptr<ov::Error> error;
+
+		int64_t start_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		int64_t deadline = ((timeout <= 0) || (timeout == Infinite)) ? INT64_MAX : (start_time + timeout);
+		int64_t next_attempt_time = start_time;
+		size_t next_index = 0;
+
+		int connected_socket = InvalidSocket;
+		const SocketAddress *connected_endpoint = nullptr;
+
+		while(connected_socket == InvalidSocket)
+		{
+			int64_t current_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+			if(current_time >= deadline)
+			{
+				error = ov::Error::CreateError(ETIMEDOUT, "Connection timed out");
+				break;
+			}
+
+			if((next_index < endpoints.size()) && (current_time >= next_attempt_time))
+			{
+				auto &endpoint = endpoints[next_index++];
+				int family = (endpoint.GetFamily() == SocketFamily::Inet6) ? PF_INET6 : PF_INET;
+				int sock = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+
+				next_attempt_time = current_time + ConnectionAttemptDelay;
+
+				if(sock == InvalidSocket)
+				{
+					error = ov::Error::CreateErrorFromErrno();
+					next_attempt_time = current_time;
+					continue;
+				}
+
+				if(::connect(sock, endpoint.Address(), endpoint.AddressLength()) == 0)
+				{
+					connected_socket = sock;
+					connected_endpoint = &endpoint;
+					break;
+				}
+
+				if(errno != EINPROGRESS)
+				{
+					// Try the next address immediately
+					error = ov::Error::CreateErrorFromErrno();
+					::close(sock);
+					next_attempt_time = current_time;
+					continue;
+				}
+
+				attempts.push_back({sock, &endpoint});
+				poll_fds.push_back({sock, POLLOUT, 0});
+
+				continue;
+			}
+
+			if(attempts.empty())
+			{
+				if(next_index >= endpoints.size())
+				{
+					// All the addresses are failed
+					break;
+				}
+
+				next_attempt_time = current_time;
+				continue;
+			}
+
+			int64_t wait_time = deadline - current_time;
+
+			if(next_index < endpoints.size())
+			{
+				wait_time = std::min(wait_time, next_attempt_time - current_time);
+			}
+
+			int result = ::poll(poll_fds.data(), poll_fds.size(), static_cast<int>(std::min<int64_t>(std::max<int64_t>(wait_time, 0), INT_MAX)));
+
+			if(result < 0)
+			{
+				if(errno == EINTR)
+				{
+					continue;
+				}
+
+				error = ov::Error::CreateErrorFromErrno();
+				break;
+			}
+
+			for(size_t index = 0; index < poll_fds.size();)
+			{
+				if(poll_fds[index].revents == 0)
+				{
+					index++;
+					continue;
+				}
+
+				int socket_error = 0;
+				socklen_t length = sizeof(socket_error);
+
+				if(::getsockopt(poll_fds[index].fd, SOL_SOCKET, SO_ERROR, &socket_error, &length) != 0)
+				{
+					socket_error = errno;
+				}
+
+				if(socket_error == 0)
+				{
+					connected_socket = attempts[index].socket;
+					connected_endpoint = attempts[index].endpoint;
+
+					attempts.erase(attempts.begin() + index);
+					poll_fds.erase(poll_fds.begin() + index);
+					break;
+				}
+
+				error = ov::Error::CreateError(socket_error, "Could not connect to %s: %s", attempts[index].endpoint->ToString().CStr(), ::strerror(socket_error));
+				::close(attempts[index].socket);
+
+				attempts.erase(attempts.begin() + index);
+				poll_fds.erase(poll_fds.begin() + index);
+
+				// The next address doesn't wait for the delay
+				next_attempt_time = current_time;
+			}
+		}
+
+		for(auto &attempt : attempts)
+		{
+			::close(attempt.socket);
+		}
+
+		if(connected_socket == InvalidSocket)
+		{
+			Close();
+
+			return (error != nullptr) ? error : ov::Error::CreateError(EINVAL, "There is no address to connect");
+		}
+
+		if(_is_nonblock == false)
+		{
+			// Same as Connect(endpoint)
+			int flags = ::fcntl(connected_socket, F_GETFL, 0);
+
+			if(flags != -1)
+			{
+				::fcntl(connected_socket, F_SETFL, flags & ~O_NONBLOCK);
+			}
+		}
+
+		logtd("[%p] [#%d] Connected to %s (replaces #%d)", this, connected_socket, connected_endpoint->ToString().CStr(), _socket.GetSocket());
+
+		::close(_socket.GetSocket());
+		_socket.SetSocket(SocketType::Tcp, connected_socket);
+
+		return nullptr;
+	}
+
 	bool Socket::PrepareEpoll()
 	{
 		switch(GetType())
@@ -540,7 +744,7 @@ namespace ov
 		return false;
 	}
 
-	bool Socket::AddToEpoll(Socket *socket, void *parameter)
+	bool Socket::AddToEpoll(Socket *socket, void *parameter, bool edge_triggered)
 	{
 		CHECK_STATE(<= SocketState::Listening, false);
 
@@ -569,11 +773,20 @@ namespace ov
 					// EPOLLRDHUP : 연결이 종료되거나 Half-close 가 진행된 상황
 					event.events = EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLRDHUP;
 
+					// Only the readiness changes are notified, so a notification is given per burst of data instead of per recv()
+					edge_triggered = edge_triggered && (socket->GetType() == SocketType::Tcp);
+					event.events |= edge_triggered ? EPOLLET : 0;
+
 					logtd("[%p] [#%d] Trying to add socket #%d to epoll #%d...", this, _socket.GetSocket(), socket->_socket.GetSocket(), _epoll);
 					int result = ::epoll_ctl(_epoll, EPOLL_CTL_ADD, socket->_socket.GetSocket(), &event);
 
 					if(result != -1)
 					{
+						// EPOLLOUT is requested to this epoll when the send queue of the socket is not flushed
+						socket->_owner_epoll = _epoll;
+						socket->_owner_epoll_parameter = parameter;
+						socket->_is_edge_triggered = edge_triggered;
+
 						return true;
 					}
 
@@ -809,6 +1022,13 @@ namespace ov
 
 				int result = ::epoll_ctl(_epoll, EPOLL_CTL_DEL, socket->_socket.GetSocket(), nullptr);
 
+				{
+					std::lock_guard<std::mutex> lock_guard(socket->_send_queue_mutex);
+
+					socket->_owner_epoll = InvalidSocket;
+					socket->_owner_epoll_parameter = nullptr;
+				}
+
 				if(result == -1)
 				{
 					logte("[%p] [#%d] Could not delete the socket from epoll for descriptor %d (result: %s)", this, _socket.GetSocket(), socket->_socket.GetSocket(), ov::Error::CreateErrorFromErrno()->ToString().CStr());
@@ -892,6 +1112,21 @@ namespace ov
 		return true;
 	}
 
+	bool Socket::GetSockOpt(SRT_SOCKOPT option, void *value, int *value_length) const
+	{
+		CHECK_STATE(!= SocketState::Closed, false);
+
+		int result = ::srt_getsockopt(_socket.GetSocket(), 0, option, value, value_length);
+
+		if(result == SRT_ERROR)
+		{
+			logtw("[%p] [#%d] Could not get option: %d (result: %s)", this, _socket.GetSocket(), option, srt_getlasterror_str());
+			return false;
+		}
+
+		return true;
+	}
+
 	SocketState Socket::GetState() const
 	{
 		return _state;
@@ -909,6 +1144,8 @@ namespace ov
 
 	ssize_t Socket::Send(const void *data, size_t length, bool &is_retry)
 	{
+		OV_TRACE_SCOPE_FLOW("socket", "Send", TraceFlow::End);
+
 		// TODO: 별도 send queue를 만들어야 함
 		//OV_ASSERT2(_socket.IsValid());
         is_retry = false;
@@ -916,6 +1153,20 @@ namespace ov
 		logtd("[%p] [#%d] Trying to send data %zu bytes...", this, _socket.GetSocket(), length);
 		logtp("[%p] [#%d] %s", this, _socket.GetSocket(), ov::Dump(data, length, 64).CStr());
 
+		if(GetType() == SocketType::Tcp)
+		{
+			std::lock_guard<std::mutex> lock_guard(_send_queue_mutex);
+
+			if((_send_queue.empty() == false) && (length > 0))
+			{
+				// Sending now would overtake the queued data
+				_send_queue.push_back(std::make_shared<Data>(data, length));
+				_send_queue_bytes += length;
+
+				return FlushSendQueueInternal() ? static_cast<ssize_t>(length) : -1L;
+			}
+		}
+
 		auto data_to_send = static_cast<const uint8_t *>(data);
 		size_t remained = length;
 		size_t total_sent = 0L;
@@ -1035,145 +1286,890 @@ namespace ov
 		return total_sent;
 	}
 
-	ssize_t Socket::Send(const void *data, size_t length)
+	ssize_t Socket::SendVector(const std::vector<std::shared_ptr<const Data>> &data_list, bool &is_retry)
 	{
-		OV_ASSERT2(data != nullptr);
+		is_retry = false;
 
-		bool is_retry = false;
-		return Send(data, length, is_retry);
-	}
+		if(GetType() != SocketType::Tcp)
+		{
+			// Only stream sockets can be treated as one continuous buffer
+			ssize_t total_sent = 0;
 
-    ssize_t Socket::Send(const std::shared_ptr<const Data> &data)
-    {
-        OV_ASSERT2(data != nullptr);
+			for(auto &data : data_list)
+			{
+				ssize_t sent = Send(data->GetData(), data->GetLength(), is_retry);
 
-        bool is_retry = false;
-        return Send(data->GetData(), data->GetLength(), is_retry);
-    }
+				total_sent += std::max<ssize_t>(sent, 0);
 
-	ssize_t Socket::SendTo(const ov::SocketAddress &address, const void *data, size_t length)
-	{
-		//OV_ASSERT2(_socket.IsValid());
-		OV_ASSERT2(address.AddressForIPv4()->sin_addr.s_addr != 0);
+				if(is_retry || (sent != static_cast<ssize_t>(data->GetLength())))
+				{
+					break;
+				}
+			}
 
-		logtd("[%p] [#%d] Trying to send data %zu bytes to %s...", this, _socket.GetSocket(), length, address.ToString().CStr());
+			return total_sent;
+		}
 
-		switch(GetType())
 		{
-			case SocketType::Udp:
-			case SocketType::Tcp:
+			std::lock_guard<std::mutex> lock_guard(_send_queue_mutex);
+
+			if(_send_queue.empty() == false)
 			{
-				while(true)
-				{
-					int result = ::sendto(_socket.GetSocket(), data, length, MSG_NOSIGNAL | (_is_nonblock ? MSG_DONTWAIT : 0), address.Address(), address.AddressLength());
+				// Sending now would overtake the queued data
+				size_t length = 0;
 
-					if(result >= 0)
-					{
-#if USE_STATS_COUNTER
-						stats_counter.IncreasePps();
-#endif // USE_STATS_COUNTER
-					}
-					else
+				for(auto &data : data_list)
+				{
+					if(data->GetLength() > 0)
 					{
-						if(errno == EAGAIN)
-						{
-#if USE_STATS_COUNTER
-							stats_counter.IncreaseRetry();
-#endif // USE_STATS_COUNTER
-							continue;
-						}
-
-#if USE_STATS_COUNTER
-						stats_counter.IncreaseError();
-#endif // USE_STATS_COUNTER
+						_send_queue.push_back(data);
+						length += data->GetLength();
 					}
-
-					return result;
 				}
-			}
 
-			case SocketType::Srt:
-				// Does not support SendTo() for SRT
-				OV_ASSERT2(false);
-				break;
+				_send_queue_bytes += length;
 
-			case SocketType::Unknown:
-				break;
+				return FlushSendQueueInternal() ? static_cast<ssize_t>(length) : -1L;
+			}
 		}
 
-		return -1;
-	}
-
-	ssize_t Socket::SendTo(const ov::SocketAddress &address, const std::shared_ptr<const Data> &data)
-	{
-		OV_ASSERT2(data != nullptr);
-
-		return SendTo(address, data->GetData(), data->GetLength());
-	}
+		logtd("[%p] [#%d] Trying to send %zu buffers...", this, _socket.GetSocket(), data_list.size());
 
-	std::shared_ptr<ov::Error> Socket::Recv(std::shared_ptr<Data> &data)
-	{
-		//OV_ASSERT2(_socket.IsValid());
-		OV_ASSERT2(data != nullptr);
-		OV_ASSERT2(data->GetCapacity() > 0);
+		int sock = _socket.GetSocket();
+		iovec iovecs[SendVectorSize];
 
-		logtd("[%p] [#%d] Trying to read from the socket...", this, _socket.GetSocket());
+		// The first buffer which is not sent completely, and the number of bytes sent from it
+		size_t index = 0;
+		size_t offset = 0;
 
-		data->SetLength(data->GetCapacity());
+		size_t total_sent = 0L;
+		int retry_count = 0;
 
-		ssize_t read_bytes = -1;
+		while(index < data_list.size())
+		{
+			int count = 0;
 
-		SRT_MSGCTRL msg_ctrl {};
+			for(size_t data_index = index; (data_index < data_list.size()) && (count < SendVectorSize); data_index++)
+			{
+				auto &data = data_list[data_index];
+				size_t skip = (data_index == index) ? offset : 0;
 
-		switch(GetType())
-		{
-			case SocketType::Udp:
-			case SocketType::Tcp:
-				read_bytes = ::recv(_socket.GetSocket(), data->GetWritableData(), (size_t)data->GetLength(), (_is_nonblock ? MSG_DONTWAIT : 0));
-				break;
+				if(data->GetLength() <= skip)
+				{
+					continue;
+				}
 
-			case SocketType::Srt:
-				read_bytes = ::srt_recvmsg2(_socket.GetSocket(),
-				                            reinterpret_cast<char *>(data->GetWritableData()),
-				                            static_cast<int>(data->GetLength()), &msg_ctrl);
-				break;
+				iovecs[count].iov_base = const_cast<uint8_t *>(data->GetDataAs<uint8_t>() + skip);
+				iovecs[count].iov_len = data->GetLength() - skip;
+				count++;
+			}
 
-			default:
+			if(count == 0)
+			{
+				// Only empty buffers are left
 				break;
-		}
+			}
 
-		if(read_bytes == 0L)
-		{
-			logtd("[%p] [#%d] Client is disconnected (errno: %d)", this, _socket.GetSocket(), errno);
+			msghdr header {};
 
-			data->SetLength(0L);
+			header.msg_iov = iovecs;
+			header.msg_iovlen = static_cast<size_t>(count);
 
-			return Error::CreateErrorFromErrno();
-		}
-		else if(read_bytes < 0L)
-		{
-			logtd("[%p] [#%d] recv() returns: %zd", this, _socket.GetSocket(), read_bytes);
+			ssize_t sent = ::sendmsg(sock, &header, MSG_NOSIGNAL | (_is_nonblock ? MSG_DONTWAIT : 0));
 
-			switch(GetType())
+			if(sent == -1L)
 			{
-				case SocketType::Udp:
-				case SocketType::Tcp:
+				if(errno == EAGAIN)
 				{
-					auto error = Error::CreateErrorFromErrno();
+					// Wait for the send buffer
+					fd_set write_fds {};
+					FD_ZERO(&write_fds);
+					FD_SET(sock, &write_fds);
 
-					data->SetLength(0L);
+					timeval tv {};
+					tv.tv_sec = 0;
+					tv.tv_usec = 200000;
 
-					switch(error->GetCode())
+					int select_result = select(sock + 1, nullptr, &write_fds, nullptr, &tv);
+
+					if(select_result == 0)
 					{
-						case EAGAIN:
-							// 클라이언트가 보낸 데이터를 끝까지 다 읽었음. 다음 데이터가 올 때까지 대기해야 함
-							logtd("[%p] [#%d] There is no data to read", this, _socket.GetSocket());
+						// timed out
+						retry_count++;
+
+						if(retry_count > 5)
+						{
+							is_retry = true;
 							break;
+						}
+					}
+					else if(select_result < 0)
+					{
+						logtw("[%p] [#%d] An error occurred while select(): %d (%s)", this, sock, select_result, ov::Error::CreateErrorFromErrno()->ToString().CStr());
+						break;
+					}
 
-						case ECONNRESET:
-							// Connection reset by peer
-							logtw("[%p] [#%d] Connection reset by peer", this, _socket.GetSocket());
-							SetState(SocketState::Error);
+					continue;
+				}
+
+				logtw("[%p] [#%d] Could not send data: %zd (%s)", this, sock, sent, ov::Error::CreateErrorFromErrno()->ToString().CStr());
+
+				break;
+			}
+
+			total_sent += sent;
+
+			// Skip the buffers which are sent
+			size_t remained = static_cast<size_t>(sent);
+
+			while((remained > 0) && (index < data_list.size()))
+			{
+				size_t available = data_list[index]->GetLength() - offset;
+
+				if(remained < available)
+				{
+					offset += remained;
+					remained = 0;
+				}
+				else
+				{
+					remained -= available;
+					index++;
+					offset = 0;
+				}
+			}
+		}
+
+		logtd("[%p] [#%d] %zu bytes sent", this, _socket.GetSocket(), total_sent);
+
+		return total_sent;
+	}
+
+	bool Socket::SendAsync(const std::shared_ptr<const Data> &data)
+	{
+		return SendAsync(std::vector<std::shared_ptr<const Data>> { data });
+	}
+
+	bool Socket::SendAsync(const std::vector<std::shared_ptr<const Data>> &data_list, bool is_forced)
+	{
+		if((GetType() != SocketType::Tcp) || (GetState() != SocketState::Connected))
+		{
+			return false;
+		}
+
+		std::unique_lock<std::mutex> lock(_send_queue_mutex);
+
+		if(_owner_epoll == InvalidSocket)
+		{
+			// Nobody waits for EPOLLOUT, so the data is sent right now
+			lock.unlock();
+
+			size_t length = 0;
+
+			for(auto &data : data_list)
+			{
+				length += data->GetLength();
+			}
+
+			bool is_retry = false;
+
+			return SendVector(data_list, is_retry) == static_cast<ssize_t>(length);
+		}
+
+		if((is_forced == false) && (_send_queue_bytes > SendQueueHighWaterMark))
+		{
+			// The client doesn't receive the data fast enough
+			logtd("[%p] [#%d] The send queue is full (%zu bytes)", this, _socket.GetSocket(), _send_queue_bytes);
+			return false;
+		}
+
+		for(auto &data : data_list)
+		{
+			if(data->GetLength() > 0)
+			{
+				_send_queue.push_back(data);
+				_send_queue_bytes += data->GetLength();
+			}
+		}
+
+		return FlushSendQueueInternal();
+	}
+
+	bool Socket::FlushSendQueue()
+	{
+		std::lock_guard<std::mutex> lock_guard(_send_queue_mutex);
+
+		return FlushSendQueueInternal();
+	}
+
+	bool Socket::FlushSendQueueInternal()
+	{
+		int sock = _socket.GetSocket();
+		iovec iovecs[SendVectorSize];
+		bool result = true;
+
+		while((_send_queue.empty() == false) && _socket.IsValid())
+		{
+			int count = 0;
+
+			for(auto item = _send_queue.begin(); (item != _send_queue.end()) && (count < SendVectorSize); ++item)
+			{
+				size_t skip = (count == 0) ? _send_queue_offset : 0;
+
+				iovecs[count].iov_base = const_cast<uint8_t *>((*item)->GetDataAs<uint8_t>() + skip);
+				iovecs[count].iov_len = (*item)->GetLength() - skip;
+				count++;
+			}
+
+			msghdr header {};
+
+			header.msg_iov = iovecs;
+			header.msg_iovlen = static_cast<size_t>(count);
+
+			ssize_t sent = ::sendmsg(sock, &header, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+			if(sent == -1L)
+			{
+				if(errno == EINTR)
+				{
+					continue;
+				}
+
+				if(errno == EAGAIN)
+				{
+					// The rest is sent when EPOLLOUT occurs
+					break;
+				}
+
+				logtw("[%p] [#%d] Could not send the queued data: %zu bytes (%s)", this, sock, _send_queue_bytes, ov::Error::CreateErrorFromErrno()->ToString().CStr());
+
+				_send_queue.clear();
+				_send_queue_offset = 0;
+				_send_queue_bytes = 0;
+
+				CallSendCompletionCallbacks(false);
+
+				result = false;
+				break;
+			}
+
+			_send_queue_bytes -= sent;
+			_send_queue_total_sent += sent;
+
+			// Release the buffers which are sent, and remember the offset of the partially sent one
+			size_t remained = static_cast<size_t>(sent);
+
+			while(remained > 0)
+			{
+				size_t available = _send_queue.front()->GetLength() - _send_queue_offset;
+
+				if(remained < available)
+				{
+					_send_queue_offset += remained;
+					remained = 0;
+				}
+				else
+				{
+					remained -= available;
+					_send_queue.pop_front();
+					_send_queue_offset = 0;
+				}
+			}
+		}
+
+		CallSendCompletionCallbacks(true);
+
+		bool need_writable = (_send_queue.empty() == false);
+
+		if((_owner_epoll != InvalidSocket) && (need_writable != _is_waiting_for_writable))
+		{
+			_is_waiting_for_writable = need_writable;
+
+			uint32_t events = EPOLLERR | EPOLLHUP;
+
+			events |= _is_draining ? 0 : (EPOLLIN | EPOLLRDHUP);
+			events |= need_writable ? EPOLLOUT : 0;
+
+			ModifyOwnerEpoll(events);
+		}
+
+		return result;
+	}
+
+	bool Socket::ModifyOwnerEpoll(uint32_t events)
+	{
+		epoll_event event {};
+
+		event.data.ptr = _owner_epoll_parameter;
+		// EPOLL_CTL_MOD re-arms the edge-triggered socket (a notification is given if it is ready already)
+		event.events = events | (_is_edge_triggered ? EPOLLET : 0);
+
+		if(::epoll_ctl(_owner_epoll, EPOLL_CTL_MOD, _socket.GetSocket(), &event) == -1)
+		{
+			logte("[%p] [#%d] Could not modify the events of epoll #%d (error: %s)", this, _socket.GetSocket(), _owner_epoll, Error::CreateErrorFromErrno()->ToString().CStr());
+			return false;
+		}
+
+		return true;
+	}
+
+	size_t Socket::GetSendQueueBytes() const
+	{
+		std::lock_guard<std::mutex> lock_guard(_send_queue_mutex);
+
+		return _send_queue_bytes;
+	}
+
+	void Socket::NotifyWhenSent(SendCompletionCallback callback)
+	{
+		std::lock_guard<std::mutex> lock_guard(_send_queue_mutex);
+
+		if(_send_queue_bytes == 0)
+		{
+			callback(true);
+			return;
+		}
+
+		_send_completion_callbacks.emplace_back(_send_queue_total_sent + _send_queue_bytes, std::move(callback));
+	}
+
+	void Socket::CallSendCompletionCallbacks(bool is_sent)
+	{
+		while(_send_completion_callbacks.empty() == false)
+		{
+			auto &item = _send_completion_callbacks.front();
+
+			if(is_sent && (item.first > _send_queue_total_sent))
+			{
+				break;
+			}
+
+			auto callback = std::move(item.second);
+
+			_send_completion_callbacks.pop_front();
+
+			callback(is_sent);
+		}
+	}
+
+	bool Socket::StartDraining()
+	{
+		std::lock_guard<std::mutex> lock_guard(_send_queue_mutex);
+
+		if(_send_queue.empty() || (_owner_epoll == InvalidSocket) || (_socket.IsValid() == false))
+		{
+			return false;
+		}
+
+		_is_draining = true;
+		_draining_start_time = std::chrono::steady_clock::now();
+
+		// Only EPOLLOUT is needed from now on
+		_is_waiting_for_writable = true;
+
+		return ModifyOwnerEpoll(EPOLLOUT | EPOLLERR | EPOLLHUP);
+	}
+
+	ssize_t Socket::Send(const void *data, size_t length)
+	{
+		OV_ASSERT2(data != nullptr);
+
+		bool is_retry = false;
+		return Send(data, length, is_retry);
+	}
+
+    ssize_t Socket::Send(const std::shared_ptr<const Data> &data)
+    {
+        OV_ASSERT2(data != nullptr);
+
+        bool is_retry = false;
+        return Send(data->GetData(), data->GetLength(), is_retry);
+    }
+
+	ssize_t Socket::SendTo(const ov::SocketAddress &address, const void *data, size_t length)
+	{
+		OV_TRACE_SCOPE_FLOW("socket", "SendTo", TraceFlow::End);
+
+		//OV_ASSERT2(_socket.IsValid());
+		OV_ASSERT2(address.AddressForIPv4()->sin_addr.s_addr != 0);
+
+		logtd("[%p] [#%d] Trying to send data %zu bytes to %s...", this, _socket.GetSocket(), length, address.ToString().CStr());
+
+		switch(GetType())
+		{
+			case SocketType::Udp:
+			case SocketType::Tcp:
+			{
+				while(true)
+				{
+					int result = ::sendto(_socket.GetSocket(), data, length, MSG_NOSIGNAL | (_is_nonblock ? MSG_DONTWAIT : 0), address.Address(), address.AddressLength());
+
+					if(result >= 0)
+					{
+#if USE_STATS_COUNTER
+						stats_counter.IncreasePps();
+#endif // USE_STATS_COUNTER
+					}
+					else
+					{
+						if(errno == EAGAIN)
+						{
+#if USE_STATS_COUNTER
+							stats_counter.IncreaseRetry();
+#endif // USE_STATS_COUNTER
+							continue;
+						}
+
+#if USE_STATS_COUNTER
+						stats_counter.IncreaseError();
+#endif // USE_STATS_COUNTER
+					}
+
+					return result;
+				}
+			}
+
+			case SocketType::Srt:
+				// Does not support SendTo() for SRT
+				OV_ASSERT2(false);
+				break;
+
+			case SocketType::Unknown:
+				break;
+		}
+
+		return -1;
+	}
+
+	ssize_t Socket::SendTo(const ov::SocketAddress &address, const std::shared_ptr<const Data> &data)
+	{
+		OV_ASSERT2(data != nullptr);
+
+		return SendTo(address, data->GetData(), data->GetLength());
+	}
+
+	uint64_t TxTimePacer::GetDepartureTime(size_t length)
+	{
+		uint64_t rate = _rate;
+
+		if(rate == 0)
+		{
+			return 0;
+		}
+
+		timespec now {};
+		::clock_gettime(CLOCK_MONOTONIC, &now);
+
+		uint64_t current_time = (static_cast<uint64_t>(now.tv_sec) * 1000000000ULL) + now.tv_nsec;
+		uint64_t max_departure_time = current_time + (TxTimeMaxLead * 1000000ULL);
+
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		uint64_t departure_time = std::min(std::max(current_time, _next_departure_time), max_departure_time);
+
+		_next_departure_time = departure_time + ((length * 8ULL * 1000000000ULL) / rate);
+
+		return departure_time;
+	}
+
+	ssize_t Socket::SendToBatch(const ov::SocketAddress &address, const std::vector<std::shared_ptr<Data>> &data_list, TxTimePacer *pacer)
+	{
+		OV_TRACE_SCOPE_FLOW("socket", "SendToBatch", TraceFlow::End);
+
+		OV_ASSERT2(address.AddressForIPv4()->sin_addr.s_addr != 0);
+
+		if(GetType() != SocketType::Udp)
+		{
+			// sendmmsg() is only meaningful for datagram sockets
+			ssize_t sent_count = 0;
+
+			for(auto &data : data_list)
+			{
+				if(SendTo(address, data) >= 0)
+				{
+					sent_count++;
+				}
+			}
+
+			return (data_list.empty() || (sent_count > 0)) ? sent_count : -1;
+		}
+
+		logtd("[%p] [#%d] Trying to send %zu datagrams to %s...", this, _socket.GetSocket(), data_list.size(), address.ToString().CStr());
+
+		// Control messages for UDP_SEGMENT and SCM_TXTIME
+		union ControlBuffer
+		{
+			char buffer[CMSG_SPACE(sizeof(uint16_t)) + CMSG_SPACE(sizeof(uint64_t))];
+			cmsghdr alignment;
+		};
+
+		mmsghdr messages[SendBatchSize];
+		iovec iovecs[SendBatchSize];
+		ControlBuffer controls[SendBatchSize];
+		// Number of datagrams in each message
+		size_t segment_counts[SendBatchSize];
+
+		size_t total_count = data_list.size();
+		size_t sent_count = 0;
+
+		// The departure times are taken once per datagram (the messages can be made again when they are retried)
+		std::vector<uint64_t> departure_times;
+
+		if((pacer != nullptr) && _tx_time && (pacer->GetRate() > 0))
+		{
+			departure_times.reserve(total_count);
+
+			for(auto &data : data_list)
+			{
+				departure_times.push_back(pacer->GetDepartureTime(data->GetLength()));
+			}
+		}
+
+		while(sent_count < total_count)
+		{
+			size_t datagram_count = std::min<size_t>(total_count - sent_count, SendBatchSize);
+			bool use_segmentation = _udp_segmentation;
+			unsigned int message_count = 0;
+
+			::memset(messages, 0, sizeof(mmsghdr) * datagram_count);
+
+			for(size_t index = 0; index < datagram_count;)
+			{
+				auto &header = messages[message_count].msg_hdr;
+				// A GSO buffer leaves at the departure time of its first datagram
+				uint64_t departure_time = departure_times.empty() ? 0 : departure_times[sent_count + index];
+				size_t segment_size = data_list[sent_count + index]->GetLength();
+				size_t segment_count = 0;
+				size_t total_bytes = 0;
+
+				header.msg_name = const_cast<sockaddr *>(address.Address());
+				header.msg_namelen = address.AddressLength();
+				header.msg_iov = &(iovecs[index]);
+
+				// A GSO buffer consists of the datagrams of the same size, except the last one which can be shorter
+				do
+				{
+					auto &data = data_list[sent_count + index];
+
+					iovecs[index].iov_base = const_cast<void *>(data->GetData());
+					iovecs[index].iov_len = data->GetLength();
+
+					total_bytes += data->GetLength();
+					segment_count++;
+					index++;
+
+					if(data->GetLength() < segment_size)
+					{
+						break;
+					}
+				}
+				while(
+					use_segmentation &&
+					(index < datagram_count) &&
+					(segment_count < UdpSegmentMaxCount) &&
+					(data_list[sent_count + index]->GetLength() <= segment_size) &&
+					((total_bytes + data_list[sent_count + index]->GetLength()) <= UdpSegmentMaxBytes));
+
+				header.msg_iovlen = segment_count;
+
+				size_t control_length = 0;
+
+				if(segment_count > 1)
+				{
+					auto control = reinterpret_cast<cmsghdr *>(controls[message_count].buffer + control_length);
+
+					control->cmsg_level = SOL_UDP;
+					control->cmsg_type = UDP_SEGMENT;
+					control->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+					*(reinterpret_cast<uint16_t *>(CMSG_DATA(control))) = static_cast<uint16_t>(segment_size);
+
+					control_length += CMSG_SPACE(sizeof(uint16_t));
+				}
+
+				if(departure_time != 0)
+				{
+					auto control = reinterpret_cast<cmsghdr *>(controls[message_count].buffer + control_length);
+
+					control->cmsg_level = SOL_SOCKET;
+					control->cmsg_type = SCM_TXTIME;
+					control->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+					::memcpy(CMSG_DATA(control), &departure_time, sizeof(departure_time));
+
+					control_length += CMSG_SPACE(sizeof(uint64_t));
+				}
+
+				if(control_length > 0)
+				{
+					header.msg_control = controls[message_count].buffer;
+					header.msg_controllen = control_length;
+				}
+
+				segment_counts[message_count] = segment_count;
+				message_count++;
+			}
+
+			int result = ::sendmmsg(_socket.GetSocket(), messages, message_count, MSG_NOSIGNAL | (_is_nonblock ? MSG_DONTWAIT : 0));
+
+			if(result > 0)
+			{
+				size_t sent_datagram_count = 0;
+
+				for(int index = 0; index < result; index++)
+				{
+					sent_datagram_count += segment_counts[index];
+				}
+
+#if USE_STATS_COUNTER
+				for(size_t index = 0; index < sent_datagram_count; index++)
+				{
+					stats_counter.IncreasePps();
+				}
+#endif // USE_STATS_COUNTER
+				// sendmmsg() may send fewer messages than requested, so the rest is sent in the next loop
+				sent_count += sent_datagram_count;
+				continue;
+			}
+
+			if((result < 0) && (errno == EAGAIN))
+			{
+#if USE_STATS_COUNTER
+				stats_counter.IncreaseRetry();
+#endif // USE_STATS_COUNTER
+				continue;
+			}
+
+			if((result < 0) && use_segmentation && ((errno == EIO) || (errno == EINVAL)))
+			{
+				// The device doesn't support checksum offloading (EIO) or the kernel refused the segmentation,
+				// so send the datagrams one by one from now on
+				logtw("[%p] [#%d] UDP segmentation is disabled: %s", this, _socket.GetSocket(), ov::Error::CreateErrorFromErrno()->ToString().CStr());
+
+				_udp_segmentation = false;
+				continue;
+			}
+
+#if USE_STATS_COUNTER
+			stats_counter.IncreaseError();
+#endif // USE_STATS_COUNTER
+			break;
+		}
+
+		return (total_count == 0) || (sent_count > 0) ? static_cast<ssize_t>(sent_count) : -1;
+	}
+
+	bool Socket::SetUdpSegmentation(bool enable)
+	{
+		if(enable == false)
+		{
+			_udp_segmentation = false;
+			return true;
+		}
+
+		if(GetType() != SocketType::Udp)
+		{
+			return false;
+		}
+
+		// The option can be read only if the kernel knows UDP_SEGMENT
+		int segment_size = 0;
+		socklen_t length = sizeof(segment_size);
+
+		if(::getsockopt(_socket.GetSocket(), SOL_UDP, UDP_SEGMENT, &segment_size, &length) != 0)
+		{
+			logtd("[%p] [#%d] UDP segmentation is not supported: %s", this, _socket.GetSocket(), ov::Error::CreateErrorFromErrno()->ToString().CStr());
+			return false;
+		}
+
+		_udp_segmentation = true;
+
+		return true;
+	}
+
+	bool Socket::SetTxTime(bool enable)
+	{
+		if(GetType() != SocketType::Udp)
+		{
+			return false;
+		}
+
+		if(enable == _tx_time)
+		{
+			return true;
+		}
+
+		if(enable)
+		{
+			// The departure times are compared with CLOCK_MONOTONIC by the fq qdisc
+			sock_txtime tx_time {};
+
+			tx_time.clockid = CLOCK_MONOTONIC;
+			tx_time.flags = 0;
+
+			if(SetSockOpt(SO_TXTIME, tx_time) == false)
+			{
+				logtd("[%p] [#%d] SO_TXTIME is not supported", this, _socket.GetSocket());
+				return false;
+			}
+		}
+		else
+		{
+			// A zero-length option turns it off
+			if(::setsockopt(_socket.GetSocket(), SOL_SOCKET, SO_TXTIME, nullptr, 0) != 0)
+			{
+				logtw("[%p] [#%d] Could not disable SO_TXTIME: %s", this, _socket.GetSocket(), ov::Error::CreateErrorFromErrno()->ToString().CStr());
+				return false;
+			}
+		}
+
+		_tx_time = enable;
+
+		return true;
+	}
+
+	bool Socket::SetMaxPacingRate(uint64_t rate)
+	{
+		if(GetType() != SocketType::Tcp)
+		{
+			return false;
+		}
+
+		// The option is bytes per second (the old kernels accept only 32 bits, and ~0U means unlimited)
+		uint64_t bytes_per_second = rate / 8;
+		uint32_t value = ((rate == 0) || (bytes_per_second >= UINT32_MAX)) ? UINT32_MAX : std::max<uint32_t>(static_cast<uint32_t>(bytes_per_second), 1);
+
+		if(SetSockOpt(SO_MAX_PACING_RATE, value) == false)
+		{
+			logtw("[%p] [#%d] Could not set the pacing rate to %" PRIu64 " bps", this, _socket.GetSocket(), rate);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool Socket::JoinMulticastGroup(const SocketAddress &group_address, const SocketAddress &interface_address)
+	{
+		CHECK_STATE(!= SocketState::Closed, false);
+
+		if((GetType() != SocketType::Udp) || (group_address.AddressForIPv4() == nullptr) || (interface_address.AddressForIPv4() == nullptr))
+		{
+			return false;
+		}
+
+		if(IN_MULTICAST(ntohl(group_address.AddrInForIPv4()->s_addr)) == false)
+		{
+			logtw("[%p] [#%d] %s is not a multicast address", this, _socket.GetSocket(), group_address.GetIpAddress().CStr());
+			return false;
+		}
+
+		ip_mreq request {};
+
+		request.imr_multiaddr = *(group_address.AddrInForIPv4());
+		request.imr_interface = *(interface_address.AddrInForIPv4());
+
+		if(::setsockopt(_socket.GetSocket(), IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) != 0)
+		{
+			if(errno == EADDRINUSE)
+			{
+				// Already joined (e.g. the port is shared by the applications)
+				return true;
+			}
+
+			logtw("[%p] [#%d] Could not join the multicast group %s (interface: %s): %s", this, _socket.GetSocket(),
+				  group_address.GetIpAddress().CStr(), interface_address.GetIpAddress().CStr(), ov::Error::CreateErrorFromErrno()->ToString().CStr());
+			return false;
+		}
+
+		return true;
+	}
+
+	bool Socket::SetMulticastOutput(int ttl, bool loopback, const SocketAddress &interface_address)
+	{
+		CHECK_STATE(!= SocketState::Closed, false);
+
+		if((GetType() != SocketType::Udp) || (interface_address.AddressForIPv4() == nullptr))
+		{
+			return false;
+		}
+
+		auto multicast_ttl = static_cast<uint8_t>(std::min(std::max(ttl, 0), 255));
+		uint8_t multicast_loop = loopback ? 1 : 0;
+		in_addr multicast_interface = *(interface_address.AddrInForIPv4());
+
+		if((::setsockopt(_socket.GetSocket(), IPPROTO_IP, IP_MULTICAST_TTL, &multicast_ttl, sizeof(multicast_ttl)) != 0) ||
+		   (::setsockopt(_socket.GetSocket(), IPPROTO_IP, IP_MULTICAST_LOOP, &multicast_loop, sizeof(multicast_loop)) != 0) ||
+		   (::setsockopt(_socket.GetSocket(), IPPROTO_IP, IP_MULTICAST_IF, &multicast_interface, sizeof(multicast_interface)) != 0))
+		{
+			logtw("[%p] [#%d] Could not set the multicast options (ttl: %d, interface: %s): %s", this, _socket.GetSocket(),
+				  ttl, interface_address.GetIpAddress().CStr(), ov::Error::CreateErrorFromErrno()->ToString().CStr());
+			return false;
+		}
+
+		return true;
+	}
+
+	std::shared_ptr<ov::Error> Socket::Recv(std::shared_ptr<Data> &data)
+	{
+		//OV_ASSERT2(_socket.IsValid());
+		OV_ASSERT2(data != nullptr);
+		OV_ASSERT2(data->GetCapacity() > 0);
+
+		logtd("[%p] [#%d] Trying to read from the socket...", this, _socket.GetSocket());
+
+		data->SetLength(data->GetCapacity());
+
+		ssize_t read_bytes = -1;
+
+		SRT_MSGCTRL msg_ctrl {};
+
+		switch(GetType())
+		{
+			case SocketType::Udp:
+			case SocketType::Tcp:
+				read_bytes = ::recv(_socket.GetSocket(), data->GetWritableData(), (size_t)data->GetLength(), (_is_nonblock ? MSG_DONTWAIT : 0));
+				break;
+
+			case SocketType::Srt:
+				read_bytes = ::srt_recvmsg2(_socket.GetSocket(),
+				                            reinterpret_cast<char *>(data->GetWritableData()),
+				                            static_cast<int>(data->GetLength()), &msg_ctrl);
+				break;
+
+			default:
+				break;
+		}
+
+		if(read_bytes == 0L)
+		{
+			logtd("[%p] [#%d] Client is disconnected (errno: %d)", this, _socket.GetSocket(), errno);
+
+			data->SetLength(0L);
+
+			return Error::CreateErrorFromErrno();
+		}
+		else if(read_bytes < 0L)
+		{
+			logtd("[%p] [#%d] recv() returns: %zd", this, _socket.GetSocket(), read_bytes);
+
+			switch(GetType())
+			{
+				case SocketType::Udp:
+				case SocketType::Tcp:
+				{
+					auto error = Error::CreateErrorFromErrno();
+
+					data->SetLength(0L);
+
+					switch(error->GetCode())
+					{
+						case EAGAIN:
+							// 클라이언트가 보낸 데이터를 끝까지 다 읽었음. 다음 데이터가 올 때까지 대기해야 함
+							logtd("[%p] [#%d] There is no data to read", this, _socket.GetSocket());
+							break;
+
+						case ECONNRESET:
+							// Connection reset by peer
+							logtw("[%p] [#%d] Connection reset by peer", this, _socket.GetSocket());
+							SetState(SocketState::Error);
 							return error;
 
 						default:
@@ -1227,6 +2223,80 @@ namespace ov
 		return nullptr;
 	}
 
+	std::shared_ptr<ov::Error> Socket::RecvAll(const std::shared_ptr<Data> &data, size_t max_bytes, bool *would_block)
+	{
+		OV_ASSERT2(data != nullptr);
+		OV_ASSERT2(GetType() == SocketType::Tcp);
+
+		*would_block = false;
+
+		size_t length = data->GetLength();
+
+		while(length < max_bytes)
+		{
+			size_t to_read = std::min(RecvAllChunkSize, max_bytes - length);
+
+			// The data is read into the tail of the buffer (no copy after recv())
+			if(data->SetLength(length + to_read) == false)
+			{
+				data->SetLength(length);
+				return Error::CreateError(ENOMEM, "Could not allocate the receive buffer");
+			}
+
+			ssize_t read_bytes = ::recv(_socket.GetSocket(), data->GetWritableDataAs<uint8_t>() + length, to_read, MSG_DONTWAIT);
+
+			if(read_bytes > 0L)
+			{
+				length += static_cast<size_t>(read_bytes);
+				data->SetLength(length);
+
+				if(static_cast<size_t>(read_bytes) < to_read)
+				{
+					// The socket is drained (the next recv() would return EAGAIN), so a syscall is saved
+					// (a notification is given for the data which arrives after this recv())
+					*would_block = true;
+					break;
+				}
+
+				continue;
+			}
+
+			data->SetLength(length);
+
+			if(read_bytes == 0L)
+			{
+				logtd("[%p] [#%d] Client is disconnected", this, _socket.GetSocket());
+				return Error::CreateError(ECONNRESET, "Disconnected");
+			}
+
+			auto error = Error::CreateErrorFromErrno();
+
+			switch(error->GetCode())
+			{
+				case EINTR:
+					continue;
+
+				case EAGAIN:
+					*would_block = true;
+					return nullptr;
+
+				case ECONNRESET:
+					logtw("[%p] [#%d] Connection reset by peer", this, _socket.GetSocket());
+					SetState(SocketState::Error);
+					return error;
+
+				default:
+					logte("[%p] [#%d] An error occurred while read data: %s", this, _socket.GetSocket(), error->ToString().CStr());
+					SetState(SocketState::Error);
+					return error;
+			}
+		}
+
+		logtd("[%p] [#%d] %zu bytes read", this, _socket.GetSocket(), length);
+
+		return nullptr;
+	}
+
 	std::shared_ptr<ov::Error> Socket::RecvFrom(std::shared_ptr<Data> &data, std::shared_ptr<ov::SocketAddress> *address)
 	{
 		OV_ASSERT2(_socket.IsValid());
@@ -1302,6 +2372,17 @@ namespace ov
 
 			CHECK_STATE(!= SocketState::Closed, false);
 
+			{
+				// Waits for FlushSendQueue() of the other thread
+				std::lock_guard<std::mutex> lock_guard(_send_queue_mutex);
+
+				_send_queue.clear();
+				_send_queue_offset = 0;
+				_send_queue_bytes = 0;
+
+				CallSendCompletionCallbacks(false);
+			}
+
 			// socket 관련
 			switch(GetType())
 			{
@@ -17,7 +17,12 @@
 #include <utility>
 #include <memory>
 #include <map>
+#include <deque>
+#include <vector>
 #include <functional>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 
 // for SRT
 #include <srt/srt.h>
@@ -36,6 +41,42 @@ namespace ov
 
 	constexpr const int MaxSrtPacketSize = 1316;
 
+	// Maximum number of datagrams passed to a sendmmsg() call
+	constexpr const int SendBatchSize = 64;
+
+	// Maximum number of datagrams received by a recvmmsg() call
+	constexpr const int RecvBatchSize = 32;
+
+	// Maximum number of buffers passed to a sendmsg() call of SendVector()
+	constexpr const int SendVectorSize = 64;
+
+	// SendAsync() is refused while more than this is queued (backpressure)
+	constexpr const size_t SendQueueHighWaterMark = 4 * 1024 * 1024;
+	// A client disconnected while its send queue is not empty is closed after the queue is flushed, or after this (ms)
+	constexpr const int SendQueueDrainTimeout = 10 * 1000;
+
+	// Limits of a UDP GSO (UDP_SEGMENT) buffer: the kernel accepts up to 64 segments and a 64KB datagram
+	constexpr const int UdpSegmentMaxCount = 64;
+	constexpr const size_t UdpSegmentMaxBytes = 60000;
+
+	// The departure time of a paced datagram is at most this far ahead (ms)
+	// (the packets are sent faster than the pacing rate when the sender has to drain its own queue)
+	constexpr const int TxTimeMaxLead = 100;
+
+	// Maximum number of connections accepted per an event of the listener
+	// (the rest is accepted after the events of the established connections are processed)
+	constexpr const int AcceptBatchSize = 64;
+	// The per-IP connection buckets which are full are removed at this interval (ms)
+	constexpr const int ConnectionBucketCleanupInterval = 10 * 1000;
+
+	// The next address is tried if the previous one isn't connected within this time (ms, Happy Eyeballs, RFC 8305)
+	constexpr const int ConnectionAttemptDelay = 250;
+
+	// RecvAll() reads into the buffer by this size
+	constexpr const size_t RecvAllChunkSize = 64 * 1024;
+	// The data of an edge-triggered socket is passed to the callback when this is read (the rest is read after the callback)
+	constexpr const size_t RecvAllMaxBytes = 1024 * 1024;
+
 	enum class SocketType : char
 	{
 		Unknown,
@@ -54,6 +95,35 @@ namespace ov
 		Error,
 	};
 
+	// Earliest departure time (EDT) of the datagrams sent to a peer (SO_TXTIME)
+	//
+	// - Each datagram is stamped with the time it may leave, and the fq qdisc holds it until then,
+	//   so the bursts are smoothed by the kernel without a timer per packet
+	// - Without the fq qdisc, the timestamps are ignored and the datagrams are sent immediately
+	class TxTimePacer
+	{
+	public:
+		// bits per second (0: not paced)
+		void SetRate(uint64_t rate)
+		{
+			_rate = rate;
+		}
+
+		uint64_t GetRate() const
+		{
+			return _rate;
+		}
+
+		// Returns the departure time (ns, CLOCK_MONOTONIC) of a datagram of the length, or 0 if it is not paced
+		uint64_t GetDepartureTime(size_t length);
+
+	protected:
+		std::atomic<uint64_t> _rate { 0 };
+
+		std::mutex _mutex;
+		uint64_t _next_departure_time = 0;
+	};
+
 	// socket_t와 SRTSOCKET의 타입이 int로 같으므로, 이를 추상화
 	struct SocketWrapper
 	{
@@ -198,9 +268,15 @@ namespace ov
 		}
 
 		std::shared_ptr<ov::Error> Connect(const SocketAddress &endpoint, int timeout = Infinite);
+		// The addresses of DnsResolver::Resolve() are raced (TCP): a new attempt is started every ConnectionAttemptDelay ms
+		// (or when the previous one fails), and the first connected one is used with its family
+		// - The socket is replaced by the connected one, so the options must be set after it
+		// - The other types are connected to the first IPv4 address (they are created as IPv4)
+		std::shared_ptr<ov::Error> Connect(const std::vector<SocketAddress> &endpoints, int timeout);
 
 		bool PrepareEpoll();
-		bool AddToEpoll(Socket *socket, void *parameter);
+		// edge_triggered: EPOLLET (TCP only), the socket must be read until EAGAIN (see RecvAll()) for each event
+		bool AddToEpoll(Socket *socket, void *parameter, bool edge_triggered = false);
 		int EpollWait(int timeout = Infinite);
 		const epoll_event *EpollEvents(int index);
 		bool RemoveFromEpoll(Socket *socket);
@@ -226,6 +302,9 @@ namespace ov
 
 		bool SetSockOpt(SRT_SOCKOPT option, const void *value, int value_length);
 
+		// value_length: size of the value (in), length of the option (out)
+		bool GetSockOpt(SRT_SOCKOPT option, void *value, int *value_length) const;
+
 		// 현재 소켓의 접속 상태
 		SocketState GetState() const;
 
@@ -243,9 +322,79 @@ namespace ov
 		virtual ssize_t Send(const void *data, size_t length);
 		virtual ssize_t Send(const std::shared_ptr<const Data> &data);
         virtual ssize_t Send(const void *data, size_t length, bool &is_retry);
+		// Sends the buffers in order with as few syscalls as possible (scatter/gather I/O), without concatenating them
+		// Returns the number of bytes sent (is_retry is set like Send(data, length, is_retry))
+		virtual ssize_t SendVector(const std::vector<std::shared_ptr<const Data>> &data_list, bool &is_retry);
+
+		// Queued send (TCP, the socket must be added to an epoll by AddToEpoll() of the owner)
+		// - The buffers are kept (not copied) until they are sent, the rest is sent by FlushSendQueue() on EPOLLOUT
+		// - Returns false if the socket is not available, or more than SendQueueHighWaterMark is queued (try again later)
+		// - While the queue is not empty, Send()/SendVector() also append to the queue to keep the order
+		// - is_forced: queued even if more than SendQueueHighWaterMark is queued
+		//   (e.g. the control frames of a multiplexed protocol, which limits the data by itself)
+		bool SendAsync(const std::shared_ptr<const Data> &data);
+		bool SendAsync(const std::vector<std::shared_ptr<const Data>> &data_list, bool is_forced = false);
+
+		// Called by the owner of the epoll when EPOLLOUT occurs
+		// Returns false if an error occurred (the queued data is discarded)
+		bool FlushSendQueue();
+
+		size_t GetSendQueueBytes() const;
+
+		// is_sent: true if the data has been written to the kernel, false if it has been discarded (error, Close())
+		typedef std::function<void(bool is_sent)> SendCompletionCallback;
+		// The callback is called when the data which is queued before this call has been sent
+		// (right now if nothing is queued). It is called with the send queue locked, so it must not use the socket
+		void NotifyWhenSent(SendCompletionCallback callback);
+
+		// Stops receiving, and keeps the socket in the epoll of the owner until the send queue is flushed
+		// Returns false if nothing is queued (the socket can be closed now)
+		bool StartDraining();
+
+		bool IsDraining() const
+		{
+			return _is_draining;
+		}
+
+		// SendQueueDrainTimeout is elapsed after StartDraining()
+		bool IsDrainTimedOut() const
+		{
+			return _is_draining && (std::chrono::steady_clock::now() - _draining_start_time) >= std::chrono::milliseconds(SendQueueDrainTimeout);
+		}
 
 		virtual ssize_t SendTo(const ov::SocketAddress &address, const void *data, size_t length);
 		virtual ssize_t SendTo(const ov::SocketAddress &address, const std::shared_ptr<const Data> &data);
+		// Sends several datagrams to the same address with as few syscalls as possible (sendmmsg)
+		// If UDP segmentation is enabled, consecutive datagrams of the same size are sent as one GSO buffer
+		// Returns the number of datagrams sent, or -1 if no datagram could be sent
+		// If the pacer is given and SO_TXTIME is enabled, each message is stamped with the departure time of the pacer
+		virtual ssize_t SendToBatch(const ov::SocketAddress &address, const std::vector<std::shared_ptr<Data>> &data_list, TxTimePacer *pacer = nullptr);
+
+		// UDP GSO (UDP_SEGMENT, Linux 4.18+)
+		// Returns false if the kernel doesn't support it
+		bool SetUdpSegmentation(bool enable);
+		bool IsUdpSegmentationEnabled() const
+		{
+			return _udp_segmentation;
+		}
+
+		// SO_TXTIME (Linux 4.19+) for the paced datagrams of SendToBatch()
+		// Returns false if the kernel doesn't support it
+		bool SetTxTime(bool enable);
+		bool IsTxTimeEnabled() const
+		{
+			return _tx_time;
+		}
+
+		// SO_MAX_PACING_RATE of a TCP connection (bits per second, 0: unlimited)
+		// TCP paces the segments by itself (or by the fq qdisc), so the bursts of the responses are smoothed
+		bool SetMaxPacingRate(uint64_t rate);
+
+		// IP_ADD_MEMBERSHIP of an IPv4 multicast group (UDP only), the socket must be bound to the port of the group
+		// - interface_address: the group is received from the interface of the address (INADDR_ANY: selected by the routing table)
+		bool JoinMulticastGroup(const SocketAddress &group_address, const SocketAddress &interface_address);
+		// IP_MULTICAST_TTL/IP_MULTICAST_LOOP/IP_MULTICAST_IF of the multicast datagrams which are sent by this socket (UDP only)
+		bool SetMulticastOutput(int ttl, bool loopback, const SocketAddress &interface_address);
 
 		virtual // 데이터 수신
 		// 최대 ByteData의 capacity만큼 데이터를 기록
@@ -256,6 +405,16 @@ namespace ov
 		// nullptr이 반환되면 errno를 체크해야 함
 		std::shared_ptr<ov::Error> RecvFrom(std::shared_ptr<Data> &data, std::shared_ptr<ov::SocketAddress> *address);
 
+		// Appends the data to the buffer until the socket would block (*would_block = true), or the buffer has max_bytes
+		// (TCP only, for the edge-triggered sockets)
+		// If an error is returned, the data which is read before the error is kept in the buffer
+		std::shared_ptr<ov::Error> RecvAll(const std::shared_ptr<Data> &data, size_t max_bytes, bool *would_block);
+
+		bool IsEdgeTriggered() const
+		{
+			return _is_edge_triggered;
+		}
+
 		// 소켓을 닫음
 		virtual bool Close();
 
@@ -264,6 +423,13 @@ namespace ov
 	protected:
 		SocketWrapper AcceptClientInternal(SocketAddress *client);
 
+		// _send_queue_mutex must be locked
+		bool FlushSendQueueInternal();
+		// Calls the callbacks which have been reached (or all of them if is_sent is false), _send_queue_mutex must be locked
+		void CallSendCompletionCallbacks(bool is_sent);
+		// Changes the events of the socket in the epoll of the owner
+		bool ModifyOwnerEpoll(uint32_t events);
+
 		// utility method
 		static String StringFromEpollEvent(const epoll_event *event);
 		static String StringFromEpollEvent(const epoll_event &event);
@@ -280,6 +446,10 @@ namespace ov
 
 		bool _is_nonblock = false;
 
+		// SendToBatch() can be called by several threads, and the option is turned off when the NIC/driver refuses GSO
+		std::atomic<bool> _udp_segmentation { false };
+		bool _tx_time = false;
+
 		// Related to epoll
 		// for normal socket
 		socket_t _epoll = InvalidSocket;
@@ -288,5 +458,26 @@ namespace ov
 		int _srt_epoll = SRT_INVALID_SOCK;
 		epoll_event *_epoll_events = nullptr;
 		int _last_epoll_event_count = 0;
+
+		// The epoll which this socket is added to (by AddToEpoll() of the owner, e.g. ServerSocket)
+		socket_t _owner_epoll = InvalidSocket;
+		void *_owner_epoll_parameter = nullptr;
+		// EPOLLET is set to the events of the owner epoll
+		bool _is_edge_triggered = false;
+
+		// Related to SendAsync()
+		mutable std::mutex _send_queue_mutex;
+		std::deque<std::shared_ptr<const Data>> _send_queue;
+		// Bytes of the first buffer which are sent already
+		size_t _send_queue_offset = 0;
+		size_t _send_queue_bytes = 0;
+		// Bytes which have been sent from the queue since the socket is created
+		uint64_t _send_queue_total_sent = 0;
+		// Callbacks of NotifyWhenSent(), ordered by _send_queue_total_sent to be reached
+		std::deque<std::pair<uint64_t, SendCompletionCallback>> _send_completion_callbacks;
+		// EPOLLOUT is requested to the owner
+		bool _is_waiting_for_writable = false;
+		std::atomic<bool> _is_draining { false };
+		std::chrono::steady_clock::time_point _draining_start_time;
 	};
 }
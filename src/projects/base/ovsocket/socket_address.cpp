@@ -92,8 +92,6 @@ namespace ov
 		OV_ASSERT2((void *)_address_ipv6 == (void *)(&_address_storage));
 
 		*_address_ipv4 = addr_in;
-
-		UpdateIPAddress();
 	}
 
 	SocketAddress::SocketAddress(const sockaddr_in6 &addr_in)
@@ -103,8 +101,6 @@ namespace ov
 		OV_ASSERT2((void *)_address_ipv6 == (void *)(&_address_storage));
 
 		*_address_ipv6 = addr_in;
-
-		UpdateIPAddress();
 	}
 
 	SocketAddress::SocketAddress(const sockaddr_storage &address)
@@ -116,8 +112,6 @@ namespace ov
 		OV_ASSERT((address.ss_family == AF_INET) || (address.ss_family == AF_INET6), "Unknown address family: %d", address.ss_family);
 
 		_address_storage = address;
-
-		UpdateIPAddress();
 	}
 
 	SocketAddress::SocketAddress(const SocketAddress &address)
@@ -129,7 +123,6 @@ namespace ov
 		::memcpy(&_address_storage, &(address._address_storage), sizeof(_address_storage));
 
 		_hostname = address._hostname;
-		_ip_address = address._ip_address;
 	}
 
 	SocketAddress::SocketAddress(SocketAddress &&address) noexcept
@@ -141,7 +134,6 @@ namespace ov
 		_address_storage = address._address_storage;
 
 		std::swap(_hostname, address._hostname);
-		std::swap(_ip_address, address._ip_address);
 	}
 
 	SocketAddress::~SocketAddress()
@@ -153,7 +145,6 @@ namespace ov
 		_address_storage = address._address_storage;
 
 		_hostname = address._hostname;
-		_ip_address = address._ip_address;
 
 		return *this;
 	}
@@ -236,8 +227,6 @@ namespace ov
 			// 의미는 없지만, endian 맞춤
 			_address_ipv4->sin_addr.s_addr = ov::HostToNetwork32(INADDR_ANY);
 
-			_ip_address = "0.0.0.0";
-
 			return true;
 		}
 
@@ -327,28 +316,9 @@ namespace ov
 
 		_hostname = hostname;
 
-		UpdateIPAddress();
-
 		return true;
 	}
 
-	void SocketAddress::UpdateIPAddress()
-	{
-		if(_address_storage.ss_family != AF_UNSPEC)
-		{
-			String ip_address;
-
-			ip_address.SetLength(AddressLength());
-
-			const void *address = (_address_storage.ss_family == AF_INET) ? (void *)(&(_address_ipv4->sin_addr)) : (void *)(&(_address_ipv6->sin6_addr));
-
-			if(inet_ntop(_address_storage.ss_family, address, ip_address.GetBuffer(), static_cast<socklen_t>(ip_address.GetLength())) != nullptr)
-			{
-				_ip_address = ip_address;
-			}
-		}
-	}
-
 	ov::String SocketAddress::GetHostname() const noexcept
 	{
 		return _hostname;
@@ -356,7 +326,20 @@ namespace ov
 
 	ov::String SocketAddress::GetIpAddress() const noexcept
 	{
-		return _ip_address;
+		if(_address_storage.ss_family == AF_UNSPEC)
+		{
+			return "";
+		}
+
+		char ip_address[INET6_ADDRSTRLEN] = { 0 };
+		const void *address = (_address_storage.ss_family == AF_INET) ? (const void *)(&(_address_ipv4->sin_addr)) : (const void *)(&(_address_ipv6->sin6_addr));
+
+		if(::inet_ntop(_address_storage.ss_family, address, ip_address, sizeof(ip_address)) == nullptr)
+		{
+			return "";
+		}
+
+		return ip_address;
 	}
 
 	bool SocketAddress::SetPort(uint16_t port)
@@ -8,6 +8,7 @@
 //==============================================================================
 #pragma once
 
+#include "./socket_address_key.h"
 #include "./socket_datastructure.h"
 #include "./socket_utilities.h"
 
@@ -63,8 +64,15 @@ namespace ov
 
 		bool SetHostname(const char *hostname);
 		ov::String GetHostname() const noexcept;
+		// Made from the address when it is requested (the addresses of the received packets don't need the strings)
 		ov::String GetIpAddress() const noexcept;
 
+		// Compact key for the demux tables
+		SocketAddressKey GetKey() const noexcept
+		{
+			return SocketAddressKey(Address());
+		}
+
 		bool SetPort(uint16_t port);
 		uint16_t Port() const noexcept;
 
@@ -102,8 +110,6 @@ namespace ov
 
 		socklen_t AddressLength() const noexcept;
 
-		void UpdateIPAddress();
-
 		ov::String ToString() const noexcept;
 
 	protected:
@@ -112,7 +118,7 @@ namespace ov
 		sockaddr_in *_address_ipv4;
 		sockaddr_in6 *_address_ipv6;
 
+		// Only if the address is made from a hostname
 		ov::String _hostname;
-		ov::String _ip_address;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,114 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+namespace ov
+{
+	// Compact key of an IPv4/IPv6 address and a port (18 bytes) for the demux tables
+	//
+	// - An IPv4 address is stored as an IPv4-mapped IPv6 address (::ffff:a.b.c.d), so the family is not stored
+	// - Compared and hashed without the sockaddr_storage (128 bytes) and the strings of SocketAddress
+	struct SocketAddressKey
+	{
+		// Network byte order
+		uint8_t address[16] = { 0 };
+		// Host byte order
+		uint16_t port = 0;
+
+		SocketAddressKey() = default;
+
+		// nullptr or an unknown family makes an empty key
+		explicit SocketAddressKey(const sockaddr *socket_address)
+		{
+			if(socket_address == nullptr)
+			{
+				return;
+			}
+
+			switch(socket_address->sa_family)
+			{
+				case AF_INET:
+				{
+					auto address_ipv4 = reinterpret_cast<const sockaddr_in *>(socket_address);
+
+					address[10] = 0xFF;
+					address[11] = 0xFF;
+					::memcpy(address + 12, &(address_ipv4->sin_addr), sizeof(address_ipv4->sin_addr));
+					port = ntohs(address_ipv4->sin_port);
+					break;
+				}
+
+				case AF_INET6:
+				{
+					auto address_ipv6 = reinterpret_cast<const sockaddr_in6 *>(socket_address);
+
+					::memcpy(address, &(address_ipv6->sin6_addr), sizeof(address));
+					port = ntohs(address_ipv6->sin6_port);
+					break;
+				}
+
+				default:
+					break;
+			}
+		}
+
+		bool operator ==(const SocketAddressKey &key) const
+		{
+			return (port == key.port) && (::memcmp(address, key.address, sizeof(address)) == 0);
+		}
+
+		bool operator !=(const SocketAddressKey &key) const
+		{
+			return !(operator ==(key));
+		}
+
+		uint64_t GetHash() const
+		{
+			uint64_t words[2];
+			::memcpy(words, address, sizeof(words));
+
+			// Mix the words (the addresses of the players are similar, e.g. the same subnet)
+			uint64_t hash = words[0] ^ (words[1] * 0x9E3779B97F4A7C15ULL) ^ (static_cast<uint64_t>(port) << 16);
+
+			hash ^= hash >> 33;
+			hash *= 0xFF51AFD7ED558CCDULL;
+			hash ^= hash >> 33;
+
+			return hash;
+		}
+	};
+
+	static_assert(sizeof(SocketAddressKey) == 18, "SocketAddressKey must be 18 bytes");
+
+	struct SocketAddressKeyHash
+	{
+		uint64_t operator()(const SocketAddressKey &key) const
+		{
+			return key.GetHash();
+		}
+	};
+}
+
+namespace std
+{
+	template<>
+	struct hash<ov::SocketAddressKey>
+	{
+		size_t operator()(const ov::SocketAddressKey &key) const
+		{
+			return static_cast<size_t>(key.GetHash());
+		}
+	};
+}
@@ -17,7 +17,7 @@ namespace pvd
 	Application::Application(const info::Application *application_info)
 		: info::Application(*application_info)
 	{
-
+		_quota_statistics = ApplicationQuota::Instance()->GetStatistics(*application_info);
 	}
 
 	Application::~Application()
@@ -39,16 +39,22 @@ namespace pvd
 
 	std::shared_ptr<Stream> Application::GetStreamById(uint32_t stream_id)
 	{
-		if(_streams.find(stream_id) == _streams.end())
+		std::lock_guard<std::mutex> lock(_streams_mutex);
+
+		auto item = _streams.find(stream_id);
+
+		if(item == _streams.end())
 		{
 			return nullptr;
 		}
 
-		return _streams[stream_id];
+		return item->second;
 	}
 
 	std::shared_ptr<Stream> Application::GetStreamByName(ov::String stream_name)
 	{
+		std::lock_guard<std::mutex> lock(_streams_mutex);
+
 		for(auto const &x : _streams)
 		{
 			auto stream = x.second;
@@ -83,27 +89,63 @@ namespace pvd
 			return false;
 		}
 
+		// The provider closes the ingest of the refused stream
+		if(ov::MemoryGovernor::Instance()->IsLevel(ov::MemoryGovernorLevel::RefuseNew))
+		{
+			logtw("The stream %s/%s is refused by the memory governor", GetName().CStr(), stream->GetName().CStr());
+			return false;
+		}
+
+		// The encoders move to the other nodes (the existing streams are kept until the deadline)
+		if(ov::DrainMode::Instance()->IsDraining())
+		{
+			logtw("The stream %s/%s is refused while draining", GetName().CStr(), stream->GetName().CStr());
+			return false;
+		}
+
+		// The encoders of the other applications are not affected by this application
+		ov::String reason = _quota_statistics->GetStreamRejectReason();
+
+		if(reason.IsEmpty() == false)
+		{
+			logtw("The stream %s/%s is refused by the quota of the application - %s", GetName().CStr(), stream->GetName().CStr(), reason.CStr());
+			return false;
+		}
+
 		MediaRouteApplicationConnector::CreateStream(stream);
 
+		std::lock_guard<std::mutex> lock(_streams_mutex);
 		_streams[stream->GetId()] = stream;
 
 
 		return true;
 	}
 
+	bool Application::SendFrame(std::shared_ptr<StreamInfo> stream_info, std::unique_ptr<MediaPacket> packet)
+	{
+		if((packet != nullptr) && (packet->GetData() != nullptr))
+		{
+			_quota_statistics->AddIngestBytes(packet->GetData()->GetLength());
+		}
+
+		return MediaRouteApplicationConnector::SendFrame(std::move(stream_info), std::move(packet));
+	}
+
 	bool Application::DeleteStream2(std::shared_ptr<Stream> stream)
 	{
 		logtd("DeleteStream");
 
-		if(_streams.find(stream->GetId()) == _streams.end())
 		{
-			return false;
+			std::lock_guard<std::mutex> lock(_streams_mutex);
+
+			if(_streams.erase(stream->GetId()) == 0)
+			{
+				return false;
+			}
 		}
 
 		MediaRouteApplicationConnector::DeleteStream(stream);
 
-		_streams.erase(stream->GetId());
-
 		return true;
 	}
 }
\ No newline at end of file
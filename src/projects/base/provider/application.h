@@ -14,6 +14,7 @@
 #include "base/ovlibrary/ovlibrary.h"
 
 #include "base/media_route/media_route_application_connector.h"
+#include "base/application/application_quota.h"
 
 namespace pvd
 {
@@ -40,6 +41,9 @@ namespace pvd
 		bool CreateStream2(std::shared_ptr<Stream> stream);
 		bool DeleteStream2(std::shared_ptr<Stream> stream);
 
+		// The ingest is accounted to the quota of the application before it is sent to the router
+		bool SendFrame(std::shared_ptr<StreamInfo> stream_info, std::unique_ptr<MediaPacket> packet);
+
 		// 상위 클래스에서 Stream 객체를 생성해서 받아옴
 		virtual std::shared_ptr<Stream> OnCreateStream() = 0;
 
@@ -47,8 +51,13 @@ namespace pvd
 		explicit Application(const info::Application *application_info);
 		~Application() override;
 
+		// The streams are created/deleted/found by several ingest threads
+		std::mutex _streams_mutex;
 		std::map<uint32_t, std::shared_ptr<Stream>> _streams;
 
+		// <MaxIngestBitrate> refuses the new streams
+		std::shared_ptr<ApplicationQuotaStatistics> _quota_statistics;
+
 	private:
 		std::mutex _queue_guard;
 		std::condition_variable _queue_cv;
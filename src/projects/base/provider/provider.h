@@ -16,6 +16,36 @@ namespace pvd
 	class Application;
 	class Stream;
 
+	// Memory used by a connection of the provider (for monitoring)
+	struct ConnectionMemoryData
+	{
+		ov::String app_name;
+		ov::String stream_name;
+		ov::String remote;
+		// Bytes which are received but not parsed yet
+		size_t receive_buffer_size = 0;
+		// Message bodies which are being assembled or waiting to be processed
+		size_t message_buffer_size = 0;
+	};
+
+	// Statistics of the transport of a connection (for monitoring, e.g. SRT)
+	struct TransportStatisticsData
+	{
+		ov::String app_name;
+		ov::String stream_name;
+		ov::String remote;
+		// Round trip time (ms)
+		double rtt = 0.0;
+		// Receiving rate (Mbps)
+		double receive_rate = 0.0;
+		int64_t received_packets = 0;
+		int64_t lost_packets = 0;
+		// Loss reports (NAK) sent to the peer, the peer retransmits the packets of them
+		int64_t retransmission_requests = 0;
+		// Packets which are too late to play (dropped by the receiver)
+		int64_t dropped_packets = 0;
+	};
+
 	// WebRTC, HLS, MPEG-DASH 등 모든 Provider는 다음 Interface를 구현하여 MediaRouterInterface에 자신을 등록한다.
 	class Provider
 	{
@@ -30,6 +60,18 @@ namespace pvd
 		std::shared_ptr<Application> GetApplicationById(info::application_id_t app_id);
 		std::shared_ptr<Stream> GetStreamById(info::application_id_t app_id, uint32_t stream_id);
 
+		// Collects the memory used by the connections (returns false if the provider does not keep any connection)
+		virtual bool GetConnectionMemoryData(std::vector<std::shared_ptr<ConnectionMemoryData>> &memories)
+		{
+			return false;
+		}
+
+		// Collects the statistics of the transports (returns false if the provider has no statistics)
+		virtual bool GetTransportStatisticsData(std::vector<std::shared_ptr<TransportStatisticsData>> &statistics)
+		{
+			return false;
+		}
+
 	protected:
 		Provider(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
 		virtual ~Provider();
@@ -6,7 +6,6 @@
 Application::Application(const info::Application *application_info)
 	: info::Application(*application_info)
 {
-	_stop_thread_flag = false;
 }
 
 Application::~Application()
@@ -16,25 +15,92 @@ Application::~Application()
 
 bool Application::Start()
 {
-	// Thread 생성
-	_stop_thread_flag = false;
-	_worker_thread = std::thread(&Application::WorkerThread, this);
-
+	// The workers are started when the first stream is created (see StartWorkers()),
+	// so the applications which have no stream don't have the threads
 	return true;
 }
 
 bool Application::Stop()
 {
-	_stop_thread_flag = true;
-	_worker_thread.join();
+	std::vector<std::shared_ptr<Worker>> workers;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_worker_mutex);
+
+		workers = std::move(_workers);
+		_workers.clear();
+		_workers_started = false;
+	}
+
+	// Stopped without the lock, so the threads which push to the workers are not blocked while joining
+	// (the workers are released when the last pusher releases them)
+	for(auto &worker : workers)
+	{
+		worker->Stop();
+	}
 
 	return true;
 }
 
+bool Application::StartWorkers()
+{
+	if(_workers_started)
+	{
+		return true;
+	}
+
+	std::lock_guard<std::mutex> lock_guard(_worker_mutex);
+
+	if(_workers_started)
+	{
+		return true;
+	}
+
+	auto worker_count = std::max(GetAppWorkerCount(), 1);
+	std::vector<std::shared_ptr<Worker>> workers;
+
+	for(int i = 0; i < worker_count; i++)
+	{
+		auto worker = std::make_shared<Worker>(this);
+
+		if(worker->Start() == false)
+		{
+			logte("Cannot create application worker (%d)", i);
+			return false;
+		}
+
+		workers.push_back(std::move(worker));
+	}
+
+	logtd("%d workers are started for application %s", worker_count, GetName().CStr());
+
+	_workers = std::move(workers);
+	_workers_started = true;
+
+	return true;
+}
+
+std::shared_ptr<Application::Worker> Application::GetWorkerByStreamId(uint32_t stream_id)
+{
+	std::lock_guard<std::mutex> lock_guard(_worker_mutex);
+
+	if(_workers.empty())
+	{
+		return nullptr;
+	}
+
+	return _workers[stream_id % _workers.size()];
+}
+
 // Call by MediaRouteApplicationObserver
 // Stream이 생성되었을 때 호출된다.
 bool Application::OnCreateStream(std::shared_ptr<StreamInfo> info)
 {
+	if(StartWorkers() == false)
+	{
+		return false;
+	}
+
 	// Stream을 자식을 통해 생성해서 연결한다.
 	auto worker_count = GetThreadCount();
 	auto stream = CreateStream(info, worker_count);
@@ -45,6 +111,8 @@ bool Application::OnCreateStream(std::shared_ptr<StreamInfo> info)
 		return false;
 	}
 
+	stream->SetSessionRebalance(IsSessionRebalanceEnabled());
+
 	_streams[info->GetId()] = stream;
 
 	return true;
@@ -80,58 +148,64 @@ bool Application::OnDeleteStream(std::shared_ptr<StreamInfo> info)
 
 bool Application::OnSendVideoFrame(std::shared_ptr<StreamInfo> stream_info,
                                    std::shared_ptr<MediaTrack> track,
-                                   std::unique_ptr<EncodedFrame> encoded_frame,
-                                   std::unique_ptr<CodecSpecificInfo> codec_info,
-                                   std::unique_ptr<FragmentationHeader> fragmentation)
+                                   std::unique_ptr<EncodedFrameDescriptor> frame)
 {
 	auto data = std::make_unique<Application::VideoStreamData>(stream_info,
 	                                                           track,
-	                                                           std::move(encoded_frame),
-	                                                           std::move(codec_info),
-	                                                           std::move(fragmentation));
+	                                                           std::move(frame));
 
-	// Mutex (This function may be called by Router thread)
-	std::unique_lock<std::mutex> lock(_video_stream_queue_guard);
-	_video_stream_queue.push(std::move(data));
-	lock.unlock();
-	_queue_event.Notify();
+	// This function may be called by Router thread
+	auto worker = GetWorkerByStreamId(stream_info->GetId());
 
-	return true;
+	if(worker == nullptr)
+	{
+		return false;
+	}
+
+	return worker->PushVideoStreamData(std::move(data));
 }
 
 bool Application::OnSendAudioFrame(std::shared_ptr<StreamInfo> stream_info,
                                    std::shared_ptr<MediaTrack> track,
-                                   std::unique_ptr<EncodedFrame> encoded_frame,
-                                   std::unique_ptr<CodecSpecificInfo> codec_info,
-                                   std::unique_ptr<FragmentationHeader> fragmentation)
+                                   std::unique_ptr<EncodedFrameDescriptor> frame)
 {
 	auto data = std::make_unique<Application::AudioStreamData>(stream_info,
 	                                                           track,
-	                                                           std::move(encoded_frame),
-	                                                           std::move(codec_info),
-	                                                           std::move(fragmentation));
+	                                                           std::move(frame));
 
-	// Mutex (This function may be called by Router thread)
-	std::unique_lock<std::mutex> lock(_audio_stream_queue_guard);
+	// This function may be called by Router thread
+	auto worker = GetWorkerByStreamId(stream_info->GetId());
 
-	_audio_stream_queue.push(std::move(data));
-	lock.unlock();
-	_queue_event.Notify();
+	if(worker == nullptr)
+	{
+		return false;
+	}
 
-	return true;
+	return worker->PushAudioStreamData(std::move(data));
 }
 
 bool Application::PushIncomingPacket(std::shared_ptr<SessionInfo> session_info,
                                      std::shared_ptr<const ov::Data> data)
 {
-	auto packet = std::make_unique<Application::IncomingPacket>(session_info, data);
+	// The packet is processed by the worker of the stream to which the session belongs
+	auto stream = std::static_pointer_cast<Session>(session_info)->GetStream();
 
-	// Mutex (This function may be called by IcePort thread)
-	std::unique_lock<std::mutex> lock(this->_incoming_packet_queue_guard);
-	_incoming_packet_queue.push(std::move(packet));
-	lock.unlock();
+	if(stream == nullptr)
+	{
+		return false;
+	}
 
-	_queue_event.Notify();
+	// This function may be called by IcePort thread
+	auto worker = GetWorkerByStreamId(stream->GetId());
+
+	if(worker == nullptr)
+	{
+		return false;
+	}
+
+	auto packet = std::make_unique<Application::IncomingPacket>(session_info, data);
+
+	worker->PushIncomingPacket(std::move(packet));
 
 	return true;
 }
@@ -160,54 +234,307 @@ std::shared_ptr<Stream> Application::GetStream(ov::String stream_name)
 	return nullptr;
 }
 
-std::unique_ptr<Application::VideoStreamData> Application::PopVideoStreamData()
+void Application::SetQueueConfig(const cfg::PublisherQueue &queue_config)
 {
-	std::unique_lock<std::mutex> lock(_video_stream_queue_guard);
+	_queue_max_size = static_cast<size_t>(std::max(queue_config.GetMaxSize(), 0));
+	_queue_policy = queue_config.GetPolicy();
+}
+
+void Application::OnFrameQueueOverflow(const std::shared_ptr<StreamInfo> &stream_info, common::MediaType media_type, size_t queue_size, size_t drop_count)
+{
+	auto overflow_count = ++_overflow_count;
 
-	if(_video_stream_queue.empty())
+	if((overflow_count % APPLICATION_QUEUE_DROP_LOG_INTERVAL) == 1)
 	{
-		return nullptr;
+		logtw("The %s queue of the application %s is full (stream: %s, size: %zu, dropped: %zu, policy: %d, overflows: %llu)",
+		      (media_type == common::MediaType::Video) ? "video" : "audio",
+		      GetName().CStr(), stream_info->GetName().CStr(), queue_size, drop_count,
+		      static_cast<int>(_queue_policy), static_cast<unsigned long long>(overflow_count));
+	}
+}
+
+ApplicationQueueStatistics Application::GetQueueStatistics()
+{
+	ApplicationQueueStatistics statistics;
+
+	std::lock_guard<std::mutex> lock_guard(_worker_mutex);
+
+	for(auto &worker : _workers)
+	{
+		worker->GetQueueStatistics(statistics);
 	}
 
-	// 데이터를 하나 꺼낸다.
-	auto data = std::move(_video_stream_queue.front());
-	_video_stream_queue.pop();
-	return data;
+	return statistics;
 }
 
-std::unique_ptr<Application::AudioStreamData> Application::PopAudioStreamData()
+std::vector<std::shared_ptr<Stream>> Application::GetStreamList()
 {
-	std::unique_lock<std::mutex> lock(_audio_stream_queue_guard);
+	std::vector<std::shared_ptr<Stream>> stream_list;
 
-	if(_audio_stream_queue.empty())
+	for(auto const &x : _streams)
 	{
-		return nullptr;
+		stream_list.push_back(x.second);
 	}
 
-	// 데이터를 하나 꺼낸다.
-	auto data = std::move(_audio_stream_queue.front());
-	_audio_stream_queue.pop();
-	return data;
+	return stream_list;
 }
 
-std::unique_ptr<Application::IncomingPacket> Application::PopIncomingPacket()
+std::vector<std::shared_ptr<Stream>> Application::GetRenditionStreams(const ov::String &stream_name)
 {
-	std::unique_lock<std::mutex> lock(this->_incoming_packet_queue_guard);
+	auto origin_stream_name = stream_name;
+	auto stream = GetStream(stream_name);
 
-	if(_incoming_packet_queue.empty())
+	if((stream != nullptr) && (stream->GetOriginStreamName().IsEmpty() == false))
 	{
-		return nullptr;
+		origin_stream_name = stream->GetOriginStreamName();
+	}
+
+	std::vector<std::shared_ptr<Stream>> stream_list;
+
+	for(auto const &x : _streams)
+	{
+		if(x.second->GetOriginStreamName() == origin_stream_name)
+		{
+			stream_list.push_back(x.second);
+		}
 	}
 
-	// 데이터를 하나 꺼낸다.
-	auto packet = std::move(_incoming_packet_queue.front());
-	_incoming_packet_queue.pop();
-	return packet;
+	if(stream_list.empty() && (stream != nullptr))
+	{
+		stream_list.push_back(stream);
+	}
+
+	return stream_list;
 }
 
+Application::Worker::Worker(Application *application)
+	: _application(application)
+{
+	_stop_thread_flag = true;
+}
+
+Application::Worker::~Worker()
+{
+	Stop();
+}
+
+bool Application::Worker::Start()
+{
+	if(_stop_thread_flag == false)
+	{
+		return true;
+	}
+
+	_stop_thread_flag = false;
+	_worker_thread = std::thread(&Application::Worker::WorkerThread, this);
+
+	return true;
+}
+
+bool Application::Worker::Stop()
+{
+	if(_stop_thread_flag)
+	{
+		return true;
+	}
+
+	_stop_thread_flag = true;
+	// Generate Event
+	_queue_event.Notify();
+	_worker_thread.join();
+
+	// Release the router threads which are blocked by the policy
+	_video_stream_queue.space.notify_all();
+	_audio_stream_queue.space.notify_all();
+
+	return true;
+}
+
+bool Application::Worker::PushVideoStreamData(std::unique_ptr<VideoStreamData> data)
+{
+	return PushFrame(_video_stream_queue, std::move(data), common::MediaType::Video);
+}
+
+bool Application::Worker::PushAudioStreamData(std::unique_ptr<AudioStreamData> data)
+{
+	return PushFrame(_audio_stream_queue, std::move(data), common::MediaType::Audio);
+}
+
+void Application::Worker::GetQueueStatistics(ApplicationQueueStatistics &statistics)
+{
+	{
+		std::lock_guard<ov::ProfiledMutex> lock_guard(_video_stream_queue.guard);
+
+		statistics.video_size += _video_stream_queue.queue.size();
+		statistics.video_high_water_mark = std::max(statistics.video_high_water_mark, _video_stream_queue.high_water_mark);
+		statistics.video_drop_count += _video_stream_queue.drop_count;
+	}
+
+	{
+		std::lock_guard<ov::ProfiledMutex> lock_guard(_audio_stream_queue.guard);
+
+		statistics.audio_size += _audio_stream_queue.queue.size();
+		statistics.audio_high_water_mark = std::max(statistics.audio_high_water_mark, _audio_stream_queue.high_water_mark);
+		statistics.audio_drop_count += _audio_stream_queue.drop_count;
+	}
+}
+
+template<typename T>
+bool Application::Worker::PushFrame(FrameQueue<T> &frame_queue, std::unique_ptr<T> item, common::MediaType media_type)
+{
+	auto stream_info = item->_stream_info;
+	size_t max_size = _application->_queue_max_size;
+	auto policy = _application->_queue_policy;
+
+	bool is_video = (media_type == common::MediaType::Video);
+	bool is_key_frame = is_video && (item->_frame != nullptr) && (item->_frame->encoded_frame._frame_type == FrameType::VideoFrameKey);
+	bool queued = true;
+	bool overflowed = false;
+	size_t drop_count = 0;
+
+	std::unique_lock<ov::ProfiledMutex> lock(frame_queue.guard);
+
+	if((max_size > 0) && (stream_info != nullptr))
+	{
+		uint32_t stream_id = stream_info->GetId();
+
+		if(is_video && (policy == cfg::PublisherQueuePolicy::DropToKeyFrame))
+		{
+			// The frames of the streams which lost the previous frames are not decodable until the next key frame
+			if(_waiting_key_frame_streams.count(stream_id) > 0)
+			{
+				if(is_key_frame)
+				{
+					_waiting_key_frame_streams.erase(stream_id);
+				}
+				else
+				{
+					queued = false;
+				}
+			}
+
+			if(queued && (frame_queue.queue.size() >= max_size))
+			{
+				overflowed = true;
+
+				while(frame_queue.queue.empty() == false)
+				{
+					auto &dropped_item = frame_queue.queue.front();
+
+					if(dropped_item->_stream_info != nullptr)
+					{
+						_waiting_key_frame_streams.insert(dropped_item->_stream_info->GetId());
+					}
+
+					frame_queue.queue.pop();
+					drop_count++;
+				}
+
+				if(is_key_frame)
+				{
+					_waiting_key_frame_streams.erase(stream_id);
+				}
+				else
+				{
+					_waiting_key_frame_streams.insert(stream_id);
+					queued = false;
+				}
+			}
+		}
+		else if(policy == cfg::PublisherQueuePolicy::Block)
+		{
+			if(frame_queue.queue.size() >= max_size)
+			{
+				overflowed = true;
+
+				frame_queue.space.wait(lock, [&]() -> bool {
+					return (frame_queue.queue.size() < max_size) || _stop_thread_flag;
+				});
+			}
+		}
+		else
+		{
+			// PublisherQueuePolicy::DropOldest (and the audio of PublisherQueuePolicy::DropToKeyFrame)
+			while(frame_queue.queue.size() >= max_size)
+			{
+				overflowed = true;
+
+				frame_queue.queue.pop();
+				drop_count++;
+			}
+		}
+	}
+
+	// The worker drains the queues after it wakes up, so it is notified only when the queue becomes non-empty
+	bool was_empty = frame_queue.queue.empty();
+
+	if(queued)
+	{
+		frame_queue.queue.push(std::move(item));
+		frame_queue.high_water_mark = std::max(frame_queue.high_water_mark, frame_queue.queue.size());
+	}
+	else
+	{
+		drop_count++;
+	}
+
+	frame_queue.drop_count += drop_count;
+
+	size_t queue_size = frame_queue.queue.size();
+
+	lock.unlock();
+
+	if(queued && was_empty)
+	{
+		_queue_event.Notify();
+	}
+
+	if(overflowed || (drop_count > 0))
+	{
+		_application->OnFrameQueueOverflow(stream_info, media_type, queue_size, drop_count);
+	}
+
+	return queued;
+}
+
+void Application::Worker::PushIncomingPacket(std::unique_ptr<IncomingPacket> packet)
+{
+	Push(_incoming_packet_queue, _incoming_packet_queue_guard, std::move(packet));
+}
+
+template<typename T>
+void Application::Worker::Push(std::queue<std::unique_ptr<T>> &queue, ov::ProfiledMutex &guard, std::unique_ptr<T> item)
+{
+	std::unique_lock<ov::ProfiledMutex> lock(guard);
+	bool was_empty = queue.empty();
+	queue.push(std::move(item));
+	lock.unlock();
+
+	if(was_empty)
+	{
+		_queue_event.Notify();
+	}
+}
+
+template<typename T>
+bool Application::Worker::PopBatch(std::queue<std::unique_ptr<T>> &queue, ov::ProfiledMutex &guard, std::vector<std::unique_ptr<T>> &batch)
+{
+	batch.clear();
+
+	std::unique_lock<ov::ProfiledMutex> lock(guard);
+
+	while((queue.empty() == false) && (batch.size() < APPLICATION_WORKER_BATCH_SIZE))
+	{
+		batch.push_back(std::move(queue.front()));
+		queue.pop();
+	}
+
+	return (batch.empty() == false);
+}
 
 /*
- * Application WorkerThread는 Publisher의 Application 마다 하나씩 존재이며, 유일한 Thread이다.
+ * Application Worker는 Publisher의 Application 마다 AppWorkerCount 개 존재하며,
+ * 각 Stream은 Stream ID에 따라 하나의 Worker에 할당된다.
  *
  * 다음과 같은 동작을 수행한다.
  *
@@ -216,62 +543,111 @@ std::unique_ptr<Application::IncomingPacket> Application::PopIncomingPacket()
  * 3. 모든 Stream과 Session이 상속받은 Module->Process()를 주기적으로 호출
  *
  */
-void Application::WorkerThread()
+void Application::Worker::WorkerThread()
 {
+	std::vector<std::unique_ptr<VideoStreamData>> video_batch;
+	std::vector<std::unique_ptr<AudioStreamData>> audio_batch;
+	std::vector<std::unique_ptr<IncomingPacket>> packet_batch;
+
+	video_batch.reserve(APPLICATION_WORKER_BATCH_SIZE);
+	audio_batch.reserve(APPLICATION_WORKER_BATCH_SIZE);
+	packet_batch.reserve(APPLICATION_WORKER_BATCH_SIZE);
+
 	while(!_stop_thread_flag)
 	{
 		// Queue에 이벤트가 들어올때까지 무한 대기 한다.
 		// TODO: 향후 App 재시작 등의 기능을 위해 WaitFor(time) 기능을 구현한다.
 		_queue_event.Wait();
 
-		// Queue에 입력된 데이터를 처리한다.
-
-		// Check video data is available
-		std::unique_ptr<Application::VideoStreamData> video_data = PopVideoStreamData();
-
-		if((video_data != nullptr) && (video_data->_stream_info != nullptr) && (video_data->_track != nullptr))
-		{
-			OV_ASSERT2(video_data->_encoded_frame != nullptr);
-
-			SendVideoFrame(video_data->_stream_info,
-			               video_data->_track,
-			               std::move(video_data->_encoded_frame),
-			               std::move(video_data->_codec_info),
-			               std::move(video_data->_framgmentation_header));
-		}
-
-		// Check audio data is available
-		std::unique_ptr<Application::AudioStreamData> audio_data = PopAudioStreamData();
-
-		if((audio_data != nullptr) && (audio_data->_stream_info != nullptr) && (audio_data->_track != nullptr))
-		{
-			OV_ASSERT2(audio_data->_encoded_frame != nullptr);
-
-			SendAudioFrame(audio_data->_stream_info,
-			               audio_data->_track,
-			               std::move(audio_data->_encoded_frame),
-			               std::move(audio_data->_codec_info),
-			               std::move(audio_data->_framgmentation_header));
-		}
+		// Drain the queues in batches until they are empty.
+		// (The producers notify the event only when a queue becomes non-empty)
+		bool processed = true;
 
-		// Check incoming packet is available
-		std::unique_ptr<IncomingPacket> packet = PopIncomingPacket();
-		if(packet)
+		while(processed && (_stop_thread_flag == false))
 		{
-			OnPacketReceived(packet->_session_info, packet->_data);
+			processed = false;
+
+			// Check video data is available
+			if(PopBatch(_video_stream_queue.queue, _video_stream_queue.guard, video_batch))
+			{
+				processed = true;
+				_video_stream_queue.space.notify_all();
+
+				for(auto &video_data : video_batch)
+				{
+					if((video_data->_stream_info == nullptr) || (video_data->_track == nullptr))
+					{
+						continue;
+					}
+
+					OV_ASSERT2(video_data->_frame != nullptr);
+
+					_application->RecordQueueLatency(video_data->_stream_info, video_data->_queued_time);
+
+					OV_TRACE_FLOW(video_data->_trace_id);
+					OV_TRACE_SCOPE("publisher", "SendVideoFrame");
+
+					_application->SendVideoFrame(video_data->_stream_info,
+					                             video_data->_track,
+					                             std::move(video_data->_frame));
+				}
+			}
+
+			// Check audio data is available
+			if(PopBatch(_audio_stream_queue.queue, _audio_stream_queue.guard, audio_batch))
+			{
+				processed = true;
+				_audio_stream_queue.space.notify_all();
+
+				for(auto &audio_data : audio_batch)
+				{
+					if((audio_data->_stream_info == nullptr) || (audio_data->_track == nullptr))
+					{
+						continue;
+					}
+
+					OV_ASSERT2(audio_data->_frame != nullptr);
+
+					_application->RecordQueueLatency(audio_data->_stream_info, audio_data->_queued_time);
+
+					OV_TRACE_FLOW(audio_data->_trace_id);
+					OV_TRACE_SCOPE("publisher", "SendAudioFrame");
+
+					_application->SendAudioFrame(audio_data->_stream_info,
+					                             audio_data->_track,
+					                             std::move(audio_data->_frame));
+				}
+			}
+
+			// Check incoming packet is available
+			if(PopBatch(_incoming_packet_queue, _incoming_packet_queue_guard, packet_batch))
+			{
+				processed = true;
+
+				for(auto &packet : packet_batch)
+				{
+					_application->OnPacketReceived(packet->_session_info, packet->_data);
+				}
+			}
 		}
 
-		//TODO: Queue에 입력된 Audio Sample을 처리한다.
 		//TODO: ApplicationModule을 호출한다.
 	}
 }
 
+void Application::RecordQueueLatency(const std::shared_ptr<StreamInfo> &info, int64_t queued_time)
+{
+	auto stream = GetStream(info->GetId());
+
+	if((stream != nullptr) && (stream->GetLatencyStatistics() != nullptr))
+	{
+		stream->GetLatencyStatistics()->Record(StreamLatencyStage::PublisherQueue, ov::LatencyHistogram::GetCurrentMicroseconds() - queued_time);
+	}
+}
 
 void Application::SendVideoFrame(std::shared_ptr<StreamInfo> info,
                                  std::shared_ptr<MediaTrack> track,
-                                 std::unique_ptr<EncodedFrame> encoded_frame,
-                                 std::unique_ptr<CodecSpecificInfo> codec_info,
-                                 std::unique_ptr<FragmentationHeader> fragmentation)
+                                 std::unique_ptr<EncodedFrameDescriptor> frame)
 {
 	// Stream에 Packet을 전송한다.
 	auto stream = GetStream(info->GetId());
@@ -281,17 +657,12 @@ void Application::SendVideoFrame(std::shared_ptr<StreamInfo> info,
 		return;
 	}
 
-	stream->SendVideoFrame(track,
-	                       std::move(encoded_frame),
-	                       std::move(codec_info),
-	                       std::move(fragmentation));
+	stream->SendVideoFrame(track, std::move(frame));
 }
 
 void Application::SendAudioFrame(std::shared_ptr<StreamInfo> info,
                                  std::shared_ptr<MediaTrack> track,
-                                 std::unique_ptr<EncodedFrame> encoded_frame,
-                                 std::unique_ptr<CodecSpecificInfo> codec_info,
-                                 std::unique_ptr<FragmentationHeader> fragmentation)
+                                 std::unique_ptr<EncodedFrameDescriptor> frame)
 {
 	// Stream에 Packet을 전송한다.
 	auto stream = GetStream(info->GetId());
@@ -301,10 +672,7 @@ void Application::SendAudioFrame(std::shared_ptr<StreamInfo> info,
 		return;
 	}
 
-	stream->SendAudioFrame(track,
-	                       std::move(encoded_frame),
-	                       std::move(codec_info),
-	                       std::move(fragmentation));
+	stream->SendAudioFrame(track, std::move(frame));
 }
 
 void Application::OnPacketReceived(std::shared_ptr<SessionInfo> session_info, std::shared_ptr<const ov::Data> data)
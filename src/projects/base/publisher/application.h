@@ -1,14 +1,21 @@
 #pragma once
 
+#include <set>
 #include <utility>
+#include <mutex>
 #include "base/common_types.h"
 #include "base/ovlibrary/string.h"
-#include "base/ovlibrary/semaphore.h"
+#include "base/ovlibrary/queue_event.h"
 #include "config/config.h"
 #include "base/application/stream_info.h"
 #include "base/media_route/media_route_application_observer.h"
 #include "stream.h"
 
+// Maximum number of items taken from each queue per lock
+#define APPLICATION_WORKER_BATCH_SIZE       32
+// OnFrameQueueOverflow() logs every APPLICATION_QUEUE_DROP_LOG_INTERVAL drops
+#define APPLICATION_QUEUE_DROP_LOG_INTERVAL 100
+
 enum ApplicationState
 {
 	Idle,
@@ -17,6 +24,18 @@ enum ApplicationState
 	Error
 };
 
+// Frame queues between the router and the workers of an application (sum of the workers)
+struct ApplicationQueueStatistics
+{
+	size_t video_size = 0;
+	size_t audio_size = 0;
+	// The largest size of a queue of a worker
+	size_t video_high_water_mark = 0;
+	size_t audio_high_water_mark = 0;
+	uint64_t video_drop_count = 0;
+	uint64_t audio_drop_count = 0;
+};
+
 class Application : public info::Application, public MediaRouteApplicationObserver
 {
 public:
@@ -27,15 +46,11 @@ public:
 	// Queue에 데이터를 넣는다.
 	bool OnSendVideoFrame(std::shared_ptr<StreamInfo> stream_info,
 	                      std::shared_ptr<MediaTrack> track,
-	                      std::unique_ptr<EncodedFrame> encoded_frame,
-	                      std::unique_ptr<CodecSpecificInfo> codec_info,
-	                      std::unique_ptr<FragmentationHeader> fragmentation) override;
+	                      std::unique_ptr<EncodedFrameDescriptor> frame) override;
 
 	bool OnSendAudioFrame(std::shared_ptr<StreamInfo> stream_info,
 	                      std::shared_ptr<MediaTrack> track,
-	                      std::unique_ptr<EncodedFrame> encoded_frame,
-	                      std::unique_ptr<CodecSpecificInfo> codec_info,
-	                      std::unique_ptr<FragmentationHeader> fragmentation) override;
+	                      std::unique_ptr<EncodedFrameDescriptor> frame) override;
 
 	// 수신된 Network Packet을 Application에 넣고 처리를 기다린다.
 	bool PushIncomingPacket(std::shared_ptr<SessionInfo> session_info,
@@ -43,6 +58,14 @@ public:
 
 	std::shared_ptr<Stream> GetStream(uint32_t stream_id);
 	std::shared_ptr<Stream> GetStream(ov::String stream_name);
+	std::vector<std::shared_ptr<Stream>> GetStreamList();
+
+	// The transcoder outputs of the same input (renditions of the master playlist)
+	// - stream_name: name of the input, or one of the outputs
+	// - The stream itself if it is not a transcoder output
+	std::vector<std::shared_ptr<Stream>> GetRenditionStreams(const ov::String &stream_name);
+
+	ApplicationQueueStatistics GetQueueStatistics();
 
 protected:
 	explicit Application(const info::Application *application_info);
@@ -51,28 +74,33 @@ protected:
 	virtual bool Start();
 	virtual bool Stop();
 
+	// Bounds the frame queues of the workers (<Publishers><XXX><Queue>), must be called before Start()
+	void SetQueueConfig(const cfg::PublisherQueue &queue_config);
+
+	// Called by the router thread when the frames are dropped (or the router is blocked) by the queue policy
+	// - It must not block, the default implementation logs the drops
+	virtual void OnFrameQueueOverflow(const std::shared_ptr<StreamInfo> &stream_info, common::MediaType media_type, size_t queue_size, size_t drop_count);
+
 	// Stream에 VideoFrame을 전송한다.
 	// virtual로 Child에서 원하면 다른 작업을 할 수 있게 한다.
 	virtual void SendVideoFrame(std::shared_ptr<StreamInfo> info,
 	                            std::shared_ptr<MediaTrack> track,
-	                            std::unique_ptr<EncodedFrame> encoded_frame,
-	                            std::unique_ptr<CodecSpecificInfo> codec_info,
-	                            std::unique_ptr<FragmentationHeader> fragmentation);
+	                            std::unique_ptr<EncodedFrameDescriptor> frame);
 
 	virtual void SendAudioFrame(std::shared_ptr<StreamInfo> info,
 	                            std::shared_ptr<MediaTrack> track,
-	                            std::unique_ptr<EncodedFrame> encoded_frame,
-	                            std::unique_ptr<CodecSpecificInfo> codec_info,
-	                            std::unique_ptr<FragmentationHeader> fragmentation);
+	                            std::unique_ptr<EncodedFrameDescriptor> frame);
 
 	virtual void OnPacketReceived(std::shared_ptr<SessionInfo> session_info, std::shared_ptr<const ov::Data> data);
 
 	std::map<uint32_t, std::shared_ptr<Stream>> _streams;
 
 private:
-	void WorkerThread();
 	// For child, 실제 구현부는 자식에서 처리한다.
 
+	// Records the PublisherQueue latency of the stream (queued_time: see VideoStreamData::_queued_time)
+	void RecordQueueLatency(const std::shared_ptr<StreamInfo> &info, int64_t queued_time);
+
 	// Stream을 자식을 통해 생성해서 받는다.
 	virtual std::shared_ptr<Stream> CreateStream(std::shared_ptr<StreamInfo> info, uint32_t thread_count) = 0;
 	virtual bool DeleteStream(std::shared_ptr<StreamInfo> info) = 0;
@@ -87,48 +115,46 @@ private:
 	public:
 		VideoStreamData(std::shared_ptr<StreamInfo> stream_info,
 		                std::shared_ptr<MediaTrack> track,
-		                std::unique_ptr<EncodedFrame> encoded_frame,
-		                std::unique_ptr<CodecSpecificInfo> codec_info,
-		                std::unique_ptr<FragmentationHeader> fragmentation)
+		                std::unique_ptr<EncodedFrameDescriptor> frame)
 		{
 			_stream_info = std::move(stream_info);
 			_track = std::move(track);
-			_encoded_frame = std::move(encoded_frame);
-			_codec_info = std::move(codec_info);
-			_framgmentation_header = std::move(fragmentation);
+			_frame = std::move(frame);
+			_queued_time = ov::LatencyHistogram::GetCurrentMicroseconds();
+			// Queued by the router while it dispatches the packet
+			_trace_id = ov::Tracer::GetCurrentFlowId();
 		}
 
 		std::shared_ptr<StreamInfo> _stream_info;
 		std::shared_ptr<MediaTrack> _track;
-		std::unique_ptr<EncodedFrame> _encoded_frame;
-		std::unique_ptr<CodecSpecificInfo> _codec_info;
-		std::unique_ptr<FragmentationHeader> _framgmentation_header;
+		std::unique_ptr<EncodedFrameDescriptor> _frame;
+		// Monotonic time when it is queued (for the PublisherQueue latency)
+		int64_t _queued_time;
+		uint64_t _trace_id;
 	};
-	std::unique_ptr<Application::VideoStreamData> PopVideoStreamData();
 
 	class AudioStreamData
 	{
 	public:
 		AudioStreamData(std::shared_ptr<StreamInfo> stream_info,
 		                std::shared_ptr<MediaTrack> track,
-		                std::unique_ptr<EncodedFrame> encoded_frame,
-		                std::unique_ptr<CodecSpecificInfo> codec_info,
-		                std::unique_ptr<FragmentationHeader> fragmentation)
+		                std::unique_ptr<EncodedFrameDescriptor> frame)
 		{
 			_stream_info = std::move(stream_info);
 			_track = std::move(track);
-			_encoded_frame = std::move(encoded_frame);
-			_codec_info = std::move(codec_info);
-			_framgmentation_header = std::move(fragmentation);
+			_frame = std::move(frame);
+			_queued_time = ov::LatencyHistogram::GetCurrentMicroseconds();
+			// Queued by the router while it dispatches the packet
+			_trace_id = ov::Tracer::GetCurrentFlowId();
 		}
 
 		std::shared_ptr<StreamInfo> _stream_info;
 		std::shared_ptr<MediaTrack> _track;
-		std::unique_ptr<EncodedFrame> _encoded_frame;
-		std::unique_ptr<CodecSpecificInfo> _codec_info;
-		std::unique_ptr<FragmentationHeader> _framgmentation_header;
+		std::unique_ptr<EncodedFrameDescriptor> _frame;
+		// Monotonic time when it is queued (for the PublisherQueue latency)
+		int64_t _queued_time;
+		uint64_t _trace_id;
 	};
-	std::unique_ptr<Application::AudioStreamData> PopAudioStreamData();
 
 	class IncomingPacket
 	{
@@ -142,21 +168,84 @@ private:
 		std::shared_ptr<SessionInfo> _session_info;
 		std::shared_ptr<const ov::Data> _data;
 	};
-	std::unique_ptr<Application::IncomingPacket> PopIncomingPacket();
 
-	bool _stop_thread_flag;
-	std::thread _worker_thread;
-	ov::Semaphore _queue_event;
+	// Streams are distributed to the workers by stream id, so all frames and packets of a stream are processed
+	// in order by the same thread while different streams can be processed in parallel.
+	class Worker
+	{
+	public:
+		explicit Worker(Application *application);
+		~Worker();
+
+		bool Start();
+		bool Stop();
+
+		bool PushVideoStreamData(std::unique_ptr<VideoStreamData> data);
+		bool PushAudioStreamData(std::unique_ptr<AudioStreamData> data);
+		void PushIncomingPacket(std::unique_ptr<IncomingPacket> packet);
 
-	std::queue<std::unique_ptr<VideoStreamData>> _video_stream_queue;
-	std::mutex _video_stream_queue_guard;
+		void GetQueueStatistics(ApplicationQueueStatistics &statistics);
+
+	private:
+		template<typename T>
+		struct FrameQueue
+		{
+			explicit FrameQueue(const char *guard_name)
+				: guard(guard_name)
+			{
+			}
+
+			std::queue<std::unique_ptr<T>> queue;
+			ov::ProfiledMutex guard;
+			// Used by PublisherQueuePolicy::Block
+			std::condition_variable_any space;
+			size_t high_water_mark = 0;
+			uint64_t drop_count = 0;
+		};
+
+		template<typename T>
+		void Push(std::queue<std::unique_ptr<T>> &queue, ov::ProfiledMutex &guard, std::unique_ptr<T> item);
+
+		// Applies the queue policy of the application, returns false if the item is dropped
+		template<typename T>
+		bool PushFrame(FrameQueue<T> &frame_queue, std::unique_ptr<T> item, common::MediaType media_type);
+
+		// Moves at most APPLICATION_WORKER_BATCH_SIZE items from the queue to the batch with a single lock
+		template<typename T>
+		bool PopBatch(std::queue<std::unique_ptr<T>> &queue, ov::ProfiledMutex &guard, std::vector<std::unique_ptr<T>> &batch);
+
+		void WorkerThread();
+
+		Application *_application;
+
+		bool _stop_thread_flag;
+		std::thread _worker_thread;
+		ov::QueueEvent _queue_event;
+
+		FrameQueue<VideoStreamData> _video_stream_queue { "Application::Worker::_video_stream_queue" };
+		FrameQueue<AudioStreamData> _audio_stream_queue { "Application::Worker::_audio_stream_queue" };
+
+		// Streams whose video frames are dropped until the next key frame (PublisherQueuePolicy::DropToKeyFrame, guarded by _video_stream_queue.guard)
+		std::set<uint32_t> _waiting_key_frame_streams;
+
+		std::queue<std::unique_ptr<IncomingPacket>> _incoming_packet_queue;
+		ov::ProfiledMutex _incoming_packet_queue_guard { "Application::Worker::_incoming_packet_queue_guard" };
+	};
 
-	std::queue<std::unique_ptr<AudioStreamData>> _audio_stream_queue;
-	std::mutex _audio_stream_queue_guard;
+	// Starts the workers if they are not started (called before the first stream is created)
+	bool StartWorkers();
 
-	std::queue<std::unique_ptr<IncomingPacket>> _incoming_packet_queue;
-	std::mutex _incoming_packet_queue_guard;
+	// nullptr if the workers are not started (or have been stopped by Stop(), e.g. the config is reloaded)
+	// - The caller keeps the worker alive while it pushes, Stop() may clear _workers at the same time
+	std::shared_ptr<Worker> GetWorkerByStreamId(uint32_t stream_id);
 
-	//std::queue<std::unique_ptr<AudioStreamData>>	_audio_stream_queue;
+	// Guarded by _worker_mutex
+	std::vector<std::shared_ptr<Worker>> _workers;
+	std::atomic<bool> _workers_started { false };
+	std::mutex _worker_mutex;
 
+	// 0: unlimited
+	size_t _queue_max_size = 0;
+	cfg::PublisherQueuePolicy _queue_policy = cfg::PublisherQueuePolicy::DropOldest;
+	std::atomic<uint64_t> _overflow_count { 0 };
 };
@@ -88,3 +88,107 @@ std::shared_ptr<Stream> Publisher::GetStream(info::application_id_t application_
 	return nullptr;
 }
 
+bool Publisher::GetStreamWorkerLoadData(std::vector<std::shared_ptr<StreamWorkerLoadData>> &loads)
+{
+	std::vector<StreamWorkerLoad> worker_loads;
+
+	for(auto const &x : _applications)
+	{
+		auto application = x.second;
+
+		for(auto const &stream : application->GetStreamList())
+		{
+			worker_loads.clear();
+			stream->GetWorkerLoads(worker_loads);
+
+			for(auto const &worker_load : worker_loads)
+			{
+				auto load_data = std::make_shared<StreamWorkerLoadData>();
+
+				load_data->app_name = application->GetName();
+				load_data->stream_name = stream->GetName();
+				load_data->load = worker_load;
+
+				loads.push_back(load_data);
+			}
+		}
+	}
+
+	return true;
+}
+
+bool Publisher::GetMetricsData(std::vector<std::shared_ptr<PublisherApplicationMetricsData>> &applications,
+                               std::vector<std::shared_ptr<PublisherStreamMetricsData>> &streams)
+{
+	for(auto const &x : _applications)
+	{
+		auto application = x.second;
+
+		auto application_data = std::make_shared<PublisherApplicationMetricsData>();
+
+		application_data->app_name = application->GetName();
+		application_data->queue = application->GetQueueStatistics();
+
+		applications.push_back(application_data);
+
+		for(auto const &stream : application->GetStreamList())
+		{
+			auto stream_data = std::make_shared<PublisherStreamMetricsData>();
+
+			stream_data->app_name = application->GetName();
+			stream_data->stream_name = stream->GetName();
+			stream_data->metrics = stream->GetMetrics();
+
+			streams.push_back(stream_data);
+		}
+	}
+
+	return true;
+}
+
+bool Publisher::GetMemoryData(std::vector<std::shared_ptr<PublisherStreamMemoryData>> &streams)
+{
+	for(auto const &x : _applications)
+	{
+		auto application = x.second;
+
+		for(auto const &stream : application->GetStreamList())
+		{
+			auto stream_data = std::make_shared<PublisherStreamMemoryData>();
+			auto metrics = stream->GetMetrics();
+
+			stream_data->app_name = application->GetName();
+			stream_data->stream_name = stream->GetName();
+			stream_data->queue_bytes = metrics.queue_bytes;
+			stream_data->gop_cache_bytes = metrics.gop_cache_bytes;
+			stream_data->store_bytes = stream->GetStoreMemoryUsage();
+			stream->GetSessionMemoryUsage(stream_data->sessions);
+
+			streams.push_back(stream_data);
+		}
+	}
+
+	return true;
+}
+
+const char *Publisher::GetPublisherName()
+{
+	switch(GetPublisherType())
+	{
+		case cfg::PublisherType::Webrtc:
+			return "webrtc";
+		case cfg::PublisherType::Rtmp:
+			return "rtmp";
+		case cfg::PublisherType::Hls:
+			return "hls";
+		case cfg::PublisherType::Dash:
+			return "dash";
+		case cfg::PublisherType::Record:
+			return "record";
+		case cfg::PublisherType::Mpegts:
+			return "mpegts";
+		case cfg::PublisherType::Unknown:
+		default:
+			return "unknown";
+	}
+}
@@ -74,6 +74,43 @@ struct MonitoringCollectionData
     std::chrono::system_clock::time_point check_time ; // (chrono)
 };
 
+// Load of a stream worker (for monitoring)
+struct StreamWorkerLoadData
+{
+    ov::String app_name;
+    ov::String stream_name;
+    StreamWorkerLoad load;
+};
+
+// Counters of a stream of a publisher (for monitoring)
+struct PublisherStreamMetricsData
+{
+    ov::String app_name;
+    ov::String stream_name;
+    StreamMetrics metrics;
+};
+
+// Frame queues of an application of a publisher (for monitoring)
+struct PublisherApplicationMetricsData
+{
+    ov::String app_name;
+    ApplicationQueueStatistics queue;
+};
+
+// Memory of a stream of a publisher (for monitoring)
+struct PublisherStreamMemoryData
+{
+    ov::String app_name;
+    ov::String stream_name;
+    // Packets in the queues of the stream workers
+    size_t queue_bytes = 0;
+    size_t gop_cache_bytes = 0;
+    // Segments/chunks kept by the stream (HLS/DASH)
+    size_t store_bytes = 0;
+    // <session id, bytes>
+    std::vector<std::pair<session_id_t, size_t>> sessions;
+};
+
 // WebRTC, HLS, MPEG-DASH 등 모든 Publisher는 다음 Interface를 구현하여 MediaRouterInterface에 자신을 등록한다.
 class Publisher
 {
@@ -92,6 +129,19 @@ public:
 	// - collected_datas vector must be insert processed
 	virtual bool GetMonitoringCollectionData(std::vector<std::shared_ptr<MonitoringCollectionData>> &collections) = 0;
 
+	// Collects the load of the stream workers of all streams
+	bool GetStreamWorkerLoadData(std::vector<std::shared_ptr<StreamWorkerLoadData>> &loads);
+
+	// Collects the counters of all applications and streams (the sessions are not visited)
+	bool GetMetricsData(std::vector<std::shared_ptr<PublisherApplicationMetricsData>> &applications,
+	                    std::vector<std::shared_ptr<PublisherStreamMetricsData>> &streams);
+
+	// Collects the memory of all streams and sessions
+	bool GetMemoryData(std::vector<std::shared_ptr<PublisherStreamMemoryData>> &streams);
+
+	// Name of the publisher type (e.g. "webrtc"), used as the label of the metrics
+	const char *GetPublisherName();
+
 protected:
 	explicit Publisher(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
 	virtual ~Publisher() = default;
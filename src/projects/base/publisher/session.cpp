@@ -47,6 +47,18 @@ bool Session::Stop()
 	return true;
 }
 
+bool Session::SendOutgoingData(const std::vector<std::shared_ptr<StreamPacket>> &packets)
+{
+	bool result = true;
+
+	for(auto &packet : packets)
+	{
+		result = SendOutgoingData(packet->_type, packet->_data) && result;
+	}
+
+	return result;
+}
+
 Session::SessionState Session::GetState()
 {
 	return _state;
@@ -12,6 +12,44 @@
 class Application;
 class Stream;
 
+// Order of the packets in StreamWorker
+enum class StreamPacketPriority : uint8_t
+{
+	// Sent before the other packets (audio, control)
+	High,
+	// Sent in order, never dropped
+	Normal,
+	// Sent in order with the Normal packets, but dropped when it is stale (until the next sync point)
+	Video,
+};
+
+class StreamPacket
+{
+public:
+	StreamPacket(uint32_t type, const std::shared_ptr<const ov::Data> &data,
+	             StreamPacketPriority priority = StreamPacketPriority::Normal, bool is_sync_point = false)
+	{
+		_type = type;
+		// The payload is immutable and shared by all workers and sessions (no copy)
+		_data = data;
+		_priority = priority;
+		_is_sync_point = is_sync_point;
+	}
+
+	uint32_t                        _type;
+	std::shared_ptr<const ov::Data> _data;
+
+	StreamPacketPriority            _priority;
+	// The decoding can restart from this packet (the first packet of a key frame)
+	bool                            _is_sync_point;
+	// ms (monotonic) when the packet is queued to the worker
+	int64_t                         _queued_time = 0;
+	// The previous packets of the stream are dropped by the worker (the session must not leave the gap of the sequence)
+	bool                            _discontinuity = false;
+	// Flow of ov::Tracer (the frame which is packetized into the packet)
+	uint64_t                        _trace_id = 0;
+};
+
 class Session : public SessionInfo
 {
 public:
@@ -26,7 +64,38 @@ public:
 	virtual bool Stop();
 
 	// 패킷을 전송한다.
-	virtual bool SendOutgoingData(uint32_t packet_type, std::shared_ptr<ov::Data> packet) = 0;
+	// packet is shared by all sessions of the stream, so it must not be modified
+	virtual bool SendOutgoingData(uint32_t packet_type, const std::shared_ptr<const ov::Data> &packet) = 0;
+	// 여러개의 패킷을 한번에 전송한다. 기본 구현은 SendOutgoingData()를 반복 호출한다.
+	virtual bool SendOutgoingData(const std::vector<std::shared_ptr<StreamPacket>> &packets);
+	// Sends the packets held by the pacer of the session (called by the timer wheel of StreamWorker).
+	// Returns the delay (ms) to be called again, -1 if no packet is held (the session doesn't pace)
+	virtual int64_t ProcessPacing()
+	{
+		return -1;
+	}
+	// Sends the periodic reports of the session (e.g. RTCP SR), called by the report timer of StreamWorker
+	// for all sessions of the worker at once (current_time: ms, monotonic, aligned to STREAM_WORKER_REPORT_INTERVAL).
+	// Returns false if the session doesn't send the reports
+	virtual bool SendReport(int64_t current_time)
+	{
+		return false;
+	}
+	// Limit of the bitrate of the session by the quota of the application (bps, 0: unlimited),
+	// called by the report timer of StreamWorker before SendReport()
+	virtual void SetEgressBitrateLimit(uint64_t bitrate)
+	{
+	}
+	// Bytes of the buffers which the session owns (the packets shared with the stream are not counted)
+	virtual size_t GetMemoryUsage()
+	{
+		return 0;
+	}
+	// false while the session cannot deliver the packets to the peer (e.g. the handshake is not finished)
+	virtual bool IsReadyToSend()
+	{
+		return true;
+	}
 	// 상위 Layer에서 Packet을 수신받는다.
 	virtual void OnPacketReceived(std::shared_ptr<SessionInfo> session_info, std::shared_ptr<const ov::Data> data) = 0;
 
@@ -39,6 +39,18 @@ SessionNodeType SessionNode::GetNodeType()
 }
 
 
+bool SessionNode::SendDataBatch(SessionNodeType from_node, const std::vector<std::shared_ptr<ov::Data>> &data_list)
+{
+	bool result = true;
+
+	for(auto &data : data_list)
+	{
+		result = SendData(from_node, data) && result;
+	}
+
+	return result;
+}
+
 bool SessionNode::Start()
 {
 	_state = NodeState::Started;
@@ -54,6 +54,8 @@ public:
 
 	// 데이터를 upper에서 받는다. lower node로 보낸다.
 	virtual bool SendData(SessionNodeType from_node, const std::shared_ptr<ov::Data> &data) = 0;
+	// 여러개의 데이터를 한번에 upper에서 받는다. 기본 구현은 SendData()를 반복 호출한다.
+	virtual bool SendDataBatch(SessionNodeType from_node, const std::vector<std::shared_ptr<ov::Data>> &data_list);
 	// 데이터를 lower에서 받는다. upper node로 보낸다.
 	virtual bool OnDataReceived(SessionNodeType from_node, const std::shared_ptr<const ov::Data> &data) = 0;
 
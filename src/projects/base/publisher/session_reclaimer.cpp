@@ -0,0 +1,125 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "publisher_private.h"
+#include "session_reclaimer.h"
+
+SessionReclaimer::~SessionReclaimer()
+{
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		_stop = true;
+		_condition.notify_all();
+	}
+
+	if(_thread.joinable())
+	{
+		_thread.join();
+	}
+
+	// Retired after the thread is finished
+	Reclaim(_retired_sessions);
+}
+
+void SessionReclaimer::Retire(const std::shared_ptr<Session> &session)
+{
+	if(session == nullptr)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	StartThread();
+
+	_retired_sessions.push_back(session);
+	_condition.notify_one();
+}
+
+void SessionReclaimer::Retire(std::vector<std::shared_ptr<Session>> &&sessions)
+{
+	if(sessions.empty())
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	StartThread();
+
+	if(_retired_sessions.empty())
+	{
+		_retired_sessions = std::move(sessions);
+	}
+	else
+	{
+		_retired_sessions.insert(_retired_sessions.end(), std::make_move_iterator(sessions.begin()), std::make_move_iterator(sessions.end()));
+	}
+
+	sessions.clear();
+	_condition.notify_one();
+}
+
+size_t SessionReclaimer::GetPendingCount() const
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	return _retired_sessions.size();
+}
+
+void SessionReclaimer::StartThread()
+{
+	if(_started == false)
+	{
+		_started = true;
+		_thread = std::thread(&SessionReclaimer::ThreadProc, this);
+	}
+}
+
+void SessionReclaimer::ThreadProc()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	std::vector<std::shared_ptr<Session>> sessions;
+
+	while(true)
+	{
+		_condition.wait(lock, [this]() -> bool {
+			return _stop || (_retired_sessions.empty() == false);
+		});
+
+		if(_stop)
+		{
+			break;
+		}
+
+		sessions.swap(_retired_sessions);
+
+		// The sessions are stopped without the lock, so the workers can retire more sessions meanwhile
+		lock.unlock();
+		Reclaim(sessions);
+		lock.lock();
+	}
+}
+
+void SessionReclaimer::Reclaim(std::vector<std::shared_ptr<Session>> &sessions)
+{
+	if(sessions.empty())
+	{
+		return;
+	}
+
+	logtd("Reclaiming %zu sessions...", sessions.size());
+
+	for(auto &session : sessions)
+	{
+		session->Stop();
+	}
+
+	// The sessions are destructed here unless the others still refer them
+	sessions.clear();
+}
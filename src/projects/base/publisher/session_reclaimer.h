@@ -0,0 +1,54 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "session.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Stops and releases the sessions removed from the streams on its own thread
+//
+// - Stopping a session closes its SRTP/DTLS contexts and frees its packetizer state, so when thousands of sessions
+//   are removed at once (e.g. the stream ends), doing it on the stream workers stalls the delivery of the other streams
+// - A session must be retired after it is removed from the snapshot of its StreamWorker:
+//   StreamWorker::RemoveSession() waits until the worker doesn't use the previous snapshot, so no worker refers to a retired session
+// - The sessions retired until the thread wakes up are reclaimed together as one batch
+class SessionReclaimer : public ov::Singleton<SessionReclaimer>
+{
+public:
+	friend class ov::Singleton<SessionReclaimer>;
+
+	// The sessions which are not reclaimed yet are stopped before returning
+	~SessionReclaimer() override;
+
+	void Retire(const std::shared_ptr<Session> &session);
+	void Retire(std::vector<std::shared_ptr<Session>> &&sessions);
+
+	// Number of the sessions which are retired but not reclaimed yet
+	size_t GetPendingCount() const;
+
+protected:
+	SessionReclaimer() = default;
+
+	// _mutex must be locked
+	void StartThread();
+	void ThreadProc();
+	static void Reclaim(std::vector<std::shared_ptr<Session>> &sessions);
+
+	mutable std::mutex _mutex;
+	std::condition_variable _condition;
+
+	std::vector<std::shared_ptr<Session>> _retired_sessions;
+
+	bool _started = false;
+	bool _stop = false;
+	std::thread _thread;
+};
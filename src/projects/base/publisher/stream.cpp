@@ -1,226 +1,1181 @@
 #include "publisher_private.h"
 #include "stream.h"
+#include "session_reclaimer.h"
+#include "stream_worker_pool.h"
+
+#include <base/application/stream_demand.h>
+
+#include <algorithm>
+#include <chrono>
 
 StreamWorker::StreamWorker()
+	: _session_snapshot(std::make_shared<const StreamWorkerSessions>()),
+	  _timer_wheel(GetCurrentMilliseconds())
+{
+	_run_packets.reserve(STREAM_WORKER_BATCH_SIZE);
+}
+
+StreamWorker::~StreamWorker()
+{
+	Stop();
+}
+
+bool StreamWorker::Start()
+{
+	// The worker is run by StreamWorkerPool when the packets are queued
+	_stop_flag = false;
+
+	return true;
+}
+
+bool StreamWorker::Stop()
+{
+	if(_stop_flag.exchange(true))
+	{
+		return true;
+	}
+
+	{
+		// The pool doesn't run the worker after this (it may still be queued)
+		std::unique_lock<std::mutex> run_lock(_run_guard);
+	}
+
+	std::vector<std::shared_ptr<Session>> sessions;
+
+	{
+		std::unique_lock<ov::ProfiledMutex> lock(_session_map_guard);
+
+		auto snapshot = std::atomic_load(&_session_snapshot);
+
+		sessions.reserve(snapshot->size());
+
+		for(auto const &item : *snapshot)
+		{
+			sessions.push_back(item.session);
+		}
+
+		PublishSessions(std::make_shared<const StreamWorkerSessions>());
+	}
+
+	// The worker is not run anymore
+	_worker_sessions.reset();
+	_paced_sessions.clear();
+	_gop_cache.clear();
+	_gop_cache_valid = false;
+	_gop_cache_packet_count = 0;
+	_gop_cache_bytes = 0;
+
+	// The sessions are stopped by the reclaimer, so a large stream doesn't block the caller
+	SessionReclaimer::Instance()->Retire(std::move(sessions));
+
+	return true;
+}
+
+bool StreamWorker::AddSession(std::shared_ptr<Session> session, bool replay_gop)
+{
+	StreamWorkerSession new_item;
+
+	new_item.id = session->GetId();
+	new_item.session = session;
+
+	if(replay_gop)
+	{
+		new_item.gop_replay = std::make_shared<bool>(true);
+	}
+
+	std::unique_lock<ov::ProfiledMutex> lock(_session_map_guard);
+
+	auto sessions = std::make_shared<StreamWorkerSessions>(*std::atomic_load(&_session_snapshot));
+
+	// Session ids are increasing, so the new session is usually appended
+	auto position = std::lower_bound(sessions->begin(), sessions->end(), new_item.id,
+	                                 [](const StreamWorkerSession &item, session_id_t id) { return item.id < id; });
+
+	if((position != sessions->end()) && (position->id == new_item.id))
+	{
+		*position = std::move(new_item);
+	}
+	else
+	{
+		sessions->insert(position, std::move(new_item));
+	}
+
+	PublishSessions(std::move(sessions));
+
+	return true;
+}
+
+bool StreamWorker::RemoveSession(session_id_t id)
+{
+	// 해당 Session ID를 가진 StreamWorker를 찾아서 삭제한다.
+	std::shared_ptr<Session> session;
+
+	{
+		std::unique_lock<ov::ProfiledMutex> lock(_session_map_guard);
+
+		auto snapshot = std::atomic_load(&_session_snapshot);
+		auto item = FindSession(*snapshot, id);
+
+		if(item == nullptr)
+		{
+			logte("Cannot find session : %u", id);
+			return false;
+		}
+
+		session = item->session;
+
+		// Session에 더이상 패킷을 전달하지 않는 것이 먼저다.
+		auto sessions = std::make_shared<StreamWorkerSessions>();
+
+		sessions->reserve(snapshot->size() - 1);
+		std::copy_if(snapshot->begin(), snapshot->end(), std::back_inserter(*sessions),
+		             [id](const StreamWorkerSession &item) { return item.id != id; });
+
+		PublishSessions(std::move(sessions));
+	}
+
+	// The worker may be sending the current batch to the session with the previous snapshot
+	WaitForSnapshotRelease();
+
+	// Session 동작을 중지한다. (off the worker thread, without the lock)
+	SessionReclaimer::Instance()->Retire(session);
+
+	return true;
+}
+
+size_t StreamWorker::RemoveSessions(const std::vector<session_id_t> &ids)
+{
+	std::vector<std::shared_ptr<Session>> sessions;
+
+	sessions.reserve(ids.size());
+
+	{
+		std::unique_lock<ov::ProfiledMutex> lock(_session_map_guard);
+
+		auto snapshot = std::atomic_load(&_session_snapshot);
+		std::set<session_id_t> removed_ids;
+
+		for(auto id : ids)
+		{
+			auto item = FindSession(*snapshot, id);
+
+			if(item == nullptr)
+			{
+				logtw("Cannot find session : %u", id);
+				continue;
+			}
+
+			if(removed_ids.insert(id).second)
+			{
+				sessions.push_back(item->session);
+			}
+		}
+
+		if(removed_ids.empty() == false)
+		{
+			// One snapshot for all removed sessions
+			auto remaining_sessions = std::make_shared<StreamWorkerSessions>();
+
+			remaining_sessions->reserve(snapshot->size() - removed_ids.size());
+			std::copy_if(snapshot->begin(), snapshot->end(), std::back_inserter(*remaining_sessions),
+			             [&removed_ids](const StreamWorkerSession &item) { return removed_ids.count(item.id) == 0; });
+
+			PublishSessions(std::move(remaining_sessions));
+		}
+	}
+
+	size_t removed_count = sessions.size();
+
+	if(removed_count > 0)
+	{
+		WaitForSnapshotRelease();
+	}
+
+	SessionReclaimer::Instance()->Retire(std::move(sessions));
+
+	return removed_count;
+}
+
+std::shared_ptr<Session> StreamWorker::GetSession(session_id_t id)
+{
+	auto snapshot = std::atomic_load(&_session_snapshot);
+	auto item = FindSession(*snapshot, id);
+
+	if(item == nullptr)
+	{
+		logte("Cannot find session : %u", id);
+		return nullptr;
+	}
+
+	return item->session;
+}
+
+std::shared_ptr<Session> StreamWorker::DetachSession()
+{
+	std::shared_ptr<Session> session;
+
+	{
+		std::unique_lock<ov::ProfiledMutex> lock(_session_map_guard);
+
+		auto snapshot = std::atomic_load(&_session_snapshot);
+
+		if(snapshot->empty())
+		{
+			return nullptr;
+		}
+
+		// The most recently added session (session ids are increasing)
+		// The moved session has already started (or it waits for the next sync point)
+		session = snapshot->back().session;
+
+		PublishSessions(std::make_shared<const StreamWorkerSessions>(snapshot->begin(), std::prev(snapshot->end())));
+	}
+
+	// The session is idle when it is detached
+	WaitForSnapshotRelease();
+
+	return session;
+}
+
+const StreamWorkerSession *StreamWorker::FindSession(const StreamWorkerSessions &sessions, session_id_t id)
+{
+	auto item = std::lower_bound(sessions.begin(), sessions.end(), id,
+	                             [](const StreamWorkerSession &item, session_id_t id) { return item.id < id; });
+
+	if((item == sessions.end()) || (item->id != id))
+	{
+		return nullptr;
+	}
+
+	return &(*item);
+}
+
+void StreamWorker::PublishSessions(std::shared_ptr<const StreamWorkerSessions> sessions)
+{
+	size_t session_count = sessions->size();
+	size_t old_session_count = _session_count.exchange(session_count);
+
+	if(_quota_statistics != nullptr)
+	{
+		_quota_statistics->AddSessionCount(static_cast<int64_t>(session_count) - static_cast<int64_t>(old_session_count));
+	}
+
+	std::atomic_store(&_session_snapshot, std::move(sessions));
+}
+
+void StreamWorker::WaitForSnapshotRelease()
+{
+	// The worker thread loads the snapshot after it locks _send_guard,
+	// so it uses the new snapshot after the current batch (like the grace period of RCU)
+	std::unique_lock<ov::ProfiledMutex> lock(_send_guard);
+}
+
+size_t StreamWorker::GetSessionCount() const
+{
+	return _session_count;
+}
+
+uint64_t StreamWorker::GetLoad() const
+{
+	uint64_t send_time_per_session = _send_time_per_session;
+
+	return _session_count * ((send_time_per_session > 0) ? send_time_per_session : 1);
+}
+
+void StreamWorker::SetLatencyStatistics(const std::shared_ptr<StreamLatencyStatistics> &latency_statistics)
+{
+	_latency_statistics = latency_statistics;
+}
+
+void StreamWorker::SetQuotaStatistics(const std::shared_ptr<ApplicationQuotaStatistics> &quota_statistics)
+{
+	_quota_statistics = quota_statistics;
+}
+
+StreamWorkerLoad StreamWorker::GetLoadInfo() const
+{
+	StreamWorkerLoad load;
+
+	load.session_count = _session_count;
+	load.send_time_per_session = _send_time_per_session;
+	load.dropped_packet_count = _dropped_packet_count;
+	load.gop_cache_packet_count = _gop_cache_packet_count;
+	load.gop_cache_bytes = _gop_cache_bytes;
+
+	std::unique_lock<ov::ProfiledMutex> lock(_packet_queue_guard);
+	load.queue_size = _priority_packet_queue.size() + _packet_queue.size();
+
+	return load;
+}
+
+void StreamWorker::AppendMetrics(StreamMetrics &metrics) const
+{
+	metrics.session_count += _session_count;
+	metrics.sent_packet_count += _sent_packet_count;
+	metrics.sent_bytes += _sent_bytes;
+	metrics.dropped_packet_count += _dropped_packet_count;
+	metrics.queue_size += _queue_size;
+	metrics.queue_bytes += _queue_bytes;
+	metrics.gop_cache_bytes += _gop_cache_bytes;
+}
+
+void StreamWorker::AppendSessionMemoryUsage(std::vector<std::pair<session_id_t, size_t>> &sessions)
+{
+	std::unique_lock<ov::ProfiledMutex> lock(_send_guard);
+
+	auto snapshot = std::atomic_load(&_session_snapshot);
+
+	for(const auto &item : *snapshot)
+	{
+		sessions.emplace_back(item.id, item.session->GetMemoryUsage());
+	}
+}
+
+void StreamWorker::SendPacket(uint32_t type, const std::shared_ptr<const ov::Data> &packet, StreamPacketPriority priority, bool is_sync_point)
+{
+	// Queue에 패킷을 집어넣는다.
+	auto stream_packet = std::make_shared<StreamPacket>(type, packet, priority, is_sync_point);
+	stream_packet->_queued_time = GetCurrentMilliseconds();
+	stream_packet->_trace_id = ov::Tracer::GetCurrentFlowId();
+
+	std::unique_lock<ov::ProfiledMutex> lock(_packet_queue_guard);
+
+	// The worker drains the queues after it wakes up
+	bool was_empty = _priority_packet_queue.empty() && _packet_queue.empty();
+
+	if(priority == StreamPacketPriority::High)
+	{
+		// e.g. The audio packets are not delayed by the burst of a key frame
+		_priority_packet_queue.push_back(std::move(stream_packet));
+	}
+	else
+	{
+		_packet_queue.push_back(std::move(stream_packet));
+	}
+
+	_queue_size = _priority_packet_queue.size() + _packet_queue.size();
+	_queue_bytes += packet->GetLength();
+
+	lock.unlock();
+
+	if(was_empty && (_stop_flag == false))
+	{
+		StreamWorkerPool::Instance()->Schedule(GetSharedPtr());
+	}
+}
+
+bool StreamWorker::PopStreamPackets(std::vector<std::shared_ptr<StreamPacket>> &packets)
+{
+	packets.clear();
+
+	std::unique_lock<ov::ProfiledMutex> lock(_packet_queue_guard);
+
+	while((_priority_packet_queue.empty() == false) && (packets.size() < STREAM_WORKER_BATCH_SIZE))
+	{
+		packets.push_back(std::move(_priority_packet_queue.front()));
+		_priority_packet_queue.pop_front();
+	}
+
+	DropStaleVideoPackets(GetCurrentMilliseconds());
+
+	while((_packet_queue.empty() == false) && (packets.size() < STREAM_WORKER_BATCH_SIZE))
+	{
+		auto &packet = _packet_queue.front();
+
+		if(packet->_priority == StreamPacketPriority::Video)
+		{
+			if(_waiting_for_sync_point)
+			{
+				if(packet->_is_sync_point == false)
+				{
+					_dropped_packet_count++;
+					_queue_bytes -= packet->_data->GetLength();
+					_packet_queue.pop_front();
+					continue;
+				}
+
+				_waiting_for_sync_point = false;
+			}
+
+			if(_video_discontinuity)
+			{
+				packet->_discontinuity = true;
+				_video_discontinuity = false;
+			}
+		}
+
+		packets.push_back(std::move(packet));
+		_packet_queue.pop_front();
+	}
+
+	_queue_size = _priority_packet_queue.size() + _packet_queue.size();
+
+	for(const auto &packet : packets)
+	{
+		_queue_bytes -= packet->_data->GetLength();
+	}
+
+	return (packets.empty() == false);
+}
+
+void StreamWorker::DropStaleVideoPackets(int64_t current_time)
+{
+	// The packets are queued in order, so the oldest Video packet tells whether the queue is lagging
+	auto oldest = std::find_if(_packet_queue.begin(), _packet_queue.end(), [](const std::shared_ptr<StreamPacket> &packet) -> bool {
+		return packet->_priority == StreamPacketPriority::Video;
+	});
+
+	if((oldest == _packet_queue.end()) || ((current_time - (*oldest)->_queued_time) <= STREAM_WORKER_VIDEO_DEADLINE_MS))
+	{
+		return;
+	}
+
+	// Skip to the latest sync point in the queue (the Normal packets are kept)
+	auto sync_point = std::find_if(_packet_queue.rbegin(), _packet_queue.rend(), [](const std::shared_ptr<StreamPacket> &packet) -> bool {
+		return (packet->_priority == StreamPacketPriority::Video) && packet->_is_sync_point;
+	});
+
+	bool has_sync_point = (sync_point != _packet_queue.rend());
+	auto drop_end = has_sync_point ? std::prev(sync_point.base()) : _packet_queue.end();
+
+	auto kept_end = std::remove_if(_packet_queue.begin(), drop_end, [](const std::shared_ptr<StreamPacket> &packet) -> bool {
+		return packet->_priority == StreamPacketPriority::Video;
+	});
+
+	size_t dropped_count = std::distance(kept_end, drop_end);
+
+	for(auto item = kept_end; item != drop_end; ++item)
+	{
+		_queue_bytes -= (*item)->_data->GetLength();
+	}
+
+	_packet_queue.erase(kept_end, drop_end);
+
+	if(dropped_count == 0)
+	{
+		// The oldest packet is the sync point
+		return;
+	}
+
+	_dropped_packet_count += dropped_count;
+	_video_discontinuity = true;
+	// If there is no sync point in the queue, the packets are dropped until it is queued
+	_waiting_for_sync_point = (has_sync_point == false);
+
+	logtw("%zu stale video packets are dropped (waiting for the sync point: %s)", dropped_count, _waiting_for_sync_point ? "true" : "false");
+}
+
+bool StreamWorker::RequestRun()
+{
+	_run_requested = true;
+
+	return (_scheduled.exchange(true) == false);
+}
+
+bool StreamWorker::Run(int64_t &timer_time)
+{
+	std::unique_lock<std::mutex> run_lock(_run_guard);
+
+	timer_time = -1;
+
+	if(_stop_flag)
+	{
+		return false;
+	}
+
+	_run_requested = false;
+
+	// The pacers wake up the worker by the timers of the pool
+	AdvanceTimers();
+
+	// Drains the queue, the producers schedule the worker only when the queue becomes non-empty
+	// (Packets of a frame are queued at once, so they are usually delivered to the session as one batch)
+	uint32_t batch_count = 0;
+
+	while((_stop_flag == false) && (batch_count < STREAM_WORKER_MAX_BATCHES_PER_RUN) && PopStreamPackets(_run_packets))
+	{
+		SendPackets(_run_packets);
+		batch_count++;
+
+		// The pacers are not delayed by a long queue
+		AdvanceTimers();
+	}
+
+	_run_packets.clear();
+
+	if(batch_count >= STREAM_WORKER_MAX_BATCHES_PER_RUN)
+	{
+		// Yields the thread, the rest is sent by the next run
+		_run_requested = true;
+	}
+
+	int64_t timeout = _timer_wheel.GetNextTimeout();
+
+	if(timeout >= 0)
+	{
+		timer_time = GetCurrentMilliseconds() + timeout;
+	}
+
+	_scheduled = false;
+
+	// The packets which are queued while running
+	return (_run_requested && (_stop_flag == false) && RequestRun());
+}
+
+void StreamWorker::AdvanceTimers()
 {
-	_stop_thread_flag = true;
+	std::unique_lock<ov::ProfiledMutex> send_lock(_send_guard);
+
+	_worker_sessions = std::atomic_load(&_session_snapshot);
+	_timer_wheel.Advance(GetCurrentMilliseconds());
+	_worker_sessions.reset();
 }
 
-StreamWorker::~StreamWorker()
-{
-	Stop();
+void StreamWorker::SendPackets(const std::vector<std::shared_ptr<StreamPacket>> &packets)
+{
+	std::unique_lock<ov::ProfiledMutex> send_lock(_send_guard, std::defer_lock);
+
+	// The sends of the sockets are the end of the flow of the last frame in the batch
+	OV_TRACE_FLOW(packets.back()->_trace_id);
+	OV_TRACE_SCOPE("publisher", "StreamWorkerSend");
+
+	if(ov::Tracer::IsEnabled())
+	{
+		// The other frames in the batch
+		uint64_t last_trace_id = packets.back()->_trace_id;
+
+		for(const auto &packet : packets)
+		{
+			if((packet->_trace_id != 0) && (packet->_trace_id != last_trace_id))
+			{
+				ov::Tracer::RecordFlowStep("publisher", "StreamWorkerSend", packet->_trace_id);
+				last_trace_id = packet->_trace_id;
+			}
+		}
+	}
+
+	// The snapshot is not changed while sending, the writers publish a new one without waiting for this batch
+	send_lock.lock();
+	_worker_sessions = std::atomic_load(&_session_snapshot);
+
+	auto start_time = std::chrono::steady_clock::now();
+	size_t session_count = _worker_sessions->size();
+	size_t sent_session_count = 0;
+
+	// 모든 Session에 전송한다.
+	for(auto const &item : *_worker_sessions)
+	{
+		auto &session = item.session;
+
+		if((item.gop_replay != nullptr) && (ReplayGopCache(item) == false))
+		{
+			// The packets will be dropped by the session anyway, and it starts from the GOP cache later
+			continue;
+		}
+
+		// The payload is shared by all sessions.
+		// If a session needs to change the data (e.g. SRTP), it must copy it to its own buffer.
+		session->SendOutgoingData(packets);
+		sent_session_count++;
+
+		SchedulePacing(session);
+	}
+
+	if((_report_scheduled == false) && (sent_session_count > 0))
+	{
+		ScheduleReport();
+	}
+
+	_worker_sessions.reset();
+	send_lock.unlock();
+
+	if(sent_session_count > 0)
+	{
+		size_t batch_bytes = 0;
+
+		for(auto &packet : packets)
+		{
+			batch_bytes += packet->_data->GetLength();
+		}
+
+		_sent_packet_count += packets.size() * sent_session_count;
+		_sent_bytes += batch_bytes * sent_session_count;
+
+		if(_quota_statistics != nullptr)
+		{
+			_quota_statistics->AddEgressBytes(batch_bytes * sent_session_count);
+		}
+	}
+
+	if(_latency_statistics != nullptr)
+	{
+		int64_t sent_time = GetCurrentMilliseconds();
+
+		for(auto &packet : packets)
+		{
+			_latency_statistics->Record(StreamLatencyStage::Send, (sent_time - packet->_queued_time) * 1000);
+		}
+	}
+
+	UpdateGopCache(packets);
+
+	if(session_count > 0)
+	{
+		// Measure the send time for the load-aware session placement (moving average with weight 1/8)
+		uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count();
+		uint64_t send_time_per_session = elapsed / session_count;
+		uint64_t average = _send_time_per_session;
+
+		_send_time_per_session = (average == 0) ? send_time_per_session : (average * 7 + send_time_per_session) / 8;
+	}
+}
+
+bool StreamWorker::ReplayGopCache(const StreamWorkerSession &item)
+{
+	if(*item.gop_replay == false)
+	{
+		return true;
+	}
+
+	auto &session = item.session;
+
+	if(session->IsReadyToSend() == false)
+	{
+		return false;
+	}
+
+	*item.gop_replay = false;
+
+	if(_gop_cache.empty())
+	{
+		// The session waits for the next sync point
+		return true;
+	}
+
+	// The packets keep their timestamps and sequence numbers, and the pacer of the session spreads the burst
+	std::vector<std::shared_ptr<StreamPacket>> batch;
+
+	batch.reserve(STREAM_WORKER_BATCH_SIZE);
+
+	for(auto &packet : _gop_cache)
+	{
+		batch.push_back(packet);
+
+		if(batch.size() >= STREAM_WORKER_BATCH_SIZE)
+		{
+			session->SendOutgoingData(batch);
+			batch.clear();
+		}
+	}
+
+	if(batch.empty() == false)
+	{
+		session->SendOutgoingData(batch);
+	}
+
+	logtd("GOP cache is replayed to the session(%u): %zu packets, %zu bytes", session->GetId(), _gop_cache.size(), _gop_cache_bytes.load());
+
+	return true;
+}
+
+void StreamWorker::UpdateGopCache(const std::vector<std::shared_ptr<StreamPacket>> &packets)
+{
+	size_t cache_bytes = _gop_cache_bytes;
+	// Reduced under the memory pressure
+	size_t max_bytes = ov::MemoryGovernor::Instance()->IsLevel(ov::MemoryGovernorLevel::Shrink) ?
+		(STREAM_WORKER_GOP_CACHE_MAX_BYTES / OV_MEMORY_GOVERNOR_GOP_CACHE_DIVISOR) : STREAM_WORKER_GOP_CACHE_MAX_BYTES;
+
+	for(auto &packet : packets)
+	{
+		if(packet->_priority == StreamPacketPriority::Video)
+		{
+			if(packet->_is_sync_point)
+			{
+				// A new GOP
+				_gop_cache.clear();
+				cache_bytes = 0;
+				_gop_cache_valid = true;
+			}
+			else if(packet->_discontinuity)
+			{
+				// The cache is not decodable without the dropped packets
+				_gop_cache.clear();
+				cache_bytes = 0;
+				_gop_cache_valid = false;
+			}
+		}
+
+		if(_gop_cache_valid == false)
+		{
+			continue;
+		}
+
+		if((cache_bytes + packet->_data->GetLength()) > max_bytes)
+		{
+			logtw("GOP exceeds %zu bytes, the cache is dropped until the next sync point", max_bytes);
+
+			_gop_cache.clear();
+			cache_bytes = 0;
+			_gop_cache_valid = false;
+			continue;
+		}
+
+		_gop_cache.push_back(packet);
+		cache_bytes += packet->_data->GetLength();
+	}
+
+	_gop_cache_packet_count = _gop_cache.size();
+	_gop_cache_bytes = cache_bytes;
+}
+
+void StreamWorker::SchedulePacing(const std::shared_ptr<Session> &session)
+{
+	session_id_t id = session->GetId();
+
+	if(_paced_sessions.find(id) != _paced_sessions.end())
+	{
+		// The timer will process it
+		return;
+	}
+
+	int64_t delay = session->ProcessPacing();
+
+	if(delay < 0)
+	{
+		return;
+	}
+
+	_paced_sessions.insert(id);
+
+	_timer_wheel.Schedule(delay, [this, id]() {
+		OnPacingTimer(id);
+	});
 }
 
-bool StreamWorker::Start()
+void StreamWorker::OnPacingTimer(session_id_t id)
 {
-	if(!_stop_thread_flag)
+	_paced_sessions.erase(id);
+
+	// The timers run with _send_guard (in the worker thread)
+	auto item = (_worker_sessions != nullptr) ? FindSession(*_worker_sessions, id) : nullptr;
+
+	if(item == nullptr)
 	{
-		return true;
+		// The session is removed or moved to another worker
+		return;
 	}
-	_stop_thread_flag = false;
-	_worker_thread = std::thread(&StreamWorker::WorkerThread, this);
 
-	return true;
+	SchedulePacing(item->session);
 }
 
-bool StreamWorker::Stop()
+void StreamWorker::ScheduleReport()
+{
+	int64_t current_time = GetCurrentMilliseconds();
+	// The timer may fire a little earlier or later than the multiple
+	int64_t next_time = ((current_time + (STREAM_WORKER_REPORT_INTERVAL / 2)) / STREAM_WORKER_REPORT_INTERVAL + 1) * STREAM_WORKER_REPORT_INTERVAL;
+
+	_report_scheduled = true;
+
+	_timer_wheel.Schedule(next_time - current_time, [this]() {
+		OnReportTimer();
+	});
+}
+
+void StreamWorker::OnReportTimer()
 {
-	if(_stop_thread_flag)
+	_report_scheduled = false;
+
+	// The timers run with _send_guard (in the worker thread)
+	if((_worker_sessions == nullptr) || _worker_sessions->empty())
 	{
-		return true;
+		// Scheduled again by the next batch
+		return;
 	}
 
-	_stop_thread_flag = true;
-	// Generate Event
-	_queue_event.Notify();
-	_worker_thread.join();
+	// The same time for all sessions (and all workers of the stream)
+	int64_t current_time = GetCurrentMilliseconds();
+	int64_t report_time = ((current_time + (STREAM_WORKER_REPORT_INTERVAL / 2)) / STREAM_WORKER_REPORT_INTERVAL) * STREAM_WORKER_REPORT_INTERVAL;
+	bool reported = false;
+	// The share of <MaxEgressBitrate> follows the sessions of the application
+	uint64_t egress_bitrate_limit = (_quota_statistics != nullptr) ? _quota_statistics->GetEgressBitrateShare() : 0;
 
-	for(auto const &x : _sessions)
+	for(auto const &item : *_worker_sessions)
 	{
-		auto session = std::static_pointer_cast<Session>(x.second);
-		session->Stop();
+		item.session->SetEgressBitrateLimit(egress_bitrate_limit);
+
+		if(item.session->IsReadyToSend() && item.session->SendReport(report_time))
+		{
+			reported = true;
+		}
 	}
-	_sessions.clear();
 
-	return true;
+	if(reported)
+	{
+		ScheduleReport();
+	}
 }
 
-bool StreamWorker::AddSession(std::shared_ptr<Session> session)
+int64_t StreamWorker::GetCurrentMilliseconds()
 {
-	std::unique_lock<std::mutex> lock(_session_map_guard);
-	_sessions[session->GetId()] = session;
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-	return true;
+Stream::Stream(const std::shared_ptr<Application> application,
+               const StreamInfo &info)
+	: StreamInfo(info)
+{
+	_application = application;
+	_run_flag = false;
+	_session_rebalance = false;
+
+	_latency_statistics = StreamLatency::Instance()->GetStatistics(application->GetId(), application->GetName(), GetName());
+	_quota_statistics = ApplicationQuota::Instance()->GetStatistics(*application);
+	_qoe_statistics = StreamQoe::Instance()->GetStatistics(*application, GetName());
 }
 
-bool StreamWorker::RemoveSession(session_id_t id)
+Stream::~Stream()
 {
-	// 해당 Session ID를 가진 StreamWorker를 찾아서 삭제한다.
-	std::unique_lock<std::mutex> lock(_session_map_guard);
-	if(_sessions.count(id) <= 0)
+	Stop();
+}
+
+bool Stream::Start(uint32_t worker_count)
+{
+	if(_run_flag == true)
 	{
-		logte("Cannot find session : %u", id);
 		return false;
 	}
 
-	auto session = _sessions[id];
-	// Session에 더이상 패킷을 전달하지 않는 것이 먼저다.
-	_sessions.erase(id);
+	// The threads are shared by all streams (StreamWorkerPool), worker_count is the maximum number of the workers
+	_max_worker_count = std::min(std::max(worker_count, 1u), static_cast<uint32_t>(MAX_STREAM_THREAD_COUNT));
+	_stream_workers.resize(_max_worker_count);
+
+	{
+		std::unique_lock<std::mutex> lock(_session_worker_map_guard);
 
-	// Session 동작을 중지한다.
-	session->Stop();
+		// More workers are added when the sessions are increased
+		if(AddWorker() == false)
+		{
+			logte("Cannot create stream worker");
+			return false;
+		}
+	}
 
+	_run_flag = true;
 	return true;
 }
 
-std::shared_ptr<Session> StreamWorker::GetSession(session_id_t id)
+bool Stream::Stop()
 {
-	if(_sessions.count(id) <= 0)
+	if(_run_flag == false)
 	{
-        logte("Cannot find session : %u", id);
-		return nullptr;
+		return false;
+	}
+
+	_run_flag = false;
+
+	{
+		std::unique_lock<std::mutex> lock(_session_worker_map_guard);
+
+		for(uint32_t i=0; i<_worker_count; i++)
+		{
+			GetWorker(i)->Stop();
+			std::atomic_store(&_stream_workers[i], std::shared_ptr<StreamWorker>());
+		}
+
+		_worker_count = 0;
 	}
 
-	return _sessions[id];
+	StreamDemand::Instance()->RemoveSession(_application->GetId(), GetName(), _sessions.size());
+
+	_sessions.clear();
+
+	std::unique_lock<std::mutex> lock(_session_worker_map_guard);
+	_session_worker_map.clear();
+
+	return true;
 }
 
-void StreamWorker::SendPacket(uint32_t type, std::shared_ptr<ov::Data> packet)
+std::shared_ptr<Application> Stream::GetApplication()
 {
-	// Queue에 패킷을 집어넣는다.
-	auto stream_packet = std::make_shared<StreamWorker::StreamPacket>(type, packet);
+	return _application;
+}
 
-	std::unique_lock<std::mutex> lock(_packet_queue_guard);
-	_packet_queue.push(stream_packet);
-	lock.unlock();
+void Stream::SetSessionRebalance(bool enabled)
+{
+	_session_rebalance = enabled;
+}
 
-	_queue_event.Notify();
+const std::shared_ptr<StreamLatencyStatistics> &Stream::GetLatencyStatistics() const
+{
+	return _latency_statistics;
+}
+
+const std::shared_ptr<StreamQoeStatistics> &Stream::GetQoeStatistics() const
+{
+	return _qoe_statistics;
 }
 
-std::shared_ptr<StreamWorker::StreamPacket> StreamWorker::PopStreamPacket()
+void Stream::GetWorkerLoads(std::vector<StreamWorkerLoad> &loads)
 {
-	std::unique_lock<std::mutex> lock(_packet_queue_guard);
+	uint32_t worker_count = _worker_count;
 
-	if(_packet_queue.empty())
+	for(uint32_t i=0; i<worker_count; i++)
 	{
-		return nullptr;
-	}
+		auto worker = GetWorker(i);
+
+		if(worker == nullptr)
+		{
+			continue;
+		}
 
-	auto data = _packet_queue.front();
-	_packet_queue.pop();
+		auto load = worker->GetLoadInfo();
+		load.index = i;
 
-	return std::move(data);
+		loads.push_back(load);
+	}
 }
 
-void StreamWorker::WorkerThread()
+StreamMetrics Stream::GetMetrics() const
 {
-	std::unique_lock<std::mutex> session_lock(_session_map_guard, std::defer_lock);
-	// Queue Event를 기다린다.
-	while(!_stop_thread_flag)
+	StreamMetrics metrics;
+	uint32_t worker_count = _worker_count;
+
+	for(uint32_t i=0; i<worker_count; i++)
 	{
-		// Queue에 이벤트가 들어올때까지 무한 대기 한다.
-		// TODO: 향후 App 재시작 등의 기능을 위해 WaitFor(time) 기능을 구현한다.
-		_queue_event.Wait();
+		auto worker = GetWorker(i);
 
-		// Queue에서 패킷을 꺼낸다.
-		std::shared_ptr<StreamWorker::StreamPacket> packet = PopStreamPacket();
-		if(packet == nullptr)
+		if(worker != nullptr)
 		{
-			continue;
+			worker->AppendMetrics(metrics);
 		}
+	}
 
-		session_lock.lock();
-		// 모든 Session에 전송한다.
-		for(auto const &x : _sessions)
-		{
-			auto session = std::static_pointer_cast<Session>(x.second);
+	return metrics;
+}
 
-			// Session will change data
-			std::shared_ptr<ov::Data> session_data = packet->_data->Clone();
-			session->SendOutgoingData(packet->_type, session_data);
+void Stream::GetSessionMemoryUsage(std::vector<std::pair<session_id_t, size_t>> &sessions)
+{
+	uint32_t worker_count = _worker_count;
+
+	for(uint32_t i=0; i<worker_count; i++)
+	{
+		auto worker = GetWorker(i);
+
+		if(worker != nullptr)
+		{
+			worker->AppendSessionMemoryUsage(sessions);
 		}
-		session_lock.unlock();
 	}
 }
 
-Stream::Stream(const std::shared_ptr<Application> application,
-               const StreamInfo &info)
-	: StreamInfo(info)
+std::shared_ptr<StreamWorker> Stream::GetWorker(uint32_t index) const
 {
-	_application = application;
-	_run_flag = false;
+	return std::atomic_load(&_stream_workers[index]);
 }
 
-Stream::~Stream()
+std::shared_ptr<StreamWorker> Stream::GetWorkerBySessionID(session_id_t session_id)
 {
-	Stop();
+	std::unique_lock<std::mutex> lock(_session_worker_map_guard);
+
+	auto item = _session_worker_map.find(session_id);
+
+	if(item == _session_worker_map.end())
+	{
+		return nullptr;
+	}
+
+	return GetWorker(item->second);
 }
 
-bool Stream::Start(uint32_t worker_count)
+bool Stream::AddWorker()
 {
-	if(_run_flag == true)
+	uint32_t index = _worker_count;
+
+	if(index >= _max_worker_count)
 	{
 		return false;
 	}
 
-	if(worker_count > MAX_STREAM_THREAD_COUNT)
-	{
-		worker_count = MAX_STREAM_THREAD_COUNT;
-	}
+	auto worker = std::make_shared<StreamWorker>();
+
+	worker->SetLatencyStatistics(_latency_statistics);
+	worker->SetQuotaStatistics(_quota_statistics);
 
-	_worker_count = worker_count;
-	// Create WorkerThread
-	for(uint32_t i=0; i<_worker_count; i++)
+	if(worker->Start() == false)
 	{
-		if(!_stream_workers[i].Start())
-		{
-			logte("Cannot create stream thread (%d)", i);
+		return false;
+	}
 
-			Stop();
+	// The packets are broadcast to the new worker after this
+	std::atomic_store(&_stream_workers[index], worker);
+	_worker_count = index + 1;
 
-			return false;
-		}
-	}
+	logtd("Stream worker %u is added to stream %s", index, GetName().CStr());
 
-	_run_flag = true;
 	return true;
 }
 
-bool Stream::Stop()
+void Stream::ShrinkWorkers()
 {
-	if(_run_flag == false)
+	uint32_t worker_count = _worker_count;
+
+	if(worker_count <= 1)
 	{
-		return false;
+		return;
 	}
 
-	_run_flag = false;
+	uint32_t last_index = worker_count - 1;
+	uint64_t total_load = 0;
 
-	for(uint32_t i=0; i<_worker_count; i++)
+	for(uint32_t i=0; i<worker_count; i++)
 	{
-		_stream_workers[i].Stop();
+		total_load += GetWorker(i)->GetLoad();
 	}
 
-	_sessions.clear();
+	// The load of each of the others after the merge
+	if((total_load / last_index) >= STREAM_WORKER_SCALE_DOWN_LOAD)
+	{
+		return;
+	}
 
-	return true;
+	auto last_worker = GetWorker(last_index);
+	size_t moved_count = 0;
+
+	// The sessions are moved while both workers receive the packets (like Rebalance())
+	while(true)
+	{
+		auto session = last_worker->DetachSession();
+
+		if(session == nullptr)
+		{
+			break;
+		}
+
+		auto index = SelectWorkerIndex(last_index);
+
+		_session_worker_map[session->GetId()] = index;
+		GetWorker(index)->AddSession(session);
+		moved_count++;
+	}
+
+	_worker_count = last_index;
+	last_worker->Stop();
+	std::atomic_store(&_stream_workers[last_index], std::shared_ptr<StreamWorker>());
+
+	logtd("Stream worker %u is removed from stream %s (%zu sessions are moved)", last_index, GetName().CStr(), moved_count);
 }
 
-std::shared_ptr<Application> Stream::GetApplication()
+uint32_t Stream::SelectWorkerIndex(uint32_t worker_count)
 {
-	return _application;
+	uint32_t selected_index = 0;
+	uint64_t selected_load = UINT64_MAX;
+
+	for(uint32_t i=0; i<worker_count; i++)
+	{
+		auto load = GetWorker(i)->GetLoad();
+
+		if(load < selected_load)
+		{
+			selected_index = i;
+			selected_load = load;
+		}
+	}
+
+	return selected_index;
 }
 
-StreamWorker& Stream::GetWorkerByStreamID(session_id_t session_id)
+void Stream::Rebalance()
 {
-	return _stream_workers[session_id % _worker_count];
+	uint32_t worker_count = _worker_count;
+	uint32_t busiest_index = 0;
+	uint32_t idlest_index = 0;
+
+	if(worker_count <= 1)
+	{
+		return;
+	}
+
+	for(uint32_t i=1; i<worker_count; i++)
+	{
+		if(GetWorker(i)->GetSessionCount() > GetWorker(busiest_index)->GetSessionCount())
+		{
+			busiest_index = i;
+		}
+
+		if(GetWorker(i)->GetSessionCount() < GetWorker(idlest_index)->GetSessionCount())
+		{
+			idlest_index = i;
+		}
+	}
+
+	auto busiest_worker = GetWorker(busiest_index);
+	auto idlest_worker = GetWorker(idlest_index);
+	size_t difference = busiest_worker->GetSessionCount() - idlest_worker->GetSessionCount();
+
+	if(difference <= STREAM_WORKER_REBALANCE_THRESHOLD)
+	{
+		return;
+	}
+
+	// Move the half of the difference
+	for(size_t count = 0; count < difference / 2; count++)
+	{
+		auto session = busiest_worker->DetachSession();
+
+		if(session == nullptr)
+		{
+			break;
+		}
+
+		_session_worker_map[session->GetId()] = idlest_index;
+		idlest_worker->AddSession(session);
+	}
+
+	logtd("Sessions are moved from worker %u to worker %u (%zu sessions)", busiest_index, idlest_index, difference / 2);
 }
 
 bool Stream::AddSession(std::shared_ptr<Session> session)
 {
 	// For getting session, all sessions
+	if(_sessions.count(session->GetId()) == 0)
+	{
+		// The transcoder starts the encoders of the on-demand stream
+		StreamDemand::Instance()->AddSession(_application->GetId(), GetName());
+	}
+
 	_sessions[session->GetId()] = session;
-	// 가장 적은 Session을 처리하는 Worker를 찾아서 Session을 넣는다.
-	// session id로 hash를 만들어서 분배한다.
-	return GetWorkerByStreamID(session->GetId()).AddSession(session);
+
+	// 가장 적은 부하를 처리하는 Worker를 찾아서 Session을 넣는다.
+	// (the load is estimated by the number of sessions and the measured send time)
+	std::unique_lock<std::mutex> lock(_session_worker_map_guard);
+
+	if(_worker_count == 0)
+	{
+		logte("Stream is not started : %s", GetName().CStr());
+		return false;
+	}
+
+	auto index = SelectWorkerIndex(_worker_count);
+	auto worker = GetWorker(index);
+	bool is_worker_added = false;
+
+	if((worker->GetSessionCount() >= STREAM_WORKER_SCALE_UP_SESSION_COUNT) && (worker->GetLoad() >= STREAM_WORKER_SCALE_UP_LOAD))
+	{
+		// The new worker doesn't have the GOP cache yet,
+		// so the new session starts on the current worker and the started sessions are moved to the new one
+		is_worker_added = AddWorker();
+	}
+
+	_session_worker_map[session->GetId()] = index;
+
+	bool result = worker->AddSession(session, true);
+
+	if(is_worker_added)
+	{
+		Rebalance();
+	}
+
+	return result;
 }
 
 bool Stream::RemoveSession(session_id_t id)
@@ -232,12 +1187,119 @@ bool Stream::RemoveSession(session_id_t id)
 	}
 	_sessions.erase(id);
 
-	return GetWorkerByStreamID(id).RemoveSession(id);
+	StreamDemand::Instance()->RemoveSession(_application->GetId(), GetName());
+
+	std::unique_lock<std::mutex> lock(_session_worker_map_guard);
+
+	auto item = _session_worker_map.find(id);
+
+	if(item == _session_worker_map.end())
+	{
+		logte("Cannot find the worker of session : %u", id);
+		return false;
+	}
+
+	auto worker = GetWorker(item->second);
+	_session_worker_map.erase(item);
+
+	bool result = worker->RemoveSession(id);
+
+	ShrinkWorkers();
+
+	if(_session_rebalance)
+	{
+		Rebalance();
+	}
+
+	return result;
+}
+
+size_t Stream::RemoveSessions(const std::vector<session_id_t> &ids)
+{
+	// The sessions of each worker
+	std::map<uint32_t, std::vector<session_id_t>> worker_session_ids;
+	size_t session_count = 0;
+
+	{
+		std::unique_lock<std::mutex> lock(_session_worker_map_guard);
+
+		for(auto id : ids)
+		{
+			if(_sessions.erase(id) == 0)
+			{
+				logte("Cannot find session : %u", id);
+				continue;
+			}
+
+			session_count++;
+
+			auto item = _session_worker_map.find(id);
+
+			if(item == _session_worker_map.end())
+			{
+				logte("Cannot find the worker of session : %u", id);
+				continue;
+			}
+
+			worker_session_ids[item->second].push_back(id);
+			_session_worker_map.erase(item);
+		}
+	}
+
+	StreamDemand::Instance()->RemoveSession(_application->GetId(), GetName(), session_count);
+
+	size_t removed_count = 0;
+
+	for(auto &item : worker_session_ids)
+	{
+		auto worker = GetWorker(item.first);
+
+		if(worker != nullptr)
+		{
+			removed_count += worker->RemoveSessions(item.second);
+		}
+	}
+
+	if(removed_count > 0)
+	{
+		std::unique_lock<std::mutex> lock(_session_worker_map_guard);
+
+		ShrinkWorkers();
+
+		if(_session_rebalance)
+		{
+			Rebalance();
+		}
+	}
+
+	return removed_count;
+}
+
+size_t Stream::RemoveAllSessions()
+{
+	std::vector<session_id_t> ids;
+
+	ids.reserve(_sessions.size());
+
+	for(auto &item : _sessions)
+	{
+		ids.push_back(item.first);
+	}
+
+	return RemoveSessions(ids);
 }
 
 std::shared_ptr<Session> Stream::GetSession(session_id_t id)
 {
-	return GetWorkerByStreamID(id).GetSession(id);
+	auto worker = GetWorkerBySessionID(id);
+
+	if(worker == nullptr)
+	{
+		logte("Cannot find session : %u", id);
+		return nullptr;
+	}
+
+	return worker->GetSession(id);
 }
 
 const std::map<session_id_t, std::shared_ptr<Session>> &Stream::GetAllSessions()
@@ -245,12 +1307,19 @@ const std::map<session_id_t, std::shared_ptr<Session>> &Stream::GetAllSessions()
 	return _sessions;
 }
 
-bool Stream::BroadcastPacket(uint32_t packet_type, std::shared_ptr<ov::Data> packet)
+bool Stream::BroadcastPacket(uint32_t packet_type, const std::shared_ptr<const ov::Data> &packet, StreamPacketPriority priority, bool is_sync_point)
 {
 	// 모든 StreamWorker에 나눠준다.
-	for(uint32_t i=0; i<_worker_count; i++)
+	uint32_t worker_count = _worker_count;
+
+	for(uint32_t i=0; i<worker_count; i++)
 	{
-		_stream_workers[i].SendPacket(packet_type, packet);
+		auto worker = GetWorker(i);
+
+		if(worker != nullptr)
+		{
+			worker->SendPacket(packet_type, packet, priority, is_sync_point);
+		}
 	}
 
 	return true;
@@ -3,55 +3,225 @@
 #include "session.h"
 #include "base/common_types.h"
 #include "base/application/stream_info.h"
+#include "base/application/stream_latency.h"
+#include "base/application/stream_qoe.h"
+#include "base/application/application_quota.h"
 #include "application.h"
 
+#include <atomic>
+#include <deque>
+#include <set>
+
 #define MIN_STREAM_THREAD_COUNT     2
 #define MAX_STREAM_THREAD_COUNT     72
+// Maximum number of packets delivered to a session at once
+#define STREAM_WORKER_BATCH_SIZE    64
+// A worker yields the thread of StreamWorkerPool after this number of batches, so it doesn't starve the other streams
+#define STREAM_WORKER_MAX_BATCHES_PER_RUN   16
+// A stream adds a worker (up to the thread count of the publisher) when the idlest one has this many sessions
+// and its estimated time to send a batch to all of them exceeds STREAM_WORKER_SCALE_UP_LOAD (nano seconds)
+#define STREAM_WORKER_SCALE_UP_SESSION_COUNT    8
+#define STREAM_WORKER_SCALE_UP_LOAD             (1000 * 1000)
+// The last worker is merged into the others when their load after the merge is below this (nano seconds)
+#define STREAM_WORKER_SCALE_DOWN_LOAD           (STREAM_WORKER_SCALE_UP_LOAD / 2)
+// Sessions are moved between workers when the difference of session count exceeds this value
+#define STREAM_WORKER_REBALANCE_THRESHOLD   4
+// The video packets which wait longer than this (ms) are dropped until the next sync point
+#define STREAM_WORKER_VIDEO_DEADLINE_MS     500
+// Bytes of the packets since the last sync point which a worker keeps for the new sessions
+// (the cache is dropped until the next sync point when it is exceeded)
+#define STREAM_WORKER_GOP_CACHE_MAX_BYTES   (4 * 1024 * 1024)
+// ms, the reports of the sessions (see Session::SendReport()). The timers of all workers fire at the multiples of it,
+// so a stream can make the report once per interval for all of its sessions
+#define STREAM_WORKER_REPORT_INTERVAL       1000
+
+// Load of a StreamWorker (for placement and monitoring)
+struct StreamWorkerLoad
+{
+	uint32_t index = 0;
+	size_t session_count = 0;
+	size_t queue_size = 0;
+	// Average time to send a batch to a session (nano seconds)
+	uint64_t send_time_per_session = 0;
+	// Number of the stale video packets dropped
+	uint64_t dropped_packet_count = 0;
+	// Packets since the last sync point (replayed to the new sessions)
+	size_t gop_cache_packet_count = 0;
+	size_t gop_cache_bytes = 0;
+};
 
-class StreamWorker
+// Counters of a stream (sum of the workers, for the metrics)
+// - They are read from the atomics of the workers, so the sessions and the queues are not locked
+struct StreamMetrics
+{
+	size_t session_count = 0;
+	// Packets (and the bytes) which are sent to the sessions (a packet sent to N sessions is counted N times)
+	uint64_t sent_packet_count = 0;
+	uint64_t sent_bytes = 0;
+	uint64_t dropped_packet_count = 0;
+	size_t queue_size = 0;
+	// Bytes of the packets in the queues and the GOP caches (the payloads are shared, so the sessions don't own them)
+	size_t queue_bytes = 0;
+	size_t gop_cache_bytes = 0;
+};
+
+// Session of a snapshot of StreamWorker
+struct StreamWorkerSession
+{
+	session_id_t id = 0;
+	std::shared_ptr<Session> session;
+	// true until the GOP cache is replayed to the session (nullptr : it doesn't wait for the replay)
+	// - Set before the snapshot is published and shared by the next snapshots, only the worker thread changes it after that
+	std::shared_ptr<bool> gop_replay;
+};
+
+// Sessions of a StreamWorker sorted by id, a published snapshot is never modified
+using StreamWorkerSessions = std::vector<StreamWorkerSession>;
+
+// Packets and sessions of a stream which are run by a thread of StreamWorkerPool (one thread at a time)
+class StreamWorker : public ov::EnableSharedFromThis<StreamWorker>
 {
 public:
+	friend class StreamWorkerPool;
+
 	StreamWorker();
 	~StreamWorker();
 
 	bool Start();
+	// Waits for the thread of the pool which is running this worker
 	bool Stop();
 
-	bool AddSession(std::shared_ptr<Session> session);
+	// If replay_gop is true, the session receives the cached packets since the last sync point before the live packets
+	// (when it is ready to send), so the peer can start decoding without waiting for the next key frame
+	bool AddSession(std::shared_ptr<Session> session, bool replay_gop = false);
+	// The removed sessions are stopped by SessionReclaimer (not by the caller)
 	bool RemoveSession(session_id_t id);
+	// Removes the sessions with one lock, returns the number of the removed sessions
+	size_t RemoveSessions(const std::vector<session_id_t> &ids);
 	std::shared_ptr<Session> GetSession(session_id_t id);
 
-	void SendPacket(uint32_t type, std::shared_ptr<ov::Data> packet);
+	// Removes a session from this worker without stopping it (to move it to another worker)
+	std::shared_ptr<Session> DetachSession();
+
+	void SendPacket(uint32_t type, const std::shared_ptr<const ov::Data> &packet,
+	                StreamPacketPriority priority = StreamPacketPriority::Normal, bool is_sync_point = false);
+
+	size_t GetSessionCount() const;
+	// Estimated time to send a batch to all sessions (the number of sessions if it has not been measured yet)
+	uint64_t GetLoad() const;
+	StreamWorkerLoad GetLoadInfo() const;
+	// Adds the counters of this worker to the metrics (without the lock)
+	void AppendMetrics(StreamMetrics &metrics) const;
+	// Memory of each session (the sessions are visited with _send_guard, so they are not sending)
+	void AppendSessionMemoryUsage(std::vector<std::pair<session_id_t, size_t>> &sessions);
+
+	// The worker records the Send latency of the packets (must be set before Start())
+	void SetLatencyStatistics(const std::shared_ptr<StreamLatencyStatistics> &latency_statistics);
+	// The sessions, the sent bytes and the run time of the worker are accounted to the quota of the application,
+	// and the sessions are limited to the share of <MaxEgressBitrate> (must be set before Start())
+	void SetQuotaStatistics(const std::shared_ptr<ApplicationQuotaStatistics> &quota_statistics);
+	const std::shared_ptr<ApplicationQuotaStatistics> &GetQuotaStatistics() const
+	{
+		return _quota_statistics;
+	}
+
+	static int64_t GetCurrentMilliseconds();
 
 private:
+	// Returns true if the caller (StreamWorkerPool) must queue the worker, false if it is queued or running
+	bool RequestRun();
+	// Runs the pacers and sends the queued packets (a thread of the pool only)
+	// Returns true if it must run again, timer_time is the time of the next pacing timer (-1 if there is no timer)
+	bool Run(int64_t &timer_time);
+	// Runs the expired pacing timers (the worker thread only)
+	void AdvanceTimers();
 
+	// Sends the batch to all sessions (the worker thread only)
+	void SendPackets(const std::vector<std::shared_ptr<StreamPacket>> &packets);
 
-	void WorkerThread();
+	// Schedules the pacing of the session to the timer wheel if it holds the packets (the worker thread only)
+	void SchedulePacing(const std::shared_ptr<Session> &session);
+	void OnPacingTimer(session_id_t id);
 
-	std::map<session_id_t, std::shared_ptr<Session>> _sessions;
-	std::mutex          _session_map_guard;
-	ov::Semaphore       _queue_event;
+	// Schedules the report timer to the next multiple of STREAM_WORKER_REPORT_INTERVAL (the worker thread only)
+	void ScheduleReport();
+	void OnReportTimer();
 
-	class StreamPacket
-	{
-	public:
-		StreamPacket(uint32_t type, std::shared_ptr<ov::Data> data)
-		{
-			_type = type;
-			_data = data->Clone();
-		}
+	// Sends the GOP cache to the session if it is waiting for the replay (the worker thread only)
+	// Returns false if the session is not ready to send yet (it doesn't receive the live packets until it is replayed)
+	bool ReplayGopCache(const StreamWorkerSession &item);
+	// Appends the sent packets to the GOP cache (the worker thread only)
+	void UpdateGopCache(const std::vector<std::shared_ptr<StreamPacket>> &packets);
+
+	// The session of the id in the snapshot (nullptr if not found)
+	static const StreamWorkerSession *FindSession(const StreamWorkerSessions &sessions, session_id_t id);
+	// Replaces the snapshot (_session_map_guard must be locked)
+	void PublishSessions(std::shared_ptr<const StreamWorkerSessions> sessions);
+	// Waits until the worker thread doesn't use the previous snapshots (it must not be called by the worker thread)
+	void WaitForSnapshotRelease();
+
+	// Snapshot of the sessions (std::atomic_load/atomic_store only)
+	// - The writers make a new snapshot with _session_map_guard, so they don't block the delivery
+	std::shared_ptr<const StreamWorkerSessions> _session_snapshot;
+	ov::ProfiledMutex   _session_map_guard { "StreamWorker::_session_map_guard" };
+	// Held by the worker thread while it uses a snapshot (sending and pacing)
+	ov::ProfiledMutex   _send_guard { "StreamWorker::_send_guard" };
+	// Snapshot which the worker thread is using (_send_guard must be locked)
+	std::shared_ptr<const StreamWorkerSessions> _worker_sessions;
+
+	// Pops at most STREAM_WORKER_BATCH_SIZE packets at once (the High packets first)
+	bool PopStreamPackets(std::vector<std::shared_ptr<StreamPacket>> &packets);
+	// Drops the stale Video packets of _packet_queue (_packet_queue_guard must be locked)
+	void DropStaleVideoPackets(int64_t current_time);
 
-		uint32_t                    _type;
-		std::shared_ptr<ov::Data>   _data;
-	};
+	// High priority packets
+	std::deque<std::shared_ptr<StreamPacket>>   _priority_packet_queue;
+	// Normal and Video packets
+	std::deque<std::shared_ptr<StreamPacket>>   _packet_queue;
+	mutable ov::ProfiledMutex   _packet_queue_guard { "StreamWorker::_packet_queue_guard" };
+	// The Video packets are dropped until a sync point is queued
+	bool                _waiting_for_sync_point = false;
+	// The next Video packet follows the dropped packets
+	bool                _video_discontinuity = false;
+	std::atomic<uint64_t>   _dropped_packet_count { 0 };
+	// Size of the queues, updated with _packet_queue_guard (so it can be read without the lock)
+	std::atomic<size_t>     _queue_size { 0 };
+	std::atomic<size_t>     _queue_bytes { 0 };
+	std::atomic<uint64_t>   _sent_packet_count { 0 };
+	std::atomic<uint64_t>   _sent_bytes { 0 };
 
-	std::shared_ptr<StreamPacket> PopStreamPacket();
+	// One timer wheel drives the pacers of all sessions of this worker (the worker thread only)
+	ov::TimerWheel              _timer_wheel;
+	// Sessions which are already scheduled to the timer wheel
+	std::set<session_id_t>      _paced_sessions;
+	// The report timer is scheduled to the timer wheel
+	bool                        _report_scheduled = false;
 
-	std::queue<std::shared_ptr<StreamPacket>>   _packet_queue;
-	std::mutex      _packet_queue_guard;
+	// Packets which are sent since the last sync point, the payloads are shared with the sessions (the worker thread only)
+	std::vector<std::shared_ptr<StreamPacket>>  _gop_cache;
+	// false until the next sync point (e.g. the packets are dropped by the worker)
+	bool                        _gop_cache_valid = false;
+	std::atomic<size_t>         _gop_cache_packet_count { 0 };
+	std::atomic<size_t>         _gop_cache_bytes { 0 };
 
-	bool            _stop_thread_flag;
-	std::thread     _worker_thread;
+	std::atomic<bool>       _stop_flag { true };
+	// Held while a thread of the pool runs the worker ("the worker thread" is the thread which holds it)
+	std::mutex              _run_guard;
+	// Queued to (or running on) the pool
+	std::atomic<bool>       _scheduled { false };
+	// The worker must run again (e.g. the packets are queued while it is running)
+	std::atomic<bool>       _run_requested { false };
+	// Time of the earliest timer of the pool for the pacers (StreamWorkerPool::_mutex must be locked)
+	int64_t                 _timer_time = -1;
+	// Batch of Run() (the worker thread only)
+	std::vector<std::shared_ptr<StreamPacket>> _run_packets;
+
+	std::atomic<size_t>     _session_count { 0 };
+	// Moving average of the time to send a batch to a session (nano seconds)
+	std::atomic<uint64_t>   _send_time_per_session { 0 };
+
+	std::shared_ptr<StreamLatencyStatistics> _latency_statistics;
+	std::shared_ptr<ApplicationQuotaStatistics> _quota_statistics;
 
 	std::shared_ptr<Stream> _parent;
 };
@@ -62,25 +232,43 @@ public:
 	// Session을 추가한다.
 	bool AddSession(std::shared_ptr<Session> session);
 	bool RemoveSession(session_id_t id);
+	// Removes the sessions at once (each worker is locked once), returns the number of the removed sessions
+	size_t RemoveSessions(const std::vector<session_id_t> &ids);
+	size_t RemoveAllSessions();
 	std::shared_ptr<Session> GetSession(session_id_t id);
 	const std::map<session_id_t, std::shared_ptr<Session>> &GetAllSessions();
 
 	// Child call this function to delivery packet to all sessions
-	bool BroadcastPacket(uint32_t packet_type, std::shared_ptr<ov::Data> packet);
+	// The packet is shared by all sessions without copying, so it must not be modified after this call
+	bool BroadcastPacket(uint32_t packet_type, const std::shared_ptr<const ov::Data> &packet,
+	                     StreamPacketPriority priority = StreamPacketPriority::Normal, bool is_sync_point = false);
 
 	// Child must implement this function for packetizing and call BroadcastPacket to delivery to all sessions.
 	virtual void SendVideoFrame(std::shared_ptr<MediaTrack> track,
-	                            std::unique_ptr<EncodedFrame> encoded_frame,
-	                            std::unique_ptr<CodecSpecificInfo> codec_info,
-	                            std::unique_ptr<FragmentationHeader> fragmentation) = 0;
+	                            std::unique_ptr<EncodedFrameDescriptor> frame) = 0;
 
 	virtual void SendAudioFrame(std::shared_ptr<MediaTrack> track,
-	                            std::unique_ptr<EncodedFrame> encoded_frame,
-	                            std::unique_ptr<CodecSpecificInfo> codec_info,
-	                            std::unique_ptr<FragmentationHeader> fragmentation) = 0;
+	                            std::unique_ptr<EncodedFrameDescriptor> frame) = 0;
 
 	virtual bool Start(uint32_t worker_count);
 	virtual bool Stop();
+
+	// If enabled, the sessions are moved from the busiest worker to the idlest one when a session is removed
+	void SetSessionRebalance(bool enabled);
+	void GetWorkerLoads(std::vector<StreamWorkerLoad> &loads);
+	StreamMetrics GetMetrics() const;
+	// session id, bytes of the session
+	void GetSessionMemoryUsage(std::vector<std::pair<session_id_t, size_t>> &sessions);
+	// Bytes of the data which the publisher keeps for the stream (e.g. the segments of HLS/DASH)
+	virtual size_t GetStoreMemoryUsage()
+	{
+		return 0;
+	}
+
+	// Latencies of the stream (PublisherQueue is recorded by the application, Send is recorded by the workers)
+	const std::shared_ptr<StreamLatencyStatistics> &GetLatencyStatistics() const;
+	// QoE of the players of the stream (shared by the publishers of the stream)
+	const std::shared_ptr<StreamQoeStatistics> &GetQoeStatistics() const;
 protected:
 	Stream(const std::shared_ptr<Application> application, const StreamInfo &info);
 	virtual ~Stream();
@@ -88,11 +276,33 @@ protected:
 	std::shared_ptr<Application>    GetApplication();
 
 private:
-	StreamWorker&                   GetWorkerByStreamID(session_id_t session_id);
+	// The worker of the index (nullptr if it is removed)
+	std::shared_ptr<StreamWorker>   GetWorker(uint32_t index) const;
+	// Returns the worker that the session has been placed on
+	std::shared_ptr<StreamWorker>   GetWorkerBySessionID(session_id_t session_id);
+	// Returns the index of the least loaded worker of [0, worker_count)
+	// (the functions below must be called with _session_worker_map_guard)
+	uint32_t                        SelectWorkerIndex(uint32_t worker_count);
+	void                            Rebalance();
+	// Adds a worker if the workers are less than _max_worker_count
+	bool                            AddWorker();
+	// Merges the last worker into the others if they can take its load
+	void                            ShrinkWorkers();
+
 	std::map<session_id_t, std::shared_ptr<Session>> _sessions;
 
-	uint32_t                        _worker_count;
+	// session id -> index of _stream_workers
+	std::map<session_id_t, uint32_t> _session_worker_map;
+	std::mutex                      _session_worker_map_guard;
+	bool                            _session_rebalance;
+
+	// The workers of [0, _worker_count) receive the packets (std::atomic_load/atomic_store only for the elements)
+	std::vector<std::shared_ptr<StreamWorker>> _stream_workers;
+	uint32_t                        _max_worker_count = 0;
+	std::atomic<uint32_t>           _worker_count { 0 };
 	bool                            _run_flag;
-	StreamWorker                    _stream_workers[MAX_STREAM_THREAD_COUNT];
 	std::shared_ptr<Application>    _application;
+	std::shared_ptr<StreamLatencyStatistics> _latency_statistics;
+	std::shared_ptr<ApplicationQuotaStatistics> _quota_statistics;
+	std::shared_ptr<StreamQoeStatistics> _qoe_statistics;
 };
\ No newline at end of file
@@ -0,0 +1,208 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "publisher_private.h"
+#include "stream_worker_pool.h"
+#include "stream.h"
+
+#include <algorithm>
+#include <chrono>
+
+StreamWorkerPool::~StreamWorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		_stop = true;
+		_condition.notify_all();
+	}
+
+	for(auto &thread : _threads)
+	{
+		if(thread.joinable())
+		{
+			thread.join();
+		}
+	}
+
+	_run_queue.clear();
+	_timers.clear();
+}
+
+void StreamWorkerPool::Schedule(const std::shared_ptr<StreamWorker> &worker)
+{
+	if((worker == nullptr) || (worker->RequestRun() == false))
+	{
+		// It is queued (or running) already
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	StartThreads();
+
+	_run_queue.push_back(worker);
+	_condition.notify_one();
+}
+
+size_t StreamWorkerPool::GetThreadCount() const
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	return _threads.size();
+}
+
+void StreamWorkerPool::StartThreads()
+{
+	if(_started)
+	{
+		return;
+	}
+
+	_started = true;
+
+	uint32_t thread_count = std::max(std::thread::hardware_concurrency(), static_cast<uint32_t>(MIN_STREAM_THREAD_COUNT));
+	thread_count = std::min(thread_count, static_cast<uint32_t>(MAX_STREAM_THREAD_COUNT));
+
+	for(uint32_t index = 0; index < thread_count; index++)
+	{
+		_threads.emplace_back(&StreamWorkerPool::ThreadProc, this, index);
+	}
+
+	logti("%u threads are started for the stream workers", thread_count);
+}
+
+int64_t StreamWorkerPool::ProcessTimers(int64_t current_time)
+{
+	while(_timers.empty() == false)
+	{
+		auto item = _timers.begin();
+
+		if(item->first > current_time)
+		{
+			return item->first;
+		}
+
+		auto worker = item->second.lock();
+
+		// The worker keeps the time of its earliest timer, the later ones are just removed
+		if((worker != nullptr) && (worker->_timer_time == item->first))
+		{
+			worker->_timer_time = -1;
+
+			if(worker->RequestRun())
+			{
+				_run_queue.push_back(worker);
+			}
+		}
+
+		_timers.erase(item);
+	}
+
+	return -1;
+}
+
+std::shared_ptr<StreamWorker> StreamWorkerPool::PopWorker()
+{
+	auto quota = ApplicationQuota::Instance();
+	int64_t current_time = ApplicationQuota::GetCurrentMilliseconds();
+	uint32_t thread_count = static_cast<uint32_t>(_threads.size());
+	auto item = _run_queue.begin();
+
+	for(; item != _run_queue.end(); ++item)
+	{
+		if(quota->IsOverShare((*item)->GetQuotaStatistics(), ApplicationQuotaScheduler::StreamWorker, current_time, thread_count) == false)
+		{
+			break;
+		}
+	}
+
+	if(item == _run_queue.end())
+	{
+		// All are over their share, the worker doesn't wait for the next window (the threads would be idle)
+		item = _run_queue.begin();
+	}
+	else if((item != _run_queue.begin()) && (_run_queue.front()->GetQuotaStatistics() != nullptr))
+	{
+		_run_queue.front()->GetQuotaStatistics()->AddDeferredCount(ApplicationQuotaScheduler::StreamWorker);
+	}
+
+	auto worker = std::move(*item);
+	_run_queue.erase(item);
+
+	return worker;
+}
+
+void StreamWorkerPool::ThreadProc(uint32_t index)
+{
+	// Bound before the buffers of the thread are allocated
+	ov::ThreadTopology::Instance()->BindCurrentThread(OV_THREAD_POOL_STREAM_WORKER, index);
+
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while(_stop == false)
+	{
+		int64_t current_time = StreamWorker::GetCurrentMilliseconds();
+		int64_t next_timer_time = ProcessTimers(current_time);
+
+		if(_run_queue.empty())
+		{
+			if(next_timer_time < 0)
+			{
+				_condition.wait(lock);
+			}
+			else
+			{
+				_condition.wait_for(lock, std::chrono::milliseconds(next_timer_time - current_time));
+			}
+
+			continue;
+		}
+
+		auto worker = PopWorker();
+
+		if(_run_queue.empty() == false)
+		{
+			// The other threads take the rest
+			_condition.notify_one();
+		}
+
+		lock.unlock();
+
+		int64_t timer_time = -1;
+		auto start_time = std::chrono::steady_clock::now();
+		bool run_again = worker->Run(timer_time);
+		auto &quota_statistics = worker->GetQuotaStatistics();
+
+		if(quota_statistics != nullptr)
+		{
+			quota_statistics->AddBusyTime(ApplicationQuotaScheduler::StreamWorker, ApplicationQuota::GetCurrentMilliseconds(),
+										  std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count());
+		}
+
+		lock.lock();
+
+		if(run_again)
+		{
+			// Behind the other workers, so a busy stream doesn't starve them
+			_run_queue.push_back(worker);
+		}
+
+		if((timer_time >= 0) && ((worker->_timer_time < 0) || (timer_time < worker->_timer_time)))
+		{
+			worker->_timer_time = timer_time;
+
+			auto item = _timers.emplace(timer_time, worker);
+
+			if(item == _timers.begin())
+			{
+				// The waiting threads sleep until the previous timer
+				_condition.notify_one();
+			}
+		}
+	}
+}
@@ -0,0 +1,64 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "base/ovlibrary/ovlibrary.h"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class StreamWorker;
+
+// Threads which run the StreamWorkers of all streams
+//
+// - A worker is queued when it has packets to send or its pacing timer expires, and it runs on one thread at a time
+// - The streams with a few sessions share the threads instead of owning them, and a busy stream spreads
+//   its sessions over several workers (see Stream::AddSession())
+// - The workers of an application which exceeds its weighted share of the window (see ApplicationQuota)
+//   run after the workers of the other applications
+class StreamWorkerPool : public ov::Singleton<StreamWorkerPool>
+{
+public:
+	friend class ov::Singleton<StreamWorkerPool>;
+
+	// The queued workers are not run after this
+	~StreamWorkerPool() override;
+
+	// Queues the worker if StreamWorker::RequestRun() returns true
+	void Schedule(const std::shared_ptr<StreamWorker> &worker);
+
+	size_t GetThreadCount() const;
+
+protected:
+	StreamWorkerPool() = default;
+
+	// _mutex must be locked
+	void StartThreads();
+	// Queues the workers of the expired timers, returns the time of the next timer (-1 if there is no timer)
+	// (_mutex must be locked)
+	int64_t ProcessTimers(int64_t current_time);
+	// Pops the first worker of the applications under their share (the first worker if there is none)
+	// (_mutex must be locked)
+	std::shared_ptr<StreamWorker> PopWorker();
+	void ThreadProc(uint32_t index);
+
+	mutable std::mutex _mutex;
+	std::condition_variable _condition;
+
+	std::deque<std::shared_ptr<StreamWorker>> _run_queue;
+	// key: time (ms) when the worker runs for its pacers
+	std::multimap<int64_t, std::weak_ptr<StreamWorker>> _timers;
+
+	bool _started = false;
+	bool _stop = false;
+	std::vector<std::thread> _threads;
+};
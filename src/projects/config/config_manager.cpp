@@ -40,6 +40,8 @@ namespace cfg
 			config_path = ov::PathManager::GetAppPath("conf");
 		}
 
+		_config_path = config_path;
+
 		PrepareMacros();
 
 		// Load Logger
@@ -67,6 +69,36 @@ namespace cfg
 		return LoadConfigs("");
 	}
 
+	std::shared_ptr<Server> ConfigManager::ReloadConfigs()
+	{
+		// Apply the levels of the log tags too
+		if(LoadLoggerConfig(_config_path) == false)
+		{
+			logtw("Could not reload Logger.xml, the previous log settings are used");
+		}
+
+		ov::String server_config_path = ov::PathManager::Combine(_config_path, "Server.xml");
+		logti("Trying to reload configurations... (%s)", server_config_path.CStr());
+
+		auto server = std::make_shared<cfg::Server>();
+
+		if(server->Parse(server_config_path, "Server") == false)
+		{
+			logte("Could not parse %s, the current configurations are kept", server_config_path.CStr());
+			return nullptr;
+		}
+
+		if(IsValidVersion("Server", server->GetVersion().CStr()) == false)
+		{
+			return nullptr;
+		}
+
+		_previous_servers.push_back(_server);
+		_server = server;
+
+		return _server;
+	}
+
 	void ConfigManager::PrepareMacros()
 	{
 		_macros.clear();
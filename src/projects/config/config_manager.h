@@ -10,6 +10,8 @@
 
 #include "items/items.h"
 
+#include <atomic>
+
 namespace cfg
 {
 	class ConfigManager : public ov::Singleton<ConfigManager>
@@ -22,6 +24,23 @@ namespace cfg
 		// Load configs from default path (<binary_path>/conf/*)
 		bool LoadConfigs();
 
+		// Parses the configs again from the path of LoadConfigs()
+		// - Returns the new server config, or nullptr if it is invalid (the current config is kept)
+		// - The previous configs are kept, because the running modules refer to the items of them
+		std::shared_ptr<Server> ReloadConfigs();
+
+		// Called by the signal handler (SIGHUP) and the admin API, the reload is done by the main thread
+		void RequestReload() noexcept
+		{
+			_reload_requested = true;
+		}
+
+		// Returns whether the reload is requested, and clears the request
+		bool CheckReloadRequested() noexcept
+		{
+			return _reload_requested.exchange(false);
+		}
+
 		std::shared_ptr<Server> GetServer() noexcept
 		{
 			return _server;
@@ -53,7 +72,12 @@ namespace cfg
 
 		bool IsValidVersion(const std::string& name, const std::string& version);
 
+		ov::String _config_path;
 		std::shared_ptr<Server> _server;
+		std::vector<std::shared_ptr<Server>> _previous_servers;
+
+		// Lock-free, so it can be set from the signal handler
+		std::atomic<bool> _reload_requested { false };
 		std::map<ov::String, ov::String> _macros;
 
 		timespec _last_modified;
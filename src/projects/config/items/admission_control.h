@@ -0,0 +1,55 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "url.h"
+
+namespace cfg
+{
+	// Limits of the load to accept a new WebRTC viewer (0: unlimited)
+	struct AdmissionControl : public Item
+	{
+		// Mbps
+		int GetMaxEgressBitrate() const
+		{
+			return _max_egress_bitrate;
+		}
+
+		// %
+		int GetMaxCpuUsage() const
+		{
+			return _max_cpu_usage;
+		}
+
+		// ms
+		int GetMaxSendLatency() const
+		{
+			return _max_send_latency;
+		}
+
+		// Less loaded edges to redirect the viewer which is not accepted
+		const std::vector<Url> &GetRedirectUrls() const
+		{
+			return _redirect_url_list;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("MaxEgressBitrate", &_max_egress_bitrate);
+			RegisterValue<Optional>("MaxCpuUsage", &_max_cpu_usage);
+			RegisterValue<Optional>("MaxSendLatency", &_max_send_latency);
+			RegisterValue<Optional>("RedirectUrl", &_redirect_url_list);
+		}
+
+		int _max_egress_bitrate = 0;
+		int _max_cpu_usage = 0;
+		int _max_send_latency = 0;
+		std::vector<Url> _redirect_url_list;
+	};
+}
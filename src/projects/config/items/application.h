@@ -15,6 +15,8 @@
 #include "streams.h"
 #include "providers.h"
 #include "publishers.h"
+#include "quota.h"
+#include "qoe.h"
 
 namespace cfg
 {
@@ -81,6 +83,16 @@ namespace cfg
 			return _encodes.GetEncodes();
 		}
 
+		const bool IsKeyFrameSyncEnabled() const
+		{
+			return _encodes.IsKeyFrameSync();
+		}
+
+		const int GetKeyFrameSyncInterval() const
+		{
+			return _encodes.GetKeyFrameInterval();
+		}
+
 		const std::vector<Stream> &GetStreamList() const
 		{
 			return _streams.GetStreamList();
@@ -101,6 +113,32 @@ namespace cfg
 			return _publishers.GetThreadCount();
 		}
 
+		const int GetAppWorkerCount() const
+		{
+			return _publishers.GetAppWorkerCount();
+		}
+
+		const bool IsSessionRebalanceEnabled() const
+		{
+			return _publishers.IsSessionRebalanceEnabled();
+		}
+
+		// Number of the router threads that streams of the application are distributed to (0: number of the CPU cores)
+		int GetRouterWorkerCount() const
+		{
+			return _router_worker_count;
+		}
+
+		const Quota &GetQuota() const
+		{
+			return _quota;
+		}
+
+		const Qoe &GetQoe() const
+		{
+			return _qoe;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
@@ -113,6 +151,9 @@ namespace cfg
 			RegisterValue<Optional>("Streams", &_streams);
 			RegisterValue<Optional>("Providers", &_providers);
 			RegisterValue<Optional>("Publishers", &_publishers);
+			RegisterValue<Optional>("RouterWorkerCount", &_router_worker_count);
+			RegisterValue<Optional>("Quota", &_quota);
+			RegisterValue<Optional>("QoE", &_qoe);
 		}
 
 		ov::String _name;
@@ -124,5 +165,8 @@ namespace cfg
 		Streams _streams;
 		Providers _providers;
 		Publishers _publishers;
+		int _router_worker_count = 1;
+		Quota _quota;
+		Qoe _qoe;
 	};
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "../item.h"
+#include "opus_profile.h"
 
 namespace cfg
 {
@@ -44,6 +45,12 @@ namespace cfg
 			return _channel;
 		}
 
+		// Used only if the codec is opus
+		const OpusProfile &GetOpus() const
+		{
+			return _opus;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
@@ -53,6 +60,7 @@ namespace cfg
 			RegisterValue("Bitrate", &_bitrate);
 			RegisterValue("Samplerate", &_samplerate);
 			RegisterValue("Channel", &_channel);
+			RegisterValue<Optional>("Opus", &_opus);
 		}
 
 		bool _bypass = false;
@@ -61,5 +69,6 @@ namespace cfg
 		ov::String _bitrate;
 		int _samplerate = 0;
 		int _channel = 0;
+		OpusProfile _opus;
 	};
 }
\ No newline at end of file
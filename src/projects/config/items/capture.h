@@ -0,0 +1,47 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "../item.h"
+
+namespace cfg
+{
+	// The packets which are received by the providers are recorded to <Path>/<application>_<stream>_<time>.ovcap,
+	// which can be replayed by <Providers><Replay> (see StreamCaptureWriter)
+	struct Capture : public Item
+	{
+		ov::String GetPath() const
+		{
+			return _path;
+		}
+
+		// Names of the streams, separated by ',' (empty: all the streams)
+		ov::String GetStreams() const
+		{
+			return _streams;
+		}
+
+		// MB per file (0: unlimited), the rest of the stream is not recorded
+		int GetMaxSize() const
+		{
+			return _max_size;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue("Path", &_path);
+			RegisterValue<Optional>("Streams", &_streams);
+			RegisterValue<Optional>("MaxSize", &_max_size);
+		}
+
+		ov::String _path;
+		ov::String _streams;
+		int _max_size = 1024;
+	};
+}
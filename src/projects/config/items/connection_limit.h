@@ -0,0 +1,49 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+namespace cfg
+{
+	// Limits of the new TCP connections of the ports (see ov::ConnectionLimit)
+	//
+	// <ConnectionLimit>
+	//     <RatePerIp>20</RatePerIp>                         <!-- New connections per second from an IP address -->
+	//     <BurstPerIp>100</BurstPerIp>                      <!-- Optional, same as RatePerIp if it is omitted -->
+	//     <MaxPendingHandshakes>1000</MaxPendingHandshakes> <!-- HTTP/HTTPS connections which haven't sent a request yet -->
+	// </ConnectionLimit>
+	struct ConnectionLimit : public Item
+	{
+		// 0: unlimited
+		int GetRatePerIp() const
+		{
+			return _rate_per_ip;
+		}
+
+		int GetBurstPerIp() const
+		{
+			return _burst_per_ip;
+		}
+
+		int GetMaxPendingHandshakes() const
+		{
+			return _max_pending_handshakes;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("RatePerIp", &_rate_per_ip);
+			RegisterValue<Optional>("BurstPerIp", &_burst_per_ip);
+			RegisterValue<Optional>("MaxPendingHandshakes", &_max_pending_handshakes);
+		}
+
+		int _rate_per_ip = 0;
+		int _burst_per_ip = 0;
+		int _max_pending_handshakes = 0;
+	};
+}
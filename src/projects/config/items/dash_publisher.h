@@ -11,6 +11,7 @@
 #include "publisher.h"
 #include "tls.h"
 #include "cross_domain.h"
+#include "segment_upload.h"
 
 namespace cfg
 {
@@ -31,11 +32,59 @@ namespace cfg
 			return _segment_duration;
 		}
 
+		// A segment can be cut at the key frame up to the tolerance before the segment duration,
+		// when it is nearer to the duration than the next key frame (milliseconds, 0: the first key frame after the duration)
+		int GetSegmentTolerance() const
+		{
+			return _segment_tolerance;
+		}
+
+		bool IsLowLatencyEnabled() const
+		{
+			return _low_latency;
+		}
+
+		// Duration of the CMAF chunks of low latency DASH (milliseconds)
+		int GetChunkDuration() const
+		{
+			return (_chunk_duration > 0) ? _chunk_duration : 500;
+		}
+
+		// Memory of the segments of a stream (MB, 0: unlimited)
+		int GetSegmentMemoryLimit() const
+		{
+			return _segment_memory_limit;
+		}
+
+		// Memory of the segments of all streams (MB, 0: unlimited)
+		int GetTotalSegmentMemoryLimit() const
+		{
+			return _total_segment_memory_limit;
+		}
+
+		// JPEG of the latest key frame (<stream>/thumb.jpg), which is decoded only when it is requested
+		bool IsThumbnailEnabled() const
+		{
+			return _thumbnail;
+		}
+
+		// Width of the thumbnail (0: width of the stream)
+		int GetThumbnailWidth() const
+		{
+			return _thumbnail_width;
+		}
+
 		const std::vector<Url> &GetCrossDomains() const
 		{
 			return _cross_domain.GetUrls();
 		}
 
+		// Push of the segments and the playlists to the ingest endpoints (origin/CDN)
+		const SegmentUpload &GetUpload() const
+		{
+			return _upload;
+		}
+
 		int GetThreadCount() const
 		{
 			return _thread_count > 0 ? _thread_count : 1;
@@ -51,6 +100,18 @@ namespace cfg
 			return _recv_buffer_size;
 		}
 
+		// SO_MAX_PACING_RATE of the connections (kbps, 0: unlimited)
+		int GetMaxPacingRate() const
+		{
+			return _max_pacing_rate;
+		}
+
+		// HTTP/2 over TLS (ALPN "h2"), the players which don't support it use HTTP/1.1
+		bool IsHttp2Enabled() const
+		{
+			return _http2;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
@@ -58,17 +119,37 @@ namespace cfg
 
 			RegisterValue<Optional>("SegmentCount", &_segment_count);
 			RegisterValue<Optional>("SegmentDuration", &_segment_duration);
+			RegisterValue<Optional>("SegmentTolerance", &_segment_tolerance);
+			RegisterValue<Optional>("LowLatency", &_low_latency);
+			RegisterValue<Optional>("ChunkDuration", &_chunk_duration);
+			RegisterValue<Optional>("SegmentMemoryLimit", &_segment_memory_limit);
+			RegisterValue<Optional>("TotalSegmentMemoryLimit", &_total_segment_memory_limit);
+			RegisterValue<Optional>("Thumbnail", &_thumbnail);
+			RegisterValue<Optional>("ThumbnailWidth", &_thumbnail_width);
 			RegisterValue<Optional>("CrossDomain", &_cross_domain);
+			RegisterValue<Optional>("Upload", &_upload);
 			RegisterValue<Optional>("ThreadCount", &_thread_count);
 			RegisterValue<Optional>("SendBufferSize", &_send_buffer_size);
 			RegisterValue<Optional>("RecvBufferSize", &_recv_buffer_size);
+			RegisterValue<Optional>("MaxPacingRate", &_max_pacing_rate);
+			RegisterValue<Optional>("Http2", &_http2);
 		}
 
 		int _segment_count = 3;
 		int _segment_duration = 5;
+		int _segment_tolerance = 0;
+		bool _low_latency = false;
+		int _chunk_duration = 500;
+		int _segment_memory_limit = 0;
+		int _total_segment_memory_limit = 0;
+		bool _thumbnail = true;
+		int _thumbnail_width = 0;
 		CrossDomain _cross_domain;
+		SegmentUpload _upload;
 		int _thread_count = 4;
 		int _send_buffer_size = 1024 * 1024 * 20; // 20M
 		int _recv_buffer_size = 0;
+		int _max_pacing_rate = 0;
+		bool _http2 = true;
 	};
 }
@@ -0,0 +1,63 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "../item.h"
+
+namespace cfg
+{
+	// Directory of the streams which is shared by the nodes of the cluster over UDP multicast (see RelayDirectory)
+	struct Discovery : public Item
+	{
+		// <multicast group>:<port>
+		ov::String GetAddress() const
+		{
+			return _address;
+		}
+
+		// IP of the interface which sends/receives the announcements (empty: the default interface)
+		ov::String GetInterface() const
+		{
+			return _interface;
+		}
+
+		// IP which the other nodes use to connect to the origin port of this node
+		// (empty: the source address of the announcements)
+		ov::String GetAdvertiseIp() const
+		{
+			return _advertise_ip;
+		}
+
+		// The streams are announced in this interval (in milliseconds)
+		int GetInterval() const
+		{
+			return _interval;
+		}
+
+		int GetTtl() const
+		{
+			return _ttl;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue("Address", &_address);
+			RegisterValue<Optional>("Interface", &_interface);
+			RegisterValue<Optional>("AdvertiseIP", &_advertise_ip);
+			RegisterValue<Optional>("Interval", &_interval);
+			RegisterValue<Optional>("TTL", &_ttl);
+		}
+
+		ov::String _address;
+		ov::String _interface;
+		ov::String _advertise_ip;
+		int _interval = 1000;
+		int _ttl = 1;
+	};
+}
@@ -0,0 +1,53 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+namespace cfg
+{
+	// Graceful drain by SIGTERM (see ov::DrainMode), SIGTERM terminates the process immediately if it is not configured
+	struct Drain : public Item
+	{
+		// ms
+		int GetTimeout() const
+		{
+			return _timeout;
+		}
+
+		// ms
+		int GetStaggerWindow() const
+		{
+			return _stagger_window;
+		}
+
+		// Seconds
+		int GetRetryAfter() const
+		{
+			return _retry_after;
+		}
+
+		// Url of the other nodes (ex: the load balancer) for the playlists of HLS/DASH
+		const ov::String &GetRedirectUrl() const
+		{
+			return _redirect_url;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("Timeout", &_timeout);
+			RegisterValue<Optional>("StaggerWindow", &_stagger_window);
+			RegisterValue<Optional>("RetryAfter", &_retry_after);
+			RegisterValue<Optional>("RedirectUrl", &_redirect_url);
+		}
+
+		int _timeout = 30000;
+		int _stagger_window = 10000;
+		int _retry_after = 5;
+		ov::String _redirect_url;
+	};
+}
@@ -19,12 +19,28 @@ namespace cfg
 			return _encode_list;
 		}
 
+		// All video renditions have the key frames at the same timestamps, and the segments are cut at them (ABR)
+		bool IsKeyFrameSync() const
+		{
+			return _key_frame_sync;
+		}
+
+		// Interval of the synchronized key frames (milliseconds, 0: the key frames of the input are used)
+		int GetKeyFrameInterval() const
+		{
+			return _key_frame_interval;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
+			RegisterValue<Optional>("KeyFrameSync", &_key_frame_sync);
+			RegisterValue<Optional>("KeyFrameInterval", &_key_frame_interval);
 			RegisterValue<Optional>("Encode", &_encode_list);
 		}
 
 		std::vector<Encode> _encode_list;
+		bool _key_frame_sync = false;
+		int _key_frame_interval = 0;
 	};
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "tls.h"
+#include "discovery.h"
 #include "ports.h"
 #include "providers.h"
 #include "publishers.h"
@@ -38,11 +39,22 @@ namespace cfg
 			return _ports;
 		}
 
+		const Discovery &GetDiscovery() const
+		{
+			return _discovery;
+		}
+
 		const std::vector<Application> &GetApplications() const
 		{
 			return _applications.GetApplications();
 		}
 
+		// Number of the threads which run the transcode streams (0: number of the cores)
+		int GetTranscodeWorkerCount() const
+		{
+			return _transcode_worker_count;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
@@ -50,13 +62,17 @@ namespace cfg
 			RegisterValue("IP", &_ip);
 			RegisterValue<Optional>("TLS", &_tls);
 			RegisterValue<Optional>("Ports", &_ports);
+			RegisterValue<Optional>("Discovery", &_discovery);
 			RegisterValue<Optional>("Applications", &_applications);
+			RegisterValue<Optional>("TranscodeWorkerCount", &_transcode_worker_count);
 		}
 		
 		ov::String _name;
 		ov::String _ip;
 		Tls _tls;
 		Ports _ports;
+		Discovery _discovery;
 		Applications _applications;
+		int _transcode_worker_count = 0;
 	};
 }
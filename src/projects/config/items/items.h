@@ -8,13 +8,18 @@
 //==============================================================================
 #pragma once
 
+#include "admission_control.h"
 #include "application.h"
 #include "applications.h"
 #include "audio_profile.h"
+#include "capture.h"
+#include "connection_limit.h"
 #include "cross_domain.h"
 #include "dash_publisher.h"
 #include "decode.h"
 #include "decode_video.h"
+#include "discovery.h"
+#include "drain.h"
 #include "encode.h"
 #include "encodes.h"
 #include "hls_publisher.h"
@@ -22,20 +27,36 @@
 #include "hosts.h"
 #include "ice_candidate.h"
 #include "ice_candidates.h"
+#include "jitter_buffer.h"
+#include "memory_governor.h"
+#include "opus_profile.h"
 #include "origin.h"
+#include "payload_encryption.h"
+#include "playout_delay.h"
 #include "port.h"
 #include "ports.h"
+#include "prewarm.h"
 #include "provider.h"
 #include "providers.h"
 #include "publisher.h"
+#include "publisher_queue.h"
 #include "publishers.h"
+#include "qoe.h"
+#include "quota.h"
+#include "reconnect.h"
+#include "replay_provider.h"
 #include "rtmp_provider.h"
 #include "rtmp_publisher.h"
+#include "rtmp_push.h"
+#include "segment_upload.h"
 #include "server.h"
+#include "srt_provider.h"
 #include "stream.h"
 #include "stream_profile.h"
 #include "stream_profiles.h"
 #include "streams.h"
+#include "thread_pool.h"
+#include "thread_topology.h"
 #include "tls.h"
 #include "url.h"
 #include "video_profile.h"
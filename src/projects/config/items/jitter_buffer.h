@@ -0,0 +1,44 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+namespace cfg
+{
+	// Reordering buffer of the packets from the providers (MediaRouteStream)
+	struct JitterBuffer : public Item
+	{
+		bool IsEnabled() const
+		{
+			return _enabled;
+		}
+
+		// The packets are held up to this time (ms) to wait for the packets of the other tracks
+		int GetLatency() const
+		{
+			return _latency;
+		}
+
+		// The timeline of a track is rebased if the timestamp jumps more than this time (ms)
+		int GetDriftThreshold() const
+		{
+			return _drift_threshold;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("Enable", &_enabled);
+			RegisterValue<Optional>("Latency", &_latency);
+			RegisterValue<Optional>("DriftThreshold", &_drift_threshold);
+		}
+
+		bool _enabled = false;
+		int _latency = 200;
+		int _drift_threshold = 3000;
+	};
+}
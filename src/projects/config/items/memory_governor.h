@@ -0,0 +1,74 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+namespace cfg
+{
+	// Load shedding by the memory usage (see ov::MemoryGovernor)
+	struct MemoryGovernor : public Item
+	{
+		// MB (0: the limit of the cgroup)
+		int GetLimit() const
+		{
+			return _limit;
+		}
+
+		// Usage (%) of the limit to enter each stage (0: the stage is not used)
+		int GetShrinkThreshold() const
+		{
+			return _shrink_threshold;
+		}
+
+		int GetCapQueuesThreshold() const
+		{
+			return _cap_queues_threshold;
+		}
+
+		int GetRefuseNewThreshold() const
+		{
+			return _refuse_new_threshold;
+		}
+
+		int GetShedStreamsThreshold() const
+		{
+			return _shed_streams_threshold;
+		}
+
+		// PSI of the memory ("some avg10", %) to raise the stage by one (0: not used)
+		int GetPressureThreshold() const
+		{
+			return _pressure_threshold;
+		}
+
+		// ms
+		int GetInterval() const
+		{
+			return _interval;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("Limit", &_limit);
+			RegisterValue<Optional>("ShrinkThreshold", &_shrink_threshold);
+			RegisterValue<Optional>("CapQueuesThreshold", &_cap_queues_threshold);
+			RegisterValue<Optional>("RefuseNewThreshold", &_refuse_new_threshold);
+			RegisterValue<Optional>("ShedStreamsThreshold", &_shed_streams_threshold);
+			RegisterValue<Optional>("PressureThreshold", &_pressure_threshold);
+			RegisterValue<Optional>("Interval", &_interval);
+		}
+
+		int _limit = 0;
+		int _shrink_threshold = 75;
+		int _cap_queues_threshold = 85;
+		int _refuse_new_threshold = 90;
+		int _shed_streams_threshold = 95;
+		int _pressure_threshold = 0;
+		int _interval = 1000;
+	};
+}
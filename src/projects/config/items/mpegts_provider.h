@@ -0,0 +1,93 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "provider.h"
+#include "port.h"
+
+namespace cfg
+{
+	struct MpegtsStream : public Item
+	{
+		const ov::String &GetName() const
+		{
+			return _name;
+		}
+
+		// A port per stream (the datagrams of a port are a TS)
+		const Port &GetPort() const
+		{
+			return _port;
+		}
+
+		// IPv4 multicast group to join (empty: unicast to the IP of the host)
+		const ov::String &GetMulticastGroup() const
+		{
+			return _multicast_group;
+		}
+
+		// Address of the interface which receives the group (empty: the interface is selected by the routing table)
+		const ov::String &GetInterface() const
+		{
+			return _interface;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue("Name", &_name);
+			RegisterValue("Port", &_port);
+			RegisterValue<Optional>("MulticastGroup", &_multicast_group);
+			RegisterValue<Optional>("Interface", &_interface);
+		}
+
+		ov::String _name;
+		Port _port { "4000/udp" };
+		ov::String _multicast_group;
+		ov::String _interface;
+	};
+
+	struct MpegtsProvider : public Provider
+	{
+		ProviderType GetType() const override
+		{
+			return ProviderType::Mpegts;
+		}
+
+		const std::vector<MpegtsStream> &GetStreams() const
+		{
+			return _stream_list;
+		}
+
+		// The stream is deleted if no datagram is received for the time (ms), and it is created again by the next datagram
+		int GetStreamTimeout() const
+		{
+			return _stream_timeout;
+		}
+
+		// SO_RCVBUF of the ports (KB)
+		int GetReceiveBufferSize() const
+		{
+			return _receive_buffer_size;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			Provider::MakeParseList();
+
+			RegisterValue("Stream", &_stream_list);
+			RegisterValue<Optional>("StreamTimeout", &_stream_timeout);
+			RegisterValue<Optional>("ReceiveBufferSize", &_receive_buffer_size);
+		}
+
+		std::vector<MpegtsStream> _stream_list;
+		int _stream_timeout = 3000;
+		int _receive_buffer_size = 4096;
+	};
+}
@@ -0,0 +1,184 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "port.h"
+#include "publisher.h"
+
+namespace cfg
+{
+	struct MpegtsPush : public Item
+	{
+		// <ip>:<port> of the receivers (an IPv4 multicast group or a unicast address)
+		ov::String GetAddress() const
+		{
+			return _address;
+		}
+
+		// Pushes this stream only (empty: all streams of the application)
+		ov::String GetStreamName() const
+		{
+			return _stream_name;
+		}
+
+		// IP_MULTICAST_TTL
+		int GetTtl() const
+		{
+			return _ttl;
+		}
+
+		// Address of the interface which sends the multicast (empty: the interface is selected by the routing table)
+		ov::String GetInterface() const
+		{
+			return _interface;
+		}
+
+		// The datagrams are paced to the rate (kbps, 0: the bitrates of the tracks + 25%)
+		int GetPacingRate() const
+		{
+			return _pacing_rate;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue("Address", &_address);
+			RegisterValue<Optional>("StreamName", &_stream_name);
+			RegisterValue<Optional>("TTL", &_ttl);
+			RegisterValue<Optional>("Interface", &_interface);
+			RegisterValue<Optional>("PacingRate", &_pacing_rate);
+		}
+
+		ov::String _address;
+		ov::String _stream_name;
+		int _ttl = 16;
+		ov::String _interface;
+		int _pacing_rate = 0;
+	};
+
+	// SRT caller which connects to a receiver
+	struct MpegtsSrtPush : public Item
+	{
+		// <host>:<port> of the SRT listener of the receiver
+		ov::String GetAddress() const
+		{
+			return _address;
+		}
+
+		// Pushes this stream only (empty: all streams of the application)
+		ov::String GetStreamName() const
+		{
+			return _stream_name;
+		}
+
+		// SRTO_STREAMID (empty: "<app>/<stream>")
+		ov::String GetStreamId() const
+		{
+			return _stream_id;
+		}
+
+		// SRTO_LATENCY (ms)
+		int GetLatency() const
+		{
+			return _latency;
+		}
+
+		// SRTO_PASSPHRASE (empty: no encryption)
+		ov::String GetPassphrase() const
+		{
+			return _passphrase;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue("Address", &_address);
+			RegisterValue<Optional>("StreamName", &_stream_name);
+			RegisterValue<Optional>("StreamId", &_stream_id);
+			RegisterValue<Optional>("Latency", &_latency);
+			RegisterValue<Optional>("Passphrase", &_passphrase);
+		}
+
+		ov::String _address;
+		ov::String _stream_name;
+		ov::String _stream_id;
+		int _latency = 120;
+		ov::String _passphrase;
+	};
+
+	// SRT listener which the receivers connect to with the stream id "<app>/<stream>"
+	struct MpegtsSrtListen : public Item
+	{
+		// <port>/srt (must not be the port of SRT provider)
+		const Port &GetPort() const
+		{
+			return _port;
+		}
+
+		// SRTO_PEERLATENCY of the listening socket (ms), the latency of a receiver is the larger of it and
+		// SRTO_RCVLATENCY of the receiver
+		int GetLatency() const
+		{
+			return _latency;
+		}
+
+		ov::String GetPassphrase() const
+		{
+			return _passphrase;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue("Port", &_port);
+			RegisterValue<Optional>("Latency", &_latency);
+			RegisterValue<Optional>("Passphrase", &_passphrase);
+		}
+
+		Port _port { "9998/srt" };
+		int _latency = 120;
+		ov::String _passphrase;
+	};
+
+	struct MpegtsPublisher : public Publisher
+	{
+		PublisherType GetType() const override
+		{
+			return PublisherType::Mpegts;
+		}
+
+		const std::vector<MpegtsPush> &GetPushList() const
+		{
+			return _push_list;
+		}
+
+		const std::vector<MpegtsSrtPush> &GetSrtPushList() const
+		{
+			return _srt_push_list;
+		}
+
+		const MpegtsSrtListen &GetSrtListen() const
+		{
+			return _srt_listen;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			Publisher::MakeParseList();
+
+			RegisterValue<Optional>("Push", &_push_list);
+			RegisterValue<Optional>("SrtPush", &_srt_push_list);
+			RegisterValue<Optional>("SrtListen", &_srt_listen);
+		}
+
+		std::vector<MpegtsPush> _push_list;
+		std::vector<MpegtsSrtPush> _srt_push_list;
+		MpegtsSrtListen _srt_listen;
+	};
+}
@@ -0,0 +1,64 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "../item.h"
+
+namespace cfg
+{
+	// Options of the OPUS encoder (<Opus> of the audio profile)
+	// - The defaults are the settings before the options: 20 ms frames, in-band FEC for 10% loss
+	struct OpusProfile : public Item
+	{
+		// ms (2.5, 5, 10, 20, 40, 60), the shorter frames lower the latency but cost the bitrate
+		float GetFrameDuration() const
+		{
+			return _frame_duration;
+		}
+
+		// 0~10 (-1: the default of libopus)
+		int GetComplexity() const
+		{
+			return _complexity;
+		}
+
+		// Discontinuous transmission, the silence is sent at a lower rate
+		bool IsDtx() const
+		{
+			return _dtx;
+		}
+
+		// In-band forward error correction
+		bool IsFec() const
+		{
+			return _fec;
+		}
+
+		// %, how much of the bitrate is spent for FEC
+		int GetExpectedLoss() const
+		{
+			return _expected_loss;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("FrameDuration", &_frame_duration);
+			RegisterValue<Optional>("Complexity", &_complexity);
+			RegisterValue<Optional>("Dtx", &_dtx);
+			RegisterValue<Optional>("Fec", &_fec);
+			RegisterValue<Optional>("ExpectedLoss", &_expected_loss);
+		}
+
+		float _frame_duration = 20.0f;
+		int _complexity = -1;
+		bool _dtx = false;
+		bool _fec = true;
+		int _expected_loss = 10;
+	};
+}
@@ -8,7 +8,8 @@
 //==============================================================================
 #pragma once
 
-#include "../item.h"
+#include "prewarm.h"
+#include "url.h"
 
 namespace cfg
 {
@@ -24,21 +25,70 @@ namespace cfg
 			return _secondary;
 		}
 
+		// Other origins (srt://<host>:<port>), the streams are spread over all the origins by consistent hashing
+		const std::vector<Url> &GetUrls() const
+		{
+			return _url_list;
+		}
+
 		ov::String GetAlias() const
 		{
 			return _alias;
 		}
 
+		// true: the edge receives the packets of a stream only while the stream has sessions (reported by WebRTC)
+		bool IsPullOnDemand() const
+		{
+			return _pull_on_demand;
+		}
+
+		// The edge stops receiving the stream if the stream does not have any session for this time (in milliseconds)
+		int GetPullIdleTimeout() const
+		{
+			return _pull_idle_timeout;
+		}
+
+		// Number of the SRT connections to each origin, the streams are spread over them
+		// (A lost packet stalls the streams of its connection only)
+		int GetConnections() const
+		{
+			return _connections;
+		}
+
+		// true: the origins which have the streams of the application are found in the directory (see <Host><Discovery>),
+		// in addition to the configured ones
+		bool IsDiscoveryEnabled() const
+		{
+			return _discovery;
+		}
+
+		const Prewarm &GetPrewarm() const
+		{
+			return _prewarm;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
 			RegisterValue<Optional>("Primary", &_primary);
 			RegisterValue<Optional>("Secondary", &_secondary);
+			RegisterValue<Optional>("Url", &_url_list);
 			RegisterValue<Optional>("Alias", &_alias);
+			RegisterValue<Optional>("PullOnDemand", &_pull_on_demand);
+			RegisterValue<Optional>("PullIdleTimeout", &_pull_idle_timeout);
+			RegisterValue<Optional>("Connections", &_connections);
+			RegisterValue<Optional>("Discovery", &_discovery);
+			RegisterValue<Optional>("Prewarm", &_prewarm);
 		}
 
 		ov::String _primary;
 		ov::String _secondary;
+		std::vector<Url> _url_list;
 		ov::String _alias;
+		bool _pull_on_demand = false;
+		int _pull_idle_timeout = 30000;
+		int _connections = 1;
+		bool _discovery = false;
+		Prewarm _prewarm;
 	};
 }
\ No newline at end of file
@@ -19,12 +19,20 @@ namespace cfg
 			return _client_peers_per_host_peer;
 		}
 
+		// Depth of the distribution tree (1: only the peers served by OME can serve the clients)
+		int GetMaxTreeDepth() const
+		{
+			return _max_tree_depth;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
 			RegisterValue<Optional>("ClientPeersPerHostPeer", &_client_peers_per_host_peer);
+			RegisterValue<Optional>("MaxTreeDepth", &_max_tree_depth);
 		}
 
 		int _client_peers_per_host_peer = 2;
+		int _max_tree_depth = 1;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,29 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+namespace cfg
+{
+	// Encrypt-once of the WebRTC payloads (research mode, only the players which know the media key can play)
+	// - The payloads are encrypted once per stream, and the key is delivered to each session by SRTCP
+	struct PayloadEncryption : public Item
+	{
+		bool IsEnabled() const
+		{
+			return _enabled;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("Enable", &_enabled);
+		}
+
+		bool _enabled = false;
+	};
+}
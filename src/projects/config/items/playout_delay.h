@@ -0,0 +1,45 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+namespace cfg
+{
+	// Delay of the jitter buffer of the players (the playout-delay RTP header extension)
+	// - Min 0 and Max 0 ask the players to render the frames as soon as they are decoded (ultra-low latency)
+	struct PlayoutDelay : public Item
+	{
+		bool IsEnabled() const
+		{
+			return _enabled;
+		}
+
+		// ms
+		int GetMin() const
+		{
+			return _min;
+		}
+
+		// ms
+		int GetMax() const
+		{
+			return _max;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("Enable", &_enabled);
+			RegisterValue<Optional>("Min", &_min);
+			RegisterValue<Optional>("Max", &_max);
+		}
+
+		bool _enabled = false;
+		int _min = 0;
+		int _max = 0;
+	};
+}
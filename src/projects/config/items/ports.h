@@ -8,6 +8,7 @@
 //==============================================================================
 #pragma once
 
+#include "connection_limit.h"
 #include "port.h"
 #include "webrtc_port.h"
 
@@ -30,6 +31,11 @@ namespace cfg
 			return _rtmp_provider_port;
 		}
 
+		const Port &GetSrtProviderPort() const
+		{
+			return _srt_provider_port;
+		}
+
 		const Port &GetRtmpPort() const
 		{
 			return _rtmp_port;
@@ -55,6 +61,26 @@ namespace cfg
 			return _monitoring_port;
 		}
 
+		int GetWorkerCount() const
+		{
+			return (_worker_count > 0) ? _worker_count : 1;
+		}
+
+		bool IsIoUringEnabled() const
+		{
+			return _io_uring;
+		}
+
+		bool IsEdgeTriggeredEnabled() const
+		{
+			return _edge_triggered;
+		}
+
+		const ConnectionLimit &GetConnectionLimit() const
+		{
+			return _connection_limit;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
@@ -66,6 +92,7 @@ namespace cfg
 
 			// Providers
 			RegisterValue<Optional>("RTMPProvider", &_rtmp_provider_port);
+			RegisterValue<Optional>("SRTProvider", &_srt_provider_port);
 
 			// Publishers
 			RegisterValue<Optional>("RTMP", &_rtmp_port);
@@ -73,6 +100,11 @@ namespace cfg
 			RegisterValue<Optional>("DASH", &_dash_port);
 			RegisterValue<Optional>("WebRTC", &_webrtc_port);
 			RegisterValue<Optional>("Monitoring", &_monitoring_port);
+
+			RegisterValue<Optional>("WorkerCount", &_worker_count);
+			RegisterValue<Optional>("IoUring", &_io_uring);
+			RegisterValue<Optional>("EdgeTriggered", &_edge_triggered);
+			RegisterValue<Optional>("ConnectionLimit", &_connection_limit);
 		}
 
 		// Listen port for Origin
@@ -80,6 +112,7 @@ namespace cfg
 
 		// Listen port for Providers
 		Port _rtmp_provider_port { "1935/tcp" };
+		Port _srt_provider_port { "9999/srt" };
 
 		// Listen port for Publishers
 		Port _rtmp_port { "1935/tcp" };
@@ -88,5 +121,17 @@ namespace cfg
 		Port _dash_port { "80/tcp" };
 		WebrtcPort _webrtc_port { "3333/tcp" };
 		Port _monitoring_port { "8888/tcp" };
+
+		// Number of the sockets (SO_REUSEPORT) and threads of each TCP/UDP port
+		int _worker_count = 1;
+
+		// Receives the datagrams of the UDP ports with io_uring (Linux 6.0+, otherwise epoll is used)
+		bool _io_uring = false;
+
+		// Reads the TCP connections until EAGAIN per notification of epoll (fewer wakeups for the busy connections, e.g. RTMP)
+		bool _edge_triggered = false;
+
+		// Limits of the new connections of the TCP ports (accept storms)
+		ConnectionLimit _connection_limit;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,96 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "../item.h"
+
+namespace cfg
+{
+	// A stream which is warmed around its start time
+	struct PrewarmSchedule : public Item
+	{
+		ov::String GetStream() const
+		{
+			return _stream;
+		}
+
+		// UTC, YYYY-MM-DDTHH:MM:SSZ
+		ov::String GetStartTime() const
+		{
+			return _start_time;
+		}
+
+		// ms before the start time
+		int GetLead() const
+		{
+			return _lead;
+		}
+
+		// ms after the start time
+		int GetDuration() const
+		{
+			return _duration;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue("Stream", &_stream);
+			RegisterValue("StartTime", &_start_time);
+			RegisterValue<Optional>("Lead", &_lead);
+			RegisterValue<Optional>("Duration", &_duration);
+		}
+
+		ov::String _stream;
+		ov::String _start_time;
+		int _lead = 60000;
+		int _duration = 3600000;
+	};
+
+	// The edge subscribes the streams without the sessions, so the GOP cache is warm when the first viewer joins
+	// (used with <PullOnDemand>, see RelayClient)
+	struct Prewarm : public Item
+	{
+		// The stream is warmed if the other nodes report this number of the viewers in the directory (0: not used)
+		int GetViewers() const
+		{
+			return _viewers;
+		}
+
+		// Mbps of all warmed streams (0: unlimited)
+		int GetMaxBitrate() const
+		{
+			return _max_bitrate;
+		}
+
+		// MB of the GOPs of all warmed streams (0: unlimited)
+		int GetMaxMemory() const
+		{
+			return _max_memory;
+		}
+
+		const std::vector<PrewarmSchedule> &GetSchedules() const
+		{
+			return _schedules;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("Viewers", &_viewers);
+			RegisterValue<Optional>("MaxBitrate", &_max_bitrate);
+			RegisterValue<Optional>("MaxMemory", &_max_memory);
+			RegisterValue<Optional>("Schedule", &_schedules);
+		}
+
+		int _viewers = 0;
+		int _max_bitrate = 0;
+		int _max_memory = 0;
+		std::vector<PrewarmSchedule> _schedules;
+	};
+}
@@ -16,6 +16,11 @@ namespace cfg
 	{
 		Unknown,
 		Rtmp,
+		Srt,
+		Vod,
+		Webrtc,
+		Mpegts,
+		Replay,
 	};
 
 	struct Provider : public Item
@@ -9,6 +9,14 @@
 #pragma once
 
 #include "rtmp_provider.h"
+#include "srt_provider.h"
+#include "vod_provider.h"
+#include "webrtc_provider.h"
+#include "mpegts_provider.h"
+#include "replay_provider.h"
+#include "capture.h"
+#include "jitter_buffer.h"
+#include "reconnect.h"
 
 namespace cfg
 {
@@ -17,18 +25,55 @@ namespace cfg
 		std::vector<const Provider *> GetProviderList() const
 		{
 			return {
-				&_rtmp_provider
+				&_rtmp_provider,
+				&_srt_provider,
+				&_vod_provider,
+				&_webrtc_provider,
+				&_mpegts_provider,
+				&_replay_provider
 			};
 		}
 
+		const JitterBuffer &GetJitterBuffer() const
+		{
+			return _jitter_buffer;
+		}
+
+		const Capture &GetCapture() const
+		{
+			return _capture;
+		}
+
+		const Reconnect &GetReconnect() const
+		{
+			return _reconnect;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
 			RegisterValue<Optional>("RTMP", &_rtmp_provider);
+			RegisterValue<Optional>("SRT", &_srt_provider);
+			RegisterValue<Optional>("VOD", &_vod_provider);
+			RegisterValue<Optional>("WebRTC", &_webrtc_provider);
+			RegisterValue<Optional>("MPEGTS", &_mpegts_provider);
+			RegisterValue<Optional>("Replay", &_replay_provider);
+			RegisterValue<Optional>("JitterBuffer", &_jitter_buffer);
+			RegisterValue<Optional>("Capture", &_capture);
+			RegisterValue<Optional>("Reconnect", &_reconnect);
 		};
 
 		std::vector<const Provider *> _providers;
 
 		RtmpProvider _rtmp_provider;
+		SrtProvider _srt_provider;
+		VodProvider _vod_provider;
+		WebrtcProvider _webrtc_provider;
+		MpegtsProvider _mpegts_provider;
+		ReplayProvider _replay_provider;
+
+		JitterBuffer _jitter_buffer;
+		Capture _capture;
+		Reconnect _reconnect;
 	};
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "../item.h"
+#include "publisher_queue.h"
 
 namespace cfg
 {
@@ -19,6 +20,8 @@ namespace cfg
 		Rtmp,
 		Hls,
 		Dash,
+		Record,
+		Mpegts,
 	};
 
 	struct Publisher : public Item
@@ -32,12 +35,19 @@ namespace cfg
 			return _max_connection;
 		}
 
+		const PublisherQueue &GetQueue() const
+		{
+			return _queue;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
 			RegisterValue<Optional>("MaxConnection", &_max_connection);
+			RegisterValue<Optional>("Queue", &_queue);
 		}
 
 		int _max_connection = 0;
+		PublisherQueue _queue;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,58 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+namespace cfg
+{
+	// What a publisher does when the queue of the frames from the router is full
+	enum class PublisherQueuePolicy
+	{
+		// The router waits until the worker of the publisher takes the frames
+		Block,
+		// The oldest frames are dropped
+		DropOldest,
+		// The queued video frames are dropped, and the next video frames of the stream are dropped until the next key frame
+		DropToKeyFrame
+	};
+
+	// Queue of the frames between the router and the workers of a publisher application
+	struct PublisherQueue : public Item
+	{
+		// Frames per queue (video/audio) of a worker (0: unlimited)
+		int GetMaxSize() const
+		{
+			return _max_size;
+		}
+
+		PublisherQueuePolicy GetPolicy() const
+		{
+			ov::String policy = _policy.LowerCaseString();
+
+			if(policy == "block")
+			{
+				return PublisherQueuePolicy::Block;
+			}
+			else if(policy == "droptokeyframe")
+			{
+				return PublisherQueuePolicy::DropToKeyFrame;
+			}
+
+			return PublisherQueuePolicy::DropOldest;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("MaxSize", &_max_size);
+			RegisterValue<Optional>("Policy", &_policy);
+		}
+
+		int _max_size = 0;
+		ov::String _policy = "DropOldest";
+	};
+}
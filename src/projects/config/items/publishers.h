@@ -12,6 +12,8 @@
 #include "hls_publisher.h"
 #include "dash_publisher.h"
 #include "webrtc_publisher.h"
+#include "record_publisher.h"
+#include "mpegts_publisher.h"
 
 namespace cfg
 {
@@ -23,7 +25,9 @@ namespace cfg
 				&_rtmp_publisher,
 				&_hls_publisher,
 				&_dash_publisher,
-				&_webrtc_publisher
+				&_webrtc_publisher,
+				&_record_publisher,
+				&_mpegts_publisher
 			};
 		}
 
@@ -32,6 +36,16 @@ namespace cfg
 			return _thread_count;
 		}
 
+		int GetAppWorkerCount() const
+		{
+			return (_app_worker_count > 0) ? _app_worker_count : 1;
+		}
+
+		bool IsSessionRebalanceEnabled() const
+		{
+			return _session_rebalance;
+		}
+
 		const RtmpPublisher &GetRtmpPublisher() const
 		{
 			return _rtmp_publisher;
@@ -52,22 +66,42 @@ namespace cfg
 			return _webrtc_publisher;
 		}
 
+		const RecordPublisher &GetRecordPublisher() const
+		{
+			return _record_publisher;
+		}
+
+		const MpegtsPublisher &GetMpegtsPublisher() const
+		{
+			return _mpegts_publisher;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
 			RegisterValue<Optional>("ThreadCount", &_thread_count);
+			RegisterValue<Optional>("AppWorkerCount", &_app_worker_count);
+			RegisterValue<Optional>("SessionRebalance", &_session_rebalance);
 
 			RegisterValue<Optional>("RTMP", &_rtmp_publisher);
 			RegisterValue<Optional>("HLS", &_hls_publisher);
 			RegisterValue<Optional>("DASH", &_dash_publisher);
 			RegisterValue<Optional>("WebRTC", &_webrtc_publisher);
+			RegisterValue<Optional>("Record", &_record_publisher);
+			RegisterValue<Optional>("MPEGTS", &_mpegts_publisher);
 		}
 
 		int _thread_count;
+		// Number of threads that streams of an application are distributed to
+		int _app_worker_count = 1;
+		// Whether to move sessions from the busiest stream worker to the idlest one when the load is unbalanced
+		bool _session_rebalance = false;
 
 		RtmpPublisher _rtmp_publisher;
 		HlsPublisher _hls_publisher;
 		DashPublisher _dash_publisher;
 		WebrtcPublisher _webrtc_publisher;
+		RecordPublisher _record_publisher;
+		MpegtsPublisher _mpegts_publisher;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+namespace cfg
+{
+	// Quality of experience of the players (see StreamQoe)
+	// - All sessions feed the histograms of the stream, the details are kept only for the sampled sessions
+	struct Qoe : public Item
+	{
+		// % of the sessions of which the details are kept (0: none)
+		float GetSamplePercent() const
+		{
+			return _sample_percent;
+		}
+
+		// Sampled sessions of a stream (the new sessions are not sampled if it is exceeded)
+		int GetMaxSampledSessions() const
+		{
+			return _max_sampled_sessions;
+		}
+
+		// Seconds after which a sampled session without the report (or the request) is removed
+		int GetSessionTimeout() const
+		{
+			return _session_timeout;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("SamplePercent", &_sample_percent);
+			RegisterValue<Optional>("MaxSampledSessions", &_max_sampled_sessions);
+			RegisterValue<Optional>("SessionTimeout", &_session_timeout);
+		}
+
+		float _sample_percent = 1.0f;
+		int _max_sampled_sessions = 1000;
+		int _session_timeout = 30;
+	};
+}
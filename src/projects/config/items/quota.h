@@ -0,0 +1,60 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+namespace cfg
+{
+	// Share of the resources of the process which an application can use (0: unlimited)
+	struct Quota : public Item
+	{
+		// Weight of the fair share of the transcoder workers and the stream workers (relative to the other applications)
+		int GetWeight() const
+		{
+			return _weight;
+		}
+
+		// % of the transcoder workers
+		int GetMaxTranscodeShare() const
+		{
+			return _max_transcode_share;
+		}
+
+		// Mbps of the sessions of the application
+		int GetMaxEgressBitrate() const
+		{
+			return _max_egress_bitrate;
+		}
+
+		int GetMaxSessions() const
+		{
+			return _max_sessions;
+		}
+
+		// Mbps of the streams which are received by the providers of the application
+		int GetMaxIngestBitrate() const
+		{
+			return _max_ingest_bitrate;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("Weight", &_weight);
+			RegisterValue<Optional>("MaxTranscodeShare", &_max_transcode_share);
+			RegisterValue<Optional>("MaxEgressBitrate", &_max_egress_bitrate);
+			RegisterValue<Optional>("MaxSessions", &_max_sessions);
+			RegisterValue<Optional>("MaxIngestBitrate", &_max_ingest_bitrate);
+		}
+
+		int _weight = 1;
+		int _max_transcode_share = 0;
+		int _max_egress_bitrate = 0;
+		int _max_sessions = 0;
+		int _max_ingest_bitrate = 0;
+	};
+}
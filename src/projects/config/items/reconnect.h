@@ -0,0 +1,37 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+namespace cfg
+{
+	// The stream of the router is kept when the provider (encoder) is disconnected (MediaRouteApplication),
+	// so the publishers keep the packetizers (segment numbers, RTP sequence numbers/SSRC) when it is reconnected
+	struct Reconnect : public Item
+	{
+		bool IsEnabled() const
+		{
+			return _enabled;
+		}
+
+		// The stream is deleted if the provider isn't reconnected within this time (ms)
+		int GetTimeout() const
+		{
+			return _timeout;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("Enable", &_enabled);
+			RegisterValue<Optional>("Timeout", &_timeout);
+		}
+
+		bool _enabled = false;
+		int _timeout = 5000;
+	};
+}
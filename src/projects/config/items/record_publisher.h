@@ -0,0 +1,94 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "publisher.h"
+
+namespace cfg
+{
+	enum class RecordFormat
+	{
+		// MPEG-TS, a file contains all tracks
+		Ts,
+		// Fragmented MP4, a file per track (same as the representations of DASH)
+		Fmp4
+	};
+
+	struct RecordPublisher : public Publisher
+	{
+		PublisherType GetType() const override
+		{
+			return PublisherType::Record;
+		}
+
+		// Directory of the recorded files (relative to the application path if it is not absolute)
+		const ov::String &GetPath() const
+		{
+			return _path;
+		}
+
+		RecordFormat GetFormat() const
+		{
+			return (_format.LowerCaseString() == "fmp4") ? RecordFormat::Fmp4 : RecordFormat::Ts;
+		}
+
+		// A new file is started at the next key frame after the duration (seconds, 0: a file per stream)
+		int GetRolloverDuration() const
+		{
+			return _rollover_duration;
+		}
+
+		// Size of a write to the disk (KB), the data of a file is written when it is filled
+		int GetWriteSize() const
+		{
+			return _write_size;
+		}
+
+		// Memory of the data which is not written yet (MB, all the streams of the application),
+		// the frames are dropped to the next key frame if it is exceeded (e.g. the disk is stalled)
+		int GetMaxBufferSize() const
+		{
+			return _max_buffer_size;
+		}
+
+		// The data which is smaller than the write size is written after the interval (milliseconds)
+		// - not used with DirectIo, the last part of a file is written when the file is closed
+		int GetFlushInterval() const
+		{
+			return _flush_interval;
+		}
+
+		// O_DIRECT (the page cache is not used)
+		bool IsDirectIoEnabled() const
+		{
+			return _direct_io;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			Publisher::MakeParseList();
+
+			RegisterValue("Path", &_path);
+			RegisterValue<Optional>("Format", &_format);
+			RegisterValue<Optional>("RolloverDuration", &_rollover_duration);
+			RegisterValue<Optional>("WriteSize", &_write_size);
+			RegisterValue<Optional>("MaxBufferSize", &_max_buffer_size);
+			RegisterValue<Optional>("FlushInterval", &_flush_interval);
+			RegisterValue<Optional>("DirectIo", &_direct_io);
+		}
+
+		ov::String _path;
+		ov::String _format = "ts";
+		int _rollover_duration = 3600;
+		int _write_size = 1024;
+		int _max_buffer_size = 256;
+		int _flush_interval = 1000;
+		bool _direct_io = false;
+	};
+}
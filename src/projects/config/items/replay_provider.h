@@ -0,0 +1,76 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "provider.h"
+
+namespace cfg
+{
+	struct ReplayStream : public Item
+	{
+		const ov::String &GetName() const
+		{
+			return _name;
+		}
+
+		// A capture of <Providers><Capture>
+		const ov::String &GetFile() const
+		{
+			return _file;
+		}
+
+		// Times of the speed of the ingest (0: as fast as possible)
+		float GetSpeed() const
+		{
+			return _speed;
+		}
+
+		// The capture is replayed again from the beginning (the timestamps are continued)
+		bool IsLoop() const
+		{
+			return _loop;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue("Name", &_name);
+			RegisterValue("File", &_file);
+			RegisterValue<Optional>("Speed", &_speed);
+			RegisterValue<Optional>("Loop", &_loop);
+		}
+
+		ov::String _name;
+		ov::String _file;
+		float _speed = 1.0f;
+		bool _loop = false;
+	};
+
+	struct ReplayProvider : public Provider
+	{
+		ProviderType GetType() const override
+		{
+			return ProviderType::Replay;
+		}
+
+		const std::vector<ReplayStream> &GetStreams() const
+		{
+			return _stream_list;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			Provider::MakeParseList();
+
+			RegisterValue("Stream", &_stream_list);
+		}
+
+		std::vector<ReplayStream> _stream_list;
+	};
+}
@@ -24,14 +24,23 @@ namespace cfg
 			return _is_block_duplicate_stream_name;
 		}
 
+		// Number of the ingest threads of the RTMP port (0: <Ports><WorkerCount>)
+		// - A connection is handled by a thread from the connect to the disconnect
+		int GetWorkerCount() const
+		{
+			return _worker_count;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
 			Provider::MakeParseList();
 
             RegisterValue<Optional>("BlockDuplicateStreamName", &_is_block_duplicate_stream_name);
+			RegisterValue<Optional>("WorkerCount", &_worker_count);
 		}
 
 		bool _is_block_duplicate_stream_name = true; // true - block   false - non block
+		int _worker_count = 0;
 	};
 }
\ No newline at end of file
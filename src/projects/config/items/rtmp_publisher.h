@@ -10,6 +10,7 @@
 
 #include "publisher.h"
 #include "cross_domain.h"
+#include "rtmp_push.h"
 
 namespace cfg
 {
@@ -20,6 +21,23 @@ namespace cfg
 			return _cross_domain.GetUrls();
 		}
 
+		const std::vector<RtmpPush> &GetPushList() const
+		{
+			return _push_list;
+		}
+
+		// Memory of the queued chunks of a push target (KB), the queue is dropped to the next key frame if it is exceeded
+		int GetQueueSize() const
+		{
+			return _queue_size;
+		}
+
+		// Serves the players of the RTMP provider port (rtmp://host:port/app/stream) from the streams of the application
+		bool IsPlayEnabled() const
+		{
+			return _play;
+		}
+
 		PublisherType GetType() const override
 		{
 			return PublisherType::Rtmp;
@@ -31,8 +49,14 @@ namespace cfg
 			Publisher::MakeParseList();
 
 			RegisterValue<Optional>("CrossDomain", &_cross_domain);
+			RegisterValue<Optional>("QueueSize", &_queue_size);
+			RegisterValue<Optional>("Push", &_push_list);
+			RegisterValue<Optional>("Play", &_play);
 		}
 
 		CrossDomain _cross_domain;
+		int _queue_size = 8192;
+		std::vector<RtmpPush> _push_list;
+		bool _play = false;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "../item.h"
+
+namespace cfg
+{
+	struct RtmpPush : public Item
+	{
+		// rtmp://<host>[:<port>]/<app>/<stream key>, ${StreamName} is replaced with the name of the stream
+		ov::String GetUrl() const
+		{
+			return _url;
+		}
+
+		// Pushes this stream only (empty: all streams of the application)
+		ov::String GetStreamName() const
+		{
+			return _stream_name;
+		}
+
+		// The targets of the same chunk size share the serialized chunks
+		int GetChunkSize() const
+		{
+			return _chunk_size;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue("Url", &_url);
+			RegisterValue<Optional>("StreamName", &_stream_name);
+			RegisterValue<Optional>("ChunkSize", &_chunk_size);
+		}
+
+		ov::String _url;
+		ov::String _stream_name;
+		int _chunk_size = 4096;
+	};
+}
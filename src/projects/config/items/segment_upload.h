@@ -0,0 +1,54 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "url.h"
+
+namespace cfg
+{
+	struct SegmentUpload : public Item
+	{
+		// http://<host>[:<port>][/<path>], the files are uploaded to <path>/<app>/<stream>/<file> (empty: disabled)
+		const std::vector<Url> &GetUrls() const
+		{
+			return _url_list;
+		}
+
+		// PUT or POST
+		ov::String GetMethod() const
+		{
+			return _method;
+		}
+
+		// Parallel uploads of the application
+		int GetWorkerCount() const
+		{
+			return _worker_count > 0 ? _worker_count : 1;
+		}
+
+		// Retries of a failed upload, the interval is doubled for every retry
+		int GetRetryCount() const
+		{
+			return _retry_count;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("Url", &_url_list);
+			RegisterValue<Optional>("Method", &_method);
+			RegisterValue<Optional>("WorkerCount", &_worker_count);
+			RegisterValue<Optional>("RetryCount", &_retry_count);
+		}
+
+		std::vector<Url> _url_list;
+		ov::String _method = "PUT";
+		int _worker_count = 4;
+		int _retry_count = 3;
+	};
+}
@@ -8,7 +8,10 @@
 //==============================================================================
 #pragma once
 
+#include "drain.h"
 #include "hosts.h"
+#include "memory_governor.h"
+#include "thread_topology.h"
 
 namespace cfg
 {
@@ -23,17 +26,54 @@ namespace cfg
             return _version;
         }
 
+		const ThreadTopology &GetThreadTopology() const
+		{
+			return _thread_topology;
+		}
+
+		// Initial state of ov::LockProfiler (it can be changed by the monitoring server at runtime)
+		bool IsLockProfiling() const
+		{
+			return _lock_profiling;
+		}
+
+		// The large media buffers are backed by the huge pages (see ov::HugePages)
+		bool IsHugePages() const
+		{
+			return _huge_pages;
+		}
+
+		const MemoryGovernor &GetMemoryGovernor() const
+		{
+			return _memory_governor;
+		}
+
+		const Drain &GetDrain() const
+		{
+			return _drain;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
 			RegisterValue<ValueType::Attribute>("version", &_version);
 			RegisterValue<Optional>("Name", &_name);
 			RegisterValue<Optional>("Hosts", &_hosts);
+			RegisterValue<Optional>("ThreadTopology", &_thread_topology);
+			RegisterValue<Optional>("LockProfiling", &_lock_profiling);
+			RegisterValue<Optional>("HugePages", &_huge_pages);
+			RegisterValue<Optional>("MemoryGovernor", &_memory_governor);
+			RegisterValue<Optional>("Drain", &_drain);
 		}
 
 		ov::String _version = "1.0";
 		ov::String _name;
 
 		Hosts _hosts;
+		ThreadTopology _thread_topology;
+		bool _lock_profiling = false;
+		bool _huge_pages = false;
+		MemoryGovernor _memory_governor;
+		Drain _drain;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "provider.h"
+#include "port.h"
+
+namespace cfg
+{
+	struct SrtProvider : public Provider
+	{
+		ProviderType GetType() const override
+		{
+			return ProviderType::Srt;
+		}
+
+		// Listen port of the application, the port of the host (<Ports><SRTProvider>) is used if not specified
+		const Port &GetPort() const
+		{
+			return _port;
+		}
+
+		// SRTO_RCVLATENCY (ms)
+		int GetLatency() const
+		{
+			return _latency;
+		}
+
+		// SRTO_PASSPHRASE (10~79 characters), the stream is not encrypted if empty
+		ov::String GetPassphrase() const
+		{
+			return _passphrase;
+		}
+
+		bool IsBlockDuplicateStreamName() const
+		{
+			return _is_block_duplicate_stream_name;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			Provider::MakeParseList();
+
+			RegisterValue<Optional>("Port", &_port);
+			RegisterValue<Optional>("Latency", &_latency);
+			RegisterValue<Optional>("Passphrase", &_passphrase);
+			RegisterValue<Optional>("BlockDuplicateStreamName", &_is_block_duplicate_stream_name);
+		}
+
+		Port _port { "9999/srt" };
+		int _latency = 120;
+		ov::String _passphrase;
+		bool _is_block_duplicate_stream_name = true;
+	};
+}
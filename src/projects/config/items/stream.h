@@ -24,14 +24,30 @@ namespace cfg
 			return _profiles.GetProfiles();
 		}
 
+		// true: the encoders of the stream run only while the stream has sessions (reported by WebRTC)
+		bool IsOnDemand() const
+		{
+			return _on_demand;
+		}
+
+		// The encoders are stopped if the stream does not have any session for this time (in milliseconds)
+		int GetOnDemandIdleTimeout() const
+		{
+			return _on_demand_idle_timeout;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
 			RegisterValue("Name", &_name);
 			RegisterValue("Profiles", &_profiles);
+			RegisterValue<Optional>("OnDemand", &_on_demand);
+			RegisterValue<Optional>("OnDemandIdleTimeout", &_on_demand_idle_timeout);
 		}
 
 		ov::String _name;
 		StreamProfiles _profiles;
+		bool _on_demand = false;
+		int _on_demand_idle_timeout = 30000;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,49 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+namespace cfg
+{
+	// CPUs and NUMA node of a thread pool (see ov::ThreadTopology)
+	//
+	// <Pool>
+	//     <Name>Port</Name>             <!-- Port, StreamWorker, SegmentWorker, Transcoder -->
+	//     <Cpus>0-7</Cpus>              <!-- Optional, the CPUs of the NUMA node if it is omitted -->
+	//     <NumaNode>0</NumaNode>        <!-- Optional, the memory of the node is preferred -->
+	// </Pool>
+	struct ThreadPool : public Item
+	{
+		const ov::String &GetName() const
+		{
+			return _name;
+		}
+
+		const ov::String &GetCpus() const
+		{
+			return _cpus;
+		}
+
+		// -1 if not specified
+		int GetNumaNode() const
+		{
+			return _numa_node;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue("Name", &_name);
+			RegisterValue<Optional>("Cpus", &_cpus);
+			RegisterValue<Optional>("NumaNode", &_numa_node);
+		}
+
+		ov::String _name;
+		ov::String _cpus;
+		int _numa_node = -1;
+	};
+}
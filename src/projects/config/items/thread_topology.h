@@ -0,0 +1,31 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "thread_pool.h"
+
+namespace cfg
+{
+	// Assignment of the thread pools to the CPU sets and the NUMA nodes
+	// (the pools which are not listed are not pinned)
+	struct ThreadTopology : public Item
+	{
+		const std::vector<ThreadPool> &GetPools() const
+		{
+			return _pool_list;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			RegisterValue<Optional>("Pool", &_pool_list);
+		}
+
+		std::vector<ThreadPool> _pool_list;
+	};
+}
@@ -59,6 +59,30 @@ namespace cfg
 			return _framerate;
 		}
 
+		// default, low-latency, balanced, quality, screen
+		ov::String GetPreset() const
+		{
+			return _preset;
+		}
+
+		// -1: from the preset, 0: number of the cores
+		int GetThreadCount() const
+		{
+			return _thread_count;
+		}
+
+		// Empty: from the preset, off, bitrate, quality, buffer
+		ov::String GetRateControl() const
+		{
+			return _rate_control;
+		}
+
+		// Temporal layers of VP8 (1~3), the players can drop the upper layers without another encoder
+		int GetTemporalLayers() const
+		{
+			return _temporal_layers;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
@@ -72,6 +96,10 @@ namespace cfg
 			RegisterValue("Height", &_height);
 			RegisterValue("Bitrate", &_bitrate);
 			RegisterValue("Framerate", &_framerate);
+			RegisterValue<Optional>("Preset", &_preset);
+			RegisterValue<Optional>("ThreadCount", &_thread_count);
+			RegisterValue<Optional>("RateControl", &_rate_control);
+			RegisterValue<Optional>("TemporalLayers", &_temporal_layers);
 		}
 
 		bool _bypass = false;
@@ -83,5 +111,9 @@ namespace cfg
 		int _height = 0;
 		ov::String _bitrate;
 		float _framerate = 0.0f;
+		ov::String _preset = "default";
+		int _thread_count = -1;
+		ov::String _rate_control;
+		int _temporal_layers = 1;
 	};
 }
\ No newline at end of file
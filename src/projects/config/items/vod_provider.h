@@ -0,0 +1,54 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "provider.h"
+
+namespace cfg
+{
+	// MP4 files of a VOD application (<Type>vod</Type>), which are packaged to HLS/DASH on request
+	struct VodProvider : public Provider
+	{
+		ProviderType GetType() const override
+		{
+			return ProviderType::Vod;
+		}
+
+		// Directory of the MP4 files: <RootPath>/<stream>.mp4 is served as <app>/<stream>
+		ov::String GetRootPath() const
+		{
+			return _root_path;
+		}
+
+		// Target duration of the segments (second), the segments are cut at the key frames
+		int GetSegmentDuration() const
+		{
+			return _segment_duration;
+		}
+
+		// Number of the files whose sample index is kept in memory
+		int GetCacheCount() const
+		{
+			return _cache_count;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			Provider::MakeParseList();
+
+			RegisterValue("RootPath", &_root_path);
+			RegisterValue<Optional>("SegmentDuration", &_segment_duration);
+			RegisterValue<Optional>("CacheCount", &_cache_count);
+		}
+
+		ov::String _root_path;
+		int _segment_duration = 6;
+		int _cache_count = 64;
+	};
+}
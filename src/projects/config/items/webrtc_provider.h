@@ -0,0 +1,62 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "provider.h"
+#include "port.h"
+#include "ice_candidates.h"
+
+namespace cfg
+{
+	struct WebrtcProvider : public Provider
+	{
+		ProviderType GetType() const override
+		{
+			return ProviderType::Webrtc;
+		}
+
+		// Listen port of WHIP (the offers of the contributors)
+		const Port &GetSignallingPort() const
+		{
+			return _signalling_port;
+		}
+
+		// Must be specified, the candidates of the WebRTC publisher cannot be shared
+		const IceCandidates &GetIceCandidates() const
+		{
+			return _ice_candidates;
+		}
+
+		// Time (ms) which the frames wait for the retransmitted packets
+		int GetJitterBufferDelay() const
+		{
+			return _jitter_buffer_delay;
+		}
+
+		bool IsBlockDuplicateStreamName() const
+		{
+			return _is_block_duplicate_stream_name;
+		}
+
+	protected:
+		void MakeParseList() const override
+		{
+			Provider::MakeParseList();
+
+			RegisterValue<Optional>("Signalling", &_signalling_port);
+			RegisterValue<Optional>("IceCandidates", &_ice_candidates);
+			RegisterValue<Optional>("JitterBufferDelay", &_jitter_buffer_delay);
+			RegisterValue<Optional>("BlockDuplicateStreamName", &_is_block_duplicate_stream_name);
+		}
+
+		Port _signalling_port { "3334/tcp" };
+		IceCandidates _ice_candidates;
+		int _jitter_buffer_delay = 150;
+		bool _is_block_duplicate_stream_name = true;
+	};
+}
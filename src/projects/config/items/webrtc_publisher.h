@@ -11,6 +11,9 @@
 #include "publisher.h"
 #include "ice_candidates.h"
 #include "p2p.h"
+#include "admission_control.h"
+#include "payload_encryption.h"
+#include "playout_delay.h"
 
 namespace cfg
 {
@@ -26,6 +29,21 @@ namespace cfg
 			return _p2p;
 		}
 
+		const AdmissionControl &GetAdmissionControl() const
+		{
+			return _admission_control;
+		}
+
+		const PayloadEncryption &GetPayloadEncryption() const
+		{
+			return _payload_encryption;
+		}
+
+		const PlayoutDelay &GetPlayoutDelay() const
+		{
+			return _playout_delay;
+		}
+
 	protected:
 		void MakeParseList() const override
 		{
@@ -33,9 +51,15 @@ namespace cfg
 
 			RegisterValue<Optional>("Timeout", &_timeout);
 			RegisterValue<Optional>("P2P", &_p2p);
+			RegisterValue<Optional>("AdmissionControl", &_admission_control);
+			RegisterValue<Optional>("PayloadEncryption", &_payload_encryption);
+			RegisterValue<Optional>("PlayoutDelay", &_playout_delay);
 		}
 
 		int _timeout = 0;
 		P2P _p2p;
+		AdmissionControl _admission_control;
+		PayloadEncryption _payload_encryption;
+		PlayoutDelay _playout_delay;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,122 @@
+﻿//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Created by Jaejong Bong
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#include "cmaf_packetyzer_manager.h"
+#include "dash_private.h"
+
+std::mutex CmafPacketyzerManager::_guard;
+std::map<ov::String, std::weak_ptr<SharedCmafPacketyzer>> CmafPacketyzerManager::_packetyzers;
+
+//====================================================================================================
+// Feeder Check
+//====================================================================================================
+bool SharedCmafPacketyzer::IsFeeder(const void *user, const std::shared_ptr<PacketyzerFrameData> &frame_data)
+{
+    const void *feeder = nullptr;
+
+    if (_feeder.compare_exchange_strong(feeder, user))
+    {
+        // new feeder : skips the frames already appended by the previous feeder
+        _video_resuming = _video_appended.load();
+        _audio_resuming = _audio_appended.load();
+    }
+    else if (feeder != user)
+    {
+        return false;
+    }
+
+    bool is_video = frame_data->type != PacketyzerFrameType::AudioFrame;
+    auto &last_timestamp = is_video ? _last_video_timestamp : _last_audio_timestamp;
+    auto &resuming = is_video ? _video_resuming : _audio_resuming;
+
+    if (resuming)
+    {
+        if (frame_data->timestamp <= last_timestamp)
+            return false;
+
+        resuming = false;
+    }
+
+    last_timestamp = frame_data->timestamp;
+    (is_video ? _video_appended : _audio_appended) = true;
+
+    return true;
+}
+
+//====================================================================================================
+// Release
+// - the other user becomes the feeder
+//====================================================================================================
+void SharedCmafPacketyzer::Release(const void *user)
+{
+    const void *feeder = user;
+
+    _feeder.compare_exchange_strong(feeder, nullptr);
+}
+
+//====================================================================================================
+// Get Packetyzer
+// - created if there is no packetyzer of the same stream/settings
+//====================================================================================================
+std::shared_ptr<SharedCmafPacketyzer> CmafPacketyzerManager::GetPacketyzer(const ov::String &app_name,
+                                                                            const ov::String &stream_name,
+                                                                            uint32_t stream_id,
+                                                                            PacketyzerStreamType stream_type,
+                                                                            const ov::String &segment_prefix,
+                                                                            uint32_t segment_count,
+                                                                            uint32_t segment_duration,
+                                                                            PacketyzerMediaInfo &media_info,
+                                                                            uint32_t chunk_duration)
+{
+    ov::String key = ov::String::FormatString("%s/%s/%u/%s/%u/%u/%u",
+                                              app_name.CStr(),
+                                              stream_name.CStr(),
+                                              stream_id,
+                                              segment_prefix.CStr(),
+                                              segment_count,
+                                              segment_duration,
+                                              chunk_duration);
+
+    std::unique_lock<std::mutex> lock(_guard);
+
+    auto item = _packetyzers.find(key);
+
+    if (item != _packetyzers.end())
+    {
+        auto shared_packetyzer = item->second.lock();
+
+        if (shared_packetyzer != nullptr)
+        {
+            logti("Cmaf packetyzer is shared - %s", key.CStr());
+            return shared_packetyzer;
+        }
+    }
+
+    // expired
+    for (auto expired_item = _packetyzers.begin(); expired_item != _packetyzers.end();)
+    {
+        if (expired_item->second.expired())
+            expired_item = _packetyzers.erase(expired_item);
+        else
+            expired_item++;
+    }
+
+    auto shared_packetyzer = std::make_shared<SharedCmafPacketyzer>(std::make_shared<DashPacketyzer>(app_name,
+                                                                                                      stream_name,
+                                                                                                      stream_type,
+                                                                                                      segment_prefix,
+                                                                                                      segment_count,
+                                                                                                      segment_duration,
+                                                                                                      media_info,
+                                                                                                      chunk_duration));
+
+    _packetyzers[key] = shared_packetyzer;
+
+    return shared_packetyzer;
+}
@@ -0,0 +1,71 @@
+﻿//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Created by Jaejong Bong
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#pragma once
+
+#include "dash_packetyzer.h"
+
+//====================================================================================================
+// SharedCmafPacketyzer
+// - one CMAF(fMP4) packetyzer of a stream, shared by DASH and HLS(CMAF)
+// - only one of the users(feeder) appends the frames, the others use the segments/playlists
+// - when the feeder is released, the next user who appends a frame becomes the feeder
+//====================================================================================================
+class SharedCmafPacketyzer
+{
+public:
+    explicit SharedCmafPacketyzer(const std::shared_ptr<DashPacketyzer> &packetyzer)
+    {
+        _packetyzer = packetyzer;
+    }
+
+    const std::shared_ptr<DashPacketyzer> &GetPacketyzer() const
+    {
+        return _packetyzer;
+    }
+
+    // true : the frame is appended by the user
+    // - after the feeder is changed, the frames before the last appended one are dropped
+    bool IsFeeder(const void *user, const std::shared_ptr<PacketyzerFrameData> &frame_data);
+
+    void Release(const void *user);
+
+private:
+    std::shared_ptr<DashPacketyzer> _packetyzer;
+    std::atomic<const void *> _feeder { nullptr };
+    std::atomic<uint64_t> _last_video_timestamp { 0 };
+    std::atomic<uint64_t> _last_audio_timestamp { 0 };
+    std::atomic<bool> _video_appended { false };
+    std::atomic<bool> _audio_appended { false };
+    std::atomic<bool> _video_resuming { false };
+    std::atomic<bool> _audio_resuming { false };
+};
+
+//====================================================================================================
+// CmafPacketyzerManager
+// - key : app/stream/stream id/segment settings(the streams with different settings are not shared)
+// - the packetyzer is deleted when the last user is released
+//====================================================================================================
+class CmafPacketyzerManager
+{
+public:
+    static std::shared_ptr<SharedCmafPacketyzer> GetPacketyzer(const ov::String &app_name,
+                                                                const ov::String &stream_name,
+                                                                uint32_t stream_id,
+                                                                PacketyzerStreamType stream_type,
+                                                                const ov::String &segment_prefix,
+                                                                uint32_t segment_count,
+                                                                uint32_t segment_duration,
+                                                                PacketyzerMediaInfo &media_info,
+                                                                uint32_t chunk_duration);
+
+private:
+    static std::mutex _guard;
+    static std::map<ov::String, std::weak_ptr<SharedCmafPacketyzer>> _packetyzers;
+};
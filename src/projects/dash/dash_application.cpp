@@ -10,6 +10,7 @@
 #include "dash_application.h"
 #include "dash_stream.h"
 #include "dash_private.h"
+#include "segment_stream/packetyzer/segment_uploader.h"
 
 //====================================================================================================
 // Create
@@ -29,6 +30,24 @@ DashApplication::DashApplication(const info::Application *application_info) : Ap
     auto publisher_info = application_info->GetPublisher<cfg::DashPublisher>();
     _segment_count = publisher_info->GetSegmentCount();
     _segment_duration = publisher_info->GetSegmentDuration();
+    _segment_tolerance = static_cast<uint32_t>(std::max(publisher_info->GetSegmentTolerance(), 0));
+    _chunk_duration = publisher_info->IsLowLatencyEnabled() ? static_cast<uint32_t>(publisher_info->GetChunkDuration()) : 0;
+    _segment_memory_limit = static_cast<uint64_t>(publisher_info->GetSegmentMemoryLimit()) * 1024 * 1024;
+    _thumbnail = publisher_info->IsThumbnailEnabled();
+    _thumbnail_width = static_cast<uint32_t>(std::max(publisher_info->GetThumbnailWidth(), 0));
+
+    SetQueueConfig(publisher_info->GetQueue());
+
+    // the chunks are not pushed(the players get the chunked transfer of the segment being made from this server)
+    if (!publisher_info->GetUpload().GetUrls().empty())
+    {
+        if (_chunk_duration > 0)
+            logtw("Upload is not supported with Low-Latency DASH, so it is disabled (%s)", GetName().CStr());
+        else
+            _uploader = SegmentUploader::Create(ov::String::FormatString("dash/%s", GetName().CStr()), publisher_info->GetUpload());
+    }
+
+    Packetyzer::SetTotalMemoryLimit(static_cast<uint64_t>(publisher_info->GetTotalSegmentMemoryLimit()) * 1024 * 1024);
 }
 
 //====================================================================================================
@@ -61,7 +80,13 @@ bool DashApplication::Start()
 //====================================================================================================
 bool DashApplication::Stop()
 {
-	return Application::Stop();
+	// the streams are stopped first(no more uploads are queued)
+	bool result = Application::Stop();
+
+	if (_uploader != nullptr)
+		_uploader->Stop();
+
+	return result;
 }
 
 //====================================================================================================
@@ -74,6 +99,12 @@ std::shared_ptr<Stream> DashApplication::CreateStream(std::shared_ptr<StreamInfo
 
 	return DashStream::Create(_segment_count,
                             _segment_duration,
+                            _segment_tolerance,
+                            _chunk_duration,
+                            _segment_memory_limit,
+                            _thumbnail,
+                            _thumbnail_width,
+                            _uploader,
                             GetSharedPtrAs<Application>(),
                             *info.get(),
                             worker_count);
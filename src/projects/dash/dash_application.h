@@ -35,4 +35,10 @@ private:
 private :
     int _segment_count;
     int _segment_duration;
+    uint32_t _segment_tolerance; // millisecond
+    uint32_t _chunk_duration;
+    uint64_t _segment_memory_limit;
+    bool _thumbnail;
+    uint32_t _thumbnail_width; // 0 : width of the stream
+    std::shared_ptr<SegmentUploader> _uploader = nullptr; // shared by the streams(nullptr : disabled)
 };
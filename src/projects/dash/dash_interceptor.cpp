@@ -9,6 +9,7 @@
 
 #include "dash_interceptor.h"
 #include "dash_private.h"
+#include "segment_stream/segment_thumbnailer.h"
 
 DashInterceptor::DashInterceptor()
 {
@@ -34,9 +35,10 @@ bool DashInterceptor::IsInterceptorForRequest(const std::shared_ptr<const HttpRe
 		return false;
 	}
 
-    // mpd/m4s
+    // mpd/m4s/thumbnail
     if((request->GetRequestTarget().IndexOf(".m4s") >= 0) ||
        (request->GetRequestTarget().IndexOf(".mpd") >= 0) ||
+       (request->GetRequestTarget().IndexOf("/" THUMBNAIL_FILE_NAME) >= 0) ||
        (!_is_crossdomain_block && request->GetRequestTarget().IndexOf("crossdomain.xml") >= 0))
     {
         return true;
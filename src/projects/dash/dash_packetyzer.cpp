@@ -16,6 +16,11 @@
 
 #define VIDEO_TRACK_ID    (1)
 #define AUDIO_TRACK_ID    (2)
+#define AVC_CODEC_STRING        ("avc1.42401f")
+// Main profile, level 4 (until the SPS is parsed)
+#define HEVC_CODEC_STRING       ("hvc1.1.6.L120.90")
+// Low latency : blocking requests time out after (DASH_WAIT_TIMEOUT_SEGMENT_COUNT x segment duration)
+#define DASH_WAIT_TIMEOUT_SEGMENT_COUNT     (3)
 
 //====================================================================================================
 // Constructor
@@ -26,7 +31,8 @@ DashPacketyzer::DashPacketyzer(const ov::String &app_name,
                             const ov::String &segment_prefix,
                             uint32_t segment_count,
                             uint32_t segment_duration,
-                            PacketyzerMediaInfo &media_info) :
+                            PacketyzerMediaInfo &media_info,
+                            uint32_t chunk_duration) :
                                 Packetyzer(app_name,
                                             stream_name,
                                             PacketyzerType::Dash,
@@ -37,6 +43,7 @@ DashPacketyzer::DashPacketyzer(const ov::String &app_name,
                                             media_info)
 {
     _avc_nal_header_size = 0;
+    _video_codec_string = (media_info.video_codec_type == SegmentCodecType::H265Codec) ? HEVC_CODEC_STRING : AVC_CODEC_STRING;
     _video_frame_datas.clear();
     _audio_frame_datas.clear();
 
@@ -57,13 +64,20 @@ DashPacketyzer::DashPacketyzer(const ov::String &app_name,
     _last_audio_append_time = time(nullptr);
 
     _duration_threshold = (double)_segment_duration * 0.9 * (double)_media_info.video_timescale;
+    _play_list_file_name = DASH_PLAY_LIST_FILE_NAME;
+
+    // chunk must be shorter than segment
+    _chunk_duration = std::min(chunk_duration, static_cast<uint32_t>(_segment_duration * 1000));
 }
 
 //====================================================================================================
 // Destructor
+// - pending chunked transfers are released
 //====================================================================================================
 DashPacketyzer::~DashPacketyzer()
 {
+    NotifyChunkWaiters(true);
+
     _video_frame_datas.clear();
     _audio_frame_datas.clear();
 }
@@ -78,6 +92,9 @@ DashPacketyzer::~DashPacketyzer()
 //====================================================================================================
 bool DashPacketyzer::VideoInit(std::shared_ptr<ov::Data> &frame_data)
 {
+    if (_media_info.video_codec_type == SegmentCodecType::H265Codec)
+        return HevcVideoInit(frame_data);
+
     // 패턴 확인
     uint32_t current_index = 0;
     int sps_start_index = -1;
@@ -157,21 +174,30 @@ bool DashPacketyzer::VideoInit(std::shared_ptr<ov::Data> &frame_data)
     auto avc_pps = std::make_shared<std::vector<uint8_t>>(data->begin() + pps_start_index,
                                                           data->begin() + pps_end_index + 1);
 
-    // Video init m4s 생성(메모리)
-    auto writer = std::make_unique<M4sInitWriter>(M4sMediaType::VideoMediaType,
-                                                  1024,
-                                                  _segment_duration * _media_info.video_timescale,
-                                                  _media_info.video_timescale,
-                                                  VIDEO_TRACK_ID,
-                                                  _media_info.video_width,
-                                                  _media_info.video_height,
-                                                  avc_sps,
-                                                  avc_pps,
-                                                  _media_info.audio_channels,
-                                                  16,
-                                                  _media_info.audio_samplerate);
-
-    if (writer->CreateData() <= 0)
+    // Video init m4s 생성(메모리, 같은 설정의 init m4s 는 공유)
+    auto key = MakeInitCacheKey(M4sMediaType::VideoMediaType, _media_info.video_timescale, VIDEO_TRACK_ID);
+    key.Append(avc_sps).Append(avc_pps);
+
+    auto init_segment = M4sInitCache::GetInitSegment(MPD_VIDEO_INIT_FILE_NAME, key, MakeSegmentCacheControl(),
+        [&]() -> std::shared_ptr<std::vector<uint8_t>>
+        {
+            auto writer = std::make_unique<M4sInitWriter>(M4sMediaType::VideoMediaType,
+                                                          1024,
+                                                          _segment_duration * _media_info.video_timescale,
+                                                          _media_info.video_timescale,
+                                                          VIDEO_TRACK_ID,
+                                                          _media_info.video_width,
+                                                          _media_info.video_height,
+                                                          avc_sps,
+                                                          avc_pps,
+                                                          _media_info.audio_channels,
+                                                          16,
+                                                          _media_info.audio_samplerate);
+
+            return (writer->CreateData() > 0) ? writer->GetDataStream() : nullptr;
+        });
+
+    if (init_segment == nullptr)
     {
         logte("video writer create fail");
         return false;
@@ -180,13 +206,175 @@ bool DashPacketyzer::VideoInit(std::shared_ptr<ov::Data> &frame_data)
     _avc_nal_header_size = avc_sps->size() + avc_pps->size() + AVC_NAL_START_PATTERN_SIZE * 3;
 
     // Video init m4s Save
-    SetSegmentData(MPD_VIDEO_INIT_FILE_NAME, 0, 0, writer->GetDataStream());
+    SetInitSegmentData(init_segment);
+
+    _video_init = true;
+
+    return true;
+}
+
+//====================================================================================================
+// HEVC Video 설정 값 Load ( Key Frame 데이터만 가능)
+//  0001 + vps + 0001 + sps + 0001 + pps + (0001 + sei ...) + 0001 + I-Frame 구조 파싱
+// - vps/sps/pps : hvcC
+// - codecs : sps 의 profile_tier_level
+// - 첫 VCL NAL 이전 까지 헤더(_avc_nal_header_size)
+//====================================================================================================
+bool DashPacketyzer::HevcVideoInit(std::shared_ptr<ov::Data> &frame_data)
+{
+    const uint8_t *data = frame_data->GetDataAs<uint8_t>();
+    size_t data_size = frame_data->GetLength();
+    std::shared_ptr<std::vector<uint8_t>> hevc_vps;
+    std::shared_ptr<std::vector<uint8_t>> hevc_sps;
+    std::shared_ptr<std::vector<uint8_t>> hevc_pps;
+    int header_size = -1;
+
+    // NAL 시작 위치 : start code(0x000001/0x00000001) 다음
+    std::vector<size_t> nal_offsets;
+
+    for (size_t index = 0; (index + 3) <= data_size; index++)
+    {
+        if (data[index] == 0 && data[index + 1] == 0 && data[index + 2] == 1)
+        {
+            nal_offsets.push_back(index + 3);
+            index += 2;
+        }
+    }
+
+    for (size_t nal_index = 0; nal_index < nal_offsets.size(); nal_index++)
+    {
+        size_t nal_offset = nal_offsets[nal_index];
+        size_t nal_end = data_size;
+
+        if (nal_index + 1 < nal_offsets.size())
+        {
+            // the next start code(0x00000001 : 4byte)
+            nal_end = nal_offsets[nal_index + 1] - 3;
+
+            if (nal_end > nal_offset && data[nal_end - 1] == 0)
+                nal_end--;
+        }
+
+        if (nal_offset >= nal_end)
+            continue;
+
+        int nal_type = (data[nal_offset] >> 1) & 0x3F;
+        auto nal = std::make_shared<std::vector<uint8_t>>(data + nal_offset, data + nal_end);
+
+        if (nal_type == HEVC_NAL_TYPE_VPS && hevc_vps == nullptr)
+            hevc_vps = nal;
+        else if (nal_type == HEVC_NAL_TYPE_SPS && hevc_sps == nullptr)
+            hevc_sps = nal;
+        else if (nal_type == HEVC_NAL_TYPE_PPS && hevc_pps == nullptr)
+            hevc_pps = nal;
+        else if (nal_type < HEVC_NAL_TYPE_VPS)
+        {
+            // VCL NAL(0 ~ 31)
+            header_size = static_cast<int>(nal_offset);
+            break;
+        }
+    }
+
+    // parsing result check
+    if (hevc_vps == nullptr || hevc_sps == nullptr || hevc_pps == nullptr || header_size < 0)
+    {
+        return false;
+    }
+
+    HevcSpsInfo sps_info;
+
+    if (M4sInitWriter::ParseHevcSps(*hevc_sps, sps_info))
+    {
+        std::lock_guard<std::mutex> lock(_video_codec_string_mutex);
+        _video_codec_string = M4sInitWriter::MakeHevcCodecString(sps_info);
+    }
+
+    // Video init m4s 생성(메모리, 같은 설정의 init m4s 는 공유)
+    auto key = MakeInitCacheKey(M4sMediaType::VideoMediaType, _media_info.video_timescale, VIDEO_TRACK_ID);
+    key.Append(hevc_vps).Append(hevc_sps).Append(hevc_pps);
+
+    auto init_segment = M4sInitCache::GetInitSegment(MPD_VIDEO_INIT_FILE_NAME, key, MakeSegmentCacheControl(),
+        [&]() -> std::shared_ptr<std::vector<uint8_t>>
+        {
+            std::shared_ptr<std::vector<uint8_t>> temp = nullptr;
+
+            auto writer = std::make_unique<M4sInitWriter>(M4sMediaType::VideoMediaType,
+                                                          1024,
+                                                          _segment_duration * _media_info.video_timescale,
+                                                          _media_info.video_timescale,
+                                                          VIDEO_TRACK_ID,
+                                                          _media_info.video_width,
+                                                          _media_info.video_height,
+                                                          temp,
+                                                          temp,
+                                                          _media_info.audio_channels,
+                                                          16,
+                                                          _media_info.audio_samplerate);
+
+            writer->SetHevcParameterSets(hevc_vps, hevc_sps, hevc_pps);
+
+            return (writer->CreateData() > 0) ? writer->GetDataStream() : nullptr;
+        });
+
+    if (init_segment == nullptr)
+    {
+        logte("video writer create fail");
+        return false;
+    }
+
+    _avc_nal_header_size = header_size;
+
+    // Video init m4s Save
+    SetInitSegmentData(init_segment);
 
     _video_init = true;
 
     return true;
 }
 
+//====================================================================================================
+// Init m4s cache key
+// - the parameters of M4sInitWriter except the parameter sets
+//====================================================================================================
+M4sInitCacheKey DashPacketyzer::MakeInitCacheKey(M4sMediaType media_type, uint32_t timescale, uint32_t track_id)
+{
+    M4sInitCacheKey key;
+
+    key.Append(static_cast<uint64_t>(media_type))
+        .Append(_segment_duration * timescale)
+        .Append(timescale)
+        .Append(track_id)
+        .Append(_media_info.video_width)
+        .Append(_media_info.video_height)
+        .Append(_media_info.audio_channels)
+        .Append(_media_info.audio_samplerate);
+
+    return key;
+}
+
+//====================================================================================================
+// Set Init Segment
+// - shared init m4s(not modified), MPD initialization / HLS(CMAF) EXT-X-MAP
+//====================================================================================================
+void DashPacketyzer::SetInitSegmentData(const std::shared_ptr<SegmentData> &init_segment)
+{
+    if (init_segment->file_name == MPD_VIDEO_INIT_FILE_NAME)
+        _mpd_video_init_file = init_segment;
+    else
+        _mpd_audio_init_file = init_segment;
+
+    UploadSegmentData(init_segment);
+}
+
+//====================================================================================================
+// Video codecs
+//====================================================================================================
+std::string DashPacketyzer::GetVideoCodecString()
+{
+    std::lock_guard<std::mutex> lock(_video_codec_string_mutex);
+    return _video_codec_string;
+}
+
 //====================================================================================================
 // Audio 설정 값 Load
 // - sample rate
@@ -195,30 +383,38 @@ bool DashPacketyzer::VideoInit(std::shared_ptr<ov::Data> &frame_data)
 //====================================================================================================
 bool DashPacketyzer::AudioInit()
 {
-    std::shared_ptr<std::vector<uint8_t>> temp = nullptr;
+    // Audio init m4s 생성(메모리, 같은 설정의 init m4s 는 공유)
+    auto key = MakeInitCacheKey(M4sMediaType::AudioMediaType, _media_info.audio_timescale, AUDIO_TRACK_ID);
 
-    // Audio init m4s 생성(메모리)
-    auto writer = std::make_unique<M4sInitWriter>(M4sMediaType::AudioMediaType,
-                                                  1024,
-                                                  _segment_duration * _media_info.audio_timescale,
-                                                  _media_info.audio_timescale,
-                                                  AUDIO_TRACK_ID,
-                                                  _media_info.video_width,
-                                                  _media_info.video_height,
-                                                  temp,
-                                                  temp,
-                                                  _media_info.audio_channels,
-                                                  16,
-                                                  _media_info.audio_samplerate);
+    auto init_segment = M4sInitCache::GetInitSegment(MPD_AUDIO_INIT_FILE_NAME, key, MakeSegmentCacheControl(),
+        [&]() -> std::shared_ptr<std::vector<uint8_t>>
+        {
+            std::shared_ptr<std::vector<uint8_t>> temp = nullptr;
+
+            auto writer = std::make_unique<M4sInitWriter>(M4sMediaType::AudioMediaType,
+                                                          1024,
+                                                          _segment_duration * _media_info.audio_timescale,
+                                                          _media_info.audio_timescale,
+                                                          AUDIO_TRACK_ID,
+                                                          _media_info.video_width,
+                                                          _media_info.video_height,
+                                                          temp,
+                                                          temp,
+                                                          _media_info.audio_channels,
+                                                          16,
+                                                          _media_info.audio_samplerate);
+
+            return (writer->CreateData() > 0) ? writer->GetDataStream() : nullptr;
+        });
 
-    if (writer->CreateData() <= 0)
+    if (init_segment == nullptr)
     {
         logte("Audio writer create fail");
         return false;
     }
 
     // Audio init m4s Save
-    SetSegmentData(MPD_AUDIO_INIT_FILE_NAME, 0, 0, writer->GetDataStream());
+    SetInitSegmentData(init_segment);
 
     _audio_init = true;
 
@@ -242,27 +438,46 @@ bool DashPacketyzer::AppendVideoFrame(std::shared_ptr<PacketyzerFrameData> &fram
 
     // Fragment Check
     // - KeyFrame ~ KeyFrame 전까지
-    if (frame_data->type == PacketyzerFrameType::VideoIFrame && !_video_frame_datas.empty())
+    if (frame_data->type == PacketyzerFrameType::VideoIFrame && !_video_frame_datas.empty() &&
+        IsSegmentCutTimestamp((_video_chunked_segment != nullptr) ? _video_chunked_segment->timestamp : _video_frame_datas[0]->timestamp,
+                              frame_data->timestamp,
+                              _media_info.video_timescale))
     {
-        if (frame_data->timestamp - _video_frame_datas[0]->timestamp >=
-                (_segment_duration * _media_info.video_timescale))
+        VideoSegmentWrite(frame_data->timestamp);
+
+        if (!_audio_frame_datas.empty() || _audio_chunked_segment != nullptr)
         {
-            VideoSegmentWrite(frame_data->timestamp);
+            AudioSegmentWrite(ConvertTimeScale(frame_data->timestamp,
+                                                _media_info.video_timescale,
+                                                _media_info.audio_timescale), false);
+        }
 
-            if (!_audio_frame_datas.empty())
-            {
-                AudioSegmentWrite(ConvertTimeScale(frame_data->timestamp,
-                                                    _media_info.video_timescale,
-                                                    _media_info.audio_timescale), false);
-            }
+        UpdatePlayList();
+    }
+    // Chunk Check(low latency)
+    else if (IsLowLatency() && !_video_frame_datas.empty() &&
+            (frame_data->timestamp - _video_frame_datas[0]->timestamp) * 1000 >=
+                ((uint64_t)_chunk_duration * _media_info.video_timescale))
+    {
+        VideoChunkWrite(frame_data->timestamp);
 
-            UpdatePlayList();
+        if (!_audio_frame_datas.empty())
+        {
+            AudioChunkWrite(ConvertTimeScale(frame_data->timestamp,
+                                              _media_info.video_timescale,
+                                              _media_info.audio_timescale), false);
         }
     }
 
     _video_frame_datas.push_back(frame_data);
     _last_video_append_time = time(nullptr);
 
+    if (IsLowLatency())
+    {
+        // blocking request timeout check
+        NotifyChunkWaiters();
+    }
+
     return true;
 }
 
@@ -281,13 +496,20 @@ bool DashPacketyzer::AppendAudioFrame(std::shared_ptr<PacketyzerFrameData> &fram
     if ((time(nullptr) - _last_video_append_time >=
             static_cast<uint32_t>(_segment_duration)) && !_audio_frame_datas.empty())
     {
-        if ((frame_data->timestamp - _audio_frame_datas[0]->timestamp) >=
+        if ((frame_data->timestamp - ((_audio_chunked_segment != nullptr) ? _audio_chunked_segment->timestamp : _audio_frame_datas[0]->timestamp)) >=
                 (_segment_duration * _media_info.audio_timescale))
         {
             AudioSegmentWrite(frame_data->timestamp, true);
 
             UpdatePlayList();
         }
+        // Chunk Check(low latency)
+        else if (IsLowLatency() &&
+                (frame_data->timestamp - _audio_frame_datas[0]->timestamp) * 1000 >=
+                    ((uint64_t)_chunk_duration * _media_info.audio_timescale))
+        {
+            AudioChunkWrite(frame_data->timestamp, true);
+        }
     }
 
     _audio_frame_datas.push_back(frame_data);
@@ -302,7 +524,38 @@ bool DashPacketyzer::AppendAudioFrame(std::shared_ptr<PacketyzerFrameData> &fram
 //====================================================================================================
 bool DashPacketyzer::VideoSegmentWrite(uint64_t max_timestamp)
 {
+    // the last chunk + chunks concatenation
+    if (IsLowLatency())
+    {
+        VideoChunkWrite(max_timestamp);
+
+        return ChunkedSegmentWrite(_video_chunked_segment, max_timestamp);
+    }
+
     uint64_t start_timestamp = 0;
+
+    auto fragment_data = MakeVideoFragment(max_timestamp, _video_sequence_number, start_timestamp);
+
+    std::ostringstream file_name_stream;
+    file_name_stream << _segment_prefix.CStr() << "_" << start_timestamp << MPD_VIDEO_SUFFIX;
+
+    ov::String file_name = file_name_stream.str().c_str();
+
+    // m4s 데이터 저장
+    SetSegmentData(file_name, max_timestamp - start_timestamp, start_timestamp, fragment_data);
+
+    return true;
+}
+
+//====================================================================================================
+// Video Fragment(moof + mdat)
+// - frames before max_timestamp
+//====================================================================================================
+std::shared_ptr<std::vector<uint8_t>> DashPacketyzer::MakeVideoFragment(uint64_t max_timestamp,
+                                                                        uint32_t sequence_number,
+                                                                        uint64_t &start_timestamp)
+{
+    start_timestamp = 0;
     std::vector<std::shared_ptr<FragmentSampleData>> sample_datas;
 
     while (!_video_frame_datas.empty())
@@ -320,16 +573,29 @@ bool DashPacketyzer::VideoSegmentWrite(uint64_t max_timestamp)
         uint64_t duration = _video_frame_datas.empty() ? (max_timestamp - frame_data->timestamp) :
                             (_video_frame_datas.front()->timestamp - frame_data->timestamp);
 
-        int offset = (frame_data->type == PacketyzerFrameType::VideoIFrame) ?
-                                        _avc_nal_header_size : AVC_NAL_START_PATTERN_SIZE;
+        bool length_prefixed = false;
+        ov::DataView sample;
+
+        if (frame_data->bitstream != nullptr)
+        {
+            // Every NAL unit of the frame is written (the AVCC form is shared with the other packetyzers of the stream)
+            sample = ov::DataView(frame_data->bitstream->GetAvcc());
+            length_prefixed = true;
+        }
+        else
+        {
+            int offset = (frame_data->type == PacketyzerFrameType::VideoIFrame) ?
+                                            _avc_nal_header_size : AVC_NAL_START_PATTERN_SIZE;
 
-        frame_data->data = frame_data->data->Subdata(offset);
+            sample = ov::DataView(frame_data->data).Subdata(offset);
+        }
 
         auto sample_data = std::make_shared<FragmentSampleData>(duration,
                                                                 frame_data->type == PacketyzerFrameType::VideoIFrame
                                                                 ? 0X02000000 : 0X01010000,
                                                                 frame_data->time_offset,
-                                                                frame_data->data);
+                                                                sample,
+                                                                length_prefixed);
 
         sample_datas.push_back(sample_data);
     }
@@ -339,32 +605,58 @@ bool DashPacketyzer::VideoSegmentWrite(uint64_t max_timestamp)
     // Fragment 쓰기
     auto fragment_writer = std::make_unique<M4sFragmentWriter>(M4sMediaType::VideoMediaType,
                                                                 4096,
-                                                                _video_sequence_number,
+                                                                sequence_number,
                                                                 VIDEO_TRACK_ID,
                                                                 start_timestamp,
                                                                 sample_datas);
 
     fragment_writer->CreateData();
 
+    return fragment_writer->GetDataStream();
+}
+
+//====================================================================================================
+// Audio Segment Write
+// - 비디오 Segment 생성이후 생성 or Audio Only 에서 생성
+//====================================================================================================
+bool DashPacketyzer::AudioSegmentWrite(uint64_t max_timestamp, bool is_audio_timestamp)
+{
+    // the last chunk + chunks concatenation
+    if (IsLowLatency())
+    {
+        AudioChunkWrite(max_timestamp, is_audio_timestamp);
+
+        return ChunkedSegmentWrite(_audio_chunked_segment, _audio_chunk_end_timestamp);
+    }
+
+    uint64_t start_timestamp = 0;
+    uint64_t end_timestamp = 0;
+
+    auto fragment_data = MakeAudioFragment(max_timestamp, is_audio_timestamp, _audio_sequence_number, start_timestamp, end_timestamp);
+
     std::ostringstream file_name_stream;
-    file_name_stream << _segment_prefix.CStr() << "_" << start_timestamp << MPD_VIDEO_SUFFIX;
+    file_name_stream << _segment_prefix.CStr() << "_" << start_timestamp << MPD_AUDIO_SUFFIX;
 
     ov::String file_name = file_name_stream.str().c_str();
 
-    // m4s 데이터 저장
-    SetSegmentData(file_name, max_timestamp - start_timestamp, start_timestamp, fragment_writer->GetDataStream());
+    // m4s save
+    SetSegmentData(file_name, end_timestamp - start_timestamp, start_timestamp, fragment_data);
 
     return true;
 }
 
 //====================================================================================================
-// Audio Segment Write
-// - 비디오 Segment 생성이후 생성 or Audio Only 에서 생성
+// Audio Fragment(moof + mdat)
+// - frames before max_timestamp(the last frame is kept if max_timestamp is video timestamp)
 //====================================================================================================
-bool DashPacketyzer::AudioSegmentWrite(uint64_t max_timestamp, bool is_audio_timestamp)
+std::shared_ptr<std::vector<uint8_t>> DashPacketyzer::MakeAudioFragment(uint64_t max_timestamp,
+                                                                        bool is_audio_timestamp,
+                                                                        uint32_t sequence_number,
+                                                                        uint64_t &start_timestamp,
+                                                                        uint64_t &end_timestamp)
 {
-    uint64_t start_timestamp = 0;
-    uint64_t end_timestamp = 0;
+    start_timestamp = 0;
+    end_timestamp = 0;
     std::vector<std::shared_ptr<FragmentSampleData>> sample_datas;
 
     while (!_audio_frame_datas.empty())
@@ -384,9 +676,7 @@ bool DashPacketyzer::AudioSegmentWrite(uint64_t max_timestamp, bool is_audio_tim
 
         end_timestamp = _audio_frame_datas.empty() ? max_timestamp : _audio_frame_datas.front()->timestamp;
 
-        frame_data->data = frame_data->data->Subdata(ADTS_HEADER_SIZE);
-
-        auto sample_data = std::make_shared<FragmentSampleData>(duration, 0, 0, frame_data->data);
+        auto sample_data = std::make_shared<FragmentSampleData>(duration, 0, 0, ov::DataView(frame_data->data).Subdata(ADTS_HEADER_SIZE));
 
         sample_datas.push_back(sample_data);
     }
@@ -394,24 +684,254 @@ bool DashPacketyzer::AudioSegmentWrite(uint64_t max_timestamp, bool is_audio_tim
     // Fragment write
     auto fragment_writer = std::make_unique<M4sFragmentWriter>(M4sMediaType::AudioMediaType,
                                                                 4096,
-                                                                _audio_sequence_number,
+                                                                sequence_number,
                                                                 AUDIO_TRACK_ID,
                                                                 start_timestamp,
                                                                 sample_datas);
 
     fragment_writer->CreateData();
 
-    std::ostringstream file_name_stream;
-    file_name_stream << _segment_prefix.CStr() << "_" << start_timestamp << MPD_AUDIO_SUFFIX;
+    return fragment_writer->GetDataStream();
+}
 
-    ov::String file_name = file_name_stream.str().c_str();
+//====================================================================================================
+// Video Chunk Write(low latency)
+// - frames before max_timestamp are written as a chunk of the segment
+//====================================================================================================
+bool DashPacketyzer::VideoChunkWrite(uint64_t max_timestamp)
+{
+    if (_video_frame_datas.empty() || _video_frame_datas.front()->timestamp >= max_timestamp)
+    {
+        return false;
+    }
 
-    // m4s save
-    SetSegmentData(file_name, end_timestamp - start_timestamp, start_timestamp, fragment_writer->GetDataStream());
+    uint64_t start_timestamp = 0;
+
+    auto fragment_data = MakeVideoFragment(max_timestamp, _video_chunk_sequence_number++, start_timestamp);
+
+    return AppendChunk(_video_chunked_segment, MPD_VIDEO_SUFFIX, start_timestamp, fragment_data);
+}
+
+//====================================================================================================
+// Audio Chunk Write(low latency)
+//====================================================================================================
+bool DashPacketyzer::AudioChunkWrite(uint64_t max_timestamp, bool is_audio_timestamp)
+{
+    uint64_t start_timestamp = 0;
+    uint64_t end_timestamp = 0;
+
+    if (_audio_frame_datas.empty())
+    {
+        return false;
+    }
+
+    auto fragment_data = MakeAudioFragment(max_timestamp,
+                                           is_audio_timestamp,
+                                           _audio_chunk_sequence_number,
+                                           start_timestamp,
+                                           end_timestamp);
+
+    // no sample
+    if (end_timestamp == 0)
+    {
+        return false;
+    }
+
+    _audio_chunk_sequence_number++;
+    _audio_chunk_end_timestamp = end_timestamp;
+
+    return AppendChunk(_audio_chunked_segment, MPD_AUDIO_SUFFIX, start_timestamp, fragment_data);
+}
+
+//====================================================================================================
+// Append Chunk(low latency)
+// - the segment file name is decided by the first chunk
+//====================================================================================================
+bool DashPacketyzer::AppendChunk(std::shared_ptr<DashChunkedSegment> &chunked_segment,
+                                 const char *suffix,
+                                 uint64_t start_timestamp,
+                                 const std::shared_ptr<std::vector<uint8_t>> &fragment)
+{
+    auto chunk = std::make_shared<ov::Data>(fragment->data(), fragment->size());
+
+    {
+        std::unique_lock<std::mutex> lock(_chunk_guard);
+
+        if (chunked_segment == nullptr)
+        {
+            std::ostringstream file_name_stream;
+            file_name_stream << _segment_prefix.CStr() << "_" << start_timestamp << suffix;
+
+            chunked_segment = std::make_shared<DashChunkedSegment>(file_name_stream.str().c_str(), start_timestamp);
+        }
+
+        chunked_segment->chunks.push_back(chunk);
+        chunked_segment->size += chunk->GetLength();
+    }
+
+    NotifyChunkWaiters();
+
+    return true;
+}
+
+//====================================================================================================
+// Chunked Segment Write(low latency)
+// - completed segment = chunks concatenation
+//====================================================================================================
+bool DashPacketyzer::ChunkedSegmentWrite(std::shared_ptr<DashChunkedSegment> &chunked_segment, uint64_t end_timestamp)
+{
+    // chunked_segment is modified by this thread only
+    if (chunked_segment == nullptr)
+    {
+        return false;
+    }
+
+    auto data = std::make_shared<std::vector<uint8_t>>();
+    data->reserve(chunked_segment->size);
+
+    for (const auto &chunk : chunked_segment->chunks)
+    {
+        data->insert(data->end(), chunk->GetDataAs<uint8_t>(), chunk->GetDataAs<uint8_t>() + chunk->GetLength());
+    }
+
+    // m4s save(completed segment is searched before the chunked segment is removed)
+    SetSegmentData(chunked_segment->file_name, end_timestamp - chunked_segment->timestamp, chunked_segment->timestamp, data);
+
+    {
+        std::unique_lock<std::mutex> lock(_chunk_guard);
+        chunked_segment = nullptr;
+    }
+
+    NotifyChunkWaiters();
+
+    return true;
+}
+
+//====================================================================================================
+// Get Chunked Segment(low latency)
+//====================================================================================================
+bool DashPacketyzer::GetChunkedSegmentData(const ov::String &file_name,
+                                           size_t offset,
+                                           std::vector<std::shared_ptr<const ov::Data>> &chunks,
+                                           bool &is_completed)
+{
+    if (!IsLowLatency() || !_init_segment_count_complete)
+        return false;
+
+    {
+        std::unique_lock<std::mutex> lock(_chunk_guard);
+
+        for (const auto &chunked_segment : {_video_chunked_segment, _audio_chunked_segment})
+        {
+            if (chunked_segment == nullptr || chunked_segment->file_name != file_name)
+                continue;
+
+            size_t position = 0;
+
+            for (const auto &chunk : chunked_segment->chunks)
+            {
+                if (position + chunk->GetLength() > offset)
+                {
+                    chunks.push_back((position >= offset) ? chunk : chunk->Subdata(offset - position));
+                }
+
+                position += chunk->GetLength();
+            }
+
+            is_completed = false;
+            return true;
+        }
+    }
+
+    std::shared_ptr<SegmentData> segment_data = nullptr;
+
+    if (!GetSegmentData(file_name, segment_data))
+        return false;
+
+    const auto &data = segment_data->data;
+
+    if (offset < data->GetLength())
+        chunks.push_back((offset == 0) ? data : data->Subdata(offset));
+
+    is_completed = true;
+    return true;
+}
+
+//====================================================================================================
+// Chunk Available Check
+// - _chunk_guard must be locked
+//====================================================================================================
+bool DashPacketyzer::IsChunkAvailable(const ov::String &file_name, size_t offset)
+{
+    for (const auto &chunked_segment : {_video_chunked_segment, _audio_chunked_segment})
+    {
+        if (chunked_segment != nullptr && chunked_segment->file_name == file_name)
+            return chunked_segment->size > offset;
+    }
 
+    // completed(or removed)
     return true;
 }
 
+//====================================================================================================
+// Wait Chunked Segment(low latency)
+//====================================================================================================
+PacketyzerWaitResult DashPacketyzer::WaitChunkedSegment(const ov::String &file_name,
+                                                        size_t offset,
+                                                        const PacketyzerWaitCallback &callback)
+{
+    if (!IsLowLatency())
+        return PacketyzerWaitResult::Available;
+
+    std::unique_lock<std::mutex> lock(_chunk_guard);
+
+    if (IsChunkAvailable(file_name, offset))
+        return PacketyzerWaitResult::Available;
+
+    _chunk_waiters.push_back({file_name,
+                              offset,
+                              GetCurrentMilliseconds() + (double)_segment_duration * 1000 * DASH_WAIT_TIMEOUT_SEGMENT_COUNT,
+                              callback});
+
+    return PacketyzerWaitResult::Waiting;
+}
+
+//====================================================================================================
+// Notify Chunk Waiters
+// - callbacks are called without lock
+//====================================================================================================
+void DashPacketyzer::NotifyChunkWaiters(bool expire_all)
+{
+    std::vector<PacketyzerWaitCallback> callbacks;
+
+    {
+        std::unique_lock<std::mutex> lock(_chunk_guard);
+
+        if (_chunk_waiters.empty())
+            return;
+
+        double current_time = GetCurrentMilliseconds();
+
+        for (auto item = _chunk_waiters.begin(); item != _chunk_waiters.end();)
+        {
+            if (expire_all || current_time >= item->deadline || IsChunkAvailable(item->file_name, item->offset))
+            {
+                callbacks.push_back(std::move(item->callback));
+                item = _chunk_waiters.erase(item);
+            }
+            else
+            {
+                item++;
+            }
+        }
+    }
+
+    for (const auto &callback : callbacks)
+    {
+        callback();
+    }
+}
+
 //====================================================================================================
 // PlayList(mpd) Update
 // - 차후 자동 인덱싱 사용시 참고 : LSN = floor(now - (availabilityStartTime + PST) / segmentDuration + startNumber - 1)
@@ -475,6 +995,16 @@ bool DashPacketyzer::UpdatePlayList()
 
     double current_milliseconds = GetCurrentMilliseconds();
 
+    // Low latency : the segment can be requested when its first chunk is written
+    std::ostringstream availability_time_offset;
+    if (IsLowLatency())
+    {
+        availability_time_offset << std::fixed << std::setprecision(3)
+                                 << " availabilityTimeOffset=\""
+                                 << ((double)_segment_duration - (double)_chunk_duration / 1000.0)
+                                 << "\" availabilityTimeComplete=\"false\"";
+    }
+
     play_list_stream << std::fixed << std::setprecision(3)
             << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
             << "<MPD xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"\n"
@@ -502,12 +1032,13 @@ bool DashPacketyzer::UpdatePlayList()
             << "\" segmentAlignment=\"true\" startWithSAP=\"1\" subsegmentAlignment=\"true\" subsegmentStartsWithSAP=\"1\">"
             << "\n"
             << "\t\t<SegmentTemplate timescale=\"" << _media_info.video_timescale
-            << "\" initialization=\"" << MPD_VIDEO_INIT_FILE_NAME << "\" media=\"" << _segment_prefix.CStr() << "_$Time$" << MPD_VIDEO_SUFFIX << "\">\n"
+            << "\" initialization=\"" << MPD_VIDEO_INIT_FILE_NAME << "\" media=\"" << _segment_prefix.CStr() << "_$Time$" << MPD_VIDEO_SUFFIX << "\""
+            << availability_time_offset.str() << ">\n"
             << "\t\t\t<SegmentTimeline>\n"
             << video_urls.str()
             << "\t\t\t</SegmentTimeline>\n"
             << "\t\t</SegmentTemplate>\n"
-            << "\t\t<Representation codecs=\"avc1.42401f\" sar=\"1:1\" bandwidth=\"" << _media_info.video_bitrate
+            << "\t\t<Representation codecs=\"" << GetVideoCodecString() << "\" sar=\"1:1\" bandwidth=\"" << _media_info.video_bitrate
             << "\" />\n"
             << "\t</AdaptationSet>\n";
     }
@@ -519,7 +1050,8 @@ bool DashPacketyzer::UpdatePlayList()
             << "\t\t<AudioChannelConfiguration schemeIdUri=\"urn:mpeg:dash:23003:3:audio_channel_configuration:2011\" value=\""
             << _media_info.audio_channels << "\"/>\n"
             << "\t\t<SegmentTemplate timescale=\"" << _media_info.audio_timescale
-            << "\" initialization=\"" << MPD_AUDIO_INIT_FILE_NAME << "\" media=\"" << _segment_prefix.CStr() << "_$Time$" << MPD_AUDIO_SUFFIX << "\">\n"
+            << "\" initialization=\"" << MPD_AUDIO_INIT_FILE_NAME << "\" media=\"" << _segment_prefix.CStr() << "_$Time$" << MPD_AUDIO_SUFFIX << "\""
+            << availability_time_offset.str() << ">\n"
             << "\t\t\t<SegmentTimeline>\n"
             << audio_urls.str()
             << "\t\t\t</SegmentTimeline>\n"
@@ -529,7 +1061,40 @@ bool DashPacketyzer::UpdatePlayList()
             << "\t</AdaptationSet>\n";
     }
 
-    play_list_stream << "</Period>\n" << "</MPD>\n";
+    play_list_stream << "</Period>\n";
+
+    // Low latency : players synchronize the clock to request the segment being written
+    if (IsLowLatency())
+    {
+        play_list_stream << "<UTCTiming schemeIdUri=\"urn:mpeg:dash:utc:direct:2014\" value="
+                         << MakeUtcTimeString(time(nullptr)) << "/>\n";
+    }
+
+    play_list_stream << "</MPD>\n";
+
+    // Representation of the master MPD(the renditions of the same input)
+    auto representation = std::make_shared<DashRepresentation>();
+
+    representation->stream_type = _stream_type;
+    representation->media_info = _media_info;
+    representation->video_codec_string = GetVideoCodecString();
+    representation->pixel_aspect_ratio = _mpd_pixel_aspect_ratio;
+    representation->start_time = _start_time;
+    representation->time_shift_buffer_depth = time_shift_buffer_depth;
+    representation->suggested_presentation_delay = _mpd_suggested_presentation_delay;
+    representation->min_buffer_time = _mpd_min_buffer_time;
+    representation->availability_time_offset = availability_time_offset.str();
+    representation->video_timeline = video_urls.str();
+    representation->audio_timeline = audio_urls.str();
+    representation->segment_prefix = _segment_prefix.CStr();
+    representation->segment_duration = _segment_duration;
+    representation->play_list_max_age = _play_list_max_age;
+
+    std::atomic_store(&_representation, std::shared_ptr<const DashRepresentation>(representation));
+
+    // HLS(CMAF) playlists are set before the MPD, so they are ready when the playlist requests are released
+    if (_hls_play_list_enabled)
+        UpdateHlsPlayList(video_segment_datas, audio_segment_datas);
 
     ov::String play_list = play_list_stream.str().c_str();
     SetPlayList(play_list);
@@ -546,10 +1111,286 @@ bool DashPacketyzer::UpdatePlayList()
     return true;
 }
 
+//====================================================================================================
+// Enable HLS(CMAF) PlayList
+// - multivariant playlist is not changed(made once)
+//====================================================================================================
+void DashPacketyzer::EnableHlsPlayList(bool byte_range)
+{
+    if (_hls_play_list_enabled.exchange(true))
+        return;
+
+    // the segments stored before are referred by their own files
+    _hls_byte_range = byte_range;
+
+    std::ostringstream play_list_stream;
+    bool has_video = _stream_type != PacketyzerStreamType::AudioOnly;
+    bool has_audio = _stream_type != PacketyzerStreamType::VideoOnly;
+
+    play_list_stream << "#EXTM3U" << "\r\n"
+                     << "#EXT-X-VERSION:7" << "\r\n"
+                     << "#EXT-X-INDEPENDENT-SEGMENTS" << "\r\n";
+
+    if (has_video && has_audio)
+    {
+        play_list_stream << "#EXT-X-MEDIA:TYPE=AUDIO,GROUP-ID=\"audio\",NAME=\"audio\",DEFAULT=YES,AUTOSELECT=YES,URI=\""
+                         << CMAF_HLS_AUDIO_PLAY_LIST_FILE_NAME << "\"\r\n";
+    }
+
+    // BANDWIDTH is required(the bitrate is unknown if it is not set by the encoder)
+    play_list_stream << "#EXT-X-STREAM-INF:BANDWIDTH="
+                     << std::max((has_video ? _media_info.video_bitrate : 0U) + (has_audio ? _media_info.audio_bitrate : 0U), 1U)
+                     << ",CODECS=\"";
+
+    if (has_video)
+        play_list_stream << GetVideoCodecString() << (has_audio ? "," : "");
+
+    if (has_audio)
+        play_list_stream << "mp4a.40.2";
+
+    play_list_stream << "\"";
+
+    if (has_video)
+    {
+        play_list_stream << ",RESOLUTION=" << _media_info.video_width << "x" << _media_info.video_height;
+
+        if (has_audio)
+            play_list_stream << ",AUDIO=\"audio\"";
+    }
+
+    play_list_stream << "\r\n"
+                     << (has_video ? CMAF_HLS_VIDEO_PLAY_LIST_FILE_NAME : CMAF_HLS_AUDIO_PLAY_LIST_FILE_NAME) << "\r\n";
+
+    ov::String play_list = play_list_stream.str().c_str();
+    std::atomic_store(&_hls_master_play_list, MakePlayListSnapshot(play_list));
+
+    UploadPlayList(CMAF_HLS_PLAY_LIST_FILE_NAME, _hls_master_play_list);
+}
+
+//====================================================================================================
+// HLS(CMAF) PlayList
+// - thread safe
+//====================================================================================================
+bool DashPacketyzer::GetHlsPlayList(const ov::String &file_name, std::shared_ptr<const PlayListSnapshot> &play_list)
+{
+    if (!_init_segment_count_complete)
+        return false;
+
+    if (file_name == CMAF_HLS_PLAY_LIST_FILE_NAME)
+        play_list = std::atomic_load(&_hls_master_play_list);
+    else if (file_name == CMAF_HLS_VIDEO_PLAY_LIST_FILE_NAME && _stream_type != PacketyzerStreamType::AudioOnly)
+        play_list = std::atomic_load(&_hls_video_play_list);
+    else if (file_name == CMAF_HLS_AUDIO_PLAY_LIST_FILE_NAME && _stream_type != PacketyzerStreamType::VideoOnly)
+        play_list = std::atomic_load(&_hls_audio_play_list);
+    else
+        play_list = nullptr;
+
+    return (play_list != nullptr);
+}
+
+//====================================================================================================
+// Representation
+// - thread safe
+//====================================================================================================
+std::shared_ptr<const DashRepresentation> DashPacketyzer::GetRepresentation()
+{
+    if (!_init_segment_count_complete)
+        return nullptr;
+
+    return std::atomic_load(&_representation);
+}
+
+//====================================================================================================
+// Master PlayList(mpd)
+// - the first representation is the base of the MPD attributes(availabilityStartTime, ...)
+//====================================================================================================
+ov::String DashPacketyzer::MakeMasterPlayList(const std::vector<std::pair<ov::String, std::shared_ptr<const DashRepresentation>>> &representations,
+                                              bool segment_alignment)
+{
+    if (representations.empty())
+        return "";
+
+    const auto &base = representations[0].second;
+    const char *alignment = segment_alignment ? "true" : "false";
+
+    const std::pair<ov::String, std::shared_ptr<const DashRepresentation>> *audio = nullptr;
+    double time_shift_buffer_depth = base->time_shift_buffer_depth;
+
+    for (const auto &item : representations)
+    {
+        if (audio == nullptr && !item.second->audio_timeline.empty())
+            audio = &item;
+
+        time_shift_buffer_depth = std::min(time_shift_buffer_depth, item.second->time_shift_buffer_depth);
+    }
+
+    std::ostringstream play_list_stream;
+
+    play_list_stream << std::fixed << std::setprecision(3)
+            << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+            << "<MPD xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"\n"
+            << "    xmlns=\"urn:mpeg:dash:schema:mpd:2011\"\n"
+            << "    xmlns:xlink=\"http://www.w3.org/1999/xlink\"\n"
+            << "    xsi:schemaLocation=\"urn:mpeg:DASH:schema:MPD:2011 http://standards.iso.org/ittf/PubliclyAvailableStandards/MPEG-DASH_schema_files/DASH-MPD.xsd\"\n"
+            << "    profiles=\"urn:mpeg:dash:profile:isoff-live:2011\"\n"
+            << "    type=\"dynamic\"\n"
+            << "    minimumUpdatePeriod=\"PT" << (double)base->segment_duration << "S\"\n"
+            << "    publishTime=" << MakeUtcTimeString(time(nullptr)) << "\n"
+            << "    availabilityStartTime=" << base->start_time << "\n"
+            << "    timeShiftBufferDepth=\"PT" << time_shift_buffer_depth << "S\"\n"
+            << "    suggestedPresentationDelay=\"PT" << std::setprecision(1) << base->suggested_presentation_delay << "S\"\n"
+            << "    minBufferTime=\"PT" << base->min_buffer_time << "S\">\n"
+            << "<Period id=\"0\" start=\"PT0S\">\n";
+
+    // video : a Representation per stream(the timeline of the stream)
+    std::ostringstream video_representations;
+
+    for (const auto &item : representations)
+    {
+        const auto &representation = item.second;
+
+        if (representation->video_timeline.empty())
+            continue;
+
+        video_representations << std::fixed << std::setprecision(3)
+            << "\t\t<Representation id=\"" << item.first.CStr() << "\" codecs=\"" << representation->video_codec_string
+            << "\" sar=\"1:1\" bandwidth=\"" << representation->media_info.video_bitrate
+            << "\" width=\"" << representation->media_info.video_width
+            << "\" height=\"" << representation->media_info.video_height
+            << "\" frameRate=\"" << representation->media_info.video_framerate << "\">\n"
+            << "\t\t\t<SegmentTemplate timescale=\"" << representation->media_info.video_timescale
+            << "\" initialization=\"../" << item.first.CStr() << "/" << MPD_VIDEO_INIT_FILE_NAME
+            << "\" media=\"../" << item.first.CStr() << "/" << representation->segment_prefix << "_$Time$" << MPD_VIDEO_SUFFIX << "\""
+            << representation->availability_time_offset << ">\n"
+            << "\t\t\t\t<SegmentTimeline>\n"
+            << representation->video_timeline
+            << "\t\t\t\t</SegmentTimeline>\n"
+            << "\t\t\t</SegmentTemplate>\n"
+            << "\t\t</Representation>\n";
+    }
+
+    if (!video_representations.str().empty())
+    {
+        play_list_stream << "\t<AdaptationSet id=\"0\" group=\"1\" mimeType=\"video/mp4\" par=\"" << base->pixel_aspect_ratio
+            << "\" segmentAlignment=\"" << alignment << "\" startWithSAP=\"1\" subsegmentAlignment=\"" << alignment
+            << "\" subsegmentStartsWithSAP=\"1\">\n"
+            << video_representations.str()
+            << "\t</AdaptationSet>\n";
+    }
+
+    if (audio != nullptr)
+    {
+        const auto &representation = audio->second;
+
+        play_list_stream << "\t<AdaptationSet id=\"1\" group=\"2\" mimeType=\"audio/mp4\" lang=\"und\" segmentAlignment=\"true\" startWithSAP=\"1\" subsegmentAlignment=\"true\" subsegmentStartsWithSAP=\"1\">\n"
+            << "\t\t<AudioChannelConfiguration schemeIdUri=\"urn:mpeg:dash:23003:3:audio_channel_configuration:2011\" value=\""
+            << representation->media_info.audio_channels << "\"/>\n"
+            << "\t\t<SegmentTemplate timescale=\"" << representation->media_info.audio_timescale
+            << "\" initialization=\"../" << audio->first.CStr() << "/" << MPD_AUDIO_INIT_FILE_NAME
+            << "\" media=\"../" << audio->first.CStr() << "/" << representation->segment_prefix << "_$Time$" << MPD_AUDIO_SUFFIX << "\""
+            << representation->availability_time_offset << ">\n"
+            << "\t\t\t<SegmentTimeline>\n"
+            << representation->audio_timeline
+            << "\t\t\t</SegmentTimeline>\n"
+            << "\t\t</SegmentTemplate>\n"
+            << "\t\t<Representation codecs=\"mp4a.40.2\" audioSamplingRate=\"" << representation->media_info.audio_samplerate
+            << "\" bandwidth=\"" << representation->media_info.audio_bitrate << "\" />\n"
+            << "\t</AdaptationSet>\n";
+    }
+
+    play_list_stream << "</Period>\n";
+
+    // Low latency : players synchronize the clock to request the segment being written
+    if (!base->availability_time_offset.empty())
+    {
+        play_list_stream << "<UTCTiming schemeIdUri=\"urn:mpeg:dash:utc:direct:2014\" value="
+                         << MakeUtcTimeString(time(nullptr)) << "/>\n";
+    }
+
+    play_list_stream << "</MPD>\n";
+
+    return play_list_stream.str().c_str();
+}
+
+//====================================================================================================
+// Update HLS(CMAF) PlayList
+// - video/audio media playlists of the last segments(same as the MPD)
+//====================================================================================================
+void DashPacketyzer::UpdateHlsPlayList(const std::vector<std::shared_ptr<SegmentData>> &video_segment_datas,
+                                       const std::vector<std::shared_ptr<SegmentData>> &audio_segment_datas)
+{
+    if (!video_segment_datas.empty())
+    {
+        ov::String play_list = MakeHlsMediaPlayList(video_segment_datas,
+                                                    _video_sequence_number,
+                                                    _media_info.video_timescale,
+                                                    MPD_VIDEO_INIT_FILE_NAME);
+        std::atomic_store(&_hls_video_play_list, MakePlayListSnapshot(play_list));
+
+        UploadPlayList(CMAF_HLS_VIDEO_PLAY_LIST_FILE_NAME, _hls_video_play_list);
+    }
+
+    if (!audio_segment_datas.empty())
+    {
+        ov::String play_list = MakeHlsMediaPlayList(audio_segment_datas,
+                                                    _audio_sequence_number,
+                                                    _media_info.audio_timescale,
+                                                    MPD_AUDIO_INIT_FILE_NAME);
+        std::atomic_store(&_hls_audio_play_list, MakePlayListSnapshot(play_list));
+
+        UploadPlayList(CMAF_HLS_AUDIO_PLAY_LIST_FILE_NAME, _hls_audio_play_list);
+    }
+}
+
+//====================================================================================================
+// HLS(CMAF) Media PlayList
+// - EXT-X-MAP : init segment of the track
+// - media sequence : the segments of the track are numbered from the first sequence number
+//   (segment alignment : timestamp slot, next_sequence_number : the next segment)
+//====================================================================================================
+ov::String DashPacketyzer::MakeHlsMediaPlayList(const std::vector<std::shared_ptr<SegmentData>> &segment_datas,
+                                                uint32_t next_sequence_number,
+                                                uint32_t timescale,
+                                                const char *init_file_name)
+{
+    std::ostringstream play_list_stream;
+    std::ostringstream segment_list;
+    double max_duration = 0;
+
+    for (const auto &segment_data : segment_datas)
+    {
+        double duration = (timescale != 0) ? (double)segment_data->duration / (double)timescale : 0;
+
+        segment_list << "#EXTINF:" << std::fixed << std::setprecision(3) << duration << ",\r\n";
+
+        if (segment_data->window_file_name.IsEmpty())
+        {
+            segment_list << segment_data->file_name.CStr() << "\r\n";
+        }
+        else
+        {
+            segment_list << "#EXT-X-BYTERANGE:" << segment_data->data->GetLength() << "@" << segment_data->window_offset << "\r\n"
+                         << segment_data->window_file_name.CStr() << "\r\n";
+        }
+
+        max_duration = std::max(max_duration, duration);
+    }
+
+    play_list_stream << "#EXTM3U" << "\r\n"
+                     << "#EXT-X-VERSION:7" << "\r\n"
+                     << "#EXT-X-TARGETDURATION:" << (int)(max_duration + 0.5) << "\r\n"
+                     << "#EXT-X-MEDIA-SEQUENCE:" << (next_sequence_number - segment_datas.size()) << "\r\n"
+                     << "#EXT-X-INDEPENDENT-SEGMENTS" << "\r\n"
+                     << "#EXT-X-MAP:URI=\"" << init_file_name << "\"\r\n"
+                     << segment_list.str();
+
+    return play_list_stream.str().c_str();
+}
+
 //====================================================================================================
 // Get Segment
 //====================================================================================================
-bool DashPacketyzer::GetSegmentData(const ov::String &file_name, std::shared_ptr<ov::Data> &data)
+bool DashPacketyzer::GetSegmentData(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data)
 {
     if(!_init_segment_count_complete)
         return false;
@@ -559,11 +1400,11 @@ bool DashPacketyzer::GetSegmentData(const ov::String &file_name, std::shared_ptr
     {
         if(_mpd_video_init_file == nullptr)
         {
-            data = nullptr;
+            segment_data = nullptr;
             return false;
         }
 
-        data =_mpd_video_init_file->data;
+        segment_data = _mpd_video_init_file;
         return true;
     }
     // audio init file
@@ -571,14 +1412,26 @@ bool DashPacketyzer::GetSegmentData(const ov::String &file_name, std::shared_ptr
     {
         if(_mpd_audio_init_file == nullptr)
         {
-            data = nullptr;
+            segment_data = nullptr;
             return false;
         }
 
-        data =_mpd_audio_init_file->data;
+        segment_data = _mpd_audio_init_file;
         return true;
     }
 
+    // byte range window file
+    if (file_name.IndexOf(ov::String::FormatString("%s%s", _segment_prefix.CStr(), CMAF_HLS_WINDOW_FILE_INFIX)) == 0)
+    {
+        if (file_name.HasSuffix(MPD_VIDEO_SUFFIX))
+            return GetWindowSegmentData(file_name, _video_segment_datas, _current_video_index, _video_segment_guard, segment_data);
+        else if (file_name.HasSuffix(MPD_AUDIO_SUFFIX))
+            return GetWindowSegmentData(file_name, _audio_segment_datas, _current_audio_index, _audio_segment_guard, segment_data);
+
+        segment_data = nullptr;
+        return false;
+    }
+
     if (file_name.IndexOf(MPD_VIDEO_SUFFIX) >= 0)
     {
         // video segment mutex
@@ -592,12 +1445,12 @@ bool DashPacketyzer::GetSegmentData(const ov::String &file_name, std::shared_ptr
 
         if(item == _video_segment_datas.end())
         {
-            data = nullptr;
+            segment_data = nullptr;
             return false;
         }
 
-        data = (*item)->data;
-        return data != nullptr;
+        segment_data = *item;
+        return segment_data->data != nullptr;
     }
     else if (file_name.IndexOf(MPD_AUDIO_SUFFIX) >= 0)
     {
@@ -612,15 +1465,15 @@ bool DashPacketyzer::GetSegmentData(const ov::String &file_name, std::shared_ptr
 
         if(item == _audio_segment_datas.end())
         {
-            data = nullptr;
+            segment_data = nullptr;
             return false;
         }
 
-        data = (*item)->data;
-        return data != nullptr;
+        segment_data = *item;
+        return segment_data->data != nullptr;
     }
 
-    data = nullptr;
+    segment_data = nullptr;
     return false;
 }
 
@@ -632,27 +1485,28 @@ bool DashPacketyzer::SetSegmentData(ov::String file_name,
                                    uint64_t timestamp,
                                    const std::shared_ptr<std::vector<uint8_t>> &data)
 {
-    if(file_name == MPD_VIDEO_INIT_FILE_NAME)
-    {
-        _mpd_video_init_file = std::make_shared<SegmentData>(0, MPD_VIDEO_INIT_FILE_NAME, duration, timestamp, data);
-        return true;
-    }
-    else if(file_name == MPD_AUDIO_INIT_FILE_NAME)
-    {
-        _mpd_audio_init_file = std::make_shared<SegmentData>(0, MPD_AUDIO_INIT_FILE_NAME, duration, timestamp, data);
-        return true;
-    }
-
     if (file_name.IndexOf(MPD_VIDEO_SUFFIX) >= 0)
     {
         // video segment mutex
         std::unique_lock<std::mutex> lock(_video_segment_guard);
 
-        _video_segment_datas[_current_video_index++] =
-                std::make_shared<SegmentData>(_sequence_number++, file_name, duration, timestamp, data);
+        // the first segment is numbered by its timestamp(segment alignment)
+        if (!_video_sequence_aligned)
+        {
+            _video_sequence_aligned = true;
+            _video_sequence_number = GetFirstSequenceNumber(timestamp, _media_info.video_timescale);
+            _video_first_sequence_number = _video_sequence_number;
+        }
 
-        if(_segment_save_count <= _current_video_index)
-            _current_video_index = 0;
+        StoreSegmentData(_video_segment_datas, _current_video_index, file_name, duration, timestamp, data);
+
+        if (_hls_byte_range)
+        {
+            AppendWindowSegment(_video_segment_datas[(_current_video_index + _segment_save_count - 1) % _segment_save_count],
+                                _video_sequence_number - _video_first_sequence_number,
+                                MPD_VIDEO_SUFFIX,
+                                _video_window_size);
+        }
 
         _video_sequence_number++;
     }
@@ -661,17 +1515,29 @@ bool DashPacketyzer::SetSegmentData(ov::String file_name,
         // audio segment mutex
         std::unique_lock<std::mutex> lock(_audio_segment_guard);
 
-        _audio_segment_datas[_current_audio_index++] =
-                std::make_shared<SegmentData>(_sequence_number++, file_name, duration, timestamp, data);
+        if (!_audio_sequence_aligned)
+        {
+            _audio_sequence_aligned = true;
+            _audio_sequence_number = GetFirstSequenceNumber(timestamp, _media_info.audio_timescale);
+            _audio_first_sequence_number = _audio_sequence_number;
+        }
+
+        StoreSegmentData(_audio_segment_datas, _current_audio_index, file_name, duration, timestamp, data);
 
-        if(_segment_save_count <= _current_audio_index)
-            _current_audio_index = 0;
+        if (_hls_byte_range)
+        {
+            AppendWindowSegment(_audio_segment_datas[(_current_audio_index + _segment_save_count - 1) % _segment_save_count],
+                                _audio_sequence_number - _audio_first_sequence_number,
+                                MPD_AUDIO_SUFFIX,
+                                _audio_window_size);
+        }
 
         _audio_sequence_number++;
     }
 
     if(!_init_segment_count_complete &&
-            (_video_sequence_number > _segment_count || _audio_sequence_number > _segment_count))
+            ((_video_sequence_number - _video_first_sequence_number) >= _segment_count ||
+             (_audio_sequence_number - _audio_first_sequence_number) >= _segment_count))
     {
         _init_segment_count_complete = true;
         logti("Dash ready completed - prefix(%s) segment(%ds/%d)",
@@ -680,6 +1546,140 @@ bool DashPacketyzer::SetSegmentData(ov::String file_name,
                 _segment_count);
     }
 
+    // coalesced requests of the segment
+    NotifyMissWaiters();
+
     return true;
 }
 
+//====================================================================================================
+// Append Window Segment
+// - window index : segment index / segment count(a window file has the segments of a playlist)
+// - the offsets are not changed after the segment is stored(the ranges can be cached)
+//====================================================================================================
+void DashPacketyzer::AppendWindowSegment(const std::shared_ptr<SegmentData> &segment_data,
+                                         uint32_t segment_index,
+                                         const char *suffix,
+                                         uint64_t &window_size)
+{
+    if (segment_data == nullptr || segment_data->data == nullptr)
+        return;
+
+    // the first segment of the window(or byte range is enabled in the middle of the window)
+    if ((segment_index % _segment_count) == 0)
+        window_size = 0;
+
+    segment_data->window_file_name.Format("%s%s%u%s",
+                                          _segment_prefix.CStr(),
+                                          CMAF_HLS_WINDOW_FILE_INFIX,
+                                          segment_index / _segment_count,
+                                          suffix);
+    segment_data->window_offset = window_size;
+
+    window_size += segment_data->data->GetLength();
+}
+
+//====================================================================================================
+// Get Window Segment
+// - the segments of the window in the ring(oldest first) are gathered without copying
+// - growing : the last stored segment is in the window(ETag has the size, so it changes with the file)
+//====================================================================================================
+bool DashPacketyzer::GetWindowSegmentData(const ov::String &file_name,
+                                          std::vector<std::shared_ptr<SegmentData>> &segment_datas,
+                                          uint32_t current_index,
+                                          std::mutex &segment_guard,
+                                          std::shared_ptr<SegmentData> &segment_data)
+{
+    std::unique_lock<std::mutex> lock(segment_guard);
+
+    std::shared_ptr<SegmentData> window = nullptr;
+    uint64_t window_size = 0;
+
+    for (uint32_t offset = 0; offset < _segment_save_count; offset++)
+    {
+        const auto &slot = segment_datas[(current_index + offset) % _segment_save_count];
+
+        if (slot == nullptr || slot->data == nullptr || slot->window_file_name != file_name)
+            continue;
+
+        // the previous segments are evicted(or the window is restarted)
+        if (window == nullptr || slot->window_offset != window_size)
+        {
+            ov::String window_file_name = file_name;
+            std::shared_ptr<ov::Data> data = slot->data;
+
+            window = std::make_shared<SegmentData>(slot->sequence_number, window_file_name, slot->duration, slot->timestamp, data);
+            window->window_file_name = file_name;
+            window->window_offset = slot->window_offset;
+        }
+        else
+        {
+            window->gather_datas.push_back(slot->data);
+            window->duration += slot->duration;
+        }
+
+        window->create_time = slot->create_time;
+        window_size = slot->window_offset + slot->data->GetLength();
+    }
+
+    if (window == nullptr)
+    {
+        segment_data = nullptr;
+        return false;
+    }
+
+    const auto &last_segment = segment_datas[(current_index + _segment_save_count - 1) % _segment_save_count];
+
+    window->is_growing = (last_segment != nullptr) && (last_segment->window_file_name == file_name);
+
+    SetSegmentCacheInfo(window);
+    window->etag.Format("\"%llx-%s-%llu\"",
+                        static_cast<unsigned long long>(_etag_prefix),
+                        file_name.CStr(),
+                        static_cast<unsigned long long>(window_size));
+
+    segment_data = window;
+    return true;
+}
+
+//====================================================================================================
+// Segment Coming Check(request coalescing)
+// - [Prefix]_[Start Timestamp]_video(audio).m4s after the last stored segment
+// - low latency : the segment being made is sent by chunked transfer(not held)
+//====================================================================================================
+bool DashPacketyzer::IsSegmentComing(const ov::String &file_name)
+{
+    if(IsLowLatency())
+        return false;
+
+    bool is_video = file_name.IndexOf(MPD_VIDEO_SUFFIX) >= 0;
+
+    if(!is_video && file_name.IndexOf(MPD_AUDIO_SUFFIX) < 0)
+        return false;
+
+    ov::String prefix = ov::String::FormatString("%s_", _segment_prefix.CStr());
+    size_t suffix_length = is_video ? strlen(MPD_VIDEO_SUFFIX) : strlen(MPD_AUDIO_SUFFIX);
+
+    if(file_name.IndexOf(prefix) != 0 || file_name.GetLength() <= prefix.GetLength() + suffix_length)
+        return false;
+
+    uint64_t timestamp = ov::Converter::ToUInt64(file_name.Substring(prefix.GetLength(),
+                                                 file_name.GetLength() - prefix.GetLength() - suffix_length));
+    uint64_t timescale = is_video ? _media_info.video_timescale : _media_info.audio_timescale;
+
+    // video(audio) segment mutex
+    std::unique_lock<std::mutex> lock(is_video ? _video_segment_guard : _audio_segment_guard);
+
+    auto &segment_datas = is_video ? _video_segment_datas : _audio_segment_datas;
+    uint32_t current_index = is_video ? _current_video_index : _current_audio_index;
+    const auto &last_segment = segment_datas[(current_index + _segment_save_count - 1) % _segment_save_count];
+
+    if(last_segment == nullptr)
+        return false;
+
+    uint64_t next_timestamp = last_segment->timestamp + last_segment->duration;
+
+    return timestamp >= next_timestamp &&
+           timestamp < next_timestamp + _segment_duration * timescale * MISS_WAIT_TIMEOUT_SEGMENT_COUNT;
+}
+
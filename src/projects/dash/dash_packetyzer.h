@@ -12,6 +12,67 @@
 #include "segment_stream/packetyzer/packetyzer.h"
 #include "segment_stream/packetyzer/m4s_init_writer.h"
 #include "segment_stream/packetyzer/m4s_fragment_writer.h"
+#include "segment_stream/packetyzer/m4s_init_cache.h"
+
+#define DASH_PLAY_LIST_FILE_NAME            "manifest.mpd"
+
+// HLS(CMAF) playlists made from the DASH segments
+#define CMAF_HLS_PLAY_LIST_FILE_NAME        "playlist.m3u8"
+#define CMAF_HLS_VIDEO_PLAY_LIST_FILE_NAME  "video.m3u8"
+#define CMAF_HLS_AUDIO_PLAY_LIST_FILE_NAME  "audio.m3u8"
+
+// HLS(CMAF) byte range : [Prefix]_w[Window Index]_video(audio).m4s, a window file has the segments of a playlist
+#define CMAF_HLS_WINDOW_FILE_INFIX          "_w"
+
+// MPD of the renditions of the same input(ex: http://host/app/stream/master.mpd)
+#define DASH_MASTER_PLAY_LIST_FILE_NAME     "master.mpd"
+
+//====================================================================================================
+// DashChunkedSegment
+// - segment being written(low latency)
+// - chunk : moof + mdat(CMAF chunk)
+//====================================================================================================
+struct DashChunkedSegment
+{
+public :
+    DashChunkedSegment(const ov::String &file_name_, uint64_t timestamp_)
+    {
+        file_name = file_name_;
+        timestamp = timestamp_;
+    }
+
+public :
+    ov::String file_name;
+    uint64_t timestamp;
+    std::vector<std::shared_ptr<const ov::Data>> chunks;
+    size_t size = 0;
+};
+
+//====================================================================================================
+// DashRepresentation
+// - the MPD items of a stream, made with the MPD
+// - the master MPD is made from the representations of the renditions
+//====================================================================================================
+struct DashRepresentation
+{
+    PacketyzerStreamType stream_type;
+    PacketyzerMediaInfo media_info;
+    std::string video_codec_string;
+    std::string pixel_aspect_ratio;
+    std::string start_time;
+    double time_shift_buffer_depth;
+    double suggested_presentation_delay;
+    double min_buffer_time;
+    std::string availability_time_offset;
+
+    // <S> of the SegmentTimeline(empty : no segment of the track)
+    std::string video_timeline;
+    std::string audio_timeline;
+
+    std::string segment_prefix;
+    uint32_t segment_duration;
+    uint32_t play_list_max_age;
+};
 
 //====================================================================================================
 // DashPacketyzer
@@ -27,20 +88,25 @@ public:
                     const ov::String &segment_prefix,
                     uint32_t segment_count,
                     uint32_t segment_duration,
-                    PacketyzerMediaInfo &media_info);
+                    PacketyzerMediaInfo &media_info,
+                    uint32_t chunk_duration = 0);
 
     ~DashPacketyzer() final;
 
 public :
     bool VideoInit(std::shared_ptr<ov::Data> &frame_data);
 
+    bool HevcVideoInit(std::shared_ptr<ov::Data> &frame_data);
+
+    std::string GetVideoCodecString();
+
     bool AudioInit();
 
     virtual bool AppendVideoFrame(std::shared_ptr<PacketyzerFrameData> &frame_data) override;
 
     virtual bool AppendAudioFrame(std::shared_ptr<PacketyzerFrameData> &frame_data) override;
 
-    virtual bool GetSegmentData(const ov::String &file_name, std::shared_ptr<ov::Data> &data) override;
+    virtual bool GetSegmentData(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data) override;
 
     virtual bool SetSegmentData(ov::String file_name,
                                 uint64_t duration,
@@ -51,11 +117,91 @@ public :
 
     bool AudioSegmentWrite(uint64_t max_timestamp, bool is_audio_timestamp);
 
+    bool IsLowLatency() const { return _chunk_duration > 0; }
+
+    // Chunks of the segment after offset(byte)
+    // - segment being written : is_completed false
+    // - completed segment : is_completed true
+    bool GetChunkedSegmentData(const ov::String &file_name,
+                               size_t offset,
+                               std::vector<std::shared_ptr<const ov::Data>> &chunks,
+                               bool &is_completed);
+
+    // Waiting : callback is called when a chunk after offset is written(or the segment is completed, timeout)
+    PacketyzerWaitResult WaitChunkedSegment(const ov::String &file_name, size_t offset, const PacketyzerWaitCallback &callback);
+
+    // HLS(CMAF) playlists
+    // - multivariant playlist + video/audio media playlists of the same fMP4 segments
+    // - made with the MPD since EnableHlsPlayList() is called
+    // - byte_range : the segments are referred by EXT-X-BYTERANGE of the window files(by the first user)
+    void EnableHlsPlayList(bool byte_range = false);
+    bool GetHlsPlayList(const ov::String &file_name, std::shared_ptr<const PlayListSnapshot> &play_list);
+
+    // nullptr : the stream is not ready
+    std::shared_ptr<const DashRepresentation> GetRepresentation();
+
+    // MPD of the representations(stream name, representation)
+    // - a video Representation per stream in one AdaptationSet, the segments are referred by ../<stream>/
+    // - audio of the first stream which has the audio
+    static ov::String MakeMasterPlayList(const std::vector<std::pair<ov::String, std::shared_ptr<const DashRepresentation>>> &representations,
+                                         bool segment_alignment);
+
 protected :
+    M4sInitCacheKey MakeInitCacheKey(M4sMediaType media_type, uint32_t timescale, uint32_t track_id);
+
+    void SetInitSegmentData(const std::shared_ptr<SegmentData> &init_segment);
+
     bool UpdatePlayList();
 
+    void UpdateHlsPlayList(const std::vector<std::shared_ptr<SegmentData>> &video_segment_datas,
+                           const std::vector<std::shared_ptr<SegmentData>> &audio_segment_datas);
+
+    ov::String MakeHlsMediaPlayList(const std::vector<std::shared_ptr<SegmentData>> &segment_datas,
+                                    uint32_t next_sequence_number,
+                                    uint32_t timescale,
+                                    const char *init_file_name);
+
+    bool IsSegmentComing(const ov::String &file_name) override;
+
+    // Byte range window of the segment just stored(the segment guard must be locked)
+    void AppendWindowSegment(const std::shared_ptr<SegmentData> &segment_data,
+                             uint32_t segment_index,
+                             const char *suffix,
+                             uint64_t &window_size);
+
+    // Window file of the segments in the ring(the segment guard is locked inside)
+    bool GetWindowSegmentData(const ov::String &file_name,
+                              std::vector<std::shared_ptr<SegmentData>> &segment_datas,
+                              uint32_t current_index,
+                              std::mutex &segment_guard,
+                              std::shared_ptr<SegmentData> &segment_data);
+
+    std::shared_ptr<std::vector<uint8_t>> MakeVideoFragment(uint64_t max_timestamp,
+                                                            uint32_t sequence_number,
+                                                            uint64_t &start_timestamp);
+
+    std::shared_ptr<std::vector<uint8_t>> MakeAudioFragment(uint64_t max_timestamp,
+                                                            bool is_audio_timestamp,
+                                                            uint32_t sequence_number,
+                                                            uint64_t &start_timestamp,
+                                                            uint64_t &end_timestamp);
+
+    // Low latency(chunked CMAF)
+    bool VideoChunkWrite(uint64_t max_timestamp);
+    bool AudioChunkWrite(uint64_t max_timestamp, bool is_audio_timestamp);
+    bool AppendChunk(std::shared_ptr<DashChunkedSegment> &chunked_segment,
+                     const char *suffix,
+                     uint64_t start_timestamp,
+                     const std::shared_ptr<std::vector<uint8_t>> &fragment);
+    bool ChunkedSegmentWrite(std::shared_ptr<DashChunkedSegment> &chunked_segment, uint64_t end_timestamp);
+    bool IsChunkAvailable(const ov::String &file_name, size_t offset);
+    void NotifyChunkWaiters(bool expire_all = false);
+
 private :
     int _avc_nal_header_size;
+    // codecs of MPD/HLS(CMAF) playlist(HEVC : updated from the SPS of the first key frame)
+    std::string _video_codec_string;
+    std::mutex _video_codec_string_mutex;
     std::string _start_time;
     std::string _mpd_pixel_aspect_ratio;
     double _mpd_suggested_presentation_delay;
@@ -67,6 +213,10 @@ private :
 
     uint32_t _video_sequence_number = 1;
     uint32_t _audio_sequence_number = 1;
+    uint32_t _video_first_sequence_number = 1;
+    uint32_t _audio_first_sequence_number = 1;
+    bool _video_sequence_aligned = false;
+    bool _audio_sequence_aligned = false;
 
     std::deque<std::shared_ptr<PacketyzerFrameData>> _video_frame_datas;
     std::deque<std::shared_ptr<PacketyzerFrameData>> _audio_frame_datas;
@@ -75,4 +225,36 @@ private :
     time_t _last_audio_append_time;
 
     double _duration_threshold;
+
+    // Low latency(chunked CMAF)
+    struct ChunkWaiter
+    {
+        ov::String file_name;
+        size_t offset;
+        double deadline;        // milliseconds
+        PacketyzerWaitCallback callback;
+    };
+
+    uint32_t _chunk_duration = 0; // millisecond(0 : disabled)
+    uint32_t _video_chunk_sequence_number = 1;
+    uint32_t _audio_chunk_sequence_number = 1;
+    uint64_t _audio_chunk_end_timestamp = 0;
+
+    // _chunk_guard : _video_chunked_segment, _audio_chunked_segment(modified), _chunk_waiters
+    std::shared_ptr<DashChunkedSegment> _video_chunked_segment = nullptr;
+    std::shared_ptr<DashChunkedSegment> _audio_chunked_segment = nullptr;
+    std::vector<ChunkWaiter> _chunk_waiters;
+    std::mutex _chunk_guard;
+
+    // HLS(CMAF) playlists(std::atomic_load/atomic_store only)
+    std::atomic<bool> _hls_play_list_enabled { false };
+    std::atomic<bool> _hls_byte_range { false };
+    uint64_t _video_window_size = 0;
+    uint64_t _audio_window_size = 0;
+    std::shared_ptr<const PlayListSnapshot> _hls_master_play_list = nullptr;
+    std::shared_ptr<const PlayListSnapshot> _hls_video_play_list = nullptr;
+    std::shared_ptr<const PlayListSnapshot> _hls_audio_play_list = nullptr;
+
+    // std::atomic_load/atomic_store only
+    std::shared_ptr<const DashRepresentation> _representation = nullptr;
 };
\ No newline at end of file
@@ -13,11 +13,12 @@
 
 std::shared_ptr<DashPublisher> DashPublisher::Create(std::map<int, std::shared_ptr<HttpServer>> &http_server_manager,
                                                     const info::Application *application_info,
-                                                    std::shared_ptr<MediaRouteInterface> router)
+                                                    std::shared_ptr<MediaRouteInterface> router,
+                                                    const std::shared_ptr<SegmentStreamObserver> &vod_observer)
 {
 	auto publisher = std::make_shared<DashPublisher>(application_info, router);
 
-    publisher->Start(http_server_manager);
+    publisher->Start(http_server_manager, vod_observer);
 
 	return publisher;
 }
@@ -43,13 +44,14 @@ DashPublisher::~DashPublisher()
 // Start
 // - Publisher override
 //====================================================================================================
-bool DashPublisher::Start(std::map<int, std::shared_ptr<HttpServer>> &http_server_manager)
+bool DashPublisher::Start(std::map<int, std::shared_ptr<HttpServer>> &http_server_manager,
+                          const std::shared_ptr<SegmentStreamObserver> &vod_observer)
 {
     if(SupportedCodecCheck())
     {
         _supported_codec_check = true;
     }
-    else
+    else if(vod_observer == nullptr)
     {
         // log out put
         logtw("To output DASH, at least one of h264 or aac encoding setting information must be set.");
@@ -71,6 +73,16 @@ bool DashPublisher::Start(std::map<int, std::shared_ptr<HttpServer>> &http_serve
     // CORS/Crossdomain.xml setting
     stream_server->SetCrossDomain(publisher_info->GetCrossDomains());
 
+    // The kernel paces the responses (the segments are sent as bursts)
+    stream_server->SetMaxPacingRate(static_cast<uint64_t>(publisher_info->GetMaxPacingRate()) * 1000);
+
+    // The segments and the playlists are multiplexed over a connection (HTTPS only)
+    stream_server->SetHttp2Enabled(publisher_info->IsHttp2Enabled());
+
+    // The observers are added before the server is started (they are not locked by the worker threads)
+    if(vod_observer != nullptr)
+        stream_server->AddObserver(vod_observer);
+
     stream_server->AddObserver(SegmentStreamObserver::GetSharedPtr());
 
     // DASH Server Start
@@ -95,6 +107,20 @@ bool DashPublisher::Start(std::map<int, std::shared_ptr<HttpServer>> &http_serve
     return Publisher::Start();
 }
 
+//====================================================================================================
+// Stop
+// - Publisher override
+//====================================================================================================
+bool DashPublisher::Stop()
+{
+    if(_stream_server != nullptr)
+    {
+        _stream_server->Stop();
+    }
+
+    return Publisher::Stop();
+}
+
 //====================================================================================================
 // SupportedCodecCheck
 // - supproted codec(h264/aac) check
@@ -158,7 +184,7 @@ std::shared_ptr<Application> DashPublisher::OnCreateApplication(const info::Appl
 bool DashPublisher::OnPlayListRequest(const ov::String &app_name,
                                        const ov::String &stream_name,
                                        const ov::String &file_name,
-                                       ov::String &play_list)
+                                       std::shared_ptr<const PlayListSnapshot> &play_list)
 {
     if(!_supported_codec_check)
     {
@@ -166,6 +192,11 @@ bool DashPublisher::OnPlayListRequest(const ov::String &app_name,
         return false;
     }
 
+    if(file_name == DASH_MASTER_PLAY_LIST_FILE_NAME)
+    {
+        return GetMasterPlayList(app_name, stream_name, play_list);
+    }
+
 	auto stream = std::static_pointer_cast<DashStream>(GetStream(app_name, stream_name));
 
 	if(!stream)
@@ -190,7 +221,7 @@ bool DashPublisher::OnPlayListRequest(const ov::String &app_name,
 bool DashPublisher::OnSegmentRequest(const ov::String &app_name,
                                       const ov::String &stream_name,
                                       const ov::String &file_name,
-                                      std::shared_ptr<ov::Data> &segment_data)
+                                      std::shared_ptr<SegmentData> &segment_data)
 {
     if(!_supported_codec_check)
     {
@@ -214,3 +245,145 @@ bool DashPublisher::OnSegmentRequest(const ov::String &app_name,
 
 	return true;
 }
+
+//====================================================================================================
+// OnPlayListWaitRequest
+//  - SegmentStreamObserver Implementation
+//  - request coalescing(the playlist not ready yet)
+//  - stream not found : responded now(404)
+//====================================================================================================
+PacketyzerWaitResult DashPublisher::OnPlayListWaitRequest(const ov::String &app_name,
+                                                          const ov::String &stream_name,
+                                                          const ov::String &file_name,
+                                                          int64_t sequence_number,
+                                                          int64_t part_index,
+                                                          const PacketyzerWaitCallback &callback)
+{
+    auto stream = std::static_pointer_cast<DashStream>(GetStream(app_name, stream_name));
+
+    if(!stream)
+    {
+        return PacketyzerWaitResult::Available;
+    }
+
+    return stream->WaitPlayList(sequence_number, part_index, callback);
+}
+
+//====================================================================================================
+// OnSegmentWaitRequest
+//  - SegmentStreamObserver Implementation
+//  - request coalescing(the segment being made)
+//====================================================================================================
+PacketyzerWaitResult DashPublisher::OnSegmentWaitRequest(const ov::String &app_name,
+                                                         const ov::String &stream_name,
+                                                         const ov::String &file_name,
+                                                         const PacketyzerWaitCallback &callback)
+{
+    auto stream = std::static_pointer_cast<DashStream>(GetStream(app_name, stream_name));
+
+    if(!stream)
+    {
+        return PacketyzerWaitResult::Available;
+    }
+
+    return stream->WaitSegment(file_name, callback);
+}
+
+//====================================================================================================
+// OnChunkedSegmentRequest
+//  - SegmentStreamObserver Implementation
+//====================================================================================================
+bool DashPublisher::OnChunkedSegmentRequest(const ov::String &app_name,
+                                            const ov::String &stream_name,
+                                            const ov::String &file_name,
+                                            size_t offset,
+                                            std::vector<std::shared_ptr<const ov::Data>> &chunks,
+                                            bool &is_completed)
+{
+    if(!_supported_codec_check)
+    {
+        return false;
+    }
+
+    auto stream = std::static_pointer_cast<DashStream>(GetStream(app_name, stream_name));
+
+    if(!stream)
+    {
+        return false;
+    }
+
+    return stream->GetChunkedSegment(file_name, offset, chunks, is_completed);
+}
+
+//====================================================================================================
+// OnChunkedSegmentWaitRequest
+//  - SegmentStreamObserver Implementation
+//  - stream not found : the transfer is terminated
+//====================================================================================================
+PacketyzerWaitResult DashPublisher::OnChunkedSegmentWaitRequest(const ov::String &app_name,
+                                                                const ov::String &stream_name,
+                                                                const ov::String &file_name,
+                                                                size_t offset,
+                                                                const PacketyzerWaitCallback &callback)
+{
+    auto stream = std::static_pointer_cast<DashStream>(GetStream(app_name, stream_name));
+
+    if(!stream)
+    {
+        return PacketyzerWaitResult::Available;
+    }
+
+    return stream->WaitChunkedSegment(file_name, offset, callback);
+}
+
+//====================================================================================================
+// GetMasterPlayList
+// - a Representation per rendition(ascending bandwidth)
+// - the renditions which are not ready yet are not listed
+//====================================================================================================
+bool DashPublisher::GetMasterPlayList(const ov::String &app_name,
+                                      const ov::String &stream_name,
+                                      std::shared_ptr<const PlayListSnapshot> &play_list)
+{
+    auto application = GetApplicationByName(app_name);
+
+    if(application == nullptr)
+    {
+        logtw("Dash Cannot find application (%s/%s/%s)", app_name.CStr(), stream_name.CStr(), DASH_MASTER_PLAY_LIST_FILE_NAME);
+        return false;
+    }
+
+    std::vector<std::pair<ov::String, std::shared_ptr<const DashRepresentation>>> representations;
+    uint32_t max_age = 0;
+
+    for(const auto &item : application->GetRenditionStreams(stream_name))
+    {
+        auto representation = std::static_pointer_cast<DashStream>(item)->GetRepresentation();
+
+        if(representation == nullptr)
+            continue;
+
+        max_age = representations.empty() ? representation->play_list_max_age : std::min(max_age, representation->play_list_max_age);
+        representations.emplace_back(item->GetName(), representation);
+    }
+
+    if(representations.empty())
+    {
+        logtw("Dash Cannot find stream (%s/%s/%s)", app_name.CStr(), stream_name.CStr(), DASH_MASTER_PLAY_LIST_FILE_NAME);
+        return false;
+    }
+
+    std::stable_sort(representations.begin(), representations.end(), [](const std::pair<ov::String, std::shared_ptr<const DashRepresentation>> &left,
+                                                                         const std::pair<ov::String, std::shared_ptr<const DashRepresentation>> &right) {
+        return (left.second->media_info.video_bitrate + left.second->media_info.audio_bitrate) <
+               (right.second->media_info.video_bitrate + right.second->media_info.audio_bitrate);
+    });
+
+    std::string content = DashPacketyzer::MakeMasterPlayList(representations, application->IsKeyFrameSyncEnabled()).CStr();
+
+    play_list = Packetyzer::MakePlayListSnapshot(content.c_str(),
+                                                 ov::String::FormatString("\"m-%zx\"", std::hash<std::string>()(content)),
+                                                 max_age);
+
+    return true;
+}
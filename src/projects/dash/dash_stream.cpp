@@ -15,12 +15,24 @@
 //====================================================================================================
 std::shared_ptr<DashStream> DashStream::Create(int segment_count,
                                               int segment_duration,
+                                              uint32_t segment_tolerance,
+                                              uint32_t chunk_duration,
+                                              uint64_t segment_memory_limit,
+                                              bool thumbnail,
+                                              uint32_t thumbnail_width,
+                                              const std::shared_ptr<SegmentUploader> &uploader,
                                               const std::shared_ptr<Application> application,
                                               const StreamInfo &info,
                                               uint32_t worker_count)
 {
     auto stream = std::make_shared<DashStream>(application, info);
 
+    stream->_chunk_duration = chunk_duration;
+    stream->SetSegmentMemoryLimit(segment_memory_limit);
+    stream->SetThumbnail(thumbnail, thumbnail_width);
+    stream->SetUploader(uploader);
+    stream->SetSegmentTolerance(segment_tolerance);
+
     if (!stream->Start(segment_count, segment_duration, 0))
     {
         return nullptr;
@@ -19,6 +19,12 @@ class DashStream : public SegmentStream
 public:
     static std::shared_ptr<DashStream> Create(int segment_count,
                                                int segment_duration,
+                                               uint32_t segment_tolerance,
+                                               uint32_t chunk_duration,
+                                               uint64_t segment_memory_limit,
+                                               bool thumbnail,
+                                               uint32_t thumbnail_width,
+                                               const std::shared_ptr<SegmentUploader> &uploader,
                                                const std::shared_ptr<Application> application,
                                                const StreamInfo &info,
                                                uint32_t worker_count);
@@ -35,15 +41,25 @@ public:
     {
         auto stream_packetyzer = std::make_shared<DashStreamPacketyzer>(GetApplication()->GetName(),
                                                                         GetName(),
+                                                                        GetId(),
                                                                         segment_count,
                                                                         segment_duration,
                                                                         segment_prefix,
                                                                         stream_type,
-                                                                        media_info);
+                                                                        media_info,
+                                                                        _chunk_duration);
 
         return std::static_pointer_cast<StreamPacketyzer>(stream_packetyzer);
     }
 
-private:
+    // Representation of the master MPD(nullptr : the stream is not ready)
+    std::shared_ptr<const DashRepresentation> GetRepresentation() const
+    {
+        auto stream_packetyzer = std::static_pointer_cast<DashStreamPacketyzer>(GetStreamPacketyzer());
 
+        return (stream_packetyzer != nullptr) ? stream_packetyzer->GetRepresentation() : nullptr;
+    }
+
+private:
+    uint32_t _chunk_duration = 0; // low latency(millisecond, 0 : disabled)
 };
@@ -15,11 +15,13 @@
 //====================================================================================================
 DashStreamPacketyzer::DashStreamPacketyzer(const ov::String &app_name,
                                            const ov::String &stream_name,
+                                           uint32_t stream_id,
                                            int segment_count,
                                            int segment_duration,
                                            const ov::String &segment_prefix,
                                             PacketyzerStreamType stream_type,
-                                            PacketyzerMediaInfo media_info) :
+                                            PacketyzerMediaInfo media_info,
+                                            uint32_t chunk_duration) :
                                                 StreamPacketyzer(app_name,
                                                                 stream_name,
                                                                 segment_count,
@@ -32,13 +34,17 @@ DashStreamPacketyzer::DashStreamPacketyzer(const ov::String &app_name,
     media_info.video_timescale = PACKTYZER_DEFAULT_TIMESCALE;
     media_info.audio_timescale = media_info.audio_samplerate;
 
-    _packetyzer = std::make_shared<DashPacketyzer>(app_name,
-                                                stream_name,
-                                                stream_type,
-                                                segment_prefix,
-                                                segment_count,
-                                                segment_duration,
-                                                media_info);
+    _shared_packetyzer = CmafPacketyzerManager::GetPacketyzer(app_name,
+                                                              stream_name,
+                                                              stream_id,
+                                                              stream_type,
+                                                              segment_prefix,
+                                                              segment_count,
+                                                              segment_duration,
+                                                              media_info,
+                                                              chunk_duration);
+
+    _packetyzer = _shared_packetyzer->GetPacketyzer();
 }
 
 //====================================================================================================
@@ -46,6 +52,7 @@ DashStreamPacketyzer::DashStreamPacketyzer(const ov::String &app_name,
 //====================================================================================================
 DashStreamPacketyzer::~DashStreamPacketyzer()
 {
+    _shared_packetyzer->Release(this);
 }
 
 //====================================================================================================
@@ -53,6 +60,10 @@ DashStreamPacketyzer::~DashStreamPacketyzer()
 //====================================================================================================
 bool DashStreamPacketyzer::AppendVideoFrame(std::shared_ptr<PacketyzerFrameData> &data)
 {
+    // appended by the other user(HLS CMAF) of the shared packetyzer
+    if (!_shared_packetyzer->IsFeeder(this, data))
+        return true;
+
     return _packetyzer->AppendVideoFrame(data);
 }
 
@@ -61,6 +72,9 @@ bool DashStreamPacketyzer::AppendVideoFrame(std::shared_ptr<PacketyzerFrameData>
 //====================================================================================================
 bool DashStreamPacketyzer::AppendAudioFrame(std::shared_ptr<PacketyzerFrameData> &data)
 {
+    if (!_shared_packetyzer->IsFeeder(this, data))
+        return true;
+
     return _packetyzer->AppendAudioFrame(data);
 }
 
@@ -68,7 +82,7 @@ bool DashStreamPacketyzer::AppendAudioFrame(std::shared_ptr<PacketyzerFrameData>
 // Get PlayList
 // - MPD
 //====================================================================================================
-bool DashStreamPacketyzer::GetPlayList(ov::String &play_list)
+bool DashStreamPacketyzer::GetPlayList(std::shared_ptr<const PlayListSnapshot> &play_list)
 {
    return _packetyzer->GetPlayList(play_list);
 }
@@ -77,7 +91,47 @@ bool DashStreamPacketyzer::GetPlayList(ov::String &play_list)
 // GetSegment
 // - M4S
 //====================================================================================================
-bool DashStreamPacketyzer::GetSegment(const ov::String &segment_file_name, std::shared_ptr<ov::Data> &segment_data)
+bool DashStreamPacketyzer::GetSegment(const ov::String &segment_file_name, std::shared_ptr<SegmentData> &segment_data)
 {
       return _packetyzer->GetSegmentData(segment_file_name, segment_data);
 }
+
+//====================================================================================================
+// GetChunkedSegment
+// - M4S(chunked CMAF)
+//====================================================================================================
+bool DashStreamPacketyzer::GetChunkedSegment(const ov::String &segment_file_name,
+                                             size_t offset,
+                                             std::vector<std::shared_ptr<const ov::Data>> &chunks,
+                                             bool &is_completed)
+{
+    return std::static_pointer_cast<DashPacketyzer>(_packetyzer)->GetChunkedSegmentData(segment_file_name, offset, chunks, is_completed);
+}
+
+//====================================================================================================
+// WaitChunkedSegment
+// - M4S(chunked CMAF)
+//====================================================================================================
+PacketyzerWaitResult DashStreamPacketyzer::WaitChunkedSegment(const ov::String &segment_file_name,
+                                                              size_t offset,
+                                                              const PacketyzerWaitCallback &callback)
+{
+    return std::static_pointer_cast<DashPacketyzer>(_packetyzer)->WaitChunkedSegment(segment_file_name, offset, callback);
+}
+
+//====================================================================================================
+// GetVideoCodecString
+//====================================================================================================
+std::string DashStreamPacketyzer::GetVideoCodecString()
+{
+    return std::static_pointer_cast<DashPacketyzer>(_packetyzer)->GetVideoCodecString();
+}
+
+//====================================================================================================
+// GetRepresentation
+// - Representation of the master MPD
+//====================================================================================================
+std::shared_ptr<const DashRepresentation> DashStreamPacketyzer::GetRepresentation()
+{
+    return std::static_pointer_cast<DashPacketyzer>(_packetyzer)->GetRepresentation();
+}
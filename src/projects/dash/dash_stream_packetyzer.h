@@ -11,6 +11,7 @@
 
 #include "../segment_stream/stream_packetyzer.h"
 #include "dash_packetyzer.h"
+#include "cmaf_packetyzer_manager.h"
 
 //====================================================================================================
 // DashStreamPacketyzer
@@ -20,11 +21,13 @@ class DashStreamPacketyzer : public StreamPacketyzer
 public:
     DashStreamPacketyzer(const ov::String &app_name,
                          const ov::String &stream_name,
+                         uint32_t stream_id,
                          int segment_count,
                         int segment_duration,
                         const  ov::String &segment_prefix,
                         PacketyzerStreamType stream_type,
-                        PacketyzerMediaInfo media_info);
+                        PacketyzerMediaInfo media_info,
+                        uint32_t chunk_duration = 0);
 
     virtual ~DashStreamPacketyzer();
 
@@ -33,10 +36,20 @@ public :
     // Implement StreamPacketyzer Interface
     bool AppendVideoFrame(std::shared_ptr<PacketyzerFrameData> &data) override;
     bool AppendAudioFrame(std::shared_ptr<PacketyzerFrameData> &data) override;
-    bool GetPlayList(ov::String &play_list) override;
-    bool GetSegment(const ov::String &file_name, std::shared_ptr<ov::Data> &data) override;
+    bool GetPlayList(std::shared_ptr<const PlayListSnapshot> &play_list) override;
+    bool GetSegment(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data) override;
+    bool GetChunkedSegment(const ov::String &file_name,
+                           size_t offset,
+                           std::vector<std::shared_ptr<const ov::Data>> &chunks,
+                           bool &is_completed) override;
+    PacketyzerWaitResult WaitChunkedSegment(const ov::String &file_name, size_t offset, const PacketyzerWaitCallback &callback) override;
+    std::string GetVideoCodecString() override;
+
+    // nullptr : the stream is not ready
+    std::shared_ptr<const DashRepresentation> GetRepresentation();
 
 private :
-    //std::shared_ptr<DashPacketyzer> _packetyzer = nullptr;
+    // shared with HLS(CMAF) of the same stream
+    std::shared_ptr<SharedCmafPacketyzer> _shared_packetyzer = nullptr;
 };
 
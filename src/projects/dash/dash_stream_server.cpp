@@ -9,10 +9,46 @@
 
 #include "dash_stream_server.h"
 #include "dash_private.h"
+#include "segment_stream/segment_thumbnailer.h"
+#include "dash_packetyzer.h"
 
 #define SEGMENT_EXT "m4s"
 #define PLAYLIST_EXT "mpd"
 #define PLAYLIST_FILE_NAME "manifest.mpd"
+#define THUMBNAIL_EXT "jpg"
+
+//====================================================================================================
+// WaitRequest
+// - request coalescing : the requests of the segment being made(or the manifest not ready yet) are held
+//   and released together when it is stored
+//====================================================================================================
+PacketyzerWaitResult DashStreamServer::WaitRequest(const std::shared_ptr<HttpRequest> &request,
+                                                   const std::shared_ptr<HttpResponse> &response,
+                                                   const ov::String &app_name,
+                                                   const ov::String &stream_name,
+                                                   const ov::String &file_name,
+                                                   const ov::String &file_ext)
+{
+    auto callback = [this, request, response]()
+    {
+        ResumeRequest(request, response);
+    };
+
+    for (const auto &observer : _observers)
+    {
+        PacketyzerWaitResult result = PacketyzerWaitResult::Available;
+
+        if (file_name == PLAYLIST_FILE_NAME)
+            result = observer->OnPlayListWaitRequest(app_name, stream_name, file_name, -1, -1, callback);
+        else if (file_ext == SEGMENT_EXT)
+            result = observer->OnSegmentWaitRequest(app_name, stream_name, file_name, callback);
+
+        if (result != PacketyzerWaitResult::Available)
+            return result;
+    }
+
+    return PacketyzerWaitResult::Available;
+}
 
 //====================================================================================================
 // ProcessRequest URL
@@ -25,7 +61,7 @@ void DashStreamServer::ProcessRequestStream(const std::shared_ptr<HttpRequest> &
                                             const ov::String &file_ext)
 {
     // file extension check
-    if(file_ext != SEGMENT_EXT && file_ext != PLAYLIST_EXT)
+    if(file_ext != SEGMENT_EXT && file_ext != PLAYLIST_EXT && file_ext != THUMBNAIL_EXT)
     {
         logtd("Request file extension fail - %s", file_ext.CStr());
         response->SetStatusCode(HttpStatusCode::NotFound);
@@ -33,10 +69,12 @@ void DashStreamServer::ProcessRequestStream(const std::shared_ptr<HttpRequest> &
     }
 
     // request dispatch
-   if (file_name == PLAYLIST_FILE_NAME)
-        PlayListRequest(app_name, stream_name, file_name, PlayListType::Mpd, response);
+   if (file_name == PLAYLIST_FILE_NAME || file_name == DASH_MASTER_PLAY_LIST_FILE_NAME)
+        PlayListRequest(app_name, stream_name, file_name, PlayListType::Mpd, request, response);
     else if (file_ext == SEGMENT_EXT)
-        SegmentRequest(app_name, stream_name, file_name, SegmentType::M4S, response);
+        SegmentRequest(app_name, stream_name, file_name, SegmentType::M4S, request, response);
+    else if (file_name == THUMBNAIL_FILE_NAME)
+        SegmentRequest(app_name, stream_name, file_name, SegmentType::Thumbnail, request, response);
     else
         response->SetStatusCode(HttpStatusCode::NotFound);// Error Response
 }
\ No newline at end of file
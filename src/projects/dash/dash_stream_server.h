@@ -35,6 +35,13 @@ public :
     }
 
 protected:
+    PacketyzerWaitResult WaitRequest(const std::shared_ptr<HttpRequest> &request,
+                                     const std::shared_ptr<HttpResponse> &response,
+                                     const ov::String &app_name,
+                                     const ov::String &stream_name,
+                                     const ov::String &file_name,
+                                     const ov::String &file_ext) override;
+
     void ProcessRequestStream(const std::shared_ptr<HttpRequest> &request,
                            const std::shared_ptr<HttpResponse> &response,
                            const ov::String &app_name,
@@ -39,6 +39,19 @@ bool DtlsIceTransport::SendData(SessionNodeType from_node, const std::shared_ptr
 	return true;
 }
 
+bool DtlsIceTransport::SendDataBatch(SessionNodeType from_node, const std::vector<std::shared_ptr<ov::Data>> &data_list)
+{
+	// Node 시작 전에는 아무것도 하지 않는다.
+	if(GetState() != SessionNode::NodeState::Started)
+	{
+		logtd("SessionNode has not started, so the received data has been canceled.");
+		return false;
+	}
+
+	// ICE_PORT로 한번에 전송한다. (sendmmsg)
+	return _ice_port->Send(GetSession(), data_list);
+}
+
 // 데이터를 lower에서 받는다. upper node로 보낸다.
 bool DtlsIceTransport::OnDataReceived(SessionNodeType from_node, const std::shared_ptr<const ov::Data> &data)
 {
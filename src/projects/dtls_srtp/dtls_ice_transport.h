@@ -23,6 +23,7 @@ public:
 	// Implement SessionNode Interface
 	// 데이터를 upper에서 받는다. lower node로 보낸다.
 	bool SendData(SessionNodeType from_node, const std::shared_ptr<ov::Data> &data) override;
+	bool SendDataBatch(SessionNodeType from_node, const std::vector<std::shared_ptr<ov::Data>> &data_list) override;
 	// 데이터를 lower에서 받는다. upper node로 보낸다.
 	bool OnDataReceived(SessionNodeType from_node, const std::shared_ptr<const ov::Data> &data) override;
 
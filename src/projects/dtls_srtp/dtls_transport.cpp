@@ -1,4 +1,5 @@
 #include "dtls_transport.h"
+#include "dtls_worker_pool.h"
 
 #include <utility>
 #include <algorithm>
@@ -45,7 +46,7 @@ bool DtlsTransport::StartDTLS()
 				tls->SetVerify(SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT);
 
 				// SSL_CTX_set_tlsext_use_srtp() returns 1 on error, 0 on success
-				if(SSL_CTX_set_tlsext_use_srtp(context, "SRTP_AES128_CM_SHA1_80:SRTP_AES128_CM_SHA1_32"))
+				if(SSL_CTX_set_tlsext_use_srtp(context, SrtpAdapter::GetSrtpProfiles()))
 				{
 					logte("SSL_CTX_set_tlsext_use_srtp failed");
 					return false;
@@ -89,9 +90,7 @@ bool DtlsTransport::StartDTLS()
 	_state = SSL_CONNECTING;
 
 	// 한번 accept를 시도해본다.
-	ContinueSSL();
-
-	return true;
+	return ScheduleDtlsPacket(nullptr);
 }
 
 bool DtlsTransport::ContinueSSL()
@@ -102,12 +101,11 @@ bool DtlsTransport::ContinueSSL()
 
 	if(error == SSL_ERROR_NONE)
 	{
-		_state = SSL_CONNECTED;
-
 		_peer_certificate = _tls.GetPeerCertificate();
 
 		if(_peer_certificate == nullptr)
 		{
+			_state = SSL_CONNECTED;
 			return false;
 		}
 
@@ -118,7 +116,12 @@ bool DtlsTransport::ContinueSSL()
 
 		_peer_certificate->Print();
 
-		return MakeSrtpKey();
+		// The keys are handed to SRTP before the state is changed, so the packets of the session are protected as soon as it is connected
+		bool result = MakeSrtpKey();
+
+		_state = SSL_CONNECTED;
+
+		return result;
 	}
 
 	return false;
@@ -220,6 +223,24 @@ bool DtlsTransport::SendData(SessionNodeType from_node, const std::shared_ptr<ov
 	return false;
 }
 
+bool DtlsTransport::SendDataBatch(SessionNodeType from_node, const std::vector<std::shared_ptr<ov::Data>> &data_list)
+{
+	if((GetState() == SessionNode::NodeState::Started) && (_state == SSL_CONNECTED) && (from_node == SessionNodeType::Srtp))
+	{
+		// SRTP는 이미 암호화가 되었으므로 ICE로 바로 전송한다.
+		auto node = GetLowerNode(SessionNodeType::Ice);
+		if(node == nullptr)
+		{
+			return false;
+		}
+
+		return node->SendDataBatch(GetNodeType(), data_list);
+	}
+
+	// The other cases are handled by SendData() one by one
+	return SessionNode::SendDataBatch(from_node, data_list);
+}
+
 // 데이터를 lower에서 받는다. upper node로 보낸다.
 // IcePort -> Publisher ->[queue] Application {thread}-> Session -> DtlsTransport -> SRTP || SCTP
 bool DtlsTransport::OnDataReceived(SessionNodeType from_node, const std::shared_ptr<const ov::Data> &data)
@@ -245,39 +266,9 @@ bool DtlsTransport::OnDataReceived(SessionNodeType from_node, const std::shared_
 			if(IsDtlsPacket(data))
 			{
 				logtd("Receive DTLS packet");
-				// Packet을 Queue에 쌓는다.
-				SaveDtlsPacket(data);
 
-				// SSL에 읽어가라고 명령을 내린다.
-				if(_state == SSL_CONNECTING)
-				{
-					// 연결중이면 SSL_accept를 해야 한다.
-					ContinueSSL();
-				}
-				else
-				{
-					// 연결이 완료된 상태면 암호화를 위해 읽어가야 한다.
-					char buffer[MAX_DTLS_PACKET_LEN];
-
-					// SSL_read는 다음과 같이 동작한다.
-					// SSL -> Read() -> TakeDtlsPacket() -> Decrypt -> buffer
-					int ssl_error = _tls.Read(buffer, sizeof(buffer), nullptr);
-
-					// 말이 안되는데 여기 들어오는지 보자.
-					int pending = _tls.Pending();
-
-					if(pending >= 0)
-					{
-						logtd("Short DTLS read. Flushing %d bytes", pending);
-						_tls.FlushInput();
-					}
-
-					// 읽은 패킷을 누군가에게 줘야 하는데... 줄 놈이 없다.
-					// TODO: 향후 SCTP 등을 연결하면 준다. 지금은 DTLS로 암호화 된 패킷을 받을 객체가 없다.
-					logtd("Unknown dtls packet received (%d)", ssl_error);
-				}
-
-				return true;
+				// The handshake is processed by the DTLS worker
+				return ScheduleDtlsPacket(data);
 			}
 				// SRTP, SRTCP,
 			else
@@ -312,6 +303,104 @@ bool DtlsTransport::OnDataReceived(SessionNodeType from_node, const std::shared_
 	return false;
 }
 
+bool DtlsTransport::ScheduleDtlsPacket(const std::shared_ptr<const ov::Data> &data)
+{
+	std::lock_guard<std::mutex> lock_guard(_pending_packet_mutex);
+
+	if(_pending_packets.size() >= MAX_PENDING_DTLS_PACKETS)
+	{
+		// The client retransmits the flight
+		logtw("Too many pending DTLS packets (%zu), the packet is dropped", _pending_packets.size());
+		return false;
+	}
+
+	_pending_packets.push_back(data);
+
+	if(_processing_scheduled)
+	{
+		// The worker processes it after the previous packets
+		return true;
+	}
+
+	auto transport = GetSharedPtrAs<DtlsTransport>();
+
+	if(DtlsWorkerPool::Instance()->Post([transport]() {
+		transport->ProcessDtlsPackets();
+	}) == false)
+	{
+		_pending_packets.clear();
+		return false;
+	}
+
+	_processing_scheduled = true;
+
+	return true;
+}
+
+void DtlsTransport::ProcessDtlsPackets()
+{
+	while(true)
+	{
+		std::shared_ptr<const ov::Data> data;
+
+		{
+			std::lock_guard<std::mutex> lock_guard(_pending_packet_mutex);
+
+			if(_pending_packets.empty())
+			{
+				_processing_scheduled = false;
+				return;
+			}
+
+			data = std::move(_pending_packets.front());
+			_pending_packets.pop_front();
+		}
+
+		if(GetState() == SessionNode::NodeState::Started)
+		{
+			ProcessDtlsPacket(data);
+		}
+	}
+}
+
+void DtlsTransport::ProcessDtlsPacket(const std::shared_ptr<const ov::Data> &data)
+{
+	// Packet을 Queue에 쌓는다.
+	if(data != nullptr)
+	{
+		SaveDtlsPacket(data);
+	}
+
+	// SSL에 읽어가라고 명령을 내린다.
+	if(_state == SSL_CONNECTING)
+	{
+		// 연결중이면 SSL_accept를 해야 한다.
+		ContinueSSL();
+	}
+	else if((_state == SSL_CONNECTED) && (data != nullptr))
+	{
+		// 연결이 완료된 상태면 암호화를 위해 읽어가야 한다.
+		char buffer[MAX_DTLS_PACKET_LEN];
+
+		// SSL_read는 다음과 같이 동작한다.
+		// SSL -> Read() -> TakeDtlsPacket() -> Decrypt -> buffer
+		int ssl_error = _tls.Read(buffer, sizeof(buffer), nullptr);
+
+		// 말이 안되는데 여기 들어오는지 보자.
+		int pending = _tls.Pending();
+
+		if(pending >= 0)
+		{
+			logtd("Short DTLS read. Flushing %d bytes", pending);
+			_tls.FlushInput();
+		}
+
+		// 읽은 패킷을 누군가에게 줘야 하는데... 줄 놈이 없다.
+		// TODO: 향후 SCTP 등을 연결하면 준다. 지금은 DTLS로 암호화 된 패킷을 받을 객체가 없다.
+		logtd("Unknown dtls packet received (%d)", ssl_error);
+	}
+}
+
 ssize_t DtlsTransport::Read(ov::Tls *tls, void *buffer, size_t length)
 {
 	std::shared_ptr<const ov::Data> data = TakeDtlsPacket();
@@ -7,9 +7,14 @@
 #include "ice/ice_port.h"
 #include "srtp_transport.h"
 
+#include <atomic>
+#include <mutex>
+
 #define DTLS_RECORD_HEADER_LEN                  13
 #define MAX_DTLS_PACKET_LEN                     2048
 #define MIN_RTP_PACKET_LEN                      12
+// Records of a transport waiting for the DTLS worker (a flight has a few records)
+#define MAX_PENDING_DTLS_PACKETS				32
 
 class DtlsTransport : public SessionNode
 {
@@ -33,6 +38,8 @@ public:
 	//--------------------------------------------------------------------
 	// Receive data from upper node, and send data to lower node.
 	bool SendData(SessionNodeType from_node, const std::shared_ptr<ov::Data> &data);
+	// SRTP packets are passed to ICE at once
+	bool SendDataBatch(SessionNodeType from_node, const std::vector<std::shared_ptr<ov::Data>> &data_list) override;
 	// Receive data from lower node, and send data to upper node.
 	bool OnDataReceived(SessionNodeType from_node, const std::shared_ptr<const ov::Data> &data);
 
@@ -42,6 +49,7 @@ public:
 	// 복호화를 한 후 다음 Layer로 전송한다.
 	// DTLS가 아니고 RTP/RTCP인 경우는 SRTP로 보낸다.
 	// 그 외에는 모르는 패킷이므로 처리하지 않는다.
+	// DTLS 패킷은 DtlsWorkerPool에서 처리하므로(핸드셰이크가 미디어 전송 thread를 막지 않도록), SSL은 worker에서만 사용한다.
 	bool RecvPacket(const std::shared_ptr<ov::Data> &data);
 
 protected:
@@ -55,6 +63,11 @@ protected:
 
 private:
 	bool ContinueSSL();
+	// Queues the DTLS packet (nullptr: only continue the handshake), and runs the queue on the DTLS worker
+	bool ScheduleDtlsPacket(const std::shared_ptr<const ov::Data> &data);
+	// Called by the DTLS worker, the packets of a transport are processed by one worker at a time
+	void ProcessDtlsPackets();
+	void ProcessDtlsPacket(const std::shared_ptr<const ov::Data> &data);
 	bool IsDtlsPacket(const std::shared_ptr<const ov::Data> data);
 	bool IsRtpPacket(const std::shared_ptr<const ov::Data> data);
 	bool SaveDtlsPacket(const std::shared_ptr<const ov::Data> data);
@@ -72,7 +85,8 @@ private:
 		SSL_CLOSED
 	};
 
-	SSLState _state;
+	// It is changed by the DTLS worker
+	std::atomic<SSLState> _state;
 	bool _peer_cerificate_verified;
 	std::shared_ptr<SessionInfo> _session_info;
 	std::shared_ptr<IcePort> _ice_port;
@@ -85,6 +99,12 @@ private:
 	// SSL이 가져갈 패킷을 임시로 보관하는 버퍼, 동시에 1개만 저장한다.
 	std::deque<std::shared_ptr<const ov::Data>> _packet_buffer;
 
+	// The packets waiting for the DTLS worker
+	std::mutex _pending_packet_mutex;
+	std::deque<std::shared_ptr<const ov::Data>> _pending_packets;
+	// true while ProcessDtlsPackets() is posted or running
+	bool _processing_scheduled = false;
+
 	// SSL *_ssl;
 	// SSL_CTX *_ssl_ctx;
 
@@ -0,0 +1,57 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Maximum number of the queued tasks, the records over it are dropped (the client retransmits the flight)
+#define DTLS_WORKER_MAX_PENDING_TASKS		4096
+
+// Thread pool which runs the DTLS handshakes (ECDHE, signing) out of the threads delivering the media
+//
+// - The workers are started by the first Post() (half of the cores)
+// - The queue is bounded, so a join burst is absorbed by the retransmission of DTLS instead of the memory
+// - The tasks are run in any order, the caller serializes the tasks of a transport (see DtlsTransport::ScheduleHandshake())
+class DtlsWorkerPool : public ov::Singleton<DtlsWorkerPool>
+{
+public:
+	friend class ov::Singleton<DtlsWorkerPool>;
+
+	typedef std::function<void()> Task;
+
+	~DtlsWorkerPool() override;
+
+	// Returns false if the queue is full (the task is not run)
+	bool Post(Task task);
+
+	size_t GetPendingCount() const;
+
+protected:
+	DtlsWorkerPool() = default;
+
+	bool Start();
+	void Stop();
+	void WorkerThread();
+
+	std::mutex _start_mutex;
+	bool _started = false;
+	std::vector<std::thread> _workers;
+
+	mutable std::mutex _task_mutex;
+	std::condition_variable _task_condition;
+	std::deque<Task> _tasks;
+	bool _running = false;
+};
@@ -24,7 +24,48 @@ SrtpAdapter::~SrtpAdapter()
 {
 }
 
-bool SrtpAdapter::SetKey(srtp_ssrc_type_t type, uint64_t crypto_suite, std::shared_ptr<ov::Data> key)
+bool SrtpAdapter::IsAeadSupported()
+{
+	static std::once_flag once;
+	static bool supported = false;
+
+	std::call_once(once, []() {
+		// Try to create a session that uses AES-GCM
+		srtp_policy_t policy;
+		uint8_t key[SRTP_AES_GCM_256_KEY_LEN_WSALT] = { 0 };
+
+		memset(&policy, 0, sizeof(policy));
+
+		srtp_crypto_policy_set_aes_gcm_128_16_auth(&policy.rtp);
+		srtp_crypto_policy_set_aes_gcm_128_16_auth(&policy.rtcp);
+
+		policy.ssrc.type = ssrc_any_outbound;
+		policy.key = key;
+		policy.window_size = 1024;
+
+		srtp_t session = nullptr;
+
+		if(srtp_create(&session, &policy) == srtp_err_status_ok)
+		{
+			srtp_dealloc(session);
+			supported = true;
+		}
+		else
+		{
+			logtw("AES-GCM SRTP profiles are disabled: libsrtp is not built with OpenSSL");
+		}
+	});
+
+	return supported;
+}
+
+const char *SrtpAdapter::GetSrtpProfiles()
+{
+	// The server selects the first profile of this list that is offered by the client
+	return IsAeadSupported() ? (SRTP_AEAD_PROFILES ":" SRTP_AES_CM_PROFILES) : SRTP_AES_CM_PROFILES;
+}
+
+bool SrtpAdapter::SetKey(srtp_ssrc_type_t type, uint64_t crypto_suite, std::shared_ptr<ov::Data> key, bool rtp_authentication_only)
 {
 	srtp_policy_t policy;
 	memset(&policy, 0, sizeof(policy));
@@ -39,11 +80,33 @@ bool SrtpAdapter::SetKey(srtp_ssrc_type_t type, uint64_t crypto_suite, std::shar
 			srtp_crypto_policy_set_aes_cm_128_hmac_sha1_32(&policy.rtp);
 			srtp_crypto_policy_set_aes_cm_128_hmac_sha1_32(&policy.rtcp);
 			break;
+		case SRTP_AEAD_AES_128_GCM:
+			// AES-NI/PCLMULQDQ are used by the OpenSSL backend of libsrtp
+			srtp_crypto_policy_set_aes_gcm_128_16_auth(&policy.rtp);
+			srtp_crypto_policy_set_aes_gcm_128_16_auth(&policy.rtcp);
+			break;
+		case SRTP_AEAD_AES_256_GCM:
+			srtp_crypto_policy_set_aes_gcm_256_16_auth(&policy.rtp);
+			srtp_crypto_policy_set_aes_gcm_256_16_auth(&policy.rtcp);
+			break;
 		default:
 			logte("Failed to create srtp adapter. Unsupported crypto suite %d", crypto_suite);
 			return false;
 	}
 
+	if(rtp_authentication_only)
+	{
+		if(crypto_suite == SRTP_AES128_CM_SHA1_80)
+		{
+			// RTCP (which has the media key) is encrypted as usual
+			srtp_crypto_policy_set_null_cipher_hmac_sha1_80(&policy.rtp);
+		}
+		else
+		{
+			logtw("RTP is encrypted: the authentication only is not available for crypto suite %d", crypto_suite);
+		}
+	}
+
 	policy.ssrc.type = type;
 	policy.ssrc.value = 0;
 	policy.key = key->GetWritableDataAs<uint8_t>();
@@ -69,7 +132,7 @@ bool SrtpAdapter::SetKey(srtp_ssrc_type_t type, uint64_t crypto_suite, std::shar
 	return true;
 }
 
-bool SrtpAdapter::ProtectRtp(std::shared_ptr<ov::Data> data)
+bool SrtpAdapter::ProtectRtp(const std::shared_ptr<ov::Data> &data)
 {
 	if(!_session)
 	{
@@ -105,7 +168,30 @@ bool SrtpAdapter::ProtectRtp(std::shared_ptr<ov::Data> data)
 	return true;
 }
 
-bool SrtpAdapter::ProtectRtcp(std::shared_ptr<ov::Data> data)
+bool SrtpAdapter::UnprotectRtp(const std::shared_ptr<ov::Data> &data)
+{
+	if(!_session)
+	{
+		return false;
+	}
+
+	auto buffer = data->GetWritableData();
+	int out_len = static_cast<int>(data->GetLength());
+
+	int err = srtp_unprotect(_session, buffer, &out_len);
+
+	if(err != srtp_err_status_ok)
+	{
+		logtd("Failed to unprotect SRTP packet, err=%d", err);
+		return false;
+	}
+
+	data->SetLength(out_len);
+
+	return true;
+}
+
+bool SrtpAdapter::ProtectRtcp(const std::shared_ptr<ov::Data> &data)
 {
     if(!_session)
     {
@@ -13,17 +13,29 @@
 
 #include <srtp2/srtp.h>
 
+// SRTP protection profiles (RFC 7714, RFC 5764)
+#define SRTP_AEAD_PROFILES			"SRTP_AEAD_AES_128_GCM:SRTP_AEAD_AES_256_GCM"
+#define SRTP_AES_CM_PROFILES		"SRTP_AES128_CM_SHA1_80:SRTP_AES128_CM_SHA1_32"
+
 class SrtpAdapter
 {
 public:
 	SrtpAdapter();
 	virtual ~SrtpAdapter();
 
-	bool	SetKey(srtp_ssrc_type_t type, uint64_t crypto_suite, std::shared_ptr<ov::Data> key);
+	// AES-GCM is available only when libsrtp is built with OpenSSL (srtp_init() must be called first)
+	static bool IsAeadSupported();
+	// The profiles for SSL_CTX_set_tlsext_use_srtp() in order of preference (AES-GCM first if supported)
+	static const char *GetSrtpProfiles();
+
+	// rtp_authentication_only: RTP is not encrypted (the payloads are encrypted in advance, see RtpPayloadEncryptor)
+	// - only for SRTP_AES128_CM_SHA1_80 which has the same key and tag with NULL cipher (the others are encrypted as usual)
+	bool	SetKey(srtp_ssrc_type_t type, uint64_t crypto_suite, std::shared_ptr<ov::Data> key, bool rtp_authentication_only = false);
 
-	bool	ProtectRtp(std::shared_ptr<ov::Data> data);
+	bool	ProtectRtp(const std::shared_ptr<ov::Data> &data);
+	bool	UnprotectRtp(const std::shared_ptr<ov::Data> &data);
 
-    bool	ProtectRtcp(std::shared_ptr<ov::Data> data);
+    bool	ProtectRtcp(const std::shared_ptr<ov::Data> &data);
     bool	UnprotectRtcp(const std::shared_ptr<ov::Data> &data);
 
 private:
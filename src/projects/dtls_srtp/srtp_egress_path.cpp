@@ -0,0 +1,48 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "srtp_egress_path.h"
+
+#define OV_LOG_TAG "SRTP"
+
+SrtpEgressPath::SrtpEgressPath(const std::shared_ptr<SrtpAdapter> &send_session, const std::shared_ptr<IcePort> &ice_port, const IcePort::Connection &connection)
+	: _send_session(send_session),
+	  _ice_port(ice_port),
+	  _connection(connection)
+{
+}
+
+bool SrtpEgressPath::SendRtp(const std::shared_ptr<ov::Data> &packet)
+{
+	if(_send_session->ProtectRtp(packet) == false)
+	{
+		return false;
+	}
+
+	return _ice_port->SendDirect(_connection, packet);
+}
+
+bool SrtpEgressPath::SendRtp(const std::vector<std::shared_ptr<ov::Data>> &packets)
+{
+	for(auto &packet : packets)
+	{
+		_send_session->ProtectRtp(packet);
+	}
+
+	// sendmmsg (or one writev of ICE-TCP)
+	return _ice_port->SendDirect(_connection, packets);
+}
+
+bool SrtpEgressPath::SendRtcp(const std::shared_ptr<ov::Data> &packet)
+{
+	if(_send_session->ProtectRtcp(packet) == false)
+	{
+		return false;
+	}
+
+	return _ice_port->SendDirect(_connection, packet);
+}
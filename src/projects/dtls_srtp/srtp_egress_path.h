@@ -0,0 +1,33 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+#include "ice/ice_port.h"
+#include "srtp_adapter.h"
+
+// Egress path of an established session (compiled after DTLS negotiated the SRTP keys)
+// - RTP/RTCP packets are protected by the SRTP context and sent to the connection of the peer
+//   by one call, instead of passing through SrtpTransport -> DtlsTransport -> DtlsIceTransport -> IcePort
+// - The node chain is still used for the handshake, and until the path is compiled
+// - Not thread-safe (RtpRtcp uses it with its send mutex locked)
+class SrtpEgressPath
+{
+public:
+	SrtpEgressPath(const std::shared_ptr<SrtpAdapter> &send_session, const std::shared_ptr<IcePort> &ice_port, const IcePort::Connection &connection);
+
+	// The packets are protected in place (the buffers must have the room for the auth tag)
+	bool SendRtp(const std::shared_ptr<ov::Data> &packet);
+	bool SendRtp(const std::vector<std::shared_ptr<ov::Data>> &packets);
+	bool SendRtcp(const std::shared_ptr<ov::Data> &packet);
+
+private:
+	std::shared_ptr<SrtpAdapter> _send_session;
+	std::shared_ptr<IcePort> _ice_port;
+	IcePort::Connection _connection;
+};
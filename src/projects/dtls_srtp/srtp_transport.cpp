@@ -31,12 +31,15 @@ bool SrtpTransport::SendData(SessionNodeType from_node, const std::shared_ptr<ov
 		return false;
 	}
 
-	if(!_send_session)
+	// The session is set by the DTLS worker
+	auto send_session = std::atomic_load(&_send_session);
+
+	if(!send_session)
 	{
 		return false;
 	}
 
-	_send_session->ProtectRtp(data);
+	send_session->ProtectRtp(data);
 
 	// DTLS로 보낸다.
 	auto node = GetLowerNode();
@@ -48,6 +51,37 @@ bool SrtpTransport::SendData(SessionNodeType from_node, const std::shared_ptr<ov
 	return node->SendData(GetNodeType(), data);
 }
 
+bool SrtpTransport::SendDataBatch(SessionNodeType from_node, const std::vector<std::shared_ptr<ov::Data>> &data_list)
+{
+	// Node 시작 전에는 아무것도 하지 않는다.
+	if(GetState() != SessionNode::NodeState::Started)
+	{
+		logtd("SessionNode has not started, so the received data has been canceled.");
+		return false;
+	}
+
+	auto send_session = std::atomic_load(&_send_session);
+
+	if(!send_session)
+	{
+		return false;
+	}
+
+	for(auto &data : data_list)
+	{
+		send_session->ProtectRtp(data);
+	}
+
+	// DTLS로 보낸다.
+	auto node = GetLowerNode();
+	if(!node)
+	{
+		return false;
+	}
+
+	return node->SendDataBatch(GetNodeType(), data_list);
+}
+
 // srtcp transfer
 bool SrtpTransport::SendRtcpData(SessionNodeType from_node, const std::shared_ptr<ov::Data> &data)
 {
@@ -57,12 +91,14 @@ bool SrtpTransport::SendRtcpData(SessionNodeType from_node, const std::shared_pt
         return false;
     }
 
-    if(!_send_session)
+    auto send_session = std::atomic_load(&_send_session);
+
+    if(!send_session)
     {
         return false;
     }
 
-    _send_session->ProtectRtcp(data);
+    send_session->ProtectRtcp(data);
 
     // DTLS transfer
     auto node = GetLowerNode();
@@ -85,15 +121,34 @@ bool SrtpTransport::OnDataReceived(SessionNodeType from_node, const std::shared_
 		return false;
 	}
 
+	auto recv_session = std::atomic_load(&_recv_session);
+
+	if(recv_session == nullptr)
+	{
+		// DTLS is not connected yet
+		return false;
+	}
+
 	auto decode_data = data->Clone();
 
-    if(!_recv_session->UnprotectRtcp(decode_data))
-    {
-        logtd("stcp unprotected fail");
-        return false;
-    }
+	// RFC 5761 4: the payload type of RTCP is 192~223, RTP is received only by the ingest sessions
+	uint8_t packet_type = (decode_data->GetLength() >= 2) ? decode_data->GetDataAs<uint8_t>()[1] : 0;
+
+	if((packet_type >= 192) && (packet_type <= 223))
+	{
+		if(!recv_session->UnprotectRtcp(decode_data))
+		{
+			logtd("stcp unprotected fail");
+			return false;
+		}
+	}
+	else if(!recv_session->UnprotectRtp(decode_data))
+	{
+		logtd("srtp unprotected fail");
+		return false;
+	}
 
-	// pass to rtcp
+	// pass to rtp/rtcp
     auto node = GetUpperNode();
 
     if(node == nullptr)
@@ -110,37 +165,54 @@ bool SrtpTransport::SetKeyMeterial(uint64_t crypto_suite, std::shared_ptr<ov::Da
 {
 	// 이미 Session을 만들었다면 다시 하지 않는다.
 	// TODO: 향후 재협상을 개발해야 한다.
-	if(_send_session || _recv_session)
+	if(std::atomic_load(&_send_session) || std::atomic_load(&_recv_session))
 	{
 		return false;
 	}
 
 	logtd("Try to set key meterial");
 
-	_send_session = std::make_shared<SrtpAdapter>();
-	if(_send_session == nullptr)
+	// It is called by the DTLS worker, so the sessions are made completely before they are published to the session thread
+	auto send_session = std::make_shared<SrtpAdapter>();
+	if(send_session == nullptr)
 	{
 		logte("Create srtp adapter failed");
 		return false;
 	}
 
-	if(!_send_session->SetKey(ssrc_any_outbound, crypto_suite, server_key))
+	if(!send_session->SetKey(ssrc_any_outbound, crypto_suite, server_key, _rtp_authentication_only))
 	{
 		return false;
 	}
 
-	_recv_session = std::make_shared<SrtpAdapter>();
-	if(_recv_session == nullptr)
+	auto recv_session = std::make_shared<SrtpAdapter>();
+	if(recv_session == nullptr)
 	{
-		_send_session.reset();
-		_send_session = nullptr;
 		return false;
 	}
 
-	if(!_recv_session->SetKey(ssrc_any_inbound, crypto_suite, client_key))
+	if(!recv_session->SetKey(ssrc_any_inbound, crypto_suite, client_key))
 	{
 		return false;
 	}
 
+	std::atomic_store(&_recv_session, recv_session);
+	std::atomic_store(&_send_session, send_session);
+
 	return true;
-}
\ No newline at end of file
+}
+
+void SrtpTransport::SetRtpAuthenticationOnly(bool authentication_only)
+{
+	_rtp_authentication_only = authentication_only;
+}
+
+bool SrtpTransport::IsSendReady()
+{
+	return (GetState() == SessionNode::NodeState::Started) && (std::atomic_load(&_send_session) != nullptr);
+}
+
+std::shared_ptr<SrtpAdapter> SrtpTransport::GetSendSession()
+{
+	return std::atomic_load(&_send_session);
+}
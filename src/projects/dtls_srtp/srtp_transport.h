@@ -21,6 +21,8 @@ public:
 
 	// 데이터를 upper에서 받는다. lower node로 보낸다.
 	bool SendData(SessionNodeType from_node, const std::shared_ptr<ov::Data> &data) override;
+	// Protects all packets in one pass, and sends them to lower node at once
+	bool SendDataBatch(SessionNodeType from_node, const std::vector<std::shared_ptr<ov::Data>> &data_list) override;
 
     // srtcp transfer
     bool SendRtcpData(SessionNodeType from_node, const std::shared_ptr<ov::Data> &data);
@@ -32,7 +34,18 @@ public:
 	bool SetKeyMeterial(uint64_t crypto_suite,
 						std::shared_ptr<ov::Data> server_key, std::shared_ptr<ov::Data> client_key);
 
+	// true if the packets can be protected (the keys are set)
+	bool IsSendReady();
+	// SRTP context of the outgoing packets (nullptr until the keys are set)
+	std::shared_ptr<SrtpAdapter> GetSendSession();
+
+	// The payloads are encrypted by the stream, so the outgoing RTP is only authenticated (must be set before DTLS)
+	void SetRtpAuthenticationOnly(bool authentication_only);
+
 private:
+	std::atomic<bool>					_rtp_authentication_only { false };
+
+	// Set by the DTLS worker, so they are accessed with std::atomic_load()/std::atomic_store()
 	std::shared_ptr<SrtpAdapter>		_send_session;
 	std::shared_ptr<SrtpAdapter>		_recv_session;
 };
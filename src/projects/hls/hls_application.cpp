@@ -10,6 +10,7 @@
 #include "hls_application.h"
 #include "hls_stream.h"
 #include "hls_private.h"
+#include "segment_stream/packetyzer/segment_uploader.h"
 
 //====================================================================================================
 // Create
@@ -29,6 +30,55 @@ HlsApplication::HlsApplication(const info::Application *application_info) : Appl
     auto publisher_info = application_info->GetPublisher<cfg::HlsPublisher>();
     _segment_count = publisher_info->GetSegmentCount();
     _segment_duration = publisher_info->GetSegmentDuration();
+    _segment_tolerance = static_cast<uint32_t>(std::max(publisher_info->GetSegmentTolerance(), 0));
+    _part_duration = publisher_info->IsLowLatencyEnabled() ? static_cast<uint32_t>(publisher_info->GetPartDuration()) : 0;
+    _cmaf = publisher_info->IsCmafEnabled();
+    _byte_range = publisher_info->IsByteRangeEnabled();
+
+    SetQueueConfig(publisher_info->GetQueue());
+
+    // partial segments are made by the TS packetyzer only
+    if (_cmaf && _part_duration > 0)
+    {
+        logtw("Low-Latency HLS is not supported with CMAF, so it is disabled (%s)", GetName().CStr());
+        _part_duration = 0;
+    }
+
+    _segment_memory_limit = static_cast<uint64_t>(publisher_info->GetSegmentMemoryLimit()) * 1024 * 1024;
+    _dvr_duration = static_cast<uint32_t>(std::max(publisher_info->GetDvrDuration(), 0));
+    _dvr_path = publisher_info->GetDvrPath();
+    _thumbnail = publisher_info->IsThumbnailEnabled();
+    _thumbnail_width = static_cast<uint32_t>(std::max(publisher_info->GetThumbnailWidth(), 0));
+
+    if (!ov::PathManager::IsAbsolute(_dvr_path.CStr()))
+        _dvr_path = ov::PathManager::GetAppPath(_dvr_path);
+
+    // the window files of TS segments are not made
+    if (!_cmaf && _byte_range)
+    {
+        logtw("ByteRange is supported with CMAF only, so it is disabled (%s)", GetName().CStr());
+        _byte_range = false;
+    }
+
+    // fMP4 segments are not written to the DVR files
+    if (_cmaf && _dvr_duration > 0)
+    {
+        logtw("DVR is not supported with CMAF, so it is disabled (%s)", GetName().CStr());
+        _dvr_duration = 0;
+    }
+
+    // the parts are not pushed(the players reload the playlist of every part from this server)
+    if (!publisher_info->GetUpload().GetUrls().empty())
+    {
+        if (_part_duration > 0)
+            logtw("Upload is not supported with Low-Latency HLS, so it is disabled (%s)", GetName().CStr());
+        else if (_byte_range)
+            logtw("Upload is not supported with ByteRange(the window files grow), so it is disabled (%s)", GetName().CStr());
+        else
+            _uploader = SegmentUploader::Create(ov::String::FormatString("hls/%s", GetName().CStr()), publisher_info->GetUpload());
+    }
+
+    Packetyzer::SetTotalMemoryLimit(static_cast<uint64_t>(publisher_info->GetTotalSegmentMemoryLimit()) * 1024 * 1024);
 }
 
 //====================================================================================================
@@ -61,7 +111,13 @@ bool HlsApplication::Start()
 //====================================================================================================
 bool HlsApplication::Stop()
 {
-	return Application::Stop();
+	// the streams are stopped first(no more uploads are queued)
+	bool result = Application::Stop();
+
+	if (_uploader != nullptr)
+		_uploader->Stop();
+
+	return result;
 }
 
 //====================================================================================================
@@ -74,6 +130,16 @@ std::shared_ptr<Stream> HlsApplication::CreateStream(std::shared_ptr<StreamInfo>
 
 	return HlsStream::Create(_segment_count,
                              _segment_duration,
+                             _segment_tolerance,
+                             _part_duration,
+                             _cmaf,
+                             _byte_range,
+                             _segment_memory_limit,
+                             _dvr_path,
+                             _dvr_duration,
+                             _thumbnail,
+                             _thumbnail_width,
+                             _uploader,
                              GetSharedPtrAs<Application>(),
                              *info.get(),
                              worker_count);
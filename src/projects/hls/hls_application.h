@@ -24,6 +24,12 @@ public:
 
 	virtual ~HlsApplication() final;
 
+    // second
+    int GetSegmentDuration() const
+    {
+        return _segment_duration;
+    }
+
 private:
 	bool Start() override;
 	bool Stop() override;
@@ -35,4 +41,14 @@ private:
 private :
     int _segment_count;
     int _segment_duration;
+    uint32_t _segment_tolerance; // millisecond
+    uint32_t _part_duration;
+    bool _cmaf;
+    bool _byte_range; // EXT-X-BYTERANGE of the window files(CMAF)
+    uint64_t _segment_memory_limit;
+    ov::String _dvr_path;
+    uint32_t _dvr_duration; // second(0 : disabled)
+    bool _thumbnail;
+    uint32_t _thumbnail_width; // 0 : width of the stream
+    std::shared_ptr<SegmentUploader> _uploader = nullptr; // shared by the streams(nullptr : disabled)
 };
@@ -0,0 +1,119 @@
+﻿//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Created by Jaejong Bong
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#include "hls_cmaf_stream_packetyzer.h"
+#include "hls_private.h"
+
+//====================================================================================================
+// Constructor
+// - timescale : same as DASH(the packetyzer is shared)
+//====================================================================================================
+HlsCmafStreamPacketyzer::HlsCmafStreamPacketyzer(const ov::String &app_name,
+                                                 const ov::String &stream_name,
+                                                 uint32_t stream_id,
+                                                 int segment_count,
+                                                 int segment_duration,
+                                                 const ov::String &segment_prefix,
+                                                 PacketyzerStreamType stream_type,
+                                                 PacketyzerMediaInfo media_info,
+                                                 bool byte_range) :
+                                                 StreamPacketyzer(app_name,
+                                                                 stream_name,
+                                                                 segment_count,
+                                                                 segment_duration,
+                                                                 stream_type,
+                                                                 PACKTYZER_DEFAULT_TIMESCALE,
+                                                                 media_info.audio_samplerate,
+                                                                 static_cast<uint32_t>(media_info.video_framerate))
+{
+    media_info.video_timescale = PACKTYZER_DEFAULT_TIMESCALE;
+    media_info.audio_timescale = media_info.audio_samplerate;
+
+    // chunk duration 0 : low latency DASH packetyzer is not shared
+    _shared_packetyzer = CmafPacketyzerManager::GetPacketyzer(app_name,
+                                                              stream_name,
+                                                              stream_id,
+                                                              stream_type,
+                                                              segment_prefix,
+                                                              segment_count,
+                                                              segment_duration,
+                                                              media_info,
+                                                              0);
+
+    _cmaf_packetyzer = _shared_packetyzer->GetPacketyzer();
+    _cmaf_packetyzer->EnableHlsPlayList(byte_range);
+
+    _packetyzer = _cmaf_packetyzer;
+}
+
+//====================================================================================================
+// Destructor
+//====================================================================================================
+HlsCmafStreamPacketyzer::~HlsCmafStreamPacketyzer()
+{
+    _shared_packetyzer->Release(this);
+}
+
+//====================================================================================================
+// Append Video Frame
+//====================================================================================================
+bool HlsCmafStreamPacketyzer::AppendVideoFrame(std::shared_ptr<PacketyzerFrameData> &data)
+{
+    // appended by the other user(DASH) of the shared packetyzer
+    if (!_shared_packetyzer->IsFeeder(this, data))
+        return true;
+
+    return _cmaf_packetyzer->AppendVideoFrame(data);
+}
+
+//====================================================================================================
+// Append Audio Frame
+//====================================================================================================
+bool HlsCmafStreamPacketyzer::AppendAudioFrame(std::shared_ptr<PacketyzerFrameData> &data)
+{
+    if (!_shared_packetyzer->IsFeeder(this, data))
+        return true;
+
+    return _cmaf_packetyzer->AppendAudioFrame(data);
+}
+
+//====================================================================================================
+// Get PlayList
+// - multivariant playlist
+//====================================================================================================
+bool HlsCmafStreamPacketyzer::GetPlayList(std::shared_ptr<const PlayListSnapshot> &play_list)
+{
+    return _cmaf_packetyzer->GetHlsPlayList(CMAF_HLS_PLAY_LIST_FILE_NAME, play_list);
+}
+
+//====================================================================================================
+// Get PlayList
+// - playlist.m3u8(multivariant)/video.m3u8/audio.m3u8
+//====================================================================================================
+bool HlsCmafStreamPacketyzer::GetPlayList(const ov::String &file_name, std::shared_ptr<const PlayListSnapshot> &play_list)
+{
+    return _cmaf_packetyzer->GetHlsPlayList(file_name, play_list);
+}
+
+//====================================================================================================
+// GetSegment
+// - M4S(init segment included)
+//====================================================================================================
+bool HlsCmafStreamPacketyzer::GetSegment(const ov::String &segment_file_name, std::shared_ptr<SegmentData> &segment_data)
+{
+    return _cmaf_packetyzer->GetSegmentData(segment_file_name, segment_data);
+}
+
+//====================================================================================================
+// GetVideoCodecString
+//====================================================================================================
+std::string HlsCmafStreamPacketyzer::GetVideoCodecString()
+{
+    return _cmaf_packetyzer->GetVideoCodecString();
+}
@@ -0,0 +1,49 @@
+﻿//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Created by Jaejong Bong
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#pragma once
+
+#include "segment_stream/stream_packetyzer.h"
+#include "dash/cmaf_packetyzer_manager.h"
+
+//====================================================================================================
+// HlsCmafStreamPacketyzer
+// - HLS with fMP4(CMAF) segments
+// - the segments are made by the CMAF packetyzer shared with DASH(same stream/segment settings)
+// - byte range : the media playlists refer to the ranges of the window files(the DASH segments are not changed)
+//====================================================================================================
+class HlsCmafStreamPacketyzer : public StreamPacketyzer
+{
+public:
+    HlsCmafStreamPacketyzer(const ov::String &app_name,
+                            const ov::String &stream_name,
+                            uint32_t stream_id,
+                            int segment_count,
+                            int segment_duration,
+                            const ov::String &segment_prefix,
+                            PacketyzerStreamType stream_type,
+                            PacketyzerMediaInfo media_info,
+                            bool byte_range = false);
+
+    virtual ~HlsCmafStreamPacketyzer();
+
+public :
+
+    // Implement StreamPacketyzer Interface
+    bool AppendVideoFrame(std::shared_ptr<PacketyzerFrameData> &data) override;
+    bool AppendAudioFrame(std::shared_ptr<PacketyzerFrameData> &data) override;
+    bool GetPlayList(std::shared_ptr<const PlayListSnapshot> &play_list) override;
+    bool GetPlayList(const ov::String &file_name, std::shared_ptr<const PlayListSnapshot> &play_list) override;
+    bool GetSegment(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data) override;
+    std::string GetVideoCodecString() override;
+
+private :
+    std::shared_ptr<SharedCmafPacketyzer> _shared_packetyzer = nullptr;
+    std::shared_ptr<DashPacketyzer> _cmaf_packetyzer = nullptr;
+};
@@ -9,6 +9,7 @@
 
 #include "hls_interceptor.h"
 #include "hls_private.h"
+#include "segment_stream/segment_thumbnailer.h"
 
 HlsInterceptor::HlsInterceptor()
 {
@@ -34,9 +35,11 @@ bool HlsInterceptor::IsInterceptorForRequest(const std::shared_ptr<const HttpReq
 		return false;
 	}
 
-    // ts/m3u8
+    // ts/m3u8/m4s(CMAF)/thumbnail
     if((request->GetRequestTarget().IndexOf(".ts") >= 0) ||
        (request->GetRequestTarget().IndexOf(".m3u8") >= 0) ||
+       (request->GetRequestTarget().IndexOf(".m4s") >= 0) ||
+       (request->GetRequestTarget().IndexOf("/" THUMBNAIL_FILE_NAME) >= 0) ||
        (!_is_crossdomain_block && request->GetRequestTarget().IndexOf("crossdomain.xml") >= 0))
     {
         return true;
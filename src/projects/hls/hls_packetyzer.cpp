@@ -15,7 +15,14 @@
 #include <algorithm>
 #include "base/ovlibrary/ovlibrary.h"
 #include "hls_private.h"
+#include <cmath>
 #define HLS_MAX_TEMP_VIDEO_DATA_COUNT        (500)
+// Low-Latency HLS : parts of the last (HLS_PART_PLAY_SEGMENT_COUNT) segments are listed in the playlist
+#define HLS_PART_PLAY_SEGMENT_COUNT          (2)
+// Low-Latency HLS : parts are kept for (HLS_PART_SAVE_SEGMENT_COUNT) segments
+#define HLS_PART_SAVE_SEGMENT_COUNT          (3)
+// Low-Latency HLS : blocking requests time out after (HLS_WAIT_TIMEOUT_SEGMENT_COUNT x segment duration)
+#define HLS_WAIT_TIMEOUT_SEGMENT_COUNT       (3)
 
 //====================================================================================================
 // Constructor
@@ -26,7 +33,8 @@ HlsPacketyzer::HlsPacketyzer(const ov::String &app_name,
                              const ov::String &segment_prefix,
                              uint32_t segment_count,
                              uint32_t segment_duration,
-                             PacketyzerMediaInfo &media_info) :
+                             PacketyzerMediaInfo &media_info,
+                             uint32_t part_duration) :
                                 Packetyzer(app_name,
                                         stream_name,
                                         PacketyzerType::Hls,
@@ -41,6 +49,22 @@ HlsPacketyzer::HlsPacketyzer(const ov::String &app_name,
     _video_enable = false;
     _audio_enable = false;
     _duration_threshold = (double)_segment_duration * 0.9 * (double)_media_info.video_timescale;
+    _part_duration = part_duration;
+    _current_sequence_number = _sequence_number;
+    _play_list_file_name = HLS_PLAY_LIST_FILE_NAME;
+
+    // playlist is updated every part
+    if (IsLowLatency())
+        _play_list_max_age = 0;
+}
+
+//====================================================================================================
+// Destructor
+// - pending blocking requests are released
+//====================================================================================================
+HlsPacketyzer::~HlsPacketyzer()
+{
+    NotifyWaiters(true);
 }
 
 //====================================================================================================
@@ -66,9 +90,14 @@ bool HlsPacketyzer::AppendVideoFrame(std::shared_ptr<PacketyzerFrameData> &frame
         frame_data->timescale = _media_info.video_timescale;
     }
 
+    if (IsLowLatency())
+    {
+        return AppendLowLatencyFrame(frame_data);
+    }
+
     if (frame_data->type == PacketyzerFrameType::VideoIFrame && !_frame_datas.empty())
     {
-        if ((frame_data->timestamp - _frame_datas[0]->timestamp) >= (_segment_duration * _media_info.video_timescale))
+        if (IsSegmentCutTimestamp(_frame_datas[0]->timestamp, frame_data->timestamp, _media_info.video_timescale))
         {
             // Segment Write
             SegmentWrite(_frame_datas[0]->timestamp, frame_data->timestamp - _frame_datas[0]->timestamp);
@@ -97,6 +126,11 @@ bool HlsPacketyzer::AppendAudioFrame(std::shared_ptr<PacketyzerFrameData> &frame
         frame_data->timescale = _media_info.audio_timescale;
     }
 
+    if (IsLowLatency())
+    {
+        return AppendLowLatencyFrame(frame_data);
+    }
+
     if ((time(nullptr) - _last_video_append_time >= static_cast<uint32_t>(_segment_duration)) && !_frame_datas.empty())
     {
         if((frame_data->timestamp - _frame_datas[0]->timestamp) >= (_segment_duration * _media_info.audio_timescale))
@@ -120,7 +154,13 @@ bool HlsPacketyzer::SegmentWrite(uint64_t start_timestamp, uint64_t duration)
     int64_t _first_audio_time_stamp = 0;
     int64_t _first_video_time_stamp = 0;
 
-    auto ts_writer = std::make_unique<TsWriter>(_video_enable, _audio_enable);
+    auto ts_writer = std::make_unique<TsWriter>(_video_enable, _audio_enable, _media_info.video_codec_type);
+    size_t data_size = 0;
+
+    for (const auto &frame_data : _frame_datas)
+        data_size += frame_data->data->GetLength();
+
+    ts_writer->ReserveSampleData(data_size, _frame_datas.size());
 
     for (auto &frame_data : _frame_datas)
     {
@@ -143,6 +183,9 @@ bool HlsPacketyzer::SegmentWrite(uint64_t start_timestamp, uint64_t duration)
     if(_first_audio_time_stamp != 0 && _first_video_time_stamp != 0)
         logtd("hls segment video/audio timestamp gap(%lldms)",  (_first_video_time_stamp - _first_audio_time_stamp)/90);
 
+    // the first segment is numbered by its timestamp(segment alignment)
+    AlignSequenceNumber(start_timestamp, _media_info.video_timescale);
+
     std::ostringstream file_name_stream;
     file_name_stream << _segment_prefix << "_" << _sequence_number << ".ts";
 
@@ -183,11 +226,14 @@ bool HlsPacketyzer::UpdatePlayList()
         }
     }
 
+    // sequence number of the first segment of the playlist
+    uint32_t media_sequence = segment_datas.empty() ? _sequence_number : segment_datas[0]->sequence_number;
+
     play_lis_stream << "#EXTM3U" << "\r\n"
-              << "#EXT-X-MEDIA-SEQUENCE:" << (_sequence_number - 1) << "\r\n"
+              << "#EXT-X-MEDIA-SEQUENCE:" << media_sequence << "\r\n"
               << "#EXT-X-VERSION:3" << "\r\n"
               << "#EXT-X-ALLOW-CACHE:NO" << "\r\n"
-              << "#EXT-X-TARGETDURATION:" << (int) (max_duration / PACKTYZER_DEFAULT_TIMESCALE) << "\r\n"
+              << "#EXT-X-TARGETDURATION:" << (int)std::lround(max_duration / PACKTYZER_DEFAULT_TIMESCALE) << "\r\n"
               << m3u8_play_list.str();
 
     // Playlist 설정
@@ -209,7 +255,7 @@ bool HlsPacketyzer::UpdatePlayList()
 //====================================================================================================
 // Get Segment
 //====================================================================================================
-bool HlsPacketyzer::GetSegmentData(const ov::String &file_name, std::shared_ptr<ov::Data> &data)
+bool HlsPacketyzer::GetSegmentData(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data)
 {
     if(!_init_segment_count_complete)
         return false;
@@ -226,13 +272,37 @@ bool HlsPacketyzer::GetSegmentData(const ov::String &file_name, std::shared_ptr<
 
     if(item == _video_segment_datas.end())
     {
-        data = nullptr;
+        lock.unlock();
+
+        // Low-Latency partial segment
+        if (IsLowLatency())
+        {
+            std::unique_lock<std::mutex> part_lock(_part_guard);
+
+            auto part_item = std::find_if(_part_datas.begin(),
+                    _part_datas.end(), [&](std::shared_ptr<HlsPartData> const &value) -> bool
+            {
+                return value->file_name == file_name;
+            });
+
+            if(part_item != _part_datas.end())
+            {
+                segment_data = (*part_item)->segment_data;
+                return segment_data != nullptr;
+            }
+        }
+
+        // older segment(out of memory)
+        if (GetDvrSegmentData(file_name, segment_data))
+            return true;
+
+        segment_data = nullptr;
         return false;
     }
 
-    data = (*item)->data;
+    segment_data = *item;
 
-    return data != nullptr;
+    return segment_data->data != nullptr;
 }
 
 //====================================================================================================
@@ -243,17 +313,12 @@ bool HlsPacketyzer::SetSegmentData(ov::String file_name,
                                     uint64_t timestamp,
                                     const std::shared_ptr<std::vector<uint8_t>> &data)
 {
-    auto segment_data = std::make_shared<SegmentData>(_sequence_number++, file_name, duration, timestamp, data);
-
     // video segment mutex
     std::unique_lock<std::mutex> lock(_video_segment_guard);
 
-    _video_segment_datas[_current_video_index++] = segment_data;
+    StoreSegmentData(_video_segment_datas, _current_video_index, file_name, duration, timestamp, data);
 
-    if(_segment_save_count <= _current_video_index)
-        _current_video_index = 0;
-
-    if(!_init_segment_count_complete  && _sequence_number > _segment_count)
+    if(!_init_segment_count_complete  && (_sequence_number - _first_sequence_number) >= _segment_count)
     {
         _init_segment_count_complete = true;
         logti("Hls ready completed - prefix(%s) segment(%ds/%d)",
@@ -262,5 +327,498 @@ bool HlsPacketyzer::SetSegmentData(ov::String file_name,
               _segment_count);
     }
 
+    lock.unlock();
+
+    if (IsDvrEnabled())
+        UpdateDvrPlayList();
+
+    // coalesced requests of the segment
+    NotifyMissWaiters();
+
+    return true;
+}
+
+//====================================================================================================
+// DVR PlayList(M3U8) 업데이트
+// - memory segments + the segments written to the DVR files(no gap : up to the latest missing segment)
+// - called by the packetyzer thread only
+//====================================================================================================
+void HlsPacketyzer::UpdateDvrPlayList()
+{
+    struct DvrPlayListItem
+    {
+        ov::String file_name;
+        uint64_t duration;
+    };
+
+    std::map<int, DvrPlayListItem> items;
+    std::vector<std::shared_ptr<const DvrSegmentIndex>> indexes;
+
+    _dvr_store->GetSegmentIndexes(indexes);
+
+    for (const auto &index : indexes)
+        items[index->sequence_number] = { index->file_name, index->duration };
+
+    {
+        std::unique_lock<std::mutex> lock(_video_segment_guard);
+
+        for (const auto &segment_data : _video_segment_datas)
+        {
+            if (segment_data != nullptr)
+                items[segment_data->sequence_number] = { segment_data->file_name, segment_data->duration };
+        }
+    }
+
+    if (items.empty())
+        return;
+
+    // contiguous segments from the latest one
+    auto begin_item = std::prev(items.end());
+
+    while (begin_item != items.begin() && std::prev(begin_item)->first == begin_item->first - 1)
+        begin_item--;
+
+    std::ostringstream play_list_stream;
+    std::ostringstream m3u8_play_list;
+    uint64_t max_duration = 0;
+
+    for (auto item = begin_item; item != items.end(); item++)
+    {
+        m3u8_play_list << "#EXTINF:" << std::fixed << std::setprecision(3)
+                       << (double)(item->second.duration) / (double)(PACKTYZER_DEFAULT_TIMESCALE) << ",\r\n"
+                       << item->second.file_name.CStr() << "\r\n";
+
+        max_duration = std::max(max_duration, item->second.duration);
+    }
+
+    play_list_stream << "#EXTM3U" << "\r\n"
+                     << "#EXT-X-MEDIA-SEQUENCE:" << begin_item->first << "\r\n"
+                     << "#EXT-X-VERSION:3" << "\r\n"
+                     << "#EXT-X-TARGETDURATION:" << (int)std::ceil((double)max_duration / PACKTYZER_DEFAULT_TIMESCALE) << "\r\n"
+                     << m3u8_play_list.str();
+
+    ov::String play_list = play_list_stream.str().c_str();
+    std::atomic_store(&_dvr_play_list, MakePlayListSnapshot(play_list));
+
+    UploadPlayList(HLS_DVR_PLAY_LIST_FILE_NAME, _dvr_play_list);
+}
+
+//====================================================================================================
+// DVR PlayList
+// - thread safe
+//====================================================================================================
+bool HlsPacketyzer::GetDvrPlayList(std::shared_ptr<const PlayListSnapshot> &play_list)
+{
+    if (!_init_segment_count_complete || !IsDvrEnabled())
+        return false;
+
+    play_list = std::atomic_load(&_dvr_play_list);
+
+    return (play_list != nullptr);
+}
+
+//====================================================================================================
+// Segment Coming Check(request coalescing)
+// - the next segment([Prefix]_[Sequence Number].TS) which is being made
+//====================================================================================================
+bool HlsPacketyzer::IsSegmentComing(const ov::String &file_name)
+{
+    // video segment mutex
+    std::unique_lock<std::mutex> lock(_video_segment_guard);
+
+    if(!_init_segment_count_complete)
+        return false;
+
+    return file_name == ov::String::FormatString("%s_%u.ts", _segment_prefix.CStr(), _sequence_number);
+}
+
+//====================================================================================================
+// Low-Latency Frame
+// - segment/part are cut at video frames(audio frames if audio only) and streamed as TS partial segments
+// - segment : key frame && (segment duration) elapsed
+// - part : the next frame would exceed the part duration
+//====================================================================================================
+bool HlsPacketyzer::AppendLowLatencyFrame(std::shared_ptr<PacketyzerFrameData> &frame_data)
+{
+    bool is_video = frame_data->type != PacketyzerFrameType::AudioFrame;
+    bool is_keyframe = !is_video || frame_data->type == PacketyzerFrameType::VideoIFrame;
+    bool is_cut_frame = (_stream_type == PacketyzerStreamType::AudioOnly) ? !is_video : is_video;
+    uint64_t timestamp = frame_data->timestamp;
+
+    if (_ts_writer == nullptr)
+    {
+        // First key frame wait
+        if (!is_cut_frame || !is_keyframe)
+        {
+            NotifyWaiters();
+            return true;
+        }
+
+        // the first segment is numbered by its timestamp(segment alignment)
+        if (!_sequence_number_aligned)
+        {
+            AlignSequenceNumber(timestamp, _media_info.video_timescale);
+
+            std::unique_lock<std::mutex> lock(_part_guard);
+            _current_sequence_number = _sequence_number;
+        }
+
+        StartSegment(timestamp);
+    }
+    else if (is_cut_frame && timestamp > _part_start_timestamp)
+    {
+        uint64_t part_elapsed = timestamp - _part_start_timestamp;
+        uint64_t frame_interval = (timestamp > _last_cut_frame_timestamp) ? (timestamp - _last_cut_frame_timestamp) : 0;
+
+        if (is_keyframe && IsSegmentCutTimestamp(_segment_start_timestamp, timestamp, _media_info.video_timescale))
+        {
+            PartWrite(timestamp);
+            LowLatencySegmentWrite(timestamp);
+            StartSegment(timestamp);
+        }
+        else if ((part_elapsed + frame_interval) * 1000 > (uint64_t)_part_duration * _media_info.video_timescale)
+        {
+            PartWrite(timestamp);
+        }
+    }
+
+    if (is_cut_frame)
+    {
+        _last_cut_frame_timestamp = timestamp;
+    }
+
+    // TS(PES) Write
+    _ts_writer->WriteSample(is_video,
+                            is_keyframe,
+                            frame_data->timestamp,
+                            frame_data->time_offset,
+                            frame_data->data);
+
+    if (is_video)
+    {
+        _last_video_append_time = time(nullptr);
+        _video_enable = true;
+    }
+    else
+    {
+        _last_audio_append_time = time(nullptr);
+        _audio_enable = true;
+    }
+
+    // blocking request timeout check
+    NotifyWaiters();
+
     return true;
 }
+
+//====================================================================================================
+// Low-Latency Segment Start
+// - PAT/PMT are written at the beginning of the segment so the first part is independent
+//====================================================================================================
+void HlsPacketyzer::StartSegment(uint64_t timestamp)
+{
+    _ts_writer = std::make_unique<TsWriter>(_stream_type != PacketyzerStreamType::AudioOnly,
+                                            _stream_type != PacketyzerStreamType::VideoOnly,
+                                            _media_info.video_codec_type);
+    _part_offset = 0;
+    _part_index = 0;
+    _segment_start_timestamp = timestamp;
+    _part_start_timestamp = timestamp;
+}
+
+//====================================================================================================
+// Part File Name
+// - [Prefix]_[Index]_part[Part Index].ts
+//====================================================================================================
+ov::String HlsPacketyzer::MakePartFileName(uint32_t sequence_number, uint32_t part_index)
+{
+    return ov::String::FormatString("%s_%u_part%u.ts", _segment_prefix.CStr(), sequence_number, part_index);
+}
+
+//====================================================================================================
+// Part Write
+// - part : data written to the segment since the last part
+//====================================================================================================
+bool HlsPacketyzer::PartWrite(uint64_t timestamp)
+{
+    const auto &data_stream = _ts_writer->GetDataStream();
+
+    if (data_stream->size() <= _part_offset || timestamp <= _part_start_timestamp)
+    {
+        return false;
+    }
+
+    auto data = std::make_shared<ov::Data>(data_stream->data() + _part_offset, data_stream->size() - _part_offset);
+    auto part_data = std::make_shared<HlsPartData>(_sequence_number,
+                                                   _part_index,
+                                                   MakePartFileName(_sequence_number, _part_index),
+                                                   timestamp - _part_start_timestamp,
+                                                   _part_index == 0,
+                                                   data);
+
+    part_data->segment_data = std::make_shared<SegmentData>(_sequence_number, part_data->file_name, part_data->duration, 0, data);
+    SetSegmentCacheInfo(part_data->segment_data);
+
+    {
+        std::unique_lock<std::mutex> lock(_part_guard);
+
+        _part_datas.push_back(part_data);
+
+        while (!_part_datas.empty() &&
+               (_part_datas.front()->sequence_number + HLS_PART_SAVE_SEGMENT_COUNT) <= _sequence_number)
+        {
+            _part_datas.pop_front();
+        }
+
+        _current_sequence_number = _sequence_number;
+        _current_part_count = _part_index + 1;
+    }
+
+    _part_offset = data_stream->size();
+    _part_index++;
+    _part_start_timestamp = timestamp;
+
+    UpdateLowLatencyPlayList();
+    NotifyWaiters();
+
+    return true;
+}
+
+//====================================================================================================
+// Low-Latency Segment Write
+// - the segment is the concatenation of its parts
+//====================================================================================================
+bool HlsPacketyzer::LowLatencySegmentWrite(uint64_t timestamp)
+{
+    ov::String file_name = ov::String::FormatString("%s_%u.ts", _segment_prefix.CStr(), _sequence_number);
+
+    SetSegmentData(file_name, timestamp - _segment_start_timestamp, _segment_start_timestamp, _ts_writer->GetDataStream());
+
+    {
+        std::unique_lock<std::mutex> lock(_part_guard);
+
+        _current_sequence_number = _sequence_number;
+        _current_part_count = 0;
+    }
+
+    _ts_writer.reset();
+
+    UpdateLowLatencyPlayList();
+    NotifyWaiters();
+
+    _video_enable = false;
+    _audio_enable = false;
+
+    return true;
+}
+
+//====================================================================================================
+// Low-Latency PlayList(M3U8)
+// - parts of the last segments + parts of the current segment + preload hint
+//====================================================================================================
+bool HlsPacketyzer::UpdateLowLatencyPlayList()
+{
+    std::ostringstream play_list_stream;
+    std::ostringstream m3u8_play_list;
+    uint64_t max_duration = 0;
+
+    std::vector<std::shared_ptr<SegmentData>> segment_datas;
+    Packetyzer::GetVideoPlaySegments(segment_datas);
+
+    std::vector<std::shared_ptr<HlsPartData>> part_datas;
+    uint32_t current_sequence_number;
+    uint32_t current_part_count;
+    {
+        std::unique_lock<std::mutex> lock(_part_guard);
+
+        part_datas.assign(_part_datas.begin(), _part_datas.end());
+        current_sequence_number = _current_sequence_number;
+        current_part_count = _current_part_count;
+    }
+
+    auto append_parts = [&](uint32_t sequence_number)
+    {
+        for (const auto &part_data : part_datas)
+        {
+            if (part_data->sequence_number != sequence_number)
+            {
+                continue;
+            }
+
+            m3u8_play_list << "#EXT-X-PART:DURATION=" << std::fixed << std::setprecision(3)
+                           << (double)(part_data->duration) / (double)(PACKTYZER_DEFAULT_TIMESCALE)
+                           << ",URI=\"" << part_data->file_name.CStr() << "\""
+                           << (part_data->independent ? ",INDEPENDENT=YES" : "") << "\r\n";
+        }
+    };
+
+    for (size_t index = 0; index < segment_datas.size(); index++)
+    {
+        const auto &segment_data = segment_datas[index];
+
+        if (index + HLS_PART_PLAY_SEGMENT_COUNT >= segment_datas.size())
+        {
+            append_parts(segment_data->sequence_number);
+        }
+
+        m3u8_play_list << "#EXTINF:" << std::fixed << std::setprecision(3)
+                       << (double)(segment_data->duration) / (double)(PACKTYZER_DEFAULT_TIMESCALE) << ",\r\n"
+                       << segment_data->file_name.CStr() << "\r\n";
+
+        if (segment_data->duration > max_duration)
+        {
+            max_duration = segment_data->duration;
+        }
+    }
+
+    // current segment
+    append_parts(current_sequence_number);
+
+    m3u8_play_list << "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\""
+                   << MakePartFileName(current_sequence_number, current_part_count).CStr() << "\"\r\n";
+
+    double part_target = (double)_part_duration / 1000.0;
+    int target_duration = std::max((int)std::lround((double)max_duration / PACKTYZER_DEFAULT_TIMESCALE),
+                                   (int)_segment_duration);
+    uint32_t media_sequence = segment_datas.empty() ? current_sequence_number : segment_datas[0]->sequence_number;
+
+    play_list_stream << "#EXTM3U" << "\r\n"
+                     << "#EXT-X-VERSION:6" << "\r\n"
+                     << "#EXT-X-TARGETDURATION:" << target_duration << "\r\n"
+                     << "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK="
+                     << std::fixed << std::setprecision(3) << (part_target * 3) << "\r\n"
+                     << "#EXT-X-PART-INF:PART-TARGET=" << part_target << "\r\n"
+                     << "#EXT-X-MEDIA-SEQUENCE:" << media_sequence << "\r\n"
+                     << m3u8_play_list.str();
+
+    // Playlist 설정
+    ov::String play_list = play_list_stream.str().c_str();
+    SetPlayList(play_list);
+
+    return true;
+}
+
+//====================================================================================================
+// Available Check
+// - part_index -1 : whole segment
+// - _part_guard must be locked
+//====================================================================================================
+bool HlsPacketyzer::IsAvailable(int64_t sequence_number, int64_t part_index)
+{
+    if (sequence_number < _current_sequence_number)
+    {
+        return true;
+    }
+
+    return (sequence_number == _current_sequence_number) &&
+           (part_index >= 0) && (part_index < _current_part_count);
+}
+
+//====================================================================================================
+// Wait PlayList
+// - Available : response now
+// - Waiting : callback is called when the segment/part is available (or timeout)
+// - Invalid : too far in the future (400 Bad Request)
+//====================================================================================================
+PacketyzerWaitResult HlsPacketyzer::WaitPlayList(int64_t sequence_number,
+                                                 int64_t part_index,
+                                                 const PacketyzerWaitCallback &callback)
+{
+    // not blocking reload : held only until the playlist is ready
+    if (sequence_number < 0)
+    {
+        return WaitPlayListData(callback);
+    }
+
+    if (!IsLowLatency())
+    {
+        return PacketyzerWaitResult::Available;
+    }
+
+    std::unique_lock<std::mutex> lock(_part_guard);
+
+    if (IsAvailable(sequence_number, part_index))
+    {
+        return PacketyzerWaitResult::Available;
+    }
+
+    if (sequence_number > _current_sequence_number + 2)
+    {
+        return PacketyzerWaitResult::Invalid;
+    }
+
+    _waiters.push_back({sequence_number,
+                        part_index,
+                        GetCurrentMilliseconds() + (double)_segment_duration * 1000 * HLS_WAIT_TIMEOUT_SEGMENT_COUNT,
+                        callback});
+
+    return PacketyzerWaitResult::Waiting;
+}
+
+//====================================================================================================
+// Wait Segment
+// - the preload hinted part is waited
+// - the requests of the segment being made are coalesced(the others are responded now)
+//====================================================================================================
+PacketyzerWaitResult HlsPacketyzer::WaitSegment(const ov::String &file_name, const PacketyzerWaitCallback &callback)
+{
+    if (!IsLowLatency())
+    {
+        return WaitSegmentData(file_name, callback);
+    }
+
+    std::unique_lock<std::mutex> lock(_part_guard);
+
+    if (file_name != MakePartFileName(_current_sequence_number, _current_part_count))
+    {
+        lock.unlock();
+
+        // the segment being made
+        return WaitSegmentData(file_name, callback);
+    }
+
+    _waiters.push_back({_current_sequence_number,
+                        _current_part_count,
+                        GetCurrentMilliseconds() + (double)_segment_duration * 1000 * HLS_WAIT_TIMEOUT_SEGMENT_COUNT,
+                        callback});
+
+    return PacketyzerWaitResult::Waiting;
+}
+
+//====================================================================================================
+// Notify Waiters
+// - callbacks are called without lock
+//====================================================================================================
+void HlsPacketyzer::NotifyWaiters(bool expire_all)
+{
+    std::vector<PacketyzerWaitCallback> callbacks;
+
+    {
+        std::unique_lock<std::mutex> lock(_part_guard);
+
+        if (_waiters.empty())
+        {
+            return;
+        }
+
+        double current_time = GetCurrentMilliseconds();
+
+        for (auto item = _waiters.begin(); item != _waiters.end();)
+        {
+            if (expire_all || current_time >= item->deadline || IsAvailable(item->sequence_number, item->part_index))
+            {
+                callbacks.push_back(std::move(item->callback));
+                item = _waiters.erase(item);
+            }
+            else
+            {
+                item++;
+            }
+        }
+    }
+
+    for (const auto &callback : callbacks)
+    {
+        callback();
+    }
+}
@@ -9,11 +9,51 @@
 
 #pragma once
 #include "segment_stream/packetyzer/ts_writer.h"
+#include <deque>
+
+#define HLS_PLAY_LIST_FILE_NAME         "playlist.m3u8"
+
+// DVR : all the segments of the window(live playlist + written to the DVR files)
+#define HLS_DVR_PLAY_LIST_FILE_NAME     "playlist_dvr.m3u8"
+
+//====================================================================================================
+// HlsPartData
+// - Partial segment of Low-Latency HLS
+//====================================================================================================
+struct HlsPartData
+{
+public :
+    HlsPartData(uint32_t sequence_number_,
+                uint32_t part_index_,
+                const ov::String &file_name_,
+                uint64_t duration_,
+                bool independent_,
+                const std::shared_ptr<ov::Data> &data_)
+    {
+        sequence_number = sequence_number_;
+        part_index = part_index_;
+        file_name = file_name_;
+        duration = duration_;
+        independent = independent_;
+        data = data_;
+    }
+
+public :
+    uint32_t sequence_number;   // sequence number of the parent segment
+    uint32_t part_index;
+    ov::String file_name;
+    uint64_t duration;
+    bool independent;           // starts with PAT/PMT and a key frame
+    std::shared_ptr<ov::Data> data;
+    std::shared_ptr<SegmentData> segment_data; // response(data + HTTP cache validators)
+};
 
 //====================================================================================================
 // HlsPacketyzer
 // TS : [Prefix]_[Index].TS
+// Part(Low-Latency) : [Prefix]_[Index]_part[Part Index].TS
 // M3U8 : playlist.M3U8
+// DVR M3U8 : playlist_dvr.M3U8
 //====================================================================================================
 class HlsPacketyzer : public Packetyzer
 {
@@ -24,16 +64,17 @@ public:
                 const ov::String &segment_prefix,
                 uint32_t segment_count,
                 uint32_t segment_duration,
-                PacketyzerMediaInfo &media_info);
+                PacketyzerMediaInfo &media_info,
+                uint32_t part_duration = 0);
 
-	~HlsPacketyzer() = default;
+	~HlsPacketyzer();
 	
 public :
     virtual bool AppendVideoFrame(std::shared_ptr<PacketyzerFrameData> &frame_data) override;
 
     virtual bool AppendAudioFrame(std::shared_ptr<PacketyzerFrameData> &frame_data) override;
 
-    virtual bool GetSegmentData(const ov::String &file_name, std::shared_ptr<ov::Data> &data) override;
+    virtual bool GetSegmentData(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data) override;
 
     virtual bool SetSegmentData(ov::String file_name,
                                 uint64_t duration,
@@ -42,17 +83,65 @@ public :
 
     bool SegmentWrite(uint64_t start_timestamp, uint64_t duration);
 
+    bool IsLowLatency() const { return _part_duration > 0; }
+
+    // thread safe
+    bool GetDvrPlayList(std::shared_ptr<const PlayListSnapshot> &play_list);
+
+    // Blocking playlist reload(_HLS_msn/_HLS_part, part -1 : whole segment, sequence -1 : not ready yet)
+    PacketyzerWaitResult WaitPlayList(int64_t sequence_number, int64_t part_index, const PacketyzerWaitCallback &callback);
+
+    // Blocking request of the preload hinted part(or the segment being made)
+    PacketyzerWaitResult WaitSegment(const ov::String &file_name, const PacketyzerWaitCallback &callback);
+
 protected : 	
 	bool UpdatePlayList();
+    void UpdateDvrPlayList();
+
+    bool IsSegmentComing(const ov::String &file_name) override;
+
+    // Low-Latency HLS
+    bool AppendLowLatencyFrame(std::shared_ptr<PacketyzerFrameData> &frame_data);
+    void StartSegment(uint64_t timestamp);
+    bool PartWrite(uint64_t timestamp);
+    bool LowLatencySegmentWrite(uint64_t timestamp);
+    bool UpdateLowLatencyPlayList();
+    ov::String MakePartFileName(uint32_t sequence_number, uint32_t part_index);
+    bool IsAvailable(int64_t sequence_number, int64_t part_index);
+    void NotifyWaiters(bool expire_all = false);
 	
 protected :
 	std::vector<std::shared_ptr<PacketyzerFrameData>> _frame_datas;
     double _duration_threshold;
+    std::shared_ptr<const PlayListSnapshot> _dvr_play_list; // std::atomic_load/atomic_store only
 
     time_t _last_video_append_time;
     time_t _last_audio_append_time;
     time_t _audio_enable;
     time_t _video_enable;
 
+    // Low-Latency HLS
+    struct Waiter
+    {
+        int64_t sequence_number;
+        int64_t part_index;     // -1 : whole segment
+        double deadline;        // milliseconds
+        PacketyzerWaitCallback callback;
+    };
+
+    uint32_t _part_duration = 0; // millisecond(0 : disabled)
+    std::unique_ptr<TsWriter> _ts_writer;
+    size_t _part_offset = 0;
+    uint32_t _part_index = 0;
+    uint64_t _segment_start_timestamp = 0;
+    uint64_t _part_start_timestamp = 0;
+    uint64_t _last_cut_frame_timestamp = 0;
+
+    // _part_guard : _part_datas, _current_sequence_number, _current_part_count, _waiters
+    std::deque<std::shared_ptr<HlsPartData>> _part_datas;
+    uint32_t _current_sequence_number = 0;
+    uint32_t _current_part_count = 0;
+    std::vector<Waiter> _waiters;
+    std::mutex _part_guard;
 };
 
@@ -11,13 +11,18 @@
 #include "hls_application.h"
 #include "hls_private.h"
 
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
 std::shared_ptr<HlsPublisher> HlsPublisher::Create(std::map<int, std::shared_ptr<HttpServer>> &http_server_manager,
                                                   const info::Application *application_info,
-                                                  std::shared_ptr<MediaRouteInterface> router)
+                                                  std::shared_ptr<MediaRouteInterface> router,
+                                                  const std::shared_ptr<SegmentStreamObserver> &vod_observer)
 {
     auto publisher = std::make_shared<HlsPublisher>(application_info, router);
 
-    publisher->Start(http_server_manager);
+    publisher->Start(http_server_manager, vod_observer);
 
     return publisher;
 }
@@ -43,13 +48,14 @@ HlsPublisher::~HlsPublisher()
 // Start
 // - Publisher override
 //====================================================================================================
-bool HlsPublisher::Start(std::map<int, std::shared_ptr<HttpServer>> &http_server_manager)
+bool HlsPublisher::Start(std::map<int, std::shared_ptr<HttpServer>> &http_server_manager,
+                         const std::shared_ptr<SegmentStreamObserver> &vod_observer)
 {
     if(SupportedCodecCheck())
     {
         _supported_codec_check = true;
     }
-    else
+    else if(vod_observer == nullptr)
     {
         // log out put
         logtw("To output HLS, at least one of h264 or aac encoding setting information must be set.");
@@ -71,6 +77,16 @@ bool HlsPublisher::Start(std::map<int, std::shared_ptr<HttpServer>> &http_server
     // CORS/Crossdomain.xml setting
     stream_server->SetCrossDomain(publisher_info->GetCrossDomains());
 
+    // The kernel paces the responses (the segments are sent as bursts)
+    stream_server->SetMaxPacingRate(static_cast<uint64_t>(publisher_info->GetMaxPacingRate()) * 1000);
+
+    // The segments and the playlists are multiplexed over a connection (HTTPS only)
+    stream_server->SetHttp2Enabled(publisher_info->IsHttp2Enabled());
+
+    // The observers are added before the server is started (they are not locked by the worker threads)
+    if(vod_observer != nullptr)
+        stream_server->AddObserver(vod_observer);
+
     stream_server->AddObserver(SegmentStreamObserver::GetSharedPtr());
 
     // HLS Server Start
@@ -95,6 +111,20 @@ bool HlsPublisher::Start(std::map<int, std::shared_ptr<HttpServer>> &http_server
     return Publisher::Start();
 }
 
+//====================================================================================================
+// Stop
+// - Publisher override
+//====================================================================================================
+bool HlsPublisher::Stop()
+{
+    if(_stream_server != nullptr)
+    {
+        _stream_server->Stop();
+    }
+
+    return Publisher::Stop();
+}
+
 //====================================================================================================
 // SupportedCodecCheck
 // - supproted codec(h264/aac) check
@@ -158,7 +188,7 @@ std::shared_ptr<Application> HlsPublisher::OnCreateApplication(const info::Appli
 bool HlsPublisher::OnPlayListRequest(const ov::String &app_name,
                                       const ov::String &stream_name,
                                       const ov::String &file_name,
-                                      ov::String &play_list)
+                                      std::shared_ptr<const PlayListSnapshot> &play_list)
 {
     if(!_supported_codec_check)
     {
@@ -166,6 +196,11 @@ bool HlsPublisher::OnPlayListRequest(const ov::String &app_name,
         return false;
     }
 
+    if(file_name == HLS_MASTER_PLAY_LIST_FILE_NAME)
+    {
+        return GetMasterPlayList(app_name, stream_name, play_list);
+    }
+
     auto stream = std::static_pointer_cast<HlsStream>(GetStream(app_name, stream_name));
 
     if(!stream)
@@ -174,7 +209,7 @@ bool HlsPublisher::OnPlayListRequest(const ov::String &app_name,
         return false;
     }
 
-    if(!stream->GetPlayList(play_list))
+    if(!stream->GetPlayList(file_name, play_list))
     {
         logtw("Hls get playlist fail (%s/%s/%s)", app_name.CStr(), stream_name.CStr(), file_name.CStr());
         return false;
@@ -190,7 +225,7 @@ bool HlsPublisher::OnPlayListRequest(const ov::String &app_name,
 bool HlsPublisher::OnSegmentRequest(const ov::String &app_name,
                                      const ov::String &stream_name,
                                      const ov::String &file_name,
-                                     std::shared_ptr<ov::Data> &segment_data)
+                                     std::shared_ptr<SegmentData> &segment_data)
 {
     if(!_supported_codec_check)
     {
@@ -214,3 +249,182 @@ bool HlsPublisher::OnSegmentRequest(const ov::String &app_name,
 
     return true;
 }
+
+//====================================================================================================
+// OnPlayListWaitRequest
+//  - SegmentStreamObserver Implementation
+//  - stream not found : responded now(404)
+//====================================================================================================
+PacketyzerWaitResult HlsPublisher::OnPlayListWaitRequest(const ov::String &app_name,
+                                                         const ov::String &stream_name,
+                                                         const ov::String &file_name,
+                                                         int64_t sequence_number,
+                                                         int64_t part_index,
+                                                         const PacketyzerWaitCallback &callback)
+{
+    // the master playlist is made per request(the input stream may not exist)
+    if(file_name == HLS_MASTER_PLAY_LIST_FILE_NAME)
+    {
+        return PacketyzerWaitResult::Available;
+    }
+
+    auto stream = std::static_pointer_cast<HlsStream>(GetStream(app_name, stream_name));
+
+    if(!stream)
+    {
+        return PacketyzerWaitResult::Available;
+    }
+
+    return stream->WaitPlayList(sequence_number, part_index, callback);
+}
+
+//====================================================================================================
+// OnSegmentWaitRequest
+//  - SegmentStreamObserver Implementation
+//====================================================================================================
+PacketyzerWaitResult HlsPublisher::OnSegmentWaitRequest(const ov::String &app_name,
+                                                        const ov::String &stream_name,
+                                                        const ov::String &file_name,
+                                                        const PacketyzerWaitCallback &callback)
+{
+    auto stream = std::static_pointer_cast<HlsStream>(GetStream(app_name, stream_name));
+
+    if(!stream)
+    {
+        return PacketyzerWaitResult::Available;
+    }
+
+    return stream->WaitSegment(file_name, callback);
+}
+
+//====================================================================================================
+// GetMasterPlayList
+// - a variant per rendition(ascending bandwidth), the media playlists are referred by ../<stream>/
+// - CMAF : video playlists of the renditions + audio playlist of the first rendition which has the audio
+// - TS : CODECS is omitted(the codec string of the TS segments is unknown)
+//====================================================================================================
+bool HlsPublisher::GetMasterPlayList(const ov::String &app_name,
+                                     const ov::String &stream_name,
+                                     std::shared_ptr<const PlayListSnapshot> &play_list)
+{
+    auto application = std::static_pointer_cast<HlsApplication>(GetApplicationByName(app_name));
+
+    if(application == nullptr)
+    {
+        logtw("Hls cannot find application (%s/%s/%s)", app_name.CStr(), stream_name.CStr(), HLS_MASTER_PLAY_LIST_FILE_NAME);
+        return false;
+    }
+
+    struct Variant
+    {
+        ov::String stream_name;
+        std::shared_ptr<MediaTrack> video_track;
+        std::shared_ptr<MediaTrack> audio_track;
+        std::string codecs;
+        bool cmaf;
+        int64_t bandwidth;
+    };
+
+    std::vector<Variant> variants;
+
+    for(const auto &item : application->GetRenditionStreams(stream_name))
+    {
+        auto stream = std::static_pointer_cast<HlsStream>(item);
+        Variant variant;
+
+        stream->GetSegmentTracks(variant.video_track, variant.audio_track);
+
+        if(variant.video_track == nullptr && variant.audio_track == nullptr)
+            continue;
+
+        variant.stream_name = stream->GetName();
+        variant.cmaf = stream->IsCmaf();
+        variant.codecs = variant.cmaf ? stream->GetVideoCodecString() : "";
+        variant.bandwidth = (variant.video_track != nullptr ? variant.video_track->GetBitrate() : 0) +
+                            (variant.audio_track != nullptr ? variant.audio_track->GetBitrate() : 0);
+
+        variants.push_back(variant);
+    }
+
+    if(variants.empty())
+    {
+        logtw("Hls cannot find stream (%s/%s/%s)", app_name.CStr(), stream_name.CStr(), HLS_MASTER_PLAY_LIST_FILE_NAME);
+        return false;
+    }
+
+    std::stable_sort(variants.begin(), variants.end(), [](const Variant &left, const Variant &right) {
+        return left.bandwidth < right.bandwidth;
+    });
+
+    // CMAF : audio rendition shared by the video variants
+    const Variant *audio = nullptr;
+
+    for(const auto &variant : variants)
+    {
+        if(variant.cmaf && variant.video_track != nullptr && variant.audio_track != nullptr)
+        {
+            audio = &variant;
+            break;
+        }
+    }
+
+    std::ostringstream play_list_stream;
+
+    play_list_stream << "#EXTM3U" << "\r\n"
+                     << "#EXT-X-VERSION:" << (audio != nullptr ? 7 : 3) << "\r\n"
+                     << "#EXT-X-INDEPENDENT-SEGMENTS" << "\r\n";
+
+    if(audio != nullptr)
+    {
+        play_list_stream << "#EXT-X-MEDIA:TYPE=AUDIO,GROUP-ID=\"audio\",NAME=\"audio\",DEFAULT=YES,AUTOSELECT=YES,URI=\"../"
+                         << audio->stream_name.CStr() << "/" << CMAF_HLS_AUDIO_PLAY_LIST_FILE_NAME << "\"\r\n";
+    }
+
+    for(const auto &variant : variants)
+    {
+        bool has_video = (variant.video_track != nullptr);
+
+        play_list_stream << "#EXT-X-STREAM-INF:BANDWIDTH=" << std::max<int64_t>(variant.bandwidth, 1);
+
+        if(variant.cmaf)
+        {
+            play_list_stream << ",CODECS=\"";
+
+            if(has_video)
+                play_list_stream << variant.codecs << ((audio != nullptr) ? "," : "");
+
+            if(audio != nullptr || !has_video)
+                play_list_stream << "mp4a.40.2";
+
+            play_list_stream << "\"";
+        }
+
+        if(has_video)
+        {
+            play_list_stream << ",RESOLUTION=" << variant.video_track->GetWidth() << "x" << variant.video_track->GetHeight();
+
+            if(variant.video_track->GetFrameRate() > 0)
+                play_list_stream << ",FRAME-RATE=" << std::fixed << std::setprecision(3) << variant.video_track->GetFrameRate();
+
+            if(variant.cmaf && audio != nullptr)
+                play_list_stream << ",AUDIO=\"audio\"";
+        }
+
+        play_list_stream << "\r\n" << "../" << variant.stream_name.CStr() << "/";
+
+        if(!variant.cmaf)
+            play_list_stream << HLS_PLAY_LIST_FILE_NAME;
+        else
+            play_list_stream << (has_video ? CMAF_HLS_VIDEO_PLAY_LIST_FILE_NAME : CMAF_HLS_AUDIO_PLAY_LIST_FILE_NAME);
+
+        play_list_stream << "\r\n";
+    }
+
+    ov::String content = play_list_stream.str().c_str();
+
+    play_list = Packetyzer::MakePlayListSnapshot(content,
+                                                 ov::String::FormatString("\"m-%zx\"", std::hash<std::string>()(play_list_stream.str())),
+                                                 static_cast<uint32_t>(std::max(application->GetSegmentDuration(), 0)));
+
+    return true;
+}
@@ -16,15 +16,20 @@
 #include "hls_stream_server.h"
 #include "hls_stream.h"
 
+// Multivariant playlist of the renditions of the same input(ex: http://host/app/stream/master.m3u8)
+#define HLS_MASTER_PLAY_LIST_FILE_NAME "master.m3u8"
+
 //====================================================================================================
 // HlsPublisher
 //====================================================================================================
 class HlsPublisher : public Publisher, public SegmentStreamObserver
 {
 public:
+    // vod_observer : packages the files of the VOD application, which is asked before the streams of the publisher
     static std::shared_ptr<HlsPublisher> Create(std::map<int, std::shared_ptr<HttpServer>> &http_server_manager,
                                                  const info::Application *application_info,
-                                                 std::shared_ptr<MediaRouteInterface> router);
+                                                 std::shared_ptr<MediaRouteInterface> router,
+                                                 const std::shared_ptr<SegmentStreamObserver> &vod_observer = nullptr);
 
     HlsPublisher(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
 
@@ -33,23 +38,44 @@ public:
 public :
     bool GetMonitoringCollectionData(std::vector<std::shared_ptr<MonitoringCollectionData>> &collections) override;
 
+    // Stops the stream server too (the application is deleted by the config reload)
+    bool Stop() override;
+
 private :
-    bool Start(std::map<int, std::shared_ptr<HttpServer>> &http_server_manager);
+    bool Start(std::map<int, std::shared_ptr<HttpServer>> &http_server_manager,
+               const std::shared_ptr<SegmentStreamObserver> &vod_observer);
 
     bool SupportedCodecCheck();
 
     std::shared_ptr<Application> OnCreateApplication(const info::Application *application_info) override;
 
+    // HLS_MASTER_PLAY_LIST_FILE_NAME(made per request from the streams of the renditions)
+    bool GetMasterPlayList(const ov::String &app_name,
+                           const ov::String &stream_name,
+                           std::shared_ptr<const PlayListSnapshot> &play_list);
+
     // SegmentStreamObserver Implementation
     bool OnPlayListRequest(const ov::String &app_name,
                            const ov::String &stream_name,
                            const ov::String &file_name,
-                           ov::String &play_list) override;
+                           std::shared_ptr<const PlayListSnapshot> &play_list) override;
 
     bool OnSegmentRequest(const ov::String &app_name,
                           const ov::String &stream_name,
                           const ov::String &file_name,
-                          std::shared_ptr<ov::Data> &segment_data) override;
+                          std::shared_ptr<SegmentData> &segment_data) override;
+
+    PacketyzerWaitResult OnPlayListWaitRequest(const ov::String &app_name,
+                                               const ov::String &stream_name,
+                                               const ov::String &file_name,
+                                               int64_t sequence_number,
+                                               int64_t part_index,
+                                               const PacketyzerWaitCallback &callback) override;
+
+    PacketyzerWaitResult OnSegmentWaitRequest(const ov::String &app_name,
+                                              const ov::String &stream_name,
+                                              const ov::String &file_name,
+                                              const PacketyzerWaitCallback &callback) override;
 
     // Publisher Implementation
     cfg::PublisherType GetPublisherType() override
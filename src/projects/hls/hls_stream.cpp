@@ -15,12 +15,31 @@
 //====================================================================================================
 std::shared_ptr<HlsStream> HlsStream::Create(int segment_count,
                                              int segment_duration,
+                                             uint32_t segment_tolerance,
+                                             uint32_t part_duration,
+                                             bool cmaf,
+                                             bool byte_range,
+                                             uint64_t segment_memory_limit,
+                                             const ov::String &dvr_path,
+                                             uint32_t dvr_duration,
+                                             bool thumbnail,
+                                             uint32_t thumbnail_width,
+                                             const std::shared_ptr<SegmentUploader> &uploader,
                                              const std::shared_ptr<Application> application,
                                              const StreamInfo &info,
                                              uint32_t worker_count)
 {
     auto stream = std::make_shared<HlsStream>(application, info);
 
+    stream->_part_duration = part_duration;
+    stream->_cmaf = cmaf;
+    stream->_byte_range = byte_range;
+    stream->SetSegmentMemoryLimit(segment_memory_limit);
+    stream->SetDvr(dvr_path, dvr_duration);
+    stream->SetThumbnail(thumbnail, thumbnail_width);
+    stream->SetUploader(uploader);
+    stream->SetSegmentTolerance(segment_tolerance);
+
     if (!stream->Start(segment_count, segment_duration, 0))
     {
         return nullptr;
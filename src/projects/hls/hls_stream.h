@@ -10,6 +10,7 @@
 #pragma once
 #include "segment_stream/segment_stream.h"
 #include "hls_stream_packetyzer.h"
+#include "hls_cmaf_stream_packetyzer.h"
 
 //====================================================================================================
 // HlsStream
@@ -19,6 +20,16 @@ class HlsStream : public SegmentStream
 public:
     static std::shared_ptr<HlsStream> Create(int segment_count,
                                              int segment_duration,
+                                             uint32_t segment_tolerance,
+                                             uint32_t part_duration,
+                                             bool cmaf,
+                                             bool byte_range,
+                                             uint64_t segment_memory_limit,
+                                             const ov::String &dvr_path,
+                                             uint32_t dvr_duration,
+                                             bool thumbnail,
+                                             uint32_t thumbnail_width,
+                                             const std::shared_ptr<SegmentUploader> &uploader,
                                              const std::shared_ptr<Application> application,
                                              const StreamInfo &info,
                                              uint32_t worker_count);
@@ -33,17 +44,41 @@ public:
                                                              PacketyzerStreamType stream_type,
                                                              PacketyzerMediaInfo media_info) override
     {
+        if (_cmaf)
+        {
+            // fMP4 segments shared with DASH
+            auto cmaf_stream_packetyzer = std::make_shared<HlsCmafStreamPacketyzer>(GetApplication()->GetName(),
+                                                                                    GetName(),
+                                                                                    GetId(),
+                                                                                    segment_count,
+                                                                                    segment_duration,
+                                                                                    segment_prefix,
+                                                                                    stream_type,
+                                                                                    media_info,
+                                                                                    _byte_range);
+
+            return std::static_pointer_cast<StreamPacketyzer>(cmaf_stream_packetyzer);
+        }
+
         auto stream_packetyzer = std::make_shared<HlsStreamPacketyzer>(GetApplication()->GetName(),
                                                                         GetName(),
                                                                         segment_count,
                                                                         segment_duration,
                                                                         segment_prefix,
                                                                         stream_type,
-                                                                        media_info);
+                                                                        media_info,
+                                                                        _part_duration);
 
         return std::static_pointer_cast<StreamPacketyzer>(stream_packetyzer);
     }
 
-private:
+    bool IsCmaf() const
+    {
+        return _cmaf;
+    }
 
+private:
+    uint32_t _part_duration = 0; // Low-Latency HLS(millisecond, 0 : disabled)
+    bool _cmaf = false; // fMP4(CMAF) segments
+    bool _byte_range = false; // EXT-X-BYTERANGE of the window files(CMAF)
 };
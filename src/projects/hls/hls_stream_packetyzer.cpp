@@ -19,7 +19,8 @@ HlsStreamPacketyzer::HlsStreamPacketyzer(const ov::String &app_name,
                                         int segment_duration,
                                         const ov::String &segment_prefix,
                                         PacketyzerStreamType stream_type,
-                                        PacketyzerMediaInfo media_info) :
+                                        PacketyzerMediaInfo media_info,
+                                        uint32_t part_duration) :
                                         StreamPacketyzer(app_name,
                                                         stream_name,
                                                         segment_count,
@@ -38,7 +39,8 @@ HlsStreamPacketyzer::HlsStreamPacketyzer(const ov::String &app_name,
                                                 segment_prefix,
                                                 segment_count,
                                                 segment_duration,
-                                                media_info);
+                                                media_info,
+                                                part_duration);
 }
 
 //====================================================================================================
@@ -68,16 +70,49 @@ bool HlsStreamPacketyzer::AppendAudioFrame(std::shared_ptr<PacketyzerFrameData>
 // Get PlayList
 // - M3U8
 //====================================================================================================
-bool HlsStreamPacketyzer::GetPlayList(ov::String &play_list)
+bool HlsStreamPacketyzer::GetPlayList(std::shared_ptr<const PlayListSnapshot> &play_list)
 {
     return _packetyzer->GetPlayList(play_list);
 }
 
+//====================================================================================================
+// Get PlayList
+// - playlist.m3u8/playlist_dvr.m3u8(DVR)
+//====================================================================================================
+bool HlsStreamPacketyzer::GetPlayList(const ov::String &file_name, std::shared_ptr<const PlayListSnapshot> &play_list)
+{
+    if (file_name == HLS_DVR_PLAY_LIST_FILE_NAME)
+        return std::static_pointer_cast<HlsPacketyzer>(_packetyzer)->GetDvrPlayList(play_list);
+
+    return _packetyzer->GetPlayList(play_list);
+}
+
 //====================================================================================================
 // GetSegment
 // - TS
 //====================================================================================================
-bool HlsStreamPacketyzer::GetSegment(const ov::String &segment_file_name, std::shared_ptr<ov::Data> &segment_data)
+bool HlsStreamPacketyzer::GetSegment(const ov::String &segment_file_name, std::shared_ptr<SegmentData> &segment_data)
 {
      return _packetyzer->GetSegmentData(segment_file_name, segment_data);
 }
+
+//====================================================================================================
+// WaitPlayList
+// - Low-Latency HLS blocking playlist reload
+//====================================================================================================
+PacketyzerWaitResult HlsStreamPacketyzer::WaitPlayList(int64_t sequence_number,
+                                                       int64_t part_index,
+                                                       const PacketyzerWaitCallback &callback)
+{
+    return std::static_pointer_cast<HlsPacketyzer>(_packetyzer)->WaitPlayList(sequence_number, part_index, callback);
+}
+
+//====================================================================================================
+// WaitSegment
+// - Low-Latency HLS preload hint
+//====================================================================================================
+PacketyzerWaitResult HlsStreamPacketyzer::WaitSegment(const ov::String &segment_file_name,
+                                                      const PacketyzerWaitCallback &callback)
+{
+    return std::static_pointer_cast<HlsPacketyzer>(_packetyzer)->WaitSegment(segment_file_name, callback);
+}
@@ -24,7 +24,8 @@ public:
                         int segment_duration,
                         const ov::String &segment_prefix,
                         PacketyzerStreamType stream_type,
-                        PacketyzerMediaInfo media_info);
+                        PacketyzerMediaInfo media_info,
+                        uint32_t part_duration = 0);
 
     virtual ~HlsStreamPacketyzer();
 
@@ -33,8 +34,11 @@ public :
     // Implement StreamPacketyzer Interface
     bool AppendVideoFrame(std::shared_ptr<PacketyzerFrameData> &data) override;
     bool AppendAudioFrame(std::shared_ptr<PacketyzerFrameData> &data) override;
-    bool GetPlayList(ov::String &play_list) override;
-    bool GetSegment(const ov::String &file_name, std::shared_ptr<ov::Data> &data) override;
+    bool GetPlayList(std::shared_ptr<const PlayListSnapshot> &play_list) override;
+    bool GetPlayList(const ov::String &file_name, std::shared_ptr<const PlayListSnapshot> &play_list) override;
+    bool GetSegment(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data) override;
+    PacketyzerWaitResult WaitPlayList(int64_t sequence_number, int64_t part_index, const PacketyzerWaitCallback &callback) override;
+    PacketyzerWaitResult WaitSegment(const ov::String &file_name, const PacketyzerWaitCallback &callback) override;
 
 private :
     //std::shared_ptr<HlsPacketyzer> _packetyzer = nullptr;
@@ -9,10 +9,13 @@
 
 #include "hls_stream_server.h"
 #include "hls_private.h"
+#include "segment_stream/segment_thumbnailer.h"
 
 #define SEGMENT_EXT "ts"
+#define CMAF_SEGMENT_EXT "m4s"
 #define PLAYLIST_EXT "m3u8"
 #define PLAYLIST_FILE_NAME "playlist.m3u8"
+#define THUMBNAIL_EXT "jpg"
 
 //====================================================================================================
 // ProcessRequest URL
@@ -26,7 +29,7 @@ void HlsStreamServer::ProcessRequestStream(const std::shared_ptr<HttpRequest> &r
 {
 
     // file extension check
-    if(file_ext != SEGMENT_EXT && file_ext != PLAYLIST_EXT)
+    if(file_ext != SEGMENT_EXT && file_ext != CMAF_SEGMENT_EXT && file_ext != PLAYLIST_EXT && file_ext != THUMBNAIL_EXT)
     {
         logtd("Request file extension fail - %s", file_ext.CStr());
         response->SetStatusCode(HttpStatusCode::NotFound);
@@ -34,10 +37,81 @@ void HlsStreamServer::ProcessRequestStream(const std::shared_ptr<HttpRequest> &r
     }
 
     // request dispatch
-    if (file_name == PLAYLIST_FILE_NAME)
-        PlayListRequest(app_name, stream_name, file_name, PlayListType::M3u8, response);
+    // - CMAF : playlist.m3u8(multivariant)/video.m3u8/audio.m3u8
+    if (file_ext == PLAYLIST_EXT)
+        PlayListRequest(app_name, stream_name, file_name, PlayListType::M3u8, request, response);
     else if (file_ext == SEGMENT_EXT)
-        SegmentRequest(app_name, stream_name, file_name, SegmentType::MpegTs, response);
+        SegmentRequest(app_name, stream_name, file_name, SegmentType::MpegTs, request, response);
+    else if (file_ext == CMAF_SEGMENT_EXT)
+        SegmentRequest(app_name, stream_name, file_name, SegmentType::M4S, request, response);
+    else if (file_name == THUMBNAIL_FILE_NAME)
+        SegmentRequest(app_name, stream_name, file_name, SegmentType::Thumbnail, request, response);
     else
         response->SetStatusCode(HttpStatusCode::NotFound);// Error Response
-}
\ No newline at end of file
+}
+
+//====================================================================================================
+// WaitRequest
+// - playlist.m3u8?_HLS_msn=[media sequence number]&_HLS_part=[part index]
+// - the preload hinted part is held until it is written
+// - request coalescing : the requests of the segment being made(or the playlist not ready yet) are held
+//====================================================================================================
+PacketyzerWaitResult HlsStreamServer::WaitRequest(const std::shared_ptr<HttpRequest> &request,
+                                                  const std::shared_ptr<HttpResponse> &response,
+                                                  const ov::String &app_name,
+                                                  const ov::String &stream_name,
+                                                  const ov::String &file_name,
+                                                  const ov::String &file_ext)
+{
+    auto callback = [this, request, response]()
+    {
+        ResumeRequest(request, response);
+    };
+
+    if (file_ext == SEGMENT_EXT || file_ext == CMAF_SEGMENT_EXT)
+    {
+        for (const auto &observer : _observers)
+        {
+            auto result = observer->OnSegmentWaitRequest(app_name, stream_name, file_name, callback);
+
+            if (result != PacketyzerWaitResult::Available)
+                return result;
+        }
+
+        return PacketyzerWaitResult::Available;
+    }
+
+    if (file_name != PLAYLIST_FILE_NAME)
+        return PacketyzerWaitResult::Available;
+
+    auto tokens = request->GetRequestTarget().Split("?");
+    int64_t sequence_number = -1;
+    int64_t part_index = -1;
+
+    for (const auto &param : (tokens.size() == 2) ? tokens[1].Split("&") : std::vector<ov::String>())
+    {
+        auto key_value = param.Split("=");
+
+        if (key_value.size() != 2)
+            continue;
+
+        if (key_value[0] == "_HLS_msn")
+            sequence_number = ov::Converter::ToInt64(key_value[1]);
+        else if (key_value[0] == "_HLS_part")
+            part_index = ov::Converter::ToInt64(key_value[1]);
+    }
+
+    // _HLS_part without _HLS_msn
+    if (sequence_number < 0 && part_index >= 0)
+        return PacketyzerWaitResult::Invalid;
+
+    for (const auto &observer : _observers)
+    {
+        auto result = observer->OnPlayListWaitRequest(app_name, stream_name, file_name, sequence_number, part_index, callback);
+
+        if (result != PacketyzerWaitResult::Available)
+            return result;
+    }
+
+    return PacketyzerWaitResult::Available;
+}
@@ -42,4 +42,11 @@ protected:
                            const ov::String &file_name,
                            const ov::String &file_ext) override;
 
+    // Low-Latency HLS blocking playlist reload(_HLS_msn/_HLS_part) and preload hint
+    PacketyzerWaitResult WaitRequest(const std::shared_ptr<HttpRequest> &request,
+                                     const std::shared_ptr<HttpResponse> &response,
+                                     const ov::String &app_name,
+                                     const ov::String &stream_name,
+                                     const ov::String &file_name,
+                                     const ov::String &file_ext) override;
 };
@@ -5,10 +5,12 @@ LOCAL_TARGET := http_server
 
 LOCAL_SOURCE_FILES := $(LOCAL_SOURCE_FILES) \
     $(call get_sub_source_list,interceptors) \
-    $(call get_sub_source_list,interceptors/**)
+    $(call get_sub_source_list,interceptors/**) \
+    $(call get_sub_source_list,http2)
 
 LOCAL_HEADER_FILES := $(LOCAL_HEADER_FILES) \
     $(call get_sub_header_list,interceptors) \
-    $(call get_sub_header_list,interceptors/**)
+    $(call get_sub_header_list,interceptors/**) \
+    $(call get_sub_header_list,http2)
 
 include $(BUILD_STATIC_LIBRARY)
@@ -0,0 +1,107 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+// 참고 자료
+// RFC7540 - Hypertext Transfer Protocol Version 2 (HTTP/2) (https://tools.ietf.org/html/rfc7540)
+// RFC7541 - HPACK: Header Compression for HTTP/2 (https://tools.ietf.org/html/rfc7541)
+
+// RFC7540 - 3.5. HTTP/2 Connection Preface
+#define HTTP2_CONNECTION_PREFACE				"PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"
+#define HTTP2_CONNECTION_PREFACE_LENGTH			(sizeof(HTTP2_CONNECTION_PREFACE) - 1)
+
+// RFC7540 - 4.1. Frame Format
+#define HTTP2_FRAME_HEADER_SIZE					9
+
+// RFC7540 - 6.5.2. Defined SETTINGS Parameters (the initial values)
+#define HTTP2_DEFAULT_HEADER_TABLE_SIZE			4096
+#define HTTP2_DEFAULT_WINDOW_SIZE				65535
+#define HTTP2_DEFAULT_MAX_FRAME_SIZE			16384
+#define HTTP2_MAX_MAX_FRAME_SIZE				16777215
+#define HTTP2_MAX_WINDOW_SIZE					0x7FFFFFFF
+
+// Settings of the server
+// - The requests over this are refused (RST_STREAM), the clients are expected to queue them
+#define HTTP2_MAX_CONCURRENT_STREAMS			100
+// - Size of the decoded header list of a request
+#define HTTP2_MAX_HEADER_LIST_SIZE				(64 * 1024)
+// - The window of the request bodies (the body is buffered until the end of the stream, OME doesn't expect a large body)
+#define HTTP2_INITIAL_WINDOW_SIZE				(1024 * 1024)
+// - The window of the connection, WINDOW_UPDATE is sent when a half of it is consumed
+#define HTTP2_CONNECTION_WINDOW_SIZE			(16 * 1024 * 1024)
+
+// RFC7540 - 6. Frame Definitions
+enum class Http2FrameType : uint8_t
+{
+	Data = 0x0,
+	Headers = 0x1,
+	Priority = 0x2,
+	RstStream = 0x3,
+	Settings = 0x4,
+	PushPromise = 0x5,
+	Ping = 0x6,
+	GoAway = 0x7,
+	WindowUpdate = 0x8,
+	Continuation = 0x9
+};
+
+// Flags of the frames
+#define HTTP2_FLAG_END_STREAM					0x01
+#define HTTP2_FLAG_ACK							0x01
+#define HTTP2_FLAG_END_HEADERS					0x04
+#define HTTP2_FLAG_PADDED						0x08
+#define HTTP2_FLAG_PRIORITY						0x20
+
+// RFC7540 - 6.5.2. Defined SETTINGS Parameters
+enum class Http2SettingsId : uint16_t
+{
+	HeaderTableSize = 0x1,
+	EnablePush = 0x2,
+	MaxConcurrentStreams = 0x3,
+	InitialWindowSize = 0x4,
+	MaxFrameSize = 0x5,
+	MaxHeaderListSize = 0x6
+};
+
+// RFC7540 - 7. Error Codes
+enum class Http2ErrorCode : uint32_t
+{
+	NoError = 0x0,
+	ProtocolError = 0x1,
+	InternalError = 0x2,
+	FlowControlError = 0x3,
+	SettingsTimeout = 0x4,
+	StreamClosed = 0x5,
+	FrameSizeError = 0x6,
+	RefusedStream = 0x7,
+	Cancel = 0x8,
+	CompressionError = 0x9,
+	ConnectError = 0xa,
+	EnhanceYourCalm = 0xb,
+	InadequateSecurity = 0xc,
+	Http11Required = 0xd
+};
+
+// A header field of HPACK (the names are lower case)
+struct Http2HeaderField
+{
+	Http2HeaderField() = default;
+
+	Http2HeaderField(const ov::String &name, const ov::String &value)
+		: name(name),
+		  value(value)
+	{
+	}
+
+	ov::String name;
+	ov::String value;
+};
+
+using Http2HeaderList = std::vector<Http2HeaderField>;
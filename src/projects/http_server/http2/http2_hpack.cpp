@@ -0,0 +1,729 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "http2_hpack.h"
+#include "../http_private.h"
+
+// The length of the integers which are longer than this is regarded as an error (RFC7541 - 5.1)
+#define HPACK_MAX_INTEGER_SHIFT			28
+// RFC7541 - 5.2. The padding of the Huffman code is the most significant bits of EOS (up to 7 bits)
+#define HPACK_HUFFMAN_EOS				256
+#define HPACK_HUFFMAN_MAX_CODE_LENGTH	30
+
+namespace
+{
+	// RFC7541 - Appendix A. Static Table Definition
+	const Http2HeaderField kStaticTable[] = {
+		{":authority", ""},
+		{":method", "GET"},
+		{":method", "POST"},
+		{":path", "/"},
+		{":path", "/index.html"},
+		{":scheme", "http"},
+		{":scheme", "https"},
+		{":status", "200"},
+		{":status", "204"},
+		{":status", "206"},
+		{":status", "304"},
+		{":status", "400"},
+		{":status", "404"},
+		{":status", "500"},
+		{"accept-charset", ""},
+		{"accept-encoding", "gzip, deflate"},
+		{"accept-language", ""},
+		{"accept-ranges", ""},
+		{"accept", ""},
+		{"access-control-allow-origin", ""},
+		{"age", ""},
+		{"allow", ""},
+		{"authorization", ""},
+		{"cache-control", ""},
+		{"content-disposition", ""},
+		{"content-encoding", ""},
+		{"content-language", ""},
+		{"content-length", ""},
+		{"content-location", ""},
+		{"content-range", ""},
+		{"content-type", ""},
+		{"cookie", ""},
+		{"date", ""},
+		{"etag", ""},
+		{"expect", ""},
+		{"expires", ""},
+		{"from", ""},
+		{"host", ""},
+		{"if-match", ""},
+		{"if-modified-since", ""},
+		{"if-none-match", ""},
+		{"if-range", ""},
+		{"if-unmodified-since", ""},
+		{"last-modified", ""},
+		{"link", ""},
+		{"location", ""},
+		{"max-forwards", ""},
+		{"proxy-authenticate", ""},
+		{"proxy-authorization", ""},
+		{"range", ""},
+		{"referer", ""},
+		{"refresh", ""},
+		{"retry-after", ""},
+		{"server", ""},
+		{"set-cookie", ""},
+		{"strict-transport-security", ""},
+		{"transfer-encoding", ""},
+		{"user-agent", ""},
+		{"vary", ""},
+		{"via", ""},
+		{"www-authenticate", ""}
+	};
+
+	constexpr const size_t kStaticTableSize = OV_COUNTOF(kStaticTable);
+
+	// RFC7541 - Appendix B. Huffman Code (code aligned to LSB, length in bits)
+	struct HuffmanCode
+	{
+		uint32_t code;
+		uint8_t length;
+	};
+
+	const HuffmanCode kHuffmanCodes[HPACK_HUFFMAN_EOS + 1] = {
+	{0x1ff8, 13}, {0x7fffd8, 23}, {0xfffffe2, 28}, {0xfffffe3, 28},
+	{0xfffffe4, 28}, {0xfffffe5, 28}, {0xfffffe6, 28}, {0xfffffe7, 28},
+	{0xfffffe8, 28}, {0xffffea, 24}, {0x3ffffffc, 30}, {0xfffffe9, 28},
+	{0xfffffea, 28}, {0x3ffffffd, 30}, {0xfffffeb, 28}, {0xfffffec, 28},
+	{0xfffffed, 28}, {0xfffffee, 28}, {0xfffffef, 28}, {0xffffff0, 28},
+	{0xffffff1, 28}, {0xffffff2, 28}, {0x3ffffffe, 30}, {0xffffff3, 28},
+	{0xffffff4, 28}, {0xffffff5, 28}, {0xffffff6, 28}, {0xffffff7, 28},
+	{0xffffff8, 28}, {0xffffff9, 28}, {0xffffffa, 28}, {0xffffffb, 28},
+	{0x14, 6}, {0x3f8, 10}, {0x3f9, 10}, {0xffa, 12},
+	{0x1ff9, 13}, {0x15, 6}, {0xf8, 8}, {0x7fa, 11},
+	{0x3fa, 10}, {0x3fb, 10}, {0xf9, 8}, {0x7fb, 11},
+	{0xfa, 8}, {0x16, 6}, {0x17, 6}, {0x18, 6},
+	{0x0, 5}, {0x1, 5}, {0x2, 5}, {0x19, 6},
+	{0x1a, 6}, {0x1b, 6}, {0x1c, 6}, {0x1d, 6},
+	{0x1e, 6}, {0x1f, 6}, {0x5c, 7}, {0xfb, 8},
+	{0x7ffc, 15}, {0x20, 6}, {0xffb, 12}, {0x3fc, 10},
+	{0x1ffa, 13}, {0x21, 6}, {0x5d, 7}, {0x5e, 7},
+	{0x5f, 7}, {0x60, 7}, {0x61, 7}, {0x62, 7},
+	{0x63, 7}, {0x64, 7}, {0x65, 7}, {0x66, 7},
+	{0x67, 7}, {0x68, 7}, {0x69, 7}, {0x6a, 7},
+	{0x6b, 7}, {0x6c, 7}, {0x6d, 7}, {0x6e, 7},
+	{0x6f, 7}, {0x70, 7}, {0x71, 7}, {0x72, 7},
+	{0xfc, 8}, {0x73, 7}, {0xfd, 8}, {0x1ffb, 13},
+	{0x7fff0, 19}, {0x1ffc, 13}, {0x3ffc, 14}, {0x22, 6},
+	{0x7ffd, 15}, {0x3, 5}, {0x23, 6}, {0x4, 5},
+	{0x24, 6}, {0x5, 5}, {0x25, 6}, {0x26, 6},
+	{0x27, 6}, {0x6, 5}, {0x74, 7}, {0x75, 7},
+	{0x28, 6}, {0x29, 6}, {0x2a, 6}, {0x7, 5},
+	{0x2b, 6}, {0x76, 7}, {0x2c, 6}, {0x8, 5},
+	{0x9, 5}, {0x2d, 6}, {0x77, 7}, {0x78, 7},
+	{0x79, 7}, {0x7a, 7}, {0x7b, 7}, {0x7ffe, 15},
+	{0x7fc, 11}, {0x3ffd, 14}, {0x1ffd, 13}, {0xffffffc, 28},
+	{0xfffe6, 20}, {0x3fffd2, 22}, {0xfffe7, 20}, {0xfffe8, 20},
+	{0x3fffd3, 22}, {0x3fffd4, 22}, {0x3fffd5, 22}, {0x7fffd9, 23},
+	{0x3fffd6, 22}, {0x7fffda, 23}, {0x7fffdb, 23}, {0x7fffdc, 23},
+	{0x7fffdd, 23}, {0x7fffde, 23}, {0xffffeb, 24}, {0x7fffdf, 23},
+	{0xffffec, 24}, {0xffffed, 24}, {0x3fffd7, 22}, {0x7fffe0, 23},
+	{0xffffee, 24}, {0x7fffe1, 23}, {0x7fffe2, 23}, {0x7fffe3, 23},
+	{0x7fffe4, 23}, {0x1fffdc, 21}, {0x3fffd8, 22}, {0x7fffe5, 23},
+	{0x3fffd9, 22}, {0x7fffe6, 23}, {0x7fffe7, 23}, {0xffffef, 24},
+	{0x3fffda, 22}, {0x1fffdd, 21}, {0xfffe9, 20}, {0x3fffdb, 22},
+	{0x3fffdc, 22}, {0x7fffe8, 23}, {0x7fffe9, 23}, {0x1fffde, 21},
+	{0x7fffea, 23}, {0x3fffdd, 22}, {0x3fffde, 22}, {0xfffff0, 24},
+	{0x1fffdf, 21}, {0x3fffdf, 22}, {0x7fffeb, 23}, {0x7fffec, 23},
+	{0x1fffe0, 21}, {0x1fffe1, 21}, {0x3fffe0, 22}, {0x1fffe2, 21},
+	{0x7fffed, 23}, {0x3fffe1, 22}, {0x7fffee, 23}, {0x7fffef, 23},
+	{0xfffea, 20}, {0x3fffe2, 22}, {0x3fffe3, 22}, {0x3fffe4, 22},
+	{0x7ffff0, 23}, {0x3fffe5, 22}, {0x3fffe6, 22}, {0x7ffff1, 23},
+	{0x3ffffe0, 26}, {0x3ffffe1, 26}, {0xfffeb, 20}, {0x7fff1, 19},
+	{0x3fffe7, 22}, {0x7ffff2, 23}, {0x3fffe8, 22}, {0x1ffffec, 25},
+	{0x3ffffe2, 26}, {0x3ffffe3, 26}, {0x3ffffe4, 26}, {0x7ffffde, 27},
+	{0x7ffffdf, 27}, {0x3ffffe5, 26}, {0xfffff1, 24}, {0x1ffffed, 25},
+	{0x7fff2, 19}, {0x1fffe3, 21}, {0x3ffffe6, 26}, {0x7ffffe0, 27},
+	{0x7ffffe1, 27}, {0x3ffffe7, 26}, {0x7ffffe2, 27}, {0xfffff2, 24},
+	{0x1fffe4, 21}, {0x1fffe5, 21}, {0x3ffffe8, 26}, {0x3ffffe9, 26},
+	{0xffffffd, 28}, {0x7ffffe3, 27}, {0x7ffffe4, 27}, {0x7ffffe5, 27},
+	{0xfffec, 20}, {0xfffff3, 24}, {0xfffed, 20}, {0x1fffe6, 21},
+	{0x3fffe9, 22}, {0x1fffe7, 21}, {0x1fffe8, 21}, {0x7ffff3, 23},
+	{0x3fffea, 22}, {0x3fffeb, 22}, {0x1ffffee, 25}, {0x1ffffef, 25},
+	{0xfffff4, 24}, {0xfffff5, 24}, {0x3ffffea, 26}, {0x7ffff4, 23},
+	{0x3ffffeb, 26}, {0x7ffffe6, 27}, {0x3ffffec, 26}, {0x3ffffed, 26},
+	{0x7ffffe7, 27}, {0x7ffffe8, 27}, {0x7ffffe9, 27}, {0x7ffffea, 27},
+	{0x7ffffeb, 27}, {0xffffffe, 28}, {0x7ffffec, 27}, {0x7ffffed, 27},
+	{0x7ffffee, 27}, {0x7ffffef, 27}, {0x7fffff0, 27}, {0x3ffffee, 26},
+	{0x3fffffff, 30},
+	};
+
+	// The code is canonical (sorted by the length, and by the symbol), so it is decoded by the first code of each length
+	struct HuffmanDecodeTable
+	{
+		HuffmanDecodeTable()
+		{
+			uint16_t symbols_of_length[HPACK_HUFFMAN_MAX_CODE_LENGTH + 1] {};
+
+			for(const auto &code : kHuffmanCodes)
+			{
+				symbols_of_length[code.length]++;
+			}
+
+			size_t offset = 0;
+
+			for(int length = 1; length <= HPACK_HUFFMAN_MAX_CODE_LENGTH; length++)
+			{
+				offset_of_length[length] = offset;
+				count_of_length[length] = symbols_of_length[length];
+				offset += symbols_of_length[length];
+			}
+
+			// The symbols in the order of the codes
+			size_t index_of_length[HPACK_HUFFMAN_MAX_CODE_LENGTH + 1] {};
+
+			for(uint16_t symbol = 0; symbol <= HPACK_HUFFMAN_EOS; symbol++)
+			{
+				int length = kHuffmanCodes[symbol].length;
+
+				if(count_of_length[length] > 0 && index_of_length[length] == 0)
+				{
+					first_code_of_length[length] = kHuffmanCodes[symbol].code;
+				}
+
+				symbols[offset_of_length[length] + index_of_length[length]] = symbol;
+				index_of_length[length]++;
+			}
+		}
+
+		uint32_t first_code_of_length[HPACK_HUFFMAN_MAX_CODE_LENGTH + 1] {};
+		size_t count_of_length[HPACK_HUFFMAN_MAX_CODE_LENGTH + 1] {};
+		size_t offset_of_length[HPACK_HUFFMAN_MAX_CODE_LENGTH + 1] {};
+		uint16_t symbols[HPACK_HUFFMAN_EOS + 1] {};
+	};
+
+	const HuffmanDecodeTable &GetHuffmanDecodeTable()
+	{
+		static const HuffmanDecodeTable table;
+
+		return table;
+	}
+
+	bool HuffmanDecode(const uint8_t *data, size_t length, ov::String &string)
+	{
+		const auto &table = GetHuffmanDecodeTable();
+
+		ov::String decoded;
+		decoded.SetCapacity(length * 8 / 5 + 1);
+
+		uint32_t code = 0;
+		int code_length = 0;
+
+		for(size_t index = 0; index < length; index++)
+		{
+			for(int bit = 7; bit >= 0; bit--)
+			{
+				code = (code << 1) | ((data[index] >> bit) & 0x01);
+				code_length++;
+
+				if(code_length > HPACK_HUFFMAN_MAX_CODE_LENGTH)
+				{
+					return false;
+				}
+
+				uint32_t distance = code - table.first_code_of_length[code_length];
+
+				if((table.count_of_length[code_length] > 0) && (code >= table.first_code_of_length[code_length]) && (distance < table.count_of_length[code_length]))
+				{
+					uint16_t symbol = table.symbols[table.offset_of_length[code_length] + distance];
+
+					if(symbol == HPACK_HUFFMAN_EOS)
+					{
+						// RFC7541 - 5.2. A Huffman-encoded string literal containing the EOS symbol MUST be treated as a decoding error
+						return false;
+					}
+
+					decoded.Append(static_cast<char>(symbol));
+
+					code = 0;
+					code_length = 0;
+				}
+			}
+		}
+
+		// The padding must be shorter than 8 bits, and be the most significant bits of EOS (all 1)
+		if((code_length > 7) || (code != ((1U << code_length) - 1)))
+		{
+			return false;
+		}
+
+		string = std::move(decoded);
+
+		return true;
+	}
+
+	size_t GetHuffmanLength(const ov::String &string)
+	{
+		size_t bits = 0;
+
+		for(size_t index = 0; index < string.GetLength(); index++)
+		{
+			bits += kHuffmanCodes[static_cast<uint8_t>(string[index])].length;
+		}
+
+		return (bits + 7) / 8;
+	}
+
+	void HuffmanEncode(const ov::String &string, ov::Data *output)
+	{
+		uint64_t bits = 0;
+		int bit_count = 0;
+
+		for(size_t index = 0; index < string.GetLength(); index++)
+		{
+			const auto &code = kHuffmanCodes[static_cast<uint8_t>(string[index])];
+
+			bits = (bits << code.length) | code.code;
+			bit_count += code.length;
+
+			while(bit_count >= 8)
+			{
+				bit_count -= 8;
+
+				uint8_t byte = static_cast<uint8_t>(bits >> bit_count);
+				output->Append(&byte, 1);
+			}
+		}
+
+		if(bit_count > 0)
+		{
+			// Padded with the most significant bits of EOS
+			uint8_t byte = static_cast<uint8_t>((bits << (8 - bit_count)) | (0xFF >> bit_count));
+			output->Append(&byte, 1);
+		}
+	}
+
+	// RFC7541 - 5.1. Integer Representation
+	bool DecodeInteger(const uint8_t *data, size_t length, size_t &offset, int prefix_bits, size_t &value)
+	{
+		if(offset >= length)
+		{
+			return false;
+		}
+
+		size_t max_prefix = (1U << prefix_bits) - 1;
+
+		value = data[offset] & max_prefix;
+		offset++;
+
+		if(value < max_prefix)
+		{
+			return true;
+		}
+
+		int shift = 0;
+
+		while(offset < length)
+		{
+			uint8_t byte = data[offset];
+			offset++;
+
+			value += static_cast<size_t>(byte & 0x7F) << shift;
+
+			if((byte & 0x80) == 0)
+			{
+				return true;
+			}
+
+			shift += 7;
+
+			if(shift > HPACK_MAX_INTEGER_SHIFT)
+			{
+				return false;
+			}
+		}
+
+		return false;
+	}
+
+	void EncodeInteger(uint8_t first_byte, int prefix_bits, size_t value, ov::Data *output)
+	{
+		size_t max_prefix = (1U << prefix_bits) - 1;
+
+		if(value < max_prefix)
+		{
+			uint8_t byte = static_cast<uint8_t>(first_byte | value);
+			output->Append(&byte, 1);
+			return;
+		}
+
+		uint8_t byte = static_cast<uint8_t>(first_byte | max_prefix);
+		output->Append(&byte, 1);
+
+		value -= max_prefix;
+
+		while(value >= 0x80)
+		{
+			byte = static_cast<uint8_t>((value & 0x7F) | 0x80);
+			output->Append(&byte, 1);
+			value >>= 7;
+		}
+
+		byte = static_cast<uint8_t>(value);
+		output->Append(&byte, 1);
+	}
+
+	// RFC7541 - 5.2. String Literal Representation
+	bool DecodeString(const uint8_t *data, size_t length, size_t &offset, ov::String &string)
+	{
+		if(offset >= length)
+		{
+			return false;
+		}
+
+		bool is_huffman = (data[offset] & 0x80) != 0;
+		size_t string_length;
+
+		if((DecodeInteger(data, length, offset, 7, string_length) == false) || (string_length > (length - offset)))
+		{
+			return false;
+		}
+
+		const uint8_t *string_data = data + offset;
+		offset += string_length;
+
+		if(is_huffman)
+		{
+			return HuffmanDecode(string_data, string_length, string);
+		}
+
+		string = ov::String(reinterpret_cast<const char *>(string_data), string_length);
+
+		return true;
+	}
+
+	void EncodeString(const ov::String &string, ov::Data *output)
+	{
+		size_t huffman_length = GetHuffmanLength(string);
+
+		if(huffman_length < string.GetLength())
+		{
+			EncodeInteger(0x80, 7, huffman_length, output);
+			HuffmanEncode(string, output);
+		}
+		else
+		{
+			EncodeInteger(0x00, 7, string.GetLength(), output);
+			output->Append(string.CStr(), string.GetLength());
+		}
+	}
+
+	// The values which are different for each response, there is no gain to index them
+	bool IsIndexable(const ov::String &name)
+	{
+		return (name != "content-length") && (name != "content-range") && (name != "date") && (name != "etag") &&
+			   (name != "last-modified") && (name != "age") && (name != "set-cookie") && (name != "expires");
+	}
+}
+
+//====================================================================================================
+// Http2HpackTable
+//====================================================================================================
+Http2HpackTable::Http2HpackTable(size_t max_size)
+	: _max_size(max_size)
+{
+}
+
+void Http2HpackTable::Add(const Http2HeaderField &field)
+{
+	size_t entry_size = GetEntrySize(field);
+
+	if(entry_size > _max_size)
+	{
+		// RFC7541 - 4.4. an attempt to add an entry larger than the maximum size causes the table to be emptied
+		Evict(0);
+		return;
+	}
+
+	Evict(_max_size - entry_size);
+
+	_entries.push_front(field);
+	_size += entry_size;
+}
+
+void Http2HpackTable::SetMaxSize(size_t max_size)
+{
+	_max_size = max_size;
+
+	Evict(max_size);
+}
+
+void Http2HpackTable::Evict(size_t max_size)
+{
+	while((_size > max_size) && (_entries.empty() == false))
+	{
+		_size -= GetEntrySize(_entries.back());
+		_entries.pop_back();
+	}
+}
+
+const Http2HeaderField *Http2HpackTable::Get(size_t index) const
+{
+	if(index >= _entries.size())
+	{
+		return nullptr;
+	}
+
+	return &(_entries[index]);
+}
+
+ssize_t Http2HpackTable::Find(const Http2HeaderField &field, ssize_t &name_index) const
+{
+	name_index = -1;
+
+	for(size_t index = 0; index < _entries.size(); index++)
+	{
+		auto &entry = _entries[index];
+
+		if(entry.name == field.name)
+		{
+			if(entry.value == field.value)
+			{
+				return static_cast<ssize_t>(index);
+			}
+
+			if(name_index < 0)
+			{
+				name_index = static_cast<ssize_t>(index);
+			}
+		}
+	}
+
+	return -1;
+}
+
+//====================================================================================================
+// Http2HpackDecoder
+//====================================================================================================
+Http2HpackDecoder::Http2HpackDecoder(size_t max_table_size)
+	: _max_table_size(max_table_size),
+	  _table(max_table_size)
+{
+}
+
+// index: 1 ~ (static table), (static table + 1) ~ (dynamic table)
+const Http2HeaderField *Http2HpackDecoder::GetField(size_t index) const
+{
+	if(index == 0)
+	{
+		return nullptr;
+	}
+
+	if(index <= kStaticTableSize)
+	{
+		return &(kStaticTable[index - 1]);
+	}
+
+	return _table.Get(index - kStaticTableSize - 1);
+}
+
+bool Http2HpackDecoder::Decode(const uint8_t *data, size_t length, size_t max_header_list_size, Http2HeaderList &header_list)
+{
+	size_t offset = 0;
+	size_t header_list_size = 0;
+	bool is_field_decoded = false;
+
+	while(offset < length)
+	{
+		uint8_t byte = data[offset];
+		Http2HeaderField field;
+
+		if(byte & 0x80)
+		{
+			// RFC7541 - 6.1. Indexed Header Field Representation
+			size_t index;
+
+			if(DecodeInteger(data, length, offset, 7, index) == false)
+			{
+				return false;
+			}
+
+			auto indexed_field = GetField(index);
+
+			if(indexed_field == nullptr)
+			{
+				logtd("Invalid index of HPACK: %zu", index);
+				return false;
+			}
+
+			field = *indexed_field;
+		}
+		else if((byte & 0xE0) == 0x20)
+		{
+			// RFC7541 - 6.3. Dynamic Table Size Update (must be at the beginning of the block)
+			size_t max_size;
+
+			if(is_field_decoded || (DecodeInteger(data, length, offset, 5, max_size) == false) || (max_size > _max_table_size))
+			{
+				return false;
+			}
+
+			_table.SetMaxSize(max_size);
+			continue;
+		}
+		else
+		{
+			// RFC7541 - 6.2. Literal Header Field Representation
+			//   01xxxxxx: with incremental indexing
+			//   0000xxxx: without indexing
+			//   0001xxxx: never indexed
+			bool is_indexing = (byte & 0xC0) == 0x40;
+			size_t name_index;
+
+			if(DecodeInteger(data, length, offset, is_indexing ? 6 : 4, name_index) == false)
+			{
+				return false;
+			}
+
+			if(name_index > 0)
+			{
+				auto indexed_field = GetField(name_index);
+
+				if(indexed_field == nullptr)
+				{
+					logtd("Invalid name index of HPACK: %zu", name_index);
+					return false;
+				}
+
+				field.name = indexed_field->name;
+			}
+			else if(DecodeString(data, length, offset, field.name) == false)
+			{
+				return false;
+			}
+
+			if(DecodeString(data, length, offset, field.value) == false)
+			{
+				return false;
+			}
+
+			if(is_indexing)
+			{
+				_table.Add(field);
+			}
+		}
+
+		is_field_decoded = true;
+
+		// RFC7540 - 6.5.2. SETTINGS_MAX_HEADER_LIST_SIZE
+		header_list_size += Http2HpackTable::GetEntrySize(field);
+
+		if(header_list_size > max_header_list_size)
+		{
+			logtd("The header list is too large: %zu bytes", header_list_size);
+			return false;
+		}
+
+		header_list.push_back(std::move(field));
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// Http2HpackEncoder
+//====================================================================================================
+void Http2HpackEncoder::SetMaxTableSize(size_t max_table_size)
+{
+	max_table_size = std::min<size_t>(max_table_size, HTTP2_DEFAULT_HEADER_TABLE_SIZE);
+
+	if(max_table_size == _table.GetMaxSize())
+	{
+		return;
+	}
+
+	_min_table_size = _is_table_size_changed ? std::min(_min_table_size, max_table_size) : std::min(_table.GetMaxSize(), max_table_size);
+	_is_table_size_changed = true;
+
+	_table.SetMaxSize(max_table_size);
+}
+
+void Http2HpackEncoder::Encode(const Http2HeaderList &header_list, ov::Data *output)
+{
+	if(_is_table_size_changed)
+	{
+		// RFC7541 - 4.2. the smallest maximum table size that occurs in that interval MUST be signaled
+		if(_min_table_size < _table.GetMaxSize())
+		{
+			EncodeInteger(0x20, 5, _min_table_size, output);
+		}
+
+		EncodeInteger(0x20, 5, _table.GetMaxSize(), output);
+
+		_is_table_size_changed = false;
+	}
+
+	for(const auto &field : header_list)
+	{
+		size_t name_index = 0;
+		ssize_t dynamic_name_index;
+		ssize_t dynamic_index = _table.Find(field, dynamic_name_index);
+
+		if(dynamic_index >= 0)
+		{
+			// Indexed (dynamic table)
+			EncodeInteger(0x80, 7, kStaticTableSize + 1 + dynamic_index, output);
+			continue;
+		}
+
+		bool is_indexed = false;
+
+		for(size_t index = 0; index < kStaticTableSize; index++)
+		{
+			if(kStaticTable[index].name == field.name)
+			{
+				if(kStaticTable[index].value == field.value)
+				{
+					// Indexed (static table)
+					EncodeInteger(0x80, 7, index + 1, output);
+					is_indexed = true;
+					break;
+				}
+
+				if(name_index == 0)
+				{
+					name_index = index + 1;
+				}
+			}
+		}
+
+		if(is_indexed)
+		{
+			continue;
+		}
+
+		if((name_index == 0) && (dynamic_name_index >= 0))
+		{
+			name_index = kStaticTableSize + 1 + dynamic_name_index;
+		}
+
+		if(IsIndexable(field.name))
+		{
+			// Literal with incremental indexing
+			EncodeInteger(0x40, 6, name_index, output);
+			_table.Add(field);
+		}
+		else
+		{
+			// Literal without indexing
+			EncodeInteger(0x00, 4, name_index, output);
+		}
+
+		if(name_index == 0)
+		{
+			EncodeString(field.name, output);
+		}
+
+		EncodeString(field.value, output);
+	}
+}
@@ -0,0 +1,92 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "http2_datastructure.h"
+
+#include <deque>
+
+// RFC7541 - 2.3.2. Dynamic Table
+// - The dynamic table of a direction of a connection (the newest entry is the first one)
+class Http2HpackTable
+{
+public:
+	explicit Http2HpackTable(size_t max_size = HTTP2_DEFAULT_HEADER_TABLE_SIZE);
+
+	// RFC7541 - 4.1. Calculating Table Size (name + value + 32)
+	static size_t GetEntrySize(const Http2HeaderField &field)
+	{
+		return field.name.GetLength() + field.value.GetLength() + 32;
+	}
+
+	// RFC7541 - 4.4. Entry Eviction When Adding New Entries
+	// - The table becomes empty if the entry is larger than the maximum size
+	void Add(const Http2HeaderField &field);
+
+	// RFC7541 - 4.3. Entry Eviction When Dynamic Table Size Changes
+	void SetMaxSize(size_t max_size);
+
+	size_t GetMaxSize() const
+	{
+		return _max_size;
+	}
+
+	// index: 0 is the newest entry
+	const Http2HeaderField *Get(size_t index) const;
+
+	// index of the field (-1: not found), name_index: index of the name only (-1: not found)
+	ssize_t Find(const Http2HeaderField &field, ssize_t &name_index) const;
+
+protected:
+	void Evict(size_t max_size);
+
+	std::deque<Http2HeaderField> _entries;
+	size_t _size = 0;
+	size_t _max_size;
+};
+
+// Decodes the header blocks of the requests
+// - The header block must be decoded in the order of receiving even if the stream is reset (the dynamic table is shared)
+class Http2HpackDecoder
+{
+public:
+	// max_table_size: SETTINGS_HEADER_TABLE_SIZE of the server
+	explicit Http2HpackDecoder(size_t max_table_size = HTTP2_DEFAULT_HEADER_TABLE_SIZE);
+
+	// Decodes a header block (the fragments of HEADERS + CONTINUATION)
+	// @return false if the block is not decodable (COMPRESSION_ERROR), or the list exceeds max_header_list_size
+	bool Decode(const uint8_t *data, size_t length, size_t max_header_list_size, Http2HeaderList &header_list);
+
+protected:
+	const Http2HeaderField *GetField(size_t index) const;
+
+	size_t _max_table_size;
+	Http2HpackTable _table;
+};
+
+// Encodes the header blocks of the responses
+// - The fields are indexed if possible, and the strings are Huffman coded if it is shorter
+// - The values which are different for each response (e.g. content-length) are not added to the dynamic table
+class Http2HpackEncoder
+{
+public:
+	Http2HpackEncoder() = default;
+
+	// SETTINGS_HEADER_TABLE_SIZE of the client (the table of the encoder doesn't exceed HTTP2_DEFAULT_HEADER_TABLE_SIZE)
+	// - The change is signaled at the beginning of the next header block
+	void SetMaxTableSize(size_t max_table_size);
+
+	void Encode(const Http2HeaderList &header_list, ov::Data *output);
+
+protected:
+	Http2HpackTable _table;
+
+	bool _is_table_size_changed = false;
+	// The smallest size since the last header block (RFC7541 - 4.2. Maximum Table Size)
+	size_t _min_table_size = HTTP2_DEFAULT_HEADER_TABLE_SIZE;
+};
@@ -0,0 +1,1248 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "http2_session.h"
+#include "../http_request.h"
+#include "../http_response.h"
+#include "../http_private.h"
+
+namespace
+{
+	inline uint32_t ReadUint32(const uint8_t *buffer)
+	{
+		return (static_cast<uint32_t>(buffer[0]) << 24) | (static_cast<uint32_t>(buffer[1]) << 16) | (static_cast<uint32_t>(buffer[2]) << 8) | buffer[3];
+	}
+
+	inline void WriteUint32(uint8_t *buffer, uint32_t value)
+	{
+		buffer[0] = static_cast<uint8_t>(value >> 24);
+		buffer[1] = static_cast<uint8_t>(value >> 16);
+		buffer[2] = static_cast<uint8_t>(value >> 8);
+		buffer[3] = static_cast<uint8_t>(value);
+	}
+
+	inline void WriteSetting(uint8_t *buffer, Http2SettingsId id, uint32_t value)
+	{
+		buffer[0] = static_cast<uint8_t>(static_cast<uint16_t>(id) >> 8);
+		buffer[1] = static_cast<uint8_t>(id);
+		WriteUint32(buffer + 2, value);
+	}
+
+	// RFC7540 - 8.1.2.2. Connection-Specific Header Fields
+	bool IsConnectionSpecificHeader(const ov::String &name)
+	{
+		return (name == "connection") || (name == "keep-alive") || (name == "proxy-connection") || (name == "transfer-encoding") || (name == "upgrade");
+	}
+
+	// RFC7540 - 8.1.2. the names must be lower case, and the fields must not have CR/LF/NUL (the request is converted to HTTP/1.1)
+	bool IsValidHeaderField(const Http2HeaderField &field)
+	{
+		if(field.name.IsEmpty())
+		{
+			return false;
+		}
+
+		for(size_t index = 0; index < field.name.GetLength(); index++)
+		{
+			char c = field.name[index];
+
+			if(((c >= 'A') && (c <= 'Z')) || (c == '\r') || (c == '\n') || (c == '\0') || (c == ' ') || ((c == ':') && (index > 0)))
+			{
+				return false;
+			}
+		}
+
+		for(size_t index = 0; index < field.value.GetLength(); index++)
+		{
+			char c = field.value[index];
+
+			if((c == '\r') || (c == '\n') || (c == '\0'))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+Http2Session::Http2Session(const std::shared_ptr<ov::ClientSocket> &remote, const std::shared_ptr<ov::Tls> &tls,
+						   const std::shared_ptr<HttpRequestInterceptor> &default_interceptor, RequestHandler request_handler)
+	: _remote(remote),
+	  _default_interceptor(default_interceptor),
+	  _request_handler(std::move(request_handler)),
+	  _hpack_decoder(HTTP2_DEFAULT_HEADER_TABLE_SIZE),
+	  _tls(tls)
+{
+	OV_ASSERT2(_remote != nullptr);
+}
+
+bool Http2Session::Start()
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	// RFC7540 - 3.5. The server connection preface consists of a SETTINGS frame
+	uint8_t settings[6 * 4];
+
+	WriteSetting(settings, Http2SettingsId::EnablePush, 0);
+	WriteSetting(settings + 6, Http2SettingsId::MaxConcurrentStreams, HTTP2_MAX_CONCURRENT_STREAMS);
+	WriteSetting(settings + 12, Http2SettingsId::InitialWindowSize, HTTP2_INITIAL_WINDOW_SIZE);
+	WriteSetting(settings + 18, Http2SettingsId::MaxHeaderListSize, HTTP2_MAX_HEADER_LIST_SIZE);
+
+	// The window of the connection can only be changed by WINDOW_UPDATE
+	uint8_t increment[4];
+	WriteUint32(increment, HTTP2_CONNECTION_WINDOW_SIZE - HTTP2_DEFAULT_WINDOW_SIZE);
+
+	logtd("HTTP/2 session is started: %s", _remote->ToString().CStr());
+
+	return Output({
+		MakeFrame(Http2FrameType::Settings, 0, 0, settings, sizeof(settings)),
+		MakeFrame(Http2FrameType::WindowUpdate, 0, 0, increment, sizeof(increment))
+	});
+}
+
+void Http2Session::Close()
+{
+	std::map<uint32_t, std::shared_ptr<Stream>> streams;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		if(_is_closed)
+		{
+			return;
+		}
+
+		_is_closed = true;
+
+		streams = std::move(_streams);
+		_streams.clear();
+
+		// HttpClient <-> TLS
+		_tls = nullptr;
+		_tls_output = nullptr;
+	}
+
+	for(auto &item : streams)
+	{
+		auto &stream = item.second;
+
+		if(stream->request != nullptr)
+		{
+			auto interceptor = stream->request->GetRequestInterceptor();
+
+			if(interceptor != nullptr)
+			{
+				interceptor->OnHttpClosed(stream->request, stream->response);
+			}
+		}
+	}
+}
+
+bool Http2Session::ProcessData(const std::shared_ptr<const ov::Data> &data)
+{
+	bool result = true;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		if(_is_closed)
+		{
+			return false;
+		}
+
+		if(_received_data == nullptr)
+		{
+			_received_data = std::make_shared<ov::Data>();
+		}
+
+		_received_data->Append(data.get());
+
+		auto buffer = _received_data->GetDataAs<uint8_t>();
+		size_t length = _received_data->GetLength();
+		size_t offset = 0;
+
+		if(_is_preface_received == false)
+		{
+			if(::memcmp(buffer, HTTP2_CONNECTION_PREFACE, std::min(length, HTTP2_CONNECTION_PREFACE_LENGTH)) != 0)
+			{
+				logtw("Invalid connection preface of HTTP/2 from %s", _remote->ToString().CStr());
+				return false;
+			}
+
+			if(length < HTTP2_CONNECTION_PREFACE_LENGTH)
+			{
+				// Need more data
+				return true;
+			}
+
+			_is_preface_received = true;
+			offset = HTTP2_CONNECTION_PREFACE_LENGTH;
+		}
+
+		// RFC7540 - 4.1. Frame Format
+		// +-----------------------------------------------+
+		// |                 Length (24)                   |
+		// +---------------+---------------+---------------+
+		// |   Type (8)    |   Flags (8)   |
+		// +-+-------------+---------------+-------------------------------+
+		// |R|                 Stream Identifier (31)                      |
+		// +=+=============================================================+
+		// |                   Frame Payload (0...)                      ...
+		// +---------------------------------------------------------------+
+		while(result && ((length - offset) >= HTTP2_FRAME_HEADER_SIZE))
+		{
+			const uint8_t *header = buffer + offset;
+			size_t frame_length = (static_cast<size_t>(header[0]) << 16) | (static_cast<size_t>(header[1]) << 8) | header[2];
+			auto type = static_cast<Http2FrameType>(header[3]);
+			uint8_t flags = header[4];
+			uint32_t stream_id = ReadUint32(header + 5) & 0x7FFFFFFF;
+
+			if(frame_length > HTTP2_DEFAULT_MAX_FRAME_SIZE)
+			{
+				// SETTINGS_MAX_FRAME_SIZE of the server is not changed
+				logtw("Too large frame from %s: %zu bytes", _remote->ToString().CStr(), frame_length);
+				SendGoAway(Http2ErrorCode::FrameSizeError);
+				result = false;
+				break;
+			}
+
+			if((length - offset - HTTP2_FRAME_HEADER_SIZE) < frame_length)
+			{
+				// Need more data
+				break;
+			}
+
+			result = ProcessFrame(type, flags, stream_id, header + HTTP2_FRAME_HEADER_SIZE, frame_length);
+			offset += HTTP2_FRAME_HEADER_SIZE + frame_length;
+		}
+
+		if(offset >= length)
+		{
+			_received_data->Clear();
+		}
+		else if(offset > 0)
+		{
+			// Keep the partial frame
+			_received_data = _received_data->Subdata(offset)->Clone();
+		}
+	}
+
+	auto received_streams = std::move(_received_streams);
+	auto reset_streams = std::move(_reset_streams);
+	_received_streams.clear();
+	_reset_streams.clear();
+
+	if(result)
+	{
+		for(auto &stream : received_streams)
+		{
+			{
+				std::lock_guard<std::mutex> lock_guard(_mutex);
+
+				if(_streams.find(stream->id) == _streams.end())
+				{
+					// Reset by the client already
+					continue;
+				}
+			}
+
+			auto body = (stream->body != nullptr) ? stream->body : std::make_shared<ov::Data>();
+
+			if(_request_handler(stream->request, stream->response, body) == false)
+			{
+				{
+					std::lock_guard<std::mutex> lock_guard(_mutex);
+
+					SendRstStream(stream->id, Http2ErrorCode::InternalError);
+					_streams.erase(stream->id);
+				}
+
+				reset_streams.push_back(stream);
+			}
+		}
+	}
+
+	for(auto &stream : reset_streams)
+	{
+		auto interceptor = stream->request->GetRequestInterceptor();
+
+		if(interceptor != nullptr)
+		{
+			interceptor->OnHttpClosed(stream->request, stream->response);
+		}
+	}
+
+	return result;
+}
+
+std::shared_ptr<ov::Data> Http2Session::ReadTls()
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	if(_tls == nullptr)
+	{
+		return nullptr;
+	}
+
+	auto data = _tls->Read();
+
+	if((_tls_output != nullptr) && (_tls_output->GetLength() > 0))
+	{
+		// e.g. The alerts, the key updates
+		std::shared_ptr<const ov::Data> output = std::move(_tls_output);
+		_tls_output = nullptr;
+
+		_remote->SendAsync({ output }, true);
+	}
+
+	return data;
+}
+
+ssize_t Http2Session::OnTlsWrite(const void *data, size_t length)
+{
+	if(_tls_output == nullptr)
+	{
+		_tls_output = std::make_shared<ov::Data>();
+	}
+
+	_tls_output->Append(data, length);
+
+	return static_cast<ssize_t>(length);
+}
+
+bool Http2Session::HasActiveStreams()
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	return _streams.empty() == false;
+}
+
+//====================================================================================================
+// Receiving
+//====================================================================================================
+bool Http2Session::ProcessFrame(Http2FrameType type, uint8_t flags, uint32_t stream_id, const uint8_t *payload, size_t length)
+{
+	logtd("HTTP/2 frame from %s: type: %d, flags: 0x%02x, stream: %u, length: %zu",
+		  _remote->ToString().CStr(), static_cast<int>(type), flags, stream_id, length);
+
+	if((_header_block_stream_id != 0) && (type != Http2FrameType::Continuation))
+	{
+		// RFC7540 - 6.10. The header block must be continued by CONTINUATION without any other frames
+		logtw("The header block of stream %u is not continued from %s", _header_block_stream_id, _remote->ToString().CStr());
+		SendGoAway(Http2ErrorCode::ProtocolError);
+		return false;
+	}
+
+	switch(type)
+	{
+		case Http2FrameType::Data:
+			return ProcessDataFrame(flags, stream_id, payload, length);
+
+		case Http2FrameType::Headers:
+			return ProcessHeadersFrame(flags, stream_id, payload, length);
+
+		case Http2FrameType::Continuation:
+			return ProcessContinuationFrame(flags, stream_id, payload, length);
+
+		case Http2FrameType::RstStream:
+			return ProcessRstStreamFrame(stream_id, payload, length);
+
+		case Http2FrameType::Settings:
+			return ProcessSettingsFrame(flags, stream_id, payload, length);
+
+		case Http2FrameType::Ping:
+			return ProcessPingFrame(flags, stream_id, payload, length);
+
+		case Http2FrameType::WindowUpdate:
+			return ProcessWindowUpdateFrame(stream_id, payload, length);
+
+		case Http2FrameType::Priority:
+			// The responses are not prioritized
+			if(stream_id == 0)
+			{
+				SendGoAway(Http2ErrorCode::ProtocolError);
+				return false;
+			}
+
+			return true;
+
+		case Http2FrameType::PushPromise:
+			// A client cannot push
+			SendGoAway(Http2ErrorCode::ProtocolError);
+			return false;
+
+		case Http2FrameType::GoAway:
+			// The client closes the connection after the responses of the streams
+			logtd("GOAWAY is received from %s", _remote->ToString().CStr());
+			return true;
+	}
+
+	// RFC7540 - 4.1. Implementations MUST ignore and discard any frame that has a type that is unknown
+	return true;
+}
+
+bool Http2Session::RemovePadding(uint8_t flags, const uint8_t *&payload, size_t &length)
+{
+	if(OV_CHECK_FLAG(flags, HTTP2_FLAG_PADDED) == false)
+	{
+		return true;
+	}
+
+	if(length < 1)
+	{
+		return false;
+	}
+
+	size_t padding_length = payload[0];
+
+	if(padding_length >= length)
+	{
+		return false;
+	}
+
+	payload += 1;
+	length -= (1 + padding_length);
+
+	return true;
+}
+
+bool Http2Session::ProcessDataFrame(uint8_t flags, uint32_t stream_id, const uint8_t *payload, size_t length)
+{
+	if(stream_id == 0)
+	{
+		SendGoAway(Http2ErrorCode::ProtocolError);
+		return false;
+	}
+
+	// The whole payload (including the padding) is counted by the window of the connection
+	_consumed_window += length;
+
+	if(_consumed_window >= (HTTP2_CONNECTION_WINDOW_SIZE / 2))
+	{
+		SendWindowUpdate(0, static_cast<uint32_t>(_consumed_window));
+		_consumed_window = 0;
+	}
+
+	if(RemovePadding(flags, payload, length) == false)
+	{
+		SendGoAway(Http2ErrorCode::ProtocolError);
+		return false;
+	}
+
+	auto item = _streams.find(stream_id);
+
+	if((item == _streams.end()) || item->second->is_request_received)
+	{
+		if(stream_id > _last_stream_id)
+		{
+			// RFC7540 - 5.1. idle stream
+			SendGoAway(Http2ErrorCode::ProtocolError);
+			return false;
+		}
+
+		SendRstStream(stream_id, Http2ErrorCode::StreamClosed);
+		return true;
+	}
+
+	auto stream = item->second;
+
+	if(length > 0)
+	{
+		if(stream->body == nullptr)
+		{
+			stream->body = std::make_shared<ov::Data>();
+		}
+
+		if((stream->body->GetLength() + length) > HTTP2_INITIAL_WINDOW_SIZE)
+		{
+			// The window of the stream is not updated (the body is limited by the initial window)
+			ResetStream(stream_id, Http2ErrorCode::FlowControlError);
+			return true;
+		}
+
+		stream->body->Append(payload, length);
+	}
+
+	if(OV_CHECK_FLAG(flags, HTTP2_FLAG_END_STREAM))
+	{
+		OnRequestReceived(stream);
+	}
+
+	return true;
+}
+
+bool Http2Session::ProcessHeadersFrame(uint8_t flags, uint32_t stream_id, const uint8_t *payload, size_t length)
+{
+	if((stream_id == 0) || ((stream_id & 0x01) == 0))
+	{
+		// RFC7540 - 5.1.1. The streams initiated by a client must use odd-numbered stream identifiers
+		SendGoAway(Http2ErrorCode::ProtocolError);
+		return false;
+	}
+
+	if(RemovePadding(flags, payload, length) == false)
+	{
+		SendGoAway(Http2ErrorCode::ProtocolError);
+		return false;
+	}
+
+	if(OV_CHECK_FLAG(flags, HTTP2_FLAG_PRIORITY))
+	{
+		// Stream dependency (32) + weight (8) - not used
+		if(length < 5)
+		{
+			SendGoAway(Http2ErrorCode::FrameSizeError);
+			return false;
+		}
+
+		payload += 5;
+		length -= 5;
+	}
+
+	if(length > HTTP2_MAX_HEADER_LIST_SIZE)
+	{
+		logtw("Too large header block from %s: %zu bytes", _remote->ToString().CStr(), length);
+		SendGoAway(Http2ErrorCode::EnhanceYourCalm);
+		return false;
+	}
+
+	_header_block_new_stream = (stream_id > _last_stream_id);
+
+	if(_header_block_new_stream)
+	{
+		_last_stream_id = stream_id;
+	}
+
+	_header_block_stream_id = stream_id;
+	_header_block_end_stream = OV_CHECK_FLAG(flags, HTTP2_FLAG_END_STREAM);
+	_header_block = std::make_shared<ov::Data>(payload, length);
+
+	if(OV_CHECK_FLAG(flags, HTTP2_FLAG_END_HEADERS))
+	{
+		return ProcessHeaderBlock();
+	}
+
+	return true;
+}
+
+bool Http2Session::ProcessContinuationFrame(uint8_t flags, uint32_t stream_id, const uint8_t *payload, size_t length)
+{
+	if((_header_block_stream_id == 0) || (stream_id != _header_block_stream_id))
+	{
+		SendGoAway(Http2ErrorCode::ProtocolError);
+		return false;
+	}
+
+	if((_header_block->GetLength() + length) > HTTP2_MAX_HEADER_LIST_SIZE)
+	{
+		logtw("Too large header block from %s: %zu bytes", _remote->ToString().CStr(), _header_block->GetLength() + length);
+		SendGoAway(Http2ErrorCode::EnhanceYourCalm);
+		return false;
+	}
+
+	_header_block->Append(payload, length);
+
+	if(OV_CHECK_FLAG(flags, HTTP2_FLAG_END_HEADERS))
+	{
+		return ProcessHeaderBlock();
+	}
+
+	return true;
+}
+
+bool Http2Session::ProcessHeaderBlock()
+{
+	uint32_t stream_id = _header_block_stream_id;
+	auto header_block = std::move(_header_block);
+
+	_header_block_stream_id = 0;
+	_header_block = nullptr;
+
+	// The block is decoded even if the stream is closed, to keep the dynamic table
+	Http2HeaderList header_list;
+
+	if(_hpack_decoder.Decode(header_block->GetDataAs<uint8_t>(), header_block->GetLength(), HTTP2_MAX_HEADER_LIST_SIZE, header_list) == false)
+	{
+		logtw("Could not decode the header block of stream %u from %s", stream_id, _remote->ToString().CStr());
+		SendGoAway(Http2ErrorCode::CompressionError);
+		return false;
+	}
+
+	if(_header_block_new_stream == false)
+	{
+		auto item = _streams.find(stream_id);
+
+		if(item == _streams.end())
+		{
+			// The stream is closed or reset
+			return true;
+		}
+
+		// Trailer: it must end the stream, and the fields are not used
+		if(item->second->is_request_received || (_header_block_end_stream == false))
+		{
+			ResetStream(stream_id, Http2ErrorCode::ProtocolError);
+			return true;
+		}
+
+		OnRequestReceived(item->second);
+		return true;
+	}
+
+	if(_streams.size() >= HTTP2_MAX_CONCURRENT_STREAMS)
+	{
+		logtd("Stream %u is refused (too many streams): %s", stream_id, _remote->ToString().CStr());
+		SendRstStream(stream_id, Http2ErrorCode::RefusedStream);
+		return true;
+	}
+
+	auto stream = std::make_shared<Stream>(stream_id, _initial_window_size);
+
+	stream->header_list = std::move(header_list);
+	_streams[stream_id] = stream;
+
+	if(_header_block_end_stream)
+	{
+		OnRequestReceived(stream);
+	}
+
+	return true;
+}
+
+void Http2Session::OnRequestReceived(const std::shared_ptr<Stream> &stream)
+{
+	stream->is_request_received = true;
+
+	auto error_code = PrepareRequest(stream);
+
+	if(error_code != Http2ErrorCode::NoError)
+	{
+		ResetStream(stream->id, error_code);
+		return;
+	}
+
+	_received_streams.push_back(stream);
+}
+
+Http2ErrorCode Http2Session::PrepareRequest(const std::shared_ptr<Stream> &stream)
+{
+	ov::String method;
+	ov::String path;
+	ov::String authority;
+	ov::String headers;
+	ov::String cookie;
+	bool is_regular_header_found = false;
+
+	for(const auto &field : stream->header_list)
+	{
+		if(IsValidHeaderField(field) == false)
+		{
+			logtw("Invalid header field of stream %u from %s", stream->id, _remote->ToString().CStr());
+			return Http2ErrorCode::ProtocolError;
+		}
+
+		// RFC7540 - 8.1.2.1. Pseudo-Header Fields (must precede the regular header fields)
+		if(field.name[0] == ':')
+		{
+			if(is_regular_header_found)
+			{
+				return Http2ErrorCode::ProtocolError;
+			}
+
+			if(field.name == ":method")
+			{
+				method = field.value;
+			}
+			else if(field.name == ":path")
+			{
+				path = field.value;
+			}
+			else if(field.name == ":authority")
+			{
+				authority = field.value;
+			}
+			else if(field.name != ":scheme")
+			{
+				return Http2ErrorCode::ProtocolError;
+			}
+
+			continue;
+		}
+
+		is_regular_header_found = true;
+
+		if(IsConnectionSpecificHeader(field.name) || ((field.name == "te") && (field.value != "trailers")))
+		{
+			return Http2ErrorCode::ProtocolError;
+		}
+
+		if((field.name == "te") || (field.name == "content-length") || ((field.name == "host") && (authority.IsEmpty() == false)))
+		{
+			// Content-Length is replaced with the length of the body, Host with :authority
+			continue;
+		}
+
+		if(field.name == "cookie")
+		{
+			// RFC7540 - 8.1.2.5. The cookie fields are concatenated into a single field
+			cookie.AppendFormat("%s%s", cookie.IsEmpty() ? "" : "; ", field.value.CStr());
+			continue;
+		}
+
+		headers.AppendFormat("%s: %s\r\n", field.name.CStr(), field.value.CStr());
+	}
+
+	if(method.IsEmpty() || path.IsEmpty())
+	{
+		// CONNECT is not supported
+		return Http2ErrorCode::ProtocolError;
+	}
+
+	size_t body_length = (stream->body != nullptr) ? stream->body->GetLength() : 0;
+
+	// The request is parsed by HttpRequest as the message of HTTP/1.1
+	ov::String request_message = ov::String::FormatString("%s %s HTTP/2.0\r\n", method.CStr(), path.CStr());
+
+	if(authority.IsEmpty() == false)
+	{
+		request_message.AppendFormat("Host: %s\r\n", authority.CStr());
+	}
+
+	request_message.Append(headers);
+
+	if(cookie.IsEmpty() == false)
+	{
+		request_message.AppendFormat("Cookie: %s\r\n", cookie.CStr());
+	}
+
+	if(body_length > 0)
+	{
+		request_message.AppendFormat("Content-Length: %zu\r\n", body_length);
+	}
+
+	request_message.Append("\r\n");
+
+	auto request = std::make_shared<HttpRequest>(_default_interceptor, _remote);
+
+	if((request->ProcessData(request_message.ToData(false)) < 0) || (request->ParseStatus() != HttpStatusCode::OK))
+	{
+		logtw("Could not parse the request of stream %u from %s", stream->id, _remote->ToString().CStr());
+		return Http2ErrorCode::ProtocolError;
+	}
+
+	auto response = std::make_shared<HttpResponse>(request.get(), _remote);
+
+	// Set default headers
+	response->SetHeader("Server", "OvenMediaEngine");
+	response->SetHeader("Content-Type", "text/html");
+	response->SetHttp2Stream(GetSharedPtr(), stream->id);
+
+	stream->request = request;
+	stream->response = response;
+	stream->header_list.clear();
+
+	return Http2ErrorCode::NoError;
+}
+
+bool Http2Session::ProcessRstStreamFrame(uint32_t stream_id, const uint8_t *payload, size_t length)
+{
+	if(stream_id == 0)
+	{
+		SendGoAway(Http2ErrorCode::ProtocolError);
+		return false;
+	}
+
+	if(length != 4)
+	{
+		SendGoAway(Http2ErrorCode::FrameSizeError);
+		return false;
+	}
+
+	logtd("Stream %u is reset by %s: %u", stream_id, _remote->ToString().CStr(), ReadUint32(payload));
+
+	RemoveStream(stream_id);
+
+	return true;
+}
+
+bool Http2Session::ProcessSettingsFrame(uint8_t flags, uint32_t stream_id, const uint8_t *payload, size_t length)
+{
+	if(stream_id != 0)
+	{
+		SendGoAway(Http2ErrorCode::ProtocolError);
+		return false;
+	}
+
+	if(OV_CHECK_FLAG(flags, HTTP2_FLAG_ACK))
+	{
+		if(length != 0)
+		{
+			SendGoAway(Http2ErrorCode::FrameSizeError);
+			return false;
+		}
+
+		return true;
+	}
+
+	if((length % 6) != 0)
+	{
+		SendGoAway(Http2ErrorCode::FrameSizeError);
+		return false;
+	}
+
+	bool is_window_changed = false;
+
+	for(size_t offset = 0; offset < length; offset += 6)
+	{
+		auto id = static_cast<Http2SettingsId>((static_cast<uint16_t>(payload[offset]) << 8) | payload[offset + 1]);
+		uint32_t value = ReadUint32(payload + offset + 2);
+
+		switch(id)
+		{
+			case Http2SettingsId::HeaderTableSize:
+				_hpack_encoder.SetMaxTableSize(value);
+				break;
+
+			case Http2SettingsId::EnablePush:
+				if(value > 1)
+				{
+					SendGoAway(Http2ErrorCode::ProtocolError);
+					return false;
+				}
+				break;
+
+			case Http2SettingsId::InitialWindowSize:
+			{
+				if(value > HTTP2_MAX_WINDOW_SIZE)
+				{
+					SendGoAway(Http2ErrorCode::FlowControlError);
+					return false;
+				}
+
+				// RFC7540 - 6.9.2. The windows of all the streams are adjusted by the difference
+				int64_t delta = static_cast<int64_t>(value) - _initial_window_size;
+
+				for(auto &item : _streams)
+				{
+					item.second->send_window += delta;
+
+					if(item.second->send_window > HTTP2_MAX_WINDOW_SIZE)
+					{
+						SendGoAway(Http2ErrorCode::FlowControlError);
+						return false;
+					}
+				}
+
+				_initial_window_size = value;
+				is_window_changed = (delta > 0);
+				break;
+			}
+
+			case Http2SettingsId::MaxFrameSize:
+				if((value < HTTP2_DEFAULT_MAX_FRAME_SIZE) || (value > HTTP2_MAX_MAX_FRAME_SIZE))
+				{
+					SendGoAway(Http2ErrorCode::ProtocolError);
+					return false;
+				}
+
+				_max_frame_size = value;
+				break;
+
+			default:
+				// MAX_CONCURRENT_STREAMS (the server doesn't open streams), MAX_HEADER_LIST_SIZE (advisory), unknown
+				break;
+		}
+	}
+
+	std::vector<std::shared_ptr<const ov::Data>> frames;
+
+	frames.push_back(MakeFrame(Http2FrameType::Settings, HTTP2_FLAG_ACK, 0, nullptr, 0));
+
+	if(is_window_changed)
+	{
+		FlushStreams(frames);
+	}
+
+	return Output(frames);
+}
+
+bool Http2Session::ProcessPingFrame(uint8_t flags, uint32_t stream_id, const uint8_t *payload, size_t length)
+{
+	if(stream_id != 0)
+	{
+		SendGoAway(Http2ErrorCode::ProtocolError);
+		return false;
+	}
+
+	if(length != 8)
+	{
+		SendGoAway(Http2ErrorCode::FrameSizeError);
+		return false;
+	}
+
+	if(OV_CHECK_FLAG(flags, HTTP2_FLAG_ACK))
+	{
+		return true;
+	}
+
+	return Output(MakeFrame(Http2FrameType::Ping, HTTP2_FLAG_ACK, 0, payload, length));
+}
+
+bool Http2Session::ProcessWindowUpdateFrame(uint32_t stream_id, const uint8_t *payload, size_t length)
+{
+	if(length != 4)
+	{
+		SendGoAway(Http2ErrorCode::FrameSizeError);
+		return false;
+	}
+
+	uint32_t increment = ReadUint32(payload) & 0x7FFFFFFF;
+	std::vector<std::shared_ptr<const ov::Data>> frames;
+
+	if(stream_id == 0)
+	{
+		_connection_send_window += increment;
+
+		if((increment == 0) || (_connection_send_window > HTTP2_MAX_WINDOW_SIZE))
+		{
+			SendGoAway((increment == 0) ? Http2ErrorCode::ProtocolError : Http2ErrorCode::FlowControlError);
+			return false;
+		}
+
+		FlushStreams(frames);
+
+		return Output(frames);
+	}
+
+	auto item = _streams.find(stream_id);
+
+	if(item == _streams.end())
+	{
+		// The stream is finished
+		return true;
+	}
+
+	auto stream = item->second;
+
+	stream->send_window += increment;
+
+	if((increment == 0) || (stream->send_window > HTTP2_MAX_WINDOW_SIZE))
+	{
+		ResetStream(stream_id, (increment == 0) ? Http2ErrorCode::ProtocolError : Http2ErrorCode::FlowControlError);
+		return true;
+	}
+
+	if(FlushStream(stream, frames))
+	{
+		_streams.erase(stream_id);
+	}
+
+	return Output(frames);
+}
+
+void Http2Session::RemoveStream(uint32_t stream_id)
+{
+	auto item = _streams.find(stream_id);
+
+	if(item == _streams.end())
+	{
+		return;
+	}
+
+	if(item->second->request != nullptr)
+	{
+		_reset_streams.push_back(item->second);
+	}
+
+	_streams.erase(item);
+}
+
+void Http2Session::ResetStream(uint32_t stream_id, Http2ErrorCode error_code)
+{
+	SendRstStream(stream_id, error_code);
+	RemoveStream(stream_id);
+}
+
+//====================================================================================================
+// Sending
+//====================================================================================================
+ssize_t Http2Session::SendResponse(uint32_t stream_id, const Http2HeaderList *header_list, const std::vector<std::shared_ptr<const ov::Data>> &data_list, bool end_stream, bool &is_retry)
+{
+	is_retry = false;
+
+	size_t length = 0;
+
+	for(const auto &data : data_list)
+	{
+		length += data->GetLength();
+	}
+
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	if(_is_closed || (_remote->GetState() != ov::SocketState::Connected))
+	{
+		return -1L;
+	}
+
+	auto item = _streams.find(stream_id);
+
+	if(item == _streams.end())
+	{
+		// The client doesn't want the response any more (RST_STREAM), the other streams are not affected
+		logtd("Stream %u is closed, the response is discarded: %s", stream_id, _remote->ToString().CStr());
+		return static_cast<ssize_t>(length);
+	}
+
+	if(_remote->GetSendQueueBytes() > ov::SendQueueHighWaterMark)
+	{
+		// Backpressure: the client doesn't receive the previous data yet
+		is_retry = true;
+		return 0L;
+	}
+
+	auto stream = item->second;
+	std::vector<std::shared_ptr<const ov::Data>> frames;
+	bool is_finished = false;
+
+	if(header_list != nullptr)
+	{
+		// A response without the body is finished by HEADERS
+		is_finished = end_stream && (length == 0) && stream->pending_data_list.empty();
+
+		AppendHeaderFrames(stream_id, *header_list, is_finished, frames);
+	}
+
+	if(is_finished == false)
+	{
+		for(const auto &data : data_list)
+		{
+			if(data->GetLength() > 0)
+			{
+				stream->pending_data_list.push_back(data);
+			}
+		}
+
+		if(end_stream)
+		{
+			stream->is_end_stream_pending = true;
+		}
+
+		is_finished = FlushStream(stream, frames);
+	}
+
+	if(is_finished)
+	{
+		_streams.erase(stream_id);
+	}
+
+	return Output(frames) ? static_cast<ssize_t>(length) : -1L;
+}
+
+void Http2Session::AppendFrameHeader(Http2FrameType type, uint8_t flags, uint32_t stream_id, size_t length, ov::Data *output)
+{
+	uint8_t header[HTTP2_FRAME_HEADER_SIZE];
+
+	header[0] = static_cast<uint8_t>(length >> 16);
+	header[1] = static_cast<uint8_t>(length >> 8);
+	header[2] = static_cast<uint8_t>(length);
+	header[3] = static_cast<uint8_t>(type);
+	header[4] = flags;
+	WriteUint32(header + 5, stream_id & 0x7FFFFFFF);
+
+	output->Append(header, sizeof(header));
+}
+
+std::shared_ptr<ov::Data> Http2Session::MakeFrame(Http2FrameType type, uint8_t flags, uint32_t stream_id, const void *payload, size_t length)
+{
+	auto frame = std::make_shared<ov::Data>(HTTP2_FRAME_HEADER_SIZE + length);
+
+	AppendFrameHeader(type, flags, stream_id, length, frame.get());
+
+	if(length > 0)
+	{
+		frame->Append(payload, length);
+	}
+
+	return frame;
+}
+
+void Http2Session::AppendHeaderFrames(uint32_t stream_id, const Http2HeaderList &header_list, bool end_stream, std::vector<std::shared_ptr<const ov::Data>> &frames)
+{
+	// The dynamic table of the encoder is changed, so the block must be sent in the order of encoding (_mutex is locked)
+	ov::Data header_block;
+
+	_hpack_encoder.Encode(header_list, &header_block);
+
+	auto block = header_block.GetDataAs<uint8_t>();
+	size_t length = header_block.GetLength();
+	size_t offset = 0;
+	bool is_first = true;
+
+	// HEADERS + CONTINUATION (if the block exceeds SETTINGS_MAX_FRAME_SIZE)
+	do
+	{
+		size_t fragment_length = std::min(length - offset, _max_frame_size);
+		bool is_last = ((offset + fragment_length) == length);
+		uint8_t flags = (is_last ? HTTP2_FLAG_END_HEADERS : 0) | ((is_first && end_stream) ? HTTP2_FLAG_END_STREAM : 0);
+
+		frames.push_back(MakeFrame(is_first ? Http2FrameType::Headers : Http2FrameType::Continuation, flags, stream_id, block + offset, fragment_length));
+
+		offset += fragment_length;
+		is_first = false;
+	} while(offset < length);
+}
+
+bool Http2Session::FlushStream(const std::shared_ptr<Stream> &stream, std::vector<std::shared_ptr<const ov::Data>> &frames)
+{
+	while(stream->pending_data_list.empty() == false)
+	{
+		int64_t available = std::min(std::min(stream->send_window, _connection_send_window), static_cast<int64_t>(_max_frame_size));
+
+		if(available <= 0)
+		{
+			// Wait for WINDOW_UPDATE
+			return false;
+		}
+
+		auto &data = stream->pending_data_list.front();
+		size_t remained = data->GetLength() - stream->pending_offset;
+		size_t length = std::min(remained, static_cast<size_t>(available));
+		bool is_last = (length == remained) && (stream->pending_data_list.size() == 1) && stream->is_end_stream_pending;
+
+		auto frame_header = std::make_shared<ov::Data>(HTTP2_FRAME_HEADER_SIZE);
+		AppendFrameHeader(Http2FrameType::Data, is_last ? HTTP2_FLAG_END_STREAM : 0, stream->id, length, frame_header.get());
+
+		// The payload refers to the data (e.g. a segment shared by the clients) without copying
+		frames.push_back(frame_header);
+		frames.push_back(data->Subdata(stream->pending_offset, length));
+
+		stream->send_window -= length;
+		_connection_send_window -= length;
+		stream->pending_offset += length;
+
+		if(stream->pending_offset >= data->GetLength())
+		{
+			stream->pending_data_list.pop_front();
+			stream->pending_offset = 0;
+		}
+
+		if(is_last)
+		{
+			stream->is_end_stream_pending = false;
+			return true;
+		}
+	}
+
+	if(stream->is_end_stream_pending)
+	{
+		// The last chunk of the chunked transfer
+		frames.push_back(MakeFrame(Http2FrameType::Data, HTTP2_FLAG_END_STREAM, stream->id, nullptr, 0));
+		stream->is_end_stream_pending = false;
+		return true;
+	}
+
+	return false;
+}
+
+void Http2Session::FlushStreams(std::vector<std::shared_ptr<const ov::Data>> &frames)
+{
+	for(auto item = _streams.begin(); (item != _streams.end()) && (_connection_send_window > 0);)
+	{
+		auto &stream = item->second;
+
+		if(stream->pending_data_list.empty() == false)
+		{
+			if(FlushStream(stream, frames))
+			{
+				item = _streams.erase(item);
+				continue;
+			}
+		}
+
+		++item;
+	}
+}
+
+bool Http2Session::Output(const std::vector<std::shared_ptr<const ov::Data>> &frames)
+{
+	if(frames.empty())
+	{
+		return true;
+	}
+
+	if(_is_closed)
+	{
+		return false;
+	}
+
+	if((_tls == nullptr) || _tls->IsKernelTlsTxEnabled())
+	{
+		// The frames are queued without copying (they are encrypted by the kernel with kTLS)
+		return _remote->SendAsync(frames, true);
+	}
+
+	// The frames are encrypted at once, so the records are not split by the frames
+	ov::Data plain_data;
+
+	for(const auto &frame : frames)
+	{
+		plain_data.Append(frame.get());
+	}
+
+	size_t written = 0;
+
+	// ov::Tls::Write() -> HttpClient::TlsWrite() -> Http2Session::OnTlsWrite()
+	if(_tls->Write(plain_data.GetData(), plain_data.GetLength(), &written) != SSL_ERROR_NONE)
+	{
+		logte("Could not encrypt the frames of HTTP/2: %s", _remote->ToString().CStr());
+		return false;
+	}
+
+	if(_tls_output == nullptr)
+	{
+		return true;
+	}
+
+	std::shared_ptr<const ov::Data> output = std::move(_tls_output);
+	_tls_output = nullptr;
+
+	return _remote->SendAsync({ output }, true);
+}
+
+bool Http2Session::Output(const std::shared_ptr<const ov::Data> &frame)
+{
+	return Output(std::vector<std::shared_ptr<const ov::Data>> { frame });
+}
+
+void Http2Session::SendRstStream(uint32_t stream_id, Http2ErrorCode error_code)
+{
+	uint8_t payload[4];
+	WriteUint32(payload, static_cast<uint32_t>(error_code));
+
+	Output(MakeFrame(Http2FrameType::RstStream, 0, stream_id, payload, sizeof(payload)));
+}
+
+void Http2Session::SendGoAway(Http2ErrorCode error_code)
+{
+	// Last-Stream-ID (31) + Error Code (32)
+	uint8_t payload[8];
+	WriteUint32(payload, _last_stream_id);
+	WriteUint32(payload + 4, static_cast<uint32_t>(error_code));
+
+	logtw("GOAWAY is sent to %s: %u", _remote->ToString().CStr(), static_cast<uint32_t>(error_code));
+
+	Output(MakeFrame(Http2FrameType::GoAway, 0, 0, payload, sizeof(payload)));
+}
+
+void Http2Session::SendWindowUpdate(uint32_t stream_id, uint32_t increment)
+{
+	uint8_t payload[4];
+	WriteUint32(payload, increment);
+
+	Output(MakeFrame(Http2FrameType::WindowUpdate, 0, stream_id, payload, sizeof(payload)));
+}
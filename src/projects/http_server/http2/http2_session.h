@@ -0,0 +1,182 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "http2_hpack.h"
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include <base/ovcrypto/ovcrypto.h>
+#include <base/ovsocket/ovsocket.h>
+
+class HttpRequest;
+class HttpResponse;
+class HttpRequestInterceptor;
+
+// A connection of HTTP/2 (negotiated by ALPN "h2")
+//
+// - The streams are multiplexed over the connection, each stream is a pair of HttpRequest/HttpResponse,
+//   so the interceptors handle the requests of HTTP/2 in the same way as HTTP/1.1
+// - The request is passed to the interceptor when the stream is half-closed by the client (the header and the body are received)
+// - The responses of the streams are sent by the worker threads, the frames are serialized by _mutex
+//   (HPACK and TLS are the state of the connection), and the DATA frames are limited by the flow control windows
+// - Server push and the extended CONNECT (RFC8441, WebSocket over HTTP/2) are not supported
+class Http2Session : public ov::EnableSharedFromThis<Http2Session>
+{
+public:
+	// Called when a request is received completely
+	// @return false if the request cannot be processed (the stream is reset)
+	using RequestHandler = std::function<bool(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response, const std::shared_ptr<const ov::Data> &body)>;
+
+	// tls: nullptr if the connection is not encrypted (the frames are sent as they are if kTLS is enabled)
+	Http2Session(const std::shared_ptr<ov::ClientSocket> &remote, const std::shared_ptr<ov::Tls> &tls,
+				 const std::shared_ptr<HttpRequestInterceptor> &default_interceptor, RequestHandler request_handler);
+	~Http2Session() override = default;
+
+	// Sends the connection preface of the server (SETTINGS)
+	bool Start();
+
+	// The streams which are not finished are closed (HttpRequestInterceptor::OnHttpClosed() is called)
+	void Close();
+
+	// Processes the plain data received from the client (called by the thread of the connection)
+	// @return false if the connection must be closed (GOAWAY is sent)
+	bool ProcessData(const std::shared_ptr<const ov::Data> &data);
+
+	// Decrypts the data received by TLS (the data set by HttpClient::SetTlsData())
+	std::shared_ptr<ov::Data> ReadTls();
+
+	// Called by HttpClient::TlsWrite() while the session encrypts the frames (_mutex is locked)
+	ssize_t OnTlsWrite(const void *data, size_t length);
+
+	// Sends the header (if header_list is not nullptr) and the data of the stream
+	// - The data is queued (not copied) to the stream, and is sent as much as the flow control windows allow
+	// - is_retry: more than ov::SendQueueHighWaterMark is queued to the socket, nothing is sent (try again later)
+	// - The data of the stream reset by the client is discarded
+	// @return the length of the data (-1 if the connection is closed)
+	ssize_t SendResponse(uint32_t stream_id, const Http2HeaderList *header_list, const std::vector<std::shared_ptr<const ov::Data>> &data_list, bool end_stream, bool &is_retry);
+
+	// Whether some streams are not finished (e.g. the blocking requests of LL-HLS, the large segments)
+	bool HasActiveStreams();
+
+protected:
+	struct Stream
+	{
+		explicit Stream(uint32_t id, int64_t send_window)
+			: id(id),
+			  send_window(send_window)
+		{
+		}
+
+		uint32_t id;
+
+		// Received from the client
+		Http2HeaderList header_list;
+		std::shared_ptr<ov::Data> body;
+		bool is_request_received = false;
+
+		std::shared_ptr<HttpRequest> request;
+		std::shared_ptr<HttpResponse> response;
+
+		// Sent to the client
+		int64_t send_window;
+		std::deque<std::shared_ptr<const ov::Data>> pending_data_list;
+		// Offset of the first data of pending_data_list
+		size_t pending_offset = 0;
+		bool is_end_stream_pending = false;
+	};
+
+	//--------------------------------------------------------------------
+	// Receiving (called by the thread of the connection)
+	//--------------------------------------------------------------------
+	bool ProcessFrame(Http2FrameType type, uint8_t flags, uint32_t stream_id, const uint8_t *payload, size_t length);
+
+	bool ProcessDataFrame(uint8_t flags, uint32_t stream_id, const uint8_t *payload, size_t length);
+	bool ProcessHeadersFrame(uint8_t flags, uint32_t stream_id, const uint8_t *payload, size_t length);
+	bool ProcessContinuationFrame(uint8_t flags, uint32_t stream_id, const uint8_t *payload, size_t length);
+	bool ProcessRstStreamFrame(uint32_t stream_id, const uint8_t *payload, size_t length);
+	bool ProcessSettingsFrame(uint8_t flags, uint32_t stream_id, const uint8_t *payload, size_t length);
+	bool ProcessPingFrame(uint8_t flags, uint32_t stream_id, const uint8_t *payload, size_t length);
+	bool ProcessWindowUpdateFrame(uint32_t stream_id, const uint8_t *payload, size_t length);
+
+	// The header block is received completely (END_HEADERS)
+	bool ProcessHeaderBlock();
+
+	// The stream is half-closed by the client (END_STREAM), the request is passed to the interceptor by ProcessData()
+	void OnRequestReceived(const std::shared_ptr<Stream> &stream);
+
+	// Makes HttpRequest/HttpResponse of the stream (the request is converted to the message of HTTP/1.1)
+	// @return error code of the stream
+	Http2ErrorCode PrepareRequest(const std::shared_ptr<Stream> &stream);
+
+	// Removes the payload padding (RFC7540 - 6.1. DATA)
+	static bool RemovePadding(uint8_t flags, const uint8_t *&payload, size_t &length);
+
+	//--------------------------------------------------------------------
+	// Sending (_mutex must be locked)
+	//--------------------------------------------------------------------
+	static void AppendFrameHeader(Http2FrameType type, uint8_t flags, uint32_t stream_id, size_t length, ov::Data *output);
+	static std::shared_ptr<ov::Data> MakeFrame(Http2FrameType type, uint8_t flags, uint32_t stream_id, const void *payload, size_t length);
+
+	void AppendHeaderFrames(uint32_t stream_id, const Http2HeaderList &header_list, bool end_stream, std::vector<std::shared_ptr<const ov::Data>> &frames);
+
+	// Makes the DATA frames of the stream within the windows
+	// @return true if END_STREAM is made (the stream is finished)
+	bool FlushStream(const std::shared_ptr<Stream> &stream, std::vector<std::shared_ptr<const ov::Data>> &frames);
+	void FlushStreams(std::vector<std::shared_ptr<const ov::Data>> &frames);
+
+	// The frames are queued to the socket in order (even if more than ov::SendQueueHighWaterMark is queued)
+	bool Output(const std::vector<std::shared_ptr<const ov::Data>> &frames);
+	bool Output(const std::shared_ptr<const ov::Data> &frame);
+
+	void SendRstStream(uint32_t stream_id, Http2ErrorCode error_code);
+	void SendGoAway(Http2ErrorCode error_code);
+	void SendWindowUpdate(uint32_t stream_id, uint32_t increment);
+
+	// Removes the stream, and the interceptor is notified later (by ProcessData())
+	void RemoveStream(uint32_t stream_id);
+	// RST_STREAM + RemoveStream()
+	void ResetStream(uint32_t stream_id, Http2ErrorCode error_code);
+
+protected:
+	std::shared_ptr<ov::ClientSocket> _remote;
+	std::shared_ptr<HttpRequestInterceptor> _default_interceptor;
+	RequestHandler _request_handler;
+
+	// Receiving
+	std::shared_ptr<ov::Data> _received_data;
+	bool _is_preface_received = false;
+	uint32_t _last_stream_id = 0;
+	Http2HpackDecoder _hpack_decoder;
+	// The header block which is continued by CONTINUATION (stream id 0: not continued)
+	uint32_t _header_block_stream_id = 0;
+	bool _header_block_end_stream = false;
+	// Whether the header block opens a new stream (or it is the trailer/the block of a closed stream)
+	bool _header_block_new_stream = false;
+	std::shared_ptr<ov::Data> _header_block;
+	// The data received since the last WINDOW_UPDATE of the connection
+	size_t _consumed_window = 0;
+	// The streams to pass to the interceptors (the interceptors are called without _mutex locked)
+	std::vector<std::shared_ptr<Stream>> _received_streams;
+	std::vector<std::shared_ptr<Stream>> _reset_streams;
+
+	// _mutex : _streams, sending, TLS
+	std::mutex _mutex;
+	bool _is_closed = false;
+	std::shared_ptr<ov::Tls> _tls;
+	std::shared_ptr<ov::Data> _tls_output;
+	std::map<uint32_t, std::shared_ptr<Stream>> _streams;
+	Http2HpackEncoder _hpack_encoder;
+	int64_t _connection_send_window = HTTP2_DEFAULT_WINDOW_SIZE;
+	// SETTINGS of the client
+	int64_t _initial_window_size = HTTP2_DEFAULT_WINDOW_SIZE;
+	size_t _max_frame_size = HTTP2_DEFAULT_MAX_FRAME_SIZE;
+};
@@ -12,9 +12,12 @@
 #include "http_private.h"
 
 HttpClient::HttpClient(std::shared_ptr<ov::ClientSocket> socket, const std::shared_ptr<HttpRequestInterceptor> &interceptor)
+	: _default_interceptor(interceptor)
 {
 	OV_ASSERT2(socket != nullptr);
 
+	_last_activity_time = time(nullptr);
+
 	_request = std::make_shared<HttpRequest>(interceptor, socket);
 	_response = std::make_shared<HttpResponse>(_request.get(), socket);
 
@@ -29,6 +32,35 @@ HttpClient::HttpClient(std::shared_ptr<ov::ClientSocket> socket, const std::shar
 	}
 }
 
+void HttpClient::ResetRequest()
+{
+	auto socket = _request->GetRemote();
+
+	auto request = std::make_shared<HttpRequest>(_default_interceptor, socket);
+	auto response = std::make_shared<HttpResponse>(request.get(), socket);
+
+	// Set default headers
+	response->SetHeader("Server", "OvenMediaEngine");
+	response->SetHeader("Content-Type", "text/html");
+
+	{
+		// response mutex(tls)
+		std::unique_lock<std::mutex> lock(_response_guard);
+
+		if(_response != nullptr)
+		{
+			response->SetTls(_response->GetTls());
+		}
+
+		_response = response;
+	}
+
+	_request = request;
+	_received_body_length = 0L;
+	_finished_request_count++;
+	_last_activity_time = time(nullptr);
+}
+
 void HttpClient::SetTls(const std::shared_ptr<ov::Tls> &tls)
 {
     // response mutex(tls)
@@ -60,6 +92,7 @@ void HttpClient::SetTlsData(const std::shared_ptr<const ov::Data> &data)
 	OV_ASSERT2(_tls_read_data == nullptr);
 
     _tls_read_data = data;
+	_tls_read_view = ov::DataView(data);
 }
 
 ssize_t HttpClient::TlsRead(ov::Tls *tls, void *buffer, size_t length)
@@ -69,19 +102,19 @@ ssize_t HttpClient::TlsRead(ov::Tls *tls, void *buffer, size_t length)
 		return 0;
 	}
 
-	const void *data = _tls_read_data->GetData();
-	size_t bytes_to_copy = std::min(length, _tls_read_data->GetLength());
+	size_t bytes_to_copy = std::min(length, _tls_read_view.GetLength());
 
-	::memcpy(buffer, data, bytes_to_copy);
+	::memcpy(buffer, _tls_read_view.GetData(), bytes_to_copy);
 
-	if(_tls_read_data->GetLength() > bytes_to_copy)
+	if(_tls_read_view.GetLength() > bytes_to_copy)
 	{
 		// Data is remained
-        _tls_read_data = _tls_read_data->Subdata(bytes_to_copy);
+		_tls_read_view = _tls_read_view.Subdata(bytes_to_copy);
 	}
 	else
 	{
-        _tls_read_data = nullptr;
+		_tls_read_data = nullptr;
+		_tls_read_view = ov::DataView();
 	}
 
 	return bytes_to_copy;
@@ -89,6 +122,12 @@ ssize_t HttpClient::TlsRead(ov::Tls *tls, void *buffer, size_t length)
 
 ssize_t HttpClient::TlsWrite(ov::Tls *tls, const void *data, size_t length)
 {
+    if(_http2_session != nullptr)
+    {
+        // The frames of HTTP/2 are encrypted by the session (the session is locked)
+        return _http2_session->OnTlsWrite(data, length);
+    }
+
     // response mutex(tls)
     std::unique_lock<std::mutex> lock(_response_guard);
 
@@ -98,6 +137,13 @@ ssize_t HttpClient::TlsWrite(ov::Tls *tls, const void *data, size_t length)
         return 0;
     }
 
+    if(tls->IsKernelTlsTxEnabled())
+    {
+        // The records are encrypted by the kernel now, OpenSSL must not write to the socket (e.g. a renegotiation)
+        logtw("Could not send TLS record (%zu bytes): kTLS is enabled", length);
+        return -1;
+    }
+
     if (_tls_write_to_response)
     {
         _response->AppendTlsData(data, length);
@@ -10,6 +10,8 @@
 
 #include "http_request.h"
 #include "http_response.h"
+#include "http2/http2_session.h"
+#include <atomic>
 #include <mutex>
 
 class HttpClient
@@ -61,6 +63,12 @@ public:
     }
 
 protected:
+	//--------------------------------------------------------------------
+	// Persistent connection (called by HttpServer with _request_guard locked)
+	//--------------------------------------------------------------------
+	// Replaces the request/response with new ones for the next request of the connection (the TLS session is kept)
+	void ResetRequest();
+
 	//--------------------------------------------------------------------
 	// APIs which is related to TLS
 	//--------------------------------------------------------------------
@@ -80,7 +88,27 @@ protected:
 	std::shared_ptr<HttpResponse> _response = nullptr;
     std::mutex _response_guard;
 
+	std::shared_ptr<HttpRequestInterceptor> _default_interceptor = nullptr;
+
+	// ProcessData() and ResetRequest() must not be called at the same time
+	std::mutex _request_guard;
+
+	// Data of the pipelined requests received while the current request is being processed
+	std::shared_ptr<ov::Data> _pending_data = nullptr;
+	// Body of the current request passed to the interceptor
+	ssize_t _received_body_length = 0L;
+	// Number of the requests finished on the connection
+	uint32_t _finished_request_count = 0;
+	time_t _last_activity_time = 0;
+	// Timer of ov::SharedTimerWheel which closes the idle connection (0: not armed)
+	std::atomic<uint64_t> _idle_timer_id { 0 };
+
+	// The connection of HTTP/2 (ALPN "h2"), the requests are the streams of the session
+	std::shared_ptr<Http2Session> _http2_session = nullptr;
+
 	std::shared_ptr<const ov::Data> _tls_read_data = nullptr;
+	// The remaining bytes of _tls_read_data (TlsRead() is called several times for a record)
+	ov::DataView _tls_read_view;
   	bool _is_tls_accepted = false;
   	bool _tls_write_to_response = false;
 };
@@ -11,6 +11,8 @@
 #include "http_response.h"
 
 #include <algorithm>
+#include <cstring>
+#include <strings.h>
 
 HttpRequest::HttpRequest(const std::shared_ptr<HttpRequestInterceptor> &interceptor, std::shared_ptr<ov::ClientSocket> remote)
 	: _interceptor(interceptor),
@@ -37,7 +39,9 @@ ssize_t HttpRequest::ProcessData(const std::shared_ptr<const ov::Data> &data)
 	ssize_t previous_length = _request_string.GetLength();
 
 	_request_string.Append(data->GetDataAs<char>(), data->GetLength());
-	ssize_t newline_position = _request_string.IndexOf(&(NewLines[0]));
+
+	// 이전에 검사한 영역은 건너뜀 (\r\n\r\n 이 두 번에 걸쳐 들어올 수 있으므로 3 bytes 전부터 검사)
+	ssize_t newline_position = _request_string.IndexOf(&(NewLines[0]), _header_search_offset);
 
 	if(newline_position >= 0)
 	{
@@ -64,6 +68,15 @@ ssize_t HttpRequest::ProcessData(const std::shared_ptr<const ov::Data> &data)
 	else
 	{
 		// 아직 데이터가 덜 들어와서 헤더를 파싱 할 수 없음
+		_header_search_offset = std::max(static_cast<ssize_t>(_request_string.GetLength()) - (NewLinesLength - 1), static_cast<ssize_t>(0));
+
+		if(_request_string.GetLength() > HTTP_MAX_HEADER_SIZE)
+		{
+			logtw("Too large header: %zu bytes", _request_string.GetLength());
+
+			_parse_status = HttpStatusCode::BadRequest;
+			used_length = -1L;
+		}
 	}
 
 	// 사용한 데이터 길이 반환
@@ -81,33 +94,35 @@ HttpStatusCode HttpRequest::ParseMessage()
 	// RFC7230 - 3.1. Start Line
 	// start-line     = request-line / status-line
 
-	// 줄바꿈 문자를 기준으로 tokenize
-	std::vector<ov::String> tokens = _request_string.Split("\r\n");
+	// 줄바꿈 문자를 기준으로 한 줄씩 처리 (header field는 복사하지 않고 위치만 저장함)
+	const char *buffer = _request_string.CStr();
+	size_t length = _request_string.GetLength();
+
+	ssize_t line_end = _request_string.IndexOf("\r\n");
+	size_t request_line_length = (line_end >= 0) ? static_cast<size_t>(line_end) : length;
 
-	HttpStatusCode status_code;
+	HttpStatusCode status_code = ParseRequestLine(ov::StringView(buffer, request_line_length));
 
-	status_code = ParseRequestLine(tokens[0]);
-	tokens.erase(tokens.begin());
+	size_t line_offset = request_line_length + 2;
 
-	if(status_code == HttpStatusCode::OK)
+	while((status_code == HttpStatusCode::OK) && (line_offset < length))
 	{
-		for(const ov::String &token : tokens)
-		{
-			status_code = ParseHeader(token);
+		const char *line_end_pointer = static_cast<const char *>(::memmem(buffer + line_offset, length - line_offset, "\r\n", 2));
+		size_t line_length = (line_end_pointer != nullptr) ? static_cast<size_t>(line_end_pointer - (buffer + line_offset)) : (length - line_offset);
 
-			if(status_code != HttpStatusCode::OK)
-			{
-				break;
-			}
-		}
+		status_code = ParseHeader(line_offset, line_length);
+
+		line_offset += line_length + 2;
 	}
 
-	logtd("Headers found: %ld:", _request_header.size());
+	logtd("Headers found: %zu", _header_fields.size());
 
-	std::for_each(_request_header.begin(), _request_header.end(), [](const auto &pair) -> void
+	for(const auto &field : _header_fields)
 	{
-		logtd("\t>> %s: %s", pair.first.CStr(), pair.second.CStr());
-	});
+		logtd("\t>> %.*s: %.*s",
+		      static_cast<int>(field.name_length), buffer + field.name_offset,
+		      static_cast<int>(field.value_length), buffer + field.value_offset);
+	}
 
 	return status_code;
 }
@@ -118,7 +133,7 @@ HttpStatusCode HttpRequest::ParseMessage()
         _method = value_if_matches; \
     }
 
-HttpStatusCode HttpRequest::ParseRequestLine(const ov::String &line)
+HttpStatusCode HttpRequest::ParseRequestLine(const ov::StringView &line)
 {
 	// RFC7230 - 3.1.1. Request Line
 	// request-line   = method SP request-target SP HTTP-version CRLF
@@ -127,14 +142,15 @@ HttpStatusCode HttpRequest::ParseRequestLine(const ov::String &line)
 
 	if((first_space_index < 0) || (last_space_index < 0) || (first_space_index == last_space_index))
 	{
-		logtw("Invalid space index: first: %d, last: %d, line: %s", first_space_index, last_space_index, line.CStr());
+		logtw("Invalid space index: first: %zd, last: %zd, line: %.*s", first_space_index, last_space_index, static_cast<int>(line.GetLength()), line.GetData());
 		return HttpStatusCode::BadRequest;
 	}
 
 	_method = HttpMethod::Unknown;
 
 	// RFC7231 - 4. Request Methods
-	ov::String method = line.Left(static_cast<size_t>(first_space_index));
+	// The method is compared without copying (a request line is parsed for every request)
+	ov::StringView method = line.Left(static_cast<size_t>(first_space_index));
 
 	HTTP_COMPARE_METHOD("GET", HttpMethod::Get);
 	HTTP_COMPARE_METHOD("HEAD", HttpMethod::Head);
@@ -147,7 +163,7 @@ HttpStatusCode HttpRequest::ParseRequestLine(const ov::String &line)
 
 	if(_method == HttpMethod::Unknown)
 	{
-		logtw("Unknown method: %s", method.CStr());
+		logtw("Unknown method: %.*s", static_cast<int>(method.GetLength()), method.GetData());
 		return HttpStatusCode::MethodNotAllowed;
 	}
 
@@ -156,18 +172,18 @@ HttpStatusCode HttpRequest::ParseRequestLine(const ov::String &line)
 	//            / absolute-form
 	//            / authority-form
 	//            / asterisk-form
-	_request_target = line.Substring(first_space_index + 1, static_cast<size_t>(last_space_index - first_space_index - 1));
+	_request_target = line.Substring(first_space_index + 1, static_cast<size_t>(last_space_index - first_space_index - 1)).ToString();
 
 	// RFC7230 - 2.6. Protocol Versioning
 	// HTTP-version  = HTTP-name "/" DIGIT "." DIGIT
 	// HTTP-name     = %x48.54.54.50 ; "HTTP", case-sensitive
-	_http_version = line.Substring(last_space_index + 1);
+	_http_version = line.Substring(last_space_index + 1).ToString();
 
-	logtd("Method: [%s], uri: [%s], version: [%s]", method.CStr(), _request_target.CStr(), _http_version.CStr());
+	logtd("Method: [%.*s], uri: [%s], version: [%s]", static_cast<int>(method.GetLength()), method.GetData(), _request_target.CStr(), _http_version.CStr());
 	return HttpStatusCode::OK;
 }
 
-HttpStatusCode HttpRequest::ParseHeader(const ov::String &line)
+HttpStatusCode HttpRequest::ParseHeader(size_t line_offset, size_t line_length)
 {
 	// RFC7230 - 3.2.  Header Fields
 	// header-field   = field-name ":" OWS field-value OWS
@@ -192,25 +208,85 @@ HttpStatusCode HttpRequest::ParseHeader(const ov::String &line)
 	// the obs-fold rule) unless the message is intended for packaging
 	// within the message/http media type.
 
-	ssize_t colon_index = line.IndexOf(':');
+	if(line_length == 0)
+	{
+		return HttpStatusCode::OK;
+	}
+
+	const char *line = _request_string.CStr() + line_offset;
+	const char *colon = static_cast<const char *>(::memchr(line, ':', line_length));
 
-	if(colon_index == -1)
+	if(colon == nullptr)
 	{
 		// 잘못된 헤더
-		logtw("Invalid header (could not find colon): %s", line.CStr());
+		logtw("Invalid header (could not find colon): %.*s", static_cast<int>(line_length), line);
 		return HttpStatusCode::BadRequest;
 	}
 
-	// 모든 헤더 이름은 대문자로 처리
-	ov::String field_name = line.Left(static_cast<size_t>(colon_index)).UpperCaseString();
+	HeaderField field {};
+
+	field.name_offset = line_offset;
+	field.name_length = static_cast<size_t>(colon - line);
+
 	// 처리를 용이하게 하기 위해 OWS(optional white space) 없앰
-	ov::String field_value = line.Substring(colon_index + 1).Trim();
+	size_t value_begin = field.name_length + 1;
+	size_t value_end = line_length;
 
-	_request_header[field_name] = field_value;
+	while((value_begin < value_end) && ((line[value_begin] == ' ') || (line[value_begin] == '\t')))
+	{
+		value_begin++;
+	}
+
+	while((value_end > value_begin) && ((line[value_end - 1] == ' ') || (line[value_end - 1] == '\t')))
+	{
+		value_end--;
+	}
+
+	field.value_offset = line_offset + value_begin;
+	field.value_length = value_end - value_begin;
+
+	// 같은 이름의 헤더가 여러 번 오면 마지막 값을 사용함
+	_header_fields.push_back(field);
 
 	return HttpStatusCode::OK;
 }
 
+const HttpRequest::HeaderField *HttpRequest::FindHeader(const ov::String &key) const noexcept
+{
+	const char *buffer = _request_string.CStr();
+
+	// 헤더 수가 많지 않으므로 순차 검색 (대소문자 구분 없음)
+	for(auto field = _header_fields.rbegin(); field != _header_fields.rend(); ++field)
+	{
+		if((field->name_length == key.GetLength()) && (::strncasecmp(buffer + field->name_offset, key.CStr(), field->name_length) == 0))
+		{
+			return &(*field);
+		}
+	}
+
+	return nullptr;
+}
+
+const std::map<ov::String, ov::String, ov::CaseInsensitiveComparator> &HttpRequest::GetRequestHeader() const noexcept
+{
+	if(_request_header.size() != _header_fields.size())
+	{
+		const char *buffer = _request_string.CStr();
+
+		_request_header.clear();
+
+		for(const auto &field : _header_fields)
+		{
+			// 모든 헤더 이름은 대문자로 처리
+			ov::String field_name(buffer + field.name_offset, field.name_length);
+
+			_request_header[field_name.UpperCaseString()] = ov::String(buffer + field.value_offset, field.value_length);
+		}
+	}
+
+	return _request_header;
+}
+
 ov::String HttpRequest::GetHeader(const ov::String &key) const noexcept
 {
 	return GetHeader(key, "");
@@ -218,19 +294,37 @@ ov::String HttpRequest::GetHeader(const ov::String &key) const noexcept
 
 ov::String HttpRequest::GetHeader(const ov::String &key, ov::String default_value) const noexcept
 {
-	auto item = _request_header.find(key.UpperCaseString());
+	auto field = FindHeader(key);
 
-	if(item == _request_header.cend())
+	if(field == nullptr)
 	{
 		return std::move(default_value);
 	}
 
-	return item->second;
+	return ov::String(_request_string.CStr() + field->value_offset, field->value_length);
 }
 
 const bool HttpRequest::IsHeaderExists(const ov::String &key) const noexcept
 {
-	return _request_header.find(key) != _request_header.cend();
+	return FindHeader(key) != nullptr;
+}
+
+bool HttpRequest::IsKeepAlive() const noexcept
+{
+	if(IsUpgrade())
+	{
+		return false;
+	}
+
+	ov::String connection = GetHeader("CONNECTION").UpperCaseString();
+
+	// The requests of HTTP/2 are the streams of a persistent connection (the header is made by Http2Session)
+	if((_http_version == "HTTP/1.1") || (_http_version == "HTTP/2.0"))
+	{
+		return connection.IndexOf("CLOSE") < 0;
+	}
+
+	return connection.IndexOf("KEEP-ALIVE") >= 0;
 }
 
 void HttpRequest::PostProcess()
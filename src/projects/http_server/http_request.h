@@ -11,6 +11,9 @@
 #include "http_datastructure.h"
 #include "interceptors/http_request_interceptor.h"
 
+// 헤더 영역의 최대 크기 (이보다 큰 헤더는 BadRequest로 처리)
+#define HTTP_MAX_HEADER_SIZE                (64 * 1024)
+
 class HttpRequest : public ov::EnableSharedFromThis<HttpRequest>
 {
 public:
@@ -82,15 +85,23 @@ public:
 		return _request_body;
 	}
 
-	const std::map<ov::String, ov::String, ov::CaseInsensitiveComparator> &GetRequestHeader() const noexcept
-	{
-		return _request_header;
-	}
+	// 헤더 목록 (호출될 때 생성됨)
+	const std::map<ov::String, ov::String, ov::CaseInsensitiveComparator> &GetRequestHeader() const noexcept;
 
 	ov::String GetHeader(const ov::String &key) const noexcept;
 	ov::String GetHeader(const ov::String &key, ov::String default_value) const noexcept;
 	const bool IsHeaderExists(const ov::String &key) const noexcept;
 
+	// RFC7230 - 6.3. Persistence
+	// HTTP/1.1: persistent unless "Connection: close", HTTP/1.0: only if "Connection: keep-alive"
+	bool IsKeepAlive() const noexcept;
+
+	// Upgraded connection (e.g. WebSocket) is not a sequence of requests
+	bool IsUpgrade() const noexcept
+	{
+		return IsHeaderExists("UPGRADE");
+	}
+
 	HttpResponse *GetHttpResponse() noexcept
 	{
 		return _response;
@@ -147,9 +158,20 @@ protected:
 		return _request_body;
 	}
 
+	// 헤더 필드의 위치 (_request_string 안의 offset - 값을 복사하지 않음)
+	struct HeaderField
+	{
+		size_t name_offset;
+		size_t name_length;
+		size_t value_offset;
+		size_t value_length;
+	};
+
 	HttpStatusCode ParseMessage();
-	HttpStatusCode ParseRequestLine(const ov::String &line);
-	HttpStatusCode ParseHeader(const ov::String &line);
+	HttpStatusCode ParseRequestLine(const ov::StringView &line);
+	HttpStatusCode ParseHeader(size_t line_offset, size_t line_length);
+
+	const HeaderField *FindHeader(const ov::String &key) const noexcept;
 
 	void PostProcess();
 
@@ -166,9 +188,12 @@ protected:
 
 	// request 헤더
 	bool _is_header_found = false;
-	// 헤더 영역을 추출해내기 위해 임시로 사용되는 문자열 버퍼
+	// 헤더 영역 (파싱이 완료된 후에도 header field들이 참조함)
 	ov::String _request_string;
-	std::map<ov::String, ov::String, ov::CaseInsensitiveComparator> _request_header;
+	// 다음 번에 \r\n\r\n 을 찾기 시작할 위치 (이미 검사한 영역은 다시 검사하지 않음)
+	off_t _header_search_offset = 0;
+	std::vector<HeaderField> _header_fields;
+	mutable std::map<ov::String, ov::String, ov::CaseInsensitiveComparator> _request_header;
 
 	// 자주 사용하는 헤더 값은 미리 저장해놓음
 	ssize_t _content_length = 0L;
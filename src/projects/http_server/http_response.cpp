@@ -9,6 +9,7 @@
 #include "http_response.h"
 #include "http_request.h"
 #include "http_private.h"
+#include "http2/http2_session.h"
 
 #include <utility>
 #include <memory>
@@ -25,6 +26,13 @@ HttpResponse::HttpResponse(HttpRequest *request, std::shared_ptr<ov::ClientSocke
 
 bool HttpResponse::Response()
 {
+	if(IsHttp2())
+	{
+		bool is_retry = false;
+
+		return (ResponseHttp2(is_retry) >= 0) && (is_retry == false);
+	}
+
 	return SendHeaderIfNeeded() && SendResponse();
 }
 
@@ -87,7 +95,7 @@ bool HttpResponse::Send(const void *data, size_t length)
 		return false;
 	}
 
-	if(_tls != nullptr)
+	if((_tls != nullptr) && (_tls->IsKernelTlsTxEnabled() == false))
 	{
 		size_t written;
 
@@ -118,7 +126,7 @@ bool HttpResponse::Send(const void *data, size_t length)
 	}
 	else
 	{
-		// Send the plain data to the client
+		// Send the plain data to the client (it is encrypted by the kernel if kTLS is enabled)
 		return _remote->Send(data, length) == static_cast<ssize_t>(length);
 	}
 }
@@ -197,37 +205,287 @@ ssize_t HttpResponse::Response(bool &is_retry)
 {
     ssize_t sent = 0;
 
+    if(IsHttp2())
+    {
+        return ResponseHttp2(is_retry);
+    }
+
+    if((_tls == nullptr) || _tls->IsKernelTlsTxEnabled())
+    {
+        // The body (e.g. a segment shared by all clients) is sent with the header by writev()-like I/O without copying
+        // (With kTLS, the kernel encrypts the records, so HTTPS takes the same path)
+        if(_is_response_data_prepared == false)
+        {
+            _http_response_data_list.clear();
+
+            if(_is_header_sent == false)
+            {
+                _http_response_data_list.push_back(MakeHeaderData());
+            }
+            _http_response_data_list.insert(_http_response_data_list.end(), _response_data_list.begin(), _response_data_list.end());
+
+            _is_response_data_prepared = true;
+        }
+
+        size_t round_length = 0;
+
+        for(const auto &data : _http_response_data_list)
+        {
+            round_length += data->GetLength();
+        }
+
+        // The buffers are queued to the socket (shared, not copied), and sent when the socket is writable
+        sent = EnqueueResponseData(_http_response_data_list, round_length, is_retry);
+
+        if(!is_retry)
+        {
+            // The next round of the chunked transfer (or the next request of the persistent connection) cannot be sent after an error
+            if((_is_chunked_transfer || _is_keep_alive) && (sent != static_cast<ssize_t>(round_length)))
+            {
+                return -1;
+            }
+
+            PrepareNextChunkRound();
+        }
+
+        return sent;
+    }
+
     if (_http_response_data == nullptr)
     {
         if(!MakeResponseData())
             return 0;
     }
 
-    if(_tls == nullptr)
-        sent = Send(_http_response_data->GetData(), _http_response_data->GetLength(), is_retry);
-    else
-        sent = Send(_http_tls_response_data->GetData(), _http_tls_response_data->GetLength(), is_retry);
+    if(_http_tls_response_data == nullptr)
+    {
+        // Nothing is encrypted (e.g. SSL_ERROR_WANT_WRITE)
+        _http_tls_response_data = std::make_shared<ov::Data>();
+    }
+
+    size_t round_length = _http_tls_response_data->GetLength();
 
-    // sent data remove
-    if (is_retry && sent != 0)
+    sent = EnqueueResponseData({ _http_tls_response_data }, round_length, is_retry);
+
+    if(!is_retry)
     {
-       if(_tls == nullptr)
-            _http_response_data = _http_response_data->Subdata(sent);
-        else
-            _http_tls_response_data = _http_tls_response_data->Subdata(sent);
+        if((_is_chunked_transfer || _is_keep_alive) && (sent != static_cast<ssize_t>(round_length)))
+        {
+            return -1;
+        }
+
+        PrepareNextChunkRound();
     }
 
     return sent;
 }
 
-// http header + body data create
-bool HttpResponse::MakeResponseData()
+// Queues the data of the round to the socket
+// - is_retry is set if the send queue of the socket is full (the round is kept, and queued by the next call)
+ssize_t HttpResponse::EnqueueResponseData(const std::vector<std::shared_ptr<const ov::Data>> &data_list, size_t round_length, bool &is_retry)
 {
-    _http_response_data = std::make_shared<ov::Data>();
+    is_retry = false;
 
-    ov::ByteStream stream(_http_response_data.get());
+    if(round_length == 0)
+    {
+        return 0;
+    }
+
+    if(_remote->SendAsync(data_list))
+    {
+        return static_cast<ssize_t>(round_length);
+    }
+
+    if(IsConnected() && (_remote->GetSendQueueBytes() > ov::SendQueueHighWaterMark))
+    {
+        // Backpressure: the client doesn't receive the previous data yet
+        is_retry = true;
+        return 0;
+    }
+
+    return -1;
+}
+
+void HttpResponse::SetChunkedTransfer()
+{
+    if(_is_chunked_transfer)
+    {
+        return;
+    }
+
+    SetHeader("Transfer-Encoding", "chunked");
+
+    _is_chunked_transfer = true;
+}
+
+// chunk = chunk-size(hex) CRLF chunk-data CRLF
+bool HttpResponse::AppendChunk(const std::shared_ptr<const ov::Data> &data)
+{
+    if((_is_chunked_transfer == false) || _is_last_chunk_appended || (data == nullptr))
+    {
+        return false;
+    }
+
+    if(data->GetLength() == 0)
+    {
+        // A zero-sized chunk means the end of the body
+        return true;
+    }
+
+    if(IsHttp2())
+    {
+        // HTTP/2 has no chunked transfer coding, the chunks are sent as DATA frames
+        AppendData(data);
+        _chunked_body_length += data->GetLength();
+
+        return true;
+    }
+
+    AppendString(ov::String::FormatString("%zx\r\n", data->GetLength()));
+    AppendData(data);
+    AppendString("\r\n");
+
+    _chunked_body_length += data->GetLength();
+
+    return true;
+}
+
+// last-chunk = 1*("0") CRLF, followed by the empty trailer
+bool HttpResponse::AppendLastChunk()
+{
+    if((_is_chunked_transfer == false) || _is_last_chunk_appended)
+    {
+        return false;
+    }
+
+    if(IsHttp2() == false)
+    {
+        AppendString("0\r\n\r\n");
+    }
+
+    _is_last_chunk_appended = true;
+
+    return true;
+}
+
+// The round is sent completely, so the next chunks can be queued
+void HttpResponse::PrepareNextChunkRound()
+{
+    if(_is_chunked_transfer == false)
+    {
+        return;
+    }
+
+    _is_header_sent = true;
+    _is_response_data_prepared = false;
+    _http_response_data_list.clear();
+    _response_data_list.clear();
+    _http_response_data = nullptr;
+    _http_tls_response_data = nullptr;
+}
+
+ssize_t HttpResponse::ResponseHttp2(bool &is_retry)
+{
+    is_retry = false;
+
+    auto session = _http2_session.lock();
+
+    if(session == nullptr)
+    {
+        return -1;
+    }
+
+    Http2HeaderList header_list;
+
+    if(_is_header_sent == false)
+    {
+        header_list = MakeHttp2HeaderList();
+    }
+
+    // The chunked transfer is continued until the last chunk is appended
+    bool end_stream = (_is_chunked_transfer == false) || _is_last_chunk_appended;
+
+    ssize_t sent = session->SendResponse(_http2_stream_id, _is_header_sent ? nullptr : &header_list, _response_data_list, end_stream, is_retry);
+
+    if(is_retry || (sent < 0))
+    {
+        // The round is kept, and sent by the next call
+        return sent;
+    }
+
+    _is_header_sent = true;
+    _response_data_list.clear();
+
+    return sent;
+}
+
+Http2HeaderList HttpResponse::MakeHttp2HeaderList()
+{
+    Http2HeaderList header_list;
+    bool has_content_length = false;
+
+    // RFC7540 - 8.1.2.4. Response Pseudo-Header Fields (there is no reason phrase)
+    header_list.emplace_back(":status", ov::String::FormatString("%d", _status_code));
+
+    for(const auto &pair : _response_header)
+    {
+        auto name = pair.first.LowerCaseString();
+
+        // RFC7540 - 8.1.2.2. Connection-Specific Header Fields
+        if((name == "connection") || (name == "keep-alive") || (name == "proxy-connection") || (name == "transfer-encoding") || (name == "upgrade"))
+        {
+            continue;
+        }
+
+        has_content_length = has_content_length || (name == "content-length");
+
+        header_list.emplace_back(name, pair.second);
+    }
+
+    if((_is_chunked_transfer == false) && (has_content_length == false) &&
+       (_status_code != HttpStatusCode::NotModified) && (_status_code != HttpStatusCode::NoContent))
+    {
+        size_t body_length = 0;
+
+        for(const auto &data : _response_data_list)
+        {
+            body_length += data->GetLength();
+        }
+
+        header_list.emplace_back("content-length", ov::Converter::ToString(body_length));
+    }
+
+    return header_list;
+}
+
+void HttpResponse::SetKeepAlive(bool keep_alive)
+{
+    _is_keep_alive = keep_alive;
+
+    SetHeader("Connection", keep_alive ? "keep-alive" : "close");
+}
+
+// http header data create
+std::shared_ptr<ov::Data> HttpResponse::MakeHeaderData()
+{
+    auto header_data = std::make_shared<ov::Data>();
+
+    // RFC7230 - 3.3.3. Message Body Length : the client finds the end of the body by Content-Length
+    if(_is_keep_alive && (_is_chunked_transfer == false) && (_response_header.find("Content-Length") == _response_header.end()) &&
+       (_status_code != HttpStatusCode::NotModified) && (_status_code != HttpStatusCode::NoContent))
+    {
+        size_t body_length = 0;
+
+        for(const auto &data : _response_data_list)
+        {
+            body_length += data->GetLength();
+        }
+
+        _response_header["Content-Length"] = ov::Converter::ToString(body_length);
+    }
+
+    ov::ByteStream stream(header_data.get());
 
-    // header
     stream.Append(ov::String::FormatString("HTTP/1.1 %d %s\r\n", _status_code, _reason.CStr()).ToData(false));
     std::for_each(_response_header.begin(), _response_header.end(), [&stream](const auto &pair) -> void
     {
@@ -238,6 +496,17 @@ bool HttpResponse::MakeResponseData()
     });
     stream.Append("\r\n", 2);
 
+    return header_data;
+}
+
+// http header + body data create
+bool HttpResponse::MakeResponseData()
+{
+    // header (only the first round of the chunked transfer has the header)
+    _http_response_data = _is_header_sent ? std::make_shared<ov::Data>() : MakeHeaderData();
+
+    ov::ByteStream stream(_http_response_data.get());
+
     // body
     for(const auto &data : _response_data_list)
     {
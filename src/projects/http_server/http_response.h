@@ -9,13 +9,16 @@
 #pragma once
 
 #include "http_datastructure.h"
+#include "http2/http2_datastructure.h"
 
 class HttpRequest;
+class Http2Session;
 
 class HttpResponse : public ov::EnableSharedFromThis<HttpResponse>
 {
 public:
 	friend class HttpClient;
+	friend class Http2Session;
 
 	HttpResponse(HttpRequest *request, std::shared_ptr<ov::ClientSocket> remote);
 	~HttpResponse() override = default;
@@ -61,6 +64,48 @@ public:
 	bool Response();
     ssize_t Response(bool &is_retry);
 
+	// Chunked transfer encoding (RFC7230 - 4.1)
+	// - The body is sent in several rounds: the chunks queued by AppendChunk() are sent by Response(is_retry),
+	//   and the next round can be queued once the previous round is sent completely
+	// - The header is sent with the first round
+	void SetChunkedTransfer();
+
+	bool IsChunkedTransfer() const
+	{
+		return _is_chunked_transfer;
+	}
+
+	bool AppendChunk(const std::shared_ptr<const ov::Data> &data);
+	// Terminates the body (last-chunk)
+	bool AppendLastChunk();
+
+	// Sum of the chunk sizes queued so far (without chunk framing)
+	size_t GetChunkedBodyLength() const
+	{
+		return _chunked_body_length;
+	}
+
+	bool IsLastChunkAppended() const
+	{
+		return _is_last_chunk_appended;
+	}
+
+	// Persistent connection (RFC7230 - 6.3)
+	// - The body must be delimited, so Content-Length is added to the header (except the chunked transfer)
+	// - Must be called before the header is sent
+	void SetKeepAlive(bool keep_alive);
+
+	bool IsKeepAlive() const
+	{
+		return _is_keep_alive;
+	}
+
+	// The response of a stream of HTTP/2 (the frames are sent by Http2Session)
+	bool IsHttp2() const
+	{
+		return _http2_stream_id != 0;
+	}
+
 	std::shared_ptr<ov::ClientSocket> GetRemote()
 	{
 		return _remote;
@@ -95,8 +140,21 @@ protected:
 	bool SendHeaderIfNeeded();
 	bool SendResponse();
 
+	void SetHttp2Stream(const std::shared_ptr<Http2Session> &session, uint32_t stream_id)
+	{
+		_http2_session = session;
+		_http2_stream_id = stream_id;
+	}
+
+	// Response(is_retry) of HTTP/2: the chunks are the DATA frames, the last chunk is END_STREAM
+	ssize_t ResponseHttp2(bool &is_retry);
+	Http2HeaderList MakeHttp2HeaderList();
+
 
 	bool MakeResponseData();
+	ssize_t EnqueueResponseData(const std::vector<std::shared_ptr<const ov::Data>> &data_list, size_t round_length, bool &is_retry);
+	std::shared_ptr<ov::Data> MakeHeaderData();
+	void PrepareNextChunkRound();
 
 	HttpRequest *_request = nullptr;
 	std::shared_ptr<ov::ClientSocket> _remote = nullptr;
@@ -117,8 +175,20 @@ protected:
 
 
     std::shared_ptr<ov::Data> _http_response_data = nullptr; // header + body
+    std::vector<std::shared_ptr<const ov::Data>> _http_response_data_list; // header, body... (not concatenated, plain only)
+    bool _is_response_data_prepared = false;
     std::shared_ptr<ov::Data> _http_tls_response_data = nullptr; // (header + body)tls encoded
     bool _is_tls_write_save = false;
 
+	bool _is_chunked_transfer = false;
+	size_t _chunked_body_length = 0;
+	bool _is_last_chunk_appended = false;
+
+	bool _is_keep_alive = false;
+
+	// The session is held by HttpClient (the stream holds this response)
+	std::weak_ptr<Http2Session> _http2_session;
+	uint32_t _http2_stream_id = 0;
+
 
 };
@@ -32,12 +32,25 @@ bool HttpServer::Start(const ov::SocketAddress &address, int sned_buffer_size, i
 
 	if(_physical_port != nullptr)
 	{
+		// The clients which don't send a request are limited by ConnectionLimit.max_pending_handshakes
+		_physical_port->SetHandshakeTracking(true);
+
 		return _physical_port->AddObserver(this);
 	}
 
 	return _physical_port != nullptr;
 }
 
+void HttpServer::SetKeepAliveTimeout(int timeout)
+{
+	_keep_alive_timeout = timeout;
+}
+
+void HttpServer::SetMaxPacingRate(uint64_t rate)
+{
+	_max_pacing_rate = rate;
+}
+
 bool HttpServer::Stop()
 {
 	if(_physical_port == nullptr)
@@ -53,6 +66,7 @@ bool HttpServer::Stop()
 
 	for(auto &client : client_list)
 	{
+		CancelIdleTimer(client.second);
 		Disconnect(client.second);
 	}
 
@@ -108,6 +122,11 @@ void HttpServer::OnConnected(const std::shared_ptr<ov::Socket> &remote)
 {
 	logti("Client(%s) is connected on %s", remote->ToString().CStr(), _physical_port->GetAddress().ToString().CStr());
 
+	if(_max_pacing_rate > 0)
+	{
+		remote->SetMaxPacingRate(_max_pacing_rate);
+	}
+
 	std::lock_guard<std::mutex> guard(_client_list_mutex);
 
 	_client_list[remote.get()] = std::make_shared<HttpClient>(std::dynamic_pointer_cast<ov::ClientSocket>(remote), _default_interceptor);
@@ -126,100 +145,344 @@ void HttpServer::ProcessData(std::shared_ptr<HttpClient> &client, const std::sha
 
 	if(client != nullptr)
 	{
-		std::shared_ptr<HttpRequest> &request = client->GetRequest();
-		std::shared_ptr<HttpResponse> &response = client->GetResponse();
+		bool need_to_disconnect;
 
-		bool need_to_disconnect = false;
-
-		switch(request->ParseStatus())
 		{
-			case HttpStatusCode::OK:
+			std::lock_guard<std::mutex> guard(client->_request_guard);
+
+			client->_last_activity_time = time(nullptr);
+
+			if(client->_http2_session != nullptr)
 			{
-				auto &interceptor = request->GetRequestInterceptor();
+				need_to_disconnect = (client->_http2_session->ProcessData(data) == false);
+			}
+			else
+			{
+				need_to_disconnect = (ProcessDataInternal(client, data) == false);
+			}
+		}
+
+		if(need_to_disconnect)
+		{
+			// 연결을 종료해야 함
+			Disconnect(client);
+		}
+	}
+}
 
-				if(interceptor != nullptr)
+bool HttpServer::ProcessDataInternal(const std::shared_ptr<HttpClient> &client, const std::shared_ptr<const ov::Data> &data)
+{
+	std::shared_ptr<HttpRequest> request = client->GetRequest();
+	std::shared_ptr<HttpResponse> response = client->GetResponse();
+
+	bool need_to_disconnect = false;
+
+	switch(request->ParseStatus())
+	{
+		case HttpStatusCode::OK:
+		{
+			auto &interceptor = request->GetRequestInterceptor();
+
+			if(interceptor != nullptr)
+			{
+				if(request->IsUpgrade())
 				{
 					// If the request is parsed, bypass to the interceptor
 					need_to_disconnect = (interceptor->OnHttpData(request, response, data) == false);
-
-					if(need_to_disconnect)
-					{
-						need_to_disconnect = need_to_disconnect;
-					}
 				}
 				else
 				{
-					OV_ASSERT2(false);
-					need_to_disconnect = true;
-				}
+					// The data after the body is the next request (pipelining)
+					bool is_overflow = false;
+					auto body = SplitPipelinedData(client, data, is_overflow);
 
-				break;
-			}
+					if((body != nullptr) && (body->GetLength() > 0))
+					{
+						need_to_disconnect = (interceptor->OnHttpData(request, response, body) == false);
+					}
 
-			case HttpStatusCode::PartialContent:
+					need_to_disconnect = need_to_disconnect || is_overflow;
+				}
+			}
+			else
 			{
-				// Need to parse HTTP header
-				ssize_t processed_length = TryParseHeader(data, request, response);
+				OV_ASSERT2(false);
+				need_to_disconnect = true;
+			}
 
-				if(processed_length >= 0)
+			break;
+		}
+
+		case HttpStatusCode::PartialContent:
+		{
+			// Need to parse HTTP header
+			ssize_t processed_length = TryParseHeader(data, request, response);
+
+			if(processed_length >= 0)
+			{
+				if(request->ParseStatus() == HttpStatusCode::OK)
 				{
-					if(request->ParseStatus() == HttpStatusCode::OK)
+					// Parsing is completed
+
+					// The connection is set up (after the TLS handshake for HTTPS), it's no longer a pending handshake
+					request->GetRemote()->CompleteHandshake();
+
+					auto interceptor = FindInterceptor(request, response);
+
+					if(interceptor == nullptr)
 					{
-						// Parsing is completed
-
-						// Find interceptor for the request
-						{
-							std::lock_guard<std::mutex> guard(_interceptor_list_mutex);
-
-							for(auto &interceptor : _interceptor_list)
-							{
-								if(interceptor->IsInterceptorForRequest(request, response))
-								{
-									request->SetRequestInterceptor(interceptor);
-									break;
-								}
-							}
-						}
-
-						auto interceptor = request->GetRequestInterceptor();
-
-						if(interceptor == nullptr)
-						{
-							need_to_disconnect = true;
-							OV_ASSERT2(false);
-						}
-
-						need_to_disconnect = need_to_disconnect || (interceptor->OnHttpPrepare(request, response) == false);
-						need_to_disconnect = need_to_disconnect || (interceptor->OnHttpData(request, response, data->Subdata(processed_length)) == false);
+						need_to_disconnect = true;
+						OV_ASSERT2(false);
 					}
-					else if(request->ParseStatus() == HttpStatusCode::PartialContent)
+
+					auto body = data->Subdata(processed_length);
+					bool is_overflow = false;
+
+					if(request->IsUpgrade() == false)
 					{
-						// Need more data
+						// The data after the body is the next request (pipelining)
+						body = SplitPipelinedData(client, body, is_overflow);
 					}
+
+					need_to_disconnect = need_to_disconnect || is_overflow;
+					need_to_disconnect = need_to_disconnect || (interceptor->OnHttpPrepare(request, response) == false);
+					need_to_disconnect = need_to_disconnect || (interceptor->OnHttpData(request, response, body) == false);
 				}
-				else
+				else if(request->ParseStatus() == HttpStatusCode::PartialContent)
 				{
-					// An error occurred with the request
-					request->GetRequestInterceptor()->OnHttpError(request, response, HttpStatusCode::BadRequest);
-					need_to_disconnect = true;
+					// Need more data
 				}
+			}
+			else
+			{
+				// An error occurred with the request
+				request->GetRequestInterceptor()->OnHttpError(request, response, HttpStatusCode::BadRequest);
+				need_to_disconnect = true;
+			}
+
+			break;
+		}
+
+		default:
+			// 이전에 parse 할 때 오류가 발생했다면 response한 뒤 close() 했으므로, 정상적인 상황이라면 여기에 진입하면 안됨
+			logte("Invalid parse status: %d", request->ParseStatus());
+			OV_ASSERT2(false);
+			need_to_disconnect = true;
+			break;
+	}
+
+	return (need_to_disconnect == false);
+}
+
+std::shared_ptr<HttpRequestInterceptor> HttpServer::FindInterceptor(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response)
+{
+	{
+		std::lock_guard<std::mutex> guard(_interceptor_list_mutex);
 
+		for(auto &interceptor : _interceptor_list)
+		{
+			if(interceptor->IsInterceptorForRequest(request, response))
+			{
+				request->SetRequestInterceptor(interceptor);
 				break;
 			}
+		}
+	}
 
-			default:
-				// 이전에 parse 할 때 오류가 발생했다면 response한 뒤 close() 했으므로, 정상적인 상황이라면 여기에 진입하면 안됨
-				logte("Invalid parse status: %d", request->ParseStatus());
-				OV_ASSERT2(false);
-				need_to_disconnect = true;
-				break;
+	return request->GetRequestInterceptor();
+}
+
+bool HttpServer::StartHttp2(const std::shared_ptr<HttpClient> &client)
+{
+	auto remote = client->GetRequest()->GetRemote();
+
+	// The server outlives the clients (the clients are disconnected by Stop())
+	auto session = std::make_shared<Http2Session>(remote, client->GetTls(), _default_interceptor,
+												  [this](const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response, const std::shared_ptr<const ov::Data> &body) -> bool {
+													  return ProcessHttp2Request(request, response, body);
+												  });
+
+	{
+		std::lock_guard<std::mutex> guard(client->_request_guard);
+
+		client->_http2_session = session;
+
+		if(_keep_alive_timeout > 0)
+		{
+			ArmIdleTimer(client);
 		}
+	}
 
-		if(need_to_disconnect)
+	// The requests are not parsed by the client, so the connection is set up here
+	remote->CompleteHandshake();
+
+	logti("HTTP/2 is negotiated: %s", remote->ToString().CStr());
+
+	return session->Start();
+}
+
+bool HttpServer::ProcessHttp2Request(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response, const std::shared_ptr<const ov::Data> &body)
+{
+	auto interceptor = FindInterceptor(request, response);
+
+	if(interceptor == nullptr)
+	{
+		OV_ASSERT2(false);
+		return false;
+	}
+
+	return interceptor->OnHttpPrepare(request, response) && interceptor->OnHttpData(request, response, body);
+}
+
+std::shared_ptr<const ov::Data> HttpServer::SplitPipelinedData(const std::shared_ptr<HttpClient> &client, const std::shared_ptr<const ov::Data> &data, bool &is_overflow)
+{
+	ssize_t remained_body_length = std::max(client->GetRequest()->GetContentLength() - client->_received_body_length, 0L);
+	size_t body_length = std::min(static_cast<size_t>(remained_body_length), data->GetLength());
+
+	client->_received_body_length += body_length;
+
+	if(body_length < data->GetLength())
+	{
+		if(client->_pending_data == nullptr)
 		{
-			// 연결을 종료해야 함
-			Disconnect(client);
+			client->_pending_data = std::make_shared<ov::Data>();
+		}
+
+		client->_pending_data->Append(data->GetDataAs<uint8_t>() + body_length, data->GetLength() - body_length);
+
+		if(client->_pending_data->GetLength() > HTTP_MAX_PENDING_DATA_SIZE)
+		{
+			logtw("Too many pipelined requests from %s: %zu bytes", client->GetRequest()->GetRemote()->ToString().CStr(), client->_pending_data->GetLength());
+			is_overflow = true;
+		}
+	}
+
+	return data->Subdata(0L, body_length);
+}
+
+bool HttpServer::FinishResponse(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response)
+{
+	if(response->IsHttp2())
+	{
+		// The other streams of the connection are still processed
+		return true;
+	}
+
+	auto client = FindClient(request->GetRemote());
+
+	if(client == nullptr)
+	{
+		// Already disconnected
+		return false;
+	}
+
+	if((_keep_alive_timeout <= 0) || (response->IsKeepAlive() == false) || (response->IsConnected() == false))
+	{
+		return Disconnect(client);
+	}
+
+	bool need_to_disconnect = false;
+
+	{
+		std::lock_guard<std::mutex> guard(client->_request_guard);
+
+		if(client->GetRequest() != request)
+		{
+			// The request has been finished already
+			return false;
+		}
+
+		client->ResetRequest();
+
+		ArmIdleTimer(client);
+
+		// Process the pipelined requests
+		auto pending_data = std::move(client->_pending_data);
+
+		if(pending_data != nullptr)
+		{
+			need_to_disconnect = (ProcessDataInternal(client, pending_data) == false);
+		}
+	}
+
+	if(need_to_disconnect)
+	{
+		Disconnect(client);
+	}
+
+	return true;
+}
+
+void HttpServer::ArmIdleTimer(const std::shared_ptr<HttpClient> &client)
+{
+	if(client->_idle_timer_id != 0)
+	{
+		return;
+	}
+
+	// The timer is armed once per connection, and it checks _last_activity_time when it is called
+	std::weak_ptr<HttpServer> weak_server = GetSharedPtr();
+	std::weak_ptr<HttpClient> weak_client = client;
+
+	client->_idle_timer_id = ov::SharedTimerWheel::Instance()->Schedule(_keep_alive_timeout * 1000, [weak_server, weak_client]() -> int64_t {
+		auto server = weak_server.lock();
+		auto client = weak_client.lock();
+
+		return ((server != nullptr) && (client != nullptr)) ? server->OnIdleTimer(client) : 0;
+	});
+}
+
+int64_t HttpServer::OnIdleTimer(const std::shared_ptr<HttpClient> &client)
+{
+	{
+		std::unique_lock<std::mutex> request_lock(client->_request_guard, std::try_to_lock);
+
+		if(request_lock.owns_lock() == false)
+		{
+			// The client is processing the data
+			return HTTP_IDLE_CHECK_INTERVAL;
+		}
+
+		if(client->_http2_session != nullptr)
+		{
+			if(client->_http2_session->HasActiveStreams())
+			{
+				// The responses are being sent (e.g. the blocking requests of LL-HLS)
+				return _keep_alive_timeout * 1000;
+			}
+		}
+		else if(client->_request->ParseStatus() != HttpStatusCode::PartialContent)
+		{
+			// The next request is being processed, the timer is armed again by FinishResponse()
+			client->_idle_timer_id = 0;
+			return 0;
 		}
+
+		time_t idle_time = time(nullptr) - client->_last_activity_time;
+
+		if(idle_time <= _keep_alive_timeout)
+		{
+			// Received the data of the next request
+			return (_keep_alive_timeout - idle_time + 1) * 1000;
+		}
+
+		client->_idle_timer_id = 0;
+	}
+
+	logtd("Client(%s) has been idle for %d seconds", client->_request->GetRemote()->ToString().CStr(), _keep_alive_timeout);
+
+	Disconnect(client);
+
+	return 0;
+}
+
+void HttpServer::CancelIdleTimer(const std::shared_ptr<HttpClient> &client)
+{
+	uint64_t timer_id = client->_idle_timer_id.exchange(0);
+
+	if(timer_id != 0)
+	{
+		ov::SharedTimerWheel::Instance()->Cancel(timer_id);
 	}
 }
 
@@ -348,6 +611,8 @@ bool HttpServer::DisconnectInternal(std::shared_ptr<HttpClient> client)
 		return false;
 	}
 
+	CancelIdleTimer(client);
+
 	auto request = client->GetRequest();
 	auto response = client->GetResponse();
 	auto interceptor = request->GetRequestInterceptor();
@@ -360,6 +625,12 @@ bool HttpServer::DisconnectInternal(std::shared_ptr<HttpClient> client)
 	{
 		interceptor->OnHttpClosed(request, response);
 	}
+
+	if(client->_http2_session != nullptr)
+	{
+		// The streams which are not finished
+		client->_http2_session->Close();
+	}
 	
 	// HttpClient shared_ptr use count down
 	// HttpResponse release -> Tls Release -> HttpClient(client) Release
@@ -20,7 +20,14 @@
 // RFC7231 - Hypertext Transfer Protocol (HTTP/1.1): Semantics and Content (https://tools.ietf.org/html/rfc7231)
 // RFC7232 - Hypertext Transfer Protocol (HTTP/1.1): Conditional Requests (https://tools.ietf.org/html/rfc7232)
 
-class HttpServer : protected PhysicalPortObserver
+// Idle connections (waiting for the next request) are closed after this time (seconds, 0: keep-alive disabled)
+#define HTTP_DEFAULT_KEEP_ALIVE_TIMEOUT		15
+// Maximum size of the pipelined requests which are waiting for the current request to be finished
+#define HTTP_MAX_PENDING_DATA_SIZE			(64 * 1024)
+// Delay to check the idle connection again if the connection is processing the data (milliseconds)
+#define HTTP_IDLE_CHECK_INTERVAL			1000
+
+class HttpServer : protected PhysicalPortObserver, public ov::EnableSharedFromThis<HttpServer>
 {
 public:
 	using ClientList = std::map<ov::Socket *, std::shared_ptr<HttpClient>>;
@@ -43,14 +50,54 @@ public:
 	bool Disconnect(std::shared_ptr<HttpClient> client);
 	bool Disconnect(const std::shared_ptr<ov::Socket> &remote);
 
+	// Persistent connection (RFC7230 - 6.3)
+	// - Must be called before Start()
+	void SetKeepAliveTimeout(int timeout);
+
+	bool IsKeepAliveEnabled() const
+	{
+		return _keep_alive_timeout > 0;
+	}
+
+	// SO_MAX_PACING_RATE of the connections (bps, 0: unlimited)
+	// - Must be called before Start()
+	void SetMaxPacingRate(uint64_t rate);
+
+	// Called when the response of the request has been sent completely
+	// - keep-alive: the connection waits for the next request (pipelined requests are processed immediately)
+	// - otherwise: the connection is closed
+	// - HTTP/2: nothing to do (the stream is finished by the response, the connection is kept)
+	bool FinishResponse(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response);
+
 protected:
 	// @return 파싱이 성공적으로 되었다면 true를, 데이터가 더 필요하거나 오류가 발생하였다면 false이 반환됨
 	ssize_t TryParseHeader(const std::shared_ptr<const ov::Data> &data, const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response);
 
 	std::shared_ptr<HttpClient> FindClient(const std::shared_ptr<ov::Socket> &remote);
 
+	// Finds the interceptor for the request, and sets it to the request
+	std::shared_ptr<HttpRequestInterceptor> FindInterceptor(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response);
+
+	// The connection becomes HTTP/2 (e.g. "h2" is negotiated by ALPN, the rest of the data is the frames)
+	bool StartHttp2(const std::shared_ptr<HttpClient> &client);
+	// Called by Http2Session when a request of a stream is received completely
+	bool ProcessHttp2Request(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response, const std::shared_ptr<const ov::Data> &body);
+
 	void ProcessData(std::shared_ptr<HttpClient> &client, const std::shared_ptr<const ov::Data> &data);
 
+	// client->_request_guard must be locked
+	// @return 연결을 종료해야 하면 false
+	bool ProcessDataInternal(const std::shared_ptr<HttpClient> &client, const std::shared_ptr<const ov::Data> &data);
+
+	// Returns the part of the body of the current request, and keeps the rest (the pipelined requests) to the client
+	std::shared_ptr<const ov::Data> SplitPipelinedData(const std::shared_ptr<HttpClient> &client, const std::shared_ptr<const ov::Data> &data, bool &is_overflow);
+
+	// The timer is armed once per connection (client->_request_guard must be locked)
+	void ArmIdleTimer(const std::shared_ptr<HttpClient> &client);
+	// Called by the idle timer of the client, returns the delay of the next check (0: the timer is finished)
+	int64_t OnIdleTimer(const std::shared_ptr<HttpClient> &client);
+	void CancelIdleTimer(const std::shared_ptr<HttpClient> &client);
+
 	//--------------------------------------------------------------------
 	// Implementation of PhysicalPortObserver
 	//--------------------------------------------------------------------
@@ -71,4 +118,7 @@ protected:
 	std::mutex _interceptor_list_mutex;
 	std::vector<std::shared_ptr<HttpRequestInterceptor>> _interceptor_list;
 	std::shared_ptr<HttpRequestInterceptor> _default_interceptor = std::make_shared<HttpDefaultInterceptor>();
+
+	int _keep_alive_timeout = HTTP_DEFAULT_KEEP_ALIVE_TIMEOUT;
+	uint64_t _max_pacing_rate = 0;
 };
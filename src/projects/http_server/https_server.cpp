@@ -28,6 +28,30 @@ void HttpsServer::SetChainCertificate(const std::shared_ptr<Certificate> &certif
 	_chain_certificate = certificate;
 }
 
+std::shared_ptr<ov::TlsContext> HttpsServer::GetTlsContext()
+{
+	std::lock_guard<std::mutex> lock_guard(_tls_context_mutex);
+
+	if(_tls_context == nullptr)
+	{
+		auto tls_context = std::make_shared<ov::TlsContext>();
+
+		if(tls_context->Prepare(TLS_server_method(), _local_certificate, _chain_certificate, HTTP_INTERMEDIATE_COMPATIBILITY) == false)
+		{
+			return nullptr;
+		}
+
+		if(_http2_enabled && (tls_context->SetAlpnProtocols({ "h2", "http/1.1" }) == false))
+		{
+			return nullptr;
+		}
+
+		_tls_context = tls_context;
+	}
+
+	return _tls_context;
+}
+
 void HttpsServer::OnConnected(const std::shared_ptr<ov::Socket> &remote)
 {
 	HttpServer::OnConnected(remote);
@@ -68,9 +92,10 @@ void HttpsServer::OnConnected(const std::shared_ptr<ov::Socket> &remote)
 			.verify_callback = nullptr
 		};
 
+	auto tls_context = GetTlsContext();
 	auto tls = std::make_shared<ov::Tls>();
 
-	if(tls->Initialize(TLS_server_method(), _local_certificate, _chain_certificate, HTTP_INTERMEDIATE_COMPATIBILITY, callback) == false)
+	if((tls_context == nullptr) || (tls->Initialize(tls_context, callback) == false))
 	{
         logte("Tls initialize fail");
 
@@ -125,7 +150,20 @@ void HttpsServer::OnDataReceived(const std::shared_ptr<ov::Socket> &remote, cons
 			case SSL_ERROR_NONE:
 				client->MarkAsAccepted();
 
-				logti("Accepted");
+				// Offloads the encryption of the responses to the kernel if possible
+				if(tls->EnableKernelTlsTx(remote->GetSocket().GetSocket()))
+				{
+					logtd("kTLS is enabled: %s", remote->ToString().CStr());
+				}
+
+				logti("Accepted%s", tls->IsSessionReused() ? " (session resumed)" : "");
+
+				if(_http2_enabled && (tls->GetSelectedAlpnProtocol() == "h2") && (StartHttp2(client) == false))
+				{
+					logte("Could not start HTTP/2: %s", remote->ToString().CStr());
+					HttpServer::Disconnect(client);
+					return;
+				}
 				break;
 
 			case SSL_ERROR_WANT_READ:
@@ -144,7 +182,8 @@ void HttpsServer::OnDataReceived(const std::shared_ptr<ov::Socket> &remote, cons
 	{
 		logtd("Trying to read data from TLS module...");
 
-		auto plain_data = tls->Read();
+		// The session serializes the TLS with the responses of the streams
+		auto plain_data = (client->_http2_session != nullptr) ? client->_http2_session->ReadTls() : tls->Read();
 
 		if((plain_data != nullptr) && (plain_data->GetLength() > 0))
 		{
@@ -21,7 +21,23 @@ public:
     {
         _tls_write_to_response = tls_write_to_response;
     }
+
+	// HTTP/2 is negotiated by ALPN ("h2", and "http/1.1" for the other clients)
+	// - Must be called before Start()
+	void SetHttp2Enabled(bool http2_enabled)
+	{
+		_http2_enabled = http2_enabled;
+	}
+
+	bool IsHttp2Enabled() const
+	{
+		return _http2_enabled;
+	}
+
 protected:
+	// The context is made when the first client is connected, and shared by all the clients
+	std::shared_ptr<ov::TlsContext> GetTlsContext();
+
 	//--------------------------------------------------------------------
 	// Implementation of PhysicalPortObserver
 	//--------------------------------------------------------------------
@@ -32,4 +48,8 @@ protected:
 	std::shared_ptr<Certificate> _local_certificate = nullptr;
 	std::shared_ptr<Certificate> _chain_certificate = nullptr;
 	bool _tls_write_to_response = false;
+	bool _http2_enabled = false;
+
+	std::mutex _tls_context_mutex;
+	std::shared_ptr<ov::TlsContext> _tls_context = nullptr;
 };
@@ -95,6 +95,11 @@ ssize_t WebSocketClient::Send(const Json::Value &value)
 	return Send(ov::Json::Stringify(value));
 }
 
+ssize_t WebSocketClient::Send(const ov::JsonWriter &writer)
+{
+	return Send(writer.ToData(), WebSocketFrameOpcode::Text);
+}
+
 void WebSocketClient::Close()
 {
 	_remote->Close();
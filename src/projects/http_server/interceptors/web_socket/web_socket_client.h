@@ -26,6 +26,8 @@ public:
 	ssize_t Send(const std::shared_ptr<const ov::Data> &data);
 	ssize_t Send(const ov::String &string);
 	ssize_t Send(const Json::Value &value);
+	// The text is sent from the buffer of the writer (no copy)
+	ssize_t Send(const ov::JsonWriter &writer);
 
 	const std::shared_ptr<HttpRequest> &GetRequest()
 	{
@@ -115,6 +115,7 @@ class WebSocketClient;
 class WebSocketFrame;
 
 typedef std::function<bool(const std::shared_ptr<WebSocketClient> &response)> WebSocketConnectionHandler;
+// The frame is reused for the next message after the handler returns (the payload is copied on write if it is kept)
 typedef std::function<bool(const std::shared_ptr<WebSocketClient> &response, const std::shared_ptr<const WebSocketFrame> &message)> WebSocketMessageHandler;
 typedef std::function<void(const std::shared_ptr<WebSocketClient> &response, const std::shared_ptr<const ov::Error> &error)> WebSocketErrorHandler;
 typedef std::function<void(const std::shared_ptr<WebSocketClient> &response)> WebSocketCloseHandler;
@@ -10,20 +10,47 @@
 #include "../../http_private.h"
 
 #include <algorithm>
+#include <cinttypes>
 
 WebSocketFrame::WebSocketFrame()
 	: _remained_length(0L),
 	  _total_length(0L),
 
-	  _last_status(WebSocketFrameParseStatus::Prepare)
+	  _last_status(WebSocketFrameParseStatus::Prepare),
+
+	  _payload(std::make_shared<ov::Data>()),
+	  _control_payload(std::make_shared<ov::Data>())
 {
+	::memset(&_header, 0, sizeof(_header));
+	::memset(_masking_key, 0, sizeof(_masking_key));
 }
 
 WebSocketFrame::~WebSocketFrame()
 {
 }
 
-ssize_t WebSocketFrame::Process(const std::shared_ptr<const ov::Data> &data)
+void WebSocketFrame::Reset()
+{
+	if(IsControlFrame())
+	{
+		// The fragments of the message which is being assembled are kept
+		_control_payload->SetLength(0L);
+	}
+	else
+	{
+		_payload->SetLength(0L);
+		_is_fragmented = false;
+	}
+
+	::memset(&_header, 0, sizeof(_header));
+	_header_read_bytes = 0;
+	_total_length = 0L;
+	_remained_length = 0L;
+
+	_last_status = WebSocketFrameParseStatus::Prepare;
+}
+
+ssize_t WebSocketFrame::Process(const void *data, size_t length)
 {
 	switch(_last_status)
 	{
@@ -39,76 +66,100 @@ ssize_t WebSocketFrame::Process(const std::shared_ptr<const ov::Data> &data)
 			return -1L;
 	}
 
-	ov::ByteStream stream(data.get());
-
+	auto current = static_cast<const uint8_t *>(data);
 	ssize_t header_length = 0L;
 
 	if(_last_status == WebSocketFrameParseStatus::Prepare)
 	{
-		header_length = ProcessHeader(stream);
+		header_length = ProcessHeader(current, length);
 
 		if(_last_status != WebSocketFrameParseStatus::Parsing)
 		{
 			return header_length;
 		}
+
+		current += header_length;
+		length -= header_length;
 	}
 
 	// 남은 데이터와 websocket frame 크기 중, 작은 크기를 구해 데이터를 누적함
-	size_t length = std::min(stream.Remained(), _remained_length);
+	size_t payload_length = static_cast<size_t>(std::min(static_cast<uint64_t>(length), _remained_length));
 
-	if(length > 0L)
+	if(payload_length > 0L)
 	{
-		// 잔여 데이터가 있다면 payload에 추가
-		if(_payload->Append(stream.GetRemainData()->GetData(), length) == false)
-		{
-			return -1L;
-		}
-	}
+		// Unmask into the buffer directly (the buffer is reserved by ProcessHeader())
+		size_t offset = _frame_payload->GetLength();
+		size_t frame_offset = static_cast<size_t>(_total_length - _remained_length);
 
-	_remained_length -= length;
+		_frame_payload->SetLength(offset + payload_length);
 
-	if(_payload->GetLength() == _total_length)
-	{
-		OV_ASSERT2(_remained_length == 0L);
+		auto destination = _frame_payload->GetWritableDataAs<uint8_t>() + offset;
 
-		// masking 처리
 		if(_header.mask)
 		{
-			size_t payload_length = _payload->GetLength();
+			Unmask(destination, current, payload_length, _masking_key, frame_offset);
+		}
+		else
+		{
+			::memcpy(destination, current, payload_length);
+		}
+	}
 
-			// 빠른 처리를 위해 8의 배수로 처리함 (mask가 있을 경우, 데이터 할당 시 이미 8의 배수로 할당해놓음)
+	_remained_length -= payload_length;
 
-			// masking은 반드시 4byte여야 함
-			OV_ASSERT2(sizeof(_frame_masking_key) == 4);
+	if(_remained_length > 0L)
+	{
+		logtd("Data received: %zu / %" PRIu64 " (remained: %" PRIu64 ")", static_cast<size_t>(_total_length - _remained_length), _total_length, _remained_length);
+		return header_length + payload_length;
+	}
 
-			uint64_t mask = static_cast<uint64_t>(_frame_masking_key) << (sizeof(_frame_masking_key) * 8) | static_cast<uint64_t>(_frame_masking_key);
+	if((IsControlFrame() == false) && (_header.fin == false))
+	{
+		// Wait for the next fragment
+		logtd("The fragment is finished: %s", ToString().CStr());
 
-			// 8의 배수로 만듦
-			size_t count = ((payload_length + 7L) / 8L);
-			_payload->SetLength(static_cast<size_t>(count * 8L));
+		_is_fragmented = true;
+		_header_read_bytes = 0;
+		_last_status = WebSocketFrameParseStatus::Prepare;
 
-			auto current = _payload->GetWritableDataAs<uint64_t>();
+		return header_length + payload_length;
+	}
 
-			for(size_t index = 0; index < count; index++)
-			{
-				*current ^= mask;
-				current++;
-			}
+	logtd("The frame is finished: %s", ToString().CStr());
 
-			_payload->SetLength(payload_length);
-		}
+	_last_status = WebSocketFrameParseStatus::Completed;
+	return header_length + payload_length;
+}
 
-		logtd("The frame is finished: %s", ToString().CStr());
+void WebSocketFrame::Unmask(uint8_t *destination, const uint8_t *source, size_t length, const uint8_t *masking_key, size_t mask_offset)
+{
+	// The masking key, rotated by the offset of the payload, repeated to 64 bits
+	uint8_t key[8];
 
-		_last_status = WebSocketFrameParseStatus::Completed;
-		return header_length + length;
+	for(size_t index = 0; index < sizeof(key); index++)
+	{
+		key[index] = masking_key[(mask_offset + index) % 4];
 	}
 
-	logtd("Data received: %ld / %ld (remained: %ld)", _payload->GetLength(), _total_length, _remained_length);
+	uint64_t mask;
+	::memcpy(&mask, key, sizeof(mask));
+
+	// 8 bytes at a time (memcpy() is used for the unaligned access, the compiler may vectorize the loop)
+	size_t index = 0;
 
-	OV_ASSERT(_payload->GetLength() <= _total_length, "Invalid payload length: payload length (%ld) must less equal than total length (%ld)", _payload->GetLength(), _total_length);
+	for(; (index + sizeof(mask)) <= length; index += sizeof(mask))
+	{
+		uint64_t value;
+
+		::memcpy(&value, source + index, sizeof(value));
+		value ^= mask;
+		::memcpy(destination + index, &value, sizeof(value));
+	}
 
-	return header_length + length;
+	for(; index < length; index++)
+	{
+		destination[index] = source[index] ^ key[index % sizeof(key)];
+	}
 }
 
 WebSocketFrameParseStatus WebSocketFrame::GetStatus() const noexcept
@@ -121,35 +172,89 @@ const WebSocketFrameHeader &WebSocketFrame::GetHeader()
 	return _header;
 }
 
-ssize_t WebSocketFrame::ProcessHeader(ov::ByteStream &stream)
+WebSocketFrameOpcode WebSocketFrame::GetOpcode() const noexcept
 {
-	ssize_t before_offset = stream.GetOffset();
-	ssize_t read_count = stream.Read(reinterpret_cast<char *>(&_header) + _header_read_bytes, sizeof(_header) - _header_read_bytes);
+	return IsControlFrame() ? static_cast<WebSocketFrameOpcode>(_header.opcode) : _message_opcode;
+}
 
-	if(read_count >= 0)
+size_t WebSocketFrame::GetHeaderSize() const
+{
+	if(_header_read_bytes < sizeof(_header))
 	{
-		_header_read_bytes += read_count;
+		return sizeof(_header);
 	}
 
-	if(_header_read_bytes != sizeof(_header))
+	auto header = reinterpret_cast<const WebSocketFrameHeader *>(_header_buffer);
+	size_t header_size = sizeof(_header);
+
+	if(header->payload_length == 126)
+	{
+		header_size += sizeof(uint16_t);
+	}
+	else if(header->payload_length == 127)
 	{
-		// Not enough data to process
-		return read_count;
+		header_size += sizeof(uint64_t);
 	}
 
+	return header_size + (header->mask ? sizeof(_masking_key) : 0);
+}
+
+ssize_t WebSocketFrame::ProcessHeader(const uint8_t *data, size_t length)
+{
+	size_t read_bytes = 0;
+
+	// The size of the header is known after the first 2 bytes are read
+	while(_header_read_bytes < GetHeaderSize())
+	{
+		if(read_bytes == length)
+		{
+			// Not enough data to process
+			return read_bytes;
+		}
+
+		size_t count = std::min(GetHeaderSize() - _header_read_bytes, length - read_bytes);
+
+		::memcpy(_header_buffer + _header_read_bytes, data + read_bytes, count);
+		_header_read_bytes += count;
+		read_bytes += count;
+	}
+
+	::memcpy(&_header, _header_buffer, sizeof(_header));
+
+	const uint8_t *current = _header_buffer + sizeof(_header);
+
 	// extensions 사용 여부
 	// TODO: 일단은 사용하지 않는 것으로 간주
 	bool extensions = false;
 
 	if((extensions == false) && (_header.reserved != 0x00))
 	{
-		OV_ASSERT(false, "Invalid reserved value: %d (expected: %d)", _header.reserved, 0x00);
+		logtw("Invalid reserved value: %d (expected: %d)", _header.reserved, 0x00);
 		_last_status = WebSocketFrameParseStatus::Error;
 		return -1L;
 	}
 
-	_total_length = 0L;
-	_remained_length = 0L;
+	if(IsControlFrame())
+	{
+		// RFC6455 - 5.5. All control frames MUST have a payload length of 125 bytes or less and MUST NOT be fragmented.
+		if((_header.fin == false) || (_header.payload_length > 125))
+		{
+			logtw("Invalid control frame: %s", ToString().CStr());
+			_last_status = WebSocketFrameParseStatus::Error;
+			return -1L;
+		}
+	}
+	else if(_is_fragmented != (static_cast<WebSocketFrameOpcode>(_header.opcode) == WebSocketFrameOpcode::Continuation))
+	{
+		// A continuation frame must follow the fragment, and only a fragment
+		logtw("Unexpected opcode: %d (fragmented: %s)", _header.opcode, _is_fragmented ? "true" : "false");
+		_last_status = WebSocketFrameParseStatus::Error;
+		return -1L;
+	}
+	else if(_is_fragmented == false)
+	{
+		_message_opcode = static_cast<WebSocketFrameOpcode>(_header.opcode);
+	}
 
 	// 길이 계산
 	//
@@ -177,18 +282,10 @@ ssize_t WebSocketFrame::ProcessHeader(ov::ByteStream &stream)
 			// 126이면, 다음 이어서 오는 16bit가 payload length
 			uint16_t extra_length;
 
-			if(stream.Read(&extra_length) == 1)
-			{
-				_total_length = ov::NetworkToHost16(extra_length);
-				_remained_length = _total_length;
-			}
-			else
-			{
-				OV_ASSERT(false, "Could not read payload length");
-				_last_status = WebSocketFrameParseStatus::Error;
-				return -1L;
-			}
+			::memcpy(&extra_length, current, sizeof(extra_length));
+			current += sizeof(extra_length);
 
+			_total_length = ov::NetworkToHost16(extra_length);
 			break;
 		}
 
@@ -197,42 +294,52 @@ ssize_t WebSocketFrame::ProcessHeader(ov::ByteStream &stream)
 			// 127이면, 다음 이어서 오는 64bit가 payload length
 			uint64_t extra_length;
 
-			if(stream.Read(&extra_length) == 1)
-			{
-				_total_length = ov::NetworkToHost64(extra_length);
-				_remained_length = _total_length;
-			}
-			else
+			::memcpy(&extra_length, current, sizeof(extra_length));
+			current += sizeof(extra_length);
+
+			_total_length = ov::NetworkToHost64(extra_length);
+
+			// The most significant bit must be 0 (RFC 6455 5.2)
+			if(_total_length & 0x8000000000000000ULL)
 			{
-				OV_ASSERT(false, "Could not read payload length");
+				logtw("Invalid payload length: %" PRIu64, _total_length);
 				_last_status = WebSocketFrameParseStatus::Error;
 				return -1L;
 			}
-
 			break;
 		}
 
 		default:
 			_total_length = _header.payload_length;
-			_remained_length = _total_length;
 	}
 
-	// masking을 해야한다면, 나중에 속도 최적화를 위해 8의 배수로 masking을 처리하는데, 이 때 버퍼 재할당이 일어나지 않도록 8의 배수로 미리 맞춰놓음
-	ssize_t total_length = _header.mask ? (_total_length / 8L) * 8L : _total_length;
-	_payload = std::make_shared<ov::Data>(total_length);
+	_remained_length = _total_length;
 
 	if(_header.mask)
 	{
-		if(stream.Read(&_frame_masking_key) != 1)
-		{
-			OV_ASSERT(false, "Could not read masking key");
-			_last_status = WebSocketFrameParseStatus::Error;
-			return -1L;
-		}
+		::memcpy(_masking_key, current, sizeof(_masking_key));
+	}
+
+	_frame_payload = IsControlFrame() ? _control_payload : _payload;
+
+	// Compared without adding the lengths, so a huge _total_length cannot wrap around
+	if((_frame_payload->GetLength() > WEB_SOCKET_MAX_MESSAGE_SIZE) ||
+	   (_total_length > (WEB_SOCKET_MAX_MESSAGE_SIZE - _frame_payload->GetLength())))
+	{
+		logtw("Too large message: %zu + %" PRIu64 " bytes (max: %d)", _frame_payload->GetLength(), _total_length, WEB_SOCKET_MAX_MESSAGE_SIZE);
+		_last_status = WebSocketFrameParseStatus::Error;
+		return -1L;
+	}
+
+	// The buffer is allocated once for the frame
+	if(_frame_payload->Reserve(_frame_payload->GetLength() + static_cast<size_t>(_total_length)) == false)
+	{
+		_last_status = WebSocketFrameParseStatus::Error;
+		return -1L;
 	}
 
 	_last_status = WebSocketFrameParseStatus::Parsing;
-	return stream.GetOffset() - before_offset;
+	return read_bytes;
 }
 
 ov::String WebSocketFrame::ToString() const
@@ -10,6 +10,11 @@
 
 #include "./web_socket_datastructure.h"
 
+// Size of the header: base(2) + extended payload length(8) + masking key(4)
+#define WEB_SOCKET_MAX_HEADER_SIZE		14
+// The message (including the fragments) which exceeds this size is regarded as an error
+#define WEB_SOCKET_MAX_MESSAGE_SIZE		(1024 * 1024)
+
 enum class WebSocketFrameParseStatus
 {
 	Prepare,
@@ -18,45 +23,66 @@ enum class WebSocketFrameParseStatus
 	Error,
 };
 
+// Parses the frames of a connection incrementally
+//
+// - The header can be split into any number of chunks
+// - The payload is unmasked while it is copied into the buffer, and the buffer is reused for the next messages
+// - The fragments of a message (continuation frames) are appended to the same buffer,
+//   and the control frames between them are completed separately
 class WebSocketFrame
 {
 public:
 	WebSocketFrame();
 	virtual ~WebSocketFrame();
 
-	void Reset()
-	{
-		::memset(&_header, 0, sizeof(_header));
-		_total_length = 0L;
-
-		_last_status = WebSocketFrameParseStatus::Prepare;
-
-		_payload->Clear();
-	}
+	// Prepares the next message after the completed one (the buffer is kept)
+	void Reset();
 
+	// Payload of the completed message (the buffer is reused after Reset(), copy-on-write if it is referenced)
 	const std::shared_ptr<const ov::Data> GetPayload() const noexcept
 	{
-		return _payload;
+		return IsControlFrame() ? _control_payload : _payload;
 	}
 
-	ssize_t Process(const std::shared_ptr<const ov::Data> &data);
+	// Returns the number of bytes consumed (a frame at most), or -1 if an error occurred
+	ssize_t Process(const void *data, size_t length);
 	WebSocketFrameParseStatus GetStatus() const noexcept;
 
 	const WebSocketFrameHeader &GetHeader();
+	// Opcode of the completed message (the opcode of the first fragment)
+	WebSocketFrameOpcode GetOpcode() const noexcept;
 
 	ov::String ToString() const;
 
 protected:
-	ssize_t ProcessHeader(ov::ByteStream &stream);
+	ssize_t ProcessHeader(const uint8_t *data, size_t length);
+	size_t GetHeaderSize() const;
+
+	bool IsControlFrame() const noexcept
+	{
+		return (_header.opcode & 0x08) != 0;
+	}
+
+	static void Unmask(uint8_t *destination, const uint8_t *source, size_t length, const uint8_t *masking_key, size_t mask_offset);
 
 	WebSocketFrameHeader _header;
-	int _header_read_bytes = 0;
+	uint8_t _header_buffer[WEB_SOCKET_MAX_HEADER_SIZE];
+	size_t _header_read_bytes = 0;
 
 	uint64_t _remained_length;
 	uint64_t _total_length;
-	uint32_t _frame_masking_key;
+	uint8_t _masking_key[4];
 
 	WebSocketFrameParseStatus _last_status;
 
+	// Opcode of the first fragment, and whether the next frame must be a continuation frame
+	WebSocketFrameOpcode _message_opcode = WebSocketFrameOpcode::Continuation;
+	bool _is_fragmented = false;
+
+	// Payload of the data frames (a fragmented message is assembled here)
 	std::shared_ptr<ov::Data> _payload;
+	// Payload of the control frames (they can be between the fragments of a message)
+	std::shared_ptr<ov::Data> _control_payload;
+	// Where the payload of the current frame is written
+	std::shared_ptr<ov::Data> _frame_payload;
 };
@@ -139,71 +139,81 @@ bool WebSocketInterceptor::OnHttpData(const std::shared_ptr<HttpRequest> &reques
 		return false;
 	}
 
+#if DEBUG
 	logtd("Data is received\n%s", data->Dump().CStr());
+#endif // DEBUG
 
 	if(item->second.frame == nullptr)
 	{
+		// The frame (and its buffer) is reused for the messages of the connection
 		item->second.frame = std::make_shared<WebSocketFrame>();
 	}
 
 	auto frame = item->second.frame;
-	auto processed_bytes = frame->Process(data);
+	auto current = data->GetDataAs<uint8_t>();
+	size_t remained = data->GetLength();
 
-	switch(frame->GetStatus())
+	// 모든 데이터를 파싱할 때 까지 반복
+	while(remained > 0L)
 	{
-		case WebSocketFrameParseStatus::Prepare:
-			// Not enough data to parse header
-			break;
+		auto processed_bytes = frame->Process(current, remained);
 
-		case WebSocketFrameParseStatus::Parsing:
-			break;
+		if(processed_bytes < 0L)
+		{
+			// 잘못된 데이터가 수신되었음 WebSocket 연결을 해제함
+			logtw("Invalid data received from %s", request->ToString().CStr());
+			return false;
+		}
+
+		current += processed_bytes;
+		remained -= processed_bytes;
 
-		case WebSocketFrameParseStatus::Completed:
+		switch(frame->GetStatus())
 		{
-			const std::shared_ptr<const ov::Data> payload = frame->GetPayload();
+			case WebSocketFrameParseStatus::Prepare:
+				// Not enough data to parse header, or the next fragment is expected
+				break;
 
-			if(static_cast<WebSocketFrameOpcode>(frame->GetHeader().opcode) == WebSocketFrameOpcode::ConnectionClose)
-			{
-				// 접속 종료 요청됨
-				logtd("Client requested close connection: reason:\n%s", payload->Dump("Reason").CStr());
-				return false;
-			}
-			else
+			case WebSocketFrameParseStatus::Parsing:
+				break;
+
+			case WebSocketFrameParseStatus::Completed:
 			{
+				const std::shared_ptr<const ov::Data> payload = frame->GetPayload();
+
+				if(frame->GetOpcode() == WebSocketFrameOpcode::ConnectionClose)
+				{
+					// 접속 종료 요청됨
+#if DEBUG
+					logtd("Client requested close connection: reason:\n%s", payload->Dump("Reason").CStr());
+#endif // DEBUG
+					return false;
+				}
+
+#if DEBUG
 				logtd("%s:\n%s", frame->ToString().CStr(), payload->Dump("Frame", 0L, 1024L, nullptr).CStr());
+#endif // DEBUG
 
 				// 패킷 조립이 완료되었음
-				// 상위 레벨로 올림
-				if(_message_handler != nullptr)
+				// 상위 레벨로 올림 (데이터가 있을 경우에만 올림)
+				if((_message_handler != nullptr) && (payload->GetLength() > 0L))
 				{
-					if(payload->GetLength() > 0L)
+					if(_message_handler(item->second.response, frame) == false)
 					{
-						// 데이터가 있을 경우에만 올림
-						if(_message_handler(item->second.response, frame) == false)
-						{
-							return false;
-						}
+						return false;
 					}
-
-					item->second.frame = nullptr;
 				}
 
 				// 나머지 데이터로 다시 파싱 시작
-				OV_ASSERT2(processed_bytes >= 0L);
-
-				if(processed_bytes > 0L)
-				{
-					return OnHttpData(request, response, data->Subdata(processed_bytes));
-				}
+				frame->Reset();
+				break;
 			}
 
-			break;
+			case WebSocketFrameParseStatus::Error:
+				// 잘못된 데이터가 수신되었음 WebSocket 연결을 해제함
+				logtw("Invalid data received from %s", request->ToString().CStr());
+				return false;
 		}
-
-		case WebSocketFrameParseStatus::Error:
-			// 잘못된 데이터가 수신되었음 WebSocket 연결을 해제함
-			logtw("Invalid data received from %s", request->ToString().CStr());
-			return false;
 	}
 
 	return true;
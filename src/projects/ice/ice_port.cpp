@@ -13,6 +13,7 @@
 #include "stun/attributes/stun_attributes.h"
 
 #include <algorithm>
+#include <string.h>
 
 #include <base/ovlibrary/ovlibrary.h>
 #include <config/config.h>
@@ -20,17 +21,26 @@
 
 IcePort::IcePort()
 {
-	_timer.Push([this](void *paramter) -> bool
-	            {
-		            CheckTimedoutItem();
-		            return true;
-	            }, nullptr, 1000, true);
-	_timer.Start();
 }
 
 IcePort::~IcePort()
 {
-	_timer.Stop();
+	std::vector<std::shared_ptr<IcePortInfo>> info_list;
+
+	{
+		std::lock_guard<ov::ProfiledSharedMutex> lock_guard(_user_mapping_table_mutex);
+
+		_user_mapping_table.EraseIf([&](const ov::String &ufrag, std::shared_ptr<IcePortInfo> &info) -> bool {
+			info_list.push_back(info);
+			return true;
+		});
+	}
+
+	// The timers refer this, so they must be canceled (without the locks which the timers acquire)
+	for(auto &info : info_list)
+	{
+		CancelExpireTimer(info);
+	}
 
 	Close();
 }
@@ -91,6 +101,31 @@ bool IcePort::Create(std::vector<RtcIceCandidate> ice_candidate_list)
 
 	if(succeeded)
 	{
+		std::lock_guard<std::mutex> slot_lock_guard(_port_slot_mutex);
+
+		// The candidates of the same port (the IP addresses of the server) are handed out together
+		for(auto &ice_candidate : ice_candidate_list)
+		{
+			auto transport = ice_candidate.GetTransport().UpperCaseString();
+			int port = ice_candidate.GetAddress().Port();
+
+			auto slot = std::find_if(_port_slots.begin(), _port_slots.end(), [&](const IcePortSlot &port_slot) -> bool {
+				return (port_slot.transport == transport) && (port_slot.port == port);
+			});
+
+			if(slot == _port_slots.end())
+			{
+				IcePortSlot port_slot;
+
+				port_slot.transport = transport;
+				port_slot.port = port;
+
+				slot = _port_slots.insert(_port_slots.end(), std::move(port_slot));
+			}
+
+			slot->candidates.push_back(ice_candidate);
+		}
+
 		_ice_candidate_list = std::move(ice_candidate_list);
 	}
 	else
@@ -106,6 +141,104 @@ const std::vector<RtcIceCandidate> &IcePort::GetIceCandidateList() const
 	return _ice_candidate_list;
 }
 
+void IcePort::SelectIceCandidates(const ov::String &ufrag, std::vector<RtcIceCandidate> *candidates)
+{
+	int64_t current_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	std::lock_guard<std::mutex> lock_guard(_port_slot_mutex);
+
+	RemoveExpiredOffers(current_time);
+
+	size_t slot_count = _port_slots.size();
+
+	if(slot_count == 0)
+	{
+		return;
+	}
+
+	// index of the selected slot for each transport
+	std::map<ov::String, size_t> selected_slots;
+	size_t start_index = _next_port_slot++ % slot_count;
+
+	for(size_t offset = 0; offset < slot_count; offset++)
+	{
+		size_t index = (start_index + offset) % slot_count;
+		auto &port_slot = _port_slots[index];
+
+		auto item = selected_slots.find(port_slot.transport);
+
+		if(item == selected_slots.end())
+		{
+			selected_slots[port_slot.transport] = index;
+		}
+		else if(port_slot.session_count < _port_slots[item->second].session_count)
+		{
+			item->second = index;
+		}
+	}
+
+	PendingOffer pending_offer;
+
+	pending_offer.offered_time = current_time;
+
+	for(auto &item : selected_slots)
+	{
+		auto &port_slot = _port_slots[item.second];
+
+		port_slot.session_count++;
+		pending_offer.port_slots.push_back(item.second);
+
+		candidates->insert(candidates->end(), port_slot.candidates.cbegin(), port_slot.candidates.cend());
+
+		logtd("Port %s/%d is selected for %s (sessions: %d)", port_slot.transport.CStr(), port_slot.port, ufrag.CStr(), port_slot.session_count);
+	}
+
+	auto old_offer = _pending_offers.find(ufrag);
+
+	if(old_offer != _pending_offers.end())
+	{
+		ReleasePortSlots(old_offer->second.port_slots);
+		_pending_offers.erase(old_offer);
+	}
+
+	_pending_offers.emplace(ufrag, std::move(pending_offer));
+}
+
+void IcePort::ReleasePortSlots(const std::shared_ptr<IcePortInfo> &info)
+{
+	std::lock_guard<std::mutex> lock_guard(_port_slot_mutex);
+
+	ReleasePortSlots(info->port_slots);
+	info->port_slots.clear();
+}
+
+void IcePort::ReleasePortSlots(const std::vector<size_t> &port_slots)
+{
+	for(auto index : port_slots)
+	{
+		if(index < _port_slots.size())
+		{
+			_port_slots[index].session_count--;
+		}
+	}
+}
+
+void IcePort::RemoveExpiredOffers(int64_t current_time)
+{
+	for(auto item = _pending_offers.begin(); item != _pending_offers.end();)
+	{
+		if((current_time - item->second.offered_time) > ICE_PORT_PENDING_OFFER_TIMEOUT)
+		{
+			ReleasePortSlots(item->second.port_slots);
+			item = _pending_offers.erase(item);
+		}
+		else
+		{
+			++item;
+		}
+	}
+}
+
 std::shared_ptr<PhysicalPort> IcePort::CreatePhysicalPort(const ov::SocketAddress &address, ov::SocketType type)
 {
 	auto physical_port = PhysicalPortManager::Instance()->CreatePort(type, address);
@@ -114,6 +247,21 @@ std::shared_ptr<PhysicalPort> IcePort::CreatePhysicalPort(const ov::SocketAddres
 	{
 		if(physical_port->AddObserver(this))
 		{
+			if(type == ov::SocketType::Udp)
+			{
+				// A video frame is usually packetized into several MTU-sized RTP packets (e.g. FU-A), so they can be sent as one GSO buffer
+				if(physical_port->SetUdpSegmentation(true))
+				{
+					logtd("UDP segmentation is enabled for %s", address.ToString().CStr());
+				}
+
+				// The media are paced per peer by the departure times (effective if the fq qdisc is used)
+				if(physical_port->SetTxTime(true))
+				{
+					logtd("SO_TXTIME is enabled for %s", address.ToString().CStr());
+				}
+			}
+
 			return physical_port;
 		}
 
@@ -149,18 +297,25 @@ bool IcePort::Close()
 
 	_ice_candidate_list.clear();
 
+	{
+		std::lock_guard<std::mutex> slot_lock_guard(_port_slot_mutex);
+
+		_pending_offers.clear();
+		_port_slots.clear();
+	}
+
 	return result;
 }
 
 ov::String IcePort::GenerateUfrag()
 {
-	std::lock_guard<std::mutex> lock_guard(_user_mapping_table_mutex);
+	std::shared_lock<ov::ProfiledSharedMutex> lock(_user_mapping_table_mutex);
 
 	while(true)
 	{
 		ov::String ufrag = ov::Random::GenerateString(6);
 
-		if(_user_mapping_table.find(ufrag) == _user_mapping_table.end())
+		if(_user_mapping_table.Contains(ufrag) == false)
 		{
 			logtd("Generated ufrag: %s", ufrag.CStr());
 
@@ -215,26 +370,28 @@ bool IcePort::RemoveObservers()
 	return true;
 }
 
-void IcePort::AddSession(const std::shared_ptr<SessionInfo> &session_info, std::shared_ptr<SessionDescription> offer_sdp, std::shared_ptr<SessionDescription> peer_sdp)
+void IcePort::AddSession(const std::shared_ptr<SessionInfo> &session_info, std::shared_ptr<SessionDescription> offer_sdp, std::shared_ptr<SessionDescription> peer_sdp, bool is_controlling)
 {
 	const ov::String &local_ufrag = offer_sdp->GetIceUfrag();
 	const ov::String &remote_ufrag = peer_sdp->GetIceUfrag();
 
+	std::shared_ptr<IcePortInfo> info;
+
 	{
-		std::lock_guard<std::mutex> lock_guard(_user_mapping_table_mutex);
+		std::lock_guard<ov::ProfiledSharedMutex> lock_guard(_user_mapping_table_mutex);
 
-		auto item = _user_mapping_table.find(local_ufrag);
+		auto item = _user_mapping_table.Find(local_ufrag);
 		session_id_t session_id = session_info->GetId();
 
-		if(item != _user_mapping_table.end())
+		if(item != nullptr)
 		{
-			OV_ASSERT(false, "Duplicated ufrag: %s:%s, session_id: %d (old session_id: %d)", local_ufrag.CStr(), remote_ufrag.CStr(), session_id, item->second->session_info->GetId());
+			OV_ASSERT(false, "Duplicated ufrag: %s:%s, session_id: %d (old session_id: %d)", local_ufrag.CStr(), remote_ufrag.CStr(), session_id, (*item)->session_info->GetId());
 		}
 
 		logtd("Trying to add session: %d (ufrag: %s:%s)...", session_id, local_ufrag.CStr(), remote_ufrag.CStr());
 
 		// 나중에 STUN Binding request를 대비하여 관련 정보들을 넣어놓음
-		std::shared_ptr<IcePortInfo> info = std::make_shared<IcePortInfo>();
+		info = std::make_shared<IcePortInfo>();
 
 		info->session_info = session_info;
 		info->offer_sdp = offer_sdp;
@@ -242,13 +399,34 @@ void IcePort::AddSession(const std::shared_ptr<SessionInfo> &session_info, std::
 		info->remote = nullptr;
 		info->address = ov::SocketAddress();
 		info->state = IcePortConnectionState::Closed;
+		info->is_controlling = is_controlling;
 
 		info->UpdateBindingTime();
 
-		_user_mapping_table[local_ufrag] = info;
+		{
+			std::lock_guard<std::mutex> slot_lock_guard(_port_slot_mutex);
+
+			auto pending_offer = _pending_offers.find(local_ufrag);
+
+			if(pending_offer != _pending_offers.end())
+			{
+				// The ports are released when the session is removed
+				info->port_slots = std::move(pending_offer->second.port_slots);
+				_pending_offers.erase(pending_offer);
+			}
+		}
+
+		_user_mapping_table.Insert(local_ufrag, info);
+
+		// The deadline is refreshed by the binding requests, so the timer checks it again when it is called
+		std::weak_ptr<IcePortInfo> weak_info = info;
+
+		info->expire_timer_id = ov::SharedTimerWheel::Instance()->Schedule(info->GetRemainedTime(), [this, weak_info]() -> int64_t {
+			return OnExpireTimer(weak_info);
+		});
 	}
 
-	SetIceState(_user_mapping_table[local_ufrag], IcePortConnectionState::New);
+	SetIceState(info, IcePortConnectionState::New);
 }
 
 bool IcePort::RemoveSession(const session_id_t session_id)
@@ -256,28 +434,31 @@ bool IcePort::RemoveSession(const session_id_t session_id)
 	std::shared_ptr<IcePortInfo> ice_port_info;
 
 	{
-		std::lock_guard<std::mutex> lock_guard(_ice_port_info_mutex);
+		std::lock_guard<ov::ProfiledSharedMutex> lock_guard(_ice_port_info_mutex);
 
-		auto item = _session_table.find(session_id);
+		auto item = _session_table.Find(session_id);
 
-		if(item == _session_table.end())
+		if(item == nullptr)
 		{
 			logtw("Could not find session: %d", session_id);
 
 			return false;
 		}
 
-		ice_port_info = item->second;
+		ice_port_info = *item;
 
-		_session_table.erase(item);
-		_ice_port_info.erase(ice_port_info->address);
+		_session_table.Erase(session_id);
+		_ice_port_info.Erase(ice_port_info->address.GetKey());
 	}
 
 	{
-		std::lock_guard<std::mutex> lock_guard(_user_mapping_table_mutex);
-		_user_mapping_table.erase(ice_port_info->offer_sdp->GetIceUfrag());
+		std::lock_guard<ov::ProfiledSharedMutex> lock_guard(_user_mapping_table_mutex);
+		_user_mapping_table.Erase(ice_port_info->offer_sdp->GetIceUfrag());
 	}
 
+	CancelExpireTimer(ice_port_info);
+	ReleasePortSlots(ice_port_info);
+
 	return true;
 }
 
@@ -287,6 +468,31 @@ bool IcePort::RemoveSession(const std::shared_ptr<SessionInfo> &session_info)
 	return RemoveSession(session_id);
 }
 
+bool IcePort::SetPacingRate(session_id_t session_id, uint64_t rate)
+{
+	auto ice_port_info = FindIcePortInfo(session_id);
+
+	if(ice_port_info == nullptr)
+	{
+		return false;
+	}
+
+	if(ice_port_info->pacer.GetRate() == rate)
+	{
+		return true;
+	}
+
+	ice_port_info->pacer.SetRate(rate);
+
+	if(ice_port_info->tcp_connection != nullptr)
+	{
+		// TCP paces the connection by itself
+		return ice_port_info->remote->SetMaxPacingRate(rate);
+	}
+
+	return true;
+}
+
 bool IcePort::Send(const std::shared_ptr<SessionInfo> &session_info, std::unique_ptr<RtpPacket> packet)
 {
 	return Send(session_info, packet->GetData());
@@ -301,42 +507,251 @@ bool IcePort::Send(const std::shared_ptr<SessionInfo> &session_info, const std::
 {
 	// logtd("Finding socket from session #%d...", session_info->GetId());
 
-	std::shared_ptr<IcePortInfo> ice_port_info;
+	auto ice_port_info = FindIcePortInfo(session_info->GetId());
+
+	if(ice_port_info == nullptr)
+	{
+		// logtw("ClientSocket not found for session #%d", session_info->GetId());
+		return false;
+	}
+
+	// logtd("Sending data to remote for session #%d", session_info->GetId());
+	if(ice_port_info->tcp_connection != nullptr)
+	{
+		return SendTcpFrames(ice_port_info->remote, *(ice_port_info->tcp_connection), { data });
+	}
+
+	return ice_port_info->remote->SendTo(ice_port_info->address, data) >= 0;
+}
+
+bool IcePort::Send(const std::shared_ptr<SessionInfo> &session_info, const std::vector<std::shared_ptr<ov::Data>> &data_list)
+{
+	auto ice_port_info = FindIcePortInfo(session_info->GetId());
+
+	if(ice_port_info == nullptr)
+	{
+		return false;
+	}
+
+	return SendToRemote(ice_port_info, data_list);
+}
 
+IcePort::Connection IcePort::GetConnection(session_id_t session_id)
+{
+	auto ice_port_info = FindIcePortInfo(session_id);
+
+	if((ice_port_info == nullptr) || (ice_port_info->remote == nullptr))
 	{
-		std::lock_guard<std::mutex> lock_guard(_ice_port_info_mutex);
+		return nullptr;
+	}
 
-		auto item = _session_table.find(session_info->GetId());
+	return ice_port_info;
+}
 
-		if(item == _session_table.end())
+bool IcePort::SendDirect(const Connection &connection, const std::shared_ptr<ov::Data> &data)
+{
+	// The session is expired (the connection is kept by the egress path until the session is stopped)
+	if((connection->state == IcePortConnectionState::Failed) || (connection->state == IcePortConnectionState::Disconnected))
+	{
+		return false;
+	}
+
+	if(connection->tcp_connection != nullptr)
+	{
+		return SendTcpFrames(connection->remote, *(connection->tcp_connection), { data });
+	}
+
+	return connection->remote->SendTo(connection->address, data) >= 0;
+}
+
+bool IcePort::SendDirect(const Connection &connection, const std::vector<std::shared_ptr<ov::Data>> &data_list)
+{
+	if((connection->state == IcePortConnectionState::Failed) || (connection->state == IcePortConnectionState::Disconnected))
+	{
+		return false;
+	}
+
+	return SendToRemote(connection, data_list);
+}
+
+bool IcePort::SendToRemote(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data)
+{
+	if(remote->GetType() == ov::SocketType::Tcp)
+	{
+		auto connection = FindTcpConnection(remote);
+
+		return (connection != nullptr) && SendTcpFrames(remote, *connection, { data });
+	}
+
+	return remote->SendTo(address, data) >= 0;
+}
+
+bool IcePort::SendToRemote(const std::shared_ptr<IcePortInfo> &info, const std::vector<std::shared_ptr<ov::Data>> &data_list)
+{
+	if(info->tcp_connection != nullptr)
+	{
+		return SendTcpFrames(info->remote, *(info->tcp_connection), std::vector<std::shared_ptr<const ov::Data>>(data_list.begin(), data_list.end()));
+	}
+
+	return info->remote->SendToBatch(info->address, data_list, &(info->pacer)) >= 0;
+}
+
+bool IcePort::SendTcpFrames(const std::shared_ptr<ov::Socket> &remote, TcpConnection &connection, const std::vector<std::shared_ptr<const ov::Data>> &data_list)
+{
+	if(data_list.empty())
+	{
+		return true;
+	}
+
+	// The headers of all frames are written to a buffer, and each frame refers to its part
+	auto headers = std::make_shared<ov::Data>(data_list.size() * ICE_TCP_FRAME_HEADER_SIZE);
+	headers->SetLength(data_list.size() * ICE_TCP_FRAME_HEADER_SIZE);
+	auto header = headers->GetWritableDataAs<uint8_t>();
+
+	std::vector<std::shared_ptr<const ov::Data>> frame_list;
+	frame_list.reserve(data_list.size() * 2);
+
+	size_t total_length = 0;
+
+	for(size_t index = 0; index < data_list.size(); index++)
+	{
+		auto &data = data_list[index];
+
+		if(data->GetLength() > UINT16_MAX)
 		{
-			// logtw("ClientSocket not found for session #%d", session_info->GetId());
+			logtw("Too large packet to send over TCP: %zu bytes", data->GetLength());
 			return false;
 		}
 
-		ice_port_info = item->second;
+		uint16_t length = ov::HostToBE16(static_cast<uint16_t>(data->GetLength()));
+		::memcpy(header + (index * ICE_TCP_FRAME_HEADER_SIZE), &length, ICE_TCP_FRAME_HEADER_SIZE);
+
+		frame_list.push_back(headers->Subdata(index * ICE_TCP_FRAME_HEADER_SIZE, ICE_TCP_FRAME_HEADER_SIZE));
+		frame_list.push_back(data);
+
+		total_length += ICE_TCP_FRAME_HEADER_SIZE + data->GetLength();
 	}
 
-	// logtd("Sending data to remote for session #%d", session_info->GetId());
-	return ice_port_info->remote->SendTo(ice_port_info->address, data) >= 0;
+	std::lock_guard<std::mutex> lock_guard(connection.send_mutex);
+
+	bool is_retry = false;
+	ssize_t sent = remote->SendVector(frame_list, is_retry);
+
+	// A frame which is sent partially breaks the stream, so the connection can't be used anymore
+	return (sent == static_cast<ssize_t>(total_length));
+}
+
+std::shared_ptr<IcePort::TcpConnection> IcePort::FindTcpConnection(const std::shared_ptr<ov::Socket> &remote)
+{
+	std::lock_guard<std::mutex> lock_guard(_tcp_connection_list_mutex);
+
+	auto item = _tcp_connection_list.find(remote.get());
+
+	return (item != _tcp_connection_list.end()) ? item->second : nullptr;
 }
 
 void IcePort::OnConnected(const std::shared_ptr<ov::Socket> &remote)
 {
-	// TODO: 일단은 UDP만 처리하므로, 비워둠. 나중에 TCP 지원할 때 구현해야 함
+	if(remote->GetType() != ov::SocketType::Tcp)
+	{
+		return;
+	}
+
+	logtd("ICE-TCP connection is accepted: %s", remote->ToString().CStr());
+
+	std::lock_guard<std::mutex> lock_guard(_tcp_connection_list_mutex);
+
+	_tcp_connection_list[remote.get()] = std::make_shared<TcpConnection>();
 }
 
 void IcePort::OnDataReceived(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data)
 {
 	// 데이터를 수신했음
+	if(remote->GetType() == ov::SocketType::Tcp)
+	{
+		OnTcpDataReceived(remote, address, data);
+		return;
+	}
+
+	// A datagram contains a packet
+	OnPacketReceived(remote, address, data);
+}
+
+void IcePort::OnTcpDataReceived(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data)
+{
+	auto connection = FindTcpConnection(remote);
+
+	if(connection == nullptr)
+	{
+		logtw("Could not find the TCP connection: %s", remote->ToString().CStr());
+		return;
+	}
 
-	// TODO: 지금은 data 안에 하나의 STUN 메시지만 있을 것으로 간주하고 작성되어 있음
-	// TODO: TCP의 경우, 데이터가 많이 들어올 수 있기 때문에 별도 처리 필요
+	// The data of a connection is received by a thread, so the pending data is not locked
+	std::shared_ptr<const ov::Data> stream = data;
+
+	if(connection->pending_data->GetLength() > 0)
+	{
+		connection->pending_data->Append(data.get());
+		stream = connection->pending_data;
+	}
+
+	auto buffer = stream->GetDataAs<uint8_t>();
+	size_t length = stream->GetLength();
+	size_t offset = 0;
+
+	while((length - offset) >= ICE_TCP_FRAME_HEADER_SIZE)
+	{
+		uint16_t frame_length;
+		::memcpy(&frame_length, buffer + offset, ICE_TCP_FRAME_HEADER_SIZE);
+		frame_length = ov::BE16ToHost(frame_length);
 
-	ov::ByteStream stream(data.get());
+		if((length - offset - ICE_TCP_FRAME_HEADER_SIZE) < frame_length)
+		{
+			// Wait for the rest of the frame
+			break;
+		}
+
+		OnPacketReceived(remote, address, stream->Subdata(offset + ICE_TCP_FRAME_HEADER_SIZE, frame_length));
+
+		offset += ICE_TCP_FRAME_HEADER_SIZE + frame_length;
+	}
+
+	// Keep the partial frame (a new buffer, the frames may still refer the old one)
+	auto pending_data = std::make_shared<ov::Data>();
+
+	if(offset < length)
+	{
+		pending_data->Append(buffer + offset, length - offset);
+	}
+
+	connection->pending_data = pending_data;
+}
+
+void IcePort::OnPacketReceived(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data)
+{
+	// The binding requests of the connected clients are repeated during the session, they are handled without parsing
+	auto ice_port_info = FindIcePortInfo(address);
+
+	if(ice_port_info != nullptr)
+	{
+		// RFC 7983 - The first byte of STUN is 0 or 1 (DTLS: 20-63, RTP/RTCP: 128-191)
+		if((data->GetLength() > 0) && (data->GetDataAs<uint8_t>()[0] > 3))
+		{
+			NotifyDataReceived(ice_port_info, data);
+			return;
+		}
+
+		if(ProcessBindingRequestFast(remote, address, data, ice_port_info))
+		{
+			return;
+		}
+	}
+
+	// The attributes are recorded into the table of the message, and decoded only when they are used
 	StunMessage message;
 
-	if(message.Parse(stream))
+	if(message.ParseFlat(data.get()))
 	{
 		// STUN 패킷이 맞음
 		logtd("Received message:\n%s", message.ToString().CStr());
@@ -382,19 +797,6 @@ void IcePort::OnDataReceived(const std::shared_ptr<ov::Socket> &remote, const ov
 	{
 		logtd("Not Stun packet. Passing data to observer...");
 
-		std::shared_ptr<IcePortInfo> ice_port_info;
-
-		{
-			std::lock_guard<std::mutex> lock_guard(_ice_port_info_mutex);
-
-			auto item = _ice_port_info.find(address);
-
-			if(item != _ice_port_info.end())
-			{
-				ice_port_info = item->second;
-			}
-		}
-
 		if(ice_port_info == nullptr)
 		{
 			// 포트 정보가 없음
@@ -403,51 +805,75 @@ void IcePort::OnDataReceived(const std::shared_ptr<ov::Socket> &remote, const ov
 			return;
 		}
 
-		// TODO: 이걸 IcePort에서 할 것이 아니라 PhysicalPort에서 하는 것이 좋아보임
-
-		// observer들에게 알림
-		for(auto &observer : _observers)
-		{
-			logtd("Trying to callback OnDataReceived() to %p...", observer.get());
-			observer->OnDataReceived(*this, ice_port_info->session_info, data);
-			logtd("OnDataReceived() is returned (%p)", observer.get());
-		}
+		NotifyDataReceived(ice_port_info, data);
 	}
 }
 
-void IcePort::CheckTimedoutItem()
+void IcePort::NotifyDataReceived(const std::shared_ptr<IcePortInfo> &info, const std::shared_ptr<const ov::Data> &data)
 {
-	std::vector<std::shared_ptr<IcePortInfo>> delete_list;
+	// TODO: 이걸 IcePort에서 할 것이 아니라 PhysicalPort에서 하는 것이 좋아보임
 
+	// observer들에게 알림
+	for(auto &observer : _observers)
 	{
-		std::lock_guard<std::mutex> lock_guard(_user_mapping_table_mutex);
+		logtd("Trying to callback OnDataReceived() to %p...", observer.get());
+		observer->OnDataReceived(*this, info->session_info, data);
+		logtd("OnDataReceived() is returned (%p)", observer.get());
+	}
+}
 
-		for(auto item = _user_mapping_table.begin(); item != _user_mapping_table.end();)
-		{
-			if(item->second->IsExpired())
-			{
-				logtd("Client %s(session id: %d) is expired", item->second->address.ToString().CStr(), item->second->session_info->GetId());
-				SetIceState(item->second, IcePortConnectionState::Disconnected);
+int64_t IcePort::OnExpireTimer(const std::weak_ptr<IcePortInfo> &weak_info)
+{
+	auto info = weak_info.lock();
 
-				delete_list.push_back(item->second);
+	if(info == nullptr)
+	{
+		// Already removed
+		return 0;
+	}
 
-				item = _user_mapping_table.erase(item);
-			}
-			else
-			{
-				++item;
-			}
-		}
+	int64_t remained = info->GetRemainedTime();
+
+	if(remained > 0)
+	{
+		// Refreshed by the binding requests
+		return remained;
 	}
 
 	{
-		std::lock_guard<std::mutex> lock_guard(_ice_port_info_mutex);
+		std::lock_guard<ov::ProfiledSharedMutex> lock_guard(_user_mapping_table_mutex);
+
+		auto item = _user_mapping_table.Find(info->offer_sdp->GetIceUfrag());
 
-		for(auto &deleted_ice_port : delete_list)
+		if((item == nullptr) || (*item != info))
 		{
-			_session_table.erase(deleted_ice_port->session_info->GetId());
-			_ice_port_info.erase(deleted_ice_port->address);
+			// Removed by RemoveSession()
+			return 0;
 		}
+
+		logtd("Client %s(session id: %d) is expired", info->address.ToString().CStr(), info->session_info->GetId());
+		SetIceState(info, IcePortConnectionState::Disconnected);
+
+		_user_mapping_table.Erase(info->offer_sdp->GetIceUfrag());
+	}
+
+	{
+		std::lock_guard<ov::ProfiledSharedMutex> lock_guard(_ice_port_info_mutex);
+
+		_session_table.Erase(info->session_info->GetId());
+		_ice_port_info.Erase(info->address.GetKey());
+	}
+
+	ReleasePortSlots(info);
+
+	return 0;
+}
+
+void IcePort::CancelExpireTimer(const std::shared_ptr<IcePortInfo> &info)
+{
+	if(info->expire_timer_id != 0)
+	{
+		ov::SharedTimerWheel::Instance()->Cancel(info->expire_timer_id);
 	}
 }
 
@@ -468,17 +894,17 @@ bool IcePort::ProcessBindingRequest(const std::shared_ptr<ov::Socket> &remote, c
 	std::shared_ptr<IcePortInfo> ice_port_info;
 
 	{
-		std::lock_guard<std::mutex> lock_guard(_user_mapping_table_mutex);
+		std::shared_lock<ov::ProfiledSharedMutex> lock(_user_mapping_table_mutex);
 
-		auto info = _user_mapping_table.find(local_ufrag);
+		auto info = _user_mapping_table.Find(local_ufrag);
 
-		if(info == _user_mapping_table.end())
+		if(info == nullptr)
 		{
 			logtd("User not found: %s (AddSession() needed)", local_ufrag.CStr());
 			return false;
 		}
 
-		ice_port_info = info->second;
+		ice_port_info = *info;
 	}
 
 	if(ice_port_info->peer_sdp->GetIceUfrag() != remote_ufrag)
@@ -499,18 +925,21 @@ bool IcePort::ProcessBindingRequest(const std::shared_ptr<ov::Socket> &remote, c
 		SetIceState(ice_port_info, IcePortConnectionState::Failed);
 
 		{
-			std::lock_guard<std::mutex> lock_guard(_user_mapping_table_mutex);
+			std::lock_guard<ov::ProfiledSharedMutex> lock_guard(_user_mapping_table_mutex);
 
-			_user_mapping_table.erase(local_ufrag);
+			_user_mapping_table.Erase(local_ufrag);
 		}
 
 		{
-			std::lock_guard<std::mutex> lock_guard(_ice_port_info_mutex);
+			std::lock_guard<ov::ProfiledSharedMutex> lock_guard(_ice_port_info_mutex);
 
-			_ice_port_info.erase(ice_port_info->address);
-			_session_table.erase(ice_port_info->session_info->GetId());
+			_ice_port_info.Erase(ice_port_info->address.GetKey());
+			_session_table.Erase(ice_port_info->session_info->GetId());
 		}
 
+		CancelExpireTimer(ice_port_info);
+		ReleasePortSlots(ice_port_info);
+
 		return false;
 	}
 
@@ -522,19 +951,78 @@ bool IcePort::ProcessBindingRequest(const std::shared_ptr<ov::Socket> &remote, c
 		SetIceState(ice_port_info, IcePortConnectionState::Checking);
 		ice_port_info->remote = remote;
 		ice_port_info->address = address;
+		ice_port_info->tcp_connection = (remote->GetType() == ov::SocketType::Tcp) ? FindTcpConnection(remote) : nullptr;
+	}
+
+	// client mapping 정보를 저장해놓음
+	{
+		std::lock_guard<ov::ProfiledSharedMutex> lock_guard(_ice_port_info_mutex);
+
+		if(_session_table.Contains(ice_port_info->session_info->GetId()) == false)
+		{
+			_ice_port_info.Insert(address.GetKey(), ice_port_info);
+			_session_table.Insert(ice_port_info->session_info->GetId(), ice_port_info);
+		}
+		else
+		{
+			// Updated
+		}
 	}
 
-	return SendBindingResponse(remote, address, request_message, ice_port_info);
+	if(SendBindingResponse(remote, address, request_message.GetTransactionId(), ice_port_info) == false)
+	{
+		return false;
+	}
+
+	SendBindingRequest(remote, address, ice_port_info);
+
+	return true;
+}
+
+bool IcePort::ProcessBindingRequestFast(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data, const std::shared_ptr<IcePortInfo> &info)
+{
+	if(StunMessage::IsBindingRequestOf(data.get(), info->offer_sdp->GetIceUfrag()) == false)
+	{
+		// Other messages are parsed by StunMessage
+		return false;
+	}
+
+	// Same as ProcessBindingRequest() (the client is already mapped to the address)
+	info->UpdateBindingTime();
+
+	// Magic cookie (4B) is followed by the transaction id
+	if(SendBindingResponse(remote, address, data->GetDataAs<uint8_t>() + 8, info) == false)
+	{
+		return false;
+	}
+
+	SendBindingRequest(remote, address, info);
+
+	return true;
 }
 
-bool IcePort::SendBindingResponse(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const StunMessage &request_message, const std::shared_ptr<IcePortInfo> &info)
+bool IcePort::SendBindingResponse(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const uint8_t *transaction_id, const std::shared_ptr<IcePortInfo> &info)
 {
+	std::lock_guard<std::mutex> lock_guard(info->binding_mutex);
+
+	if((info->binding_response != nullptr) && (info->binding_response_address == address))
+	{
+		// Only the transaction id is changed
+		if(StunMessage::UpdateTransactionId(info->binding_response, transaction_id, info->response_hmac) == false)
+		{
+			logtw("Could not update the binding response");
+			return false;
+		}
+
+		return SendToRemote(remote, address, info->binding_response);
+	}
+
 	// Binding response 준비
 	StunMessage response_message;
 
 	response_message.SetClass(StunClass::SuccessResponse);
 	response_message.SetMethod(StunMethod::Binding);
-	response_message.SetTransactionId(request_message.GetTransactionId());
+	response_message.SetTransactionId(transaction_id);
 
 	std::unique_ptr<StunAttribute> attribute;
 
@@ -551,37 +1039,26 @@ bool IcePort::SendBindingResponse(const std::shared_ptr<ov::Socket> &remote, con
 	// Integrity & Fingerprint attribute는 Serialize()할 때 자동 생성됨
 	std::shared_ptr<ov::Data> serialized = response_message.Serialize(key);
 
-	logtd("Generated STUN response:\n%s\n%s", response_message.ToString().CStr(), serialized->Dump().CStr());
+	if(serialized == nullptr)
+	{
+		logtw("Could not serialize the binding response");
+		return false;
+	}
 
-	remote->SendTo(address, serialized);
+	logtd("Generated STUN response:\n%s\n%s", response_message.ToString().CStr(), serialized->Dump().CStr());
 
-	// client mapping 정보를 저장해놓음
+	// Keep the message for the next binding request
+	if(info->response_hmac.IsCreated() || info->response_hmac.Create(ov::CryptoAlgorithm::Sha1, key.CStr(), key.GetLength()))
 	{
-		std::lock_guard<std::mutex> lock_guard(_ice_port_info_mutex);
-
-		if(_session_table.find(info->session_info->GetId()) == _session_table.end())
-		{
-			_ice_port_info[address] = info;
-			_session_table[info->session_info->GetId()] = info;
-		}
-		else
-		{
-			// Updated
-		}
+		info->binding_response = serialized;
+		info->binding_response_address = address;
 	}
 
-	SendBindingRequest(remote, address, info);
-
-	return true;
+	return SendToRemote(remote, address, serialized);
 }
 
 bool IcePort::SendBindingRequest(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<IcePortInfo> &info)
 {
-	// Binding request 준비
-	StunMessage request_message;
-
-	request_message.SetClass(StunClass::Request);
-	request_message.SetMethod(StunMethod::Binding);
 	// logtw("TEST PURPOSE TRANSACTION_ID");
 	// TODO: transaction_id가 겹치지 않게 처리 해야 함
 	uint8_t transaction_id[OV_STUN_TRANSACTION_ID_LENGTH];
@@ -592,6 +1069,26 @@ bool IcePort::SendBindingRequest(const std::shared_ptr<ov::Socket> &remote, cons
 	{
 		transaction_id[index] = charset[rand() % OV_COUNTOF(charset)];
 	}
+
+	std::lock_guard<std::mutex> lock_guard(info->binding_mutex);
+
+	if(info->binding_request != nullptr)
+	{
+		// The attributes are not changed during the session
+		if(StunMessage::UpdateTransactionId(info->binding_request, transaction_id, info->request_hmac) == false)
+		{
+			logtw("Could not update the binding request");
+			return false;
+		}
+
+		return SendToRemote(remote, address, info->binding_request);
+	}
+
+	// Binding request 준비
+	StunMessage request_message;
+
+	request_message.SetClass(StunClass::Request);
+	request_message.SetMethod(StunMethod::Binding);
 	request_message.SetTransactionId(&(transaction_id[0]));
 
 	std::unique_ptr<StunAttribute> attribute;
@@ -611,17 +1108,21 @@ bool IcePort::SendBindingRequest(const std::shared_ptr<ov::Socket> &remote, cons
 	unknown_attribute->SetData(&(unknown_data[0]), 4);
 	request_message.AddAttribute(std::move(attribute));
 
-	// ICE-CONTROLLING 추가 (hash 테스트용)
-	attribute = std::make_unique<StunUnknownAttribute>(0x802A, 8);
+	// ICE-CONTROLLING/ICE-CONTROLLED 추가 (hash 테스트용)
+	attribute = std::make_unique<StunUnknownAttribute>(info->is_controlling ? 0x802A : 0x8029, 8);
 	unknown_attribute = dynamic_cast<StunUnknownAttribute *>(attribute.get());
 	uint8_t unknown_data2[] = { 0x1C, 0xF5, 0x1E, 0xB1, 0xB0, 0xCB, 0xE3, 0x49 };
 	unknown_attribute->SetData(&(unknown_data2[0]), 8);
 	request_message.AddAttribute(std::move(attribute));
 
-	// USE-CANDIDATE 추가 - Required (hash 테스트용)
-	attribute = std::make_unique<StunUnknownAttribute>(0x0025, 0);
-	unknown_attribute = dynamic_cast<StunUnknownAttribute *>(attribute.get());
-	request_message.AddAttribute(std::move(attribute));
+	if(info->is_controlling)
+	{
+		// USE-CANDIDATE 추가 - Required (hash 테스트용)
+		// (The controlled agent must not nominate the pair)
+		attribute = std::make_unique<StunUnknownAttribute>(0x0025, 0);
+		unknown_attribute = dynamic_cast<StunUnknownAttribute *>(attribute.get());
+		request_message.AddAttribute(std::move(attribute));
+	}
 
 	// PRIORITY 추가 - Required (hash 테스트용)
 	attribute = std::make_unique<StunUnknownAttribute>(0x0024, 4);
@@ -636,33 +1137,35 @@ bool IcePort::SendBindingRequest(const std::shared_ptr<ov::Socket> &remote, cons
 	// Integrity & Fingerprint attribute는 Serialize()할 때 자동 생성됨
 	std::shared_ptr<ov::Data> serialized = request_message.Serialize(key);
 
+	if(serialized == nullptr)
+	{
+		logtw("Could not serialize the binding request");
+		return false;
+	}
+
 	logtd("Generated STUN response:\n%s\n%s", request_message.ToString().CStr(), serialized->Dump().CStr());
 
-	remote->SendTo(address, serialized);
+	// Keep the message for the next binding request
+	if(info->request_hmac.IsCreated() || info->request_hmac.Create(ov::CryptoAlgorithm::Sha1, key.CStr(), key.GetLength()))
+	{
+		info->binding_request = serialized;
+	}
 
-	return true;
+	return SendToRemote(remote, address, serialized);
 }
 
 bool IcePort::ProcessBindingResponse(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const StunMessage &response_message)
 {
 	// TODO: state가 checking 상태인지 확인
 
-	std::shared_ptr<IcePortInfo> ice_port_info;
+	auto ice_port_info = FindIcePortInfo(address);
 
+	if(ice_port_info == nullptr)
 	{
-		std::lock_guard<std::mutex> lock_guard(_ice_port_info_mutex);
-
-		auto item = _ice_port_info.find(address);
-
-		if(item == _ice_port_info.end())
-		{
-			// 포트 정보가 없음
-			// 이전 단계에서 관련 정보가 저장되어 있어야 함
-			logtw("Could not find client information");
-			return false;
-		}
-
-		ice_port_info = item->second;
+		// 포트 정보가 없음
+		// 이전 단계에서 관련 정보가 저장되어 있어야 함
+		logtw("Could not find client information");
+		return false;
 	}
 
 	// SDP의 password로 무결성 검사를 한 뒤
@@ -682,9 +1185,77 @@ bool IcePort::ProcessBindingResponse(const std::shared_ptr<ov::Socket> &remote,
 	return true;
 }
 
+std::shared_ptr<IcePort::IcePortInfo> IcePort::FindIcePortInfo(const ov::SocketAddress &address)
+{
+	auto key = address.GetKey();
+
+	std::shared_lock<ov::ProfiledSharedMutex> lock(_ice_port_info_mutex);
+
+	auto item = _ice_port_info.Find(key);
+
+	return (item != nullptr) ? *item : nullptr;
+}
+
+std::shared_ptr<IcePort::IcePortInfo> IcePort::FindIcePortInfo(session_id_t session_id)
+{
+	std::shared_lock<ov::ProfiledSharedMutex> lock(_ice_port_info_mutex);
+
+	auto item = _session_table.Find(session_id);
+
+	return (item != nullptr) ? *item : nullptr;
+}
+
 void IcePort::OnDisconnected(const std::shared_ptr<ov::Socket> &remote, PhysicalPortDisconnectReason reason, const std::shared_ptr<const ov::Error> &error)
 {
-	// TODO: TCP 연결이 해제되었을 때 처리. 일단은 UDP만 처리하므로, 비워둠
+	if(remote->GetType() != ov::SocketType::Tcp)
+	{
+		return;
+	}
+
+	logtd("ICE-TCP connection is closed: %s", remote->ToString().CStr());
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_tcp_connection_list_mutex);
+
+		_tcp_connection_list.erase(remote.get());
+	}
+
+	// The sessions which use the connection can't receive the packets anymore
+	std::vector<std::shared_ptr<IcePortInfo>> info_list;
+
+	{
+		std::lock_guard<ov::ProfiledSharedMutex> lock_guard(_ice_port_info_mutex);
+
+		_session_table.EraseIf([&](const session_id_t &session_id, std::shared_ptr<IcePortInfo> &info) -> bool {
+			if(info->remote == remote)
+			{
+				info_list.push_back(info);
+				return true;
+			}
+
+			return false;
+		});
+
+		for(auto &info : info_list)
+		{
+			_ice_port_info.Erase(info->address.GetKey());
+		}
+	}
+
+	for(auto &info : info_list)
+	{
+		{
+			std::lock_guard<ov::ProfiledSharedMutex> lock_guard(_user_mapping_table_mutex);
+
+			_user_mapping_table.Erase(info->offer_sdp->GetIceUfrag());
+		}
+
+		logtd("Client %s(session id: %d) is disconnected", info->address.ToString().CStr(), info->session_info->GetId());
+		SetIceState(info, IcePortConnectionState::Disconnected);
+
+		CancelExpireTimer(info);
+		ReleasePortSlots(info);
+	}
 }
 
 void IcePort::SetIceState(std::shared_ptr<IcePortInfo> &info, IcePortConnectionState state)
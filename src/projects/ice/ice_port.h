@@ -13,17 +13,38 @@
 
 #include <vector>
 #include <memory>
+#include <shared_mutex>
+#include <map>
+#include <unordered_map>
 
 #include <config/config.h>
 #include <rtp_rtcp/rtp_packet.h>
 #include <rtp_rtcp/rtcp_packet.h>
 #include <physical_port/physical_port_manager.h>
 
+// RFC 4571 - The packets (STUN/DTLS/SRTP) over the ICE-TCP connections (RFC 6544) are framed with the length
+// [length(2)] [packet(length)]
+#define ICE_TCP_FRAME_HEADER_SIZE			2
+// Priority of the TCP candidates (the UDP candidates have 50)
+#define ICE_TCP_CANDIDATE_PRIORITY			40
+// The port which is assigned to an offer is released if the peer doesn't answer in this time (ms)
+#define ICE_PORT_PENDING_OFFER_TIMEOUT		(30 * 1000)
+
 class RtcIceCandidate;
 
 class IcePort : protected PhysicalPortObserver
 {
 protected:
+	// State of a passive ICE-TCP connection which is accepted by the TCP physical port
+	struct TcpConnection
+	{
+		// The frame which is not received completely
+		std::shared_ptr<ov::Data> pending_data = std::make_shared<ov::Data>();
+
+		// The frames must not be interleaved (the session and the ICE messages are sent by different threads)
+		std::mutex send_mutex;
+	};
+
 	// A data structure to tracking client connection status
 	struct IcePortInfo
 	{
@@ -35,10 +56,34 @@ protected:
 
 		std::shared_ptr<ov::Socket> remote;
 		ov::SocketAddress address;
+		// nullptr if the remote is not a TCP connection
+		std::shared_ptr<TcpConnection> tcp_connection;
+
+		// Indices of IcePort::_port_slots which are assigned to the session
+		std::vector<size_t> port_slots;
+
+		// Kernel pacing of the media to the peer (SO_TXTIME for UDP, SO_MAX_PACING_RATE for ICE-TCP)
+		ov::TxTimePacer pacer;
 
 		IcePortConnectionState state;
 
+		// OME is the controlling agent when it sends the offer, and the controlled agent when it answers (WHEP)
+		bool is_controlling = true;
+
 		std::chrono::time_point<std::chrono::system_clock> expire_time;
+		// Timer of ov::SharedTimerWheel which removes the session when it is expired
+		uint64_t expire_timer_id = 0;
+
+		// The binding messages are serialized once, and only the transaction id (and the hashes) are updated later
+		std::mutex binding_mutex;
+		// HMAC of the binding response (key: ICE password of the offer)
+		ov::Hmac response_hmac;
+		// HMAC of the binding request (key: ICE password of the peer)
+		ov::Hmac request_hmac;
+		std::shared_ptr<ov::Data> binding_response;
+		// XOR-MAPPED-ADDRESS of binding_response
+		ov::SocketAddress binding_response_address;
+		std::shared_ptr<ov::Data> binding_request;
 
 		void UpdateBindingTime()
 		{
@@ -49,6 +94,39 @@ protected:
 		{
 			return (std::chrono::system_clock::now() > expire_time);
 		}
+
+		// ms until expire_time (0 if expired)
+		int64_t GetRemainedTime() const
+		{
+			auto remained = std::chrono::duration_cast<std::chrono::milliseconds>(expire_time - std::chrono::system_clock::now()).count();
+
+			return std::max<int64_t>(remained, 0);
+		}
+	};
+
+	// Candidates of a port (one for each IP address), which is received by the threads of its PhysicalPort
+	struct IcePortSlot
+	{
+		ov::String transport;
+		int port = 0;
+		std::vector<RtcIceCandidate> candidates;
+
+		// Sessions (and the offers which are not answered yet) which are assigned to the port
+		int session_count = 0;
+	};
+
+	struct PendingOffer
+	{
+		std::vector<size_t> port_slots;
+		int64_t offered_time = 0;
+	};
+
+	struct UfragHash
+	{
+		uint64_t operator()(const ov::String &ufrag) const
+		{
+			return ov::HashBytes(ufrag.CStr(), ufrag.GetLength());
+		}
 	};
 
 public:
@@ -59,23 +137,36 @@ public:
 
 	const std::vector<RtcIceCandidate> &GetIceCandidateList() const;
 
+	// Appends the candidates of the least loaded port of each transport, so the sessions are spread over the port range
+	// - ufrag is the local ufrag of the session, the ports are assigned to it when AddSession() is called
+	void SelectIceCandidates(const ov::String &ufrag, std::vector<RtcIceCandidate> *candidates);
+
 	bool Close();
 
 	IcePortConnectionState GetState(const std::shared_ptr<SessionInfo> &session_info) const
 	{
 		OV_ASSERT2(session_info != nullptr);
 
-		auto item = _session_table.find(session_info->GetId());
+		std::shared_lock<ov::ProfiledSharedMutex> lock(_ice_port_info_mutex);
 
-		if(item == _session_table.end())
+		auto item = _session_table.Find(session_info->GetId());
+
+		if(item == nullptr)
 		{
 			OV_ASSERT(false, "Invalid session_id: %d", session_info->GetId());
 			return IcePortConnectionState::Failed;
 		}
 
-		return item->second->state;
+		return (*item)->state;
 	}
 
+	// Connection of a session (socket and address of the peer), which is used by the compiled egress path of the session
+	// - the session table is not looked up for each packet
+	using Connection = std::shared_ptr<IcePortInfo>;
+
+	// nullptr if the peer has not been connected yet
+	Connection GetConnection(session_id_t session_id);
+
 	ov::String GenerateUfrag();
 
 	bool AddObserver(std::shared_ptr<IcePortObserver> observer);
@@ -87,13 +178,22 @@ public:
 		return (_observers.empty() == false);
 	}
 
-	void AddSession(const std::shared_ptr<SessionInfo> &session_info, std::shared_ptr<SessionDescription> offer_sdp, std::shared_ptr<SessionDescription> peer_sdp);
+	// offer_sdp is the local description (the answer of OME if is_controlling is false)
+	void AddSession(const std::shared_ptr<SessionInfo> &session_info, std::shared_ptr<SessionDescription> offer_sdp, std::shared_ptr<SessionDescription> peer_sdp, bool is_controlling = true);
 	bool RemoveSession(session_id_t session_id);
 	bool RemoveSession(const std::shared_ptr<SessionInfo> &session_info);
 
+	// Target rate of the session (bits per second, 0: not paced), which is enforced by the kernel
+	bool SetPacingRate(session_id_t session_id, uint64_t rate);
+
 	bool Send(const std::shared_ptr<SessionInfo> &session_info, std::unique_ptr<RtpPacket> packet);
 	bool Send(const std::shared_ptr<SessionInfo> &session_info, std::unique_ptr<RtcpPacket> packet);
 	bool Send(const std::shared_ptr<SessionInfo> &session_info, const std::shared_ptr<const ov::Data> &data);
+	// Sends several packets of a session with as few syscalls as possible
+	bool Send(const std::shared_ptr<SessionInfo> &session_info, const std::vector<std::shared_ptr<ov::Data>> &data_list);
+	// Sends the packets to the connection of GetConnection() (false if the connection is closed)
+	bool SendDirect(const Connection &connection, const std::shared_ptr<ov::Data> &data);
+	bool SendDirect(const Connection &connection, const std::vector<std::shared_ptr<ov::Data>> &data_list);
 
 	ov::String ToString() const;
 
@@ -114,7 +214,9 @@ protected:
 	void ResponseError(const std::shared_ptr<ov::Socket> &remote);
 
 private:
-	void CheckTimedoutItem();
+	// Called by the expire timer of the session, returns the delay of the next check (0: the session is removed)
+	int64_t OnExpireTimer(const std::weak_ptr<IcePortInfo> &weak_info);
+	void CancelExpireTimer(const std::shared_ptr<IcePortInfo> &info);
 
 	// STUN negotiation order:
 	// (State: New)
@@ -125,10 +227,35 @@ private:
 	// [Server] <-- 4. Binding Success Response --- [Player]
 	// (State: Connected)
 	bool ProcessBindingRequest(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const StunMessage &request_message);
-	bool SendBindingResponse(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const StunMessage &request_message, const std::shared_ptr<IcePortInfo> &info);
+	// Handles the binding request of the known client without parsing the message (returns false if it is not)
+	bool ProcessBindingRequestFast(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data, const std::shared_ptr<IcePortInfo> &info);
+	bool SendBindingResponse(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const uint8_t *transaction_id, const std::shared_ptr<IcePortInfo> &info);
 	bool SendBindingRequest(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<IcePortInfo> &info);
 	bool ProcessBindingResponse(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const StunMessage &response_message);
 
+	// Handles a packet (a datagram of UDP or a frame of TCP)
+	void OnPacketReceived(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data);
+	// Splits the stream of the TCP connection into the frames
+	void OnTcpDataReceived(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data);
+	std::shared_ptr<TcpConnection> FindTcpConnection(const std::shared_ptr<ov::Socket> &remote);
+
+	// Sends the packets to the remote (framed if the remote is a TCP connection)
+	bool SendToRemote(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data);
+	bool SendToRemote(const std::shared_ptr<IcePortInfo> &info, const std::vector<std::shared_ptr<ov::Data>> &data_list);
+	// Sends the frames with one writev() (the headers and the packets are not concatenated)
+	static bool SendTcpFrames(const std::shared_ptr<ov::Socket> &remote, TcpConnection &connection, const std::vector<std::shared_ptr<const ov::Data>> &data_list);
+
+	void NotifyDataReceived(const std::shared_ptr<IcePortInfo> &info, const std::shared_ptr<const ov::Data> &data);
+
+	// Releases the ports of the removed session
+	void ReleasePortSlots(const std::shared_ptr<IcePortInfo> &info);
+	// _port_slot_mutex must be locked
+	void ReleasePortSlots(const std::vector<size_t> &port_slots);
+	void RemoveExpiredOffers(int64_t current_time);
+
+	std::shared_ptr<IcePortInfo> FindIcePortInfo(const ov::SocketAddress &address);
+	std::shared_ptr<IcePortInfo> FindIcePortInfo(session_id_t session_id);
+
 	std::vector<std::shared_ptr<PhysicalPort>> _physical_port_list;
 	std::recursive_mutex _physical_port_list_mutex;
 
@@ -137,23 +264,34 @@ private:
 
 	std::vector<RtcIceCandidate> _ice_candidate_list;
 
+	// The slots are not changed after Create()
+	std::vector<IcePortSlot> _port_slots;
+	std::mutex _port_slot_mutex;
+	// The ties are broken by the rotating index, so the idle ports are used in turn
+	size_t _next_port_slot = 0;
+	// key: local ufrag of the offer which is not answered yet
+	std::map<ov::String, PendingOffer> _pending_offers;
+
 	// STUN binding이 될 때까지 관련 정보를 담고 있는 mapping table
 	// binding이 완료되면 이후로는 destination ip & port로 구분하기 때문에 필요 없어짐
 	// key: offer ufrag
 	// value: IcePortInfo
-	std::map<const ov::String, std::shared_ptr<IcePortInfo>> _user_mapping_table;
-	std::mutex _user_mapping_table_mutex;
+	ov::HashTable<ov::String, std::shared_ptr<IcePortInfo>, UfragHash> _user_mapping_table;
+	// Binding requests are looked up by the readers concurrently
+	ov::ProfiledSharedMutex _user_mapping_table_mutex { "IcePort::_user_mapping_table_mutex" };
 
 	// STUN nego가 완료되면 생성되는 mapping table
 
 	// 상대방의 ip:port로 IcePortInfo를 바로 찾을 수 있게 함
 	// key: SocketAddress
 	// value: IcePortInfo
-	std::mutex _ice_port_info_mutex;
-	std::map<ov::SocketAddress, std::shared_ptr<IcePortInfo>> _ice_port_info;
+	// Every received packet and every sent packet looks up the tables, so they are hash tables under a shared lock
+	mutable ov::ProfiledSharedMutex _ice_port_info_mutex { "IcePort::_ice_port_info_mutex" };
+	ov::HashTable<ov::SocketAddressKey, std::shared_ptr<IcePortInfo>, ov::SocketAddressKeyHash> _ice_port_info;
 	// session_id로 IcePortInfo를 바로 찾을 수 있게 함
-	std::map<session_id_t, std::shared_ptr<IcePortInfo>> _session_table;
+	ov::HashTable<session_id_t, std::shared_ptr<IcePortInfo>> _session_table;
 
-	// 마지막으로 STUN 메시지가 온 시점을 기억함
-	ov::DelayQueue _timer;
+	// key: socket of the accepted TCP connection
+	std::mutex _tcp_connection_list_mutex;
+	std::unordered_map<const ov::Socket *, std::shared_ptr<TcpConnection>> _tcp_connection_list;
 };
@@ -102,6 +102,16 @@ bool IcePortManager::GenerateIceCandidates(const cfg::IceCandidates &ice_candida
 				ov::String protocol = (socket_type == ov::SocketType::Tcp) ? "TCP" : "UDP";
 
 				parsed_ice_candidate_list->emplace_back(protocol, address, 0, "");
+
+				if(socket_type == ov::SocketType::Tcp)
+				{
+					// RFC 6544 - OME only accepts the connections from the players
+					// (lower priority than UDP, so TCP is used only when UDP is blocked)
+					auto &tcp_candidate = parsed_ice_candidate_list->back();
+
+					tcp_candidate.SetPriority(ICE_TCP_CANDIDATE_PRIORITY);
+					tcp_candidate.AddExtensionAttributes("tcptype", "passive");
+				}
 			}
 		}
 	}
@@ -86,8 +86,6 @@ bool StunMappedAddressAttribute::Parse(ov::ByteStream &stream)
 				return false;
 			}
 
-			_address.UpdateIPAddress();
-
 			break;
 		}
 
@@ -47,7 +47,6 @@ bool StunXorMappedAddressAttribute::Parse(ov::ByteStream &stream)
 		{
 			case ov::SocketFamily::Inet:
 				(static_cast<in_addr *>(_address))->s_addr ^= ov::HostToNetwork32(OV_STUN_MAGIC_COOKIE);
-				_address.UpdateIPAddress();
 				break;
 
 			case ov::SocketFamily::Inet6:
@@ -14,6 +14,7 @@
 
 #include <base/ovlibrary/ovlibrary.h>
 #include <base/ovcrypto/ovcrypto.h>
+#include <base/ovlibrary/byte_io.h>
 
 static const uint32_t StunTypeMask = 0x0110;
 static const size_t StunAttributeHeaderSize = 4;
@@ -54,6 +55,124 @@ bool StunMessage::Parse(ov::ByteStream &stream)
 	return _parsed;
 }
 
+bool StunMessage::ParseFlat(const ov::Data *data)
+{
+	_parsed = false;
+	_flat_data = nullptr;
+	_flat_attribute_count = 0;
+
+	auto buffer = data->GetDataAs<uint8_t>();
+	size_t length = data->GetLength();
+	// FINGERPRINT attribute (type + length + CRC)
+	size_t fingerprint_size = StunAttributeHeaderSize + sizeof(uint32_t);
+
+	if((length < (DefaultHeaderLength() + fingerprint_size)) || ((length % 4) != 0) || (length > UINT16_MAX))
+	{
+		return false;
+	}
+
+	uint16_t type = ov::LoadBE<uint16_t>(&buffer[0]);
+
+	if(((type & 0xC000) != 0) ||
+	   (ov::LoadBE<uint16_t>(&buffer[2]) != (length - DefaultHeaderLength())) ||
+	   (ov::LoadBE<uint32_t>(&buffer[4]) != OV_STUN_MAGIC_COOKIE))
+	{
+		return false;
+	}
+
+	if(HasValidFingerprint(buffer, length) == false)
+	{
+		logtd("Could not validate fingerprint");
+		return false;
+	}
+
+	size_t offset = DefaultHeaderLength();
+
+	while((offset + StunAttributeHeaderSize) <= length)
+	{
+		uint16_t attribute_length = ov::LoadBE<uint16_t>(&buffer[offset + 2]);
+		size_t value_offset = offset + StunAttributeHeaderSize;
+
+		if((value_offset + attribute_length) > length)
+		{
+			logtw("Invalid attribute length: %u (offset: %zu, message length: %zu)", attribute_length, offset, length);
+			return false;
+		}
+
+		if(_flat_attribute_count >= OV_STUN_MAX_FLAT_ATTRIBUTE_COUNT)
+		{
+			logtw("Too many attributes (max: %d)", OV_STUN_MAX_FLAT_ATTRIBUTE_COUNT);
+			return false;
+		}
+
+		auto &attribute = _flat_attributes[_flat_attribute_count++];
+
+		attribute.type = static_cast<StunAttributeType>(ov::LoadBE<uint16_t>(&buffer[offset]));
+		attribute.offset = static_cast<uint16_t>(value_offset);
+		attribute.length = attribute_length;
+
+		// The values are padded to 4 bytes
+		offset = value_offset + ((attribute_length + 3) & ~3);
+	}
+
+	_type = type;
+	_message_length = static_cast<uint16_t>(length - DefaultHeaderLength());
+	_magic_cookie = OV_STUN_MAGIC_COOKIE;
+	::memcpy(_transaction_id, &buffer[8], sizeof(_transaction_id));
+
+	_flat_data = buffer;
+	_parsed = true;
+
+	return true;
+}
+
+bool StunMessage::GetAttributeValue(StunAttributeType type, const uint8_t **value, size_t *length) const
+{
+	for(size_t index = 0; index < _flat_attribute_count; index++)
+	{
+		const auto &attribute = _flat_attributes[index];
+
+		if(attribute.type == type)
+		{
+			*value = _flat_data + attribute.offset;
+			*length = attribute.length;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool StunMessage::GetUserName(ov::StringView *user_name) const
+{
+	if(IsFlat())
+	{
+		const uint8_t *value = nullptr;
+		size_t length = 0;
+
+		if(GetAttributeValue(StunAttributeType::UserName, &value, &length) == false)
+		{
+			return false;
+		}
+
+		*user_name = ov::StringView(reinterpret_cast<const char *>(value), length);
+
+		return true;
+	}
+
+	const auto *user_name_attribute = GetAttribute<StunUserNameAttribute>(StunAttributeType::UserName);
+
+	if(user_name_attribute == nullptr)
+	{
+		return false;
+	}
+
+	*user_name = user_name_attribute->GetUserName();
+
+	return true;
+}
+
 bool StunMessage::ParseHeader(ov::ByteStream &stream)
 {
 	logtd("Trying to check STUN header length...");
@@ -451,33 +570,31 @@ bool StunMessage::CheckIntegrity(const ov::String &password) const
 
 bool StunMessage::GetUfrags(ov::String *first_ufrag, ov::String *second_ufrag) const
 {
-	const auto *user_name_attribute = GetAttribute<StunUserNameAttribute>(StunAttributeType::UserName);
+	ov::StringView user_name;
 
-	if(user_name_attribute == nullptr)
+	if(GetUserName(&user_name) == false)
 	{
 		logtw("User name attribute not found");
 		return false;
 	}
 
-	const ov::String &user_name = user_name_attribute->GetUserName();
+	off_t separator = user_name.IndexOf(':');
 
-	std::vector<ov::String> tokens = user_name.Split(":");
-
-	if(tokens.size() != 2)
+	// token은 반드시 2개여야 함
+	if((separator < 0) || (user_name.IndexOf(':', separator + 1) >= 0))
 	{
-		// token은 반드시 2개여야 함
-		logtw("Invalid user name: %s", user_name.CStr());
+		logtw("Invalid user name: %.*s", static_cast<int>(user_name.GetLength()), user_name.GetData());
 		return false;
 	}
 
 	if(first_ufrag != nullptr)
 	{
-		*first_ufrag = tokens[0];
+		*first_ufrag = user_name.Left(separator).ToString();
 	}
 
 	if(second_ufrag != nullptr)
 	{
-		*second_ufrag = tokens[1];
+		*second_ufrag = user_name.Substring(separator + 1).ToString();
 	}
 
 	return true;
@@ -496,6 +613,20 @@ ov::String StunMessage::ToString() const
 	dump.AppendFormat("Message Length: %d (0x%04X)\n", _message_length, _message_length);
 	dump.AppendFormat("Magic Cookie: 0x%08X\n", _magic_cookie);
 	dump.AppendFormat("Transaction ID: %s\n", ov::ToHexString(&(_transaction_id[0]), OV_COUNTOF(_transaction_id)).CStr());
+	if(IsFlat())
+	{
+		dump.AppendFormat("Attributes: %zu items (flat)", _flat_attribute_count);
+
+		for(size_t index = 0; index < _flat_attribute_count; index++)
+		{
+			const auto &attribute = _flat_attributes[index];
+
+			dump.AppendFormat("\n    Type: 0x%04X, Offset: %u, Length: %u", static_cast<uint16_t>(attribute.type), attribute.offset, attribute.length);
+		}
+
+		return dump;
+	}
+
 	dump.AppendFormat("Attributes: %d items", _attributes.size());
 
 	for(const auto &attribute : _attributes)
@@ -676,3 +807,119 @@ std::shared_ptr<ov::Data> StunMessage::Serialize(const ov::String &integrity_key
 
 	return result ? data : nullptr;
 }
+
+bool StunMessage::IsBindingRequestOf(const ov::Data *data, const ov::String &local_ufrag)
+{
+	auto buffer = data->GetDataAs<uint8_t>();
+	size_t length = data->GetLength();
+	// FINGERPRINT attribute (type + length + CRC)
+	size_t fingerprint_size = StunAttributeHeaderSize + sizeof(uint32_t);
+
+	if((length < (DefaultHeaderLength() + fingerprint_size)) || ((length % 4) != 0))
+	{
+		return false;
+	}
+
+	// Binding request (class: request, method: binding)
+	if((ByteReader<uint16_t>::ReadBigEndian(&buffer[0]) != 0x0001) ||
+	   (ByteReader<uint16_t>::ReadBigEndian(&buffer[2]) != (length - DefaultHeaderLength())) ||
+	   (ByteReader<uint32_t>::ReadBigEndian(&buffer[4]) != OV_STUN_MAGIC_COOKIE))
+	{
+		return false;
+	}
+
+	if(HasValidFingerprint(buffer, length) == false)
+	{
+		return false;
+	}
+
+	size_t fingerprint_offset = length - fingerprint_size;
+
+	// Find USERNAME
+	size_t offset = DefaultHeaderLength();
+
+	while((offset + StunAttributeHeaderSize) <= fingerprint_offset)
+	{
+		uint16_t type = ByteReader<uint16_t>::ReadBigEndian(&buffer[offset]);
+		uint16_t attribute_length = ByteReader<uint16_t>::ReadBigEndian(&buffer[offset + 2]);
+		size_t value_offset = offset + StunAttributeHeaderSize;
+
+		if((value_offset + attribute_length) > fingerprint_offset)
+		{
+			return false;
+		}
+
+		if(type == static_cast<uint16_t>(StunAttributeType::UserName))
+		{
+			size_t ufrag_length = local_ufrag.GetLength();
+
+			return (attribute_length > ufrag_length) &&
+				   (::memcmp(&buffer[value_offset], local_ufrag.CStr(), ufrag_length) == 0) &&
+				   (buffer[value_offset + ufrag_length] == ':');
+		}
+
+		// The values are padded to 4 bytes
+		offset = value_offset + ((attribute_length + 3) & ~3);
+	}
+
+	return false;
+}
+
+bool StunMessage::HasValidFingerprint(const uint8_t *buffer, size_t length)
+{
+	size_t fingerprint_size = StunAttributeHeaderSize + sizeof(uint32_t);
+
+	if(length < (DefaultHeaderLength() + fingerprint_size))
+	{
+		return false;
+	}
+
+	// FINGERPRINT must be the last attribute
+	size_t fingerprint_offset = length - fingerprint_size;
+
+	if((ByteReader<uint16_t>::ReadBigEndian(&buffer[fingerprint_offset]) != static_cast<uint16_t>(StunAttributeType::Fingerprint)) ||
+	   (ByteReader<uint16_t>::ReadBigEndian(&buffer[fingerprint_offset + 2]) != sizeof(uint32_t)))
+	{
+		return false;
+	}
+
+	uint32_t crc = ov::Crc32::Calculate(buffer, fingerprint_offset) ^ OV_STUN_FINGERPRINT_XOR_VALUE;
+
+	return crc == ByteReader<uint32_t>::ReadBigEndian(&buffer[fingerprint_offset + StunAttributeHeaderSize]);
+}
+
+bool StunMessage::UpdateTransactionId(const std::shared_ptr<ov::Data> &serialized, const uint8_t transaction_id[OV_STUN_TRANSACTION_ID_LENGTH], const ov::Hmac &hmac)
+{
+	auto buffer = serialized->GetWritableDataAs<uint8_t>();
+	size_t length = serialized->GetLength();
+	// Serialize() always appends MESSAGE-INTEGRITY and FINGERPRINT
+	size_t fingerprint_size = StunAttributeHeaderSize + sizeof(uint32_t);
+	size_t integrity_size = StunAttributeHeaderSize + StunMessageIntegritySize;
+
+	if(length < (DefaultHeaderLength() + integrity_size + fingerprint_size))
+	{
+		OV_ASSERT2(false);
+		return false;
+	}
+
+	size_t fingerprint_offset = length - fingerprint_size;
+	size_t integrity_offset = fingerprint_offset - integrity_size;
+
+	// Magic cookie (4B) is followed by the transaction id
+	::memcpy(&buffer[8], transaction_id, OV_STUN_TRANSACTION_ID_LENGTH);
+
+	// The message length includes MESSAGE-INTEGRITY, but not FINGERPRINT, when computing the hash (see WriteMessageIntegrityAttribute())
+	ByteWriter<uint16_t>::WriteBigEndian(&buffer[2], static_cast<uint16_t>(fingerprint_offset - DefaultHeaderLength()));
+
+	if(hmac.Compute(buffer, integrity_offset, &buffer[integrity_offset + StunAttributeHeaderSize], StunMessageIntegritySize) == false)
+	{
+		return false;
+	}
+
+	ByteWriter<uint16_t>::WriteBigEndian(&buffer[2], static_cast<uint16_t>(length - DefaultHeaderLength()));
+
+	uint32_t crc = ov::Crc32::Calculate(buffer, fingerprint_offset) ^ OV_STUN_FINGERPRINT_XOR_VALUE;
+	ByteWriter<uint32_t>::WriteBigEndian(&buffer[fingerprint_offset + StunAttributeHeaderSize], crc);
+
+	return true;
+}
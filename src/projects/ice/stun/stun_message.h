@@ -14,12 +14,26 @@
 
 #include <base/ovlibrary/ovlibrary.h>
 #include <base/ovsocket/ovsocket.h>
+#include <base/ovcrypto/ovcrypto.h>
 
 #include "attributes/stun_attribute.h"
 
+// Maximum number of the attributes which ParseFlat() records (a binding request has about 6)
+#define OV_STUN_MAX_FLAT_ATTRIBUTE_COUNT                        16
+
 class StunMessage
 {
 public:
+	// An attribute which is recorded by ParseFlat() (the value is not copied)
+	struct FlatAttribute
+	{
+		StunAttributeType type;
+		// Offset of the value from the start of the message
+		uint16_t offset;
+		// Length of the value (without the padding)
+		uint16_t length;
+	};
+
 	StunMessage();
 	virtual ~StunMessage();
 
@@ -28,6 +42,24 @@ public:
 	// TCP에서 데이터가 덜 들어오면 어떻게 되나? TCP에서 데이터가 덜 들어오는 경우가 있나 확인 필요
 	bool Parse(ov::ByteStream &stream);
 
+	// Zero-allocation parse of a received message
+	//
+	// - The header is parsed, and the type/offset/length of each attribute is recorded into an inline table
+	//   (StunAttribute instances are not created), FINGERPRINT is validated like Parse()
+	// - The values are decoded when they are requested (GetAttributeValue(), GetUserName(), GetUfrags())
+	// - data must outlive the message, and GetAttribute<T>() returns nullptr for the message
+	bool ParseFlat(const ov::Data *data);
+
+	bool IsFlat() const
+	{
+		return _flat_data != nullptr;
+	}
+
+	// The value of the attribute of the message which is parsed by ParseFlat()
+	bool GetAttributeValue(StunAttributeType type, const uint8_t **value, size_t *length) const;
+	// USERNAME ("<ufrag of the receiver>:<ufrag of the sender>"), available in both modes
+	bool GetUserName(ov::StringView *user_name) const;
+
 	bool IsValid() const;
 
 	bool CheckIntegrity(const ov::String &password) const;
@@ -86,6 +118,14 @@ public:
 
 	std::shared_ptr<ov::Data> Serialize(const ov::String &integrity_key);
 
+	// Fast path of the binding (without parsing the attributes and allocating them)
+
+	// Checks whether data is a binding request to local_ufrag (USERNAME: "<local_ufrag>:<remote_ufrag>") with a valid FINGERPRINT
+	static bool IsBindingRequestOf(const ov::Data *data, const ov::String &local_ufrag);
+	// Replaces the transaction id of the message serialized by Serialize(), and updates MESSAGE-INTEGRITY and FINGERPRINT
+	// (hmac: created with the integrity key of Serialize())
+	static bool UpdateTransactionId(const std::shared_ptr<ov::Data> &serialized, const uint8_t transaction_id[OV_STUN_TRANSACTION_ID_LENGTH], const ov::Hmac &hmac);
+
 protected:
 	bool ParseHeader(ov::ByteStream &stream);
 	bool ParseAttributes(ov::ByteStream &stream);
@@ -103,6 +143,8 @@ protected:
 	// spec: RFC 5389, section 7.3, 15.5
 	bool CalculateFingerprint(ov::ByteStream &stream, ssize_t length, uint32_t *fingerprint) const;
 	bool ValidateFingerprint(ov::ByteStream &stream);
+	// The last attribute of the message must be a valid FINGERPRINT (false: this is not a STUN message)
+	static bool HasValidFingerprint(const uint8_t *buffer, size_t length);
 
 	bool _parsed;
 
@@ -117,4 +159,9 @@ protected:
 	// Integrity attribute와 Fingerprint attribute는 모든 데이터가 입력된 후 Serialze()할 때 자동 생성 되는 것이므로 별도로 취급함
 	std::unique_ptr<StunAttribute> _integrity_attribute;
 	std::unique_ptr<StunAttribute> _fingerprint_attribute;
+
+	// The message parsed by ParseFlat() (nullptr: Parse() or the message is created)
+	const uint8_t *_flat_data = nullptr;
+	FlatAttribute _flat_attributes[OV_STUN_MAX_FLAT_ATTRIBUTE_COUNT];
+	size_t _flat_attribute_count = 0;
 };
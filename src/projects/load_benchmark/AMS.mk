@@ -0,0 +1,22 @@
+LOCAL_PATH := $(call get_local_path)
+include $(DEFAULT_VARIABLES)
+
+LOCAL_STATIC_LIBRARIES := \
+	rtmpprovider \
+	ice \
+	dtls_srtp \
+	socket \
+	ovcrypto \
+	ovlibrary \
+	jsoncpp
+
+LOCAL_LDFLAGS := \
+	-lpthread \
+	-ldl \
+	`pkg-config --libs srt` \
+	`pkg-config --libs openssl` \
+	`pkg-config --libs libsrtp2`
+
+LOCAL_TARGET := load_benchmark
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,563 @@
+//==============================================================================
+//
+//  LoadBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "http_subscriber.h"
+#include "load_worker.h"
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#define OV_LOG_TAG "LoadBenchmark.Http"
+
+#define TS_PACKET_SIZE							188
+#define TS_SYNC_BYTE							0x47
+
+HttpSubscriber::HttpSubscriber(HttpSubscriberType type, const LoadUrl &playlist_url, const std::shared_ptr<LoadStatistics> &statistics)
+	: LoadSession(statistics),
+	  _type(type),
+	  _playlist_url(playlist_url)
+{
+}
+
+bool HttpSubscriber::OnStart(int64_t now)
+{
+	// The variant of the multivariant playlist is selected again
+	_url = _playlist_url;
+	_segments.clear();
+	_last_segment_id = -1;
+	_poll_interval = HTTP_SUBSCRIBER_DEFAULT_POLL_INTERVAL;
+	_next_poll_time = now;
+
+	return RequestNext(now);
+}
+
+void HttpSubscriber::OnClose()
+{
+	_request_type = RequestType::None;
+	_body.Clear();
+}
+
+bool HttpSubscriber::OnEvent(int fd, uint32_t events, int64_t now)
+{
+	if(fd != _tcp_socket)
+	{
+		// The socket is already closed
+		return true;
+	}
+
+	if(events & EPOLLERR)
+	{
+		_statistics->request_errors++;
+		return false;
+	}
+
+	if(events & EPOLLOUT)
+	{
+		if(_is_tcp_connected == false)
+		{
+			int error = 0;
+			socklen_t length = sizeof(error);
+
+			if((::getsockopt(_tcp_socket, SOL_SOCKET, SO_ERROR, &error, &length) != 0) || (error != 0))
+			{
+				logtd("Could not connect to %s: %s", _url.address.ToString().CStr(), ::strerror(error));
+				_statistics->request_errors++;
+				return false;
+			}
+
+			_is_tcp_connected = true;
+		}
+
+		if(FlushTcp() == false)
+		{
+			return false;
+		}
+	}
+
+	if(events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))
+	{
+		bool is_connected = ReceiveTcp();
+
+		if(ProcessResponse(now) == false)
+		{
+			_statistics->request_errors++;
+			return false;
+		}
+
+		if(is_connected == false)
+		{
+			if(_request_type == RequestType::None)
+			{
+				// The keep-alive connection is closed by the server, connects again for the next request
+				CloseTcp();
+				return true;
+			}
+
+			if(_is_header_received && (_is_chunked == false) && (_content_length < 0))
+			{
+				// The body is terminated by the close
+				_body.Append(_tcp_buffer.GetData(), _tcp_buffer.GetLength());
+				CloseTcp();
+
+				return OnResponse(_status_code, now) && RequestNext(now);
+			}
+
+			_statistics->request_errors++;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool HttpSubscriber::OnTimer(int64_t now)
+{
+	if(_request_type != RequestType::None)
+	{
+		if((now - _request_time) > HTTP_SUBSCRIBER_REQUEST_TIMEOUT)
+		{
+			logtd("Timed out while requesting %s", _url.path.CStr());
+			_statistics->request_errors++;
+			return false;
+		}
+
+		return true;
+	}
+
+	return RequestNext(now);
+}
+
+bool HttpSubscriber::SendRequest(RequestType type, const LoadUrl &url, int64_t now)
+{
+	if((_tcp_socket < 0) && (ConnectTcp(url.address) == false))
+	{
+		_statistics->request_errors++;
+		return false;
+	}
+
+	auto request = ov::String::FormatString(
+		"GET %s HTTP/1.1\r\n"
+		"Host: %s:%d\r\n"
+		"User-Agent: LoadBenchmark\r\n"
+		"Accept: */*\r\n"
+		"Connection: keep-alive\r\n"
+		"\r\n",
+		url.path.CStr(), url.host.CStr(), url.port);
+
+	_request_type = type;
+	_request_time = now;
+	_is_header_received = false;
+	_status_code = 0;
+	_is_chunked = false;
+	_content_length = -1;
+	_body.Clear();
+
+	_statistics->requests++;
+
+	return SendTcp(request.CStr(), request.GetLength());
+}
+
+bool HttpSubscriber::RequestNext(int64_t now)
+{
+	if(_segments.empty() == false)
+	{
+		auto segment = _segments.front();
+		_segments.pop_front();
+
+		return SendRequest(RequestType::Segment, _url.Resolve(segment), now);
+	}
+
+	if(now >= _next_poll_time)
+	{
+		_next_poll_time = now + _poll_interval;
+
+		return SendRequest(RequestType::Playlist, _url, now);
+	}
+
+	return true;
+}
+
+bool HttpSubscriber::ProcessResponse(int64_t now)
+{
+	while(_request_type != RequestType::None)
+	{
+		if(_is_header_received == false)
+		{
+			size_t header_length = 0;
+			std::map<ov::String, ov::String> headers;
+
+			if(ParseHttpResponseHeader(_tcp_buffer, &header_length, &_status_code, &headers) == false)
+			{
+				// Waits for the rest of the header
+				return true;
+			}
+
+			if(_status_code < 0)
+			{
+				logtd("Invalid response of %s", _url.path.CStr());
+				return false;
+			}
+
+			_tcp_buffer.Erase(0, header_length);
+			_is_header_received = true;
+
+			auto item = headers.find("transfer-encoding");
+			_is_chunked = (item != headers.end()) && (item->second.LowerCaseString().IndexOf("chunked") >= 0);
+
+			item = headers.find("content-length");
+			_content_length = (item != headers.end()) ? ov::Converter::ToInt64(item->second) : -1;
+
+			if((_is_chunked == false) && (_content_length < 0) && ((_status_code == 204) || (_status_code == 304)))
+			{
+				_content_length = 0;
+			}
+		}
+
+		bool is_completed = false;
+
+		if(ReadBody(&is_completed) == false)
+		{
+			return false;
+		}
+
+		if(is_completed == false)
+		{
+			return true;
+		}
+
+		if((OnResponse(_status_code, now) == false) || (RequestNext(now) == false))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool HttpSubscriber::ReadBody(bool *is_completed)
+{
+	*is_completed = false;
+
+	if(_is_chunked == false)
+	{
+		if(_content_length < 0)
+		{
+			// Until the connection is closed
+			return true;
+		}
+
+		auto length = std::min<size_t>(_tcp_buffer.GetLength(), static_cast<size_t>(_content_length) - _body.GetLength());
+
+		_body.Append(_tcp_buffer.GetData(), length);
+		_tcp_buffer.Erase(0, length);
+
+		*is_completed = (_body.GetLength() == static_cast<size_t>(_content_length));
+
+		return true;
+	}
+
+	// <size in hex>\r\n<data>\r\n ... 0\r\n\r\n
+	while(true)
+	{
+		auto data = _tcp_buffer.GetDataAs<char>();
+		auto end = data + _tcp_buffer.GetLength();
+		auto line_end = std::search(data, end, "\r\n", "\r\n" + 2);
+
+		if(line_end == end)
+		{
+			return true;
+		}
+
+		auto chunk_size = static_cast<size_t>(::strtoul(ov::String(data, static_cast<size_t>(line_end - data)).CStr(), nullptr, 16));
+		size_t line_length = static_cast<size_t>(line_end - data) + 2;
+
+		if(_tcp_buffer.GetLength() < (line_length + chunk_size + 2))
+		{
+			// Waits for the rest of the chunk
+			return true;
+		}
+
+		_body.Append(data + line_length, chunk_size);
+		_tcp_buffer.Erase(0, line_length + chunk_size + 2);
+
+		if(chunk_size == 0)
+		{
+			// The trailers are not used
+			*is_completed = true;
+			return true;
+		}
+	}
+}
+
+bool HttpSubscriber::OnResponse(int status_code, int64_t now)
+{
+	auto request_type = _request_type;
+
+	_request_type = RequestType::None;
+
+	if((status_code / 100) != 2)
+	{
+		_statistics->request_errors++;
+
+		if((status_code == 404) && (request_type == RequestType::Segment))
+		{
+			// The segment is removed from the playlist already (the subscriber is too slow)
+			return true;
+		}
+
+		logtd("%s returns %d", _url.path.CStr(), status_code);
+
+		// The stream may not be ready (e.g. the publisher is reconnecting)
+		return (status_code / 100) == 4;
+	}
+
+	if(request_type == RequestType::Playlist)
+	{
+		ov::String playlist(_body.GetDataAs<char>(), _body.GetLength());
+
+		return (_type == HttpSubscriberType::Hls) ? ParseHlsPlaylist(playlist, now) : ParseDashManifest(playlist, now);
+	}
+
+	ProcessSegment(_body);
+
+	return true;
+}
+
+bool HttpSubscriber::ParseHlsPlaylist(const ov::String &playlist, int64_t now)
+{
+	auto lines = playlist.Replace("\r", "").Split("\n");
+	int64_t media_sequence = 0;
+	std::vector<ov::String> segments;
+	bool is_variant = false;
+
+	for(auto &item : lines)
+	{
+		auto line = item.Trim();
+
+		if(line.IsEmpty())
+		{
+			continue;
+		}
+
+		if(line.HasPrefix("#EXT-X-STREAM-INF"))
+		{
+			is_variant = true;
+		}
+		else if(line.HasPrefix("#EXT-X-MEDIA-SEQUENCE:"))
+		{
+			media_sequence = ov::Converter::ToInt64(line.Substring(22));
+		}
+		else if(line.HasPrefix("#EXT-X-TARGETDURATION:"))
+		{
+			// Polls twice in a segment duration
+			_poll_interval = std::max<int64_t>(ov::Converter::ToInt64(line.Substring(22)) * 1000 / 2, HTTP_SUBSCRIBER_MIN_POLL_INTERVAL);
+		}
+		else if(line.HasPrefix("#") == false)
+		{
+			if(is_variant)
+			{
+				// Follows the first variant
+				_url = _url.Resolve(line);
+				_next_poll_time = now;
+
+				return true;
+			}
+
+			segments.push_back(line);
+		}
+	}
+
+	for(size_t index = 0; index < segments.size(); index++)
+	{
+		int64_t sequence = media_sequence + static_cast<int64_t>(index);
+
+		// Starts from the last segment
+		if((_last_segment_id < 0) ? (index == segments.size() - 1) : (sequence > _last_segment_id))
+		{
+			_segments.push_back(segments[index]);
+			_last_segment_id = sequence;
+		}
+	}
+
+	return true;
+}
+
+bool HttpSubscriber::ParseDashManifest(const ov::String &manifest, int64_t now)
+{
+	// The first video AdaptationSet
+	off_t adaptation_index = 0;
+
+	while(true)
+	{
+		adaptation_index = manifest.IndexOf("<AdaptationSet", adaptation_index);
+
+		if(adaptation_index < 0)
+		{
+			logtd("There is no video AdaptationSet in %s", _url.path.CStr());
+			return true;
+		}
+
+		auto adaptation_end = manifest.IndexOf(">", adaptation_index);
+		auto adaptation = manifest.Substring(adaptation_index, static_cast<size_t>(adaptation_end - adaptation_index));
+
+		if((GetXmlAttribute(adaptation, "mimeType").HasPrefix("video")) || (GetXmlAttribute(adaptation, "contentType") == "video"))
+		{
+			break;
+		}
+
+		adaptation_index = adaptation_end;
+	}
+
+	auto template_index = manifest.IndexOf("<SegmentTemplate", adaptation_index);
+	auto timeline_end = manifest.IndexOf("</SegmentTimeline>", adaptation_index);
+
+	if((template_index < 0) || (timeline_end < 0))
+	{
+		return true;
+	}
+
+	auto segment_template = manifest.Substring(template_index, static_cast<size_t>(manifest.IndexOf(">", template_index) - template_index));
+	auto media = GetXmlAttribute(segment_template, "media");
+	int64_t timescale = std::max<int64_t>(ov::Converter::ToInt64(GetXmlAttribute(segment_template, "timescale")), 1);
+
+	if(media.IndexOf("$Time$") < 0)
+	{
+		logtw("Only $Time$ of SegmentTemplate is supported: %s", media.CStr());
+		return false;
+	}
+
+	// <S t="..." d="..." r="..."/>
+	std::vector<std::pair<int64_t, int64_t>> segments;
+	int64_t time = 0;
+	off_t segment_index = template_index;
+
+	while(true)
+	{
+		segment_index = manifest.IndexOf("<S ", segment_index);
+
+		if((segment_index < 0) || (segment_index > timeline_end))
+		{
+			break;
+		}
+
+		auto segment_end = manifest.IndexOf(">", segment_index);
+		auto segment = manifest.Substring(segment_index, static_cast<size_t>(segment_end - segment_index));
+		auto t = GetXmlAttribute(segment, "t");
+		auto d = ov::Converter::ToInt64(GetXmlAttribute(segment, "d"));
+		auto r = ov::Converter::ToInt64(GetXmlAttribute(segment, "r"));
+
+		if(t.IsEmpty() == false)
+		{
+			time = ov::Converter::ToInt64(t);
+		}
+
+		for(int64_t repeat = 0; repeat <= r; repeat++)
+		{
+			segments.emplace_back(time, d);
+			time += d;
+		}
+
+		segment_index = segment_end;
+	}
+
+	if(segments.empty() == false)
+	{
+		_poll_interval = std::max<int64_t>(segments.back().second * 1000 / timescale / 2, HTTP_SUBSCRIBER_MIN_POLL_INTERVAL);
+	}
+
+	for(size_t index = 0; index < segments.size(); index++)
+	{
+		int64_t segment_time = segments[index].first;
+
+		if((_last_segment_id < 0) ? (index == segments.size() - 1) : (segment_time > _last_segment_id))
+		{
+			_segments.push_back(media.Replace("$Time$", ov::Converter::ToString(segment_time).CStr()));
+			_last_segment_id = segment_time;
+		}
+	}
+
+	return true;
+}
+
+void HttpSubscriber::ProcessSegment(const ov::Data &segment)
+{
+	std::vector<SyntheticMarker> markers;
+	auto data = segment.GetDataAs<uint8_t>();
+
+	if((segment.GetLength() >= TS_PACKET_SIZE) && (data[0] == TS_SYNC_BYTE) && ((segment.GetLength() % TS_PACKET_SIZE) == 0))
+	{
+		// The SEI may be split by the TS packets (and the packets of the other PIDs)
+		std::map<uint16_t, ov::Data> payloads;
+
+		DemuxTs(segment, &payloads);
+
+		for(auto &payload : payloads)
+		{
+			SyntheticStream::FindMarkers(payload.second.GetDataAs<uint8_t>(), payload.second.GetLength(), &markers);
+		}
+	}
+	else
+	{
+		// fMP4: the NAL units are not split in mdat
+		SyntheticStream::FindMarkers(data, segment.GetLength(), &markers);
+	}
+
+	OnMarkers(markers, SyntheticStream::GetWallClockMicroseconds());
+}
+
+ov::String HttpSubscriber::GetXmlAttribute(const ov::String &element, const char *name)
+{
+	auto pattern = ov::String::FormatString(" %s=\"", name);
+	auto index = element.IndexOf(pattern.CStr());
+
+	if(index < 0)
+	{
+		return "";
+	}
+
+	auto value_index = index + static_cast<off_t>(pattern.GetLength());
+	auto value_end = element.IndexOf('"', value_index);
+
+	if(value_end < 0)
+	{
+		return "";
+	}
+
+	return element.Substring(value_index, static_cast<size_t>(value_end - value_index));
+}
+
+void HttpSubscriber::DemuxTs(const ov::Data &segment, std::map<uint16_t, ov::Data> *payloads)
+{
+	auto data = segment.GetDataAs<uint8_t>();
+
+	for(size_t offset = 0; (offset + TS_PACKET_SIZE) <= segment.GetLength(); offset += TS_PACKET_SIZE)
+	{
+		auto packet = data + offset;
+
+		if(packet[0] != TS_SYNC_BYTE)
+		{
+			continue;
+		}
+
+		auto pid = static_cast<uint16_t>(((packet[1] & 0x1F) << 8) | packet[2]);
+		auto adaptation_field_control = (packet[3] >> 4) & 0x03;
+		size_t payload_offset = 4;
+
+		if(adaptation_field_control & 0x02)
+		{
+			payload_offset += 1 + packet[4];
+		}
+
+		if(((adaptation_field_control & 0x01) == 0) || (payload_offset >= TS_PACKET_SIZE))
+		{
+			continue;
+		}
+
+		(*payloads)[pid].Append(packet + payload_offset, TS_PACKET_SIZE - payload_offset);
+	}
+}
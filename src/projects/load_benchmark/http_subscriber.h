@@ -0,0 +1,88 @@
+//==============================================================================
+//
+//  LoadBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <deque>
+
+#include "load_session.h"
+
+// Timeout of a request (ms)
+#define HTTP_SUBSCRIBER_REQUEST_TIMEOUT			10000
+// Interval to poll the playlist if the duration of the segments is not known (ms)
+#define HTTP_SUBSCRIBER_DEFAULT_POLL_INTERVAL	1000
+#define HTTP_SUBSCRIBER_MIN_POLL_INTERVAL		200
+
+enum class HttpSubscriberType
+{
+	// playlist.m3u8 (follows the first variant of a multivariant playlist), MPEG-TS or fMP4 segments
+	Hls,
+	// manifest.mpd (the video SegmentTemplate with $Time$)
+	Dash,
+};
+
+// Polls the playlist like a player and downloads the new segments on a keep-alive connection
+//
+// - Starts from the last segment of the first playlist (the live edge)
+// - The markers of the segment are counted when the whole segment is received
+class HttpSubscriber : public LoadSession
+{
+public:
+	HttpSubscriber(HttpSubscriberType type, const LoadUrl &playlist_url, const std::shared_ptr<LoadStatistics> &statistics);
+
+	bool OnEvent(int fd, uint32_t events, int64_t now) override;
+	bool OnTimer(int64_t now) override;
+
+protected:
+	enum class RequestType
+	{
+		None,
+		Playlist,
+		Segment,
+	};
+
+	bool OnStart(int64_t now) override;
+	void OnClose() override;
+
+	bool SendRequest(RequestType type, const LoadUrl &url, int64_t now);
+	// Requests the next segment, or the playlist if it is time to poll
+	bool RequestNext(int64_t now);
+
+	// Parses the response in _tcp_buffer (returns false if the response is invalid)
+	bool ProcessResponse(int64_t now);
+	bool ReadBody(bool *is_completed);
+	bool OnResponse(int status_code, int64_t now);
+
+	bool ParseHlsPlaylist(const ov::String &playlist, int64_t now);
+	bool ParseDashManifest(const ov::String &manifest, int64_t now);
+	void ProcessSegment(const ov::Data &segment);
+
+	static ov::String GetXmlAttribute(const ov::String &element, const char *name);
+	// Concatenates the payloads of the TS packets of each PID
+	static void DemuxTs(const ov::Data &segment, std::map<uint16_t, ov::Data> *payloads);
+
+	HttpSubscriberType _type;
+	LoadUrl _playlist_url;
+	LoadUrl _url;
+
+	RequestType _request_type = RequestType::None;
+	int64_t _request_time = 0;
+
+	// The header of the current response
+	bool _is_header_received = false;
+	int _status_code = 0;
+	bool _is_chunked = false;
+	int64_t _content_length = -1;
+	ov::Data _body;
+
+	int64_t _next_poll_time = 0;
+	int64_t _poll_interval = HTTP_SUBSCRIBER_DEFAULT_POLL_INTERVAL;
+
+	std::deque<ov::String> _segments;
+	// HLS: media sequence, DASH: time of the last segment which is downloaded
+	int64_t _last_segment_id = -1;
+};
@@ -0,0 +1,314 @@
+//==============================================================================
+//
+//  LoadBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "load_session.h"
+#include "load_worker.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define OV_LOG_TAG "LoadBenchmark.Session"
+
+bool LoadUrl::Parse(const ov::String &url, LoadUrl *load_url)
+{
+	auto scheme_index = url.IndexOf("://");
+
+	if(scheme_index <= 0)
+	{
+		return false;
+	}
+
+	load_url->scheme = url.Substring(0, static_cast<size_t>(scheme_index)).LowerCaseString();
+
+	if((load_url->scheme != "http") && (load_url->scheme != "ws"))
+	{
+		return false;
+	}
+
+	auto address = url.Substring(scheme_index + 3);
+	auto path_index = address.IndexOf('/');
+	auto host_port = (path_index < 0) ? address : address.Substring(0, static_cast<size_t>(path_index));
+
+	load_url->path = (path_index < 0) ? "/" : address.Substring(path_index);
+
+	auto port_index = host_port.IndexOfRev(':');
+
+	if(port_index > 0)
+	{
+		load_url->host = host_port.Substring(0, static_cast<size_t>(port_index));
+		load_url->port = ov::Converter::ToUInt16(host_port.Substring(port_index + 1));
+	}
+	else
+	{
+		load_url->host = host_port;
+		load_url->port = 80;
+	}
+
+	if(load_url->host.IsEmpty() || (load_url->port == 0))
+	{
+		return false;
+	}
+
+	load_url->address = ov::SocketAddress(load_url->host, load_url->port);
+
+	return (load_url->address.AddressLength() > 0);
+}
+
+LoadUrl LoadUrl::Resolve(const ov::String &relative_path) const
+{
+	LoadUrl url = *this;
+
+	if(relative_path.HasPrefix("/"))
+	{
+		url.path = relative_path;
+	}
+	else
+	{
+		// The query string of the playlist is not kept
+		auto query_index = path.IndexOf('?');
+		auto directory = (query_index < 0) ? path : path.Substring(0, static_cast<size_t>(query_index));
+
+		url.path = directory.Substring(0, static_cast<size_t>(directory.IndexOfRev('/') + 1)) + relative_path;
+	}
+
+	return url;
+}
+
+LoadSession::LoadSession(const std::shared_ptr<LoadStatistics> &statistics)
+	: _statistics(statistics)
+{
+}
+
+LoadSession::~LoadSession()
+{
+	CloseTcp();
+}
+
+bool LoadSession::Start(LoadWorker *worker, uint32_t slot, int64_t now)
+{
+	_worker = worker;
+	_slot = slot;
+	_is_started = true;
+	_last_frame_index = -1;
+
+	_statistics->started_sessions++;
+
+	return OnStart(now);
+}
+
+void LoadSession::Close(bool failed)
+{
+	if(_is_started == false)
+	{
+		return;
+	}
+
+	OnClose();
+	CloseTcp();
+	SetPlaying(false);
+
+	_is_started = false;
+	_restart_time = (ov::LatencyHistogram::GetCurrentMicroseconds() / 1000) + LOAD_SESSION_RESTART_INTERVAL;
+
+	if(failed)
+	{
+		_statistics->failed_sessions++;
+	}
+}
+
+bool LoadSession::ConnectTcp(const ov::SocketAddress &address)
+{
+	CloseTcp();
+
+	_tcp_socket = ::socket(address.Address()->sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	if(_tcp_socket < 0)
+	{
+		logtw("Could not create a socket: %s", ::strerror(errno));
+		return false;
+	}
+
+	int no_delay = 1;
+	::setsockopt(_tcp_socket, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+	if((::connect(_tcp_socket, address.Address(), address.AddressLength()) != 0) && (errno != EINPROGRESS))
+	{
+		logtw("Could not connect to %s: %s", address.ToString().CStr(), ::strerror(errno));
+		CloseTcp();
+		return false;
+	}
+
+	// EPOLLOUT: the connection is completed
+	return _worker->AddSocket(_tcp_socket, EPOLLIN | EPOLLOUT | EPOLLRDHUP, _slot);
+}
+
+bool LoadSession::SendTcp(const void *data, size_t length)
+{
+	if(_tcp_socket < 0)
+	{
+		return false;
+	}
+
+	_tcp_send_buffer.Append(data, length);
+
+	return _is_tcp_connected ? FlushTcp() : true;
+}
+
+bool LoadSession::FlushTcp()
+{
+	while(_tcp_send_buffer.GetLength() > 0)
+	{
+		auto sent = ::send(_tcp_socket, _tcp_send_buffer.GetData(), _tcp_send_buffer.GetLength(), MSG_NOSIGNAL | MSG_DONTWAIT);
+
+		if(sent < 0)
+		{
+			if((errno == EAGAIN) || (errno == EWOULDBLOCK))
+			{
+				// Waits for EPOLLOUT
+				return _worker->ModifySocket(_tcp_socket, EPOLLIN | EPOLLOUT | EPOLLRDHUP, _slot);
+			}
+
+			return false;
+		}
+
+		_tcp_send_buffer.Erase(0, static_cast<size_t>(sent));
+	}
+
+	return _worker->ModifySocket(_tcp_socket, EPOLLIN | EPOLLRDHUP, _slot);
+}
+
+bool LoadSession::ReceiveTcp()
+{
+	// Shared by the sessions of the worker, so an idle session doesn't keep a large buffer
+	auto buffer = _worker->GetReceiveBuffer();
+
+	while(true)
+	{
+		auto received = ::recv(_tcp_socket, buffer, LOAD_SESSION_RECV_CHUNK_SIZE, MSG_DONTWAIT);
+
+		if(received > 0)
+		{
+			_tcp_buffer.Append(buffer, static_cast<size_t>(received));
+			_statistics->bytes += static_cast<uint64_t>(received);
+
+			if(received < LOAD_SESSION_RECV_CHUNK_SIZE)
+			{
+				return true;
+			}
+
+			continue;
+		}
+
+		if(received == 0)
+		{
+			// Disconnected by the server
+			return false;
+		}
+
+		return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR);
+	}
+}
+
+void LoadSession::CloseTcp()
+{
+	if(_tcp_socket >= 0)
+	{
+		if(_worker != nullptr)
+		{
+			_worker->RemoveSocket(_tcp_socket);
+		}
+
+		::close(_tcp_socket);
+		_tcp_socket = -1;
+	}
+
+	_is_tcp_connected = false;
+	_tcp_buffer.Clear();
+	_tcp_send_buffer.Clear();
+}
+
+void LoadSession::OnMarkers(const std::vector<SyntheticMarker> &markers, int64_t now_wall_clock)
+{
+	for(auto &marker : markers)
+	{
+		auto frame_index = static_cast<int64_t>(marker.frame_index);
+
+		if(frame_index <= _last_frame_index)
+		{
+			// Retransmitted or the same segment
+			continue;
+		}
+
+		if(_last_frame_index >= 0)
+		{
+			_statistics->lost_frames += static_cast<uint64_t>(frame_index - _last_frame_index - 1);
+		}
+
+		_last_frame_index = frame_index;
+
+		_statistics->frames++;
+		_statistics->latency.Record(now_wall_clock - marker.wall_clock);
+	}
+
+	if(markers.empty() == false)
+	{
+		SetPlaying(true);
+	}
+}
+
+void LoadSession::SetPlaying(bool playing)
+{
+	if(_is_playing != playing)
+	{
+		_is_playing = playing;
+		_statistics->playing_sessions += playing ? 1 : -1;
+	}
+}
+
+bool LoadSession::ParseHttpResponseHeader(const ov::Data &data, size_t *header_length, int *status_code, std::map<ov::String, ov::String> *headers)
+{
+	auto begin = data.GetDataAs<char>();
+	auto end = begin + data.GetLength();
+	auto header_end = std::search(begin, end, "\r\n\r\n", "\r\n\r\n" + 4);
+
+	if(header_end == end)
+	{
+		return false;
+	}
+
+	*header_length = static_cast<size_t>(header_end - begin) + 4;
+	*status_code = -1;
+	headers->clear();
+
+	auto lines = ov::String(begin, static_cast<size_t>(header_end - begin)).Split("\r\n");
+
+	// HTTP/1.1 200 OK
+	auto status_line = lines[0].Split(" ");
+
+	if((status_line.size() < 2) || (status_line[0].HasPrefix("HTTP/") == false))
+	{
+		return true;
+	}
+
+	*status_code = ov::Converter::ToInt32(status_line[1], 10);
+
+	for(size_t index = 1; index < lines.size(); index++)
+	{
+		auto colon_index = lines[index].IndexOf(':');
+
+		if(colon_index > 0)
+		{
+			(*headers)[lines[index].Substring(0, static_cast<size_t>(colon_index)).Trim().LowerCaseString()] = lines[index].Substring(colon_index + 1).Trim();
+		}
+	}
+
+	return true;
+}
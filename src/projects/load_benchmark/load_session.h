@@ -0,0 +1,133 @@
+//==============================================================================
+//
+//  LoadBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+#include <base/ovlibrary/latency_histogram.h>
+#include <base/ovsocket/socket_address.h>
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+#include "synthetic_stream.h"
+
+// Interval to start a failed session again (ms)
+#define LOAD_SESSION_RESTART_INTERVAL			1000
+// Size of a read() from the sockets
+#define LOAD_SESSION_RECV_CHUNK_SIZE			(64 * 1024)
+
+class LoadWorker;
+
+// http://<host>[:<port>]/<path>, ws://<host>[:<port>]/<path> (TLS is not supported)
+struct LoadUrl
+{
+	ov::String scheme;
+	ov::String host;
+	uint16_t port = 0;
+	// Starts with '/' (with the query string)
+	ov::String path;
+
+	// Resolved once, so the sessions don't resolve the host
+	ov::SocketAddress address;
+
+	static bool Parse(const ov::String &url, LoadUrl *load_url);
+
+	// The URL of which the path is replaced by the relative path (e.g. a segment of the playlist)
+	LoadUrl Resolve(const ov::String &relative_path) const;
+};
+
+// Statistics of the sessions of a protocol (shared by the workers)
+struct LoadStatistics
+{
+	// Wall clock of the receiver - wall clock of the marker (microseconds)
+	ov::LatencyHistogram latency;
+
+	std::atomic<uint64_t> started_sessions { 0 };
+	// Sessions which are receiving the frames
+	std::atomic<int64_t> playing_sessions { 0 };
+	std::atomic<uint64_t> failed_sessions { 0 };
+
+	std::atomic<uint64_t> frames { 0 };
+	// Gaps of the frame indexes of the markers
+	std::atomic<uint64_t> lost_frames { 0 };
+	std::atomic<uint64_t> bytes { 0 };
+
+	// WebRTC only (gaps of the sequence numbers)
+	std::atomic<uint64_t> rtp_packets { 0 };
+	std::atomic<uint64_t> lost_rtp_packets { 0 };
+
+	// HLS/DASH only
+	std::atomic<uint64_t> requests { 0 };
+	std::atomic<uint64_t> request_errors { 0 };
+};
+
+// A subscriber which is driven by a LoadWorker (all methods are called by the worker thread)
+//
+// - The sockets are non-blocking and registered to the epoll of the worker, so a worker runs thousands of sessions
+// - If a method returns false, the session is closed and started again after LOAD_SESSION_RESTART_INTERVAL
+class LoadSession
+{
+public:
+	LoadSession(const std::shared_ptr<LoadStatistics> &statistics);
+	virtual ~LoadSession();
+
+	bool Start(LoadWorker *worker, uint32_t slot, int64_t now);
+	// failed: counts the session as failed
+	void Close(bool failed);
+
+	bool IsStarted() const
+	{
+		return _is_started;
+	}
+
+	int64_t GetRestartTime() const
+	{
+		return _restart_time;
+	}
+
+	// now: monotonic time (ms)
+	virtual bool OnEvent(int fd, uint32_t events, int64_t now) = 0;
+	virtual bool OnTimer(int64_t now) = 0;
+
+protected:
+	virtual bool OnStart(int64_t now) = 0;
+	virtual void OnClose() = 0;
+
+	// The TCP connection of the session (signalling or HTTP)
+	bool ConnectTcp(const ov::SocketAddress &address);
+	// The data is queued if the socket is not writable (sent by FlushTcp() when EPOLLOUT)
+	bool SendTcp(const void *data, size_t length);
+	bool FlushTcp();
+	// Appends all received data to _tcp_buffer, returns false if the peer is disconnected
+	bool ReceiveTcp();
+	void CloseTcp();
+
+	// now_wall_clock: SyntheticStream::GetWallClockMicroseconds()
+	void OnMarkers(const std::vector<SyntheticMarker> &markers, int64_t now_wall_clock);
+	void SetPlaying(bool playing);
+
+	// Parses the header of an HTTP response (header_length: including the empty line)
+	// - returns false if the header is not received yet, status_code is -1 if the header is invalid
+	static bool ParseHttpResponseHeader(const ov::Data &data, size_t *header_length, int *status_code, std::map<ov::String, ov::String> *headers);
+
+	LoadWorker *_worker = nullptr;
+	uint32_t _slot = 0;
+	std::shared_ptr<LoadStatistics> _statistics;
+
+	int _tcp_socket = -1;
+	bool _is_tcp_connected = false;
+	ov::Data _tcp_buffer;
+	ov::Data _tcp_send_buffer;
+
+private:
+	bool _is_started = false;
+	bool _is_playing = false;
+	int64_t _restart_time = 0;
+	int64_t _last_frame_index = -1;
+};
@@ -0,0 +1,211 @@
+//==============================================================================
+//
+//  LoadBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "load_worker.h"
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#define OV_LOG_TAG "LoadBenchmark.Worker"
+
+// epoll_event.data.u64: slot (32 bits) + socket (32 bits)
+#define LOAD_WORKER_MAKE_EVENT_DATA(slot, socket)	((static_cast<uint64_t>(slot) << 32) | static_cast<uint32_t>(socket))
+
+LoadWorker::LoadWorker()
+	: _receive_buffer(LOAD_SESSION_RECV_CHUNK_SIZE)
+{
+}
+
+LoadWorker::~LoadWorker()
+{
+	Stop();
+}
+
+bool LoadWorker::Start(int index)
+{
+	if(_stop_thread_flag == false)
+	{
+		return false;
+	}
+
+	_index = index;
+	_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+
+	if(_epoll < 0)
+	{
+		logte("Could not create an epoll for worker #%d: %s", index, ::strerror(errno));
+		return false;
+	}
+
+	_stop_thread_flag = false;
+	_worker_thread = std::thread(&LoadWorker::WorkerThread, this);
+
+	return true;
+}
+
+void LoadWorker::Stop()
+{
+	if(_stop_thread_flag)
+	{
+		return;
+	}
+
+	_stop_thread_flag = true;
+
+	if(_worker_thread.joinable())
+	{
+		_worker_thread.join();
+	}
+
+	for(auto &session : _sessions)
+	{
+		session->Close(false);
+	}
+
+	_sessions.clear();
+	_pending_sessions.clear();
+
+	::close(_epoll);
+	_epoll = -1;
+}
+
+void LoadWorker::AddSession(const std::shared_ptr<LoadSession> &session)
+{
+	std::lock_guard<std::mutex> lock_guard(_pending_mutex);
+
+	_pending_sessions.push_back(session);
+	_session_count++;
+}
+
+bool LoadWorker::AddSocket(int socket, uint32_t events, uint32_t slot)
+{
+	epoll_event event {};
+
+	event.events = events;
+	event.data.u64 = LOAD_WORKER_MAKE_EVENT_DATA(slot, socket);
+
+	if(::epoll_ctl(_epoll, EPOLL_CTL_ADD, socket, &event) != 0)
+	{
+		logtw("Could not add the socket #%d to worker #%d: %s", socket, _index, ::strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+bool LoadWorker::ModifySocket(int socket, uint32_t events, uint32_t slot)
+{
+	epoll_event event {};
+
+	event.events = events;
+	event.data.u64 = LOAD_WORKER_MAKE_EVENT_DATA(slot, socket);
+
+	return (::epoll_ctl(_epoll, EPOLL_CTL_MOD, socket, &event) == 0);
+}
+
+void LoadWorker::RemoveSocket(int socket)
+{
+	::epoll_ctl(_epoll, EPOLL_CTL_DEL, socket, nullptr);
+}
+
+void LoadWorker::WorkerThread()
+{
+	ov::String thread_name = ov::String::FormatString("LoadWorker%d", _index);
+	::pthread_setname_np(::pthread_self(), thread_name.CStr());
+
+	std::vector<epoll_event> events(LOAD_WORKER_MAX_EPOLL_EVENTS);
+	int64_t next_timer = 0;
+
+	while(_stop_thread_flag == false)
+	{
+		int count = ::epoll_wait(_epoll, events.data(), static_cast<int>(events.size()), LOAD_WORKER_TIMER_INTERVAL);
+		int64_t now = ov::LatencyHistogram::GetCurrentMicroseconds() / 1000;
+
+		if((count < 0) && (errno != EINTR))
+		{
+			logte("An error occurred while epoll_wait() of worker #%d: %s", _index, ::strerror(errno));
+			break;
+		}
+
+		for(int index = 0; index < count; index++)
+		{
+			auto &event = events[index];
+			auto slot = static_cast<uint32_t>(event.data.u64 >> 32);
+			auto socket = static_cast<int>(event.data.u64 & 0xFFFFFFFFULL);
+
+			if(slot >= _sessions.size())
+			{
+				continue;
+			}
+
+			auto &session = _sessions[slot];
+
+			// The socket may be closed by the previous event of the session
+			if(session->IsStarted() && (session->OnEvent(socket, event.events, now) == false))
+			{
+				session->Close(true);
+			}
+		}
+
+		if(now >= next_timer)
+		{
+			StartPendingSessions(now);
+			ProcessTimers(now);
+
+			next_timer = now + LOAD_WORKER_TIMER_INTERVAL;
+		}
+	}
+}
+
+void LoadWorker::StartPendingSessions(int64_t now)
+{
+	std::vector<std::shared_ptr<LoadSession>> sessions;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_pending_mutex);
+
+		sessions.swap(_pending_sessions);
+	}
+
+	for(auto &session : sessions)
+	{
+		auto slot = static_cast<uint32_t>(_sessions.size());
+
+		_sessions.push_back(session);
+
+		if(session->Start(this, slot, now) == false)
+		{
+			session->Close(true);
+		}
+	}
+}
+
+void LoadWorker::ProcessTimers(int64_t now)
+{
+	uint32_t slot = 0;
+
+	for(auto &session : _sessions)
+	{
+		if(session->IsStarted())
+		{
+			if(session->OnTimer(now) == false)
+			{
+				session->Close(true);
+			}
+		}
+		else if(now >= session->GetRestartTime())
+		{
+			if(session->Start(this, slot, now) == false)
+			{
+				session->Close(true);
+			}
+		}
+
+		slot++;
+	}
+}
@@ -0,0 +1,70 @@
+//==============================================================================
+//
+//  LoadBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "load_session.h"
+
+// Max events of an epoll_wait()
+#define LOAD_WORKER_MAX_EPOLL_EVENTS			1024
+// Interval to call LoadSession::OnTimer() (ms)
+#define LOAD_WORKER_TIMER_INTERVAL				20
+
+// Runs the sessions on a thread with an epoll (the sessions are never moved to other workers)
+class LoadWorker
+{
+public:
+	LoadWorker();
+	~LoadWorker();
+
+	bool Start(int index);
+	void Stop();
+
+	// Called by any thread (the session is started by the worker thread)
+	void AddSession(const std::shared_ptr<LoadSession> &session);
+
+	size_t GetSessionCount() const
+	{
+		return _session_count;
+	}
+
+	// Called by the sessions of the worker (slot: the slot which is given to LoadSession::Start())
+	bool AddSocket(int socket, uint32_t events, uint32_t slot);
+	bool ModifySocket(int socket, uint32_t events, uint32_t slot);
+	void RemoveSocket(int socket);
+
+	// Buffer of LOAD_SESSION_RECV_CHUNK_SIZE bytes for the sessions of the worker
+	uint8_t *GetReceiveBuffer()
+	{
+		return _receive_buffer.data();
+	}
+
+protected:
+	void WorkerThread();
+	void StartPendingSessions(int64_t now);
+	void ProcessTimers(int64_t now);
+
+	int _index = -1;
+	int _epoll = -1;
+
+	std::mutex _pending_mutex;
+	std::vector<std::shared_ptr<LoadSession>> _pending_sessions;
+
+	// The index is the slot of the session (the sessions are kept until the worker is stopped)
+	std::vector<std::shared_ptr<LoadSession>> _sessions;
+	std::atomic<size_t> _session_count { 0 };
+
+	std::vector<uint8_t> _receive_buffer;
+
+	std::atomic<bool> _stop_thread_flag { true };
+	std::thread _worker_thread;
+};
@@ -0,0 +1,550 @@
+//==============================================================================
+//
+//  LoadBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <base/ovcrypto/ovcrypto.h>
+#include <base/ovlibrary/log_write.h>
+#include <base/ovlibrary/json.h>
+#include <srtp2/srtp.h>
+
+#include "http_subscriber.h"
+#include "load_worker.h"
+#include "rtmp_publisher.h"
+#include "webrtc_subscriber.h"
+
+#define OV_LOG_TAG "LoadBenchmark"
+
+// Interval to check the stop condition (ms)
+#define BENCHMARK_TICK_INTERVAL				100
+// Waits for the publisher before the subscribers are started (ms)
+#define BENCHMARK_PUBLISH_TIMEOUT			10000
+
+struct ParseOption
+{
+	// -p <rtmp url>
+	ov::String publish_url = "";
+	// -s <width>x<height>, -f <frame rate>, -g <gop>, -b <bitrate>
+	int video_width = 1280;
+	int video_height = 720;
+	double video_frame_rate = 30.0;
+	int gop = 60;
+	int64_t bitrate = 2000000;
+
+	// -w <ws url> -W <count>, -l <hls url> -H <count>, -d <dash url> -D <count>
+	ov::String webrtc_url = "";
+	int webrtc_count = 0;
+	ov::String hls_url = "";
+	int hls_count = 0;
+	ov::String dash_url = "";
+	int dash_count = 0;
+	// -I <host>
+	ov::String ice_host = "";
+
+	// -t <threads>, -r <sessions per second>
+	int thread_count = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U));
+	int ramp_rate = 100;
+	// -T <seconds> (0: until SIGINT), -i <seconds> (0: only at the end)
+	int duration = 60;
+	int report_interval = 0;
+
+	// -P <pid>: measures the CPU time of the server
+	int server_pid = 0;
+	// -o <json path> (default: stdout)
+	ov::String output_path = "";
+};
+
+bool TryParseOption(int argc, char *argv[], ParseOption *parse_option)
+{
+	constexpr const char *opt_string = "hp:s:f:g:b:w:W:l:H:d:D:I:t:r:T:i:P:o:";
+
+	while(true)
+	{
+		int name = getopt(argc, argv, opt_string);
+
+		switch(name)
+		{
+			case -1:
+				// end of arguments
+				return (parse_option->webrtc_count + parse_option->hls_count + parse_option->dash_count) > 0;
+
+			case 'p':
+				parse_option->publish_url = optarg;
+				break;
+
+			case 's':
+				if(::sscanf(optarg, "%dx%d", &(parse_option->video_width), &(parse_option->video_height)) != 2)
+				{
+					return false;
+				}
+				break;
+
+			case 'f':
+				parse_option->video_frame_rate = std::max(::atof(optarg), 1.0);
+				break;
+
+			case 'g':
+				parse_option->gop = std::max(::atoi(optarg), 1);
+				break;
+
+			case 'b':
+				parse_option->bitrate = std::max(::atoll(optarg), 0LL);
+				break;
+
+			case 'w':
+				parse_option->webrtc_url = optarg;
+				break;
+
+			case 'W':
+				parse_option->webrtc_count = std::max(::atoi(optarg), 0);
+				break;
+
+			case 'l':
+				parse_option->hls_url = optarg;
+				break;
+
+			case 'H':
+				parse_option->hls_count = std::max(::atoi(optarg), 0);
+				break;
+
+			case 'd':
+				parse_option->dash_url = optarg;
+				break;
+
+			case 'D':
+				parse_option->dash_count = std::max(::atoi(optarg), 0);
+				break;
+
+			case 'I':
+				parse_option->ice_host = optarg;
+				break;
+
+			case 't':
+				parse_option->thread_count = std::max(::atoi(optarg), 1);
+				break;
+
+			case 'r':
+				parse_option->ramp_rate = std::max(::atoi(optarg), 1);
+				break;
+
+			case 'T':
+				parse_option->duration = std::max(::atoi(optarg), 0);
+				break;
+
+			case 'i':
+				parse_option->report_interval = std::max(::atoi(optarg), 0);
+				break;
+
+			case 'P':
+				parse_option->server_pid = std::max(::atoi(optarg), 0);
+				break;
+
+			case 'o':
+				parse_option->output_path = optarg;
+				break;
+
+			case 'h':
+			default: // '?'
+				printf("Usage: %s [OPTION]...\n", argv[0]);
+				printf("    -p <url>              Publish a synthetic stream to rtmp://<host>[:<port>]/<app>/<stream>\n");
+				printf("    -s <width>x<height>   Resolution of the video (default: 1280x720)\n");
+				printf("    -f <fps>              Frame rate of the video (default: 30)\n");
+				printf("    -g <frames>           Key frame interval (default: 60)\n");
+				printf("    -b <bps>              Bitrate of the video, 0 to not add the filler data (default: 2000000)\n");
+				printf("    -w <url>              WebRTC signalling URL (ws://<host>:<port>/<app>/<stream>)\n");
+				printf("    -W <count>            Number of WebRTC subscribers\n");
+				printf("    -l <url>              HLS playlist URL (http://<host>:<port>/<app>/<stream>/playlist.m3u8)\n");
+				printf("    -H <count>            Number of HLS subscribers\n");
+				printf("    -d <url>              DASH manifest URL (http://<host>:<port>/<app>/<stream>/manifest.mpd)\n");
+				printf("    -D <count>            Number of DASH subscribers\n");
+				printf("    -I <host>             Send the ICE/RTP to this host instead of the candidates\n");
+				printf("    -t <count>            Number of worker threads (default: number of CPUs)\n");
+				printf("    -r <count>            Number of subscribers started per second (default: 100)\n");
+				printf("    -T <seconds>          Duration after all subscribers are started, 0 until SIGINT (default: 60)\n");
+				printf("    -i <seconds>          Print the statistics periodically\n");
+				printf("    -P <pid>              Measure the CPU time of the server process\n");
+				printf("    -o <path>             Path of the JSON result (default: stdout)\n");
+				return false;
+		}
+	}
+}
+
+int64_t GetCurrentMilliseconds()
+{
+	return ov::LatencyHistogram::GetCurrentMicroseconds() / 1000;
+}
+
+// utime + stime of the process (in clock ticks)
+bool GetCpuTime(int pid, uint64_t *cpu_time)
+{
+	std::ifstream stat(ov::String::FormatString("/proc/%d/stat", pid).CStr());
+	std::string line;
+
+	if(std::getline(stat, line).fail())
+	{
+		return false;
+	}
+
+	// The comm field may have spaces, so the fields are counted after ")"
+	auto position = line.rfind(')');
+
+	if(position == std::string::npos)
+	{
+		return false;
+	}
+
+	std::istringstream fields(line.substr(position + 2));
+	std::string field;
+	uint64_t utime = 0;
+	uint64_t stime = 0;
+
+	// state(3) ... utime(14), stime(15)
+	for(int index = 3; index < 14; index++)
+	{
+		fields >> field;
+	}
+
+	fields >> utime >> stime;
+
+	if(fields.fail())
+	{
+		return false;
+	}
+
+	*cpu_time = utime + stime;
+
+	return true;
+}
+
+// A protocol to benchmark
+struct BenchmarkTarget
+{
+	const char *name;
+	int count;
+	std::shared_ptr<LoadStatistics> statistics;
+};
+
+Json::Value MakeResult(const ParseOption &parse_option, const std::vector<BenchmarkTarget> &targets, const RtmpPublisher *publisher,
+                       int64_t elapsed, double server_cpu_usage)
+{
+	Json::Value result(Json::ValueType::objectValue);
+
+	Json::Value &input = result["input"];
+	input["url"] = parse_option.publish_url.CStr();
+	input["width"] = parse_option.video_width;
+	input["height"] = parse_option.video_height;
+	input["frame_rate"] = parse_option.video_frame_rate;
+	input["gop"] = parse_option.gop;
+	input["bitrate"] = static_cast<Json::Int64>(parse_option.bitrate);
+
+	if(publisher != nullptr)
+	{
+		input["frames"] = static_cast<Json::UInt64>(publisher->GetVideoFrameCount());
+		input["reconnects"] = static_cast<Json::UInt64>(publisher->GetReconnectCount());
+	}
+
+	result["elapsed_ms"] = static_cast<Json::Int64>(elapsed);
+	result["threads"] = parse_option.thread_count;
+
+	int64_t total_playing_sessions = 0;
+	Json::Value &protocols = result["protocols"];
+
+	for(const auto &target : targets)
+	{
+		const auto &statistics = *(target.statistics);
+		Json::Value &protocol = protocols[target.name];
+
+		protocol["sessions"] = target.count;
+		protocol["started"] = static_cast<Json::UInt64>(statistics.started_sessions);
+		protocol["playing"] = static_cast<Json::Int64>(statistics.playing_sessions);
+		protocol["failed"] = static_cast<Json::UInt64>(statistics.failed_sessions);
+		protocol["frames"] = static_cast<Json::UInt64>(statistics.frames);
+		protocol["lost_frames"] = static_cast<Json::UInt64>(statistics.lost_frames);
+		protocol["bytes"] = static_cast<Json::UInt64>(statistics.bytes);
+
+		if(statistics.rtp_packets > 0)
+		{
+			protocol["rtp_packets"] = static_cast<Json::UInt64>(statistics.rtp_packets);
+			protocol["lost_rtp_packets"] = static_cast<Json::UInt64>(statistics.lost_rtp_packets);
+		}
+
+		if(statistics.requests > 0)
+		{
+			protocol["requests"] = static_cast<Json::UInt64>(statistics.requests);
+			protocol["request_errors"] = static_cast<Json::UInt64>(statistics.request_errors);
+		}
+
+		// From the frame is made by the publisher to it is received by a subscriber
+		Json::Value &latency = protocol["latency_us"];
+		latency["count"] = static_cast<Json::UInt64>(statistics.latency.GetCount());
+		latency["p50"] = static_cast<Json::Int64>(statistics.latency.GetPercentile(50.0));
+		latency["p90"] = static_cast<Json::Int64>(statistics.latency.GetPercentile(90.0));
+		latency["p99"] = static_cast<Json::Int64>(statistics.latency.GetPercentile(99.0));
+		latency["max"] = static_cast<Json::Int64>(statistics.latency.GetMax());
+
+		total_playing_sessions += statistics.playing_sessions;
+	}
+
+	if(parse_option.server_pid > 0)
+	{
+		Json::Value &server = result["server"];
+
+		server["pid"] = parse_option.server_pid;
+		// 100%: a core
+		server["cpu_usage"] = server_cpu_usage;
+		server["cpu_usage_per_viewer"] = (total_playing_sessions > 0) ? (server_cpu_usage / total_playing_sessions) : 0.0;
+	}
+
+	return result;
+}
+
+static volatile sig_atomic_t g_stop_flag = 0;
+
+void OnSignal(int signal_number)
+{
+	g_stop_flag = 1;
+}
+
+int main(int argc, char *argv[])
+{
+	ParseOption parse_option;
+
+	if(TryParseOption(argc, argv, &parse_option) == false)
+	{
+		return 1;
+	}
+
+	ov::LogWrite::Initialize(false);
+
+	::signal(SIGINT, OnSignal);
+	::signal(SIGTERM, OnSignal);
+	::signal(SIGPIPE, SIG_IGN);
+
+	if(ov::OpensslManager::InitializeOpenssl() == false)
+	{
+		logte("Could not initialize OpenSSL");
+		return 1;
+	}
+
+	if(srtp_init() != srtp_err_status_ok)
+	{
+		logte("Could not initialize SRTP");
+		return 1;
+	}
+
+	// Prepares the targets before the publisher, so the invalid URLs are reported immediately
+	std::vector<BenchmarkTarget> targets;
+	std::vector<std::shared_ptr<LoadSession>> sessions;
+
+	if(parse_option.webrtc_count > 0)
+	{
+		auto context = std::make_shared<WebRtcSubscriberContext>();
+		auto statistics = std::make_shared<LoadStatistics>();
+
+		context->ice_host = parse_option.ice_host;
+
+		if((LoadUrl::Parse(parse_option.webrtc_url, &(context->signalling_url)) == false) || (context->Prepare() == false))
+		{
+			logte("Could not prepare the WebRTC subscribers: %s", parse_option.webrtc_url.CStr());
+			return 1;
+		}
+
+		for(int index = 0; index < parse_option.webrtc_count; index++)
+		{
+			sessions.push_back(std::make_shared<WebRtcSubscriber>(context, statistics));
+		}
+
+		targets.push_back({ "webrtc", parse_option.webrtc_count, statistics });
+	}
+
+	for(auto type : { HttpSubscriberType::Hls, HttpSubscriberType::Dash })
+	{
+		bool is_hls = (type == HttpSubscriberType::Hls);
+		int count = is_hls ? parse_option.hls_count : parse_option.dash_count;
+		const ov::String &url = is_hls ? parse_option.hls_url : parse_option.dash_url;
+
+		if(count == 0)
+		{
+			continue;
+		}
+
+		LoadUrl load_url;
+		auto statistics = std::make_shared<LoadStatistics>();
+
+		if(LoadUrl::Parse(url, &load_url) == false)
+		{
+			logte("Invalid URL: %s", url.CStr());
+			return 1;
+		}
+
+		for(int index = 0; index < count; index++)
+		{
+			sessions.push_back(std::make_shared<HttpSubscriber>(type, load_url, statistics));
+		}
+
+		targets.push_back({ is_hls ? "hls" : "dash", count, statistics });
+	}
+
+	// The stream is published by another encoder if -p is not specified
+	std::unique_ptr<RtmpPublisher> publisher;
+
+	if(parse_option.publish_url.IsEmpty() == false)
+	{
+		auto stream = std::make_shared<SyntheticStream>(parse_option.video_width, parse_option.video_height, parse_option.video_frame_rate, parse_option.gop, parse_option.bitrate);
+
+		publisher = std::make_unique<RtmpPublisher>(stream);
+
+		if(publisher->Start(parse_option.publish_url) == false)
+		{
+			return 1;
+		}
+
+		int64_t publish_start_time = GetCurrentMilliseconds();
+
+		while((publisher->IsPublishing() == false) && (g_stop_flag == 0))
+		{
+			if((GetCurrentMilliseconds() - publish_start_time) > BENCHMARK_PUBLISH_TIMEOUT)
+			{
+				logte("Could not publish the stream: %s", parse_option.publish_url.CStr());
+				return 1;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(BENCHMARK_TICK_INTERVAL));
+		}
+	}
+
+	std::vector<std::unique_ptr<LoadWorker>> workers;
+
+	for(int index = 0; index < parse_option.thread_count; index++)
+	{
+		auto worker = std::make_unique<LoadWorker>();
+
+		if(worker->Start(index) == false)
+		{
+			return 1;
+		}
+
+		workers.push_back(std::move(worker));
+	}
+
+	// Interleaves the protocols, so all protocols are ramped up at the same time
+	std::vector<std::shared_ptr<LoadSession>> ordered_sessions;
+	{
+		std::vector<size_t> offsets;
+		size_t offset = 0;
+
+		for(const auto &target : targets)
+		{
+			offsets.push_back(offset);
+			offset += target.count;
+		}
+
+		for(int index = 0; ordered_sessions.size() < sessions.size(); index++)
+		{
+			for(size_t target_index = 0; target_index < targets.size(); target_index++)
+			{
+				if(index < targets[target_index].count)
+				{
+					ordered_sessions.push_back(sessions[offsets[target_index] + index]);
+				}
+			}
+		}
+	}
+
+	uint64_t start_cpu_time = 0;
+	bool has_cpu_time = (parse_option.server_pid > 0) && GetCpuTime(parse_option.server_pid, &start_cpu_time);
+
+	int64_t start_time = GetCurrentMilliseconds();
+	int64_t last_report_time = start_time;
+	int64_t end_time = -1;
+	size_t started_count = 0;
+	int64_t ticks_per_second = ::sysconf(_SC_CLK_TCK);
+
+	auto get_server_cpu_usage = [&](int64_t now) -> double {
+		uint64_t cpu_time = 0;
+
+		if((has_cpu_time == false) || (now <= start_time) || (GetCpuTime(parse_option.server_pid, &cpu_time) == false))
+		{
+			return 0.0;
+		}
+
+		return (static_cast<double>(cpu_time - start_cpu_time) / ticks_per_second) * 100000.0 / (now - start_time);
+	};
+
+	while(g_stop_flag == 0)
+	{
+		int64_t now = GetCurrentMilliseconds();
+
+		// Ramps up the subscribers
+		auto target_count = std::min(ordered_sessions.size(), static_cast<size_t>(((now - start_time) * parse_option.ramp_rate) / 1000) + 1);
+
+		while(started_count < target_count)
+		{
+			workers[started_count % workers.size()]->AddSession(ordered_sessions[started_count]);
+			started_count++;
+		}
+
+		if((end_time < 0) && (started_count == ordered_sessions.size()) && (parse_option.duration > 0))
+		{
+			end_time = now + (parse_option.duration * 1000);
+		}
+
+		if((end_time >= 0) && (now >= end_time))
+		{
+			break;
+		}
+
+		if((parse_option.report_interval > 0) && ((now - last_report_time) >= (parse_option.report_interval * 1000)))
+		{
+			// One line per report, so that the results can be collected by line
+			logti("Report: %s", ov::Json::Stringify(MakeResult(parse_option, targets, publisher.get(), now - start_time, get_server_cpu_usage(now))).Replace("\n", "").CStr());
+			last_report_time = now;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(BENCHMARK_TICK_INTERVAL));
+	}
+
+	int64_t now = GetCurrentMilliseconds();
+
+	// Measured before the sessions are closed
+	auto result = ov::Json::Stringify(MakeResult(parse_option, targets, publisher.get(), now - start_time, get_server_cpu_usage(now)));
+
+	for(auto &worker : workers)
+	{
+		worker->Stop();
+	}
+
+	if(publisher != nullptr)
+	{
+		publisher->Stop();
+	}
+
+	if(parse_option.output_path.IsEmpty())
+	{
+		printf("%s\n", result.CStr());
+	}
+	else
+	{
+		std::ofstream output(parse_option.output_path.CStr());
+
+		if(output.is_open() == false)
+		{
+			logte("Could not open the output: %s", parse_option.output_path.CStr());
+			return 1;
+		}
+
+		output << result.CStr() << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,740 @@
+//==============================================================================
+//
+//  LoadBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtmp_publisher.h"
+
+#include <sys/time.h>
+
+#define OV_LOG_TAG "LoadBenchmark.Rtmp"
+
+RtmpPublisher::RtmpPublisher(const std::shared_ptr<SyntheticStream> &stream)
+	: _stream(stream)
+{
+}
+
+RtmpPublisher::~RtmpPublisher()
+{
+	Stop();
+}
+
+//====================================================================================================
+// ParseUrl
+// - rtmp://<host>[:<port>]/<app>/<stream key>
+//====================================================================================================
+bool RtmpPublisher::ParseUrl(const ov::String &url)
+{
+	if(url.HasPrefix("rtmp://") == false)
+	{
+		return false;
+	}
+
+	auto address = url.Substring(7);
+	auto path_index = address.IndexOf('/');
+
+	if(path_index <= 0)
+	{
+		return false;
+	}
+
+	auto host_port = address.Substring(0, static_cast<size_t>(path_index));
+	auto path = address.Substring(path_index + 1);
+	auto key_index = path.IndexOfRev('/');
+
+	if((key_index <= 0) || (key_index == static_cast<off_t>(path.GetLength()) - 1))
+	{
+		return false;
+	}
+
+	_app = path.Substring(0, static_cast<size_t>(key_index));
+	_stream_key = path.Substring(key_index + 1);
+	_tc_url = ov::String::FormatString("rtmp://%s/%s", host_port.CStr(), _app.CStr());
+
+	auto port_index = host_port.IndexOfRev(':');
+
+	if(port_index > 0)
+	{
+		_host = host_port.Substring(0, static_cast<size_t>(port_index));
+		_port = ov::Converter::ToUInt16(host_port.Substring(port_index + 1));
+	}
+	else
+	{
+		_host = host_port;
+		_port = RTMP_DEFULT_PORT;
+	}
+
+	return (_host.IsEmpty() == false) && (_port != 0);
+}
+
+bool RtmpPublisher::Start(const ov::String &url)
+{
+	if(_stop_thread_flag == false)
+	{
+		return false;
+	}
+
+	if(ParseUrl(url) == false)
+	{
+		logte("Invalid RTMP URL: %s", url.CStr());
+		return false;
+	}
+
+	_recv_data = std::make_shared<ov::Data>(RTMP_PUBLISHER_RECV_BUFFER_SIZE);
+	_stop_thread_flag = false;
+
+	try
+	{
+		_worker_thread = std::thread(&RtmpPublisher::WorkerThread, this);
+	}
+	catch(const std::system_error &e)
+	{
+		logte("Failed to start the publisher thread (%s)", _tc_url.CStr());
+		_stop_thread_flag = true;
+		return false;
+	}
+
+	return true;
+}
+
+void RtmpPublisher::Stop()
+{
+	if(_stop_thread_flag)
+	{
+		return;
+	}
+
+	_stop_thread_flag = true;
+
+	if(_worker_thread.joinable())
+	{
+		_worker_thread.join();
+	}
+}
+
+//====================================================================================================
+// WorkerThread
+// - Connect -> Handshake -> Publish -> Send the frames in real time (until disconnected) -> Reconnect
+//====================================================================================================
+void RtmpPublisher::WorkerThread()
+{
+	while(_stop_thread_flag == false)
+	{
+		if(Connect() && Handshake() && Publish())
+		{
+			logti("Publishing %dx%d@%.2f to %s/%s", _stream->GetWidth(), _stream->GetHeight(), _stream->GetFrameRate(), _tc_url.CStr(), _stream_key.CStr());
+
+			// The frames are continued from the last frame, but not sent in a burst
+			_start_time = (SyntheticStream::GetWallClockMicroseconds() / 1000) - std::min(_stream->GetNextVideoTimestamp(), _stream->GetNextAudioTimestamp());
+
+			if(SendMetaData() && SendSequenceHeaders(static_cast<uint32_t>(_stream->GetNextVideoTimestamp())))
+			{
+				_publishing = true;
+
+				while((_stop_thread_flag == false) && SendFrames() && ReceiveData(false) && ProcessMessages())
+				{
+				}
+
+				_publishing = false;
+			}
+		}
+
+		Disconnect();
+
+		if(_stop_thread_flag)
+		{
+			break;
+		}
+
+		_reconnect_count++;
+
+		logtw("Could not publish to %s, retrying after %d ms", _tc_url.CStr(), RTMP_PUBLISHER_RECONNECT_INTERVAL);
+
+		for(int elapsed = 0; (elapsed < RTMP_PUBLISHER_RECONNECT_INTERVAL) && (_stop_thread_flag == false); elapsed += 100)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+	}
+}
+
+//====================================================================================================
+// Connect
+// - The socket is blocking (the timeouts bound connect/send/recv)
+//====================================================================================================
+bool RtmpPublisher::Connect()
+{
+	_socket = std::make_shared<ov::ClientSocket>();
+
+	if(_socket->Create(ov::SocketType::Tcp) == false)
+	{
+		logte("Could not create a socket for %s", _tc_url.CStr());
+		return false;
+	}
+
+	timeval timeout {};
+	timeout.tv_sec = RTMP_PUBLISHER_CONNECT_TIMEOUT / 1000;
+	timeout.tv_usec = (RTMP_PUBLISHER_CONNECT_TIMEOUT % 1000) * 1000;
+
+	_socket->SetSockOpt(SO_SNDTIMEO, timeout);
+	_socket->SetSockOpt(SO_RCVTIMEO, timeout);
+
+	ov::SocketAddress address(_host, _port);
+
+	auto error = _socket->Connect(address, RTMP_PUBLISHER_CONNECT_TIMEOUT);
+
+	if(error != nullptr)
+	{
+		logtw("Could not connect to %s: %s", address.ToString().CStr(), error->ToString().CStr());
+		return false;
+	}
+
+	_export_chunk = std::make_unique<RtmpExportChunk>(false, RTMP_PUBLISHER_CHUNK_SIZE);
+	_import_chunk = std::make_unique<RtmpImportChunk>(RTMP_DEFAULT_CHUNK_SIZE);
+
+	return true;
+}
+
+//====================================================================================================
+// Handshake
+// - c0 + c1 Send, s0 + s1 + s2 Receive, c2 Send (the simple handshake)
+//====================================================================================================
+bool RtmpPublisher::Handshake()
+{
+	uint8_t c0_c1[sizeof(uint8_t) + RTMP_HANDSHAKE_PACKET_SIZE] = { 0, };
+
+	c0_c1[0] = RTMP_HANDSHAKE_VERSION;
+	RtmpMuxUtil::WriteInt32(c0_c1 + 1, static_cast<int>(time(nullptr)));
+
+	for(int index = 9; index < static_cast<int>(sizeof(c0_c1)); index++)
+	{
+		c0_c1[index] = static_cast<uint8_t>(ov::Random::GenerateUInt32(0, 0xFF));
+	}
+
+	if(SendData(c0_c1, sizeof(c0_c1)) == false)
+	{
+		return false;
+	}
+
+	const size_t s0_s1_s2_size = sizeof(uint8_t) + RTMP_HANDSHAKE_PACKET_SIZE * 2;
+
+	while(_receive_buffer.GetLength() < s0_s1_s2_size)
+	{
+		if(ReceiveData(true) == false)
+		{
+			logtw("Could not receive the handshake from %s", _tc_url.CStr());
+			return false;
+		}
+	}
+
+	auto s0 = _receive_buffer.GetData();
+
+	if(s0[0] != RTMP_HANDSHAKE_VERSION)
+	{
+		logtw("Handshake Version Fail - Version(%d:%d)", s0[0], RTMP_HANDSHAKE_VERSION);
+		return false;
+	}
+
+	// c2 is the echo of s1
+	if(SendData(s0 + sizeof(uint8_t), RTMP_HANDSHAKE_PACKET_SIZE) == false)
+	{
+		return false;
+	}
+
+	_receive_buffer.Consume(s0_s1_s2_size);
+
+	return true;
+}
+
+//====================================================================================================
+// Publish
+// - SetChunkSize -> connect -> releaseStream/FCPublish/createStream -> publish
+//====================================================================================================
+bool RtmpPublisher::Publish()
+{
+	if(SendSetChunkSize() == false)
+	{
+		return false;
+	}
+
+	// connect
+	{
+		AmfDocument document;
+		auto object = new AmfObject;
+
+		document.AddProperty(RTMP_CMD_NAME_CONNECT);
+		document.AddProperty(RTMP_PUBLISHER_TRID_CONNECT);
+
+		object->AddProperty("app", _app.CStr());
+		object->AddProperty("type", "nonprivate");
+		object->AddProperty("flashVer", "FMLE/3.0 (compatible; FMSc/1.0)");
+		object->AddProperty("tcUrl", _tc_url.CStr());
+		document.AddProperty(object);
+
+		if((SendAmfCommand(0, document) == false) || (WaitForResult(RTMP_PUBLISHER_TRID_CONNECT) == false))
+		{
+			logtw("Could not connect to %s", _tc_url.CStr());
+			return false;
+		}
+	}
+
+	// releaseStream, FCPublish (the results are not needed)
+	for(auto command : { std::make_pair(RTMP_CMD_NAME_RELEASESTREAM, RTMP_PUBLISHER_TRID_RELEASESTREAM),
+	                     std::make_pair(RTMP_CMD_NAME_FCPUBLISH, RTMP_PUBLISHER_TRID_FCPUBLISH) })
+	{
+		AmfDocument document;
+
+		document.AddProperty(command.first);
+		document.AddProperty(command.second);
+		document.AddProperty(AmfDataType::Null);
+		document.AddProperty(_stream_key.CStr());
+
+		if(SendAmfCommand(0, document) == false)
+		{
+			return false;
+		}
+	}
+
+	// createStream
+	{
+		AmfDocument document;
+		double stream_id = 0.0;
+
+		document.AddProperty(RTMP_CMD_NAME_CREATESTREAM);
+		document.AddProperty(RTMP_PUBLISHER_TRID_CREATESTREAM);
+		document.AddProperty(AmfDataType::Null);
+
+		if((SendAmfCommand(0, document) == false) || (WaitForResult(RTMP_PUBLISHER_TRID_CREATESTREAM, &stream_id) == false))
+		{
+			logtw("Could not create a stream on %s", _tc_url.CStr());
+			return false;
+		}
+
+		_rtmp_stream_id = static_cast<uint32_t>(stream_id);
+	}
+
+	// publish
+	{
+		AmfDocument document;
+
+		document.AddProperty(RTMP_CMD_NAME_PUBLISH);
+		document.AddProperty(RTMP_PUBLISHER_TRID_PUBLISH);
+		document.AddProperty(AmfDataType::Null);
+		document.AddProperty(_stream_key.CStr());
+		document.AddProperty("live");
+
+		if((SendAmfCommand(_rtmp_stream_id, document) == false) || (WaitForPublishStatus() == false))
+		{
+			return false;
+		}
+	}
+
+	// The messages from the server are polled between the frames
+	return _socket->MakeNonBlocking();
+}
+
+void RtmpPublisher::Disconnect()
+{
+	if(_socket != nullptr)
+	{
+		_socket->Close();
+		_socket.reset();
+	}
+
+	_export_chunk.reset();
+	_import_chunk.reset();
+	_receive_buffer.Clear();
+	_commands.clear();
+	_rtmp_stream_id = 0;
+}
+
+//====================================================================================================
+// SendMetaData
+// - @setDataFrame(onMetaData)
+//====================================================================================================
+bool RtmpPublisher::SendMetaData()
+{
+	AmfDocument document;
+	auto array = new AmfArray;
+
+	document.AddProperty(RTMP_CMD_DATA_SETDATAFRAME);
+	document.AddProperty(RTMP_CMD_DATA_ONMETADATA);
+
+	array->AddProperty("width", static_cast<double>(_stream->GetWidth()));
+	array->AddProperty("height", static_cast<double>(_stream->GetHeight()));
+	array->AddProperty("framerate", _stream->GetFrameRate());
+	array->AddProperty("videocodecid", 7.0);
+	array->AddProperty("audiosamplerate", static_cast<double>(SYNTHETIC_AUDIO_SAMPLE_RATE));
+	array->AddProperty("audiochannels", static_cast<double>(SYNTHETIC_AUDIO_CHANNELS));
+	array->AddProperty("audiocodecid", 10.0);
+	array->AddProperty("encoder", "LoadBenchmark");
+	document.AddProperty(array);
+
+	auto body = std::make_shared<std::vector<uint8_t>>(2048);
+	auto body_size = document.Encode(body->data());
+
+	if(body_size <= 0)
+	{
+		return false;
+	}
+
+	body->resize(static_cast<size_t>(body_size));
+
+	return SendMessage(RTMP_PUBLISHER_CHUNK_STREAM_ID_META, RTMP_MSGID_AMF0_DATA_MESSAGE, 0, _rtmp_stream_id, body);
+}
+
+//====================================================================================================
+// SendSequenceHeaders
+// - The provider makes the stream after both sequence headers are received
+//====================================================================================================
+bool RtmpPublisher::SendSequenceHeaders(uint32_t timestamp)
+{
+	auto video_config = _stream->GetVideoSequenceHeader();
+	auto video_body = std::make_shared<std::vector<uint8_t>>(std::initializer_list<uint8_t> { 0x17, RTMP_SEQUENCE_INFO_TYPE, 0x00, 0x00, 0x00 });
+
+	video_body->insert(video_body->end(), video_config->GetDataAs<uint8_t>(), video_config->GetDataAs<uint8_t>() + video_config->GetLength());
+
+	auto audio_config = _stream->GetAudioSequenceHeader();
+	// AAC, 44kHz, 16 bits, stereo (always for AAC)
+	auto audio_body = std::make_shared<std::vector<uint8_t>>(std::initializer_list<uint8_t> { 0xAF, RTMP_SEQUENCE_INFO_TYPE });
+
+	audio_body->insert(audio_body->end(), audio_config->GetDataAs<uint8_t>(), audio_config->GetDataAs<uint8_t>() + audio_config->GetLength());
+
+	return SendMessage(RTMP_PUBLISHER_CHUNK_STREAM_ID_VIDEO, RTMP_MSGID_VIDEO_MESSAGE, timestamp, _rtmp_stream_id, video_body) &&
+	       SendMessage(RTMP_PUBLISHER_CHUNK_STREAM_ID_AUDIO, RTMP_MSGID_AUDIO_MESSAGE, timestamp, _rtmp_stream_id, audio_body);
+}
+
+//====================================================================================================
+// SendFrames
+// - Sends the video/audio frames of which the time is reached in the order of the timestamps,
+//   then sleeps until the next frame (at most 10 ms to poll the messages from the server)
+//====================================================================================================
+bool RtmpPublisher::SendFrames()
+{
+	while(_stop_thread_flag == false)
+	{
+		int64_t now = SyntheticStream::GetWallClockMicroseconds() / 1000;
+		int64_t video_timestamp = _stream->GetNextVideoTimestamp();
+		int64_t audio_timestamp = _stream->GetNextAudioTimestamp();
+		bool is_video = (video_timestamp <= audio_timestamp);
+		int64_t next_time = _start_time + (is_video ? video_timestamp : audio_timestamp);
+
+		if(next_time > now)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(std::min<int64_t>(next_time - now, 10)));
+			return true;
+		}
+
+		std::shared_ptr<std::vector<uint8_t>> body;
+		SyntheticFrame frame;
+
+		if(is_video)
+		{
+			frame = _stream->MakeVideoFrame();
+
+			// Frame type + codec id, AVC packet type, composition time (no B frames)
+			body = std::make_shared<std::vector<uint8_t>>(std::initializer_list<uint8_t> { static_cast<uint8_t>(frame.is_key_frame ? 0x17 : 0x27), RTMP_FRAME_DATA_TYPE, 0x00, 0x00, 0x00 });
+		}
+		else
+		{
+			frame = _stream->MakeAudioFrame();
+
+			body = std::make_shared<std::vector<uint8_t>>(std::initializer_list<uint8_t> { 0xAF, RTMP_FRAME_DATA_TYPE });
+		}
+
+		body->insert(body->end(), frame.data->GetDataAs<uint8_t>(), frame.data->GetDataAs<uint8_t>() + frame.data->GetLength());
+
+		if(SendMessage(is_video ? RTMP_PUBLISHER_CHUNK_STREAM_ID_VIDEO : RTMP_PUBLISHER_CHUNK_STREAM_ID_AUDIO,
+		               is_video ? RTMP_MSGID_VIDEO_MESSAGE : RTMP_MSGID_AUDIO_MESSAGE,
+		               static_cast<uint32_t>(frame.timestamp), _rtmp_stream_id, body) == false)
+		{
+			logtw("Could not send the frame to %s", _tc_url.CStr());
+			return false;
+		}
+
+		if(is_video)
+		{
+			_video_frame_count++;
+		}
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// SendData
+// - The non-blocking socket retries until all data is sent (or the socket is closed)
+//====================================================================================================
+bool RtmpPublisher::SendData(const uint8_t *data, size_t data_size)
+{
+	return (_socket->Send(data, data_size) == static_cast<ssize_t>(data_size));
+}
+
+bool RtmpPublisher::SendMessage(uint32_t chunk_stream_id, uint8_t type_id, uint32_t timestamp, uint32_t stream_id, std::shared_ptr<std::vector<uint8_t>> &body)
+{
+	auto message_header = std::make_shared<RtmpMuxMessageHeader>(chunk_stream_id, timestamp, type_id, stream_id, body->size());
+	auto export_data = _export_chunk->ExportStreamData(message_header, body);
+
+	if(export_data == nullptr)
+	{
+		return false;
+	}
+
+	return SendData(export_data->data(), export_data->size());
+}
+
+bool RtmpPublisher::SendAmfCommand(uint32_t stream_id, AmfDocument &document)
+{
+	auto body = std::make_shared<std::vector<uint8_t>>(2048);
+	auto body_size = document.Encode(body->data());
+
+	if(body_size <= 0)
+	{
+		return false;
+	}
+
+	body->resize(static_cast<size_t>(body_size));
+
+	return SendMessage(RTMP_CHUNK_STREAM_ID_CONTROL, RTMP_MSGID_AMF0_COMMAND_MESSAGE, 0, stream_id, body);
+}
+
+bool RtmpPublisher::SendSetChunkSize()
+{
+	auto body = std::make_shared<std::vector<uint8_t>>(sizeof(int));
+
+	RtmpMuxUtil::WriteInt32(body->data(), RTMP_PUBLISHER_CHUNK_SIZE);
+
+	return SendMessage(RTMP_CHUNK_STREAM_ID_URGENT, RTMP_MSGID_SET_CHUNK_SIZE, 0, 0, body);
+}
+
+//====================================================================================================
+// ReceiveData
+// - wait: false if the socket is non-blocking (nothing to read is not an error)
+//====================================================================================================
+bool RtmpPublisher::ReceiveData(bool wait)
+{
+	auto error = _socket->Recv(_recv_data);
+
+	if(error != nullptr)
+	{
+		logtw("%s is disconnected: %s", _tc_url.CStr(), error->ToString().CStr());
+		return false;
+	}
+
+	if(_recv_data->GetLength() == 0)
+	{
+		if(wait)
+		{
+			logtw("Timed out while waiting for the response of %s", _tc_url.CStr());
+			return false;
+		}
+
+		return true;
+	}
+
+	_receive_buffer.Append(_recv_data->GetDataAs<uint8_t>(), _recv_data->GetLength());
+
+	return true;
+}
+
+//====================================================================================================
+// ProcessMessages
+// - Handles the control messages, the command messages are kept until the publish is completed
+//====================================================================================================
+bool RtmpPublisher::ProcessMessages()
+{
+	while(_receive_buffer.IsEmpty() == false)
+	{
+		bool message_complete = false;
+		int import_size = _import_chunk->ImportStreamData(_receive_buffer.GetData(), static_cast<int>(_receive_buffer.GetLength()), message_complete);
+
+		if(import_size == 0)
+		{
+			break;
+		}
+		else if(import_size < 0)
+		{
+			logtw("Could not parse the chunks from %s", _tc_url.CStr());
+			return false;
+		}
+
+		_receive_buffer.Consume(static_cast<size_t>(import_size));
+
+		while(message_complete)
+		{
+			auto message = _import_chunk->GetMessage();
+
+			if((message == nullptr) || (message->body == nullptr))
+			{
+				break;
+			}
+
+			switch(message->message_header->type_id)
+			{
+				case RTMP_MSGID_SET_CHUNK_SIZE:
+				{
+					auto chunk_size = static_cast<int>(RtmpMuxUtil::ReadInt32(message->body->data()));
+
+					if(chunk_size <= 0)
+					{
+						logtw("ChunkSize Fail - Size(%d)", chunk_size);
+						return false;
+					}
+
+					_import_chunk->SetChunkSize(chunk_size);
+					break;
+				}
+
+				case RTMP_MSGID_USER_CONTROL_MESSAGE:
+					// Ping request: event type (2B) + timestamp (4B)
+					if((message->body->size() >= 6) && (RtmpMuxUtil::ReadInt16(message->body->data()) == RTMP_UCMID_PINGREQUEST))
+					{
+						auto body = std::make_shared<std::vector<uint8_t>>(message->body->begin(), message->body->begin() + 6);
+
+						RtmpMuxUtil::WriteInt16(body->data(), RTMP_UCMID_PINGRESPONSE);
+
+						if(SendMessage(RTMP_CHUNK_STREAM_ID_URGENT, RTMP_MSGID_USER_CONTROL_MESSAGE, 0, 0, body) == false)
+						{
+							return false;
+						}
+					}
+					break;
+
+				case RTMP_MSGID_AMF0_COMMAND_MESSAGE:
+					if(_publishing == false)
+					{
+						_commands.push_back(message);
+					}
+					break;
+
+				default:
+					// Acknowledgement, WindowAcknowledgementSize, SetPeerBandwidth, ...
+					break;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool RtmpPublisher::ReceiveCommand(std::shared_ptr<ImportMessage> &message)
+{
+	while(_commands.empty())
+	{
+		if((_stop_thread_flag) || (ReceiveData(true) == false) || (ProcessMessages() == false))
+		{
+			return false;
+		}
+	}
+
+	message = _commands.front();
+	_commands.pop_front();
+
+	return true;
+}
+
+//====================================================================================================
+// WaitForResult
+// - Waits for _result/_error of the transaction, the other commands (onBWDone, ...) are ignored
+//====================================================================================================
+bool RtmpPublisher::WaitForResult(double transaction_id, double *result_number)
+{
+	std::shared_ptr<ImportMessage> message;
+
+	while(ReceiveCommand(message))
+	{
+		AmfDocument document;
+
+		if((document.Decode(message->body->data(), message->message_header->body_size) == 0) ||
+		   (document.GetProperty(0) == nullptr) || (document.GetProperty(0)->GetType() != AmfDataType::String) ||
+		   (document.GetProperty(1) == nullptr) || (document.GetProperty(1)->GetType() != AmfDataType::Number))
+		{
+			continue;
+		}
+
+		ov::String message_name = document.GetProperty(0)->GetString();
+
+		if(document.GetProperty(1)->GetNumber() != transaction_id)
+		{
+			continue;
+		}
+
+		if(message_name == RTMP_ACK_NAME_ERROR)
+		{
+			logtw("%s returns an error (transaction: %.1f)", _tc_url.CStr(), transaction_id);
+			return false;
+		}
+
+		if(message_name != RTMP_ACK_NAME_RESULT)
+		{
+			continue;
+		}
+
+		if(result_number != nullptr)
+		{
+			auto property = document.GetProperty(3);
+
+			if((property == nullptr) || (property->GetType() != AmfDataType::Number))
+			{
+				return false;
+			}
+
+			*result_number = property->GetNumber();
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+//====================================================================================================
+// WaitForPublishStatus
+// - onStatus(NetStream.Publish.Start)
+//====================================================================================================
+bool RtmpPublisher::WaitForPublishStatus()
+{
+	std::shared_ptr<ImportMessage> message;
+
+	while(ReceiveCommand(message))
+	{
+		AmfDocument document;
+
+		if((document.Decode(message->body->data(), message->message_header->body_size) == 0) ||
+		   (document.GetProperty(0) == nullptr) || (document.GetProperty(0)->GetType() != AmfDataType::String))
+		{
+			continue;
+		}
+
+		if(ov::String(document.GetProperty(0)->GetString()) != RTMP_CMD_NAME_ONSTATUS)
+		{
+			continue;
+		}
+
+		// onStatus, transaction id, null, information
+		ov::String code;
+		auto property = document.GetProperty(3);
+
+		if((property != nullptr) && (property->GetType() == AmfDataType::Object))
+		{
+			auto object = property->GetObject();
+			auto index = object->FindName("code");
+
+			if((index >= 0) && (object->GetType(index) == AmfDataType::String))
+			{
+				code = object->GetString(index);
+			}
+		}
+
+		if(code != "NetStream.Publish.Start")
+		{
+			logtw("%s rejects the publish: %s", _tc_url.CStr(), code.CStr());
+			return false;
+		}
+
+		return true;
+	}
+
+	return false;
+}
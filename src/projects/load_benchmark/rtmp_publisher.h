@@ -0,0 +1,123 @@
+//==============================================================================
+//
+//  LoadBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovsocket/ovsocket.h>
+#include <rtmp/chunk/amf_document.h>
+#include <rtmp/chunk/rtmp_export_chunk.h>
+#include <rtmp/chunk/rtmp_import_chunk.h>
+#include <rtmp/chunk/rtmp_receive_buffer.h>
+
+#include <atomic>
+#include <deque>
+#include <thread>
+
+#include "synthetic_stream.h"
+
+// Timeout of the connection, handshake and the commands (ms)
+#define RTMP_PUBLISHER_CONNECT_TIMEOUT			(5000)
+// Interval of the reconnection after the server is disconnected (ms)
+#define RTMP_PUBLISHER_RECONNECT_INTERVAL		(3000)
+#define RTMP_PUBLISHER_RECV_BUFFER_SIZE			(64 * 1024)
+#define RTMP_PUBLISHER_CHUNK_SIZE				(4096)
+
+// Transaction ids of the commands
+#define RTMP_PUBLISHER_TRID_CONNECT				(1.0)
+#define RTMP_PUBLISHER_TRID_RELEASESTREAM		(2.0)
+#define RTMP_PUBLISHER_TRID_FCPUBLISH			(3.0)
+#define RTMP_PUBLISHER_TRID_CREATESTREAM		(4.0)
+#define RTMP_PUBLISHER_TRID_PUBLISH				(5.0)
+
+// Chunk stream ids of the media (same as OBS)
+#define RTMP_PUBLISHER_CHUNK_STREAM_ID_AUDIO	(4)
+#define RTMP_PUBLISHER_CHUNK_STREAM_ID_META		(5)
+#define RTMP_PUBLISHER_CHUNK_STREAM_ID_VIDEO	(6)
+
+// Publishes a SyntheticStream to the RTMP provider of the server in real time on its own thread
+//
+// - Reconnects and publishes again if the server is disconnected (the timestamps continue)
+// - The frames are sent when their wall clocks are reached, so the markers measure the latency of the server only
+class RtmpPublisher
+{
+public:
+	RtmpPublisher(const std::shared_ptr<SyntheticStream> &stream);
+	~RtmpPublisher();
+
+	// rtmp://<host>[:<port>]/<app>/<stream key>
+	bool Start(const ov::String &url);
+	void Stop();
+
+	bool IsPublishing() const
+	{
+		return _publishing;
+	}
+
+	uint64_t GetVideoFrameCount() const
+	{
+		return _video_frame_count;
+	}
+
+	uint64_t GetReconnectCount() const
+	{
+		return _reconnect_count;
+	}
+
+protected:
+	bool ParseUrl(const ov::String &url);
+
+	void WorkerThread();
+
+	bool Connect();
+	bool Handshake();
+	bool Publish();
+	void Disconnect();
+
+	// Sends the frames of which the time is reached, and waits for the next frame
+	bool SendFrames();
+	bool SendSequenceHeaders(uint32_t timestamp);
+	bool SendMetaData();
+
+	bool SendData(const uint8_t *data, size_t data_size);
+	bool SendMessage(uint32_t chunk_stream_id, uint8_t type_id, uint32_t timestamp, uint32_t stream_id, std::shared_ptr<std::vector<uint8_t>> &body);
+	bool SendAmfCommand(uint32_t stream_id, AmfDocument &document);
+	bool SendSetChunkSize();
+
+	bool ReceiveData(bool wait);
+	bool ProcessMessages();
+	bool ReceiveCommand(std::shared_ptr<ImportMessage> &message);
+	bool WaitForResult(double transaction_id, double *result_number = nullptr);
+	bool WaitForPublishStatus();
+
+	std::shared_ptr<SyntheticStream> _stream;
+
+	ov::String _host;
+	uint16_t _port = RTMP_DEFULT_PORT;
+	ov::String _app;
+	ov::String _stream_key;
+	ov::String _tc_url;
+
+	std::shared_ptr<ov::ClientSocket> _socket;
+	std::unique_ptr<RtmpExportChunk> _export_chunk;
+	std::unique_ptr<RtmpImportChunk> _import_chunk;
+	RtmpReceiveBuffer _receive_buffer;
+	std::shared_ptr<ov::Data> _recv_data;
+
+	// The command messages received while waiting for a response
+	std::deque<std::shared_ptr<ImportMessage>> _commands;
+
+	uint32_t _rtmp_stream_id = 0;
+	// Wall clock (ms) of the timestamp 0, aligned again after reconnected
+	int64_t _start_time = 0;
+
+	std::atomic<bool> _publishing { false };
+	std::atomic<uint64_t> _video_frame_count { 0 };
+	std::atomic<uint64_t> _reconnect_count { 0 };
+
+	std::atomic<bool> _stop_thread_flag { true };
+	std::thread _worker_thread;
+};
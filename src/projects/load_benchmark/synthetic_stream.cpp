@@ -0,0 +1,491 @@
+//==============================================================================
+//
+//  LoadBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "synthetic_stream.h"
+
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+
+#define OV_LOG_TAG "LoadBenchmark"
+
+#define H264_NAL_HEADER_SPS				0x67
+#define H264_NAL_HEADER_PPS				0x68
+#define H264_NAL_HEADER_SEI				0x06
+#define H264_NAL_HEADER_IDR				0x65
+#define H264_NAL_HEADER_NON_IDR			0x41
+#define H264_NAL_HEADER_FILLER			0x0C
+
+// user_data_unregistered
+#define H264_SEI_TYPE_USER_DATA			5
+// mb_type of I_PCM in an I slice
+#define H264_MB_TYPE_I_PCM				25
+// 256 luma + 128 chroma (4:2:0) samples
+#define H264_PCM_MACROBLOCK_SIZE		384
+// Gray
+#define H264_PCM_SAMPLE_VALUE			0x80
+
+namespace
+{
+	// No zero byte (see SYNTHETIC_MARKER_PAYLOAD_LENGTH)
+	const uint8_t marker_uuid[SYNTHETIC_MARKER_UUID_LENGTH] =
+	{
+		'O', 'v', 'e', 'n', 'L', 'o', 'a', 'd', 'B', 'e', 'n', 'c', 'h', 'M', 'r', 'k'
+	};
+
+	// A silent raw frame of AAC-LC (2ch)
+	const uint8_t silent_aac_frame[] =
+	{
+		0x21, 0x00, 0x49, 0x90, 0x02, 0x19, 0x00, 0x23, 0x80
+	};
+
+	// Writes the bits of a RBSP (MSB first)
+	class RbspWriter
+	{
+	public:
+		void WriteBit(uint32_t bit)
+		{
+			_current = static_cast<uint8_t>((_current << 1) | (bit & 0x01));
+			_bit_count++;
+
+			if(_bit_count == 8)
+			{
+				_bytes.push_back(_current);
+				_current = 0;
+				_bit_count = 0;
+			}
+		}
+
+		void WriteBits(uint32_t value, int count)
+		{
+			for(int index = count - 1; index >= 0; index--)
+			{
+				WriteBit(value >> index);
+			}
+		}
+
+		// ue(v)
+		void WriteUe(uint32_t value)
+		{
+			uint32_t code = value + 1;
+			int length = 0;
+
+			for(uint32_t temp = code; temp != 0; temp >>= 1)
+			{
+				length++;
+			}
+
+			WriteBits(0, length - 1);
+			WriteBits(code, length);
+		}
+
+		// se(v)
+		void WriteSe(int32_t value)
+		{
+			WriteUe((value <= 0) ? static_cast<uint32_t>(-2 * value) : static_cast<uint32_t>(2 * value - 1));
+		}
+
+		void AlignWithZeros()
+		{
+			while(_bit_count != 0)
+			{
+				WriteBit(0);
+			}
+		}
+
+		// Must be aligned
+		void WriteBytes(uint8_t value, size_t count)
+		{
+			_bytes.insert(_bytes.end(), count, value);
+		}
+
+		void WriteTrailingBits()
+		{
+			WriteBit(1);
+			AlignWithZeros();
+		}
+
+		// NAL header + RBSP with the emulation prevention bytes
+		std::shared_ptr<ov::Data> ToNalUnit(uint8_t nal_header) const
+		{
+			auto nal_unit = std::make_shared<ov::Data>(_bytes.size() + (_bytes.size() / 64) + 1);
+			std::vector<uint8_t> escaped;
+			int zero_count = 0;
+
+			escaped.reserve(nal_unit->GetCapacity());
+			escaped.push_back(nal_header);
+
+			for(auto byte : _bytes)
+			{
+				if((zero_count == 2) && (byte <= 0x03))
+				{
+					escaped.push_back(0x03);
+					zero_count = 0;
+				}
+
+				escaped.push_back(byte);
+				zero_count = (byte == 0x00) ? (zero_count + 1) : 0;
+			}
+
+			nal_unit->Append(escaped.data(), escaped.size());
+
+			return nal_unit;
+		}
+
+	protected:
+		std::vector<uint8_t> _bytes;
+		uint8_t _current = 0;
+		int _bit_count = 0;
+	};
+
+	void WriteMarkerValue(uint8_t *buffer, uint64_t value, int nibble_count)
+	{
+		for(int index = 0; index < nibble_count; index++)
+		{
+			buffer[index] = static_cast<uint8_t>(0x40 | ((value >> ((nibble_count - 1 - index) * 4)) & 0x0F));
+		}
+	}
+
+	bool ReadMarkerValue(const uint8_t *buffer, int nibble_count, uint64_t *value)
+	{
+		*value = 0;
+
+		for(int index = 0; index < nibble_count; index++)
+		{
+			if((buffer[index] & 0xF0) != 0x40)
+			{
+				return false;
+			}
+
+			*value = (*value << 4) | (buffer[index] & 0x0F);
+		}
+
+		return true;
+	}
+}
+
+SyntheticStream::SyntheticStream(int width, int height, double frame_rate, int gop, int64_t bitrate)
+	: _width(std::max(width / 16, 1) * 16),
+	  _height(std::max(height / 16, 1) * 16),
+	  _frame_rate((frame_rate > 0.0) ? frame_rate : 30.0),
+	  _gop(std::max(gop, 1)),
+	  _bitrate(std::max(bitrate, static_cast<int64_t>(0)))
+{
+	_sps = MakeSps();
+	_pps = MakePps();
+}
+
+std::shared_ptr<ov::Data> SyntheticStream::MakeSps() const
+{
+	RbspWriter writer;
+
+	// profile_idc: Baseline, constraint_set0/1_flag, level_idc: 4.0
+	writer.WriteBits(66, 8);
+	writer.WriteBits(0xC0, 8);
+	writer.WriteBits(40, 8);
+	// seq_parameter_set_id
+	writer.WriteUe(0);
+	// log2_max_frame_num_minus4 (frame_num: 4 bits)
+	writer.WriteUe(0);
+	// pic_order_cnt_type: 2 (POC is derived from frame_num, no B frames)
+	writer.WriteUe(2);
+	// max_num_ref_frames
+	writer.WriteUe(1);
+	// gaps_in_frame_num_value_allowed_flag
+	writer.WriteBit(0);
+	// pic_width_in_mbs_minus1, pic_height_in_map_units_minus1
+	writer.WriteUe(static_cast<uint32_t>(_width / 16 - 1));
+	writer.WriteUe(static_cast<uint32_t>(_height / 16 - 1));
+	// frame_mbs_only_flag, direct_8x8_inference_flag, frame_cropping_flag, vui_parameters_present_flag
+	writer.WriteBit(1);
+	writer.WriteBit(1);
+	writer.WriteBit(0);
+	writer.WriteBit(0);
+	writer.WriteTrailingBits();
+
+	return writer.ToNalUnit(H264_NAL_HEADER_SPS);
+}
+
+std::shared_ptr<ov::Data> SyntheticStream::MakePps() const
+{
+	RbspWriter writer;
+
+	// pic_parameter_set_id, seq_parameter_set_id
+	writer.WriteUe(0);
+	writer.WriteUe(0);
+	// entropy_coding_mode_flag (CAVLC), bottom_field_pic_order_in_frame_present_flag
+	writer.WriteBit(0);
+	writer.WriteBit(0);
+	// num_slice_groups_minus1
+	writer.WriteUe(0);
+	// num_ref_idx_l0/l1_default_active_minus1
+	writer.WriteUe(0);
+	writer.WriteUe(0);
+	// weighted_pred_flag, weighted_bipred_idc
+	writer.WriteBit(0);
+	writer.WriteBits(0, 2);
+	// pic_init_qp_minus26, pic_init_qs_minus26, chroma_qp_index_offset
+	writer.WriteSe(0);
+	writer.WriteSe(0);
+	writer.WriteSe(0);
+	// deblocking_filter_control_present_flag, constrained_intra_pred_flag, redundant_pic_cnt_present_flag
+	writer.WriteBit(0);
+	writer.WriteBit(0);
+	writer.WriteBit(0);
+	writer.WriteTrailingBits();
+
+	return writer.ToNalUnit(H264_NAL_HEADER_PPS);
+}
+
+std::shared_ptr<ov::Data> SyntheticStream::MakeSei(uint32_t frame_index) const
+{
+	uint8_t sei[3 + SYNTHETIC_MARKER_LENGTH + 1];
+
+	sei[0] = H264_NAL_HEADER_SEI;
+	sei[1] = H264_SEI_TYPE_USER_DATA;
+	sei[2] = SYNTHETIC_MARKER_LENGTH;
+
+	::memcpy(sei + 3, marker_uuid, sizeof(marker_uuid));
+	WriteMarkerValue(sei + 3 + SYNTHETIC_MARKER_UUID_LENGTH, frame_index, 8);
+	WriteMarkerValue(sei + 3 + SYNTHETIC_MARKER_UUID_LENGTH + 8, static_cast<uint64_t>(GetWallClockMicroseconds()), 16);
+
+	// rbsp_trailing_bits
+	sei[sizeof(sei) - 1] = 0x80;
+
+	return std::make_shared<ov::Data>(sei, sizeof(sei));
+}
+
+std::shared_ptr<ov::Data> SyntheticStream::MakeIdrSlice(uint32_t idr_id) const
+{
+	RbspWriter writer;
+
+	// first_mb_in_slice, slice_type: I (all slices), pic_parameter_set_id
+	writer.WriteUe(0);
+	writer.WriteUe(7);
+	writer.WriteUe(0);
+	// frame_num
+	writer.WriteBits(0, 4);
+	// idr_pic_id
+	writer.WriteUe(idr_id);
+	// dec_ref_pic_marking(): no_output_of_prior_pics_flag, long_term_reference_flag
+	writer.WriteBit(0);
+	writer.WriteBit(0);
+	// slice_qp_delta
+	writer.WriteSe(0);
+
+	int macroblock_count = (_width / 16) * (_height / 16);
+
+	for(int index = 0; index < macroblock_count; index++)
+	{
+		writer.WriteUe(H264_MB_TYPE_I_PCM);
+		// pcm_alignment_zero_bit
+		writer.AlignWithZeros();
+		writer.WriteBytes(H264_PCM_SAMPLE_VALUE, H264_PCM_MACROBLOCK_SIZE);
+	}
+
+	writer.WriteTrailingBits();
+
+	return writer.ToNalUnit(H264_NAL_HEADER_IDR);
+}
+
+std::shared_ptr<ov::Data> SyntheticStream::MakePSlice(uint32_t frame_num) const
+{
+	RbspWriter writer;
+
+	// first_mb_in_slice, slice_type: P (all slices), pic_parameter_set_id
+	writer.WriteUe(0);
+	writer.WriteUe(5);
+	writer.WriteUe(0);
+	// frame_num
+	writer.WriteBits(frame_num & 0x0F, 4);
+	// num_ref_idx_active_override_flag, ref_pic_list_modification_flag_l0
+	writer.WriteBit(0);
+	writer.WriteBit(0);
+	// dec_ref_pic_marking(): adaptive_ref_pic_marking_mode_flag
+	writer.WriteBit(0);
+	// slice_qp_delta
+	writer.WriteSe(0);
+	// mb_skip_run: all macroblocks are the same as the previous picture
+	writer.WriteUe(static_cast<uint32_t>((_width / 16) * (_height / 16)));
+	writer.WriteTrailingBits();
+
+	return writer.ToNalUnit(H264_NAL_HEADER_NON_IDR);
+}
+
+std::shared_ptr<ov::Data> SyntheticStream::MakeFiller(size_t length) const
+{
+	auto filler = std::make_shared<ov::Data>(length + 2);
+	std::vector<uint8_t> bytes(length + 2, 0xFF);
+
+	bytes.front() = H264_NAL_HEADER_FILLER;
+	bytes.back() = 0x80;
+
+	filler->Append(bytes.data(), bytes.size());
+
+	return filler;
+}
+
+void SyntheticStream::AppendNalUnit(const std::shared_ptr<ov::Data> &frame, const std::shared_ptr<ov::Data> &nal_unit)
+{
+	uint8_t length[4];
+	auto nal_length = static_cast<uint32_t>(nal_unit->GetLength());
+
+	length[0] = static_cast<uint8_t>(nal_length >> 24);
+	length[1] = static_cast<uint8_t>(nal_length >> 16);
+	length[2] = static_cast<uint8_t>(nal_length >> 8);
+	length[3] = static_cast<uint8_t>(nal_length);
+
+	frame->Append(length, sizeof(length));
+	frame->Append(nal_unit.get());
+}
+
+std::shared_ptr<ov::Data> SyntheticStream::GetVideoSequenceHeader() const
+{
+	auto record = std::make_shared<ov::Data>(11 + _sps->GetLength() + _pps->GetLength());
+	auto sps = _sps->GetDataAs<uint8_t>();
+
+	uint8_t header[] =
+	{
+		// configurationVersion, AVCProfileIndication, profile_compatibility, AVCLevelIndication
+		0x01, sps[1], sps[2], sps[3],
+		// lengthSizeMinusOne: 3, numOfSequenceParameterSets: 1
+		0xFF, 0xE1,
+		static_cast<uint8_t>(_sps->GetLength() >> 8), static_cast<uint8_t>(_sps->GetLength())
+	};
+
+	record->Append(header, sizeof(header));
+	record->Append(_sps.get());
+
+	uint8_t pps_header[] =
+	{
+		// numOfPictureParameterSets: 1
+		0x01,
+		static_cast<uint8_t>(_pps->GetLength() >> 8), static_cast<uint8_t>(_pps->GetLength())
+	};
+
+	record->Append(pps_header, sizeof(pps_header));
+	record->Append(_pps.get());
+
+	return record;
+}
+
+std::shared_ptr<ov::Data> SyntheticStream::GetAudioSequenceHeader() const
+{
+	// audioObjectType: 2 (LC), samplingFrequencyIndex: 3 (48000), channelConfiguration: 2
+	const uint8_t audio_specific_config[] = { 0x11, 0x90 };
+
+	return std::make_shared<ov::Data>(audio_specific_config, sizeof(audio_specific_config));
+}
+
+SyntheticFrame SyntheticStream::MakeVideoFrame()
+{
+	SyntheticFrame frame;
+	uint32_t gop_index = _video_frame_index % static_cast<uint32_t>(_gop);
+
+	frame.timestamp = GetNextVideoTimestamp();
+	frame.is_key_frame = (gop_index == 0);
+	frame.data = std::make_shared<ov::Data>(frame.is_key_frame ? ((_width / 16) * (_height / 16) * (H264_PCM_MACROBLOCK_SIZE + 2) + 1024) : 1024);
+
+	if(frame.is_key_frame)
+	{
+		// SPS/PPS in band too, so the subscriber doesn't depend on the sequence header
+		AppendNalUnit(frame.data, _sps);
+		AppendNalUnit(frame.data, _pps);
+		AppendNalUnit(frame.data, MakeSei(_video_frame_index));
+		// Consecutive IDR pictures must have different idr_pic_id
+		AppendNalUnit(frame.data, MakeIdrSlice(_idr_id++ & 0x01));
+	}
+	else
+	{
+		AppendNalUnit(frame.data, MakeSei(_video_frame_index));
+		AppendNalUnit(frame.data, MakePSlice(gop_index));
+	}
+
+	if(_bitrate > 0)
+	{
+		_byte_budget += static_cast<int64_t>(_bitrate / 8 / _frame_rate);
+		_byte_budget -= static_cast<int64_t>(frame.data->GetLength());
+
+		// Length prefix (4B) + NAL header (1B) + trailing bits (1B)
+		if(_byte_budget > 64)
+		{
+			auto filler = MakeFiller(static_cast<size_t>(_byte_budget - 6));
+
+			AppendNalUnit(frame.data, filler);
+			_byte_budget -= static_cast<int64_t>(filler->GetLength() + 4);
+		}
+	}
+
+	_video_frame_index++;
+
+	return frame;
+}
+
+SyntheticFrame SyntheticStream::MakeAudioFrame()
+{
+	SyntheticFrame frame;
+
+	frame.timestamp = GetNextAudioTimestamp();
+	frame.is_key_frame = true;
+	frame.data = std::make_shared<ov::Data>(silent_aac_frame, sizeof(silent_aac_frame));
+
+	_audio_frame_index++;
+
+	return frame;
+}
+
+int64_t SyntheticStream::GetNextVideoTimestamp() const
+{
+	return static_cast<int64_t>(_video_frame_index * 1000.0 / _frame_rate);
+}
+
+int64_t SyntheticStream::GetNextAudioTimestamp() const
+{
+	return static_cast<int64_t>(_audio_frame_index * SYNTHETIC_AUDIO_SAMPLES_PER_FRAME * 1000 / SYNTHETIC_AUDIO_SAMPLE_RATE);
+}
+
+int64_t SyntheticStream::GetWallClockMicroseconds()
+{
+	timespec now {};
+
+	::clock_gettime(CLOCK_REALTIME, &now);
+
+	return static_cast<int64_t>(now.tv_sec) * 1000000LL + (now.tv_nsec / 1000);
+}
+
+void SyntheticStream::FindMarkers(const uint8_t *data, size_t length, std::vector<SyntheticMarker> *markers)
+{
+	const uint8_t *current = data;
+	const uint8_t *end = data + length;
+
+	while(static_cast<size_t>(end - current) >= SYNTHETIC_MARKER_LENGTH)
+	{
+		auto found = static_cast<const uint8_t *>(::memmem(current, end - current, marker_uuid, sizeof(marker_uuid)));
+
+		if((found == nullptr) || (static_cast<size_t>(end - found) < SYNTHETIC_MARKER_LENGTH))
+		{
+			break;
+		}
+
+		uint64_t frame_index = 0;
+		uint64_t wall_clock = 0;
+		const uint8_t *payload = found + SYNTHETIC_MARKER_UUID_LENGTH;
+
+		if(ReadMarkerValue(payload, 8, &frame_index) && ReadMarkerValue(payload + 8, 16, &wall_clock))
+		{
+			SyntheticMarker marker;
+
+			marker.frame_index = static_cast<uint32_t>(frame_index);
+			marker.wall_clock = static_cast<int64_t>(wall_clock);
+
+			markers->push_back(marker);
+		}
+
+		current = found + SYNTHETIC_MARKER_UUID_LENGTH;
+	}
+}
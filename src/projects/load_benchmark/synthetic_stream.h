@@ -0,0 +1,115 @@
+//==============================================================================
+//
+//  LoadBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <memory>
+#include <vector>
+
+// Length of the UUID of the SEI (user_data_unregistered) which carries the marker of a frame
+#define SYNTHETIC_MARKER_UUID_LENGTH			16
+// Frame index (32 bits) + wall clock (64 bits), a nibble per byte (0x40 | nibble) so the payload has no zero byte
+// (no emulation prevention byte is inserted, and the marker can be found in any container without unescaping)
+#define SYNTHETIC_MARKER_PAYLOAD_LENGTH			(8 + 16)
+#define SYNTHETIC_MARKER_LENGTH					(SYNTHETIC_MARKER_UUID_LENGTH + SYNTHETIC_MARKER_PAYLOAD_LENGTH)
+
+// AAC-LC, 48kHz, 2ch (1024 samples per frame)
+#define SYNTHETIC_AUDIO_SAMPLE_RATE				48000
+#define SYNTHETIC_AUDIO_CHANNELS				2
+#define SYNTHETIC_AUDIO_SAMPLES_PER_FRAME		1024
+
+// The marker of a frame which is found in the media received by a subscriber
+struct SyntheticMarker
+{
+	uint32_t frame_index = 0;
+	// When the frame was made by the publisher (see SyntheticStream::GetWallClockMicroseconds())
+	int64_t wall_clock = 0;
+};
+
+// A frame of the synthetic stream (timestamp in milliseconds, same as RTMP)
+struct SyntheticFrame
+{
+	int64_t timestamp = 0;
+	bool is_key_frame = false;
+
+	// H.264: NAL units with 4 bytes length prefixes (AVCC), AAC: a raw frame
+	std::shared_ptr<ov::Data> data;
+};
+
+// Makes an H.264 stream which doesn't need an encoder, and silent AAC frames
+//
+// - The key frames are IDR pictures of I_PCM macroblocks (gray), the other frames are P pictures which skip all
+//   macroblocks, so the bitrate depends on the resolution and the GOP (filler data is added to reach the bitrate)
+// - Each video frame has an SEI with its index and the wall clock, so the subscribers can measure the latency
+//   and the lost frames from any protocol (RTP payloads, MPEG-TS and fMP4 segments)
+class SyntheticStream
+{
+public:
+	// width/height: multiples of 16, gop: key frame interval (in frames), bitrate: 0 to not add the filler data (bps)
+	SyntheticStream(int width, int height, double frame_rate, int gop, int64_t bitrate);
+
+	int GetWidth() const
+	{
+		return _width;
+	}
+
+	int GetHeight() const
+	{
+		return _height;
+	}
+
+	double GetFrameRate() const
+	{
+		return _frame_rate;
+	}
+
+	// AVCDecoderConfigurationRecord (RTMP/FLV sequence header)
+	std::shared_ptr<ov::Data> GetVideoSequenceHeader() const;
+	// AudioSpecificConfig
+	std::shared_ptr<ov::Data> GetAudioSequenceHeader() const;
+
+	// The frames are made in order, the timestamps are calculated from the frame rate/sample rate
+	SyntheticFrame MakeVideoFrame();
+	SyntheticFrame MakeAudioFrame();
+
+	// Timestamps of the frames which will be made next (the marker has the wall clock of when the frame is made)
+	int64_t GetNextVideoTimestamp() const;
+	int64_t GetNextAudioTimestamp() const;
+
+	// CLOCK_REALTIME in microseconds (the subscribers may run on another host which is synchronized by NTP)
+	static int64_t GetWallClockMicroseconds();
+
+	// Finds the markers in the data (the payloads of MPEG-TS packets must be concatenated before)
+	static void FindMarkers(const uint8_t *data, size_t length, std::vector<SyntheticMarker> *markers);
+
+protected:
+	std::shared_ptr<ov::Data> MakeSps() const;
+	std::shared_ptr<ov::Data> MakePps() const;
+	std::shared_ptr<ov::Data> MakeSei(uint32_t frame_index) const;
+	std::shared_ptr<ov::Data> MakeIdrSlice(uint32_t idr_id) const;
+	std::shared_ptr<ov::Data> MakePSlice(uint32_t frame_num) const;
+	std::shared_ptr<ov::Data> MakeFiller(size_t length) const;
+
+	static void AppendNalUnit(const std::shared_ptr<ov::Data> &frame, const std::shared_ptr<ov::Data> &nal_unit);
+
+	int _width;
+	int _height;
+	double _frame_rate;
+	int _gop;
+	int64_t _bitrate;
+
+	std::shared_ptr<ov::Data> _sps;
+	std::shared_ptr<ov::Data> _pps;
+
+	uint32_t _video_frame_index = 0;
+	uint32_t _idr_id = 0;
+	uint64_t _audio_frame_index = 0;
+	// Bytes which are not sent by the budget of the bitrate (the key frames exceed it)
+	int64_t _byte_budget = 0;
+};
@@ -0,0 +1,1046 @@
+//==============================================================================
+//
+//  LoadBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "webrtc_subscriber.h"
+#include "load_worker.h"
+
+#include <base/ovlibrary/byte_io.h>
+#include <ice/stun/stun_message.h>
+#include <ice/stun/attributes/stun_attributes.h>
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <openssl/srtp.h>
+
+#define OV_LOG_TAG "LoadBenchmark.WebRtc"
+
+#define WEBSOCKET_OPCODE_CONTINUATION			0x00
+#define WEBSOCKET_OPCODE_TEXT					0x01
+#define WEBSOCKET_OPCODE_CLOSE					0x08
+#define WEBSOCKET_OPCODE_PING					0x09
+#define WEBSOCKET_OPCODE_PONG					0x0A
+
+#define RTCP_PAYLOAD_TYPE_RR					201
+// The report blocks of a receiver report (RC: 5 bits)
+#define RTCP_MAX_REPORT_BLOCKS					31
+
+bool WebRtcSubscriberContext::Prepare()
+{
+	certificate = std::make_shared<Certificate>();
+
+	auto error = certificate->Generate();
+
+	if(error != nullptr)
+	{
+		logte("Could not generate a certificate: %s", error->ToString().CStr());
+		return false;
+	}
+
+	fingerprint = certificate->GetFingerprint("sha-256");
+	tls_context = std::make_shared<ov::TlsContext>();
+
+	if(tls_context->Prepare(DTLS_client_method(), certificate, nullptr, "DEFAULT:!NULL:!aNULL:!SHA256:!SHA384:!aECDH:!AESGCM+AES256:!aPSK") == false)
+	{
+		return false;
+	}
+
+	// SSL_CTX_set_tlsext_use_srtp() returns 1 on error, 0 on success
+	if(SSL_CTX_set_tlsext_use_srtp(tls_context->GetSslContext(), SrtpAdapter::GetSrtpProfiles()))
+	{
+		logte("SSL_CTX_set_tlsext_use_srtp failed");
+		return false;
+	}
+
+	return true;
+}
+
+WebRtcSubscriber::WebRtcSubscriber(const std::shared_ptr<WebRtcSubscriberContext> &context, const std::shared_ptr<LoadStatistics> &statistics)
+	: LoadSession(statistics),
+	  _context(context)
+{
+}
+
+bool WebRtcSubscriber::OnStart(int64_t now)
+{
+	_state = State::Connecting;
+	_start_time = now;
+	_message.Clear();
+
+	_local_ufrag = ov::Random::GenerateString(8);
+	_local_pwd = ov::Random::GenerateString(32);
+	_is_ice_connected = false;
+	_local_ssrc = ov::Random::GenerateUInt32();
+	_rtp_sources.clear();
+
+	return ConnectTcp(_context->signalling_url.address) && SendUpgradeRequest();
+}
+
+void WebRtcSubscriber::OnClose()
+{
+	if((_state != State::Connecting) && (_state != State::Upgrading) && (_session_id != 0))
+	{
+		// Best effort (the ICE session of the server is expired otherwise)
+		::Json::Value value;
+
+		value["command"] = "stop";
+		value["id"] = static_cast<::Json::Int64>(_session_id);
+		value["peer_id"] = static_cast<::Json::Int64>(_peer_id);
+
+		SendCommand(value);
+	}
+
+	if(_udp_socket >= 0)
+	{
+		_worker->RemoveSocket(_udp_socket);
+		::close(_udp_socket);
+		_udp_socket = -1;
+	}
+
+	_tls.reset();
+	_dtls_packets.clear();
+	_srtp_inbound.reset();
+	_srtp_outbound.reset();
+	_session_id = 0;
+	_peer_id = 0;
+}
+
+bool WebRtcSubscriber::OnEvent(int fd, uint32_t events, int64_t now)
+{
+	if(fd == _tcp_socket)
+	{
+		return OnTcpEvent(events, now);
+	}
+
+	if(fd == _udp_socket)
+	{
+		return OnUdpEvent(events, now);
+	}
+
+	// The socket is already closed
+	return true;
+}
+
+bool WebRtcSubscriber::OnTimer(int64_t now)
+{
+	if(_state != State::Playing)
+	{
+		if((now - _start_time) > WEBRTC_SUBSCRIBER_CONNECT_TIMEOUT)
+		{
+			logtd("Timed out while connecting (state: %d)", static_cast<int>(_state));
+			return false;
+		}
+	}
+	else if((now - _last_rtp_time) > WEBRTC_SUBSCRIBER_PLAY_TIMEOUT)
+	{
+		logtd("No RTP packet is received for %d ms", WEBRTC_SUBSCRIBER_PLAY_TIMEOUT);
+		return false;
+	}
+
+	if((_udp_socket >= 0) && (now >= _next_binding_time))
+	{
+		_next_binding_time = now + (_is_ice_connected ? WEBRTC_SUBSCRIBER_CONSENT_INTERVAL : WEBRTC_SUBSCRIBER_CHECK_INTERVAL);
+
+		if(SendBindingRequest() == false)
+		{
+			return false;
+		}
+	}
+
+	if((_state == State::DtlsConnecting) && (now >= _next_dtls_time))
+	{
+		if(ContinueDtls(now) == false)
+		{
+			return false;
+		}
+	}
+
+	if((_state == State::Playing) && (now >= _next_rtcp_time))
+	{
+		_next_rtcp_time = now + WEBRTC_SUBSCRIBER_RTCP_INTERVAL;
+
+		return SendReceiverReport();
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// Signalling
+//====================================================================================================
+bool WebRtcSubscriber::OnTcpEvent(uint32_t events, int64_t now)
+{
+	if(events & EPOLLERR)
+	{
+		return false;
+	}
+
+	if(events & EPOLLOUT)
+	{
+		if(_is_tcp_connected == false)
+		{
+			int error = 0;
+			socklen_t length = sizeof(error);
+
+			if((::getsockopt(_tcp_socket, SOL_SOCKET, SO_ERROR, &error, &length) != 0) || (error != 0))
+			{
+				logtd("Could not connect to %s: %s", _context->signalling_url.address.ToString().CStr(), ::strerror(error));
+				return false;
+			}
+
+			_is_tcp_connected = true;
+			_state = State::Upgrading;
+		}
+
+		if(FlushTcp() == false)
+		{
+			return false;
+		}
+	}
+
+	if(events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))
+	{
+		bool is_connected = ReceiveTcp();
+
+		if(_state == State::Upgrading)
+		{
+			size_t header_length = 0;
+			int status_code = 0;
+			std::map<ov::String, ov::String> headers;
+
+			if(ParseHttpResponseHeader(_tcp_buffer, &header_length, &status_code, &headers))
+			{
+				if(status_code != 101)
+				{
+					logtd("Could not upgrade the connection: %d", status_code);
+					return false;
+				}
+
+				_tcp_buffer.Erase(0, header_length);
+				_state = State::WaitingForOffer;
+
+				::Json::Value value;
+				value["command"] = "request_offer";
+
+				if(SendCommand(value) == false)
+				{
+					return false;
+				}
+			}
+		}
+
+		if((_state != State::Upgrading) && (ProcessWebSocketFrames(now) == false))
+		{
+			return false;
+		}
+
+		if(is_connected == false)
+		{
+			logtd("The signalling connection is closed by the server");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool WebRtcSubscriber::SendUpgradeRequest()
+{
+	uint8_t key[16];
+
+	for(auto &byte : key)
+	{
+		byte = static_cast<uint8_t>(ov::Random::GenerateUInt32(0, 0xFF));
+	}
+
+	_websocket_key = ov::Base64::Encode(std::make_shared<ov::Data>(key, sizeof(key)));
+
+	auto &url = _context->signalling_url;
+	auto request = ov::String::FormatString(
+		"GET %s HTTP/1.1\r\n"
+		"Host: %s:%d\r\n"
+		"Upgrade: websocket\r\n"
+		"Connection: Upgrade\r\n"
+		"Sec-WebSocket-Key: %s\r\n"
+		"Sec-WebSocket-Version: 13\r\n"
+		"\r\n",
+		url.path.CStr(), url.host.CStr(), url.port, _websocket_key.CStr());
+
+	// Sent after the connection is completed
+	return SendTcp(request.CStr(), request.GetLength());
+}
+
+bool WebRtcSubscriber::ProcessWebSocketFrames(int64_t now)
+{
+	while(_tcp_buffer.GetLength() >= 2)
+	{
+		auto data = _tcp_buffer.GetWritableDataAs<uint8_t>();
+		bool is_final = (data[0] & 0x80) != 0;
+		uint8_t opcode = data[0] & 0x0F;
+		bool is_masked = (data[1] & 0x80) != 0;
+		uint64_t payload_length = data[1] & 0x7F;
+		size_t header_length = 2;
+
+		if(payload_length == 126)
+		{
+			if(_tcp_buffer.GetLength() < 4)
+			{
+				return true;
+			}
+
+			payload_length = ByteReader<uint16_t>::ReadBigEndian(data + 2);
+			header_length += 2;
+		}
+		else if(payload_length == 127)
+		{
+			if(_tcp_buffer.GetLength() < 10)
+			{
+				return true;
+			}
+
+			payload_length = ByteReader<uint64_t>::ReadBigEndian(data + 2);
+			header_length += 8;
+		}
+
+		size_t mask_offset = header_length;
+
+		if(is_masked)
+		{
+			header_length += 4;
+		}
+
+		if(_tcp_buffer.GetLength() < (header_length + payload_length))
+		{
+			// Waits for the rest of the frame
+			return true;
+		}
+
+		auto payload = data + header_length;
+
+		if(is_masked)
+		{
+			// The frames from the server are not masked, but it is allowed
+			for(uint64_t index = 0; index < payload_length; index++)
+			{
+				payload[index] ^= data[mask_offset + (index % 4)];
+			}
+		}
+
+		bool result = true;
+
+		switch(opcode)
+		{
+			case WEBSOCKET_OPCODE_CONTINUATION:
+			case WEBSOCKET_OPCODE_TEXT:
+				_message.Append(payload, static_cast<size_t>(payload_length));
+
+				if(is_final)
+				{
+					result = OnCommand(ov::String(_message.GetDataAs<char>(), _message.GetLength()), now);
+					_message.Clear();
+				}
+				break;
+
+			case WEBSOCKET_OPCODE_PING:
+				result = SendWebSocketFrame(WEBSOCKET_OPCODE_PONG, payload, static_cast<size_t>(payload_length));
+				break;
+
+			case WEBSOCKET_OPCODE_CLOSE:
+				logtd("The signalling is closed by the server");
+				result = false;
+				break;
+
+			default:
+				break;
+		}
+
+		_tcp_buffer.Erase(0, static_cast<size_t>(header_length + payload_length));
+
+		if(result == false)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool WebRtcSubscriber::SendWebSocketFrame(uint8_t opcode, const void *data, size_t length)
+{
+	// FIN + opcode, MASK + payload length (the frames of the client must be masked)
+	ov::Data frame(length + 14);
+	uint8_t header[14];
+	size_t header_length = 2;
+
+	header[0] = static_cast<uint8_t>(0x80 | opcode);
+
+	if(length < 126)
+	{
+		header[1] = static_cast<uint8_t>(0x80 | length);
+	}
+	else if(length <= 0xFFFF)
+	{
+		header[1] = 0x80 | 126;
+		ByteWriter<uint16_t>::WriteBigEndian(header + 2, static_cast<uint16_t>(length));
+		header_length += 2;
+	}
+	else
+	{
+		header[1] = 0x80 | 127;
+		ByteWriter<uint64_t>::WriteBigEndian(header + 2, static_cast<uint64_t>(length));
+		header_length += 8;
+	}
+
+	auto mask = ov::Random::GenerateUInt32();
+	uint8_t *mask_bytes = header + header_length;
+
+	::memcpy(mask_bytes, &mask, sizeof(mask));
+	header_length += 4;
+
+	frame.Append(header, header_length);
+	frame.Append(data, length);
+
+	auto payload = frame.GetWritableDataAs<uint8_t>() + header_length;
+
+	for(size_t index = 0; index < length; index++)
+	{
+		payload[index] ^= mask_bytes[index % 4];
+	}
+
+	return SendTcp(frame.GetData(), frame.GetLength());
+}
+
+bool WebRtcSubscriber::SendCommand(const ::Json::Value &value)
+{
+	auto message = ov::Json::Stringify(value);
+
+	return SendWebSocketFrame(WEBSOCKET_OPCODE_TEXT, message.CStr(), message.GetLength());
+}
+
+bool WebRtcSubscriber::OnCommand(const ov::String &message, int64_t now)
+{
+	ov::JsonObject object;
+
+	if(object.Parse(message) != nullptr)
+	{
+		logtd("Invalid message: %s", message.CStr());
+		return false;
+	}
+
+	auto &command = object.GetJsonValue("command");
+
+	if(command.isString() == false)
+	{
+		return true;
+	}
+
+	if(command.asString() == "offer")
+	{
+		return OnOffer(object, now);
+	}
+
+	// The other commands are not used (e.g. the candidates are in the offer)
+	return true;
+}
+
+bool WebRtcSubscriber::OnOffer(const ov::JsonObject &object, int64_t now)
+{
+	if(_state != State::WaitingForOffer)
+	{
+		return true;
+	}
+
+	_session_id = object.GetInt64Value("id");
+	_peer_id = object.GetInt64Value("peer_id");
+
+	auto &sdp_value = object.GetJsonValue("sdp");
+
+	if((sdp_value.isObject() == false) || (sdp_value["sdp"].isString() == false))
+	{
+		logtd("There is no SDP in the offer");
+		return false;
+	}
+
+	ov::String offer = sdp_value["sdp"].asCString();
+	auto answer = MakeAnswer(offer);
+
+	if(_remote_ufrag.IsEmpty() || _remote_pwd.IsEmpty())
+	{
+		logtd("There is no ICE credential in the offer");
+		return false;
+	}
+
+	// The first UDP candidate (in the command, or in the SDP)
+	std::vector<ov::String> candidates;
+	auto &candidates_value = object.GetJsonValue("candidates");
+
+	if(candidates_value.isArray())
+	{
+		for(auto &item : candidates_value)
+		{
+			if(item["candidate"].isString())
+			{
+				candidates.emplace_back(item["candidate"].asCString());
+			}
+		}
+	}
+
+	for(auto &line : offer.Replace("\r", "").Split("\n"))
+	{
+		if(line.HasPrefix("a=candidate:"))
+		{
+			candidates.push_back(line.Substring(2));
+		}
+	}
+
+	bool is_found = false;
+
+	for(auto &candidate : candidates)
+	{
+		// candidate:<foundation> <component> <transport> <priority> <address> <port> typ <type> ...
+		auto tokens = candidate.Split(" ");
+
+		if((tokens.size() < 6) || (tokens[2].UpperCaseString() != "UDP"))
+		{
+			continue;
+		}
+
+		auto port = ov::Converter::ToUInt16(tokens[5]);
+		_remote_address = ov::SocketAddress(_context->ice_host.IsEmpty() ? tokens[4] : _context->ice_host, port);
+
+		if(_remote_address.AddressLength() > 0)
+		{
+			is_found = true;
+			break;
+		}
+	}
+
+	if(is_found == false)
+	{
+		logtd("There is no UDP candidate in the offer");
+		return false;
+	}
+
+	::Json::Value value;
+
+	value["command"] = "answer";
+	value["id"] = static_cast<::Json::Int64>(_session_id);
+	value["peer_id"] = static_cast<::Json::Int64>(_peer_id);
+	value["sdp"]["type"] = "answer";
+	value["sdp"]["sdp"] = answer.CStr();
+
+	if((SendCommand(value) == false) || (ConnectUdp(_remote_address) == false))
+	{
+		return false;
+	}
+
+	_state = State::IceChecking;
+	_next_binding_time = now;
+
+	return true;
+}
+
+//====================================================================================================
+// MakeAnswer
+// - The offer with the credentials/fingerprint of the subscriber, recvonly and DTLS client
+// - The codecs of the offer are accepted as they are
+//====================================================================================================
+ov::String WebRtcSubscriber::MakeAnswer(const ov::String &offer)
+{
+	ov::String answer;
+
+	_remote_ufrag = "";
+	_remote_pwd = "";
+
+	for(auto &item : offer.Replace("\r", "").Split("\n"))
+	{
+		auto line = item.Trim();
+
+		if(line.IsEmpty())
+		{
+			continue;
+		}
+
+		if(line.HasPrefix("a=ice-ufrag:"))
+		{
+			_remote_ufrag = line.Substring(12);
+			line = ov::String::FormatString("a=ice-ufrag:%s", _local_ufrag.CStr());
+		}
+		else if(line.HasPrefix("a=ice-pwd:"))
+		{
+			_remote_pwd = line.Substring(10);
+			line = ov::String::FormatString("a=ice-pwd:%s", _local_pwd.CStr());
+		}
+		else if(line.HasPrefix("a=fingerprint:"))
+		{
+			line = ov::String::FormatString("a=fingerprint:sha-256 %s", _context->fingerprint.CStr());
+		}
+		else if(line.HasPrefix("a=setup:"))
+		{
+			line = "a=setup:active";
+		}
+		else if((line == "a=sendonly") || (line == "a=sendrecv"))
+		{
+			line = "a=recvonly";
+		}
+		else if(line.HasPrefix("a=ssrc") || line.HasPrefix("a=msid") || line.HasPrefix("a=candidate:") ||
+		        (line == "a=end-of-candidates") || (line == "a=ice-lite"))
+		{
+			// The subscriber doesn't send any media
+			continue;
+		}
+
+		answer.Append(line);
+		answer.Append("\r\n");
+	}
+
+	return answer;
+}
+
+//====================================================================================================
+// ICE
+//====================================================================================================
+bool WebRtcSubscriber::ConnectUdp(const ov::SocketAddress &address)
+{
+	_udp_socket = ::socket(address.Address()->sa_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	if(_udp_socket < 0)
+	{
+		logtw("Could not create a socket: %s", ::strerror(errno));
+		return false;
+	}
+
+	// Only the packets from the candidate are received
+	if(::connect(_udp_socket, address.Address(), address.AddressLength()) != 0)
+	{
+		logtw("Could not connect to %s: %s", address.ToString().CStr(), ::strerror(errno));
+		return false;
+	}
+
+	return _worker->AddSocket(_udp_socket, EPOLLIN, _slot);
+}
+
+bool WebRtcSubscriber::OnUdpEvent(uint32_t events, int64_t now)
+{
+	if(events & EPOLLERR)
+	{
+		// ICMP port unreachable, etc.
+		int error = 0;
+		socklen_t length = sizeof(error);
+
+		::getsockopt(_udp_socket, SOL_SOCKET, SO_ERROR, &error, &length);
+		logtd("An error occurred on the UDP socket: %s", ::strerror(error));
+
+		return _state != State::Playing;
+	}
+
+	auto buffer = _worker->GetReceiveBuffer();
+
+	while(true)
+	{
+		auto received = ::recv(_udp_socket, buffer, LOAD_SESSION_RECV_CHUNK_SIZE, MSG_DONTWAIT);
+
+		if(received < 0)
+		{
+			return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR) || (errno == ECONNREFUSED);
+		}
+
+		if(received == 0)
+		{
+			continue;
+		}
+
+		_statistics->bytes += static_cast<uint64_t>(received);
+
+		// RFC 7983 - STUN: 0~3, DTLS: 20~63, RTP/RTCP: 128~191
+		uint8_t first_byte = buffer[0];
+
+		if(first_byte <= 3)
+		{
+			auto data = std::make_shared<ov::Data>(buffer, static_cast<size_t>(received));
+			ov::ByteStream stream(data.get());
+			StunMessage message;
+
+			if((message.Parse(stream) == false) || (message.GetMethod() != StunMethod::Binding))
+			{
+				continue;
+			}
+
+			if(message.GetClass() == StunClass::SuccessResponse)
+			{
+				if(_is_ice_connected == false)
+				{
+					_is_ice_connected = true;
+
+					if((_state == State::IceChecking) && (StartDtls() == false))
+					{
+						return false;
+					}
+				}
+			}
+			else if(message.GetClass() == StunClass::Request)
+			{
+				if(SendBindingResponse(message.GetTransactionId()) == false)
+				{
+					return false;
+				}
+			}
+		}
+		else if((first_byte >= 20) && (first_byte <= 63))
+		{
+			if(_state == State::DtlsConnecting)
+			{
+				_dtls_packets.push_back(std::make_shared<ov::Data>(buffer, static_cast<size_t>(received)));
+
+				if(ContinueDtls(now) == false)
+				{
+					return false;
+				}
+			}
+		}
+		else if((first_byte >= 128) && (first_byte <= 191) && (_state == State::Playing) && (received >= 12))
+		{
+			// RTCP: PT 192~223 (with the marker bit of RTP)
+			if((buffer[1] >= 192) && (buffer[1] <= 223))
+			{
+				// Sender reports are not used
+				continue;
+			}
+
+			auto packet = std::make_shared<ov::Data>(buffer, static_cast<size_t>(received));
+
+			if(_srtp_inbound->UnprotectRtp(packet))
+			{
+				OnRtp(packet, now);
+			}
+		}
+	}
+}
+
+bool WebRtcSubscriber::SendBindingRequest()
+{
+	uint8_t transaction_id[OV_STUN_TRANSACTION_ID_LENGTH];
+
+	for(auto &byte : transaction_id)
+	{
+		byte = static_cast<uint8_t>(ov::Random::GenerateUInt32(0, 0xFF));
+	}
+
+	StunMessage request_message;
+
+	request_message.SetClass(StunClass::Request);
+	request_message.SetMethod(StunMethod::Binding);
+	request_message.SetTransactionId(transaction_id);
+
+	// USERNAME: <ufrag of the server>:<ufrag of the subscriber>
+	auto attribute = std::make_unique<StunUserNameAttribute>();
+	attribute->SetUserName(ov::String::FormatString("%s:%s", _remote_ufrag.CStr(), _local_ufrag.CStr()));
+	request_message.AddAttribute(std::move(attribute));
+
+	// MESSAGE-INTEGRITY with the password of the server, FINGERPRINT
+	auto serialized = request_message.Serialize(_remote_pwd);
+
+	return (serialized != nullptr) && SendUdp(serialized->GetData(), serialized->GetLength());
+}
+
+bool WebRtcSubscriber::SendBindingResponse(const uint8_t *transaction_id)
+{
+	StunMessage response_message;
+
+	response_message.SetClass(StunClass::SuccessResponse);
+	response_message.SetMethod(StunMethod::Binding);
+	response_message.SetTransactionId(transaction_id);
+
+	auto attribute = std::make_unique<StunXorMappedAddressAttribute>();
+	attribute->SetParameters(_remote_address);
+	response_message.AddAttribute(std::move(attribute));
+
+	// The request of the server is signed with the password of the subscriber
+	auto serialized = response_message.Serialize(_local_pwd);
+
+	return (serialized != nullptr) && SendUdp(serialized->GetData(), serialized->GetLength());
+}
+
+bool WebRtcSubscriber::SendUdp(const void *data, size_t length)
+{
+	if(_udp_socket < 0)
+	{
+		return false;
+	}
+
+	if(::send(_udp_socket, data, length, MSG_DONTWAIT | MSG_NOSIGNAL) < 0)
+	{
+		// The packet is dropped if the buffer is full, like the network
+		return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ECONNREFUSED);
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// DTLS/SRTP
+//====================================================================================================
+bool WebRtcSubscriber::StartDtls()
+{
+	ov::TlsCallback callback =
+		{
+			.create_callback = nullptr,
+			.read_callback = [this](ov::Tls *tls, void *buffer, size_t length) -> ssize_t
+			{
+				return OnDtlsRead(buffer, length);
+			},
+			.write_callback = [this](ov::Tls *tls, const void *data, size_t length) -> ssize_t
+			{
+				return OnDtlsWrite(data, length);
+			},
+			.destroy_callback = nullptr,
+			.ctrl_callback = [](ov::Tls *tls, int cmd, long num, void *ptr) -> long
+			{
+				switch(cmd)
+				{
+					case BIO_CTRL_FLUSH:
+						return 1;
+
+					default:
+						return 0;
+				}
+			},
+			.verify_callback = nullptr
+		};
+
+	_tls = std::make_unique<ov::Tls>();
+
+	if(_tls->Initialize(_context->tls_context, callback) == false)
+	{
+		return false;
+	}
+
+	_state = State::DtlsConnecting;
+
+	// ClientHello
+	return ContinueDtls(ov::LatencyHistogram::GetCurrentMicroseconds() / 1000);
+}
+
+bool WebRtcSubscriber::ContinueDtls(int64_t now)
+{
+	_next_dtls_time = now + WEBRTC_SUBSCRIBER_DTLS_INTERVAL;
+
+	int error = _tls->Connect();
+
+	if((error == SSL_ERROR_WANT_READ) || (error == SSL_ERROR_WANT_WRITE))
+	{
+		return true;
+	}
+
+	if(error != SSL_ERROR_NONE)
+	{
+		return false;
+	}
+
+	// https://www.iana.org/assignments/tls-parameters/tls-parameters.xhtml#exporter-labels
+	const ov::String label = "EXTRACTOR-dtls_srtp";
+
+	auto crypto_suite = _tls->GetSelectedSrtpProfileId();
+	auto server_key = std::make_shared<ov::Data>();
+	auto client_key = std::make_shared<ov::Data>();
+
+	if(_tls->ExportKeyingMaterial(crypto_suite, label, server_key, client_key) == false)
+	{
+		logtd("Could not export the keying material");
+		return false;
+	}
+
+	// The server protects the packets with the server key
+	_srtp_inbound = std::make_unique<SrtpAdapter>();
+	_srtp_outbound = std::make_unique<SrtpAdapter>();
+
+	if((_srtp_inbound->SetKey(ssrc_any_inbound, crypto_suite, server_key) == false) ||
+	   (_srtp_outbound->SetKey(ssrc_any_outbound, crypto_suite, client_key) == false))
+	{
+		return false;
+	}
+
+	_state = State::Playing;
+	_last_rtp_time = now;
+	_next_rtcp_time = now + WEBRTC_SUBSCRIBER_RTCP_INTERVAL;
+	_dtls_packets.clear();
+
+	return true;
+}
+
+ssize_t WebRtcSubscriber::OnDtlsRead(void *buffer, size_t length)
+{
+	if(_dtls_packets.empty())
+	{
+		// No data to read
+		return 0;
+	}
+
+	auto packet = _dtls_packets.front();
+	_dtls_packets.pop_front();
+
+	size_t read_length = std::min(length, packet->GetLength());
+
+	::memcpy(buffer, packet->GetData(), read_length);
+
+	return static_cast<ssize_t>(read_length);
+}
+
+ssize_t WebRtcSubscriber::OnDtlsWrite(const void *data, size_t length)
+{
+	return SendUdp(data, length) ? static_cast<ssize_t>(length) : -1;
+}
+
+void WebRtcSubscriber::OnRtp(const std::shared_ptr<ov::Data> &packet, int64_t now)
+{
+	auto data = packet->GetDataAs<uint8_t>();
+	size_t length = packet->GetLength();
+
+	if((length < 12) || ((data[0] >> 6) != 2))
+	{
+		return;
+	}
+
+	auto csrc_count = data[0] & 0x0F;
+	bool has_extension = (data[0] & 0x10) != 0;
+	bool has_padding = (data[0] & 0x20) != 0;
+	auto sequence = ByteReader<uint16_t>::ReadBigEndian(data + 2);
+	auto ssrc = ByteReader<uint32_t>::ReadBigEndian(data + 8);
+	size_t offset = 12 + (csrc_count * 4);
+
+	if(has_extension)
+	{
+		if((offset + 4) > length)
+		{
+			return;
+		}
+
+		offset += 4 + (ByteReader<uint16_t>::ReadBigEndian(data + offset + 2) * 4);
+	}
+
+	if(has_padding && (length > offset))
+	{
+		length -= std::min<size_t>(data[length - 1], length - offset);
+	}
+
+	if(offset > length)
+	{
+		return;
+	}
+
+	_last_rtp_time = now;
+	_statistics->rtp_packets++;
+
+	// RFC 3550 - A.1 (without the probation)
+	auto item = _rtp_sources.find(ssrc);
+
+	if(item == _rtp_sources.end())
+	{
+		auto &source = _rtp_sources[ssrc];
+
+		source.base_sequence = sequence;
+		source.max_sequence = sequence;
+		source.received = 1;
+	}
+	else
+	{
+		auto &source = item->second;
+		auto delta = static_cast<uint16_t>(sequence - source.max_sequence);
+
+		if((delta > 0) && (delta < 0x8000))
+		{
+			if(sequence < source.max_sequence)
+			{
+				// Wrapped around
+				source.cycles += 0x10000;
+			}
+
+			source.max_sequence = sequence;
+		}
+
+		source.received++;
+	}
+
+	// A marker is in an SEI which is sent as a single NAL unit or in a STAP-A (it is smaller than MTU)
+	std::vector<SyntheticMarker> markers;
+
+	SyntheticStream::FindMarkers(data + offset, length - offset, &markers);
+
+	if(markers.empty() == false)
+	{
+		OnMarkers(markers, SyntheticStream::GetWallClockMicroseconds());
+	}
+}
+
+bool WebRtcSubscriber::SendReceiverReport()
+{
+	if(_rtp_sources.empty())
+	{
+		return true;
+	}
+
+	auto block_count = std::min<size_t>(_rtp_sources.size(), RTCP_MAX_REPORT_BLOCKS);
+	size_t length = 8 + (block_count * 24);
+	// + SRTCP index (4B) + auth tag
+	auto packet = std::make_shared<ov::Data>(length + 32);
+
+	packet->SetLength(length);
+
+	auto data = packet->GetWritableDataAs<uint8_t>();
+
+	::memset(data, 0, length);
+
+	data[0] = static_cast<uint8_t>(0x80 | block_count);
+	data[1] = RTCP_PAYLOAD_TYPE_RR;
+	ByteWriter<uint16_t>::WriteBigEndian(data + 2, static_cast<uint16_t>((length / 4) - 1));
+	ByteWriter<uint32_t>::WriteBigEndian(data + 4, _local_ssrc);
+
+	auto block = data + 8;
+	size_t index = 0;
+
+	for(auto &item : _rtp_sources)
+	{
+		if(index++ >= block_count)
+		{
+			break;
+		}
+
+		auto &source = item.second;
+		uint32_t extended_max = source.cycles + source.max_sequence;
+		uint32_t expected = extended_max - source.base_sequence + 1;
+		int64_t lost = static_cast<int64_t>(expected) - source.received;
+		uint32_t expected_interval = expected - source.expected_prior;
+		uint32_t received_interval = source.received - source.received_prior;
+		int64_t lost_interval = static_cast<int64_t>(expected_interval) - received_interval;
+		uint8_t fraction = ((expected_interval == 0) || (lost_interval <= 0)) ? 0 : static_cast<uint8_t>((lost_interval << 8) / expected_interval);
+
+		if(lost_interval > 0)
+		{
+			_statistics->lost_rtp_packets += static_cast<uint64_t>(lost_interval);
+		}
+
+		source.expected_prior = expected;
+		source.received_prior = source.received;
+
+		// SSRC, fraction lost + cumulative number of packets lost (24 bits), extended highest sequence number
+		// (jitter, LSR and DLSR are 0)
+		ByteWriter<uint32_t>::WriteBigEndian(block, item.first);
+		ByteWriter<uint32_t>::WriteBigEndian(block + 4, (static_cast<uint32_t>(fraction) << 24) | (static_cast<uint32_t>(std::max<int64_t>(lost, 0)) & 0xFFFFFF));
+		ByteWriter<uint32_t>::WriteBigEndian(block + 8, extended_max);
+
+		block += 24;
+	}
+
+	if(_srtp_outbound->ProtectRtcp(packet) == false)
+	{
+		return false;
+	}
+
+	return SendUdp(packet->GetData(), packet->GetLength());
+}
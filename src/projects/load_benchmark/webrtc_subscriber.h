@@ -0,0 +1,147 @@
+//==============================================================================
+//
+//  LoadBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovcrypto/ovcrypto.h>
+#include <base/ovcrypto/openssl/tls.h>
+#include <base/ovlibrary/json.h>
+#include <dtls_srtp/srtp_adapter.h>
+
+#include <deque>
+#include <unordered_map>
+
+#include "load_session.h"
+
+// Timeout from the signalling to the first RTP packet, and of the RTP packets while playing (ms)
+#define WEBRTC_SUBSCRIBER_CONNECT_TIMEOUT		10000
+#define WEBRTC_SUBSCRIBER_PLAY_TIMEOUT			10000
+// Interval of the binding requests before/after the ICE is connected (ms)
+#define WEBRTC_SUBSCRIBER_CHECK_INTERVAL		500
+#define WEBRTC_SUBSCRIBER_CONSENT_INTERVAL		2500
+// Interval of the DTLS retransmissions (OpenSSL retransmits the flight if its timer is expired)
+#define WEBRTC_SUBSCRIBER_DTLS_INTERVAL			100
+#define WEBRTC_SUBSCRIBER_RTCP_INTERVAL			1000
+#define WEBRTC_SUBSCRIBER_MAX_PACKET_SIZE		1500
+
+// Shared by all WebRTC subscribers
+struct WebRtcSubscriberContext
+{
+	// ws://<host>:<port>/<app>/<stream>
+	LoadUrl signalling_url;
+	// Sends the ICE to this host instead of the host of the candidate (e.g. the server is behind NAT)
+	ov::String ice_host;
+
+	// A certificate for all sessions (the fingerprint is written to the answers)
+	std::shared_ptr<Certificate> certificate;
+	ov::String fingerprint;
+	// DTLS_client_method() with the SRTP profiles
+	std::shared_ptr<ov::TlsContext> tls_context;
+
+	bool Prepare();
+};
+
+// A headless WebRTC player
+//
+// - Signalling: WebSocket (request_offer -> offer -> answer)
+// - ICE: binding requests to the first UDP candidate (ICE-lite like, no candidate gathering)
+// - DTLS (client, setup:active) -> SRTP, the RTP packets are decrypted to count the losses and find the markers
+// - RTCP receiver reports are sent periodically
+class WebRtcSubscriber : public LoadSession
+{
+public:
+	WebRtcSubscriber(const std::shared_ptr<WebRtcSubscriberContext> &context, const std::shared_ptr<LoadStatistics> &statistics);
+
+	bool OnEvent(int fd, uint32_t events, int64_t now) override;
+	bool OnTimer(int64_t now) override;
+
+protected:
+	enum class State
+	{
+		Connecting,
+		// Waiting for 101 Switching Protocols
+		Upgrading,
+		WaitingForOffer,
+		IceChecking,
+		DtlsConnecting,
+		Playing,
+	};
+
+	// Statistics of an SSRC (RFC 3550 - A.1)
+	struct RtpSource
+	{
+		uint16_t max_sequence = 0;
+		uint32_t cycles = 0;
+		uint32_t base_sequence = 0;
+		uint32_t received = 0;
+		uint32_t expected_prior = 0;
+		uint32_t received_prior = 0;
+	};
+
+	bool OnStart(int64_t now) override;
+	void OnClose() override;
+
+	// Signalling
+	bool OnTcpEvent(uint32_t events, int64_t now);
+	bool SendUpgradeRequest();
+	bool ProcessWebSocketFrames(int64_t now);
+	bool SendWebSocketFrame(uint8_t opcode, const void *data, size_t length);
+	bool SendCommand(const ::Json::Value &value);
+	bool OnCommand(const ov::String &message, int64_t now);
+	bool OnOffer(const ov::JsonObject &object, int64_t now);
+	ov::String MakeAnswer(const ov::String &offer);
+
+	// ICE
+	bool ConnectUdp(const ov::SocketAddress &address);
+	bool OnUdpEvent(uint32_t events, int64_t now);
+	bool SendBindingRequest();
+	bool SendBindingResponse(const uint8_t *transaction_id);
+	bool SendUdp(const void *data, size_t length);
+
+	// DTLS/SRTP
+	bool StartDtls();
+	bool ContinueDtls(int64_t now);
+	ssize_t OnDtlsRead(void *buffer, size_t length);
+	ssize_t OnDtlsWrite(const void *data, size_t length);
+
+	void OnRtp(const std::shared_ptr<ov::Data> &packet, int64_t now);
+	bool SendReceiverReport();
+
+	std::shared_ptr<WebRtcSubscriberContext> _context;
+
+	State _state = State::Connecting;
+	// When the session is started (the connection must be completed in WEBRTC_SUBSCRIBER_CONNECT_TIMEOUT)
+	int64_t _start_time = 0;
+	ov::String _websocket_key;
+	// Payload of the fragmented messages
+	ov::Data _message;
+
+	int64_t _peer_id = 0;
+	int64_t _session_id = 0;
+
+	ov::String _local_ufrag;
+	ov::String _local_pwd;
+	ov::String _remote_ufrag;
+	ov::String _remote_pwd;
+	ov::SocketAddress _remote_address;
+	int64_t _next_binding_time = 0;
+	bool _is_ice_connected = false;
+
+	int _udp_socket = -1;
+
+	std::unique_ptr<ov::Tls> _tls;
+	std::deque<std::shared_ptr<const ov::Data>> _dtls_packets;
+	int64_t _next_dtls_time = 0;
+
+	std::unique_ptr<SrtpAdapter> _srtp_inbound;
+	std::unique_ptr<SrtpAdapter> _srtp_outbound;
+
+	uint32_t _local_ssrc = 0;
+	std::unordered_map<uint32_t, RtpSource> _rtp_sources;
+	int64_t _last_rtp_time = 0;
+	int64_t _next_rtcp_time = 0;
+};
@@ -2,6 +2,7 @@ LOCAL_PATH := $(call get_local_path)
 include $(DEFAULT_VARIABLES)
 
 LOCAL_STATIC_LIBRARIES := \
+	webrtcprovider \
 	webrtc \
 	transcoder \
 	rtc_signalling \
@@ -21,7 +22,14 @@ LOCAL_STATIC_LIBRARIES := \
 	ovcrypto \
 	config \
 	ovlibrary \
+	rtmppush \
+	mpegtspush \
+	record \
 	rtmpprovider \
+	mpegtsprovider \
+	replayprovider \
+	srtprovider \
+	vodprovider \
 	hls \
 	dash \
 	segment_stream \
@@ -0,0 +1,401 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "host_modules.h"
+#include "main.h"
+
+#include <webrtc/webrtc_publisher.h>
+#include <dash/dash_publisher.h>
+#include <hls/hls_publisher.h>
+#include <rtmp/rtmp_provider.h>
+#include <srt/srt_provider.h>
+#include <webrtc_provider/webrtc_provider.h>
+#include <mpegts/mpegts_provider.h>
+#include <replay/replay_provider.h>
+#include <rtmp_push/rtmp_push_publisher.h>
+#include <record/record_publisher.h>
+#include <mpegts_push/mpegts_push_publisher.h>
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+ApplicationModules::ApplicationModules(const cfg::Application &application)
+	: _info(std::make_unique<info::Application>(application))
+{
+}
+
+bool ApplicationModules::Start(const ov::String &host_name, const std::shared_ptr<MediaRouter> &router, const std::shared_ptr<Transcoder> &transcoder)
+{
+	const info::Application *application_info = _info.get();
+	auto app_name = application_info->GetName();
+
+	if(router->CreateApplication(application_info) == false)
+	{
+		logte("Could not create the route application [%s/%s]", host_name.CStr(), app_name.CStr());
+		return false;
+	}
+
+	transcoder->CreateApplication(application_info);
+
+	if(application_info->GetType() == cfg::ApplicationType::Live)
+	{
+		logti("Trying to create RTMP Provider for application [%s/%s]...", host_name.CStr(), app_name.CStr());
+		_providers.push_back(RtmpProvider::Create(application_info, router));
+
+		auto srt_provider_info = application_info->GetProvider<cfg::SrtProvider>();
+
+		if((srt_provider_info != nullptr) && srt_provider_info->IsParsed())
+		{
+			logti("Trying to create SRT Provider for application [%s/%s]...", host_name.CStr(), app_name.CStr());
+
+			auto srt_provider = SrtProvider::Create(application_info, router);
+
+			if(srt_provider != nullptr)
+			{
+				_providers.push_back(srt_provider);
+			}
+		}
+
+		auto webrtc_provider_info = application_info->GetProvider<cfg::WebrtcProvider>();
+
+		if((webrtc_provider_info != nullptr) && webrtc_provider_info->IsParsed())
+		{
+			logti("Trying to create WebRTC Provider for application [%s/%s]...", host_name.CStr(), app_name.CStr());
+
+			auto webrtc_provider = WebrtcProvider::Create(application_info, router);
+
+			if(webrtc_provider != nullptr)
+			{
+				_providers.push_back(webrtc_provider);
+			}
+		}
+
+		auto mpegts_provider_info = application_info->GetProvider<cfg::MpegtsProvider>();
+
+		if((mpegts_provider_info != nullptr) && mpegts_provider_info->IsParsed())
+		{
+			logti("Trying to create MPEG-TS Provider for application [%s/%s]...", host_name.CStr(), app_name.CStr());
+
+			auto mpegts_provider = MpegtsProvider::Create(application_info, router);
+
+			if(mpegts_provider != nullptr)
+			{
+				_providers.push_back(mpegts_provider);
+			}
+		}
+
+		auto replay_provider_info = application_info->GetProvider<cfg::ReplayProvider>();
+
+		if((replay_provider_info != nullptr) && replay_provider_info->IsParsed())
+		{
+			logti("Trying to create Replay Provider for application [%s/%s]...", host_name.CStr(), app_name.CStr());
+
+			auto replay_provider = ReplayProvider::Create(application_info, router);
+
+			if(replay_provider != nullptr)
+			{
+				_providers.push_back(replay_provider);
+			}
+		}
+	}
+	else if((application_info->GetType() == cfg::ApplicationType::Vod) || (application_info->GetType() == cfg::ApplicationType::VodEdge))
+	{
+		// The files are packaged by the stream servers of the HLS/DASH publishers (no stream is created)
+		logti("Trying to create VOD Provider for application [%s/%s]...", host_name.CStr(), app_name.CStr());
+		_vod_provider = VodProvider::Create(application_info);
+	}
+
+	auto publisher_list = application_info->GetPublishers().GetPublisherList();
+	std::map<int, std::shared_ptr<HttpServer>> segment_http_server_manager; // key : port number
+
+	for(const auto &publisher : publisher_list)
+	{
+		if(publisher->IsParsed() == false)
+		{
+			continue;
+		}
+
+		switch(publisher->GetType())
+		{
+			case cfg::PublisherType::Webrtc:
+				logti("Trying to create WebRTC Publisher for application [%s/%s]...", host_name.CStr(), app_name.CStr());
+				_publishers.push_back(WebRtcPublisher::Create(application_info, router, router->GetRouteApplicationById(application_info->GetId())));
+				break;
+
+			case cfg::PublisherType::Dash:
+				logti("Trying to create DASH Publisher for application [%s/%s]...", host_name.CStr(), app_name.CStr());
+				_publishers.push_back(DashPublisher::Create(segment_http_server_manager, application_info, router, _vod_provider));
+				break;
+
+			case cfg::PublisherType::Hls:
+				logti("Trying to create HLS Publisher for application [%s/%s]...", host_name.CStr(), app_name.CStr());
+				_publishers.push_back(HlsPublisher::Create(segment_http_server_manager, application_info, router, _vod_provider));
+				break;
+
+			case cfg::PublisherType::Rtmp:
+				logti("Trying to create RTMP Publisher for application [%s/%s]...", host_name.CStr(), app_name.CStr());
+				_publishers.push_back(RtmpPushPublisher::Create(application_info, router));
+				break;
+
+			case cfg::PublisherType::Record:
+				logti("Trying to create Record Publisher for application [%s/%s]...", host_name.CStr(), app_name.CStr());
+				_publishers.push_back(RecordPublisher::Create(application_info, router));
+				break;
+
+			case cfg::PublisherType::Mpegts:
+				logti("Trying to create MPEG-TS Publisher for application [%s/%s]...", host_name.CStr(), app_name.CStr());
+				_publishers.push_back(MpegtsPushPublisher::Create(application_info, router));
+				break;
+
+			default:
+				// not implemented
+				break;
+		}
+	}
+
+	// The modules which are failed to create
+	_providers.erase(std::remove(_providers.begin(), _providers.end(), nullptr), _providers.end());
+	_publishers.erase(std::remove(_publishers.begin(), _publishers.end(), nullptr), _publishers.end());
+
+	// The stats of the publishers are pushed to the consoles
+	if(application_info->GetWebConsole().IsParsed())
+	{
+		logti("Trying to initialize WebConsole for application [%s/%s]...", host_name.CStr(), app_name.CStr());
+		_web_console_server = WebConsoleServer::Create(application_info, router, _publishers);
+	}
+
+	return true;
+}
+
+void ApplicationModules::Stop(const std::shared_ptr<MediaRouter> &router, const std::shared_ptr<Transcoder> &transcoder)
+{
+	// Same order as the streams flow: the streams are deleted by the providers first,
+	// so the deletion is propagated to the transcoder and the publishers
+	for(auto &provider : _providers)
+	{
+		provider->Stop();
+	}
+
+	for(auto &publisher : _publishers)
+	{
+		publisher->Stop();
+	}
+
+	if(_web_console_server != nullptr)
+	{
+		_web_console_server->Stop();
+	}
+
+	transcoder->DeleteApplication(_info->GetId());
+	router->DeleteApplication(_info->GetId());
+
+	_providers.clear();
+	_publishers.clear();
+	_web_console_server = nullptr;
+	_vod_provider = nullptr;
+}
+
+bool HostModules::Start(const cfg::Host &host)
+{
+	_host_name = host.GetName();
+	_ports_config = host.GetPorts().ToString();
+	_transcode_worker_count = host.GetTranscodeWorkerCount();
+
+	// The applications are added by StartApplication(), so they can be added/removed by the reload
+	logti("Trying to create MediaRouter for host [%s]...", _host_name.CStr());
+	_router = MediaRouter::Create({});
+
+	logti("Trying to create Transcoder for host [%s]...", _host_name.CStr());
+	_transcoder = Transcoder::Create({}, _router);
+
+	std::vector<const cfg::Application *> applications;
+
+	for(const auto &application : host.GetApplications())
+	{
+		applications.push_back(&application);
+	}
+
+	StartApplications(host, applications);
+
+	if(_applications.empty())
+	{
+		logtw("Nothing to do for host [%s]", _host_name.CStr());
+	}
+
+	return true;
+}
+
+int HostModules::Reload(const cfg::Host &host)
+{
+	if(host.GetPorts().ToString() != _ports_config)
+	{
+		logtw("The ports of host [%s] are changed, the new ports are used after a restart", _host_name.CStr());
+	}
+
+	if(host.GetTranscodeWorkerCount() != _transcode_worker_count)
+	{
+		logtw("The transcode worker count of host [%s] is changed, the new count is used after a restart", _host_name.CStr());
+	}
+
+	int change_count = 0;
+	std::set<ov::String> names;
+	std::vector<const cfg::Application *> applications_to_start;
+
+	for(const auto &application : host.GetApplications())
+	{
+		auto name = application.GetName();
+		auto item = _application_configs.find(name);
+
+		names.insert(name);
+
+		if(item == _application_configs.end())
+		{
+			logti("Application [%s/%s] is added", _host_name.CStr(), name.CStr());
+		}
+		else if(item->second == MakeApplicationConfig(host, application))
+		{
+			// Not changed: the streams are kept
+			continue;
+		}
+		else
+		{
+			logti("Application [%s/%s] is changed, restarting the application...", _host_name.CStr(), name.CStr());
+			StopApplication(name);
+		}
+
+		applications_to_start.push_back(&application);
+		change_count++;
+	}
+
+	StartApplications(host, applications_to_start);
+
+	for(auto item = _application_configs.begin(); item != _application_configs.end();)
+	{
+		auto name = item->first;
+		++item;
+
+		if(names.find(name) == names.end())
+		{
+			logti("Application [%s/%s] is removed", _host_name.CStr(), name.CStr());
+			StopApplication(name);
+			change_count++;
+		}
+	}
+
+	return change_count;
+}
+
+void HostModules::Stop()
+{
+	while(_applications.empty() == false)
+	{
+		StopApplication(_applications.begin()->first);
+	}
+}
+
+void HostModules::GetModules(std::vector<std::shared_ptr<pvd::Provider>> &providers, std::vector<std::shared_ptr<Publisher>> &publishers) const
+{
+	for(const auto &application : _applications)
+	{
+		const auto &modules = application.second;
+
+		providers.insert(providers.end(), modules->GetProviders().begin(), modules->GetProviders().end());
+		publishers.insert(publishers.end(), modules->GetPublishers().begin(), modules->GetPublishers().end());
+	}
+}
+
+ov::String HostModules::MakeApplicationConfig(const cfg::Host &host, const cfg::Application &application) const
+{
+	return host.GetTls().ToString() + application.ToString();
+}
+
+int HostModules::StartApplications(const cfg::Host &host, const std::vector<const cfg::Application *> &applications)
+{
+	size_t count = applications.size();
+
+	if(count == 0)
+	{
+		return 0;
+	}
+
+	// The infos are created in order (the certificates are loaded once, see info::Application)
+	std::vector<std::shared_ptr<ApplicationModules>> modules_list;
+
+	for(const auto &application : applications)
+	{
+		logti("Trying to create application [%s] (%s)...", application->GetName().CStr(), application->GetTypeName().CStr());
+		modules_list.push_back(std::make_shared<ApplicationModules>(*application));
+	}
+
+	// The applications don't depend on each other (each one has its own route/transcode application),
+	// so they are started in parallel. The modules of an application are started in order by ApplicationModules::Start().
+	size_t thread_count = std::min<size_t>(count, std::max(std::thread::hardware_concurrency(), 1U));
+	thread_count = std::min<size_t>(thread_count, HOST_MODULES_MAX_START_THREADS);
+
+	std::vector<char> results(count, 0);
+	std::atomic<size_t> next_index { 0 };
+
+	auto start_applications = [&]() {
+		size_t index;
+
+		while((index = next_index++) < count)
+		{
+			results[index] = modules_list[index]->Start(_host_name, _router, _transcoder) ? 1 : 0;
+		}
+	};
+
+	std::vector<std::thread> threads;
+
+	for(size_t index = 1; index < thread_count; index++)
+	{
+		threads.emplace_back(start_applications);
+	}
+
+	// The current thread starts the applications too
+	start_applications();
+
+	for(auto &thread : threads)
+	{
+		thread.join();
+	}
+
+	int started_count = 0;
+
+	for(size_t index = 0; index < count; index++)
+	{
+		if(results[index] == 0)
+		{
+			continue;
+		}
+
+		auto &application = *(applications[index]);
+
+		_applications[application.GetName()] = modules_list[index];
+		_application_configs[application.GetName()] = MakeApplicationConfig(host, application);
+		started_count++;
+	}
+
+	logti("%d/%zu applications are started for host [%s] (%zu threads)", started_count, count, _host_name.CStr(), thread_count);
+
+	return started_count;
+}
+
+void HostModules::StopApplication(const ov::String &name)
+{
+	auto item = _applications.find(name);
+
+	if(item != _applications.end())
+	{
+		logti("Trying to stop application [%s/%s]...", _host_name.CStr(), name.CStr());
+
+		item->second->Stop(_router, _transcoder);
+		_applications.erase(item);
+	}
+
+	_application_configs.erase(name);
+}
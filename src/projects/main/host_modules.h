@@ -0,0 +1,112 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/application/application.h>
+#include <base/provider/provider.h>
+#include <base/publisher/publisher.h>
+#include <media_router/media_router.h>
+#include <transcode/transcoder.h>
+#include <web_console/web_console_server.h>
+#include <vod/vod_provider.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+// Maximum number of the threads which start the applications of a host in parallel
+#define HOST_MODULES_MAX_START_THREADS		8
+
+// Modules of an application (providers, publishers, web console), which are created/deleted as a unit by the config reload
+class ApplicationModules
+{
+public:
+	explicit ApplicationModules(const cfg::Application &application);
+
+	// Registers the application to the router/transcoder, and creates the providers/publishers
+	bool Start(const ov::String &host_name, const std::shared_ptr<MediaRouter> &router, const std::shared_ptr<Transcoder> &transcoder);
+
+	// The streams of the application are deleted
+	void Stop(const std::shared_ptr<MediaRouter> &router, const std::shared_ptr<Transcoder> &transcoder);
+
+	const info::Application &GetInfo() const
+	{
+		return *_info;
+	}
+
+	const std::vector<std::shared_ptr<pvd::Provider>> &GetProviders() const
+	{
+		return _providers;
+	}
+
+	const std::vector<std::shared_ptr<Publisher>> &GetPublishers() const
+	{
+		return _publishers;
+	}
+
+protected:
+	// The providers/publishers refer to it until they are stopped, so it is not moved
+	std::unique_ptr<info::Application> _info;
+
+	std::vector<std::shared_ptr<pvd::Provider>> _providers;
+	std::vector<std::shared_ptr<Publisher>> _publishers;
+	std::shared_ptr<WebConsoleServer> _web_console_server;
+	// VOD application only
+	std::shared_ptr<VodProvider> _vod_provider;
+};
+
+// Router/transcoder and the applications of a host
+//
+// - Reload() compares the configs of the applications by their names:
+//   the added applications are started, the removed applications are stopped,
+//   and the changed applications are restarted (the streams of the unchanged applications are not affected)
+// - The changes of the ports, the thread counts and the monitoring server are applied after a restart
+class HostModules
+{
+public:
+	bool Start(const cfg::Host &host);
+
+	// Returns the number of the applications which are added/removed/restarted
+	int Reload(const cfg::Host &host);
+
+	void Stop();
+
+	const ov::String &GetName() const
+	{
+		return _host_name;
+	}
+
+	const std::shared_ptr<MediaRouter> &GetRouter() const
+	{
+		return _router;
+	}
+
+	void GetModules(std::vector<std::shared_ptr<pvd::Provider>> &providers, std::vector<std::shared_ptr<Publisher>> &publishers) const;
+
+protected:
+	// The config which the modules of the application depend on (including the TLS of the host, which is used for the certificates)
+	ov::String MakeApplicationConfig(const cfg::Host &host, const cfg::Application &application) const;
+
+	// Starts the applications in parallel, returns the number of the applications which are started
+	int StartApplications(const cfg::Host &host, const std::vector<const cfg::Application *> &applications);
+	void StopApplication(const ov::String &name);
+
+	ov::String _host_name;
+
+	// The configs which can't be applied while running
+	ov::String _ports_config;
+	int _transcode_worker_count = 0;
+
+	std::shared_ptr<MediaRouter> _router;
+	std::shared_ptr<Transcoder> _transcoder;
+
+	// key: application name
+	std::map<ov::String, std::shared_ptr<ApplicationModules>> _applications;
+	// key: application name, value: the config when the application is started
+	std::map<ov::String, ov::String> _application_configs;
+};
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <regex>
 
+#include <signal.h>
 #include <sys/utsname.h>
 
 #include <srtp2/srtp.h>
@@ -14,15 +15,130 @@
 #include <hls/hls_publisher.h>
 #include <media_router/media_router.h>
 #include <transcode/transcoder.h>
+#include <transcode/transcode_scheduler.h>
 #include <monitoring/monitoring_server.h>
 #include <web_console/web_console.h>
 #include <rtmp/rtmp_provider.h>
+#include <srt/srt_provider.h>
+#include <rtmp_push/rtmp_push_publisher.h>
+#include <physical_port/physical_port_manager.h>
+#include "host_modules.h"
 #include <base/ovcrypto/ovcrypto.h>
 #include <base/ovlibrary/stack_trace.h>
 #include <base/ovlibrary/log_write.h>
 
 void SrtLogHandler(void *opaque, int level, const char *file, int line, const char *area, const char *message);
 
+static void ReloadSignalHandler(int signal_number)
+{
+	// Only sets the flag (async-signal-safe), the configs are reloaded by the main loop
+	cfg::ConfigManager::Instance()->RequestReload();
+}
+
+static volatile sig_atomic_t g_drain_requested = 0;
+
+static void DrainSignalHandler(int signal_number)
+{
+	// Only sets the flag (async-signal-safe), the drain is started by the main loop
+	g_drain_requested = 1;
+
+	// The next SIGTERM terminates the process immediately
+	::signal(SIGTERM, SIG_DFL);
+}
+
+// Sessions of the publishers of all hosts
+static size_t GetSessionCount(const std::map<ov::String, std::shared_ptr<HostModules>> &host_modules_map)
+{
+	std::vector<std::shared_ptr<pvd::Provider>> providers;
+	std::vector<std::shared_ptr<Publisher>> publishers;
+
+	for(const auto &item : host_modules_map)
+	{
+		item.second->GetModules(providers, publishers);
+	}
+
+	size_t session_count = 0;
+	std::vector<std::shared_ptr<PublisherApplicationMetricsData>> applications;
+	std::vector<std::shared_ptr<PublisherStreamMetricsData>> streams;
+
+	for(const auto &publisher : publishers)
+	{
+		applications.clear();
+		streams.clear();
+
+		publisher->GetMetricsData(applications, streams);
+
+		for(const auto &stream : streams)
+		{
+			session_count += stream->metrics.session_count;
+		}
+	}
+
+	return session_count;
+}
+
+static void ReloadHosts(std::map<ov::String, std::shared_ptr<HostModules>> &host_modules_map, const std::vector<std::shared_ptr<MonitoringServer>> &monitoring_servers)
+{
+	logti("Trying to reload the configs...");
+
+	auto server = cfg::ConfigManager::Instance()->ReloadConfigs();
+
+	if(server == nullptr)
+	{
+		logte("Could not reload the configs, the current configs are kept");
+		return;
+	}
+
+	int change_count = 0;
+	std::map<ov::String, std::shared_ptr<HostModules>> new_host_modules_map;
+
+	for(const auto &host : server->GetHosts())
+	{
+		auto item = host_modules_map.find(host.GetName());
+
+		if(item != host_modules_map.end())
+		{
+			change_count += item->second->Reload(host);
+			new_host_modules_map[host.GetName()] = item->second;
+			host_modules_map.erase(item);
+		}
+		else
+		{
+			logti("Host [%s] is added", host.GetName().CStr());
+
+			auto host_modules = std::make_shared<HostModules>();
+			host_modules->Start(host);
+			new_host_modules_map[host.GetName()] = host_modules;
+			change_count++;
+		}
+	}
+
+	// The remaining hosts are removed
+	for(auto &item : host_modules_map)
+	{
+		logti("Host [%s] is removed", item.first.CStr());
+		item.second->Stop();
+		change_count++;
+	}
+
+	host_modules_map = std::move(new_host_modules_map);
+
+	std::vector<std::shared_ptr<pvd::Provider>> providers;
+	std::vector<std::shared_ptr<Publisher>> publishers;
+
+	for(const auto &item : host_modules_map)
+	{
+		item.second->GetModules(providers, publishers);
+	}
+
+	for(const auto &monitoring_server : monitoring_servers)
+	{
+		monitoring_server->UpdateModules(providers, publishers);
+	}
+
+	logti("The configs are reloaded (%d changes)", change_count);
+}
+
 struct ParseOption
 {
 	// -c <config_path>
@@ -114,15 +230,37 @@ int main(int argc, char *argv[])
 	std::shared_ptr<cfg::Server> server = cfg::ConfigManager::Instance()->GetServer();
 	std::vector<cfg::Host> hosts = server->GetHosts();
 
-	std::shared_ptr<MediaRouter> router;
-	std::shared_ptr<Transcoder> transcoder;
-	std::vector<std::shared_ptr<WebConsoleServer>> web_console_servers;
+	// The pools must be set before the threads are created
+	for(const auto &pool : server->GetThreadTopology().GetPools())
+	{
+		if(ov::ThreadTopology::Instance()->SetPool(pool.GetName(), pool.GetCpus(), pool.GetNumaNode()) == false)
+		{
+			logte("Invalid thread pool: %s", pool.GetName().CStr());
+			return 1;
+		}
+	}
 
-	std::vector<std::shared_ptr<pvd::Provider>> providers;
-	std::vector<std::shared_ptr<Publisher>> publishers;
-	//std::shared_ptr<MonitoringServer> monitoring_server;
+	ov::LockProfiler::SetEnabled(server->IsLockProfiling());
+	// Falls back to the normal pages if the kernel doesn't support them
+	ov::HugePages::SetEnabled(server->IsHugePages());
 
-	std::map<ov::String, std::vector<info::Application>> application_infos;
+	auto &memory_governor_config = server->GetMemoryGovernor();
+
+	if(memory_governor_config.IsParsed())
+	{
+		ov::MemoryGovernorConfig memory_governor;
+		memory_governor.limit = static_cast<uint64_t>(std::max(memory_governor_config.GetLimit(), 0)) * 1024ULL * 1024ULL;
+		memory_governor.shrink_threshold = memory_governor_config.GetShrinkThreshold();
+		memory_governor.cap_queues_threshold = memory_governor_config.GetCapQueuesThreshold();
+		memory_governor.refuse_new_threshold = memory_governor_config.GetRefuseNewThreshold();
+		memory_governor.shed_streams_threshold = memory_governor_config.GetShedStreamsThreshold();
+		memory_governor.pressure_threshold = memory_governor_config.GetPressureThreshold();
+		memory_governor.interval = memory_governor_config.GetInterval();
+		ov::MemoryGovernor::Instance()->Start(memory_governor);
+	}
+
+	std::map<ov::String, std::shared_ptr<HostModules>> host_modules_map;
+	std::vector<std::shared_ptr<MonitoringServer>> monitoring_servers;
 
 	for(auto &host : hosts)
 	{
@@ -130,101 +268,116 @@ int main(int argc, char *argv[])
 
 		logtd("Trying to create modules for host [%s]", host_name.CStr());
 
-		auto &app_info_list = application_infos[host.GetName()];
+		PhysicalPortManager::Instance()->SetWorkerCount(host.GetPorts().GetWorkerCount());
+		PhysicalPortManager::Instance()->SetIoUringEnabled(host.GetPorts().IsIoUringEnabled());
+		PhysicalPortManager::Instance()->SetEdgeTriggeredEnabled(host.GetPorts().IsEdgeTriggeredEnabled());
+
+		auto &connection_limit_config = host.GetPorts().GetConnectionLimit();
+		ov::ConnectionLimit connection_limit;
+		connection_limit.rate_per_ip = connection_limit_config.GetRatePerIp();
+		connection_limit.burst_per_ip = connection_limit_config.GetBurstPerIp();
+		connection_limit.max_pending_handshakes = connection_limit_config.GetMaxPendingHandshakes();
+		PhysicalPortManager::Instance()->SetConnectionLimit(connection_limit);
+
+		// The transcode workers are shared by all hosts, so the count of the first host is used
+		TranscodeScheduler::Instance()->SetWorkerCount(host.GetTranscodeWorkerCount());
+
+		auto host_modules = std::make_shared<HostModules>();
+		host_modules->Start(host);
+		host_modules_map[host_name] = host_modules;
 
-		for(const auto &application : host.GetApplications())
+		std::vector<std::shared_ptr<pvd::Provider>> providers;
+		std::vector<std::shared_ptr<Publisher>> publishers;
+		host_modules->GetModules(providers, publishers);
+
+		// Monitoring Server (CSV and /metrics for Prometheus)
+		auto &monitoring_port = host.GetPorts().GetMonitoringPort();
+
+		if(monitoring_port.IsParsed() && ((providers.empty() == false) || (publishers.empty() == false)))
 		{
-			logti("Trying to create application [%s] (%s)...", application.GetName().CStr(), application.GetTypeName().CStr());
+			logti("Trying to start Monitoring Server for host [%s] (port: %d)...", host_name.CStr(), monitoring_port.GetPort());
+
+			auto monitoring_server = std::make_shared<MonitoringServer>();
 
-			app_info_list.emplace_back(application);
+			if(monitoring_server->Start(ov::SocketAddress(static_cast<uint16_t>(monitoring_port.GetPort())),
+			                            providers,
+			                            publishers,
+			                            nullptr,
+			                            host_modules->GetRouter()))
+			{
+				monitoring_servers.push_back(monitoring_server);
+			}
+			else
+			{
+				logte("Could not start Monitoring Server for host [%s]", host_name.CStr());
+			}
 		}
+	}
+
+	// kill -HUP <pid> (or /reload of the monitoring server) reloads the configs
+	::signal(SIGHUP, ReloadSignalHandler);
+
+	auto &drain_config = server->GetDrain();
+
+	if(drain_config.IsParsed())
+	{
+		ov::DrainConfig drain;
+		drain.timeout = drain_config.GetTimeout();
+		drain.stagger_window = drain_config.GetStaggerWindow();
+		drain.retry_after = drain_config.GetRetryAfter();
+		drain.redirect_url = drain_config.GetRedirectUrl().CStr();
+		ov::DrainMode::Instance()->SetConfig(drain);
+
+		// kill -TERM <pid> drains the sessions before the process is terminated
+		::signal(SIGTERM, DrainSignalHandler);
+	}
 
-		if(app_info_list.empty() == false)
+	while(true)
+	{
+		sleep(1);
+
+		if(g_drain_requested)
 		{
-			logti("Trying to create MediaRouter for host [%s]...", host_name.CStr());
-			router = MediaRouter::Create(app_info_list);
+			ov::DrainMode::Instance()->Start();
+		}
 
-			logti("Trying to create Transcoder for host [%s]...", host_name.CStr());
-			transcoder = Transcoder::Create(app_info_list, router);
+		if(ov::DrainMode::Instance()->IsDraining())
+		{
+			// The sessions are kept until all clients are asked to move and they leave (or the deadline)
+			if(ov::DrainMode::Instance()->IsExpired())
+			{
+				logtw("The drain timeout is expired, %zu sessions will be closed", GetSessionCount(host_modules_map));
+				break;
+			}
 
-			for(const auto &application_info : app_info_list)
+			if(ov::DrainMode::Instance()->IsStaggered() && (GetSessionCount(host_modules_map) == 0))
 			{
-				auto app_name = application_info.GetName();
-
-				if(application_info.GetType() == cfg::ApplicationType::Live)
-				{
-					logti("Trying to create RTMP Provider for application [%s/%s]...", host_name.CStr(), app_name.CStr());
-					providers.push_back(RtmpProvider::Create(&application_info, router));
-				}
-
-				if(application_info.GetWebConsole().IsParsed())
-				{
-					logti("Trying to initialize WebConsole for application [%s/%s]...", host_name.CStr(), app_name.CStr());
-					web_console_servers.push_back(WebConsoleServer::Create(&application_info));
-				}
-
-				auto publisher_list = application_info.GetPublishers().GetPublisherList();
-				std::map<int, std::shared_ptr<HttpServer>> segment_http_server_manager; // key : port number
-
-				for(const auto &publisher : publisher_list)
-				{
-					if(publisher->IsParsed())
-					{
-						auto application = router->GetRouteApplicationById(application_info.GetId());
-
-						switch(publisher->GetType())
-						{
-							case cfg::PublisherType::Webrtc:
-								logti("Trying to create WebRTC Publisher for application [%s/%s]...", host_name.CStr(), app_name.CStr());
-								publishers.push_back(WebRtcPublisher::Create(&application_info, router, application));
-								break;
-
-							case cfg::PublisherType::Dash:
-								logti("Trying to create DASH Publisher for application [%s/%s]...", host_name.CStr(), app_name.CStr());
-								publishers.push_back(DashPublisher::Create(segment_http_server_manager,
-								                                           &application_info,
-								                                           router));
-								break;
-
-							case cfg::PublisherType::Hls:
-								logti("Trying to create HLS Publisher for application [%s/%s]...", host_name.CStr(), app_name.CStr());
-								publishers.push_back(HlsPublisher::Create(segment_http_server_manager,
-								                                          &application_info,
-								                                          router));
-								break;
-
-							case cfg::PublisherType::Rtmp:
-							default:
-								// not implemented
-								break;
-						}
-					}
-				}
+				logti("All sessions are drained");
+				break;
 			}
+
+			// The configs are not reloaded while draining
+			continue;
 		}
-		else
+
+		if(cfg::ConfigManager::Instance()->CheckReloadRequested())
 		{
-			logtw("Nothing to do for host [%s]", host_name.CStr());
+			ReloadHosts(host_modules_map, monitoring_servers);
 		}
+	}
 
-//		// Monitoring Server
-//        auto monitoring_port = host.GetPorts().GetMonitoringPort();
-//        if(monitoring_port.IsParsed() && (providers.size() > 0 || publishers.size() > 0))
-//        {
-//            logtd("Monitoring Server Start - host[%s] port[%d]", host_name.CStr(), monitoring_port.GetPort());
-//
-//            monitoring_server = std::make_shared<MonitoringServer>();
-//            monitoring_server->Start(ov::SocketAddress(static_cast<uint16_t>(monitoring_port.GetPort())),
-//                                     providers,
-//                                     publishers);
-//        }
+	for(const auto &monitoring_server : monitoring_servers)
+	{
+		monitoring_server->Stop();
 	}
 
-	while(true)
+	for(auto &item : host_modules_map)
 	{
-		sleep(1);
+		item.second->Stop();
 	}
 
+	host_modules_map.clear();
+
 	logtd("Trying to uninitialize OpenSSL...");
 	ov::OpensslManager::ReleaseOpenSSL();
 
@@ -106,10 +106,8 @@ void BitstreamToADTS::convert_to(const std::shared_ptr<ov::Data> &data)
 
 		int16_t aac_fixed_header_length = 2;
 
-		// extract data after [aac_fixed_header_length] bytes
-		// packet->EraseBuffer(0, aac_fixed_header_length);
-		data->Erase(0, aac_fixed_header_length);
-		// pkt->_buf.erase(pkt->_buf.begin(), pkt->_buf.begin()+aac_fixed_header_length);
+		// extract data after [aac_fixed_header_length] bytes (the header becomes the headroom, the data is not moved)
+		data->TrimFront(aac_fixed_header_length);
 
 		int16_t aac_raw_length = data->GetLength();    // 2바이트 헤더를 제외함
 
@@ -156,7 +154,8 @@ void BitstreamToADTS::convert_to(const std::shared_ptr<ov::Data> &data)
 			*pp++ = 0xfc;
 		}
 
-		data->Insert(aac_fixed_header, 0, sizeof(aac_fixed_header));
+		// O(1) if the data has enough headroom (MEDIA_PACKET_HEADROOM)
+		data->Prepend(aac_fixed_header, sizeof(aac_fixed_header));
 	}
 }
 
@@ -31,8 +31,13 @@ BitstreamToAnnexB::~BitstreamToAnnexB()
 // ([extradata]) | ([length] NALU) | ([length] NALU) |
 // In annexb, [start code] may be 0x000001 or 0x00000001.
 
-void BitstreamToAnnexB::convert_to(const std::shared_ptr<ov::Data> &data, int64_t &cts)
+void BitstreamToAnnexB::convert_to(const std::shared_ptr<ov::Data> &data, int64_t &cts, FragmentationHeader *fragmentation)
 {
+	if(fragmentation != nullptr)
+	{
+		fragmentation->fragmentation_vector_size = 0;
+	}
+
 	if(data->GetLength() < 4)
 	{
 		logtw("Could not determine bit stream type");
@@ -53,7 +58,6 @@ void BitstreamToAnnexB::convert_to(const std::shared_ptr<ov::Data> &data, int64_
 	}
 
 	uint8_t start_code[4] = { 0x00, 0x00, 0x00, 0x01 };
-	auto pbuf_length = static_cast<uint32_t>(data->GetLength());
 
 	// Convert [FLV] to [Video data]
 	// Refrence: Video File Format Specification, Version 10 (https://wwwimages2.adobe.com/content/dam/acom/en/devnet/flv/video_file_format_spec_v10.pdf)
@@ -74,6 +78,7 @@ void BitstreamToAnnexB::convert_to(const std::shared_ptr<ov::Data> &data, int64_
 	//     5: On2 VP7 with alpha channel
 	//     6: Screen video version 2
 	//     7: AVC
+	//    12: HEVC (not in the specification, the RTMP provider converts the Enhanced RTMP header to this)
 	int codec_id = pbuf[0] & 0x0f;
 	//   8bit : AVCPacketType
 	//     0: AVC Sequence header
@@ -87,7 +92,9 @@ void BitstreamToAnnexB::convert_to(const std::shared_ptr<ov::Data> &data, int64_
 	// 0
 	//int composition_time = 0;
 
-	if(codec_id == 7) // avcvideopacket
+	bool is_hevc = (codec_id == 12);
+
+	if((codec_id == 7) || is_hevc) // avcvideopacket (HEVC has the same structure)
 	{
 		// 3byte
 		avc_packet_type = pbuf[1];
@@ -111,6 +118,45 @@ void BitstreamToAnnexB::convert_to(const std::shared_ptr<ov::Data> &data, int64_
 			{
 				case 0:
 				{
+					if(is_hevc)
+					{
+						// HEVC sequence header (HEVCDecoderConfigurationRecord)
+						uint8_t hevc_profile;
+						uint8_t hevc_level;
+
+						if(HevcSequenceHeaderParsing(pbuf, static_cast<int>(data->GetLength()), _vps, _sps, _pps, hevc_profile, hevc_level) == false)
+						{
+							logtw("Could not parse the HEVC sequence header");
+							break;
+						}
+
+						data->Clear();
+						data->Append(start_code, 4);
+						data->Append(_vps.data(), _vps.size());
+
+						data->Append(start_code, 4);
+						data->Append(_sps.data(), _sps.size());
+
+						data->Append(start_code, 4);
+						data->Append(_pps.data(), _pps.size());
+
+						if(fragmentation != nullptr)
+						{
+							size_t count = 0;
+							size_t offset = 4;
+
+							AddFragment(fragmentation, count, data->GetDataAs<uint8_t>(), offset, _vps.size(), true);
+							offset += _vps.size() + 4;
+							AddFragment(fragmentation, count, data->GetDataAs<uint8_t>(), offset, _sps.size(), true);
+							offset += _sps.size() + 4;
+							AddFragment(fragmentation, count, data->GetDataAs<uint8_t>(), offset, _pps.size(), true);
+						}
+
+						logtd("vps/sps/pps packet size : %d", data->GetLength());
+
+						break;
+					}
+
 					// AVC sequence header
 
 					// pBuf[0] == CodecID (1B)
@@ -199,6 +245,14 @@ void BitstreamToAnnexB::convert_to(const std::shared_ptr<ov::Data> &data, int64_
 					data->Append(start_code, 4);
 					data->Append(_pps.data(), _pps.size());
 
+					if(fragmentation != nullptr)
+					{
+						size_t count = 0;
+
+						AddFragment(fragmentation, count, data->GetDataAs<uint8_t>(), 4, _sps.size(), false);
+						AddFragment(fragmentation, count, data->GetDataAs<uint8_t>(), 4 + _sps.size() + 4, _pps.size(), false);
+					}
+
 					logtd("sps/pps packet size : %d", data->GetLength());
 
 					break;
@@ -218,8 +272,6 @@ void BitstreamToAnnexB::convert_to(const std::shared_ptr<ov::Data> &data, int64_
                                                 static_cast<uint8_t>(*(pbuf + 3)) << 8 |
                                                 static_cast<uint8_t>(*(pbuf + 4)));
 
-                    const uint8_t *p = pbuf + 5;
-
 					// 0      Unspecified                                                    non-VCL
 					// 1      Coded slice of a non-IDR picture                               VCL
 					// 2      Coded slice data partition A                                   VCL
@@ -244,33 +296,7 @@ void BitstreamToAnnexB::convert_to(const std::shared_ptr<ov::Data> &data, int64_
 					// 22..23 Reserved                                                       non-VCL
 					// 24..31 Unspecified                                                    non-VCL
 
-					auto tmp_buf = std::make_shared<MediaFrame>();
-
-					while(true)
-					{
-						int32_t nal_length = static_cast<int32_t>(static_cast<uint8_t>(*(p)) << 24 |
-						                                          static_cast<uint8_t>(*(p + 1)) << 16 |
-						                                          static_cast<uint8_t>(*(p + 2)) << 8 |
-						                                          static_cast<uint8_t>(*(p + 3)));
-
-						// skip length 32bit
-						p += 4;
-
-						tmp_buf->AppendBuffer(start_code, 4);
-						tmp_buf->AppendBuffer(p, nal_length);
-
-						p += nal_length;
-
-						if((p - pbuf) >= pbuf_length)
-						{
-							break;
-						}
-
-						// logtd("nal_unit_type : %s", Nalu2Str( (AvcNaluType)((*p) & 0x1F) ).c_str());
-					}
-
-					data->Clear();
-					data->Append(tmp_buf->GetBuffer(), tmp_buf->GetBufferSize());
+					ConvertNalLengthToStartCode(data, fragmentation, is_hevc);
 					break;
 				}
 
@@ -295,38 +321,7 @@ void BitstreamToAnnexB::convert_to(const std::shared_ptr<ov::Data> &data, int64_
                                         static_cast<uint8_t>(*(pbuf + 3)) << 8 |
                                         static_cast<uint8_t>(*(pbuf + 4)));
 			// intra-frame
-			const uint8_t *p = pbuf + 5;
-
-			auto tmp_buf = std::make_shared<MediaFrame>();
-
-			while(true)
-			{
-				int32_t nal_length = static_cast<int32_t>(static_cast<uint8_t>(*(p)) << 24 |
-				                                          static_cast<uint8_t>(*(p + 1)) << 16 |
-				                                          static_cast<uint8_t>(*(p + 2)) << 8 |
-				                                          static_cast<uint8_t>(*(p + 3)));
-
-				// logte("nal_lengh = %d, pbuf_length = %d", nal_length, pbuf_length);
-
-				// skip length 32bit
-				p += 4;
-
-				// logtd("n
-				// al_unit_type : %s", Nalu2Str( (AvcNaluType)((*p) & 0x1F) ).c_str());
-
-				tmp_buf->AppendBuffer(start_code, 4);
-				tmp_buf->AppendBuffer(p, nal_length);
-
-				p += nal_length;
-
-				if((p - pbuf) >= pbuf_length)
-				{
-					break;
-				}
-			}
-
-			data->Clear();
-			data->Append(tmp_buf->GetBuffer(), tmp_buf->GetBufferSize());
+			ConvertNalLengthToStartCode(data, fragmentation, is_hevc);
 
 			break;
 		}
@@ -348,6 +343,85 @@ void BitstreamToAnnexB::convert_to(const std::shared_ptr<ov::Data> &data, int64_
 	}
 }
 
+bool BitstreamToAnnexB::ConvertNalLengthToStartCode(const std::shared_ptr<ov::Data> &data, FragmentationHeader *fragmentation, bool is_hevc)
+{
+	// FrameType/CodecID (1B) + AVCPacketType (1B) + CompositionTime (3B)
+	constexpr size_t video_tag_header_size = 5;
+	constexpr size_t nal_length_size = 4;
+	const uint8_t start_code[nal_length_size] = { 0x00, 0x00, 0x00, 0x01 };
+
+	auto buffer = data->GetWritableDataAs<uint8_t>();
+	size_t length = data->GetLength();
+	size_t offset = video_tag_header_size;
+	size_t fragment_count = 0;
+
+	if((buffer == nullptr) || (length < video_tag_header_size))
+	{
+		return false;
+	}
+
+	while((offset + nal_length_size) <= length)
+	{
+		size_t nal_length = static_cast<size_t>(buffer[offset]) << 24 |
+		                    static_cast<size_t>(buffer[offset + 1]) << 16 |
+		                    static_cast<size_t>(buffer[offset + 2]) << 8 |
+		                    static_cast<size_t>(buffer[offset + 3]);
+
+		if(nal_length > (length - offset - nal_length_size))
+		{
+			logtw("Invalid NAL length: %zu (remained: %zu)", nal_length, length - offset - nal_length_size);
+			break;
+		}
+
+		// The length and the start code have the same size, so the NAL unit does not need to be moved
+		::memcpy(buffer + offset, start_code, nal_length_size);
+
+		if(fragmentation != nullptr)
+		{
+			// The offsets are relative to the converted frame (after the video tag header is removed)
+			AddFragment(fragmentation, fragment_count, buffer + video_tag_header_size, offset - video_tag_header_size + nal_length_size, nal_length, is_hevc);
+		}
+
+		offset += nal_length_size + nal_length;
+	}
+
+	if(offset < length)
+	{
+		// Drop the incomplete NAL unit
+		data->SetLength(offset);
+	}
+
+	// The header becomes the headroom of the data
+	return data->TrimFront(video_tag_header_size);
+}
+
+void BitstreamToAnnexB::AddFragment(FragmentationHeader *fragmentation, size_t &count, const uint8_t *data, size_t offset, size_t length, bool is_hevc)
+{
+	count++;
+
+	if(count > MAX_FRAG_COUNT)
+	{
+		// Too many NAL units, the publishers find them from the start codes
+		fragmentation->fragmentation_vector_size = 0;
+		return;
+	}
+
+	fragmentation->fragmentation_offset[count - 1] = offset;
+	fragmentation->fragmentation_length[count - 1] = length;
+	if(length == 0)
+	{
+		fragmentation->fragmentation_pl_type[count - 1] = 0;
+	}
+	else
+	{
+		// H.264: forbidden_zero_bit(1) + nal_ref_idc(2) + nal_unit_type(5)
+		// HEVC: forbidden_zero_bit(1) + nal_unit_type(6) + nuh_layer_id(6) + nuh_temporal_id_plus1(3)
+		fragmentation->fragmentation_pl_type[count - 1] = is_hevc ? ((data[offset] >> 1) & 0x3F) : (data[offset] & 0x1F);
+	}
+
+	fragmentation->fragmentation_vector_size = static_cast<uint16_t>(count);
+}
+
 std::string BitstreamToAnnexB::Nalu2Str(AvcNaluType nalu_type)
 {
 	switch(nalu_type)
@@ -454,3 +528,110 @@ bool BitstreamToAnnexB::SequenceHeaderParsing(const uint8_t *data,
 
 	return true;
 }
+
+//====================================================================================================
+// HevcSequenceHeaderParsing
+// - FrameType/CodecID(1B) + AVCPacketType(1B) + CompositionTime(3B) + HEVCDecoderConfigurationRecord
+// - HEVCDecoderConfigurationRecord
+//      - configurationVersion, general_profile_space/tier_flag/profile_idc    - 2 byte
+//      - general_profile_compatibility_flags                                  - 4 byte
+//      - general_constraint_indicator_flags                                   - 6 byte
+//      - general_level_idc                                                    - 1 byte
+//      - min_spatial_segmentation_idc ~ lengthSizeMinusOne                    - 9 byte
+//      - numOfArrays                                                          - 1 byte
+//      - array_completeness/NAL_unit_type(1 byte) + numNalus(2 byte)
+//        + (nalUnitLength(2 byte) + nalUnit) * numNalus                       - * numOfArrays
+//====================================================================================================
+bool BitstreamToAnnexB::HevcSequenceHeaderParsing(const uint8_t *data,
+                                                  int data_size,
+                                                  std::vector<uint8_t> &vps,
+                                                  std::vector<uint8_t> &sps,
+                                                  std::vector<uint8_t> &pps,
+                                                  uint8_t &hevc_profile,
+                                                  uint8_t &hevc_level)
+{
+	// Video tag header(5) + fixed fields of the record(23)
+	constexpr int record_offset = 5;
+	constexpr int record_header_size = 23;
+
+	if(data_size < (record_offset + record_header_size))
+	{
+		logtw("Could not determine bit stream type");
+		return false;
+	}
+
+	int frame_type = data[0] >> 4 & 0x0f;
+	int codec_id = data[0] & 0x0f;
+	int packet_type = data[1];
+
+	if(frame_type != 1 || codec_id != 12 || packet_type != 0)
+	{
+		return false;
+	}
+
+	const uint8_t *end = data + data_size;
+	const uint8_t *record = data + record_offset;
+
+	logtd("configuration version = %d", record[0]);
+	hevc_profile = record[1] & 0x1F;
+	hevc_level = record[12];
+	logtd("lengthSizeMinusOne = %d", record[21] & 0x03);
+
+	int array_count = record[22];
+	data = record + record_header_size;
+
+	for(int array_index = 0; array_index < array_count; array_index++)
+	{
+		if((end - data) < 3)
+		{
+			return false;
+		}
+
+		int nal_type = data[0] & 0x3F;
+		int nal_count = data[1] << 8 | data[2];
+		data += 3;
+
+		for(int index = 0; index < nal_count; index++)
+		{
+			if((end - data) < 2)
+			{
+				return false;
+			}
+
+			int nal_size = data[0] << 8 | data[1];
+			data += 2;
+
+			if((end - data) < nal_size)
+			{
+				return false;
+			}
+
+			// Only the first parameter set of each type is used
+			std::vector<uint8_t> *parameter_set = nullptr;
+
+			switch(nal_type)
+			{
+				case HevcNaluTypeVPS:
+					parameter_set = &vps;
+					break;
+				case HevcNaluTypeSPS:
+					parameter_set = &sps;
+					break;
+				case HevcNaluTypePPS:
+					parameter_set = &pps;
+					break;
+				default:
+					break;
+			}
+
+			if((parameter_set != nullptr) && (index == 0))
+			{
+				parameter_set->assign(data, data + nal_size);
+			}
+
+			data += nal_size;
+		}
+	}
+
+	return (vps.empty() == false) && (sps.empty() == false) && (pps.empty() == false);
+}
@@ -11,6 +11,7 @@
 
 #include "base/media_route/media_buffer.h"
 #include "base/media_route/media_type.h"
+#include "base/common_types.h"
 #include <stdint.h>
 
 class BitstreamToAnnexB
@@ -57,12 +58,28 @@ public:
 	    AvcNaluTypeCodedSliceExt = 20,
 	};
 
+	enum HevcNaluType
+	{
+		// Coded slice of an IDR picture (with/without the leading pictures)
+		HevcNaluTypeIDR_W_RADL = 19,
+		HevcNaluTypeIDR_N_LP = 20,
+		// Video parameter set
+		HevcNaluTypeVPS = 32,
+		// Sequence parameter set
+		HevcNaluTypeSPS = 33,
+		// Picture parameter set
+		HevcNaluTypePPS = 34,
+		// Access unit delimiter
+		HevcNaluTypeAccessUnitDelimiter = 35,
+	};
+
 	std::string Nalu2Str(AvcNaluType nalu_type);
 public:
     BitstreamToAnnexB();
     ~BitstreamToAnnexB();
 
-	void convert_to(const std::shared_ptr<ov::Data> &data, int64_t &cts);
+	// fragmentation: NAL units of the converted frame (fragmentation_vector_size is 0 if there are more than MAX_FRAG_COUNT)
+	void convert_to(const std::shared_ptr<ov::Data> &data, int64_t &cts, FragmentationHeader *fragmentation = nullptr);
  	static bool SequenceHeaderParsing(const uint8_t *data,
                                         int data_size,
                                         std::vector<uint8_t> &_sps,
@@ -71,8 +88,23 @@ public:
                                         uint8_t &avc_profile_compatibility,
                                         uint8_t &avc_level);
 
+	// Parses the HEVCDecoderConfigurationRecord of the sequence header (ISO/IEC 14496-15 8.3.3.1)
+	static bool HevcSequenceHeaderParsing(const uint8_t *data,
+	                                      int data_size,
+	                                      std::vector<uint8_t> &vps,
+	                                      std::vector<uint8_t> &sps,
+	                                      std::vector<uint8_t> &pps,
+	                                      uint8_t &hevc_profile,
+	                                      uint8_t &hevc_level);
+
 private:
+	// Replaces the NAL length fields (4 bytes) with the start codes in place, and removes the FLV video tag header
+	// - The NAL units are indexed from the length fields while converting, so nobody needs to scan the start codes
+	static bool ConvertNalLengthToStartCode(const std::shared_ptr<ov::Data> &data, FragmentationHeader *fragmentation, bool is_hevc);
+
+	static void AddFragment(FragmentationHeader *fragmentation, size_t &count, const uint8_t *data, size_t offset, size_t length, bool is_hevc);
 
+	std::vector<uint8_t> 	_vps;
 	std::vector<uint8_t> 	_sps;
 	std::vector<uint8_t> 	_pps;
 };
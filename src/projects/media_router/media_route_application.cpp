@@ -8,7 +8,10 @@
 //==============================================================================
 #include "media_route_application.h"
 
+#include <base/application/stream_demand.h>
 #include <base/application/stream_info.h>
+#include <base/application/stream_latency.h>
+#include <base/application/stream_qoe.h>
 #include <relay/relay.h>
 
 #define OV_LOG_TAG "MediaRouter.App"
@@ -35,16 +38,35 @@ MediaRouteApplication::~MediaRouteApplication()
 
 bool MediaRouteApplication::Start()
 {
-	try
+	int worker_count = _application_info->GetRouterWorkerCount();
+
+	if(worker_count <= 0)
 	{
-		_kill_flag = false;
-		_thread = std::thread(&MediaRouteApplication::MainTask, this);
+		worker_count = static_cast<int>(std::thread::hardware_concurrency());
 	}
-	catch(const std::system_error &e)
+
+	worker_count = std::max(1, std::min(worker_count, MEDIA_ROUTE_MAX_WORKER_COUNT));
+
+	_kill_flag = false;
+
+	for(int index = 0; index < worker_count; index++)
 	{
-		_kill_flag = true;
-		logte("Failed to start media route application thread.");
-		return false;
+		auto worker = std::make_unique<Worker>();
+
+		worker->_indicator.SetAlias(ov::String::FormatString("%s/indicator#%d", _application_info->GetName().CStr(), index));
+
+		try
+		{
+			worker->_thread = std::thread(&MediaRouteApplication::MainTask, this, worker.get());
+		}
+		catch(const std::system_error &e)
+		{
+			logte("Failed to start media route application thread (%d)", index);
+			Stop();
+			return false;
+		}
+
+		_workers.push_back(std::move(worker));
 	}
 
 	switch(_application_info->GetType())
@@ -58,8 +80,11 @@ bool MediaRouteApplication::Start()
 
 		case cfg::ApplicationType::LiveEdge:
 		{
+			// The edge also re-exports the pulled streams to the downstream edges (origin -> mid-tier edge -> edge)
 			_relay_server = std::make_shared<RelayServer>(this, _application_info);
 
+			RegisterObserverApp(_relay_server);
+
 			auto &origin = _application_info->GetOrigin();
 
 			if(origin.IsParsed())
@@ -79,18 +104,52 @@ bool MediaRouteApplication::Start()
 			break;
 	}
 
-	logtd("started media route application thread. application(%s)", _application_info->GetName().CStr());
+	_gc_queue.Start();
+
+	ov::MemoryGovernor::Instance()->AddShedder(this);
+
+	logtd("started media route application thread. application(%s), workers(%d)", _application_info->GetName().CStr(), worker_count);
 	return true;
 }
 
 bool MediaRouteApplication::Stop()
 {
+	ov::MemoryGovernor::Instance()->RemoveShedder(this);
+
+	GetStreamRegistry()->streams.ForEach([](uint32_t stream_id, const std::shared_ptr<MediaRouteStream> &stream) {
+		ov::SharedTimerWheel::Instance()->Cancel(stream->GetGarbageCollectorTimerId());
+		ov::SharedTimerWheel::Instance()->Cancel(stream->GetReconnectTimerId());
+	});
+
+	_gc_queue.Stop();
+
 	_kill_flag = true;
-	_thread.join();
+
+	for(auto &worker : _workers)
+	{
+		worker->_indicator.abort();
+
+		if(worker->_thread.joinable())
+		{
+			worker->_thread.join();
+		}
+	}
+
+	_workers.clear();
 
 	return true;
 }
 
+MediaRouteApplication::Worker *MediaRouteApplication::GetWorkerByStreamId(uint32_t stream_id)
+{
+	if(_workers.empty())
+	{
+		return nullptr;
+	}
+
+	return _workers[stream_id % _workers.size()].get();
+}
+
 // 어플리케이션의 스트림이 생성됨
 bool MediaRouteApplication::RegisterConnectorApp(
 	std::shared_ptr<MediaRouteApplicationConnector> app_conn)
@@ -106,7 +165,9 @@ bool MediaRouteApplication::RegisterConnectorApp(
 
 	app_conn->SetMediaRouterApplication(GetSharedPtr());
 
-	_connectors.push_back(app_conn);
+	auto connectors = std::make_shared<ConnectorList>(*GetConnectors());
+	connectors->push_back(app_conn);
+	std::atomic_store(&_connectors, std::shared_ptr<const ConnectorList>(connectors));
 
 	return true;
 }
@@ -124,14 +185,18 @@ bool MediaRouteApplication::UnregisterConnectorApp(
 	logtd("Unregister application connector. application(%s/%p) connector_type(%d)", _application_info->GetName().CStr(), app_conn.get(), app_conn->GetConnectorType());
 
 	// 삭제
-	auto position = std::find(_connectors.begin(), _connectors.end(), app_conn);
-	if(position == _connectors.end())
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	auto connectors = std::make_shared<ConnectorList>(*GetConnectors());
+	auto position = std::find(connectors->begin(), connectors->end(), app_conn);
+	if(position == connectors->end())
 	{
 		return true;
 	}
 
-	std::unique_lock<std::mutex> lock(_mutex);
-	_connectors.erase(position);
+	connectors->erase(position);
+	std::atomic_store(&_connectors, std::shared_ptr<const ConnectorList>(connectors));
+
 	lock.unlock();
 
 	return true;
@@ -150,9 +215,16 @@ bool MediaRouteApplication::RegisterObserverApp(
 	logtd("Register application observer. application(%s/%p) observer_type(%d)", _application_info->GetName().CStr(), app_obsrv.get(), app_obsrv->GetObserverType());
 
 	std::unique_lock<std::mutex> lock(_mutex);
-	_observers.push_back(app_obsrv);
+
+	// The readers keep iterating the old list until they load the list again
+	auto observers = std::make_shared<ObserverList>(*GetObservers());
+	observers->push_back(app_obsrv);
+	std::atomic_store(&_observers, std::shared_ptr<const ObserverList>(observers));
+
 	lock.unlock();
 
+	app_obsrv->SetMediaRouteApplication(GetSharedPtr());
+
 	return true;
 }
 
@@ -167,17 +239,54 @@ bool MediaRouteApplication::UnregisterObserverApp(
 
 	logtd("Unregister application observer. application(%s/%p) observer_type(%d)", _application_info->GetName().CStr(), app_obsrv.get(), app_obsrv->GetObserverType());
 
-	auto position = std::find(_observers.begin(), _observers.end(), app_obsrv);
-	if(position == _observers.end())
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	auto observers = std::make_shared<ObserverList>(*GetObservers());
+	auto position = std::find(observers->begin(), observers->end(), app_obsrv);
+	if(position == observers->end())
 	{
 		return true;
 	}
 
-	_observers.erase(position);
+	observers->erase(position);
+	std::atomic_store(&_observers, std::shared_ptr<const ObserverList>(observers));
+
+	lock.unlock();
+
+	app_obsrv->SetMediaRouteApplication(nullptr);
 
 	return true;
 }
 
+void MediaRouteApplication::GetRelayStatisticsData(
+	std::vector<std::shared_ptr<RelayLinkStatisticsData>> &links,
+	std::vector<std::shared_ptr<RelayStreamStatisticsData>> &streams)
+{
+	if(_relay_server != nullptr)
+	{
+		_relay_server->GetStatisticsData(links);
+	}
+
+	if(_relay_client != nullptr)
+	{
+		_relay_client->GetStatisticsData(links, streams);
+	}
+}
+
+void MediaRouteApplication::GetStreamMetricsData(std::vector<std::shared_ptr<MediaRouteStreamMetricsData>> &streams) const
+{
+	GetStreamRegistry()->streams.ForEach([this, &streams](uint32_t stream_id, const std::shared_ptr<MediaRouteStream> &stream) {
+		auto metrics_data = std::make_shared<MediaRouteStreamMetricsData>();
+
+		metrics_data->app_name = _application_info->GetName();
+		metrics_data->stream_name = stream->GetStreamInfo()->GetName();
+		metrics_data->connector_type = stream->GetConnectorType();
+		metrics_data->metrics = stream->GetMetrics();
+
+		streams.push_back(metrics_data);
+	});
+}
+
 bool MediaRouteApplication::OnCreateStream(
 	std::shared_ptr<MediaRouteApplicationConnector> app_conn,
 	std::shared_ptr<StreamInfo> stream_info)
@@ -188,20 +297,50 @@ bool MediaRouteApplication::OnCreateStream(
 		return false;
 	}
 
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	auto registry = GetStreamRegistry();
+
 	// 동일한 스트림명 Reconnect 되는 경우 처리함.
 	// 기존에 사용하던 Stream의 ID를 재사용한다
 	if(app_conn->GetConnectorType() == MediaRouteApplicationConnector::ConnectorType::Provider)
 	{
-		for(auto it = _streams.begin(); it != _streams.end(); ++it)
+		auto item = registry->streams_by_name.Find(stream_info->GetName());
+
+		if(item != nullptr)
 		{
-			auto istream = it->second;
+			auto istream = *item;
+			bool is_disconnected = (istream->GetDisconnectedTime() != 0);
+
+			if(is_disconnected && (IsSameTracks(istream->GetStreamInfo(), stream_info) == false))
+			{
+				// The publishers can't continue the packetizers with the new codecs, so the stream is created again
+				logti("The tracks of the stream are changed by the reconnection, the stream is created again. application(%s) stream(%s/%u)",
+				      _application_info->GetName().CStr(), stream_info->GetName().CStr(), istream->GetStreamInfo()->GetId());
+
+				RemoveStream(istream->GetStreamInfo()->GetId());
+				lock.unlock();
 
-			if(stream_info->GetName() == istream->GetStreamInfo()->GetName())
+				DeleteProviderStream(istream->GetStreamInfo());
+
+				lock.lock();
+				registry = GetStreamRegistry();
+			}
+			else
 			{
+				if(is_disconnected)
+				{
+					ov::SharedTimerWheel::Instance()->Cancel(istream->GetReconnectTimerId());
+					istream->SetDisconnected(0, 0);
+					istream->SetConnector(app_conn);
+				}
+
 				// 기존에 사용하던 ID를 재사용
 				stream_info->SetId(istream->GetStreamInfo()->GetId());
 				logtw("Reconnected same stream from provider(%s, %d)", stream_info->GetName().CStr(), stream_info->GetId());
 
+				istream->RebaseTimestamps();
+
 				return true;
 			}
 		}
@@ -210,21 +349,41 @@ bool MediaRouteApplication::OnCreateStream(
 
 	logtd("Created stream from connector. connector_type(%d), application(%s) stream(%s/%u)", app_conn->GetConnectorType(), _application_info->GetName().CStr(), stream_info->GetName().CStr(), stream_info->GetId());
 
-	std::unique_lock<std::mutex> lock(_mutex);
-
 	auto new_stream_info = std::make_shared<StreamInfo>(*stream_info);
 	auto new_stream = std::make_shared<MediaRouteStream>(new_stream_info);
 
 	new_stream->SetConnectorType(app_conn->GetConnectorType());
+	new_stream->SetConnector(app_conn);
+	new_stream->SetLatencyStatistics(StreamLatency::Instance()->GetStatistics(_application_info->GetId(), _application_info->GetName(), new_stream_info->GetName()));
+
+	if(app_conn->GetConnectorType() == MediaRouteApplicationConnector::ConnectorType::Provider)
+	{
+		new_stream->SetCapture(CreateCapture(new_stream_info));
+	}
 
-	_streams.insert(
-		std::make_pair(new_stream_info->GetId(), new_stream)
-	);
+	// Only the packets from the providers (encoders) are reordered
+	auto &jitter_buffer_config = _application_info->GetProviders().GetJitterBuffer();
+	if((app_conn->GetConnectorType() == MediaRouteApplicationConnector::ConnectorType::Provider) && jitter_buffer_config.IsEnabled())
+	{
+		new_stream->EnableJitterBuffer(jitter_buffer_config.GetLatency(), jitter_buffer_config.GetDriftThreshold());
+	}
+
+	auto new_registry = std::make_shared<StreamRegistry>(*registry);
+
+	new_registry->streams.Insert(new_stream_info->GetId(), new_stream);
+	new_registry->streams_by_name.Insert(new_stream_info->GetName(), new_stream);
+
+	std::atomic_store(&_stream_registry, std::shared_ptr<const StreamRegistry>(new_registry));
 
 	lock.unlock();
 
+	if(app_conn->GetConnectorType() == MediaRouteApplicationConnector::ConnectorType::Provider)
+	{
+		ArmGarbageCollector(new_stream);
+	}
+
 	// 옵저버에 스트림 생성을 알림
-	for(auto observer : _observers)
+	for(auto observer : *GetObservers())
 	{
 		if(
 			// Provider -> MediaRoute -> Transcoder
@@ -252,8 +411,13 @@ bool MediaRouteApplication::OnCreateStream(
 		}
 		else if(
 			// RelayClient -> MediaRoute -> Publisher
+			// or
+			// RelayClient -> MediaRoute -> Relay (downstream edges)
 			(app_conn->GetConnectorType() == MediaRouteApplicationConnector::ConnectorType::Relay) &&
-			(observer->GetObserverType() == MediaRouteApplicationObserver::ObserverType::Publisher)
+			(
+				(observer->GetObserverType() == MediaRouteApplicationObserver::ObserverType::Publisher) ||
+				(observer->GetObserverType() == MediaRouteApplicationObserver::ObserverType::Relay)
+			)
 			)
 		{
 			observer->OnCreateStream(new_stream->GetStreamInfo());
@@ -275,10 +439,29 @@ bool MediaRouteApplication::OnDeleteStream(
 
 	logtd("Deleted stream from connector. connector_type(%d), application(%s) stream(%s/%u)", app_conn->GetConnectorType(), _application_info->GetName().CStr(), stream_info->GetName().CStr(), stream_info->GetId());
 
+	{
+		std::lock_guard<std::mutex> lock_guard(_shed_mutex);
+
+		// The observers have already deleted the stream when it is shed
+		if(_shed_stream_ids.erase(stream_info->GetId()) > 0)
+		{
+			return true;
+		}
+	}
+
+	if((app_conn->GetConnectorType() == MediaRouteApplicationConnector::ConnectorType::Provider) &&
+	   _application_info->GetProviders().GetReconnect().IsEnabled() &&
+	   WaitForReconnect(stream_info))
+	{
+		return true;
+	}
+
 	auto new_stream_info = std::make_shared<StreamInfo>(*stream_info);
 
 	// 옵저버에 스트림 삭제를 알림
-	for(auto it = _observers.begin(); it != _observers.end(); ++it)
+	auto observers = GetObservers();
+
+	for(auto it = observers->begin(); it != observers->end(); ++it)
 	{
 		auto observer = *it;
 
@@ -306,7 +489,8 @@ bool MediaRouteApplication::OnDeleteStream(
 			(app_conn->GetConnectorType() == MediaRouteApplicationConnector::ConnectorType::Relay) &&
 			(
 				(observer->GetObserverType() == MediaRouteApplicationObserver::ObserverType::Transcoder) ||
-				(observer->GetObserverType() == MediaRouteApplicationObserver::ObserverType::Publisher)
+				(observer->GetObserverType() == MediaRouteApplicationObserver::ObserverType::Publisher) ||
+				(observer->GetObserverType() == MediaRouteApplicationObserver::ObserverType::Relay)
 			)
 			)
 		{
@@ -315,12 +499,77 @@ bool MediaRouteApplication::OnDeleteStream(
 	}
 
 	std::unique_lock<std::mutex> lock(_mutex);
-	_streams.erase(new_stream_info->GetId());
+	RemoveStream(new_stream_info->GetId());
 	lock.unlock();
 
 	return true;
 }
 
+std::shared_ptr<const MediaRouteApplication::StreamRegistry> MediaRouteApplication::GetStreamRegistry() const
+{
+	return std::atomic_load(&_stream_registry);
+}
+
+void MediaRouteApplication::RemoveStream(uint32_t stream_id)
+{
+	auto registry = GetStreamRegistry();
+	auto item = registry->streams.Find(stream_id);
+
+	if(item == nullptr)
+	{
+		return;
+	}
+
+	auto stream = *item;
+	auto new_registry = std::make_shared<StreamRegistry>(*registry);
+
+	// The timer doesn't acquire _mutex, so it can be cancelled here
+	ov::SharedTimerWheel::Instance()->Cancel(stream->GetGarbageCollectorTimerId());
+	stream->SetGarbageCollectorTimerId(0);
+	ov::SharedTimerWheel::Instance()->Cancel(stream->GetReconnectTimerId());
+	stream->SetDisconnected(0, 0);
+
+	new_registry->streams.Erase(stream_id);
+
+	auto name = stream->GetStreamInfo()->GetName();
+	auto name_item = new_registry->streams_by_name.Find(name);
+
+	// The name may be used by another stream which is created later
+	if((name_item != nullptr) && (*name_item == stream))
+	{
+		new_registry->streams_by_name.Erase(name);
+
+		StreamLatency::Instance()->RemoveStatistics(_application_info->GetId(), name);
+		StreamQoe::Instance()->RemoveStatistics(_application_info->GetName(), name);
+	}
+
+	std::atomic_store(&_stream_registry, std::shared_ptr<const StreamRegistry>(new_registry));
+}
+
+const std::map<uint32_t, std::shared_ptr<MediaRouteStream>> MediaRouteApplication::GetStreams() const
+{
+	std::map<uint32_t, std::shared_ptr<MediaRouteStream>> streams;
+
+	GetStreamRegistry()->streams.ForEach([&streams](uint32_t stream_id, const std::shared_ptr<MediaRouteStream> &stream) {
+		streams[stream_id] = stream;
+	});
+
+	return streams;
+}
+
+std::shared_ptr<MediaRouteStream> MediaRouteApplication::GetStream(uint32_t stream_id) const
+{
+	auto registry = GetStreamRegistry();
+	auto item = registry->streams.Find(stream_id);
+
+	return (item != nullptr) ? *item : nullptr;
+}
+
+size_t MediaRouteApplication::GetStreamCount() const
+{
+	return GetStreamRegistry()->streams.GetCount();
+}
+
 
 // 프로바이더에서 인코딩된 데이터가 들어옴
 // @from RtmpProvider
@@ -336,20 +585,27 @@ bool MediaRouteApplication::OnReceiveBuffer(
 	}
 
 	// 스트림 ID에 해당하는 스트림을 탐색
-	auto stream_bucket = _streams.find(stream_info->GetId());
-	if(stream_bucket == _streams.end())
+	// The providers (e.g. the ingest threads of RTMP) create/delete the streams while the others are pushing (the snapshot is not locked)
+	auto stream = GetStream(stream_info->GetId());
+	if(stream == nullptr)
 	{
+		if(IsShedStream(stream_info->GetId()))
+		{
+			// Discarded silently until the provider deletes it
+			return false;
+		}
+
 		logte("cannot find stream from router. appication(%s), stream(%s)", _application_info->GetName().CStr(), stream_info->GetName().CStr());
 
 		return false;
 	}
 
-	auto stream = stream_bucket->second;
-	if(stream == nullptr)
-	{
-		logte("invalid stream bucket");
+	auto &capture = stream->GetCapture();
 
-		return false;
+	if(capture != nullptr)
+	{
+		// As it is received (the replay is converted again)
+		capture->Write(*packet);
 	}
 
 	bool convert_bitstream = app_conn->GetConnectorType() != MediaRouteApplicationConnector::ConnectorType::Relay;
@@ -359,100 +615,449 @@ bool MediaRouteApplication::OnReceiveBuffer(
 	// TODO(SOULK) : Connector(Provider, Transcoder)에서 수신된 데이터에 대한 정보를 바로 처리하기 위해 버퍼의 Indicator 정보를
 	// MainTask에 전달한다. 패킷이 수신되어 처리(재분배)되는 속도가 0.001초 이하의 초저지연으로 동작하나, 효율적인 구조는 
 	// 아닌것으로 판단되므로, 향후에 개선이 필요하다
-	_indicator.push(std::make_unique<BufferIndicator>(
-		stream_info->GetId()
-	));
+	auto worker = GetWorkerByStreamId(stream_info->GetId());
+
+	if(worker != nullptr)
+	{
+		worker->_indicator.push(std::make_unique<BufferIndicator>(
+			stream_info->GetId()
+		));
+	}
 
 	return ret;
 }
 
 
-void MediaRouteApplication::OnGarbageCollector()
+bool MediaRouteApplication::OnRequestKeyFrame(uint32_t stream_id, int32_t track_id)
 {
-	_indicator.push(std::make_unique<BufferIndicator>(
-		BUFFFER_INDICATOR_UNIQUEID_GC // 가비지 컬렉터를 실행
-	));
+	auto stream = GetStream(stream_id);
+
+	if(stream == nullptr)
+	{
+		return false;
+	}
+
+	if(stream->AcceptKeyFrameRequest(track_id) == false)
+	{
+		// Coalesced with the previous request
+		return true;
+	}
+
+	auto connector = stream->GetConnector();
+
+	if(connector == nullptr)
+	{
+		return false;
+	}
+
+	auto stream_info = stream->GetStreamInfo();
+
+	if(connector->OnKeyFrameRequested(stream_info, track_id) == false)
+	{
+		logtd("The connector(%d) cannot make a key frame. application(%s) stream(%s/%u) track(%d)",
+		      connector->GetConnectorType(), _application_info->GetName().CStr(), stream_info->GetName().CStr(), stream_id, track_id);
+		return false;
+	}
+
+	logtd("Key frame is requested. application(%s) stream(%s/%u) track(%d)", _application_info->GetName().CStr(), stream_info->GetName().CStr(), stream_id, track_id);
+
+	return true;
+}
+
+void MediaRouteApplication::ArmGarbageCollector(const std::shared_ptr<MediaRouteStream> &stream)
+{
+#if DEBUG
+	// debug 빌드 되었을 경우 stream 삭제 기능 동작 안하게 함
+#else // DEBUG
+	std::weak_ptr<MediaRouteApplication> weak_application = GetSharedPtrAs<MediaRouteApplication>();
+	std::weak_ptr<MediaRouteStream> weak_stream = stream;
+
+	auto timer_id = ov::SharedTimerWheel::Instance()->Schedule(TIMEOUT_STREAM_ALIVE * 1000, [weak_application, weak_stream]() -> int64_t {
+		auto application = weak_application.lock();
+		auto stream = weak_stream.lock();
+
+		if((application == nullptr) || (stream == nullptr))
+		{
+			return 0;
+		}
+
+		time_t curr_time;
+		time(&curr_time);
+
+		double diff_time = difftime(curr_time, stream->getLastReceivedTime());
+
+		if(diff_time <= TIMEOUT_STREAM_ALIVE)
+		{
+			// The stream received the packets after the timer is armed, wait for the rest of the timeout
+			return static_cast<int64_t>((TIMEOUT_STREAM_ALIVE - diff_time) * 1000.0) + 1000;
+		}
+
+		// The observers are called by _gc_queue, so neither the wheel nor the router threads are blocked
+		application->_gc_queue.Push([weak_application, stream](void *parameter) -> bool {
+			auto application = weak_application.lock();
+
+			if(application != nullptr)
+			{
+				application->GarbageCollector(stream);
+			}
+
+			return false;
+		}, 0);
+
+		return 0;
+	});
+
+	stream->SetGarbageCollectorTimerId(timer_id);
+#endif // DEBUG
 }
 
 // 스트림 객제중에 데이터가 수신되지 않은 스트림은 N초후에 자동 삭제를 진행함.
-void MediaRouteApplication::GarbageCollector()
+void MediaRouteApplication::GarbageCollector(const std::shared_ptr<MediaRouteStream> &stream)
 {
+	auto stream_info = stream->GetStreamInfo();
+
+	// The stream may be deleted by the provider (or replaced) while it is waiting for _gc_queue
+	if(GetStream(stream_info->GetId()) != stream)
+	{
+		return;
+	}
+
 	time_t curr_time;
 	time(&curr_time);
 
-	for(auto it = _streams.begin(); it != _streams.end(); ++it)
+	double diff_time = difftime(curr_time, stream->getLastReceivedTime());
+
+	if(diff_time <= TIMEOUT_STREAM_ALIVE)
 	{
-		auto stream = (*it).second;
+		// Reconnected (the provider reuses the stream id) before it is deleted
+		ArmGarbageCollector(stream);
+		return;
+	}
 
-		MediaRouteApplicationConnector::ConnectorType connector_type = stream->GetConnectorType();
-		if(connector_type == MediaRouteApplicationConnector::ConnectorType::Provider)
+	// Streams that do not receive data are automatically deleted after 30 seconds.
+	logti("%s(%u) will delete the stream. diff time(%.0f)",
+	      stream_info->GetName().CStr(),
+	      stream_info->GetId(),
+	      diff_time);
+
+	for(auto observer : *GetObservers())
+	{
+		if(observer->GetObserverType() == MediaRouteApplicationObserver::ObserverType::Transcoder)
 		{
-			double diff_time;
+			observer->OnDeleteStream(stream_info);
+		}
+	}
 
-			diff_time = difftime(curr_time, stream->getLastReceivedTime());
+	std::unique_lock<std::mutex> lock(_mutex);
+	RemoveStream(stream_info->GetId());
+	lock.unlock();
+}
 
-			// TODO(soulk) 삭제 Treshold 값은 설정서 읽어오도록 수정해야함.
-			// Observer 에게 삭제 메세지를 전달하는 구조도 비효율적임. 레이스컨디션 발생 가능성 있음.
-#if DEBUG
-			// debug 빌드 되었을 경우 stream 삭제 기능 동작 안하게 함
-#else // DEBUG
+bool MediaRouteApplication::WaitForReconnect(const std::shared_ptr<StreamInfo> &stream_info)
+{
+	int timeout = _application_info->GetProviders().GetReconnect().GetTimeout();
+
+	if(timeout <= 0)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock_guard(_mutex);
 
-            // Streams that do not receive data are automatically deleted after 30 seconds.
-            if (diff_time > TIMEOUT_STREAM_ALIVE)
+	auto stream = GetStream(stream_info->GetId());
+
+	if((stream == nullptr) || (stream->GetConnectorType() != MediaRouteApplicationConnector::ConnectorType::Provider))
+	{
+		return false;
+	}
+
+	std::weak_ptr<MediaRouteApplication> weak_application = GetSharedPtrAs<MediaRouteApplication>();
+	std::weak_ptr<MediaRouteStream> weak_stream = stream;
+
+	auto timer_id = ov::SharedTimerWheel::Instance()->Schedule(timeout, [weak_application, weak_stream]() -> int64_t {
+		auto application = weak_application.lock();
+		auto stream = weak_stream.lock();
+
+		if((application == nullptr) || (stream == nullptr))
+		{
+			return 0;
+		}
+
+		// Same as ArmGarbageCollector()
+		application->_gc_queue.Push([weak_application, stream](void *parameter) -> bool {
+			auto application = weak_application.lock();
+
+			if(application != nullptr)
 			{
-				logti("%s(%u) will delete the stream. diff time(%.0f)",
-					  stream->GetStreamInfo()->GetName().CStr(),
-					  stream->GetStreamInfo()->GetId(),
-					  diff_time);
+				application->DeleteDisconnectedStream(stream);
+			}
 
-				for(auto observer : _observers)
-				{
-					if(observer->GetObserverType() == MediaRouteApplicationObserver::ObserverType::Transcoder)
-					{
-						observer->OnDeleteStream(stream->GetStreamInfo());
-					}
-				}
+			return false;
+		}, 0);
 
-				std::unique_lock<std::mutex> lock(_mutex);
-				_streams.erase(stream->GetStreamInfo()->GetId());
-				lock.unlock();
+		return 0;
+	});
+
+	int64_t current_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	stream->SetDisconnected(current_time, timer_id);
+
+	logti("The provider of the stream is disconnected, waiting %d ms for the reconnection. application(%s) stream(%s/%u)",
+	      timeout, _application_info->GetName().CStr(), stream_info->GetName().CStr(), stream_info->GetId());
+
+	return true;
+}
 
-				// 비효율적임
-				it = _streams.begin();
+void MediaRouteApplication::DeleteDisconnectedStream(const std::shared_ptr<MediaRouteStream> &stream)
+{
+	auto stream_info = stream->GetStreamInfo();
+	int64_t current_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		int64_t disconnected_time = stream->GetDisconnectedTime();
+
+		// Reconnected (or disconnected again, then the timer of the last disconnection deletes it)
+		if((GetStream(stream_info->GetId()) != stream) || (disconnected_time == 0) ||
+		   ((current_time - disconnected_time) < _application_info->GetProviders().GetReconnect().GetTimeout()))
+		{
+			return;
+		}
+
+		// Removed first, so the reconnection creates a new stream while the observers are deleting it
+		RemoveStream(stream_info->GetId());
+	}
+
+	logti("The provider of the stream is not reconnected, the stream is deleted. application(%s) stream(%s/%u)",
+	      _application_info->GetName().CStr(), stream_info->GetName().CStr(), stream_info->GetId());
+
+	DeleteProviderStream(stream_info);
+}
+
+void MediaRouteApplication::DeleteProviderStream(const std::shared_ptr<StreamInfo> &stream_info)
+{
+	for(auto observer : *GetObservers())
+	{
+		if(
+			(observer->GetObserverType() == MediaRouteApplicationObserver::ObserverType::Transcoder) ||
+			(observer->GetObserverType() == MediaRouteApplicationObserver::ObserverType::Relay)
+			)
+		{
+			observer->OnDeleteStream(stream_info);
+		}
+	}
+}
+
+bool MediaRouteApplication::IsSameTracks(const std::shared_ptr<StreamInfo> &stream_info, const std::shared_ptr<StreamInfo> &new_stream_info)
+{
+	auto &tracks = stream_info->GetTracks();
+	auto &new_tracks = new_stream_info->GetTracks();
+
+	if(tracks.size() != new_tracks.size())
+	{
+		return false;
+	}
+
+	for(auto &item : tracks)
+	{
+		auto new_item = new_tracks.find(item.first);
+
+		if(new_item == new_tracks.end())
+		{
+			return false;
+		}
+
+		auto &track = item.second;
+		auto &new_track = new_item->second;
+
+		if((track->GetMediaType() != new_track->GetMediaType()) ||
+		   (track->GetCodecId() != new_track->GetCodecId()) ||
+		   (track->GetTimeBase().GetNum() != new_track->GetTimeBase().GetNum()) ||
+		   (track->GetTimeBase().GetDen() != new_track->GetTimeBase().GetDen()))
+		{
+			return false;
+		}
+
+		if(track->GetMediaType() == MediaType::Video)
+		{
+			if((track->GetWidth() != new_track->GetWidth()) || (track->GetHeight() != new_track->GetHeight()))
+			{
+				return false;
 			}
-#endif // DEBUG
 		}
+		else if(track->GetMediaType() == MediaType::Audio)
+		{
+			if((track->GetSampleRate() != new_track->GetSampleRate()) ||
+			   (track->GetChannel().GetLayout() != new_track->GetChannel().GetLayout()))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+std::shared_ptr<StreamCaptureWriter> MediaRouteApplication::CreateCapture(const std::shared_ptr<StreamInfo> &stream_info) const
+{
+	auto &capture = _application_info->GetProviders().GetCapture();
+
+	if((capture.IsParsed() == false) || capture.GetPath().IsEmpty())
+	{
+		return nullptr;
+	}
+
+	auto streams = capture.GetStreams();
+
+	if(streams.IsEmpty() == false)
+	{
+		auto names = streams.Split(",");
+
+		if(std::none_of(names.begin(), names.end(), [&](const ov::String &name) -> bool { return name.Trim() == stream_info->GetName(); }))
+		{
+			return nullptr;
+		}
+	}
+
+	if(ov::PathManager::MakeDirectory(capture.GetPath().CStr()) == false)
+	{
+		logte("Could not create the directory of the capture: %s", capture.GetPath().CStr());
+		return nullptr;
+	}
+
+	char time_buffer[32];
+	time_t now = ::time(nullptr);
+	struct tm now_tm {};
+
+	::localtime_r(&now, &now_tm);
+	::strftime(time_buffer, sizeof(time_buffer), "%Y%m%d-%H%M%S", &now_tm);
+
+	auto path = ov::PathManager::Combine(capture.GetPath(), ov::String::FormatString("%s_%s_%s.ovcap", _application_info->GetName().CStr(), stream_info->GetName().CStr(), time_buffer));
+	auto writer = StreamCaptureWriter::Create(path, stream_info, static_cast<uint64_t>(std::max(capture.GetMaxSize(), 0)) * 1024ULL * 1024ULL);
+
+	if(writer != nullptr)
+	{
+		logti("The stream %s/%s is captured to %s", _application_info->GetName().CStr(), stream_info->GetName().CStr(), path.CStr());
 	}
+
+	return writer;
+}
+
+bool MediaRouteApplication::IsShedStream(uint32_t stream_id)
+{
+	std::lock_guard<std::mutex> lock_guard(_shed_mutex);
+
+	return _shed_stream_ids.find(stream_id) != _shed_stream_ids.end();
+}
+
+bool MediaRouteApplication::GetShedCandidate(size_t *session_count)
+{
+	std::shared_ptr<MediaRouteStream> candidate = nullptr;
+	size_t candidate_session_count = 0;
+
+	GetStreamRegistry()->streams.ForEach([&](uint32_t stream_id, const std::shared_ptr<MediaRouteStream> &stream) {
+		// The output streams of the transcoder are deleted with the input stream
+		if(stream->GetConnectorType() != MediaRouteApplicationConnector::ConnectorType::Provider)
+		{
+			return;
+		}
+
+		size_t count = StreamDemand::Instance()->GetInputSessionCount(_application_info->GetId(), stream->GetStreamInfo()->GetName());
+
+		if((candidate == nullptr) || (count < candidate_session_count))
+		{
+			candidate = stream;
+			candidate_session_count = count;
+		}
+	});
+
+	std::lock_guard<std::mutex> lock_guard(_shed_mutex);
+
+	_shed_candidate = candidate;
+
+	if(candidate == nullptr)
+	{
+		return false;
+	}
+
+	*session_count = candidate_session_count;
+
+	return true;
+}
+
+bool MediaRouteApplication::ShedStream()
+{
+	std::shared_ptr<MediaRouteStream> stream;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_shed_mutex);
+
+		stream = _shed_candidate.lock();
+		_shed_candidate.reset();
+	}
+
+	if(stream == nullptr)
+	{
+		return false;
+	}
+
+	auto stream_info = stream->GetStreamInfo();
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		// Deleted by the provider (or replaced) after it is selected
+		if(GetStream(stream_info->GetId()) != stream)
+		{
+			return false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock_guard(_shed_mutex);
+			_shed_stream_ids.insert(stream_info->GetId());
+		}
+
+		RemoveStream(stream_info->GetId());
+	}
+
+	logtw("%s/%s(%u) is dropped by the memory governor", _application_info->GetName().CStr(), stream_info->GetName().CStr(), stream_info->GetId());
+
+	// The same as the deletion from the provider
+	for(auto observer : *GetObservers())
+	{
+		if((observer->GetObserverType() == MediaRouteApplicationObserver::ObserverType::Transcoder) ||
+		   (observer->GetObserverType() == MediaRouteApplicationObserver::ObserverType::Relay))
+		{
+			observer->OnDeleteStream(stream_info);
+		}
+	}
+
+	return true;
 }
 
 // Stream 객체 에에 있는 패킷을 Application Observer에 전달한다
 // TODO: 이 구조에서 Segment Fault 문제가 발생함
 // TODO: 패킷을 지연없이 전달하기위해 Application당 스레드를 생성하였음.
-void MediaRouteApplication::MainTask()
+// - Each worker only handles the streams that are assigned to it
+void MediaRouteApplication::MainTask(Worker *worker)
 {
 	while(!_kill_flag)
 	{
-		auto indicator = _indicator.pop_unique();
+		auto indicator = worker->_indicator.pop_unique();
 		if(indicator == nullptr)
 		{
-			logte("invalid indicator");
-			continue;
-		}
-
-		// GC 수행
-		if(indicator->_stream_id == BUFFFER_INDICATOR_UNIQUEID_GC)
-		{
-			GarbageCollector();
+			if(_kill_flag == false)
+			{
+				logte("invalid indicator");
+			}
 			continue;
 		}
 
 		// logtd("indicator : %u", indicator->_stream_id);
 
-		// TODO: 동기화 처리가 필요 하지만 자주 호출 부분이라 성능 적으로 확인 필요
-		std::unique_lock<std::mutex> lock(_mutex);
-		auto it = _streams.find(indicator->_stream_id);
-		auto stream = (it != _streams.end()) ? it->second : nullptr;
-		lock.unlock();
+		// The snapshot of the streams is read without the lock
+		auto stream = GetStream(indicator->_stream_id);
 
 		if(stream == nullptr)
 		{
@@ -460,15 +1065,23 @@ void MediaRouteApplication::MainTask()
 			continue;
 		}
 
-		auto cur_buf = stream->Pop();
-		if(cur_buf)
+		// The observers which are registered/unregistered while the packets are sent get them from the next indicator
+		auto observers = GetObservers();
+
+		// A packet can release several packets from the jitter buffer (or none while it is held)
+		std::unique_ptr<MediaPacket> cur_buf;
+		while((cur_buf = stream->Pop()) != nullptr)
 		{
+			// The observers which are called from here (e.g. the queues of the publishers) take over the flow
+			OV_TRACE_FLOW(cur_buf->GetTraceId());
+			OV_TRACE_SCOPE("router", "Dispatch");
+
 			MediaRouteApplicationConnector::ConnectorType connector_type = stream->GetConnectorType();
 
 			auto stream_info = stream->GetStreamInfo();
 
-			// Find Media Track
-			auto media_track = stream_info->GetTrack(cur_buf->GetTrackId());
+			// Find Media Track (the reference of the dense table of the stream info, which outlives this loop)
+			auto &media_track = stream_info->GetTrack(cur_buf->GetTrackId());
 
 			// Transcoder -> MediaRouter -> RelayClient
 			// or
@@ -482,7 +1095,7 @@ void MediaRouteApplication::MainTask()
 			}
 
 			// Observer(Publisher or Transcoder)에게 MediaBuffer를 전달함.
-			for(const auto &observer : _observers)
+			for(const auto &observer : *observers)
 			{
 				// Provider -> MediaRouter -> Transcoder
 				if(
@@ -491,15 +1104,8 @@ void MediaRouteApplication::MainTask()
 					)
 				{
 					// TODO(soulk): Application Observer의 타입에 따라서 호출하는 함수를 다르게 한다
-					// TODO(soulk) : MediaFrame clone 기능을 만든다.
-					auto media_buffer_clone = std::make_unique<MediaPacket>(
-						cur_buf->GetMediaType(),
-						cur_buf->GetTrackId(),
-						cur_buf->GetData(),
-						cur_buf->GetPts(),
-						cur_buf->GetFlags(),
-						cur_buf->GetCts()
-					);
+					// The payload is shared by all the observers (the transcoder only reads it), instead of copying it per observer
+					auto media_buffer_clone = cur_buf->SharePacket();
 
 					observer->OnSendFrame(
 						stream_info,
@@ -522,11 +1128,13 @@ void MediaRouteApplication::MainTask()
 						case MediaType::Video:
 						{
 							auto data = cur_buf->GetData();
-							auto &track = stream_info->GetTrack(cur_buf->GetTrackId());
+							auto &track = media_track;
 
 							OV_ASSERT2(track != nullptr);
 
-							auto encoded_frame = std::make_unique<EncodedFrame>(data, data->GetLength(), 0);
+							// One allocation for the frame, the codec info and the fragmentation
+							auto frame = std::make_unique<EncodedFrameDescriptor>(data, data->GetLength());
+							auto encoded_frame = &(frame->encoded_frame);
 							encoded_frame->_encoded_width = track->GetWidth();
 							encoded_frame->_encoded_height = track->GetHeight();
 							encoded_frame->_frame_type = (cur_buf->GetFlags() == MediaPacketFlag::Key) ? FrameType::VideoFrameKey : FrameType::VideoFrameDelta;
@@ -540,7 +1148,7 @@ void MediaRouteApplication::MainTask()
 							// SDP의 Timebase가 90000이라서 읨의로 수정해줌.
 							// encoded_frame->_timeStamp = (uint32_t)((double)cur_buf->GetPts() * (double)0.09);
 
-							auto codec_info = std::make_unique<CodecSpecificInfo>();
+							auto codec_info = &(frame->codec_info);
 
 							MediaCodecId codec_id = media_track->GetCodecId();
 
@@ -550,7 +1158,8 @@ void MediaRouteApplication::MainTask()
 								codec_info->codec_specific.vp8.picture_id = -1;
 								codec_info->codec_specific.vp8.non_reference = false;
 								codec_info->codec_specific.vp8.simulcast_idx = 0;
-								codec_info->codec_specific.vp8.temporal_idx = 0;
+								// The RTP packetizer numbers TL0PICIDX of the layered tracks
+								codec_info->codec_specific.vp8.temporal_idx = cur_buf->GetTemporalLayer();
 								codec_info->codec_specific.vp8.layer_sync = false;
 								codec_info->codec_specific.vp8.tl0_pic_idx = -1;
 								codec_info->codec_specific.vp8.key_idx = -1;
@@ -562,29 +1171,33 @@ void MediaRouteApplication::MainTask()
 								codec_info->codec_specific.h264.packetization_mode = H264PacketizationMode::NonInterleaved;
 							}
 
-							auto fragmentation = std::make_unique<FragmentationHeader>();
-							::memcpy(fragmentation.get(), cur_buf->_frag_hdr.get(), sizeof(FragmentationHeader));
+							if((codec_id == MediaCodecId::H264) || (codec_id == MediaCodecId::H265))
+							{
+								// The publishers convert the frame from/to the same bitstream
+								encoded_frame->_bitstream = cur_buf->GetVideoBitstream(codec_id);
+							}
+
+							::memcpy(&(frame->fragmentation), cur_buf->_frag_hdr.get(), sizeof(FragmentationHeader));
 
 							// logtd("send to publisher (1000k cr):%u, (90k cr):%u", cur_buf->GetPts(), encoded_frame->_timeStamp);
 							observer->OnSendVideoFrame(
 								stream_info,
 								media_track,
-								std::move(encoded_frame),
-								std::move(codec_info),
-								std::move(fragmentation));
+								std::move(frame));
 							break;
 						}
 
 						case MediaType::Audio:
 						{
 							auto data = cur_buf->GetData();
-							auto &track = stream_info->GetTrack(cur_buf->GetTrackId());
+							auto &track = media_track;
 
 							OV_ASSERT2(track != nullptr);
 
 							// RFC7587 - RTP Payload Format for the Opus Speech and Audio Codec (https://tools.ietf.org/html/rfc7587)
 
-							auto encoded_frame = std::make_unique<EncodedFrame>(data, data->GetLength(), 0);
+							auto frame = std::make_unique<EncodedFrameDescriptor>(data, data->GetLength());
+							auto encoded_frame = &(frame->encoded_frame);
 							encoded_frame->_encoded_width = track->GetWidth();
 							encoded_frame->_encoded_height = track->GetHeight();
 							encoded_frame->_frame_type = (cur_buf->GetFlags() == MediaPacketFlag::Key) ? FrameType::AudioFrameKey : FrameType::AudioFrameDelta;
@@ -595,7 +1208,7 @@ void MediaRouteApplication::MainTask()
 							// SDP의 Timebase가 90000이라서 읨의로 수정해줌.
 							// encoded_frame->_timeStamp = (uint32_t)((double)cur_buf->GetPts() * (double)0.09);
 
-							auto codec_info = std::make_unique<CodecSpecificInfo>();
+							auto codec_info = &(frame->codec_info);
 
 							codec_info->codec_type = CodecType::Opus;
 
@@ -605,15 +1218,11 @@ void MediaRouteApplication::MainTask()
 							codec_info->codec_specific.opus.min_bitrate_bps = 0;
 							codec_info->codec_specific.opus.max_bitrate_bps = 0;
 
-							auto fragmentation = std::make_unique<FragmentationHeader>();
-
 							// logtd("send to publisher (1000k cr):%u, (90k cr):%u", cur_buf->GetPts(), encoded_frame->_timeStamp);
 							observer->OnSendAudioFrame(
 								stream_info,
 								media_track,
-								std::move(encoded_frame),
-								std::move(codec_info),
-								std::move(fragmentation));
+								std::move(frame));
 							break;
 						}
 
@@ -10,6 +10,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <set>
 #include <vector>
 #include <algorithm>
 
@@ -28,6 +29,8 @@ class StreamInfo;
 
 class RelayServer;
 class RelayClient;
+struct RelayLinkStatisticsData;
+struct RelayStreamStatisticsData;
 
 // -어플리케이션(Application) 별 스트림(Stream)을 관리해야 한다
 // - Publisher를 관리해야한다
@@ -37,10 +40,12 @@ class RelayClient;
 
 // 1. Connect App에 접속되면 어플리케이션으로 할당함.
 
-// Stream timout for GarbageCollector
+// Stream timout for GarbageCollector (seconds, the stream from the provider is deleted if it doesn't receive the packets)
 # define TIMEOUT_STREAM_ALIVE   30
+// Maximum number of the router threads per application (<RouterWorkerCount>)
+# define MEDIA_ROUTE_MAX_WORKER_COUNT	64
 
-class MediaRouteApplication : public MediaRouteApplicationInterface
+class MediaRouteApplication : public MediaRouteApplicationInterface, public ov::MemoryShedder
 {
 public:
 	static std::shared_ptr<MediaRouteApplication> Create(const info::Application *application_info);
@@ -53,7 +58,6 @@ public:
 	bool Stop();
 
 	volatile bool _kill_flag;
-	std::thread _thread;
 	std::mutex _mutex;
 
 	////////////////////////////////////////////////////////////////////////////////////////////////
@@ -83,6 +87,15 @@ public:
 		std::shared_ptr<StreamInfo> stream,
 		std::unique_ptr<MediaPacket> packet) override;
 
+	// Forwards the key frame request of an observer to the connector of the stream (at most once per interval per track)
+	bool OnRequestKeyFrame(uint32_t stream_id, int32_t track_id) override;
+
+	// ov::MemoryShedder: the stream from the providers which has the fewest viewers
+	// - The stream is deleted from the router and the observers, but the ingest of the provider is kept
+	//   (the packets are discarded until the provider deletes the stream)
+	bool GetShedCandidate(size_t *session_count) override;
+	bool ShedStream() override;
+
 
 public:
 
@@ -92,42 +105,72 @@ public:
 	bool UnregisterObserverApp(
 		std::shared_ptr<MediaRouteApplicationObserver> observer);
 
+	// Collects the statistics of the relay server and client of the application (for monitoring)
+	void GetRelayStatisticsData(
+		std::vector<std::shared_ptr<RelayLinkStatisticsData>> &links,
+		std::vector<std::shared_ptr<RelayStreamStatisticsData>> &streams);
+
+	// Collects the counters of the streams from the snapshot of the registry (without the lock)
+	void GetStreamMetricsData(std::vector<std::shared_ptr<MediaRouteStreamMetricsData>> &streams) const;
 
 public:
 	// Application information from configuration file
 	const info::Application *_application_info;
 
-	// Information of Connector instance
-	std::vector<std::shared_ptr<MediaRouteApplicationConnector>> _connectors;
+	using ConnectorList = std::vector<std::shared_ptr<MediaRouteApplicationConnector>>;
+	using ObserverList = std::vector<std::shared_ptr<MediaRouteApplicationObserver>>;
+
+	// The lists are copied and replaced by the writers (with _mutex), the readers iterate a snapshot without the lock
+	std::shared_ptr<const ConnectorList> GetConnectors() const
+	{
+		return std::atomic_load(&_connectors);
+	}
+
+	std::shared_ptr<const ObserverList> GetObservers() const
+	{
+		return std::atomic_load(&_observers);
+	}
 
-	// Information of Observer instance
-	std::vector<std::shared_ptr<MediaRouteApplicationObserver>> _observers;
+	// Information of Connector instance (std::atomic_load/atomic_store only)
+	std::shared_ptr<const ConnectorList> _connectors = std::make_shared<ConnectorList>();
+
+	// Information of Observer instance (std::atomic_load/atomic_store only)
+	std::shared_ptr<const ObserverList> _observers = std::make_shared<ObserverList>();
 
 	// Information of MediaStream instance
-	// Key : StreamInfo.id
-	std::map<uint32_t, std::shared_ptr<MediaRouteStream>> _streams;
+	// - An immutable snapshot, which is replaced as a whole when a stream is created/deleted (RCU)
+	// - The readers (e.g. the lookup per packet) don't lock, the writers are serialized by _mutex
+	struct StreamNameHash
+	{
+		uint64_t operator()(const ov::String &name) const
+		{
+			return ov::HashBytes(name.CStr(), name.GetLength());
+		}
+	};
+
+	struct StreamRegistry
+	{
+		// Key : StreamInfo.id
+		ov::HashTable<uint32_t, std::shared_ptr<MediaRouteStream>> streams;
+		// Key : StreamInfo.name (the last created stream if the names are duplicated)
+		ov::HashTable<ov::String, std::shared_ptr<MediaRouteStream>, StreamNameHash> streams_by_name;
+	};
 
 public:
-	void MainTask();
+	class Worker;
 
-	void OnGarbageCollector();
-	void GarbageCollector();
+	void MainTask(Worker *worker);
 
-	const std::map<uint32_t, std::shared_ptr<MediaRouteStream>> GetStreams() const override
-	{
-		return _streams;
-	}
+
+	const std::map<uint32_t, std::shared_ptr<MediaRouteStream>> GetStreams() const override;
+	std::shared_ptr<MediaRouteStream> GetStream(uint32_t stream_id) const override;
+	size_t GetStreamCount() const override;
 
 	std::shared_ptr<RelayClient> GetOriginConnector() override
 	{
 		return _relay_client;
 	}
 
-	enum
-	{
-		BUFFFER_INDICATOR_UNIQUEID_GC = 0
-	};
-
 	class BufferIndicator
 	{
 	public:
@@ -139,12 +182,53 @@ public:
 		uint32_t _stream_id;
 	};
 
+	// A router thread, each stream is assigned to a worker by the stream id
+	// (so the packets of a stream are sent in order, and the streams are sent in parallel)
+	class Worker
+	{
+	public:
+		// 버퍼를 처리할 인디게이터
+		MediaQueue<std::unique_ptr<BufferIndicator>> _indicator;
+		std::thread _thread;
+	};
 
 protected:
-	// 버퍼를 처리할 인디게이터
-	MediaQueue<std::unique_ptr<BufferIndicator>> _indicator;
+	Worker *GetWorkerByStreamId(uint32_t stream_id);
+
+	std::shared_ptr<const StreamRegistry> GetStreamRegistry() const;
+	// _mutex must be locked
+	void RemoveStream(uint32_t stream_id);
+
+	// The deadline of the stream is armed on ov::SharedTimerWheel, so only the expired streams are visited
+	void ArmGarbageCollector(const std::shared_ptr<MediaRouteStream> &stream);
+	// Called by _gc_queue (not by the router threads)
+	void GarbageCollector(const std::shared_ptr<MediaRouteStream> &stream);
+
+	// <Providers><Reconnect>: the stream is kept until the provider is reconnected (false: the stream is deleted now)
+	bool WaitForReconnect(const std::shared_ptr<StreamInfo> &stream_info);
+	// Called by _gc_queue when the provider isn't reconnected within the timeout
+	void DeleteDisconnectedStream(const std::shared_ptr<MediaRouteStream> &stream);
+	// The observers of the provider (transcoder, relay) delete the stream, _mutex must not be locked
+	void DeleteProviderStream(const std::shared_ptr<StreamInfo> &stream_info);
+	// The timeline of the stream is continued only if the codecs of the tracks are not changed by the reconnection
+	static bool IsSameTracks(const std::shared_ptr<StreamInfo> &stream_info, const std::shared_ptr<StreamInfo> &new_stream_info);
+
+	bool IsShedStream(uint32_t stream_id);
+
+	// <Providers><Capture>: nullptr if the stream is not captured
+	std::shared_ptr<StreamCaptureWriter> CreateCapture(const std::shared_ptr<StreamInfo> &stream_info) const;
+
+	std::shared_ptr<const StreamRegistry> _stream_registry = std::make_shared<StreamRegistry>(); // std::atomic_load/atomic_store only
+
+	std::vector<std::unique_ptr<Worker>> _workers;
 
 	std::shared_ptr<RelayServer>    _relay_server;
 	std::shared_ptr<RelayClient>    _relay_client;
-	ov::DelayQueue                  _retry_timer;
+	// The expired streams are deleted by this thread (the observers may take a while to delete the stream)
+	ov::DelayQueue                  _gc_queue;
+
+	// The streams which are dropped by ov::MemoryGovernor (until the provider deletes them)
+	std::mutex                      _shed_mutex;
+	std::set<uint32_t>              _shed_stream_ids;
+	std::weak_ptr<MediaRouteStream> _shed_candidate;
 };
@@ -0,0 +1,164 @@
+//==============================================================================
+//
+//  MediaRouteJitterBuffer
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "media_route_jitter_buffer.h"
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#define OV_LOG_TAG "MediaRouter.JitterBuffer"
+
+MediaRouteJitterBuffer::MediaRouteJitterBuffer(const std::shared_ptr<StreamInfo> &stream_info, int latency, int drift_threshold)
+	: _latency(std::max(latency, 0)),
+	  _drift_threshold(std::max(drift_threshold, 1))
+{
+	for(const auto &item : stream_info->GetTracks())
+	{
+		auto &timebase = item.second->GetTimeBase();
+		auto &track = _tracks[item.first];
+
+		if((timebase.GetNum() > 0) && (timebase.GetDen() > 0))
+		{
+			track.timebase_num = timebase.GetNum();
+			track.timebase_den = timebase.GetDen();
+		}
+	}
+}
+
+MediaRouteJitterBuffer::Track *MediaRouteJitterBuffer::GetTrack(int32_t track_id)
+{
+	// The track which is not in the stream info uses 1/1000 (same as RTMP)
+	return &(_tracks[track_id]);
+}
+
+int64_t MediaRouteJitterBuffer::ToMilliseconds(const Track &track, int64_t timestamp) const
+{
+	return timestamp * 1000 * track.timebase_num / track.timebase_den;
+}
+
+void MediaRouteJitterBuffer::Push(std::unique_ptr<MediaPacket> packet)
+{
+	Track *track = GetTrack(packet->GetTrackId());
+	int64_t timestamp = packet->GetPts() + track->offset;
+
+	_stats.pushed_count++;
+
+	if(track->last_input != INT64_MIN)
+	{
+		int64_t delta = timestamp - track->last_input;
+
+		if(std::abs(ToMilliseconds(*track, delta)) > _drift_threshold)
+		{
+			// Continue the timeline from the last frame
+			int64_t corrected = track->last_input + track->last_duration;
+
+			logtw("Timestamp of the track %d is jumped (%lld ms), the timeline is rebased", packet->GetTrackId(), ToMilliseconds(*track, delta));
+
+			track->offset += corrected - timestamp;
+			timestamp = corrected;
+			_stats.drift_count++;
+		}
+		else if(delta > 0)
+		{
+			track->last_duration = delta;
+		}
+	}
+
+	if(timestamp > track->last_input)
+	{
+		track->last_input = timestamp;
+	}
+
+	if((track->last_output != INT64_MIN) && (timestamp < track->last_output))
+	{
+		// The newer packet was already released, keep the PTS as possible
+		int64_t delta = track->last_output - timestamp;
+
+		packet->SetCts(std::max<int64_t>(packet->GetCts() - delta, 0));
+		timestamp = track->last_output;
+		_stats.late_count++;
+	}
+
+	packet->SetPts(timestamp);
+
+	// Find the position from the back (most of the packets are arrived in order)
+	auto position = track->packets.end();
+	while((position != track->packets.begin()) && ((*(position - 1))->GetPts() > timestamp))
+	{
+		--position;
+	}
+
+	if(position != track->packets.end())
+	{
+		_stats.reordered_count++;
+	}
+
+	track->packets.insert(position, std::move(packet));
+	_buffered_count++;
+
+	_stats.max_buffered_count = std::max(_stats.max_buffered_count, _buffered_count);
+	_newest_time = std::max(_newest_time, ToMilliseconds(*track, timestamp));
+}
+
+//====================================================================================================
+// Pop
+// - The oldest packet of all tracks is released if every track has a packet (the older packet of the
+//   other track can't be arrived), or it's older than the newest packet more than the latency
+//====================================================================================================
+std::unique_ptr<MediaPacket> MediaRouteJitterBuffer::Pop()
+{
+	Track *head_track = nullptr;
+	int64_t head_time = 0;
+	bool is_all_tracks_buffered = true;
+
+	for(auto &item : _tracks)
+	{
+		auto &track = item.second;
+
+		if(track.packets.empty())
+		{
+			is_all_tracks_buffered = false;
+			continue;
+		}
+
+		int64_t time = ToMilliseconds(track, track.packets.front()->GetPts());
+
+		if((head_track == nullptr) || (time < head_time))
+		{
+			head_track = &track;
+			head_time = time;
+		}
+	}
+
+	if(head_track == nullptr)
+	{
+		return nullptr;
+	}
+
+	int64_t delay = _newest_time - head_time;
+
+	if((is_all_tracks_buffered == false) && (delay < _latency))
+	{
+		return nullptr;
+	}
+
+	auto packet = std::move(head_track->packets.front());
+	head_track->packets.pop_front();
+	head_track->last_output = packet->GetPts();
+	_buffered_count--;
+
+	_stats.popped_count++;
+	_stats.max_delay = std::max(_stats.max_delay, delay);
+
+	return packet;
+}
+
+ov::String MediaRouteJitterBuffer::GetStatsString() const
+{
+	return ov::String::FormatString("pushed(%llu) popped(%llu) reordered(%llu) late(%llu) drift(%llu) max_buffered(%zu) max_delay(%lld ms)",
+	                                _stats.pushed_count, _stats.popped_count, _stats.reordered_count, _stats.late_count, _stats.drift_count,
+	                                _stats.max_buffered_count, _stats.max_delay);
+}
@@ -0,0 +1,97 @@
+//==============================================================================
+//
+//  MediaRouteJitterBuffer
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <deque>
+#include <map>
+
+#include "base/media_route/media_buffer.h"
+#include "base/application/stream_info.h"
+
+//====================================================================================================
+// MediaRouteJitterBuffer
+// - Holds the packets of the provider up to the latency, and releases them in the timestamp order
+//   of all tracks (strictly interleaved, the timestamp of each track is never decreased)
+// - The timestamp of the provider packet is the DTS (the PTS is DTS + CTS)
+// - A timestamp jump (e.g. the encoder is restarted) which is larger than the drift threshold is
+//   corrected by rebasing the timeline of the track to the last timestamp
+//====================================================================================================
+class MediaRouteJitterBuffer
+{
+public:
+	struct Stats
+	{
+		uint64_t pushed_count = 0;
+		uint64_t popped_count = 0;
+
+		// Packets which are arrived earlier than the previous packet of the track
+		uint64_t reordered_count = 0;
+		// Packets which are arrived after the newer packet of the track was released (the timestamp is clamped)
+		uint64_t late_count = 0;
+		// Number of the timeline rebasing
+		uint64_t drift_count = 0;
+
+		size_t max_buffered_count = 0;
+		// Max time span (ms) of the buffered packets when a packet is released
+		int64_t max_delay = 0;
+	};
+
+	MediaRouteJitterBuffer(const std::shared_ptr<StreamInfo> &stream_info, int latency, int drift_threshold);
+
+	void Push(std::unique_ptr<MediaPacket> packet);
+	// nullptr if there is no packet to release
+	std::unique_ptr<MediaPacket> Pop();
+
+	size_t Size() const
+	{
+		return _buffered_count;
+	}
+
+	const Stats &GetStats() const
+	{
+		return _stats;
+	}
+
+	ov::String GetStatsString() const;
+
+private:
+	struct Track
+	{
+		int64_t timebase_num = 1;
+		int64_t timebase_den = 1000;
+
+		// Sorted by the timestamp
+		std::deque<std::unique_ptr<MediaPacket>> packets;
+
+		// Added to the timestamps of the provider (drift correction)
+		int64_t offset = 0;
+
+		// Timestamp of the newest input, duration of the last frame (after the correction)
+		int64_t last_input = INT64_MIN;
+		int64_t last_duration = 0;
+
+		// Timestamp of the last released packet
+		int64_t last_output = INT64_MIN;
+	};
+
+	Track *GetTrack(int32_t track_id);
+	int64_t ToMilliseconds(const Track &track, int64_t timestamp) const;
+
+	std::map<int32_t, Track> _tracks;
+
+	int64_t _latency;
+	int64_t _drift_threshold;
+
+	// Newest timestamp (ms) of all tracks
+	int64_t _newest_time = INT64_MIN;
+	size_t _buffered_count = 0;
+
+	Stats _stats;
+};
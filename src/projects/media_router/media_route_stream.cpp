@@ -10,6 +10,10 @@
 
 #include <base/ovlibrary/ovlibrary.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
 #define OV_LOG_TAG "MediaRouter.Stream"
 
 using namespace common;
@@ -27,6 +31,11 @@ MediaRouteStream::MediaRouteStream(std::shared_ptr<StreamInfo> stream_info)
 
 MediaRouteStream::~MediaRouteStream()
 {
+	if(_jitter_buffer != nullptr)
+	{
+		logti("Jitter buffer of the stream %s(%u): %s", _stream_info->GetName().CStr(), _stream_info->GetId(), _jitter_buffer->GetStatsString().CStr());
+	}
+
 	logtd("Delete media route stream name(%s) id(%u)", _stream_info->GetName().CStr(), _stream_info->GetId());
 }
 
@@ -45,8 +54,72 @@ MediaRouteApplicationConnector::ConnectorType MediaRouteStream::GetConnectorType
 	return _application_connector_type;
 }
 
+void MediaRouteStream::SetConnector(const std::shared_ptr<MediaRouteApplicationConnector> &connector)
+{
+	_connector = connector;
+}
+
+std::shared_ptr<MediaRouteApplicationConnector> MediaRouteStream::GetConnector()
+{
+	return _connector.lock();
+}
+
+bool MediaRouteStream::AcceptKeyFrameRequest(int32_t track_id)
+{
+	int64_t current_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	std::lock_guard<std::mutex> lock(_key_frame_request_mutex);
+
+	auto item = _key_frame_request_times.find(track_id);
+
+	if((item != _key_frame_request_times.end()) && ((current_time - item->second) < MEDIA_ROUTE_KEY_FRAME_REQUEST_INTERVAL))
+	{
+		// The key frame of the previous request is coming
+		return false;
+	}
+
+	_key_frame_request_times[track_id] = current_time;
+
+	return true;
+}
+
+void MediaRouteStream::EnableJitterBuffer(int latency, int drift_threshold)
+{
+	std::lock_guard<std::mutex> lock(_queue_mutex);
+
+	logtd("Jitter buffer is enabled: stream(%s) latency(%d ms) drift threshold(%d ms)", _stream_info->GetName().CStr(), latency, drift_threshold);
+
+	_jitter_buffer = std::make_unique<MediaRouteJitterBuffer>(_stream_info, latency, drift_threshold);
+}
+
+void MediaRouteStream::SetLatencyStatistics(const std::shared_ptr<StreamLatencyStatistics> &latency_statistics)
+{
+	// It is set before the stream is registered, so Push()/Pop() don't lock it
+	_latency_statistics = latency_statistics;
+}
+
+void MediaRouteStream::SetCapture(const std::shared_ptr<StreamCaptureWriter> &capture)
+{
+	// Same as SetLatencyStatistics()
+	_capture = capture;
+}
+
+const std::shared_ptr<StreamCaptureWriter> &MediaRouteStream::GetCapture() const
+{
+	return _capture;
+}
+
 bool MediaRouteStream::Push(std::unique_ptr<MediaPacket> buffer, bool convert_bitstream)
 {
+	OV_TRACE_FLOW(buffer->GetTraceId());
+	OV_TRACE_SCOPE("router", "Push");
+
+	if(buffer->GetTraceId() == 0)
+	{
+		// The flow of the packet starts here (from the provider, or from the encoder if the input isn't traced)
+		buffer->SetTraceId(ov::Tracer::StartFlow("router", "Ingest"));
+	}
+
 	MediaType media_type = buffer->GetMediaType();
 	int32_t track_id = buffer->GetTrackId();
 	auto media_track = _stream_info->GetTrack(track_id);
@@ -59,11 +132,13 @@ bool MediaRouteStream::Push(std::unique_ptr<MediaPacket> buffer, bool convert_bi
 
 	if(convert_bitstream)
 	{
-		if(media_type == MediaType::Video && media_track->GetCodecId() == MediaCodecId::H264)
+		if(media_type == MediaType::Video && (media_track->GetCodecId() == MediaCodecId::H264 || media_track->GetCodecId() == MediaCodecId::H265))
 		{
-		    int64_t cts = 0;
+		    // The Annex-B bitstream (e.g. SRT/MPEG-TS) keeps the cts of the provider
+		    // (HEVC of RTMP has the same structure as AVC, the converter checks the codec id of the FLV header)
+		    int64_t cts = buffer->GetCts();
 
-		    _bsfv.convert_to(buffer->GetData(), cts);
+		    _bsfv.convert_to(buffer->GetData(), cts, buffer->_frag_hdr.get());
             buffer->SetCts(cts);
 
             // logtd("rtmp input h264 pts(%lld) cts(%lld)", buffer->GetPts(), buffer->GetCts());
@@ -104,8 +179,44 @@ bool MediaRouteStream::Push(std::unique_ptr<MediaPacket> buffer, bool convert_bi
 	media_track->SetLastFrameTime(buffer->GetPts());
 #endif
 
+	int64_t current_time = ov::LatencyHistogram::GetCurrentMicroseconds();
+
+	if((_latency_statistics != nullptr) && (buffer->GetIngestTime() > 0))
+	{
+		_latency_statistics->Record(StreamLatencyStage::Ingest, current_time - buffer->GetIngestTime());
+	}
+
+	buffer->SetQueuedTime(current_time);
+
+	_received_packet_count++;
+	_received_bytes += buffer->GetData()->GetLength();
+
 	// 변경된 스트림을 큐에 넣음
-	_queue.push(std::move(buffer));
+	std::unique_lock<std::mutex> lock(_queue_mutex);
+
+	if(_application_connector_type == MediaRouteApplicationConnector::ConnectorType::Provider)
+	{
+		UpdateTimeline(buffer.get(), media_track);
+	}
+
+	if(_jitter_buffer != nullptr)
+	{
+		_jitter_buffer->Push(std::move(buffer));
+
+		// Move the packets which can be released, so Pop() is same as the queue
+		while(auto packet = _jitter_buffer->Pop())
+		{
+			_queue.push(std::move(packet));
+		}
+	}
+	else
+	{
+		_queue.push(std::move(buffer));
+	}
+
+	_queue_size = _queue.size() + ((_jitter_buffer != nullptr) ? _jitter_buffer->Size() : 0);
+
+	lock.unlock();
 
 	time(&_last_rb_time);
 	// logtd("last time : %s", asctime(gmtime(&_last_rb_time)) );
@@ -115,6 +226,8 @@ bool MediaRouteStream::Push(std::unique_ptr<MediaPacket> buffer, bool convert_bi
 
 std::unique_ptr<MediaPacket> MediaRouteStream::Pop()
 {
+	std::lock_guard<std::mutex> lock(_queue_mutex);
+
 	if(_queue.empty())
 	{
 		return nullptr;
@@ -123,16 +236,197 @@ std::unique_ptr<MediaPacket> MediaRouteStream::Pop()
 	auto p2 = std::move(_queue.front());
 	_queue.pop();
 
+	_queue_size = _queue.size() + ((_jitter_buffer != nullptr) ? _jitter_buffer->Size() : 0);
+
+	if(_latency_statistics != nullptr)
+	{
+		_latency_statistics->Record(StreamLatencyStage::RouterQueue, ov::LatencyHistogram::GetCurrentMicroseconds() - p2->GetQueuedTime());
+	}
+
 	return p2;
 }
 
 uint32_t MediaRouteStream::Size()
 {
-	return _queue.size();
+	std::lock_guard<std::mutex> lock(_queue_mutex);
+
+	return _queue.size() + ((_jitter_buffer != nullptr) ? _jitter_buffer->Size() : 0);
 }
 
+MediaRouteStreamMetrics MediaRouteStream::GetMetrics() const
+{
+	MediaRouteStreamMetrics metrics;
+
+	metrics.received_packet_count = _received_packet_count;
+	metrics.received_bytes = _received_bytes;
+	metrics.queue_size = _queue_size;
+
+	return metrics;
+}
 
 time_t MediaRouteStream::getLastReceivedTime()
 {
 	return _last_rb_time;
-}
\ No newline at end of file
+}
+
+void MediaRouteStream::SetGarbageCollectorTimerId(uint64_t timer_id)
+{
+	_gc_timer_id = timer_id;
+}
+
+uint64_t MediaRouteStream::GetGarbageCollectorTimerId() const
+{
+	return _gc_timer_id;
+}
+
+void MediaRouteStream::SetDisconnected(int64_t disconnected_time, uint64_t timer_id)
+{
+	_disconnected_time = disconnected_time;
+	_reconnect_timer_id = timer_id;
+}
+
+int64_t MediaRouteStream::GetDisconnectedTime() const
+{
+	return _disconnected_time;
+}
+
+uint64_t MediaRouteStream::GetReconnectTimerId() const
+{
+	return _reconnect_timer_id;
+}
+
+void MediaRouteStream::RebaseTimestamps()
+{
+	std::lock_guard<std::mutex> lock(_queue_mutex);
+
+	_rebase_pending = true;
+}
+
+void MediaRouteStream::UpdateTimeline(MediaPacket *packet, const std::shared_ptr<MediaTrack> &media_track)
+{
+	double timebase = media_track->GetTimeBase().GetExpr();
+
+	if(timebase <= 0.0)
+	{
+		return;
+	}
+
+	if(_rebase_pending)
+	{
+		_rebase_pending = false;
+
+		// The end of the previous connection is the end of the longest track (seconds), so the tracks stay in sync
+		double end_time = 0.0;
+		bool has_timeline = false;
+
+		for(auto &item : _timelines)
+		{
+			auto &track = _stream_info->GetTrack(item.first);
+
+			if((track == nullptr) || (item.second.has_pts == false) || (track->GetTimeBase().GetExpr() <= 0.0))
+			{
+				continue;
+			}
+
+			end_time = std::max(end_time, static_cast<double>(item.second.max_pts + item.second.duration) * track->GetTimeBase().GetExpr());
+			has_timeline = true;
+		}
+
+		if(has_timeline)
+		{
+			// The first packet of the new connection follows the end of the previous connection
+			_timeline_offset = end_time - (static_cast<double>(packet->GetPts()) * timebase);
+
+			for(auto &item : _timelines)
+			{
+				auto &track = _stream_info->GetTrack(item.first);
+
+				if((track != nullptr) && (track->GetTimeBase().GetExpr() > 0.0))
+				{
+					item.second.offset = std::llround(_timeline_offset / track->GetTimeBase().GetExpr());
+				}
+			}
+
+			logti("The timestamps are rebased: stream(%s) offset(%.3f s)", _stream_info->GetName().CStr(), _timeline_offset);
+		}
+	}
+
+	auto item = _timelines.find(packet->GetTrackId());
+
+	if(item == _timelines.end())
+	{
+		MediaRouteTrackTimeline timeline;
+
+		timeline.offset = std::llround(_timeline_offset / timebase);
+		item = _timelines.emplace(packet->GetTrackId(), timeline).first;
+	}
+
+	auto &timeline = item->second;
+	int64_t pts = packet->GetPts() + timeline.offset;
+
+	if(timeline.has_pts == false)
+	{
+		timeline.max_pts = pts;
+		timeline.has_pts = true;
+	}
+	else if(pts > timeline.max_pts)
+	{
+		// The pts of the B-frames are smaller than max_pts
+		timeline.duration = pts - timeline.max_pts;
+		timeline.max_pts = pts;
+	}
+
+	packet->SetPts(pts);
+}
+
+void MediaRouteStream::CacheGopPacket(const MediaPacket *packet)
+{
+	std::lock_guard<std::mutex> lock(_gop_cache_mutex);
+
+	if((packet->GetMediaType() == MediaType::Video) && (packet->GetFlags() == MediaPacketFlag::Key))
+	{
+		// A new GOP
+		_gop_cache.clear();
+		_gop_cache_bytes = 0;
+	}
+	else if(_gop_cache.empty())
+	{
+		// Wait for the key frame
+		return;
+	}
+
+	auto data = packet->GetData();
+	// Reduced under the memory pressure (the late joiners wait for the next key frame instead)
+	size_t max_bytes = ov::MemoryGovernor::Instance()->IsLevel(ov::MemoryGovernorLevel::Shrink) ?
+		(MEDIA_ROUTE_GOP_CACHE_MAX_BYTES / OV_MEMORY_GOVERNOR_GOP_CACHE_DIVISOR) : MEDIA_ROUTE_GOP_CACHE_MAX_BYTES;
+
+	if((_gop_cache_bytes + data->GetLength()) > max_bytes)
+	{
+		logtw("GOP of the stream %s(%u) exceeds %zu bytes, the cache is dropped until the next key frame",
+		      _stream_info->GetName().CStr(), _stream_info->GetId(), max_bytes);
+
+		_gop_cache.clear();
+		_gop_cache_bytes = 0;
+		return;
+	}
+
+	auto gop_packet = std::make_shared<MediaRouteGopPacket>();
+
+	gop_packet->media_type = packet->GetMediaType();
+	gop_packet->track_id = packet->GetTrackId();
+	gop_packet->pts = packet->GetPts();
+	gop_packet->cts = packet->GetCts();
+	gop_packet->flags = packet->GetFlags();
+	::memcpy(&(gop_packet->frag_header), packet->_frag_hdr.get(), sizeof(FragmentationHeader));
+	gop_packet->data = data;
+
+	_gop_cache.push_back(gop_packet);
+	_gop_cache_bytes += data->GetLength();
+}
+
+std::vector<std::shared_ptr<const MediaRouteGopPacket>> MediaRouteStream::GetGopCache()
+{
+	std::lock_guard<std::mutex> lock(_gop_cache_mutex);
+
+	return _gop_cache;
+}
@@ -9,19 +9,74 @@
 #pragma once
 
 #include <stdint.h>
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <queue>
+#include <mutex>
+#include <map>
 
 #include "base/media_route/media_route_application_connector.h"
 #include "base/media_route/media_buffer.h"
 #include "base/media_route/media_type.h"
 #include "base/application/stream_info.h"
+#include "base/application/stream_latency.h"
+#include "base/application/stream_capture.h"
 
 #include "bitstream/bitstream_to_annexb.h"
 #include "bitstream/bitstream_to_adts.h"
 #include "bitstream/bitstream_to_annexa.h"
 
+#include "media_route_jitter_buffer.h"
+
+// Minimum interval of the key frame requests to the connector per track (ms), the requests in the interval are coalesced
+#define MEDIA_ROUTE_KEY_FRAME_REQUEST_INTERVAL          (1000)
+
+// Bytes of the GOP cache per stream (the cache is dropped until the next key frame when it is exceeded)
+#define MEDIA_ROUTE_GOP_CACHE_MAX_BYTES                 (8 * 1024 * 1024)
+
+// A packet of the GOP cache (the data is shared with the packet which is sent to the observers)
+struct MediaRouteGopPacket
+{
+	common::MediaType media_type;
+	int32_t track_id;
+	int64_t pts;
+	int64_t cts;
+	MediaPacketFlag flags;
+	FragmentationHeader frag_header;
+	std::shared_ptr<const ov::Data> data;
+};
+
+// Timeline of a track of the provider (in the timebase of the track), continued when the provider is reconnected
+struct MediaRouteTrackTimeline
+{
+	// Added to the timestamps of the provider
+	int64_t offset = 0;
+	// The largest pts (after the offset) and the interval to the previous one
+	int64_t max_pts = 0;
+	int64_t duration = 0;
+	bool has_pts = false;
+};
+
+// Counters of a stream of the router (for the metrics)
+struct MediaRouteStreamMetrics
+{
+	// Pushed by the connector (after the bitstream conversion)
+	uint64_t received_packet_count = 0;
+	uint64_t received_bytes = 0;
+	// Packets which are not popped yet (with the jitter buffer)
+	size_t queue_size = 0;
+};
+
+// Metrics of a stream of the router (for monitoring)
+struct MediaRouteStreamMetricsData
+{
+	ov::String app_name;
+	ov::String stream_name;
+	MediaRouteApplicationConnector::ConnectorType connector_type = MediaRouteApplicationConnector::ConnectorType::Provider;
+	MediaRouteStreamMetrics metrics;
+};
+
 class MediaRouteStream
 {
 public:
@@ -35,20 +90,89 @@ public:
 	void SetConnectorType(MediaRouteApplicationConnector::ConnectorType type);
 	MediaRouteApplicationConnector::ConnectorType GetConnectorType();
 
+	// The connector which created the stream (the key frame requests are sent to it)
+	void SetConnector(const std::shared_ptr<MediaRouteApplicationConnector> &connector);
+	std::shared_ptr<MediaRouteApplicationConnector> GetConnector();
+
+	// Returns false if a key frame of the track is requested within MEDIA_ROUTE_KEY_FRAME_REQUEST_INTERVAL
+	bool AcceptKeyFrameRequest(int32_t track_id);
+
+	// The packets are reordered/interleaved before they are popped (latency, drift_threshold: ms)
+	void EnableJitterBuffer(int latency, int drift_threshold);
+
+	// Push() records the Ingest latency, Pop() records the RouterQueue latency
+	void SetLatencyStatistics(const std::shared_ptr<StreamLatencyStatistics> &latency_statistics);
+
+	// <Providers><Capture>: the packets of the provider are recorded before they are pushed (nullptr: not captured)
+	void SetCapture(const std::shared_ptr<StreamCaptureWriter> &capture);
+	const std::shared_ptr<StreamCaptureWriter> &GetCapture() const;
+
 private:
 	std::shared_ptr<StreamInfo> _stream_info;
 
 	MediaRouteApplicationConnector::ConnectorType _application_connector_type;
+	std::weak_ptr<MediaRouteApplicationConnector> _connector;
+
+	// key: track id, value: the time of the last request sent to the connector (ms)
+	std::mutex _key_frame_request_mutex;
+	std::map<int32_t, int64_t> _key_frame_request_times;
 
 public:
 	// 패킷 관리
 	bool Push(std::unique_ptr<MediaPacket> buffer, bool convert_bitstream);
 	std::unique_ptr<MediaPacket> Pop();
 	uint32_t Size();
+	// Read from the atomics, so the queue is not locked
+	MediaRouteStreamMetrics GetMetrics() const;
 
 	time_t getLastReceivedTime();
+
+	// Timer of ov::SharedTimerWheel which deletes the stream when it doesn't receive the packets (0: none)
+	void SetGarbageCollectorTimerId(uint64_t timer_id);
+	uint64_t GetGarbageCollectorTimerId() const;
+
+	// The packets from the last video key frame (with the audio packets in the same order), so a new subscriber
+	// can start the stream immediately instead of waiting for the next key frame
+	// - Empty if the stream doesn't have the video
+	void CacheGopPacket(const MediaPacket *packet);
+	std::vector<std::shared_ptr<const MediaRouteGopPacket>> GetGopCache();
+
+	// <Providers><Reconnect>: the provider is disconnected, the stream is deleted by the timer of ov::SharedTimerWheel
+	// if it isn't reconnected (set with _mutex of the application, disconnected time: ms, 0: connected)
+	void SetDisconnected(int64_t disconnected_time, uint64_t timer_id);
+	int64_t GetDisconnectedTime() const;
+	uint64_t GetReconnectTimerId() const;
+
+	// The timestamps of the provider are continued from the end of the previous connection (from the next packet),
+	// so the publishers receive the same timeline as before
+	void RebaseTimestamps();
+
 private:
+	// Push() is called by the provider and Pop() is called by MainTask of the application
+	std::mutex _queue_mutex;
 	std::queue<std::unique_ptr<MediaPacket>> _queue;
+	std::unique_ptr<MediaRouteJitterBuffer> _jitter_buffer;
+
+	std::shared_ptr<StreamLatencyStatistics> _latency_statistics;
+	std::shared_ptr<StreamCaptureWriter> _capture;
+
+	std::atomic<uint64_t> _received_packet_count { 0 };
+	std::atomic<uint64_t> _received_bytes { 0 };
+	// Same as Size(), updated with _queue_mutex
+	std::atomic<size_t> _queue_size { 0 };
+
+	// The timestamps of the provider (with _queue_mutex)
+	void UpdateTimeline(MediaPacket *packet, const std::shared_ptr<MediaTrack> &media_track);
+
+	// key: track id
+	std::map<int32_t, MediaRouteTrackTimeline> _timelines;
+	// The offset of the timelines (seconds), for the tracks which receive the first packet after the rebase
+	double _timeline_offset = 0.0;
+	bool _rebase_pending = false;
+
+	std::mutex _gop_cache_mutex;
+	std::vector<std::shared_ptr<const MediaRouteGopPacket>> _gop_cache;
+	size_t _gop_cache_bytes = 0;
 
 private:
 	////////////////////////////
@@ -60,5 +184,9 @@ private:
 
 	// 마지막으로 받은 패킷의 시간
 	time_t _last_rb_time;
+
+	std::atomic<uint64_t> _gc_timer_id { 0 };
+	std::atomic<int64_t> _disconnected_time { 0 };
+	std::atomic<uint64_t> _reconnect_timer_id { 0 };
 };
 
@@ -44,20 +44,7 @@ bool MediaRouter::Start()
 		return false;
 	}
 
-	try
-	{
-		_kill_flag = false;
-		_thread = std::thread(&MediaRouter::MainTask, this);
-	}
-	catch(const std::system_error &e)
-	{
-		_kill_flag = true;
-
-		logte("Failed to start media router thread.");
-
-		return false;
-	}
-
+	// The garbage collectors of the applications are driven by ov::SharedTimerWheel
 	logti("Media router is started.");
 
 	return true;
@@ -67,9 +54,6 @@ bool MediaRouter::Stop()
 {
 	logti("Terminated media route modules.");
 
-	_kill_flag = true;
-	_thread.join();
-
 	if(!DeleteApplication())
 	{
 		return false;
@@ -84,20 +68,7 @@ bool MediaRouter::CreateApplications()
 {
 	for(auto const &application_info : _app_info_list)
 	{
-		info::application_id_t application_id = application_info.GetId();
-
-		auto route_app = MediaRouteApplication::Create(&application_info);
-
-		if(route_app == nullptr)
-		{
-			logte("failed to allocation");
-			continue;
-		}
-
-		// 라우터 어플리케이션 관리 항목에 추가
-		_route_apps.insert(
-			std::make_pair(application_id, route_app)
-		);
+		CreateApplication(&application_info);
 	}
 
 	return true;
@@ -106,12 +77,60 @@ bool MediaRouter::CreateApplications()
 // 어플리케이션의 스트림이 삭제됨
 bool MediaRouter::DeleteApplication()
 {
-	for(auto const &_route_app : _route_apps)
+	std::map<info::application_id_t, std::shared_ptr<MediaRouteApplication>> route_apps;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+		route_apps = std::move(_route_apps);
+		_route_apps.clear();
+	}
+
+	for(auto const &_route_app : route_apps)
 	{
 		_route_app.second->Stop();
 	}
 
-	_route_apps.clear();
+	return true;
+}
+
+bool MediaRouter::CreateApplication(const info::Application *application_info)
+{
+	info::application_id_t application_id = application_info->GetId();
+
+	auto route_app = MediaRouteApplication::Create(application_info);
+
+	if(route_app == nullptr)
+	{
+		logte("failed to allocation");
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	// 라우터 어플리케이션 관리 항목에 추가
+	return _route_apps.insert(std::make_pair(application_id, route_app)).second;
+}
+
+bool MediaRouter::DeleteApplication(info::application_id_t application_id)
+{
+	std::shared_ptr<MediaRouteApplication> route_app;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		auto item = _route_apps.find(application_id);
+
+		if(item == _route_apps.end())
+		{
+			return false;
+		}
+
+		route_app = item->second;
+		_route_apps.erase(item);
+	}
+
+	// The workers are joined outside of the lock
+	route_app->Stop();
 
 	return true;
 }
@@ -119,6 +138,8 @@ bool MediaRouter::DeleteApplication()
 //  Application Name으로 RouteApplication을 찾음
 std::shared_ptr<MediaRouteApplication> MediaRouter::GetRouteApplicationById(info::application_id_t application_id)
 {
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
 	auto obj = _route_apps.find(application_id);
 
 	if(obj == _route_apps.end())
@@ -129,6 +150,28 @@ std::shared_ptr<MediaRouteApplication> MediaRouter::GetRouteApplicationById(info
 	return obj->second;
 }
 
+void MediaRouter::GetRelayStatisticsData(
+	std::vector<std::shared_ptr<RelayLinkStatisticsData>> &links,
+	std::vector<std::shared_ptr<RelayStreamStatisticsData>> &streams)
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	for(auto &route_app : _route_apps)
+	{
+		route_app.second->GetRelayStatisticsData(links, streams);
+	}
+}
+
+void MediaRouter::GetStreamMetricsData(std::vector<std::shared_ptr<MediaRouteStreamMetricsData>> &streams)
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	for(auto &route_app : _route_apps)
+	{
+		route_app.second->GetStreamMetricsData(streams);
+	}
+}
+
 // Connector의 Application이 생성되면 라우터에 등록함
 bool MediaRouter::RegisterConnectorApp(
 	const info::Application *application_info,
@@ -208,21 +251,3 @@ bool MediaRouter::UnregisterObserverApp(
 
 	return media_route_app->UnregisterObserverApp(app_obsrv);
 }
-
-
-// Application -> Stream -> BufferQueue에 있는 Buffer를 Observer에 전달하는 목적으로 사용됨.
-void MediaRouter::MainTask()
-{
-	while(!_kill_flag)
-	{
-		sleep(5);
-		// logtd("Perform a garbage collector");
-		for(auto it = _route_apps.begin(); it != _route_apps.end(); ++it)
-		{
-			auto application = it->second;
-
-			application->OnGarbageCollector();
-		}
-	}
-
-}
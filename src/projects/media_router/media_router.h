@@ -49,9 +49,22 @@ public:
 	bool CreateApplications();
 	bool DeleteApplication();
 
+	// Adds/removes an application after Start() (config reload), the other applications are not affected
+	// - application_info must be valid until the application is deleted
+	bool CreateApplication(const info::Application *application_info);
+	bool DeleteApplication(info::application_id_t application_id);
+
 	//  Application Name으로 RouteApplication을 찾음
 	std::shared_ptr<MediaRouteApplication> GetRouteApplicationById(info::application_id_t application_id);
 
+	// Collects the statistics of the relays of all the applications (for monitoring)
+	void GetRelayStatisticsData(
+		std::vector<std::shared_ptr<RelayLinkStatisticsData>> &links,
+		std::vector<std::shared_ptr<RelayStreamStatisticsData>> &streams);
+
+	// Collects the counters of the streams of all the applications (for monitoring)
+	void GetStreamMetricsData(std::vector<std::shared_ptr<MediaRouteStreamMetricsData>> &streams);
+
 private:
 	std::map<info::application_id_t, std::shared_ptr<MediaRouteApplication>> _route_apps;
 
@@ -83,12 +96,9 @@ public:
 		std::shared_ptr<MediaRouteApplicationObserver> application_observer) override;
 
 private:
-	void MainTask();
-
 	std::vector<info::Application> _app_info_list;
 
-	volatile bool _kill_flag;
-	std::thread _thread;
+	// Protects _route_apps (the applications can be added/removed by the config reload)
 	std::mutex _mutex;
 
 };
@@ -0,0 +1,25 @@
+LOCAL_PATH := $(call get_local_path)
+include $(DEFAULT_VARIABLES)
+
+LOCAL_STATIC_LIBRARIES := \
+	rtp_rtcp \
+	dtls_srtp \
+	segment_stream \
+	mediarouter \
+	ice \
+	rtmpprovider \
+	socket \
+	ovcrypto \
+	ovlibrary \
+	jsoncpp
+
+LOCAL_LDFLAGS := \
+	-lpthread \
+	-ldl \
+	`pkg-config --libs srt` \
+	`pkg-config --libs openssl` \
+	`pkg-config --libs libsrtp2`
+
+LOCAL_TARGET := micro_benchmark
+
+include $(BUILD_EXECUTABLE)
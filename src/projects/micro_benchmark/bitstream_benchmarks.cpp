@@ -0,0 +1,71 @@
+//==============================================================================
+//
+//  MicroBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include <media_router/bitstream/bitstream_to_annexb.h>
+
+#include "micro_benchmark.h"
+#include "sample_frames.h"
+
+// The frames are converted in place, so the inputs of this many iterations are copied at once (not measured)
+#define BENCHMARK_BITSTREAM_POOL_SIZE			64
+
+// An FLV video tag of the RTMP provider to Annex-B + the fragmentation header (MediaRouteStream)
+static void ConvertToAnnexB(MicroBenchmarkState &state, bool key_frame)
+{
+	BitstreamToAnnexB converter;
+	int64_t cts = 0;
+
+	auto sequence_header = SampleFrames::MakeH264FlvSequenceHeader();
+	converter.convert_to(sequence_header, cts);
+
+	auto source = SampleFrames::MakeH264Flv(static_cast<size_t>(state.GetArgument()), key_frame, 4);
+	std::vector<std::shared_ptr<ov::Data>> pool;
+
+	for(int index = 0; index < BENCHMARK_BITSTREAM_POOL_SIZE; index++)
+	{
+		// SPS/PPS are inserted to the key frames
+		pool.push_back(std::make_shared<ov::Data>(source->GetLength() + 64));
+	}
+
+	FragmentationHeader fragmentation;
+	size_t pool_index = BENCHMARK_BITSTREAM_POOL_SIZE;
+
+	while(state.KeepRunning())
+	{
+		if(pool_index == BENCHMARK_BITSTREAM_POOL_SIZE)
+		{
+			state.PauseTiming();
+
+			for(auto &data : pool)
+			{
+				data->Clear();
+				data->Append(source.get());
+			}
+
+			pool_index = 0;
+
+			state.ResumeTiming();
+		}
+
+		converter.convert_to(pool[pool_index++], cts, &fragmentation);
+	}
+
+	state.SetBytesProcessed(state.GetIterations() * static_cast<int64_t>(source->GetLength()));
+	state.SetItemsProcessed(state.GetIterations());
+}
+
+static void BitstreamToAnnexBKeyFrame(MicroBenchmarkState &state)
+{
+	ConvertToAnnexB(state, true);
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(BitstreamToAnnexBKeyFrame, SAMPLE_FRAME_SIZES);
+
+static void BitstreamToAnnexBDeltaFrame(MicroBenchmarkState &state)
+{
+	ConvertToAnnexB(state, false);
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(BitstreamToAnnexBDeltaFrame, SAMPLE_FRAME_SIZES);
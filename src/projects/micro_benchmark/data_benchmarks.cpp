@@ -0,0 +1,136 @@
+//==============================================================================
+//
+//  MicroBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "micro_benchmark.h"
+#include "sample_frames.h"
+
+// Allocation + copy of a frame (e.g. the frames are cloned for each track of a transcoded stream)
+static void DataClone(MicroBenchmarkState &state)
+{
+	auto data = SampleFrames::MakePayload(static_cast<size_t>(state.GetArgument()));
+
+	while(state.KeepRunning())
+	{
+		auto clone = data->Clone();
+
+		MicroBenchmarkDoNotOptimize(clone);
+	}
+
+	state.SetBytesProcessed(state.GetIterations() * static_cast<int64_t>(data->GetLength()));
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(DataClone, SAMPLE_FRAME_SIZES);
+
+// Subdata refers the region of the source without copying
+static void DataSubdata(MicroBenchmarkState &state)
+{
+	auto data = SampleFrames::MakePayload(static_cast<size_t>(state.GetArgument()));
+
+	while(state.KeepRunning())
+	{
+		auto subdata = data->Subdata(4);
+
+		MicroBenchmarkDoNotOptimize(subdata);
+	}
+
+	state.SetItemsProcessed(state.GetIterations());
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(DataSubdata, SAMPLE_FRAME_SIZES);
+
+// DataView shares the buffer of the source without allocating an instance
+static void DataViewSubdata(MicroBenchmarkState &state)
+{
+	auto data = SampleFrames::MakePayload(static_cast<size_t>(state.GetArgument()));
+	ov::DataView view(data);
+
+	while(state.KeepRunning())
+	{
+		auto subdata = view.Subdata(4);
+
+		MicroBenchmarkDoNotOptimize(subdata);
+	}
+
+	state.SetItemsProcessed(state.GetIterations());
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(DataViewSubdata, SAMPLE_FRAME_SIZES);
+
+// Big endian reads of the fields of a packet (e.g. the headers of RTP/RTCP/STUN)
+static void ByteStreamRead(MicroBenchmarkState &state)
+{
+	auto data = SampleFrames::MakePayload(static_cast<size_t>(state.GetArgument()));
+	size_t field_count = data->GetLength() / 8;
+
+	while(state.KeepRunning())
+	{
+		ov::ByteStream stream(data.get());
+		uint64_t sum = 0;
+
+		for(size_t index = 0; index < field_count; index++)
+		{
+			sum += stream.ReadBE16();
+			sum += stream.ReadBE16();
+			sum += stream.ReadBE32();
+		}
+
+		MicroBenchmarkDoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(state.GetIterations() * static_cast<int64_t>(field_count * 8));
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(ByteStreamRead, SAMPLE_FRAME_SIZES);
+
+// The same fields, the bounds are checked once per block
+static void ByteStreamReadBlock(MicroBenchmarkState &state)
+{
+	auto data = SampleFrames::MakePayload(static_cast<size_t>(state.GetArgument()));
+	size_t field_count = data->GetLength() / 8;
+
+	while(state.KeepRunning())
+	{
+		ov::ByteStream stream(data.get());
+		uint64_t sum = 0;
+
+		for(size_t index = 0; index < field_count; index++)
+		{
+			auto block = stream.ReadBlock(8);
+
+			sum += ov::LoadBE<uint16_t>(block);
+			sum += ov::LoadBE<uint16_t>(block + 2);
+			sum += ov::LoadBE<uint32_t>(block + 4);
+		}
+
+		MicroBenchmarkDoNotOptimize(sum);
+	}
+
+	state.SetBytesProcessed(state.GetIterations() * static_cast<int64_t>(field_count * 8));
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(ByteStreamReadBlock, SAMPLE_FRAME_SIZES);
+
+static void ByteStreamWrite(MicroBenchmarkState &state)
+{
+	auto length = static_cast<size_t>(state.GetArgument());
+	size_t field_count = length / 8;
+	ov::Data data(length);
+
+	while(state.KeepRunning())
+	{
+		data.Clear();
+
+		ov::ByteStream stream(&data);
+
+		for(size_t index = 0; index < field_count; index++)
+		{
+			stream.WriteBE16(static_cast<uint16_t>(index));
+			stream.WriteBE16(static_cast<uint16_t>(index >> 16));
+			stream.WriteBE32(static_cast<uint32_t>(index));
+		}
+
+		MicroBenchmarkDoNotOptimize(data.GetLength());
+	}
+
+	state.SetBytesProcessed(state.GetIterations() * static_cast<int64_t>(field_count * 8));
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(ByteStreamWrite, SAMPLE_FRAME_SIZES);
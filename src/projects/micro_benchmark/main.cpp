@@ -0,0 +1,293 @@
+//==============================================================================
+//
+//  MicroBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <sstream>
+
+#include <unistd.h>
+
+#include <base/ovcrypto/ovcrypto.h>
+#include <base/ovlibrary/log_write.h>
+#include <srtp2/srtp.h>
+
+#include "micro_benchmark.h"
+
+#define OV_LOG_TAG "MicroBenchmark"
+
+// A benchmark is regressed if it is slower than the baseline by this (percent)
+#define BENCHMARK_DEFAULT_THRESHOLD			10.0
+
+struct ParseOption
+{
+	// -f <regex>: runs the benchmarks of which the name matches
+	ov::String filter = "";
+	// -l: prints the names of the benchmarks
+	bool list = false;
+
+	// -m <ms>, -n <count>
+	int64_t min_time = MICRO_BENCHMARK_DEFAULT_MIN_TIME;
+	int repetitions = MICRO_BENCHMARK_DEFAULT_REPETITIONS;
+
+	// -o <json path>: the result
+	ov::String output_path = "";
+	// -a <path>: appends the result as a line (the history of the results)
+	ov::String history_path = "";
+	// -b <json path>: the result of a previous run to compare, -t <percent>
+	ov::String baseline_path = "";
+	double threshold = BENCHMARK_DEFAULT_THRESHOLD;
+};
+
+bool TryParseOption(int argc, char *argv[], ParseOption *parse_option)
+{
+	constexpr const char *opt_string = "hf:lm:n:o:a:b:t:";
+
+	while(true)
+	{
+		int name = getopt(argc, argv, opt_string);
+
+		switch(name)
+		{
+			case -1:
+				// end of arguments
+				return true;
+
+			case 'f':
+				parse_option->filter = optarg;
+				break;
+
+			case 'l':
+				parse_option->list = true;
+				break;
+
+			case 'm':
+				parse_option->min_time = std::max(::atoll(optarg), 1LL);
+				break;
+
+			case 'n':
+				parse_option->repetitions = std::max(::atoi(optarg), 1);
+				break;
+
+			case 'o':
+				parse_option->output_path = optarg;
+				break;
+
+			case 'a':
+				parse_option->history_path = optarg;
+				break;
+
+			case 'b':
+				parse_option->baseline_path = optarg;
+				break;
+
+			case 't':
+				parse_option->threshold = std::max(::atof(optarg), 0.0);
+				break;
+
+			case 'h':
+			default: // '?'
+				printf("Usage: %s [OPTION]...\n", argv[0]);
+				printf("    -f <regex>            Run the benchmarks of which the name matches\n");
+				printf("    -l                    Print the names of the benchmarks\n");
+				printf("    -m <ms>               Minimum time of a repetition (default: %d)\n", MICRO_BENCHMARK_DEFAULT_MIN_TIME);
+				printf("    -n <count>            Number of repetitions, the median is reported (default: %d)\n", MICRO_BENCHMARK_DEFAULT_REPETITIONS);
+				printf("    -o <path>             Path of the JSON result\n");
+				printf("    -a <path>             Append the JSON result as a line to the file (history)\n");
+				printf("    -b <path>             JSON result of a previous run to compare with\n");
+				printf("    -t <percent>          Fail if a benchmark is slower than the baseline by this (default: %.0f)\n", BENCHMARK_DEFAULT_THRESHOLD);
+				return false;
+		}
+	}
+}
+
+// name => ns_per_iteration of the baseline
+bool LoadBaseline(const ov::String &path, std::map<ov::String, double> *baseline)
+{
+	std::ifstream input(path.CStr());
+
+	if(input.is_open() == false)
+	{
+		logte("Could not open the baseline: %s", path.CStr());
+		return false;
+	}
+
+	std::stringstream content;
+	content << input.rdbuf();
+
+	ov::JsonObject object;
+
+	if(object.Parse(content.str().c_str()) != nullptr)
+	{
+		logte("Could not parse the baseline: %s", path.CStr());
+		return false;
+	}
+
+	for(const auto &item : object.GetJsonValue("benchmarks"))
+	{
+		if(item["name"].isString() && item["ns_per_iteration"].isNumeric())
+		{
+			(*baseline)[item["name"].asCString()] = item["ns_per_iteration"].asDouble();
+		}
+	}
+
+	return true;
+}
+
+ov::String FormatRate(double value, const char *unit)
+{
+	if(value >= 1000000000.0)
+	{
+		return ov::String::FormatString("%.2fG%s/s", value / 1000000000.0, unit);
+	}
+
+	if(value >= 1000000.0)
+	{
+		return ov::String::FormatString("%.2fM%s/s", value / 1000000.0, unit);
+	}
+
+	return ov::String::FormatString("%.2fk%s/s", value / 1000.0, unit);
+}
+
+int main(int argc, char *argv[])
+{
+	ParseOption parse_option;
+
+	if(TryParseOption(argc, argv, &parse_option) == false)
+	{
+		return 1;
+	}
+
+	ov::LogWrite::Initialize(false);
+
+	const auto &benchmarks = MicroBenchmarkRegistry::Instance()->GetBenchmarks();
+	std::regex filter(parse_option.filter.IsEmpty() ? ".*" : parse_option.filter.CStr());
+
+	if(parse_option.list)
+	{
+		for(const auto &benchmark : benchmarks)
+		{
+			if(std::regex_search(benchmark.name.CStr(), filter))
+			{
+				printf("%s\n", benchmark.name.CStr());
+			}
+		}
+
+		return 0;
+	}
+
+	std::map<ov::String, double> baseline;
+
+	if((parse_option.baseline_path.IsEmpty() == false) && (LoadBaseline(parse_option.baseline_path, &baseline) == false))
+	{
+		return 1;
+	}
+
+	if((ov::OpensslManager::InitializeOpenssl() == false) || (srtp_init() != srtp_err_status_ok))
+	{
+		logte("Could not initialize OpenSSL/SRTP");
+		return 1;
+	}
+
+	::Json::Value result(::Json::ValueType::objectValue);
+	::Json::Value &result_benchmarks = result["benchmarks"];
+	int regression_count = 0;
+
+	result["time"] = static_cast<::Json::Int64>(::time(nullptr));
+	result["min_time_ms"] = static_cast<::Json::Int64>(parse_option.min_time);
+	result["repetitions"] = parse_option.repetitions;
+
+	char host_name[256] = {};
+	::gethostname(host_name, sizeof(host_name) - 1);
+	result["host"] = host_name;
+
+	result_benchmarks = ::Json::Value(::Json::ValueType::arrayValue);
+
+	printf("%-44s %14s %14s %16s %16s\n", "Benchmark", "Iterations", "ns/iteration", "Bytes", "Items");
+
+	for(const auto &benchmark : benchmarks)
+	{
+		if(std::regex_search(benchmark.name.CStr(), filter) == false)
+		{
+			continue;
+		}
+
+		auto benchmark_result = MicroBenchmarkRegistry::Run(benchmark, parse_option.min_time, parse_option.repetitions);
+		auto value = benchmark_result.ToJson();
+
+		if(benchmark_result.error.IsEmpty() == false)
+		{
+			printf("%-44s ERROR: %s\n", benchmark.name.CStr(), benchmark_result.error.CStr());
+			result_benchmarks.append(value);
+			continue;
+		}
+
+		ov::String comparison;
+		auto baseline_item = baseline.find(benchmark.name);
+
+		if((baseline_item != baseline.end()) && (baseline_item->second > 0.0))
+		{
+			// + : slower than the baseline
+			double change = ((benchmark_result.nanoseconds_per_iteration / baseline_item->second) - 1.0) * 100.0;
+			bool is_regressed = (change > parse_option.threshold);
+
+			value["baseline_ns_per_iteration"] = baseline_item->second;
+			value["change_percent"] = change;
+			value["regressed"] = is_regressed;
+
+			comparison = ov::String::FormatString(" %+.1f%%%s", change, is_regressed ? " REGRESSED" : "");
+			regression_count += is_regressed ? 1 : 0;
+		}
+
+		printf("%-44s %14lld %14.1f %16s %16s%s\n",
+		       benchmark.name.CStr(),
+		       static_cast<long long>(benchmark_result.iterations),
+		       benchmark_result.nanoseconds_per_iteration,
+		       (benchmark_result.bytes_per_second > 0.0) ? FormatRate(benchmark_result.bytes_per_second, "B").CStr() : "",
+		       (benchmark_result.items_per_second > 0.0) ? FormatRate(benchmark_result.items_per_second, "").CStr() : "",
+		       comparison.CStr());
+		fflush(stdout);
+
+		result_benchmarks.append(value);
+	}
+
+	if(parse_option.output_path.IsEmpty() == false)
+	{
+		std::ofstream output(parse_option.output_path.CStr());
+
+		if(output.is_open() == false)
+		{
+			logte("Could not open the output: %s", parse_option.output_path.CStr());
+			return 1;
+		}
+
+		output << ov::Json::Stringify(result).CStr() << std::endl;
+	}
+
+	if(parse_option.history_path.IsEmpty() == false)
+	{
+		std::ofstream history(parse_option.history_path.CStr(), std::ios::app);
+
+		if(history.is_open() == false)
+		{
+			logte("Could not open the history: %s", parse_option.history_path.CStr());
+			return 1;
+		}
+
+		// One line per run, so that the results can be plotted by line
+		history << ov::Json::Stringify(result).Replace("\n", "").CStr() << std::endl;
+	}
+
+	if(regression_count > 0)
+	{
+		logte("%d benchmark(s) are slower than the baseline by more than %.1f%%", regression_count, parse_option.threshold);
+		return 2;
+	}
+
+	return 0;
+}
@@ -0,0 +1,153 @@
+//==============================================================================
+//
+//  MicroBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "micro_benchmark.h"
+
+#include <algorithm>
+
+#define OV_LOG_TAG "MicroBenchmark"
+
+MicroBenchmarkState::MicroBenchmarkState(int64_t iterations, int64_t argument)
+	: _iterations(iterations),
+	  _remaining_iterations(iterations),
+	  _argument(argument)
+{
+}
+
+void MicroBenchmarkState::PauseTiming()
+{
+	if(_is_timing)
+	{
+		_elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _resume_time).count();
+		_is_timing = false;
+	}
+}
+
+void MicroBenchmarkState::ResumeTiming()
+{
+	if(_is_timing == false)
+	{
+		_is_timing = true;
+		_resume_time = std::chrono::steady_clock::now();
+	}
+}
+
+::Json::Value MicroBenchmarkResult::ToJson() const
+{
+	::Json::Value value(::Json::ValueType::objectValue);
+
+	value["name"] = name.CStr();
+	value["iterations"] = static_cast<::Json::Int64>(iterations);
+	value["ns_per_iteration"] = nanoseconds_per_iteration;
+
+	if(bytes_per_second > 0.0)
+	{
+		value["bytes_per_second"] = bytes_per_second;
+	}
+
+	if(items_per_second > 0.0)
+	{
+		value["items_per_second"] = items_per_second;
+	}
+
+	if(error.IsEmpty() == false)
+	{
+		value["error"] = error.CStr();
+	}
+
+	return value;
+}
+
+bool MicroBenchmarkRegistry::Register(const char *name, MicroBenchmarkFunction function, const std::vector<int64_t> &arguments)
+{
+	if(arguments.empty())
+	{
+		_benchmarks.push_back({ name, function, 0 });
+		return true;
+	}
+
+	for(auto argument : arguments)
+	{
+		_benchmarks.push_back({ ov::String::FormatString("%s/%lld", name, static_cast<long long>(argument)), function, argument });
+	}
+
+	return true;
+}
+
+MicroBenchmarkResult MicroBenchmarkRegistry::Run(const Benchmark &benchmark, int64_t min_time, int repetitions)
+{
+	MicroBenchmarkResult result;
+	int64_t min_time_ns = min_time * 1000000LL;
+	int64_t iterations = 1;
+
+	result.name = benchmark.name;
+
+	// Finds the iterations of which a repetition takes min_time (like Google Benchmark)
+	while(true)
+	{
+		MicroBenchmarkState state(iterations, benchmark.argument);
+
+		benchmark.function(state);
+
+		if(state.GetError().IsEmpty() == false)
+		{
+			result.error = state.GetError();
+			return result;
+		}
+
+		int64_t elapsed = state.GetElapsedNanoseconds();
+
+		if((elapsed >= min_time_ns) || (iterations >= MICRO_BENCHMARK_MAX_ITERATIONS))
+		{
+			break;
+		}
+
+		// Predicts the iterations from the elapsed time with 40% margin, but grows 10x at most
+		double multiplier = (elapsed > 0) ? ((min_time_ns * 1.4) / elapsed) : 10.0;
+		multiplier = std::min(std::max(multiplier, 2.0), 10.0);
+
+		iterations = std::min(static_cast<int64_t>(iterations * multiplier), MICRO_BENCHMARK_MAX_ITERATIONS);
+	}
+
+	std::vector<MicroBenchmarkResult> samples;
+
+	for(int repetition = 0; repetition < std::max(repetitions, 1); repetition++)
+	{
+		MicroBenchmarkState state(iterations, benchmark.argument);
+
+		benchmark.function(state);
+
+		if(state.GetError().IsEmpty() == false)
+		{
+			result.error = state.GetError();
+			return result;
+		}
+
+		MicroBenchmarkResult sample;
+		double seconds = std::max(state.GetElapsedNanoseconds(), static_cast<int64_t>(1)) / 1000000000.0;
+
+		sample.nanoseconds_per_iteration = static_cast<double>(state.GetElapsedNanoseconds()) / iterations;
+		sample.bytes_per_second = state.GetBytesProcessed() / seconds;
+		sample.items_per_second = state.GetItemsProcessed() / seconds;
+
+		samples.push_back(sample);
+	}
+
+	// The median is less affected by the other processes than the mean
+	std::sort(samples.begin(), samples.end(), [](const MicroBenchmarkResult &sample1, const MicroBenchmarkResult &sample2) -> bool {
+		return sample1.nanoseconds_per_iteration < sample2.nanoseconds_per_iteration;
+	});
+
+	const auto &median = samples[samples.size() / 2];
+
+	result.iterations = iterations;
+	result.nanoseconds_per_iteration = median.nanoseconds_per_iteration;
+	result.bytes_per_second = median.bytes_per_second;
+	result.items_per_second = median.items_per_second;
+
+	return result;
+}
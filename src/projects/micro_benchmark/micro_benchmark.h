@@ -0,0 +1,191 @@
+//==============================================================================
+//
+//  MicroBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+#include <base/ovlibrary/singleton.h>
+#include <base/ovlibrary/json.h>
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+// Each benchmark runs at least this long to measure a repetition (ms)
+#define MICRO_BENCHMARK_DEFAULT_MIN_TIME		500
+#define MICRO_BENCHMARK_DEFAULT_REPETITIONS		3
+#define MICRO_BENCHMARK_MAX_ITERATIONS			static_cast<int64_t>(1000000000)
+
+// Prevents the compiler from removing the result of the measured code
+template<typename T>
+inline void MicroBenchmarkDoNotOptimize(const T &value)
+{
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// State of a repetition which is given to the benchmark function
+//
+//	void RtpPacketizerH264(MicroBenchmarkState &state)
+//	{
+//		// Preparation (not measured)
+//		...
+//		while(state.KeepRunning())
+//		{
+//			// Measured code
+//		}
+//
+//		state.SetBytesProcessed(state.GetIterations() * frame_size);
+//	}
+class MicroBenchmarkState
+{
+public:
+	MicroBenchmarkState(int64_t iterations, int64_t argument);
+
+	// The timer is started by the first call, and stopped after the last iteration
+	inline bool KeepRunning()
+	{
+		if(_remaining_iterations > 0)
+		{
+			if(_is_started == false)
+			{
+				_is_started = true;
+				ResumeTiming();
+			}
+
+			_remaining_iterations--;
+			return true;
+		}
+
+		if(_is_timing)
+		{
+			PauseTiming();
+		}
+
+		return false;
+	}
+
+	// Excludes the code between them from the measurement (e.g. resetting the input of the next iteration)
+	void PauseTiming();
+	void ResumeTiming();
+
+	int64_t GetIterations() const
+	{
+		return _iterations;
+	}
+
+	// The argument of MICRO_BENCHMARK_WITH_ARGUMENTS() (e.g. a frame size), 0 if there is no argument
+	int64_t GetArgument() const
+	{
+		return _argument;
+	}
+
+	void SetBytesProcessed(int64_t bytes)
+	{
+		_bytes_processed = bytes;
+	}
+
+	void SetItemsProcessed(int64_t items)
+	{
+		_items_processed = items;
+	}
+
+	// The benchmark is reported as failed (the function must return without calling KeepRunning())
+	void SkipWithError(const ov::String &error)
+	{
+		_error = error;
+		_remaining_iterations = 0;
+	}
+
+	int64_t GetElapsedNanoseconds() const
+	{
+		return _elapsed;
+	}
+
+	int64_t GetBytesProcessed() const
+	{
+		return _bytes_processed;
+	}
+
+	int64_t GetItemsProcessed() const
+	{
+		return _items_processed;
+	}
+
+	const ov::String &GetError() const
+	{
+		return _error;
+	}
+
+protected:
+	int64_t _iterations;
+	int64_t _remaining_iterations;
+	int64_t _argument;
+
+	bool _is_started = false;
+	bool _is_timing = false;
+	std::chrono::steady_clock::time_point _resume_time;
+	int64_t _elapsed = 0;
+
+	int64_t _bytes_processed = 0;
+	int64_t _items_processed = 0;
+	ov::String _error;
+};
+
+typedef std::function<void(MicroBenchmarkState &state)> MicroBenchmarkFunction;
+
+// Result of a benchmark (the median of the repetitions)
+struct MicroBenchmarkResult
+{
+	ov::String name;
+	int64_t iterations = 0;
+
+	double nanoseconds_per_iteration = 0.0;
+	// 0 if the benchmark doesn't set them
+	double bytes_per_second = 0.0;
+	double items_per_second = 0.0;
+
+	ov::String error;
+
+	::Json::Value ToJson() const;
+};
+
+// The benchmarks which are registered by MICRO_BENCHMARK() in the translation units
+class MicroBenchmarkRegistry : public ov::Singleton<MicroBenchmarkRegistry>
+{
+public:
+	struct Benchmark
+	{
+		// <function name>[/<argument>]
+		ov::String name;
+		MicroBenchmarkFunction function;
+		int64_t argument;
+	};
+
+	bool Register(const char *name, MicroBenchmarkFunction function, const std::vector<int64_t> &arguments = {});
+
+	const std::vector<Benchmark> &GetBenchmarks() const
+	{
+		return _benchmarks;
+	}
+
+	// Runs the benchmark until a repetition takes min_time, and returns the median of the repetitions
+	static MicroBenchmarkResult Run(const Benchmark &benchmark, int64_t min_time, int repetitions);
+
+protected:
+	std::vector<Benchmark> _benchmarks;
+};
+
+#define MICRO_BENCHMARK_CONCAT_INTERNAL(a, b)		a##b
+#define MICRO_BENCHMARK_CONCAT(a, b)				MICRO_BENCHMARK_CONCAT_INTERNAL(a, b)
+
+// Registers void function(MicroBenchmarkState &state) as a benchmark
+#define MICRO_BENCHMARK(function) \
+	static bool MICRO_BENCHMARK_CONCAT(_micro_benchmark_registered_, __LINE__) = MicroBenchmarkRegistry::Instance()->Register(#function, function)
+
+// Registers a benchmark for each argument (named <function>/<argument>)
+#define MICRO_BENCHMARK_WITH_ARGUMENTS(function, ...) \
+	static bool MICRO_BENCHMARK_CONCAT(_micro_benchmark_registered_, __LINE__) = MicroBenchmarkRegistry::Instance()->Register(#function, function, { __VA_ARGS__ })
@@ -0,0 +1,188 @@
+//==============================================================================
+//
+//  MicroBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include <ice/stun/attributes/stun_attributes.h>
+#include <ice/stun/stun_message.h>
+#include <rtmp/chunk/amf_document.h>
+#include <rtmp/chunk/rtmp_define.h>
+
+#include "micro_benchmark.h"
+
+#define BENCHMARK_ICE_LOCAL_UFRAG				"Wd3v"
+#define BENCHMARK_ICE_REMOTE_UFRAG				"Rk8QeZ3n"
+#define BENCHMARK_ICE_PASSWORD					"4VxiSjHAPFoK8n2QcZb7aLmT"
+
+// A binding request of a browser (USERNAME, MESSAGE-INTEGRITY, FINGERPRINT)
+static std::shared_ptr<ov::Data> MakeBindingRequest()
+{
+	uint8_t transaction_id[OV_STUN_TRANSACTION_ID_LENGTH];
+
+	for(int index = 0; index < OV_STUN_TRANSACTION_ID_LENGTH; index++)
+	{
+		transaction_id[index] = static_cast<uint8_t>(index + 1);
+	}
+
+	StunMessage message;
+
+	message.SetClass(StunClass::Request);
+	message.SetMethod(StunMethod::Binding);
+	message.SetTransactionId(transaction_id);
+
+	auto attribute = std::make_unique<StunUserNameAttribute>();
+	attribute->SetUserName(BENCHMARK_ICE_LOCAL_UFRAG ":" BENCHMARK_ICE_REMOTE_UFRAG);
+	message.AddAttribute(std::move(attribute));
+
+	return message.Serialize(BENCHMARK_ICE_PASSWORD);
+}
+
+// Parsing of the attributes + MESSAGE-INTEGRITY (the slow path of IcePort)
+static void StunMessageParse(MicroBenchmarkState &state)
+{
+	auto request = MakeBindingRequest();
+
+	if(request == nullptr)
+	{
+		state.SkipWithError("Could not make a binding request");
+		return;
+	}
+
+	while(state.KeepRunning())
+	{
+		ov::ByteStream stream(request.get());
+		StunMessage message;
+
+		bool result = message.Parse(stream) && message.CheckIntegrity(BENCHMARK_ICE_PASSWORD);
+
+		MicroBenchmarkDoNotOptimize(result);
+	}
+
+	state.SetBytesProcessed(state.GetIterations() * static_cast<int64_t>(request->GetLength()));
+	state.SetItemsProcessed(state.GetIterations());
+}
+MICRO_BENCHMARK(StunMessageParse);
+
+// The table of the attributes over the datagram (the slow path of IcePort)
+static void StunMessageParseFlat(MicroBenchmarkState &state)
+{
+	auto request = MakeBindingRequest();
+
+	if(request == nullptr)
+	{
+		state.SkipWithError("Could not make a binding request");
+		return;
+	}
+
+	while(state.KeepRunning())
+	{
+		StunMessage message;
+		ov::String local_ufrag;
+
+		bool result = message.ParseFlat(request.get()) && message.GetUfrags(&local_ufrag, nullptr) && message.CheckIntegrity(BENCHMARK_ICE_PASSWORD);
+
+		MicroBenchmarkDoNotOptimize(result);
+	}
+
+	state.SetBytesProcessed(state.GetIterations() * static_cast<int64_t>(request->GetLength()));
+	state.SetItemsProcessed(state.GetIterations());
+}
+MICRO_BENCHMARK(StunMessageParseFlat);
+
+// USERNAME + FINGERPRINT without parsing the attributes (the fast path of IcePort)
+static void StunMessageIsBindingRequestOf(MicroBenchmarkState &state)
+{
+	auto request = MakeBindingRequest();
+
+	if(request == nullptr)
+	{
+		state.SkipWithError("Could not make a binding request");
+		return;
+	}
+
+	ov::String local_ufrag = BENCHMARK_ICE_LOCAL_UFRAG;
+
+	while(state.KeepRunning())
+	{
+		bool result = StunMessage::IsBindingRequestOf(request.get(), local_ufrag);
+
+		MicroBenchmarkDoNotOptimize(result);
+	}
+
+	state.SetItemsProcessed(state.GetIterations());
+}
+MICRO_BENCHMARK(StunMessageIsBindingRequestOf);
+
+// A binding response with XOR-MAPPED-ADDRESS, MESSAGE-INTEGRITY and FINGERPRINT
+static void StunMessageSerialize(MicroBenchmarkState &state)
+{
+	ov::SocketAddress address("192.168.0.100", 50000);
+	uint8_t transaction_id[OV_STUN_TRANSACTION_ID_LENGTH] = {};
+
+	while(state.KeepRunning())
+	{
+		StunMessage message;
+
+		message.SetClass(StunClass::SuccessResponse);
+		message.SetMethod(StunMethod::Binding);
+		message.SetTransactionId(transaction_id);
+
+		auto attribute = std::make_unique<StunXorMappedAddressAttribute>();
+		attribute->SetParameters(address);
+		message.AddAttribute(std::move(attribute));
+
+		auto serialized = message.Serialize(BENCHMARK_ICE_PASSWORD);
+
+		MicroBenchmarkDoNotOptimize(serialized);
+		transaction_id[0]++;
+	}
+
+	state.SetItemsProcessed(state.GetIterations());
+}
+MICRO_BENCHMARK(StunMessageSerialize);
+
+// The connect command of an encoder
+static void AmfDocumentDecode(MicroBenchmarkState &state)
+{
+	AmfDocument document;
+	auto object = new AmfObject;
+
+	document.AddProperty(RTMP_CMD_NAME_CONNECT);
+	document.AddProperty(1.0);
+
+	object->AddProperty("app", "app");
+	object->AddProperty("type", "nonprivate");
+	object->AddProperty("flashVer", "FMLE/3.0 (compatible; FMSc/1.0)");
+	object->AddProperty("swfUrl", "rtmp://192.168.0.100:1935/app");
+	object->AddProperty("tcUrl", "rtmp://192.168.0.100:1935/app");
+	object->AddProperty("fpad", false);
+	object->AddProperty("capabilities", 239.0);
+	object->AddProperty("audioCodecs", 3575.0);
+	object->AddProperty("videoCodecs", 252.0);
+	object->AddProperty("videoFunction", 1.0);
+	document.AddProperty(object);
+
+	std::vector<uint8_t> body(4096);
+	int body_size = document.Encode(body.data());
+
+	if(body_size <= 0)
+	{
+		state.SkipWithError("Could not encode the command");
+		return;
+	}
+
+	while(state.KeepRunning())
+	{
+		AmfDocument decoded_document;
+
+		int result = decoded_document.Decode(body.data(), body_size);
+
+		MicroBenchmarkDoNotOptimize(result);
+	}
+
+	state.SetBytesProcessed(state.GetIterations() * body_size);
+	state.SetItemsProcessed(state.GetIterations());
+}
+MICRO_BENCHMARK(AmfDocumentDecode);
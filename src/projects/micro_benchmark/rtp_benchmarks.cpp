@@ -0,0 +1,261 @@
+//==============================================================================
+//
+//  MicroBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include <base/ovlibrary/ovlibrary.h>
+#include <base/ovlibrary/byte_io.h>
+#include <dtls_srtp/srtp_adapter.h>
+#include <rtp_rtcp/rtcp_packet.h>
+#include <rtp_rtcp/rtp_packetizer.h>
+#include <rtp_rtcp/rtp_rtcp_interface.h>
+#include <rtp_rtcp/ulpfec_generator.h>
+
+#include <openssl/srtp.h>
+
+#include "micro_benchmark.h"
+#include "sample_frames.h"
+
+#define BENCHMARK_RTP_PAYLOAD_TYPE				96
+#define BENCHMARK_RED_PAYLOAD_TYPE				120
+#define BENCHMARK_ULPFEC_PAYLOAD_TYPE			121
+#define BENCHMARK_RTP_SSRC						0x12345678
+// Payload size of the media packets of the FEC/SRTP benchmarks (same as the packetizer makes)
+#define BENCHMARK_RTP_PAYLOAD_SIZE				1200
+
+// Receives the packets instead of RtcSession (the packets are released immediately, like a session without NACK)
+class BenchmarkRtpSession : public RtpRtcpPacketizerInterface
+{
+public:
+	bool OnRtpPacketized(std::shared_ptr<RtpPacket> packet) override
+	{
+		_packet_count++;
+		_byte_count += packet->PayloadSize();
+
+		return true;
+	}
+
+	bool OnRtcpPacketized(std::shared_ptr<RtcpPacket> packet) override
+	{
+		return true;
+	}
+
+	int64_t GetPacketCount() const
+	{
+		return _packet_count;
+	}
+
+protected:
+	int64_t _packet_count = 0;
+	int64_t _byte_count = 0;
+};
+
+static void PacketizeVideo(MicroBenchmarkState &state, RtpVideoCodecType codec, bool ulpfec)
+{
+	auto session = std::make_shared<BenchmarkRtpSession>();
+	RtpPacketizer packetizer(false, session);
+
+	packetizer.SetPayloadType(BENCHMARK_RTP_PAYLOAD_TYPE);
+	packetizer.SetSSRC(BENCHMARK_RTP_SSRC);
+	packetizer.SetVideoCodec(codec);
+
+	if(ulpfec)
+	{
+		packetizer.SetUlpfec(BENCHMARK_RED_PAYLOAD_TYPE, BENCHMARK_ULPFEC_PAYLOAD_TYPE);
+		packetizer.SetFecProtectionRate(ULPFEC_DEFAULT_PROTECTION_RATE);
+	}
+
+	RTPVideoHeader video_header;
+	::memset(&video_header, 0, sizeof(video_header));
+
+	video_header.codec = codec;
+
+	std::shared_ptr<ov::Data> frame;
+	auto length = static_cast<size_t>(state.GetArgument());
+
+	if(codec == RtpVideoCodecType::H264)
+	{
+		video_header.codec_header.h264.packetization_mode = H264PacketizationMode::NonInterleaved;
+		// The start codes are scanned by the packetizer (the fragmentation header is empty)
+		frame = SampleFrames::MakeH264AnnexB(length, false);
+	}
+	else
+	{
+		video_header.codec_header.vp8.InitRTPVideoHeaderVP8();
+		video_header.codec_header.vp8.picture_id = 0x8000;
+		frame = SampleFrames::MakePayload(length);
+	}
+
+	FragmentationHeader fragmentation;
+	uint32_t timestamp = 0;
+
+	while(state.KeepRunning())
+	{
+		packetizer.Packetize(FrameType::VideoFrameDelta, timestamp, frame->GetDataAs<uint8_t>(), frame->GetLength(), &fragmentation, &video_header);
+		timestamp += 3000;
+	}
+
+	state.SetBytesProcessed(state.GetIterations() * static_cast<int64_t>(frame->GetLength()));
+	state.SetItemsProcessed(session->GetPacketCount());
+}
+
+// RtpPacketizer + RtpPacketizerH264 (FU-A/STAP-A) + RtpPacketArena
+static void RtpPacketizerH264(MicroBenchmarkState &state)
+{
+	PacketizeVideo(state, RtpVideoCodecType::H264, false);
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(RtpPacketizerH264, SAMPLE_FRAME_SIZES);
+
+// Same as above, and RED + ULPFEC of each packet
+static void RtpPacketizerH264Ulpfec(MicroBenchmarkState &state)
+{
+	PacketizeVideo(state, RtpVideoCodecType::H264, true);
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(RtpPacketizerH264Ulpfec, SAMPLE_FRAME_SIZES);
+
+static void RtpPacketizerVp8(MicroBenchmarkState &state)
+{
+	PacketizeVideo(state, RtpVideoCodecType::Vp8, false);
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(RtpPacketizerVp8, SAMPLE_FRAME_SIZES);
+
+// FEC packets of a frame of <argument> media packets
+static void UlpfecGeneratorEncode(MicroBenchmarkState &state)
+{
+	UlpfecGenerator generator;
+	std::vector<std::shared_ptr<RedRtpPacket>> red_packets;
+	auto payload = SampleFrames::MakePayload(BENCHMARK_RTP_PAYLOAD_SIZE);
+
+	generator.SetProtectionRate(ULPFEC_DEFAULT_PROTECTION_RATE);
+
+	for(int64_t index = 0; index < state.GetArgument(); index++)
+	{
+		RtpPacket packet;
+
+		packet.SetPayloadType(BENCHMARK_RTP_PAYLOAD_TYPE);
+		packet.SetSsrc(BENCHMARK_RTP_SSRC);
+		packet.SetSequenceNumber(static_cast<uint16_t>(index));
+		packet.SetMarker(index == (state.GetArgument() - 1));
+		packet.SetPayload(payload->GetDataAs<uint8_t>(), payload->GetLength());
+
+		red_packets.push_back(std::make_shared<RedRtpPacket>(BENCHMARK_RED_PAYLOAD_TYPE, packet));
+	}
+
+	RedRtpPacket fec_packet;
+	int64_t fec_packet_count = 0;
+
+	while(state.KeepRunning())
+	{
+		for(auto &red_packet : red_packets)
+		{
+			generator.AddRtpPacketAndGenerateFec(red_packet);
+		}
+
+		while(generator.IsAvailableFecPackets())
+		{
+			generator.NextPacket(&fec_packet);
+			fec_packet_count++;
+		}
+	}
+
+	state.SetBytesProcessed(state.GetIterations() * state.GetArgument() * BENCHMARK_RTP_PAYLOAD_SIZE);
+	state.SetItemsProcessed(fec_packet_count);
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(UlpfecGeneratorEncode, 4, 16, 48);
+
+static void ProtectRtp(MicroBenchmarkState &state, uint64_t crypto_suite, size_t key_salt_length)
+{
+	SrtpAdapter adapter;
+
+	if(adapter.SetKey(ssrc_any_outbound, crypto_suite, SampleFrames::MakePayload(key_salt_length)) == false)
+	{
+		state.SkipWithError("Could not create an SRTP session (srtp_init() is not called?)");
+		return;
+	}
+
+	auto payload_size = static_cast<size_t>(state.GetArgument());
+	size_t packet_size = 12 + payload_size;
+	// + auth tag
+	auto packet = std::make_shared<ov::Data>(packet_size + 16);
+	auto payload = SampleFrames::MakePayload(payload_size);
+	uint8_t header[12] = { 0x80, BENCHMARK_RTP_PAYLOAD_TYPE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+	ByteWriter<uint32_t>::WriteBigEndian(header + 8, BENCHMARK_RTP_SSRC);
+
+	packet->Append(header, sizeof(header));
+	packet->Append(payload->GetData(), payload->GetLength());
+
+	uint16_t sequence_number = 0;
+
+	while(state.KeepRunning())
+	{
+		// The encrypted payload is encrypted again with the next sequence number (the content doesn't matter)
+		packet->SetLength(packet_size);
+		ByteWriter<uint16_t>::WriteBigEndian(packet->GetWritableDataAs<uint8_t>() + 2, sequence_number++);
+
+		adapter.ProtectRtp(packet);
+	}
+
+	state.SetBytesProcessed(state.GetIterations() * static_cast<int64_t>(packet_size));
+	state.SetItemsProcessed(state.GetIterations());
+}
+
+// AES-128-CM + HMAC-SHA1-80 of a media packet
+static void SrtpAdapterProtectRtp(MicroBenchmarkState &state)
+{
+	// master key (16) + master salt (14)
+	ProtectRtp(state, SRTP_AES128_CM_SHA1_80, 30);
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(SrtpAdapterProtectRtp, 160, BENCHMARK_RTP_PAYLOAD_SIZE);
+
+// AEAD-AES-128-GCM of a media packet (fails if libsrtp is not built with OpenSSL)
+static void SrtpAdapterProtectRtpAesGcm(MicroBenchmarkState &state)
+{
+	// master key (16) + master salt (12)
+	ProtectRtp(state, SRTP_AEAD_AES_128_GCM, 28);
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(SrtpAdapterProtectRtpAesGcm, 160, BENCHMARK_RTP_PAYLOAD_SIZE);
+
+// An SR for each of the sessions (the argument), made from scratch for each session (the clock is read every time)
+static void RtcpMakeSrPacket(MicroBenchmarkState &state)
+{
+	auto session_count = static_cast<uint32_t>(state.GetArgument());
+
+	while(state.KeepRunning())
+	{
+		for(uint32_t index = 0; index < session_count; index++)
+		{
+			MicroBenchmarkDoNotOptimize(RtcpPacket::MakeSrPacket(BENCHMARK_RTP_SSRC + index));
+		}
+	}
+
+	state.SetItemsProcessed(state.GetIterations() * session_count);
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(RtcpMakeSrPacket, 100, 1000);
+
+// The same SRs from the template of the stream (made once per interval), each session copies it to its buffer and patches it
+static void RtcpPatchSrTemplate(MicroBenchmarkState &state)
+{
+	auto session_count = static_cast<uint32_t>(state.GetArgument());
+	auto report_buffer = std::make_shared<ov::Data>(RTCP_SR_PACKET_SIZE);
+	RtcpSrTemplate sr_template;
+
+	while(state.KeepRunning())
+	{
+		RtcpPacket::MakeSrTemplate(0, sr_template);
+
+		for(uint32_t index = 0; index < session_count; index++)
+		{
+			report_buffer->SetLength(0);
+			report_buffer->Append(sr_template.packet, RTCP_SR_PACKET_SIZE);
+			RtcpPacket::PatchSrPacket(report_buffer->GetWritableDataAs<uint8_t>(), BENCHMARK_RTP_SSRC + index, index, index, index);
+
+			MicroBenchmarkDoNotOptimize(report_buffer);
+		}
+	}
+
+	state.SetItemsProcessed(state.GetIterations() * session_count);
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(RtcpPatchSrTemplate, 100, 1000);
@@ -0,0 +1,151 @@
+//==============================================================================
+//
+//  MicroBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "sample_frames.h"
+
+#include <base/ovlibrary/byte_io.h>
+
+#include <algorithm>
+
+// Baseline profile, level 3.1, 1280x720
+static const std::vector<uint8_t> g_sps = { 0x67, 0x42, 0xC0, 0x1F, 0xDA, 0x01, 0x40, 0x16, 0xE8, 0x40 };
+static const std::vector<uint8_t> g_pps = { 0x68, 0xCE, 0x3C, 0x80 };
+
+static void FillPayload(uint8_t *buffer, size_t length, uint32_t *state)
+{
+	for(size_t index = 0; index < length; index++)
+	{
+		// xorshift32
+		*state ^= *state << 13;
+		*state ^= *state >> 17;
+		*state ^= *state << 5;
+
+		buffer[index] = static_cast<uint8_t>((*state % 255) + 1);
+	}
+}
+
+std::shared_ptr<ov::Data> SampleFrames::MakePayload(size_t length, uint32_t seed)
+{
+	auto data = std::make_shared<ov::Data>(length);
+	uint32_t state = (seed == 0) ? 1 : seed;
+
+	data->SetLength(length);
+	FillPayload(data->GetWritableDataAs<uint8_t>(), length, &state);
+
+	return data;
+}
+
+const std::vector<uint8_t> &SampleFrames::GetSps()
+{
+	return g_sps;
+}
+
+const std::vector<uint8_t> &SampleFrames::GetPps()
+{
+	return g_pps;
+}
+
+std::vector<size_t> SampleFrames::SplitNalUnits(size_t length, bool key_frame, int nal_unit_count)
+{
+	std::vector<size_t> lengths;
+	size_t parameter_sets_length = key_frame ? (g_sps.size() + g_pps.size()) : 0;
+	size_t slice_length = std::max(length, parameter_sets_length + nal_unit_count * 2) - parameter_sets_length;
+	size_t count = static_cast<size_t>(std::max(nal_unit_count, 1));
+
+	for(size_t index = 0; index < count; index++)
+	{
+		// The remainder is added to the last NAL unit
+		lengths.push_back((index == (count - 1)) ? (slice_length - (slice_length / count) * (count - 1)) : (slice_length / count));
+	}
+
+	return lengths;
+}
+
+std::shared_ptr<ov::Data> SampleFrames::MakeH264AnnexB(size_t length, bool key_frame, int nal_unit_count)
+{
+	static const uint8_t start_code[4] = { 0x00, 0x00, 0x00, 0x01 };
+
+	auto lengths = SplitNalUnits(length, key_frame, nal_unit_count);
+	auto data = std::make_shared<ov::Data>(length + (lengths.size() + 2) * sizeof(start_code));
+	uint32_t state = static_cast<uint32_t>(length);
+
+	if(key_frame)
+	{
+		data->Append(start_code, sizeof(start_code));
+		data->Append(g_sps.data(), g_sps.size());
+		data->Append(start_code, sizeof(start_code));
+		data->Append(g_pps.data(), g_pps.size());
+	}
+
+	for(auto nal_length : lengths)
+	{
+		// nal_ref_idc: 3, nal_unit_type: IDR(5) or non-IDR(1)
+		uint8_t header = key_frame ? 0x65 : 0x61;
+		std::vector<uint8_t> payload(nal_length - 1);
+
+		FillPayload(payload.data(), payload.size(), &state);
+
+		data->Append(start_code, sizeof(start_code));
+		data->Append(&header, 1);
+		data->Append(payload.data(), payload.size());
+	}
+
+	return data;
+}
+
+std::shared_ptr<ov::Data> SampleFrames::MakeH264Flv(size_t length, bool key_frame, int nal_unit_count)
+{
+	auto lengths = SplitNalUnits(length, key_frame, nal_unit_count);
+	auto data = std::make_shared<ov::Data>(length + 5 + lengths.size() * 4);
+	uint32_t state = static_cast<uint32_t>(length);
+	uint8_t buffer[5];
+
+	// FrameType(4) + CodecID(4), AVCPacketType: NALU, CompositionTime: 0
+	buffer[0] = key_frame ? 0x17 : 0x27;
+	buffer[1] = 0x01;
+	buffer[2] = buffer[3] = buffer[4] = 0x00;
+	data->Append(buffer, 5);
+
+	for(auto nal_length : lengths)
+	{
+		uint8_t header = key_frame ? 0x65 : 0x61;
+		std::vector<uint8_t> payload(nal_length - 1);
+
+		FillPayload(payload.data(), payload.size(), &state);
+
+		ByteWriter<uint32_t>::WriteBigEndian(buffer, static_cast<uint32_t>(nal_length));
+		data->Append(buffer, 4);
+		data->Append(&header, 1);
+		data->Append(payload.data(), payload.size());
+	}
+
+	return data;
+}
+
+std::shared_ptr<ov::Data> SampleFrames::MakeH264FlvSequenceHeader()
+{
+	auto data = std::make_shared<ov::Data>();
+	uint8_t buffer[5] = { 0x17, 0x00, 0x00, 0x00, 0x00 };
+
+	data->Append(buffer, 5);
+
+	// AVCDecoderConfigurationRecord (lengthSizeMinusOne: 3)
+	uint8_t record[6] = { 0x01, g_sps[1], g_sps[2], g_sps[3], 0xFF, 0xE1 };
+	data->Append(record, sizeof(record));
+
+	ByteWriter<uint16_t>::WriteBigEndian(buffer, static_cast<uint16_t>(g_sps.size()));
+	data->Append(buffer, 2);
+	data->Append(g_sps.data(), g_sps.size());
+
+	buffer[0] = 0x01;
+	data->Append(buffer, 1);
+	ByteWriter<uint16_t>::WriteBigEndian(buffer, static_cast<uint16_t>(g_pps.size()));
+	data->Append(buffer, 2);
+	data->Append(g_pps.data(), g_pps.size());
+
+	return data;
+}
@@ -0,0 +1,42 @@
+//==============================================================================
+//
+//  MicroBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <vector>
+
+// Frame sizes of the benchmarks (bytes): an audio frame, P frames of 720p/1080p, a key frame of 1080p
+#define SAMPLE_FRAME_SIZES						200, 4000, 20000, 100000
+
+// The inputs of the benchmarks
+//
+// - The payloads are random bytes without zero, so they never have a start code (like the emulation prevention)
+// - The same seed makes the same data, so the results of the runs are comparable
+class SampleFrames
+{
+public:
+	static std::shared_ptr<ov::Data> MakePayload(size_t length, uint32_t seed = 1);
+
+	// H.264 NAL units of a frame with the start codes (SPS + PPS + IDR if key_frame, otherwise a non-IDR slice)
+	//
+	// nal_unit_count: the slice is split into this many NAL units
+	static std::shared_ptr<ov::Data> MakeH264AnnexB(size_t length, bool key_frame, int nal_unit_count = 1);
+
+	// An FLV video tag (AVCPacketType 1) of the AVCC NAL units, which is given by the RTMP provider
+	static std::shared_ptr<ov::Data> MakeH264Flv(size_t length, bool key_frame, int nal_unit_count = 1);
+	// An FLV video tag of the AVCDecoderConfigurationRecord (AVCPacketType 0)
+	static std::shared_ptr<ov::Data> MakeH264FlvSequenceHeader();
+
+	static const std::vector<uint8_t> &GetSps();
+	static const std::vector<uint8_t> &GetPps();
+
+protected:
+	// Lengths of the NAL units of a frame (the headers are included)
+	static std::vector<size_t> SplitNalUnits(size_t length, bool key_frame, int nal_unit_count);
+};
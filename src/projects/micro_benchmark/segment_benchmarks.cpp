@@ -0,0 +1,80 @@
+//==============================================================================
+//
+//  MicroBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include <segment_stream/packetyzer/m4s_fragment_writer.h>
+#include <segment_stream/packetyzer/ts_writer.h>
+
+#include "micro_benchmark.h"
+#include "sample_frames.h"
+
+// A fragment/segment of a second of 30 fps video
+#define BENCHMARK_SEGMENT_FRAME_COUNT			30
+// 90kHz, 30 fps
+#define BENCHMARK_SEGMENT_FRAME_DURATION		3000
+
+// PES + TS packets of the frames of a segment (the frames are Annex-B, like HlsPacketyzer)
+static void TsWriterWriteSample(MicroBenchmarkState &state)
+{
+	auto length = static_cast<size_t>(state.GetArgument());
+	auto key_frame = SampleFrames::MakeH264AnnexB(length, true);
+	auto frame = SampleFrames::MakeH264AnnexB(length, false);
+	int64_t frame_count = 0;
+
+	while(state.KeepRunning())
+	{
+		TsWriter writer(true, false);
+
+		writer.ReserveSampleData((key_frame->GetLength() + frame->GetLength() * (BENCHMARK_SEGMENT_FRAME_COUNT - 1)), BENCHMARK_SEGMENT_FRAME_COUNT);
+
+		for(int index = 0; index < BENCHMARK_SEGMENT_FRAME_COUNT; index++)
+		{
+			writer.WriteSample(true, (index == 0), frame_count * BENCHMARK_SEGMENT_FRAME_DURATION, 0, (index == 0) ? key_frame : frame);
+			frame_count++;
+		}
+
+		MicroBenchmarkDoNotOptimize(writer.GetDataStream()->size());
+	}
+
+	state.SetBytesProcessed(state.GetIterations() * static_cast<int64_t>(key_frame->GetLength() + frame->GetLength() * (BENCHMARK_SEGMENT_FRAME_COUNT - 1)));
+	state.SetItemsProcessed(frame_count);
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(TsWriterWriteSample, SAMPLE_FRAME_SIZES);
+
+// moof + mdat of the frames of a segment (the samples are length-prefixed, like DashPacketyzer)
+static void M4sFragmentWriterCreateData(MicroBenchmarkState &state)
+{
+	auto length = static_cast<size_t>(state.GetArgument());
+	// Without the FLV video tag header (5 bytes)
+	auto key_frame = ov::DataView(SampleFrames::MakeH264Flv(length, true)).Subdata(5);
+	auto frame = ov::DataView(SampleFrames::MakeH264Flv(length, false)).Subdata(5);
+	std::vector<std::shared_ptr<FragmentSampleData>> sample_datas;
+
+	for(int index = 0; index < BENCHMARK_SEGMENT_FRAME_COUNT; index++)
+	{
+		sample_datas.push_back(std::make_shared<FragmentSampleData>(BENCHMARK_SEGMENT_FRAME_DURATION,
+		                                                            (index == 0) ? 0X02000000 : 0X01010000,
+		                                                            0,
+		                                                            (index == 0) ? key_frame : frame,
+		                                                            true));
+	}
+
+	uint32_t sequence_number = 1;
+
+	while(state.KeepRunning())
+	{
+		M4sFragmentWriter writer(M4sMediaType::VideoMediaType, 4096, sequence_number, 1, sequence_number * BENCHMARK_SEGMENT_FRAME_COUNT * BENCHMARK_SEGMENT_FRAME_DURATION, sample_datas);
+
+		writer.CreateData();
+		sequence_number++;
+
+		MicroBenchmarkDoNotOptimize(writer.GetDataStream()->size());
+	}
+
+	state.SetBytesProcessed(state.GetIterations() * static_cast<int64_t>(key_frame.GetLength() + frame.GetLength() * (BENCHMARK_SEGMENT_FRAME_COUNT - 1)));
+	state.SetItemsProcessed(state.GetIterations() * BENCHMARK_SEGMENT_FRAME_COUNT);
+}
+MICRO_BENCHMARK_WITH_ARGUMENTS(M4sFragmentWriterCreateData, SAMPLE_FRAME_SIZES);
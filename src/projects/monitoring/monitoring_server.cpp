@@ -9,8 +9,15 @@
 
 #include "monitoring_server.h"
 #include "monitoring_interceptor.h"
+#include "../base/application/stream_latency.h"
+#include "../base/application/stream_qoe.h"
+#include "../base/application/stream_memory.h"
+#include "../base/application/stream_overload.h"
+#include "../base/application/application_quota.h"
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <tuple>
 
 #define OV_LOG_TAG "Monitoring"
 
@@ -39,7 +46,8 @@ ov::String GetCurrentIso8601Time()
 bool MonitoringServer::Start(const ov::SocketAddress &address,
                              const std::vector<std::shared_ptr<pvd::Provider>> &providers,
                              const std::vector<std::shared_ptr<Publisher>> &publishers,
-                             const std::shared_ptr<Certificate> &certificate)
+                             const std::shared_ptr<Certificate> &certificate,
+                             const std::shared_ptr<MediaRouter> &router)
 {
     if (_http_server != nullptr)
     {
@@ -62,8 +70,9 @@ bool MonitoringServer::Start(const ov::SocketAddress &address,
 
     auto monitoring_interceptor = std::make_shared<MonitoringInterceptor>();
 
-    // app_name/stream_name/file_name.ext?param=value
-    ov::String regular_expression = "(([^ #?]*)/([^ #?]*)/)?(stat)[?]?([^ #]*)#?([^ ]*)?";
+    // app_name/stream_name/file_name.ext?param=value (or /file_name, e.g. /metrics)
+    // - The file name is dispatched by ProcessRequest()
+    ov::String regular_expression = "(([^ #?]*)/)?([^ #?/]+)[?]?([^ #]*)#?([^ ]*)?";
 
     auto process_func = std::bind(&MonitoringServer::ProcessRequest,
                                     this,
@@ -78,12 +87,27 @@ bool MonitoringServer::Start(const ov::SocketAddress &address,
 
     _providers.assign(providers.begin(), providers.end());
     _publishers.assign(publishers.begin(), publishers.end());
+    _router = router;
 
     logtd("Monitoring Server Start - provider(%u) publisher(%u)", _providers.size(), _publishers.size());
 
     return _http_server->Start(address);
 }
 
+//====================================================================================================
+// UpdateModules
+//====================================================================================================
+void MonitoringServer::UpdateModules(const std::vector<std::shared_ptr<pvd::Provider>> &providers,
+                                     const std::vector<std::shared_ptr<Publisher>> &publishers)
+{
+    std::lock_guard<std::mutex> lock_guard(_module_mutex);
+
+    _providers.assign(providers.begin(), providers.end());
+    _publishers.assign(publishers.begin(), publishers.end());
+
+    logtd("Monitoring Server modules are updated - provider(%zu) publisher(%zu)", _providers.size(), _publishers.size());
+}
+
 //====================================================================================================
 // Stop
 //====================================================================================================
@@ -109,21 +133,16 @@ bool MonitoringServer::RequestUrlParsing(const ov::String &request_url,
                                             ov::String &file_name,
                                             ov::String &file_ext)
 {
-    ov::String request_path;
-    ov::String request_param;
+    // The tokens refer to request_url (only file_name/file_ext are copied)
+    ov::StringView url(request_url);
 
     // param split directory/file.ext?param=test
-    auto tokens = request_url.Split("?");
-    if (tokens.size() == 0)
-    {
-        return false;
-    }
+    auto tokens = url.Split("?");
 
-    request_path = tokens[0];
-    request_param = tokens.size() == 2 ? tokens[1] : "";
+    ov::StringView request_path = tokens[0];
+    ov::StringView request_param = tokens.size() == 2 ? tokens[1] : ov::StringView();
 
     // ...../app_name/stream_name/file_name.ext_name split
-    tokens.clear();
     tokens = request_path.Split("/");
 
     if (tokens.size() < 2)
@@ -131,22 +150,25 @@ bool MonitoringServer::RequestUrlParsing(const ov::String &request_url,
         return false;
     }
 
-    file_name = tokens[tokens.size() - 1];
+    ov::StringView name = tokens[tokens.size() - 1];
+    file_name = name.ToString();
 
     // file_name.ext_name seprator
-    tokens.clear();
-    tokens = file_name.Split(".");
+    tokens = name.Split(".");
     if (tokens.size() == 2)
     {
-        file_ext = tokens[1];
+        file_ext = tokens[1].ToString();
     }
 
     logtd("request : %s\n"\
-         "request path : %s\n"\
-         "request param : %s\n"\
+         "request path : %.*s\n"\
+         "request param : %.*s\n"\
          "file name : %s\n"\
          "file ext : %s\n",
-          request_url.CStr(), request_path.CStr(), request_param.CStr(),  file_name.CStr(),file_ext.CStr());
+          request_url.CStr(),
+          static_cast<int>(request_path.GetLength()), request_path.GetData(),
+          static_cast<int>(request_param.GetLength()), request_param.GetData(),
+          file_name.CStr(), file_ext.CStr());
 
     return true;
 }
@@ -163,6 +185,8 @@ void MonitoringServer::ProcessRequest(const std::shared_ptr<HttpRequest> &reques
 
     logtd("Request URL  : %s", request_url.CStr());
 
+    std::lock_guard<std::mutex> lock_guard(_module_mutex);
+
     // URL parsing
     if (!RequestUrlParsing(request_url, file_name, file_ext))
     {
@@ -176,6 +200,36 @@ void MonitoringServer::ProcessRequest(const std::shared_ptr<HttpRequest> &reques
         StateRequest(response);
     else if(file_name == "test")
         StateRequest(response);
+    else if(file_name == "workers")
+        WorkerRequest(response);
+    else if(file_name == "buffers")
+        BufferPoolRequest(response);
+    else if(file_name == "connections")
+        ConnectionRequest(response);
+    else if(file_name == "transports")
+        TransportRequest(response);
+    else if(file_name == "relays")
+        RelayRequest(response);
+    else if(file_name == "relay_streams")
+        RelayStreamRequest(response);
+    else if(file_name == "latencies")
+        LatencyRequest(response);
+    else if(file_name == "qoe")
+        QoeRequest(response);
+    else if(file_name == "qoe_sessions")
+        QoeSessionRequest(response);
+    else if(file_name == "locks")
+        LockRequest(request_url, response);
+    else if(file_name == "memory")
+        MemoryRequest(response);
+    else if(file_name == "trace" && file_ext == "json")
+        TraceExportRequest(request_url, response);
+    else if(file_name == "trace")
+        TraceRequest(request_url, response);
+    else if(file_name == "metrics")
+        MetricsRequest(response);
+    else if(file_name == "reload")
+        ReloadRequest(response);
     else
     {
         response->SetStatusCode(HttpStatusCode::NotFound);
@@ -330,4 +384,1094 @@ void MonitoringServer::StateRequest(const std::shared_ptr<HttpResponse> &respons
     {
         logte("State Response Fail");
     }
-}
\ No newline at end of file
+}
+
+//====================================================================================================
+// WorkerRequest
+// - load of each stream worker
+//
+// {app},{stream},{worker index},{session count},{queue size},{send time per session(ns)},{datetime}
+// ex)
+//      live,stream2,0,120,3,8500,2019-03-25T09:58:58+00:00
+//      live,stream2,1,118,0,8200,2019-03-25T09:58:58+00:00
+//====================================================================================================
+void MonitoringServer::WorkerRequest(const std::shared_ptr<HttpResponse> &response)
+{
+    std::vector<std::shared_ptr<StreamWorkerLoadData>> loads;
+
+    for (const auto &publisher : _publishers)
+    {
+        publisher->GetStreamWorkerLoadData(loads);
+    }
+
+    std::ostringstream string_stream;
+    ov::String current_time = GetCurrentIso8601Time();
+
+    for(const auto &load_data : loads)
+    {
+        string_stream
+        << load_data->app_name.CStr()                << COLLECTION_DATA_SEPARATOR
+        << load_data->stream_name.CStr()             << COLLECTION_DATA_SEPARATOR
+        << load_data->load.index                     << COLLECTION_DATA_SEPARATOR
+        << load_data->load.session_count             << COLLECTION_DATA_SEPARATOR
+        << load_data->load.queue_size                << COLLECTION_DATA_SEPARATOR
+        << load_data->load.send_time_per_session     << COLLECTION_DATA_SEPARATOR
+        << current_time.CStr()                       << COLLECTION_DATA_LINE_END;
+    }
+
+    ov::String data = string_stream.str().c_str();
+
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("Worker Response Fail");
+    }
+}
+
+//====================================================================================================
+// BufferPoolRequest
+// - hit rate of the buffer pool (ov::Data)
+//
+// {size class},{capacity},{alloc},{local hit},{global hit},{miss},{release},{discard},{hit rate(%)}
+//====================================================================================================
+void MonitoringServer::BufferPoolRequest(const std::shared_ptr<HttpResponse> &response)
+{
+    std::ostringstream string_stream;
+
+    for(int index = 0; index < static_cast<int>(ov::BufferPool::SizeClass::NumberOfSizeClass); index++)
+    {
+        auto size_class = static_cast<ov::BufferPool::SizeClass>(index);
+        auto statistics = ov::BufferPool::GetStatistics(size_class);
+
+        string_stream
+        << ov::BufferPool::GetSizeClassString(size_class)  << COLLECTION_DATA_SEPARATOR
+        << ((index == 0) ? OV_BUFFER_POOL_SMALL_SIZE : OV_BUFFER_POOL_MTU_SIZE) << COLLECTION_DATA_SEPARATOR
+        << statistics.allocation_count                      << COLLECTION_DATA_SEPARATOR
+        << statistics.local_hit_count                       << COLLECTION_DATA_SEPARATOR
+        << statistics.global_hit_count                      << COLLECTION_DATA_SEPARATOR
+        << statistics.miss_count                            << COLLECTION_DATA_SEPARATOR
+        << statistics.release_count                         << COLLECTION_DATA_SEPARATOR
+        << statistics.discard_count                         << COLLECTION_DATA_SEPARATOR
+        << statistics.GetHitRate()                          << COLLECTION_DATA_LINE_END;
+    }
+
+    ov::String data = string_stream.str().c_str();
+
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("Buffer Pool Response Fail");
+    }
+}
+
+//====================================================================================================
+// ConnectionRequest
+// - memory of each provider connection (e.g. RTMP)
+//
+// {app},{stream},{remote},{receive buffer(bytes)},{message buffer(bytes)},{datetime}
+//====================================================================================================
+void MonitoringServer::ConnectionRequest(const std::shared_ptr<HttpResponse> &response)
+{
+    std::vector<std::shared_ptr<pvd::ConnectionMemoryData>> memories;
+
+    for (const auto &provider : _providers)
+    {
+        provider->GetConnectionMemoryData(memories);
+    }
+
+    std::ostringstream string_stream;
+    ov::String current_time = GetCurrentIso8601Time();
+
+    for(const auto &memory_data : memories)
+    {
+        string_stream
+        << memory_data->app_name.CStr()              << COLLECTION_DATA_SEPARATOR
+        << memory_data->stream_name.CStr()           << COLLECTION_DATA_SEPARATOR
+        << memory_data->remote.CStr()                << COLLECTION_DATA_SEPARATOR
+        << memory_data->receive_buffer_size          << COLLECTION_DATA_SEPARATOR
+        << memory_data->message_buffer_size          << COLLECTION_DATA_SEPARATOR
+        << current_time.CStr()                       << COLLECTION_DATA_LINE_END;
+    }
+
+    ov::String data = string_stream.str().c_str();
+
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("Connection Response Fail");
+    }
+}
+
+//====================================================================================================
+// LatencyRequest
+// - latency of each stage of the media pipeline (microseconds, since the stream is created)
+//
+// {app},{stream},{stage},{count},{mean},{p50},{p90},{p99},{p99.9},{max},{datetime}
+// ex)
+//      live,stream2,router_queue,35210,180,95,410,2100,8800,15300,2019-03-25T09:58:58+00:00
+//      live,stream2_o,send,1203344,1450,1000,3000,9000,21000,48000,2019-03-25T09:58:58+00:00
+//====================================================================================================
+void MonitoringServer::LatencyRequest(const std::shared_ptr<HttpResponse> &response)
+{
+    std::vector<std::shared_ptr<StreamLatencyStatistics>> statistics_list;
+
+    StreamLatency::Instance()->GetAllStatistics(statistics_list);
+
+    std::ostringstream string_stream;
+    ov::String current_time = GetCurrentIso8601Time();
+
+    for(const auto &statistics : statistics_list)
+    {
+        for(int index = 0; index < static_cast<int>(StreamLatencyStage::NumberOfStages); index++)
+        {
+            auto stage = static_cast<StreamLatencyStage>(index);
+            auto &histogram = statistics->GetHistogram(stage);
+
+            // The stages which the stream doesn't pass (e.g. decode of the output stream)
+            if(histogram.GetCount() == 0)
+                continue;
+
+            string_stream
+            << statistics->GetApplicationName().CStr()          << COLLECTION_DATA_SEPARATOR
+            << statistics->GetStreamName().CStr()               << COLLECTION_DATA_SEPARATOR
+            << StreamLatencyStatistics::GetStageName(stage)     << COLLECTION_DATA_SEPARATOR
+            << histogram.GetCount()                             << COLLECTION_DATA_SEPARATOR
+            << static_cast<int64_t>(histogram.GetMean())        << COLLECTION_DATA_SEPARATOR
+            << histogram.GetPercentile(50.0)                    << COLLECTION_DATA_SEPARATOR
+            << histogram.GetPercentile(90.0)                    << COLLECTION_DATA_SEPARATOR
+            << histogram.GetPercentile(99.0)                    << COLLECTION_DATA_SEPARATOR
+            << histogram.GetPercentile(99.9)                    << COLLECTION_DATA_SEPARATOR
+            << histogram.GetMax()                               << COLLECTION_DATA_SEPARATOR
+            << current_time.CStr()                              << COLLECTION_DATA_LINE_END;
+        }
+    }
+
+    ov::String data = string_stream.str().c_str();
+
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("Latency Response Fail");
+    }
+}
+
+//====================================================================================================
+// QoeRequest
+// - QoE of the players of each stream (all sessions, loss: per mille, the others: microseconds)
+//
+// {app},{stream},{metric},{count},{mean},{p50},{p90},{p99},{max},{sampled sessions},{datetime}
+// ex)
+//      live,stream2,loss,81200,3,0,7,50,260,12,2019-03-25T09:58:58+00:00
+//      live,stream2,rebuffer,31,820000,510000,1900000,4100000,4100000,12,2019-03-25T09:58:58+00:00
+//====================================================================================================
+void MonitoringServer::QoeRequest(const std::shared_ptr<HttpResponse> &response)
+{
+    std::vector<std::shared_ptr<StreamQoeStatistics>> statistics_list;
+
+    StreamQoe::Instance()->GetAllStatistics(statistics_list);
+
+    std::ostringstream string_stream;
+    ov::String current_time = GetCurrentIso8601Time();
+
+    for(const auto &statistics : statistics_list)
+    {
+        auto sampled_session_count = statistics->GetSampledSessionCount();
+
+        for(int index = 0; index < static_cast<int>(StreamQoeMetric::NumberOfMetrics); index++)
+        {
+            auto metric = static_cast<StreamQoeMetric>(index);
+            auto &histogram = statistics->GetHistogram(metric);
+
+            // The metrics of the other protocols (e.g. RTT of HLS)
+            if(histogram.GetCount() == 0)
+                continue;
+
+            string_stream
+            << statistics->GetApplicationName().CStr()          << COLLECTION_DATA_SEPARATOR
+            << statistics->GetStreamName().CStr()               << COLLECTION_DATA_SEPARATOR
+            << StreamQoeStatistics::GetMetricName(metric)       << COLLECTION_DATA_SEPARATOR
+            << histogram.GetCount()                             << COLLECTION_DATA_SEPARATOR
+            << static_cast<int64_t>(histogram.GetMean())        << COLLECTION_DATA_SEPARATOR
+            << histogram.GetPercentile(50.0)                    << COLLECTION_DATA_SEPARATOR
+            << histogram.GetPercentile(90.0)                    << COLLECTION_DATA_SEPARATOR
+            << histogram.GetPercentile(99.0)                    << COLLECTION_DATA_SEPARATOR
+            << histogram.GetMax()                               << COLLECTION_DATA_SEPARATOR
+            << sampled_session_count                            << COLLECTION_DATA_SEPARATOR
+            << current_time.CStr()                              << COLLECTION_DATA_LINE_END;
+        }
+    }
+
+    ov::String data = string_stream.str().c_str();
+
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("QoE Response Fail");
+    }
+}
+
+//====================================================================================================
+// QoeSessionRequest
+// - details of the sampled sessions (loss: per mille of the last report, the times: microseconds)
+//
+// {app},{stream},{session},{start time},{reports},{loss},{packets lost},{jitter},{rtt},
+// {requests},{download time},{rebuffers},{rebuffer time},{datetime}
+// ex)
+//      live,stream2,webrtc/3021,1553507938,120,3,18,2100,41000,0,0,0,0,2019-03-25T09:58:58+00:00
+//      live,stream2,hls/10.0.0.7,1553507901,0,0,0,0,0,48,21000,1,820000,2019-03-25T09:58:58+00:00
+//====================================================================================================
+void MonitoringServer::QoeSessionRequest(const std::shared_ptr<HttpResponse> &response)
+{
+    std::vector<std::shared_ptr<StreamQoeStatistics>> statistics_list;
+    std::vector<StreamQoeSession> sessions;
+
+    StreamQoe::Instance()->GetAllStatistics(statistics_list);
+
+    std::ostringstream string_stream;
+    ov::String current_time = GetCurrentIso8601Time();
+
+    for(const auto &statistics : statistics_list)
+    {
+        sessions.clear();
+        statistics->GetSampledSessions(sessions);
+
+        for(const auto &session : sessions)
+        {
+            string_stream
+            << statistics->GetApplicationName().CStr()          << COLLECTION_DATA_SEPARATOR
+            << statistics->GetStreamName().CStr()               << COLLECTION_DATA_SEPARATOR
+            << session.key.CStr()                               << COLLECTION_DATA_SEPARATOR
+            << session.start_time                               << COLLECTION_DATA_SEPARATOR
+            << session.report_count                             << COLLECTION_DATA_SEPARATOR
+            << session.loss                                     << COLLECTION_DATA_SEPARATOR
+            << session.packet_lost                              << COLLECTION_DATA_SEPARATOR
+            << session.jitter                                   << COLLECTION_DATA_SEPARATOR
+            << session.rtt                                      << COLLECTION_DATA_SEPARATOR
+            << session.request_count                            << COLLECTION_DATA_SEPARATOR
+            << session.download_time                            << COLLECTION_DATA_SEPARATOR
+            << session.rebuffer_count                           << COLLECTION_DATA_SEPARATOR
+            << session.rebuffer_time                            << COLLECTION_DATA_SEPARATOR
+            << current_time.CStr()                              << COLLECTION_DATA_LINE_END;
+        }
+    }
+
+    ov::String data = string_stream.str().c_str();
+
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("QoE Session Response Fail");
+    }
+}
+
+//====================================================================================================
+// LockRequest
+// - the locks of which the total wait time is the longest (microseconds, ov::LockProfiler)
+// - parameters: enable=true|false (starts/stops the profiling), reset=true (clears the statistics),
+//               count=N (number of the locks, 0 = all)
+//
+// {name},{locks},{contentions},{wait total},{wait p50},{wait p99},{wait max},{hold total},{hold max},{enabled},{datetime}
+// ex)
+//      StreamWorker::_packet_queue_guard,8803110,42117,918333,12,140,2210,3100921,180,true,2019-03-25T09:58:58+00:00
+//====================================================================================================
+void MonitoringServer::LockRequest(const ov::String &request_url, const std::shared_ptr<HttpResponse> &response)
+{
+    auto lock_profiler = ov::LockProfiler::Instance();
+    size_t count = OV_LOCK_PROFILER_DEFAULT_TOP_COUNT;
+    auto tokens = request_url.Split("?");
+
+    if (tokens.size() == 2)
+    {
+        for (const auto &param : tokens[1].Split("&"))
+        {
+            auto key_value = param.Split("=");
+
+            if (key_value.size() != 2)
+                continue;
+
+            if (key_value[0] == "enable")
+                ov::LockProfiler::SetEnabled((key_value[1] == "true") || (key_value[1] == "1"));
+            else if (key_value[0] == "reset" && ((key_value[1] == "true") || (key_value[1] == "1")))
+                lock_profiler->Reset();
+            else if (key_value[0] == "count")
+                count = static_cast<size_t>(std::max(::atoi(key_value[1].CStr()), 0));
+        }
+    }
+
+    std::ostringstream string_stream;
+    ov::String current_time = GetCurrentIso8601Time();
+    const char *enabled = ov::LockProfiler::IsEnabled() ? "true" : "false";
+
+    for(const auto &statistics : lock_profiler->GetTopContended(count))
+    {
+        auto &wait_histogram = statistics->GetWaitHistogram();
+
+        string_stream
+        << statistics->GetName().CStr()                 << COLLECTION_DATA_SEPARATOR
+        << statistics->GetLockCount()                   << COLLECTION_DATA_SEPARATOR
+        << statistics->GetContentionCount()             << COLLECTION_DATA_SEPARATOR
+        << (statistics->GetTotalWaitTime() / 1000)      << COLLECTION_DATA_SEPARATOR
+        << wait_histogram.GetPercentile(50.0)           << COLLECTION_DATA_SEPARATOR
+        << wait_histogram.GetPercentile(99.0)           << COLLECTION_DATA_SEPARATOR
+        << wait_histogram.GetMax()                      << COLLECTION_DATA_SEPARATOR
+        << (statistics->GetTotalHoldTime() / 1000)      << COLLECTION_DATA_SEPARATOR
+        << (statistics->GetMaxHoldTime() / 1000)        << COLLECTION_DATA_SEPARATOR
+        << enabled                                      << COLLECTION_DATA_SEPARATOR
+        << current_time.CStr()                          << COLLECTION_DATA_LINE_END;
+    }
+
+    ov::String data = string_stream.str().c_str();
+
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("Lock Response Fail");
+    }
+}
+
+//====================================================================================================
+// MemoryRequest
+// - bytes used by each allocation tag, application, stream, publisher and session
+//   * tag: buffers of ov::Data (by ov::MemoryTag, the buffers cached by BufferPool are not counted)
+//   * stream: buffers of the provider connections and the queues of the transcoder
+//   * publisher: queues, GOP cache and segments of the publisher streams (session: sum of the sessions)
+//   * session: the sessions which use the most memory (MONITORING_MEMORY_SESSION_COUNT)
+//   * application: sum of the stream and publisher rows of the application
+//
+// {scope},{app},{stream},{publisher},{session},{component},{bytes},{datetime}
+// ex)
+//      tag,,,,,segment,73400320,2019-03-25T09:58:58+00:00
+//      stream,live,stream2,,,rtmp_message_buffer,1048576,2019-03-25T09:58:58+00:00
+//      publisher,live,stream2_o,hls,,store,25165824,2019-03-25T09:58:58+00:00
+//      session,live,stream2_o,webrtc,1234,session,2621440,2019-03-25T09:58:58+00:00
+//      application,live,,,,total,31457280,2019-03-25T09:58:58+00:00
+//====================================================================================================
+#define MONITORING_MEMORY_SESSION_COUNT     20
+
+void MonitoringServer::MemoryRequest(const std::shared_ptr<HttpResponse> &response)
+{
+    std::ostringstream string_stream;
+    ov::String current_time = GetCurrentIso8601Time();
+    std::map<ov::String, uint64_t> application_bytes;
+
+    auto append_row = [&](const char *scope, const ov::String &app_name, const ov::String &stream_name,
+                          const ov::String &publisher_name, const ov::String &session_id, const char *component, uint64_t bytes) {
+        string_stream
+        << scope                        << COLLECTION_DATA_SEPARATOR
+        << app_name.CStr()              << COLLECTION_DATA_SEPARATOR
+        << stream_name.CStr()           << COLLECTION_DATA_SEPARATOR
+        << publisher_name.CStr()        << COLLECTION_DATA_SEPARATOR
+        << session_id.CStr()            << COLLECTION_DATA_SEPARATOR
+        << component                    << COLLECTION_DATA_SEPARATOR
+        << bytes                        << COLLECTION_DATA_SEPARATOR
+        << current_time.CStr()          << COLLECTION_DATA_LINE_END;
+    };
+
+    // Allocation tags
+    for(int index = 0; index < static_cast<int>(ov::MemoryTag::NumberOfTags); index++)
+    {
+        auto tag = static_cast<ov::MemoryTag>(index);
+
+        append_row("tag", "", "", "", "", ov::MemoryAccounting::GetTagName(tag),
+                   static_cast<uint64_t>(std::max(ov::MemoryAccounting::GetBytes(tag), static_cast<int64_t>(0))));
+    }
+
+    // Connections of the providers
+    {
+        std::vector<std::shared_ptr<pvd::ConnectionMemoryData>> memories;
+
+        for (const auto &provider : _providers)
+        {
+            provider->GetConnectionMemoryData(memories);
+        }
+
+        for(const auto &memory_data : memories)
+        {
+            append_row("stream", memory_data->app_name, memory_data->stream_name, "", memory_data->remote, "receive_buffer", memory_data->receive_buffer_size);
+            append_row("stream", memory_data->app_name, memory_data->stream_name, "", memory_data->remote, "message_buffer", memory_data->message_buffer_size);
+
+            application_bytes[memory_data->app_name] += memory_data->receive_buffer_size + memory_data->message_buffer_size;
+        }
+    }
+
+    // Queues of the transcoder
+    {
+        std::vector<std::shared_ptr<StreamMemoryStatistics>> statistics_list;
+
+        StreamMemory::Instance()->GetAllStatistics(statistics_list);
+
+        for(const auto &statistics : statistics_list)
+        {
+            for(int index = 0; index < static_cast<int>(StreamMemoryComponent::NumberOfComponents); index++)
+            {
+                auto component = static_cast<StreamMemoryComponent>(index);
+                auto bytes = static_cast<uint64_t>(std::max(statistics->GetBytes(component), static_cast<int64_t>(0)));
+
+                append_row("stream", statistics->GetApplicationName(), statistics->GetStreamName(), "", "",
+                           StreamMemoryStatistics::GetComponentName(component), bytes);
+
+                application_bytes[statistics->GetApplicationName()] += bytes;
+            }
+        }
+    }
+
+    // Streams and sessions of the publishers
+    {
+        // <bytes, row>
+        std::vector<std::pair<size_t, std::tuple<ov::String, ov::String, ov::String, session_id_t>>> session_list;
+
+        for(const auto &publisher : _publishers)
+        {
+            ov::String publisher_name = publisher->GetPublisherName();
+            std::vector<std::shared_ptr<PublisherStreamMemoryData>> streams;
+
+            publisher->GetMemoryData(streams);
+
+            for(const auto &stream : streams)
+            {
+                size_t session_bytes = 0;
+
+                for(const auto &session : stream->sessions)
+                {
+                    session_bytes += session.second;
+                    session_list.emplace_back(session.second, std::make_tuple(stream->app_name, stream->stream_name, publisher_name, session.first));
+                }
+
+                append_row("publisher", stream->app_name, stream->stream_name, publisher_name, "", "queue", stream->queue_bytes);
+                append_row("publisher", stream->app_name, stream->stream_name, publisher_name, "", "gop_cache", stream->gop_cache_bytes);
+                append_row("publisher", stream->app_name, stream->stream_name, publisher_name, "", "store", stream->store_bytes);
+                append_row("publisher", stream->app_name, stream->stream_name, publisher_name, "", "session", session_bytes);
+
+                application_bytes[stream->app_name] += stream->queue_bytes + stream->gop_cache_bytes + stream->store_bytes + session_bytes;
+            }
+        }
+
+        size_t count = std::min(session_list.size(), static_cast<size_t>(MONITORING_MEMORY_SESSION_COUNT));
+
+        std::partial_sort(session_list.begin(), session_list.begin() + count, session_list.end(), [](const auto &lhs, const auto &rhs) -> bool {
+            return lhs.first > rhs.first;
+        });
+
+        for(size_t index = 0; index < count; index++)
+        {
+            const auto &row = session_list[index].second;
+
+            append_row("session", std::get<0>(row), std::get<1>(row), std::get<2>(row),
+                       ov::String::FormatString("%d", std::get<3>(row)), "session", session_list[index].first);
+        }
+    }
+
+    for(const auto &item : application_bytes)
+    {
+        append_row("application", item.first, "", "", "", "total", item.second);
+    }
+
+    ov::String data = string_stream.str().c_str();
+
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("Memory Response Fail");
+    }
+}
+
+//====================================================================================================
+// TraceRequest
+// - starts/stops the tracing of the media pipeline (ov::Tracer), the events are exported by /trace.json
+// - parameters: start=N (captures N seconds), flight=true (flight recorder, until stop), stop=true
+//
+// {enabled},{mode},{remaining(ms)},{threads},{datetime}
+// ex)
+//      true,capture,8410,23,2019-03-25T09:58:58+00:00
+//====================================================================================================
+void MonitoringServer::TraceRequest(const ov::String &request_url, const std::shared_ptr<HttpResponse> &response)
+{
+    auto tracer = ov::Tracer::Instance();
+    auto tokens = request_url.Split("?");
+
+    if (tokens.size() == 2)
+    {
+        for (const auto &param : tokens[1].Split("&"))
+        {
+            auto key_value = param.Split("=");
+
+            if (key_value.size() != 2)
+                continue;
+
+            if (key_value[0] == "start")
+            {
+                int duration = ::atoi(key_value[1].CStr());
+                tracer->Start(((duration > 0) ? duration : OV_TRACER_DEFAULT_DURATION) * 1000LL);
+                logti("Tracing is started for %d seconds", (duration > 0) ? duration : OV_TRACER_DEFAULT_DURATION);
+            }
+            else if (key_value[0] == "flight" && ((key_value[1] == "true") || (key_value[1] == "1")))
+            {
+                tracer->Start(0);
+                logti("Tracing is started (flight recorder)");
+            }
+            else if (key_value[0] == "stop" && ((key_value[1] == "true") || (key_value[1] == "1")))
+            {
+                tracer->Stop();
+                logti("Tracing is stopped");
+            }
+        }
+    }
+
+    std::ostringstream string_stream;
+    ov::String current_time = GetCurrentIso8601Time();
+
+    string_stream
+    << (ov::Tracer::IsEnabled() ? "true" : "false")             << COLLECTION_DATA_SEPARATOR
+    << (tracer->IsFlightRecorder() ? "flight" : "capture")      << COLLECTION_DATA_SEPARATOR
+    << tracer->GetRemainingTime()                               << COLLECTION_DATA_SEPARATOR
+    << tracer->GetThreadCount()                                 << COLLECTION_DATA_SEPARATOR
+    << current_time.CStr()                                      << COLLECTION_DATA_LINE_END;
+
+    ov::String data = string_stream.str().c_str();
+
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("Trace Response Fail");
+    }
+}
+
+//====================================================================================================
+// ReloadRequest
+// - the configs are parsed again, and the changes of the applications are applied by the main thread
+// - the result is written to the log (the invalid configs are not applied)
+//
+// {requested},{datetime}
+// ex)
+//      true,2019-03-25T09:58:58+00:00
+//====================================================================================================
+void MonitoringServer::ReloadRequest(const std::shared_ptr<HttpResponse> &response)
+{
+    cfg::ConfigManager::Instance()->RequestReload();
+
+    logti("The reload of the configs is requested (monitoring)");
+
+    std::ostringstream string_stream;
+    ov::String current_time = GetCurrentIso8601Time();
+
+    string_stream
+    << "true"                   << COLLECTION_DATA_SEPARATOR
+    << current_time.CStr()      << COLLECTION_DATA_LINE_END;
+
+    ov::String data = string_stream.str().c_str();
+
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("Reload Response Fail");
+    }
+}
+
+//====================================================================================================
+// TraceExportRequest
+// - the events since the tracing is started (Chrome trace event format, can be opened by Perfetto UI or chrome://tracing)
+// - parameters: seconds=N (only the last N seconds, e.g. a flight recorder after a latency spike)
+//====================================================================================================
+void MonitoringServer::TraceExportRequest(const ov::String &request_url, const std::shared_ptr<HttpResponse> &response)
+{
+    int64_t last = 0;
+    auto tokens = request_url.Split("?");
+
+    if (tokens.size() == 2)
+    {
+        for (const auto &param : tokens[1].Split("&"))
+        {
+            auto key_value = param.Split("=");
+
+            if ((key_value.size() == 2) && (key_value[0] == "seconds"))
+                last = std::max(::atoi(key_value[1].CStr()), 0) * 1000LL;
+        }
+    }
+
+    ov::String data = ov::Tracer::Instance()->ExportChromeTrace(last);
+
+    response->SetHeader("Content-Type", "application/json");
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("Trace Export Response Fail");
+    }
+}
+
+//====================================================================================================
+// TransportRequest
+// - transport statistics of each provider connection (e.g. SRT)
+//
+// {app},{stream},{remote},{rtt(ms)},{receive rate(Mbps)},{received},{lost},{retransmission requests},{dropped},{datetime}
+//====================================================================================================
+void MonitoringServer::TransportRequest(const std::shared_ptr<HttpResponse> &response)
+{
+    std::vector<std::shared_ptr<pvd::TransportStatisticsData>> statistics;
+
+    for (const auto &provider : _providers)
+    {
+        provider->GetTransportStatisticsData(statistics);
+    }
+
+    std::ostringstream string_stream;
+    ov::String current_time = GetCurrentIso8601Time();
+
+    for(const auto &statistics_data : statistics)
+    {
+        string_stream
+        << statistics_data->app_name.CStr()          << COLLECTION_DATA_SEPARATOR
+        << statistics_data->stream_name.CStr()       << COLLECTION_DATA_SEPARATOR
+        << statistics_data->remote.CStr()            << COLLECTION_DATA_SEPARATOR
+        << statistics_data->rtt                      << COLLECTION_DATA_SEPARATOR
+        << statistics_data->receive_rate             << COLLECTION_DATA_SEPARATOR
+        << statistics_data->received_packets         << COLLECTION_DATA_SEPARATOR
+        << statistics_data->lost_packets             << COLLECTION_DATA_SEPARATOR
+        << statistics_data->retransmission_requests  << COLLECTION_DATA_SEPARATOR
+        << statistics_data->dropped_packets          << COLLECTION_DATA_SEPARATOR
+        << current_time.CStr()                       << COLLECTION_DATA_LINE_END;
+    }
+
+    ov::String data = string_stream.str().c_str();
+
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("Transport Response Fail");
+    }
+}
+
+//====================================================================================================
+// RelayRequest
+// - each relay connection (server: from an edge, client: to an origin)
+//
+// {app},{role},{remote},{lane},{connected},{streams},{queued bytes},{queued frames},{total bytes},{bitrate(bps)},{dropped frames},{reconnects},{datetime}
+//====================================================================================================
+void MonitoringServer::RelayRequest(const std::shared_ptr<HttpResponse> &response)
+{
+    std::vector<std::shared_ptr<RelayLinkStatisticsData>> links;
+    std::vector<std::shared_ptr<RelayStreamStatisticsData>> streams;
+
+    if(_router != nullptr)
+    {
+        _router->GetRelayStatisticsData(links, streams);
+    }
+
+    std::ostringstream string_stream;
+    ov::String current_time = GetCurrentIso8601Time();
+
+    for(const auto &link_data : links)
+    {
+        string_stream
+        << link_data->app_name.CStr()                << COLLECTION_DATA_SEPARATOR
+        << link_data->role.CStr()                    << COLLECTION_DATA_SEPARATOR
+        << link_data->remote.CStr()                  << COLLECTION_DATA_SEPARATOR
+        << link_data->lane                           << COLLECTION_DATA_SEPARATOR
+        << (link_data->is_connected ? 1 : 0)         << COLLECTION_DATA_SEPARATOR
+        << link_data->stream_count                   << COLLECTION_DATA_SEPARATOR
+        << link_data->queued_bytes                   << COLLECTION_DATA_SEPARATOR
+        << link_data->queued_frames                  << COLLECTION_DATA_SEPARATOR
+        << link_data->total_bytes                    << COLLECTION_DATA_SEPARATOR
+        << link_data->bitrate                        << COLLECTION_DATA_SEPARATOR
+        << link_data->dropped_frames                 << COLLECTION_DATA_SEPARATOR
+        << link_data->reconnect_count                << COLLECTION_DATA_SEPARATOR
+        << current_time.CStr()                       << COLLECTION_DATA_LINE_END;
+    }
+
+    ov::String data = string_stream.str().c_str();
+
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("Relay Response Fail");
+    }
+}
+
+//====================================================================================================
+// RelayStreamRequest
+// - each stream received from the origins (edge)
+//
+// {app},{stream},{origin},{lane},{received frames},{bitrate(bps)},{lag(ms)},{max lag(ms)},{origin switches},{datetime}
+//====================================================================================================
+void MonitoringServer::RelayStreamRequest(const std::shared_ptr<HttpResponse> &response)
+{
+    std::vector<std::shared_ptr<RelayLinkStatisticsData>> links;
+    std::vector<std::shared_ptr<RelayStreamStatisticsData>> streams;
+
+    if(_router != nullptr)
+    {
+        _router->GetRelayStatisticsData(links, streams);
+    }
+
+    std::ostringstream string_stream;
+    ov::String current_time = GetCurrentIso8601Time();
+
+    for(const auto &stream_data : streams)
+    {
+        string_stream
+        << stream_data->app_name.CStr()              << COLLECTION_DATA_SEPARATOR
+        << stream_data->stream_name.CStr()           << COLLECTION_DATA_SEPARATOR
+        << stream_data->origin.CStr()                << COLLECTION_DATA_SEPARATOR
+        << stream_data->lane                         << COLLECTION_DATA_SEPARATOR
+        << stream_data->received_frames              << COLLECTION_DATA_SEPARATOR
+        << stream_data->bitrate                      << COLLECTION_DATA_SEPARATOR
+        << stream_data->lag                          << COLLECTION_DATA_SEPARATOR
+        << stream_data->max_lag                      << COLLECTION_DATA_SEPARATOR
+        << stream_data->origin_switch_count          << COLLECTION_DATA_SEPARATOR
+        << current_time.CStr()                       << COLLECTION_DATA_LINE_END;
+    }
+
+    ov::String data = string_stream.str().c_str();
+
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("Relay Stream Response Fail");
+    }
+}
+
+//====================================================================================================
+// MetricsRequest
+// - OpenMetrics text format (for Prometheus), e.g. GET /metrics
+// - The values are read from the atomic counters of the router and the publishers,
+//   so a scrape doesn't visit the sessions and doesn't block the pipeline
+//
+// ex)
+//      # TYPE ome_publisher_sessions gauge
+//      # HELP ome_publisher_sessions Sessions of the stream
+//      ome_publisher_sessions{application="app",stream="stream",publisher="webrtc"} 120
+//      # EOF
+//====================================================================================================
+#define OPENMETRICS_CONTENT_TYPE ("application/openmetrics-text; version=1.0.0; charset=utf-8")
+
+typedef std::vector<std::pair<ov::String, uint64_t>> MetricsSamples;
+
+// label_name="label_value",... (the values are escaped)
+static ov::String MakeMetricsLabels(std::initializer_list<std::pair<const char *, ov::String>> labels)
+{
+    ov::String result;
+
+    for(const auto &label : labels)
+    {
+        if(result.IsEmpty() == false)
+        {
+            result.Append(',');
+        }
+
+        result.AppendFormat("%s=\"", label.first);
+
+        for(size_t index = 0; index < label.second.GetLength(); index++)
+        {
+            char character = label.second[index];
+
+            if(character == '\\')
+                result.Append("\\\\");
+            else if(character == '"')
+                result.Append("\\\"");
+            else if(character == '\n')
+                result.Append("\\n");
+            else
+                result.Append(character);
+        }
+
+        result.Append('"');
+    }
+
+    return result;
+}
+
+static void WriteMetricsFamily(std::ostringstream &string_stream, const char *name, bool is_counter, const char *help, const MetricsSamples &samples)
+{
+    string_stream
+    << "# TYPE " << name << (is_counter ? " counter" : " gauge") << "\n"
+    << "# HELP " << name << " " << help << "\n";
+
+    for(const auto &sample : samples)
+    {
+        string_stream << name << (is_counter ? "_total" : "") << "{" << sample.first.CStr() << "} " << sample.second << "\n";
+    }
+}
+
+static const char *GetConnectorTypeName(MediaRouteApplicationConnector::ConnectorType type)
+{
+    switch(type)
+    {
+        case MediaRouteApplicationConnector::ConnectorType::Provider:
+            return "provider";
+        case MediaRouteApplicationConnector::ConnectorType::Transcoder:
+            return "transcoder";
+        case MediaRouteApplicationConnector::ConnectorType::Relay:
+            return "relay";
+    }
+
+    return "unknown";
+}
+
+void MonitoringServer::MetricsRequest(const std::shared_ptr<HttpResponse> &response)
+{
+    std::ostringstream string_stream;
+
+    // Streams of the router
+    if(_router != nullptr)
+    {
+        std::vector<std::shared_ptr<MediaRouteStreamMetricsData>> streams;
+        MetricsSamples received_packets, received_bytes, queue_sizes;
+
+        _router->GetStreamMetricsData(streams);
+
+        for(const auto &stream : streams)
+        {
+            auto labels = MakeMetricsLabels({{"application", stream->app_name},
+                                             {"stream", stream->stream_name},
+                                             {"source", GetConnectorTypeName(stream->connector_type)}});
+
+            received_packets.emplace_back(labels, stream->metrics.received_packet_count);
+            received_bytes.emplace_back(labels, stream->metrics.received_bytes);
+            queue_sizes.emplace_back(labels, stream->metrics.queue_size);
+        }
+
+        WriteMetricsFamily(string_stream, "ome_stream_ingest_packets", true, "Packets pushed to the router", received_packets);
+        WriteMetricsFamily(string_stream, "ome_stream_ingest_bytes", true, "Bytes pushed to the router", received_bytes);
+        WriteMetricsFamily(string_stream, "ome_stream_router_queue_packets", false, "Packets waiting in the queue of the router", queue_sizes);
+    }
+
+    // Streams and applications of the publishers
+    {
+        std::vector<std::shared_ptr<PublisherApplicationMetricsData>> applications;
+        std::vector<std::shared_ptr<PublisherStreamMetricsData>> streams;
+        MetricsSamples sessions, sent_packets, sent_bytes, dropped_packets, queue_sizes;
+        MetricsSamples app_queue_frames, app_dropped_frames, app_sessions, app_sent_bytes;
+
+        // key : app name + publisher name pair
+        std::map<std::pair<ov::String, ov::String>, StreamMetrics> app_sum;
+
+        for(const auto &publisher : _publishers)
+        {
+            ov::String publisher_name = publisher->GetPublisherName();
+
+            applications.clear();
+            streams.clear();
+
+            publisher->GetMetricsData(applications, streams);
+
+            for(const auto &application : applications)
+            {
+                auto video_labels = MakeMetricsLabels({{"application", application->app_name}, {"publisher", publisher_name}, {"media", "video"}});
+                auto audio_labels = MakeMetricsLabels({{"application", application->app_name}, {"publisher", publisher_name}, {"media", "audio"}});
+
+                app_queue_frames.emplace_back(video_labels, application->queue.video_size);
+                app_queue_frames.emplace_back(audio_labels, application->queue.audio_size);
+                app_dropped_frames.emplace_back(video_labels, application->queue.video_drop_count);
+                app_dropped_frames.emplace_back(audio_labels, application->queue.audio_drop_count);
+
+                // The applications without the streams are also exported
+                app_sum[std::pair<ov::String, ov::String>(application->app_name, publisher_name)];
+            }
+
+            for(const auto &stream : streams)
+            {
+                auto labels = MakeMetricsLabels({{"application", stream->app_name},
+                                                 {"stream", stream->stream_name},
+                                                 {"publisher", publisher_name}});
+
+                sessions.emplace_back(labels, stream->metrics.session_count);
+                sent_packets.emplace_back(labels, stream->metrics.sent_packet_count);
+                sent_bytes.emplace_back(labels, stream->metrics.sent_bytes);
+                dropped_packets.emplace_back(labels, stream->metrics.dropped_packet_count);
+                queue_sizes.emplace_back(labels, stream->metrics.queue_size);
+
+                auto &sum = app_sum[std::pair<ov::String, ov::String>(stream->app_name, publisher_name)];
+
+                sum.session_count += stream->metrics.session_count;
+                sum.sent_bytes += stream->metrics.sent_bytes;
+            }
+        }
+
+        for(const auto &item : app_sum)
+        {
+            auto labels = MakeMetricsLabels({{"application", item.first.first}, {"publisher", item.first.second}});
+
+            app_sessions.emplace_back(labels, item.second.session_count);
+            app_sent_bytes.emplace_back(labels, item.second.sent_bytes);
+        }
+
+        WriteMetricsFamily(string_stream, "ome_publisher_sessions", false, "Sessions of the stream", sessions);
+        WriteMetricsFamily(string_stream, "ome_publisher_sent_packets", true, "Packets sent to the sessions (counted for each session)", sent_packets);
+        WriteMetricsFamily(string_stream, "ome_publisher_sent_bytes", true, "Bytes sent to the sessions (counted for each session)", sent_bytes);
+        WriteMetricsFamily(string_stream, "ome_publisher_dropped_packets", true, "Stale video packets dropped by the stream workers", dropped_packets);
+        WriteMetricsFamily(string_stream, "ome_publisher_queue_packets", false, "Packets waiting in the queues of the stream workers", queue_sizes);
+        WriteMetricsFamily(string_stream, "ome_application_queue_frames", false, "Frames waiting in the queues of the publisher application", app_queue_frames);
+        WriteMetricsFamily(string_stream, "ome_application_dropped_frames", true, "Frames dropped by the queue policy of the publisher application", app_dropped_frames);
+        WriteMetricsFamily(string_stream, "ome_application_sessions", false, "Sessions of the application", app_sessions);
+        WriteMetricsFamily(string_stream, "ome_application_sent_bytes", true, "Bytes sent to the sessions of the application", app_sent_bytes);
+    }
+
+    // Degradation of the transcoder
+    {
+        std::vector<std::shared_ptr<StreamOverloadStatistics>> statistics_list;
+        MetricsSamples levels, queue_delays, level_ups, dropped_frames, suspended_renditions;
+
+        StreamOverload::Instance()->GetAllStatistics(statistics_list);
+
+        for(const auto &statistics : statistics_list)
+        {
+            auto labels = MakeMetricsLabels({{"application", statistics->GetApplicationName()}, {"stream", statistics->GetStreamName()}});
+
+            levels.emplace_back(labels, static_cast<uint64_t>(statistics->GetLevel()));
+            queue_delays.emplace_back(labels, static_cast<uint64_t>(std::max(statistics->GetQueueDelay(), static_cast<int64_t>(0))));
+            level_ups.emplace_back(labels, statistics->GetLevelUpCount());
+            dropped_frames.emplace_back(labels, statistics->GetDroppedFrameCount());
+            suspended_renditions.emplace_back(labels, statistics->GetSuspendedRenditionCount());
+        }
+
+        WriteMetricsFamily(string_stream, "ome_transcoder_degradation_level", false, "Degradation of the transcoder (0: normal, 1: skip non-reference frames, 2: reduce frame rate, 3: fast encoding, 4: suspend renditions)", levels);
+        WriteMetricsFamily(string_stream, "ome_transcoder_queue_delay_ms", false, "The longest waiting time of the input packets of the transcoder in the last second", queue_delays);
+        WriteMetricsFamily(string_stream, "ome_transcoder_degradation_steps", true, "Times which the degradation of the transcoder is raised", level_ups);
+        WriteMetricsFamily(string_stream, "ome_transcoder_dropped_frames", true, "Decoded frames dropped to reduce the frame rate", dropped_frames);
+        WriteMetricsFamily(string_stream, "ome_transcoder_suspended_renditions", false, "Renditions suspended by the degradation of the transcoder", suspended_renditions);
+    }
+
+    // Quotas of the applications
+    {
+        std::vector<std::shared_ptr<ApplicationQuotaStatistics>> statistics_list;
+        MetricsSamples weights, sessions, egress_bitrates, ingest_bitrates, transcode_times, stream_worker_times;
+        MetricsSamples transcode_deferrals, stream_worker_deferrals, rejected_sessions, rejected_streams;
+
+        ApplicationQuota::Instance()->GetAllStatistics(statistics_list);
+
+        for(const auto &statistics : statistics_list)
+        {
+            auto labels = MakeMetricsLabels({{"application", statistics->GetApplicationName()}});
+
+            weights.emplace_back(labels, statistics->GetWeight());
+            sessions.emplace_back(labels, static_cast<uint64_t>(std::max(statistics->GetSessionCount(), static_cast<int64_t>(0))));
+            egress_bitrates.emplace_back(labels, statistics->GetEgressBitrate());
+            ingest_bitrates.emplace_back(labels, statistics->GetIngestBitrate());
+            transcode_times.emplace_back(labels, statistics->GetBusyTime(ApplicationQuotaScheduler::Transcoder));
+            stream_worker_times.emplace_back(labels, statistics->GetBusyTime(ApplicationQuotaScheduler::StreamWorker));
+            transcode_deferrals.emplace_back(labels, statistics->GetDeferredCount(ApplicationQuotaScheduler::Transcoder));
+            stream_worker_deferrals.emplace_back(labels, statistics->GetDeferredCount(ApplicationQuotaScheduler::StreamWorker));
+            rejected_sessions.emplace_back(labels, statistics->GetRejectedSessionCount());
+            rejected_streams.emplace_back(labels, statistics->GetRejectedStreamCount());
+        }
+
+        WriteMetricsFamily(string_stream, "ome_quota_weight", false, "Weight of the fair share of the application in the shared schedulers", weights);
+        WriteMetricsFamily(string_stream, "ome_quota_sessions", false, "Sessions of the stream workers of the application", sessions);
+        WriteMetricsFamily(string_stream, "ome_quota_egress_bps", false, "Bitrate sent to the sessions of the application in the last second", egress_bitrates);
+        WriteMetricsFamily(string_stream, "ome_quota_ingest_bps", false, "Bitrate received by the providers of the application in the last second", ingest_bitrates);
+        WriteMetricsFamily(string_stream, "ome_quota_transcode_us", true, "Time which the transcoder workers ran the streams of the application", transcode_times);
+        WriteMetricsFamily(string_stream, "ome_quota_stream_worker_us", true, "Time which the stream worker threads ran the streams of the application", stream_worker_times);
+        WriteMetricsFamily(string_stream, "ome_quota_transcode_deferrals", true, "Times which the transcoder ran the other applications first or waited for the next window", transcode_deferrals);
+        WriteMetricsFamily(string_stream, "ome_quota_stream_worker_deferrals", true, "Times which the stream worker threads ran the other applications first", stream_worker_deferrals);
+        WriteMetricsFamily(string_stream, "ome_quota_rejected_sessions", true, "Sessions refused by the session and egress quotas", rejected_sessions);
+        WriteMetricsFamily(string_stream, "ome_quota_rejected_streams", true, "Streams refused by the ingest quota", rejected_streams);
+    }
+
+    // QoE of the players (the quantiles of the histograms of the streams)
+    {
+        static const char *metric_help[] = {
+            "Fraction lost of the RTCP receiver reports (per mille)",
+            "Interarrival jitter of the RTCP receiver reports (microseconds)",
+            "Round trip time of the RTCP receiver reports (microseconds)",
+            "Time until a HLS/DASH segment has been written to the socket (microseconds)",
+            "Interval between the segment requests of the sampled players (microseconds)",
+            "Estimated stalls of the sampled HLS/DASH players (microseconds)"
+        };
+        static const std::pair<const char *, double> quantiles[] = { { "0.5", 50.0 }, { "0.9", 90.0 }, { "0.99", 99.0 } };
+
+        std::vector<std::shared_ptr<StreamQoeStatistics>> statistics_list;
+        MetricsSamples metric_samples[static_cast<int>(StreamQoeMetric::NumberOfMetrics)];
+        MetricsSamples reports, requests, rebuffers, sampled_sessions, skipped_sessions;
+
+        StreamQoe::Instance()->GetAllStatistics(statistics_list);
+
+        for(const auto &statistics : statistics_list)
+        {
+            auto labels = MakeMetricsLabels({{"application", statistics->GetApplicationName()}, {"stream", statistics->GetStreamName()}});
+
+            for(int index = 0; index < static_cast<int>(StreamQoeMetric::NumberOfMetrics); index++)
+            {
+                auto &histogram = statistics->GetHistogram(static_cast<StreamQoeMetric>(index));
+
+                if(histogram.GetCount() == 0)
+                    continue;
+
+                for(const auto &quantile : quantiles)
+                {
+                    metric_samples[index].emplace_back(MakeMetricsLabels({{"application", statistics->GetApplicationName()},
+                                                                          {"stream", statistics->GetStreamName()},
+                                                                          {"quantile", quantile.first}}),
+                                                       static_cast<uint64_t>(histogram.GetPercentile(quantile.second)));
+                }
+            }
+
+            reports.emplace_back(labels, statistics->GetReportCount());
+            requests.emplace_back(labels, statistics->GetRequestCount());
+            rebuffers.emplace_back(labels, statistics->GetHistogram(StreamQoeMetric::Rebuffer).GetCount());
+            sampled_sessions.emplace_back(labels, statistics->GetSampledSessionCount());
+            skipped_sessions.emplace_back(labels, statistics->GetSkippedSessionCount());
+        }
+
+        for(int index = 0; index < static_cast<int>(StreamQoeMetric::NumberOfMetrics); index++)
+        {
+            ov::String name = ov::String::FormatString("ome_qoe_%s", StreamQoeStatistics::GetMetricName(static_cast<StreamQoeMetric>(index)));
+
+            WriteMetricsFamily(string_stream, name.CStr(), false, metric_help[index], metric_samples[index]);
+        }
+
+        WriteMetricsFamily(string_stream, "ome_qoe_receiver_reports", true, "Report blocks of the RTCP receiver reports of the WebRTC players", reports);
+        WriteMetricsFamily(string_stream, "ome_qoe_segment_requests", true, "Segments sent to the HLS/DASH players", requests);
+        WriteMetricsFamily(string_stream, "ome_qoe_rebuffers", true, "Estimated stalls of the sampled HLS/DASH players", rebuffers);
+        WriteMetricsFamily(string_stream, "ome_qoe_sampled_sessions", false, "Sessions of which the details are kept", sampled_sessions);
+        WriteMetricsFamily(string_stream, "ome_qoe_skipped_sessions", true, "Sessions which are not sampled because of MaxSampledSessions", skipped_sessions);
+    }
+
+    // Allocation tags
+    {
+        MetricsSamples tag_bytes;
+
+        for(int index = 0; index < static_cast<int>(ov::MemoryTag::NumberOfTags); index++)
+        {
+            auto tag = static_cast<ov::MemoryTag>(index);
+
+            tag_bytes.emplace_back(MakeMetricsLabels({{"tag", ov::MemoryAccounting::GetTagName(tag)}}),
+                                   static_cast<uint64_t>(std::max(ov::MemoryAccounting::GetBytes(tag), static_cast<int64_t>(0))));
+        }
+
+        WriteMetricsFamily(string_stream, "ome_memory_tag_bytes", false, "Bytes of the buffers of ov::Data by the allocation tag", tag_bytes);
+    }
+
+    // Huge pages
+    {
+        auto statistics = ov::HugePages::GetStatistics();
+
+        WriteMetricsFamily(string_stream, "ome_huge_page_advised_bytes", true, "Bytes of the buffers advised to the transparent huge pages", {{"", statistics.advised_bytes}});
+        WriteMetricsFamily(string_stream, "ome_huge_page_hugetlb_bytes", false, "Bytes mapped from the huge page pool", {{"", statistics.hugetlb_bytes}});
+        WriteMetricsFamily(string_stream, "ome_huge_page_anon_bytes", false, "Anonymous memory of the process backed by the huge pages", {{"", statistics.anon_huge_bytes}});
+    }
+
+    string_stream << "# EOF\n";
+
+    ov::String data = string_stream.str().c_str();
+
+    response->SetHeader("Content-Type", OPENMETRICS_CONTENT_TYPE);
+    response->AppendString(data);
+
+    if (!response->Response())
+    {
+        logte("Metrics Response Fail");
+    }
+}
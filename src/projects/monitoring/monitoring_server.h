@@ -10,6 +10,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include "../http_server/http_server.h"
 #include "../http_server/https_server.h"
 #include "../http_server/interceptors/http_request_interceptors.h"
@@ -19,6 +20,8 @@
 #include "../base/provider/provider.h"
 #include "../base/publisher/publisher.h"
 #include "../base/ovlibrary/string.h"
+#include "../media_router/media_router.h"
+#include "../relay/relay_statistics.h"
 
 //====================================================================================================
 // MonitoringServer
@@ -34,7 +37,12 @@ public :
     bool Start(const ov::SocketAddress &address,
                const std::vector<std::shared_ptr<pvd::Provider>> &providers,
                 const std::vector<std::shared_ptr<Publisher>> &publishers,
-                const std::shared_ptr<Certificate> &certificate = nullptr);
+                const std::shared_ptr<Certificate> &certificate = nullptr,
+                const std::shared_ptr<MediaRouter> &router = nullptr);
+
+    // The modules are replaced after the config reload (the applications are added/removed)
+    void UpdateModules(const std::vector<std::shared_ptr<pvd::Provider>> &providers,
+                       const std::vector<std::shared_ptr<Publisher>> &publishers);
 
     bool Stop();
 
@@ -47,10 +55,33 @@ protected:
 
     void ProcessRequest(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response);
     void StateRequest(const std::shared_ptr<HttpResponse> &response);
+    void WorkerRequest(const std::shared_ptr<HttpResponse> &response);
+    void BufferPoolRequest(const std::shared_ptr<HttpResponse> &response);
+    void ConnectionRequest(const std::shared_ptr<HttpResponse> &response);
+    void TransportRequest(const std::shared_ptr<HttpResponse> &response);
+    void RelayRequest(const std::shared_ptr<HttpResponse> &response);
+    void RelayStreamRequest(const std::shared_ptr<HttpResponse> &response);
+    void LatencyRequest(const std::shared_ptr<HttpResponse> &response);
+    // QoE of the players (histograms of the streams, and the details of the sampled sessions)
+    void QoeRequest(const std::shared_ptr<HttpResponse> &response);
+    void QoeSessionRequest(const std::shared_ptr<HttpResponse> &response);
+    // Top contended locks of ov::LockProfiler (enable/reset by the parameters)
+    void LockRequest(const ov::String &request_url, const std::shared_ptr<HttpResponse> &response);
+    void MemoryRequest(const std::shared_ptr<HttpResponse> &response);
+    void TraceRequest(const ov::String &request_url, const std::shared_ptr<HttpResponse> &response);
+    void TraceExportRequest(const ov::String &request_url, const std::shared_ptr<HttpResponse> &response);
+    // OpenMetrics (Prometheus) text of the counters
+    void MetricsRequest(const std::shared_ptr<HttpResponse> &response);
+    // Requests the reload of the configs (applied by the main thread, same as SIGHUP)
+    void ReloadRequest(const std::shared_ptr<HttpResponse> &response);
 
 protected :
     std::shared_ptr<HttpServer> _http_server;
     std::vector<std::shared_ptr<pvd::Provider>> _providers;
     std::vector<std::shared_ptr<Publisher>> _publishers;
+    std::shared_ptr<MediaRouter> _router;
+
+    // Protects _providers/_publishers while a request is processed
+    std::mutex _module_mutex;
 
 };
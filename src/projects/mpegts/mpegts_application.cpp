@@ -0,0 +1,30 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "mpegts_application.h"
+
+#include <srt/srt_stream.h>
+
+#define OV_LOG_TAG "MpegtsApplication"
+
+std::shared_ptr<MpegtsApplication> MpegtsApplication::Create(const info::Application *application_info)
+{
+	auto application = std::make_shared<MpegtsApplication>(application_info);
+	return application;
+}
+
+MpegtsApplication::MpegtsApplication(const info::Application *application_info)
+	: Application(application_info)
+{
+}
+
+std::shared_ptr<pvd::Stream> MpegtsApplication::OnCreateStream()
+{
+	logtd("OnCreateStream");
+
+	return SrtStream::Create();
+}
@@ -0,0 +1,29 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "base/common_types.h"
+
+#include "base/provider/application.h"
+#include "base/provider/stream.h"
+
+//====================================================================================================
+// MpegtsApplication
+// - The streams demux the TS as the streams of SRT (see SrtStream)
+//====================================================================================================
+class MpegtsApplication : public pvd::Application
+{
+public:
+	static std::shared_ptr<MpegtsApplication> Create(const info::Application *application_info);
+
+	explicit MpegtsApplication(const info::Application *info);
+	~MpegtsApplication() override = default;
+
+public:
+	std::shared_ptr<pvd::Stream> OnCreateStream() override;
+};
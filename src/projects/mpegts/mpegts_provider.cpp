@@ -0,0 +1,507 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include <config/config.h>
+
+#include "mpegts_provider.h"
+#include "mpegts_application.h"
+
+#include <chrono>
+
+#define OV_LOG_TAG "MpegtsProvider"
+
+static int64_t GetCurrentMilliseconds()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<MpegtsProvider> MpegtsProvider::Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+{
+	auto provider = std::make_shared<MpegtsProvider>(application_info, router);
+
+	if(provider->Start() == false)
+	{
+		return nullptr;
+	}
+
+	return provider;
+}
+
+//====================================================================================================
+// MpegtsProvider
+//====================================================================================================
+MpegtsProvider::MpegtsProvider(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+	: Provider(application_info, router)
+{
+	logtd("Created Mpegts Provider modules.");
+}
+
+//====================================================================================================
+// ~MpegtsProvider
+//====================================================================================================
+MpegtsProvider::~MpegtsProvider()
+{
+	Stop();
+	logtd("Terminated Mpegts Provider modules.");
+}
+
+//====================================================================================================
+// Start
+//====================================================================================================
+bool MpegtsProvider::Start()
+{
+	_provider_info = _application_info->GetProvider<cfg::MpegtsProvider>();
+
+	if((_provider_info == nullptr) || (_provider_info->IsParsed() == false))
+	{
+		logte("Cannot initialize MpegtsProvider using config information");
+		return false;
+	}
+
+	auto host = _application_info->GetParentAs<cfg::Host>("Host");
+
+	if(host == nullptr)
+	{
+		OV_ASSERT2(false);
+		return false;
+	}
+
+	bool result = true;
+
+	{
+		std::lock_guard<std::mutex> lock(_input_mutex);
+
+		for(const auto &stream_info : _provider_info->GetStreams())
+		{
+			if(CreateInput(stream_info, host->GetIp()) == false)
+			{
+				result = false;
+				break;
+			}
+		}
+	}
+
+	if(result == false)
+	{
+		Stop();
+		return false;
+	}
+
+	_timeout_timer.Push([this](void *parameter) -> bool {
+		OnTimeoutCheck();
+		return true;
+	}, nullptr, MPEGTS_PROVIDER_TIMEOUT_CHECK_INTERVAL, true);
+
+	_timeout_timer.Start();
+
+	return Provider::Start();
+}
+
+//====================================================================================================
+// Stop
+//====================================================================================================
+bool MpegtsProvider::Stop()
+{
+	_timeout_timer.Stop();
+
+	{
+		std::lock_guard<std::mutex> lock(_input_mutex);
+
+		for(auto &item : _inputs)
+		{
+			auto &input = item.second;
+
+			input.physical_port->RemoveObserver(this);
+
+			DeleteStream(input);
+
+			PhysicalPortManager::Instance()->DeletePort(input.physical_port);
+			input.physical_port = nullptr;
+		}
+
+		_inputs.clear();
+	}
+
+	return Provider::Stop();
+}
+
+//====================================================================================================
+// CreateInput
+// - The socket of a multicast stream is bound to the group, so the groups which share a port are
+//   received by their own sockets (and the unicast datagrams to the port are not received)
+// - _input_mutex must be locked
+//====================================================================================================
+bool MpegtsProvider::CreateInput(const cfg::MpegtsStream &stream_info, const ov::String &host_ip)
+{
+	const auto &port = stream_info.GetPort();
+	const auto &multicast_group = stream_info.GetMulticastGroup();
+
+	if(port.GetSocketType() != ov::SocketType::Udp)
+	{
+		logte("Invalid MPEG-TS provider port of %s: %d (the type must be udp)", stream_info.GetName().CStr(), port.GetPort());
+		return false;
+	}
+
+	ov::SocketAddress address(multicast_group.IsEmpty() ? host_ip : multicast_group, static_cast<uint16_t>(port.GetPort()));
+
+	if(_inputs.find(address) != _inputs.end())
+	{
+		logte("%s is already used by another stream of %s", address.ToString().CStr(), _application_info->GetName().CStr());
+		return false;
+	}
+
+	// A thread per port: the datagrams of a TS must be demuxed in order
+	auto physical_port = PhysicalPortManager::Instance()->CreatePort(ov::SocketType::Udp, address, 0, _provider_info->GetReceiveBufferSize() * 1024, 1);
+
+	if(physical_port == nullptr)
+	{
+		logte("Could not initialize phyiscal port for MPEG-TS provider: %s", address.ToString().CStr());
+		return false;
+	}
+
+	if(multicast_group.IsEmpty() == false)
+	{
+		ov::SocketAddress interface_address(stream_info.GetInterface(), 0);
+
+		if(physical_port->JoinMulticastGroup(address, interface_address) == false)
+		{
+			logte("Could not join the multicast group %s for %s", address.ToString().CStr(), stream_info.GetName().CStr());
+			PhysicalPortManager::Instance()->DeletePort(physical_port);
+			return false;
+		}
+	}
+
+	auto &input = _inputs[address];
+
+	input.stream_name = stream_info.GetName();
+	input.physical_port = physical_port;
+
+	physical_port->AddObserver(this);
+
+	logti("MPEG-TS Provider is listening on %s (stream: %s/%s, multicast: %s)...",
+	      address.ToString().CStr(), _application_info->GetName().CStr(), input.stream_name.CStr(), multicast_group.IsEmpty() ? "off" : "on");
+
+	return true;
+}
+
+//====================================================================================================
+// GetConnectionMemoryData
+// - 미디어 정보를 기다리는 동안 보관하는 패킷 크기
+//====================================================================================================
+bool MpegtsProvider::GetConnectionMemoryData(std::vector<std::shared_ptr<pvd::ConnectionMemoryData>> &memories)
+{
+	std::lock_guard<std::mutex> lock(_input_mutex);
+
+	for(const auto &item : _inputs)
+	{
+		const auto &input = item.second;
+
+		if(input.stream == nullptr)
+		{
+			continue;
+		}
+
+		auto memory_data = std::make_shared<pvd::ConnectionMemoryData>();
+
+		memory_data->app_name = _application_info->GetName();
+		memory_data->stream_name = input.stream_name;
+		memory_data->remote = input.source.ToString();
+		memory_data->message_buffer_size = input.stream->GetBufferedSize();
+
+		memories.push_back(memory_data);
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// GetTransportStatisticsData
+// - The lost packets are the TS packets (continuity counter), UDP has no retransmission
+//====================================================================================================
+bool MpegtsProvider::GetTransportStatisticsData(std::vector<std::shared_ptr<pvd::TransportStatisticsData>> &statistics)
+{
+	std::lock_guard<std::mutex> lock(_input_mutex);
+
+	for(const auto &item : _inputs)
+	{
+		const auto &input = item.second;
+
+		if(input.stream == nullptr)
+		{
+			continue;
+		}
+
+		auto statistics_data = std::make_shared<pvd::TransportStatisticsData>();
+
+		statistics_data->app_name = _application_info->GetName();
+		statistics_data->stream_name = input.stream_name;
+		statistics_data->remote = input.source.ToString();
+		statistics_data->receive_rate = input.receive_rate;
+		statistics_data->received_packets = static_cast<int64_t>(input.received_datagrams);
+		statistics_data->lost_packets = static_cast<int64_t>(input.stream->GetErrorCount());
+		statistics_data->dropped_packets = static_cast<int64_t>(input.ignored_datagrams);
+
+		statistics.push_back(statistics_data);
+	}
+
+	return true;
+}
+
+std::shared_ptr<pvd::Application> MpegtsProvider::OnCreateApplication(const info::Application *application_info)
+{
+	return MpegtsApplication::Create(application_info);
+}
+
+//====================================================================================================
+// FindInput
+// - The port is shared if another application uses the same address, so the input is found by the local address of the socket
+//====================================================================================================
+MpegtsProvider::MpegtsInput *MpegtsProvider::FindInput(const std::shared_ptr<ov::Socket> &remote)
+{
+	auto local_address = remote->GetLocalAddress();
+
+	if(local_address == nullptr)
+	{
+		return nullptr;
+	}
+
+	auto item = _inputs.find(*local_address);
+
+	return (item != _inputs.end()) ? &(item->second) : nullptr;
+}
+
+//====================================================================================================
+// OnDataReceived
+// - PhysicalPortObserver 구현
+//====================================================================================================
+void MpegtsProvider::OnDataReceived(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data)
+{
+	ov::MemoryTagScope memory_tag(ov::MemoryTag::Ingest);
+	std::lock_guard<std::mutex> lock(_input_mutex);
+
+	auto input = FindInput(remote);
+
+	if(input == nullptr)
+	{
+		return;
+	}
+
+	ProcessDatagram(*input, address, data, GetCurrentMilliseconds());
+	SendPackets(*input);
+}
+
+//====================================================================================================
+// OnDatagramsReceived
+// - PhysicalPortObserver 구현
+// - The datagrams of a batch (recvmmsg) are demuxed with a lock, and the packets are sent at once
+//====================================================================================================
+void MpegtsProvider::OnDatagramsReceived(const std::shared_ptr<ov::Socket> &remote, const std::vector<ov::Datagram> &datagrams)
+{
+	ov::MemoryTagScope memory_tag(ov::MemoryTag::Ingest);
+	OV_TRACE_SCOPE("provider", "MpegtsReceive");
+	std::lock_guard<std::mutex> lock(_input_mutex);
+
+	auto input = FindInput(remote);
+
+	if(input == nullptr)
+	{
+		return;
+	}
+
+	int64_t current_time = GetCurrentMilliseconds();
+
+	for(auto &datagram : datagrams)
+	{
+		ProcessDatagram(*input, datagram.remote_address, datagram.data, current_time);
+	}
+
+	SendPackets(*input);
+}
+
+//====================================================================================================
+// ProcessDatagram
+// - The stream is made by the first datagram, and it is created to the router when the media information is known
+// - _input_mutex must be locked
+//====================================================================================================
+void MpegtsProvider::ProcessDatagram(MpegtsInput &input, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data, int64_t current_time)
+{
+	if(input.stream == nullptr)
+	{
+		auto application = std::dynamic_pointer_cast<MpegtsApplication>(GetApplicationById(_application_info->GetId()));
+
+		if(application == nullptr)
+		{
+			return;
+		}
+
+		auto stream = std::dynamic_pointer_cast<SrtStream>(application->MakeStream());
+
+		if(stream == nullptr)
+		{
+			logte("can not create stream - app(%s) stream(%s)", _application_info->GetName().CStr(), input.stream_name.CStr());
+			return;
+		}
+
+		stream->SetName(input.stream_name.CStr());
+
+		input.stream = stream;
+		input.source = address;
+		input.received_bytes = 0;
+		input.received_datagrams = 0;
+		input.ignored_datagrams = 0;
+		input.last_check_bytes = 0;
+
+		logti("MPEG-TS input stream started - stream(%s/%s) source(%s)",
+		      _application_info->GetName().CStr(), input.stream_name.CStr(), address.ToString().CStr());
+	}
+	else if(input.source != address)
+	{
+		if(input.ignored_datagrams == 0)
+		{
+			logtw("The datagrams of %s are ignored, %s/%s is received from %s",
+			      address.ToString().CStr(), _application_info->GetName().CStr(), input.stream_name.CStr(), input.source.ToString().CStr());
+		}
+
+		input.ignored_datagrams++;
+		return;
+	}
+
+	input.last_received_time = current_time;
+	input.received_bytes += data->GetLength();
+	input.received_datagrams++;
+
+	input.stream->ParseData(data);
+}
+
+//====================================================================================================
+// SendPackets
+// - _input_mutex must be locked
+//====================================================================================================
+void MpegtsProvider::SendPackets(MpegtsInput &input)
+{
+	auto stream = input.stream;
+
+	if(stream == nullptr)
+	{
+		return;
+	}
+
+	auto application = std::dynamic_pointer_cast<MpegtsApplication>(GetApplicationById(_application_info->GetId()));
+
+	if(application == nullptr)
+	{
+		return;
+	}
+
+	if(stream->IsCreated() == false)
+	{
+		if(stream->IsMediaInfoReady() == false)
+		{
+			return;
+		}
+
+		if(stream->AddTracks() == false)
+		{
+			logte("Could not create the stream - app(%s) stream(%s)", _application_info->GetName().CStr(), stream->GetName().CStr());
+
+			input.stream = nullptr;
+			return;
+		}
+
+		// 라우터에 스트림이 생성되었다고 알림
+		if(application->CreateStream2(stream) == false)
+		{
+			input.stream = nullptr;
+			return;
+		}
+
+		stream->SetCreated(true);
+
+		logti("MPEG-TS input stream create completed - stream(%s/%s) id(%u/%u) source(%s)",
+		      _application_info->GetName().CStr(), stream->GetName().CStr(),
+		      _application_info->GetId(), stream->GetId(), input.source.ToString().CStr());
+	}
+
+	auto &packets = stream->GetPackets();
+
+	if(packets.empty() == false)
+	{
+		for(auto &packet : packets)
+		{
+			application->SendFrame(stream, std::move(packet));
+		}
+
+		stream->ClearPackets();
+	}
+}
+
+//====================================================================================================
+// DeleteStream
+// - _input_mutex must be locked
+//====================================================================================================
+void MpegtsProvider::DeleteStream(MpegtsInput &input)
+{
+	if(input.stream == nullptr)
+	{
+		return;
+	}
+
+	if(input.stream->IsCreated())
+	{
+		auto application = std::dynamic_pointer_cast<MpegtsApplication>(GetApplicationById(_application_info->GetId()));
+
+		if(application != nullptr)
+		{
+			// 라우터에 스트림이 삭제되었다고 알림
+			application->DeleteStream2(input.stream);
+		}
+
+		input.stream->SetCreated(false);
+	}
+
+	input.stream = nullptr;
+	input.source = ov::SocketAddress();
+	input.receive_rate = 0.0;
+}
+
+//====================================================================================================
+// OnTimeoutCheck
+// - UDP has no disconnection, so the stream is deleted when the sender stops
+//====================================================================================================
+void MpegtsProvider::OnTimeoutCheck()
+{
+	std::lock_guard<std::mutex> lock(_input_mutex);
+
+	int64_t current_time = GetCurrentMilliseconds();
+
+	for(auto &item : _inputs)
+	{
+		auto &input = item.second;
+
+		if(input.stream == nullptr)
+		{
+			continue;
+		}
+
+		input.receive_rate = static_cast<double>(input.received_bytes - input.last_check_bytes) * 8.0 / (MPEGTS_PROVIDER_TIMEOUT_CHECK_INTERVAL * 1000.0);
+		input.last_check_bytes = input.received_bytes;
+
+		if((current_time - input.last_received_time) < _provider_info->GetStreamTimeout())
+		{
+			continue;
+		}
+
+		logti("MPEG-TS input stream timed out - stream(%s/%s) source(%s) errors(%llu)",
+		      _application_info->GetName().CStr(), input.stream_name.CStr(), input.source.ToString().CStr(),
+		      static_cast<unsigned long long>(input.stream->GetErrorCount()));
+
+		DeleteStream(input);
+	}
+}
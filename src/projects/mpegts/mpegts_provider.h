@@ -0,0 +1,95 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+#include <base/ovlibrary/delay_queue.h>
+
+#include "base/provider/provider.h"
+#include "base/provider/application.h"
+#include "physical_port/physical_port_manager.h"
+
+#include <srt/srt_stream.h>
+
+// Interval (ms) of the check of the streams which don't receive the datagrams
+#define MPEGTS_PROVIDER_TIMEOUT_CHECK_INTERVAL      (1000)
+
+//====================================================================================================
+// MpegtsProvider
+// - Receives MPEG-TS (H.264/AAC) over UDP, a port (and a multicast group) per stream (<Stream>)
+// - The datagrams are received in batches (recvmmsg) by the thread of the port, and demuxed by SrtStream
+// - The stream locks onto the first sender, the datagrams of the others are ignored until the stream times out
+//====================================================================================================
+class MpegtsProvider : public pvd::Provider, public PhysicalPortObserver
+{
+public:
+	static std::shared_ptr<MpegtsProvider> Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+
+	explicit MpegtsProvider(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+	~MpegtsProvider() override;
+
+	cfg::ProviderType GetProviderType() override
+	{
+		return cfg::ProviderType::Mpegts;
+	}
+
+	bool Start() override;
+	bool Stop() override;
+
+	bool GetConnectionMemoryData(std::vector<std::shared_ptr<pvd::ConnectionMemoryData>> &memories) override;
+	bool GetTransportStatisticsData(std::vector<std::shared_ptr<pvd::TransportStatisticsData>> &statistics) override;
+
+	std::shared_ptr<pvd::Application> OnCreateApplication(const info::Application *application_info) override;
+
+	//--------------------------------------------------------------------
+	// Implementation of PhysicalPortObserver
+	//--------------------------------------------------------------------
+	void OnDataReceived(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data) override;
+	void OnDatagramsReceived(const std::shared_ptr<ov::Socket> &remote, const std::vector<ov::Datagram> &datagrams) override;
+
+private:
+	struct MpegtsInput
+	{
+		ov::String stream_name;
+		std::shared_ptr<PhysicalPort> physical_port;
+
+		// nullptr until a datagram is received
+		std::shared_ptr<SrtStream> stream;
+		ov::SocketAddress source;
+
+		// ms (monotonic)
+		int64_t last_received_time = 0;
+
+		uint64_t received_bytes = 0;
+		uint64_t received_datagrams = 0;
+		// Datagrams of the other senders
+		uint64_t ignored_datagrams = 0;
+
+		// Receiving rate of the last check (Mbps)
+		double receive_rate = 0.0;
+		uint64_t last_check_bytes = 0;
+	};
+
+	bool CreateInput(const cfg::MpegtsStream &stream_info, const ov::String &host_ip);
+
+	// _input_mutex must be locked
+	MpegtsInput *FindInput(const std::shared_ptr<ov::Socket> &remote);
+	void ProcessDatagram(MpegtsInput &input, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data, int64_t current_time);
+	void SendPackets(MpegtsInput &input);
+	void DeleteStream(MpegtsInput &input);
+
+	void OnTimeoutCheck();
+
+	const cfg::MpegtsProvider *_provider_info = nullptr;
+
+	std::mutex _input_mutex;
+	// key: bound address of the port
+	std::map<ov::SocketAddress, MpegtsInput> _inputs;
+
+	ov::DelayQueue _timeout_timer;
+};
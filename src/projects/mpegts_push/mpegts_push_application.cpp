@@ -0,0 +1,144 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "mpegts_push_application.h"
+#include "mpegts_push_private.h"
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<MpegtsPushApplication> MpegtsPushApplication::Create(const info::Application *application_info, const std::shared_ptr<PhysicalPort> &srt_port)
+{
+	auto application = std::make_shared<MpegtsPushApplication>(application_info, srt_port);
+	application->Start();
+	return application;
+}
+
+//====================================================================================================
+// MpegtsPushApplication
+//====================================================================================================
+MpegtsPushApplication::MpegtsPushApplication(const info::Application *application_info, const std::shared_ptr<PhysicalPort> &srt_port)
+	: Application(application_info),
+	  _srt_port(srt_port)
+{
+	auto publisher_info = application_info->GetPublisher<cfg::MpegtsPublisher>();
+
+	if(publisher_info != nullptr)
+	{
+		_push_list = publisher_info->GetPushList();
+		_srt_push_list = publisher_info->GetSrtPushList();
+
+		SetQueueConfig(publisher_info->GetQueue());
+	}
+}
+
+//====================================================================================================
+// ~MpegtsPushApplication
+//====================================================================================================
+MpegtsPushApplication::~MpegtsPushApplication()
+{
+	Stop();
+	logtd("MpegtsPushApplication(%d) has been terminated finally", GetId());
+}
+
+//====================================================================================================
+// Start
+//====================================================================================================
+bool MpegtsPushApplication::Start()
+{
+	return Application::Start();
+}
+
+//====================================================================================================
+// Stop
+//====================================================================================================
+bool MpegtsPushApplication::Stop()
+{
+	return Application::Stop();
+}
+
+//====================================================================================================
+// CreateStream
+// - The targets of UDP are IPv4 (a multicast group or a unicast address)
+// - The targets of SRT are <host>:<port>, the hosts are resolved by the callers
+//====================================================================================================
+std::shared_ptr<Stream> MpegtsPushApplication::CreateStream(std::shared_ptr<StreamInfo> info, uint32_t worker_count)
+{
+	std::vector<MpegtsPushTarget> targets;
+
+	for(const auto &push : _push_list)
+	{
+		if((push.GetStreamName().IsEmpty() == false) && (push.GetStreamName() != info->GetName()))
+		{
+			continue;
+		}
+
+		MpegtsPushTarget target;
+
+		target.address = ov::SocketAddress(push.GetAddress());
+
+		if((target.address.AddressForIPv4() == nullptr) || (target.address.AddrInForIPv4()->s_addr == 0) || (target.address.Port() == 0))
+		{
+			logte("Invalid MPEG-TS push address: %s (%s/%s)", push.GetAddress().CStr(), GetName().CStr(), info->GetName().CStr());
+			continue;
+		}
+
+		target.is_multicast = IN_MULTICAST(ntohl(target.address.AddrInForIPv4()->s_addr));
+		target.ttl = push.GetTtl();
+		target.interface = push.GetInterface();
+		target.pacing_rate = static_cast<uint64_t>(std::max(push.GetPacingRate(), 0)) * 1000;
+
+		targets.push_back(target);
+	}
+
+	std::vector<MpegtsSrtTarget> srt_targets;
+
+	for(const auto &push : _srt_push_list)
+	{
+		if((push.GetStreamName().IsEmpty() == false) && (push.GetStreamName() != info->GetName()))
+		{
+			continue;
+		}
+
+		MpegtsSrtTarget target;
+		auto address = push.GetAddress();
+		auto position = address.IndexOfRev(':');
+
+		if(position > 0)
+		{
+			target.host = address.Substring(0, static_cast<size_t>(position));
+			target.port = static_cast<uint16_t>(ov::Converter::ToInt32(address.Substring(position + 1)));
+		}
+
+		if(target.host.IsEmpty() || (target.port == 0))
+		{
+			logte("Invalid SRT push address: %s (%s/%s)", address.CStr(), GetName().CStr(), info->GetName().CStr());
+			continue;
+		}
+
+		target.stream_id = push.GetStreamId().IsEmpty() ? ov::String::FormatString("%s/%s", GetName().CStr(), info->GetName().CStr()) : push.GetStreamId();
+		target.latency = std::max(push.GetLatency(), 0);
+		target.passphrase = push.GetPassphrase();
+
+		srt_targets.push_back(target);
+	}
+
+	logtd("CreateStream : %s/%u (%zu targets, %zu SRT targets)", info->GetName().CStr(), info->GetId(), targets.size(), srt_targets.size());
+
+	return MpegtsPushStream::Create(GetSharedPtrAs<Application>(), *info, worker_count, targets, srt_targets, _srt_port);
+}
+
+//====================================================================================================
+// DeleteStream
+// - The sockets are closed by MpegtsPushStream::Stop()
+//====================================================================================================
+bool MpegtsPushApplication::DeleteStream(std::shared_ptr<StreamInfo> info)
+{
+	logtd("DeleteStream : %s/%u", info->GetName().CStr(), info->GetId());
+
+	return true;
+}
@@ -0,0 +1,39 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/common_types.h>
+#include <base/publisher/application.h>
+#include <config/config.h>
+#include "mpegts_push_stream.h"
+
+//====================================================================================================
+// MpegtsPushApplication
+// - Creates the push targets of a stream from <Publishers><MPEGTS><Push>/<SrtPush>
+//====================================================================================================
+class MpegtsPushApplication : public Application
+{
+public:
+	// srt_port: the listener of <SrtListen> (nullptr if it is not enabled)
+	static std::shared_ptr<MpegtsPushApplication> Create(const info::Application *application_info, const std::shared_ptr<PhysicalPort> &srt_port);
+
+	MpegtsPushApplication(const info::Application *application_info, const std::shared_ptr<PhysicalPort> &srt_port);
+	~MpegtsPushApplication() final;
+
+private:
+	bool Start() override;
+	bool Stop() override;
+
+	// Application Implementation
+	std::shared_ptr<Stream> CreateStream(std::shared_ptr<StreamInfo> info, uint32_t worker_count) override;
+	bool DeleteStream(std::shared_ptr<StreamInfo> info) override;
+
+	std::vector<cfg::MpegtsPush> _push_list;
+	std::vector<cfg::MpegtsSrtPush> _srt_push_list;
+	std::shared_ptr<PhysicalPort> _srt_port;
+};
@@ -0,0 +1,281 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "mpegts_push_publisher.h"
+#include "mpegts_push_private.h"
+
+#include <srt/srt_stream_id.h>
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<MpegtsPushPublisher> MpegtsPushPublisher::Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+{
+	auto publisher = std::make_shared<MpegtsPushPublisher>(application_info, router);
+
+	if(publisher->Start() == false)
+	{
+		return nullptr;
+	}
+
+	return publisher;
+}
+
+//====================================================================================================
+// MpegtsPushPublisher
+//====================================================================================================
+MpegtsPushPublisher::MpegtsPushPublisher(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+	: Publisher(application_info, std::move(router))
+{
+}
+
+//====================================================================================================
+// ~MpegtsPushPublisher
+//====================================================================================================
+MpegtsPushPublisher::~MpegtsPushPublisher()
+{
+	Stop();
+	logtd("MpegtsPushPublisher has been terminated finally");
+}
+
+//====================================================================================================
+// Start
+//====================================================================================================
+bool MpegtsPushPublisher::Start()
+{
+	auto publisher_info = _application_info->GetPublisher<cfg::MpegtsPublisher>();
+
+	if((publisher_info == nullptr) || (publisher_info->IsParsed() == false))
+	{
+		logte("Invalid MPEG-TS publisher configuration");
+		return false;
+	}
+
+	// The listener is created before the applications, they give it to the streams
+	if(publisher_info->GetSrtListen().IsParsed() && (StartSrtListener(publisher_info->GetSrtListen()) == false))
+	{
+		return false;
+	}
+
+	if(publisher_info->GetPushList().empty() && publisher_info->GetSrtPushList().empty() && (_srt_port == nullptr))
+	{
+		logtw("There is no MPEG-TS push target for %s", _application_info->GetName().CStr());
+	}
+
+	return Publisher::Start();
+}
+
+//====================================================================================================
+// Stop
+// - The receivers are disconnected by the streams
+//====================================================================================================
+bool MpegtsPushPublisher::Stop()
+{
+	auto result = Publisher::Stop();
+
+	if(_srt_port != nullptr)
+	{
+		_srt_port->RemoveObserver(this);
+
+		PhysicalPortManager::Instance()->DeletePort(_srt_port);
+		_srt_port = nullptr;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_srt_receiver_mutex);
+
+		_srt_receivers.clear();
+	}
+
+	return result;
+}
+
+//====================================================================================================
+// StartSrtListener
+// - The options are set to the listening socket, and the accepted sockets inherit them (see SrtProvider)
+//====================================================================================================
+bool MpegtsPushPublisher::StartSrtListener(const cfg::MpegtsSrtListen &listen)
+{
+	auto host = _application_info->GetParentAs<cfg::Host>("Host");
+
+	if(host == nullptr)
+	{
+		OV_ASSERT2(false);
+		return false;
+	}
+
+	auto &port = listen.GetPort();
+
+	if(port.GetSocketType() != ov::SocketType::Srt)
+	{
+		logte("Invalid SRT listener port of MPEG-TS publisher: %d (the type must be srt)", port.GetPort());
+		return false;
+	}
+
+	auto latency = static_cast<int32_t>(std::max(listen.GetLatency(), 0));
+	auto passphrase = listen.GetPassphrase();
+
+	if((passphrase.IsEmpty() == false) &&
+	   ((passphrase.GetLength() < SRT_PROVIDER_MIN_PASSPHRASE_LENGTH) || (passphrase.GetLength() > SRT_PROVIDER_MAX_PASSPHRASE_LENGTH)))
+	{
+		logte("The passphrase of SRT must be %d~%d characters (application: %s)",
+			  SRT_PROVIDER_MIN_PASSPHRASE_LENGTH, SRT_PROVIDER_MAX_PASSPHRASE_LENGTH, _application_info->GetName().CStr());
+		return false;
+	}
+
+	auto address = ov::SocketAddress(host->GetIp(), static_cast<uint16_t>(port.GetPort()));
+
+	_srt_port = PhysicalPortManager::Instance()->CreatePort(ov::SocketType::Srt, address);
+
+	if(_srt_port == nullptr)
+	{
+		logte("Could not initialize phyiscal port for MPEG-TS publisher: %s", address.ToString().CStr());
+		return false;
+	}
+
+	// The latency of the sender is SRTO_PEERLATENCY, each receiver may require more with its SRTO_RCVLATENCY
+	bool result = _srt_port->SetSrtSocketOption(SRTO_PEERLATENCY, &latency, static_cast<int>(sizeof(latency)));
+
+	if(passphrase.IsEmpty() == false)
+	{
+		result = result && _srt_port->SetSrtSocketOption(SRTO_PASSPHRASE, passphrase.CStr(), static_cast<int>(passphrase.GetLength()));
+	}
+
+	if(result == false)
+	{
+		logte("Could not set the options of SRT listener of MPEG-TS publisher: %s", address.ToString().CStr());
+
+		PhysicalPortManager::Instance()->DeletePort(_srt_port);
+		_srt_port = nullptr;
+		return false;
+	}
+
+	_srt_port->AddObserver(this);
+
+	logti("MPEG-TS publisher is listening on %s for SRT receivers (application: %s, latency: %d ms, encryption: %s)...",
+		  address.ToString().CStr(), _application_info->GetName().CStr(), latency, passphrase.IsEmpty() ? "off" : "on");
+
+	return true;
+}
+
+//====================================================================================================
+// OnCreateApplication
+//====================================================================================================
+std::shared_ptr<Application> MpegtsPushPublisher::OnCreateApplication(const info::Application *application_info)
+{
+	return MpegtsPushApplication::Create(application_info, _srt_port);
+}
+
+//====================================================================================================
+// OnConnected
+// - PhysicalPortObserver 구현
+// - The stream must exist, the receiver gets the TS from the next datagram (PAT/PMT is repeated)
+//====================================================================================================
+void MpegtsPushPublisher::OnConnected(const std::shared_ptr<ov::Socket> &remote)
+{
+	char stream_id_buffer[SRT_PROVIDER_MAX_STREAM_ID_LENGTH + 1] = { 0 };
+	int stream_id_length = SRT_PROVIDER_MAX_STREAM_ID_LENGTH;
+
+	if(remote->GetSockOpt(SRTO_STREAMID, stream_id_buffer, &stream_id_length) == false)
+	{
+		Disconnect(remote);
+		return;
+	}
+
+	ov::String stream_id(stream_id_buffer, static_cast<size_t>(std::max(stream_id_length, 0)));
+	ov::String app_name;
+	ov::String stream_name;
+
+	if(SrtStreamId::Parse(stream_id, app_name, stream_name) == false)
+	{
+		logtw("Invalid stream id (%s) - remote(%s)", stream_id.CStr(), remote->ToString().CStr());
+		Disconnect(remote);
+		return;
+	}
+
+	if(app_name != _application_info->GetName())
+	{
+		// The connection is for another application which shares the port
+		return;
+	}
+
+	// The lock is not held while the stream is looked up (the streams disconnect the receivers when they are deleted)
+	auto stream = std::dynamic_pointer_cast<MpegtsPushStream>(GetStream(app_name, stream_name));
+
+	if(stream == nullptr)
+	{
+		logtw("Cannot find the stream for SRT receiver - app(%s) stream(%s) remote(%s)", app_name.CStr(), stream_name.CStr(), remote->ToString().CStr());
+		Disconnect(remote);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_srt_receiver_mutex);
+
+		if(stream->AddSrtReceiver(remote))
+		{
+			_srt_receivers[remote.get()] = stream;
+			return;
+		}
+	}
+
+	// The stream is not pushed (e.g. it has no H264/H265/AAC track)
+	Disconnect(remote);
+}
+
+//====================================================================================================
+// OnDataReceived
+// - PhysicalPortObserver 구현
+// - The receivers don't send the payload
+//====================================================================================================
+void MpegtsPushPublisher::OnDataReceived(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data)
+{
+}
+
+//====================================================================================================
+// OnDisconnected
+// - PhysicalPortObserver 구현
+//====================================================================================================
+void MpegtsPushPublisher::OnDisconnected(const std::shared_ptr<ov::Socket> &remote, PhysicalPortDisconnectReason reason, const std::shared_ptr<const ov::Error> &error)
+{
+	std::lock_guard<std::mutex> lock(_srt_receiver_mutex);
+
+	auto item = _srt_receivers.find(remote.get());
+
+	if(item == _srt_receivers.end())
+	{
+		return;
+	}
+
+	auto stream = item->second.lock();
+
+	if(stream != nullptr)
+	{
+		stream->RemoveSrtReceiver(remote);
+	}
+
+	_srt_receivers.erase(item);
+}
+
+void MpegtsPushPublisher::Disconnect(const std::shared_ptr<ov::Socket> &remote)
+{
+	auto client_socket = std::dynamic_pointer_cast<ov::ClientSocket>(remote);
+
+	if((_srt_port != nullptr) && (client_socket != nullptr))
+	{
+		_srt_port->DisconnectClient(client_socket.get());
+	}
+}
+
+//====================================================================================================
+// monitoring data pure virtual function
+// - The pushed streams are not counted as the connections
+//====================================================================================================
+bool MpegtsPushPublisher::GetMonitoringCollectionData(std::vector<std::shared_ptr<MonitoringCollectionData>> &collections)
+{
+	return true;
+}
@@ -0,0 +1,58 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/common_types.h>
+#include <base/publisher/publisher.h>
+#include <physical_port/physical_port_manager.h>
+#include "mpegts_push_application.h"
+
+//====================================================================================================
+// MpegtsPushPublisher
+// - Pushes the streams as MPEG-TS over UDP to the multicast groups/unicast addresses (<Publishers><MPEGTS>)
+// - Pushes them over SRT to the receivers (<SrtPush>), and serves them to the callers of the SRT listener (<SrtListen>)
+//   with the stream id "<app>/<stream>" (or "#!::r=<app>/<stream>", the same as SRT provider)
+//====================================================================================================
+class MpegtsPushPublisher : public Publisher, public PhysicalPortObserver
+{
+public:
+	static std::shared_ptr<MpegtsPushPublisher> Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+
+	MpegtsPushPublisher(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+	~MpegtsPushPublisher() override;
+
+	bool GetMonitoringCollectionData(std::vector<std::shared_ptr<MonitoringCollectionData>> &collections) override;
+
+	//--------------------------------------------------------------------
+	// Implementation of PhysicalPortObserver
+	//--------------------------------------------------------------------
+	void OnConnected(const std::shared_ptr<ov::Socket> &remote) override;
+	void OnDataReceived(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data) override;
+	void OnDisconnected(const std::shared_ptr<ov::Socket> &remote, PhysicalPortDisconnectReason reason, const std::shared_ptr<const ov::Error> &error) override;
+
+private:
+	bool Start() override;
+	bool Stop() override;
+
+	bool StartSrtListener(const cfg::MpegtsSrtListen &listen);
+	void Disconnect(const std::shared_ptr<ov::Socket> &remote);
+
+	// Publisher Implementation
+	cfg::PublisherType GetPublisherType() override
+	{
+		return cfg::PublisherType::Mpegts;
+	}
+
+	std::shared_ptr<Application> OnCreateApplication(const info::Application *application_info) override;
+
+	std::shared_ptr<PhysicalPort> _srt_port;
+
+	std::mutex _srt_receiver_mutex;
+	// key: remote socket
+	std::map<ov::Socket *, std::weak_ptr<MpegtsPushStream>> _srt_receivers;
+};
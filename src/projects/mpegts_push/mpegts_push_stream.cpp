@@ -0,0 +1,630 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "mpegts_push_stream.h"
+#include "mpegts_push_private.h"
+
+#include <base/ovsocket/dns_resolver.h>
+#include <base/publisher/application.h>
+
+using namespace common;
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<MpegtsPushStream> MpegtsPushStream::Create(const std::shared_ptr<Application> application,
+														   const StreamInfo &info,
+														   uint32_t worker_count,
+														   const std::vector<MpegtsPushTarget> &targets,
+														   const std::vector<MpegtsSrtTarget> &srt_targets,
+														   const std::shared_ptr<PhysicalPort> &srt_port)
+{
+	auto stream = std::make_shared<MpegtsPushStream>(application, info, targets, srt_targets, srt_port);
+
+	if(stream->Start(worker_count) == false)
+	{
+		return nullptr;
+	}
+
+	return stream;
+}
+
+//====================================================================================================
+// MpegtsPushStream
+//====================================================================================================
+MpegtsPushStream::MpegtsPushStream(const std::shared_ptr<Application> application,
+								   const StreamInfo &info,
+								   const std::vector<MpegtsPushTarget> &targets,
+								   const std::vector<MpegtsSrtTarget> &srt_targets,
+								   const std::shared_ptr<PhysicalPort> &srt_port)
+	: Stream(application, info),
+	  _targets(targets),
+	  _srt_targets(srt_targets),
+	  _srt_port(srt_port)
+{
+}
+
+//====================================================================================================
+// ~MpegtsPushStream
+//====================================================================================================
+MpegtsPushStream::~MpegtsPushStream()
+{
+	logtd("MpegtsPushStream(%u) has been terminated finally", GetId());
+	Stop();
+}
+
+//====================================================================================================
+// Start
+// - Only the first H264/H265/AAC tracks are pushed
+//====================================================================================================
+bool MpegtsPushStream::Start(uint32_t worker_count)
+{
+	for(auto &track_item : _tracks)
+	{
+		auto &track = track_item.second;
+
+		if((track->GetMediaType() == MediaType::Video) &&
+		   ((track->GetCodecId() == MediaCodecId::H264) || (track->GetCodecId() == MediaCodecId::H265)) &&
+		   (_video_track == nullptr))
+		{
+			_video_track = track;
+		}
+		else if((track->GetMediaType() == MediaType::Audio) && (track->GetCodecId() == MediaCodecId::Aac) && (_audio_track == nullptr))
+		{
+			_audio_track = track;
+		}
+		else
+		{
+			logtw("[%s/%s] Track %d is not pushed (only the first H264/H265/AAC tracks are supported)",
+				  GetApplication()->GetName().CStr(), GetName().CStr(), track->GetId());
+		}
+	}
+
+	// There is no session, the frames are sent by the worker of the stream
+	if(Stream::Start(1) == false)
+	{
+		return false;
+	}
+
+	if((_video_track == nullptr) && (_audio_track == nullptr))
+	{
+		logtw("[%s/%s] There is no H264/H265/AAC track to push", GetApplication()->GetName().CStr(), GetName().CStr());
+		return true;
+	}
+
+	// The rate of the targets which don't specify it
+	uint64_t bitrate = 0;
+
+	if(_video_track != nullptr)
+	{
+		bitrate += static_cast<uint64_t>(std::max(_video_track->GetBitrate(), 0));
+	}
+
+	if(_audio_track != nullptr)
+	{
+		bitrate += static_cast<uint64_t>(std::max(_audio_track->GetBitrate(), 0));
+	}
+
+	uint64_t pacing_rate = bitrate * (100 + MPEGTS_PUSH_PACING_HEADROOM) / 100;
+
+	std::lock_guard<std::mutex> lock_guard(_sender_mutex);
+
+	for(const auto &target : _targets)
+	{
+		CreateSender(target, pacing_rate);
+	}
+
+	// The SRT listener may get the receivers later
+	if(_senders.empty() && _srt_targets.empty() && (_srt_port == nullptr))
+	{
+		return true;
+	}
+
+	auto codec_type = ((_video_track != nullptr) && (_video_track->GetCodecId() == MediaCodecId::H265)) ? SegmentCodecType::H265Codec : SegmentCodecType::H264Codec;
+
+	_ts_writer = std::make_unique<TsWriter>(_video_track != nullptr, _audio_track != nullptr, codec_type);
+
+	// PAT/PMT is written by the constructor
+	_program_tables = *(_ts_writer->GetDataStream());
+	_ts_writer->ClearDataStream();
+
+	_pending_data.reserve(MPEGTS_PUSH_DATAGRAM_SIZE * 64);
+	_waiting_key_frame = (_video_track != nullptr);
+
+	for(const auto &target : _srt_targets)
+	{
+		auto caller = std::make_unique<SrtCaller>();
+
+		caller->target = target;
+		caller->address.Format("%s:%u", target.host.CStr(), target.port);
+		caller->socket = std::make_shared<ov::Socket>();
+		caller->thread = std::thread(&MpegtsPushStream::SrtCallerThread, this, caller.get());
+
+		_srt_callers.push_back(std::move(caller));
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// Stop
+//====================================================================================================
+bool MpegtsPushStream::Stop()
+{
+	std::vector<std::unique_ptr<SrtCaller>> srt_callers;
+	std::map<ov::Socket *, SrtReceiver> srt_receivers;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_sender_mutex);
+
+		for(auto &sender : _senders)
+		{
+			logti("[%s/%s] MPEG-TS push is stopped - target(%s) datagrams(%llu)",
+				  GetApplication()->GetName().CStr(), GetName().CStr(), sender->target.address.ToString().CStr(),
+				  static_cast<unsigned long long>(sender->sent_datagrams));
+
+			sender->socket->Close();
+		}
+
+		_senders.clear();
+		_ts_writer = nullptr;
+		_pending_data.clear();
+
+		// Recv() of the callers returns when the sockets are closed
+		_srt_stop = true;
+
+		for(auto &caller : _srt_callers)
+		{
+			caller->is_connected = false;
+			caller->socket->Close();
+		}
+
+		srt_callers = std::move(_srt_callers);
+		_srt_callers.clear();
+		srt_receivers = std::move(_srt_receivers);
+		_srt_receivers.clear();
+	}
+
+	_srt_stop_condition.notify_all();
+
+	for(auto &caller : srt_callers)
+	{
+		if(caller->thread.joinable())
+		{
+			caller->thread.join();
+		}
+
+		logti("[%s/%s] SRT push is stopped - target(%s) datagrams(%llu) connections(%llu)",
+			  GetApplication()->GetName().CStr(), GetName().CStr(), caller->address.CStr(),
+			  static_cast<unsigned long long>(caller->sent_datagrams), static_cast<unsigned long long>(caller->connection_count));
+	}
+
+	// The lock is not held, the disconnection may be notified to the publisher right away
+	for(auto &item : srt_receivers)
+	{
+		auto client_socket = std::dynamic_pointer_cast<ov::ClientSocket>(item.second.socket);
+
+		logti("[%s/%s] SRT receiver is disconnected by the stream - remote(%s) datagrams(%llu)",
+			  GetApplication()->GetName().CStr(), GetName().CStr(), item.second.socket->ToString().CStr(),
+			  static_cast<unsigned long long>(item.second.sent_datagrams));
+
+		if((_srt_port != nullptr) && (client_socket != nullptr))
+		{
+			_srt_port->DisconnectClient(client_socket.get());
+		}
+	}
+
+	return Stream::Stop();
+}
+
+//====================================================================================================
+// CreateSender
+// - _sender_mutex must be locked
+//====================================================================================================
+bool MpegtsPushStream::CreateSender(const MpegtsPushTarget &target, uint64_t pacing_rate)
+{
+	auto sender = std::make_unique<Sender>();
+
+	sender->target = target;
+	sender->socket = std::make_shared<ov::DatagramSocket>();
+
+	// Any address/port, the socket only sends
+	if(sender->socket->Prepare(0) == false)
+	{
+		logte("[%s/%s] Could not create the socket to %s", GetApplication()->GetName().CStr(), GetName().CStr(), target.address.ToString().CStr());
+		return false;
+	}
+
+	if(target.is_multicast && (sender->socket->SetMulticastOutput(target.ttl, false, ov::SocketAddress(target.interface, 0)) == false))
+	{
+		sender->socket->Close();
+		return false;
+	}
+
+	auto rate = (target.pacing_rate > 0) ? target.pacing_rate : pacing_rate;
+
+	if((rate > 0) && (sender->socket->SetTxTime(true) == false))
+	{
+		logtw("[%s/%s] The datagrams to %s are not paced (SO_TXTIME is not supported)",
+			  GetApplication()->GetName().CStr(), GetName().CStr(), target.address.ToString().CStr());
+	}
+
+	// The departure times are ignored by the socket if SO_TXTIME is not enabled
+	sender->pacer.SetRate(rate);
+
+	logti("[%s/%s] MPEG-TS push is started - target(%s) multicast(%s) pacing(%llu kbps)",
+		  GetApplication()->GetName().CStr(), GetName().CStr(), target.address.ToString().CStr(),
+		  target.is_multicast ? "on" : "off", static_cast<unsigned long long>(rate / 1000));
+
+	_senders.push_back(std::move(sender));
+
+	return true;
+}
+
+//====================================================================================================
+// SrtCallerThread
+// - The receiver doesn't send the payload, so Recv() blocks until the connection is closed
+//====================================================================================================
+void MpegtsPushStream::SrtCallerThread(SrtCaller *caller)
+{
+	auto &target = caller->target;
+	auto &socket = caller->socket;
+	auto data = std::make_shared<ov::Data>(ov::MaxSrtPacketSize);
+
+	while(true)
+	{
+		{
+			std::lock_guard<std::mutex> lock_guard(_sender_mutex);
+
+			if(_srt_stop)
+			{
+				break;
+			}
+		}
+
+		if((socket->GetState() == ov::SocketState::Closed) && (socket->Create(ov::SocketType::Srt) == false))
+		{
+			logte("[%s/%s] Could not create the SRT socket to %s", GetApplication()->GetName().CStr(), GetName().CStr(), caller->address.CStr());
+			break;
+		}
+
+		// The options must be set before the connection
+		auto latency = static_cast<int32_t>(target.latency);
+		bool result = socket->SetSockOpt(SRTO_LATENCY, latency);
+
+		result = result && socket->SetSockOpt(SRTO_STREAMID, target.stream_id.CStr(), static_cast<int>(target.stream_id.GetLength()));
+
+		if(target.passphrase.IsEmpty() == false)
+		{
+			result = result && socket->SetSockOpt(SRTO_PASSPHRASE, target.passphrase.CStr(), static_cast<int>(target.passphrase.GetLength()));
+		}
+
+		if(result == false)
+		{
+			logte("[%s/%s] Could not set the options of SRT to %s", GetApplication()->GetName().CStr(), GetName().CStr(), caller->address.CStr());
+			socket->Close();
+			break;
+		}
+
+		auto addresses = ov::DnsResolver::Instance()->Resolve(target.host, target.port, MPEGTS_PUSH_SRT_RESOLVE_TIMEOUT);
+
+		if(addresses.empty())
+		{
+			logtw("[%s/%s] Could not resolve the SRT receiver %s", GetApplication()->GetName().CStr(), GetName().CStr(), caller->address.CStr());
+
+			socket->Close();
+
+			if(WaitForReconnect() == false)
+			{
+				break;
+			}
+
+			continue;
+		}
+
+		auto error = socket->Connect(addresses, MPEGTS_PUSH_SRT_CONNECT_TIMEOUT);
+
+		if(error != nullptr)
+		{
+			logtw("[%s/%s] Could not connect to the SRT receiver %s (%s)",
+				  GetApplication()->GetName().CStr(), GetName().CStr(), caller->address.CStr(), error->ToString().CStr());
+
+			socket->Close();
+
+			if(WaitForReconnect() == false)
+			{
+				break;
+			}
+
+			continue;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock_guard(_sender_mutex);
+
+			if(_srt_stop)
+			{
+				socket->Close();
+				break;
+			}
+
+			caller->is_connected = true;
+			caller->connection_count++;
+		}
+
+		logti("[%s/%s] SRT push is started - target(%s) stream id(%s) latency(%d ms) encryption(%s)",
+			  GetApplication()->GetName().CStr(), GetName().CStr(), caller->address.CStr(),
+			  target.stream_id.CStr(), target.latency, target.passphrase.IsEmpty() ? "off" : "on");
+
+		while(socket->Recv(data) == nullptr)
+		{
+		}
+
+		bool is_stopped;
+
+		{
+			std::lock_guard<std::mutex> lock_guard(_sender_mutex);
+
+			caller->is_connected = false;
+			socket->Close();
+
+			is_stopped = _srt_stop;
+		}
+
+		if(is_stopped)
+		{
+			break;
+		}
+
+		logtw("[%s/%s] SRT receiver %s is disconnected, reconnecting in %d ms",
+			  GetApplication()->GetName().CStr(), GetName().CStr(), caller->address.CStr(), MPEGTS_PUSH_SRT_RECONNECT_INTERVAL);
+
+		if(WaitForReconnect() == false)
+		{
+			break;
+		}
+	}
+}
+
+//====================================================================================================
+// WaitForReconnect
+//====================================================================================================
+bool MpegtsPushStream::WaitForReconnect()
+{
+	std::unique_lock<std::mutex> lock(_sender_mutex);
+
+	_srt_stop_condition.wait_for(lock, std::chrono::milliseconds(MPEGTS_PUSH_SRT_RECONNECT_INTERVAL), [this]() -> bool {
+		return _srt_stop;
+	});
+
+	return _srt_stop == false;
+}
+
+//====================================================================================================
+// AddSrtReceiver
+//====================================================================================================
+bool MpegtsPushStream::AddSrtReceiver(const std::shared_ptr<ov::Socket> &remote)
+{
+	std::lock_guard<std::mutex> lock_guard(_sender_mutex);
+
+	if((_ts_writer == nullptr) || (_srt_port == nullptr) || _srt_stop)
+	{
+		return false;
+	}
+
+	_srt_receivers[remote.get()].socket = remote;
+
+	logti("[%s/%s] SRT receiver is connected - remote(%s) receivers(%zu)",
+		  GetApplication()->GetName().CStr(), GetName().CStr(), remote->ToString().CStr(), _srt_receivers.size());
+
+	return true;
+}
+
+//====================================================================================================
+// RemoveSrtReceiver
+//====================================================================================================
+void MpegtsPushStream::RemoveSrtReceiver(const std::shared_ptr<ov::Socket> &remote)
+{
+	std::lock_guard<std::mutex> lock_guard(_sender_mutex);
+
+	auto item = _srt_receivers.find(remote.get());
+
+	if(item == _srt_receivers.end())
+	{
+		return;
+	}
+
+	logti("[%s/%s] SRT receiver is disconnected - remote(%s) datagrams(%llu)",
+		  GetApplication()->GetName().CStr(), GetName().CStr(), remote->ToString().CStr(),
+		  static_cast<unsigned long long>(item->second.sent_datagrams));
+
+	_srt_receivers.erase(item);
+}
+
+//====================================================================================================
+// WriteProgramTables
+// - The continuity counters of PAT/PMT are increased by each repetition
+//====================================================================================================
+void MpegtsPushStream::WriteProgramTables()
+{
+	size_t offset = _pending_data.size();
+
+	_pending_data.insert(_pending_data.end(), _program_tables.begin(), _program_tables.end());
+
+	for(size_t position = offset; (position + MPEGTS_PUSH_TS_PACKET_SIZE) <= _pending_data.size(); position += MPEGTS_PUSH_TS_PACKET_SIZE)
+	{
+		_pending_data[position + 3] = static_cast<uint8_t>((_pending_data[position + 3] & 0xF0) | (_program_table_continuity_count & 0x0F));
+	}
+
+	_program_table_continuity_count++;
+}
+
+//====================================================================================================
+// WriteSample
+//====================================================================================================
+void MpegtsPushStream::WriteSample(bool is_video, bool is_keyframe, int64_t timestamp, std::shared_ptr<ov::Data> &data)
+{
+	if((_ts_writer == nullptr) || (data == nullptr))
+	{
+		return;
+	}
+
+	if((is_video && is_keyframe) ||
+	   (_last_program_table_time < 0) || (timestamp < _last_program_table_time) ||
+	   ((timestamp - _last_program_table_time) >= (MPEGTS_PUSH_PROGRAM_TABLE_INTERVAL * MPEGTS_PUSH_TIMESCALE / 1000)))
+	{
+		WriteProgramTables();
+		_last_program_table_time = timestamp;
+	}
+
+	_ts_writer->WriteSample(is_video, is_keyframe, static_cast<uint64_t>(timestamp), 0, data);
+
+	auto &data_stream = _ts_writer->GetDataStream();
+
+	_pending_data.insert(_pending_data.end(), data_stream->begin(), data_stream->end());
+	_ts_writer->ClearDataStream();
+
+	SendDatagrams();
+}
+
+//====================================================================================================
+// SendDatagrams
+//====================================================================================================
+void MpegtsPushStream::SendDatagrams()
+{
+	size_t count = _pending_data.size() / MPEGTS_PUSH_DATAGRAM_SIZE;
+
+	if(count == 0)
+	{
+		return;
+	}
+
+	std::vector<std::shared_ptr<ov::Data>> datagrams;
+
+	datagrams.reserve(count);
+
+	for(size_t index = 0; index < count; index++)
+	{
+		datagrams.push_back(std::make_shared<ov::Data>(_pending_data.data() + (index * MPEGTS_PUSH_DATAGRAM_SIZE), MPEGTS_PUSH_DATAGRAM_SIZE));
+	}
+
+	_pending_data.erase(_pending_data.begin(), _pending_data.begin() + (count * MPEGTS_PUSH_DATAGRAM_SIZE));
+
+	for(auto &sender : _senders)
+	{
+		auto sent_count = sender->socket->SendToBatch(sender->target.address, datagrams, &(sender->pacer));
+
+		if(sent_count < 0)
+		{
+			// Logged once until the datagrams are sent again (e.g. no route to the target)
+			if(sender->failed_count == 0)
+			{
+				logtw("[%s/%s] Could not send the datagrams to %s", GetApplication()->GetName().CStr(), GetName().CStr(), sender->target.address.ToString().CStr());
+			}
+
+			sender->failed_count++;
+			continue;
+		}
+
+		sender->failed_count = 0;
+		sender->sent_datagrams += static_cast<uint64_t>(sent_count);
+	}
+
+	// A datagram is a SRT packet, the sockets of the live mode don't block (the late packets are dropped by SRT)
+	for(auto &caller : _srt_callers)
+	{
+		if(caller->is_connected)
+		{
+			caller->sent_datagrams += SendSrtDatagrams(caller->socket, datagrams);
+		}
+	}
+
+	for(auto &item : _srt_receivers)
+	{
+		item.second.sent_datagrams += SendSrtDatagrams(item.second.socket, datagrams);
+	}
+}
+
+//====================================================================================================
+// SendSrtDatagrams
+//====================================================================================================
+uint64_t MpegtsPushStream::SendSrtDatagrams(const std::shared_ptr<ov::Socket> &socket, const std::vector<std::shared_ptr<ov::Data>> &datagrams)
+{
+	uint64_t sent_count = 0;
+
+	for(auto &datagram : datagrams)
+	{
+		if(socket->Send(datagram) != static_cast<ssize_t>(datagram->GetLength()))
+		{
+			break;
+		}
+
+		sent_count++;
+	}
+
+	return sent_count;
+}
+
+//====================================================================================================
+// SendVideoFrame
+//====================================================================================================
+void MpegtsPushStream::SendVideoFrame(std::shared_ptr<MediaTrack> track,
+									  std::unique_ptr<EncodedFrameDescriptor> frame)
+{
+	if((_video_track == nullptr) || (track->GetId() != _video_track->GetId()))
+	{
+		return;
+	}
+
+	auto encoded_frame = &(frame->encoded_frame);
+	bool is_keyframe = (encoded_frame->_frame_type == FrameType::VideoFrameKey);
+
+	std::lock_guard<std::mutex> lock_guard(_sender_mutex);
+
+	if(_waiting_key_frame)
+	{
+		if(is_keyframe == false)
+		{
+			return;
+		}
+
+		_waiting_key_frame = false;
+	}
+
+	// The timestamp of the video frames is 90kHz
+	WriteSample(true, is_keyframe, encoded_frame->_time_stamp, encoded_frame->_buffer);
+}
+
+//====================================================================================================
+// SendAudioFrame
+// - The audio is sent from the first key frame of the video
+//====================================================================================================
+void MpegtsPushStream::SendAudioFrame(std::shared_ptr<MediaTrack> track,
+									  std::unique_ptr<EncodedFrameDescriptor> frame)
+{
+	if((_audio_track == nullptr) || (track->GetId() != _audio_track->GetId()))
+	{
+		return;
+	}
+
+	auto encoded_frame = &(frame->encoded_frame);
+	auto &timebase = track->GetTimeBase();
+
+	if(timebase.GetDen() == 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock_guard(_sender_mutex);
+
+	if(_waiting_key_frame)
+	{
+		return;
+	}
+
+	WriteSample(false, true, encoded_frame->_time_stamp * MPEGTS_PUSH_TIMESCALE * timebase.GetNum() / timebase.GetDen(), encoded_frame->_buffer);
+}
@@ -0,0 +1,168 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/common_types.h>
+#include <base/publisher/stream.h>
+#include <base/ovsocket/ovsocket.h>
+#include <config/config.h>
+#include <physical_port/physical_port.h>
+#include <segment_stream/packetyzer/ts_writer.h>
+
+#include <condition_variable>
+#include <map>
+#include <thread>
+
+// Timescale of the video frames (see MediaRouteApplication) and the TS
+#define MPEGTS_PUSH_TIMESCALE				(90000)
+#define MPEGTS_PUSH_TS_PACKET_SIZE			(188)
+// 7 TS packets per datagram (fits in the MTU of the ethernet with IP/UDP headers)
+#define MPEGTS_PUSH_PACKETS_PER_DATAGRAM	(7)
+#define MPEGTS_PUSH_DATAGRAM_SIZE			(MPEGTS_PUSH_PACKETS_PER_DATAGRAM * MPEGTS_PUSH_TS_PACKET_SIZE)
+// PAT/PMT is repeated at the key frames, and at least once in the interval (ms) for the receivers which join later
+#define MPEGTS_PUSH_PROGRAM_TABLE_INTERVAL	(100)
+// Headroom of the pacing rate over the bitrates of the tracks (%, the PES/TS headers and the bursts of the key frames)
+#define MPEGTS_PUSH_PACING_HEADROOM			(25)
+// The SRT callers reconnect to the receivers in this interval (ms)
+#define MPEGTS_PUSH_SRT_RECONNECT_INTERVAL	(3000)
+#define MPEGTS_PUSH_SRT_CONNECT_TIMEOUT		(3000)
+#define MPEGTS_PUSH_SRT_RESOLVE_TIMEOUT		(3000)
+
+struct MpegtsPushTarget
+{
+	ov::SocketAddress address;
+	bool is_multicast = false;
+	int ttl = 0;
+	ov::String interface;
+	// bits per second (0: the bitrates of the tracks)
+	uint64_t pacing_rate = 0;
+};
+
+struct MpegtsSrtTarget
+{
+	ov::String host;
+	uint16_t port = 0;
+	ov::String stream_id;
+	// ms
+	int latency = 0;
+	ov::String passphrase;
+};
+
+//====================================================================================================
+// MpegtsPushStream
+// - Muxes the first H.264/H.265 and AAC tracks to a TS once (TsWriter), and sends it to the targets
+//   over UDP with the datagrams of 7 TS packets (the targets share the datagrams)
+// - The datagrams of a frame are sent with a syscall (sendmmsg), and paced by the kernel (SO_TXTIME),
+//   so a key frame doesn't burst into the network
+// - The frames are muxed by the worker of the stream, UDP never blocks the sender
+// - The SRT callers (<SrtPush>) and the receivers of the SRT listener (<SrtListen>) share the same datagrams,
+//   SRT keeps the latency of each connection (the datagrams are 1316 bytes, the payload of a SRT packet)
+//====================================================================================================
+class MpegtsPushStream : public Stream
+{
+public:
+	static std::shared_ptr<MpegtsPushStream> Create(const std::shared_ptr<Application> application,
+													const StreamInfo &info,
+													uint32_t worker_count,
+													const std::vector<MpegtsPushTarget> &targets,
+													const std::vector<MpegtsSrtTarget> &srt_targets,
+													const std::shared_ptr<PhysicalPort> &srt_port);
+
+	MpegtsPushStream(const std::shared_ptr<Application> application,
+					 const StreamInfo &info,
+					 const std::vector<MpegtsPushTarget> &targets,
+					 const std::vector<MpegtsSrtTarget> &srt_targets,
+					 const std::shared_ptr<PhysicalPort> &srt_port);
+	~MpegtsPushStream() final;
+
+	void SendVideoFrame(std::shared_ptr<MediaTrack> track,
+						std::unique_ptr<EncodedFrameDescriptor> frame) override;
+
+	void SendAudioFrame(std::shared_ptr<MediaTrack> track,
+						std::unique_ptr<EncodedFrameDescriptor> frame) override;
+
+	// A receiver which is connected to the SRT listener (false if the stream is not pushed)
+	bool AddSrtReceiver(const std::shared_ptr<ov::Socket> &remote);
+	void RemoveSrtReceiver(const std::shared_ptr<ov::Socket> &remote);
+
+private:
+	struct Sender
+	{
+		MpegtsPushTarget target;
+		std::shared_ptr<ov::DatagramSocket> socket;
+		ov::TxTimePacer pacer;
+
+		uint64_t sent_datagrams = 0;
+		uint64_t failed_count = 0;
+	};
+
+	struct SrtCaller
+	{
+		MpegtsSrtTarget target;
+		ov::String address;
+		std::shared_ptr<ov::Socket> socket;
+		// The datagrams are sent while it is true (_sender_mutex)
+		bool is_connected = false;
+		std::thread thread;
+
+		uint64_t sent_datagrams = 0;
+		uint64_t connection_count = 0;
+	};
+
+	struct SrtReceiver
+	{
+		std::shared_ptr<ov::Socket> socket;
+
+		uint64_t sent_datagrams = 0;
+	};
+
+	bool Start(uint32_t worker_count) override;
+	bool Stop() override;
+
+	bool CreateSender(const MpegtsPushTarget &target, uint64_t pacing_rate);
+	// Connects to the receiver and reconnects until the stream is stopped
+	void SrtCallerThread(SrtCaller *caller);
+	// Waits for the interval, returns false if the stream is stopped
+	bool WaitForReconnect();
+
+	// timestamp: 90kHz (_sender_mutex must be locked)
+	void WriteSample(bool is_video, bool is_keyframe, int64_t timestamp, std::shared_ptr<ov::Data> &data);
+	// PAT/PMT with the next continuity counter (_sender_mutex must be locked)
+	void WriteProgramTables();
+	// Sends the full datagrams of the TS, the rest is sent with the next sample (_sender_mutex must be locked)
+	void SendDatagrams();
+	// Returns the number of the datagrams which are sent
+	static uint64_t SendSrtDatagrams(const std::shared_ptr<ov::Socket> &socket, const std::vector<std::shared_ptr<ov::Data>> &datagrams);
+
+	std::vector<MpegtsPushTarget> _targets;
+	std::vector<MpegtsSrtTarget> _srt_targets;
+	std::shared_ptr<PhysicalPort> _srt_port;
+
+	std::shared_ptr<MediaTrack> _video_track;
+	std::shared_ptr<MediaTrack> _audio_track;
+
+	std::mutex _sender_mutex;
+	std::vector<std::unique_ptr<Sender>> _senders;
+	std::vector<std::unique_ptr<SrtCaller>> _srt_callers;
+	// key: remote socket
+	std::map<ov::Socket *, SrtReceiver> _srt_receivers;
+	std::condition_variable _srt_stop_condition;
+	bool _srt_stop = false;
+
+	std::unique_ptr<TsWriter> _ts_writer;
+	// PAT/PMT which is written by the constructor of TsWriter (the continuity counters are updated)
+	std::vector<uint8_t> _program_tables;
+	uint8_t _program_table_continuity_count = 0;
+	// 90kHz (-1: not written yet)
+	int64_t _last_program_table_time = -1;
+
+	// TS which is not sent yet (less than a datagram)
+	std::vector<uint8_t> _pending_data;
+
+	bool _waiting_key_frame = true;
+};
@@ -17,60 +17,110 @@ PhysicalPort::PhysicalPort()
 	  _server_socket(nullptr),
 	  _datagram_socket(nullptr),
 
-	  _need_to_stop(true)
+	  _need_to_stop(true),
+
+	  _observer_list(std::make_shared<std::vector<PhysicalPortObserver *>>())
 {
 }
 
 PhysicalPort::~PhysicalPort()
 {
-	OV_ASSERT2(_observer_list.empty());
+	OV_ASSERT2(_observer_list->empty());
 }
 
 bool PhysicalPort::Create(ov::SocketType type,
                           const ov::SocketAddress &address,
                           int send_buffer_size,
-                          int recv_buffer_size)
+                          int recv_buffer_size,
+                          int worker_count,
+                          bool io_uring)
 {
 	OV_ASSERT2((_server_socket == nullptr) && (_datagram_socket == nullptr));
 
-	logtd("Trying to start server...");
+	if(type == ov::SocketType::Srt)
+	{
+		// SRT doesn't support SO_REUSEPORT
+		worker_count = 1;
+	}
+
+	worker_count = std::max(worker_count, 1);
+	bool reuse_port = (worker_count > 1);
+
+	logtd("Trying to start server (workers: %d)...", worker_count);
 
-	switch(type)
+	for(int index = 0; index < worker_count; index++)
 	{
-		case ov::SocketType::Srt:
-		case ov::SocketType::Tcp:
+		bool result = false;
+
+		switch(type)
 		{
-			return CreateServerSocket(type, address, send_buffer_size, recv_buffer_size);
+			case ov::SocketType::Srt:
+			case ov::SocketType::Tcp:
+				result = CreateServerSocket(type, address, send_buffer_size, recv_buffer_size, reuse_port);
+				break;
+
+			case ov::SocketType::Udp:
+				result = CreateDatagramSocket(type, address, recv_buffer_size, reuse_port, io_uring);
+				break;
+
+			case ov::SocketType::Unknown:
+				break;
 		}
 
-		case ov::SocketType::Udp:
+		if(result == false)
 		{
-			return CreateDatagramSocket(type, address);
-		}
+			if(index > 0)
+			{
+				logte("Could not create worker #%d for %s", index, address.ToString().CStr());
+				Close();
+			}
 
-		case ov::SocketType::Unknown:
-			break;
+			return false;
+		}
 	}
 
-	return false;
+	return true;
+}
+
+std::shared_ptr<const std::vector<PhysicalPortObserver *>> PhysicalPort::GetObserverList()
+{
+	std::lock_guard<std::mutex> lock(_observer_list_mutex);
+
+	return _observer_list;
 }
 
 bool PhysicalPort::CreateServerSocket(ov::SocketType type,
                                       const ov::SocketAddress &address,
                                       int send_buffer_size,
-                                      int recv_buffer_size)
+                                      int recv_buffer_size,
+                                      bool reuse_port)
 {
 	auto socket = std::make_shared<ov::ServerSocket>();
 
-	if(socket->Prepare(type, address, send_buffer_size, recv_buffer_size))
+	if(socket->Prepare(type, address, send_buffer_size, recv_buffer_size, SOMAXCONN, reuse_port))
 	{
 		_type = type;
-		_server_socket = socket;
+
+		if(_server_socket == nullptr)
+		{
+			_server_socket = socket;
+		}
+
+		_server_sockets.push_back(socket);
+
+		int thread_index = static_cast<int>(_threads.size());
+
+		if(reuse_port)
+		{
+			AlignWithCpu(socket, thread_index);
+		}
 
 		_need_to_stop = false;
 
-		auto proc = [&, socket]() -> void
+		auto proc = [&, socket, thread_index]() -> void
 		{
+			ov::ThreadTopology::Instance()->BindCurrentThread(OV_THREAD_POOL_PORT, thread_index);
+
 			auto client_callback = [&](const std::shared_ptr<ov::ClientSocket> &client, ov::SocketConnectionState state) -> bool
 			{
 				switch(state)
@@ -81,7 +131,8 @@ bool PhysicalPort::CreateServerSocket(ov::SocketType type,
 
 						// observer들에게 알림
 						auto func = std::bind(&PhysicalPortObserver::OnConnected, std::placeholders::_1, std::static_pointer_cast<ov::Socket>(client));
-						for_each(_observer_list.begin(), _observer_list.end(), func);
+						auto observer_list = GetObserverList();
+						for_each(observer_list->begin(), observer_list->end(), func);
 
 						break;
 					}
@@ -92,7 +143,8 @@ bool PhysicalPort::CreateServerSocket(ov::SocketType type,
 
 						// observer들에게 알림
 						auto func = bind(&PhysicalPortObserver::OnDisconnected, std::placeholders::_1, std::static_pointer_cast<ov::Socket>(client), PhysicalPortDisconnectReason::Disconnected, nullptr);
-						for_each(_observer_list.begin(), _observer_list.end(), func);
+						auto observer_list = GetObserverList();
+						for_each(observer_list->begin(), observer_list->end(), func);
 
 						break;
 					}
@@ -111,7 +163,8 @@ bool PhysicalPort::CreateServerSocket(ov::SocketType type,
 
 				// observer들에게 알림
 				auto func = std::bind(&PhysicalPortObserver::OnDataReceived, std::placeholders::_1, std::static_pointer_cast<ov::Socket>(client), std::ref(*(client->GetRemoteAddress().get())), ref(data));
-				for_each(_observer_list.begin(), _observer_list.end(), func);
+				auto observer_list = GetObserverList();
+				for_each(observer_list->begin(), observer_list->end(), func);
 
 				// TCP는 명시적으로 close하기 전까지 계속 사용해야 하므로 false 반환
 				return false;
@@ -127,7 +180,7 @@ bool PhysicalPort::CreateServerSocket(ov::SocketType type,
 		};
 
 		// thread 시작
-		_thread = std::thread(proc);
+		_threads.emplace_back(proc);
 
 		_address = address;
 
@@ -137,32 +190,59 @@ bool PhysicalPort::CreateServerSocket(ov::SocketType type,
 	return false;
 }
 
-bool PhysicalPort::CreateDatagramSocket(ov::SocketType type, const ov::SocketAddress &address)
+bool PhysicalPort::CreateDatagramSocket(ov::SocketType type, const ov::SocketAddress &address, int recv_buffer_size, bool reuse_port, bool io_uring)
 {
 	auto socket = std::make_shared<ov::DatagramSocket>();
 
-	if(socket->Prepare(address))
+	if(socket->Prepare(address, reuse_port))
 	{
 		_type = type;
-		_datagram_socket = socket;
+
+		if((recv_buffer_size > 0) && (socket->SetSockOpt<int>(SO_RCVBUF, recv_buffer_size) == false))
+		{
+			logtw("Could not set the receive buffer of %s to %d bytes", address.ToString().CStr(), recv_buffer_size);
+		}
+
+		if(_datagram_socket == nullptr)
+		{
+			_datagram_socket = socket;
+		}
+
+		_datagram_sockets.push_back(socket);
+
+		int thread_index = static_cast<int>(_threads.size());
+
+		if(reuse_port)
+		{
+			AlignWithCpu(socket, thread_index);
+		}
 
 		_need_to_stop = false;
 
-		auto proc = [&, socket]() -> void
+		auto proc = [&, socket, thread_index, io_uring, address]() -> void
 		{
-			auto data_callback = [&](const std::shared_ptr<ov::DatagramSocket> &socket, const ov::SocketAddress &remote_address, const std::shared_ptr<const ov::Data> &data) -> bool
+			ov::ThreadTopology::Instance()->BindCurrentThread(OV_THREAD_POOL_PORT, thread_index);
+
+			// The buffers of the ring are allocated by the thread (on its NUMA node)
+			if(io_uring && (socket->EnableIoUring() == false))
 			{
-				logtd("Received data %d bytes:\n%s", data->GetLength(), data->Dump().CStr());
+				logtw("Could not use io_uring for %s, epoll is used instead", address.ToString().CStr());
+			}
 
-				// observer들에게 알림
-				auto func = std::bind(&PhysicalPortObserver::OnDataReceived, std::placeholders::_1, socket, remote_address, ref(data));
-				for_each(_observer_list.begin(), _observer_list.end(), func);
+			auto batch_callback = [&](const std::shared_ptr<ov::DatagramSocket> &socket, const std::vector<ov::Datagram> &datagrams) -> void
+			{
+				logtd("Received %zu datagrams", datagrams.size());
 
-				// UDP는 1회용 소켓으로 사용
-				return true;
+				// observer들에게 알림 (the list is taken once per batch)
+				auto observer_list = GetObserverList();
+
+				for(auto observer : *observer_list)
+				{
+					observer->OnDatagramsReceived(socket, datagrams);
+				}
 			};
 
-			while((_need_to_stop == false) && (socket->DispatchEvent(data_callback, 500)))
+			while((_need_to_stop == false) && (socket->DispatchEvent(batch_callback, 500)))
 			{
 			}
 
@@ -172,7 +252,7 @@ bool PhysicalPort::CreateDatagramSocket(ov::SocketType type, const ov::SocketAdd
 		};
 
 		// thread 시작
-		_thread = std::thread(proc);
+		_threads.emplace_back(proc);
 
 		_address = address;
 
@@ -186,41 +266,51 @@ bool PhysicalPort::Close()
 {
 	_need_to_stop = true;
 
-	if(_thread.joinable())
+	for(auto &thread : _threads)
 	{
-		_thread.join();
+		if(thread.joinable())
+		{
+			thread.join();
+		}
 	}
 
-	_thread = std::thread();
+	_threads.clear();
+
+	bool result = true;
 
 	switch(_type)
 	{
+		case ov::SocketType::Srt:
 		case ov::SocketType::Tcp:
-			if(_server_socket != nullptr)
+			for(auto &socket : _server_sockets)
 			{
-				if((_server_socket->GetState() == ov::SocketState::Closed) || (_server_socket->Close()))
-				{
-					_server_socket = nullptr;
-					_observer_list.clear();
-					return true;
-				}
+				result &= ((socket->GetState() == ov::SocketState::Closed) || (socket->Close()));
 			}
+
+			_server_sockets.clear();
+			_server_socket = nullptr;
 			break;
 
 		case ov::SocketType::Udp:
-			if((_datagram_socket->GetState() == ov::SocketState::Closed) || (_datagram_socket->Close()))
+			for(auto &socket : _datagram_sockets)
 			{
-				_datagram_socket = nullptr;
-				_observer_list.clear();
-				return true;
+				result &= ((socket->GetState() == ov::SocketState::Closed) || (socket->Close()));
 			}
+
+			_datagram_sockets.clear();
+			_datagram_socket = nullptr;
 			break;
 
 		default:
-			break;
+			return false;
 	}
 
-	return false;
+	{
+		std::lock_guard<std::mutex> lock(_observer_list_mutex);
+		_observer_list = std::make_shared<std::vector<PhysicalPortObserver *>>();
+	}
+
+	return result;
 }
 
 ov::SocketState PhysicalPort::GetState()
@@ -244,26 +334,180 @@ ov::SocketState PhysicalPort::GetState()
 
 bool PhysicalPort::AddObserver(PhysicalPortObserver *observer)
 {
-	_observer_list.push_back(observer);
+	std::lock_guard<std::mutex> lock(_observer_list_mutex);
+
+	auto observer_list = std::make_shared<std::vector<PhysicalPortObserver *>>(*_observer_list);
+	observer_list->push_back(observer);
+
+	_observer_list = observer_list;
 
 	return true;
 }
 
 bool PhysicalPort::RemoveObserver(PhysicalPortObserver *observer)
 {
-	auto item = std::find(_observer_list.begin(), _observer_list.end(), observer);
+	std::lock_guard<std::mutex> lock(_observer_list_mutex);
+
+	auto item = std::find(_observer_list->begin(), _observer_list->end(), observer);
+
+	if(item == _observer_list->end())
+	{
+		return false;
+	}
+
+	auto observer_list = std::make_shared<std::vector<PhysicalPortObserver *>>(*_observer_list);
+	observer_list->erase(observer_list->begin() + (item - _observer_list->begin()));
+
+	_observer_list = observer_list;
+
+	return true;
+}
+
+bool PhysicalPort::AlignWithCpu(const std::shared_ptr<ov::Socket> &socket, int thread_index)
+{
+	int cpu = ov::ThreadTopology::Instance()->GetCpu(OV_THREAD_POOL_PORT, thread_index);
+
+	if(cpu < 0)
+	{
+		return false;
+	}
+
+	// The kernel selects the socket of the group of SO_REUSEPORT which is bound to the CPU received the packet (RSS queue),
+	// so the packets are processed by the thread on the same CPU
+	if(socket->SetSockOpt(SO_INCOMING_CPU, cpu) == false)
+	{
+		logtw("Could not align the socket #%d with CPU %d", thread_index, cpu);
+		return false;
+	}
+
+	logtd("Socket #%d is aligned with CPU %d", thread_index, cpu);
+
+	return true;
+}
+
+bool PhysicalPort::SetUdpSegmentation(bool enable)
+{
+	if(_type != ov::SocketType::Udp)
+	{
+		return false;
+	}
+
+	bool result = true;
+
+	for(auto &socket : _datagram_sockets)
+	{
+		result &= socket->SetUdpSegmentation(enable);
+	}
+
+	return result;
+}
+
+bool PhysicalPort::SetTxTime(bool enable)
+{
+	if(_type != ov::SocketType::Udp)
+	{
+		return false;
+	}
+
+	bool result = true;
+
+	for(auto &socket : _datagram_sockets)
+	{
+		result &= socket->SetTxTime(enable);
+	}
+
+	return result;
+}
+
+bool PhysicalPort::JoinMulticastGroup(const ov::SocketAddress &group_address, const ov::SocketAddress &interface_address)
+{
+	if(_type != ov::SocketType::Udp)
+	{
+		return false;
+	}
+
+	bool result = true;
+
+	for(auto &socket : _datagram_sockets)
+	{
+		result &= socket->JoinMulticastGroup(group_address, interface_address);
+	}
+
+	return result;
+}
+
+bool PhysicalPort::SetConnectionLimit(const ov::ConnectionLimit &limit)
+{
+	if(_server_sockets.empty())
+	{
+		return false;
+	}
 
-	if(item == _observer_list.end())
+	for(auto &socket : _server_sockets)
+	{
+		socket->SetConnectionLimit(limit);
+	}
+
+	return true;
+}
+
+bool PhysicalPort::SetHandshakeTracking(bool enable)
+{
+	if(_server_sockets.empty())
 	{
 		return false;
 	}
 
-	_observer_list.erase(item);
+	for(auto &socket : _server_sockets)
+	{
+		socket->SetHandshakeTracking(enable);
+	}
 
 	return true;
 }
 
+bool PhysicalPort::SetEdgeTriggered(bool enable)
+{
+	if(_type != ov::SocketType::Tcp)
+	{
+		return false;
+	}
+
+	for(auto &socket : _server_sockets)
+	{
+		socket->SetEdgeTriggered(enable);
+	}
+
+	return true;
+}
+
+bool PhysicalPort::SetSrtSocketOption(SRT_SOCKOPT option, const void *value, int value_length)
+{
+	if(_type != ov::SocketType::Srt)
+	{
+		return false;
+	}
+
+	bool result = true;
+
+	for(auto &socket : _server_sockets)
+	{
+		result &= socket->SetSockOpt(option, value, value_length);
+	}
+
+	return result;
+}
+
 bool PhysicalPort::DisconnectClient(ov::ClientSocket *client_socket)
 {
-	return _server_socket->DisconnectClient(client_socket);
+	// The client belongs to one of the listeners
+	for(auto &socket : _server_sockets)
+	{
+		if(socket->DisconnectClient(client_socket))
+		{
+			return true;
+		}
+	}
+
+	return false;
 }
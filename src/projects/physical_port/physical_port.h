@@ -13,11 +13,17 @@
 #include <memory>
 #include <functional>
 #include <thread>
+#include <mutex>
+#include <vector>
 
 #include <base/ovsocket/ovsocket.h>
 
 // PhysicalPort는 여러 곳에서 공유해서 사용할 수 있음
 // PhysicalPortObserver를 iteration 하면서 callback 할 수 있는 구조 필요
+//
+// worker_count > 1 이면 같은 address에 SO_REUSEPORT 소켓을 worker_count개 열고, 소켓마다 thread를 하나씩 사용함 (TCP/UDP only)
+// - 커널이 4-tuple hash로 소켓을 선택하므로, 하나의 client(UDP remote address/TCP connection)는 항상 같은 thread에서 처리됨
+// - 따라서 observer callback은 여러 thread에서 동시에 호출될 수 있지만, 같은 client에 대해서는 순서가 보장됨
 class PhysicalPort
 {
 public:
@@ -27,7 +33,9 @@ public:
 	bool Create(ov::SocketType type,
                 const ov::SocketAddress &address,
                 int send_buffer_size = 0,
-                int recv_buffer_size = 0);
+                int recv_buffer_size = 0,
+                int worker_count = 1,
+                bool io_uring = false);
 
 	bool Close();
 
@@ -49,24 +57,57 @@ public:
 
 	bool DisconnectClient(ov::ClientSocket *client_socket);
 
+	// Enables UDP GSO on all datagram sockets of the port (see ov::Socket::SendToBatch())
+	// Returns false if the kernel doesn't support it
+	bool SetUdpSegmentation(bool enable);
+	// SO_TXTIME of the UDP sockets (for the paced datagrams)
+	bool SetTxTime(bool enable);
+	// Joins the IPv4 multicast group on all datagram sockets of the port (see ov::Socket::JoinMulticastGroup())
+	bool JoinMulticastGroup(const ov::SocketAddress &group_address, const ov::SocketAddress &interface_address);
+
+	// Limits of the new connections of the listeners (TCP/SRT only)
+	bool SetConnectionLimit(const ov::ConnectionLimit &limit);
+	// The clients are counted as pending handshakes until ClientSocket::CompleteHandshake() is called (TCP/SRT only)
+	bool SetHandshakeTracking(bool enable);
+	// The TCP clients are read until EAGAIN per edge-triggered notification (TCP only)
+	bool SetEdgeTriggered(bool enable);
+
+	// Sets the option of the listening socket (SRT only), the accepted sockets inherit the options
+	bool SetSrtSocketOption(SRT_SOCKOPT option, const void *value, int value_length);
+
 protected:
 	bool CreateServerSocket(ov::SocketType type,
 	                        const ov::SocketAddress &address,
 	                        int send_buffer_size,
-                            int recv_buffer_size);
+                            int recv_buffer_size,
+                            bool reuse_port);
 
-	bool CreateDatagramSocket(ov::SocketType type, const ov::SocketAddress &address);
+	// If io_uring is true, the socket receives the datagrams with io_uring (epoll is used if it is not supported)
+	// recv_buffer_size: SO_RCVBUF (0: the default of the kernel), the bursts of the senders are absorbed by it
+	bool CreateDatagramSocket(ov::SocketType type, const ov::SocketAddress &address, int recv_buffer_size, bool reuse_port, bool io_uring);
+
+	// Returns the snapshot of the observer list (callbacks iterate it without holding the lock)
+	std::shared_ptr<const std::vector<PhysicalPortObserver *>> GetObserverList();
+
+	// Pins the socket to the CPU of the port thread (SO_INCOMING_CPU)
+	bool AlignWithCpu(const std::shared_ptr<ov::Socket> &socket, int thread_index);
 
 	std::shared_ptr<PhysicalPort> _self;
 
 	ov::SocketType _type;
 	ov::SocketAddress _address;
 
+	// The first socket of _server_sockets/_datagram_sockets
 	std::shared_ptr<ov::ServerSocket> _server_socket;
 	std::shared_ptr<ov::DatagramSocket> _datagram_socket;
 
+	std::vector<std::shared_ptr<ov::ServerSocket>> _server_sockets;
+	std::vector<std::shared_ptr<ov::DatagramSocket>> _datagram_sockets;
+
 	volatile bool _need_to_stop;
-	std::thread _thread;
+	std::vector<std::thread> _threads;
 
-	std::vector<PhysicalPortObserver *> _observer_list;
+	// Copy-on-write: AddObserver()/RemoveObserver() replace the list, so the workers don't need to lock while iterating
+	std::mutex _observer_list_mutex;
+	std::shared_ptr<const std::vector<PhysicalPortObserver *>> _observer_list;
 };
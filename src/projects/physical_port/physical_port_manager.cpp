@@ -8,6 +8,8 @@
 //==============================================================================
 #include "physical_port_manager.h"
 
+#include <algorithm>
+
 PhysicalPortManager::PhysicalPortManager()
 {
 }
@@ -19,9 +21,11 @@ PhysicalPortManager::~PhysicalPortManager()
 std::shared_ptr<PhysicalPort> PhysicalPortManager::CreatePort(ov::SocketType type,
                                                               const ov::SocketAddress &address,
                                                               int sned_buffer_size,
-                                                              int recv_buffer_size)
+                                                              int recv_buffer_size,
+                                                              int worker_count)
 {
 	auto key = std::make_pair(type, address);
+	std::lock_guard<std::mutex> lock_guard(_port_list_mutex);
 	auto item = _port_list.find(key);
 	std::shared_ptr<PhysicalPort> port = nullptr;
 
@@ -29,8 +33,18 @@ std::shared_ptr<PhysicalPort> PhysicalPortManager::CreatePort(ov::SocketType typ
 	{
 		port = std::make_shared<PhysicalPort>();
 
-		if(port->Create(type, address, sned_buffer_size, recv_buffer_size))
+		if(port->Create(type, address, sned_buffer_size, recv_buffer_size, (worker_count > 0) ? worker_count : _worker_count, _io_uring_enabled))
 		{
+			if(type != ov::SocketType::Udp)
+			{
+				port->SetConnectionLimit(_connection_limit);
+			}
+
+			if(type == ov::SocketType::Tcp)
+			{
+				port->SetEdgeTriggered(_edge_triggered_enabled);
+			}
+
 			_port_list[key] = port;
 		}
 		else
@@ -46,9 +60,50 @@ std::shared_ptr<PhysicalPort> PhysicalPortManager::CreatePort(ov::SocketType typ
 	return port;
 }
 
+void PhysicalPortManager::SetWorkerCount(int worker_count)
+{
+	_worker_count = std::max(worker_count, 1);
+}
+
+int PhysicalPortManager::GetWorkerCount() const
+{
+	return _worker_count;
+}
+
+void PhysicalPortManager::SetIoUringEnabled(bool enabled)
+{
+	_io_uring_enabled = enabled;
+}
+
+bool PhysicalPortManager::IsIoUringEnabled() const
+{
+	return _io_uring_enabled;
+}
+
+void PhysicalPortManager::SetEdgeTriggeredEnabled(bool enabled)
+{
+	_edge_triggered_enabled = enabled;
+}
+
+bool PhysicalPortManager::IsEdgeTriggeredEnabled() const
+{
+	return _edge_triggered_enabled;
+}
+
+void PhysicalPortManager::SetConnectionLimit(const ov::ConnectionLimit &limit)
+{
+	_connection_limit = limit;
+}
+
+const ov::ConnectionLimit &PhysicalPortManager::GetConnectionLimit() const
+{
+	return _connection_limit;
+}
+
 bool PhysicalPortManager::DeletePort(std::shared_ptr<PhysicalPort> &port)
 {
 	auto key = std::make_pair(port->GetType(), port->GetAddress());
+	std::lock_guard<std::mutex> lock_guard(_port_list_mutex);
 	auto item = _port_list.find(key);
 
 	if(item == _port_list.end())
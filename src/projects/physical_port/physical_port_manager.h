@@ -12,6 +12,7 @@
 #include "physical_port_observer.h"
 
 #include <memory>
+#include <mutex>
 
 class PhysicalPortManager : public ov::Singleton<PhysicalPortManager>
 {
@@ -20,15 +21,40 @@ public:
 
 	virtual ~PhysicalPortManager();
 
+	// worker_count: number of the sockets/threads of the port (0: GetWorkerCount()), used only when the port is created
 	std::shared_ptr<PhysicalPort> CreatePort(ov::SocketType type,
 	                                        const ov::SocketAddress &address,
 	                                        int sned_buffer_size = 0,
-	                                        int recv_buffer_size = 0);
+	                                        int recv_buffer_size = 0,
+	                                        int worker_count = 0);
 
 	bool DeletePort(std::shared_ptr<PhysicalPort> &port);
 
+	// Number of the sockets/threads of the ports created after this call (TCP/UDP only)
+	void SetWorkerCount(int worker_count);
+	int GetWorkerCount() const;
+
+	// The UDP ports created after this call receive the datagrams with io_uring (falls back to epoll if it is not supported)
+	void SetIoUringEnabled(bool enabled);
+	bool IsIoUringEnabled() const;
+
+	// The TCP ports created after this call use the edge-triggered reads (see ov::ServerSocket::SetEdgeTriggered())
+	void SetEdgeTriggeredEnabled(bool enabled);
+	bool IsEdgeTriggeredEnabled() const;
+
+	// Limits of the new connections of the TCP/SRT ports created after this call
+	void SetConnectionLimit(const ov::ConnectionLimit &limit);
+	const ov::ConnectionLimit &GetConnectionLimit() const;
+
 protected:
 	PhysicalPortManager();
 
+	// The applications are started in parallel, so the ports are created/deleted by multiple threads
+	std::mutex _port_list_mutex;
 	std::map<std::pair<ov::SocketType, ov::SocketAddress>, std::shared_ptr<PhysicalPort>> _port_list;
+
+	int _worker_count = 1;
+	bool _io_uring_enabled = false;
+	bool _edge_triggered_enabled = false;
+	ov::ConnectionLimit _connection_limit;
 };
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include <base/ovlibrary/ovlibrary.h>
 #include <base/ovsocket/ovsocket.h>
@@ -44,6 +45,15 @@ public:
 	// 데이터를 수신하였을 때 호출됨
 	virtual void OnDataReceived(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data) = 0;
 
+	// UDP일 때, 한번에 수신된 datagram들을 전달함 (override하지 않으면 OnDataReceived()가 각각 호출됨)
+	virtual void OnDatagramsReceived(const std::shared_ptr<ov::Socket> &remote, const std::vector<ov::Datagram> &datagrams)
+	{
+		for(auto &datagram : datagrams)
+		{
+			OnDataReceived(remote, datagram.remote_address, datagram.data);
+		}
+	}
+
 	// TCP/SRT등 일 때, 상대방과의 접속이 해제되면 호출됨
 	virtual void OnDisconnected(const std::shared_ptr<ov::Socket> &remote, PhysicalPortDisconnectReason reason, const std::shared_ptr<const ov::Error> &error)
 	{
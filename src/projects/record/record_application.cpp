@@ -0,0 +1,109 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "record_application.h"
+#include "record_private.h"
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<RecordApplication> RecordApplication::Create(const info::Application *application_info)
+{
+	auto application = std::make_shared<RecordApplication>(application_info);
+	application->Start();
+	return application;
+}
+
+//====================================================================================================
+// RecordApplication
+//====================================================================================================
+RecordApplication::RecordApplication(const info::Application *application_info)
+	: Application(application_info)
+{
+	auto publisher_info = application_info->GetPublisher<cfg::RecordPublisher>();
+
+	if(publisher_info != nullptr)
+	{
+		_path = publisher_info->GetPath();
+
+		if(ov::PathManager::IsAbsolute(_path.CStr()) == false)
+		{
+			_path = ov::PathManager::GetAppPath(_path);
+		}
+
+		_format = publisher_info->GetFormat();
+		_rollover_duration = publisher_info->GetRolloverDuration();
+
+		_writer = std::make_shared<RecordWriter>(static_cast<size_t>(std::max(publisher_info->GetWriteSize(), 4)) * 1024,
+												 static_cast<size_t>(std::max(publisher_info->GetMaxBufferSize(), 1)) * 1024 * 1024,
+												 static_cast<uint32_t>(std::max(publisher_info->GetFlushInterval(), 0)),
+												 publisher_info->IsDirectIoEnabled());
+
+		SetQueueConfig(publisher_info->GetQueue());
+	}
+}
+
+//====================================================================================================
+// ~RecordApplication
+//====================================================================================================
+RecordApplication::~RecordApplication()
+{
+	Stop();
+	logtd("RecordApplication(%d) has been terminated finally", GetId());
+}
+
+//====================================================================================================
+// Start
+//====================================================================================================
+bool RecordApplication::Start()
+{
+	if((_writer == nullptr) || (_writer->Start() == false))
+	{
+		return false;
+	}
+
+	return Application::Start();
+}
+
+//====================================================================================================
+// Stop
+// - The workers are stopped first, so the files are closed by the writer after the last frames are appended
+//====================================================================================================
+bool RecordApplication::Stop()
+{
+	auto result = Application::Stop();
+
+	if(_writer != nullptr)
+	{
+		_writer->Stop();
+	}
+
+	return result;
+}
+
+//====================================================================================================
+// CreateStream
+//====================================================================================================
+std::shared_ptr<Stream> RecordApplication::CreateStream(std::shared_ptr<StreamInfo> info, uint32_t worker_count)
+{
+	auto directory = ov::PathManager::Combine(ov::PathManager::Combine(_path, GetName()), info->GetName());
+
+	logtd("CreateStream : %s/%u (%s)", info->GetName().CStr(), info->GetId(), directory.CStr());
+
+	return RecordStream::Create(GetSharedPtrAs<Application>(), *info, worker_count, _writer, directory, _format, _rollover_duration);
+}
+
+//====================================================================================================
+// DeleteStream
+// - The files are closed by RecordStream::Stop()
+//====================================================================================================
+bool RecordApplication::DeleteStream(std::shared_ptr<StreamInfo> info)
+{
+	logtd("DeleteStream : %s/%u", info->GetName().CStr(), info->GetId());
+
+	return true;
+}
@@ -0,0 +1,41 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/common_types.h>
+#include <base/publisher/application.h>
+#include <config/config.h>
+#include "record_stream.h"
+
+//====================================================================================================
+// RecordApplication
+// - The streams are recorded to <Path>/<application>/<stream>/ (<Publishers><Record>)
+// - The files of all streams are written by a RecordWriter
+//====================================================================================================
+class RecordApplication : public Application
+{
+public:
+	static std::shared_ptr<RecordApplication> Create(const info::Application *application_info);
+
+	explicit RecordApplication(const info::Application *application_info);
+	~RecordApplication() final;
+
+private:
+	bool Start() override;
+	bool Stop() override;
+
+	// Application Implementation
+	std::shared_ptr<Stream> CreateStream(std::shared_ptr<StreamInfo> info, uint32_t worker_count) override;
+	bool DeleteStream(std::shared_ptr<StreamInfo> info) override;
+
+	ov::String _path;
+	cfg::RecordFormat _format = cfg::RecordFormat::Ts;
+	int _rollover_duration = 0;
+
+	std::shared_ptr<RecordWriter> _writer;
+};
@@ -0,0 +1,455 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "record_muxer.h"
+#include "record_private.h"
+
+#include <base/media_route/media_bitstream.h>
+#include <segment_stream/packetyzer/m4s_fragment_writer.h>
+#include <segment_stream/packetyzer/m4s_init_writer.h>
+
+using namespace common;
+
+namespace
+{
+	// sample flags of trun (sample_depends_on/sample_is_non_sync_sample)
+	const uint32_t mp4_key_frame_flag = 0x02000000;
+	const uint32_t mp4_frame_flag = 0x01010000;
+
+	bool IsAdts(const ov::Data &data)
+	{
+		auto buffer = data.GetDataAs<uint8_t>();
+
+		return (data.GetLength() > ADTS_HEADER_SIZE) && (buffer[0] == 0xFF) && ((buffer[1] & 0xF0) == 0xF0);
+	}
+}
+
+//====================================================================================================
+// RecordMuxer
+//====================================================================================================
+RecordMuxer::RecordMuxer(const ov::String &name, const std::shared_ptr<MediaTrack> &video_track, const std::shared_ptr<MediaTrack> &audio_track)
+	: _name(name),
+	  _video_track(video_track),
+	  _audio_track(audio_track)
+{
+}
+
+void RecordMuxer::SetDropped(bool dropped)
+{
+	if(dropped)
+	{
+		_drop_count++;
+
+		if(_dropped == false)
+		{
+			logtw("[%s] The frames are dropped until the next key frame (the data is not written to the disk fast enough)", _name.CStr());
+			_dropped = true;
+		}
+	}
+	else if(_dropped)
+	{
+		logti("[%s] The frames are recorded again (%" PRIu64 " frames are dropped)", _name.CStr(), _drop_count);
+
+		_dropped = false;
+		_drop_count = 0;
+	}
+}
+
+int64_t RecordMuxer::ConvertTimestamp(int64_t timestamp, common::Timebase &timebase, int64_t timescale)
+{
+	if(timebase.GetDen() == 0)
+	{
+		return timestamp;
+	}
+
+	return timestamp * timebase.GetNum() * timescale / timebase.GetDen();
+}
+
+//====================================================================================================
+// RecordTsMuxer
+//====================================================================================================
+RecordTsMuxer::RecordTsMuxer(const ov::String &name, const std::shared_ptr<MediaTrack> &video_track, const std::shared_ptr<MediaTrack> &audio_track)
+	: RecordMuxer(name, video_track, audio_track)
+{
+}
+
+bool RecordTsMuxer::Open(const std::shared_ptr<RecordWriter> &writer, const ov::String &base_path, int64_t start_time)
+{
+	Close();
+
+	auto codec_type = ((_video_track != nullptr) && (_video_track->GetCodecId() == MediaCodecId::H265)) ? SegmentCodecType::H265Codec : SegmentCodecType::H264Codec;
+
+	_file = writer->CreateFile(ov::String::FormatString("%s.%s", base_path.CStr(), RECORD_TS_FILE_EXTENSION));
+	_ts_writer = std::make_unique<TsWriter>(_video_track != nullptr, _audio_track != nullptr, codec_type);
+
+	// PAT/PMT is written by the constructor
+	_header = *(_ts_writer->GetDataStream());
+	_header_written = false;
+	_ts_writer->ClearDataStream();
+
+	return true;
+}
+
+void RecordTsMuxer::Close()
+{
+	if(_file != nullptr)
+	{
+		_file->Close();
+		_file = nullptr;
+	}
+
+	_ts_writer = nullptr;
+}
+
+void RecordTsMuxer::WriteVideo(EncodedFrame &frame)
+{
+	bool is_keyframe = (frame._frame_type == FrameType::VideoFrameKey);
+
+	if(_waiting_key_frame && (is_keyframe == false))
+	{
+		SetDropped(true);
+		return;
+	}
+
+	_waiting_key_frame = (WriteSample(true, is_keyframe, static_cast<uint64_t>(frame._time_stamp), frame._buffer) == false);
+
+	SetDropped(_waiting_key_frame);
+}
+
+void RecordTsMuxer::WriteAudio(EncodedFrame &frame)
+{
+	auto timestamp = ConvertTimestamp(frame._time_stamp, _audio_track->GetTimeBase(), RECORD_VIDEO_TIMESCALE);
+
+	SetDropped(WriteSample(false, true, static_cast<uint64_t>(timestamp), frame._buffer) == false);
+}
+
+bool RecordTsMuxer::WriteSample(bool is_video, bool is_keyframe, uint64_t timestamp, std::shared_ptr<ov::Data> &data)
+{
+	if((_file == nullptr) || (data == nullptr))
+	{
+		return false;
+	}
+
+	if(_header_written == false)
+	{
+		if(_file->Append(_header) == false)
+		{
+			return false;
+		}
+
+		_header_written = true;
+	}
+
+	_ts_writer->WriteSample(is_video, is_keyframe, timestamp, 0, data);
+
+	bool result = _file->Append(*(_ts_writer->GetDataStream()));
+
+	_ts_writer->ClearDataStream();
+
+	return result;
+}
+
+//====================================================================================================
+// RecordMp4Muxer
+//====================================================================================================
+RecordMp4Muxer::RecordMp4Muxer(const ov::String &name, const std::shared_ptr<MediaTrack> &video_track, const std::shared_ptr<MediaTrack> &audio_track)
+	: RecordMuxer(name, video_track, audio_track)
+{
+	if(_audio_track != nullptr)
+	{
+		_audio_timescale = static_cast<uint32_t>((_audio_track->GetSampleRate() > 0) ? _audio_track->GetSampleRate() : _audio_track->GetTimeBase().GetDen());
+	}
+}
+
+bool RecordMp4Muxer::Open(const std::shared_ptr<RecordWriter> &writer, const ov::String &base_path, int64_t start_time)
+{
+	Close();
+
+	_start_time = start_time;
+
+	if(_video_track != nullptr)
+	{
+		_video_file = writer->CreateFile(ov::String::FormatString("%s%s", base_path.CStr(), RECORD_MP4_VIDEO_FILE_SUFFIX));
+	}
+
+	if((_audio_track != nullptr) && (_audio_timescale > 0))
+	{
+		_audio_file = writer->CreateFile(ov::String::FormatString("%s%s", base_path.CStr(), RECORD_MP4_AUDIO_FILE_SUFFIX));
+	}
+
+	_video_init_written = false;
+	_audio_init_written = false;
+	_video_sequence_number = 0;
+	_audio_sequence_number = 0;
+
+	return true;
+}
+
+void RecordMp4Muxer::Close()
+{
+	if(_video_file != nullptr)
+	{
+		WriteVideoFragment(0);
+
+		_video_file->Close();
+		_video_file = nullptr;
+	}
+
+	if(_audio_file != nullptr)
+	{
+		WriteAudioFragment(0);
+
+		_audio_file->Close();
+		_audio_file = nullptr;
+	}
+
+	_video_samples.clear();
+	_audio_samples.clear();
+}
+
+//====================================================================================================
+// WriteVideo
+// - The GOP is written as a fragment at the next key frame
+// - The parameter sets of the key frame are kept for the init segment
+//====================================================================================================
+void RecordMp4Muxer::WriteVideo(EncodedFrame &frame)
+{
+	if(_video_file == nullptr)
+	{
+		return;
+	}
+
+	int64_t timestamp = frame._time_stamp - (_start_time * RECORD_VIDEO_TIMESCALE / 1000);
+	bool is_keyframe = (frame._frame_type == FrameType::VideoFrameKey);
+
+	if(timestamp < 0)
+	{
+		return;
+	}
+
+	auto codec_id = _video_track->GetCodecId();
+	auto bitstream = (frame._bitstream != nullptr) ? frame._bitstream : std::make_shared<VideoBitstream>(codec_id, frame._buffer);
+
+	if(is_keyframe)
+	{
+		auto buffer = bitstream->GetAnnexB()->GetDataAs<uint8_t>();
+
+		for(const auto &nal_unit : bitstream->GetNalUnits())
+		{
+			std::shared_ptr<std::vector<uint8_t>> *parameter_set = nullptr;
+
+			if(codec_id == MediaCodecId::H265)
+			{
+				// VPS(32), SPS(33), PPS(34)
+				switch((nal_unit.header >> 1) & 0x3F)
+				{
+					case 32:
+						parameter_set = &_vps;
+						break;
+					case 33:
+						parameter_set = &_sps;
+						break;
+					case 34:
+						parameter_set = &_pps;
+						break;
+				}
+			}
+			else
+			{
+				// SPS(7), PPS(8)
+				switch(nal_unit.header & 0x1F)
+				{
+					case 7:
+						parameter_set = &_sps;
+						break;
+					case 8:
+						parameter_set = &_pps;
+						break;
+				}
+			}
+
+			if(parameter_set != nullptr)
+			{
+				*parameter_set = std::make_shared<std::vector<uint8_t>>(buffer + nal_unit.offset, buffer + nal_unit.offset + nal_unit.length);
+			}
+		}
+
+		WriteVideoFragment(static_cast<uint64_t>(timestamp));
+	}
+	else if(_video_samples.empty())
+	{
+		// A fragment starts with a key frame
+		return;
+	}
+
+	_video_samples.push_back({ static_cast<uint64_t>(timestamp), is_keyframe, bitstream->GetAvcc() });
+}
+
+//====================================================================================================
+// WriteAudio
+// - The ADTS header is removed (the config is in the init segment)
+//====================================================================================================
+void RecordMp4Muxer::WriteAudio(EncodedFrame &frame)
+{
+	if((_audio_file == nullptr) || (frame._buffer == nullptr))
+	{
+		return;
+	}
+
+	int64_t timestamp = ConvertTimestamp(frame._time_stamp, _audio_track->GetTimeBase(), _audio_timescale) - (_start_time * _audio_timescale / 1000);
+
+	if(timestamp < 0)
+	{
+		return;
+	}
+
+	auto data = frame._buffer;
+
+	if(IsAdts(*data))
+	{
+		// protection absent ? 7 : 9 (CRC)
+		data = data->Subdata((data->GetDataAs<uint8_t>()[1] & 0x01) ? ADTS_HEADER_SIZE : ADTS_HEADER_SIZE + 2);
+	}
+
+	if((_audio_samples.empty() == false) &&
+	   ((static_cast<uint64_t>(timestamp) - _audio_samples.front().timestamp) * 1000 >= static_cast<uint64_t>(RECORD_MP4_AUDIO_FRAGMENT_DURATION) * _audio_timescale))
+	{
+		WriteAudioFragment(static_cast<uint64_t>(timestamp));
+	}
+
+	_audio_samples.push_back({ static_cast<uint64_t>(timestamp), true, data });
+}
+
+void RecordMp4Muxer::WriteVideoFragment(uint64_t end_timestamp)
+{
+	if(_video_samples.empty())
+	{
+		return;
+	}
+
+	if((_video_init_written == false) && ((_video_init_written = WriteVideoInit()) == false))
+	{
+		_video_samples.clear();
+		SetDropped(true);
+		return;
+	}
+
+	SetDropped(WriteFragment(_video_file, true, ++_video_sequence_number, _video_samples, end_timestamp) == false);
+}
+
+void RecordMp4Muxer::WriteAudioFragment(uint64_t end_timestamp)
+{
+	if(_audio_samples.empty())
+	{
+		return;
+	}
+
+	if((_audio_init_written == false) && ((_audio_init_written = WriteAudioInit()) == false))
+	{
+		_audio_samples.clear();
+		SetDropped(true);
+		return;
+	}
+
+	SetDropped(WriteFragment(_audio_file, false, ++_audio_sequence_number, _audio_samples, end_timestamp) == false);
+}
+
+//====================================================================================================
+// WriteFragment
+// - moof + mdat, the duration of a sample is the difference of the timestamps
+//====================================================================================================
+bool RecordMp4Muxer::WriteFragment(const std::shared_ptr<RecordFile> &file, bool is_video, uint32_t sequence_number,
+								   std::deque<Mp4Sample> &samples, uint64_t end_timestamp)
+{
+	uint64_t &last_duration = is_video ? _last_video_duration : _last_audio_duration;
+	std::vector<std::shared_ptr<FragmentSampleData>> sample_datas;
+	size_t data_size = 0;
+
+	sample_datas.reserve(samples.size());
+
+	for(size_t index = 0; index < samples.size(); index++)
+	{
+		auto &sample = samples[index];
+		uint64_t next_timestamp = (index + 1 < samples.size()) ? samples[index + 1].timestamp : end_timestamp;
+
+		if(next_timestamp > sample.timestamp)
+		{
+			last_duration = next_timestamp - sample.timestamp;
+		}
+
+		uint32_t flag = is_video ? (sample.is_keyframe ? mp4_key_frame_flag : mp4_frame_flag) : 0;
+
+		sample_datas.push_back(std::make_shared<FragmentSampleData>(last_duration, flag, 0, ov::DataView(sample.data), is_video));
+		data_size += sample.data->GetLength();
+	}
+
+	auto writer = std::make_unique<M4sFragmentWriter>(is_video ? M4sMediaType::VideoMediaType : M4sMediaType::AudioMediaType,
+													  static_cast<uint32_t>(data_size + MP4_FRAGMENT_HEADER_RESERVE_SIZE + sample_datas.size() * 16),
+													  sequence_number,
+													  is_video ? RECORD_MP4_VIDEO_TRACK_ID : RECORD_MP4_AUDIO_TRACK_ID,
+													  samples.front().timestamp,
+													  sample_datas);
+
+	samples.clear();
+
+	writer->CreateData();
+
+	return file->Append(*(writer->GetDataStream()));
+}
+
+bool RecordMp4Muxer::WriteVideoInit()
+{
+	if((_sps == nullptr) || (_pps == nullptr) || ((_video_track->GetCodecId() == MediaCodecId::H265) && (_vps == nullptr)))
+	{
+		logtw("[%s] There is no parameter set in the key frame, the fragment is dropped", _name.CStr());
+		return false;
+	}
+
+	auto writer = std::make_unique<M4sInitWriter>(M4sMediaType::VideoMediaType,
+												  1024,
+												  0,
+												  RECORD_VIDEO_TIMESCALE,
+												  RECORD_MP4_VIDEO_TRACK_ID,
+												  _video_track->GetWidth(),
+												  _video_track->GetHeight(),
+												  _sps,
+												  _pps,
+												  0,
+												  0,
+												  0);
+
+	if(_video_track->GetCodecId() == MediaCodecId::H265)
+	{
+		writer->SetHevcParameterSets(_vps, _sps, _pps);
+	}
+
+	writer->CreateData();
+
+	return _video_file->Append(*(writer->GetDataStream()));
+}
+
+bool RecordMp4Muxer::WriteAudioInit()
+{
+	std::shared_ptr<std::vector<uint8_t>> empty = nullptr;
+
+	auto writer = std::make_unique<M4sInitWriter>(M4sMediaType::AudioMediaType,
+												  1024,
+												  0,
+												  _audio_timescale,
+												  RECORD_MP4_AUDIO_TRACK_ID,
+												  0,
+												  0,
+												  empty,
+												  empty,
+												  static_cast<uint16_t>(_audio_track->GetChannel().GetCounts()),
+												  16,
+												  static_cast<uint16_t>(_audio_timescale));
+
+	writer->CreateData();
+
+	return _audio_file->Append(*(writer->GetDataStream()));
+}
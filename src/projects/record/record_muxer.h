@@ -0,0 +1,166 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/application/media_track.h>
+#include <base/common_types.h>
+#include <segment_stream/packetyzer/ts_writer.h>
+
+#include "record_writer.h"
+
+// Timescale of the video frames (see MediaRouteApplication) and the TS
+#define RECORD_VIDEO_TIMESCALE					(90000)
+
+// Track ID of the fMP4 files (same as DASH)
+#define RECORD_MP4_VIDEO_TRACK_ID				(1)
+#define RECORD_MP4_AUDIO_TRACK_ID				(2)
+
+// Duration of an audio fragment (milliseconds), the video is fragmented by the key frames
+#define RECORD_MP4_AUDIO_FRAGMENT_DURATION		(2000)
+
+#define RECORD_TS_FILE_EXTENSION				"ts"
+#define RECORD_MP4_VIDEO_FILE_SUFFIX			"_video.mp4"
+#define RECORD_MP4_AUDIO_FILE_SUFFIX			"_audio.mp4"
+
+//====================================================================================================
+// RecordMuxer
+// - Makes the files of a recording (a rollover) of a stream, the data is appended to RecordFile
+//   (memory only), so it never waits for the disk
+// - If the data is not appended (the buffer of the writer is full), the frames are dropped until the next key frame
+// - The video frames are H.264/H.265 (Annex-B, 90kHz), the audio frames are AAC (ADTS)
+//====================================================================================================
+class RecordMuxer
+{
+public:
+	RecordMuxer(const ov::String &name, const std::shared_ptr<MediaTrack> &video_track, const std::shared_ptr<MediaTrack> &audio_track);
+	virtual ~RecordMuxer() = default;
+
+	// base_path: path of the files without the extension
+	// start_time: timestamp of the first frame (milliseconds), the frames before it are not written
+	virtual bool Open(const std::shared_ptr<RecordWriter> &writer, const ov::String &base_path, int64_t start_time) = 0;
+	// The rest of the frames are written, and the files are closed
+	virtual void Close() = 0;
+
+	virtual void WriteVideo(EncodedFrame &frame) = 0;
+	virtual void WriteAudio(EncodedFrame &frame) = 0;
+
+	// Could not write the files (e.g. no space), they are closed by Close()
+	virtual bool IsFailed() const = 0;
+
+protected:
+	// Logs the drop once until the frames are written again
+	void SetDropped(bool dropped);
+
+	// timestamp * timebase -> timescale
+	static int64_t ConvertTimestamp(int64_t timestamp, common::Timebase &timebase, int64_t timescale);
+
+	ov::String _name;
+	std::shared_ptr<MediaTrack> _video_track;
+	std::shared_ptr<MediaTrack> _audio_track;
+
+	bool _dropped = false;
+	uint64_t _drop_count = 0;
+};
+
+//====================================================================================================
+// RecordTsMuxer
+// - A file (<base_path>.ts) contains all tracks, the timestamps of the stream are kept (same as HLS)
+//====================================================================================================
+class RecordTsMuxer : public RecordMuxer
+{
+public:
+	RecordTsMuxer(const ov::String &name, const std::shared_ptr<MediaTrack> &video_track, const std::shared_ptr<MediaTrack> &audio_track);
+
+	bool Open(const std::shared_ptr<RecordWriter> &writer, const ov::String &base_path, int64_t start_time) override;
+	void Close() override;
+
+	void WriteVideo(EncodedFrame &frame) override;
+	void WriteAudio(EncodedFrame &frame) override;
+
+	bool IsFailed() const override
+	{
+		return (_file != nullptr) && _file->IsFailed();
+	}
+
+protected:
+	// The packets of the sample are appended to the file
+	bool WriteSample(bool is_video, bool is_keyframe, uint64_t timestamp, std::shared_ptr<ov::Data> &data);
+
+	std::shared_ptr<RecordFile> _file;
+	std::unique_ptr<TsWriter> _ts_writer;
+
+	// PAT/PMT, which is written with the first sample
+	std::vector<uint8_t> _header;
+	bool _header_written = false;
+
+	bool _waiting_key_frame = false;
+};
+
+//====================================================================================================
+// RecordMp4Muxer
+// - A fragmented MP4 file per track (<base_path>_video.mp4, <base_path>_audio.mp4): init segment + fragments
+// - A fragment is a GOP of the video, the timestamps start from 0 at the start of the file
+//====================================================================================================
+class RecordMp4Muxer : public RecordMuxer
+{
+public:
+	RecordMp4Muxer(const ov::String &name, const std::shared_ptr<MediaTrack> &video_track, const std::shared_ptr<MediaTrack> &audio_track);
+
+	bool Open(const std::shared_ptr<RecordWriter> &writer, const ov::String &base_path, int64_t start_time) override;
+	void Close() override;
+
+	void WriteVideo(EncodedFrame &frame) override;
+	void WriteAudio(EncodedFrame &frame) override;
+
+	bool IsFailed() const override
+	{
+		return ((_video_file != nullptr) && _video_file->IsFailed()) || ((_audio_file != nullptr) && _audio_file->IsFailed());
+	}
+
+protected:
+	struct Mp4Sample
+	{
+		uint64_t timestamp;
+		bool is_keyframe;
+		std::shared_ptr<ov::Data> data;
+	};
+
+	// All of the samples are written, end_timestamp is the end of the last sample (0: the duration of the previous sample is used)
+	void WriteVideoFragment(uint64_t end_timestamp);
+	void WriteAudioFragment(uint64_t end_timestamp);
+	bool WriteFragment(const std::shared_ptr<RecordFile> &file, bool is_video, uint32_t sequence_number,
+					   std::deque<Mp4Sample> &samples, uint64_t end_timestamp);
+
+	bool WriteVideoInit();
+	bool WriteAudioInit();
+
+	std::shared_ptr<RecordFile> _video_file;
+	std::shared_ptr<RecordFile> _audio_file;
+
+	// milliseconds
+	int64_t _start_time = 0;
+	uint32_t _audio_timescale = 0;
+
+	// NAL units of the last key frame (including the NAL header)
+	std::shared_ptr<std::vector<uint8_t>> _vps;
+	std::shared_ptr<std::vector<uint8_t>> _sps;
+	std::shared_ptr<std::vector<uint8_t>> _pps;
+
+	bool _video_init_written = false;
+	bool _audio_init_written = false;
+
+	std::deque<Mp4Sample> _video_samples;
+	std::deque<Mp4Sample> _audio_samples;
+
+	uint32_t _video_sequence_number = 0;
+	uint32_t _audio_sequence_number = 0;
+
+	// Duration of the last sample, which is used for the last sample of the file
+	uint64_t _last_video_duration = RECORD_VIDEO_TIMESCALE / 30;
+	uint64_t _last_audio_duration = 1024;
+};
@@ -0,0 +1,79 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "record_publisher.h"
+#include "record_private.h"
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<RecordPublisher> RecordPublisher::Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+{
+	auto publisher = std::make_shared<RecordPublisher>(application_info, router);
+
+	if(publisher->Start() == false)
+	{
+		return nullptr;
+	}
+
+	return publisher;
+}
+
+//====================================================================================================
+// RecordPublisher
+//====================================================================================================
+RecordPublisher::RecordPublisher(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+	: Publisher(application_info, std::move(router))
+{
+}
+
+//====================================================================================================
+// ~RecordPublisher
+//====================================================================================================
+RecordPublisher::~RecordPublisher()
+{
+	logtd("RecordPublisher has been terminated finally");
+}
+
+//====================================================================================================
+// Start
+//====================================================================================================
+bool RecordPublisher::Start()
+{
+	auto publisher_info = _application_info->GetPublisher<cfg::RecordPublisher>();
+
+	if((publisher_info == nullptr) || (publisher_info->IsParsed() == false))
+	{
+		logte("Invalid record publisher configuration");
+		return false;
+	}
+
+	if(publisher_info->GetPath().IsEmpty())
+	{
+		logte("There is no path to record %s", _application_info->GetName().CStr());
+		return false;
+	}
+
+	return Publisher::Start();
+}
+
+//====================================================================================================
+// OnCreateApplication
+//====================================================================================================
+std::shared_ptr<Application> RecordPublisher::OnCreateApplication(const info::Application *application_info)
+{
+	return RecordApplication::Create(application_info);
+}
+
+//====================================================================================================
+// monitoring data pure virtual function
+// - The recorded streams are not counted as the connections
+//====================================================================================================
+bool RecordPublisher::GetMonitoringCollectionData(std::vector<std::shared_ptr<MonitoringCollectionData>> &collections)
+{
+	return true;
+}
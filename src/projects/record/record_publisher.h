@@ -0,0 +1,40 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/common_types.h>
+#include <base/publisher/publisher.h>
+#include "record_application.h"
+
+//====================================================================================================
+// RecordPublisher
+// - Records the streams to the files (<Publishers><Record>)
+// - The router is not blocked by the disk: the frames are queued to the workers of the application
+//   (<Queue>), and the files are written by a thread (see RecordWriter)
+//====================================================================================================
+class RecordPublisher : public Publisher
+{
+public:
+	static std::shared_ptr<RecordPublisher> Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+
+	RecordPublisher(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+	~RecordPublisher() override;
+
+	bool GetMonitoringCollectionData(std::vector<std::shared_ptr<MonitoringCollectionData>> &collections) override;
+
+private:
+	bool Start() override;
+
+	// Publisher Implementation
+	cfg::PublisherType GetPublisherType() override
+	{
+		return cfg::PublisherType::Record;
+	}
+
+	std::shared_ptr<Application> OnCreateApplication(const info::Application *application_info) override;
+};
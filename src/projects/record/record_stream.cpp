@@ -0,0 +1,251 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "record_stream.h"
+#include "record_private.h"
+
+#include <base/publisher/application.h>
+
+#include <time.h>
+
+using namespace common;
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<RecordStream> RecordStream::Create(const std::shared_ptr<Application> application,
+												   const StreamInfo &info,
+												   uint32_t worker_count,
+												   const std::shared_ptr<RecordWriter> &writer,
+												   const ov::String &directory,
+												   cfg::RecordFormat format,
+												   int rollover_duration)
+{
+	auto stream = std::make_shared<RecordStream>(application, info, writer, directory, format, rollover_duration);
+
+	if(stream->Start(worker_count) == false)
+	{
+		return nullptr;
+	}
+
+	return stream;
+}
+
+//====================================================================================================
+// RecordStream
+//====================================================================================================
+RecordStream::RecordStream(const std::shared_ptr<Application> application,
+						   const StreamInfo &info,
+						   const std::shared_ptr<RecordWriter> &writer,
+						   const ov::String &directory,
+						   cfg::RecordFormat format,
+						   int rollover_duration)
+	: Stream(application, info),
+	  _writer(writer),
+	  _directory(directory),
+	  _format(format),
+	  _rollover_duration(static_cast<int64_t>(std::max(rollover_duration, 0)) * 1000)
+{
+}
+
+//====================================================================================================
+// ~RecordStream
+//====================================================================================================
+RecordStream::~RecordStream()
+{
+	logtd("RecordStream(%u) has been terminated finally", GetId());
+	Stop();
+}
+
+//====================================================================================================
+// Start
+// - Only the first H264/H265/AAC tracks are recorded
+//====================================================================================================
+bool RecordStream::Start(uint32_t worker_count)
+{
+	for(auto &track_item : _tracks)
+	{
+		auto &track = track_item.second;
+
+		if((track->GetMediaType() == MediaType::Video) &&
+		   ((track->GetCodecId() == MediaCodecId::H264) || (track->GetCodecId() == MediaCodecId::H265)) &&
+		   (_video_track == nullptr))
+		{
+			_video_track = track;
+		}
+		else if((track->GetMediaType() == MediaType::Audio) && (track->GetCodecId() == MediaCodecId::Aac) && (_audio_track == nullptr))
+		{
+			_audio_track = track;
+		}
+		else
+		{
+			logtw("[%s/%s] Track %d is not recorded (only the first H264/H265/AAC tracks are supported)",
+				  GetApplication()->GetName().CStr(), GetName().CStr(), track->GetId());
+		}
+	}
+
+	// There is no session, the frames are recorded by the worker of the application
+	if(Stream::Start(1) == false)
+	{
+		return false;
+	}
+
+	if((_video_track == nullptr) && (_audio_track == nullptr))
+	{
+		logtw("[%s/%s] There is no H264/H265/AAC track to record", GetApplication()->GetName().CStr(), GetName().CStr());
+		return true;
+	}
+
+	auto name = ov::String::FormatString("%s/%s", GetApplication()->GetName().CStr(), GetName().CStr());
+
+	std::lock_guard<std::mutex> lock_guard(_muxer_mutex);
+
+	if(_format == cfg::RecordFormat::Fmp4)
+	{
+		_muxer = std::make_unique<RecordMp4Muxer>(name, _video_track, _audio_track);
+	}
+	else
+	{
+		_muxer = std::make_unique<RecordTsMuxer>(name, _video_track, _audio_track);
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// Stop
+// - The rest of the frames are written by the writer
+//====================================================================================================
+bool RecordStream::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock_guard(_muxer_mutex);
+
+		if(_muxer != nullptr)
+		{
+			_muxer->Close();
+			_muxer = nullptr;
+		}
+
+		_file_opened = false;
+	}
+
+	return Stream::Stop();
+}
+
+//====================================================================================================
+// PrepareFile
+// - _muxer_mutex must be locked
+//====================================================================================================
+void RecordStream::PrepareFile(int64_t time)
+{
+	if(_file_opened)
+	{
+		if(_muxer->IsFailed())
+		{
+			logtw("[%s/%s] Could not record the stream, it is retried after %d seconds",
+				  GetApplication()->GetName().CStr(), GetName().CStr(), RECORD_RETRY_INTERVAL / 1000);
+
+			_retry_time = time + RECORD_RETRY_INTERVAL;
+		}
+		else if((_rollover_duration == 0) || ((time - _file_start_time) < _rollover_duration))
+		{
+			return;
+		}
+
+		_muxer->Close();
+		_file_opened = false;
+	}
+
+	if(time < _retry_time)
+	{
+		return;
+	}
+
+	// Local time of the start of the file
+	char time_buffer[32];
+	time_t now = ::time(nullptr);
+	struct tm now_tm {};
+
+	::localtime_r(&now, &now_tm);
+	::strftime(time_buffer, sizeof(time_buffer), "%Y%m%d-%H%M%S", &now_tm);
+
+	auto base_path = ov::PathManager::Combine(_directory, ov::String::FormatString("%s_%s", GetName().CStr(), time_buffer));
+
+	_file_opened = _muxer->Open(_writer, base_path, time);
+	_file_start_time = time;
+}
+
+//====================================================================================================
+// SendVideoFrame
+//====================================================================================================
+void RecordStream::SendVideoFrame(std::shared_ptr<MediaTrack> track,
+								  std::unique_ptr<EncodedFrameDescriptor> frame)
+{
+	if((_video_track == nullptr) || (track->GetId() != _video_track->GetId()))
+	{
+		return;
+	}
+
+	auto encoded_frame = &(frame->encoded_frame);
+
+	std::lock_guard<std::mutex> lock_guard(_muxer_mutex);
+
+	if(_muxer == nullptr)
+	{
+		return;
+	}
+
+	if(encoded_frame->_frame_type == FrameType::VideoFrameKey)
+	{
+		// The timestamp of the video frames is 90kHz
+		PrepareFile(encoded_frame->_time_stamp * 1000 / RECORD_VIDEO_TIMESCALE);
+	}
+
+	if(_file_opened)
+	{
+		_muxer->WriteVideo(*encoded_frame);
+	}
+}
+
+//====================================================================================================
+// SendAudioFrame
+//====================================================================================================
+void RecordStream::SendAudioFrame(std::shared_ptr<MediaTrack> track,
+								  std::unique_ptr<EncodedFrameDescriptor> frame)
+{
+	if((_audio_track == nullptr) || (track->GetId() != _audio_track->GetId()))
+	{
+		return;
+	}
+
+	auto encoded_frame = &(frame->encoded_frame);
+
+	std::lock_guard<std::mutex> lock_guard(_muxer_mutex);
+
+	if(_muxer == nullptr)
+	{
+		return;
+	}
+
+	if(_video_track == nullptr)
+	{
+		auto &timebase = track->GetTimeBase();
+
+		if(timebase.GetDen() == 0)
+		{
+			return;
+		}
+
+		PrepareFile(encoded_frame->_time_stamp * 1000 * timebase.GetNum() / timebase.GetDen());
+	}
+
+	if(_file_opened)
+	{
+		_muxer->WriteAudio(*encoded_frame);
+	}
+}
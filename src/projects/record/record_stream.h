@@ -0,0 +1,74 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/common_types.h>
+#include <base/publisher/stream.h>
+#include <config/config.h>
+
+#include "record_muxer.h"
+
+// A failed file (e.g. no space) is not retried until the interval (milliseconds)
+#define RECORD_RETRY_INTERVAL			(10 * 1000)
+
+//====================================================================================================
+// RecordStream
+// - Records the first H.264/H.265 and AAC tracks to <directory>/<stream>_<yyyyMMdd-HHmmss>.<ext>
+// - A file starts at a key frame (or any frame of the audio only stream), and a new file is started at
+//   the key frame after the rollover duration
+// - The frames are muxed by the worker of the application, the files are written by RecordWriter
+//====================================================================================================
+class RecordStream : public Stream
+{
+public:
+	static std::shared_ptr<RecordStream> Create(const std::shared_ptr<Application> application,
+												const StreamInfo &info,
+												uint32_t worker_count,
+												const std::shared_ptr<RecordWriter> &writer,
+												const ov::String &directory,
+												cfg::RecordFormat format,
+												int rollover_duration);
+
+	RecordStream(const std::shared_ptr<Application> application,
+				 const StreamInfo &info,
+				 const std::shared_ptr<RecordWriter> &writer,
+				 const ov::String &directory,
+				 cfg::RecordFormat format,
+				 int rollover_duration);
+	~RecordStream() final;
+
+	void SendVideoFrame(std::shared_ptr<MediaTrack> track,
+						std::unique_ptr<EncodedFrameDescriptor> frame) override;
+
+	void SendAudioFrame(std::shared_ptr<MediaTrack> track,
+						std::unique_ptr<EncodedFrameDescriptor> frame) override;
+
+private:
+	bool Start(uint32_t worker_count) override;
+	bool Stop() override;
+
+	// Closes the file if it is failed or the rollover duration is elapsed, and opens a new file
+	// - time: timestamp of the frame (milliseconds)
+	void PrepareFile(int64_t time);
+
+	std::shared_ptr<RecordWriter> _writer;
+	ov::String _directory;
+	cfg::RecordFormat _format;
+	int64_t _rollover_duration;
+
+	std::shared_ptr<MediaTrack> _video_track;
+	std::shared_ptr<MediaTrack> _audio_track;
+
+	std::mutex _muxer_mutex;
+	std::unique_ptr<RecordMuxer> _muxer;
+
+	bool _file_opened = false;
+	// milliseconds
+	int64_t _file_start_time = 0;
+	int64_t _retry_time = INT64_MIN;
+};
@@ -0,0 +1,552 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "record_writer.h"
+#include "record_private.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+// Wait of the thread if there is no notification (milliseconds)
+#define RECORD_WRITER_MAX_WAIT_TIME			(1000)
+
+//====================================================================================================
+// RecordBlock
+//====================================================================================================
+RecordBlock::RecordBlock(size_t capacity)
+{
+	void *buffer = nullptr;
+
+	if(::posix_memalign(&buffer, RECORD_WRITER_ALIGNMENT, capacity) == 0)
+	{
+		data = static_cast<uint8_t *>(buffer);
+		this->capacity = capacity;
+	}
+}
+
+RecordBlock::~RecordBlock()
+{
+	::free(data);
+}
+
+//====================================================================================================
+// RecordFile
+//====================================================================================================
+RecordFile::RecordFile(const std::shared_ptr<RecordWriter> &writer, const ov::String &path)
+	: _writer(writer),
+	  _path(path)
+{
+}
+
+RecordFile::~RecordFile()
+{
+	if(_fd >= 0)
+	{
+		::close(_fd);
+	}
+
+	for(auto &block : _blocks)
+	{
+		_writer->ReleaseBlock(std::move(block));
+	}
+
+	if(_current_block != nullptr)
+	{
+		_writer->ReleaseBlock(std::move(_current_block));
+	}
+}
+
+//====================================================================================================
+// Append
+// - The blocks are allocated before the data is copied, so the data is appended entirely or not at all
+//====================================================================================================
+bool RecordFile::Append(const void *data, size_t length)
+{
+	if(length == 0)
+	{
+		return true;
+	}
+
+	bool filled = false;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		if(_closed || _failed)
+		{
+			return false;
+		}
+
+		size_t remained = (_current_block != nullptr) ? _current_block->GetRemained() : 0;
+		std::vector<std::unique_ptr<RecordBlock>> new_blocks;
+
+		if(length > remained)
+		{
+			auto block_size = _writer->GetBlockSize();
+
+			if(_writer->AllocateBlocks((length - remained + block_size - 1) / block_size, new_blocks) == false)
+			{
+				return false;
+			}
+		}
+
+		auto source = static_cast<const uint8_t *>(data);
+		size_t rest = length;
+		auto new_block = new_blocks.begin();
+
+		while(rest > 0)
+		{
+			if((_current_block == nullptr) || (_current_block->GetRemained() == 0))
+			{
+				if(_current_block != nullptr)
+				{
+					_blocks.push_back(std::move(_current_block));
+					filled = true;
+				}
+
+				_current_block = std::move(*new_block);
+				++new_block;
+			}
+
+			size_t copy_size = std::min(rest, _current_block->GetRemained());
+
+			::memcpy(_current_block->data + _current_block->size, source, copy_size);
+			_current_block->size += copy_size;
+
+			source += copy_size;
+			rest -= copy_size;
+		}
+
+		if(_current_block->GetRemained() == 0)
+		{
+			_blocks.push_back(std::move(_current_block));
+			filled = true;
+		}
+
+		_size += length;
+	}
+
+	if(filled)
+	{
+		_writer->Notify();
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// Close
+//====================================================================================================
+void RecordFile::Close()
+{
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		if(_closed)
+		{
+			return;
+		}
+
+		_closed = true;
+	}
+
+	_writer->Notify();
+}
+
+//====================================================================================================
+// RecordWriter
+// - The block size is aligned for O_DIRECT
+//====================================================================================================
+RecordWriter::RecordWriter(size_t block_size, size_t max_buffer_size, uint32_t flush_interval, bool direct_io)
+	: _block_size(std::max<size_t>((block_size + RECORD_WRITER_ALIGNMENT - 1) / RECORD_WRITER_ALIGNMENT, 1) * RECORD_WRITER_ALIGNMENT),
+	  _flush_interval(flush_interval),
+	  _direct_io(direct_io)
+{
+	// A block is being filled and another is being written at least
+	_max_block_count = std::max<size_t>(max_buffer_size / _block_size, 2);
+}
+
+RecordWriter::~RecordWriter()
+{
+	Stop();
+}
+
+//====================================================================================================
+// Start
+//====================================================================================================
+bool RecordWriter::Start()
+{
+	if(_stop_thread_flag == false)
+	{
+		return true;
+	}
+
+	_stop_thread_flag = false;
+
+	try
+	{
+		_thread = std::thread(&RecordWriter::WriterThread, this);
+		::pthread_setname_np(_thread.native_handle(), "RecordWriter");
+	}
+	catch(const std::system_error &error)
+	{
+		logte("Could not create the thread of the writer: %s", error.what());
+		_stop_thread_flag = true;
+		return false;
+	}
+
+	logtd("RecordWriter is started (block: %zu bytes, buffer: %zu blocks, direct io: %s)",
+	      _block_size, _max_block_count, _direct_io ? "true" : "false");
+
+	return true;
+}
+
+//====================================================================================================
+// Stop
+//====================================================================================================
+void RecordWriter::Stop()
+{
+	if(_stop_thread_flag.exchange(true))
+	{
+		return;
+	}
+
+	Notify();
+
+	if(_thread.joinable())
+	{
+		_thread.join();
+	}
+}
+
+//====================================================================================================
+// CreateFile
+//====================================================================================================
+std::shared_ptr<RecordFile> RecordWriter::CreateFile(const ov::String &path)
+{
+	auto file = std::make_shared<RecordFile>(GetSharedPtr(), path);
+
+	std::lock_guard<std::mutex> lock_guard(_file_mutex);
+
+	if(_stop_thread_flag)
+	{
+		file->_closed = true;
+		file->_failed = true;
+		return file;
+	}
+
+	file->_last_flush_time = std::chrono::steady_clock::now();
+	_files.push_back(file);
+
+	return file;
+}
+
+//====================================================================================================
+// AllocateBlocks
+//====================================================================================================
+bool RecordWriter::AllocateBlocks(size_t count, std::vector<std::unique_ptr<RecordBlock>> &blocks)
+{
+	std::lock_guard<std::mutex> lock_guard(_block_mutex);
+
+	if(count > (_free_blocks.size() + _max_block_count - _allocated_block_count))
+	{
+		return false;
+	}
+
+	while((blocks.size() < count) && (_free_blocks.empty() == false))
+	{
+		blocks.push_back(std::move(_free_blocks.back()));
+		_free_blocks.pop_back();
+	}
+
+	while(blocks.size() < count)
+	{
+		auto block = std::make_unique<RecordBlock>(_block_size);
+
+		if(block->data == nullptr)
+		{
+			// Return the blocks, so nothing is allocated
+			for(auto &free_block : blocks)
+			{
+				_free_blocks.push_back(std::move(free_block));
+			}
+
+			blocks.clear();
+			return false;
+		}
+
+		blocks.push_back(std::move(block));
+		_allocated_block_count++;
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// ReleaseBlock
+// - A quarter of the blocks are kept for the reuse, so the memory is not kept after a stall of the disk
+//====================================================================================================
+void RecordWriter::ReleaseBlock(std::unique_ptr<RecordBlock> block)
+{
+	if(block == nullptr)
+	{
+		return;
+	}
+
+	block->size = 0;
+
+	std::lock_guard<std::mutex> lock_guard(_block_mutex);
+
+	if(_free_blocks.size() < std::max<size_t>(_max_block_count / 4, 1))
+	{
+		_free_blocks.push_back(std::move(block));
+		return;
+	}
+
+	block = nullptr;
+	_allocated_block_count--;
+}
+
+//====================================================================================================
+// Notify
+//====================================================================================================
+void RecordWriter::Notify()
+{
+	{
+		std::lock_guard<std::mutex> lock_guard(_notify_mutex);
+		_notified = true;
+	}
+
+	_notify_condition.notify_one();
+}
+
+//====================================================================================================
+// WriterThread
+// - The files are written until they are closed even if the writer is stopped
+//====================================================================================================
+void RecordWriter::WriterThread()
+{
+	auto wait_time = std::chrono::milliseconds(((_direct_io == false) && (_flush_interval > 0)) ? std::min<uint32_t>(_flush_interval, RECORD_WRITER_MAX_WAIT_TIME) : RECORD_WRITER_MAX_WAIT_TIME);
+
+	while(true)
+	{
+		bool stopping = _stop_thread_flag;
+
+		if(stopping == false)
+		{
+			std::unique_lock<std::mutex> lock(_notify_mutex);
+
+			_notify_condition.wait_for(lock, wait_time, [this]() -> bool {
+				return _notified;
+			});
+
+			_notified = false;
+		}
+
+		std::vector<std::shared_ptr<RecordFile>> files;
+
+		{
+			std::lock_guard<std::mutex> lock_guard(_file_mutex);
+
+			if(stopping)
+			{
+				// No more data is appended
+				for(auto &file : _files)
+				{
+					std::lock_guard<std::mutex> file_lock_guard(file->_mutex);
+					file->_closed = true;
+				}
+			}
+
+			files = _files;
+		}
+
+		std::vector<std::shared_ptr<RecordFile>> closed_files;
+
+		for(auto &file : files)
+		{
+			if(FlushFile(file) == false)
+			{
+				closed_files.push_back(file);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock_guard(_file_mutex);
+
+		for(auto &file : closed_files)
+		{
+			_files.erase(std::remove(_files.begin(), _files.end(), file), _files.end());
+		}
+
+		if(stopping)
+		{
+			// The files are closed by FlushFile(), it breaks the references between the writer and the files
+			_files.clear();
+			break;
+		}
+	}
+}
+
+//====================================================================================================
+// FlushFile
+// - The filled blocks are written
+// - The block which is being filled is written if the file is closed, or after the flush interval (without O_DIRECT)
+//====================================================================================================
+bool RecordWriter::FlushFile(const std::shared_ptr<RecordFile> &file)
+{
+	auto now = std::chrono::steady_clock::now();
+	std::deque<std::unique_ptr<RecordBlock>> blocks;
+	bool closed = false;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(file->_mutex);
+
+		closed = file->_closed;
+
+		bool flush_current = closed ||
+							 ((_direct_io == false) && (_flush_interval > 0) &&
+							  (std::chrono::duration_cast<std::chrono::milliseconds>(now - file->_last_flush_time).count() >= _flush_interval));
+
+		if((file->_current_block != nullptr) && flush_current)
+		{
+			if(file->_current_block->size > 0)
+			{
+				file->_blocks.push_back(std::move(file->_current_block));
+			}
+			else
+			{
+				ReleaseBlock(std::move(file->_current_block));
+			}
+
+			file->_current_block = nullptr;
+		}
+
+		blocks.swap(file->_blocks);
+	}
+
+	if(blocks.empty() == false)
+	{
+		file->_last_flush_time = now;
+	}
+
+	for(auto &block : blocks)
+	{
+		if(file->_failed == false)
+		{
+			if(((file->_fd < 0) && (OpenFile(*file) == false)) || (WriteBlock(*file, *block) == false))
+			{
+				file->_failed = true;
+			}
+		}
+
+		ReleaseBlock(std::move(block));
+	}
+
+	if(closed == false)
+	{
+		return true;
+	}
+
+	if(file->_fd >= 0)
+	{
+		::close(file->_fd);
+		file->_fd = -1;
+
+		logti("%s has been recorded (%" PRIu64 " bytes%s)", file->_path.CStr(), file->_size, file->_failed ? ", failed" : "");
+	}
+
+	return false;
+}
+
+//====================================================================================================
+// OpenFile
+// - The directories of the path are made
+// - Falls back to the buffered I/O if O_DIRECT is not supported by the file system (e.g. tmpfs)
+//====================================================================================================
+bool RecordWriter::OpenFile(RecordFile &file)
+{
+	const auto &path = file._path;
+
+	for(off_t position = path.IndexOf('/', 1); position > 0; position = path.IndexOf('/', position + 1))
+	{
+		auto directory = path.Left(static_cast<size_t>(position));
+
+		if(ov::PathManager::MakeDirectory(directory.CStr()) == false)
+		{
+			logte("Could not create the directory: %s (%s)", directory.CStr(), ::strerror(errno));
+			return false;
+		}
+	}
+
+	int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+
+	file._direct_io = _direct_io;
+	file._fd = ::open(path.CStr(), flags | (_direct_io ? O_DIRECT : 0), 0644);
+
+	if((file._fd < 0) && _direct_io && (errno == EINVAL))
+	{
+		logtw("O_DIRECT is not supported by the file system of %s", path.CStr());
+
+		file._direct_io = false;
+		file._fd = ::open(path.CStr(), flags, 0644);
+	}
+
+	if(file._fd < 0)
+	{
+		logte("Could not open the file: %s (%s)", path.CStr(), ::strerror(errno));
+		return false;
+	}
+
+	logti("Recording to %s", path.CStr());
+
+	return true;
+}
+
+//====================================================================================================
+// WriteBlock
+// - The last block of the file (not aligned) is written without O_DIRECT
+//====================================================================================================
+bool RecordWriter::WriteBlock(RecordFile &file, const RecordBlock &block)
+{
+	if(file._direct_io && ((block.size % RECORD_WRITER_ALIGNMENT) != 0))
+	{
+		int flags = ::fcntl(file._fd, F_GETFL);
+
+		if((flags < 0) || (::fcntl(file._fd, F_SETFL, flags & ~O_DIRECT) < 0))
+		{
+			logte("Could not disable O_DIRECT of %s (%s)", file._path.CStr(), ::strerror(errno));
+			return false;
+		}
+
+		file._direct_io = false;
+	}
+
+	size_t written = 0;
+
+	while(written < block.size)
+	{
+		ssize_t result = ::write(file._fd, block.data + written, block.size - written);
+
+		if(result < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+
+			logte("Could not write to %s (%s), the rest of the file is dropped", file._path.CStr(), ::strerror(errno));
+			return false;
+		}
+
+		written += static_cast<size_t>(result);
+	}
+
+	return true;
+}
@@ -0,0 +1,173 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Alignment of the blocks (address/size/file offset), which is required by O_DIRECT
+#define RECORD_WRITER_ALIGNMENT				(4096)
+
+class RecordWriter;
+
+//====================================================================================================
+// RecordBlock
+// - Aligned buffer of a write, which is reused by the writer
+//====================================================================================================
+struct RecordBlock
+{
+	explicit RecordBlock(size_t capacity);
+	~RecordBlock();
+
+	size_t GetRemained() const
+	{
+		return capacity - size;
+	}
+
+	uint8_t *data = nullptr;
+	size_t capacity = 0;
+	size_t size = 0;
+};
+
+//====================================================================================================
+// RecordFile
+// - The data is appended by a stream (memory only), and written by the thread of RecordWriter
+// - The file is opened by the writer when the first block is written (the directories are made),
+//   so the stream never waits for the disk
+//====================================================================================================
+class RecordFile
+{
+public:
+	RecordFile(const std::shared_ptr<RecordWriter> &writer, const ov::String &path);
+	~RecordFile();
+
+	const ov::String &GetPath() const
+	{
+		return _path;
+	}
+
+	// The data is appended as a unit: false if the buffer of the writer is full, or the file is failed/closed
+	// (nothing is appended in this case)
+	bool Append(const void *data, size_t length);
+
+	bool Append(const std::vector<uint8_t> &data)
+	{
+		return Append(data.data(), data.size());
+	}
+
+	// The rest of the data is written, and the file is closed by the writer
+	void Close();
+
+	// Could not open/write the file (the data is dropped)
+	bool IsFailed() const
+	{
+		return _failed;
+	}
+
+	// Appended bytes (including the data which is not written yet)
+	uint64_t GetSize() const
+	{
+		return _size;
+	}
+
+protected:
+	friend class RecordWriter;
+
+	std::shared_ptr<RecordWriter> _writer;
+	ov::String _path;
+
+	std::mutex _mutex;
+	// The blocks which are filled (or sealed by the flush), written in order
+	std::deque<std::unique_ptr<RecordBlock>> _blocks;
+	// The block which is being filled
+	std::unique_ptr<RecordBlock> _current_block;
+	bool _closed = false;
+	std::atomic<bool> _failed { false };
+	uint64_t _size = 0;
+
+	// Accessed by the thread of the writer only
+	int _fd = -1;
+	bool _direct_io = false;
+	std::chrono::steady_clock::time_point _last_flush_time;
+};
+
+//====================================================================================================
+// RecordWriter
+// - A thread writes the files of the streams of an application
+// - The data is copied to the aligned blocks (write size), and a block is written by a write(),
+//   so the writes are large and aligned even if the frames are small
+// - The memory of the blocks is limited: if the disk can't keep up with the streams (e.g. the disk is stalled),
+//   Append() fails without waiting, and the stream drops the frames until the next key frame
+// - io_uring is not used, the writes are sequential and large, so a thread is enough for many streams
+//====================================================================================================
+class RecordWriter : public ov::EnableSharedFromThis<RecordWriter>
+{
+public:
+	RecordWriter(size_t block_size, size_t max_buffer_size, uint32_t flush_interval, bool direct_io);
+	~RecordWriter() override;
+
+	bool Start();
+	// The files are written and closed (the files which are created after it fail)
+	void Stop();
+
+	std::shared_ptr<RecordFile> CreateFile(const ov::String &path);
+
+	size_t GetBlockSize() const
+	{
+		return _block_size;
+	}
+
+	// Memory of the blocks which are allocated (including the free blocks which are kept for the reuse)
+	size_t GetBufferSize() const
+	{
+		return _allocated_block_count * _block_size;
+	}
+
+protected:
+	friend class RecordFile;
+
+	// All of the blocks or nothing (the limit is exceeded)
+	bool AllocateBlocks(size_t count, std::vector<std::unique_ptr<RecordBlock>> &blocks);
+	void ReleaseBlock(std::unique_ptr<RecordBlock> block);
+
+	// A block of the file is filled (or the file is closed)
+	void Notify();
+
+	void WriterThread();
+	// Returns false if the file is closed (it is removed from the list)
+	bool FlushFile(const std::shared_ptr<RecordFile> &file);
+	bool OpenFile(RecordFile &file);
+	bool WriteBlock(RecordFile &file, const RecordBlock &block);
+
+	size_t _block_size;
+	size_t _max_block_count;
+	uint32_t _flush_interval;
+	bool _direct_io;
+
+	std::mutex _block_mutex;
+	std::vector<std::unique_ptr<RecordBlock>> _free_blocks;
+	std::atomic<size_t> _allocated_block_count { 0 };
+
+	std::mutex _file_mutex;
+	std::vector<std::shared_ptr<RecordFile>> _files;
+
+	std::mutex _notify_mutex;
+	std::condition_variable _notify_condition;
+	bool _notified = false;
+
+	std::thread _thread;
+	std::atomic<bool> _stop_thread_flag { true };
+};
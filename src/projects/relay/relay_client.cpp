@@ -10,179 +10,400 @@
 #include "relay_private.h"
 
 #include <base/provider/stream.h>
+#include <base/application/stream_demand.h>
+
+#include <time.h>
+
+#include <algorithm>
 
 void RelayClient::Start(const ov::String &application)
 {
 	OV_ASSERT2(_stop == true);
 	_stop = false;
 
+	_application_name = application;
+
 	_media_route_application->RegisterConnectorApp(this->GetSharedPtr());
 
-	_connection = std::thread(
-		[&, application]() -> void
-		{
-			auto data = std::make_shared<ov::Data>(ov::MaxSrtPacketSize);
+	auto &origin = _application_info->GetOrigin();
+	std::vector<ov::String> urls = { origin.GetPrimary(), origin.GetSecondary() };
 
-			auto &origin = _application_info->GetOrigin();
+	for(auto &url : origin.GetUrls())
+	{
+		urls.push_back(url.GetUrl());
+	}
 
-			auto primary = origin.GetPrimary();
-			auto secondary = origin.GetSecondary();
+	auto &prewarm = origin.GetPrewarm();
 
-			// Extract scheme
-			primary = ParseAddress(primary);
-			secondary = ParseAddress(secondary);
+	if(prewarm.IsParsed())
+	{
+		for(auto &schedule : prewarm.GetSchedules())
+		{
+			int64_t start_time = 0;
 
-			if(primary.IsEmpty() && secondary.IsEmpty())
+			if(ParsePrewarmTime(schedule.GetStartTime(), &start_time) == false)
 			{
-				logte("Could not initialize relay client: both of addresses are invalid");
-				return;
+				logtw("Invalid <StartTime> of the prewarm schedule of %s/%s: %s (must be YYYY-MM-DDTHH:MM:SSZ)",
+				      application.CStr(), schedule.GetStream().CStr(), schedule.GetStartTime().CStr());
+				continue;
 			}
 
-			ov::SocketAddress primary_address(primary);
-			ov::SocketAddress secondary_address(secondary);
+			_prewarm_schedules.push_back({ schedule.GetStream(), start_time - std::max(schedule.GetLead(), 0), start_time + std::max(schedule.GetDuration(), 0) });
+		}
+
+		if(origin.IsPullOnDemand())
+		{
+			_use_prewarm = (prewarm.GetViewers() > 0) || (_prewarm_schedules.empty() == false);
+		}
+		else
+		{
+			logtw("<Prewarm> of %s is ignored: all the streams are pulled without <PullOnDemand>", application.CStr());
+		}
+	}
+
+	// The viewers of the other edges are needed to prewarm the streams
+	if(origin.IsDiscoveryEnabled() || (_use_prewarm && (prewarm.GetViewers() > 0)))
+	{
+		auto host = _application_info->GetParentAs<cfg::Host>("Host");
 
-			bool is_primary = true;
+		if((host != nullptr) && host->GetDiscovery().IsParsed() && RelayDirectory::Instance()->Start(host->GetDiscovery()))
+		{
+			_use_discovery = origin.IsDiscoveryEnabled();
+			_use_directory = true;
+		}
+		else
+		{
+			logte("The origins of %s cannot be discovered, and the viewers of the cluster are not known: the stream directory is not available (see <Host><Discovery>)", application.CStr());
+		}
+	}
 
-			while(_stop == false)
-			{
-				if((_client_socket.GetState() == ov::SocketState::Closed) && (_client_socket.Create(ov::SocketType::Srt) == false))
-				{
-					logte("Could not create relay client socket");
-					return;
-				}
+	{
+		// The lanes can access _origin_list as soon as they are started
+		std::lock_guard<std::mutex> lock_guard(_stream_list_mutex);
 
-				// Switch between primary and secondary server
-				if(
-					(is_primary && (primary.IsEmpty())) ||
-					((is_primary == false) && (secondary.IsEmpty()))
-					)
-				{
-					is_primary = !is_primary;
-				}
+		for(auto &url : urls)
+		{
+			AddOrigin(url);
+		}
 
-				const ov::SocketAddress &address = is_primary ? primary_address : secondary_address;
+		if(_origin_list.empty() && (_use_discovery == false))
+		{
+			logte("Could not initialize relay client: all of addresses are invalid");
+			return;
+		}
+	}
 
-				logti("Trying to connect to %s origin server...: %s", (is_primary) ? "primary" : "secondary", address.ToString().CStr());
+	// The streams are subscribed even if <PullOnDemand> is disabled, to receive them from one origin
+	_subscription_timer_id = ov::SharedTimerWheel::Instance()->Schedule(RELAY_SUBSCRIPTION_CHECK_INTERVAL, [this]() -> int64_t {
+		UpdateSubscriptions();
+		return RELAY_SUBSCRIPTION_CHECK_INTERVAL;
+	});
+}
 
-				auto error = _client_socket.Connect(address, 1000);
+bool RelayClient::AddOrigin(const ov::String &url)
+{
+	// Extract scheme
+	bool use_shm = false;
+	auto address = ParseAddress(url, &use_shm);
 
-				if(error != nullptr)
-				{
-					// retry
-					logtw("Cannot connect to %s origin server: %s (%s)", (is_primary) ? "primary" : "secondary", address.ToString().CStr(), error->ToString().CStr());
+	if(address.IsEmpty())
+	{
+		return false;
+	}
 
-					// switch
-					is_primary = !is_primary;
-					continue;
-				}
+	if(_origin_addresses.insert(address).second == false)
+	{
+		// Configured (or discovered) already
+		return false;
+	}
 
-				{
-					std::lock_guard<std::mutex> lock_guard(_stream_list_mutex);
+	size_t lane_count = static_cast<size_t>(std::max(1, std::min(_application_info->GetOrigin().GetConnections(), RELAY_ORIGIN_MAX_CONNECTIONS)));
+	auto origin_connection = std::make_shared<OriginConnection>();
 
-					for(auto &stream:_stream_list)
-					{
-						MediaRouteApplicationConnector::DeleteStream(stream.second->stream_info);
-					}
+	origin_connection->url = url;
+	origin_connection->address = address;
 
-					_stream_list.clear();
-				}
+	// "<host>:<port>" (ParseAddress() appends the default port), the host is resolved by the connection threads
+	auto port_position = address.IndexOfRev(':');
 
-				logti("Connected to %s origin server %s successfully", (is_primary) ? "primary" : "secondary", address.ToString().CStr());
+	origin_connection->host = address.Substring(0, static_cast<size_t>(port_position));
+	origin_connection->port = ov::Converter::ToUInt16(address.Substring(port_position + 1));
 
-				logti("Trying to request register for application [%s]...", application.CStr());
+	if(use_shm == false)
+	{
+		// The threads don't wait for the first lookup
+		ov::DnsResolver::Instance()->Prefetch(origin_connection->host);
+	}
 
-				Register(application);
+	for(size_t index = 0; index < lane_count; index++)
+	{
+		auto lane = std::make_unique<OriginLane>();
 
-				while(true)
-				{
-					// read from server
-					error = _client_socket.Recv(data);
-
-					if(error != nullptr)
-					{
-						logte("An error occurred while receive data: %s", error->ToString().CStr());
-
-						// reconnect
-						_client_socket.Close();
-						is_primary = !is_primary;
-						break;
-					}
-
-					RelayPacket packet(data.get());
-
-					switch(packet.GetType())
-					{
-						case RelayPacketType::Register:
-							OV_ASSERT2("RelayClient cannot handle Register packet");
-							break;
-
-						case RelayPacketType::CreateStream:
-							HandleCreateStream(packet);
-							break;
-
-						case RelayPacketType::DeleteStream:
-							HandleDeleteStream(packet);
-							break;
-
-						case RelayPacketType::Packet:
-							// 데이터 처리
-							HandleData(packet);
-							break;
-
-						case RelayPacketType::Error:
-							// There was a problem
-
-							// reconnect
-							is_primary = !is_primary;
-							_client_socket.Close();
-							break;
-					}
-				}
+		lane->index = index;
+		lane->use_shm = use_shm;
+		origin_connection->lanes.push_back(std::move(lane));
+	}
+
+	for(int index = 0; index < RELAY_ORIGIN_VIRTUAL_NODES; index++)
+	{
+		auto node = ov::String::FormatString("%s#%d", address.CStr(), index);
+
+		_origin_ring[ov::HashBytes(node.CStr(), node.GetLength())] = _origin_list.size();
+	}
+
+	_origin_list.push_back(origin_connection);
+
+	for(auto &lane : origin_connection->lanes)
+	{
+		lane->thread = std::thread(lane->use_shm ? &RelayClient::ShmConnectionThreadProc : &RelayClient::ConnectionThreadProc,
+		                           this, origin_connection.get(), lane.get(), _application_name);
+	}
+
+	return true;
+}
+
+void RelayClient::ConnectionThreadProc(OriginConnection *origin, OriginLane *lane, ov::String application)
+{
+	auto data = std::make_shared<ov::Data>(ov::MaxSrtPacketSize);
+	auto &socket = lane->socket;
+
+	while(_stop == false)
+	{
+		if((socket.GetState() == ov::SocketState::Closed) && (socket.Create(ov::SocketType::Srt) == false))
+		{
+			logte("Could not create relay client socket");
+			return;
+		}
+
+		logti("Trying to connect to origin server...: %s (lane #%zu)", origin->address.CStr(), lane->index);
+
+		// Looked up again when the cache is expired (a slow DNS server delays the attempt up to the timeout)
+		auto addresses = ov::DnsResolver::Instance()->Resolve(origin->host, origin->port, RELAY_ORIGIN_RESOLVE_TIMEOUT);
+
+		if(addresses.empty())
+		{
+			logtw("Cannot resolve origin server: %s", origin->address.CStr());
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(RELAY_ORIGIN_RECONNECT_INTERVAL));
+			continue;
+		}
+
+		auto error = socket.Connect(addresses, 1000);
+
+		if(error != nullptr)
+		{
+			// retry
+			logtw("Cannot connect to origin server: %s (%s)", origin->address.CStr(), error->ToString().CStr());
+
+			socket.Close();
+			std::this_thread::sleep_for(std::chrono::milliseconds(RELAY_ORIGIN_RECONNECT_INTERVAL));
+			continue;
+		}
+
+		logti("Connected to origin server %s successfully (lane #%zu)", origin->address.CStr(), lane->index);
+
+		logti("Trying to request register for application [%s]...", application.CStr());
+
+		lane->frame_assembler.Clear();
+		lane->is_connected = true;
+
+		if(lane->has_been_connected)
+		{
+			lane->reconnect_count++;
+		}
+
+		lane->has_been_connected = true;
+
+		Register(lane, application);
+
+		while(_stop == false)
+		{
+			// read from server
+			error = socket.Recv(data);
+
+			if(error != nullptr)
+			{
+				logte("An error occurred while receive data from %s: %s", origin->address.CStr(), error->ToString().CStr());
+				break;
 			}
-		});
+
+			lane->received_meter.Add(data->GetLength());
+
+			if(HandleMessage(origin, lane, ov::DataView(data)) == false)
+			{
+				// There was a problem
+				break;
+			}
+		}
+
+		// reconnect
+		lane->is_connected = false;
+		socket.Close();
+
+		HandleDisconnected(origin, lane);
+	}
 }
 
-std::shared_ptr<RelayClient::RelayStreamInfo> RelayClient::GetStreamInfo(info::stream_id_t stream_id, bool create_info, bool *created, bool delete_info)
+void RelayClient::ShmConnectionThreadProc(OriginConnection *origin, OriginLane *lane, ov::String application)
 {
-	std::lock_guard<std::mutex> lock_guard(_stream_list_mutex);
-	std::shared_ptr<RelayStreamInfo> relay_info;
-	auto relay_stream = _stream_list.find(stream_id);
+	auto &channel = lane->shm_channel;
+	auto socket_name = RelayShmChannel::GetSocketName(origin->port, application);
 
-	if(relay_stream == _stream_list.end())
+	while(_stop == false)
 	{
-		if(create_info)
+		logti("Trying to connect to origin server...: %s (lane #%zu)", origin->url.CStr(), lane->index);
+
+		if(channel.Connect(socket_name) == false)
 		{
-			// Create a new relay info
-			relay_info = std::make_shared<RelayStreamInfo>();
-			relay_info->stream_info = std::make_shared<StreamInfo>();
+			// retry
+			logtw("Cannot connect to origin server: %s", origin->url.CStr());
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(RELAY_ORIGIN_RECONNECT_INTERVAL));
+			continue;
+		}
+
+		logti("Connected to origin server %s successfully (lane #%zu)", origin->url.CStr(), lane->index);
+
+		lane->frame_assembler.Clear();
+		lane->is_connected = true;
+
+		if(lane->has_been_connected)
+		{
+			lane->reconnect_count++;
+		}
+
+		lane->has_been_connected = true;
+
+		Register(lane, application);
 
-			_stream_list[stream_id] = relay_info;
+		bool is_connected = true;
+
+		while(is_connected && (_stop == false))
+		{
+			if(channel.Wait(RELAY_SHM_POLL_INTERVAL) == false)
+			{
+				logte("The origin server %s is disconnected", origin->url.CStr());
+				break;
+			}
 
-			if(created != nullptr)
+			// The chunks are handled in the ring, and the frames are assembled into the buffers of the MediaPackets
+			for(auto data = channel.Peek(); data.IsEmpty() == false; data = channel.Peek())
 			{
-				*created = true;
+				lane->received_meter.Add(data.GetLength());
+
+				is_connected = HandleMessage(origin, lane, data);
+
+				channel.Pop();
+
+				if(is_connected == false)
+				{
+					// There was a problem
+					break;
+				}
 			}
 		}
+
+		// reconnect
+		lane->is_connected = false;
+		channel.Close();
+
+		HandleDisconnected(origin, lane);
 	}
-	else
+}
+
+bool RelayClient::HandleMessage(OriginConnection *origin, OriginLane *lane, const ov::DataView &data)
+{
+	// The streams are managed by the first lane (the old servers send the control frames to all the connections)
+	bool is_control_lane = (lane->index == 0);
+
+	if(RelayFrameAssembler::IsRelayFrame(data))
 	{
-		relay_info = relay_stream->second;
+		// The server supports v2
+		RelayFrame frame;
 
-		if(created != nullptr)
+		if(lane->frame_assembler.Push(data, &frame) == false)
 		{
-			*created = false;
+			// Wait for the rest of the frame
+			return true;
 		}
 
-		if(delete_info)
+		switch(frame.type)
 		{
-			_stream_list.erase(stream_id);
+			case RelayPacketType::Register:
+				OV_ASSERT2("RelayClient cannot handle Register packet");
+				break;
+
+			case RelayPacketType::Subscribe:
+			case RelayPacketType::Unsubscribe:
+				// The client sends them only
+				break;
+
+			case RelayPacketType::CreateStream:
+				if(is_control_lane)
+				{
+					HandleCreateStream(origin, frame.application_id, frame.stream_id, frame.data->GetData(), frame.data->GetLength());
+				}
+				break;
+
+			case RelayPacketType::DeleteStream:
+				if(is_control_lane)
+				{
+					HandleDeleteStream(origin, frame.application_id, frame.stream_id);
+				}
+				break;
+
+			case RelayPacketType::Packet:
+				HandleData(origin, lane, frame);
+				break;
+
+			case RelayPacketType::Error:
+				return false;
 		}
+
+		return true;
+	}
+
+	ov::Data packet_data(data.GetData(), data.GetLength(), true);
+	RelayPacket packet(&packet_data);
+
+	switch(packet.GetType())
+	{
+		case RelayPacketType::Register:
+			OV_ASSERT2("RelayClient cannot handle Register packet");
+			break;
+
+		case RelayPacketType::Subscribe:
+		case RelayPacketType::Unsubscribe:
+			// The client sends them only
+			break;
+
+		case RelayPacketType::CreateStream:
+			if(is_control_lane)
+			{
+				HandleCreateStream(origin, packet.GetApplicationId(), packet.GetStreamId(), packet.GetData(), packet.GetDataSize());
+			}
+			break;
+
+		case RelayPacketType::DeleteStream:
+			if(is_control_lane)
+			{
+				HandleDeleteStream(origin, packet.GetApplicationId(), packet.GetStreamId());
+			}
+			break;
+
+		case RelayPacketType::Packet:
+			// 데이터 처리
+			HandleData(origin, lane, packet);
+			break;
+
+		case RelayPacketType::Error:
+			return false;
 	}
 
-	return relay_info;
+	return true;
 }
 
-ov::String RelayClient::ParseAddress(const ov::String &address)
+ov::String RelayClient::ParseAddress(const ov::String &address, bool *use_shm)
 {
 	if(address.IsEmpty())
 	{
@@ -200,6 +421,22 @@ ov::String RelayClient::ParseAddress(const ov::String &address)
 	auto scheme = tokens[0];
 	scheme.MakeUpper();
 
+	*use_shm = (scheme == RELAY_SHM_SCHEME);
+
+	if(*use_shm)
+	{
+		// shm://<origin port> (the address is used to identify the origin)
+		auto port = tokens[1].IsEmpty() ? static_cast<uint16_t>(RELAY_DEFAULT_PORT) : ov::Converter::ToUInt16(tokens[1]);
+
+		if(port == 0)
+		{
+			logte("Invalid port in relay address: %s", address.CStr());
+			return "";
+		}
+
+		return ov::String::FormatString("127.0.0.1:%u", port);
+	}
+
 	if(scheme != "SRT")
 	{
 		logte("Not supported scheme in relay address: %s", address.CStr());
@@ -216,9 +453,9 @@ ov::String RelayClient::ParseAddress(const ov::String &address)
 	return new_address;
 }
 
-void RelayClient::HandleCreateStream(const RelayPacket &packet)
+void RelayClient::HandleCreateStream(OriginConnection *origin, info::application_id_t application_id, info::stream_id_t stream_id, const void *data, size_t length)
 {
-	ov::String deserialize = ov::String(static_cast<const char *>(packet.GetData()), packet.GetDataSize());
+	ov::String deserialize = ov::String(static_cast<const char *>(data), length);
 
 	if(deserialize.IsEmpty())
 	{
@@ -232,7 +469,7 @@ void RelayClient::HandleCreateStream(const RelayPacket &packet)
 
 	auto lines = deserialize.Split("\n");
 
-	logtd("Received stream information:\n%s", deserialize.CStr());
+	logtd("Received stream information from %s:\n%s", origin->address.CStr(), deserialize.CStr());
 
 	if(lines.empty())
 	{
@@ -240,212 +477,846 @@ void RelayClient::HandleCreateStream(const RelayPacket &packet)
 		return;
 	}
 
-	bool first = true;
-	std::shared_ptr<StreamInfo> stream_info;
-	std::shared_ptr<RelayStreamInfo> relay_info;
-
-	for(auto &line : lines)
-	{
-		if(first)
-		{
-			// stream name
-			first = false;
-
-			info::stream_id_t stream_id = packet.GetStreamId();
+	// stream name
+	auto stream_info = std::make_shared<StreamInfo>();
 
-			bool is_created;
+	stream_info->SetName(lines[0]);
 
-			relay_info = GetStreamInfo(stream_id, true, &is_created);
+	for(size_t line_index = 1; line_index < lines.size(); line_index++)
+	{
+		auto &line = lines[line_index];
 
-			if(is_created == false)
-			{
-				logtd("The stream #%u is already created. Ignoring...", stream_id);
-				break;
-			}
+		if(line.IsEmpty())
+		{
+			continue;
+		}
 
-			stream_info = relay_info->stream_info;
+		// track info
+		auto info = line.Split("|");
 
-			stream_info->SetName(line);
-			stream_info->SetId(stream_id);
-		}
-		else
+		if(info.size() != 14)
 		{
-			if(line.IsEmpty())
-			{
-				continue;
-			}
-
-			if(stream_info == nullptr)
-			{
-				continue;
-			}
+			logte("Invalid track data: [%s]", line.CStr());
+			return;
+		}
 
-			// track info
-			auto info = line.Split("|");
+		auto track = std::make_shared<MediaTrack>();
+		int index = 0;
+
+		// Deserialize VideoTrack
+		// framerate|width|height
+		track->SetFrameRate(ov::Converter::ToDouble(info[index++]));
+		track->SetWidth(ov::Converter::ToInt32(info[index++]));
+		track->SetHeight(ov::Converter::ToInt32(info[index++]));
+
+		// Deserialize AudioTrack
+		// samplerate|format|layout
+		track->SetSampleRate(ov::Converter::ToInt32(info[index++]));
+		track->GetSample().SetFormat(static_cast<common::AudioSample::Format>(ov::Converter::ToInt32(info[index++])));
+		track->GetChannel().SetLayout(static_cast<common::AudioChannel::Layout >(ov::Converter::ToInt32(info[index++])));
+
+		// Serialize MediaTrack
+		// track_id|codec_id|media_type|timebase.num|timebase.den|bitrate|start_frame_time|last_frame_time
+		track->SetId(ov::Converter::ToUInt32(info[index++]));
+		track->SetCodecId(static_cast<common::MediaCodecId>(ov::Converter::ToInt32(info[index++])));
+		track->SetMediaType(static_cast<common::MediaType>(ov::Converter::ToInt32(info[index++])));
+		int num = ov::Converter::ToInt32(info[index++]);
+		int den = ov::Converter::ToInt32(info[index++]);
+		track->SetTimeBase(num, den);
+		track->SetBitrate(ov::Converter::ToInt32(info[index++]));
+		track->SetStartFrameTime(ov::Converter::ToInt64(info[index++]));
+		track->SetLastFrameTime(ov::Converter::ToInt64(info[index++]));
+
+		stream_info->AddTrack(track);
+	}
 
-			if(info.size() != 14)
-			{
-				logte("Invalid track data: [%s]", line.CStr());
-				return;
-			}
+	bool is_created = false;
 
-			auto track = std::make_shared<MediaTrack>();
-			int index = 0;
+	{
+		std::lock_guard<std::mutex> lock_guard(_stream_list_mutex);
 
-			// Deserialize VideoTrack
-			// framerate|width|height
-			track->SetFrameRate(ov::Converter::ToDouble(info[index++]));
-			track->SetWidth(ov::Converter::ToInt32(info[index++]));
-			track->SetHeight(ov::Converter::ToInt32(info[index++]));
+		origin->stream_names[stream_id] = stream_info->GetName();
+		origin->stream_ids[stream_info->GetName()] = stream_id;
 
-			// Deserialize AudioTrack
-			// samplerate|format|layout
-			track->SetSampleRate(ov::Converter::ToInt32(info[index++]));
-			track->GetSample().SetFormat(static_cast<common::AudioSample::Format>(ov::Converter::ToInt32(info[index++])));
-			track->GetChannel().SetLayout(static_cast<common::AudioChannel::Layout >(ov::Converter::ToInt32(info[index++])));
+		auto &relay_info = _stream_list[stream_info->GetName()];
 
-			// Serialize MediaTrack
-			// track_id|codec_id|media_type|timebase.num|timebase.den|bitrate|start_frame_time|last_frame_time
-			track->SetId(ov::Converter::ToUInt32(info[index++]));
-			track->SetCodecId(static_cast<common::MediaCodecId>(ov::Converter::ToInt32(info[index++])));
-			track->SetMediaType(static_cast<common::MediaType>(ov::Converter::ToInt32(info[index++])));
-			int num = ov::Converter::ToInt32(info[index++]);
-			int den = ov::Converter::ToInt32(info[index++]);
-			track->SetTimeBase(num, den);
-			track->SetBitrate(ov::Converter::ToInt32(info[index++]));
-			track->SetStartFrameTime(ov::Converter::ToInt64(info[index++]));
-			track->SetLastFrameTime(ov::Converter::ToInt64(info[index++]));
+		if(relay_info == nullptr)
+		{
+			// The stream is created by the first origin, the others share it
+			relay_info = std::make_shared<RelayStreamInfo>();
 
-			stream_info->AddTrack(track);
+			stream_info->SetId(++_last_stream_id);
+			relay_info->stream_info = stream_info;
 
-			auto transaction = std::make_shared<Transaction>();
+			for(auto &track : stream_info->GetTracks())
+			{
+				relay_info->transactions[track.first] = std::make_shared<Transaction>();
+			}
 
-			relay_info->transactions[track->GetId()] = transaction;
+			is_created = true;
+		}
+		else
+		{
+			logtd("The stream %s is already created. Ignoring...", stream_info->GetName().CStr());
 		}
 	}
 
-	if(stream_info != nullptr)
+	if(is_created)
 	{
 		MediaRouteApplicationConnector::CreateStream(stream_info);
 
-		logtd("A stream is created: %s/%s (%u/%u)",
+		logtd("A stream is created: %s/%s (%u/%u, origin: %s #%u)",
 		      _application_info->GetName().CStr(), stream_info->GetName().CStr(),
-		      packet.GetApplicationId(), stream_info->GetId()
+		      application_id, stream_info->GetId(), origin->address.CStr(), stream_id
 		);
 	}
+
+	// Subscribe the stream without waiting for the timer
+	UpdateSubscriptions();
 }
 
-void RelayClient::HandleDeleteStream(const RelayPacket &packet)
+void RelayClient::HandleDeleteStream(OriginConnection *origin, info::application_id_t application_id, info::stream_id_t stream_id)
 {
-	info::stream_id_t stream_id = packet.GetStreamId();
-
-	auto relay_info = GetStreamInfo(stream_id, false, nullptr, true);
+	std::shared_ptr<StreamInfo> deleted_stream;
 
-	if(relay_info == nullptr)
 	{
-		// If a DeleteStream event occurs before registering, it enters here
-		return;
-	}
+		std::lock_guard<std::mutex> lock_guard(_stream_list_mutex);
 
-	auto stream = relay_info->stream_info;
+		auto stream_name = origin->stream_names.find(stream_id);
 
-	logtd("A stream is deleted: %s/%s (%u/%u)",
-	      _application_info->GetName().CStr(), stream->GetName().CStr(),
-	      packet.GetApplicationId(), stream->GetId()
-	);
+		if(stream_name == origin->stream_names.end())
+		{
+			// If a DeleteStream event occurs before registering, it enters here
+			return;
+		}
 
-	MediaRouteApplicationConnector::DeleteStream(stream);
-}
+		auto name = stream_name->second;
 
-void RelayClient::HandleData(const RelayPacket &packet)
-{
-	auto relay_info = GetStreamInfo(packet.GetStreamId());
+		origin->stream_ids.erase(name);
+		origin->stream_names.erase(stream_name);
 
-	if(relay_info == nullptr)
-	{
-		// No sync occurred, or sync is in progress
-		Register(_application_info->GetName());
-		return;
-	}
+		auto relay_stream = _stream_list.find(name);
 
-	uint32_t track_id = packet.GetTrackId();
-	auto transaction_info = relay_info->transactions.find(track_id);
+		if(relay_stream != _stream_list.end())
+		{
+			auto &relay_info = relay_stream->second;
 
-	if(transaction_info == relay_info->transactions.end())
-	{
-		// The stream is parsing in HandleCreateStream()
-		return;
-	}
+			if(relay_info->origin == origin)
+			{
+				relay_info->origin = nullptr;
+				relay_info->lane = nullptr;
+			}
 
-	std::shared_ptr<Transaction> transaction = transaction_info->second;
+			if(IsStreamAvailable(name) == false)
+			{
+				if(relay_info->reported_viewers > 0)
+				{
+					RelayDirectory::Instance()->SetViewerCount(_application_name, name, 0);
+				}
 
-	auto &data = transaction->data;
-	bool is_different_packet = false;
+				deleted_stream = relay_info->stream_info;
+				_stream_list.erase(relay_stream);
+			}
+		}
+	}
 
-	if(packet.GetTransactionId() != transaction->transaction_id)
+	if(deleted_stream != nullptr)
 	{
-		// another packet is arrived
-		is_different_packet = true;
+		logtd("A stream is deleted: %s/%s (%u/%u)",
+		      _application_info->GetName().CStr(), deleted_stream->GetName().CStr(),
+		      application_id, deleted_stream->GetId()
+		);
+
+		MediaRouteApplicationConnector::DeleteStream(deleted_stream);
 	}
 	else
 	{
-		data.Append(packet.GetData(), packet.GetDataSize());
+		// Another origin still has the stream
+		UpdateSubscriptions();
 	}
+}
 
-	if(packet.IsEnd() || is_different_packet)
-	{
-		// send to media router
-		auto stream_list = _media_route_application->GetStreams();
-		auto stream = stream_list[packet.GetStreamId()];
+void RelayClient::HandleDisconnected(OriginConnection *origin, OriginLane *lane)
+{
+	std::vector<std::shared_ptr<StreamInfo>> deleted_streams;
+	// The streams which are still received from the other lanes of the origin
+	std::vector<std::pair<OriginLane *, info::stream_id_t>> unsubscribe_list;
 
-		if(stream != nullptr)
+	if(lane->index != 0)
+	{
 		{
-			if(data.GetLength() > 0)
+			std::lock_guard<std::mutex> lock_guard(_stream_list_mutex);
+
+			// Only the streams of the lane are moved (to the first lane, or to another origin)
+			for(auto &relay_stream : _stream_list)
 			{
-				auto media_packet = std::make_unique<MediaPacket>(
-					static_cast<common::MediaType>(transaction->media_type),
-					transaction->track_id,
-					data.GetData(),
-					data.GetLength(),
-					transaction->last_pts,
-					static_cast<MediaPacketFlag>(transaction->flags)
-				);
-
-				::memcpy(media_packet->_frag_hdr.get(), packet.GetFragmentHeader(), sizeof(FragmentationHeader));
-
-				_media_route_application->OnReceiveBuffer(this->GetSharedPtr(), stream->GetStreamInfo(), std::move(media_packet));
+				auto &relay_info = relay_stream.second;
+
+				if(relay_info->lane == lane)
+				{
+					relay_info->origin = nullptr;
+					relay_info->lane = nullptr;
+				}
 			}
 		}
-		else
-		{
-			OV_ASSERT2(stream != nullptr);
-		}
 
-		// clear the data
-		data.Clear();
+		UpdateSubscriptions();
+		return;
 	}
 
-	if(is_different_packet)
 	{
-		transaction->transaction_id = packet.GetTransactionId();
-		transaction->media_type = packet.GetMediaType();
-		transaction->last_pts = packet.GetPts();
-		transaction->track_id = packet.GetTrackId();
-		data.Append(packet.GetData(), packet.GetDataSize());
-		transaction->flags = packet.GetFlags();
-	}
+		std::lock_guard<std::mutex> lock_guard(_stream_list_mutex);
+
+		origin->stream_names.clear();
+		origin->stream_ids.clear();
+
+		for(auto relay_stream = _stream_list.begin(); relay_stream != _stream_list.end();)
+		{
+			auto &relay_info = relay_stream->second;
+
+			if(relay_info->origin == origin)
+			{
+				if((relay_info->lane != lane) && (relay_info->lane != nullptr) && relay_info->lane->is_connected)
+				{
+					unsubscribe_list.emplace_back(relay_info->lane, relay_info->origin_stream_id);
+				}
+
+				relay_info->origin = nullptr;
+				relay_info->lane = nullptr;
+			}
+
+			if(IsStreamAvailable(relay_stream->first) == false)
+			{
+				deleted_streams.push_back(relay_info->stream_info);
+				relay_stream = _stream_list.erase(relay_stream);
+			}
+			else
+			{
+				++relay_stream;
+			}
+		}
+	}
+
+	for(auto &stream : deleted_streams)
+	{
+		MediaRouteApplicationConnector::DeleteStream(stream);
+	}
+
+	for(auto &item : unsubscribe_list)
+	{
+		RelayPacket packet(RelayPacketType::Unsubscribe);
+
+		packet.SetApplicationId(_application_info->GetId());
+		packet.SetStreamId(item.second);
+
+		SendPacket(item.first, packet);
+	}
+
+	// Move the streams to the other origins
+	UpdateSubscriptions();
+}
+
+std::shared_ptr<RelayClient::RelayStreamInfo> RelayClient::GetSubscribedStream(OriginConnection *origin, OriginLane *lane, info::stream_id_t origin_stream_id, int64_t now)
+{
+	auto stream_name = origin->stream_names.find(origin_stream_id);
+
+	if(stream_name == origin->stream_names.end())
+	{
+		return nullptr;
+	}
+
+	auto relay_stream = _stream_list.find(stream_name->second);
+
+	if((relay_stream == _stream_list.end()) || (relay_stream->second->origin != origin) || (relay_stream->second->lane != lane))
+	{
+		// The stream is received from another origin or lane (e.g. sent before the origin processes Unsubscribe)
+		return nullptr;
+	}
+
+	relay_stream->second->last_packet_time = now;
+
+	return relay_stream->second;
+}
+
+void RelayClient::HandleData(OriginConnection *origin, OriginLane *lane, const RelayPacket &packet)
+{
+	std::lock_guard<std::mutex> lock_guard(_stream_list_mutex);
+
+	int64_t now = GetCurrentTime();
+	auto relay_info = GetSubscribedStream(origin, lane, packet.GetStreamId(), now);
+
+	if(relay_info == nullptr)
+	{
+		return;
+	}
+
+	uint32_t track_id = packet.GetTrackId();
+	auto transaction_info = relay_info->transactions.find(track_id);
+
+	if(transaction_info == relay_info->transactions.end())
+	{
+		// Unknown track
+		return;
+	}
+
+	std::shared_ptr<Transaction> transaction = transaction_info->second;
+
+	bool is_different_packet = false;
+
+	if(packet.GetTransactionId() != transaction->transaction_id)
+	{
+		// another packet is arrived
+		is_different_packet = true;
+	}
+	else
+	{
+		transaction->data->Append(packet.GetData(), packet.GetDataSize());
+	}
+
+	if(packet.IsEnd() || is_different_packet)
+	{
+		// v1 packets don't have the length of the frame, so the next buffer is sized from the previous frame
+		size_t capacity = transaction->data->GetLength();
+
+		if(capacity > 0)
+		{
+			UpdateStreamStatistics(relay_info.get(), transaction.get(), transaction->media_type, transaction->flags, transaction->last_pts, capacity, now);
+		}
+
+		SendToMediaRouter(relay_info->stream_info->GetId(), transaction->media_type, transaction->track_id, std::move(transaction->data), transaction->last_pts, transaction->flags, packet.GetFragmentHeader());
+
+		transaction->data = CreateFrameBuffer(capacity);
+	}
+
+	if(is_different_packet)
+	{
+		transaction->transaction_id = packet.GetTransactionId();
+		transaction->media_type = packet.GetMediaType();
+		transaction->last_pts = packet.GetPts();
+		transaction->track_id = packet.GetTrackId();
+		transaction->data->Append(packet.GetData(), packet.GetDataSize());
+		transaction->flags = packet.GetFlags();
+	}
+}
+
+void RelayClient::HandleData(OriginConnection *origin, OriginLane *lane, RelayFrame &frame)
+{
+	std::lock_guard<std::mutex> lock_guard(_stream_list_mutex);
+
+	int64_t now = GetCurrentTime();
+	auto relay_info = GetSubscribedStream(origin, lane, frame.stream_id, now);
+
+	if(relay_info == nullptr)
+	{
+		return;
+	}
+
+	auto transaction = relay_info->transactions.find(frame.track_id);
+
+	if(transaction == relay_info->transactions.end())
+	{
+		// Unknown track
+		return;
+	}
+
+	UpdateStreamStatistics(relay_info.get(), transaction->second.get(), frame.media_type, frame.flags, frame.pts, frame.data->GetLength(), now);
+
+	SendToMediaRouter(relay_info->stream_info->GetId(), frame.media_type, frame.track_id, std::move(frame.data), frame.pts, frame.flags, &(frame.frag_header));
+}
+
+bool RelayClient::IsStreamAvailable(const ov::String &stream_name) const
+{
+	for(auto &origin : _origin_list)
+	{
+		if(origin->stream_ids.find(stream_name) != origin->stream_ids.end())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+RelayClient::OriginConnection *RelayClient::SelectOrigin(const ov::String &stream_name, const std::shared_ptr<RelayStreamInfo> &relay_info, int64_t now)
+{
+	OriginConnection *failed_origin = nullptr;
+	auto node = _origin_ring.lower_bound(ov::HashBytes(stream_name.CStr(), stream_name.GetLength()));
+
+	// Walk the ring clockwise from the point of the stream
+	for(size_t count = 0; count < _origin_ring.size(); count++, node++)
+	{
+		if(node == _origin_ring.end())
+		{
+			node = _origin_ring.begin();
+		}
+
+		auto origin = _origin_list[node->second].get();
+
+		if((origin->IsConnected() == false) || (origin->stream_ids.find(stream_name) == origin->stream_ids.end()))
+		{
+			continue;
+		}
+
+		if((origin == relay_info->failed_origin) && (now < relay_info->failed_until))
+		{
+			// Use it only if there is no other origin
+			failed_origin = origin;
+			continue;
+		}
+
+		return origin;
+	}
+
+	return failed_origin;
+}
+
+RelayClient::OriginLane *RelayClient::SelectLane(OriginConnection *origin, const ov::String &stream_name)
+{
+	auto &lane = origin->lanes[ov::HashBytes(stream_name.CStr(), stream_name.GetLength()) % origin->lanes.size()];
+
+	return lane->is_connected ? lane.get() : origin->lanes[0].get();
 }
 
-void RelayClient::Register(const ov::String &identifier)
+void RelayClient::UpdateSubscriptions()
+{
+	int64_t now = GetCurrentTime();
+	bool pull_on_demand = _application_info->GetOrigin().IsPullOnDemand();
+	int64_t idle_timeout = _application_info->GetOrigin().GetPullIdleTimeout();
+
+	struct Request
+	{
+		OriginConnection *origin;
+		OriginLane *lane;
+		RelayPacketType type;
+		info::stream_id_t stream_id;
+	};
+
+	std::vector<Request> requests;
+	std::set<ov::String> discovered_origins;
+
+	if(_use_discovery)
+	{
+		discovered_origins = RelayDirectory::Instance()->GetOrigins(_application_name);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_stream_list_mutex);
+
+		// The origin is kept when it leaves the directory (it is reconnected when it comes back)
+		for(auto &url : discovered_origins)
+		{
+			if(AddOrigin(url))
+			{
+				logti("The origin %s of %s is found in the directory", url.CStr(), _application_name.CStr());
+			}
+		}
+
+		// [key: stream name, value: sessions of this node]
+		std::map<ov::String, size_t> session_counts;
+
+		if(pull_on_demand || _use_directory)
+		{
+			for(auto &stream : _stream_list)
+			{
+				auto &relay_info = stream.second;
+				size_t session_count = StreamDemand::Instance()->GetInputSessionCount(_application_info->GetId(), stream.first);
+
+				session_counts[stream.first] = session_count;
+
+				if(_use_directory && (session_count != relay_info->reported_viewers))
+				{
+					RelayDirectory::Instance()->SetViewerCount(_application_name, stream.first, session_count);
+					relay_info->reported_viewers = session_count;
+				}
+			}
+		}
+
+		std::set<ov::String> prewarm_streams;
+
+		if(_use_prewarm)
+		{
+			prewarm_streams = SelectPrewarmStreams(session_counts);
+		}
+
+		for(auto &stream : _stream_list)
+		{
+			auto &relay_info = stream.second;
+			bool is_wanted = true;
+
+			if((relay_info->origin != nullptr) && (relay_info->origin->IsConnected()))
+			{
+				auto bitrate = relay_info->received_meter.GetBitrate();
+
+				if(bitrate > 0)
+				{
+					relay_info->last_bitrate = bitrate;
+				}
+			}
+
+			if(pull_on_demand)
+			{
+				size_t session_count = session_counts[stream.first];
+				bool is_prewarmed = (session_count == 0) && (prewarm_streams.find(stream.first) != prewarm_streams.end());
+
+				if(is_prewarmed != relay_info->is_prewarmed)
+				{
+					logti("The stream %s/%s %s", _application_name.CStr(), stream.first.CStr(), is_prewarmed ? "is prewarmed" : "is no longer prewarmed");
+					relay_info->is_prewarmed = is_prewarmed;
+				}
+
+				if((session_count > 0) || is_prewarmed)
+				{
+					relay_info->idle_since = -1;
+				}
+				else if(relay_info->origin == nullptr)
+				{
+					// Nobody watches the stream
+					is_wanted = false;
+				}
+				else if(relay_info->idle_since < 0)
+				{
+					relay_info->idle_since = now;
+				}
+				else if((now - relay_info->idle_since) >= idle_timeout)
+				{
+					relay_info->idle_since = -1;
+					is_wanted = false;
+				}
+			}
+
+			if(relay_info->origin != nullptr)
+			{
+				if(is_wanted == false)
+				{
+					requests.push_back({ relay_info->origin, relay_info->lane, RelayPacketType::Unsubscribe, relay_info->origin_stream_id });
+					relay_info->origin = nullptr;
+					relay_info->lane = nullptr;
+					continue;
+				}
+
+				if((now - relay_info->last_packet_time) < RELAY_ORIGIN_STALL_TIMEOUT)
+				{
+					continue;
+				}
+
+				logtw("The stream %s is stalled on the origin %s, trying to move it to another origin...",
+				      stream.first.CStr(), relay_info->origin->address.CStr());
+
+				requests.push_back({ relay_info->origin, relay_info->lane, RelayPacketType::Unsubscribe, relay_info->origin_stream_id });
+				relay_info->failed_origin = relay_info->origin;
+				relay_info->failed_until = now + RELAY_ORIGIN_RETRY_INTERVAL;
+				relay_info->origin = nullptr;
+				relay_info->lane = nullptr;
+			}
+
+			if(is_wanted == false)
+			{
+				continue;
+			}
+
+			auto origin = SelectOrigin(stream.first, relay_info, now);
+
+			if(origin == nullptr)
+			{
+				// No origin is available now
+				continue;
+			}
+
+			if((relay_info->last_origin != nullptr) && (relay_info->last_origin != origin))
+			{
+				relay_info->origin_switch_count++;
+			}
+
+			relay_info->origin = origin;
+			relay_info->last_origin = origin;
+			relay_info->lane = SelectLane(origin, stream.first);
+			relay_info->origin_stream_id = origin->stream_ids[stream.first];
+			relay_info->last_packet_time = now;
+
+			// The v1 packets of the previous origin are not continued (and the pts might be different)
+			for(auto &transaction : relay_info->transactions)
+			{
+				transaction.second->transaction_id = 0xFFFFFFFF;
+				transaction.second->data = CreateFrameBuffer(0);
+				transaction.second->min_delay = INT64_MAX;
+			}
+
+			relay_info->lag = 0;
+
+			requests.push_back({ origin, relay_info->lane, RelayPacketType::Subscribe, relay_info->origin_stream_id });
+		}
+	}
+
+	for(auto &request : requests)
+	{
+		logtd("Trying to %s the stream #%u of %s (lane #%zu)...", (request.type == RelayPacketType::Subscribe) ? "subscribe" : "unsubscribe",
+		      request.stream_id, request.origin->address.CStr(), request.lane->index);
+
+		RelayPacket packet(request.type);
+
+		packet.SetApplicationId(_application_info->GetId());
+		packet.SetStreamId(request.stream_id);
+
+		SendPacket(request.lane, packet);
+	}
+}
+
+std::set<ov::String> RelayClient::SelectPrewarmStreams(const std::map<ov::String, size_t> &session_counts)
+{
+	auto &prewarm = _application_info->GetOrigin().GetPrewarm();
+	size_t viewer_threshold = static_cast<size_t>(std::max(prewarm.GetViewers(), 0));
+	uint64_t max_bitrate = static_cast<uint64_t>(std::max(prewarm.GetMaxBitrate(), 0)) * 1000000ULL;
+	size_t max_memory = static_cast<size_t>(std::max(prewarm.GetMaxMemory(), 0)) * 1024 * 1024;
+	int64_t wall_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+	struct Candidate
+	{
+		const ov::String *stream_name;
+		const RelayStreamInfo *relay_info;
+		bool is_scheduled;
+		size_t viewers;
+	};
+
+	std::vector<Candidate> candidates;
+
+	for(auto &stream : _stream_list)
+	{
+		auto session_count = session_counts.find(stream.first);
+
+		if((session_count != session_counts.end()) && (session_count->second > 0))
+		{
+			// Subscribed anyway
+			continue;
+		}
+
+		bool is_scheduled = std::any_of(_prewarm_schedules.begin(), _prewarm_schedules.end(), [&](const PrewarmSchedule &schedule) -> bool {
+			return (schedule.stream_name == stream.first) && (wall_time >= schedule.start_time) && (wall_time < schedule.end_time);
+		});
+		size_t viewers = ((viewer_threshold > 0) && _use_directory) ? RelayDirectory::Instance()->GetViewerCount(_application_name, stream.first) : 0;
+
+		if(is_scheduled || ((viewer_threshold > 0) && (viewers >= viewer_threshold)))
+		{
+			candidates.push_back({ &(stream.first), stream.second.get(), is_scheduled, viewers });
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) -> bool {
+		if(a.is_scheduled != b.is_scheduled)
+		{
+			return a.is_scheduled;
+		}
+
+		return a.viewers > b.viewers;
+	});
+
+	// The cost of a stream which is not measured is not known until it is received for a while
+	bool is_measuring = std::any_of(candidates.begin(), candidates.end(), [](const Candidate &candidate) -> bool {
+		return candidate.relay_info->is_prewarmed && (candidate.relay_info->origin != nullptr) && (candidate.relay_info->last_bitrate == 0);
+	});
+
+	std::set<ov::String> streams;
+	uint64_t total_bitrate = 0;
+	size_t total_memory = 0;
+
+	for(auto &candidate : candidates)
+	{
+		auto relay_info = candidate.relay_info;
+
+		if(relay_info->last_bitrate == 0)
+		{
+			if(relay_info->is_prewarmed == false)
+			{
+				if(is_measuring || ((max_bitrate > 0) && (total_bitrate >= max_bitrate)) || ((max_memory > 0) && (total_memory >= max_memory)))
+				{
+					continue;
+				}
+
+				is_measuring = true;
+			}
+		}
+		else if(((max_bitrate > 0) && ((total_bitrate + relay_info->last_bitrate) > max_bitrate)) ||
+		        ((max_memory > 0) && ((total_memory + relay_info->last_gop_bytes) > max_memory)))
+		{
+			// Over the budget
+			continue;
+		}
+
+		total_bitrate += relay_info->last_bitrate;
+		total_memory += relay_info->last_gop_bytes;
+		streams.insert(*(candidate.stream_name));
+	}
+
+	return streams;
+}
+
+bool RelayClient::ParsePrewarmTime(const ov::String &time, int64_t *time_ms)
+{
+	struct tm tm {};
+
+	if(::sscanf(time.CStr(), RELAY_PREWARM_TIME_FORMAT, &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6)
+	{
+		return false;
+	}
+
+	tm.tm_year -= 1900;
+	tm.tm_mon -= 1;
+
+	time_t seconds = ::timegm(&tm);
+
+	if(seconds < 0)
+	{
+		return false;
+	}
+
+	*time_ms = static_cast<int64_t>(seconds) * 1000;
+
+	return true;
+}
+
+void RelayClient::UpdateStreamStatistics(RelayStreamInfo *relay_info, Transaction *transaction, int8_t media_type, uint8_t flags, int64_t pts, size_t bytes, int64_t now)
+{
+	relay_info->received_frames++;
+	relay_info->received_meter.Add(bytes);
+
+	if((media_type == static_cast<int8_t>(common::MediaType::Video)) && (flags == static_cast<uint8_t>(MediaPacketFlag::Key)))
+	{
+		// The GOP cache of the stream holds about this
+		relay_info->last_gop_bytes = relay_info->gop_bytes;
+		relay_info->gop_bytes = 0;
+	}
+
+	relay_info->gop_bytes += bytes;
+
+	auto track = relay_info->stream_info->GetTrack(transaction->track_id);
+
+	if((track == nullptr) || (track->GetTimeBase().GetDen() == 0))
+	{
+		return;
+	}
+
+	int64_t pts_ms = static_cast<int64_t>(static_cast<double>(pts) * track->GetTimeBase().GetExpr() * 1000.0);
+	int64_t delay = now - pts_ms;
+
+	transaction->min_delay = std::min(transaction->min_delay, delay);
+
+	relay_info->lag = delay - transaction->min_delay;
+	relay_info->max_lag = std::max(relay_info->max_lag, relay_info->lag);
+}
+
+void RelayClient::GetStatisticsData(std::vector<std::shared_ptr<RelayLinkStatisticsData>> &links, std::vector<std::shared_ptr<RelayStreamStatisticsData>> &streams)
+{
+	std::lock_guard<std::mutex> lock_guard(_stream_list_mutex);
+
+	for(auto &origin : _origin_list)
+	{
+		for(auto &lane : origin->lanes)
+		{
+			auto data = std::make_shared<RelayLinkStatisticsData>();
+
+			data->app_name = _application_info->GetName();
+			data->role = "client";
+			data->remote = origin->address;
+			data->lane = lane->index;
+			data->is_connected = lane->is_connected;
+			data->total_bytes = lane->received_meter.GetTotalBytes();
+			data->bitrate = lane->received_meter.GetBitrate();
+			data->reconnect_count = lane->reconnect_count;
+
+			for(auto &stream : _stream_list)
+			{
+				if(stream.second->lane == lane.get())
+				{
+					data->stream_count++;
+				}
+			}
+
+			links.push_back(data);
+		}
+	}
+
+	for(auto &stream : _stream_list)
+	{
+		auto &relay_info = stream.second;
+		auto data = std::make_shared<RelayStreamStatisticsData>();
+
+		data->app_name = _application_info->GetName();
+		data->stream_name = stream.first;
+
+		if(relay_info->origin != nullptr)
+		{
+			data->origin = relay_info->origin->address;
+			data->lane = relay_info->lane->index;
+		}
+
+		data->received_frames = relay_info->received_frames;
+		data->bitrate = relay_info->received_meter.GetBitrate();
+		data->lag = relay_info->lag;
+		data->max_lag = relay_info->max_lag;
+		data->origin_switch_count = relay_info->origin_switch_count;
+
+		// The maximum is measured for each request
+		relay_info->max_lag = relay_info->lag;
+
+		streams.push_back(data);
+	}
+}
+
+void RelayClient::SendToMediaRouter(info::stream_id_t stream_id, int8_t media_type, uint32_t track_id, std::shared_ptr<ov::Data> data, uint64_t pts, uint8_t flags, const FragmentationHeader *frag_header)
+{
+	auto stream = _media_route_application->GetStream(stream_id);
+
+	if(stream == nullptr)
+	{
+		OV_ASSERT2(stream != nullptr);
+		return;
+	}
+
+	if((data == nullptr) || (data->GetLength() == 0))
+	{
+		return;
+	}
+
+	auto media_packet = std::make_unique<MediaPacket>(
+		static_cast<common::MediaType>(media_type),
+		track_id,
+		std::move(data),
+		pts,
+		static_cast<MediaPacketFlag>(flags)
+	);
+
+	::memcpy(media_packet->_frag_hdr.get(), frag_header, sizeof(FragmentationHeader));
+
+	_media_route_application->OnReceiveBuffer(this->GetSharedPtr(), stream->GetStreamInfo(), std::move(media_packet));
+}
+
+std::shared_ptr<ov::Data> RelayClient::CreateFrameBuffer(size_t capacity)
+{
+	auto data = std::make_shared<ov::Data>();
+
+	data->ReserveHeadroom(MEDIA_PACKET_HEADROOM, capacity);
+
+	return data;
+}
+
+void RelayClient::Register(OriginLane *lane, const ov::String &identifier)
 {
 	RelayPacket packet(RelayPacketType::Register);
 
+	// Ask the server to send the frames using v2, and the subscribed streams only
+	uint8_t flags = RELAY_REGISTER_FLAG_V2 | RELAY_REGISTER_FLAG_SUBSCRIPTION;
+
+	if(lane->index != 0)
+	{
+		flags |= RELAY_REGISTER_FLAG_DATA_ONLY;
+	}
+
+	packet.SetFlags(flags);
 	packet.SetData(identifier.CStr(), static_cast<uint16_t>(identifier.GetLength()));
 
-	SendPacket(packet);
+	SendPacket(lane, packet);
 }
 
-void RelayClient::SendPacket(const RelayPacket &packet)
+void RelayClient::SendPacket(OriginLane *lane, const RelayPacket &packet)
 {
 	// TODO: make transaction id
 	if(packet.GetTransactionId() == 0)
@@ -454,30 +1325,43 @@ void RelayClient::SendPacket(const RelayPacket &packet)
 
 		new_packet.SetTransactionId(ov::Random::GenerateUInt32());
 
-		_client_socket.Send(&new_packet, sizeof(new_packet));
+		SendPacket(lane, new_packet);
+	}
+	else if(lane->use_shm)
+	{
+		lane->shm_channel.SendControl(&packet, sizeof(packet));
 	}
 	else
 	{
-		_client_socket.Send(&packet, sizeof(packet));
+		lane->socket.Send(&packet, sizeof(packet));
 	}
 }
 
-void RelayClient::SendPacket(RelayPacketType type, info::application_id_t application_id, info::stream_id_t stream_id, const MediaPacket &packet)
+int64_t RelayClient::GetCurrentTime()
 {
-	RelayPacket relay_packet(type);
-
-	relay_packet.SetApplicationId(ov::HostToBE32(application_id));
-	relay_packet.SetStreamId(ov::HostToBE32(stream_id));
-
-	SendPacket(relay_packet);
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
 void RelayClient::Stop()
 {
-	_stop = false;
+	_stop = true;
+
+	if(_subscription_timer_id != 0)
+	{
+		ov::SharedTimerWheel::Instance()->Cancel(_subscription_timer_id);
+		_subscription_timer_id = 0;
+	}
 
-	if(_connection.joinable())
+	for(auto &origin : _origin_list)
 	{
-		_connection.join();
+		for(auto &lane : origin->lanes)
+		{
+			lane->socket.Close();
+
+			if(lane->thread.joinable())
+			{
+				lane->thread.join();
+			}
+		}
 	}
 }
@@ -9,7 +9,13 @@
 #pragma once
 
 #include "relay_datastructure.h"
+#include "relay_directory.h"
+#include "relay_frame.h"
+#include "relay_shm.h"
+#include "relay_statistics.h"
 
+#include <atomic>
+#include <set>
 #include <utility>
 
 #include <base/ovlibrary/ovlibrary.h>
@@ -20,7 +26,42 @@
 #include <media_router/media_route_application.h>
 
 #define RELAY_DEFAULT_PORT                              9000
+// Interval (ms) to check the sessions and the origins of the streams
+#define RELAY_SUBSCRIPTION_CHECK_INTERVAL               200
+// Points of an origin on the consistent hash ring
+#define RELAY_ORIGIN_VIRTUAL_NODES                      64
+// A subscribed stream which doesn't receive any packet for this time (ms) is moved to another origin
+#define RELAY_ORIGIN_STALL_TIMEOUT                      3000
+// The origin which is failed for a stream is not selected again for the stream during this time (ms),
+// unless it is the only origin which has the stream
+#define RELAY_ORIGIN_RETRY_INTERVAL                     10000
+// Delay (ms) before reconnecting to the origin
+#define RELAY_ORIGIN_RECONNECT_INTERVAL                 1000
+// Maximum time (ms) to wait for the lookup of the origin (the lookup continues, and the next attempt uses the result)
+#define RELAY_ORIGIN_RESOLVE_TIMEOUT                    1000
+// Maximum value of <Connections>
+#define RELAY_ORIGIN_MAX_CONNECTIONS                    16
+// Format of <Prewarm><Schedule><StartTime> (UTC)
+#define RELAY_PREWARM_TIME_FORMAT                       "%4d-%2d-%2dT%2d:%2d:%2dZ"
 
+// Pulls the streams from the origins
+//
+// - The client connects to all the origins (<Primary>, <Secondary>, <Url>), and receives the streams of them
+// - Each stream is subscribed from one origin which is selected by consistent hashing of the name of the stream,
+//   so the origins share the load and the edges pull a stream from the same origin
+// - When the origin is disconnected (or stalls), the stream is subscribed from the next origin on the ring,
+//   which replays its GOP cache, so the stream resumes from the current key frame
+// - <Connections>: the client opens several SRT connections (lanes) to each origin, and the streams are spread over them.
+//   SRT delivers the packets of a connection in order, so a lost packet only stalls the streams of its lane
+// - <Discovery>: the client also connects to the origins which announce the streams of the application
+//   to the stream directory (see RelayDirectory), so the origins don't need to be configured
+// - shm://<origin port>: the origin is on the same host, the lanes receive the frames through the shared memory
+//   instead of SRT (see relay_shm.h)
+// - <Prewarm> (with <PullOnDemand>): the streams which are watched on the other edges (reported to the stream directory),
+//   or scheduled to start, are subscribed before the first viewer of this edge joins, so the GOP cache is already warm.
+//   The streams are admitted in the order of the priority (scheduled, then the viewers of the cluster)
+//   while their last bitrate and GOP fit <MaxBitrate> and <MaxMemory>, and a stream which is not measured yet
+//   is admitted one at a time
 class RelayClient : public MediaRouteApplicationConnector
 {
 public:
@@ -33,10 +74,8 @@ public:
 	void Start(const ov::String &application);
 	void Stop();
 
-	void SendPacket(const RelayPacket &packet);
-	void SendPacket(RelayPacketType type, info::application_id_t application_id, info::stream_id_t stream_id, const MediaPacket &packet);
-
-	void Register(const ov::String &identifier);
+	// Collects the statistics of the connections to the origins, and the streams
+	void GetStatisticsData(std::vector<std::shared_ptr<RelayLinkStatisticsData>> &links, std::vector<std::shared_ptr<RelayStreamStatisticsData>> &streams);
 
 	//--------------------------------------------------------------------
 	// Implementation of MediaRouteApplicationConnector
@@ -54,35 +93,175 @@ protected:
 		int8_t media_type;
 		uint64_t last_pts;
 		uint32_t track_id;
-		ov::Data data;
+		// Handed to the MediaPacket when the packet is completed, then the next one is allocated
+		std::shared_ptr<ov::Data> data = CreateFrameBuffer(0);
 		uint8_t flags;
+
+		// The minimum of (arrival time - pts) of the track since the stream is subscribed
+		int64_t min_delay = INT64_MAX;
+	};
+
+	struct OriginLane
+	{
+		size_t index = 0;
+
+		ov::Socket socket;
+		// shm://: the socket is not used
+		bool use_shm = false;
+		RelayShmChannel shm_channel;
+		RelayFrameAssembler frame_assembler;
+		std::thread thread;
+		std::atomic<bool> is_connected { false };
+
+		// Statistics
+		RelayRateMeter received_meter;
+		bool has_been_connected = false;
+		std::atomic<uint64_t> reconnect_count { 0 };
+	};
+
+	struct OriginConnection
+	{
+		ov::String url;
+		// "<host>:<port>" of the url
+		ov::String address;
+		ov::String host;
+		uint16_t port = 0;
+
+		// The first lane receives the control frames (CreateStream, DeleteStream) and the streams,
+		// the others receive the streams only
+		std::vector<std::unique_ptr<OriginLane>> lanes;
+
+		bool IsConnected() const
+		{
+			return lanes[0]->is_connected;
+		}
+
+		// The streams of the origin (_stream_list_mutex must be locked)
+		// [key: stream id of the origin, value: stream name]
+		std::map<info::stream_id_t, ov::String> stream_names;
+		// [key: stream name, value: stream id of the origin]
+		std::map<ov::String, info::stream_id_t> stream_ids;
 	};
 
 	struct RelayStreamInfo
 	{
+		// The id of the stream is allocated by the client (each origin has its own ids)
 		std::shared_ptr<StreamInfo> stream_info;
 
 		// [key: track_id, value: transaction data]
 		std::map<uint32_t, std::shared_ptr<Transaction>> transactions;
+
+		// The origin which sends the stream (nullptr: not subscribed)
+		OriginConnection *origin = nullptr;
+		OriginLane *lane = nullptr;
+		info::stream_id_t origin_stream_id = 0;
+		int64_t last_packet_time = 0;
+
+		// The origin which is failed for this stream
+		OriginConnection *failed_origin = nullptr;
+		int64_t failed_until = 0;
+
+		// <PullOnDemand>: when the last session is detached (-1: has sessions)
+		int64_t idle_since = -1;
+
+		// <Prewarm>: subscribed without the sessions
+		bool is_prewarmed = false;
+		// The viewers which are reported to the stream directory
+		size_t reported_viewers = 0;
+		// The cost of the stream while it was subscribed last time (0: not measured)
+		uint64_t last_bitrate = 0;
+		size_t last_gop_bytes = 0;
+		// Bytes since the last key frame of the video
+		size_t gop_bytes = 0;
+
+		// Statistics (see RelayStreamStatisticsData)
+		OriginConnection *last_origin = nullptr;
+		uint64_t origin_switch_count = 0;
+		uint64_t received_frames = 0;
+		RelayRateMeter received_meter;
+		int64_t lag = 0;
+		int64_t max_lag = 0;
 	};
 
-	ov::String ParseAddress(const ov::String &address);
+	// use_shm: the address is shm://
+	ov::String ParseAddress(const ov::String &address, bool *use_shm);
+	// Creates the connection to the origin and starts its lanes (_stream_list_mutex must be locked)
+	// - Returns false if the address is invalid or the origin is added already
+	bool AddOrigin(const ov::String &url);
+
+	void ConnectionThreadProc(OriginConnection *origin, OriginLane *lane, ov::String application);
+	void ShmConnectionThreadProc(OriginConnection *origin, OriginLane *lane, ov::String application);
+	void Register(OriginLane *lane, const ov::String &identifier);
+	void SendPacket(OriginLane *lane, const RelayPacket &packet);
+
+	// Returns false if the origin reports an error
+	bool HandleMessage(OriginConnection *origin, OriginLane *lane, const ov::DataView &data);
+	void HandleCreateStream(OriginConnection *origin, info::application_id_t application_id, info::stream_id_t stream_id, const void *data, size_t length);
+	void HandleDeleteStream(OriginConnection *origin, info::application_id_t application_id, info::stream_id_t stream_id);
+	// RelayPacket (v1): the packets are assembled per track
+	void HandleData(OriginConnection *origin, OriginLane *lane, const RelayPacket &packet);
+	// RelayFrame (v2): the frame is already assembled
+	void HandleData(OriginConnection *origin, OriginLane *lane, RelayFrame &frame);
+	void HandleDisconnected(OriginConnection *origin, OriginLane *lane);
+	// _stream_list_mutex must be locked
+	static void UpdateStreamStatistics(RelayStreamInfo *relay_info, Transaction *transaction, int8_t media_type, uint8_t flags, int64_t pts, size_t bytes, int64_t now);
+
+	// _stream_list_mutex must be locked
+	// - Returns the stream which is sent by the lane of the origin (nullptr if the lane is not selected for the stream)
+	std::shared_ptr<RelayStreamInfo> GetSubscribedStream(OriginConnection *origin, OriginLane *lane, info::stream_id_t origin_stream_id, int64_t now);
+	OriginConnection *SelectOrigin(const ov::String &stream_name, const std::shared_ptr<RelayStreamInfo> &relay_info, int64_t now);
+	// The lane is selected by the hash of the name of the stream (the first lane is used while the lane is disconnected)
+	static OriginLane *SelectLane(OriginConnection *origin, const ov::String &stream_name);
+	bool IsStreamAvailable(const ov::String &stream_name) const;
 
-	std::shared_ptr<RelayStreamInfo> GetStreamInfo(info::stream_id_t stream_id, bool create_info = false, bool *created = nullptr, bool delete_info = false);
+	// Subscribes the streams from the selected origins, and unsubscribes the idle (<PullOnDemand>) or stalled streams
+	void UpdateSubscriptions();
+	// The streams without the sessions which are subscribed by <Prewarm> (_stream_list_mutex must be locked)
+	std::set<ov::String> SelectPrewarmStreams(const std::map<ov::String, size_t> &session_counts);
+	// RELAY_PREWARM_TIME_FORMAT -> ms since the epoch
+	static bool ParsePrewarmTime(const ov::String &time, int64_t *time_ms);
 
-	void HandleCreateStream(const RelayPacket &packet);
-	void HandleDeleteStream(const RelayPacket &packet);
-	void HandleData(const RelayPacket &packet);
+	void SendToMediaRouter(info::stream_id_t stream_id, int8_t media_type, uint32_t track_id, std::shared_ptr<ov::Data> data, uint64_t pts, uint8_t flags, const FragmentationHeader *frag_header);
+	// The buffer has the headroom of MediaPacket, so it can be used as the data of the MediaPacket without copying
+	static std::shared_ptr<ov::Data> CreateFrameBuffer(size_t capacity);
+
+	static int64_t GetCurrentTime();
 
 	MediaRouteApplication *_media_route_application;
 
 	const info::Application *_application_info;
 
-	ov::Socket _client_socket;
+	ov::String _application_name;
+
+	// The origins are only added (by Start() and the discovery) with _stream_list_mutex
+	std::vector<std::shared_ptr<OriginConnection>> _origin_list;
+	// Consistent hash ring [key: hash, value: index of _origin_list]
+	std::map<uint64_t, size_t> _origin_ring;
+	// Addresses of _origin_list (<ip>:<port>)
+	std::set<ov::String> _origin_addresses;
+	// The origins in the stream directory are added
+	bool _use_discovery = false;
+	// The viewers are reported to the stream directory
+	bool _use_directory = false;
+
+	struct PrewarmSchedule
+	{
+		ov::String stream_name;
+		// ms since the epoch
+		int64_t start_time;
+		int64_t end_time;
+	};
+
+	bool _use_prewarm = false;
+	std::vector<PrewarmSchedule> _prewarm_schedules;
 
-	std::thread _connection;
 	bool _stop = true;
 
+	// Timer of UpdateSubscriptions()
+	uint64_t _subscription_timer_id = 0;
+
 	std::mutex _stream_list_mutex;
-	std::map<info::stream_id_t, std::shared_ptr<RelayStreamInfo>> _stream_list;
+	// [key: stream name]
+	std::map<ov::String, std::shared_ptr<RelayStreamInfo>> _stream_list;
+	info::stream_id_t _last_stream_id = 0;
 };
\ No newline at end of file
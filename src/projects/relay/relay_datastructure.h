@@ -19,9 +19,19 @@ enum class RelayPacketType : uint8_t
 	CreateStream,
 	DeleteStream,
 	Packet,
-	Error
+	Error,
+	// The client wants to receive the packets of the stream (stream_id)
+	Subscribe,
+	Unsubscribe
 };
 
+// Set to the flags of the Register packet when the client subscribes the streams which it needs
+// (Otherwise, the server sends the packets of all streams)
+#define RELAY_REGISTER_FLAG_SUBSCRIPTION                0x02
+// Set to the flags of the Register packet when the connection only receives the packets of the subscribed streams
+// (The client opens several connections to an origin, and the streams are received from one of them)
+#define RELAY_REGISTER_FLAG_DATA_ONLY                   0x04
+
 constexpr const int RelayPacketDataSize = 1200;
 
 #pragma pack(push, 1)
@@ -0,0 +1,423 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "relay_directory.h"
+#include "relay_private.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+
+RelayDirectory::~RelayDirectory()
+{
+	Stop();
+}
+
+bool RelayDirectory::Start(const cfg::Discovery &discovery)
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	if(_socket_fd >= 0)
+	{
+		// Already started by another application
+		return true;
+	}
+
+	_group_address = ov::SocketAddress(discovery.GetAddress());
+
+	if((_group_address.GetFamily() != ov::SocketFamily::Inet) || (IN_MULTICAST(ntohl(_group_address.AddrInForIPv4()->s_addr)) == false))
+	{
+		logte("Invalid address of the stream directory: %s (must be an IPv4 multicast group)", discovery.GetAddress().CStr());
+		return false;
+	}
+
+	int socket_fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+	if(socket_fd < 0)
+	{
+		logte("Could not create the socket of the stream directory: %s", ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		return false;
+	}
+
+	// The nodes on the same host listen to the same group
+	int reuse = 1;
+	sockaddr_in bind_address {};
+
+	bind_address.sin_family = AF_INET;
+	bind_address.sin_port = htons(_group_address.Port());
+	bind_address.sin_addr = *(_group_address.AddrInForIPv4());
+
+	ip_mreq membership {};
+	in_addr interface_address {};
+	uint8_t ttl = static_cast<uint8_t>(std::max(1, std::min(discovery.GetTtl(), 255)));
+	uint8_t loopback = 1;
+
+	membership.imr_multiaddr = bind_address.sin_addr;
+	interface_address.s_addr = discovery.GetInterface().IsEmpty() ? htonl(INADDR_ANY) : ::inet_addr(discovery.GetInterface().CStr());
+	membership.imr_interface = interface_address;
+
+	if((::setsockopt(socket_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0) ||
+	   (::bind(socket_fd, reinterpret_cast<const sockaddr *>(&bind_address), sizeof(bind_address)) != 0) ||
+	   (::setsockopt(socket_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) ||
+	   (::setsockopt(socket_fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) != 0) ||
+	   // The announcements are received by the other nodes on this host too
+	   (::setsockopt(socket_fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loopback, sizeof(loopback)) != 0) ||
+	   (::setsockopt(socket_fd, IPPROTO_IP, IP_MULTICAST_IF, &interface_address, sizeof(interface_address)) != 0))
+	{
+		logte("Could not join the stream directory %s: %s", _group_address.ToString().CStr(), ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		::close(socket_fd);
+		return false;
+	}
+
+	_socket_fd = socket_fd;
+	_advertise_ip = discovery.GetAdvertiseIp();
+	_interval = std::max(discovery.GetInterval(), 100);
+	_node_id = (static_cast<uint64_t>(ov::Random::GenerateUInt32()) << 32) | ov::Random::GenerateUInt32();
+	_stop = false;
+
+	_thread = std::thread(&RelayDirectory::ThreadProc, this);
+
+	logti("Stream directory is started: %s (node: %016llx, interval: %lld ms)",
+	      _group_address.ToString().CStr(), static_cast<unsigned long long>(_node_id), static_cast<long long>(_interval));
+
+	return true;
+}
+
+void RelayDirectory::Stop()
+{
+	_stop = true;
+
+	if(_thread.joinable())
+	{
+		_thread.join();
+	}
+
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	if(_socket_fd >= 0)
+	{
+		::close(_socket_fd);
+		_socket_fd = -1;
+	}
+
+	_local_streams.clear();
+	_remote_streams.clear();
+	_local_viewers.clear();
+	_remote_viewers.clear();
+}
+
+void RelayDirectory::AddStream(const ov::String &application, const ov::String &stream_name, uint16_t origin_port)
+{
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		_local_streams[StreamKey(application, stream_name)] = origin_port;
+	}
+
+	Send(ov::String::FormatString("%s+%u %s/%s\n", MakeHeader().CStr(), origin_port, application.CStr(), stream_name.CStr()));
+}
+
+void RelayDirectory::RemoveStream(const ov::String &application, const ov::String &stream_name, uint16_t origin_port)
+{
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		_local_streams.erase(StreamKey(application, stream_name));
+	}
+
+	// If it is lost, the entry is expired by the other nodes
+	Send(ov::String::FormatString("%s-%u %s/%s\n", MakeHeader().CStr(), origin_port, application.CStr(), stream_name.CStr()));
+}
+
+std::set<ov::String> RelayDirectory::GetOrigins(const ov::String &application) const
+{
+	std::set<ov::String> origins;
+
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	for(auto item = _remote_streams.lower_bound(StreamKey(application, "")); (item != _remote_streams.end()) && (item->first.first == application); ++item)
+	{
+		for(auto &origin : item->second)
+		{
+			origins.insert(origin.first);
+		}
+	}
+
+	return origins;
+}
+
+void RelayDirectory::SetViewerCount(const ov::String &application, const ov::String &stream_name, size_t viewers)
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	if(viewers == 0)
+	{
+		_local_viewers.erase(StreamKey(application, stream_name));
+	}
+	else
+	{
+		_local_viewers[StreamKey(application, stream_name)] = viewers;
+	}
+}
+
+size_t RelayDirectory::GetViewerCount(const ov::String &application, const ov::String &stream_name) const
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	auto item = _remote_viewers.find(StreamKey(application, stream_name));
+
+	if(item == _remote_viewers.end())
+	{
+		return 0;
+	}
+
+	size_t viewers = 0;
+
+	for(auto &node : item->second)
+	{
+		viewers += node.second.first;
+	}
+
+	return viewers;
+}
+
+ov::String RelayDirectory::MakeHeader() const
+{
+	return ov::String::FormatString("%s %016llx %s\n", RELAY_DIRECTORY_MAGIC, static_cast<unsigned long long>(_node_id),
+	                                _advertise_ip.IsEmpty() ? "*" : _advertise_ip.CStr());
+}
+
+void RelayDirectory::Send(const ov::String &message)
+{
+	if(_socket_fd < 0)
+	{
+		return;
+	}
+
+	if(::sendto(_socket_fd, message.CStr(), message.GetLength(), 0, _group_address.Address(), _group_address.AddressLength()) < 0)
+	{
+		logtd("Could not send the announcement to %s: %s", _group_address.ToString().CStr(), ov::Error::CreateErrorFromErrno()->ToString().CStr());
+	}
+}
+
+void RelayDirectory::Announce()
+{
+	std::vector<ov::String> messages;
+	auto header = MakeHeader();
+	int64_t now = GetCurrentTime();
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		ov::String message = header;
+		std::vector<ov::String> lines;
+
+		for(auto &stream : _local_streams)
+		{
+			lines.push_back(ov::String::FormatString("+%u %s/%s\n", stream.second, stream.first.first.CStr(), stream.first.second.CStr()));
+		}
+
+		for(auto &stream : _local_viewers)
+		{
+			lines.push_back(ov::String::FormatString("*%zu %s/%s\n", stream.second, stream.first.first.CStr(), stream.first.second.CStr()));
+		}
+
+		for(auto &line : lines)
+		{
+			if(((message.GetLength() + line.GetLength()) > RELAY_DIRECTORY_MAX_DATAGRAM_SIZE) && (message.GetLength() > header.GetLength()))
+			{
+				messages.push_back(message);
+				message = header;
+			}
+
+			message.Append(line);
+		}
+
+		if(message.GetLength() > header.GetLength())
+		{
+			messages.push_back(message);
+		}
+
+		for(auto stream = _remote_streams.begin(); stream != _remote_streams.end();)
+		{
+			auto &origins = stream->second;
+
+			for(auto origin = origins.begin(); origin != origins.end();)
+			{
+				if(origin->second <= now)
+				{
+					logti("The stream %s/%s of %s is expired in the directory", stream->first.first.CStr(), stream->first.second.CStr(), origin->first.CStr());
+					origin = origins.erase(origin);
+				}
+				else
+				{
+					++origin;
+				}
+			}
+
+			stream = origins.empty() ? _remote_streams.erase(stream) : std::next(stream);
+		}
+
+		for(auto stream = _remote_viewers.begin(); stream != _remote_viewers.end();)
+		{
+			auto &nodes = stream->second;
+
+			for(auto node = nodes.begin(); node != nodes.end();)
+			{
+				node = (node->second.second <= now) ? nodes.erase(node) : std::next(node);
+			}
+
+			stream = nodes.empty() ? _remote_viewers.erase(stream) : std::next(stream);
+		}
+	}
+
+	for(auto &message : messages)
+	{
+		Send(message);
+	}
+}
+
+void RelayDirectory::HandleAnnouncement(const ov::String &message, const ov::String &source_ip, int64_t now)
+{
+	auto lines = message.Split("\n");
+
+	if(lines.empty())
+	{
+		return;
+	}
+
+	auto header = lines[0].Split(" ");
+
+	if((header.size() != 3) || (header[0] != RELAY_DIRECTORY_MAGIC))
+	{
+		logtd("Invalid announcement from %s", source_ip.CStr());
+		return;
+	}
+
+	if(header[1] == ov::String::FormatString("%016llx", static_cast<unsigned long long>(_node_id)))
+	{
+		// Sent by this node
+		return;
+	}
+
+	const ov::String &ip = (header[2] == "*") ? source_ip : header[2];
+	int64_t expire_time = now + (_interval * RELAY_DIRECTORY_EXPIRE_COUNT);
+
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	for(size_t index = 1; index < lines.size(); index++)
+	{
+		const auto &line = lines[index];
+		// +<origin port> <application>/<stream>
+		auto space = line.IndexOf(' ');
+		auto slash = line.IndexOf('/');
+
+		if((line.GetLength() < 2) || ((line[0] != '+') && (line[0] != '-') && (line[0] != '*')) || (space < 2) || (slash <= space))
+		{
+			continue;
+		}
+
+		if(line[0] == '*')
+		{
+			// *<viewers> <application>/<stream>
+			auto viewers = ov::Converter::ToInt64(line.Substring(1, static_cast<size_t>(space - 1)));
+
+			if(viewers > 0)
+			{
+				StreamKey key(line.Substring(space + 1, static_cast<size_t>(slash - space - 1)), line.Substring(slash + 1));
+
+				_remote_viewers[key][header[1]] = std::make_pair(static_cast<size_t>(viewers), expire_time);
+			}
+
+			continue;
+		}
+
+		auto port = ov::Converter::ToUInt16(line.Substring(1, static_cast<size_t>(space - 1)));
+
+		if(port == 0)
+		{
+			continue;
+		}
+
+		StreamKey key(line.Substring(space + 1, static_cast<size_t>(slash - space - 1)), line.Substring(slash + 1));
+		auto origin = ov::String::FormatString("srt://%s:%u", ip.CStr(), port);
+
+		if(line[0] == '+')
+		{
+			auto &origins = _remote_streams[key];
+
+			if(origins.find(origin) == origins.end())
+			{
+				logti("The stream %s/%s is found in the directory: %s", key.first.CStr(), key.second.CStr(), origin.CStr());
+			}
+
+			origins[origin] = expire_time;
+		}
+		else
+		{
+			auto stream = _remote_streams.find(key);
+
+			if((stream != _remote_streams.end()) && (stream->second.erase(origin) > 0))
+			{
+				logti("The stream %s/%s is removed from the directory: %s", key.first.CStr(), key.second.CStr(), origin.CStr());
+
+				if(stream->second.empty())
+				{
+					_remote_streams.erase(stream);
+				}
+			}
+		}
+	}
+}
+
+void RelayDirectory::ThreadProc()
+{
+	char buffer[RELAY_DIRECTORY_MAX_DATAGRAM_SIZE * 2];
+	int64_t next_announce_time = 0;
+
+	while(_stop == false)
+	{
+		int64_t now = GetCurrentTime();
+
+		if(now >= next_announce_time)
+		{
+			Announce();
+			next_announce_time = now + _interval;
+		}
+
+		pollfd fds = { _socket_fd, POLLIN, 0 };
+
+		// Wakes up at least every 100 ms to check the stop
+		if(::poll(&fds, 1, static_cast<int>(std::min<int64_t>(next_announce_time - now, 100))) <= 0)
+		{
+			continue;
+		}
+
+		while(true)
+		{
+			sockaddr_in source {};
+			socklen_t source_length = sizeof(source);
+			ssize_t length = ::recvfrom(_socket_fd, buffer, sizeof(buffer), MSG_DONTWAIT, reinterpret_cast<sockaddr *>(&source), &source_length);
+
+			if(length <= 0)
+			{
+				break;
+			}
+
+			HandleAnnouncement(ov::String(buffer, static_cast<size_t>(length)), ov::SocketAddress(source).GetIpAddress(), GetCurrentTime());
+		}
+	}
+}
+
+int64_t RelayDirectory::GetCurrentTime()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
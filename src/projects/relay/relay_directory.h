@@ -0,0 +1,105 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+#include <base/ovsocket/socket_address.h>
+#include <config/config.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+// The entry which is not announced again in (<Interval> * this) is removed (the node is gone)
+#define RELAY_DIRECTORY_EXPIRE_COUNT                    3
+// Maximum size of an announcement (the streams are split into several announcements)
+#define RELAY_DIRECTORY_MAX_DATAGRAM_SIZE               1200
+#define RELAY_DIRECTORY_MAGIC                           "OVDIR/1"
+
+// Directory of the streams which are ingested by the nodes of the cluster
+//
+// - Each node announces the streams of its origin applications (RelayServer of the Live applications)
+//   to the multicast group of <Host><Discovery>: immediately when a stream is created or deleted,
+//   and all of them every <Interval> (so the nodes which join later, or lost an announcement, catch up)
+// - RelayClient (<Origin><Discovery>true</Discovery>) connects to the origins which have the streams of its application,
+//   and the stream is selected from one of them as usual (consistent hashing over the connected origins)
+// - A node doesn't need to know the other nodes, so the streams can be ingested by any origin
+//
+// Announcement (text):
+//   OVDIR/1 <node id> <advertised IP or *>\n
+//   +<origin port> <application>/<stream>\n   (the stream is ingested)
+//   -<origin port> <application>/<stream>\n   (the stream is deleted)
+//   *<viewers> <application>/<stream>\n       (the viewers of the stream on this node, used by <Origin><Prewarm>)
+class RelayDirectory : public ov::Singleton<RelayDirectory>
+{
+public:
+	friend class ov::Singleton<RelayDirectory>;
+
+	~RelayDirectory() override;
+
+	// The directory is shared by the applications, so only the first call starts it
+	bool Start(const cfg::Discovery &discovery);
+	void Stop();
+
+	bool IsStarted() const
+	{
+		return _socket_fd >= 0;
+	}
+
+	// Called by RelayServer
+	void AddStream(const ov::String &application, const ov::String &stream_name, uint16_t origin_port);
+	void RemoveStream(const ov::String &application, const ov::String &stream_name, uint16_t origin_port);
+
+	// The origins (srt://<ip>:<port>) which have any stream of the application (the streams of this node are excluded)
+	std::set<ov::String> GetOrigins(const ov::String &application) const;
+
+	// Called by RelayClient: the viewers of the stream on this node (announced every <Interval>, 0: not announced)
+	void SetViewerCount(const ov::String &application, const ov::String &stream_name, size_t viewers);
+	// The viewers of the stream on the other nodes
+	size_t GetViewerCount(const ov::String &application, const ov::String &stream_name) const;
+
+protected:
+	RelayDirectory() = default;
+
+	// [application, stream name]
+	typedef std::pair<ov::String, ov::String> StreamKey;
+
+	void ThreadProc();
+
+	ov::String MakeHeader() const;
+	void Send(const ov::String &message);
+	// All the streams of this node (and the expired entries are removed)
+	void Announce();
+
+	void HandleAnnouncement(const ov::String &message, const ov::String &source_ip, int64_t now);
+
+	static int64_t GetCurrentTime();
+
+	ov::SocketAddress _group_address;
+	ov::String _advertise_ip;
+	int64_t _interval = 0;
+
+	int _socket_fd = -1;
+	// Identifies the announcements of this node
+	uint64_t _node_id = 0;
+
+	std::thread _thread;
+	std::atomic<bool> _stop { false };
+
+	mutable std::mutex _mutex;
+	// The streams of this node [value: origin port]
+	std::map<StreamKey, uint16_t> _local_streams;
+	// The streams of the other nodes [key: stream, value: [key: origin url, value: expiration time]]
+	std::map<StreamKey, std::map<ov::String, int64_t>> _remote_streams;
+	// The viewers of the streams on this node
+	std::map<StreamKey, size_t> _local_viewers;
+	// The viewers of the streams on the other nodes [key: stream, value: [key: node id, value: (viewers, expiration time)]]
+	std::map<StreamKey, std::map<ov::String, std::pair<size_t, int64_t>>> _remote_viewers;
+};
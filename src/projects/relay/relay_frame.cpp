@@ -0,0 +1,239 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "relay_frame.h"
+
+#include "relay_private.h"
+
+#include <base/ovsocket/socket.h>
+#include <base/media_route/media_buffer.h>
+
+// application_id(4) stream_id(4) data_length(4)
+#define RELAY_V2_FRAME_HEADER_SIZE                      12
+// media_type(1) track_id(4) pts(8) media_flags(1) fragment_count(1)
+#define RELAY_V2_PACKET_HEADER_SIZE                     15
+// offset(4) length(4) time_diff(2) pl_type(1)
+#define RELAY_V2_FRAGMENT_SIZE                          11
+
+static void WriteCommonHeader(ov::ByteStream &stream, const RelayPacket &header, uint8_t chunk_flags)
+{
+	stream.WriteBE16(RELAY_V2_MAGIC);
+	stream.Write8(RELAY_V2_VERSION);
+	stream.Write8(static_cast<uint8_t>(header.GetType()));
+	stream.Write8(chunk_flags);
+	stream.WriteBE32(header.GetTransactionId());
+}
+
+std::vector<std::shared_ptr<const ov::Data>> RelayFrameWriter::Serialize(const RelayPacket &header, const ov::Data *data)
+{
+	std::vector<std::shared_ptr<const ov::Data>> chunks;
+
+	auto payload = (data != nullptr) ? data->GetDataAs<uint8_t>() : nullptr;
+	size_t remained = (data != nullptr) ? data->GetLength() : 0;
+
+	// The first chunk
+	{
+		auto chunk = std::make_shared<ov::Data>(ov::MaxSrtPacketSize);
+		ov::ByteStream stream(chunk.get());
+
+		WriteCommonHeader(stream, header, RELAY_V2_CHUNK_FLAG_FIRST);
+
+		stream.WriteBE32(header.GetApplicationId());
+		stream.WriteBE32(header.GetStreamId());
+		stream.WriteBE32(static_cast<uint32_t>(remained));
+
+		if(header.GetType() == RelayPacketType::Packet)
+		{
+			const FragmentationHeader *frag_header = header.GetFragmentHeader();
+			auto fragment_count = std::min<uint16_t>(frag_header->fragmentation_vector_size, MAX_FRAG_COUNT);
+
+			stream.Write8(static_cast<uint8_t>(header.GetMediaType()));
+			stream.WriteBE32(header.GetTrackId());
+			stream.WriteBE64(header.GetPts());
+			stream.Write8(header.GetFlags());
+			stream.Write8(static_cast<uint8_t>(fragment_count));
+
+			for(uint16_t index = 0; index < fragment_count; index++)
+			{
+				stream.WriteBE32(static_cast<uint32_t>(frag_header->fragmentation_offset[index]));
+				stream.WriteBE32(static_cast<uint32_t>(frag_header->fragmentation_length[index]));
+				stream.WriteBE16(frag_header->fragmentation_time_diff[index]);
+				stream.Write8(frag_header->fragmentation_pl_type[index]);
+			}
+		}
+
+		size_t bytes = std::min(remained, ov::MaxSrtPacketSize - chunk->GetLength());
+
+		if(bytes > 0)
+		{
+			stream.Write(payload, bytes);
+			payload += bytes;
+			remained -= bytes;
+		}
+
+		chunks.push_back(chunk);
+	}
+
+	// Continuation chunks
+	while(remained > 0)
+	{
+		auto chunk = std::make_shared<ov::Data>(ov::MaxSrtPacketSize);
+		ov::ByteStream stream(chunk.get());
+
+		WriteCommonHeader(stream, header, 0);
+
+		size_t bytes = std::min<size_t>(remained, ov::MaxSrtPacketSize - RELAY_V2_COMMON_HEADER_SIZE);
+
+		stream.Write(payload, bytes);
+		payload += bytes;
+		remained -= bytes;
+
+		chunks.push_back(chunk);
+	}
+
+	return chunks;
+}
+
+bool RelayFrameAssembler::IsRelayFrame(const ov::DataView &chunk)
+{
+	if(chunk.GetLength() < RELAY_V2_COMMON_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	auto buffer = chunk.GetDataAs<uint8_t>();
+
+	return (ov::BE16ToHost(*reinterpret_cast<const uint16_t *>(buffer)) == RELAY_V2_MAGIC) && (buffer[2] == RELAY_V2_VERSION);
+}
+
+bool RelayFrameAssembler::Push(const ov::DataView &chunk, RelayFrame *frame)
+{
+	if(IsRelayFrame(chunk) == false)
+	{
+		return false;
+	}
+
+	// The chunk is parsed in place (nothing is allocated for the chunks, e.g. the records of the ring)
+	ov::Data chunk_data(chunk.GetData(), chunk.GetLength(), true);
+	ov::ByteStream stream(&chunk_data);
+
+	stream.Skip(3);
+	auto type = static_cast<RelayPacketType>(stream.Read8());
+	uint8_t chunk_flags = stream.Read8();
+	uint32_t transaction_id = stream.ReadBE32();
+
+	PendingFrame *pending = nullptr;
+
+	if(chunk_flags & RELAY_V2_CHUNK_FLAG_FIRST)
+	{
+		if(stream.IsRemained(RELAY_V2_FRAME_HEADER_SIZE) == false)
+		{
+			logte("Invalid relay frame: too short header (%zu bytes)", chunk.GetLength());
+			return false;
+		}
+
+		if((_pending_frames.size() >= RELAY_V2_MAX_PENDING_FRAMES) && (_pending_frames.find(transaction_id) == _pending_frames.end()))
+		{
+			// The rest of the oldest frame might be lost
+			logtw("Too many pending relay frames, dropping the frame #%u", _pending_frames.begin()->first);
+			_pending_frames.erase(_pending_frames.begin());
+		}
+
+		pending = &(_pending_frames[transaction_id]);
+		*pending = PendingFrame();
+
+		RelayFrame &pending_frame = pending->frame;
+
+		pending_frame.type = type;
+		pending_frame.transaction_id = transaction_id;
+		pending_frame.application_id = stream.ReadBE32();
+		pending_frame.stream_id = stream.ReadBE32();
+		pending->data_length = stream.ReadBE32();
+
+		if(type == RelayPacketType::Packet)
+		{
+			if(stream.IsRemained(RELAY_V2_PACKET_HEADER_SIZE) == false)
+			{
+				logte("Invalid relay frame: too short packet header (%zu bytes)", chunk.GetLength());
+				_pending_frames.erase(transaction_id);
+				return false;
+			}
+
+			pending_frame.media_type = static_cast<int8_t>(stream.Read8());
+			pending_frame.track_id = stream.ReadBE32();
+			pending_frame.pts = stream.ReadBE64();
+			pending_frame.flags = stream.Read8();
+
+			uint8_t fragment_count = stream.Read8();
+
+			if((fragment_count > MAX_FRAG_COUNT) || (stream.IsRemained(fragment_count * RELAY_V2_FRAGMENT_SIZE) == false))
+			{
+				logte("Invalid relay frame: invalid fragments (count: %d)", fragment_count);
+				_pending_frames.erase(transaction_id);
+				return false;
+			}
+
+			FragmentationHeader &frag_header = pending_frame.frag_header;
+
+			frag_header.fragmentation_vector_size = fragment_count;
+
+			for(uint8_t index = 0; index < fragment_count; index++)
+			{
+				frag_header.fragmentation_offset[index] = stream.ReadBE32();
+				frag_header.fragmentation_length[index] = stream.ReadBE32();
+				frag_header.fragmentation_time_diff[index] = stream.ReadBE16();
+				frag_header.fragmentation_pl_type[index] = stream.Read8();
+			}
+		}
+
+		// The buffer is allocated once with the length of the frame, and it becomes the data of the MediaPacket
+		pending_frame.data = std::make_shared<ov::Data>();
+		pending_frame.data->ReserveHeadroom(MEDIA_PACKET_HEADROOM, pending->data_length);
+	}
+	else
+	{
+		auto item = _pending_frames.find(transaction_id);
+
+		if(item == _pending_frames.end())
+		{
+			// The first chunk is lost (or dropped)
+			return false;
+		}
+
+		pending = &(item->second);
+	}
+
+	size_t remained = stream.Remained();
+
+	if((pending->frame.data->GetLength() + remained) > pending->data_length)
+	{
+		logte("Invalid relay frame: the frame #%u exceeds its length (%zu)", transaction_id, pending->data_length);
+		_pending_frames.erase(transaction_id);
+		return false;
+	}
+
+	if(remained > 0)
+	{
+		pending->frame.data->Append(chunk.GetDataAs<uint8_t>() + stream.GetOffset(), remained);
+	}
+
+	if(pending->frame.data->GetLength() < pending->data_length)
+	{
+		// Wait for the next chunk
+		return false;
+	}
+
+	*frame = std::move(pending->frame);
+	_pending_frames.erase(transaction_id);
+
+	return true;
+}
+
+void RelayFrameAssembler::Clear()
+{
+	_pending_frames.clear();
+}
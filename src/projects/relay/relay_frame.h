@@ -0,0 +1,92 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "relay_datastructure.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+// Relay protocol v2
+//
+// A frame (CreateStream, DeleteStream, Packet, ...) is sent as one or more SRT messages (chunks).
+// Unlike RelayPacket, the size of a chunk is variable (no padding), and the header of the frame is sent only once.
+//
+// [Every chunk]
+//   magic(2) | version(1) | type(1) | chunk_flags(1) | transaction_id(4)
+// [The first chunk of the frame]
+//   application_id(4) | stream_id(4) | data_length(4)
+//   (Packet only) media_type(1) | track_id(4) | pts(8) | media_flags(1) | fragment_count(1) | [offset(4) | length(4) | time_diff(2) | pl_type(1)] * fragment_count
+// [Payload]
+//   The rest of the chunk (up to ov::MaxSrtPacketSize)
+//
+// All the fields are big endian
+#define RELAY_V2_MAGIC                                  0x4F56
+#define RELAY_V2_VERSION                                2
+#define RELAY_V2_COMMON_HEADER_SIZE                     9
+// chunk_flags
+#define RELAY_V2_CHUNK_FLAG_FIRST                       0x01
+
+// Set to the flags of the Register packet (v1) when the client can receive the v2 frames
+// (The old servers ignore it and keep sending the RelayPackets)
+#define RELAY_REGISTER_FLAG_V2                          0x01
+
+// Frames which are being assembled at the same time (the oldest one is dropped when it is exceeded)
+#define RELAY_V2_MAX_PENDING_FRAMES                     64
+
+struct RelayFrame
+{
+	RelayPacketType type = RelayPacketType::Packet;
+	uint32_t transaction_id = 0;
+
+	// info::application_id_t
+	uint32_t application_id = 0;
+	// info::stream_id_t
+	uint32_t stream_id = 0;
+
+	// common::MediaType
+	int8_t media_type = 0;
+	uint32_t track_id = 0;
+	uint64_t pts = 0;
+	// MediaPacketFlag
+	uint8_t flags = 0;
+	FragmentationHeader frag_header;
+
+	std::shared_ptr<ov::Data> data;
+};
+
+class RelayFrameWriter
+{
+public:
+	// Splits the data into the chunks
+	// - The header fields are taken from the header packet (the payload of the packet is not used)
+	// - The result can be sent to several clients
+	static std::vector<std::shared_ptr<const ov::Data>> Serialize(const RelayPacket &header, const ov::Data *data);
+};
+
+class RelayFrameAssembler
+{
+public:
+	static bool IsRelayFrame(const ov::DataView &chunk);
+
+	// Returns true when the frame is completed (the frame is filled)
+	bool Push(const ov::DataView &chunk, RelayFrame *frame);
+
+	void Clear();
+
+protected:
+	struct PendingFrame
+	{
+		RelayFrame frame;
+		size_t data_length = 0;
+	};
+
+	// key: transaction id
+	std::map<uint32_t, PendingFrame> _pending_frames;
+};
@@ -13,6 +13,9 @@
 #include <media_router/media_router.h>
 #include <base/media_route/media_route_application_interface.h>
 #include <base/media_route/media_buffer.h>
+#include <base/application/stream_demand.h>
+
+#include <poll.h>
 
 RelayServer::RelayServer(MediaRouteApplicationInterface *media_route_application, const info::Application *application_info)
 	: _media_route_application(media_route_application),
@@ -42,7 +45,26 @@ RelayServer::RelayServer(MediaRouteApplicationInterface *media_route_application
 			if(_server_port != nullptr)
 			{
 				logti("Trying to start relay server on %s", address.ToString().CStr());
+				_io_thread = std::thread(&RelayServer::IoThreadProc, this);
 				_server_port->AddObserver(this);
+
+				// The relay clients on the same host receive the streams through the shared memory
+				auto socket_name = RelayShmChannel::GetSocketName(static_cast<uint16_t>(port), application_info->GetName());
+
+				if(_shm_listener.Listen(socket_name))
+				{
+					logti("Relay server for the clients on the same host is started: %s", socket_name.CStr());
+					_shm_thread = std::thread(&RelayServer::ShmThreadProc, this);
+				}
+
+				// Only the ingested streams are announced (the edges which re-export the streams would make loops)
+				auto &discovery = host->GetDiscovery();
+
+				if(discovery.IsParsed() && (application_info->GetType() == cfg::ApplicationType::Live) &&
+				   RelayDirectory::Instance()->Start(discovery))
+				{
+					_directory_port = static_cast<uint16_t>(port);
+				}
 			}
 			else
 			{
@@ -66,9 +88,31 @@ RelayServer::~RelayServer()
 	{
 		_server_port->RemoveObserver(this);
 	}
+
+	_stop_shm = true;
+
+	if(_shm_thread.joinable())
+	{
+		_shm_thread.join();
+	}
+
+	_shm_listener.Close();
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_io_mutex);
+
+		_stop_io = true;
+	}
+
+	_io_condition.notify_all();
+
+	if(_io_thread.joinable())
+	{
+		_io_thread.join();
+	}
 }
 
-void RelayServer::SendStream(const std::shared_ptr<ov::Socket> &remote, const std::shared_ptr<StreamInfo> &stream_info)
+void RelayServer::SendStream(const ClientLink *link, const std::shared_ptr<StreamInfo> &stream_info)
 {
 	if(_client_list.size() == 0)
 	{
@@ -107,10 +151,10 @@ void RelayServer::SendStream(const std::shared_ptr<ov::Socket> &remote, const st
 
 	RelayPacket response(RelayPacketType::CreateStream);
 
-	if(remote != nullptr)
+	if(link != nullptr)
 	{
 		// send to specific relay client
-		Send(remote, stream_info->GetId(), response, serialize.ToData().get());
+		Send(*link, stream_info->GetId(), response, serialize.ToData().get());
 	}
 	else
 	{
@@ -126,6 +170,11 @@ bool RelayServer::OnCreateStream(std::shared_ptr<StreamInfo> info)
 
 	SendStream(nullptr, info);
 
+	if(_directory_port > 0)
+	{
+		RelayDirectory::Instance()->AddStream(_application_info->GetName(), info->GetName(), _directory_port);
+	}
+
 	return true;
 }
 
@@ -134,17 +183,31 @@ bool RelayServer::OnDeleteStream(std::shared_ptr<StreamInfo> info)
 	// Notify to relay client
 	logtd("Stream is deleted: %u, %s", info->GetId(), info->GetName().CStr());
 
+	if(_directory_port > 0)
+	{
+		RelayDirectory::Instance()->RemoveStream(_application_info->GetName(), info->GetName(), _directory_port);
+	}
+
 	Send(info->GetId(), RelayPacket(RelayPacketType::DeleteStream), nullptr);
 
+	std::lock_guard<std::mutex> lock_guard(_client_list_mutex);
+
+	for(auto &client : _client_list)
+	{
+		std::lock_guard<std::mutex> queue_lock_guard(client.second->queue_mutex);
+
+		RemoveDemand(client.second.get(), info->GetId());
+	}
+
 	return true;
 }
 
-bool RelayServer::OnSendVideoFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrame> encoded_frame, std::unique_ptr<CodecSpecificInfo> codec_info, std::unique_ptr<FragmentationHeader> fragmentation)
+bool RelayServer::OnSendVideoFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrameDescriptor> frame)
 {
 	return true;
 }
 
-bool RelayServer::OnSendAudioFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrame> encoded_frame, std::unique_ptr<CodecSpecificInfo> codec_info, std::unique_ptr<FragmentationHeader> fragmentation)
+bool RelayServer::OnSendAudioFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrameDescriptor> frame)
 {
 	return true;
 }
@@ -158,12 +221,24 @@ void RelayServer::OnDataReceived(const std::shared_ptr<ov::Socket> &remote, cons
 {
 	logtd("Data received from %s: %zu bytes", remote->ToString().CStr(), data->GetLength());
 
-	RelayPacket packet(data.get());
+	ClientLink link;
+
+	link.socket = remote;
 
+	HandlePacket(link, RelayPacket(data.get()));
+}
+
+void RelayServer::HandlePacket(const ClientLink &link, const RelayPacket &packet)
+{
 	switch(packet.GetType())
 	{
 		case RelayPacketType::Register:
-			HandleRegister(remote, packet);
+			HandleRegister(link, packet);
+			break;
+
+		case RelayPacketType::Subscribe:
+		case RelayPacketType::Unsubscribe:
+			HandleSubscription(link, packet);
 			break;
 
 		default:
@@ -177,18 +252,34 @@ void RelayServer::OnDisconnected(const std::shared_ptr<ov::Socket> &remote, Phys
 {
 	logti("RelayClient is disconnected: %s (reason: %d)", remote->ToString().CStr(), reason);
 
+	RemoveClient(remote.get());
+}
+
+void RelayServer::RemoveClient(const void *key)
+{
 	// remove from _client_list
 	std::lock_guard<std::mutex> lock_guard(_client_list_mutex);
 
-	auto info_iter = _client_list.find(remote.get());
+	auto info_iter = _client_list.find(key);
 
 	if(info_iter != _client_list.end())
 	{
+		auto &client_info = info_iter->second;
+
+		{
+			std::lock_guard<std::mutex> queue_lock_guard(client_info->queue_mutex);
+
+			while(client_info->demanded_streams.empty() == false)
+			{
+				RemoveDemand(client_info.get(), client_info->demanded_streams.begin()->first);
+			}
+		}
+
 		_client_list.erase(info_iter);
 	}
 }
 
-void RelayServer::HandleRegister(const std::shared_ptr<ov::Socket> &remote, const RelayPacket &packet)
+void RelayServer::HandleRegister(const ClientLink &link, const RelayPacket &packet)
 {
 	// The relay client wants to be registered on this server for the application
 	ov::String app_name(reinterpret_cast<const char *>(packet.GetData()), packet.GetDataSize());
@@ -200,18 +291,31 @@ void RelayServer::HandleRegister(const std::shared_ptr<ov::Socket> &remote, cons
 		// TODO(dimiden): If multiple RelayServers use the same PhysicalPort, data from other servers can come in here
 		// This situation is not assumed at this time, and packet probe function should be added afterward
 
-		RelayPacket response(RelayPacketType::Error);
-		remote->Send(&response, sizeof(response));
+		link.SendResponse(RelayPacket(RelayPacketType::Error));
 
 		return;
 	}
 
-	logtd("Registering a relay client %s for application: %s", remote->ToString().CStr(), _application_info->GetName().CStr());
+	logtd("Registering a relay client %s for application: %s (protocol: v%d)", link.ToString().CStr(), _application_info->GetName().CStr(),
+	      OV_CHECK_FLAG(packet.GetFlags(), RELAY_REGISTER_FLAG_V2) ? RELAY_V2_VERSION : 1);
 
 	{
 		std::lock_guard<std::mutex> lock_guard(_client_list_mutex);
 
-		_client_list[remote.get()] = ClientInfo();
+		auto client_info = std::make_shared<ClientInfo>();
+
+		client_info->link = link;
+		client_info->use_v2 = OV_CHECK_FLAG(packet.GetFlags(), RELAY_REGISTER_FLAG_V2);
+		client_info->use_subscription = OV_CHECK_FLAG(packet.GetFlags(), RELAY_REGISTER_FLAG_SUBSCRIPTION);
+		client_info->is_data_only = client_info->use_subscription && OV_CHECK_FLAG(packet.GetFlags(), RELAY_REGISTER_FLAG_DATA_ONLY);
+
+		_client_list[link.GetKey()] = client_info;
+
+		if(client_info->is_data_only)
+		{
+			// The streams are sent to the first connection of the client
+			return;
+		}
 	}
 
 	// Send streams to the relay client
@@ -226,69 +330,524 @@ void RelayServer::HandleRegister(const std::shared_ptr<ov::Socket> &remote, cons
 	{
 		const auto &stream_info = stream_iter.second->GetStreamInfo();
 
-		SendStream(remote, stream_info);
+		SendStream(&link, stream_info);
 	}
 }
 
-void RelayServer::Send(info::stream_id_t stream_id, const RelayPacket &base_packet, const ov::Data *data)
+std::shared_ptr<const RelayServer::RelayChunks> RelayServer::SerializePackets(const RelayPacket &packet, const ov::Data *data)
 {
-	if(_client_list.empty())
-	{
-		// There is no client to send
-		return;
-	}
-
-	uint32_t transaction_id = _transaction_id++;
-
-	RelayPacket packet = base_packet;
-
-	packet.SetApplicationId(_application_info->GetId());
-	packet.SetStreamId(stream_id);
-	packet.SetTransactionId(transaction_id);
+	auto chunks = std::make_shared<RelayChunks>();
+	RelayPacket chunk_packet = packet;
 
-	packet.SetStart(true);
+	chunk_packet.SetStart(true);
 
 	if(data != nullptr)
 	{
+		// separate the data to multiple packets
 		ov::ByteStream stream(data);
 
 		while(stream.Remained() > 0)
 		{
-			size_t read_bytes = stream.Read(static_cast<uint8_t *>(packet.GetData()), RelayPacketDataSize);
-			packet.SetDataSize(static_cast<uint16_t>(read_bytes));
+			size_t read_bytes = stream.Read(static_cast<uint8_t *>(chunk_packet.GetData()), RelayPacketDataSize);
+			chunk_packet.SetDataSize(static_cast<uint16_t>(read_bytes));
 
 			if(stream.Remained() == 0)
 			{
-				packet.SetEnd(true);
+				chunk_packet.SetEnd(true);
 			}
 
+			chunks->push_back(std::make_shared<ov::Data>(&chunk_packet, sizeof(chunk_packet)));
+
+			chunk_packet.SetStart(false);
+		}
+	}
+	else
+	{
+		chunk_packet.SetEnd(true);
+
+		chunks->push_back(std::make_shared<ov::Data>(&chunk_packet, sizeof(chunk_packet)));
+	}
+
+	return chunks;
+}
+
+void RelayServer::Enqueue(ClientInfo *client_info, const RelayPacket &packet, const ov::Data *data,
+                          std::shared_ptr<const RelayChunks> *v1_chunks, std::shared_ptr<const RelayChunks> *v2_chunks)
+{
+	info::stream_id_t stream_id = packet.GetStreamId();
+
+	std::lock_guard<std::mutex> lock_guard(client_info->queue_mutex);
+
+	switch(packet.GetType())
+	{
+		case RelayPacketType::Packet:
+		{
+			if(client_info->use_subscription && (client_info->subscribed_streams.find(stream_id) == client_info->subscribed_streams.end()))
 			{
-				std::lock_guard<std::mutex> lock_guard(_client_list_mutex);
+				// Nobody watches the stream at the client
+				return;
+			}
+
+			bool is_key_frame = (packet.GetFlags() == static_cast<uint8_t>(MediaPacketFlag::Key));
+			auto dropping = client_info->dropping_streams.find(stream_id);
+
+			if((dropping != client_info->dropping_streams.end()) && (is_key_frame == false))
+			{
+				// Wait for the next key frame
+				client_info->dropped_frame_count++;
+				return;
+			}
+
+			size_t bytes = (data != nullptr) ? data->GetLength() : 0;
 
-				for(auto &client : _client_list)
+			if((client_info->queued_bytes + bytes) > RELAY_CLIENT_QUEUE_BUDGET)
+			{
+				if(dropping == client_info->dropping_streams.end())
 				{
-					client.first->Send(&packet, sizeof(packet));
+					logtw("The relay client %s falls behind (%zu bytes queued), dropping the packets of the stream #%u until the next key frame",
+					      client_info->link.ToString().CStr(), client_info->queued_bytes, stream_id);
+
+					client_info->dropping_streams.insert(stream_id);
 				}
+
+				client_info->dropped_frame_count++;
+				return;
+			}
+
+			if(dropping != client_info->dropping_streams.end())
+			{
+				logti("The relay client %s resumes the stream #%u from the key frame (%llu frames dropped so far)",
+				      client_info->link.ToString().CStr(), stream_id, client_info->dropped_frame_count);
+
+				client_info->dropping_streams.erase(dropping);
 			}
 
-			packet.SetStart(false);
+			break;
 		}
+
+		case RelayPacketType::DeleteStream:
+			client_info->subscribed_streams.erase(stream_id);
+			client_info->dropping_streams.erase(stream_id);
+
+			if(client_info->is_data_only)
+			{
+				return;
+			}
+			break;
+
+		case RelayPacketType::CreateStream:
+			if(client_info->is_data_only)
+			{
+				return;
+			}
+			break;
+
+		default:
+			// The control frames are always sent
+			break;
 	}
-	else
+
+	auto &chunks = client_info->use_v2 ? *v2_chunks : *v1_chunks;
+
+	if(chunks == nullptr)
 	{
-		packet.SetEnd(true);
+		chunks = client_info->use_v2 ? std::make_shared<RelayChunks>(RelayFrameWriter::Serialize(packet, data)) : SerializePackets(packet, data);
+	}
+
+	QueuedFrame frame;
+
+	frame.chunks = chunks;
+
+	for(auto &chunk : *chunks)
+	{
+		frame.bytes += chunk->GetLength();
+	}
+
+	client_info->queued_bytes += frame.bytes;
+	client_info->queue.push_back(std::move(frame));
+}
+
+void RelayServer::ClientLink::SendResponse(const RelayPacket &packet) const
+{
+	if(socket != nullptr)
+	{
+		socket->Send(&packet, sizeof(packet));
+		return;
+	}
+
+	if(shm_channel->Write(&packet, sizeof(packet)))
+	{
+		shm_channel->Notify();
+	}
+}
+
+bool RelayServer::SendChunk(const ClientLink &link, const std::shared_ptr<const ov::Data> &chunk)
+{
+	if(link.socket != nullptr)
+	{
+		link.socket->Send(chunk);
+		return true;
+	}
+
+	return link.shm_channel->Write(chunk->GetData(), chunk->GetLength());
+}
+
+bool RelayServer::Flush(ClientInfo *client_info, bool *is_blocked)
+{
+	auto &link = client_info->link;
+	size_t sent_bytes = 0;
+
+	*is_blocked = false;
+
+	while(sent_bytes < RELAY_CLIENT_FLUSH_QUANTUM)
+	{
+		int buffered_packets = 0;
+		int length = static_cast<int>(sizeof(buffered_packets));
+
+		if((link.socket != nullptr) &&
+		   link.socket->GetSockOpt(SRTO_SNDDATA, &buffered_packets, &length) && (buffered_packets >= RELAY_CLIENT_MAX_SRT_BUFFERED_PACKETS))
+		{
+			// Try again later not to block the other clients
+			*is_blocked = true;
+			break;
+		}
+
+		std::shared_ptr<const ov::Data> chunk;
+
+		{
+			std::lock_guard<std::mutex> lock_guard(client_info->queue_mutex);
+
+			if(client_info->queue.empty())
+			{
+				break;
+			}
+
+			// Only this thread removes the frames from the queue
+			auto &frame = client_info->queue.front();
+
+			chunk = frame.chunks->at(frame.sent_count);
+		}
+
+		if(SendChunk(link, chunk) == false)
+		{
+			// The ring is full, try again later
+			*is_blocked = true;
+			break;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock_guard(client_info->queue_mutex);
+
+			auto &frame = client_info->queue.front();
+
+			frame.sent_count++;
+
+			if(frame.sent_count == frame.chunks->size())
+			{
+				client_info->queued_bytes -= frame.bytes;
+				client_info->queue.pop_front();
+			}
+		}
+
+		sent_bytes += chunk->GetLength();
+		client_info->sent_meter.Add(chunk->GetLength());
+	}
+
+	if((link.shm_channel != nullptr) && (sent_bytes > 0))
+	{
+		// The client is woken up once for the chunks
+		link.shm_channel->Notify();
+	}
+
+	std::lock_guard<std::mutex> lock_guard(client_info->queue_mutex);
+
+	return (client_info->queue.empty() == false);
+}
+
+void RelayServer::IoThreadProc()
+{
+	std::vector<std::shared_ptr<ClientInfo>> clients;
+	bool has_ready_client = false;
+	bool has_blocked_client = false;
+
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_io_mutex);
+			auto predicate = [this]() -> bool {
+				return _io_pending || _stop_io;
+			};
+
+			if(has_ready_client == false)
+			{
+				if(has_blocked_client)
+				{
+					_io_condition.wait_for(lock, std::chrono::milliseconds(RELAY_IO_RETRY_INTERVAL), predicate);
+				}
+				else
+				{
+					_io_condition.wait(lock, predicate);
+				}
+			}
+
+			if(_stop_io)
+			{
+				break;
+			}
+
+			_io_pending = false;
+		}
+
+		clients.clear();
 
 		{
 			std::lock_guard<std::mutex> lock_guard(_client_list_mutex);
 
 			for(auto &client : _client_list)
 			{
-				client.first->Send(&packet, sizeof(packet));
+				clients.push_back(client.second);
 			}
 		}
+
+		has_ready_client = false;
+		has_blocked_client = false;
+
+		// The clients are flushed by turns (RELAY_CLIENT_FLUSH_QUANTUM)
+		for(auto &client : clients)
+		{
+			bool is_blocked;
+
+			if(Flush(client.get(), &is_blocked))
+			{
+				(is_blocked ? has_blocked_client : has_ready_client) = true;
+			}
+		}
+	}
+}
+
+void RelayServer::NotifyIoThread()
+{
+	{
+		std::lock_guard<std::mutex> lock_guard(_io_mutex);
+
+		_io_pending = true;
+	}
+
+	_io_condition.notify_one();
+}
+
+void RelayServer::ShmThreadProc()
+{
+	// Only this thread accesses the channels, the other threads access them through _client_list
+	std::vector<std::shared_ptr<RelayShmChannel>> channels;
+	std::vector<pollfd> fds;
+	// A byte more than RelayPacket, to find the longer packets
+	uint8_t buffer[sizeof(RelayPacket) + 1];
+
+	while(_stop_shm == false)
+	{
+		fds.clear();
+		fds.push_back({ _shm_listener.GetFd(), POLLIN, 0 });
+
+		for(auto &channel : channels)
+		{
+			fds.push_back({ channel->GetSocketFd(), POLLIN, 0 });
+		}
+
+		int result = ::poll(fds.data(), fds.size(), RELAY_SHM_POLL_INTERVAL);
+
+		if(result <= 0)
+		{
+			continue;
+		}
+
+		// The channels are iterated backward, so the disconnected one is removed from the vector
+		for(size_t index = channels.size(); index > 0; index--)
+		{
+			auto &channel = channels[index - 1];
+			auto revents = fds[index].revents;
+			bool is_disconnected = (revents & (POLLERR | POLLNVAL)) != 0;
+
+			if(revents & (POLLIN | POLLHUP))
+			{
+				ClientLink link;
+
+				link.shm_channel = channel;
+
+				while(true)
+				{
+					auto length = channel->ReceiveControl(buffer, sizeof(buffer));
+
+					if(length < 0)
+					{
+						break;
+					}
+
+					if(length == 0)
+					{
+						is_disconnected = true;
+						break;
+					}
+
+					if(static_cast<size_t>(length) != sizeof(RelayPacket))
+					{
+						logte("Invalid packet received from %s: %zd bytes", channel->ToString().CStr(), length);
+						continue;
+					}
+
+					ov::Data data(buffer, static_cast<size_t>(length), true);
+
+					HandlePacket(link, RelayPacket(&data));
+				}
+			}
+
+			if(is_disconnected)
+			{
+				logti("RelayClient is disconnected: %s", channel->ToString().CStr());
+
+				RemoveClient(channel.get());
+				channels.erase(channels.begin() + (index - 1));
+			}
+		}
+
+		if(fds[0].revents & POLLIN)
+		{
+			auto channel = _shm_listener.Accept();
+
+			if(channel == nullptr)
+			{
+				continue;
+			}
+
+			if(channels.size() >= RELAY_SHM_MAX_CLIENTS)
+			{
+				logtw("Too many relay clients on the same host (%zu), %s is rejected", channels.size(), channel->ToString().CStr());
+				continue;
+			}
+
+			logti("New RelayClient is connected: %s", channel->ToString().CStr());
+
+			channels.push_back(channel);
+		}
+	}
+
+	for(auto &channel : channels)
+	{
+		RemoveClient(channel.get());
+	}
+}
+
+void RelayServer::HandleSubscription(const ClientLink &link, const RelayPacket &packet)
+{
+	std::shared_ptr<ClientInfo> client_info;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_client_list_mutex);
+
+		auto client = _client_list.find(link.GetKey());
+
+		if(client == _client_list.end())
+		{
+			logtw("The relay client %s is not registered", link.ToString().CStr());
+			return;
+		}
+
+		client_info = client->second;
+	}
+
+	info::stream_id_t stream_id = packet.GetStreamId();
+	bool subscribe = (packet.GetType() == RelayPacketType::Subscribe);
+
+	logtd("The relay client %s %s the stream #%u", link.ToString().CStr(), subscribe ? "subscribes" : "unsubscribes", stream_id);
+
+	if(subscribe == false)
+	{
+		std::lock_guard<std::mutex> lock_guard(client_info->queue_mutex);
+
+		client_info->subscribed_streams.erase(stream_id);
+		client_info->dropping_streams.erase(stream_id);
+		RemoveDemand(client_info.get(), stream_id);
+
+		return;
+	}
+
+	// SendMediaPacket() is blocked while the GOP is replayed, so the live packets follow the cached packets
+	std::lock_guard<std::mutex> send_lock_guard(_send_media_mutex);
+
+	std::vector<std::shared_ptr<const MediaRouteGopPacket>> gop_cache;
+	ov::String stream_name;
+	auto stream = _media_route_application->GetStream(stream_id);
+
+	if(stream != nullptr)
+	{
+		gop_cache = stream->GetGopCache();
+		stream_name = stream->GetStreamInfo()->GetName();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock_guard(client_info->queue_mutex);
+
+		if(client_info->subscribed_streams.insert(stream_id).second == false)
+		{
+			// Already subscribed
+			return;
+		}
+
+		if(stream_name.IsEmpty() == false)
+		{
+			client_info->demanded_streams[stream_id] = stream_name;
+			StreamDemand::Instance()->AddSession(_application_info->GetId(), stream_name);
+		}
+
+		if(gop_cache.empty())
+		{
+			// The client can decode the stream from the key frame
+			client_info->dropping_streams.insert(stream_id);
+			return;
+		}
+	}
+
+	logtd("Replaying the GOP of the stream #%u (%zu packets) to %s", stream_id, gop_cache.size(), link.ToString().CStr());
+
+	for(auto &gop_packet : gop_cache)
+	{
+		auto relay_packet = CreateMediaPacket(gop_packet->media_type, gop_packet->track_id, gop_packet->pts, gop_packet->flags, &(gop_packet->frag_header));
+
+		Send(link, stream_id, relay_packet, gop_packet->data.get());
 	}
 }
 
+void RelayServer::Send(info::stream_id_t stream_id, const RelayPacket &base_packet, const ov::Data *data)
+{
+	if(_client_list.empty())
+	{
+		// There is no client to send
+		return;
+	}
+
+	uint32_t transaction_id = _transaction_id++;
+
+	RelayPacket packet = base_packet;
+
+	packet.SetApplicationId(_application_info->GetId());
+	packet.SetStreamId(stream_id);
+	packet.SetTransactionId(transaction_id);
+
+	std::shared_ptr<const RelayChunks> v1_chunks;
+	std::shared_ptr<const RelayChunks> v2_chunks;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_client_list_mutex);
+
+		for(auto &client : _client_list)
+		{
+			Enqueue(client.second.get(), packet, data, &v1_chunks, &v2_chunks);
+		}
+	}
+
+	NotifyIoThread();
+}
+
 void RelayServer::Send(info::stream_id_t stream_id, const RelayPacket &base_packet, const void *data, uint16_t data_size)
 {
 	if(_client_list.empty())
@@ -301,7 +860,7 @@ void RelayServer::Send(info::stream_id_t stream_id, const RelayPacket &base_pack
 	Send(stream_id, base_packet, &data_to_send);
 }
 
-void RelayServer::Send(const std::shared_ptr<ov::Socket> &socket, info::stream_id_t stream_id, const RelayPacket &base_packet, const ov::Data *data)
+void RelayServer::Send(const ClientLink &link, info::stream_id_t stream_id, const RelayPacket &base_packet, const ov::Data *data)
 {
 	uint32_t transaction_id = _transaction_id++;
 
@@ -311,38 +870,90 @@ void RelayServer::Send(const std::shared_ptr<ov::Socket> &socket, info::stream_i
 	packet.SetStreamId(stream_id);
 	packet.SetTransactionId(transaction_id);
 
-	packet.SetStart(true);
+	std::shared_ptr<const RelayChunks> v1_chunks;
+	std::shared_ptr<const RelayChunks> v2_chunks;
 
-	if(data != nullptr)
 	{
-		// separate the data to multiple packets
-		ov::ByteStream stream(data);
+		std::lock_guard<std::mutex> lock_guard(_client_list_mutex);
 
-		while(stream.Remained() > 0)
+		auto client = _client_list.find(link.GetKey());
+
+		if(client == _client_list.end())
 		{
-			size_t read_bytes = stream.Read(static_cast<uint8_t *>(packet.GetData()), RelayPacketDataSize);
-			packet.SetDataSize(static_cast<uint16_t>(read_bytes));
+			logtw("The relay client %s is not registered", link.ToString().CStr());
+			return;
+		}
 
-			if(stream.Remained() == 0)
-			{
-				packet.SetEnd(true);
-			}
+		Enqueue(client->second.get(), packet, data, &v1_chunks, &v2_chunks);
+	}
+
+	NotifyIoThread();
+}
 
-			socket->Send(&packet, sizeof(packet));
+void RelayServer::GetStatisticsData(std::vector<std::shared_ptr<RelayLinkStatisticsData>> &statistics)
+{
+	// The clients which don't use the subscription receive all the streams
+	size_t stream_count = _media_route_application->GetStreamCount();
 
-			packet.SetStart(false);
+	std::lock_guard<std::mutex> lock_guard(_client_list_mutex);
+
+	for(auto &client : _client_list)
+	{
+		auto &client_info = client.second;
+		auto data = std::make_shared<RelayLinkStatisticsData>();
+
+		data->app_name = _application_info->GetName();
+		data->role = "server";
+		data->remote = client_info->link.ToString();
+		data->is_connected = true;
+		data->total_bytes = client_info->sent_meter.GetTotalBytes();
+		data->bitrate = client_info->sent_meter.GetBitrate();
+
+		{
+			std::lock_guard<std::mutex> queue_lock_guard(client_info->queue_mutex);
+
+			data->stream_count = client_info->use_subscription ? client_info->subscribed_streams.size() : stream_count;
+			data->queued_bytes = client_info->queued_bytes;
+			data->queued_frames = client_info->queue.size();
+			data->dropped_frames = client_info->dropped_frame_count;
 		}
+
+		statistics.push_back(data);
 	}
-	else
-	{
-		packet.SetEnd(true);
+}
 
-		socket->Send(&packet, sizeof(packet));
+void RelayServer::RemoveDemand(ClientInfo *client_info, info::stream_id_t stream_id)
+{
+	auto demanded_stream = client_info->demanded_streams.find(stream_id);
+
+	if(demanded_stream != client_info->demanded_streams.end())
+	{
+		StreamDemand::Instance()->RemoveSession(_application_info->GetId(), demanded_stream->second);
+		client_info->demanded_streams.erase(demanded_stream);
 	}
 }
 
+RelayPacket RelayServer::CreateMediaPacket(common::MediaType media_type, int32_t track_id, int64_t pts, MediaPacketFlag flags, const FragmentationHeader *frag_header)
+{
+	RelayPacket relay_packet(RelayPacketType::Packet);
+
+	relay_packet.SetFragmentHeader(frag_header);
+
+	relay_packet.SetMediaType(static_cast<int8_t>(media_type));
+	relay_packet.SetTrackId(static_cast<uint32_t>(track_id));
+	relay_packet.SetPts(static_cast<uint64_t>(pts));
+	relay_packet.SetFlags(static_cast<uint8_t>(flags));
+
+	return relay_packet;
+}
+
 void RelayServer::SendMediaPacket(const std::shared_ptr<MediaRouteStream> &media_stream, const MediaPacket *packet)
 {
+	std::lock_guard<std::mutex> lock_guard(_send_media_mutex);
+
+	// The cache is updated with the lock, so HandleSubscription() neither misses the packet nor replays it twice
+	media_stream->CacheGopPacket(packet);
+
 	if(_client_list.empty())
 	{
 		// Nothing to do
@@ -350,16 +961,7 @@ void RelayServer::SendMediaPacket(const std::shared_ptr<MediaRouteStream> &media
 	}
 
 	auto stream_info = media_stream->GetStreamInfo();
-	auto media_track = stream_info->GetTrack(packet->GetTrackId());
-
-	RelayPacket relay_packet(RelayPacketType::Packet);
-
-	relay_packet.SetFragmentHeader(packet->_frag_hdr.get());
-
-	relay_packet.SetMediaType(static_cast<int8_t>(packet->GetMediaType()));
-	relay_packet.SetTrackId(static_cast<uint32_t>(packet->GetTrackId()));
-	relay_packet.SetPts(static_cast<uint64_t>(packet->GetPts()));
-	relay_packet.SetFlags(static_cast<uint8_t>(packet->GetFlags()));
+	auto relay_packet = CreateMediaPacket(packet->GetMediaType(), packet->GetTrackId(), packet->GetPts(), packet->GetFlags(), packet->_frag_hdr.get());
 
 	Send(stream_info->GetId(), relay_packet, packet->GetData().get());
 }
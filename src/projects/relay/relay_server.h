@@ -9,12 +9,36 @@
 #pragma once
 
 #include "relay_datastructure.h"
+#include "relay_directory.h"
+#include "relay_frame.h"
+#include "relay_shm.h"
+#include "relay_statistics.h"
 
 #include <base/ovsocket/socket.h>
 #include <base/application/application.h>
 #include <physical_port/physical_port_manager.h>
 #include <base/media_route/media_route_application_interface.h>
 #include <base/media_route/media_route_application_observer.h>
+#include <base/media_route/media_buffer.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <set>
+#include <thread>
+
+// Bytes which can be queued per relay client
+// - When it is exceeded, the media packets of the stream are dropped until the next key frame
+#define RELAY_CLIENT_QUEUE_BUDGET                       (4 * 1024 * 1024)
+// The client is skipped by the I/O thread while SRT has more packets than this in its send buffer
+// (so a slow client doesn't block the other clients)
+#define RELAY_CLIENT_MAX_SRT_BUFFERED_PACKETS           2048
+// Bytes which are sent to a client at once, before the I/O thread moves to the next client
+#define RELAY_CLIENT_FLUSH_QUANTUM                      (64 * 1024)
+// Interval (ms) of the I/O thread while a client is waiting for its SRT send buffer
+#define RELAY_IO_RETRY_INTERVAL                         5
+// Maximum number of the relay clients on the same host (RelayShmChannel)
+#define RELAY_SHM_MAX_CLIENTS                           64
 
 class MediaRouteStream;
 
@@ -26,23 +50,98 @@ public:
 
 	void Send(info::stream_id_t stream_id, const RelayPacket &base_packet, const ov::Data *data);
 	void Send(info::stream_id_t stream_id, const RelayPacket &base_packet, const void *data, uint16_t data_size);
-	void Send(const std::shared_ptr<ov::Socket> &remote, info::stream_id_t stream_id, const RelayPacket &base_packet, const ov::Data *data);
 	void SendMediaPacket(const std::shared_ptr<MediaRouteStream> &media_stream, const MediaPacket *packet);
 
+	// Collects the statistics of the connections from the edges
+	void GetStatisticsData(std::vector<std::shared_ptr<RelayLinkStatisticsData>> &statistics);
+
 protected:
+	typedef std::vector<std::shared_ptr<const ov::Data>> RelayChunks;
+
+	// A serialized frame, shared by the clients which use the same version
+	struct QueuedFrame
+	{
+		std::shared_ptr<const RelayChunks> chunks;
+		size_t bytes = 0;
+		// Index of the chunk to send next
+		size_t sent_count = 0;
+	};
+
+	// Connection of a relay client: SRT, or the shared memory of the client on the same host
+	struct ClientLink
+	{
+		std::shared_ptr<ov::Socket> socket;
+		std::shared_ptr<RelayShmChannel> shm_channel;
+
+		// Key of _client_list
+		const void *GetKey() const
+		{
+			return (socket != nullptr) ? static_cast<const void *>(socket.get()) : static_cast<const void *>(shm_channel.get());
+		}
+
+		ov::String ToString() const
+		{
+			return (socket != nullptr) ? socket->ToString() : shm_channel->ToString();
+		}
+
+		// Sends the response which is not queued (the client is not registered)
+		void SendResponse(const RelayPacket &packet) const;
+	};
+
 	struct ClientInfo
 	{
+		ClientLink link;
+
+		// The client can receive the v2 frames (RelayFrame)
+		bool use_v2 = false;
+		// The client receives the packets of the subscribed streams only
+		bool use_subscription = false;
+		// The connection doesn't receive the control frames (CreateStream, DeleteStream)
+		bool is_data_only = false;
+
+		// Accessed by the I/O thread
+		std::mutex queue_mutex;
+		std::deque<QueuedFrame> queue;
+		size_t queued_bytes = 0;
+		std::set<info::stream_id_t> subscribed_streams;
+		// Streams which are waiting for the key frame
+		std::set<info::stream_id_t> dropping_streams;
+		uint64_t dropped_frame_count = 0;
+
+		// Updated by the I/O thread
+		RelayRateMeter sent_meter;
+
+		// Subscribed streams which are counted as the sessions of StreamDemand
+		// (When this server is a mid-tier edge, its RelayClient pulls them from the origin on demand)
+		// [key: stream id, value: stream name]
+		std::map<info::stream_id_t, ov::String> demanded_streams;
 	};
 
-	void SendStream(const std::shared_ptr<ov::Socket> &remote, const std::shared_ptr<StreamInfo> &stream_info);
+	// Splits the data into the RelayPackets (v1)
+	static std::shared_ptr<const RelayChunks> SerializePackets(const RelayPacket &packet, const ov::Data *data);
+	// The chunks are serialized only once per version, and reused for the other clients
+	static void Enqueue(ClientInfo *client_info, const RelayPacket &packet, const ov::Data *data,
+	                    std::shared_ptr<const RelayChunks> *v1_chunks, std::shared_ptr<const RelayChunks> *v2_chunks);
+	// Sends the queued chunks up to RELAY_CLIENT_FLUSH_QUANTUM, returns true if the chunks are remained
+	// - is_blocked: the SRT send buffer (or the ring) of the client is full
+	static bool Flush(ClientInfo *client_info, bool *is_blocked);
+	// Returns false if the chunk cannot be sent now (the ring is full)
+	static bool SendChunk(const ClientLink &link, const std::shared_ptr<const ov::Data> &chunk);
+
+	void IoThreadProc();
+	void NotifyIoThread();
+
+	// link: nullptr to broadcast
+	void SendStream(const ClientLink *link, const std::shared_ptr<StreamInfo> &stream_info);
+	void Send(const ClientLink &link, info::stream_id_t stream_id, const RelayPacket &base_packet, const ov::Data *data);
 
 	//--------------------------------------------------------------------
 	// Implementation of MediaRouteApplicationObserver
 	//--------------------------------------------------------------------
 	bool OnCreateStream(std::shared_ptr<StreamInfo> info) override;
 	bool OnDeleteStream(std::shared_ptr<StreamInfo> info) override;
-	bool OnSendVideoFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrame> encoded_frame, std::unique_ptr<CodecSpecificInfo> codec_info, std::unique_ptr<FragmentationHeader> fragmentation) override;
-	bool OnSendAudioFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrame> encoded_frame, std::unique_ptr<CodecSpecificInfo> codec_info, std::unique_ptr<FragmentationHeader> fragmentation) override;
+	bool OnSendVideoFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrameDescriptor> frame) override;
+	bool OnSendAudioFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrameDescriptor> frame) override;
 
 	ObserverType GetObserverType() override
 	{
@@ -59,16 +158,48 @@ protected:
 	void OnDisconnected(const std::shared_ptr<ov::Socket> &remote, PhysicalPortDisconnectReason reason, const std::shared_ptr<const ov::Error> &error) override;
 	//--------------------------------------------------------------------
 
-	void HandleRegister(const std::shared_ptr<ov::Socket> &remote, const RelayPacket &packet);
+	// Handles the control packets of the client (SRT or RelayShmChannel)
+	void HandlePacket(const ClientLink &link, const RelayPacket &packet);
+	void HandleRegister(const ClientLink &link, const RelayPacket &packet);
+	// The newly subscribed client receives the GOP cache of the stream first (see MediaRouteStream::GetGopCache())
+	void HandleSubscription(const ClientLink &link, const RelayPacket &packet);
+	void RemoveClient(const void *key);
+
+	// Accepts the relay clients on the same host, and receives their control packets
+	void ShmThreadProc();
+
+	// client_info->queue_mutex must be locked
+	void RemoveDemand(ClientInfo *client_info, info::stream_id_t stream_id);
+
+	static RelayPacket CreateMediaPacket(common::MediaType media_type, int32_t track_id, int64_t pts, MediaPacketFlag flags, const FragmentationHeader *frag_header);
 
 	MediaRouteApplicationInterface *_media_route_application;
 
 	const info::Application *_application_info;
 	std::shared_ptr<PhysicalPort> _server_port;
 
+	// Serializes SendMediaPacket() and the replay of the GOP cache
+	std::mutex _send_media_mutex;
+
 	// All client list
 	std::mutex _client_list_mutex;
-	std::map<ov::Socket *, ClientInfo> _client_list;
+	// [key: ClientLink::GetKey()]
+	std::map<const void *, std::shared_ptr<ClientInfo>> _client_list;
+
+	// Flushes the queues of the clients
+	std::thread _io_thread;
+	std::mutex _io_mutex;
+	std::condition_variable _io_condition;
+	bool _io_pending = false;
+	bool _stop_io = false;
+
+	// The relay clients on the same host (see relay_shm.h)
+	RelayShmListener _shm_listener;
+	std::thread _shm_thread;
+	std::atomic<bool> _stop_shm { false };
 
 	uint32_t _transaction_id = 0;
+
+	// The streams are announced to the directory with this port (0: not announced, see RelayDirectory)
+	uint16_t _directory_port = 0;
 };
\ No newline at end of file
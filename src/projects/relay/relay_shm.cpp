@@ -0,0 +1,671 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "relay_shm.h"
+#include "relay_private.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <new>
+
+#ifndef MFD_CLOEXEC
+#	define MFD_CLOEXEC                                  0x0001U
+#endif
+#ifndef MFD_HUGETLB
+#	define MFD_HUGETLB                                  0x0004U
+#endif
+
+#define RELAY_SHM_RING_MAGIC                            0x4F565352
+#define RELAY_SHM_RECORD_HEADER_SIZE                    8
+// Length of the record which skips the rest of the ring
+#define RELAY_SHM_PADDING_RECORD                        0xFFFFFFFF
+// Timeout (ms) of the handshake of the client
+#define RELAY_SHM_CONNECT_TIMEOUT                       1000
+
+static inline uint64_t GetRecordSize(size_t length)
+{
+	return (RELAY_SHM_RECORD_HEADER_SIZE + length + 7) & ~static_cast<uint64_t>(7);
+}
+
+static bool MakeSocketAddress(const ov::String &socket_name, sockaddr_un *address, socklen_t *length)
+{
+	::memset(address, 0, sizeof(*address));
+
+	// Abstract namespace: sun_path[0] is NUL, so the socket file is not created
+	if((socket_name.GetLength() + 1) > sizeof(address->sun_path))
+	{
+		logte("Too long name of the relay socket: %s", socket_name.CStr());
+		return false;
+	}
+
+	address->sun_family = AF_UNIX;
+	::memcpy(address->sun_path + 1, socket_name.CStr(), socket_name.GetLength());
+
+	*length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + 1 + socket_name.GetLength());
+
+	return true;
+}
+
+//====================================================================================================
+// RelayShmRing
+//====================================================================================================
+RelayShmRing::~RelayShmRing()
+{
+	Release();
+}
+
+bool RelayShmRing::Create(size_t capacity)
+{
+	Release();
+
+	capacity = capacity & ~static_cast<size_t>(7);
+
+	size_t mapped_size = sizeof(Header) + capacity;
+
+	// The rest of the last huge page is used by the ring too (the capacity is still a multiple of 8)
+	if(ov::HugePages::IsEnabled() && CreateMemory(MFD_HUGETLB, ov::HugePages::Align(mapped_size)))
+	{
+		_is_hugetlb = true;
+		ov::HugePages::AddHugeTlbRegion(static_cast<int64_t>(_mapped_size));
+	}
+	else if(CreateMemory(0, mapped_size) == false)
+	{
+		return false;
+	}
+
+	capacity = _mapped_size - sizeof(Header);
+
+	_header = new(_memory) Header();
+	_header->magic = RELAY_SHM_RING_MAGIC;
+	_header->capacity = capacity;
+	_header->write_position = 0;
+	_header->read_position = 0;
+
+	_capacity = capacity;
+
+	return true;
+}
+
+bool RelayShmRing::CreateMemory(unsigned int flags, size_t mapped_size)
+{
+	// If it is not huge pages, the failure is logged
+	bool is_hugetlb = ((flags & MFD_HUGETLB) != 0);
+
+	// memfd_create() is not wrapped by the old glibc
+	_fd = static_cast<int>(::syscall(SYS_memfd_create, "OvenMediaEngine/Relay", MFD_CLOEXEC | flags));
+
+	if(_fd < 0)
+	{
+		if(is_hugetlb == false)
+		{
+			logte("Could not create the memfd of the relay ring: %s", ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		}
+
+		return false;
+	}
+
+	if(::ftruncate(_fd, static_cast<off_t>(mapped_size)) != 0)
+	{
+		if(is_hugetlb == false)
+		{
+			logte("Could not resize the relay ring to %zu bytes: %s", mapped_size, ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		}
+
+		Release();
+		return false;
+	}
+
+	// The huge pages are reserved by mmap(), so it fails if the pool doesn't have enough pages
+	if(Map(mapped_size, is_hugetlb == false) == false)
+	{
+		if(is_hugetlb)
+		{
+			logtd("The relay ring is not backed by the huge pages (%zu bytes), the normal pages are used", mapped_size);
+		}
+
+		Release();
+		return false;
+	}
+
+	return true;
+}
+
+bool RelayShmRing::Attach(int fd)
+{
+	Release();
+
+	_fd = fd;
+
+	struct stat file_stat;
+
+	if((::fstat(_fd, &file_stat) != 0) || (static_cast<size_t>(file_stat.st_size) <= sizeof(Header)))
+	{
+		logte("Invalid memfd of the relay ring");
+		Release();
+		return false;
+	}
+
+	size_t mapped_size = static_cast<size_t>(file_stat.st_size);
+
+	if(Map(mapped_size, true) == false)
+	{
+		Release();
+		return false;
+	}
+
+	_header = static_cast<Header *>(_memory);
+
+	if((_header->magic != RELAY_SHM_RING_MAGIC) || (_header->capacity != (mapped_size - sizeof(Header))) || ((_header->capacity % 8) != 0))
+	{
+		logte("Invalid header of the relay ring (magic: %08X, capacity: %llu)", _header->magic, static_cast<unsigned long long>(_header->capacity));
+		Release();
+		return false;
+	}
+
+	_capacity = _header->capacity;
+
+	return true;
+}
+
+bool RelayShmRing::Map(size_t mapped_size, bool log_error)
+{
+	void *memory = ::mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+
+	if(memory == MAP_FAILED)
+	{
+		if(log_error)
+		{
+			logte("Could not map the relay ring (%zu bytes): %s", mapped_size, ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		}
+
+		return false;
+	}
+
+	_memory = memory;
+	_mapped_size = mapped_size;
+	_data = static_cast<uint8_t *>(_memory) + sizeof(Header);
+
+	return true;
+}
+
+void RelayShmRing::Release()
+{
+	if(_memory != nullptr)
+	{
+		::munmap(_memory, _mapped_size);
+		_memory = nullptr;
+
+		if(_is_hugetlb)
+		{
+			ov::HugePages::AddHugeTlbRegion(-static_cast<int64_t>(_mapped_size));
+		}
+	}
+
+	_is_hugetlb = false;
+
+	if(_fd >= 0)
+	{
+		::close(_fd);
+		_fd = -1;
+	}
+
+	_mapped_size = 0;
+	_header = nullptr;
+	_data = nullptr;
+	_capacity = 0;
+	_peeked_size = 0;
+	_is_broken = false;
+}
+
+bool RelayShmRing::Write(const void *data, size_t length)
+{
+	if(_header == nullptr)
+	{
+		return false;
+	}
+
+	uint64_t record_size = GetRecordSize(length);
+	// Only the writer updates write_position
+	uint64_t write_position = _header->write_position.load(std::memory_order_relaxed);
+	uint64_t read_position = _header->read_position.load(std::memory_order_acquire);
+	uint64_t offset = write_position % _capacity;
+	uint64_t contiguous_size = _capacity - offset;
+	// The record is written from the beginning of the ring if it doesn't fit in the rest
+	uint64_t padding_size = (contiguous_size < record_size) ? contiguous_size : 0;
+
+	if((record_size + padding_size) > (_capacity - (write_position - read_position)))
+	{
+		return false;
+	}
+
+	if(padding_size > 0)
+	{
+		// The rest is at least 8 bytes (the records are aligned)
+		*reinterpret_cast<uint32_t *>(_data + offset) = RELAY_SHM_PADDING_RECORD;
+
+		write_position += padding_size;
+		offset = 0;
+	}
+
+	*reinterpret_cast<uint32_t *>(_data + offset) = static_cast<uint32_t>(length);
+	::memcpy(_data + offset + RELAY_SHM_RECORD_HEADER_SIZE, data, length);
+
+	// The reader sees the record after it is written
+	_header->write_position.store(write_position + record_size, std::memory_order_release);
+
+	return true;
+}
+
+const uint8_t *RelayShmRing::Peek(size_t *length)
+{
+	if((_header == nullptr) || _is_broken)
+	{
+		return nullptr;
+	}
+
+	while(true)
+	{
+		// Only the reader updates read_position
+		uint64_t read_position = _header->read_position.load(std::memory_order_relaxed);
+		uint64_t write_position = _header->write_position.load(std::memory_order_acquire);
+
+		if(read_position == write_position)
+		{
+			return nullptr;
+		}
+
+		uint64_t offset = read_position % _capacity;
+		uint32_t record_length = *reinterpret_cast<const uint32_t *>(_data + offset);
+
+		if(record_length == RELAY_SHM_PADDING_RECORD)
+		{
+			_header->read_position.store(read_position + (_capacity - offset), std::memory_order_release);
+			continue;
+		}
+
+		uint64_t record_size = GetRecordSize(record_length);
+
+		if((record_size > (_capacity - offset)) || (record_size > (write_position - read_position)))
+		{
+			logte("Invalid record of the relay ring (length: %u, offset: %llu)", record_length, static_cast<unsigned long long>(offset));
+			_is_broken = true;
+			return nullptr;
+		}
+
+		_peeked_size = record_size;
+		*length = record_length;
+
+		return _data + offset + RELAY_SHM_RECORD_HEADER_SIZE;
+	}
+}
+
+void RelayShmRing::Pop()
+{
+	if((_header == nullptr) || (_peeked_size == 0))
+	{
+		return;
+	}
+
+	// The writer can overwrite the record after this
+	_header->read_position.store(_header->read_position.load(std::memory_order_relaxed) + _peeked_size, std::memory_order_release);
+	_peeked_size = 0;
+}
+
+//====================================================================================================
+// RelayShmChannel
+//====================================================================================================
+RelayShmChannel::~RelayShmChannel()
+{
+	Close();
+}
+
+ov::String RelayShmChannel::GetSocketName(uint16_t port, const ov::String &application)
+{
+	return ov::String::FormatString("OvenMediaEngine/Relay/%u/%s", port, application.CStr());
+}
+
+bool RelayShmChannel::Open(int socket_fd)
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	_socket_fd = socket_fd;
+
+	// Only the processes of the same user can receive the streams
+	ucred credential {};
+	socklen_t credential_length = sizeof(credential);
+
+	if(::getsockopt(_socket_fd, SOL_SOCKET, SO_PEERCRED, &credential, &credential_length) != 0)
+	{
+		logte("Could not get the credential of the relay client: %s", ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		return false;
+	}
+
+	if(credential.uid != ::geteuid())
+	{
+		logte("The relay client (pid: %d, uid: %u) is not allowed", credential.pid, credential.uid);
+		return false;
+	}
+
+	_peer_pid = credential.pid;
+
+	if(_ring.Create(RELAY_SHM_RING_SIZE) == false)
+	{
+		return false;
+	}
+
+	_event_fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+	if(_event_fd < 0)
+	{
+		logte("Could not create the eventfd of the relay ring: %s", ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		return false;
+	}
+
+	// Passes the memfd and the eventfd to the client
+	int fds[2] = { _ring.GetFd(), _event_fd };
+	uint8_t payload = 0;
+	alignas(cmsghdr) uint8_t control[CMSG_SPACE(sizeof(fds))] {};
+	iovec vector { &payload, sizeof(payload) };
+	msghdr message {};
+
+	message.msg_iov = &vector;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	auto control_message = CMSG_FIRSTHDR(&message);
+
+	control_message->cmsg_level = SOL_SOCKET;
+	control_message->cmsg_type = SCM_RIGHTS;
+	control_message->cmsg_len = CMSG_LEN(sizeof(fds));
+	::memcpy(CMSG_DATA(control_message), fds, sizeof(fds));
+
+	if(::sendmsg(_socket_fd, &message, MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(payload)))
+	{
+		logte("Could not pass the relay ring to the client (pid: %d): %s", _peer_pid, ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		return false;
+	}
+
+	return true;
+}
+
+bool RelayShmChannel::Connect(const ov::String &socket_name)
+{
+	Close();
+
+	sockaddr_un address;
+	socklen_t address_length;
+
+	if(MakeSocketAddress(socket_name, &address, &address_length) == false)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	_socket_fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+
+	if(_socket_fd < 0)
+	{
+		logte("Could not create the relay socket: %s", ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		return false;
+	}
+
+	timeval timeout { RELAY_SHM_CONNECT_TIMEOUT / 1000, (RELAY_SHM_CONNECT_TIMEOUT % 1000) * 1000 };
+
+	::setsockopt(_socket_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	if(::connect(_socket_fd, reinterpret_cast<const sockaddr *>(&address), address_length) != 0)
+	{
+		// The server is not started yet (it is logged by the caller)
+		::close(_socket_fd);
+		_socket_fd = -1;
+		return false;
+	}
+
+	int fds[2] = { -1, -1 };
+	uint8_t payload = 0;
+	alignas(cmsghdr) uint8_t control[CMSG_SPACE(sizeof(fds))] {};
+	iovec vector { &payload, sizeof(payload) };
+	msghdr message {};
+
+	message.msg_iov = &vector;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	ssize_t received = ::recvmsg(_socket_fd, &message, MSG_CMSG_CLOEXEC);
+	auto control_message = CMSG_FIRSTHDR(&message);
+
+	if((received <= 0) || (control_message == nullptr) ||
+	   (control_message->cmsg_type != SCM_RIGHTS) || (control_message->cmsg_len != CMSG_LEN(sizeof(fds))))
+	{
+		logte("Could not receive the relay ring from %s", socket_name.CStr());
+		::close(_socket_fd);
+		_socket_fd = -1;
+		return false;
+	}
+
+	::memcpy(fds, CMSG_DATA(control_message), sizeof(fds));
+
+	_event_fd = fds[1];
+
+	if(_ring.Attach(fds[0]) == false)
+	{
+		::close(_event_fd);
+		_event_fd = -1;
+		::close(_socket_fd);
+		_socket_fd = -1;
+		return false;
+	}
+
+	return true;
+}
+
+void RelayShmChannel::Close()
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	if(_socket_fd >= 0)
+	{
+		::close(_socket_fd);
+		_socket_fd = -1;
+	}
+
+	if(_event_fd >= 0)
+	{
+		::close(_event_fd);
+		_event_fd = -1;
+	}
+
+	std::lock_guard<std::mutex> write_lock_guard(_write_mutex);
+
+	_ring.Release();
+}
+
+bool RelayShmChannel::Write(const void *data, size_t length)
+{
+	std::lock_guard<std::mutex> lock_guard(_write_mutex);
+
+	return _ring.Write(data, length);
+}
+
+void RelayShmChannel::Notify()
+{
+	uint64_t value = 1;
+
+	// EAGAIN: the counter is not read yet, the client is woken up anyway
+	if(::write(_event_fd, &value, sizeof(value)) < 0)
+	{
+		logtd("Could not signal the relay client (pid: %d): %s", _peer_pid, ov::Error::CreateErrorFromErrno()->ToString().CStr());
+	}
+}
+
+ssize_t RelayShmChannel::ReceiveControl(void *buffer, size_t length)
+{
+	ssize_t received = ::recv(_socket_fd, buffer, length, MSG_DONTWAIT);
+
+	if(received < 0)
+	{
+		return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ? -1 : 0;
+	}
+
+	return received;
+}
+
+bool RelayShmChannel::SendControl(const void *data, size_t length)
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	if(_socket_fd < 0)
+	{
+		return false;
+	}
+
+	return ::send(_socket_fd, data, length, MSG_NOSIGNAL) == static_cast<ssize_t>(length);
+}
+
+bool RelayShmChannel::Wait(int timeout)
+{
+	if(_ring.IsBroken())
+	{
+		return false;
+	}
+
+	// The server doesn't send anything over the socket after the handshake, so it is readable only when it is closed
+	pollfd fds[2] = {
+		{ _event_fd, POLLIN, 0 },
+		{ _socket_fd, POLLIN, 0 }
+	};
+
+	int result = ::poll(fds, 2, timeout);
+
+	if(result < 0)
+	{
+		return (errno == EINTR);
+	}
+
+	if(fds[1].revents != 0)
+	{
+		return false;
+	}
+
+	if(fds[0].revents & POLLIN)
+	{
+		uint64_t value;
+
+		// Resets the counter, the ring is read until it is empty
+		if(::read(_event_fd, &value, sizeof(value)) < 0)
+		{
+			logtd("Could not read the eventfd of the relay ring: %s", ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		}
+	}
+
+	return true;
+}
+
+ov::DataView RelayShmChannel::Peek()
+{
+	size_t length = 0;
+	auto record = _ring.Peek(&length);
+
+	if(record == nullptr)
+	{
+		return ov::DataView();
+	}
+
+	return ov::DataView(record, length);
+}
+
+void RelayShmChannel::Pop()
+{
+	_ring.Pop();
+}
+
+ov::String RelayShmChannel::ToString() const
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	return ov::String::FormatString("<RelayShmChannel: %p, #%d, pid: %d>", this, _socket_fd, _peer_pid);
+}
+
+//====================================================================================================
+// RelayShmListener
+//====================================================================================================
+RelayShmListener::~RelayShmListener()
+{
+	Close();
+}
+
+bool RelayShmListener::Listen(const ov::String &socket_name)
+{
+	sockaddr_un address;
+	socklen_t address_length;
+
+	if(MakeSocketAddress(socket_name, &address, &address_length) == false)
+	{
+		return false;
+	}
+
+	_socket_fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+
+	if(_socket_fd < 0)
+	{
+		logte("Could not create the relay socket: %s", ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		return false;
+	}
+
+	if((::bind(_socket_fd, reinterpret_cast<const sockaddr *>(&address), address_length) != 0) ||
+	   (::listen(_socket_fd, SOMAXCONN) != 0))
+	{
+		logte("Could not listen to the relay socket %s: %s", socket_name.CStr(), ov::Error::CreateErrorFromErrno()->ToString().CStr());
+		Close();
+		return false;
+	}
+
+	_socket_name = socket_name;
+
+	return true;
+}
+
+void RelayShmListener::Close()
+{
+	if(_socket_fd >= 0)
+	{
+		::close(_socket_fd);
+		_socket_fd = -1;
+	}
+}
+
+std::shared_ptr<RelayShmChannel> RelayShmListener::Accept()
+{
+	int socket_fd = ::accept4(_socket_fd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+
+	if(socket_fd < 0)
+	{
+		return nullptr;
+	}
+
+	auto channel = std::make_shared<RelayShmChannel>();
+
+	// The socket is closed by the channel
+	if(channel->Open(socket_fd) == false)
+	{
+		return nullptr;
+	}
+
+	return channel;
+}
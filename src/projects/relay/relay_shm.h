@@ -0,0 +1,177 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <atomic>
+#include <mutex>
+
+// Relay over the shared memory (the server and the client on the same host)
+//
+// - The client connects to the unix domain socket (SOCK_SEQPACKET, abstract namespace) of the server.
+//   The name of the socket is made of the origin port and the name of the application
+// - The server creates a ring (memfd) and an eventfd per connection, and passes them to the client with SCM_RIGHTS
+// - The chunks of the frames (the same as SRT) are written to the ring by the server, and the eventfd is signaled.
+//   The client reads the chunks from the mapped ring, so the frames don't go through the kernel
+// - The control packets of the client (Register, Subscribe, Unsubscribe) are sent over the socket,
+//   and the closed socket means the disconnection
+#define RELAY_SHM_RING_SIZE                             (8 * 1024 * 1024)
+// Timeout (ms) of the poll, to check whether the thread is stopped
+#define RELAY_SHM_POLL_INTERVAL                         100
+#define RELAY_SHM_SCHEME                                "SHM"
+
+// A ring of the records in a memfd (a writer and a reader, each in its own process)
+// - Record: length(4) | reserved(4) | data, aligned to 8 bytes
+// - The memfd is made of the huge pages (MFD_HUGETLB) if ov::HugePages is enabled and the pool has enough pages
+// - A record is not wrapped around, the rest of the ring is skipped by the padding record instead
+class RelayShmRing
+{
+public:
+	RelayShmRing() = default;
+	~RelayShmRing();
+
+	// Creates the memfd (writer)
+	bool Create(size_t capacity);
+	// Maps the memfd which is created by the writer (reader), the ring owns the fd
+	bool Attach(int fd);
+	void Release();
+
+	int GetFd() const
+	{
+		return _fd;
+	}
+
+	// Returns false if there is no room for the record (nothing is written)
+	bool Write(const void *data, size_t length);
+
+	// Returns the next record (nullptr: empty), which is valid until Pop()
+	const uint8_t *Peek(size_t *length);
+	void Pop();
+
+	// The reader found an invalid record
+	bool IsBroken() const
+	{
+		return _is_broken;
+	}
+
+private:
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t reserved;
+		uint64_t capacity;
+
+		// The positions are increased monotonically (offset = position % capacity)
+		// (std::atomic<uint64_t> is lock-free on the platforms which have memfd, so it works across the processes)
+		alignas(64) std::atomic<uint64_t> write_position;
+		alignas(64) std::atomic<uint64_t> read_position;
+	};
+
+	// Creates the memfd of mapped_size with the flags of memfd_create() (e.g. MFD_HUGETLB)
+	bool CreateMemory(unsigned int flags, size_t mapped_size);
+	bool Map(size_t mapped_size, bool log_error);
+
+	int _fd = -1;
+	void *_memory = nullptr;
+	size_t _mapped_size = 0;
+	// Mapped from the huge page pool (writer only)
+	bool _is_hugetlb = false;
+
+	Header *_header = nullptr;
+	uint8_t *_data = nullptr;
+	uint64_t _capacity = 0;
+
+	// Size of the record which is returned by Peek()
+	size_t _peeked_size = 0;
+	bool _is_broken = false;
+};
+
+// A connection between the relay server and a relay client on the same host
+// - Server: Open() with the accepted socket, Write() the chunks, Notify() the client, and ReceiveControl()
+// - Client: Connect(), SendControl(), and Wait()/Peek()/Pop() the chunks
+class RelayShmChannel
+{
+public:
+	RelayShmChannel() = default;
+	~RelayShmChannel();
+
+	// Name of the socket of the relay server for the application
+	static ov::String GetSocketName(uint16_t port, const ov::String &application);
+
+	// Server: creates the ring, and passes it to the client
+	bool Open(int socket_fd);
+	// Client
+	bool Connect(const ov::String &socket_name);
+	void Close();
+
+	int GetSocketFd() const
+	{
+		return _socket_fd;
+	}
+
+	//--------------------------------------------------------------------
+	// Server
+	//--------------------------------------------------------------------
+	// Returns false if the ring is full
+	bool Write(const void *data, size_t length);
+	// Wakes the client up after the chunks are written
+	void Notify();
+	// Returns the length of the control packet (0: disconnected, -1: nothing to receive)
+	ssize_t ReceiveControl(void *buffer, size_t length);
+
+	//--------------------------------------------------------------------
+	// Client
+	//--------------------------------------------------------------------
+	bool SendControl(const void *data, size_t length);
+	// Returns false if the server is disconnected
+	bool Wait(int timeout);
+	// The view refers to the ring (valid until Pop(), empty if there is no record)
+	ov::DataView Peek();
+	void Pop();
+
+	ov::String ToString() const;
+
+private:
+	// Close() and SendControl() can be called by the other threads
+	mutable std::mutex _mutex;
+	int _socket_fd = -1;
+	int _event_fd = -1;
+	// Process of the client (server only)
+	pid_t _peer_pid = 0;
+
+	std::mutex _write_mutex;
+	RelayShmRing _ring;
+};
+
+// Accepts the relay clients on the same host
+class RelayShmListener
+{
+public:
+	~RelayShmListener();
+
+	bool Listen(const ov::String &socket_name);
+	void Close();
+
+	int GetFd() const
+	{
+		return _socket_fd;
+	}
+
+	// Returns nullptr if the client cannot be accepted
+	std::shared_ptr<RelayShmChannel> Accept();
+
+	const ov::String &GetSocketName() const
+	{
+		return _socket_name;
+	}
+
+private:
+	int _socket_fd = -1;
+	ov::String _socket_name;
+};
@@ -0,0 +1,37 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "relay_statistics.h"
+
+uint64_t RelayRateMeter::GetBitrate()
+{
+	std::lock_guard<std::mutex> lock_guard(_sample_mutex);
+
+	auto current_time = std::chrono::steady_clock::now();
+	uint64_t total_bytes = GetTotalBytes();
+
+	if(_sampled == false)
+	{
+		_sampled = true;
+	}
+	else
+	{
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(current_time - _sample_time).count();
+
+		if(elapsed < RELAY_STATISTICS_SAMPLE_INTERVAL)
+		{
+			return _bitrate;
+		}
+
+		_bitrate = (total_bytes - _sample_bytes) * 8ULL * 1000ULL / static_cast<uint64_t>(elapsed);
+	}
+
+	_sample_time = current_time;
+	_sample_bytes = total_bytes;
+
+	return _bitrate;
+}
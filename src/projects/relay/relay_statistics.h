@@ -0,0 +1,87 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+// The rate is sampled when it is requested, but at most once in this interval (ms)
+#define RELAY_STATISTICS_SAMPLE_INTERVAL                1000
+
+// Statistics of a relay connection (for monitoring)
+struct RelayLinkStatisticsData
+{
+	ov::String app_name;
+	// "server": a connection from an edge, "client": a connection (lane) to an origin
+	ov::String role;
+	ov::String remote;
+	// Index of the lane (client only)
+	size_t lane = 0;
+	bool is_connected = false;
+	// Streams which are sent (server) or received (client) through the connection
+	size_t stream_count = 0;
+	// Frames which are waiting to be sent (server only)
+	size_t queued_bytes = 0;
+	size_t queued_frames = 0;
+	// Bytes which are sent (server) or received (client), and the rate of them (bps)
+	uint64_t total_bytes = 0;
+	uint64_t bitrate = 0;
+	// Frames which are dropped because the edge falls behind (server only)
+	uint64_t dropped_frames = 0;
+	// Reconnections to the origin (client only)
+	uint64_t reconnect_count = 0;
+};
+
+// Statistics of a stream which is received from an origin (for monitoring)
+struct RelayStreamStatisticsData
+{
+	ov::String app_name;
+	ov::String stream_name;
+	// Empty if the stream is not subscribed
+	ov::String origin;
+	size_t lane = 0;
+	uint64_t received_frames = 0;
+	uint64_t bitrate = 0;
+	// Delay (ms) added on the way from the origin: (arrival time - pts) minus the minimum of it since the stream is subscribed
+	// (The clocks of the origin and the edge don't need to be synchronized)
+	int64_t lag = 0;
+	// The maximum lag since the last request
+	int64_t max_lag = 0;
+	// The stream is moved to another origin
+	uint64_t origin_switch_count = 0;
+};
+
+// Counts the bytes (thread-safe)
+class RelayRateMeter
+{
+public:
+	void Add(size_t bytes)
+	{
+		_total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	uint64_t GetTotalBytes() const
+	{
+		return _total_bytes.load(std::memory_order_relaxed);
+	}
+
+	// bps between the two last samples
+	uint64_t GetBitrate();
+
+protected:
+	std::atomic<uint64_t> _total_bytes { 0 };
+
+	std::mutex _sample_mutex;
+	bool _sampled = false;
+	std::chrono::steady_clock::time_point _sample_time;
+	uint64_t _sample_bytes = 0;
+	uint64_t _bitrate = 0;
+};
@@ -0,0 +1,33 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "replay_application.h"
+
+#define OV_LOG_TAG "ReplayApplication"
+
+std::shared_ptr<ReplayStream> ReplayStream::Create()
+{
+	return std::make_shared<ReplayStream>();
+}
+
+std::shared_ptr<ReplayApplication> ReplayApplication::Create(const info::Application *application_info)
+{
+	auto application = std::make_shared<ReplayApplication>(application_info);
+	return application;
+}
+
+ReplayApplication::ReplayApplication(const info::Application *application_info)
+	: Application(application_info)
+{
+}
+
+std::shared_ptr<pvd::Stream> ReplayApplication::OnCreateStream()
+{
+	logtd("OnCreateStream");
+
+	return ReplayStream::Create();
+}
@@ -0,0 +1,41 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "base/common_types.h"
+
+#include "base/provider/application.h"
+#include "base/provider/stream.h"
+
+//====================================================================================================
+// ReplayStream
+// - The tracks are copied from the capture
+//====================================================================================================
+class ReplayStream : public pvd::Stream
+{
+public:
+	static std::shared_ptr<ReplayStream> Create();
+
+	ReplayStream() = default;
+	~ReplayStream() final = default;
+};
+
+//====================================================================================================
+// ReplayApplication
+//====================================================================================================
+class ReplayApplication : public pvd::Application
+{
+public:
+	static std::shared_ptr<ReplayApplication> Create(const info::Application *application_info);
+
+	explicit ReplayApplication(const info::Application *info);
+	~ReplayApplication() override = default;
+
+public:
+	std::shared_ptr<pvd::Stream> OnCreateStream() override;
+};
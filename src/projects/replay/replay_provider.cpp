@@ -0,0 +1,280 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include <config/config.h>
+
+#include "replay_provider.h"
+#include "replay_application.h"
+
+#include <algorithm>
+
+#define OV_LOG_TAG "ReplayProvider"
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<ReplayProvider> ReplayProvider::Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+{
+	auto provider = std::make_shared<ReplayProvider>(application_info, router);
+
+	if(provider->Start() == false)
+	{
+		return nullptr;
+	}
+
+	return provider;
+}
+
+//====================================================================================================
+// ReplayProvider
+//====================================================================================================
+ReplayProvider::ReplayProvider(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+	: Provider(application_info, router)
+{
+	logtd("Created Replay Provider modules.");
+}
+
+//====================================================================================================
+// ~ReplayProvider
+//====================================================================================================
+ReplayProvider::~ReplayProvider()
+{
+	Stop();
+	logtd("Terminated Replay Provider modules.");
+}
+
+//====================================================================================================
+// Start
+// - The captures are opened before the application is started, so an invalid capture fails the provider
+//====================================================================================================
+bool ReplayProvider::Start()
+{
+	_provider_info = _application_info->GetProvider<cfg::ReplayProvider>();
+
+	if((_provider_info == nullptr) || (_provider_info->IsParsed() == false))
+	{
+		logte("Cannot initialize ReplayProvider using config information");
+		return false;
+	}
+
+	for(const auto &stream : _provider_info->GetStreams())
+	{
+		auto reader = StreamCaptureReader::Open(stream.GetFile());
+
+		if(reader == nullptr)
+		{
+			_inputs.clear();
+			return false;
+		}
+
+		auto input = std::make_unique<ReplayInput>();
+
+		input->config = &stream;
+		input->reader = reader;
+
+		_inputs.push_back(std::move(input));
+	}
+
+	if(Provider::Start() == false)
+	{
+		return false;
+	}
+
+	_stop = false;
+
+	for(auto &input : _inputs)
+	{
+		input->thread = std::thread(&ReplayProvider::ReplayThread, this, input.get());
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// Stop
+//====================================================================================================
+bool ReplayProvider::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock_guard(_stop_mutex);
+
+		_stop = true;
+	}
+
+	_stop_condition.notify_all();
+
+	for(auto &input : _inputs)
+	{
+		if(input->thread.joinable())
+		{
+			input->thread.join();
+		}
+	}
+
+	_inputs.clear();
+
+	return Provider::Stop();
+}
+
+//====================================================================================================
+// OnCreateApplication
+//====================================================================================================
+std::shared_ptr<pvd::Application> ReplayProvider::OnCreateApplication(const info::Application *application_info)
+{
+	return ReplayApplication::Create(application_info);
+}
+
+//====================================================================================================
+// ReplayThread
+// - The stream is created with the tracks of the capture, and deleted when the capture ends (without <Loop>)
+//====================================================================================================
+void ReplayProvider::ReplayThread(ReplayInput *input)
+{
+	auto application = GetApplicationById(_application_info->GetId());
+
+	if(application == nullptr)
+	{
+		return;
+	}
+
+	auto stream = application->MakeStream();
+
+	if(stream == nullptr)
+	{
+		logte("can not create stream - app(%s) stream(%s)", _application_info->GetName().CStr(), input->config->GetName().CStr());
+		return;
+	}
+
+	stream->SetName(input->config->GetName());
+
+	for(auto &track : input->reader->GetStreamInfo().GetTracks())
+	{
+		stream->AddTrack(std::make_shared<MediaTrack>(*(track.second)));
+	}
+
+	if(application->CreateStream2(stream) == false)
+	{
+		return;
+	}
+
+	double speed = std::max(input->config->GetSpeed(), 0.0f);
+
+	logti("Replaying %s to the stream %s/%s (speed: %s, loop: %s)",
+	      input->config->GetFile().CStr(), _application_info->GetName().CStr(), stream->GetName().CStr(),
+	      (speed > 0.0) ? ov::String::FormatString("%.2fx", speed).CStr() : "max", input->config->IsLoop() ? "true" : "false");
+
+	// [key: track id] The timestamps of the capture
+	std::map<int32_t, int64_t> first_pts;
+	std::map<int32_t, int64_t> last_pts;
+	std::map<int32_t, int64_t> last_duration;
+	// [key: track id] Added to the timestamps of the current loop
+	std::map<int32_t, int64_t> pts_offset;
+
+	uint64_t loop_count = 0;
+	uint64_t packet_count = 0;
+
+	while(true)
+	{
+		int64_t start_time = ov::LatencyHistogram::GetCurrentMicroseconds();
+		StreamCapturePacket capture_packet;
+		bool is_stopped = false;
+
+		while(input->reader->Read(&capture_packet))
+		{
+			// As fast as possible: only the stop is checked
+			int64_t send_time = (speed > 0.0) ? (start_time + static_cast<int64_t>(static_cast<double>(capture_packet.time) / speed)) : 0;
+
+			if(WaitUntil(send_time) == false)
+			{
+				is_stopped = true;
+				break;
+			}
+
+			auto &packet = capture_packet.packet;
+			int32_t track_id = packet->GetTrackId();
+			int64_t pts = packet->GetPts();
+
+			if(first_pts.find(track_id) == first_pts.end())
+			{
+				first_pts[track_id] = pts;
+			}
+
+			auto last = last_pts.find(track_id);
+
+			if((last != last_pts.end()) && (pts > last->second))
+			{
+				last_duration[track_id] = pts - last->second;
+			}
+
+			last_pts[track_id] = pts;
+
+			packet->SetPts(pts + pts_offset[track_id]);
+			packet->SetIngestTime(ov::LatencyHistogram::GetCurrentMicroseconds());
+
+			application->SendFrame(stream, std::move(packet));
+			packet_count++;
+		}
+
+		if(is_stopped || (input->config->IsLoop() == false) || (input->reader->Rewind() == false))
+		{
+			break;
+		}
+
+		// The next loop starts after the longest track of the capture (in seconds), so the tracks stay in sync
+		double duration = 0.0;
+
+		for(auto &first : first_pts)
+		{
+			auto &track = stream->GetTrack(first.first);
+
+			if((track == nullptr) || (track->GetTimeBase().GetDen() == 0))
+			{
+				continue;
+			}
+
+			duration = std::max(duration, static_cast<double>(last_pts[first.first] + last_duration[first.first] - first.second) * track->GetTimeBase().GetExpr());
+		}
+
+		for(auto &first : first_pts)
+		{
+			auto &track = stream->GetTrack(first.first);
+
+			if((track != nullptr) && (track->GetTimeBase().GetExpr() > 0.0))
+			{
+				pts_offset[first.first] += static_cast<int64_t>(duration / track->GetTimeBase().GetExpr());
+			}
+		}
+
+		last_pts.clear();
+		last_duration.clear();
+		loop_count++;
+	}
+
+	logti("The replay of the stream %s/%s is finished (packets: %llu, loops: %llu)",
+	      _application_info->GetName().CStr(), stream->GetName().CStr(),
+	      static_cast<unsigned long long>(packet_count), static_cast<unsigned long long>(loop_count));
+
+	application->DeleteStream2(stream);
+}
+
+//====================================================================================================
+// WaitUntil
+//====================================================================================================
+bool ReplayProvider::WaitUntil(int64_t time)
+{
+	std::unique_lock<std::mutex> lock(_stop_mutex);
+	int64_t wait_time = time - ov::LatencyHistogram::GetCurrentMicroseconds();
+
+	if(wait_time > 0)
+	{
+		_stop_condition.wait_for(lock, std::chrono::microseconds(wait_time), [this]() -> bool {
+			return _stop;
+		});
+	}
+
+	return _stop == false;
+}
@@ -0,0 +1,66 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+#include <base/application/stream_capture.h>
+
+#include "base/provider/provider.h"
+#include "base/provider/application.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+//====================================================================================================
+// ReplayProvider
+// - Feeds the captures of <Providers><Capture> to the router as a provider (<Stream>)
+// - A thread per stream sends the packets at the intervals of the ingest divided by <Speed>
+//   (<Speed>0</Speed>: as fast as possible), so the workload of the production can be measured offline
+// - The packets are the same as the packets which were received by the provider, so the router converts the bitstream again
+// - <Loop>: the capture is replayed again, the timestamps of the tracks are continued by the duration of the capture
+//====================================================================================================
+class ReplayProvider : public pvd::Provider
+{
+public:
+	static std::shared_ptr<ReplayProvider> Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+
+	explicit ReplayProvider(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+	~ReplayProvider() override;
+
+	cfg::ProviderType GetProviderType() override
+	{
+		return cfg::ProviderType::Replay;
+	}
+
+	bool Start() override;
+	bool Stop() override;
+
+	std::shared_ptr<pvd::Application> OnCreateApplication(const info::Application *application_info) override;
+
+private:
+	struct ReplayInput
+	{
+		const cfg::ReplayStream *config = nullptr;
+		std::shared_ptr<StreamCaptureReader> reader;
+		std::thread thread;
+	};
+
+	void ReplayThread(ReplayInput *input);
+	// Returns false if the provider is stopped while waiting
+	bool WaitUntil(int64_t time);
+
+	const cfg::ReplayProvider *_provider_info = nullptr;
+
+	std::vector<std::unique_ptr<ReplayInput>> _inputs;
+
+	std::mutex _stop_mutex;
+	std::condition_variable _stop_condition;
+	bool _stop = true;
+};
@@ -11,6 +11,8 @@
 
 #include "../rtc_signalling_server_private.h"
 
+#include <algorithm>
+
 std::shared_ptr<RtcPeerInfo> RtcP2PManager::CreatePeerInfo(peer_id_t id, const std::shared_ptr<WebSocketClient> &response)
 {
 	auto user_agent = response->GetRequest()->GetHeader("USER-AGENT");
@@ -18,11 +20,12 @@ std::shared_ptr<RtcPeerInfo> RtcP2PManager::CreatePeerInfo(peer_id_t id, const s
 
 	if(peer_info != nullptr)
 	{
-		std::lock_guard<std::recursive_mutex> lock_guard(_list_mutex);
+		auto &shard = GetShard(id);
+		std::lock_guard<std::mutex> lock_guard(shard.mutex);
 
-		auto previous_peer_info = _peer_list.find(id);
+		auto previous_peer_info = shard.peer_list.find(id);
 
-		if(previous_peer_info != _peer_list.end())
+		if(previous_peer_info != shard.peer_list.end())
 		{
 			// Already exists
 			logtd("Already exists: %s (%s)", user_agent.CStr(), peer_info->ToString().CStr());
@@ -31,7 +34,8 @@ std::shared_ptr<RtcPeerInfo> RtcP2PManager::CreatePeerInfo(peer_id_t id, const s
 		else
 		{
 			logtd("New peer: %s (%s)", user_agent.CStr(), peer_info->ToString().CStr());
-			_peer_list[id] = peer_info;
+			shard.peer_list[id] = peer_info;
+			_peer_count++;
 		}
 	}
 
@@ -40,11 +44,12 @@ std::shared_ptr<RtcPeerInfo> RtcP2PManager::CreatePeerInfo(peer_id_t id, const s
 
 std::shared_ptr<RtcPeerInfo> RtcP2PManager::FindPeer(peer_id_t peer_id)
 {
-	std::lock_guard<std::recursive_mutex> lock_guard(_list_mutex);
+	auto &shard = GetShard(peer_id);
+	std::lock_guard<std::mutex> lock_guard(shard.mutex);
 
-	auto peer_info = _peer_list.find(peer_id);
+	auto peer_info = shard.peer_list.find(peer_id);
 
-	if(peer_info != _peer_list.end())
+	if(peer_info != shard.peer_list.end())
 	{
 		return peer_info->second;
 	}
@@ -52,50 +57,68 @@ std::shared_ptr<RtcPeerInfo> RtcP2PManager::FindPeer(peer_id_t peer_id)
 	return nullptr;
 }
 
+bool RtcP2PManager::IsRegistered(const std::shared_ptr<RtcPeerInfo> &peer)
+{
+	return FindPeer(peer->GetId()) == peer;
+}
+
+void RtcP2PManager::SetMaxDepth(int max_depth)
+{
+	std::lock_guard<std::recursive_mutex> lock_guard(_tree_mutex);
+
+	_max_depth = std::max(max_depth, 1);
+	_is_p2p_enabled = true;
+}
+
 bool RtcP2PManager::RemovePeer(const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host)
 {
-	std::lock_guard<std::recursive_mutex> lock_guard(_list_mutex);
+	std::unique_lock<std::recursive_mutex> tree_lock(_tree_mutex, std::defer_lock);
 
-	if(peer->IsHost())
+	if(_is_p2p_enabled)
 	{
-		// Remove client peers
-		auto client_list = peer->_client_list;
+		tree_lock.lock();
 	}
-	else
+
 	{
-		// Remove client from host peer
-		auto host_peer = peer->_host_peer;
+		auto &shard = GetShard(peer->GetId());
+		std::lock_guard<std::mutex> lock_guard(shard.mutex);
 
-		if(host_peer != nullptr)
+		auto peer_info = shard.peer_list.find(peer->GetId());
+
+		if((peer_info == shard.peer_list.end()) || (peer_info->second != peer))
 		{
-			host_peer->_client_list.erase(peer->GetId());
-			if(host_peer->_client_list.size() < max_clients_per_host)
-			{
-				if(host_peer->CanAccept())
-				{
-					_available_list[peer->GetId()] = host_peer;
-				}
-			}
+			return false;
 		}
 
-		_total_client_count--;
+		shard.peer_list.erase(peer_info);
+		_peer_count--;
 	}
 
-	_available_list.erase(peer->GetId());
+	if(_is_p2p_enabled == false)
+	{
+		// All the peers are the host peers of OME
+		return true;
+	}
 
-	auto peer_info = _peer_list.find(peer->GetId());
+	_available_list.erase(peer->GetId());
 
-	if(peer_info == _peer_list.end())
+	// Remove client from host peer (the host may accept another client now)
+	if(DetachClientPeer(peer, max_clients_per_host) != nullptr)
 	{
-		return false;
+		_total_client_count--;
 	}
 
-	_peer_list.erase(peer->GetId());
+	// The clients don't receive the stream until they are reattached
+	for(auto &client : peer->_client_list)
+	{
+		client.second->_is_relay = false;
+		UpdateAvailability(client.second, max_clients_per_host);
+	}
 
 	return true;
 }
 
-bool RtcP2PManager::RegisterAsHostPeer(const std::shared_ptr<RtcPeerInfo> &peer)
+bool RtcP2PManager::RegisterAsHostPeer(const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host)
 {
 	if(peer == nullptr)
 	{
@@ -104,7 +127,12 @@ bool RtcP2PManager::RegisterAsHostPeer(const std::shared_ptr<RtcPeerInfo> &peer)
 		return false;
 	}
 
-	std::lock_guard<std::recursive_mutex> lock_guard(_list_mutex);
+	std::unique_lock<std::recursive_mutex> tree_lock(_tree_mutex, std::defer_lock);
+
+	if(_is_p2p_enabled)
+	{
+		tree_lock.lock();
+	}
 
 	auto peer_info = FindPeer(peer->GetId());
 
@@ -120,11 +148,19 @@ bool RtcP2PManager::RegisterAsHostPeer(const std::shared_ptr<RtcPeerInfo> &peer)
 		return false;
 	}
 
+	if(DetachClientPeer(peer_info, max_clients_per_host) != nullptr)
+	{
+		// The client peer lost its host, and OME serves it now
+		_total_client_count--;
+	}
+
 	peer_info->MakeAsHost();
+	peer_info->_is_relay = false;
+	peer_info->SetDepth(0);
 
-	if(peer_info->CanAccept())
+	if(_is_p2p_enabled)
 	{
-		_available_list[peer->GetId()] = peer_info;
+		UpdateAvailability(peer_info, max_clients_per_host);
 	}
 
 	return true;
@@ -140,54 +176,221 @@ std::shared_ptr<RtcPeerInfo> RtcP2PManager::TryToRegisterAsClientPeer(const std:
 		return nullptr;
 	}
 
-	std::lock_guard<std::recursive_mutex> lock_guard(_list_mutex);
+	std::lock_guard<std::recursive_mutex> lock_guard(_tree_mutex);
+
+	auto host_peer = FindBestHostPeer(peer);
+
+	if(host_peer == nullptr)
+	{
+		return nullptr;
+	}
+
+	auto &client_list = host_peer->_client_list;
+	auto client_peer = client_list.find(peer->GetId());
+
+	if(client_peer == client_list.end())
+	{
+		AttachClientPeer(host_peer, peer, max_clients_per_host);
+		_total_client_count++;
+	}
+	else
+	{
+		OV_ASSERT2(false);
+		logtw("Client peer %s is already exists (previous peer: %s)", peer->ToString().CStr(), client_peer->second->ToString().CStr());
+	}
+
+	return host_peer;
+}
+
+bool RtcP2PManager::RegisterAsRelayPeer(const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host)
+{
+	std::lock_guard<std::recursive_mutex> lock_guard(_tree_mutex);
+
+	if(peer->IsHost() || (peer->_host_peer == nullptr))
+	{
+		return false;
+	}
+
+	peer->_is_relay = true;
+
+	UpdateAvailability(peer, max_clients_per_host);
+
+	return true;
+}
+
+std::shared_ptr<RtcPeerInfo> RtcP2PManager::TryToReattachClientPeer(const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host)
+{
+	std::lock_guard<std::recursive_mutex> lock_guard(_tree_mutex);
+
+	if(peer->IsHost() || (FindPeer(peer->GetId()) == nullptr))
+	{
+		return nullptr;
+	}
+
+	auto host_peer = FindBestHostPeer(peer);
+
+	if(host_peer == nullptr)
+	{
+		return nullptr;
+	}
+
+	DetachClientPeer(peer, max_clients_per_host);
+
+	// The peer cannot relay until it receives the stream from the new host
+	peer->_is_relay = false;
+	AttachClientPeer(host_peer, peer, max_clients_per_host);
+
+	return host_peer;
+}
+
+void RtcP2PManager::UpdatePeerStats(const std::shared_ptr<RtcPeerInfo> &peer, int uplink_kbps, int rtt, RtcNatType nat_type, size_t max_clients_per_host)
+{
+	std::lock_guard<std::recursive_mutex> lock_guard(_tree_mutex);
+
+	peer->_uplink_kbps = std::max(uplink_kbps, 0);
+	peer->_rtt = std::max(rtt, 0);
+	peer->_nat_type = nat_type;
+
+	UpdateAvailability(peer, max_clients_per_host);
+}
+
+std::shared_ptr<RtcPeerInfo> RtcP2PManager::FindBestHostPeer(const std::shared_ptr<RtcPeerInfo> &peer)
+{
+	// The subtree of the peer moves with it, so the deepest descendant must not exceed the max depth
+	int height = peer->GetSubtreeHeight();
+
+	std::shared_ptr<RtcPeerInfo> best_host;
+	int64_t best_score = 0;
 
 	for(const auto &host : _available_list)
 	{
 		auto &host_peer = host.second;
 
-		if(host_peer->IsCompatibleWith(peer))
+		if(host_peer->IsDescendantOf(peer.get()))
 		{
-			OV_ASSERT2(host_peer->IsHost());
-			OV_ASSERT2(host_peer->IsHost());
+			// It makes a cycle
+			continue;
+		}
 
-			auto &client_list = host_peer->_client_list;
+		if((host_peer->_depth + 1 + height) > _max_depth)
+		{
+			continue;
+		}
 
-			peer_id_t client_id = peer->GetId();
+		if(host_peer->IsCompatibleWith(peer) == false)
+		{
+			continue;
+		}
 
-			auto client_peer = client_list.find(client_id);
+		if(IsReceivingStream(host_peer) == false)
+		{
+			// An ancestor of the host left, and it is waiting for another host
+			continue;
+		}
 
-			if(client_peer == client_list.end())
-			{
-				client_list[client_id] = peer;
-				_total_client_count++;
+		int64_t score = GetHostScore(host_peer);
 
-				peer->_host_peer = host_peer;
+		if((best_host == nullptr) || (score > best_score))
+		{
+			best_host = host_peer;
+			best_score = score;
+		}
+	}
 
-				if(client_list.size() >= max_clients_per_host)
-				{
-					// Now, the host cannot accept another client
-					_available_list.erase(host.first);
-				}
-			}
-			else
-			{
-				OV_ASSERT2(false);
-				logtw("Client peer %s is already exists (previous peer: %s)", peer->ToString().CStr(), client_peer->second->ToString().CStr());
-			}
+	return best_host;
+}
 
-			return host_peer;
+bool RtcP2PManager::IsReceivingStream(const std::shared_ptr<RtcPeerInfo> &peer)
+{
+	for(auto current = peer.get(); current != nullptr; current = current->_host_peer.get())
+	{
+		if(current->IsHost())
+		{
+			return true;
+		}
+
+		if(current->IsRelay() == false)
+		{
+			return false;
 		}
 	}
 
-	return nullptr;
+	// The host is removed
+	return false;
+}
+
+int64_t RtcP2PManager::GetHostScore(const std::shared_ptr<RtcPeerInfo> &host)
+{
+	int64_t uplink_kbps = (host->_uplink_kbps > 0) ? host->_uplink_kbps : P2P_DEFAULT_UPLINK_KBPS;
+
+	// Uplink per client when the new client is added
+	int64_t score = uplink_kbps / static_cast<int64_t>(host->_client_list.size() + 1);
+
+	score -= static_cast<int64_t>(host->GetPathRtt()) * P2P_SCORE_RTT_WEIGHT;
+	score -= static_cast<int64_t>(host->_depth) * P2P_SCORE_DEPTH_PENALTY;
+
+	if((host->_nat_type == RtcNatType::Open) || (host->_nat_type == RtcNatType::FullCone))
+	{
+		score += P2P_SCORE_OPEN_NAT_BONUS;
+	}
+
+	return score;
+}
+
+void RtcP2PManager::AttachClientPeer(const std::shared_ptr<RtcPeerInfo> &host, const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host)
+{
+	OV_ASSERT2(host->IsHost() || host->IsRelay());
+
+	host->_client_list[peer->GetId()] = peer;
+	peer->_host_peer = host;
+	peer->SetDepth(host->_depth + 1);
+
+	UpdateAvailability(host, max_clients_per_host);
+	UpdateAvailability(peer, max_clients_per_host);
+}
+
+std::shared_ptr<RtcPeerInfo> RtcP2PManager::DetachClientPeer(const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host)
+{
+	auto host_peer = peer->_host_peer;
+
+	if(host_peer != nullptr)
+	{
+		host_peer->_client_list.erase(peer->GetId());
+		peer->_host_peer = nullptr;
+
+		UpdateAvailability(host_peer, max_clients_per_host);
+	}
+
+	return host_peer;
+}
+
+void RtcP2PManager::UpdateAvailability(const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host)
+{
+	bool is_available =
+		// The peer is not removed
+		IsRegistered(peer) &&
+		peer->CanAccept() &&
+		// The peer receives the stream
+		(peer->IsHost() || peer->IsRelay()) &&
+		(peer->_depth < _max_depth) &&
+		(peer->_client_list.size() < peer->GetCapacity(max_clients_per_host));
+
+	if(is_available)
+	{
+		_available_list[peer->GetId()] = peer;
+	}
+	else
+	{
+		// Now, the host cannot accept another client
+		_available_list.erase(peer->GetId());
+	}
 }
 
 std::shared_ptr<RtcPeerInfo> RtcP2PManager::GetClientPeerOf(const std::shared_ptr<RtcPeerInfo> &host, peer_id_t client_id)
 {
 	if(host != nullptr)
 	{
-		std::lock_guard<std::recursive_mutex> lock_guard(_list_mutex);
+		std::lock_guard<std::recursive_mutex> lock_guard(_tree_mutex);
 
 		auto &client_list = host->_client_list;
 		auto client = client_list.find(client_id);
@@ -217,7 +420,7 @@ std::map<peer_id_t, std::shared_ptr<RtcPeerInfo>> RtcP2PManager::GetClientPeerLi
 	}
 
 	{
-		std::lock_guard<std::recursive_mutex> lock_guard(_list_mutex);
+		std::lock_guard<std::recursive_mutex> lock_guard(_tree_mutex);
 		list = host->_client_list;
 	}
 
@@ -226,7 +429,7 @@ std::map<peer_id_t, std::shared_ptr<RtcPeerInfo>> RtcP2PManager::GetClientPeerLi
 
 int RtcP2PManager::GetPeerCount() const
 {
-	return static_cast<int>(_peer_list.size());
+	return _peer_count;
 }
 
 int RtcP2PManager::GetClientPeerCount() const
@@ -10,18 +10,52 @@
 
 #include "rtc_peer_info.h"
 
+#include <array>
+#include <atomic>
+
+// Weights of the score of a host peer candidate (see RtcP2PManager::GetHostScore(), the unit is kbps)
+// Penalty per 1 ms of the RTT from OME to the host
+#define P2P_SCORE_RTT_WEIGHT                        10
+// Penalty per level of the tree (the deeper peer has the higher latency and the more chance to be broken)
+#define P2P_SCORE_DEPTH_PENALTY                     500
+// Bonus of the host which is not behind a restricted NAT (the client can connect to it easily)
+#define P2P_SCORE_OPEN_NAT_BONUS                    500
+
+// Number of the shards of the peer list (the peers are looked up by the signalling workers in parallel)
+#define P2P_PEER_SHARD_COUNT                        32
+
+// Distribution tree of the peers
+//
+// - OME serves the host peers (depth 0), and a peer serves up to max_clients_per_host client peers
+// - A client peer which receives the stream (relay) can serve other clients until it reaches the max depth
+// - The host of a new client is selected by the uplink, the RTT, the depth and the NAT type of the candidates
+// - When a peer leaves, its clients are reattached to other peers (with their subtrees)
+// - The peers are kept in the shards by the id, so the joins of the different peers don't wait for each other.
+//   The tree is locked by _tree_mutex, which is used only if P2P is enabled (SetMaxDepth())
 class RtcP2PManager
 {
 public:
 	// Create a PeerInfo from user-agent
 	std::shared_ptr<RtcPeerInfo> CreatePeerInfo(peer_id_t id, const std::shared_ptr<WebSocketClient> &response);
 
-	// Add to _peer_list
+	// Maximum depth of the client peers (1: only the host peers can serve the clients), P2P is enabled by it
+	void SetMaxDepth(int max_depth);
+
+	// The shard of the id is locked
 	std::shared_ptr<RtcPeerInfo> FindPeer(peer_id_t peer_id);
+	// The client peers of the peer are kept (they must be reattached by TryToReattachClientPeer() or RegisterAsHostPeer())
 	bool RemovePeer(const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host);
 
-	bool RegisterAsHostPeer(const std::shared_ptr<RtcPeerInfo> &peer);
+	// If the peer is a client peer, it is detached from the host peer (with its subtree)
+	bool RegisterAsHostPeer(const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host);
 	std::shared_ptr<RtcPeerInfo> TryToRegisterAsClientPeer(const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host);
+	// Called when the client peer receives the stream from the host peer, then it can serve other clients
+	bool RegisterAsRelayPeer(const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host);
+	// Moves the client peer (and its subtree) to another host peer, returns nullptr if there is no host to accept it
+	std::shared_ptr<RtcPeerInfo> TryToReattachClientPeer(const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host);
+
+	// Measured by the peer (0 or RtcNatType::Unknown: not measured)
+	void UpdatePeerStats(const std::shared_ptr<RtcPeerInfo> &peer, int uplink_kbps, int rtt, RtcNatType nat_type, size_t max_clients_per_host);
 
 	std::shared_ptr<RtcPeerInfo> GetClientPeerOf(const std::shared_ptr<RtcPeerInfo> &host, peer_id_t client_id);
 	std::map<peer_id_t, std::shared_ptr<RtcPeerInfo>> GetClientPeerList(const std::shared_ptr<RtcPeerInfo> &host);
@@ -30,16 +64,44 @@ public:
 	int GetClientPeerCount() const;
 
 protected:
+	struct PeerShard
+	{
+		std::mutex mutex;
+		// key: peer id, value: peer info
+		std::map<peer_id_t, std::shared_ptr<RtcPeerInfo>> peer_list;
+	};
+
+	PeerShard &GetShard(peer_id_t peer_id)
+	{
+		return _peer_shards[static_cast<uint32_t>(peer_id) % P2P_PEER_SHARD_COUNT];
+	}
 
-	std::recursive_mutex _list_mutex;
+	// Indicates whether the peer is not removed
+	bool IsRegistered(const std::shared_ptr<RtcPeerInfo> &peer);
+
+	// _tree_mutex must be locked
+	std::shared_ptr<RtcPeerInfo> FindBestHostPeer(const std::shared_ptr<RtcPeerInfo> &peer);
+	static int64_t GetHostScore(const std::shared_ptr<RtcPeerInfo> &host);
+	// Indicates whether all the ancestors of the peer receive the stream
+	static bool IsReceivingStream(const std::shared_ptr<RtcPeerInfo> &peer);
+	void AttachClientPeer(const std::shared_ptr<RtcPeerInfo> &host, const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host);
+	// Returns the host peer which the peer is detached from
+	std::shared_ptr<RtcPeerInfo> DetachClientPeer(const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host);
+	// Adds the peer to _available_list if it can accept one more client, otherwise removes it
+	void UpdateAvailability(const std::shared_ptr<RtcPeerInfo> &peer, size_t max_clients_per_host);
 
 	// All peer list
-	// key: peer id, value: peer info list
-	std::map<peer_id_t, std::shared_ptr<RtcPeerInfo>> _peer_list;
+	std::array<PeerShard, P2P_PEER_SHARD_COUNT> _peer_shards;
+	std::atomic<int> _peer_count { 0 };
+
+	// The links of the peers, _available_list and the counters (the shard is locked after it)
+	std::recursive_mutex _tree_mutex;
 
 	// List of hosts that can accept client
 	// key: host id, value: host info
 	std::map<peer_id_t, std::shared_ptr<RtcPeerInfo>> _available_list;
 
-	int _total_client_count = 0;
+	std::atomic<int> _total_client_count { 0 };
+	int _max_depth = 1;
+	std::atomic<bool> _is_p2p_enabled { false };
 };
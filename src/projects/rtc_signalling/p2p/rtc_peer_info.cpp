@@ -9,6 +9,8 @@
 
 #include "rtc_peer_info.h"
 
+#include <algorithm>
+
 std::shared_ptr<RtcPeerInfo> RtcPeerInfo::FromUserAgent(peer_id_t id, const ov::String &user_agent, const std::shared_ptr<WebSocketClient> &response)
 {
 	if(user_agent.IsEmpty())
@@ -120,7 +122,108 @@ bool RtcPeerInfo::IsCompatibleWith(const std::shared_ptr<RtcPeerInfo> &peer)
 		return false;
 	}
 
-	return (_browser.browser_type == peer->_browser.browser_type);
+	if(_browser.browser_type != peer->_browser.browser_type)
+	{
+		return false;
+	}
+
+	// A peer behind the symmetric NAT cannot connect to the peer behind the symmetric/port restricted NAT without TURN
+	auto is_strict_nat = [](RtcNatType nat_type) -> bool {
+		return (nat_type == RtcNatType::Symmetric) || (nat_type == RtcNatType::PortRestricted);
+	};
+
+	if(((_nat_type == RtcNatType::Symmetric) && is_strict_nat(peer->_nat_type)) ||
+	   ((peer->_nat_type == RtcNatType::Symmetric) && is_strict_nat(_nat_type)))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+RtcNatType RtcPeerInfo::ParseNatType(const ov::String &nat_type)
+{
+	auto type = nat_type.LowerCaseString();
+
+	if(type == "open")
+	{
+		return RtcNatType::Open;
+	}
+	else if(type == "full_cone")
+	{
+		return RtcNatType::FullCone;
+	}
+	else if(type == "restricted")
+	{
+		return RtcNatType::Restricted;
+	}
+	else if(type == "port_restricted")
+	{
+		return RtcNatType::PortRestricted;
+	}
+	else if(type == "symmetric")
+	{
+		return RtcNatType::Symmetric;
+	}
+
+	return RtcNatType::Unknown;
+}
+
+size_t RtcPeerInfo::GetCapacity(size_t max_clients_per_host) const
+{
+	if(_uplink_kbps > 0)
+	{
+		return std::min(max_clients_per_host, static_cast<size_t>(_uplink_kbps / P2P_STREAM_BITRATE_KBPS));
+	}
+
+	return max_clients_per_host;
+}
+
+int RtcPeerInfo::GetPathRtt() const
+{
+	int rtt = 0;
+
+	for(auto peer = this; peer != nullptr; peer = peer->_host_peer.get())
+	{
+		rtt += peer->_rtt;
+	}
+
+	return rtt;
+}
+
+int RtcPeerInfo::GetSubtreeHeight() const
+{
+	int height = 0;
+
+	for(const auto &client : _client_list)
+	{
+		height = std::max(height, client.second->GetSubtreeHeight() + 1);
+	}
+
+	return height;
+}
+
+bool RtcPeerInfo::IsDescendantOf(const RtcPeerInfo *peer) const
+{
+	for(auto current = this; current != nullptr; current = current->_host_peer.get())
+	{
+		if(current == peer)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void RtcPeerInfo::SetDepth(int depth)
+{
+	_depth = depth;
+
+	for(auto &client : _client_list)
+	{
+		client.second->SetDepth(depth + 1);
+	}
 }
 
 ov::String RtcPeerInfo::ToString() const
@@ -139,10 +242,12 @@ ov::String RtcPeerInfo::ToString() const
 	else
 	{
 		return ov::String::FormatString(
-			"<PeerInfo: %p, Client peer, id: %d, can accept: %s, browser: %s>",
+			"<PeerInfo: %p, Client peer, id: %d, depth: %d, can accept: %s, client count: %d, browser: %s>",
 			this,
 			_id,
+			_depth,
 			_can_accept ? "true" : "false",
+			_client_list.size(),
 			_browser.ToString().CStr()
 		);
 	}
@@ -16,8 +16,24 @@
 #define P2P_OME_PEER_ID                             0
 #define P2P_INVALID_PEER_ID                         -1
 
+// Uplink of the peer which is not measured yet (kbps)
+#define P2P_DEFAULT_UPLINK_KBPS                     5000
+// Bitrate of the stream relayed to a client peer (kbps), used to limit the clients by the uplink
+#define P2P_STREAM_BITRATE_KBPS                     2000
+
 typedef int peer_id_t;
 
+// NAT type detected by the peer (e.g. using STUN, RFC 3489 classification)
+enum class RtcNatType : char
+{
+	Unknown,
+	Open,
+	FullCone,
+	Restricted,
+	PortRestricted,
+	Symmetric
+};
+
 enum class RtcOsType : char
 {
 	// PC
@@ -235,6 +251,33 @@ public:
 		return _host_peer;
 	}
 
+	// Depth in the distribution tree (0: host peer which receives the stream from OME)
+	int GetDepth() const
+	{
+		return _depth;
+	}
+
+	// Indicates whether the client peer receives the stream from the host peer (so it can relay to other clients)
+	bool IsRelay() const
+	{
+		return _is_relay;
+	}
+
+	int GetUplinkKbps() const
+	{
+		return _uplink_kbps;
+	}
+
+	int GetRtt() const
+	{
+		return _rtt;
+	}
+
+	RtcNatType GetNatType() const
+	{
+		return _nat_type;
+	}
+
 	std::shared_ptr<WebSocketClient> GetResponse()
 	{
 		return _response;
@@ -242,6 +285,9 @@ public:
 
 	bool IsCompatibleWith(const std::shared_ptr<RtcPeerInfo> &peer);
 
+	// "open", "full_cone", "restricted", "port_restricted", "symmetric"
+	static RtcNatType ParseNatType(const ov::String &nat_type);
+
 	ov::String ToString() const;
 
 protected:
@@ -250,6 +296,17 @@ protected:
 	static std::shared_ptr<RtcPeerInfo> FromUserAgent(peer_id_t id, const ov::String &user_agent, const std::shared_ptr<WebSocketClient> &response);
 	static RtcPeerBrowser ParseBrowserInfo(const ov::String &user_agent);
 
+	// Number of the client peers which the peer can serve (limited by the uplink if it is measured)
+	size_t GetCapacity(size_t max_clients_per_host) const;
+	// Sum of the RTTs from OME to the peer
+	int GetPathRtt() const;
+	// Depth of the deepest descendant from the peer (0: no client)
+	int GetSubtreeHeight() const;
+	// Indicates whether the peer is the ancestor (or itself)
+	bool IsDescendantOf(const RtcPeerInfo *peer) const;
+	// Updates the depth of the peer and its descendants
+	void SetDepth(int depth);
+
 	// peer id
 	peer_id_t _id = 0;
 
@@ -264,6 +321,15 @@ protected:
 	// host peer info (client only)
 	std::shared_ptr<RtcPeerInfo> _host_peer;
 
+	int _depth = 0;
+	bool _is_relay = false;
+
+	// Reported by the peer (0: not measured)
+	int _uplink_kbps = 0;
+	// RTT between the peer and the host peer (or OME)
+	int _rtt = 0;
+	RtcNatType _nat_type = RtcNatType::Unknown;
+
 	std::shared_ptr<WebSocketClient> _response;
 
 	std::map<peer_id_t, std::shared_ptr<RtcPeerInfo>> _client_list;
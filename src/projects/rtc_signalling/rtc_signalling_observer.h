@@ -24,6 +24,11 @@ public:
 	// observer가 여러 개 등록되어 있는 경우, 가장 먼저 반환되는 SDP를 사용함
 	virtual std::shared_ptr<SessionDescription> OnRequestOffer(const ov::String &application_name, const ov::String &stream_name, std::vector<RtcIceCandidate> *ice_candidates) = 0;
 
+	// The peer sent the offer (WHEP): the session is created with the answer of OME
+	// - Returns the answer (nullptr if the stream cannot serve the offer), and ice_candidates are filled
+	// - The session is identified by the session id of offer_sdp (OnStopCommand())
+	virtual std::shared_ptr<SessionDescription> OnRequestAnswer(const ov::String &application_name, const ov::String &stream_name, const std::shared_ptr<SessionDescription> &offer_sdp, std::vector<RtcIceCandidate> *ice_candidates) = 0;
+
 	// remote SDP가 도착했을 때 호출되는 메서드
 	virtual bool OnAddRemoteDescription(const ov::String &application_name, const ov::String &stream_name, const std::shared_ptr<SessionDescription> &offer_sdp, const std::shared_ptr<SessionDescription> &peer_sdp) = 0;
 
@@ -33,7 +38,14 @@ public:
 	// client에서 stop 이벤트가 도착했을 때 호출되는 메서드
     virtual bool OnStopCommand(const ov::String &application_name, const ov::String &stream_name, const std::shared_ptr<SessionDescription> &offer_sdp, const std::shared_ptr<SessionDescription> &peer_sdp) = 0;
 
+	// The peer changed the tracks which it receives ("subscribe" command)
+	// - max_height: resolution cap of the video (0: unlimited)
+	virtual bool OnSubscribeCommand(const ov::String &application_name, const ov::String &stream_name, const std::shared_ptr<SessionDescription> &offer_sdp, const std::shared_ptr<SessionDescription> &peer_sdp, bool audio, bool video, int32_t max_height) = 0;
+
     // client bitrate info check method
     virtual uint32_t OnGetBitrate(const ov::String &application_name, const ov::String &stream_name) = 0;
 
+	// Time (us) to send a frame to all sessions of the worker that a new session will be assigned to
+	virtual uint64_t OnGetSendLatency(const ov::String &application_name, const ov::String &stream_name) = 0;
+
 };
@@ -10,11 +10,23 @@
 #include "rtc_signalling_server.h"
 #include "rtc_ice_candidate.h"
 #include "rtc_signalling_server_private.h"
+#include "rtc_signalling_worker_pool.h"
 
 #include <utility>
 
 #include <ice/ice.h>
 #include <webrtc/webrtc_publisher.h>
+#include <base/application/application_quota.h>
+
+// The responses are written to the buffer of the current thread, which is reused by the next response
+static ov::JsonWriter &GetResponseWriter()
+{
+	thread_local ov::JsonWriter writer;
+
+	writer.Clear();
+
+	return writer;
+}
 
 RtcSignallingServer::RtcSignallingServer(const info::Application *application_info, std::shared_ptr<MediaRouteApplicationInterface> application)
 	: _application_info(application_info),
@@ -29,6 +41,7 @@ RtcSignallingServer::RtcSignallingServer(const info::Application *application_in
 	}
 
 	_p2p_info = &(_webrtc_publisher_info->GetP2P());
+	_admission_control_info = &(_webrtc_publisher_info->GetAdmissionControl());
 }
 
 bool RtcSignallingServer::Start(const ov::SocketAddress &address)
@@ -63,14 +76,32 @@ bool RtcSignallingServer::Start(const ov::SocketAddress &address)
 
 	if(_p2p_info->IsParsed())
 	{
-		logti("P2P is enabled (Client peers per host peer: %d)", _p2p_info->GetClientPeersPerHostPeer());
+		logti("P2P is enabled (Client peers per host peer: %d, max tree depth: %d)", _p2p_info->GetClientPeersPerHostPeer(), _p2p_info->GetMaxTreeDepth());
+
+		_p2p_manager.SetMaxDepth(_p2p_info->GetMaxTreeDepth());
 	}
 	else
 	{
 		logti("P2P is disabled");
 	}
 
-	return InitializeWebSocketServer() && _http_server->Start(address);
+	if(_admission_control_info->IsParsed())
+	{
+		logti("Admission control is enabled (Max egress bitrate: %d Mbps, max CPU usage: %d%%, max send latency: %d ms, redirect urls: %zu)",
+		      _admission_control_info->GetMaxEgressBitrate(), _admission_control_info->GetMaxCpuUsage(),
+		      _admission_control_info->GetMaxSendLatency(), _admission_control_info->GetRedirectUrls().size());
+	}
+
+	if((InitializeWebSocketServer() && InitializeWhepServer() && _http_server->Start(address)) == false)
+	{
+		return false;
+	}
+
+	_drain_timer_id = ov::SharedTimerWheel::Instance()->Schedule(RTC_SIGNALLING_DRAIN_INTERVAL, [this]() -> int64_t {
+		return MoveDrainingClients();
+	});
+
+	return true;
 }
 
 bool RtcSignallingServer::InitializeWebSocketServer()
@@ -140,6 +171,7 @@ bool RtcSignallingServer::InitializeWebSocketServer()
 				}
 			}
 
+			info->client = response;
 			response->GetRequest()->SetExtra(info);
 
 			return true;
@@ -163,89 +195,399 @@ bool RtcSignallingServer::InitializeWebSocketServer()
 				return false;
 			}
 
-			ov::JsonObject object = ov::Json::Parse(message->GetPayload());
+			return ScheduleCommand(info, response, message);
+		});
+
+	web_socket->SetErrorHandler(
+		[this](const std::shared_ptr<WebSocketClient> &response, const std::shared_ptr<const ov::Error> &error) -> void
+		{
+			logtw("An error occurred: %s", error->ToString().CStr());
+		});
 
-			if(object.IsNull())
+	web_socket->SetCloseHandler(
+		[this](const std::shared_ptr<WebSocketClient> &response) -> void
+		{
+			auto info = response->GetRequest()->GetExtraAs<RtcSignallingInfo>();
+
+			if(info != nullptr)
 			{
-				logtw("Invalid request message from %s", response->ToString().CStr());
-				return false;
+				// The session is cleaned up after the commands which are received before
+				ScheduleCommand(info, response, nullptr);
 			}
+			else
+			{
+				// The client is disconnected before websocket negotiation
+			}
+		});
+
+	return _http_server->AddInterceptor(web_socket);
+}
+
+bool RtcSignallingServer::ScheduleCommand(const std::shared_ptr<RtcSignallingInfo> &info, const std::shared_ptr<WebSocketClient> &response, const std::shared_ptr<const WebSocketFrame> &message)
+{
+	{
+		std::lock_guard<std::mutex> lock_guard(info->command_mutex);
+
+		if((message != nullptr) && (info->pending_commands.size() >= RTC_SIGNALLING_MAX_PENDING_COMMANDS))
+		{
+			logtw("Too many pending commands (%zu) from %s, disconnecting...", info->pending_commands.size(), response->ToString().CStr());
+			return false;
+		}
+
+		info->pending_commands.emplace_back(response, message);
 
-			// TODO(dimiden): 이렇게 호출하면 "command": null 이 추가되어버림. 개선 필요
-			Json::Value &command_value = object.GetJsonValue()["command"];
+		if(info->command_scheduled)
+		{
+			// The worker dispatches it after the previous commands
+			return true;
+		}
+
+		info->command_scheduled = true;
+	}
+
+	auto server = GetSharedPtr();
+
+	if(RtcSignallingWorkerPool::Instance()->Post([server, info]() {
+		server->ProcessCommands(info);
+	}) == false)
+	{
+		ProcessCommands(info);
+	}
+
+	return true;
+}
+
+void RtcSignallingServer::ProcessCommands(const std::shared_ptr<RtcSignallingInfo> &info)
+{
+	while(true)
+	{
+		std::shared_ptr<WebSocketClient> response;
+		std::shared_ptr<const WebSocketFrame> message;
 
-			if(command_value.isNull())
+		{
+			std::lock_guard<std::mutex> lock_guard(info->command_mutex);
+
+			if(info->pending_commands.empty())
 			{
-				logtw("Invalid request message from %s", response->ToString().CStr());
-				return false;
+				info->command_scheduled = false;
+				return;
 			}
 
-			ov::String command = ov::Converter::ToString(command_value);
+			response = std::move(info->pending_commands.front().first);
+			message = std::move(info->pending_commands.front().second);
+			info->pending_commands.pop_front();
+		}
 
-			logtd("Trying to dispatch command: %s...", command.CStr());
+		if(message == nullptr)
+		{
+			ProcessClose(info, response);
+			continue;
+		}
 
-			auto error = DispatchCommand(command, object, info, response, message);
+		if(info->command_failed)
+		{
+			// The connection is being closed
+			continue;
+		}
 
-			if(error != nullptr)
+		if(ProcessCommand(info, response, message) == false)
+		{
+			info->command_failed = true;
+
+			// Same as the message handler returns false (the close handler queues the stop)
+			auto http_server = std::atomic_load(&_http_server);
+
+			if(http_server != nullptr)
 			{
-				if(error->GetCode() == 404)
-				{
-					logte("Cannot find stream (%s/%s)", info->application_name.CStr(), info->stream_name.CStr());
-				}
-				else
-				{
-					logte("An error occurred while dispatch command %s for stream (%s/%s): %s, disconnecting...", command.CStr(), info->application_name.CStr(), info->stream_name.CStr(), error->ToString().CStr());
-				}
+				http_server->Disconnect(response->GetRequest()->GetRemote());
+			}
+		}
+	}
+}
 
-				ov::JsonObject response_json;
-				Json::Value &value = response_json.GetJsonValue();
+bool RtcSignallingServer::ProcessCommand(std::shared_ptr<RtcSignallingInfo> info, const std::shared_ptr<WebSocketClient> &response, const std::shared_ptr<const WebSocketFrame> &message)
+{
+	ov::JsonObject object = ov::Json::Parse(message->GetPayload());
 
-				value["code"] = error->GetCode();
-				value["error"] = error->GetMessage().CStr();
+	if(object.IsNull())
+	{
+		logtw("Invalid request message from %s", response->ToString().CStr());
+		return false;
+	}
 
-				response->Send(response_json.ToString());
+	// TODO(dimiden): 이렇게 호출하면 "command": null 이 추가되어버림. 개선 필요
+	Json::Value &command_value = object.GetJsonValue()["command"];
 
-				return false;
-			}
+	if(command_value.isNull())
+	{
+		logtw("Invalid request message from %s", response->ToString().CStr());
+		return false;
+	}
 
-			return true;
-		});
+	ov::String command = ov::Converter::ToString(command_value);
 
-	web_socket->SetErrorHandler(
-		[this](const std::shared_ptr<WebSocketClient> &response, const std::shared_ptr<const ov::Error> &error) -> void
+	logtd("Trying to dispatch command: %s...", command.CStr());
+
+	auto error = DispatchCommand(command, object, info, response, message);
+
+	if(error != nullptr)
+	{
+		if(error->GetCode() == static_cast<int>(HttpStatusCode::TemporaryRedirect))
 		{
-			logtw("An error occurred: %s", error->ToString().CStr());
-		});
+			// 'redirect' command is already sent
+			return false;
+		}
 
-	web_socket->SetCloseHandler(
-		[this](const std::shared_ptr<WebSocketClient> &response) -> void
+		if(error->GetCode() == 404)
 		{
-			auto info = response->GetRequest()->GetExtraAs<RtcSignallingInfo>();
+			logte("Cannot find stream (%s/%s)", info->application_name.CStr(), info->stream_name.CStr());
+		}
+		else
+		{
+			logte("An error occurred while dispatch command %s for stream (%s/%s): %s, disconnecting...", command.CStr(), info->application_name.CStr(), info->stream_name.CStr(), error->ToString().CStr());
+		}
 
-			if(info != nullptr)
-			{
-				if(info->id != P2P_INVALID_PEER_ID)
-				{
-					// The client is disconnected without send "close" command
+		auto &writer = GetResponseWriter();
 
-					// Forces the session to be cleaned up by sending a stop command
-					DispatchStop(info);
-				}
+		writer.BeginObject()
+			.Member("code", error->GetCode())
+			.Member("error", error->GetMessage())
+			.EndObject();
 
-				logti("Client is disconnected: %s (%s / %s, ufrag: local: %s, remote: %s)",
-				      response->ToString().CStr(),
-				      info->application_name.CStr(), info->stream_name.CStr(),
-				      (info->offer_sdp != nullptr) ? info->offer_sdp->GetIceUfrag().CStr() : "(N/A)",
-				      (info->peer_sdp != nullptr) ? info->peer_sdp->GetIceUfrag().CStr() : "(N/A)"
-				);
-			}
-			else
+		response->Send(writer);
+
+		return false;
+	}
+
+	return true;
+}
+
+void RtcSignallingServer::ProcessClose(std::shared_ptr<RtcSignallingInfo> info, const std::shared_ptr<WebSocketClient> &response)
+{
+	if(info->id != P2P_INVALID_PEER_ID)
+	{
+		// The client is disconnected without send "close" command
+
+		// Forces the session to be cleaned up by sending a stop command
+		DispatchStop(info);
+	}
+
+	logti("Client is disconnected: %s (%s / %s, ufrag: local: %s, remote: %s)",
+	      response->ToString().CStr(),
+	      info->application_name.CStr(), info->stream_name.CStr(),
+	      (info->offer_sdp != nullptr) ? info->offer_sdp->GetIceUfrag().CStr() : "(N/A)",
+	      (info->peer_sdp != nullptr) ? info->peer_sdp->GetIceUfrag().CStr() : "(N/A)"
+	);
+}
+
+bool RtcSignallingServer::InitializeWhepServer()
+{
+	// The WebSocket interceptor is checked first, and the other requests are handled by this interceptor
+	auto whep = std::make_shared<HttpDefaultInterceptor>();
+
+	whep->Register(HttpMethod::Post, R"(/[^/?#]+/[^/?#]+/whep([?#].*)?)", std::bind(&RtcSignallingServer::OnWhepOffer, this, std::placeholders::_1, std::placeholders::_2));
+	whep->Register(HttpMethod::Delete, R"(/[^/?#]+/[^/?#]+/whep/[0-9]+([?#].*)?)", std::bind(&RtcSignallingServer::OnWhepDelete, this, std::placeholders::_1, std::placeholders::_2));
+
+	// Preflight of the browsers (the players of the other origins send application/sdp)
+	whep->Register(HttpMethod::Options, R"(/[^/?#]+/[^/?#]+/whep(/[0-9]+)?([?#].*)?)", [](const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response) -> void
+	{
+		SetWhepCorsHeaders(response);
+		response->SetStatusCode(HttpStatusCode::NoContent);
+		response->Response();
+	});
+
+	return _http_server->AddInterceptor(whep);
+}
+
+void RtcSignallingServer::SetWhepCorsHeaders(const std::shared_ptr<HttpResponse> &response)
+{
+	response->SetHeader("Access-Control-Allow-Origin", "*");
+	response->SetHeader("Access-Control-Allow-Methods", "POST, DELETE, OPTIONS");
+	response->SetHeader("Access-Control-Allow-Headers", "Content-Type");
+	response->SetHeader("Access-Control-Expose-Headers", "Location");
+}
+
+ov::String RtcSignallingServer::AddCandidatesToSdp(const ov::String &sdp, const std::vector<RtcIceCandidate> &candidates)
+{
+	off_t media_position = sdp.IndexOf("m=");
+
+	if(media_position < 0)
+	{
+		return sdp;
+	}
+
+	// The end of the first m= section
+	off_t next_media_position = sdp.IndexOf("\r\nm=", media_position);
+	size_t insert_position = (next_media_position < 0) ? sdp.GetLength() : static_cast<size_t>(next_media_position + 2);
+
+	ov::String result = sdp.Left(insert_position);
+
+	for(const auto &candidate : candidates)
+	{
+		result.AppendFormat("a=%s\r\n", candidate.GetCandidateString().CStr());
+	}
+
+	result.Append("a=end-of-candidates\r\n");
+	result.Append(sdp.Substring(insert_position));
+
+	return result;
+}
+
+void RtcSignallingServer::OnWhepOffer(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response)
+{
+	SetWhepCorsHeaders(response);
+
+	// "/<app>/<stream>/whep"
+	auto tokens = request->GetUri().Split("?")[0].Split("/");
+
+	if(tokens.size() < 4)
+	{
+		response->SetStatusCode(HttpStatusCode::BadRequest);
+		response->Response();
+		return;
+	}
+
+	ov::String application_name = tokens[1];
+	ov::String stream_name = tokens[2];
+	ov::String content_type = request->GetHeader("CONTENT-TYPE");
+
+	if((content_type.IsEmpty() == false) && (content_type.LowerCaseString().HasPrefix("application/sdp") == false))
+	{
+		response->SetStatusCode(HttpStatusCode::UnsupportedMediaType);
+		response->Response();
+		return;
+	}
+
+	ov::String reason = GetOverloadReason(application_name, stream_name);
+
+	if(reason.IsEmpty() == false)
+	{
+		ov::String url = GetRedirectUrl(application_name, stream_name);
+
+		if(url.IsEmpty())
+		{
+			logtw("Reject the WHEP client %s for stream (%s/%s) - %s", request->GetRemote()->ToString().CStr(), application_name.CStr(), stream_name.CStr(), reason.CStr());
+
+			response->SetStatusCode(HttpStatusCode::ServiceUnavailable);
+		}
+		else
+		{
+			url.Append("/whep");
+
+			logtw("Redirect the WHEP client %s for stream (%s/%s) to %s - %s", request->GetRemote()->ToString().CStr(), application_name.CStr(), stream_name.CStr(), url.CStr(), reason.CStr());
+
+			response->SetStatusCode(HttpStatusCode::TemporaryRedirect);
+			response->SetHeader("Location", url);
+		}
+
+		response->Response();
+		return;
+	}
+
+	auto body = request->GetRequestBody();
+	auto offer_sdp = std::make_shared<SessionDescription>();
+
+	if((body == nullptr) || (offer_sdp->FromString(ov::String(body->GetDataAs<char>(), body->GetLength())) == false))
+	{
+		logtw("Invalid offer from the WHEP client %s", request->GetRemote()->ToString().CStr());
+
+		response->SetStatusCode(HttpStatusCode::BadRequest);
+		response->Response();
+		return;
+	}
+
+	std::vector<RtcIceCandidate> local_candidates;
+	std::shared_ptr<SessionDescription> answer_sdp = nullptr;
+
+	std::find_if(_observers.begin(), _observers.end(), [&](auto &observer) -> bool
+	{
+		answer_sdp = observer->OnRequestAnswer(application_name, stream_name, offer_sdp, &local_candidates);
+		return answer_sdp != nullptr;
+	});
+
+	ov::String answer_sdp_text;
+
+	if((answer_sdp == nullptr) || (answer_sdp->ToString(answer_sdp_text) == false))
+	{
+		logtw("Could not answer the offer of the WHEP client %s for stream (%s/%s)", request->GetRemote()->ToString().CStr(), application_name.CStr(), stream_name.CStr());
+
+		response->SetStatusCode((answer_sdp == nullptr) ? HttpStatusCode::NotFound : HttpStatusCode::InternalServerError);
+		response->Response();
+		return;
+	}
+
+	auto info = std::make_shared<RtcSignallingInfo>(
+		application_name, stream_name,
+		P2P_INVALID_PEER_ID, nullptr,
+		answer_sdp, offer_sdp,
+		local_candidates, std::vector<RtcIceCandidate>()
+	);
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_whep_session_list_mutex);
+
+		while(true)
+		{
+			peer_id_t id = ov::Random::GenerateInt32(1, INT32_MAX);
+
+			if(_whep_session_list.find(id) == _whep_session_list.end())
 			{
-				// The client is disconnected before websocket negotiation
+				info->id = id;
+				_whep_session_list[id] = info;
+
+				break;
 			}
-		});
+		}
+	}
 
-	return _http_server->AddInterceptor(web_socket);
+	logti("WHEP client %s is answered for stream (%s/%s, id: %d)", request->GetRemote()->ToString().CStr(), application_name.CStr(), stream_name.CStr(), info->id);
+
+	response->SetStatusCode(HttpStatusCode::Created);
+	response->SetHeader("Content-Type", "application/sdp");
+	response->SetHeader("Location", ov::String::FormatString("/%s/%s/whep/%d", application_name.CStr(), stream_name.CStr(), info->id));
+	response->AppendString(AddCandidatesToSdp(answer_sdp_text, local_candidates));
+	response->Response();
+}
+
+void RtcSignallingServer::OnWhepDelete(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response)
+{
+	SetWhepCorsHeaders(response);
+
+	// "/<app>/<stream>/whep/<id>"
+	auto tokens = request->GetUri().Split("?")[0].Split("/");
+	std::shared_ptr<RtcSignallingInfo> info = nullptr;
+
+	if(tokens.size() >= 5)
+	{
+		peer_id_t id = ov::Converter::ToInt32(tokens[4]);
+
+		std::lock_guard<std::mutex> lock_guard(_whep_session_list_mutex);
+
+		auto item = _whep_session_list.find(id);
+
+		if((item != _whep_session_list.end()) && (item->second->application_name == tokens[1]) && (item->second->stream_name == tokens[2]))
+		{
+			info = item->second;
+			_whep_session_list.erase(item);
+		}
+	}
+
+	if(info == nullptr)
+	{
+		response->SetStatusCode(HttpStatusCode::NotFound);
+		response->Response();
+		return;
+	}
+
+	logti("WHEP session is deleted by %s (%s/%s, id: %d)", request->GetRemote()->ToString().CStr(), info->application_name.CStr(), info->stream_name.CStr(), info->id);
+
+	for(auto &observer : _observers)
+	{
+		observer->OnStopCommand(info->application_name, info->stream_name, info->offer_sdp, info->peer_sdp);
+	}
+
+	response->SetStatusCode(HttpStatusCode::OK);
+	response->Response();
 }
 
 bool RtcSignallingServer::AddObserver(const std::shared_ptr<RtcSignallingObserver> &observer)
@@ -307,6 +649,25 @@ bool RtcSignallingServer::Disconnect(const ov::String &application_name, const o
 			return false;
 		});
 
+	{
+		// The ICE connection of a WHEP session is closed
+		std::lock_guard<std::mutex> lock_guard(_whep_session_list_mutex);
+
+		for(auto item = _whep_session_list.begin(); item != _whep_session_list.end(); ++item)
+		{
+			auto &info = item->second;
+
+			if((info->application_name == application_name) && (info->stream_name == stream_name) && (*(info->peer_sdp) == *peer_sdp))
+			{
+				logti("WHEP session is disconnected (%s/%s, id: %d)", application_name.CStr(), stream_name.CStr(), info->id);
+
+				_whep_session_list.erase(item);
+				disconnected = true;
+				break;
+			}
+		}
+	}
+
 	if(disconnected == false)
 	{
 		// ICE 연결이 끊어져 Disconnect()이 호출 된 직후, _http_server->Disconnect()이 실행되기 전 타이밍에
@@ -407,9 +768,16 @@ bool RtcSignallingServer::Stop()
 		return false;
 	}
 
+	if(_drain_timer_id != 0)
+	{
+		ov::SharedTimerWheel::Instance()->Cancel(_drain_timer_id);
+		_drain_timer_id = 0;
+	}
+
 	if(_http_server->Stop())
 	{
-		_http_server = nullptr;
+		// The workers may be disconnecting the clients
+		std::atomic_store(&_http_server, std::shared_ptr<HttpServer>());
 
 		return true;
 	}
@@ -444,6 +812,14 @@ std::shared_ptr<ov::Error> RtcSignallingServer::DispatchCommand(const ov::String
 	{
 		return DispatchCandidateP2P(object, info);
 	}
+	else if(command == "p2p_stats")
+	{
+		return DispatchP2PStats(object, info);
+	}
+	else if(command == "subscribe")
+	{
+		return DispatchSubscribe(object, info);
+	}
 	else if(command == "stop")
 	{
 		return DispatchStop(info);
@@ -455,10 +831,6 @@ std::shared_ptr<ov::Error> RtcSignallingServer::DispatchCommand(const ov::String
 
 std::shared_ptr<ov::Error> RtcSignallingServer::DispatchRequestOffer(std::shared_ptr<RtcSignallingInfo> &info, const std::shared_ptr<WebSocketClient> &response)
 {
-	ov::String application_name = info->application_name;
-	ov::String stream_name = info->stream_name;
-
-	std::shared_ptr<SessionDescription> sdp = nullptr;
 	std::shared_ptr<ov::Error> error = nullptr;
 
 	logtd("Trying to find p2p host for client %s...", response->ToString().CStr());
@@ -501,103 +873,271 @@ std::shared_ptr<ov::Error> RtcSignallingServer::DispatchRequestOffer(std::shared
 		logtd("peer %s became a host peer because there is no p2p host for client %s.", peer_info->ToString().CStr(), response->ToString().CStr());
 
 		// None of the hosts can accept this client
-		std::find_if(_observers.begin(), _observers.end(), [info, &sdp, application_name, stream_name](auto &observer) -> bool
+		error = CheckAdmission(info, response);
+
+		if(error == nullptr)
 		{
-			// Ask observer to fill local_candidates
-			sdp = observer->OnRequestOffer(application_name, stream_name, &(info->local_candidates));
-			return sdp != nullptr;
-		});
+			error = SendOfferFromOme(info, response);
+		}
+	}
+	else
+	{
+		info->peer_was_client = true;
+		// Found a host that can accept this client
+		logtd("[Client -> Host] Host %s found for client %s", host_peer->ToString().CStr(), peer_info->ToString().CStr());
+
+		// Send 'request_offer_p2p' command to the host
+		SendRequestOfferP2P(host_peer, peer_info);
+
+		// Wait for 'offer_p2p' command from the host
+
+		// TODO(dimiden): Timeout is required because host peer may not give offer for too long
+	}
+
+	return error;
+}
+
+ov::String RtcSignallingServer::GetOverloadReason(const ov::String &application_name, const ov::String &stream_name)
+{
+	// Regardless of <AdmissionControl>
+	if(ov::MemoryGovernor::Instance()->IsLevel(ov::MemoryGovernorLevel::RefuseNew))
+	{
+		return "memory pressure";
+	}
+
+	if(ov::DrainMode::Instance()->IsDraining())
+	{
+		return "draining";
+	}
 
-		if(sdp != nullptr)
+	// <Quota> of the application (the streams of the application haven't been created if it is not found)
+	auto quota_statistics = ApplicationQuota::Instance()->FindStatistics(application_name);
+
+	if(quota_statistics != nullptr)
+	{
+		ov::String quota_reason = quota_statistics->GetSessionRejectReason();
+
+		if(quota_reason.IsEmpty() == false)
 		{
-			logtd("SDP is generated successfully");
+			return quota_reason;
+		}
+	}
 
-			if(_p2p_manager.RegisterAsHostPeer(peer_info) == false)
-			{
-				OV_ASSERT2(false);
-				return ov::Error::CreateError(HttpStatusCode::InternalServerError, "Could not add host peer");
-			}
+	if(_admission_control_info->IsParsed() == false)
+	{
+		return "";
+	}
 
-			ov::JsonObject response_json;
+	ov::String reason;
 
-			Json::Value &value = response_json.GetJsonValue();
+	int max_egress_bitrate = _admission_control_info->GetMaxEgressBitrate();
+	int max_cpu_usage = _admission_control_info->GetMaxCpuUsage();
+	int max_send_latency = _admission_control_info->GetMaxSendLatency();
 
-			// SDP를 계산함
-			Json::Value &sdp_value = value["sdp"];
+	if((max_egress_bitrate > 0) || (max_cpu_usage > 0))
+	{
+		auto load = ov::SystemLoad::Instance()->GetLoad();
 
-			ov::String offer_sdp;
+		if(max_egress_bitrate > 0)
+		{
+			uint64_t bitrate = 0;
 
-			if(sdp->ToString(offer_sdp))
+			for(auto &observer : _observers)
 			{
-				value["command"] = "offer";
-				value["id"] = info->id;
-				value["peer_id"] = P2P_OME_PEER_ID;
-				sdp_value["sdp"] = offer_sdp.CStr();
-				sdp_value["type"] = "offer";
-
-				// candidates: [ <candidate>, <candidate>, ... ]
-				Json::Value candidates(Json::ValueType::arrayValue);
-
-				// candiate:
-				// {
-				//     "candidate":"candidate:0 1 UDP 50 192.168.0.183 10000 typ host generation 0",
-				//     "sdpMLineIndex":0,
-				//     "sdpMid":"video"
-				// }
-				// local candidate 목록을 client로 보냄
-				for(const auto &candidate : info->local_candidates)
+				bitrate = observer->OnGetBitrate(application_name, stream_name);
+
+				if(bitrate != 0)
 				{
-					Json::Value item;
+					break;
+				}
+			}
 
-					item["candidate"] = candidate.GetCandidateString().CStr();
-					item["sdpMLineIndex"] = candidate.GetSdpMLineIndex();
-					if(candidate.GetSdpMid().IsEmpty() == false)
-					{
-						item["sdpMid"] = candidate.GetSdpMid().CStr();
-					}
+			// Includes the bitrate of the new viewer
+			if((load.egress_bps + bitrate) > (static_cast<uint64_t>(max_egress_bitrate) * 1000000ULL))
+			{
+				reason.Format("egress bitrate: %" PRIu64 " + %" PRIu64 " bps", load.egress_bps, bitrate);
+			}
+		}
 
-					candidates.append(item);
-				}
-				value["candidates"] = candidates;
-				value["code"] = static_cast<int>(HttpStatusCode::OK);
+		if(reason.IsEmpty() && (max_cpu_usage > 0) && (load.cpu_usage > max_cpu_usage))
+		{
+			reason.Format("CPU usage: %.1f%%", load.cpu_usage);
+		}
+	}
 
-				info->offer_sdp = sdp;
+	if(reason.IsEmpty() && (max_send_latency > 0))
+	{
+		for(auto &observer : _observers)
+		{
+			uint64_t latency = observer->OnGetSendLatency(application_name, stream_name);
 
-				response->Send(response_json.ToString());
+			if(latency > (static_cast<uint64_t>(max_send_latency) * 1000ULL))
+			{
+				reason.Format("send latency: %" PRIu64 " us", latency);
+				break;
 			}
-			else
+		}
+	}
+
+	return reason;
+}
+
+ov::String RtcSignallingServer::GetRedirectUrl(const ov::String &application_name, const ov::String &stream_name)
+{
+	auto &redirect_urls = _admission_control_info->GetRedirectUrls();
+
+	if(redirect_urls.empty())
+	{
+		return "";
+	}
+
+	ov::String url = redirect_urls[_redirect_index++ % redirect_urls.size()].GetUrl();
+
+	if(url.HasSuffix("/") == false)
+	{
+		url.Append('/');
+	}
+
+	url.AppendFormat("%s/%s", application_name.CStr(), stream_name.CStr());
+
+	return url;
+}
+
+std::shared_ptr<ov::Error> RtcSignallingServer::CheckAdmission(const std::shared_ptr<RtcSignallingInfo> &info, const std::shared_ptr<WebSocketClient> &response)
+{
+	ov::String reason = GetOverloadReason(info->application_name, info->stream_name);
+
+	if(reason.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	ov::String url = GetRedirectUrl(info->application_name, info->stream_name);
+
+	if(url.IsEmpty())
+	{
+		logtw("Reject the client %s for stream (%s/%s) - %s", response->ToString().CStr(), info->application_name.CStr(), info->stream_name.CStr(), reason.CStr());
+
+		return ov::Error::CreateError(HttpStatusCode::ServiceUnavailable, "Server is overloaded");
+	}
+
+	logtw("Redirect the client %s for stream (%s/%s) to %s - %s", response->ToString().CStr(), info->application_name.CStr(), info->stream_name.CStr(), url.CStr(), reason.CStr());
+
+	auto &writer = GetResponseWriter();
+
+	writer.BeginObject()
+		.Member("command", "redirect")
+		.Member("id", info->id)
+		.Member("code", static_cast<int>(HttpStatusCode::TemporaryRedirect))
+		.Member("url", url)
+		.EndObject();
+
+	response->Send(writer);
+
+	return ov::Error::CreateError(HttpStatusCode::TemporaryRedirect, "Redirected to %s", url.CStr());
+}
+
+std::shared_ptr<ov::Error> RtcSignallingServer::SendOfferFromOme(std::shared_ptr<RtcSignallingInfo> &info, const std::shared_ptr<WebSocketClient> &response)
+{
+	ov::String application_name = info->application_name;
+	ov::String stream_name = info->stream_name;
+	auto peer_info = info->peer_info;
+
+	std::shared_ptr<SessionDescription> sdp = nullptr;
+	std::shared_ptr<ov::Error> error = nullptr;
+
+	std::find_if(_observers.begin(), _observers.end(), [info, &sdp, application_name, stream_name](auto &observer) -> bool
+	{
+		// Ask observer to fill local_candidates
+		sdp = observer->OnRequestOffer(application_name, stream_name, &(info->local_candidates));
+		return sdp != nullptr;
+	});
+
+	if(sdp != nullptr)
+	{
+		logtd("SDP is generated successfully");
+
+		if(_p2p_manager.RegisterAsHostPeer(peer_info, _p2p_info->GetClientPeersPerHostPeer()) == false)
+		{
+			OV_ASSERT2(false);
+			return ov::Error::CreateError(HttpStatusCode::InternalServerError, "Could not add host peer");
+		}
+
+		// SDP를 계산함
+		ov::String offer_sdp;
+
+		if(sdp->ToString(offer_sdp))
+		{
+			auto &writer = GetResponseWriter();
+
+			writer.BeginObject()
+				.Member("command", "offer")
+				.Member("id", info->id)
+				.Member("peer_id", P2P_OME_PEER_ID);
+
+			writer.Key("sdp").BeginObject()
+				.Member("sdp", offer_sdp)
+				.Member("type", "offer")
+				.EndObject();
+
+			// candidates: [ <candidate>, <candidate>, ... ]
+			writer.Key("candidates").BeginArray();
+
+			// candiate:
+			// {
+			//     "candidate":"candidate:0 1 UDP 50 192.168.0.183 10000 typ host generation 0",
+			//     "sdpMLineIndex":0,
+			//     "sdpMid":"video"
+			// }
+			// local candidate 목록을 client로 보냄
+			for(const auto &candidate : info->local_candidates)
 			{
-				logtw("Could not create SDP for stream %s", info->stream_name.CStr());
-				error = ov::Error::CreateError(HttpStatusCode::NotFound, "Cannot create offer");
+				writer.BeginObject()
+					.Member("candidate", candidate.GetCandidateString())
+					.Member("sdpMLineIndex", candidate.GetSdpMLineIndex());
+
+				if(candidate.GetSdpMid().IsEmpty() == false)
+				{
+					writer.Member("sdpMid", candidate.GetSdpMid());
+				}
+
+				writer.EndObject();
 			}
+
+			writer.EndArray()
+				.Member("code", static_cast<int>(HttpStatusCode::OK))
+				.EndObject();
+
+			info->offer_sdp = sdp;
+
+			response->Send(writer);
 		}
 		else
 		{
-			// cannot create offer
+			logtw("Could not create SDP for stream %s", info->stream_name.CStr());
 			error = ov::Error::CreateError(HttpStatusCode::NotFound, "Cannot create offer");
 		}
 	}
 	else
 	{
-		info->peer_was_client = true;
-		// Found a host that can accept this client
-		logtd("[Client -> Host] Host %s found for client %s", host_peer->ToString().CStr(), peer_info->ToString().CStr());
-
-		// Send 'request_offer_p2p' command to the host
-		Json::Value value;
-
-		value["command"] = "request_offer_p2p";
-		value["id"] = host_peer->GetId();
-		value["peer_id"] = peer_info->GetId();
+		// cannot create offer
+		error = ov::Error::CreateError(HttpStatusCode::NotFound, "Cannot create offer");
+	}
 
-		host_peer->GetResponse()->Send(value);
+	return error;
+}
 
-		// Wait for 'offer_p2p' command from the host
+void RtcSignallingServer::SendRequestOfferP2P(const std::shared_ptr<RtcPeerInfo> &host_peer, const std::shared_ptr<RtcPeerInfo> &client_peer)
+{
+	auto &writer = GetResponseWriter();
 
-		// TODO(dimiden): Timeout is required because host peer may not give offer for too long
-	}
+	writer.BeginObject()
+		.Member("command", "request_offer_p2p")
+		.Member("id", host_peer->GetId())
+		.Member("peer_id", client_peer->GetId())
+		.EndObject();
 
-	return error;
+	host_peer->GetResponse()->Send(writer);
 }
 
 std::shared_ptr<ov::Error> RtcSignallingServer::DispatchAnswer(const ov::JsonObject &object, std::shared_ptr<RtcSignallingInfo> &info)
@@ -669,14 +1209,20 @@ std::shared_ptr<ov::Error> RtcSignallingServer::DispatchAnswer(const ov::JsonObj
 			return ov::Error::CreateError(HttpStatusCode::BadRequest, "Invalid peer id: %d", peer_id);
 		}
 
-		Json::Value value;
+		auto &writer = GetResponseWriter();
 
-		value["command"] = "answer_p2p";
-		value["id"] = host_peer->GetId();
-		value["peer_id"] = peer_info->GetId();
-		value["sdp"] = sdp_value;
+		// sdp_value is the object which is parsed from the answer of the client
+		writer.BeginObject()
+			.Member("command", "answer_p2p")
+			.Member("id", host_peer->GetId())
+			.Member("peer_id", peer_info->GetId())
+			.Key("sdp").Value(sdp_value)
+			.EndObject();
 
-		host_peer->GetResponse()->Send(value);
+		host_peer->GetResponse()->Send(writer);
+
+		// The client will receive the stream from the host, so it can relay the stream to other clients
+		_p2p_manager.RegisterAsRelayPeer(peer_info, _p2p_info->GetClientPeersPerHostPeer());
 	}
 
 	return nullptr;
@@ -735,14 +1281,16 @@ std::shared_ptr<ov::Error> RtcSignallingServer::DispatchCandidate(const ov::Json
 		logtd("[Client -> Host] The client peer sent candidates: %s", object.ToString().CStr());
 
 		// Client -> (OME) -> Host
-		Json::Value value;
+		auto &writer = GetResponseWriter();
 
-		value["command"] = "candidate_p2p";
-		value["id"] = peer_info->GetId();
-		value["peer_id"] = info->id;
-		value["candidates"] = candidates_value;
+		writer.BeginObject()
+			.Member("command", "candidate_p2p")
+			.Member("id", peer_info->GetId())
+			.Member("peer_id", info->id)
+			.Key("candidates").Value(candidates_value)
+			.EndObject();
 
-		peer_info->GetResponse()->Send(value);
+		peer_info->GetResponse()->Send(writer);
 	}
 
 	return nullptr;
@@ -793,18 +1341,22 @@ std::shared_ptr<ov::Error> RtcSignallingServer::DispatchOfferP2P(const ov::JsonO
 
 	logtd("[Host -> Client] The host peer sent an offer: %s", object.ToString().CStr());
 
-	Json::Value value;
+	auto &writer = GetResponseWriter();
+
+	writer.BeginObject()
+		.Member("command", "offer")
+		.Member("id", client_peer->GetId())
+		.Member("peer_id", host->GetId())
+		.Key("sdp").Value(sdp_value);
 
-	value["command"] = "offer";
-	value["id"] = client_peer->GetId();
-	value["peer_id"] = host->GetId();
-	value["sdp"] = sdp_value;
 	if(candidates.isNull() == false)
 	{
-		value["candidates"] = candidates;
+		writer.Key("candidates").Value(candidates);
 	}
 
-	client_peer->GetResponse()->Send(value);
+	writer.EndObject();
+
+	client_peer->GetResponse()->Send(writer);
 
 	return nullptr;
 }
@@ -840,18 +1392,143 @@ std::shared_ptr<ov::Error> RtcSignallingServer::DispatchCandidateP2P(const ov::J
 
 	logtd("[Host -> Client] The host peer sent candidates: %s", object.ToString().CStr());
 
-	Json::Value candidates;
+	auto &writer = GetResponseWriter();
+
+	writer.BeginObject()
+		.Member("command", "candidate")
+		.Member("id", client_peer->GetId())
+		.Member("peer_id", info->id)
+		.Key("candidates").Value(candidates_value)
+		.EndObject();
+
+	client_peer->GetResponse()->Send(writer);
+
+	return nullptr;
+}
+
+std::shared_ptr<ov::Error> RtcSignallingServer::DispatchP2PStats(const ov::JsonObject &object, std::shared_ptr<RtcSignallingInfo> &info)
+{
+	auto &peer_info = info->peer_info;
+
+	if(peer_info == nullptr)
+	{
+		return ov::Error::CreateError(HttpStatusCode::BadRequest, "Could not find peer id: %d", info->id);
+	}
+
+	// {
+	//     "command": "p2p_stats",
+	//     "id": <id>,
+	//     "uplink": <kbps>,
+	//     "rtt": <ms, between the peer and its host or OME>,
+	//     "nat": "open" | "full_cone" | "restricted" | "port_restricted" | "symmetric"
+	// }
+	const Json::Value &nat_value = object.GetJsonValue("nat");
+	RtcNatType nat_type = nat_value.isString() ? RtcPeerInfo::ParseNatType(nat_value.asCString()) : RtcNatType::Unknown;
+
+	_p2p_manager.UpdatePeerStats(peer_info, object.GetIntValue("uplink"), object.GetIntValue("rtt"), nat_type, _p2p_info->GetClientPeersPerHostPeer());
+
+	logtd("The peer reported the stats: %s", object.ToString().CStr());
 
-	candidates["command"] = "candidate";
-	candidates["id"] = client_peer->GetId();
-	candidates["peer_id"] = info->id;
-	candidates["candidates"] = candidates_value;
+	return nullptr;
+}
 
-	client_peer->GetResponse()->Send(candidates);
+std::shared_ptr<ov::Error> RtcSignallingServer::DispatchSubscribe(const ov::JsonObject &object, std::shared_ptr<RtcSignallingInfo> &info)
+{
+	if(info->peer_sdp == nullptr)
+	{
+		return ov::Error::CreateError(HttpStatusCode::BadRequest, "The session is not created yet: %d", info->id);
+	}
+
+	// {
+	//     "command": "subscribe",
+	//     "id": <id>,
+	//     "audio": <bool, default: true>,
+	//     "video": <bool, default: true, false: paused (e.g. the player is in the background)>,
+	//     "max_height": <pixels of the video layer, default: 0 (unlimited)>
+	// }
+	const Json::Value &audio_value = object.GetJsonValue("audio");
+	const Json::Value &video_value = object.GetJsonValue("video");
+
+	bool audio = audio_value.isBool() ? audio_value.asBool() : true;
+	bool video = video_value.isBool() ? video_value.asBool() : true;
+	int32_t max_height = std::max(object.GetIntValue("max_height"), 0);
+
+	for(auto &observer : _observers)
+	{
+		logtd("Trying to callback OnSubscribeCommand to %p for client %d (%s / %s)...", observer.get(), info->id, info->application_name.CStr(), info->stream_name.CStr());
+
+		if(observer->OnSubscribeCommand(info->application_name, info->stream_name, info->offer_sdp, info->peer_sdp, audio, video, max_height) == false)
+		{
+			return ov::Error::CreateError(HttpStatusCode::NotFound, "Could not find the session: %d", info->id);
+		}
+	}
 
 	return nullptr;
 }
 
+void RtcSignallingServer::RepairClientPeers(const std::shared_ptr<RtcPeerInfo> &peer_info)
+{
+	auto client_list = _p2p_manager.GetClientPeerList(peer_info);
+
+	for(auto &client : client_list)
+	{
+		auto &client_info = client.second;
+
+		auto &writer = GetResponseWriter();
+
+		writer.BeginObject()
+			.Member("command", "stop")
+			.Member("id", client_info->GetId())
+			.Member("peer_id", peer_info->GetId())
+			.EndObject();
+
+		client_info->GetResponse()->Send(writer);
+
+		// Move the client (and its subtree) to another peer
+		auto host_peer = _p2p_manager.TryToReattachClientPeer(client_info, _p2p_info->GetClientPeersPerHostPeer());
+
+		if(host_peer != nullptr)
+		{
+			logtd("[Client -> Host] Host %s found for orphaned client %s", host_peer->ToString().CStr(), client_info->ToString().CStr());
+
+			SendRequestOfferP2P(host_peer, client_info);
+			continue;
+		}
+
+		// None of the peers can accept the client, OME serves it
+		std::shared_ptr<RtcSignallingInfo> signalling_info;
+
+		{
+			std::lock_guard<std::mutex> lock_guard(_client_list_mutex);
+
+			auto item = _client_list.find(client_info->GetId());
+
+			if(item != _client_list.end())
+			{
+				signalling_info = item->second;
+			}
+		}
+
+		if((signalling_info == nullptr) || (signalling_info->peer_info != client_info))
+		{
+			// The client is stopped
+			_p2p_manager.RemovePeer(client_info, _p2p_info->GetClientPeersPerHostPeer());
+			continue;
+		}
+
+		logtd("peer %s became a host peer because there is no p2p host for orphaned client", client_info->ToString().CStr());
+
+		auto error = SendOfferFromOme(signalling_info, client_info->GetResponse());
+
+		if(error != nullptr)
+		{
+			logtw("Could not send offer to orphaned client %s: %s", client_info->ToString().CStr(), error->ToString().CStr());
+
+			_p2p_manager.RemovePeer(client_info, _p2p_info->GetClientPeersPerHostPeer());
+		}
+	}
+}
+
 std::shared_ptr<ov::Error> RtcSignallingServer::DispatchStop(std::shared_ptr<RtcSignallingInfo> &info)
 {
 	bool result = true;
@@ -890,54 +1567,41 @@ std::shared_ptr<ov::Error> RtcSignallingServer::DispatchStop(std::shared_ptr<Rtc
 		{
 			logtd("Deleting peer %s from p2p manager...", peer_info->ToString().CStr());
 
+			// RemovePeer() detaches the peer from the host peer
+			auto host_info = peer_info->GetHostPeer();
+
 			_p2p_manager.RemovePeer(peer_info, _p2p_info->GetClientPeersPerHostPeer());
 
 			if(peer_info->IsHost())
 			{
-				logtd("[Host -> OME] The host peer is requested stop", peer_info->ToString().CStr());
-
-				// Broadcast to client peers
-				auto client_list = _p2p_manager.GetClientPeerList(peer_info);
-
-				for(auto &client : client_list)
-				{
-					auto &client_info = client.second;
-
-					Json::Value value;
-
-					value["command"] = "stop";
-					value["id"] = client_info->GetId();
-					value["peer_id"] = peer_info->GetId();
-
-					client_info->GetResponse()->Send(value);
-
-					// remove client from peer
-					_p2p_manager.RemovePeer(client_info, _p2p_info->GetClientPeersPerHostPeer());
-				}
+				logtd("[Host -> OME] The host peer is requested stop: %s", peer_info->ToString().CStr());
 			}
 			else
 			{
 				// Client peer -> OME
-				logtd("[Client -> OME] The client peer is requested stop", peer_info->ToString().CStr());
+				logtd("[Client -> OME] The client peer is requested stop: %s", peer_info->ToString().CStr());
 
 				// Send to host peer
-				auto host_info = peer_info->GetHostPeer();
-
 				if(host_info != nullptr)
 				{
-					Json::Value value;
+					auto &writer = GetResponseWriter();
 
-					value["command"] = "stop";
-					value["id"] = host_info->GetId();
-					value["peer_id"] = peer_info->GetId();
+					writer.BeginObject()
+						.Member("command", "stop")
+						.Member("id", host_info->GetId())
+						.Member("peer_id", peer_info->GetId())
+						.EndObject();
 
-					host_info->GetResponse()->Send(value);
+					host_info->GetResponse()->Send(writer);
 				}
 				else
 				{
 					// The peer disconnected before dispatch request_offer
 				}
 			}
+
+			// The host peer and the relay peer have the client peers
+			RepairClientPeers(peer_info);
 		}
 		else
 		{
@@ -952,3 +1616,66 @@ std::shared_ptr<ov::Error> RtcSignallingServer::DispatchStop(std::shared_ptr<Rtc
 
 	return nullptr;
 }
+
+int64_t RtcSignallingServer::MoveDrainingClients()
+{
+	if(ov::DrainMode::Instance()->IsDraining() == false)
+	{
+		return RTC_SIGNALLING_DRAIN_INTERVAL;
+	}
+
+	std::vector<std::shared_ptr<RtcSignallingInfo>> infos;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_client_list_mutex);
+
+		for(auto &client_item : _client_list)
+		{
+			auto &info = client_item.second;
+
+			// The ids are random, so the clients are moved evenly in the stagger window
+			if((info->drain_notified == false) && ov::DrainMode::Instance()->ShouldMove(static_cast<uint64_t>(info->id)))
+			{
+				info->drain_notified = true;
+				infos.push_back(info);
+			}
+		}
+	}
+
+	// Sends the commands without the lock of the list
+	for(const auto &info : infos)
+	{
+		auto client = info->client.lock();
+
+		if(client == nullptr)
+		{
+			continue;
+		}
+
+		ov::String url = GetRedirectUrl(info->application_name, info->stream_name);
+		auto &writer = GetResponseWriter();
+
+		if(url.IsEmpty())
+		{
+			writer.BeginObject()
+				.Member("command", "reconnect")
+				.Member("id", info->id)
+				.EndObject();
+		}
+		else
+		{
+			writer.BeginObject()
+				.Member("command", "redirect")
+				.Member("id", info->id)
+				.Member("code", static_cast<int>(HttpStatusCode::TemporaryRedirect))
+				.Member("url", url)
+				.EndObject();
+		}
+
+		logti("The client %s (%s/%s) is asked to move while draining", client->ToString().CStr(), info->application_name.CStr(), info->stream_name.CStr());
+
+		client->Send(writer);
+	}
+
+	return RTC_SIGNALLING_DRAIN_INTERVAL;
+}
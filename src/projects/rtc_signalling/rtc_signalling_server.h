@@ -12,6 +12,7 @@
 #include "rtc_ice_candidate.h"
 #include "p2p/rtc_p2p_manager.h"
 
+#include <deque>
 #include <memory>
 
 #include <base/application/application.h>
@@ -24,6 +25,11 @@
 #include <relay/relay.h>
 #include "../base/publisher/publisher.h"
 
+// Interval (ms) to ask the clients to move while draining (see ov::DrainMode)
+#define RTC_SIGNALLING_DRAIN_INTERVAL		500
+// The connection is closed if it sends more commands than this before they are dispatched
+#define RTC_SIGNALLING_MAX_PENDING_COMMANDS	64
+
 class RtcSignallingServer : public ov::EnableSharedFromThis<RtcSignallingServer>
 {
 public:
@@ -42,6 +48,10 @@ public:
 
 	int GetTotalPeerCount() const;
 	int GetClientPeerCount() const;
+
+	// Adds the candidates to the first m= section (the media is bundled), so the peer doesn't need to wait for trickle ICE
+	// (used by WHEP and WHIP)
+	static ov::String AddCandidatesToSdp(const ov::String &sdp, const std::vector<RtcIceCandidate> &candidates);
 	
 protected:
 	struct RtcSignallingInfo
@@ -68,6 +78,20 @@ protected:
 		// client의 candidates
 		std::vector<RtcIceCandidate> remote_candidates;
 
+		// The connection of the client (not kept by the info, the request of the connection keeps the info)
+		std::weak_ptr<WebSocketClient> client;
+		// The client is asked to move to another node while draining
+		bool drain_notified = false;
+
+		// The commands of the connection are dispatched by RtcSignallingWorkerPool in the received order
+		// (the message is nullptr when the connection is closed)
+		std::mutex command_mutex;
+		std::deque<std::pair<std::shared_ptr<WebSocketClient>, std::shared_ptr<const WebSocketFrame>>> pending_commands;
+		// true while ProcessCommands() is posted or running
+		bool command_scheduled = false;
+		// The commands after the failed one are ignored (the connection is being closed)
+		bool command_failed = false;
+
 		RtcSignallingInfo(ov::String application_name, ov::String stream_name,
 		                  peer_id_t id, std::shared_ptr<RtcPeerInfo> peer_info,
 		                  std::shared_ptr<SessionDescription> offer_sdp, std::shared_ptr<SessionDescription> peer_sdp,
@@ -88,17 +112,58 @@ protected:
 
 	bool InitializeWebSocketServer();
 
+	// The commands are dispatched by the workers instead of the threads of the HTTP server (false: too many commands)
+	bool ScheduleCommand(const std::shared_ptr<RtcSignallingInfo> &info, const std::shared_ptr<WebSocketClient> &response, const std::shared_ptr<const WebSocketFrame> &message);
+	// Called by the worker, the commands of a connection are dispatched by one worker at a time
+	void ProcessCommands(const std::shared_ptr<RtcSignallingInfo> &info);
+	// Returns false if the connection must be closed
+	bool ProcessCommand(std::shared_ptr<RtcSignallingInfo> info, const std::shared_ptr<WebSocketClient> &response, const std::shared_ptr<const WebSocketFrame> &message);
+	void ProcessClose(std::shared_ptr<RtcSignallingInfo> info, const std::shared_ptr<WebSocketClient> &response);
+
 	std::shared_ptr<ov::Error> DispatchCommand(const ov::String &command, const ov::JsonObject &object, std::shared_ptr<RtcSignallingInfo> &info, const std::shared_ptr<WebSocketClient> &response, const std::shared_ptr<const WebSocketFrame> &message);
 	std::shared_ptr<ov::Error> DispatchRequestOffer(std::shared_ptr<RtcSignallingInfo> &info, const std::shared_ptr<WebSocketClient> &response);
 	std::shared_ptr<ov::Error> DispatchAnswer(const ov::JsonObject &object, std::shared_ptr<RtcSignallingInfo> &info);
 	std::shared_ptr<ov::Error> DispatchCandidate(const ov::JsonObject &object, std::shared_ptr<RtcSignallingInfo> &info);
 	std::shared_ptr<ov::Error> DispatchOfferP2P(const ov::JsonObject &object, std::shared_ptr<RtcSignallingInfo> &info);
 	std::shared_ptr<ov::Error> DispatchCandidateP2P(const ov::JsonObject &object, std::shared_ptr<RtcSignallingInfo> &info);
+	std::shared_ptr<ov::Error> DispatchP2PStats(const ov::JsonObject &object, std::shared_ptr<RtcSignallingInfo> &info);
+	std::shared_ptr<ov::Error> DispatchSubscribe(const ov::JsonObject &object, std::shared_ptr<RtcSignallingInfo> &info);
 	std::shared_ptr<ov::Error> DispatchStop(std::shared_ptr<RtcSignallingInfo> &info);
 
+	// WHEP (WebRTC-HTTP Egress Protocol)
+	// - POST /<app>/<stream>/whep: the body is the offer of the player, and the answer is responded with the candidates of OME
+	//   (201 Created, Location: /<app>/<stream>/whep/<id>)
+	// - DELETE /<app>/<stream>/whep/<id>: stops the session
+	bool InitializeWhepServer();
+	void OnWhepOffer(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response);
+	void OnWhepDelete(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response);
+	static void SetWhepCorsHeaders(const std::shared_ptr<HttpResponse> &response);
+
+	// Returns the reason if the load of OME exceeds the limits of AdmissionControl (empty if a new viewer can be served)
+	ov::String GetOverloadReason(const ov::String &application_name, const ov::String &stream_name);
+	// Returns the url of the stream on the next redirect edge (empty if not configured)
+	ov::String GetRedirectUrl(const ov::String &application_name, const ov::String &stream_name);
+
+	// Checks the load of OME before serving a new viewer (egress bitrate, CPU usage, send latency of the workers)
+	// - If the viewer is not accepted, it is redirected to another edge (if configured)
+	std::shared_ptr<ov::Error> CheckAdmission(const std::shared_ptr<RtcSignallingInfo> &info, const std::shared_ptr<WebSocketClient> &response);
+
+	// Makes the peer as a host peer, and sends the offer of OME
+	std::shared_ptr<ov::Error> SendOfferFromOme(std::shared_ptr<RtcSignallingInfo> &info, const std::shared_ptr<WebSocketClient> &response);
+	void SendRequestOfferP2P(const std::shared_ptr<RtcPeerInfo> &host_peer, const std::shared_ptr<RtcPeerInfo> &client_peer);
+	// Reattaches the client peers of the removed peer to other peers (or OME)
+	void RepairClientPeers(const std::shared_ptr<RtcPeerInfo> &peer_info);
+
+	// Called by the timer: while draining, the clients chosen by ov::DrainMode::ShouldMove() are asked to move:
+	//   {"command": "redirect", "id": <id>, "code": 307, "url": <url>} if a redirect url of AdmissionControl is configured,
+	//   {"command": "reconnect", "id": <id>} otherwise (the client connects again through the load balancer)
+	// - The WHEP sessions don't have the connection, so they are kept until the deadline
+	int64_t MoveDrainingClients();
+
 	const info::Application *_application_info;
 	const cfg::WebrtcPublisher *_webrtc_publisher_info;
 	const cfg::P2P *_p2p_info;
+	const cfg::AdmissionControl *_admission_control_info;
 
 	std::shared_ptr<MediaRouteApplicationInterface> _application;
 
@@ -109,5 +174,15 @@ protected:
 	std::map<peer_id_t, std::shared_ptr<RtcSignallingInfo>> _client_list;
 	std::mutex _client_list_mutex;
 
+	// Sessions of WHEP (they don't have the WebSocket connection)
+	// key: id of the resource, value: offer_sdp is the answer of OME and peer_sdp is the offer of the player
+	std::map<peer_id_t, std::shared_ptr<RtcSignallingInfo>> _whep_session_list;
+	std::mutex _whep_session_list_mutex;
+
 	RtcP2PManager _p2p_manager;
+
+	// Index of the next redirect url (the load of the other edges is unknown, so they are used in turn)
+	std::atomic<uint32_t> _redirect_index { 0 };
+
+	uint64_t _drain_timer_id = 0;
 };
@@ -0,0 +1,146 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtc_signalling_worker_pool.h"
+
+#include <algorithm>
+
+#define OV_LOG_TAG "Signalling.Worker"
+
+RtcSignallingWorkerPool::~RtcSignallingWorkerPool()
+{
+	Stop();
+}
+
+bool RtcSignallingWorkerPool::Start()
+{
+	std::lock_guard<std::mutex> lock(_start_mutex);
+
+	if(_started)
+	{
+		return _workers.empty() == false;
+	}
+
+	_started = true;
+
+	// The other half delivers the media
+	int worker_count = std::max(static_cast<int>(std::thread::hardware_concurrency()) / 2, 1);
+
+	{
+		std::lock_guard<std::mutex> task_lock(_task_mutex);
+		_running = true;
+	}
+
+	try
+	{
+		for(int index = 0; index < worker_count; index++)
+		{
+			_workers.emplace_back(&RtcSignallingWorkerPool::WorkerThread, this);
+		}
+	}
+	catch(const std::system_error &e)
+	{
+		logte("Failed to start signalling worker thread.");
+
+		if(_workers.empty())
+		{
+			std::lock_guard<std::mutex> task_lock(_task_mutex);
+			_running = false;
+
+			return false;
+		}
+	}
+
+	logti("Signalling worker pool is started with %zu workers", _workers.size());
+
+	return true;
+}
+
+void RtcSignallingWorkerPool::Stop()
+{
+	std::lock_guard<std::mutex> lock(_start_mutex);
+
+	{
+		std::lock_guard<std::mutex> task_lock(_task_mutex);
+
+		_running = false;
+		_tasks.clear();
+		_task_condition.notify_all();
+	}
+
+	for(auto &worker : _workers)
+	{
+		if(worker.joinable())
+		{
+			worker.join();
+		}
+	}
+
+	_workers.clear();
+}
+
+bool RtcSignallingWorkerPool::Post(Task task)
+{
+	if(Start() == false)
+	{
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_task_mutex);
+
+		if(_running == false)
+		{
+			return false;
+		}
+
+		if(_tasks.size() >= RTC_SIGNALLING_MAX_PENDING_TASKS)
+		{
+			logtw("Too many pending signalling tasks (%zu), the task is run by the caller", _tasks.size());
+			return false;
+		}
+
+		_tasks.push_back(std::move(task));
+	}
+
+	_task_condition.notify_one();
+
+	return true;
+}
+
+size_t RtcSignallingWorkerPool::GetPendingCount() const
+{
+	std::lock_guard<std::mutex> lock(_task_mutex);
+
+	return _tasks.size();
+}
+
+void RtcSignallingWorkerPool::WorkerThread()
+{
+	while(true)
+	{
+		Task task;
+
+		{
+			std::unique_lock<std::mutex> lock(_task_mutex);
+
+			_task_condition.wait(lock, [this]() -> bool {
+				return (_running == false) || (_tasks.empty() == false);
+			});
+
+			if(_running == false)
+			{
+				break;
+			}
+
+			task = std::move(_tasks.front());
+			_tasks.pop_front();
+		}
+
+		task();
+	}
+}
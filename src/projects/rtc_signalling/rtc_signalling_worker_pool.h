@@ -0,0 +1,57 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Maximum number of the queued tasks (a task per connection which has the commands)
+#define RTC_SIGNALLING_MAX_PENDING_TASKS		65536
+
+// Thread pool which dispatches the commands of the signalling (request_offer, answer, candidate, ...)
+// out of the threads of the HTTP server
+//
+// - The workers are started by the first Post() (half of the cores)
+// - The tasks are run in any order, the caller serializes the commands of a connection
+//   (see RtcSignallingServer::ScheduleCommand())
+class RtcSignallingWorkerPool : public ov::Singleton<RtcSignallingWorkerPool>
+{
+public:
+	friend class ov::Singleton<RtcSignallingWorkerPool>;
+
+	typedef std::function<void()> Task;
+
+	~RtcSignallingWorkerPool() override;
+
+	// Returns false if the queue is full (the task is not run)
+	bool Post(Task task);
+
+	size_t GetPendingCount() const;
+
+protected:
+	RtcSignallingWorkerPool() = default;
+
+	bool Start();
+	void Stop();
+	void WorkerThread();
+
+	std::mutex _start_mutex;
+	bool _started = false;
+	std::vector<std::thread> _workers;
+
+	mutable std::mutex _task_mutex;
+	std::condition_variable _task_condition;
+	std::deque<Task> _tasks;
+	bool _running = false;
+};
@@ -0,0 +1,301 @@
+//==============================================================================
+//
+//  RtmpProvider
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "amf_reader.h"
+
+#include <cstring>
+
+//====================================================================================================
+// Decode
+// - 모든 top level 값을 읽어야 성공 (중간에 실패하면 AmfDocument로 다시 디코딩)
+//====================================================================================================
+bool AmfReader::Decode(const uint8_t *data, size_t data_length)
+{
+    _data = data;
+    _data_length = data_length;
+    _offset = 0;
+    _value_count = 0;
+    _top_level_count = 0;
+
+    if ((data == nullptr) || (data_length == 0))
+    {
+        return false;
+    }
+
+    while (_offset < _data_length)
+    {
+        if (_top_level_count >= AMF_READER_MAX_VALUE_COUNT)
+        {
+            return false;
+        }
+
+        int index = _value_count;
+
+        if (DecodeValue(-1, nullptr, 0, 0) == false)
+        {
+            return false;
+        }
+
+        _top_level[_top_level_count++] = index;
+    }
+
+    return true;
+}
+
+//====================================================================================================
+// Get
+//====================================================================================================
+const AmfReaderValue *AmfReader::Get(int index) const
+{
+    if ((index < 0) || (index >= _top_level_count))
+    {
+        return nullptr;
+    }
+
+    return &_values[_top_level[index]];
+}
+
+//====================================================================================================
+// IsString
+//====================================================================================================
+bool AmfReader::IsString(int index, const char *string) const
+{
+    auto value = Get(index);
+
+    if ((value == nullptr) || (value->type != AmfDataType::String))
+    {
+        return false;
+    }
+
+    size_t length = ::strlen(string);
+
+    return (value->string_length == length) && (::memcmp(value->string, string, length) == 0);
+}
+
+//====================================================================================================
+// GetNumber
+//====================================================================================================
+double AmfReader::GetNumber(int index, double default_value) const
+{
+    auto value = Get(index);
+
+    if ((value == nullptr) || (value->type != AmfDataType::Number))
+    {
+        return default_value;
+    }
+
+    return value->number;
+}
+
+//====================================================================================================
+// FindProperty
+//====================================================================================================
+const AmfReaderValue *AmfReader::FindProperty(int object_index, const char *name) const
+{
+    auto object = Get(object_index);
+
+    if ((object == nullptr) || ((object->type != AmfDataType::Object) && (object->type != AmfDataType::Array)))
+    {
+        return nullptr;
+    }
+
+    int parent = _top_level[object_index];
+    size_t length = ::strlen(name);
+
+    // 속성들은 object 바로 뒤에 연속으로 저장됨
+    for (int index = parent + 1; index < _value_count; index++)
+    {
+        auto &value = _values[index];
+
+        if ((value.parent == parent) && (value.name_length == length) && (::memcmp(value.name, name, length) == 0))
+        {
+            return &value;
+        }
+    }
+
+    return nullptr;
+}
+
+//====================================================================================================
+// AddValue
+//====================================================================================================
+AmfReaderValue *AmfReader::AddValue(int parent, const char *name, size_t name_length, AmfDataType type)
+{
+    if (_value_count >= AMF_READER_MAX_VALUE_COUNT)
+    {
+        return nullptr;
+    }
+
+    auto value = &_values[_value_count++];
+
+    value->parent = parent;
+    value->name = name;
+    value->name_length = name_length;
+    value->type = type;
+    value->number = 0.0;
+    value->boolean = false;
+    value->string = nullptr;
+    value->string_length = 0;
+
+    return value;
+}
+
+//====================================================================================================
+// DecodeValue
+// - marker + 값
+//====================================================================================================
+bool AmfReader::DecodeValue(int parent, const char *name, size_t name_length, int depth)
+{
+    if (_offset >= _data_length)
+    {
+        return false;
+    }
+
+    auto marker = static_cast<AmfTypeMarker>(_data[_offset++]);
+    size_t remained = _data_length - _offset;
+    const uint8_t *data = _data + _offset;
+    AmfReaderValue *value = nullptr;
+
+    switch (marker)
+    {
+        case AmfTypeMarker::Number:
+        {
+            if (remained < 8 || (value = AddValue(parent, name, name_length, AmfDataType::Number)) == nullptr)
+            {
+                return false;
+            }
+
+            uint64_t bits = 0;
+
+            // Big Endian
+            for (int index = 0; index < 8; index++)
+            {
+                bits = (bits << 8) | data[index];
+            }
+
+            ::memcpy(&value->number, &bits, sizeof(bits));
+            _offset += 8;
+            return true;
+        }
+
+        case AmfTypeMarker::Boolean:
+        {
+            if (remained < 1 || (value = AddValue(parent, name, name_length, AmfDataType::Boolean)) == nullptr)
+            {
+                return false;
+            }
+
+            value->boolean = (data[0] != 0);
+            _offset += 1;
+            return true;
+        }
+
+        case AmfTypeMarker::String:
+        case AmfTypeMarker::LongString:
+        {
+            size_t length_size = (marker == AmfTypeMarker::String) ? 2 : 4;
+
+            if (remained < length_size || (value = AddValue(parent, name, name_length, AmfDataType::String)) == nullptr)
+            {
+                return false;
+            }
+
+            size_t length = 0;
+
+            for (size_t index = 0; index < length_size; index++)
+            {
+                length = (length << 8) | data[index];
+            }
+
+            if ((remained - length_size) < length)
+            {
+                return false;
+            }
+
+            value->string = reinterpret_cast<const char *>(data + length_size);
+            value->string_length = length;
+            _offset += length_size + length;
+            return true;
+        }
+
+        case AmfTypeMarker::Null:
+            return AddValue(parent, name, name_length, AmfDataType::Null) != nullptr;
+
+        case AmfTypeMarker::Undefined:
+            return AddValue(parent, name, name_length, AmfDataType::Undefined) != nullptr;
+
+        case AmfTypeMarker::Object:
+        case AmfTypeMarker::EcmaArray:
+        {
+            if (depth >= AMF_READER_MAX_DEPTH)
+            {
+                return false;
+            }
+
+            int index = _value_count;
+            AmfDataType type = (marker == AmfTypeMarker::Object) ? AmfDataType::Object : AmfDataType::Array;
+
+            if (AddValue(parent, name, name_length, type) == nullptr)
+            {
+                return false;
+            }
+
+            if (marker == AmfTypeMarker::EcmaArray)
+            {
+                // associative count (사용하지 않음, object end 까지 읽음)
+                if (remained < 4)
+                {
+                    return false;
+                }
+
+                _offset += 4;
+            }
+
+            return DecodeProperties(index, depth + 1);
+        }
+
+        default:
+            // reference, strict array, date, typed object 등은 AmfDocument 에서 처리
+            return false;
+    }
+}
+
+//====================================================================================================
+// DecodeProperties
+// - name(2 + n) + value ... 00 00 09(object end)
+//====================================================================================================
+bool AmfReader::DecodeProperties(int parent, int depth)
+{
+    while (true)
+    {
+        if ((_data_length - _offset) < 3)
+        {
+            return false;
+        }
+
+        const uint8_t *data = _data + _offset;
+        size_t name_length = (static_cast<size_t>(data[0]) << 8) | data[1];
+
+        if ((name_length == 0) && (data[2] == static_cast<uint8_t>(AmfTypeMarker::ObjectEnd)))
+        {
+            _offset += 3;
+            return true;
+        }
+
+        if ((_data_length - _offset - 2) < name_length)
+        {
+            return false;
+        }
+
+        _offset += 2 + name_length;
+
+        if (DecodeValue(parent, reinterpret_cast<const char *>(data + 2), name_length, depth) == false)
+        {
+            return false;
+        }
+    }
+}
@@ -0,0 +1,73 @@
+//==============================================================================
+//
+//  RtmpProvider
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "amf_document.h"
+
+// Maximum number of the values of a document (including the properties of the objects)
+#define AMF_READER_MAX_VALUE_COUNT              (64)
+// Maximum depth of the nested objects
+#define AMF_READER_MAX_DEPTH                    (4)
+
+//====================================================================================================
+// AmfReaderValue
+// - name/string point to the decoded packet (not null terminated), so the packet must be kept
+//====================================================================================================
+struct AmfReaderValue
+{
+    // Index of the object which contains this value (-1: top level)
+    int             parent;
+
+    const char *    name;
+    size_t          name_length;
+
+    AmfDataType     type;
+    double          number;
+    bool            boolean;
+    const char *    string;
+    size_t          string_length;
+};
+
+//====================================================================================================
+// AmfReader
+// - AMF0 decoder without any allocation, the values are decoded into the fixed arena of the reader
+// - Decode() fails if the document has unsupported types (reference, strict array, typed object...)
+//   or too many values, the caller falls back to AmfDocument then
+//====================================================================================================
+class AmfReader
+{
+public:
+    bool                    Decode(const uint8_t *data, size_t data_length);
+
+    // Top level values
+    int                     GetCount() const { return _top_level_count; }
+    const AmfReaderValue *  Get(int index) const;
+    bool                    IsString(int index, const char *string) const;
+    double                  GetNumber(int index, double default_value = 0.0) const;
+
+    // Properties of an object/array (the value of object_index must be an object or an array)
+    const AmfReaderValue *  FindProperty(int object_index, const char *name) const;
+
+private:
+    bool                    DecodeValue(int parent, const char *name, size_t name_length, int depth);
+    bool                    DecodeProperties(int parent, int depth);
+    AmfReaderValue *        AddValue(int parent, const char *name, size_t name_length, AmfDataType type);
+
+    const uint8_t *         _data = nullptr;
+    size_t                  _data_length = 0;
+    size_t                  _offset = 0;
+
+    AmfReaderValue          _values[AMF_READER_MAX_VALUE_COUNT];
+    int                     _value_count = 0;
+
+    // Indices of the top level values in _values
+    int                     _top_level[AMF_READER_MAX_VALUE_COUNT];
+    int                     _top_level_count = 0;
+};
@@ -153,6 +153,26 @@ const int g_rtmp_sample_rate_table[] = {96000, 88200, 64000, 48000, 44100, 32000
 #define RTMP_SPEEX_AUDIO_FRAME_INDEX            (1)
 #define RTMP_MP3_AUDIO_FRAME_INDEX                (1)
 #define RTMP_SPS_PPS_MIN_DATA_SIZE                (14)
+#define RTMP_HEVC_SEQUENCE_MIN_DATA_SIZE        (28) // control(1) + sequence(1) + offsettime(3) + record header(23)
+#define RTMP_END_OF_SEQUENCE_TYPE                (0x02)
+
+// VideoTagHeader - FrameType(4bit) + CodecId(4bit)
+#define RTMP_VIDEO_FRAME_TYPE_KEY                (1)
+#define RTMP_VIDEO_FRAME_TYPE_INTER                (2)
+#define RTMP_VIDEO_FRAME_TYPE_COMMAND            (5)
+#define RTMP_VIDEO_CODEC_ID_AVC                    (7)
+// Not in the FLV specification, but the encoder which sends HEVC with the legacy header uses this
+// (Enhanced RTMP header is converted to this also)
+#define RTMP_VIDEO_CODEC_ID_HEVC                (12)
+
+// Enhanced RTMP(ExVideoTagHeader) - IsExHeader(1bit) + FrameType(3bit) + PacketType(4bit) + FourCC(4Byte)
+#define RTMP_EX_VIDEO_HEADER_FLAG                (0x80)
+#define RTMP_EX_VIDEO_HEADER_SIZE                (5)
+#define RTMP_EX_PACKET_TYPE_SEQUENCE_START        (0)
+#define RTMP_EX_PACKET_TYPE_CODED_FRAMES        (1) // + CompositionTime(3Byte)
+#define RTMP_EX_PACKET_TYPE_SEQUENCE_END        (2)
+#define RTMP_EX_PACKET_TYPE_CODED_FRAMES_X        (3) // CompositionTime is 0
+#define RTMP_FOURCC_HEVC                        (0x68766331) // 'hvc1'
 
 #define RTMP_VIDEO_CONTROL_HEADER_INDEX            (0)
 #define RTMP_VIDEO_SEQUENCE_HEADER_INDEX        (1)
@@ -235,6 +255,7 @@ enum class RtmpFrameType : int32_t {
 enum class RtmpCodecType : int32_t {
     Unknown,
     H264,    //	H264/X264 avc1(7)
+    H265,    //	HEVC      hvc1(12 or Enhanced RTMP FourCC)
     AAC,    //	AAC          mp4a(10)
     MP3,  //	MP3(2)
     SPEEX,//	SPEEX(11)
@@ -304,6 +325,11 @@ public :
         //h.264 AVC 헤더 관련 설정 정보
         avc_sps = std::make_shared<std::vector<uint8_t>>();
         avc_pps = std::make_shared<std::vector<uint8_t>>();
+
+        //h.265 HEVC 헤더 관련 설정 정보
+        hevc_vps = std::make_shared<std::vector<uint8_t>>();
+        hevc_sps = std::make_shared<std::vector<uint8_t>>();
+        hevc_pps = std::make_shared<std::vector<uint8_t>>();
     }
 
 public :
@@ -331,6 +357,11 @@ public :
     //h.264 AVC 헤더 관련 설정 정보
     std::shared_ptr<std::vector<uint8_t>> avc_sps;
     std::shared_ptr<std::vector<uint8_t>> avc_pps;
+
+    //h.265 HEVC 헤더 관련 설정 정보
+    std::shared_ptr<std::vector<uint8_t>> hevc_vps;
+    std::shared_ptr<std::vector<uint8_t>> hevc_sps;
+    std::shared_ptr<std::vector<uint8_t>> hevc_pps;
 };
 
 #pragma pack()
\ No newline at end of file
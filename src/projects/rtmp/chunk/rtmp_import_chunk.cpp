@@ -9,6 +9,8 @@
 #include "rtmp_import_chunk.h"
 #include "../rtmp_chunk_log_define.h"
 
+#include <algorithm>
+
 //====================================================================================================
 // RtmpImportChunk
 //====================================================================================================
@@ -112,99 +114,46 @@ std::shared_ptr<RtmpMuxMessageHeader> RtmpImportChunk::GetMessageHeader(std::sha
 
 //====================================================================================================
 // ChunkMessage 추가
+// - chunk 헤더를 제외한 데이터를 메시지 body 에 바로 복사
 //====================================================================================================
-bool
-RtmpImportChunk::AppendChunk(std::shared_ptr<ImportStream> &stream, uint8_t *chunk, int header_size, int data_size)
+bool RtmpImportChunk::AppendChunk(std::shared_ptr<ImportStream> &stream, const uint8_t *chunk_data, int data_size)
 {
-    int append_size = header_size + data_size;
-
-    //10M이상 데이터 경고
-    if (append_size > RTMP_MAX_PACKET_SIZE)//10M
+    if ((stream->body == nullptr) ||
+        (static_cast<int>(stream->body->size()) - stream->write_chunk_size) < data_size)
     {
-        RTMP_CHUNK_WARNING_LOG(("Rtmp Append Data Size ( %d)", append_size));
+        RTMP_CHUNK_WARNING_LOG(("Rtmp Append Data Size ( %d)", data_size));
         return false;
     }
 
-    // 버퍼에 남아있는공간 체크. 부족하면 새로 할당
-    if ((static_cast<int>(stream->buffer->size()) - stream->data_size) < append_size)
-    {
-        stream->buffer->resize(
-                (stream->buffer->size() * 2) > (stream->buffer->size() + append_size) ? (stream->buffer->size() * 2) : (
-                        stream->buffer->size() + append_size));
-    }
-
     // 복사
-    memcpy(stream->buffer->data() + stream->data_size, chunk, (size_t) append_size);
-    stream->data_size += append_size;
+    memcpy(stream->body->data() + stream->write_chunk_size, chunk_data, (size_t) data_size);
     stream->write_chunk_size += data_size;
 
     return true;
 }
 
 //====================================================================================================
-// ChunkData 수신 완료 데이터 복사
+// ChunkData 수신 완료
 //====================================================================================================
-int RtmpImportChunk::CompleteChunkMessage(std::shared_ptr<ImportStream> &stream, int chunk_size)
+void RtmpImportChunk::CompleteChunkMessage(std::shared_ptr<ImportStream> &stream)
 {
-    int chunk_header_size = 0;
-    int chunk_data_raw_size = 0;
-    bool extend_type = false;
-
-    //Chunk Header 읽기
-    auto chunk_header = GetChunkHeader(stream->buffer->data(), stream->data_size, chunk_header_size, extend_type);
-
-    //Message Header 설정
-    auto message_header = GetMessageHeader(stream, chunk_header);
-
-    //전체 크기 확인
-    chunk_data_raw_size = GetChunkDataRawSize(chunk_size, message_header->chunk_stream_id, message_header->body_size,
-                                              extend_type);
-
-    // Chunk Stream 이 완성되지 않았다면 스킵
-    if (stream->data_size < chunk_header_size + chunk_data_raw_size)
-    {
-        RTMP_CHUNK_ERROR_LOG(("Buffer(%d) RawData(%d)", stream->data_size, chunk_header_size + chunk_data_raw_size));
-        return 0;
-    }
-
-    // 데이터 길이가 0인 헤더 정보 정보가 오는 경우 발생
-    if (message_header->body_size == 0)
-    {
-        //스트림 정보 초기화
-        stream->data_size = 0;
-        stream->write_chunk_size = 0;
-        return 0;
-    }
-
-    // 메모리 할당
-    auto message = std::make_shared<ImportMessage>(message_header);
-
-    //Chunk Message 할당
-    if (GetChunkData(chunk_size, stream->buffer->data() + chunk_header_size, chunk_data_raw_size,
-                     message_header->body_size, message->body->data(), extend_type) == 0)
-    {
-        RTMP_CHUNK_ERROR_LOG(("GetChunkData - Header(%d) RawData(%d)", chunk_header_size, chunk_data_raw_size));
-        return 0;
-    }
+    // 리스트에 등록
+    _import_message_queue.push_back(std::make_shared<ImportMessage>(stream->message_header, stream->body));
 
     // 스트림 정보 초기화
-    stream->data_size = 0;
+    stream->body = nullptr;
     stream->write_chunk_size = 0;
-
-    // 리스트에 등록
-    _import_message_queue.push_back(message);
-
-    return message_header->body_size;
 }
 
 //====================================================================================================
 // ImportStream
 // - Chunk 데이터 삽입
 //====================================================================================================
-int RtmpImportChunk::ImportStreamData(uint8_t *data, int data_size, bool &message_complete)
+int RtmpImportChunk::ImportStreamData(const uint8_t *data, int data_size, bool &message_complete)
 {
     int chunk_header_size = 0;
     int rest_chunk_size = 0;
+    int chunk_data_size = 0;
     bool extend_type = false;
 
     if (data_size <= 0 || data == nullptr)
@@ -213,7 +162,7 @@ int RtmpImportChunk::ImportStreamData(uint8_t *data, int data_size, bool &messag
     }
 
     // Chunk Header  읽기
-    auto chunk_header = GetChunkHeader(data, data_size, chunk_header_size, extend_type);
+    auto chunk_header = GetChunkHeader(const_cast<uint8_t *>(data), data_size, chunk_header_size, extend_type);
 
     if (chunk_header_size <= 0)
     {
@@ -243,8 +192,9 @@ int RtmpImportChunk::ImportStreamData(uint8_t *data, int data_size, bool &messag
     // ExtendHeader 설정
     stream->extend_type = extend_type;
 
-    // Message Header 얻기
-    auto message_header = GetMessageHeader(stream, chunk_header);
+    // Message Header 얻기 (메시지의 첫 chunk 에서 결정되고, 이어지는 chunk 는 같은 헤더를 사용)
+    bool first_chunk = (stream->write_chunk_size == 0);
+    auto message_header = first_chunk ? GetMessageHeader(stream, chunk_header) : stream->message_header;
 
     rest_chunk_size = message_header->body_size - stream->write_chunk_size;
 
@@ -255,55 +205,49 @@ int RtmpImportChunk::ImportStreamData(uint8_t *data, int data_size, bool &messag
         return -1;
     }
 
-    // Chunk Size 가 남은 경우
-    if (_chunk_size < rest_chunk_size)
+    chunk_data_size = std::min(_chunk_size, rest_chunk_size);
+
+    //Data 를 아직 다 받지 못했다면 스킵
+    if (data_size < chunk_header_size + chunk_data_size)
     {
-        //Data 를 아직 다 받지 못했다면 스킵
-        if (data_size < chunk_header_size + _chunk_size)
-        {
-            return 0;
-        }
+        return 0;
+    }
 
-        // Chunk 추가
-        if (!AppendChunk(stream, data, chunk_header_size, _chunk_size))
+    if (first_chunk)
+    {
+        //20M이상 데이터 확인
+        if (message_header->body_size > RTMP_MAX_PACKET_SIZE)
         {
-            RTMP_CHUNK_ERROR_LOG(
-                    ("AppendChunk Fail - Header(%d) Data(%d) Chunk(%d)", chunk_header_size, rest_chunk_size, _chunk_size));
+            RTMP_CHUNK_ERROR_LOG(("Rtmp Message Size Fail ( %u)", message_header->body_size));
             return -1;
         }
 
-        // Import 스트림 정보 업데이트
-        message_header->timestamp -= stream->timestamp_delta;
+        // header 정보 갱신
+        stream->timestamp_delta = message_header->timestamp - stream->message_header->timestamp;
         stream->message_header = message_header;
-        message_complete = false;
-
-        return chunk_header_size + _chunk_size;
-    }
-
-    // Data 를 아직 다 받지 못했다면 skip
-    if (data_size < chunk_header_size + rest_chunk_size)
-    {
-        return 0;
+        stream->body = RtmpMessageBufferPool::Allocate(message_header->body_size);
     }
 
     // Chunk 추가
-    if (!AppendChunk(stream, data, chunk_header_size, rest_chunk_size))
+    if (!AppendChunk(stream, data + chunk_header_size, chunk_data_size))
     {
         RTMP_CHUNK_ERROR_LOG(
                 ("AppendChunk Fail - Header(%d) Data(%d) Chunk(%d)", chunk_header_size, rest_chunk_size, _chunk_size));
         return -1;
     }
 
-    // 완료
-    CompleteChunkMessage(stream, _chunk_size);
+    // Chunk Size 가 남은 경우
+    if (chunk_data_size < rest_chunk_size)
+    {
+        message_complete = false;
+        return chunk_header_size + chunk_data_size;
+    }
 
-    // header 정보 갱신
-    stream->timestamp_delta = message_header->timestamp - stream->message_header->timestamp;
-    stream->message_header = message_header;
+    // 완료
+    CompleteChunkMessage(stream);
     message_complete = true;
 
-    return chunk_header_size + rest_chunk_size;
-
+    return chunk_header_size + chunk_data_size;
 }
 
 //====================================================================================================
@@ -323,3 +267,26 @@ std::shared_ptr<ImportMessage> RtmpImportChunk::GetMessage()
 
     return message;
 }
+
+//====================================================================================================
+// 메시지 버퍼 크기
+//====================================================================================================
+size_t RtmpImportChunk::GetMessageBufferSize() const
+{
+    size_t buffer_size = 0;
+
+    for (const auto &stream_item : _stream_map)
+    {
+        if (stream_item.second->body != nullptr)
+        {
+            buffer_size += stream_item.second->body->capacity();
+        }
+    }
+
+    for (const auto &message : _import_message_queue)
+    {
+        buffer_size += message->body->capacity();
+    }
+
+    return buffer_size;
+}
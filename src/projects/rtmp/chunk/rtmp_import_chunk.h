@@ -12,6 +12,7 @@
 #include <map>
 #include <deque>
 #include "rtmp_mux_util.h"
+#include "rtmp_message_buffer_pool.h"
 
 //====================================================================================================
 // ImportStream
@@ -22,10 +23,9 @@ public :
 	ImportStream()
 	{
 		message_header 		= std::make_shared<RtmpMuxMessageHeader>();
+		timestamp_delta		= 0;
         write_chunk_size	= 0;
         extend_type		= false;
-        data_size			= 0;
-        buffer 				= std::make_shared<std::vector<uint8_t>>(1024*1024);
 	}
 
 public :
@@ -33,8 +33,8 @@ public :
 	uint32_t								timestamp_delta;
 	int										write_chunk_size;
 	bool									extend_type;
-	int 									data_size;
-	std::shared_ptr<std::vector<uint8_t>> 	buffer;
+	// 수신 중인 메시지의 body (chunk 헤더를 제외한 데이터만 복사)
+	std::shared_ptr<std::vector<uint8_t>> 	body;
 };
 
 //====================================================================================================
@@ -43,10 +43,10 @@ public :
 struct ImportMessage
 {
 public :
-	ImportMessage(std::shared_ptr<RtmpMuxMessageHeader>	&header)
+	ImportMessage(const std::shared_ptr<RtmpMuxMessageHeader> &header, const std::shared_ptr<std::vector<uint8_t>> &message_body)
 	{
         message_header  = header;
-        body            = std::make_shared<std::vector<uint8_t>>(message_header->body_size);
+        body            = message_body;
 	}
 
 public :
@@ -65,14 +65,17 @@ public:
 
 public:
 	void							        Destroy();
-	int								        ImportStreamData(uint8_t *data, int data_size, bool & message_complete);
+	// data 를 복사하지 않고 파싱 (ret: 처리길이, 0: 데이터 부족, <0: 실패)
+	int								        ImportStreamData(const uint8_t *data, int data_size, bool & message_complete);
 	std::shared_ptr<ImportMessage>          GetMessage();
 	void                                    SetChunkSize(int chunk_size){ _chunk_size = chunk_size;}
+	// 수신 중이거나 처리 대기 중인 메시지 body 의 크기
+	size_t                                  GetMessageBufferSize() const;
 private:
 	std::shared_ptr<ImportStream>           GetStream(uint32_t chunk_stream_id);
 	std::shared_ptr<RtmpMuxMessageHeader>   GetMessageHeader(std::shared_ptr<ImportStream> &stream, std::shared_ptr<RtmpChunkHeader> &chunk_header);
-	bool							        AppendChunk(std::shared_ptr<ImportStream> &stream, uint8_t *chunk, int header_size, int data_size);
-	int								        CompleteChunkMessage(std::shared_ptr<ImportStream> &stream, int chunk_size);
+	bool							        AppendChunk(std::shared_ptr<ImportStream> &stream, const uint8_t *chunk_data, int data_size);
+	void							        CompleteChunkMessage(std::shared_ptr<ImportStream> &stream);
 
 private:
 	std::map<uint32_t, std::shared_ptr<ImportStream>>	_stream_map;
@@ -0,0 +1,164 @@
+//==============================================================================
+//
+//  RtmpProvider
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtmp_message_buffer_pool.h"
+
+#include <base/ovlibrary/huge_pages.h>
+
+#include <atomic>
+#include <mutex>
+
+namespace
+{
+    // 4KB, 8KB, ..., 4MB
+    constexpr int SizeClassCount = 11;
+
+    struct SizeClass
+    {
+        std::mutex                          mutex;
+        std::vector<std::vector<uint8_t> *> buffers;
+    };
+
+    struct GlobalPool
+    {
+        SizeClass               size_classes[SizeClassCount];
+
+        std::atomic<uint64_t>   used_count { 0 };
+        std::atomic<uint64_t>   used_bytes { 0 };
+        std::atomic<uint64_t>   pooled_count { 0 };
+        std::atomic<uint64_t>   pooled_bytes { 0 };
+        std::atomic<uint64_t>   hit_count { 0 };
+        std::atomic<uint64_t>   miss_count { 0 };
+    };
+
+    GlobalPool &GetGlobalPool()
+    {
+        // 종료 시 static 객체가 해제되는 중에도 버퍼가 반환될 수 있으므로 해제하지 않음
+        static GlobalPool *pool = new GlobalPool();
+
+        return *pool;
+    }
+
+    size_t GetClassCapacity(int size_class)
+    {
+        return static_cast<size_t>(RTMP_MESSAGE_BUFFER_POOL_MIN_SIZE) << size_class;
+    }
+
+    // size 를 담을 수 있는 가장 작은 size class (-1: pool 을 사용하지 않음)
+    int GetSizeClass(size_t size)
+    {
+        for (int size_class = 0; size_class < SizeClassCount; size_class++)
+        {
+            if (size <= GetClassCapacity(size_class))
+            {
+                return size_class;
+            }
+        }
+
+        return -1;
+    }
+
+    // allocated_capacity: 할당 시점의 capacity (사용 중 버퍼가 커질 수 있음)
+    void Release(std::vector<uint8_t> *buffer, size_t allocated_capacity)
+    {
+        auto &pool = GetGlobalPool();
+        size_t capacity = buffer->capacity();
+
+        pool.used_count.fetch_sub(1, std::memory_order_relaxed);
+        pool.used_bytes.fetch_sub(allocated_capacity, std::memory_order_relaxed);
+
+        // capacity 가 class 크기와 같은 버퍼만 보관
+        int size_class = GetSizeClass(capacity);
+
+        if ((size_class >= 0) && (capacity == GetClassCapacity(size_class)))
+        {
+            auto &item = pool.size_classes[size_class];
+            std::lock_guard<std::mutex> lock(item.mutex);
+
+            if ((item.buffers.size() + 1) * capacity <= RTMP_MESSAGE_BUFFER_POOL_CLASS_BYTES)
+            {
+                item.buffers.push_back(buffer);
+
+                pool.pooled_count.fetch_add(1, std::memory_order_relaxed);
+                pool.pooled_bytes.fetch_add(capacity, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        delete buffer;
+    }
+}
+
+//====================================================================================================
+// 메시지 버퍼 할당
+//====================================================================================================
+std::shared_ptr<std::vector<uint8_t>> RtmpMessageBufferPool::Allocate(size_t size)
+{
+    auto &pool = GetGlobalPool();
+    int size_class = GetSizeClass(size);
+    std::vector<uint8_t> *buffer = nullptr;
+
+    if (size_class >= 0)
+    {
+        auto &item = pool.size_classes[size_class];
+        std::lock_guard<std::mutex> lock(item.mutex);
+
+        if (!item.buffers.empty())
+        {
+            buffer = item.buffers.back();
+            item.buffers.pop_back();
+
+            pool.pooled_count.fetch_sub(1, std::memory_order_relaxed);
+            pool.pooled_bytes.fetch_sub(buffer->capacity(), std::memory_order_relaxed);
+        }
+    }
+
+    if (buffer != nullptr)
+    {
+        pool.hit_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        pool.miss_count.fetch_add(1, std::memory_order_relaxed);
+
+        buffer = new std::vector<uint8_t>();
+        buffer->reserve((size_class >= 0) ? GetClassCapacity(size_class) : size);
+
+        // 2MB 이상의 size class (key frame) 는 huge page 사용
+        ov::HugePages::Advise(buffer->data(), buffer->capacity());
+    }
+
+    // 재사용된 버퍼는 이전 크기를 넘는 부분만 초기화됨
+    buffer->resize(size);
+
+    size_t capacity = buffer->capacity();
+
+    pool.used_count.fetch_add(1, std::memory_order_relaxed);
+    pool.used_bytes.fetch_add(capacity, std::memory_order_relaxed);
+
+    return std::shared_ptr<std::vector<uint8_t>>(buffer, [capacity](std::vector<uint8_t> *released) {
+        Release(released, capacity);
+    });
+}
+
+//====================================================================================================
+// 통계
+//====================================================================================================
+RtmpMessageBufferPoolStatistics RtmpMessageBufferPool::GetStatistics()
+{
+    auto &pool = GetGlobalPool();
+    RtmpMessageBufferPoolStatistics statistics;
+
+    statistics.used_count = pool.used_count.load(std::memory_order_relaxed);
+    statistics.used_bytes = pool.used_bytes.load(std::memory_order_relaxed);
+    statistics.pooled_count = pool.pooled_count.load(std::memory_order_relaxed);
+    statistics.pooled_bytes = pool.pooled_bytes.load(std::memory_order_relaxed);
+    statistics.hit_count = pool.hit_count.load(std::memory_order_relaxed);
+    statistics.miss_count = pool.miss_count.load(std::memory_order_relaxed);
+
+    return statistics;
+}
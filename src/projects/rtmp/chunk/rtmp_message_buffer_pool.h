@@ -0,0 +1,48 @@
+//==============================================================================
+//
+//  RtmpProvider
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Smallest size class of the message buffers (control messages, audio frames)
+#define RTMP_MESSAGE_BUFFER_POOL_MIN_SIZE       (4 * 1024)
+// Largest size class of the message buffers, the larger messages are allocated from the heap
+#define RTMP_MESSAGE_BUFFER_POOL_MAX_SIZE       (4 * 1024 * 1024)
+// Bytes kept by each size class (all connections)
+#define RTMP_MESSAGE_BUFFER_POOL_CLASS_BYTES    (16 * 1024 * 1024)
+
+struct RtmpMessageBufferPoolStatistics
+{
+    // Buffers which are used by the connections
+    uint64_t    used_count = 0;
+    uint64_t    used_bytes = 0;
+    // Buffers which are kept in the pool
+    uint64_t    pooled_count = 0;
+    uint64_t    pooled_bytes = 0;
+    // Allocations served from the pool/heap
+    uint64_t    hit_count = 0;
+    uint64_t    miss_count = 0;
+};
+
+//====================================================================================================
+// RtmpMessageBufferPool
+// - The message bodies of all connections are allocated from the size classes (power of two)
+// - A buffer returns to the pool when the last reference is released, and the bytes kept by a size class are limited,
+//   so an idle connection does not pin any buffer
+//====================================================================================================
+class RtmpMessageBufferPool
+{
+public:
+    // Returns a buffer whose size is <size>
+    static std::shared_ptr<std::vector<uint8_t>>    Allocate(size_t size);
+
+    static RtmpMessageBufferPoolStatistics          GetStatistics();
+};
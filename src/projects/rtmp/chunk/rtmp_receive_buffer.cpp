@@ -0,0 +1,70 @@
+//==============================================================================
+//
+//  RtmpProvider
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtmp_receive_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+//====================================================================================================
+// 데이터 추가
+// - 끝에 공간이 없으면 남은 데이터를 앞으로 이동하고, 그래도 부족하면 버퍼를 늘림
+//====================================================================================================
+void RtmpReceiveBuffer::Append(const uint8_t *data, size_t data_size)
+{
+    if ((data == nullptr) || (data_size == 0))
+    {
+        return;
+    }
+
+    if ((_buffer.size() - _write_offset) < data_size)
+    {
+        size_t length = GetLength();
+
+        if (_read_offset > 0)
+        {
+            ::memmove(_buffer.data(), _buffer.data() + _read_offset, length);
+            _read_offset = 0;
+            _write_offset = length;
+        }
+
+        if ((_buffer.size() - _write_offset) < data_size)
+        {
+            _buffer.resize(std::max({ _buffer.size() * 2, length + data_size, static_cast<size_t>(RTMP_RECEIVE_BUFFER_MIN_SIZE) }));
+        }
+    }
+
+    ::memcpy(_buffer.data() + _write_offset, data, data_size);
+    _write_offset += data_size;
+}
+
+//====================================================================================================
+// 처리한 데이터 제거
+//====================================================================================================
+void RtmpReceiveBuffer::Consume(size_t size)
+{
+    _read_offset += std::min(size, GetLength());
+
+    if (_read_offset == _write_offset)
+    {
+        // 모두 처리했다면 처음부터 다시 사용
+        _read_offset = 0;
+        _write_offset = 0;
+    }
+}
+
+//====================================================================================================
+// 초기화
+// - 버퍼도 해제
+//====================================================================================================
+void RtmpReceiveBuffer::Clear()
+{
+    std::vector<uint8_t>().swap(_buffer);
+
+    _read_offset = 0;
+    _write_offset = 0;
+}
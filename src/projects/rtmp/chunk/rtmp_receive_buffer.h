@@ -0,0 +1,40 @@
+//==============================================================================
+//
+//  RtmpProvider
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Minimum capacity of the receive buffer (allocated when the first incomplete chunk is kept)
+#define RTMP_RECEIVE_BUFFER_MIN_SIZE            (4 * 1024)
+
+//====================================================================================================
+// RtmpReceiveBuffer
+// - Keeps the bytes which are not parsed yet, the parser reads them in place
+// - Nothing is allocated until some bytes are left, so an idle connection does not pin any memory
+// - The consumed bytes are not erased, the remained bytes are moved to the front only when there is
+//   no space at the end (so the bytes are moved once per buffer length at most)
+//====================================================================================================
+class RtmpReceiveBuffer
+{
+public:
+    void            Append(const uint8_t *data, size_t data_size);
+    void            Consume(size_t size);
+    void            Clear();
+
+    const uint8_t * GetData() const { return _buffer.data() + _read_offset; }
+    size_t          GetLength() const { return _write_offset - _read_offset; }
+    bool            IsEmpty() const { return _read_offset == _write_offset; }
+    size_t          GetCapacity() const { return _buffer.capacity(); }
+
+private:
+    std::vector<uint8_t>    _buffer;
+    size_t                  _read_offset = 0;
+    size_t                  _write_offset = 0;
+};
@@ -40,6 +40,15 @@
  C->S : Video/Audio Data Stream
  - H.264 : SPS/PPS 
  - AAC : Control Byte 
+
+- Playing (after Connect)
+ C->S : createStream
+ S->C : _result
+ C->S : play
+ S->C : Set Chunk Size (RTMP_PLAY_CHUNK_SIZE)
+ S->C : Stream Begin
+ S->C : onStatus(Reset/Start)
+ S->C : @setDataFrame + Video/Audio Data Stream (sent by the publisher)
 */
 
 #define OV_LOG_TAG                  "RtmpProvider"
@@ -57,7 +66,6 @@ RtmpChunkStream::RtmpChunkStream(ov::ClientSocket *remote, IRtmpChunkStream *str
 
 	_remote = remote;
 	_stream_interface = stream_interface;
-	_remained_data = std::make_unique<std::vector<uint8_t>>();
 	_app_id = info::application_id_t();
 	_stream_id = 0;
 	_device_string = RTMP_UNKNOWN_DEVICE_TYPE_STRING;
@@ -96,6 +104,9 @@ ov::String RtmpChunkStream::GetCodecString(RtmpCodecType codec_type)
 		case RtmpCodecType::H264 :
 			codec_string = "h264";
 			break;
+		case RtmpCodecType::H265 :
+			codec_string = "h265";
+			break;
 		case RtmpCodecType::AAC :
 			codec_string = "aac";
 			break;
@@ -173,31 +184,33 @@ bool RtmpChunkStream::SendData(int data_size, uint8_t *data)
 // - Handshake 처리
 // - Chunkstream 처리
 //====================================================================================================
-int32_t RtmpChunkStream::OnDataReceived(const std::unique_ptr<std::vector<uint8_t>> &data)
+int32_t RtmpChunkStream::OnDataReceived(const uint8_t *data, size_t data_size)
 {
+	ov::MemoryTagScope memory_tag(ov::MemoryTag::Ingest);
+	OV_TRACE_SCOPE("provider", "RtmpReceive");
+
 	int32_t process_size = 0;
-	std::shared_ptr<std::vector<uint8_t>> process_data = nullptr;
+	const uint8_t *process_data = data;
+	size_t process_data_size = data_size;
 
-	if(!_remained_data->empty())
-	{
-		process_data = std::make_shared<std::vector<uint8_t>>(_remained_data->begin(), _remained_data->end());
-		process_data->insert(process_data->end(), data->begin(), data->end());
-		_remained_data->clear();
-	}
-	else
+	// 남은 데이터가 있을 때만 버퍼에 이어 붙여서 처리 (없으면 수신 데이터를 복사하지 않고 바로 파싱)
+	if(_receive_buffer.IsEmpty() == false)
 	{
-		process_data = std::make_shared<std::vector<uint8_t>>(data->begin(), data->end());
+		_receive_buffer.Append(data, data_size);
+
+		process_data = _receive_buffer.GetData();
+		process_data_size = _receive_buffer.GetLength();
 	}
 
 	// 최대 크기 확인
-	if(process_data->size() > RTMP_MAX_PACKET_SIZE)
+	if(process_data_size > RTMP_MAX_PACKET_SIZE)
 	{
-		logte("Process data size fail - stream(%s/%s) id(%u/%u) size(%d:%d)",
+		logte("Process data size fail - stream(%s/%s) id(%u/%u) size(%zu:%d)",
 		      _app_name.CStr(),
               _stream_name.CStr(),
 		      _app_id,
 		      _stream_id,
-		      process_data->size(),
+		      process_data_size,
 		      RTMP_MAX_PACKET_SIZE);
 
 		return -1;
@@ -205,11 +218,11 @@ int32_t RtmpChunkStream::OnDataReceived(const std::unique_ptr<std::vector<uint8_
 
 	if(_handshake_state != RtmpHandshakeState::Complete)
 	{
-		process_size = ReceiveHandshakePacket(process_data);
+		process_size = ReceiveHandshakePacket(process_data, static_cast<int32_t>(process_data_size));
 	}
 	else
 	{
-		process_size = ReceiveChunkPacket(process_data);
+		process_size = ReceiveChunkPacket(process_data, static_cast<int32_t>(process_data_size));
 	}
 
 	if(process_size < 0)
@@ -225,22 +238,42 @@ int32_t RtmpChunkStream::OnDataReceived(const std::unique_ptr<std::vector<uint8_
 	}
 
 	// remained 데이터 설정
-	if(process_size < static_cast<int32_t>(process_data->size()))
+	if(process_data != data)
+	{
+		_receive_buffer.Consume(process_size);
+	}
+	else if(process_size < static_cast<int32_t>(process_data_size))
 	{
-		_remained_data->assign(process_data->begin() + process_size, process_data->end());
+		_receive_buffer.Append(data + process_size, process_data_size - process_size);
 	}
 
 	return process_size;
 }
 
 
+//====================================================================================================
+// 메시지 버퍼 크기
+// - 수신 중인 메시지 + 스트림 생성 전까지 보관 중인 메시지
+//====================================================================================================
+size_t RtmpChunkStream::GetMessageBufferSize() const
+{
+	size_t buffer_size = _import_chunk->GetMessageBufferSize();
+
+	for(const auto &message : _stream_messages)
+	{
+		buffer_size += message->body->capacity();
+	}
+
+	return buffer_size;
+}
+
 //====================================================================================================
 // Receive Handshake Packet
 // c0 + c1 Receive
 // s0 + s1 + s2 Send
 // c2 Receive
 //====================================================================================================
-int32_t RtmpChunkStream::ReceiveHandshakePacket(const std::shared_ptr<const std::vector<uint8_t>> &data)
+int32_t RtmpChunkStream::ReceiveHandshakePacket(const uint8_t *data, int32_t data_size)
 {
 	int32_t process_size = 0;
 	int32_t chunk_process_size = 0;
@@ -260,7 +293,7 @@ int32_t RtmpChunkStream::ReceiveHandshakePacket(const std::shared_ptr<const std:
 	}
 
 	// Process Data Size Check
-	if(static_cast<int32_t>(data->size()) < process_size)
+	if(data_size < process_size)
 	{
 		return 0;
 	}
@@ -270,9 +303,9 @@ int32_t RtmpChunkStream::ReceiveHandshakePacket(const std::shared_ptr<const std:
 	{
 		// c0 + c1 수신 확인
 		// 버전 체크
-		if(data->at(0) != RTMP_HANDSHAKE_VERSION)
+		if(data[0] != RTMP_HANDSHAKE_VERSION)
 		{
-			logte("Handshake Version Fail - Version(%d:%d)", data->at(0), RTMP_HANDSHAKE_VERSION);
+			logte("Handshake Version Fail - Version(%d:%d)", data[0], RTMP_HANDSHAKE_VERSION);
 			return -1;
 		}
 		_handshake_state = RtmpHandshakeState::C0;
@@ -289,10 +322,9 @@ int32_t RtmpChunkStream::ReceiveHandshakePacket(const std::shared_ptr<const std:
 	_handshake_state = RtmpHandshakeState::C2;
 
 	// 최종 c3와 chunk 패킷이 같이 들어오는 경우 처리(encoder 전송 대기 상태에 빠질 수 있음)
-	if(process_size < static_cast<int32_t>(data->size()))
+	if(process_size < data_size)
 	{
-		auto process_data = std::make_shared<std::vector<uint8_t>>(data->begin() + process_size, data->end());
-		chunk_process_size = ReceiveChunkPacket(process_data);
+		chunk_process_size = ReceiveChunkPacket(data + process_size, data_size - process_size);
 		if(chunk_process_size < 0)
 		{
 			return -1;
@@ -309,7 +341,7 @@ int32_t RtmpChunkStream::ReceiveHandshakePacket(const std::shared_ptr<const std:
 // Handshake 전송
 // s0 + s1 + s2
 //====================================================================================================
-bool RtmpChunkStream::SendHandshake(const std::shared_ptr<const std::vector<uint8_t>> &data)
+bool RtmpChunkStream::SendHandshake(const uint8_t *data)
 {
 	uint8_t s0 = 0;
 	uint8_t s1[RTMP_HANDSHAKE_PACKET_SIZE] = { 0, };
@@ -318,7 +350,7 @@ bool RtmpChunkStream::SendHandshake(const std::shared_ptr<const std::vector<uint
 	// 데이터 설정
 	s0 = RTMP_HANDSHAKE_VERSION;
 	RtmpHandshake::MakeS1(s1);
-	RtmpHandshake::MakeS2((uint8_t *)data->data() + sizeof(uint8_t), s2);
+	RtmpHandshake::MakeS2((uint8_t *)data + sizeof(uint8_t), s2);
 	_handshake_state = RtmpHandshakeState::C1;
 
 	// s0 전송
@@ -352,18 +384,17 @@ bool RtmpChunkStream::SendHandshake(const std::shared_ptr<const std::vector<uint
 // Chunk 패킷 수신
 // - OnMetaData 이후에 스트리밍 시작
 //====================================================================================================
-int32_t RtmpChunkStream::ReceiveChunkPacket(const std::shared_ptr<const std::vector<uint8_t>> &data)
+int32_t RtmpChunkStream::ReceiveChunkPacket(const uint8_t *data, int32_t data_size)
 {
 	int32_t process_size = 0;
 	int32_t import_size = 0;
 	bool message_complete = false;
 
-	while(process_size < static_cast<int32_t>(data->size()))
+	while(process_size < data_size)
 	{
 		message_complete = false;
 
-		import_size = _import_chunk->ImportStreamData((uint8_t *)data->data() + process_size,
-		                                              data->size() - process_size, message_complete);
+		import_size = _import_chunk->ImportStreamData(data + process_size, data_size - process_size, message_complete);
 
 		if(import_size == 0)
 		{
@@ -502,6 +533,10 @@ void RtmpChunkStream::ReceiveAmfCommandMessage(std::shared_ptr<ImportMessage> &m
 	ov::String message_name;
 	double transaction_id = 0.0;
 
+	if(ReceiveAmfCommandMessageFast(message))
+	{
+		return;
+	}
 
 	if(document.Decode(message->body->data(), message->message_header->body_size) == 0)
 	{
@@ -526,19 +561,60 @@ void RtmpChunkStream::ReceiveAmfCommandMessage(std::shared_ptr<ImportMessage> &m
 	// 처리
 	if(message_name == RTMP_CMD_NAME_CONNECT)
 	{
-		OnAmfConnect(message->message_header, document, transaction_id);
+		double object_encoding = 0.0;
+
+		if(document.GetProperty(2) != nullptr && document.GetProperty(2)->GetType() == AmfDataType::Object)
+		{
+			AmfObject *object = document.GetProperty(2)->GetObject();
+			int32_t index;
+
+			// object encoding
+			if((index = object->FindName("objectEncoding")) >= 0 && object->GetType(index) == AmfDataType::Number)
+			{
+				object_encoding = object->GetNumber(index);
+			}
+
+			// app 설정
+			if((index = object->FindName("app")) >= 0 && object->GetType(index) == AmfDataType::String)
+			{
+				_app_name = object->GetString(index);
+			}
+		}
+
+		OnAmfConnect(message->message_header, transaction_id, object_encoding);
 	}
 	else if(message_name == RTMP_CMD_NAME_CREATESTREAM)
 	{
-		OnAmfCreateStream(message->message_header, document, transaction_id);
+		OnAmfCreateStream(message->message_header, transaction_id);
 	}
-	else if(message_name == RTMP_CMD_NAME_FCPUBLISH)
+	else if(message_name == RTMP_CMD_NAME_FCPUBLISH || message_name == RTMP_CMD_NAME_PUBLISH)
 	{
-		OnAmfFCPublish(message->message_header, document, transaction_id);
+		ov::String stream_name;
+
+		if(document.GetProperty(3) != nullptr && document.GetProperty(3)->GetType() == AmfDataType::String)
+		{
+			stream_name = document.GetProperty(3)->GetString();
+		}
+
+		if(message_name == RTMP_CMD_NAME_FCPUBLISH)
+		{
+			OnAmfFCPublish(message->message_header, transaction_id, stream_name);
+		}
+		else
+		{
+			OnAmfPublish(message->message_header, transaction_id, stream_name);
+		}
 	}
-	else if(message_name == RTMP_CMD_NAME_PUBLISH)
+	else if(message_name == RTMP_CMD_NAME_PLAY)
 	{
-		OnAmfPublish(message->message_header, document, transaction_id);
+		ov::String stream_name;
+
+		if(document.GetProperty(3) != nullptr && document.GetProperty(3)->GetType() == AmfDataType::String)
+		{
+			stream_name = document.GetProperty(3)->GetString();
+		}
+
+		OnAmfPlay(message->message_header, transaction_id, stream_name);
 	}
 	else if(message_name == RTMP_CMD_NAME_RELEASESTREAM)
 	{ ;
@@ -546,7 +622,8 @@ void RtmpChunkStream::ReceiveAmfCommandMessage(std::shared_ptr<ImportMessage> &m
 	else if(message_name == RTMP_PING)
 	{ ;
 	}
-	else if(message_name == RTMP_CMD_NAME_DELETESTREAM)
+	else if(message_name == RTMP_CMD_NAME_DELETESTREAM ||
+	        (message_name == RTMP_CMD_NAME_CLOSESTREAM && _play_connection != nullptr))
 	{
 		OnAmfDeleteStream(message->message_header, document, transaction_id);
 	}
@@ -557,6 +634,87 @@ void RtmpChunkStream::ReceiveAmfCommandMessage(std::shared_ptr<ImportMessage> &m
 	}
 }
 
+//====================================================================================================
+// Chunk Message - Amf0CommandMessage (fast path)
+// - 접속 시의 명령은 AmfReader 로 디코딩 (문자열은 메시지를 가리키므로 할당 없음)
+// - 지원하지 않는 명령/타입이면 false 를 반환하고 AmfDocument 로 처리
+//====================================================================================================
+bool RtmpChunkStream::ReceiveAmfCommandMessageFast(std::shared_ptr<ImportMessage> &message)
+{
+	AmfReader reader;
+
+	if(reader.Decode(message->body->data(), message->message_header->body_size) == false)
+	{
+		return false;
+	}
+
+	double transaction_id = reader.GetNumber(1);
+
+	if(reader.IsString(0, RTMP_CMD_NAME_CONNECT))
+	{
+		double object_encoding = 0.0;
+		auto value = reader.FindProperty(2, "objectEncoding");
+
+		if(value != nullptr && value->type == AmfDataType::Number)
+		{
+			object_encoding = value->number;
+		}
+
+		value = reader.FindProperty(2, "app");
+
+		if(value != nullptr && value->type == AmfDataType::String)
+		{
+			_app_name = ov::String(value->string, value->string_length);
+		}
+
+		OnAmfConnect(message->message_header, transaction_id, object_encoding);
+	}
+	else if(reader.IsString(0, RTMP_CMD_NAME_RELEASESTREAM))
+	{ ;
+	}
+	else if(reader.IsString(0, RTMP_CMD_NAME_CREATESTREAM))
+	{
+		OnAmfCreateStream(message->message_header, transaction_id);
+	}
+	else if(reader.IsString(0, RTMP_CMD_NAME_FCPUBLISH) || reader.IsString(0, RTMP_CMD_NAME_PUBLISH))
+	{
+		ov::String stream_name;
+		auto value = reader.Get(3);
+
+		if(value != nullptr && value->type == AmfDataType::String)
+		{
+			stream_name = ov::String(value->string, value->string_length);
+		}
+
+		if(reader.IsString(0, RTMP_CMD_NAME_FCPUBLISH))
+		{
+			OnAmfFCPublish(message->message_header, transaction_id, stream_name);
+		}
+		else
+		{
+			OnAmfPublish(message->message_header, transaction_id, stream_name);
+		}
+	}
+	else if(reader.IsString(0, RTMP_CMD_NAME_PLAY))
+	{
+		ov::String stream_name;
+		auto value = reader.Get(3);
+
+		if(value != nullptr && value->type == AmfDataType::String)
+		{
+			stream_name = ov::String(value->string, value->string_length);
+		}
+
+		OnAmfPlay(message->message_header, transaction_id, stream_name);
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
 //====================================================================================================
 // Chunk Message - Amf0DataMessage
 //====================================================================================================
@@ -607,29 +765,9 @@ void RtmpChunkStream::ReceiveAmfDataMessage(std::shared_ptr<ImportMessage> &mess
 // Amf Command - Connect
 // - application name 설정
 //====================================================================================================
-void RtmpChunkStream::OnAmfConnect(std::shared_ptr<RtmpMuxMessageHeader> &message_header, AmfDocument &document,
-                                   double transaction_id)
+void RtmpChunkStream::OnAmfConnect(std::shared_ptr<RtmpMuxMessageHeader> &message_header, double transaction_id,
+                                   double object_encoding)
 {
-	double object_encoding = 0.0;
-
-	if(document.GetProperty(2) != nullptr && document.GetProperty(2)->GetType() == AmfDataType::Object)
-	{
-		AmfObject *object = document.GetProperty(2)->GetObject();
-		int32_t index;
-
-		// object encoding
-		if((index = object->FindName("objectEncoding")) >= 0 && object->GetType(index) == AmfDataType::Number)
-		{
-			object_encoding = object->GetNumber(index);
-		}
-
-		// app 설정
-		if((index = object->FindName("app")) >= 0 && object->GetType(index) == AmfDataType::String)
-		{
-			_app_name = object->GetString(index);
-		}
-	}
-
 	if(!SendWindowAcknowledgementSize())
 	{
 		logte("SendWindowAcknowledgementSize Fail");
@@ -658,8 +796,7 @@ void RtmpChunkStream::OnAmfConnect(std::shared_ptr<RtmpMuxMessageHeader> &messag
 //====================================================================================================
 // Amf Command - CreateStream
 //====================================================================================================
-void RtmpChunkStream::OnAmfCreateStream(std::shared_ptr<RtmpMuxMessageHeader> &message_header, AmfDocument &document,
-                                        double transaction_id)
+void RtmpChunkStream::OnAmfCreateStream(std::shared_ptr<RtmpMuxMessageHeader> &message_header, double transaction_id)
 {
 	if(!SendAmfCreateStreamResult(message_header->chunk_stream_id, transaction_id))
 	{
@@ -671,32 +808,31 @@ void RtmpChunkStream::OnAmfCreateStream(std::shared_ptr<RtmpMuxMessageHeader> &m
 //====================================================================================================
 // Amf Command - FCPublish
 //====================================================================================================
-void RtmpChunkStream::OnAmfFCPublish(std::shared_ptr<RtmpMuxMessageHeader> &message_header, AmfDocument &document,
-                                     double transaction_id)
+void RtmpChunkStream::OnAmfFCPublish(std::shared_ptr<RtmpMuxMessageHeader> &message_header, double transaction_id,
+                                     const ov::String &stream_name)
 {
-	if(_stream_name.IsEmpty() && document.GetProperty(3) != nullptr &&
-	   document.GetProperty(3)->GetType() == AmfDataType::String)
+	if(_stream_name.IsEmpty() && stream_name.IsEmpty() == false)
 	{
 		if(!SendAmfOnFCPublish(message_header->chunk_stream_id, _rtmp_stream_id, _client_id))
 		{
 			logte("SendAmfOnFCPublish Fail");
 			return;
 		}
-		_stream_name = document.GetProperty(3)->GetString();
+		_stream_name = stream_name;
 	}
 }
 
 //====================================================================================================
 // Amf Command - Publish
 //====================================================================================================
-void RtmpChunkStream::OnAmfPublish(std::shared_ptr<RtmpMuxMessageHeader> &message_header, AmfDocument &document,
-                                   double transaction_id)
+void RtmpChunkStream::OnAmfPublish(std::shared_ptr<RtmpMuxMessageHeader> &message_header, double transaction_id,
+                                   const ov::String &stream_name)
 {
 	if(_stream_name.IsEmpty())
 	{
-		if(document.GetProperty(3) != nullptr && document.GetProperty(3)->GetType() == AmfDataType::String)
+		if(stream_name.IsEmpty() == false)
 		{
-			_stream_name = document.GetProperty(3)->GetString();
+			_stream_name = stream_name;
 		}
 		else
 		{
@@ -736,12 +872,98 @@ void RtmpChunkStream::OnAmfPublish(std::shared_ptr<RtmpMuxMessageHeader> &messag
 }
 
 //====================================================================================================
-// Amf Command - Publish
+// Amf Command - Play
+// - The publisher of the application sends the media after NetStream.Play.Start, the chunks are
+//   serialized with RTMP_PLAY_CHUNK_SIZE once per stream and shared by the players
+//====================================================================================================
+void RtmpChunkStream::OnAmfPlay(std::shared_ptr<RtmpMuxMessageHeader> &message_header, double transaction_id,
+                                const ov::String &stream_name)
+{
+	if((_play_connection != nullptr) || (_stream_id != 0))
+	{
+		logtw("OnPlay - Already playing/publishing - stream(%s/%s)", _app_name.CStr(), _stream_name.CStr());
+		return;
+	}
+
+	_stream_name = stream_name;
+	_chunk_stream_id = message_header->chunk_stream_id;
+
+	_play_connection = _stream_interface->OnChunkStreamPlay(_remote, _app_name, _stream_name);
+
+	if(_play_connection == nullptr)
+	{
+		SendAmfOnStatus((uint32_t)_chunk_stream_id,
+		                _rtmp_stream_id,
+		                (char *)"error",
+		                (char *)"NetStream.Play.StreamNotFound",
+		                (char *)"No such stream",
+		                _client_id);
+		return;
+	}
+
+	// The player has been attached to the stream by OnChunkStreamPlay(), it is detached and disconnected
+	// if it cannot be started
+	auto stop_play = [this]() {
+		_play_connection->Disconnect();
+		_stream_interface->OnChunkStreamStopPlay(_play_connection);
+		_play_connection = nullptr;
+	};
+
+	// The commands after this use the chunk size of the media
+	if(!SendSetChunkSize(RTMP_PLAY_CHUNK_SIZE))
+	{
+		logte("SendSetChunkSize Fail");
+		stop_play();
+		return;
+	}
+
+	_export_chunk = std::make_unique<RtmpExportChunk>(false, RTMP_PLAY_CHUNK_SIZE);
+
+	// stream begin 전송
+	if(!SendStreamBegin())
+	{
+		logte("SendStreamBegin Fail");
+		stop_play();
+		return;
+	}
+
+	if(!SendAmfOnStatus((uint32_t)_chunk_stream_id,
+	                    _rtmp_stream_id,
+	                    (char *)"status",
+	                    (char *)"NetStream.Play.Reset",
+	                    (char *)"Playing and resetting",
+	                    _client_id) ||
+	   !SendAmfOnStatus((uint32_t)_chunk_stream_id,
+	                    _rtmp_stream_id,
+	                    (char *)"status",
+	                    (char *)"NetStream.Play.Start",
+	                    (char *)"Started playing",
+	                    _client_id))
+	{
+		logte("SendAmfOnStatus Fail");
+		stop_play();
+		return;
+	}
+
+	_play_connection->SetStarted();
+}
+
+//====================================================================================================
+// Amf Command - DeleteStream
+// - The player is disconnected (the server stops sending the media)
 //====================================================================================================
 void RtmpChunkStream::OnAmfDeleteStream(std::shared_ptr<RtmpMuxMessageHeader> &message_header,
                                         AmfDocument &document,
                                         double transaction_id)
 {
+	if(_play_connection != nullptr)
+	{
+		logtd("Delete Stream - player(%s)", _play_connection->ToString().CStr());
+
+		_play_connection->Disconnect();
+		return;
+	}
+
 	logtd("Delete Stream - stream(%s/%s) id(%u/%u)", _app_name.CStr(),  _stream_name.CStr(), _app_id, _stream_id);
 
 	_media_info->video_streaming = false;
@@ -811,8 +1033,8 @@ bool RtmpChunkStream::SendUserControlMessage(uint16_t message, std::shared_ptr<s
 	                                                             0,
 	                                                             data->size() + 2);
 
-	data->insert(data->begin(), 0);
-	data->insert(data->begin(), 0);
+	// Event type (2B)
+	data->insert(data->begin(), 2, 0);
 	RtmpMuxUtil::WriteInt16(data->data(), message);
 
 	return SendMessagePacket(message_header, data);
@@ -882,6 +1104,23 @@ bool RtmpChunkStream::SendStreamBegin()
 	return SendUserControlMessage(RTMP_UCMID_STREAMBEGIN, body);
 }
 
+//====================================================================================================
+// Set Chunk Size 전송
+//====================================================================================================
+bool RtmpChunkStream::SendSetChunkSize(uint32_t chunk_size)
+{
+	auto body = std::make_shared<std::vector<uint8_t>>(sizeof(int));
+	auto message_header = std::make_shared<RtmpMuxMessageHeader>(RTMP_CHUNK_STREAM_ID_URGENT,
+	                                                             0,
+	                                                             RTMP_MSGID_SET_CHUNK_SIZE,
+	                                                             0,
+	                                                             body->size());
+
+	RtmpMuxUtil::WriteInt32(body->data(), chunk_size);
+
+	return SendMessagePacket(message_header, body);
+}
+
 //====================================================================================================
 // Connect Result 전송
 //====================================================================================================
@@ -1033,6 +1272,7 @@ bool RtmpChunkStream::SendAmfOnStatus(uint32_t chunk_stream_id,
 bool RtmpChunkStream::ReceiveVideoMessage(std::shared_ptr<ImportMessage> &message)
 {
 	RtmpFrameType frame_type = RtmpFrameType::VideoPFrame;
+	bool ignored = false;
 
 	// size check
 	if((message->message_header->body_size < RTMP_VIDEO_DATA_MIN_SIZE) ||
@@ -1045,12 +1285,37 @@ bool RtmpChunkStream::ReceiveVideoMessage(std::shared_ptr<ImportMessage> &messag
 		return false;
 	}
 
+	// Enhanced RTMP 헤더 변환(이후 처리는 기존 헤더 형식 사용)
+	if(!ConvertEnhancedVideoHeader(message, ignored))
+	{
+		return false;
+	}
+
+	if(ignored)
+	{
+		return true;
+	}
+
+	uint8_t control_byte = message->body->at(RTMP_VIDEO_CONTROL_HEADER_INDEX);
+	int codec_id = control_byte & 0x0F;
+	int video_frame_type = (control_byte >> 4) & 0x0F;
+
+	// Codec 확인 (H264/H265)
+	if((codec_id != RTMP_VIDEO_CODEC_ID_AVC) && (codec_id != RTMP_VIDEO_CODEC_ID_HEVC))
+	{
+		logte("Codec fail - stream(%s/%s) codec(%d)",
+		      _app_name.CStr(),
+		      _stream_name.CStr(),
+		      codec_id);
+		return false;
+	}
+
 	// Frame Type 확인 (I/P(B) Frame)
-	if(message->body->at(RTMP_VIDEO_CONTROL_HEADER_INDEX) == RTMP_H264_I_FRAME_TYPE)
+	if(video_frame_type == RTMP_VIDEO_FRAME_TYPE_KEY)
 	{
 		frame_type = RtmpFrameType::VideoIFrame; //I-Frame
 	}
-	else if(message->body->at(RTMP_VIDEO_CONTROL_HEADER_INDEX) == RTMP_H264_P_FRAME_TYPE)
+	else if(video_frame_type == RTMP_VIDEO_FRAME_TYPE_INTER)
 	{
 		frame_type = RtmpFrameType::VideoPFrame; //P-Frame
 	}
@@ -1070,7 +1335,7 @@ bool RtmpChunkStream::ReceiveVideoMessage(std::shared_ptr<ImportMessage> &messag
 		_video_sequence_info_process = true;
 
 		// control header/sequence type 정보 skip
-		if(!VideoSequenceHeaderProcess(message->body, message->body->at(RTMP_VIDEO_CONTROL_HEADER_INDEX)))
+		if(!VideoSequenceHeaderProcess(message->body, control_byte))
 		{
 			logtw("Video sequence info process fail - stream(%s/%s)", _app_name.CStr(), _stream_name.CStr());
 
@@ -1157,6 +1422,99 @@ bool RtmpChunkStream::ReceiveVideoMessage(std::shared_ptr<ImportMessage> &messag
 	return true;
 }
 
+//====================================================================================================
+// ConvertEnhancedVideoHeader
+// - Enhanced RTMP(https://github.com/veovera/enhanced-rtmp) ExVideoTagHeader 를 기존 VideoTagHeader 로 변환
+//   (SequenceHeader/BitstreamToAnnexB 는 기존 형식만 처리)
+// - ExVideoTagHeader : IsExHeader(1bit) + FrameType(3bit) + PacketType(4bit) + FourCC(4Byte) [+ CompositionTime(3Byte)]
+// - VideoTagHeader : FrameType(4bit) + CodecId(4bit) + PacketType(1Byte) + CompositionTime(3Byte)
+// - 변환된 메시지는 다시 변환되지 않음(IsExHeader = 0) : 임시 저장 메시지 재처리 시 문제 없음
+//====================================================================================================
+bool RtmpChunkStream::ConvertEnhancedVideoHeader(std::shared_ptr<ImportMessage> &message, bool &ignored)
+{
+	auto &data = message->body;
+	uint8_t control_byte = data->at(RTMP_VIDEO_CONTROL_HEADER_INDEX);
+
+	ignored = false;
+
+	if((control_byte & RTMP_EX_VIDEO_HEADER_FLAG) == 0)
+	{
+		// Legacy header
+		return true;
+	}
+
+	int frame_type = (control_byte >> 4) & 0x07;
+	int packet_type = control_byte & 0x0F;
+	uint32_t fourcc = static_cast<uint32_t>(data->at(1)) << 24 |
+	                  static_cast<uint32_t>(data->at(2)) << 16 |
+	                  static_cast<uint32_t>(data->at(3)) << 8 |
+	                  static_cast<uint32_t>(data->at(4));
+
+	if(fourcc != RTMP_FOURCC_HEVC)
+	{
+		logte("Not supported FourCC - stream(%s/%s) fourcc(%c%c%c%c)",
+		      _app_name.CStr(),
+		      _stream_name.CStr(),
+		      data->at(1), data->at(2), data->at(3), data->at(4));
+
+		logti("Please select H264 or H265 codec - stream(%s/%s)", _app_name.CStr(), _stream_name.CStr());
+
+		return false;
+	}
+
+	if(frame_type == RTMP_VIDEO_FRAME_TYPE_COMMAND)
+	{
+		// Video info/command frame
+		ignored = true;
+		return true;
+	}
+
+	size_t header_size = RTMP_EX_VIDEO_HEADER_SIZE;
+	uint8_t legacy_packet_type = RTMP_FRAME_DATA_TYPE;
+	uint8_t composition_time[3] = { 0, 0, 0 };
+
+	switch(packet_type)
+	{
+		case RTMP_EX_PACKET_TYPE_SEQUENCE_START:
+			legacy_packet_type = RTMP_SEQUENCE_INFO_TYPE;
+			break;
+
+		case RTMP_EX_PACKET_TYPE_CODED_FRAMES:
+			if(data->size() < (RTMP_EX_VIDEO_HEADER_SIZE + sizeof(composition_time)))
+			{
+				logte("Size Fail - stream(%s/%s) size(%d)", _app_name.CStr(), _stream_name.CStr(), data->size());
+				return false;
+			}
+
+			::memcpy(composition_time, data->data() + RTMP_EX_VIDEO_HEADER_SIZE, sizeof(composition_time));
+			header_size += sizeof(composition_time);
+			break;
+
+		case RTMP_EX_PACKET_TYPE_CODED_FRAMES_X:
+			break;
+
+		case RTMP_EX_PACKET_TYPE_SEQUENCE_END:
+			legacy_packet_type = RTMP_END_OF_SEQUENCE_TYPE;
+			break;
+
+		default:
+			// Metadata(HDR), MPEG2TSSequenceStart
+			ignored = true;
+			return true;
+	}
+
+	// The legacy header is 5 bytes : ExVideoTagHeader(5) or ExVideoTagHeader(5) + CompositionTime(3)
+	data->erase(data->begin(), data->begin() + (header_size - RTMP_VIDEO_DATA_MIN_SIZE));
+
+	data->at(RTMP_VIDEO_CONTROL_HEADER_INDEX) = static_cast<uint8_t>((frame_type << 4) | RTMP_VIDEO_CODEC_ID_HEVC);
+	data->at(RTMP_VIDEO_SEQUENCE_HEADER_INDEX) = legacy_packet_type;
+	::memcpy(data->data() + RTMP_VIDEO_COMPOSITION_OFFSET_INDEX, composition_time, sizeof(composition_time));
+
+	message->message_header->body_size = static_cast<uint32_t>(data->size());
+
+	return true;
+}
+
 //====================================================================================================
 // Chunk Message - Audio Message
 // * 패킷 구조
@@ -1270,16 +1628,20 @@ bool RtmpChunkStream::ReceiveAudioMessage(std::shared_ptr<ImportMessage> &messag
 //====================================================================================================
 bool RtmpChunkStream::VideoSequenceHeaderProcess(std::shared_ptr<std::vector<uint8_t>> &data, uint8_t control_byte)
 {
+	if((control_byte & 0x0f) == RTMP_VIDEO_CODEC_ID_HEVC)
+	{
+		return HevcSequenceHeaderProcess(data);
+	}
 
-	// Codec Type Check(Only H264)
-	if((control_byte & 0x0f) != 7)
+	// Codec Type Check(H264)
+	if((control_byte & 0x0f) != RTMP_VIDEO_CODEC_ID_AVC)
 	{
 		logtd("Not Supported Codec Type - stream(%s/%s) codec(%d)",
 		      _app_name.CStr(),
 		      _stream_name.CStr(),
 		      (control_byte & 0x0f));
 
-		logti("Please select H264 codec - stream(%s/%s)", _app_name.CStr(), _stream_name.CStr());
+		logti("Please select H264 or H265 codec - stream(%s/%s)", _app_name.CStr(), _stream_name.CStr());
 
 		return false;
 	}
@@ -1318,6 +1680,7 @@ bool RtmpChunkStream::VideoSequenceHeaderProcess(std::shared_ptr<std::vector<uin
 	_media_info->avc_sps->assign(sps.begin(), sps.end()); // SPS
 	_media_info->avc_pps->assign(pps.begin(), pps.end());  // PPS
 
+	_media_info->video_codec_type = RtmpCodecType::H264;
 	_media_info->video_streaming = true;
 
 	logtd("Video sequence header - stream(%s/%s) sps(%d) pps(%d) profile(%d) compatibility(%d) level(%d)",
@@ -1332,6 +1695,63 @@ bool RtmpChunkStream::VideoSequenceHeaderProcess(std::shared_ptr<std::vector<uin
 	return true;
 }
 
+//====================================================================================================
+// HevcSequenceHeaderProcess
+// - VPS/SPS/PPS Load(HEVCDecoderConfigurationRecord)
+// - 코덱 정보는 메타데이터 보다 Sequence Header 기준
+//====================================================================================================
+bool RtmpChunkStream::HevcSequenceHeaderProcess(std::shared_ptr<std::vector<uint8_t>> &data)
+{
+	// data size check
+	if(data->size() < RTMP_HEVC_SEQUENCE_MIN_DATA_SIZE)
+	{
+		logte("Data size fail - stream(%s/%s) size(%d)", _app_name.CStr(), _stream_name.CStr(), data->size());
+		return false;
+	}
+
+	std::vector<uint8_t> vps;
+	std::vector<uint8_t> sps;
+	std::vector<uint8_t> pps;
+	uint8_t hevc_profile;
+	uint8_t hevc_level;
+
+	// Parsing
+	if(!BitstreamToAnnexB::HevcSequenceHeaderParsing(data->data(),
+	                                                 data->size(),
+	                                                 vps,
+	                                                 sps,
+	                                                 pps,
+	                                                 hevc_profile,
+	                                                 hevc_level))
+	{
+		logte("HEVC sequence header parsing fail - stream(%s/%s) size(%d)\n%s",
+		      _app_name.CStr(),
+		      _stream_name.CStr(),
+		      data->size(),
+		      ov::ToHexString(data->data(), data->size()).CStr());
+
+		return false;
+	}
+
+	_media_info->hevc_vps->assign(vps.begin(), vps.end()); // VPS
+	_media_info->hevc_sps->assign(sps.begin(), sps.end()); // SPS
+	_media_info->hevc_pps->assign(pps.begin(), pps.end()); // PPS
+
+	_media_info->video_codec_type = RtmpCodecType::H265;
+	_media_info->video_streaming = true;
+
+	logtd("HEVC sequence header - stream(%s/%s) vps(%d) sps(%d) pps(%d) profile(%d) level(%d)",
+	      _app_name.CStr(),
+	      _stream_name.CStr(),
+	      _media_info->hevc_vps->size(),
+	      _media_info->hevc_sps->size(),
+	      _media_info->hevc_pps->size(),
+	      hevc_profile,
+	      hevc_level);
+
+	return true;
+}
+
 //====================================================================================================
 // AudioSequenceHeaderProcess
 // - Audio Control 패킷 처리
@@ -1561,6 +1981,17 @@ bool RtmpChunkStream::OnAmfMetaData(std::shared_ptr<RtmpMuxMessageHeader> &messa
 		{
 			video_codec_type = RtmpCodecType::H264;
 		}
+		else if(object->GetType(index) == AmfDataType::String &&
+		        (strcmp("hvc1", object->GetString(index)) == 0 || strcmp("hev1", object->GetString(index)) == 0))
+		{
+			video_codec_type = RtmpCodecType::H265;
+		}
+		else if(object->GetType(index) == AmfDataType::Number &&
+		        (object->GetNumber(index) == 12.0 || object->GetNumber(index) == (double)RTMP_FOURCC_HEVC))
+		{
+			// Enhanced RTMP : FourCC as a number
+			video_codec_type = RtmpCodecType::H265;
+		}
 	}
 
 	// Video Framerate
@@ -1673,8 +2104,8 @@ bool RtmpChunkStream::OnAmfMetaData(std::shared_ptr<RtmpMuxMessageHeader> &messa
 		audio_samplesize = object->GetNumber(index);
 	}    // Audio Sample Size
 
-	// support codec check (H264/AAC 지원)
-	if(!(video_codec_type == RtmpCodecType::H264) && !(audio_codec_type == RtmpCodecType::AAC))
+	// support codec check (H264/H265/AAC 지원)
+	if(!(video_codec_type == RtmpCodecType::H264 || video_codec_type == RtmpCodecType::H265) && !(audio_codec_type == RtmpCodecType::AAC))
 	{
 		logtw("codec type fail - stream(%s/%s) id(%u/%u) video(%s) audio(%s)",
 		      _app_name.CStr(),
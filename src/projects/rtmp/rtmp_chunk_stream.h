@@ -19,9 +19,12 @@
 #include <config/config.h>
 
 #include "chunk/rtmp_import_chunk.h"
+#include "chunk/rtmp_receive_buffer.h"
 #include "chunk/rtmp_export_chunk.h"
 #include "chunk/rtmp_handshake.h"
 #include "chunk/amf_document.h"
+#include "chunk/amf_reader.h"
+#include "rtmp_play.h"
 
 //====================================================================================================
 // Interface
@@ -54,6 +57,13 @@ public:
 	                            ov::String &stream_name,
 	                            info::application_id_t applicaiton_id,
 	                            uint32_t stream_id) = 0;
+
+	// "play" command, returns nullptr if the stream cannot be played
+	virtual std::shared_ptr<RtmpPlayConnection> OnChunkStreamPlay(ov::ClientSocket *remote,
+	                                                              const ov::String &app_name,
+	                                                              const ov::String &stream_name) = 0;
+	// Detaches the player from the stream (e.g. the "play" command has failed after OnChunkStreamPlay())
+	virtual void OnChunkStreamStopPlay(const std::shared_ptr<RtmpPlayConnection> &connection) = 0;
 };
 
 //====================================================================================================
@@ -67,7 +77,15 @@ public:
 	~RtmpChunkStream() override = default;
 
 public:
-	int32_t OnDataReceived(const std::unique_ptr<std::vector<uint8_t>> &data);
+	int32_t OnDataReceived(const uint8_t *data, size_t data_size);
+
+	// 메모리 사용량 (monitoring)
+	size_t GetReceiveBufferSize() const
+	{
+		return _receive_buffer.GetCapacity();
+	}
+
+	size_t GetMessageBufferSize() const;
 
 	static ov::String GetCodecString(RtmpCodecType codec_type);
 
@@ -108,14 +126,25 @@ public:
 		return _remote;
 	}
 
+	// nullptr if the connection doesn't play a stream
+	const std::shared_ptr<RtmpPlayConnection> &GetPlayConnection() const
+	{
+		return _play_connection;
+	}
+
+	void ResetPlayConnection()
+	{
+		_play_connection = nullptr;
+	}
+
 private :
 	bool SendData(int data_size, uint8_t *data);
 
-	int32_t ReceiveHandshakePacket(const std::shared_ptr<const std::vector<uint8_t>> &data);
+	int32_t ReceiveHandshakePacket(const uint8_t *data, int32_t data_size);
 
-	int32_t ReceiveChunkPacket(const std::shared_ptr<const std::vector<uint8_t>> &data);
+	int32_t ReceiveChunkPacket(const uint8_t *data, int32_t data_size);
 
-	bool SendHandshake(const std::shared_ptr<const std::vector<uint8_t>> &data);
+	bool SendHandshake(const uint8_t *data);
 
 	bool ReceiveChunkMessage();
 
@@ -125,24 +154,37 @@ private :
 
 	void ReceiveAmfCommandMessage(std::shared_ptr<ImportMessage> &message);
 
+	// Handles connect/releaseStream/FCPublish/createStream/publish without building the AmfDocument
+	// (returns false if the command is not handled, AmfDocument is used then)
+	bool ReceiveAmfCommandMessageFast(std::shared_ptr<ImportMessage> &message);
+
 	void ReceiveAmfDataMessage(std::shared_ptr<ImportMessage> &message);
 
 	bool ReceiveAudioMessage(std::shared_ptr<ImportMessage> &message);
 
 	bool ReceiveVideoMessage(std::shared_ptr<ImportMessage> &message);
 
-	void
-	OnAmfConnect(std::shared_ptr<RtmpMuxMessageHeader> &message_header, AmfDocument &document, double transaction_id);
+	// Converts the ExVideoTagHeader of Enhanced RTMP to the legacy VideoTagHeader (the body is changed)
+	// ignored: true if the message has no frame (e.g. metadata)
+	bool ConvertEnhancedVideoHeader(std::shared_ptr<ImportMessage> &message, bool &ignored);
 
-	void OnAmfCreateStream(std::shared_ptr<RtmpMuxMessageHeader> &message_header,
-	                       AmfDocument &document,
-	                       double transaction_id);
+	// _app_name is set by the caller (app of the command object)
+	void OnAmfConnect(std::shared_ptr<RtmpMuxMessageHeader> &message_header, double transaction_id, double object_encoding);
 
-	void
-	OnAmfFCPublish(std::shared_ptr<RtmpMuxMessageHeader> &message_header, AmfDocument &document, double transaction_id);
+	void OnAmfCreateStream(std::shared_ptr<RtmpMuxMessageHeader> &message_header, double transaction_id);
 
-	void
-	OnAmfPublish(std::shared_ptr<RtmpMuxMessageHeader> &message_header, AmfDocument &document, double transaction_id);
+	// stream_name is empty if the command has no stream name
+	void OnAmfFCPublish(std::shared_ptr<RtmpMuxMessageHeader> &message_header,
+	                    double transaction_id,
+	                    const ov::String &stream_name);
+
+	void OnAmfPublish(std::shared_ptr<RtmpMuxMessageHeader> &message_header,
+	                  double transaction_id,
+	                  const ov::String &stream_name);
+
+	void OnAmfPlay(std::shared_ptr<RtmpMuxMessageHeader> &message_header,
+	               double transaction_id,
+	               const ov::String &stream_name);
 
 	void OnAmfDeleteStream(std::shared_ptr<RtmpMuxMessageHeader> &message_header,
 	                       AmfDocument &document,
@@ -162,6 +204,8 @@ private :
 
 	bool SendStreamBegin();
 
+	bool SendSetChunkSize(uint32_t chunk_size);
+
 	bool SendAcknowledgementSize();
 
 	bool SendAmfCommand(std::shared_ptr<RtmpMuxMessageHeader> &message_header, AmfDocument &document);
@@ -181,6 +225,8 @@ private :
 
 	bool VideoSequenceHeaderProcess(std::shared_ptr<std::vector<uint8_t>> &data, uint8_t control_byte);
 
+	bool HevcSequenceHeaderProcess(std::shared_ptr<std::vector<uint8_t>> &data);
+
 	bool AudioSequenceHeaderProcess(std::shared_ptr<std::vector<uint8_t>> &data, uint8_t control_byte);
 
 	bool StreamCreate();
@@ -194,11 +240,13 @@ protected :
 	uint32_t _stream_id;
 	ov::String _device_string;
 
-	std::unique_ptr<std::vector<uint8_t>> _remained_data;
+	// 처리하지 못하고 남은 데이터 (다음 수신 데이터와 이어서 파싱)
+	RtmpReceiveBuffer _receive_buffer;
 	RtmpHandshakeState _handshake_state;
 	std::unique_ptr<RtmpImportChunk> _import_chunk;
 	std::unique_ptr<RtmpExportChunk> _export_chunk;
 	std::shared_ptr<RtmpMediaInfo> _media_info;
+	std::shared_ptr<RtmpPlayConnection> _play_connection;
 
 	uint32_t _rtmp_stream_id;
 	uint32_t _peer_bandwidth;
@@ -0,0 +1,122 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtmp_play.h"
+#include "rtmp_server.h"
+
+#define OV_LOG_TAG "RtmpProvider"
+
+//====================================================================================================
+// RtmpPlayConnection
+//====================================================================================================
+RtmpPlayConnection::RtmpPlayConnection(RtmpServer *server,
+                                       const std::shared_ptr<ov::ClientSocket> &socket,
+                                       const ov::String &app_name,
+                                       const ov::String &stream_name)
+	: _server(server),
+	  _socket(socket),
+	  _app_name(app_name),
+	  _stream_name(stream_name)
+{
+}
+
+//====================================================================================================
+// Disconnect
+//====================================================================================================
+void RtmpPlayConnection::Disconnect()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if(_server != nullptr)
+	{
+		_server->DisconnectPlayer(_socket);
+	}
+}
+
+//====================================================================================================
+// Detach
+//====================================================================================================
+void RtmpPlayConnection::Detach()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_server = nullptr;
+}
+
+//====================================================================================================
+// ToString
+//====================================================================================================
+ov::String RtmpPlayConnection::ToString() const
+{
+	return ov::String::FormatString("%s/%s (%s)", _app_name.CStr(), _stream_name.CStr(), _socket->ToString().CStr());
+}
+
+//====================================================================================================
+// Register
+//====================================================================================================
+bool RtmpPlayRegistry::Register(const ov::String &app_name, RtmpPlayObserver *observer)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if(_observers.find(app_name) != _observers.end())
+	{
+		logtw("The RTMP players of %s are already served", app_name.CStr());
+		return false;
+	}
+
+	_observers[app_name] = observer;
+
+	return true;
+}
+
+//====================================================================================================
+// Unregister
+//====================================================================================================
+void RtmpPlayRegistry::Unregister(const ov::String &app_name, RtmpPlayObserver *observer)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto item = _observers.find(app_name);
+
+	if((item != _observers.end()) && (item->second == observer))
+	{
+		_observers.erase(item);
+	}
+}
+
+//====================================================================================================
+// Play
+//====================================================================================================
+bool RtmpPlayRegistry::Play(const std::shared_ptr<RtmpPlayConnection> &connection)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto item = _observers.find(connection->GetAppName());
+
+	if(item == _observers.end())
+	{
+		logtw("RTMP play is not enabled for %s", connection->ToString().CStr());
+		return false;
+	}
+
+	return item->second->OnPlay(connection);
+}
+
+//====================================================================================================
+// Stop
+//====================================================================================================
+void RtmpPlayRegistry::Stop(const std::shared_ptr<RtmpPlayConnection> &connection)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto item = _observers.find(connection->GetAppName());
+
+	if(item != _observers.end())
+	{
+		item->second->OnPlayStopped(connection);
+	}
+}
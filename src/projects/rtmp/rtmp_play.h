@@ -0,0 +1,124 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+#include <base/ovsocket/ovsocket.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+
+// Chunk size of the media sent to the players (Set Chunk Size is sent before NetStream.Play.Start),
+// all players use the same size, so the chunks are serialized once per stream
+#define RTMP_PLAY_CHUNK_SIZE                (4096)
+// Message stream id of the media sent to the players (createStream always returns 1)
+#define RTMP_PLAY_STREAM_ID                 (1)
+
+class RtmpServer;
+
+//====================================================================================================
+// RtmpPlayConnection
+// - A connection of RtmpServer which has requested "play"
+// - The publisher sends the chunks with the socket, but the server owns the connection (it is closed
+//   by the server only)
+//====================================================================================================
+class RtmpPlayConnection
+{
+public:
+	RtmpPlayConnection(RtmpServer *server,
+	                   const std::shared_ptr<ov::ClientSocket> &socket,
+	                   const ov::String &app_name,
+	                   const ov::String &stream_name);
+
+	const std::shared_ptr<ov::ClientSocket> &GetSocket() const
+	{
+		return _socket;
+	}
+
+	const ov::String &GetAppName() const
+	{
+		return _app_name;
+	}
+
+	const ov::String &GetStreamName() const
+	{
+		return _stream_name;
+	}
+
+	// NetStream.Play.Start has been sent, the media can be sent after it
+	bool IsStarted() const
+	{
+		return _started;
+	}
+
+	void SetStarted()
+	{
+		_started = true;
+	}
+
+	// Requests the server to close the connection (it can be called by any thread, the timer thread of the server closes it)
+	void Disconnect();
+
+	// The connection is closed or the server is stopped (RtmpServer only)
+	void Detach();
+
+	ov::String ToString() const;
+
+private:
+	std::mutex _mutex;
+	RtmpServer *_server;
+
+	std::shared_ptr<ov::ClientSocket> _socket;
+	ov::String _app_name;
+	ov::String _stream_name;
+
+	std::atomic<bool> _started { false };
+};
+
+//====================================================================================================
+// RtmpPlayObserver
+// - Serves the players of an application (implemented by the publisher)
+//====================================================================================================
+class RtmpPlayObserver
+{
+public:
+	virtual ~RtmpPlayObserver() = default;
+
+	// Returns false if the stream cannot be played (NetStream.Play.StreamNotFound is sent)
+	virtual bool OnPlay(const std::shared_ptr<RtmpPlayConnection> &connection) = 0;
+
+	// The connection is closed (by the player, the server or Disconnect())
+	virtual void OnPlayStopped(const std::shared_ptr<RtmpPlayConnection> &connection) = 0;
+};
+
+//====================================================================================================
+// RtmpPlayRegistry
+// - The RTMP provider and the publisher of an application are created separately, so the servers
+//   find the observer of the application by the name
+// - The observer is called with the lock of the registry, so it is not unregistered while it is called
+//====================================================================================================
+class RtmpPlayRegistry : public ov::Singleton<RtmpPlayRegistry>
+{
+public:
+	friend class ov::Singleton<RtmpPlayRegistry>;
+
+	bool Register(const ov::String &app_name, RtmpPlayObserver *observer);
+	void Unregister(const ov::String &app_name, RtmpPlayObserver *observer);
+
+	// Returns false if there is no observer of the application or the observer refuses it
+	bool Play(const std::shared_ptr<RtmpPlayConnection> &connection);
+	void Stop(const std::shared_ptr<RtmpPlayConnection> &connection);
+
+protected:
+	RtmpPlayRegistry() = default;
+
+	std::mutex _mutex;
+	// key: application name
+	std::map<ov::String, RtmpPlayObserver *> _observers;
+};
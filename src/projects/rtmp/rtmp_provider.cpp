@@ -81,7 +81,7 @@ bool RtmpProvider::Start()
 
 	// RtmpServer 에 Observer 연결
 	_rtmp_server->AddObserver(RtmpObserver::GetSharedPtr());
-	_rtmp_server->Start(rtmp_address);
+	_rtmp_server->Start(rtmp_address, _provider_info->GetWorkerCount());
 
 	return Provider::Start();
 }
@@ -91,9 +91,30 @@ bool RtmpProvider::Start()
 //====================================================================================================
 bool RtmpProvider::Stop()
 {
+	if(_rtmp_server != nullptr)
+	{
+		// The port is closed when the last provider which shares it is stopped
+		_rtmp_server->Stop();
+		_rtmp_server = nullptr;
+	}
+
 	return Provider::Stop();
 }
 
+//====================================================================================================
+// GetConnectionMemoryData
+// - 연결별 수신/메시지 버퍼 크기
+//====================================================================================================
+bool RtmpProvider::GetConnectionMemoryData(std::vector<std::shared_ptr<pvd::ConnectionMemoryData>> &memories)
+{
+	if(_rtmp_server == nullptr)
+	{
+		return false;
+	}
+
+	return _rtmp_server->GetConnectionMemoryData(memories);
+}
+
 std::shared_ptr<Application> RtmpProvider::OnCreateApplication(const info::Application *application_info)
 {
 	return RtmpApplication::Create(application_info);
@@ -159,7 +180,7 @@ bool RtmpProvider::OnStreamReadyComplete(const ov::String &app_name,
 		// 비디오는 TrackId 0으로 고정
 		new_track->SetId(0);
 		new_track->SetMediaType(MediaType::Video);
-		new_track->SetCodecId(MediaCodecId::H264);
+		new_track->SetCodecId((media_info->video_codec_type == RtmpCodecType::H265) ? MediaCodecId::H265 : MediaCodecId::H264);
 		new_track->SetWidth((uint32_t)media_info->video_width);
 		new_track->SetHeight((uint32_t)media_info->video_height);
 		new_track->SetFrameRate(media_info->video_framerate);
@@ -196,7 +217,10 @@ bool RtmpProvider::OnStreamReadyComplete(const ov::String &app_name,
 	}
 
 	// 라우터에 스트림이 생성되었다고 알림
-	application->CreateStream2(stream);
+	if(application->CreateStream2(stream) == false)
+	{
+		return false;
+	}
 
 	// id 설정
 	application_id = application->GetId();
@@ -239,6 +263,9 @@ bool RtmpProvider::OnVideoData(info::application_id_t application_id,
 	                                          timestamp,
 	                                          frame_type == RtmpFrameType::VideoIFrame ? MediaPacketFlag::Key : MediaPacketFlag::NoFlag);
 
+	// RtmpChunkStream calls it as soon as the message is received
+	pbuf->SetIngestTime(ov::LatencyHistogram::GetCurrentMicroseconds());
+
 	application->SendFrame(stream, std::move(pbuf));
 
 	return true;
@@ -276,6 +303,8 @@ bool RtmpProvider::OnAudioData(info::application_id_t application_id,
 	                                          data->size(),
 	                                          timestamp,
 	                                          MediaPacketFlag::Key);
+	pbuf->SetIngestTime(ov::LatencyHistogram::GetCurrentMicroseconds());
+
 	application->SendFrame(stream, std::move(pbuf));
 
 	return true;
@@ -46,6 +46,8 @@ public:
 
     bool Stop() override;
 
+    bool GetConnectionMemoryData(std::vector<std::shared_ptr<pvd::ConnectionMemoryData>> &memories) override;
+
     std::shared_ptr<pvd::Application> OnCreateApplication(const info::Application *application_info) override;
 
     //--------------------------------------------------------------------
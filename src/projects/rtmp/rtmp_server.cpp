@@ -22,7 +22,7 @@ RtmpServer::~RtmpServer()
 //====================================================================================================
 // Start
 //====================================================================================================
-bool RtmpServer::Start(const ov::SocketAddress &address)
+bool RtmpServer::Start(const ov::SocketAddress &address, int worker_count)
 {
     logtd("RtmpServer Start");
 
@@ -39,10 +39,18 @@ bool RtmpServer::Start(const ov::SocketAddress &address)
                                 return true;
                               }, nullptr, 3000, true);
 
+    // Disconnect Request Timer Setting
+    _garbage_check_timer.Push([this](void *paramter) ->bool
+                              {
+                                OnDisconnectRequest();
+                                return true;
+                              }, nullptr, RTMP_SERVER_DISCONNECT_INTERVAL, true);
+
     // Gargabe Check Timer Start
     _garbage_check_timer.Start();
 
-	_physical_port = PhysicalPortManager::Instance()->CreatePort(ov::SocketType::Tcp, address);
+	// Each thread of the port has its own epoll, and the connections are distributed by the kernel (SO_REUSEPORT)
+	_physical_port = PhysicalPortManager::Instance()->CreatePort(ov::SocketType::Tcp, address, 0, 0, worker_count);
 
 	if(_physical_port != nullptr)
 	{
@@ -66,6 +74,18 @@ bool RtmpServer::Stop()
     _garbage_check_timer.Stop();
 
 	_physical_port->RemoveObserver(this);
+
+	// The publishers don't send the media to the players of this server anymore
+	for(auto &shard : _shards)
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		for(auto &item : shard.chunk_streams)
+		{
+			StopPlay(item.second);
+		}
+	}
+
 	PhysicalPortManager::Instance()->DeletePort(_physical_port);
 	_physical_port = nullptr;
 
@@ -118,6 +138,19 @@ bool RtmpServer::RemoveObserver(const std::shared_ptr<RtmpObserver> &observer)
     return true;
 }
 
+//====================================================================================================
+// GetCurrentShard
+// - The shard is assigned to the thread when the thread calls it first
+//====================================================================================================
+RtmpChunkStreamShard &RtmpServer::GetCurrentShard()
+{
+    // Shared by all RtmpServers, the threads of a port get the different shards
+    static std::atomic<uint32_t> next_shard_index(0);
+    static thread_local uint32_t shard_index = next_shard_index++ % RTMP_SERVER_MAX_SHARD_COUNT;
+
+    return _shards[shard_index];
+}
+
 //====================================================================================================
 // OnConnected
 // - client 세션 추가
@@ -126,75 +159,188 @@ void RtmpServer::OnConnected(const std::shared_ptr<ov::Socket> &remote)
 {
     logti("Rtmp input stream connected - remote(%s)", remote->ToString().CStr());
 
-    std::unique_lock<std::recursive_mutex> lock(_chunk_stream_list_mutex);
+    auto &shard = GetCurrentShard();
+    std::lock_guard<std::mutex> lock(shard.mutex);
 
-    _chunk_stream_list[remote.get()] = std::make_shared<RtmpChunkStream>(dynamic_cast<ov::ClientSocket *>(remote.get()), this);
+    shard.chunk_streams[remote.get()] = std::make_shared<RtmpChunkStream>(dynamic_cast<ov::ClientSocket *>(remote.get()), this);
 }
 
 //====================================================================================================
 // Disconnect
 // - stream name은 중복 가능 해서 stream id 로 검색
+// - An ingest thread calls it while its shard is locked (e.g. duplicated stream name), so the connection
+//   is disconnected by the timer thread which doesn't lock any shard
 //====================================================================================================
 bool RtmpServer::Disconnect(const ov::String &app_name, uint32_t stream_id)
 {
-    std::unique_lock<std::recursive_mutex> lock(_chunk_stream_list_mutex);
+    std::lock_guard<std::mutex> lock(_disconnect_request_mutex);
+
+    _disconnect_requests.emplace_back(app_name, stream_id);
+
+    return true;
+}
+
+//====================================================================================================
+// DisconnectPlayer
+// - Called by the publishers (e.g. the stream is deleted), so the shards are not locked here
+//====================================================================================================
+bool RtmpServer::DisconnectPlayer(const std::shared_ptr<ov::ClientSocket> &remote)
+{
+    std::lock_guard<std::mutex> lock(_disconnect_request_mutex);
+
+    _player_disconnect_requests.push_back(remote);
+
+    return true;
+}
+
+//====================================================================================================
+// OnDisconnectRequest
+// - Disconnect()/DisconnectPlayer() 요청 처리
+//====================================================================================================
+void RtmpServer::OnDisconnectRequest()
+{
+    std::vector<std::pair<ov::String, uint32_t>> requests;
+    std::vector<std::shared_ptr<ov::ClientSocket>> player_requests;
+
+    {
+        std::lock_guard<std::mutex> lock(_disconnect_request_mutex);
+        requests.swap(_disconnect_requests);
+        player_requests.swap(_player_disconnect_requests);
+    }
+
+    for(const auto &remote : player_requests)
+    {
+        for(auto &shard : _shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            auto item = shard.chunk_streams.find(remote.get());
+
+            if(item != shard.chunk_streams.end())
+            {
+                logti("Rtmp player disconnect - stream(%s/%s) remote(%s)",
+                      item->second->GetAppName().CStr(),
+                      item->second->GetStreamName().CStr(),
+                      remote->ToString().CStr());
+
+                StopPlay(item->second);
+                _physical_port->DisconnectClient(remote.get());
+                shard.chunk_streams.erase(item);
+                break;
+            }
+        }
+    }
+
+    for(const auto &request : requests)
+    {
+        bool found = false;
 
-    for(auto item = _chunk_stream_list.begin(); item != _chunk_stream_list.end(); ++item)
+        for(auto &shard : _shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            for(auto item = shard.chunk_streams.begin(); item != shard.chunk_streams.end(); ++item)
+            {
+                auto &chunk_stream = item->second;
+
+                if(chunk_stream->GetAppName() == request.first && chunk_stream->GetStreamId() == request.second)
+                {
+                    // The stream is already deleted by the caller
+                    _physical_port->DisconnectClient(dynamic_cast<ov::ClientSocket *>(item->first));
+                    shard.chunk_streams.erase(item);
+
+                    found = true;
+                    break;
+                }
+            }
+
+            if(found)
+            {
+                break;
+            }
+        }
+    }
+}
+
+//====================================================================================================
+// GetConnectionMemoryData
+// - 연결별 메모리 사용량 (monitoring)
+//====================================================================================================
+bool RtmpServer::GetConnectionMemoryData(std::vector<std::shared_ptr<pvd::ConnectionMemoryData>> &memories)
+{
+    for(auto &shard : _shards)
     {
-        auto chunk_stream = item->second;
+        std::lock_guard<std::mutex> lock(shard.mutex);
 
-        if(chunk_stream->GetAppName() == app_name && chunk_stream->GetStreamId()== stream_id)
+        for(auto &item : shard.chunk_streams)
         {
-	        _physical_port->DisconnectClient(dynamic_cast<ov::ClientSocket *>(item->first));
-            _chunk_stream_list.erase(item);
-            return true;
+            auto memory_data = std::make_shared<pvd::ConnectionMemoryData>();
+
+            memory_data->app_name = item.second->GetAppName();
+            memory_data->stream_name = item.second->GetStreamName();
+            memory_data->remote = item.second->GetRemoteSocket()->ToString();
+            memory_data->receive_buffer_size = item.second->GetReceiveBufferSize();
+            memory_data->message_buffer_size = item.second->GetMessageBufferSize();
+
+            memories.push_back(memory_data);
         }
     }
 
-    return false;
+    return true;
+}
+
+//====================================================================================================
+// CloseChunkStream
+// - 스트림 삭제 및 socket 종료
+//====================================================================================================
+void RtmpServer::CloseChunkStream(ov::Socket *remote, const std::shared_ptr<RtmpChunkStream> &chunk_stream)
+{
+    StopPlay(chunk_stream);
+
+    // Stream Close
+    if(chunk_stream->GetAppId() != 0 && chunk_stream->GetStreamId() != 0)
+    {
+        OnDeleteStream(chunk_stream->GetRemoteSocket(),
+                       chunk_stream->GetAppName(),
+                       chunk_stream->GetStreamName(),
+                       chunk_stream->GetAppId(),
+                       chunk_stream->GetStreamId());
+    }
+
+    // Socket Close
+    _physical_port->DisconnectClient(dynamic_cast<ov::ClientSocket *>(remote));
 }
 
 //====================================================================================================
 // OnDataReceived
 // - 데이터 수신
+// - Only the shard of the current thread is locked (the connection is always handled by this thread)
 //====================================================================================================
 void RtmpServer::OnDataReceived(const std::shared_ptr<ov::Socket> &remote,
                                 const ov::SocketAddress &address,
                                 const std::shared_ptr<const ov::Data> &data)
 {
-    std::unique_lock<std::recursive_mutex> lock(_chunk_stream_list_mutex);
+    auto &shard = GetCurrentShard();
+    std::lock_guard<std::mutex> lock(shard.mutex);
 
-	auto item = _chunk_stream_list.find(remote.get());
+	auto item = shard.chunk_streams.find(remote.get());
 
 	// clinet 세션 확인
-	if(item != _chunk_stream_list.end())
+	if(item != shard.chunk_streams.end())
 	{
         // client 접속 상태 확인
         if(remote->GetState() != ov::SocketState::Connected)
         {
             logte("Rtmp input stream erase - remote(%s)", remote->ToString().CStr());
-            _chunk_stream_list.erase(item);
+            StopPlay(item->second);
+            shard.chunk_streams.erase(item);
             return;
         }
 
-        // 데이터 전달
-        auto process_data = std::make_unique<std::vector<uint8_t>>((uint8_t *)data->GetData(),
-                                                                   (uint8_t *)data->GetData() + data->GetLength());
-
-        if(item->second->OnDataReceived(std::move(process_data)) < 0)
+        // 데이터 전달 (복사하지 않음)
+        if(item->second->OnDataReceived(data->GetDataAs<uint8_t>(), data->GetLength()) < 0)
         {
-            // Stream Close
-            if(item->second->GetAppId() != 0 && item->second->GetStreamId() != 0)
-            {
-                OnDeleteStream(item->second->GetRemoteSocket(),
-                               item->second->GetAppName(),
-                               item->second->GetStreamName(),
-                               item->second->GetAppId(),
-                               item->second->GetStreamId());
-            }
-
-            // Socket Close
-            _physical_port->DisconnectClient(dynamic_cast<ov::ClientSocket *>(item->first));
+            CloseChunkStream(item->first, item->second);
 
             logti("Rtmp input stream disconnect - stream(%s/%s) id(%u/%u) remote(%s)",
                   item->second->GetAppName().CStr(),
@@ -203,7 +349,7 @@ void RtmpServer::OnDataReceived(const std::shared_ptr<ov::Socket> &remote,
                   item->second->GetStreamId(),
                   remote->ToString().CStr());
 
-            _chunk_stream_list.erase(item);
+            shard.chunk_streams.erase(item);
 
             return;
         }
@@ -219,12 +365,15 @@ void RtmpServer::OnDisconnected(const std::shared_ptr<ov::Socket> &remote,
                                 PhysicalPortDisconnectReason reason,
                                 const std::shared_ptr<const ov::Error> &error)
 {
-	std::unique_lock<std::recursive_mutex> lock(_chunk_stream_list_mutex);
+    auto &shard = GetCurrentShard();
+    std::lock_guard<std::mutex> lock(shard.mutex);
 
-    auto item = _chunk_stream_list.find(remote.get());
+    auto item = shard.chunk_streams.find(remote.get());
 
-    if(item != _chunk_stream_list.end())
+    if(item != shard.chunk_streams.end())
     {
+        StopPlay(item->second);
+
         // Stream Delete
         if(item->second->GetAppId() != 0 && item->second->GetStreamId() != 0)
         {
@@ -242,7 +391,7 @@ void RtmpServer::OnDisconnected(const std::shared_ptr<ov::Socket> &remote,
               item->second->GetStreamId(),
               remote->ToString().CStr());
 
-        _chunk_stream_list.erase(item);
+        shard.chunk_streams.erase(item);
     }
 }
 
@@ -376,6 +525,57 @@ bool RtmpServer::OnDeleteStream(ov::ClientSocket *remote,
     return true;
 }
 
+//====================================================================================================
+// OnChunkStreamPlay
+// - IRtmpChunkStream 구현
+// - The observer of the application (the publisher) sends the media to the player after NetStream.Play.Start
+//====================================================================================================
+std::shared_ptr<RtmpPlayConnection> RtmpServer::OnChunkStreamPlay(ov::ClientSocket *remote,
+                                                                  const ov::String &app_name,
+                                                                  const ov::String &stream_name)
+{
+    auto connection = std::make_shared<RtmpPlayConnection>(this, remote->GetSharedPtrAs<ov::ClientSocket>(), app_name, stream_name);
+
+    if(RtmpPlayRegistry::Instance()->Play(connection) == false)
+    {
+        logtw("Rtmp player rejected - stream(%s/%s) remote(%s)", app_name.CStr(), stream_name.CStr(), remote->ToString().CStr());
+
+        connection->Detach();
+        return nullptr;
+    }
+
+    logti("Rtmp player connected - stream(%s/%s) remote(%s)", app_name.CStr(), stream_name.CStr(), remote->ToString().CStr());
+
+    return connection;
+}
+
+//====================================================================================================
+// OnChunkStreamStopPlay
+// - IRtmpChunkStream 구현
+//====================================================================================================
+void RtmpServer::OnChunkStreamStopPlay(const std::shared_ptr<RtmpPlayConnection> &connection)
+{
+    RtmpPlayRegistry::Instance()->Stop(connection);
+    connection->Detach();
+}
+
+//====================================================================================================
+// StopPlay
+//====================================================================================================
+void RtmpServer::StopPlay(const std::shared_ptr<RtmpChunkStream> &chunk_stream)
+{
+    auto connection = chunk_stream->GetPlayConnection();
+
+    if(connection == nullptr)
+    {
+        return;
+    }
+
+    OnChunkStreamStopPlay(connection);
+
+    chunk_stream->ResetPlayConnection();
+}
+
 //====================================================================================================
 // Gerbage Check
 // - Last Packet Time Check
@@ -385,42 +585,34 @@ void RtmpServer::OnGarbageCheck()
 {
     time_t current_time = time(nullptr);
 
-    std::unique_lock<std::recursive_mutex> lock(_chunk_stream_list_mutex);
-
-    for(auto item = _chunk_stream_list.begin(); item != _chunk_stream_list.end();)
+    for(auto &shard : _shards)
     {
-        auto chunk_stream = item->second;
+        std::lock_guard<std::mutex> lock(shard.mutex);
 
-        // 10초 Stream Packet 체크
-        if(current_time - chunk_stream->GetLastPacketTime() > MAX_STREAM_PACKET_GAP)
+        for(auto item = shard.chunk_streams.begin(); item != shard.chunk_streams.end();)
         {
-            // Stream Close
-            if(item->second->GetAppId() != 0 && item->second->GetStreamId() != 0)
+            auto chunk_stream = item->second;
+
+            // 10초 Stream Packet 체크 (the players don't send the packets, they are closed by OnDisconnected())
+            if((chunk_stream->GetPlayConnection() == nullptr) &&
+               (current_time - chunk_stream->GetLastPacketTime() > MAX_STREAM_PACKET_GAP))
             {
-                OnDeleteStream(item->second->GetRemoteSocket(),
-                                item->second->GetAppName(),
-                                item->second->GetStreamName(),
-                                item->second->GetAppId(),
-                                item->second->GetStreamId());
-            }
+                CloseChunkStream(item->first, chunk_stream);
 
-            // Socket Close
-	        _physical_port->DisconnectClient(dynamic_cast<ov::ClientSocket *>(item->first));
+                logtw("Rtmp input stream  timeout remove - stream(%s/%s) id(%u/%u) time(%d/%d)",
+                      chunk_stream->GetAppName().CStr(),
+                      chunk_stream->GetStreamName().CStr(),
+                      chunk_stream->GetAppId(),
+                      chunk_stream->GetStreamId(),
+                      current_time - chunk_stream->GetLastPacketTime(),
+                      MAX_STREAM_PACKET_GAP);
 
-            logtw("Rtmp input stream  timeout remove - stream(%s/%s) id(%u/%u) time(%d/%d)",
-                  item->second->GetAppName().CStr(),
-                  item->second->GetStreamName().CStr(),
-                  item->second->GetAppId(),
-                  item->second->GetStreamId(),
-                  current_time - chunk_stream->GetLastPacketTime(),
-                  MAX_STREAM_PACKET_GAP);
-
-            _chunk_stream_list.erase(item++);
-        }
-        else
-        {
-            item++;
+                shard.chunk_streams.erase(item++);
+            }
+            else
+            {
+                item++;
+            }
         }
     }
 }
-
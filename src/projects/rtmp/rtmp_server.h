@@ -11,10 +11,32 @@
 #include "rtmp_chunk_stream.h"
 #include <base/ovsocket/ovsocket.h>
 #include <physical_port/physical_port_manager.h>
+#include <base/provider/provider.h>
 #include "rtmp_observer.h"
+#include "rtmp_play.h"
+
+// Maximum number of the shards (ingest threads which are handled without the contention)
+#define RTMP_SERVER_MAX_SHARD_COUNT         (64)
+// Interval of processing the disconnect requests (ms)
+#define RTMP_SERVER_DISCONNECT_INTERVAL     (100)
+
+//====================================================================================================
+// RtmpChunkStreamShard
+// - The connections which are handled by a thread of the port
+//====================================================================================================
+struct RtmpChunkStreamShard
+{
+    // Contended only by the garbage check/disconnect requests/monitoring
+    std::mutex mutex;
+    std::map<ov::Socket *, std::shared_ptr<RtmpChunkStream>> chunk_streams;
+};
 
 //====================================================================================================
 // RtmpServer
+// - The port has worker_count sockets (SO_REUSEPORT) and threads, and a connection is always handled
+//   by the thread of the socket which accepted it
+// - Each thread has its own shard of the connections, so the chunk streams of different threads
+//   are parsed in parallel without the lock contention
 //====================================================================================================
 class RtmpServer : protected PhysicalPortObserver, public IRtmpChunkStream
 {
@@ -24,7 +46,8 @@ public:
     virtual ~RtmpServer();
 
 public:
-    bool Start(const ov::SocketAddress &address);
+    // worker_count: number of the ingest threads (0: PhysicalPortManager::GetWorkerCount())
+    bool Start(const ov::SocketAddress &address, int worker_count = 0);
 
     bool Stop();
 
@@ -32,8 +55,14 @@ public:
 
     bool RemoveObserver(const std::shared_ptr<RtmpObserver> &observer);
 
+    // The connection is disconnected by the timer thread later (it can be called by the ingest threads)
     bool Disconnect(const ov::String &app_name, uint32_t stream_id);
 
+    // The player is disconnected by the timer thread later (see RtmpPlayConnection::Disconnect())
+    bool DisconnectPlayer(const std::shared_ptr<ov::ClientSocket> &remote);
+
+    bool GetConnectionMemoryData(std::vector<std::shared_ptr<pvd::ConnectionMemoryData>> &memories);
+
 protected:
     //--------------------------------------------------------------------
     // Implementation of PhysicalPortObserver
@@ -78,14 +107,33 @@ protected:
                         info::application_id_t application_id,
                         uint32_t stream_id) override;
 
+    std::shared_ptr<RtmpPlayConnection> OnChunkStreamPlay(ov::ClientSocket *remote,
+                                                          const ov::String &app_name,
+                                                          const ov::String &stream_name) override;
+    void OnChunkStreamStopPlay(const std::shared_ptr<RtmpPlayConnection> &connection) override;
+
     void OnGarbageCheck();
+    void OnDisconnectRequest();
+
+    // Shard of the current thread (the thread of the port which calls the callbacks)
+    RtmpChunkStreamShard &GetCurrentShard();
+
+    // Deletes the stream and closes the socket of the chunk stream (the mutex of the shard must be locked)
+    void CloseChunkStream(ov::Socket *remote, const std::shared_ptr<RtmpChunkStream> &chunk_stream);
+
+    // Stops sending the media to the player (nothing is done if the chunk stream doesn't play)
+    void StopPlay(const std::shared_ptr<RtmpChunkStream> &chunk_stream);
 
 private :
     std::shared_ptr<PhysicalPort> _physical_port;
-    std::map<ov::Socket *, std::shared_ptr<RtmpChunkStream>> _chunk_stream_list;
+    RtmpChunkStreamShard _shards[RTMP_SERVER_MAX_SHARD_COUNT];
     std::vector<std::shared_ptr<RtmpObserver>> _observers;
 
     ov::DelayQueue _garbage_check_timer;
-    std::recursive_mutex _chunk_stream_list_mutex; // 동일 Thread에서 접속 가능
+
+    std::mutex _disconnect_request_mutex;
+    std::vector<std::pair<ov::String, uint32_t>> _disconnect_requests;
+    // The sockets are kept until the requests are processed, so they are not reused by the other connections
+    std::vector<std::shared_ptr<ov::ClientSocket>> _player_disconnect_requests;
 
 };
@@ -0,0 +1,154 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtmp_play_session.h"
+#include "rtmp_push_private.h"
+
+#include <base/publisher/application.h>
+#include <base/publisher/stream.h>
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<RtmpPlaySession> RtmpPlaySession::Create(const std::shared_ptr<Application> &application,
+                                                         const std::shared_ptr<Stream> &stream,
+                                                         const std::shared_ptr<RtmpPlayConnection> &connection,
+                                                         size_t queue_size)
+{
+	auto session = std::make_shared<RtmpPlaySession>(application, stream, connection, queue_size);
+
+	if(session->Start() == false)
+	{
+		return nullptr;
+	}
+
+	return session;
+}
+
+//====================================================================================================
+// RtmpPlaySession
+//====================================================================================================
+RtmpPlaySession::RtmpPlaySession(const std::shared_ptr<Application> &application,
+                                 const std::shared_ptr<Stream> &stream,
+                                 const std::shared_ptr<RtmpPlayConnection> &connection,
+                                 size_t queue_size)
+	: Session(application, stream),
+	  _connection(connection),
+	  _queue_size_limit(queue_size)
+{
+}
+
+//====================================================================================================
+// ~RtmpPlaySession
+//====================================================================================================
+RtmpPlaySession::~RtmpPlaySession()
+{
+	Stop();
+	logtd("RtmpPlaySession(%u) has been terminated finally", GetId());
+}
+
+//====================================================================================================
+// Stop
+// - The player is disconnected by the server (nothing is done if the server has already closed it)
+//====================================================================================================
+bool RtmpPlaySession::Stop()
+{
+	if(_stopped.exchange(true))
+	{
+		return false;
+	}
+
+	_connection->Disconnect();
+
+	return Session::Stop();
+}
+
+//====================================================================================================
+// IsSequenceHeaderRequired
+// - The stream sends the sequence headers before the next key frame if true
+//====================================================================================================
+bool RtmpPlaySession::IsSequenceHeaderRequired()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	return _sequence_header_required;
+}
+
+//====================================================================================================
+// SendOutgoingData
+// - Called by the stream, the chunks are shared with the other players (not copied)
+// - If the socket has queued more than the limit, the frames are dropped until the next key frame
+//====================================================================================================
+bool RtmpPlaySession::SendOutgoingData(uint32_t packet_type, const std::shared_ptr<const ov::Data> &packet)
+{
+	auto type = static_cast<RtmpPushPacketType>(packet_type);
+	auto &socket = _connection->GetSocket();
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if(IsPlaying() == false)
+	{
+		return false;
+	}
+
+	if(type == RtmpPushPacketType::SequenceHeader)
+	{
+		_sequence_header_required = false;
+	}
+	else
+	{
+		if(_sequence_header_required)
+		{
+			return false;
+		}
+
+		if(_wait_key_frame)
+		{
+			if(type != RtmpPushPacketType::KeyFrame)
+			{
+				return false;
+			}
+
+			_wait_key_frame = false;
+		}
+
+		auto queued_bytes = socket->GetSendQueueBytes();
+
+		if((queued_bytes + packet->GetLength()) > _queue_size_limit)
+		{
+			_dropped_count++;
+
+			logtw("[%s/%s] The player %s is too slow (%zu bytes are queued), the frames are dropped to the next key frame",
+			      GetApplication()->GetName().CStr(), GetStream()->GetName().CStr(), socket->ToString().CStr(), queued_bytes);
+
+			// The queued chunks are complete messages, so the player continues from the sequence headers
+			_sequence_header_required = true;
+			_wait_key_frame = true;
+			return false;
+		}
+	}
+
+	// Forced: the limit of the queue is checked above (it can be larger than ov::SendQueueHighWaterMark)
+	if(socket->SendAsync({ packet }, true) == false)
+	{
+		logtd("[%s/%s] Could not send to the player %s",
+		      GetApplication()->GetName().CStr(), GetStream()->GetName().CStr(), socket->ToString().CStr());
+
+		_connection->Disconnect();
+		return false;
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// OnPacketReceived
+// - The commands of the player are handled by RtmpChunkStream
+//====================================================================================================
+void RtmpPlaySession::OnPacketReceived(std::shared_ptr<SessionInfo> session_info, std::shared_ptr<const ov::Data> data)
+{
+}
@@ -0,0 +1,88 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/publisher/session.h>
+#include <rtmp/rtmp_play.h>
+#include "rtmp_push_session.h"
+
+#include <atomic>
+#include <mutex>
+
+//====================================================================================================
+// RtmpPlaySession
+// - A player of the RTMP provider port, the stream sends the shared chunks (RTMP_PLAY_CHUNK_SIZE) to it
+// - The chunks are queued to the socket (flushed on EPOLLOUT by the server), so the stream is never
+//   blocked by the player. If more than queue_size bytes are queued, the frames are dropped until the
+//   next key frame (with the sequence headers again)
+//====================================================================================================
+class RtmpPlaySession : public Session
+{
+public:
+	static std::shared_ptr<RtmpPlaySession> Create(const std::shared_ptr<Application> &application,
+	                                               const std::shared_ptr<Stream> &stream,
+	                                               const std::shared_ptr<RtmpPlayConnection> &connection,
+	                                               size_t queue_size);
+
+	RtmpPlaySession(const std::shared_ptr<Application> &application,
+	                const std::shared_ptr<Stream> &stream,
+	                const std::shared_ptr<RtmpPlayConnection> &connection,
+	                size_t queue_size);
+	~RtmpPlaySession() override;
+
+	bool Stop() override;
+
+	const std::shared_ptr<RtmpPlayConnection> &GetConnection() const
+	{
+		return _connection;
+	}
+
+	// NetStream.Play.Start has been sent to the player
+	bool IsPlaying() const
+	{
+		return (_stopped == false) && _connection->IsStarted();
+	}
+
+	RtmpPushExportKey GetExportKey() const
+	{
+		return RtmpPushExportKey(RTMP_PLAY_CHUNK_SIZE, RTMP_PLAY_STREAM_ID);
+	}
+
+	bool IsSequenceHeaderRequired();
+
+	// The stream replays the GOP cache of the router once before the live messages (the stream only)
+	bool IsGopReplayRequired() const
+	{
+		return _gop_replay_required;
+	}
+
+	void SetGopReplayed()
+	{
+		_gop_replay_required = false;
+	}
+
+	uint64_t GetDroppedCount() const
+	{
+		return _dropped_count;
+	}
+
+	// Queues the chunks to the socket (packet_type: RtmpPushPacketType), returns false if the chunks are dropped
+	bool SendOutgoingData(uint32_t packet_type, const std::shared_ptr<const ov::Data> &packet) override;
+	void OnPacketReceived(std::shared_ptr<SessionInfo> session_info, std::shared_ptr<const ov::Data> data) override;
+
+private:
+	std::shared_ptr<RtmpPlayConnection> _connection;
+	size_t _queue_size_limit;
+
+	std::mutex _mutex;
+	bool _sequence_header_required = true;
+	bool _wait_key_frame = true;
+	bool _gop_replay_required = true;
+	std::atomic<bool> _stopped { false };
+	std::atomic<uint64_t> _dropped_count { 0 };
+};
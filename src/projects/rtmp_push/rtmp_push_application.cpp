@@ -0,0 +1,152 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtmp_push_application.h"
+#include "rtmp_push_private.h"
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<RtmpPushApplication> RtmpPushApplication::Create(const info::Application *application_info)
+{
+	auto application = std::make_shared<RtmpPushApplication>(application_info);
+	application->Start();
+	return application;
+}
+
+//====================================================================================================
+// RtmpPushApplication
+//====================================================================================================
+RtmpPushApplication::RtmpPushApplication(const info::Application *application_info)
+	: Application(application_info)
+{
+	auto publisher_info = application_info->GetPublisher<cfg::RtmpPublisher>();
+
+	if(publisher_info != nullptr)
+	{
+		_push_list = publisher_info->GetPushList();
+		_queue_size = static_cast<size_t>(std::max(publisher_info->GetQueueSize(), 0)) * 1024;
+		_play_enabled = publisher_info->IsPlayEnabled();
+
+		SetQueueConfig(publisher_info->GetQueue());
+	}
+}
+
+//====================================================================================================
+// ~RtmpPushApplication
+//====================================================================================================
+RtmpPushApplication::~RtmpPushApplication()
+{
+	Stop();
+	logtd("RtmpPushApplication(%d) has been terminated finally", GetId());
+}
+
+//====================================================================================================
+// Start
+//====================================================================================================
+bool RtmpPushApplication::Start()
+{
+	if(Application::Start() == false)
+	{
+		return false;
+	}
+
+	if(_play_enabled)
+	{
+		_play_registered = RtmpPlayRegistry::Instance()->Register(GetName(), this);
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// Stop
+//====================================================================================================
+bool RtmpPushApplication::Stop()
+{
+	if(_play_registered)
+	{
+		// No player is added after this (the players of the streams are disconnected when the streams are stopped)
+		RtmpPlayRegistry::Instance()->Unregister(GetName(), this);
+		_play_registered = false;
+	}
+
+	return Application::Stop();
+}
+
+//====================================================================================================
+// CreateStream
+// - ${StreamName} of the url is replaced with the name of the stream
+//====================================================================================================
+std::shared_ptr<Stream> RtmpPushApplication::CreateStream(std::shared_ptr<StreamInfo> info, uint32_t worker_count)
+{
+	std::vector<RtmpPushTarget> targets;
+
+	for(const auto &push : _push_list)
+	{
+		if((push.GetStreamName().IsEmpty() == false) && (push.GetStreamName() != info->GetName()))
+		{
+			continue;
+		}
+
+		auto url = push.GetUrl().Replace("${StreamName}", info->GetName().CStr());
+		RtmpPushTarget target;
+
+		if(RtmpPushTarget::Parse(url, push.GetChunkSize(), target) == false)
+		{
+			logte("Invalid RTMP push url: %s (%s/%s)", push.GetUrl().CStr(), GetName().CStr(), info->GetName().CStr());
+			continue;
+		}
+
+		targets.push_back(target);
+	}
+
+	logtd("CreateStream : %s/%u (%zu targets)", info->GetName().CStr(), info->GetId(), targets.size());
+
+	return RtmpPushStream::Create(GetSharedPtrAs<Application>(), *info, worker_count, targets, _queue_size);
+}
+
+//====================================================================================================
+// DeleteStream
+// - The sessions are stopped by RtmpPushStream::Stop()
+//====================================================================================================
+bool RtmpPushApplication::DeleteStream(std::shared_ptr<StreamInfo> info)
+{
+	logtd("DeleteStream : %s/%u", info->GetName().CStr(), info->GetId());
+
+	return true;
+}
+
+//====================================================================================================
+// OnPlay
+// - Called by the RTMP provider (RtmpPlayRegistry is locked)
+//====================================================================================================
+bool RtmpPushApplication::OnPlay(const std::shared_ptr<RtmpPlayConnection> &connection)
+{
+	auto stream = std::dynamic_pointer_cast<RtmpPushStream>(GetStream(connection->GetStreamName()));
+
+	if(stream == nullptr)
+	{
+		logtw("Could not find the stream to play: %s", connection->ToString().CStr());
+		return false;
+	}
+
+	return stream->AddPlayer(connection);
+}
+
+//====================================================================================================
+// OnPlayStopped
+//====================================================================================================
+void RtmpPushApplication::OnPlayStopped(const std::shared_ptr<RtmpPlayConnection> &connection)
+{
+	auto stream = std::dynamic_pointer_cast<RtmpPushStream>(GetStream(connection->GetStreamName()));
+
+	if(stream != nullptr)
+	{
+		stream->RemovePlayer(connection);
+	}
+}
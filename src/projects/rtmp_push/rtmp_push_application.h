@@ -0,0 +1,45 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/common_types.h>
+#include <base/publisher/application.h>
+#include <config/config.h>
+#include <rtmp/rtmp_play.h>
+#include "rtmp_push_stream.h"
+
+//====================================================================================================
+// RtmpPushApplication
+// - Creates the push targets of a stream from <Publishers><RTMP><Push>
+// - Serves the players of the RTMP provider port if <Publishers><RTMP><Play> is true
+//====================================================================================================
+class RtmpPushApplication : public Application, public RtmpPlayObserver
+{
+public:
+	static std::shared_ptr<RtmpPushApplication> Create(const info::Application *application_info);
+
+	explicit RtmpPushApplication(const info::Application *application_info);
+	~RtmpPushApplication() final;
+
+private:
+	bool Start() override;
+	bool Stop() override;
+
+	// Application Implementation
+	std::shared_ptr<Stream> CreateStream(std::shared_ptr<StreamInfo> info, uint32_t worker_count) override;
+	bool DeleteStream(std::shared_ptr<StreamInfo> info) override;
+
+	// RtmpPlayObserver Implementation
+	bool OnPlay(const std::shared_ptr<RtmpPlayConnection> &connection) override;
+	void OnPlayStopped(const std::shared_ptr<RtmpPlayConnection> &connection) override;
+
+	std::vector<cfg::RtmpPush> _push_list;
+	size_t _queue_size = 0;
+	bool _play_enabled = false;
+	bool _play_registered = false;
+};
@@ -0,0 +1,78 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtmp_push_publisher.h"
+#include "rtmp_push_private.h"
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<RtmpPushPublisher> RtmpPushPublisher::Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+{
+	auto publisher = std::make_shared<RtmpPushPublisher>(application_info, router);
+
+	if(publisher->Start() == false)
+	{
+		return nullptr;
+	}
+
+	return publisher;
+}
+
+//====================================================================================================
+// RtmpPushPublisher
+//====================================================================================================
+RtmpPushPublisher::RtmpPushPublisher(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+	: Publisher(application_info, std::move(router))
+{
+}
+
+//====================================================================================================
+// ~RtmpPushPublisher
+//====================================================================================================
+RtmpPushPublisher::~RtmpPushPublisher()
+{
+	logtd("RtmpPushPublisher has been terminated finally");
+}
+
+//====================================================================================================
+// Start
+//====================================================================================================
+bool RtmpPushPublisher::Start()
+{
+	auto publisher_info = _application_info->GetPublisher<cfg::RtmpPublisher>();
+
+	if((publisher_info == nullptr) || (publisher_info->IsParsed() == false))
+	{
+		logte("Invalid RTMP publisher configuration");
+		return false;
+	}
+
+	if(publisher_info->GetPushList().empty() && (publisher_info->IsPlayEnabled() == false))
+	{
+		logtw("There is no RTMP push target (and RTMP play is disabled) for %s", _application_info->GetName().CStr());
+	}
+
+	return Publisher::Start();
+}
+
+//====================================================================================================
+// OnCreateApplication
+//====================================================================================================
+std::shared_ptr<Application> RtmpPushPublisher::OnCreateApplication(const info::Application *application_info)
+{
+	return RtmpPushApplication::Create(application_info);
+}
+
+//====================================================================================================
+// monitoring data pure virtual function
+// - The pushed streams are not counted as the connections
+//====================================================================================================
+bool RtmpPushPublisher::GetMonitoringCollectionData(std::vector<std::shared_ptr<MonitoringCollectionData>> &collections)
+{
+	return true;
+}
@@ -0,0 +1,38 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/common_types.h>
+#include <base/publisher/publisher.h>
+#include "rtmp_push_application.h"
+
+//====================================================================================================
+// RtmpPushPublisher
+// - Pushes the streams to the RTMP servers (<Publishers><RTMP><Push>)
+//====================================================================================================
+class RtmpPushPublisher : public Publisher
+{
+public:
+	static std::shared_ptr<RtmpPushPublisher> Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+
+	RtmpPushPublisher(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+	~RtmpPushPublisher() override;
+
+	bool GetMonitoringCollectionData(std::vector<std::shared_ptr<MonitoringCollectionData>> &collections) override;
+
+private:
+	bool Start() override;
+
+	// Publisher Implementation
+	cfg::PublisherType GetPublisherType() override
+	{
+		return cfg::PublisherType::Rtmp;
+	}
+
+	std::shared_ptr<Application> OnCreateApplication(const info::Application *application_info) override;
+};
@@ -0,0 +1,850 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtmp_push_session.h"
+#include "rtmp_push_private.h"
+
+#include <base/publisher/application.h>
+#include <base/publisher/stream.h>
+
+#include <sys/time.h>
+
+//====================================================================================================
+// Parse
+// - rtmp://<host>[:<port>]/<app>/<stream key>
+//====================================================================================================
+bool RtmpPushTarget::Parse(const ov::String &url, int chunk_size, RtmpPushTarget &target)
+{
+	if(url.HasPrefix("rtmp://") == false)
+	{
+		return false;
+	}
+
+	auto address = url.Substring(7);
+	auto path_index = address.IndexOf('/');
+
+	if(path_index <= 0)
+	{
+		return false;
+	}
+
+	auto host_port = address.Substring(0, static_cast<size_t>(path_index));
+	auto path = address.Substring(path_index + 1);
+
+	// The stream key is the last part of the path, the app may have an instance name (<app>/<instance>)
+	auto key_index = path.IndexOfRev('/');
+
+	if((key_index <= 0) || (key_index == static_cast<off_t>(path.GetLength()) - 1))
+	{
+		return false;
+	}
+
+	target.url = url;
+	target.app = path.Substring(0, static_cast<size_t>(key_index));
+	target.stream_key = path.Substring(key_index + 1);
+	target.tc_url = ov::String::FormatString("rtmp://%s/%s", host_port.CStr(), target.app.CStr());
+	target.chunk_size = (chunk_size > 0) ? chunk_size : RTMP_DEFAULT_CHUNK_SIZE;
+
+	auto port_index = host_port.IndexOfRev(':');
+
+	if(port_index > 0)
+	{
+		target.host = host_port.Substring(0, static_cast<size_t>(port_index));
+		target.port = ov::Converter::ToUInt16(host_port.Substring(port_index + 1));
+	}
+	else
+	{
+		target.host = host_port;
+		target.port = RTMP_DEFULT_PORT;
+	}
+
+	return (target.host.IsEmpty() == false) && (target.port != 0);
+}
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<RtmpPushSession> RtmpPushSession::Create(const std::shared_ptr<Application> &application,
+                                                         const std::shared_ptr<Stream> &stream,
+                                                         const RtmpPushTarget &target,
+                                                         size_t queue_size)
+{
+	auto session = std::make_shared<RtmpPushSession>(application, stream, target, queue_size);
+
+	if(session->Start() == false)
+	{
+		return nullptr;
+	}
+
+	return session;
+}
+
+//====================================================================================================
+// RtmpPushSession
+//====================================================================================================
+RtmpPushSession::RtmpPushSession(const std::shared_ptr<Application> &application,
+                                 const std::shared_ptr<Stream> &stream,
+                                 const RtmpPushTarget &target,
+                                 size_t queue_size)
+	: Session(application, stream),
+	  _target(target),
+	  _queue_size_limit(queue_size)
+{
+}
+
+//====================================================================================================
+// ~RtmpPushSession
+//====================================================================================================
+RtmpPushSession::~RtmpPushSession()
+{
+	Stop();
+	logtd("RtmpPushSession(%u) has been terminated finally", GetId());
+}
+
+//====================================================================================================
+// Start
+//====================================================================================================
+bool RtmpPushSession::Start()
+{
+	if(_stop_thread_flag == false)
+	{
+		return false;
+	}
+
+	_recv_data = std::make_shared<ov::Data>(RTMP_PUSH_RECV_BUFFER_SIZE);
+	_stop_thread_flag = false;
+
+	try
+	{
+		_worker_thread = std::thread(&RtmpPushSession::WorkerThread, this);
+	}
+	catch(const std::system_error &e)
+	{
+		logte("Failed to start RTMP push thread (%s)", _target.tc_url.CStr());
+		_stop_thread_flag = true;
+		return false;
+	}
+
+	return Session::Start();
+}
+
+//====================================================================================================
+// Stop
+//====================================================================================================
+bool RtmpPushSession::Stop()
+{
+	if(_stop_thread_flag)
+	{
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_queue_mutex);
+
+		_stop_thread_flag = true;
+		_queue_condition.notify_all();
+	}
+
+	if(_worker_thread.joinable())
+	{
+		_worker_thread.join();
+	}
+
+	return Session::Stop();
+}
+
+//====================================================================================================
+// IsSequenceHeaderRequired
+// - The stream queues the sequence headers before the next frame if true
+//====================================================================================================
+bool RtmpPushSession::IsSequenceHeaderRequired()
+{
+	std::lock_guard<std::mutex> lock(_queue_mutex);
+
+	return _publishing && _sequence_header_required;
+}
+
+//====================================================================================================
+// SendOutgoingData
+// - Called by the stream, only queues the chunks
+// - If the queue is full, the queued chunks are dropped and the frames are dropped until the next key frame
+//====================================================================================================
+bool RtmpPushSession::SendOutgoingData(uint32_t packet_type, const std::shared_ptr<const ov::Data> &packet)
+{
+	auto type = static_cast<RtmpPushPacketType>(packet_type);
+
+	std::lock_guard<std::mutex> lock(_queue_mutex);
+
+	if(_publishing == false)
+	{
+		return false;
+	}
+
+	if(type == RtmpPushPacketType::SequenceHeader)
+	{
+		_sequence_header_required = false;
+	}
+	else
+	{
+		if(_sequence_header_required)
+		{
+			return false;
+		}
+
+		if(_wait_key_frame)
+		{
+			if(type != RtmpPushPacketType::KeyFrame)
+			{
+				return false;
+			}
+
+			_wait_key_frame = false;
+		}
+
+		if((_queue_bytes + packet->GetLength()) > _queue_size_limit)
+		{
+			_dropped_count++;
+
+			logtw("[%s/%s] %s is too slow, %zu bytes are dropped to the next key frame",
+			      GetApplication()->GetName().CStr(), GetStream()->GetName().CStr(), _target.tc_url.CStr(), _queue_bytes);
+
+			ClearQueue();
+			return false;
+		}
+	}
+
+	_queue.push_back(packet);
+	_queue_bytes += packet->GetLength();
+
+	_queue_condition.notify_one();
+
+	return true;
+}
+
+//====================================================================================================
+// OnPacketReceived
+// - The messages from the target are received by the worker thread
+//====================================================================================================
+void RtmpPushSession::OnPacketReceived(std::shared_ptr<SessionInfo> session_info, std::shared_ptr<const ov::Data> data)
+{
+}
+
+//====================================================================================================
+// ClearQueue
+// - The sequence headers are queued again before the next key frame
+//====================================================================================================
+void RtmpPushSession::ClearQueue()
+{
+	_queue.clear();
+	_queue_bytes = 0;
+	_sequence_header_required = true;
+	_wait_key_frame = true;
+}
+
+//====================================================================================================
+// Sleep
+//====================================================================================================
+bool RtmpPushSession::Sleep(int milliseconds)
+{
+	std::unique_lock<std::mutex> lock(_queue_mutex);
+
+	_queue_condition.wait_for(lock, std::chrono::milliseconds(milliseconds), [this]() -> bool {
+		return _stop_thread_flag;
+	});
+
+	return (_stop_thread_flag == false);
+}
+
+//====================================================================================================
+// WorkerThread
+// - Connect -> Handshake -> Publish -> Send the queued chunks (until disconnected) -> Reconnect
+//====================================================================================================
+void RtmpPushSession::WorkerThread()
+{
+	auto app_name = GetApplication()->GetName();
+	auto stream_name = GetStream()->GetName();
+
+	while(_stop_thread_flag == false)
+	{
+		if(Connect() && Handshake() && Publish())
+		{
+			logti("[%s/%s] Publishing to %s (chunk size: %d)", app_name.CStr(), stream_name.CStr(), _target.tc_url.CStr(), _target.chunk_size);
+
+			{
+				std::lock_guard<std::mutex> lock(_queue_mutex);
+
+				ClearQueue();
+				_publishing = true;
+			}
+
+			while(_stop_thread_flag == false)
+			{
+				if((SendAll() == false) || (ReceiveData(false) == false) || (ProcessMessages() == false))
+				{
+					break;
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(_queue_mutex);
+
+				_publishing = false;
+				ClearQueue();
+			}
+		}
+
+		Disconnect();
+
+		if(_stop_thread_flag)
+		{
+			break;
+		}
+
+		logtw("[%s/%s] Could not publish to %s, retrying after %d ms", app_name.CStr(), stream_name.CStr(), _target.tc_url.CStr(), RTMP_PUSH_RECONNECT_INTERVAL);
+
+		Sleep(RTMP_PUSH_RECONNECT_INTERVAL);
+	}
+
+	logtd("[%s/%s] RTMP push thread is terminated (%s)", app_name.CStr(), stream_name.CStr(), _target.tc_url.CStr());
+}
+
+//====================================================================================================
+// Connect
+// - The socket is blocking until the stream is published (the timeouts bound connect/send/recv)
+//====================================================================================================
+bool RtmpPushSession::Connect()
+{
+	_socket = std::make_shared<ov::ClientSocket>();
+
+	if(_socket->Create(ov::SocketType::Tcp) == false)
+	{
+		logte("Could not create a socket for %s", _target.tc_url.CStr());
+		return false;
+	}
+
+	// The lookup isn't blocked by a slow DNS server longer than the timeout (the reconnection uses the cache)
+	auto addresses = ov::DnsResolver::Instance()->Resolve(_target.host, _target.port, RTMP_PUSH_CONNECT_TIMEOUT);
+
+	if(addresses.empty())
+	{
+		logtw("Could not resolve %s", _target.host.CStr());
+		return false;
+	}
+
+	auto error = _socket->Connect(addresses, RTMP_PUSH_CONNECT_TIMEOUT);
+
+	if(error != nullptr)
+	{
+		logtw("Could not connect to %s:%u: %s", _target.host.CStr(), _target.port, error->ToString().CStr());
+		return false;
+	}
+
+	timeval timeout {};
+	timeout.tv_sec = RTMP_PUSH_CONNECT_TIMEOUT / 1000;
+	timeout.tv_usec = (RTMP_PUSH_CONNECT_TIMEOUT % 1000) * 1000;
+
+	// The connected socket is a new one (see ov::Socket::Connect())
+	_socket->SetSockOpt(SO_SNDTIMEO, timeout);
+	_socket->SetSockOpt(SO_RCVTIMEO, timeout);
+
+	_export_chunk = std::make_unique<RtmpExportChunk>(false, _target.chunk_size);
+	_import_chunk = std::make_unique<RtmpImportChunk>(RTMP_DEFAULT_CHUNK_SIZE);
+
+	return true;
+}
+
+//====================================================================================================
+// Handshake
+// - c0 + c1 Send
+// - s0 + s1 + s2 Receive
+// - c2 Send
+// - The simple handshake (without the digest) is used like the most of the encoders
+//====================================================================================================
+bool RtmpPushSession::Handshake()
+{
+	uint8_t c0_c1[sizeof(uint8_t) + RTMP_HANDSHAKE_PACKET_SIZE] = { 0, };
+
+	c0_c1[0] = RTMP_HANDSHAKE_VERSION;
+	RtmpMuxUtil::WriteInt32(c0_c1 + 1, static_cast<int>(time(nullptr)));
+
+	for(int index = 9; index < static_cast<int>(sizeof(c0_c1)); index++)
+	{
+		c0_c1[index] = static_cast<uint8_t>(ov::Random::GenerateUInt32(0, 0xFF));
+	}
+
+	if(SendData(c0_c1, sizeof(c0_c1)) == false)
+	{
+		logtw("Could not send the handshake to %s", _target.tc_url.CStr());
+		return false;
+	}
+
+	const size_t s0_s1_s2_size = sizeof(uint8_t) + RTMP_HANDSHAKE_PACKET_SIZE * 2;
+
+	while(_receive_buffer.GetLength() < s0_s1_s2_size)
+	{
+		if(ReceiveData(true) == false)
+		{
+			logtw("Could not receive the handshake from %s", _target.tc_url.CStr());
+			return false;
+		}
+	}
+
+	auto s0 = _receive_buffer.GetData();
+
+	if(s0[0] != RTMP_HANDSHAKE_VERSION)
+	{
+		logtw("Handshake Version Fail - Version(%d:%d)", s0[0], RTMP_HANDSHAKE_VERSION);
+		return false;
+	}
+
+	// c2 is the echo of s1
+	if(SendData(s0 + sizeof(uint8_t), RTMP_HANDSHAKE_PACKET_SIZE) == false)
+	{
+		logtw("Could not send the handshake to %s", _target.tc_url.CStr());
+		return false;
+	}
+
+	_receive_buffer.Consume(s0_s1_s2_size);
+
+	return true;
+}
+
+//====================================================================================================
+// Publish
+// - SetChunkSize -> connect -> releaseStream/FCPublish/createStream -> publish
+//====================================================================================================
+bool RtmpPushSession::Publish()
+{
+	if(SendSetChunkSize() == false)
+	{
+		return false;
+	}
+
+	// connect
+	{
+		AmfDocument document;
+		auto object = new AmfObject;
+
+		document.AddProperty(RTMP_CMD_NAME_CONNECT);
+		document.AddProperty(RTMP_PUSH_TRID_CONNECT);
+
+		object->AddProperty("app", _target.app.CStr());
+		object->AddProperty("type", "nonprivate");
+		object->AddProperty("flashVer", "FMLE/3.0 (compatible; FMSc/1.0)");
+		object->AddProperty("tcUrl", _target.tc_url.CStr());
+		document.AddProperty(object);
+
+		if((SendAmfCommand(0, document) == false) || (WaitForResult(RTMP_PUSH_TRID_CONNECT) == false))
+		{
+			logtw("Could not connect to %s", _target.tc_url.CStr());
+			return false;
+		}
+	}
+
+	// releaseStream, FCPublish (the results are not needed)
+	for(auto command : { std::make_pair(RTMP_CMD_NAME_RELEASESTREAM, RTMP_PUSH_TRID_RELEASESTREAM),
+	                     std::make_pair(RTMP_CMD_NAME_FCPUBLISH, RTMP_PUSH_TRID_FCPUBLISH) })
+	{
+		AmfDocument document;
+
+		document.AddProperty(command.first);
+		document.AddProperty(command.second);
+		document.AddProperty(AmfDataType::Null);
+		document.AddProperty(_target.stream_key.CStr());
+
+		if(SendAmfCommand(0, document) == false)
+		{
+			return false;
+		}
+	}
+
+	// createStream
+	{
+		AmfDocument document;
+		double stream_id = 0.0;
+
+		document.AddProperty(RTMP_CMD_NAME_CREATESTREAM);
+		document.AddProperty(RTMP_PUSH_TRID_CREATESTREAM);
+		document.AddProperty(AmfDataType::Null);
+
+		if((SendAmfCommand(0, document) == false) || (WaitForResult(RTMP_PUSH_TRID_CREATESTREAM, &stream_id) == false))
+		{
+			logtw("Could not create a stream on %s", _target.tc_url.CStr());
+			return false;
+		}
+
+		_rtmp_stream_id = static_cast<uint32_t>(stream_id);
+	}
+
+	// publish
+	{
+		AmfDocument document;
+
+		document.AddProperty(RTMP_CMD_NAME_PUBLISH);
+		document.AddProperty(RTMP_PUSH_TRID_PUBLISH);
+		document.AddProperty(AmfDataType::Null);
+		document.AddProperty(_target.stream_key.CStr());
+		document.AddProperty("live");
+
+		if((SendAmfCommand(_rtmp_stream_id, document) == false) || (WaitForPublishStatus() == false))
+		{
+			return false;
+		}
+	}
+
+	// Do not block the thread while sending the media (the messages from the target are polled)
+	return _socket->MakeNonBlocking();
+}
+
+//====================================================================================================
+// Disconnect
+//====================================================================================================
+void RtmpPushSession::Disconnect()
+{
+	if(_socket != nullptr)
+	{
+		_socket->Close();
+		_socket.reset();
+	}
+
+	_export_chunk.reset();
+	_import_chunk.reset();
+	_receive_buffer.Clear();
+	_commands.clear();
+	_rtmp_stream_id = 0;
+}
+
+//====================================================================================================
+// SendAll
+// - Sends all queued chunks with as few syscalls as possible
+//====================================================================================================
+bool RtmpPushSession::SendAll()
+{
+	std::vector<std::shared_ptr<const ov::Data>> data_list;
+	size_t data_size = 0;
+
+	{
+		std::unique_lock<std::mutex> lock(_queue_mutex);
+
+		_queue_condition.wait_for(lock, std::chrono::milliseconds(RTMP_PUSH_IDLE_INTERVAL), [this]() -> bool {
+			return _stop_thread_flag || (_queue.empty() == false);
+		});
+
+		data_list.assign(_queue.begin(), _queue.end());
+		data_size = _queue_bytes;
+
+		_queue.clear();
+		_queue_bytes = 0;
+	}
+
+	if(data_list.empty())
+	{
+		return true;
+	}
+
+	bool is_retry = false;
+	ssize_t sent = _socket->SendVector(data_list, is_retry);
+
+	if(sent != static_cast<ssize_t>(data_size))
+	{
+		logtw("Could not send the chunks to %s (sent: %zd/%zu)", _target.tc_url.CStr(), sent, data_size);
+		return false;
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// SendData
+//====================================================================================================
+bool RtmpPushSession::SendData(const uint8_t *data, size_t data_size)
+{
+	return (_socket->Send(data, data_size) == static_cast<ssize_t>(data_size));
+}
+
+//====================================================================================================
+// SendMessage
+// - Commands and control messages of the session (the media are serialized by the stream)
+//====================================================================================================
+bool RtmpPushSession::SendMessage(uint32_t chunk_stream_id, uint8_t type_id, uint32_t stream_id, std::shared_ptr<std::vector<uint8_t>> &body)
+{
+	auto message_header = std::make_shared<RtmpMuxMessageHeader>(chunk_stream_id, 0, type_id, stream_id, body->size());
+	auto export_data = _export_chunk->ExportStreamData(message_header, body);
+
+	if(export_data == nullptr)
+	{
+		return false;
+	}
+
+	return SendData(export_data->data(), export_data->size());
+}
+
+//====================================================================================================
+// SendAmfCommand
+//====================================================================================================
+bool RtmpPushSession::SendAmfCommand(uint32_t stream_id, AmfDocument &document)
+{
+	auto body = std::make_shared<std::vector<uint8_t>>(2048);
+	auto body_size = document.Encode(body->data());
+
+	if(body_size <= 0)
+	{
+		return false;
+	}
+
+	body->resize(static_cast<size_t>(body_size));
+
+	return SendMessage(RTMP_CHUNK_STREAM_ID_CONTROL, RTMP_MSGID_AMF0_COMMAND_MESSAGE, stream_id, body);
+}
+
+//====================================================================================================
+// SendSetChunkSize
+//====================================================================================================
+bool RtmpPushSession::SendSetChunkSize()
+{
+	auto body = std::make_shared<std::vector<uint8_t>>(sizeof(int));
+
+	RtmpMuxUtil::WriteInt32(body->data(), _target.chunk_size);
+
+	return SendMessage(RTMP_CHUNK_STREAM_ID_URGENT, RTMP_MSGID_SET_CHUNK_SIZE, 0, body);
+}
+
+//====================================================================================================
+// ReceiveData
+// - wait: false if the socket is non-blocking (nothing to read is not an error)
+//====================================================================================================
+bool RtmpPushSession::ReceiveData(bool wait)
+{
+	auto error = _socket->Recv(_recv_data);
+
+	if(error != nullptr)
+	{
+		logtw("%s is disconnected: %s", _target.tc_url.CStr(), error->ToString().CStr());
+		return false;
+	}
+
+	if(_recv_data->GetLength() == 0)
+	{
+		if(wait)
+		{
+			logtw("Timed out while waiting for the response of %s", _target.tc_url.CStr());
+			return false;
+		}
+
+		return true;
+	}
+
+	_receive_buffer.Append(_recv_data->GetDataAs<uint8_t>(), _recv_data->GetLength());
+
+	return true;
+}
+
+//====================================================================================================
+// ProcessMessages
+// - Handles the control messages, the command messages are kept until the publish is completed
+//====================================================================================================
+bool RtmpPushSession::ProcessMessages()
+{
+	while(_receive_buffer.IsEmpty() == false)
+	{
+		bool message_complete = false;
+		int import_size = _import_chunk->ImportStreamData(_receive_buffer.GetData(), static_cast<int>(_receive_buffer.GetLength()), message_complete);
+
+		if(import_size == 0)
+		{
+			break;
+		}
+		else if(import_size < 0)
+		{
+			logtw("Could not parse the chunks from %s", _target.tc_url.CStr());
+			return false;
+		}
+
+		_receive_buffer.Consume(static_cast<size_t>(import_size));
+
+		while(message_complete)
+		{
+			auto message = _import_chunk->GetMessage();
+
+			if((message == nullptr) || (message->body == nullptr))
+			{
+				break;
+			}
+
+			switch(message->message_header->type_id)
+			{
+				case RTMP_MSGID_SET_CHUNK_SIZE:
+				{
+					auto chunk_size = static_cast<int>(RtmpMuxUtil::ReadInt32(message->body->data()));
+
+					if(chunk_size <= 0)
+					{
+						logtw("ChunkSize Fail - Size(%d)", chunk_size);
+						return false;
+					}
+
+					_import_chunk->SetChunkSize(chunk_size);
+					break;
+				}
+
+				case RTMP_MSGID_USER_CONTROL_MESSAGE:
+					// Ping request: event type (2B) + timestamp (4B)
+					if((message->body->size() >= 6) && (RtmpMuxUtil::ReadInt16(message->body->data()) == RTMP_UCMID_PINGREQUEST))
+					{
+						auto body = std::make_shared<std::vector<uint8_t>>(message->body->begin(), message->body->begin() + 6);
+
+						RtmpMuxUtil::WriteInt16(body->data(), RTMP_UCMID_PINGRESPONSE);
+
+						if(SendMessage(RTMP_CHUNK_STREAM_ID_URGENT, RTMP_MSGID_USER_CONTROL_MESSAGE, 0, body) == false)
+						{
+							return false;
+						}
+					}
+					break;
+
+				case RTMP_MSGID_AMF0_COMMAND_MESSAGE:
+					if(_publishing == false)
+					{
+						_commands.push_back(message);
+					}
+					break;
+
+				default:
+					// Acknowledgement, WindowAcknowledgementSize, SetPeerBandwidth, ...
+					break;
+			}
+		}
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// ReceiveCommand
+//====================================================================================================
+bool RtmpPushSession::ReceiveCommand(std::shared_ptr<ImportMessage> &message)
+{
+	while(_commands.empty())
+	{
+		if((_stop_thread_flag) || (ReceiveData(true) == false) || (ProcessMessages() == false))
+		{
+			return false;
+		}
+	}
+
+	message = _commands.front();
+	_commands.pop_front();
+
+	return true;
+}
+
+//====================================================================================================
+// WaitForResult
+// - Waits for _result/_error of the transaction, the other commands (onBWDone, ...) are ignored
+//====================================================================================================
+bool RtmpPushSession::WaitForResult(double transaction_id, double *result_number)
+{
+	std::shared_ptr<ImportMessage> message;
+
+	while(ReceiveCommand(message))
+	{
+		AmfDocument document;
+
+		if((document.Decode(message->body->data(), message->message_header->body_size) == 0) ||
+		   (document.GetProperty(0) == nullptr) || (document.GetProperty(0)->GetType() != AmfDataType::String) ||
+		   (document.GetProperty(1) == nullptr) || (document.GetProperty(1)->GetType() != AmfDataType::Number))
+		{
+			continue;
+		}
+
+		ov::String message_name = document.GetProperty(0)->GetString();
+
+		if(document.GetProperty(1)->GetNumber() != transaction_id)
+		{
+			continue;
+		}
+
+		if(message_name == RTMP_ACK_NAME_ERROR)
+		{
+			logtw("%s returns an error (transaction: %.1f)", _target.tc_url.CStr(), transaction_id);
+			return false;
+		}
+
+		if(message_name != RTMP_ACK_NAME_RESULT)
+		{
+			continue;
+		}
+
+		if(result_number != nullptr)
+		{
+			auto property = document.GetProperty(3);
+
+			if((property == nullptr) || (property->GetType() != AmfDataType::Number))
+			{
+				return false;
+			}
+
+			*result_number = property->GetNumber();
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+//====================================================================================================
+// WaitForPublishStatus
+// - onStatus(NetStream.Publish.Start)
+//====================================================================================================
+bool RtmpPushSession::WaitForPublishStatus()
+{
+	std::shared_ptr<ImportMessage> message;
+
+	while(ReceiveCommand(message))
+	{
+		AmfDocument document;
+
+		if((document.Decode(message->body->data(), message->message_header->body_size) == 0) ||
+		   (document.GetProperty(0) == nullptr) || (document.GetProperty(0)->GetType() != AmfDataType::String))
+		{
+			continue;
+		}
+
+		ov::String message_name = document.GetProperty(0)->GetString();
+
+		if(message_name != RTMP_CMD_NAME_ONSTATUS)
+		{
+			continue;
+		}
+
+		// onStatus, transaction id, null, information
+		ov::String code;
+		auto property = document.GetProperty(3);
+
+		if((property != nullptr) && (property->GetType() == AmfDataType::Object))
+		{
+			auto object = property->GetObject();
+			auto index = object->FindName("code");
+
+			if((index >= 0) && (object->GetType(index) == AmfDataType::String))
+			{
+				code = object->GetString(index);
+			}
+		}
+
+		if(code != "NetStream.Publish.Start")
+		{
+			logtw("%s rejects the publish: %s", _target.tc_url.CStr(), code.CStr());
+			return false;
+		}
+
+		return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,160 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/publisher/session.h>
+#include <base/ovsocket/ovsocket.h>
+#include <rtmp/chunk/amf_document.h>
+#include <rtmp/chunk/rtmp_export_chunk.h>
+#include <rtmp/chunk/rtmp_import_chunk.h>
+#include <rtmp/chunk/rtmp_receive_buffer.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+
+// Timeout of the connection, handshake and the commands (ms)
+#define RTMP_PUSH_CONNECT_TIMEOUT           (5000)
+// Interval of the reconnection after the target is disconnected (ms)
+#define RTMP_PUSH_RECONNECT_INTERVAL        (3000)
+// Interval of checking the messages from the target while there is nothing to send (ms)
+#define RTMP_PUSH_IDLE_INTERVAL             (100)
+#define RTMP_PUSH_RECV_BUFFER_SIZE          (64 * 1024)
+
+// Transaction ids of the commands sent by the publisher
+#define RTMP_PUSH_TRID_CONNECT              (1.0)
+#define RTMP_PUSH_TRID_RELEASESTREAM        (2.0)
+#define RTMP_PUSH_TRID_FCPUBLISH            (3.0)
+#define RTMP_PUSH_TRID_CREATESTREAM         (4.0)
+#define RTMP_PUSH_TRID_PUBLISH              (5.0)
+
+// Chunk size and message stream id, the sessions of the same key share the serialized chunks
+typedef std::pair<int, uint32_t> RtmpPushExportKey;
+
+enum class RtmpPushPacketType : uint32_t
+{
+	// Sequence headers and the metadata, queued before the media after (re)connected or dropped
+	SequenceHeader,
+	KeyFrame,
+	Frame,
+};
+
+struct RtmpPushTarget
+{
+	ov::String url;
+	ov::String host;
+	uint16_t port = RTMP_DEFULT_PORT;
+	ov::String app;
+	ov::String stream_key;
+	ov::String tc_url;
+	int chunk_size = RTMP_DEFAULT_CHUNK_SIZE;
+
+	// rtmp://<host>[:<port>]/<app>/<stream key>
+	static bool Parse(const ov::String &url, int chunk_size, RtmpPushTarget &target);
+};
+
+//====================================================================================================
+// RtmpPushSession
+// - Connects and publishes to a target on its own thread
+// - The stream only queues the chunks (it is never blocked by the target), and the queue is dropped
+//   to the next key frame if the target is too slow to send the queued chunks
+//====================================================================================================
+class RtmpPushSession : public Session
+{
+public:
+	static std::shared_ptr<RtmpPushSession> Create(const std::shared_ptr<Application> &application,
+	                                               const std::shared_ptr<Stream> &stream,
+	                                               const RtmpPushTarget &target,
+	                                               size_t queue_size);
+
+	RtmpPushSession(const std::shared_ptr<Application> &application,
+	                const std::shared_ptr<Stream> &stream,
+	                const RtmpPushTarget &target,
+	                size_t queue_size);
+	~RtmpPushSession() override;
+
+	bool Start() override;
+	bool Stop() override;
+
+	const RtmpPushTarget &GetTarget() const
+	{
+		return _target;
+	}
+
+	bool IsPublishing() const
+	{
+		return _publishing;
+	}
+
+	RtmpPushExportKey GetExportKey() const
+	{
+		return RtmpPushExportKey(_target.chunk_size, _rtmp_stream_id);
+	}
+
+	bool IsSequenceHeaderRequired();
+
+	uint64_t GetDroppedCount() const
+	{
+		return _dropped_count;
+	}
+
+	// Queues the chunks (packet_type: RtmpPushPacketType), returns false if the chunks are dropped
+	bool SendOutgoingData(uint32_t packet_type, const std::shared_ptr<const ov::Data> &packet) override;
+	void OnPacketReceived(std::shared_ptr<SessionInfo> session_info, std::shared_ptr<const ov::Data> data) override;
+
+private:
+	void WorkerThread();
+
+	bool Connect();
+	bool Handshake();
+	bool Publish();
+	void Disconnect();
+
+	bool SendAll();
+	bool SendData(const uint8_t *data, size_t data_size);
+	bool SendMessage(uint32_t chunk_stream_id, uint8_t type_id, uint32_t stream_id, std::shared_ptr<std::vector<uint8_t>> &body);
+	bool SendAmfCommand(uint32_t stream_id, AmfDocument &document);
+	bool SendSetChunkSize();
+
+	bool ReceiveData(bool wait);
+	bool ProcessMessages();
+	bool ReceiveCommand(std::shared_ptr<ImportMessage> &message);
+	bool WaitForResult(double transaction_id, double *result_number = nullptr);
+	bool WaitForPublishStatus();
+
+	// _queue_mutex must be locked
+	void ClearQueue();
+	// Waits for the time unless the session is stopped (returns false if stopped)
+	bool Sleep(int milliseconds);
+
+	RtmpPushTarget _target;
+	size_t _queue_size_limit;
+
+	std::shared_ptr<ov::ClientSocket> _socket;
+	std::unique_ptr<RtmpExportChunk> _export_chunk;
+	std::unique_ptr<RtmpImportChunk> _import_chunk;
+	RtmpReceiveBuffer _receive_buffer;
+	std::shared_ptr<ov::Data> _recv_data;
+
+	// The command messages received while waiting for a response
+	std::deque<std::shared_ptr<ImportMessage>> _commands;
+
+	std::atomic<bool> _publishing { false };
+	std::atomic<uint32_t> _rtmp_stream_id { 0 };
+
+	std::mutex _queue_mutex;
+	std::condition_variable _queue_condition;
+	std::deque<std::shared_ptr<const ov::Data>> _queue;
+	size_t _queue_bytes = 0;
+	bool _sequence_header_required = true;
+	bool _wait_key_frame = true;
+	std::atomic<uint64_t> _dropped_count { 0 };
+
+	std::atomic<bool> _stop_thread_flag { true };
+	std::thread _worker_thread;
+};
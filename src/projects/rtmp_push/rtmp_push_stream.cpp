@@ -0,0 +1,885 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtmp_push_stream.h"
+#include "rtmp_push_private.h"
+
+#include <base/publisher/application.h>
+#include <media_router/media_route_stream.h>
+
+using namespace common;
+
+namespace
+{
+	// Keeps the serialized chunks, the ov::Data references them without copying
+	struct RtmpPushChunkData
+	{
+		explicit RtmpPushChunkData(const std::shared_ptr<std::vector<uint8_t>> &chunks_)
+			: chunks(chunks_),
+			  data(chunks_->data(), chunks_->size(), true)
+		{
+		}
+
+		std::shared_ptr<std::vector<uint8_t>> chunks;
+		ov::Data data;
+	};
+
+	const int32_t aac_sample_rates[] = { 96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350 };
+
+	// AAC, 44kHz, 16 bits, stereo (always for AAC)
+	const uint8_t aac_control = 0xAF;
+
+	void WriteNalUnit(std::vector<uint8_t> &body, const uint8_t *nal, size_t nal_size)
+	{
+		uint8_t length[RTMP_VIDEO_FRAME_SIZE_INFO_SIZE];
+
+		RtmpMuxUtil::WriteInt32(length, static_cast<int>(nal_size));
+
+		body.insert(body.end(), length, length + sizeof(length));
+		body.insert(body.end(), nal, nal + nal_size);
+	}
+}
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<RtmpPushStream> RtmpPushStream::Create(const std::shared_ptr<Application> application,
+                                                       const StreamInfo &info,
+                                                       uint32_t worker_count,
+                                                       const std::vector<RtmpPushTarget> &targets,
+                                                       size_t queue_size)
+{
+	auto stream = std::make_shared<RtmpPushStream>(application, info, targets, queue_size);
+
+	if(stream->Start(worker_count) == false)
+	{
+		return nullptr;
+	}
+
+	return stream;
+}
+
+//====================================================================================================
+// RtmpPushStream
+//====================================================================================================
+RtmpPushStream::RtmpPushStream(const std::shared_ptr<Application> application,
+                               const StreamInfo &info,
+                               const std::vector<RtmpPushTarget> &targets,
+                               size_t queue_size)
+	: Stream(application, info),
+	  _targets(targets),
+	  _queue_size(queue_size)
+{
+}
+
+//====================================================================================================
+// ~RtmpPushStream
+//====================================================================================================
+RtmpPushStream::~RtmpPushStream()
+{
+	logtd("RtmpPushStream(%u) has been terminated finally", GetId());
+	Stop();
+}
+
+//====================================================================================================
+// Start
+// - Only the first H264/AAC tracks are pushed
+//====================================================================================================
+bool RtmpPushStream::Start(uint32_t worker_count)
+{
+	for(auto &track_item : _tracks)
+	{
+		auto &track = track_item.second;
+
+		if((track->GetMediaType() == MediaType::Video) && (track->GetCodecId() == MediaCodecId::H264) && (_video_track == nullptr))
+		{
+			_video_track = track;
+		}
+		else if((track->GetMediaType() == MediaType::Audio) && (track->GetCodecId() == MediaCodecId::Aac) && (_audio_track == nullptr))
+		{
+			_audio_track = track;
+		}
+		else
+		{
+			logtw("[%s/%s] Track %d is not pushed (only the first H264/AAC tracks are supported)",
+			      GetApplication()->GetName().CStr(), GetName().CStr(), track->GetId());
+		}
+	}
+
+	// The sessions send the chunks by themselves, the stream worker is needed only to register them
+	if(Stream::Start(1) == false)
+	{
+		return false;
+	}
+
+	if((_video_track == nullptr) && (_audio_track == nullptr))
+	{
+		logtw("[%s/%s] There is no H264/AAC track to push", GetApplication()->GetName().CStr(), GetName().CStr());
+		return true;
+	}
+
+	MakeMetaData();
+
+	std::lock_guard<std::mutex> lock(_session_mutex);
+
+	for(const auto &target : _targets)
+	{
+		auto session = RtmpPushSession::Create(GetApplication(), GetSharedPtrAs<Stream>(), target, _queue_size);
+
+		if(session == nullptr)
+		{
+			continue;
+		}
+
+		AddSession(session);
+		_push_sessions.push_back(session);
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// Stop
+//====================================================================================================
+bool RtmpPushStream::Stop()
+{
+	std::vector<std::shared_ptr<RtmpPushSession>> sessions;
+	std::vector<std::shared_ptr<RtmpPlaySession>> play_sessions;
+
+	{
+		std::lock_guard<std::mutex> lock(_session_mutex);
+
+		sessions = std::move(_push_sessions);
+		_push_sessions.clear();
+
+		play_sessions = std::move(_play_sessions);
+		_play_sessions.clear();
+	}
+
+	std::vector<session_id_t> ids;
+
+	for(auto &session : sessions)
+	{
+		ids.push_back(session->GetId());
+	}
+
+	for(auto &session : play_sessions)
+	{
+		ids.push_back(session->GetId());
+	}
+
+	// The sessions are stopped by SessionReclaimer (the players are disconnected then)
+	RemoveSessions(ids);
+
+	return Stream::Stop();
+}
+
+//====================================================================================================
+// GetPublishingCount
+//====================================================================================================
+size_t RtmpPushStream::GetPublishingCount()
+{
+	std::lock_guard<std::mutex> lock(_session_mutex);
+
+	return std::count_if(_push_sessions.begin(), _push_sessions.end(), [](const std::shared_ptr<RtmpPushSession> &session) -> bool {
+		return session->IsPublishing();
+	});
+}
+
+//====================================================================================================
+// AddPlayer
+//====================================================================================================
+bool RtmpPushStream::AddPlayer(const std::shared_ptr<RtmpPlayConnection> &connection)
+{
+	if((_video_track == nullptr) && (_audio_track == nullptr))
+	{
+		logtw("[%s/%s] There is no track to play (H264/AAC)", GetApplication()->GetName().CStr(), GetName().CStr());
+		return false;
+	}
+
+	auto session = RtmpPlaySession::Create(GetApplication(), GetSharedPtrAs<Stream>(), connection, _queue_size);
+
+	if(session == nullptr)
+	{
+		return false;
+	}
+
+	AddSession(session);
+
+	{
+		std::lock_guard<std::mutex> lock(_session_mutex);
+
+		_play_sessions.push_back(session);
+	}
+
+	logti("[%s/%s] RTMP player %s has been added (%zu players)",
+	      GetApplication()->GetName().CStr(), GetName().CStr(), connection->GetSocket()->ToString().CStr(), GetPlayerCount());
+
+	return true;
+}
+
+//====================================================================================================
+// RemovePlayer
+//====================================================================================================
+void RtmpPushStream::RemovePlayer(const std::shared_ptr<RtmpPlayConnection> &connection)
+{
+	std::shared_ptr<RtmpPlaySession> session;
+
+	{
+		std::lock_guard<std::mutex> lock(_session_mutex);
+
+		auto item = std::find_if(_play_sessions.begin(), _play_sessions.end(), [&connection](const std::shared_ptr<RtmpPlaySession> &play_session) -> bool {
+			return play_session->GetConnection() == connection;
+		});
+
+		if(item == _play_sessions.end())
+		{
+			return;
+		}
+
+		session = *item;
+		_play_sessions.erase(item);
+	}
+
+	logti("[%s/%s] RTMP player %s has been removed (%" PRIu64 " dropped)",
+	      GetApplication()->GetName().CStr(), GetName().CStr(), connection->GetSocket()->ToString().CStr(), session->GetDroppedCount());
+
+	RemoveSession(session->GetId());
+}
+
+//====================================================================================================
+// GetPlayerCount
+//====================================================================================================
+size_t RtmpPushStream::GetPlayerCount()
+{
+	std::lock_guard<std::mutex> lock(_session_mutex);
+
+	return _play_sessions.size();
+}
+
+//====================================================================================================
+// MakeMetaData
+// - @setDataFrame(onMetaData)
+//====================================================================================================
+void RtmpPushStream::MakeMetaData()
+{
+	AmfDocument document;
+	auto array = new AmfArray;
+
+	document.AddProperty(RTMP_CMD_DATA_SETDATAFRAME);
+	document.AddProperty(RTMP_CMD_DATA_ONMETADATA);
+
+	if(_video_track != nullptr)
+	{
+		array->AddProperty("width", static_cast<double>(_video_track->GetWidth()));
+		array->AddProperty("height", static_cast<double>(_video_track->GetHeight()));
+		array->AddProperty("framerate", _video_track->GetFrameRate());
+		array->AddProperty("videocodecid", 7.0);
+		array->AddProperty("videodatarate", _video_track->GetBitrate() / 1000.0);
+	}
+
+	if(_audio_track != nullptr)
+	{
+		array->AddProperty("audiosamplerate", static_cast<double>(_audio_track->GetSampleRate()));
+		array->AddProperty("audiochannels", static_cast<double>(_audio_track->GetChannel().GetCounts()));
+		array->AddProperty("audiocodecid", 10.0);
+		array->AddProperty("audiodatarate", _audio_track->GetBitrate() / 1000.0);
+	}
+
+	array->AddProperty("encoder", "OvenMediaEngine");
+	document.AddProperty(array);
+
+	auto body = std::make_shared<std::vector<uint8_t>>(2048);
+	auto body_size = document.Encode(body->data());
+
+	if(body_size <= 0)
+	{
+		logtw("[%s/%s] Could not make the metadata", GetApplication()->GetName().CStr(), GetName().CStr());
+		return;
+	}
+
+	body->resize(static_cast<size_t>(body_size));
+
+	_metadata = body;
+}
+
+//====================================================================================================
+// GetTimestamp
+// - Milliseconds from the first frame
+//====================================================================================================
+uint32_t RtmpPushStream::GetTimestamp(int64_t milliseconds)
+{
+	if(_base_timestamp < 0)
+	{
+		_base_timestamp = milliseconds;
+	}
+
+	return static_cast<uint32_t>(std::max<int64_t>(milliseconds - _base_timestamp, 0));
+}
+
+//====================================================================================================
+// MakeVideoTag
+// - Annex B -> FLV video tag (AVCC)
+//====================================================================================================
+std::shared_ptr<std::vector<uint8_t>> RtmpPushStream::MakeVideoTag(const uint8_t *data, size_t data_size,
+                                                                   const FragmentationHeader *fragmentation, bool key_frame,
+                                                                   const uint8_t *&sps, size_t &sps_size,
+                                                                   const uint8_t *&pps, size_t &pps_size)
+{
+	auto end = data + data_size;
+
+	// control(1) + AVC packet type(1) + composition time(3) + NAL units (length prefixed)
+	auto body = std::make_shared<std::vector<uint8_t>>();
+	body->reserve(RTMP_VIDEO_DATA_MIN_SIZE + data_size + RTMP_VIDEO_FRAME_SIZE_INFO_SIZE * MAX_FRAG_COUNT);
+	body->push_back(key_frame ? RTMP_H264_I_FRAME_TYPE : RTMP_H264_P_FRAME_TYPE);
+	body->push_back(RTMP_FRAME_DATA_TYPE);
+	body->insert(body->end(), 3, 0);
+
+	sps = nullptr;
+	pps = nullptr;
+	sps_size = 0;
+	pps_size = 0;
+
+	auto add_nal_unit = [&](const uint8_t *nal, size_t nal_size) {
+		if(nal_size == 0)
+		{
+			return;
+		}
+
+		switch(nal[0] & 0x1F)
+		{
+			case 7:
+				sps = nal;
+				sps_size = nal_size;
+				break;
+
+			case 8:
+				pps = nal;
+				pps_size = nal_size;
+				break;
+
+			case 9:
+				// Access unit delimiter is not used in FLV
+				break;
+
+			default:
+				WriteNalUnit(*body, nal, nal_size);
+				break;
+		}
+	};
+
+	if((fragmentation != nullptr) && (fragmentation->fragmentation_vector_size > 0))
+	{
+		// The NAL units are indexed by the provider/encoder
+		for(int index = 0; index < fragmentation->fragmentation_vector_size; index++)
+		{
+			auto offset = fragmentation->fragmentation_offset[index];
+			auto length = fragmentation->fragmentation_length[index];
+
+			if((offset + length) > data_size)
+			{
+				break;
+			}
+
+			add_nal_unit(data + offset, length);
+		}
+	}
+	else
+	{
+		auto start_code = ov::FindNalStartCode(data, end);
+
+		while(start_code < end)
+		{
+			auto nal = start_code + 3;
+			auto next_start_code = ov::FindNalStartCode(nal, end);
+			auto nal_end = next_start_code;
+
+			// The leading zero of the 4 bytes start code (and the trailing zeros) are not the part of the NAL unit
+			while((nal_end > nal) && (nal_end[-1] == 0x00))
+			{
+				nal_end--;
+			}
+
+			add_nal_unit(nal, static_cast<size_t>(nal_end - nal));
+
+			start_code = next_start_code;
+		}
+	}
+
+	return body;
+}
+
+//====================================================================================================
+// SendVideoFrame
+// - The sequence header is made from SPS/PPS of the key frames
+//====================================================================================================
+void RtmpPushStream::SendVideoFrame(std::shared_ptr<MediaTrack> track,
+                                    std::unique_ptr<EncodedFrameDescriptor> frame)
+{
+	if((_video_track == nullptr) || (track->GetId() != _video_track->GetId()))
+	{
+		return;
+	}
+
+	auto encoded_frame = &(frame->encoded_frame);
+	bool key_frame = (encoded_frame->_frame_type == FrameType::VideoFrameKey);
+
+	// The timestamp of the video frames is 90kHz (see MediaRouteApplication)
+	auto timestamp = GetTimestamp(encoded_frame->_time_stamp / 90);
+
+	const uint8_t *sps = nullptr;
+	const uint8_t *pps = nullptr;
+	size_t sps_size = 0;
+	size_t pps_size = 0;
+
+	auto body = MakeVideoTag(encoded_frame->_buffer->GetDataAs<uint8_t>(), encoded_frame->_buffer->GetLength(),
+	                         &(frame->fragmentation), key_frame, sps, sps_size, pps, pps_size);
+
+	if((sps != nullptr) && (pps != nullptr) &&
+	   ((_video_sequence_header == nullptr) ||
+	    (_avc_sps.size() != sps_size) || (::memcmp(_avc_sps.data(), sps, sps_size) != 0) ||
+	    (_avc_pps.size() != pps_size) || (::memcmp(_avc_pps.data(), pps, pps_size) != 0)))
+	{
+		if(sps_size < 4)
+		{
+			logtw("[%s/%s] Invalid SPS (%zu bytes)", GetApplication()->GetName().CStr(), GetName().CStr(), sps_size);
+			return;
+		}
+
+		_avc_sps.assign(sps, sps + sps_size);
+		_avc_pps.assign(pps, pps + pps_size);
+
+		// AVCDecoderConfigurationRecord
+		auto header = std::make_shared<std::vector<uint8_t>>();
+
+		header->push_back(RTMP_H264_I_FRAME_TYPE);
+		header->push_back(RTMP_SEQUENCE_INFO_TYPE);
+		header->insert(header->end(), 3, 0);
+		// version, profile, compatibility, level
+		header->push_back(0x01);
+		header->insert(header->end(), sps + 1, sps + 4);
+		// NAL length size (4 bytes)
+		header->push_back(0xFF);
+		// SPS
+		header->push_back(0xE1);
+		header->push_back(static_cast<uint8_t>(sps_size >> 8));
+		header->push_back(static_cast<uint8_t>(sps_size & 0xFF));
+		header->insert(header->end(), sps, sps + sps_size);
+		// PPS
+		header->push_back(0x01);
+		header->push_back(static_cast<uint8_t>(pps_size >> 8));
+		header->push_back(static_cast<uint8_t>(pps_size & 0xFF));
+		header->insert(header->end(), pps, pps + pps_size);
+
+		_video_sequence_header = header;
+
+		SendMessage(RtmpPushPacketType::SequenceHeader, RTMP_PUSH_CHUNK_STREAM_ID_VIDEO, RTMP_MSGID_VIDEO_MESSAGE, timestamp, _video_sequence_header);
+	}
+
+	if(body->size() <= RTMP_VIDEO_DATA_MIN_SIZE)
+	{
+		// Only SPS/PPS
+		return;
+	}
+
+	SendMessage(key_frame ? RtmpPushPacketType::KeyFrame : RtmpPushPacketType::Frame, RTMP_PUSH_CHUNK_STREAM_ID_VIDEO, RTMP_MSGID_VIDEO_MESSAGE, timestamp, body);
+
+	_last_video_timestamp = timestamp;
+}
+
+//====================================================================================================
+// MakeAudioTag
+// - ADTS (or raw AAC) -> FLV audio tag, the config is made from the ADTS header (or the track)
+//====================================================================================================
+std::shared_ptr<std::vector<uint8_t>> RtmpPushStream::MakeAudioTag(const std::shared_ptr<MediaTrack> &track,
+                                                                   const uint8_t *data, size_t data_size,
+                                                                   uint8_t config[2])
+{
+	uint8_t object_type = 2;
+	uint8_t sample_rate_index = 0;
+	uint8_t channels = 0;
+	size_t header_size = 0;
+
+	if((data_size >= RTMP_ADTS_HEADER_SIZE) && (data[0] == 0xFF) && ((data[1] & 0xF0) == 0xF0))
+	{
+		// ADTS: profile(2) + sampling frequency index(4) + private(1) + channel configuration(3)
+		object_type = static_cast<uint8_t>(((data[2] >> 6) & 0x03) + 1);
+		sample_rate_index = static_cast<uint8_t>((data[2] >> 2) & 0x0F);
+		channels = static_cast<uint8_t>(((data[2] & 0x01) << 2) | ((data[3] >> 6) & 0x03));
+		// protection absent ? 7 : 9 (CRC)
+		header_size = (data[1] & 0x01) ? RTMP_ADTS_HEADER_SIZE : RTMP_ADTS_HEADER_SIZE + 2;
+	}
+	else
+	{
+		auto sample_rate = track->GetSampleRate();
+		auto item = std::find(std::begin(aac_sample_rates), std::end(aac_sample_rates), sample_rate);
+
+		sample_rate_index = static_cast<uint8_t>((item != std::end(aac_sample_rates)) ? (item - std::begin(aac_sample_rates)) : 4);
+		channels = static_cast<uint8_t>(track->GetChannel().GetCounts());
+	}
+
+	if(data_size <= header_size)
+	{
+		return nullptr;
+	}
+
+	// AudioSpecificConfig: object type(5) + sampling frequency index(4) + channel configuration(4) + 0(3)
+	config[0] = static_cast<uint8_t>((object_type << 3) | (sample_rate_index >> 1));
+	config[1] = static_cast<uint8_t>(((sample_rate_index & 0x01) << 7) | ((channels & 0x0F) << 3));
+
+	auto body = std::make_shared<std::vector<uint8_t>>();
+
+	body->reserve(RTMP_AAC_AUDIO_DATA_MIN_SIZE + data_size - header_size);
+	body->push_back(aac_control);
+	body->push_back(RTMP_FRAME_DATA_TYPE);
+	body->insert(body->end(), data + header_size, data + data_size);
+
+	return body;
+}
+
+//====================================================================================================
+// SendAudioFrame
+// - The sequence header is made from the config of the frames
+//====================================================================================================
+void RtmpPushStream::SendAudioFrame(std::shared_ptr<MediaTrack> track,
+                                    std::unique_ptr<EncodedFrameDescriptor> frame)
+{
+	if((_audio_track == nullptr) || (track->GetId() != _audio_track->GetId()))
+	{
+		return;
+	}
+
+	auto encoded_frame = &(frame->encoded_frame);
+	auto &timebase = track->GetTimeBase();
+
+	if(timebase.GetDen() == 0)
+	{
+		return;
+	}
+
+	auto timestamp = GetTimestamp(encoded_frame->_time_stamp * 1000 * timebase.GetNum() / timebase.GetDen());
+
+	uint8_t config[2] = { 0, 0 };
+	auto body = MakeAudioTag(track, encoded_frame->_buffer->GetDataAs<uint8_t>(), encoded_frame->_buffer->GetLength(), config);
+
+	if(body == nullptr)
+	{
+		return;
+	}
+
+	if((_audio_sequence_header == nullptr) || (::memcmp(_audio_sequence_header->data() + 2, config, sizeof(config)) != 0))
+	{
+		_audio_sequence_header = std::make_shared<std::vector<uint8_t>>(std::initializer_list<uint8_t> { aac_control, RTMP_SEQUENCE_INFO_TYPE, config[0], config[1] });
+
+		SendMessage(RtmpPushPacketType::SequenceHeader, RTMP_PUSH_CHUNK_STREAM_ID_AUDIO, RTMP_MSGID_AUDIO_MESSAGE, timestamp, _audio_sequence_header);
+	}
+
+	// Every audio frame is a key frame if there is no video
+	SendMessage((_video_track == nullptr) ? RtmpPushPacketType::KeyFrame : RtmpPushPacketType::Frame,
+	            RTMP_PUSH_CHUNK_STREAM_ID_AUDIO, RTMP_MSGID_AUDIO_MESSAGE, timestamp, body);
+
+	_last_audio_timestamp = timestamp;
+}
+
+//====================================================================================================
+// SendMessage
+// - The message is serialized once per export key, and the chunks are shared by the targets/players of the key
+//====================================================================================================
+void RtmpPushStream::SendMessage(RtmpPushPacketType packet_type,
+                                 uint32_t chunk_stream_id,
+                                 uint8_t type_id,
+                                 uint32_t timestamp,
+                                 std::shared_ptr<std::vector<uint8_t>> &body)
+{
+	std::map<RtmpPushExportKey, std::shared_ptr<const ov::Data>> chunks;
+
+	std::lock_guard<std::mutex> lock(_session_mutex);
+
+	for(auto &session : _push_sessions)
+	{
+		if(session->IsPublishing() == false)
+		{
+			continue;
+		}
+
+		if(SendSessionMessage(session, chunks, packet_type, chunk_stream_id, type_id, timestamp, body) == false)
+		{
+			return;
+		}
+	}
+
+	if(_play_sessions.empty())
+	{
+		return;
+	}
+
+	// The players which have started since the previous message get the GOP before this message
+	std::vector<std::shared_ptr<RtmpPlaySession>> new_sessions;
+
+	for(auto &session : _play_sessions)
+	{
+		if(session->IsPlaying() && session->IsGopReplayRequired())
+		{
+			session->SetGopReplayed();
+			new_sessions.push_back(session);
+		}
+	}
+
+	if(new_sessions.empty() == false)
+	{
+		ReplayGopCache(new_sessions);
+	}
+
+	for(auto &session : _play_sessions)
+	{
+		if(session->IsPlaying() == false)
+		{
+			continue;
+		}
+
+		if(SendSessionMessage(session, chunks, packet_type, chunk_stream_id, type_id, timestamp, body) == false)
+		{
+			return;
+		}
+	}
+}
+
+//====================================================================================================
+// SendSessionMessage
+//====================================================================================================
+template<typename T>
+bool RtmpPushStream::SendSessionMessage(const std::shared_ptr<T> &session,
+                                        std::map<RtmpPushExportKey, std::shared_ptr<const ov::Data>> &chunks,
+                                        RtmpPushPacketType packet_type,
+                                        uint32_t chunk_stream_id,
+                                        uint8_t type_id,
+                                        uint32_t timestamp,
+                                        std::shared_ptr<std::vector<uint8_t>> &body)
+{
+	if(session->IsSequenceHeaderRequired())
+	{
+		// The new (or dropped) targets get all sequence headers before the next key frame
+		if(packet_type != RtmpPushPacketType::KeyFrame)
+		{
+			return true;
+		}
+
+		SendSequenceHeaders(session, timestamp);
+	}
+
+	auto key = session->GetExportKey();
+	auto &data = chunks[key];
+
+	if(data == nullptr)
+	{
+		data = ExportMessage(key, chunk_stream_id, type_id, timestamp, body);
+
+		if(data == nullptr)
+		{
+			return false;
+		}
+	}
+
+	session->SendOutgoingData(static_cast<uint32_t>(packet_type), data);
+
+	return true;
+}
+
+//====================================================================================================
+// SendSequenceHeaders
+//====================================================================================================
+template<typename T>
+void RtmpPushStream::SendSequenceHeaders(const std::shared_ptr<T> &session, uint32_t timestamp)
+{
+	auto key = session->GetExportKey();
+	auto packet_type = static_cast<uint32_t>(RtmpPushPacketType::SequenceHeader);
+
+	if(_metadata != nullptr)
+	{
+		auto data = ExportMessage(key, RTMP_PUSH_CHUNK_STREAM_ID_META, RTMP_MSGID_AMF0_DATA_MESSAGE, timestamp, _metadata);
+
+		if(data != nullptr)
+		{
+			session->SendOutgoingData(packet_type, data);
+		}
+	}
+
+	if(_video_sequence_header != nullptr)
+	{
+		auto data = ExportMessage(key, RTMP_PUSH_CHUNK_STREAM_ID_VIDEO, RTMP_MSGID_VIDEO_MESSAGE, timestamp, _video_sequence_header);
+
+		if(data != nullptr)
+		{
+			session->SendOutgoingData(packet_type, data);
+		}
+	}
+
+	if(_audio_sequence_header != nullptr)
+	{
+		auto data = ExportMessage(key, RTMP_PUSH_CHUNK_STREAM_ID_AUDIO, RTMP_MSGID_AUDIO_MESSAGE, timestamp, _audio_sequence_header);
+
+		if(data != nullptr)
+		{
+			session->SendOutgoingData(packet_type, data);
+		}
+	}
+}
+
+//====================================================================================================
+// ReplayGopCache
+// - The GOP of the router starts from a video key frame, it is empty if the stream doesn't have the video
+//   (every audio frame is a key frame then)
+//====================================================================================================
+void RtmpPushStream::ReplayGopCache(const std::vector<std::shared_ptr<RtmpPlaySession>> &sessions)
+{
+	if((_video_track == nullptr) || (_video_sequence_header == nullptr) || (_last_video_timestamp < 0))
+	{
+		return;
+	}
+
+	auto route_stream = GetApplication()->GetRouteStream(GetId());
+
+	if(route_stream == nullptr)
+	{
+		return;
+	}
+
+	auto gop_cache = route_stream->GetGopCache();
+
+	if(gop_cache.empty())
+	{
+		return;
+	}
+
+	// Messages of the cached frames which have been sent by the stream
+	struct ReplayMessage
+	{
+		RtmpPushPacketType packet_type;
+		uint32_t chunk_stream_id;
+		uint8_t type_id;
+		uint32_t timestamp;
+		std::shared_ptr<std::vector<uint8_t>> body;
+	};
+
+	std::vector<ReplayMessage> messages;
+
+	for(const auto &gop_packet : gop_cache)
+	{
+		auto data = gop_packet->data->GetDataAs<uint8_t>();
+		auto data_size = gop_packet->data->GetLength();
+
+		if((gop_packet->media_type == MediaType::Video) && (static_cast<uint32_t>(gop_packet->track_id) == _video_track->GetId()))
+		{
+			// Same as the timestamp of EncodedFrameDescriptor (see MediaRouteApplication)
+			auto timestamp = GetTimestamp(static_cast<int64_t>(static_cast<double>(gop_packet->pts) / 1000000.0 * 90000.0) / 90);
+			bool key_frame = (gop_packet->flags == MediaPacketFlag::Key);
+
+			if(messages.empty() && (key_frame == false))
+			{
+				return;
+			}
+
+			if(static_cast<int64_t>(timestamp) > _last_video_timestamp)
+			{
+				// The stream has not received the rest of the GOP yet
+				break;
+			}
+
+			const uint8_t *sps = nullptr;
+			const uint8_t *pps = nullptr;
+			size_t sps_size = 0;
+			size_t pps_size = 0;
+
+			auto body = MakeVideoTag(data, data_size, &(gop_packet->frag_header), key_frame, sps, sps_size, pps, pps_size);
+
+			if(body->size() > RTMP_VIDEO_DATA_MIN_SIZE)
+			{
+				messages.push_back({ key_frame ? RtmpPushPacketType::KeyFrame : RtmpPushPacketType::Frame,
+				                     RTMP_PUSH_CHUNK_STREAM_ID_VIDEO, RTMP_MSGID_VIDEO_MESSAGE, timestamp, body });
+			}
+		}
+		else if((gop_packet->media_type == MediaType::Audio) && (_audio_track != nullptr) &&
+		        (static_cast<uint32_t>(gop_packet->track_id) == _audio_track->GetId()) && (messages.empty() == false))
+		{
+			auto &timebase = _audio_track->GetTimeBase();
+
+			if(timebase.GetDen() == 0)
+			{
+				continue;
+			}
+
+			auto timestamp = GetTimestamp(gop_packet->pts * 1000 * timebase.GetNum() / timebase.GetDen());
+
+			if(static_cast<int64_t>(timestamp) > _last_audio_timestamp)
+			{
+				continue;
+			}
+
+			uint8_t config[2] = { 0, 0 };
+			auto body = MakeAudioTag(_audio_track, data, data_size, config);
+
+			if(body != nullptr)
+			{
+				messages.push_back({ RtmpPushPacketType::Frame, RTMP_PUSH_CHUNK_STREAM_ID_AUDIO, RTMP_MSGID_AUDIO_MESSAGE, timestamp, body });
+			}
+		}
+	}
+
+	if(messages.empty())
+	{
+		return;
+	}
+
+	logtd("[%s/%s] Replaying the GOP (%zu messages) to %zu players",
+	      GetApplication()->GetName().CStr(), GetName().CStr(), messages.size(), sessions.size());
+
+	// All players have the same export key, so the messages are serialized once for them
+	std::map<RtmpPushExportKey, std::shared_ptr<const ov::Data>> chunks;
+
+	for(auto &message : messages)
+	{
+		chunks.clear();
+
+		for(auto &session : sessions)
+		{
+			if(SendSessionMessage(session, chunks, message.packet_type, message.chunk_stream_id, message.type_id, message.timestamp, message.body) == false)
+			{
+				return;
+			}
+		}
+	}
+}
+
+//====================================================================================================
+// ExportMessage
+//====================================================================================================
+std::shared_ptr<const ov::Data> RtmpPushStream::ExportMessage(const RtmpPushExportKey &key,
+                                                              uint32_t chunk_stream_id,
+                                                              uint8_t type_id,
+                                                              uint32_t timestamp,
+                                                              std::shared_ptr<std::vector<uint8_t>> &body)
+{
+	auto &export_chunk = _export_chunks[key];
+
+	if(export_chunk == nullptr)
+	{
+		export_chunk = std::make_unique<RtmpExportChunk>(false, key.first);
+	}
+
+	auto message_header = std::make_shared<RtmpMuxMessageHeader>(chunk_stream_id, timestamp, type_id, key.second, body->size());
+	auto export_data = export_chunk->ExportStreamData(message_header, body);
+
+	if(export_data == nullptr)
+	{
+		logtw("[%s/%s] Could not make the chunks (type: %d, size: %zu)", GetApplication()->GetName().CStr(), GetName().CStr(), type_id, body->size());
+		return nullptr;
+	}
+
+	auto chunk_data = std::make_shared<RtmpPushChunkData>(export_data);
+
+	return std::shared_ptr<const ov::Data>(chunk_data, &(chunk_data->data));
+}
@@ -0,0 +1,126 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/common_types.h>
+#include <base/publisher/stream.h>
+#include "rtmp_push_session.h"
+#include "rtmp_play_session.h"
+
+#define RTMP_PUSH_CHUNK_STREAM_ID_AUDIO     (4)
+#define RTMP_PUSH_CHUNK_STREAM_ID_META      (5)
+#define RTMP_PUSH_CHUNK_STREAM_ID_VIDEO     (6)
+
+//====================================================================================================
+// RtmpPushStream
+// - Makes the FLV tags (H264/AAC) of the frames once, and serializes them to the chunks once per
+//   export key (chunk size + message stream id). The targets of the same key share the chunks
+// - The headers are not compressed (type 0 for every message), so a target can start from any message
+// - The players of the RTMP provider port are served with one export key (RTMP_PLAY_CHUNK_SIZE), so
+//   all players (and the push targets of the same key) share the chunks. A new player starts from the
+//   GOP cache of the router, the cached frames are serialized once for the players which join together
+//====================================================================================================
+class RtmpPushStream : public Stream
+{
+public:
+	static std::shared_ptr<RtmpPushStream> Create(const std::shared_ptr<Application> application,
+	                                              const StreamInfo &info,
+	                                              uint32_t worker_count,
+	                                              const std::vector<RtmpPushTarget> &targets,
+	                                              size_t queue_size);
+
+	RtmpPushStream(const std::shared_ptr<Application> application,
+	               const StreamInfo &info,
+	               const std::vector<RtmpPushTarget> &targets,
+	               size_t queue_size);
+	~RtmpPushStream() final;
+
+	void SendVideoFrame(std::shared_ptr<MediaTrack> track,
+	                    std::unique_ptr<EncodedFrameDescriptor> frame) override;
+
+	void SendAudioFrame(std::shared_ptr<MediaTrack> track,
+	                    std::unique_ptr<EncodedFrameDescriptor> frame) override;
+
+	// Number of the targets which are publishing
+	size_t GetPublishingCount();
+
+	// Returns false if the stream cannot be played (e.g. there is no H264/AAC track)
+	// - The players are limited to the queue size of the targets
+	bool AddPlayer(const std::shared_ptr<RtmpPlayConnection> &connection);
+	void RemovePlayer(const std::shared_ptr<RtmpPlayConnection> &connection);
+	size_t GetPlayerCount();
+
+private:
+	bool Start(uint32_t worker_count) override;
+	bool Stop() override;
+
+	void MakeMetaData();
+	uint32_t GetTimestamp(int64_t milliseconds);
+
+	// FLV video tag (AVCC) of the Annex B frame, SPS/PPS of the frame are returned instead of being added to the tag
+	std::shared_ptr<std::vector<uint8_t>> MakeVideoTag(const uint8_t *data, size_t data_size,
+	                                                   const FragmentationHeader *fragmentation, bool key_frame,
+	                                                   const uint8_t *&sps, size_t &sps_size,
+	                                                   const uint8_t *&pps, size_t &pps_size);
+	// FLV audio tag of the ADTS (or raw AAC) frame, config is the AudioSpecificConfig of the frame (nullptr: no payload)
+	std::shared_ptr<std::vector<uint8_t>> MakeAudioTag(const std::shared_ptr<MediaTrack> &track,
+	                                                   const uint8_t *data, size_t data_size,
+	                                                   uint8_t config[2]);
+
+	// Sends a message to all publishing targets and playing players (_session_mutex must not be locked)
+	void SendMessage(RtmpPushPacketType packet_type,
+	                 uint32_t chunk_stream_id,
+	                 uint8_t type_id,
+	                 uint32_t timestamp,
+	                 std::shared_ptr<std::vector<uint8_t>> &body);
+	// Returns false if the message could not be serialized (_session_mutex must be locked)
+	template<typename T>
+	bool SendSessionMessage(const std::shared_ptr<T> &session,
+	                        std::map<RtmpPushExportKey, std::shared_ptr<const ov::Data>> &chunks,
+	                        RtmpPushPacketType packet_type,
+	                        uint32_t chunk_stream_id,
+	                        uint8_t type_id,
+	                        uint32_t timestamp,
+	                        std::shared_ptr<std::vector<uint8_t>> &body);
+	template<typename T>
+	void SendSequenceHeaders(const std::shared_ptr<T> &session, uint32_t timestamp);
+	// Sends the GOP cache of the router to the new players (_session_mutex must be locked)
+	// - Only the frames which have been sent by the stream are replayed (the router is ahead of the stream),
+	//   the players wait for the next key frame if nothing is replayed
+	void ReplayGopCache(const std::vector<std::shared_ptr<RtmpPlaySession>> &sessions);
+	std::shared_ptr<const ov::Data> ExportMessage(const RtmpPushExportKey &key,
+	                                              uint32_t chunk_stream_id,
+	                                              uint8_t type_id,
+	                                              uint32_t timestamp,
+	                                              std::shared_ptr<std::vector<uint8_t>> &body);
+
+	std::vector<RtmpPushTarget> _targets;
+	size_t _queue_size;
+
+	std::shared_ptr<MediaTrack> _video_track;
+	std::shared_ptr<MediaTrack> _audio_track;
+
+	std::mutex _session_mutex;
+	std::vector<std::shared_ptr<RtmpPushSession>> _push_sessions;
+	std::vector<std::shared_ptr<RtmpPlaySession>> _play_sessions;
+	std::map<RtmpPushExportKey, std::unique_ptr<RtmpExportChunk>> _export_chunks;
+
+	// Message bodies which are queued before the media to the new (or dropped) targets
+	std::shared_ptr<std::vector<uint8_t>> _metadata;
+	std::shared_ptr<std::vector<uint8_t>> _video_sequence_header;
+	std::shared_ptr<std::vector<uint8_t>> _audio_sequence_header;
+
+	std::vector<uint8_t> _avc_sps;
+	std::vector<uint8_t> _avc_pps;
+
+	// Timestamp of the first frame (ms), the timestamps of the messages start from 0
+	int64_t _base_timestamp = -1;
+	// Timestamps of the last frames which have been sent (ms, -1: none), the GOP cache is replayed up to them
+	int64_t _last_video_timestamp = -1;
+	int64_t _last_audio_timestamp = -1;
+};
@@ -0,0 +1,281 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "bandwidth_estimator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#define OV_LOG_TAG "RtpRtcp.BWE"
+
+BandwidthEstimator::BandwidthEstimator()
+	: _sent_packets(BWE_SENT_HISTORY_SIZE)
+{
+}
+
+void BandwidthEstimator::OnPacketSent(uint16_t transport_sequence_number, size_t size, int64_t send_time_us)
+{
+	auto &sent_packet = _sent_packets[transport_sequence_number & (BWE_SENT_HISTORY_SIZE - 1)];
+
+	sent_packet.valid = true;
+	sent_packet.transport_sequence_number = transport_sequence_number;
+	sent_packet.size = size;
+	sent_packet.send_time_us = send_time_us;
+}
+
+void BandwidthEstimator::OnTransportFeedback(const RtcpTransportCc &feedback, int64_t current_time_us)
+{
+	bool has_arrived_packet = false;
+
+	for(const auto &status : feedback.packets)
+	{
+		if(status.received == false)
+		{
+			continue;
+		}
+
+		auto &sent_packet = _sent_packets[status.sequence_number & (BWE_SENT_HISTORY_SIZE - 1)];
+
+		if((sent_packet.valid == false) || (sent_packet.transport_sequence_number != status.sequence_number))
+		{
+			// Too old, or the feedback is duplicated
+			continue;
+		}
+
+		OnPacketArrived(sent_packet, status.receive_time_us);
+
+		sent_packet.valid = false;
+		has_arrived_packet = true;
+	}
+
+	if(has_arrived_packet)
+	{
+		if(_has_transport_feedback == false)
+		{
+			// The delay based estimate starts from the REMB if it is known
+			if(_remb_time_us >= 0)
+			{
+				_estimated_bitrate = std::min(_estimated_bitrate, static_cast<double>(_remb_bitrate));
+			}
+
+			_has_transport_feedback = true;
+		}
+
+		UpdateEstimate(current_time_us);
+	}
+}
+
+void BandwidthEstimator::OnPacketArrived(const SentPacket &sent_packet, int64_t arrival_time_us)
+{
+	// Acknowledged bitrate
+	_acked_packets.emplace_back(arrival_time_us, sent_packet.size);
+	_acked_bytes += sent_packet.size;
+
+	while((_acked_packets.empty() == false) && ((arrival_time_us - _acked_packets.front().first) > BWE_ACKED_WINDOW_US))
+	{
+		_acked_bytes -= _acked_packets.front().second;
+		_acked_packets.pop_front();
+	}
+
+	// Packet grouping
+	if(_current_group.valid && ((sent_packet.send_time_us - _current_group.first_send_time_us) <= BWE_BURST_INTERVAL_US))
+	{
+		_current_group.last_send_time_us = std::max(_current_group.last_send_time_us, sent_packet.send_time_us);
+		_current_group.last_arrival_time_us = std::max(_current_group.last_arrival_time_us, arrival_time_us);
+		return;
+	}
+
+	if(_current_group.valid && _previous_group.valid)
+	{
+		int64_t send_delta_us = _current_group.last_send_time_us - _previous_group.last_send_time_us;
+		int64_t arrival_delta_us = _current_group.last_arrival_time_us - _previous_group.last_arrival_time_us;
+
+		if(send_delta_us >= 0)
+		{
+			UpdateTrendline(static_cast<double>(arrival_delta_us - send_delta_us) / 1000.0, _current_group.last_arrival_time_us);
+		}
+	}
+
+	if(_current_group.valid)
+	{
+		_previous_group = _current_group;
+	}
+
+	_current_group.valid = true;
+	_current_group.first_send_time_us = sent_packet.send_time_us;
+	_current_group.last_send_time_us = sent_packet.send_time_us;
+	_current_group.last_arrival_time_us = arrival_time_us;
+}
+
+void BandwidthEstimator::UpdateTrendline(double delay_variation_ms, int64_t arrival_time_us)
+{
+	if(_first_arrival_time_us < 0)
+	{
+		_first_arrival_time_us = arrival_time_us;
+	}
+
+	_delta_count = std::min<uint32_t>(_delta_count + 1, 60);
+
+	_accumulated_delay += delay_variation_ms;
+	_smoothed_delay = (BWE_TRENDLINE_SMOOTHING * _smoothed_delay) + ((1.0 - BWE_TRENDLINE_SMOOTHING) * _accumulated_delay);
+
+	_delay_samples.emplace_back(static_cast<double>(arrival_time_us - _first_arrival_time_us) / 1000.0, _smoothed_delay);
+
+	if(_delay_samples.size() > BWE_TRENDLINE_WINDOW_SIZE)
+	{
+		_delay_samples.pop_front();
+	}
+
+	if(_delay_samples.size() < BWE_TRENDLINE_WINDOW_SIZE)
+	{
+		return;
+	}
+
+	// Slope of the linear regression
+	double average_x = 0.0;
+	double average_y = 0.0;
+
+	for(const auto &sample : _delay_samples)
+	{
+		average_x += sample.first;
+		average_y += sample.second;
+	}
+
+	average_x /= _delay_samples.size();
+	average_y /= _delay_samples.size();
+
+	double numerator = 0.0;
+	double denominator = 0.0;
+
+	for(const auto &sample : _delay_samples)
+	{
+		numerator += (sample.first - average_x) * (sample.second - average_y);
+		denominator += (sample.first - average_x) * (sample.first - average_x);
+	}
+
+	if(denominator == 0.0)
+	{
+		return;
+	}
+
+	double modified_trend = (numerator / denominator) * _delta_count * BWE_TRENDLINE_THRESHOLD_GAIN;
+
+	if(modified_trend > BWE_OVERUSE_THRESHOLD)
+	{
+		// A single spike is not the overuse
+		_overuse_count++;
+
+		if(_overuse_count >= 2)
+		{
+			_usage = BandwidthUsage::Overusing;
+		}
+	}
+	else if(modified_trend < -BWE_OVERUSE_THRESHOLD)
+	{
+		_overuse_count = 0;
+		_usage = BandwidthUsage::Underusing;
+	}
+	else
+	{
+		_overuse_count = 0;
+		_usage = BandwidthUsage::Normal;
+	}
+}
+
+uint64_t BandwidthEstimator::GetAckedBitrate() const
+{
+	if(_acked_packets.size() < 2)
+	{
+		return 0;
+	}
+
+	int64_t duration_us = std::max<int64_t>(_acked_packets.back().first - _acked_packets.front().first, BWE_ACKED_WINDOW_US / 5);
+
+	return static_cast<uint64_t>(_acked_bytes) * 8 * 1000000 / duration_us;
+}
+
+void BandwidthEstimator::UpdateEstimate(int64_t current_time_us)
+{
+	double elapsed = (_last_update_time_us < 0) ? 0.0 : static_cast<double>(current_time_us - _last_update_time_us) / 1000000.0;
+	elapsed = std::min(std::max(elapsed, 0.0), 1.0);
+
+	_last_update_time_us = current_time_us;
+
+	auto acked_bitrate = static_cast<double>(GetAckedBitrate());
+
+	switch(_usage)
+	{
+		case BandwidthUsage::Overusing:
+			// Multiplicative decrease
+			_estimated_bitrate = (acked_bitrate > 0.0) ? std::min(_estimated_bitrate, acked_bitrate * 0.85) : (_estimated_bitrate * 0.85);
+			// Decrease once per overuse
+			_usage = BandwidthUsage::Normal;
+			_overuse_count = 0;
+			break;
+
+		case BandwidthUsage::Normal:
+			// Multiplicative increase (8% per second), but not too far from the throughput
+			_estimated_bitrate *= std::pow(1.08, elapsed);
+
+			if(acked_bitrate > 0.0)
+			{
+				_estimated_bitrate = std::min(_estimated_bitrate, (acked_bitrate * 1.5) + 10000.0);
+			}
+			break;
+
+		case BandwidthUsage::Underusing:
+			// The queues are draining, hold the estimate
+			break;
+	}
+
+	_estimated_bitrate = std::min(std::max(_estimated_bitrate, static_cast<double>(BWE_MIN_BITRATE)), static_cast<double>(BWE_MAX_BITRATE));
+}
+
+void BandwidthEstimator::OnRemb(uint64_t bitrate, int64_t current_time_us)
+{
+	_remb_bitrate = bitrate;
+	_remb_time_us = current_time_us;
+
+	if(_has_transport_feedback == false)
+	{
+		// The player estimates the bandwidth
+		_estimated_bitrate = std::min(std::max(static_cast<double>(bitrate), static_cast<double>(BWE_MIN_BITRATE)), static_cast<double>(BWE_MAX_BITRATE));
+	}
+}
+
+void BandwidthEstimator::OnFractionLost(uint8_t fraction_lost)
+{
+	double loss = static_cast<double>(fraction_lost) / 256.0;
+
+	if(loss > 0.1)
+	{
+		_estimated_bitrate = std::max(_estimated_bitrate * (1.0 - (0.5 * loss)), static_cast<double>(BWE_MIN_BITRATE));
+	}
+}
+
+uint64_t BandwidthEstimator::GetEstimatedBitrate(int64_t current_time_us) const
+{
+	auto estimated_bitrate = static_cast<uint64_t>(_estimated_bitrate);
+
+	if(_has_transport_feedback && (_remb_time_us >= 0) && ((current_time_us - _remb_time_us) <= BWE_REMB_TIMEOUT_US))
+	{
+		estimated_bitrate = std::min(estimated_bitrate, _remb_bitrate);
+	}
+
+	return estimated_bitrate;
+}
+
+bool BandwidthEstimator::HasEstimate(int64_t current_time_us) const
+{
+	return _has_transport_feedback || ((_remb_time_us >= 0) && ((current_time_us - _remb_time_us) <= BWE_REMB_TIMEOUT_US));
+}
+
+int64_t BandwidthEstimator::GetCurrentMicroseconds()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
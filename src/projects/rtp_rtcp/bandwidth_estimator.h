@@ -0,0 +1,120 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <deque>
+#include <vector>
+
+#include "rtcp_packet.h"
+
+// Number of the sent packets kept to match the transport-wide CC feedback (must be a power of 2)
+#define BWE_SENT_HISTORY_SIZE			8192
+
+#define BWE_MIN_BITRATE					(100 * 1000)
+#define BWE_MAX_BITRATE					(20 * 1000 * 1000)
+#define BWE_START_BITRATE				(1000 * 1000)
+
+// Packets sent within this interval are handled as a group (a burst of a frame)
+#define BWE_BURST_INTERVAL_US			5000
+// Number of the delay samples of the trendline
+#define BWE_TRENDLINE_WINDOW_SIZE		20
+#define BWE_TRENDLINE_SMOOTHING			0.9
+#define BWE_TRENDLINE_THRESHOLD_GAIN	4.0
+// Modified trend (ms) of the overuse detection
+#define BWE_OVERUSE_THRESHOLD			12.5
+// Window of the acknowledged bitrate
+#define BWE_ACKED_WINDOW_US				(500 * 1000)
+// REMB is ignored if it is not received for this time
+#define BWE_REMB_TIMEOUT_US				(5 * 1000 * 1000)
+
+// Estimates the available bandwidth of a session (a simplified version of the send-side BWE of WebRTC)
+//
+// - Delay based: the one-way delay variation of the packet groups is measured by the transport-wide CC feedback,
+//   and its trendline detects the overuse (decrease to 85% of the acknowledged bitrate) or
+//   the normal state (increase by 8% per second)
+// - Loss based: the estimate is decreased when the fraction lost of RR is more than 10%
+// - REMB (the estimate of the receiver) limits the estimate,
+//   or it is the estimate if the player doesn't send the transport-wide CC feedback
+// - Not thread-safe (RtpRtcp guards it)
+class BandwidthEstimator
+{
+public:
+	BandwidthEstimator();
+	~BandwidthEstimator() = default;
+
+	void OnPacketSent(uint16_t transport_sequence_number, size_t size, int64_t send_time_us);
+	void OnTransportFeedback(const RtcpTransportCc &feedback, int64_t current_time_us);
+	void OnRemb(uint64_t bitrate, int64_t current_time_us);
+	// fraction_lost is 1/256 (RR)
+	void OnFractionLost(uint8_t fraction_lost);
+
+	// bps
+	uint64_t GetEstimatedBitrate(int64_t current_time_us) const;
+	// false if neither the transport-wide CC feedback nor REMB is received (the estimate is the start bitrate)
+	bool HasEstimate(int64_t current_time_us) const;
+
+	static int64_t GetCurrentMicroseconds();
+
+private:
+	enum class BandwidthUsage
+	{
+		Normal,
+		Overusing,
+		Underusing
+	};
+
+	struct SentPacket
+	{
+		bool valid = false;
+		uint16_t transport_sequence_number = 0;
+		size_t size = 0;
+		int64_t send_time_us = 0;
+	};
+
+	struct PacketGroup
+	{
+		bool valid = false;
+		int64_t first_send_time_us = 0;
+		int64_t last_send_time_us = 0;
+		int64_t last_arrival_time_us = 0;
+	};
+
+	void OnPacketArrived(const SentPacket &sent_packet, int64_t arrival_time_us);
+	// delay_variation_ms: (inter-arrival time) - (inter-departure time) of two groups
+	void UpdateTrendline(double delay_variation_ms, int64_t arrival_time_us);
+	void UpdateEstimate(int64_t current_time_us);
+	uint64_t GetAckedBitrate() const;
+
+	std::vector<SentPacket> _sent_packets;
+
+	PacketGroup _current_group;
+	PacketGroup _previous_group;
+
+	// Trendline
+	double _accumulated_delay = 0.0;
+	double _smoothed_delay = 0.0;
+	int64_t _first_arrival_time_us = -1;
+	// (arrival time (ms), smoothed delay (ms))
+	std::deque<std::pair<double, double>> _delay_samples;
+	uint32_t _delta_count = 0;
+	uint32_t _overuse_count = 0;
+	BandwidthUsage _usage = BandwidthUsage::Normal;
+
+	// (arrival time (us), size) of the acknowledged packets
+	std::deque<std::pair<int64_t, size_t>> _acked_packets;
+	size_t _acked_bytes = 0;
+
+	bool _has_transport_feedback = false;
+	double _estimated_bitrate = BWE_START_BITRATE;
+	int64_t _last_update_time_us = -1;
+
+	uint64_t _remb_bitrate = 0;
+	int64_t _remb_time_us = -1;
+};
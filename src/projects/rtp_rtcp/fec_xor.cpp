@@ -0,0 +1,92 @@
+#include "fec_xor.h"
+
+#if defined(__SSE2__)
+#	define OV_FEC_USE_SSE2
+#	include <emmintrin.h>
+// The AVX2 kernel is compiled with the target attribute and used only if the CPU supports it
+#	if defined(__GNUC__)
+#		define OV_FEC_USE_AVX2
+#		include <immintrin.h>
+#	endif
+#elif defined(__aarch64__)
+#	define OV_FEC_USE_NEON
+#	include <arm_neon.h>
+#endif
+
+namespace
+{
+#if defined(OV_FEC_USE_AVX2)
+	bool HasAvx2()
+	{
+		static const bool has_avx2 = __builtin_cpu_supports("avx2");
+
+		return has_avx2;
+	}
+
+	__attribute__((target("avx2")))
+	size_t XorBytesAvx2(uint8_t *dst, const uint8_t *src, size_t length)
+	{
+		size_t offset = 0;
+
+		for(; (offset + 32) <= length; offset += 32)
+		{
+			__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + offset));
+			__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + offset));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + offset), _mm256_xor_si256(a, b));
+		}
+
+		return offset;
+	}
+#endif // OV_FEC_USE_AVX2
+
+#if defined(OV_FEC_USE_SSE2)
+	size_t XorBytesSse2(uint8_t *dst, const uint8_t *src, size_t length)
+	{
+		size_t offset = 0;
+
+		for(; (offset + 16) <= length; offset += 16)
+		{
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + offset));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + offset));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + offset), _mm_xor_si128(a, b));
+		}
+
+		return offset;
+	}
+#endif // OV_FEC_USE_SSE2
+
+#if defined(OV_FEC_USE_NEON)
+	size_t XorBytesNeon(uint8_t *dst, const uint8_t *src, size_t length)
+	{
+		size_t offset = 0;
+
+		for(; (offset + 16) <= length; offset += 16)
+		{
+			vst1q_u8(dst + offset, veorq_u8(vld1q_u8(dst + offset), vld1q_u8(src + offset)));
+		}
+
+		return offset;
+	}
+#endif // OV_FEC_USE_NEON
+}
+
+void XorFecBytes(uint8_t *dst, const uint8_t *src, size_t length)
+{
+	// The kernel processes the bytes from the beginning, the remaining bytes are processed by the scalar loop
+#if defined(OV_FEC_USE_AVX2)
+	size_t offset = HasAvx2() ? XorBytesAvx2(dst, src, length) : XorBytesSse2(dst, src, length);
+#elif defined(OV_FEC_USE_SSE2)
+	size_t offset = XorBytesSse2(dst, src, length);
+#elif defined(OV_FEC_USE_NEON)
+	size_t offset = XorBytesNeon(dst, src, length);
+#else
+	size_t offset = 0;
+#endif
+
+	for(; offset < length; offset++)
+	{
+		dst[offset] ^= src[offset];
+	}
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// dst ^= src (length bytes)
+// The FEC generators XOR the media packets with this, it uses SSE2/AVX2 or NEON if the CPU supports
+void XorFecBytes(uint8_t *dst, const uint8_t *src, size_t length);
@@ -0,0 +1,223 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "flexfec_generator.h"
+#include "base/ovlibrary/byte_io.h"
+#include "fec_xor.h"
+
+#include <algorithm>
+#include <string.h>
+
+#define OV_LOG_TAG "RtpRtcp.FlexFEC"
+
+void FlexfecGenerator::SetProtectionRate(uint32_t rate)
+{
+	_protection_rate = std::min<uint32_t>(rate, ULPFEC_MAX_PROTECTION_RATE);
+}
+
+void FlexfecGenerator::StartBlock()
+{
+	uint32_t protection_rate = _protection_rate;
+
+	_media_packets.clear();
+
+	if(protection_rate == 0)
+	{
+		_columns = 0;
+		_rows = 0;
+	}
+	else if(protection_rate <= FLEXFEC_ROW_ONLY_MAX_RATE)
+	{
+		// e.g. 10% Rate, 1 row FEC packet per 10 media packets
+		_columns = std::min<size_t>(100 / protection_rate, FLEXFEC_MAX_PROTECTED_PACKETS);
+		_rows = 1;
+	}
+	else
+	{
+		// L + D FEC packets per L x D media packets (4 x 4: 50%)
+		_columns = FLEXFEC_2D_COLUMNS;
+		_rows = FLEXFEC_2D_ROWS;
+	}
+}
+
+bool FlexfecGenerator::AddRtpPacketAndGenerateFec(const std::shared_ptr<RtpPacket> &packet)
+{
+	if(_media_packets.empty())
+	{
+		StartBlock();
+	}
+
+	if(_columns == 0)
+	{
+		// FEC is not needed for any session, the rate is checked again by the next packet
+		return true;
+	}
+
+	_media_packets.push_back(packet);
+
+	size_t count = _media_packets.size();
+
+	if((count % _columns) == 0)
+	{
+		// Row
+		_indexes.clear();
+
+		for(size_t index = count - _columns; index < count; index++)
+		{
+			_indexes.push_back(index);
+		}
+
+		Encode(_indexes);
+	}
+
+	if(count == (_columns * _rows))
+	{
+		if(_rows > 1)
+		{
+			// Columns
+			for(size_t column = 0; column < _columns; column++)
+			{
+				_indexes.clear();
+
+				for(size_t row = 0; row < _rows; row++)
+				{
+					_indexes.push_back((row * _columns) + column);
+				}
+
+				Encode(_indexes);
+			}
+		}
+
+		_media_packets.clear();
+	}
+
+	return true;
+}
+
+bool FlexfecGenerator::IsAvailableFecPackets() const
+{
+	return !_generated_fec_packets.empty();
+}
+
+bool FlexfecGenerator::NextPacket(RtpPacket *packet)
+{
+	if(!IsAvailableFecPackets())
+	{
+		return false;
+	}
+
+	auto fec_packet = _generated_fec_packets.front();
+	_generated_fec_packets.pop();
+
+	return packet->SetPayload(fec_packet->GetDataAs<uint8_t>(), fec_packet->GetLength());
+}
+
+size_t FlexfecGenerator::GetMaskSize(uint16_t max_offset)
+{
+	if(max_offset < 15)
+	{
+		return 2;
+	}
+	else if(max_offset < 46)
+	{
+		return 6;
+	}
+
+	return FLEXFEC_MAX_MASK_SIZE;
+}
+
+void FlexfecGenerator::Encode(const std::vector<size_t> &indexes)
+{
+	uint16_t sn_base = _media_packets[indexes.front()]->SequenceNumber();
+	uint16_t max_offset = 0;
+	size_t max_protected_len = 0;
+
+	for(auto index : indexes)
+	{
+		auto &media_packet = _media_packets[index];
+
+		max_offset = std::max<uint16_t>(max_offset, media_packet->SequenceNumber() - sn_base);
+		max_protected_len = std::max(max_protected_len, media_packet->GetData()->GetLength() - FIXED_HEADER_SIZE);
+	}
+
+	if(max_offset >= FLEXFEC_MAX_PROTECTED_PACKETS)
+	{
+		logte("Could not protect the packets (SN base: %u, max offset: %u)", sn_base, max_offset);
+		return;
+	}
+
+	size_t mask_size = GetMaskSize(max_offset);
+	size_t fec_header_size = FLEXFEC_BASE_HEADER_SIZE + mask_size;
+
+	// The new bytes are zero, so the first packet is XORed too
+	auto fec_packet = std::make_shared<ov::Data>();
+	fec_packet->SetLength(fec_header_size + max_protected_len);
+	auto fec_buffer = fec_packet->GetWritableDataAs<uint8_t>();
+
+	uint8_t mask[FLEXFEC_MAX_MASK_SIZE];
+	memset(mask, 0, sizeof(mask));
+
+	for(auto index : indexes)
+	{
+		auto &media_packet = _media_packets[index];
+
+		XorFecPacket(fec_buffer, fec_header_size, media_packet.get());
+
+		// The mask bits follow the k bits of the first and the second chunks
+		uint16_t offset = media_packet->SequenceNumber() - sn_base;
+		size_t bit = (offset < 15) ? (offset + 1) : (offset + 2);
+
+		mask[bit / 8] |= 1 << (7 - (bit % 8));
+	}
+
+	// R=0, F=0 (flexible mask)
+	fec_buffer[0] &= 0x3F;
+
+	// SN base
+	ByteWriter<uint16_t>::WriteBigEndian(&fec_buffer[8], sn_base);
+
+	// k bit of the last chunk (the third chunk has no k bit)
+	if(mask_size == 2)
+	{
+		mask[0] |= 0x80;
+	}
+	else if(mask_size == 6)
+	{
+		mask[2] |= 0x80;
+	}
+
+	memcpy(&fec_buffer[FLEXFEC_BASE_HEADER_SIZE], mask, mask_size);
+
+	_generated_fec_packets.push(fec_packet);
+}
+
+void FlexfecGenerator::XorFecPacket(uint8_t *fec_packet, size_t fec_header_len, RtpPacket *media_packet)
+{
+	auto rtp_header = media_packet->Header();
+	auto rtp_length = media_packet->GetData()->GetLength();
+
+	// XOR P, X, CC
+	fec_packet[0] ^= rtp_header[0];
+
+	// XOR M, PT recovery
+	fec_packet[1] ^= rtp_header[1];
+
+	// XOR Length recovery (CSRCs, header extensions, payload and padding)
+	uint8_t length_network_order[2];
+	ByteWriter<uint16_t>::WriteBigEndian(length_network_order, static_cast<uint16_t>(rtp_length - FIXED_HEADER_SIZE));
+	fec_packet[2] ^= length_network_order[0];
+	fec_packet[3] ^= length_network_order[1];
+
+	// XOR TS recovery
+	fec_packet[4] ^= rtp_header[4];
+	fec_packet[5] ^= rtp_header[5];
+	fec_packet[6] ^= rtp_header[6];
+	fec_packet[7] ^= rtp_header[7];
+
+	// XOR everything after the fixed header
+	XorFecBytes(&fec_packet[fec_header_len], &rtp_header[FIXED_HEADER_SIZE], rtp_length - FIXED_HEADER_SIZE);
+}
@@ -0,0 +1,91 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "rtp_packet.h"
+#include "ulpfec_generator.h"
+
+#include <atomic>
+#include <memory>
+#include <queue>
+#include <vector>
+
+// Size of the FlexFEC header before the mask: R/F/P/X/CC(1) M/PT recovery(1) length recovery(2) TS recovery(4) SN base(2)
+#define FLEXFEC_BASE_HEADER_SIZE			10
+// The mask is extended as needed: k + mask[0-14](2), k + mask[15-45](4), mask[46-109](8)
+#define FLEXFEC_MAX_MASK_SIZE				14
+#define FLEXFEC_MAX_PROTECTED_PACKETS		110
+// Above this protection rate, the columns are also protected (2D parity)
+#define FLEXFEC_ROW_ONLY_MAX_RATE			25
+// L (columns) x D (rows) of the 2D parity
+#define FLEXFEC_2D_COLUMNS					4
+#define FLEXFEC_2D_ROWS						4
+
+/*
+* FlexFEC header (RFC 8627, flexible mask: R=0, F=0)
+    0                   1                   2                   3
+    0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |0|0|P|X|  CC   |M| PT recovery |        length recovery        |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |                          TS recovery                          |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |           SN base_i           |k|          Mask [0-14]        |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |k|                   Mask [15-45] (optional)                   |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |                     Mask [46-109] (optional)                  |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |                   ... FEC Payload (repair) ...                |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+*/
+
+/*
+ *  FlexFEC packets are sent on their own SSRC, so the media packets are not wrapped with RED.
+ *  The media packets are protected by blocks of L x D packets (the sequence numbers are consecutive):
+ *   - Row: L consecutive packets are protected by one FEC packet (generated when the row is complete)
+ *   - Column: the packets of the same column of D rows are protected by one FEC packet (generated when the block is complete),
+ *     a burst loss of a row is recovered by the columns
+ *  Any parity is described by the flexible mask, so the receiver doesn't need to know L and D.
+ *  The protection rate decides L and D, it is applied from the next block.
+ */
+
+class FlexfecGenerator
+{
+public:
+	FlexfecGenerator() = default;
+	~FlexfecGenerator() = default;
+
+	// rate: FEC packets per 100 media packets (applied from the next block, it can be called from another thread)
+	// The rate is same as ULPFEC (see UlpfecGenerator::GetProtectionRate())
+	void SetProtectionRate(uint32_t rate);
+
+	// packet: a media packet (not RED)
+	bool AddRtpPacketAndGenerateFec(const std::shared_ptr<RtpPacket> &packet);
+	bool IsAvailableFecPackets() const;
+	// Sets the FEC header and the repair payload to the payload of packet
+	bool NextPacket(RtpPacket *packet);
+
+private:
+	// Decides L and D of the next block by the protection rate
+	void StartBlock();
+	// Makes a FEC packet protecting the packets of the block at the indexes
+	void Encode(const std::vector<size_t> &indexes);
+	static void XorFecPacket(uint8_t *fec_packet, size_t fec_header_len, RtpPacket *media_packet);
+	static size_t GetMaskSize(uint16_t max_offset);
+
+	std::queue<std::shared_ptr<ov::Data>>		_generated_fec_packets;
+	// Media packets of the current block
+	std::vector<std::shared_ptr<RtpPacket>>		_media_packets;
+	std::atomic<uint32_t>						_protection_rate { ULPFEC_DEFAULT_PROTECTION_RATE };
+
+	// 0 if FEC is not generated for the current block
+	size_t _columns = 0;
+	size_t _rows = 0;
+	std::vector<size_t> _indexes;
+};
@@ -9,6 +9,12 @@ RedRtpPacket::RedRtpPacket(uint8_t red_payload_type, RtpPacket &src)
 	PackageAsRed(red_payload_type, src);
 }
 
+RedRtpPacket::RedRtpPacket(uint8_t red_payload_type, RtpPacket &src, const std::shared_ptr<ov::Data> &arena, uint8_t *buffer, size_t offset, size_t capacity)
+	: RtpPacket(arena, buffer, offset, capacity)
+{
+	PackageAsRed(red_payload_type, src);
+}
+
 RedRtpPacket::RedRtpPacket(RedRtpPacket &src)
 	:RtpPacket(src)
 {
@@ -33,6 +39,11 @@ void RedRtpPacket::PackageAsRed(uint8_t red_payload_type, RtpPacket &src)
 	_padding_size = src.PaddingSize();
 	_extension_size = src.ExtensionSize();
 
+	// CSRCs and header extensions
+	SetDataLength(_payload_offset);
+	_buffer[0] = (_buffer[0] & 0xE0) | (src.Buffer()[0] & 0x1F);
+	::memcpy(&_buffer[FIXED_HEADER_SIZE], &(src.Buffer()[FIXED_HEADER_SIZE]), _payload_offset - FIXED_HEADER_SIZE);
+
 	PackageAsRed(red_payload_type);
 
 	SetMarker(src.Marker());
@@ -51,8 +62,7 @@ void RedRtpPacket::PackageAsRed(uint8_t red_payload_type)
 
 	// Increase 1 bytes for RED
 	_payload_offset = _payload_offset + RED_HEADER_SIZE;
-	_data->SetLength(_payload_offset);
-	_buffer = _data->GetWritableDataAs<uint8_t>();
+	SetDataLength(_payload_offset);
 
 	// Write payload type at the end of the rtp header
 	_buffer[_payload_offset - RED_HEADER_SIZE] = _block_pt;
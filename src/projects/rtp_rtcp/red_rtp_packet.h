@@ -9,6 +9,8 @@ class RedRtpPacket : public RtpPacket
 public:
 	RedRtpPacket();
 	RedRtpPacket(uint8_t red_payload_type, RtpPacket &src);
+	// The packet is written to arena (see RtpPacketArena)
+	RedRtpPacket(uint8_t red_payload_type, RtpPacket &src, const std::shared_ptr<ov::Data> &arena, uint8_t *buffer, size_t offset, size_t capacity);
 	RedRtpPacket(RedRtpPacket &src);
 	~RedRtpPacket();
 
@@ -8,6 +8,7 @@
 //==============================================================================
 #include "rtcp_packet.h"
 #include <sys/time.h>
+#include <algorithm>
 
 #define OV_LOG_TAG "Rtcp"
 
@@ -101,6 +102,12 @@ ov::String  RtcpPacket::GetPacketTypeString(RtcpPacketType type)
         case RtcpPacketType::APP :
             result = "APP";
             break;
+        case RtcpPacketType::RTPFB :
+            result = "RTPFB";
+            break;
+        case RtcpPacketType::PSFB :
+            result = "PSFB";
+            break;
     }
 
     return result;
@@ -130,7 +137,7 @@ bool RtcpPacket::IsRtcpPacket(const std::shared_ptr<const ov::Data> &data,
     // rtcp rr packet check
     if(version != RTCP_HEADER_VERSION ||
        type < (int)RtcpPacketType::SR ||
-       type > (int)RtcpPacketType::APP ||
+       type > (int)RtcpPacketType::PSFB ||
        data->GetLength() < RTCP_HEADER_SIZE + payload_size)
     {
         return false;
@@ -154,20 +161,28 @@ bool RtcpPacket::RrParseing(int report_count,
 
     for(int index = 0; index < report_count; index++)
     {
+        // The bounds of the report block are checked at once
+        auto block = stream.ReadBlock(RTCP_REPORT_BLOCK_LENGTH);
+
+        if(block == nullptr)
+        {
+            break;
+        }
+
         auto receiver_report = std::make_shared<RtcpReceiverReport >();
         receiver_report->ssrc = sender_ssrc;
-        receiver_report->ssrc_1 = stream.ReadBE32();
-        receiver_report->fraction_lost = stream.Read8();
+        receiver_report->ssrc_1 = ov::LoadBE<uint32_t>(block);
+        receiver_report->fraction_lost = block[4];
 
-        receiver_report->packet_lost += stream.Read8() << 16;
-        receiver_report->packet_lost += stream.Read8() << 8;
-        receiver_report->packet_lost += stream.Read8();
+        receiver_report->packet_lost += block[5] << 16;
+        receiver_report->packet_lost += block[6] << 8;
+        receiver_report->packet_lost += block[7];
 
-        receiver_report->sequence_number_cycle = stream.ReadBE16();
-        receiver_report->highest_sequence_number = stream.ReadBE16();
-        receiver_report->jitter = stream.ReadBE32();
-        receiver_report->lsr = stream.ReadBE32();
-        receiver_report->dlsr = stream.ReadBE32();
+        receiver_report->sequence_number_cycle = ov::LoadBE<uint16_t>(block + 8);
+        receiver_report->highest_sequence_number = ov::LoadBE<uint16_t>(block + 10);
+        receiver_report->jitter = ov::LoadBE<uint32_t>(block + 12);
+        receiver_report->lsr = ov::LoadBE<uint32_t>(block + 16);
+        receiver_report->dlsr = ov::LoadBE<uint32_t>(block + 20);
 
         // delay calculation
         receiver_report->rtt = DelayCalculation(receiver_report->lsr, receiver_report->dlsr);
@@ -178,6 +193,310 @@ bool RtcpPacket::RrParseing(int report_count,
     return true;
 }
 
+//====================================================================================================
+// Generic NACK packet Parsing
+/*
+ *  ********** RTPFB: Generic NACK (RFC 4585) **********
+ 0                   1                   2                   3
+ 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|V=2|P|  FMT=1  |   PT=RTPFB=205|             length            |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|                  SSRC of packet sender                        |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|                  SSRC of media source                         |
++=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+|            PID                |             BLP               | FCI
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+:                               ...                             :
+
+ - PID: sequence number of the lost packet
+ - BLP: bitmask of following lost packets (bit i means PID + i + 1 is lost)
+ */
+//====================================================================================================
+bool RtcpPacket::NackParsing(int report_count,
+                             const std::shared_ptr<const ov::Data> &data,
+                             RtcpNack &nack)
+{
+    if(report_count != RTCP_RTPFB_FMT_NACK || data->GetLength() < RTCP_FEEDBACK_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    ov::ByteStream stream(data.get());
+
+    stream.Skip(2);
+    uint32_t payload_size = stream.ReadBE16() * 4;
+
+    if(payload_size + RTCP_HEADER_SIZE < RTCP_FEEDBACK_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    nack.sender_ssrc = stream.ReadBE32();
+    nack.media_ssrc = stream.ReadBE32();
+    nack.lost_sequence_numbers.clear();
+
+    // payload_size is already checked by IsRtcpPacket()
+    size_t fci_count = (payload_size + RTCP_HEADER_SIZE - RTCP_FEEDBACK_HEADER_SIZE) / RTCP_NACK_FCI_SIZE;
+
+    for(size_t index = 0; index < fci_count; index++)
+    {
+        uint16_t pid = stream.ReadBE16();
+        uint16_t blp = stream.ReadBE16();
+
+        nack.lost_sequence_numbers.push_back(pid);
+
+        for(int bit = 0; bit < 16; bit++)
+        {
+            if(blp & (1 << bit))
+            {
+                nack.lost_sequence_numbers.push_back(static_cast<uint16_t>(pid + bit + 1));
+            }
+        }
+    }
+
+    return (nack.lost_sequence_numbers.empty() == false);
+}
+
+//====================================================================================================
+// Transport-wide CC feedback Parsing
+/*
+ *  ********** RTPFB: Transport-wide CC (draft-holmer-rmcat-transport-wide-cc-extensions-01) **********
+ 0                   1                   2                   3
+ 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|V=2|P|  FMT=15 |    PT=205     |           length              |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|                     SSRC of packet sender                     |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|                      SSRC of media source                     |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|      base sequence number     |      packet status count      |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|                 reference time                | fb pkt. count |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|          packet chunk         |         packet chunk          |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+:                              ...                              :
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+|         recv delta            |  recv delta   | zero padding  |
++-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+ - Run length chunk:    |T=0| S(2) | Run Length(13) |
+ - Status vector chunk: |T=1| S(1) | Symbols(14) |, S=0: 14 symbols of 1 bit, S=1: 7 symbols of 2 bits
+ - Symbol: 0 = not received, 1 = received (small delta, 1 byte), 2 = received (large delta, 2 bytes signed)
+ - Recv delta: multiples of 250us from the previous received packet (the first one is from the reference time)
+ */
+//====================================================================================================
+bool RtcpPacket::TransportCcParsing(int report_count,
+                                    const std::shared_ptr<const ov::Data> &data,
+                                    RtcpTransportCc &transport_cc)
+{
+    if(report_count != RTCP_RTPFB_FMT_TRANSPORT_CC || data->GetLength() < RTCP_TRANSPORT_CC_MIN_SIZE)
+    {
+        return false;
+    }
+
+    ov::ByteStream stream(data.get());
+
+    stream.Skip(2);
+    uint32_t payload_size = stream.ReadBE16() * 4;
+
+    if(payload_size + RTCP_HEADER_SIZE < RTCP_TRANSPORT_CC_MIN_SIZE || payload_size + RTCP_HEADER_SIZE > data->GetLength())
+    {
+        return false;
+    }
+
+    transport_cc.sender_ssrc = stream.ReadBE32();
+    transport_cc.media_ssrc = stream.ReadBE32();
+    transport_cc.base_sequence_number = stream.ReadBE16();
+    transport_cc.packet_status_count = stream.ReadBE16();
+
+    uint32_t reference_time = (static_cast<uint32_t>(stream.Read8()) << 16);
+    reference_time |= stream.ReadBE16();
+    // Sign extension of 24 bits
+    int32_t signed_reference_time = (reference_time & 0x800000) ? static_cast<int32_t>(reference_time | 0xFF000000) : static_cast<int32_t>(reference_time);
+
+    transport_cc.reference_time_us = static_cast<int64_t>(signed_reference_time) * 64 * 1000;
+    transport_cc.feedback_count = stream.Read8();
+    transport_cc.packets.clear();
+
+    size_t remained = payload_size + RTCP_HEADER_SIZE - RTCP_TRANSPORT_CC_MIN_SIZE;
+    std::vector<uint8_t> symbols;
+
+    symbols.reserve(transport_cc.packet_status_count);
+
+    // Packet status chunks
+    while(symbols.size() < transport_cc.packet_status_count)
+    {
+        if(remained < 2)
+        {
+            return false;
+        }
+
+        uint16_t chunk = stream.ReadBE16();
+        remained -= 2;
+
+        if((chunk & 0x8000) == 0)
+        {
+            // Run length chunk
+            uint8_t symbol = static_cast<uint8_t>((chunk >> 13) & 0x03);
+            size_t run_length = chunk & 0x1FFF;
+
+            for(size_t index = 0; (index < run_length) && (symbols.size() < transport_cc.packet_status_count); index++)
+            {
+                symbols.push_back(symbol);
+            }
+        }
+        else if((chunk & 0x4000) == 0)
+        {
+            // Status vector chunk (1 bit symbols)
+            for(int bit = 13; (bit >= 0) && (symbols.size() < transport_cc.packet_status_count); bit--)
+            {
+                symbols.push_back(static_cast<uint8_t>((chunk >> bit) & 0x01));
+            }
+        }
+        else
+        {
+            // Status vector chunk (2 bits symbols)
+            for(int bit = 12; (bit >= 0) && (symbols.size() < transport_cc.packet_status_count); bit -= 2)
+            {
+                symbols.push_back(static_cast<uint8_t>((chunk >> bit) & 0x03));
+            }
+        }
+    }
+
+    // Receive deltas
+    int64_t receive_time_us = transport_cc.reference_time_us;
+    uint16_t sequence_number = transport_cc.base_sequence_number;
+
+    for(auto symbol : symbols)
+    {
+        RtcpTransportCc::PacketStatus status;
+
+        status.sequence_number = sequence_number++;
+
+        if(symbol == 1)
+        {
+            if(remained < 1)
+            {
+                return false;
+            }
+
+            receive_time_us += static_cast<int64_t>(stream.Read8()) * 250;
+            remained -= 1;
+
+            status.received = true;
+        }
+        else if(symbol == 2)
+        {
+            if(remained < 2)
+            {
+                return false;
+            }
+
+            receive_time_us += static_cast<int64_t>(static_cast<int16_t>(stream.ReadBE16())) * 250;
+            remained -= 2;
+
+            status.received = true;
+        }
+
+        status.receive_time_us = status.received ? receive_time_us : 0;
+        transport_cc.packets.push_back(status);
+    }
+
+    return (transport_cc.packets.empty() == false);
+}
+
+//====================================================================================================
+// REMB packet Parsing
+// - The layout is described at the top of this file (draft-alvestrand-rmcat-remb)
+// - BR Mantissa(18 bits) << BR Exp(6 bits) is the estimated max bitrate of all SSRCs of the feedback
+//====================================================================================================
+bool RtcpPacket::RembParsing(int report_count,
+                             const std::shared_ptr<const ov::Data> &data,
+                             RtcpRemb &remb)
+{
+    if(report_count != RTCP_PSFB_FMT_AFB || data->GetLength() < RTCP_REMB_MIN_SIZE)
+    {
+        return false;
+    }
+
+    ov::ByteStream stream(data.get());
+
+    stream.Skip(2);
+    uint32_t payload_size = stream.ReadBE16() * 4;
+
+    if(payload_size + RTCP_HEADER_SIZE < RTCP_REMB_MIN_SIZE)
+    {
+        return false;
+    }
+
+    remb.sender_ssrc = stream.ReadBE32();
+    // SSRC of media source (always 0)
+    stream.Skip(4);
+
+    if(stream.ReadBE32() != (('R' << 24) | ('E' << 16) | ('M' << 8) | 'B'))
+    {
+        // Another application layer feedback
+        return false;
+    }
+
+    // Num SSRC
+    stream.Skip(1);
+
+    uint8_t exp_mantissa = stream.Read8();
+    uint16_t mantissa = stream.ReadBE16();
+
+    remb.bitrate = ((static_cast<uint64_t>(exp_mantissa & 0x03) << 16) | mantissa) << (exp_mantissa >> 2);
+
+    return true;
+}
+
+//====================================================================================================
+// PLI/FIR Parsing
+// - PLI: feedback header only (the key frame of SSRC of media source)
+// - FIR: SSRC of media source is not used, FCI entries of SSRC(4) + Seq nr.(1) + Reserved(3)
+//====================================================================================================
+bool RtcpPacket::KeyFrameRequestParsing(int report_count,
+                                        const std::shared_ptr<const ov::Data> &data,
+                                        std::vector<uint32_t> &media_ssrcs)
+{
+    if((report_count != RTCP_PSFB_FMT_PLI && report_count != RTCP_PSFB_FMT_FIR) || data->GetLength() < RTCP_FEEDBACK_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    ov::ByteStream stream(data.get());
+
+    stream.Skip(2);
+    uint32_t packet_size = stream.ReadBE16() * 4 + RTCP_HEADER_SIZE;
+
+    if(packet_size < RTCP_FEEDBACK_HEADER_SIZE || packet_size > data->GetLength())
+    {
+        return false;
+    }
+
+    // SSRC of packet sender
+    stream.Skip(4);
+    uint32_t media_ssrc = stream.ReadBE32();
+
+    if(report_count == RTCP_PSFB_FMT_PLI)
+    {
+        media_ssrcs.push_back(media_ssrc);
+        return true;
+    }
+
+    for(uint32_t offset = RTCP_FEEDBACK_HEADER_SIZE; offset + RTCP_FIR_FCI_SIZE <= packet_size; offset += RTCP_FIR_FCI_SIZE)
+    {
+        media_ssrcs.push_back(stream.ReadBE32());
+        stream.Skip(4);
+    }
+
+    return media_ssrcs.empty() == false;
+}
+
 //====================================================================================================
 // SR type packet Make
 /*
@@ -265,6 +584,184 @@ std::shared_ptr<ov::Data> RtcpPacket::MakeSrPacket(uint32_t ssrc)
     return sr_packet;
 }
 
+void RtcpPacket::MakeSrTemplate(int64_t time, RtcpSrTemplate &sr_template)
+{
+    uint32_t msw = 0;
+    uint32_t lsw = 0;
+
+    GetNtpTime(msw, lsw);
+
+    auto packet = sr_template.packet;
+
+    ::memset(packet, 0, RTCP_SR_PACKET_SIZE);
+
+    packet[0] = (RTCP_HEADER_VERSION) << 6; // version, RC 0
+    packet[1] = static_cast<uint8_t>(RtcpPacketType::SR);
+    ov::StoreBE<uint16_t>(&packet[2], DEFAULT_SR_LENGTH);
+    ov::StoreBE<uint32_t>(&packet[8], msw);
+    ov::StoreBE<uint32_t>(&packet[12], lsw);
+
+    sr_template.time = time;
+}
+
+void RtcpPacket::PatchSrPacket(uint8_t *packet, uint32_t ssrc, uint32_t rtp_timestamp, uint32_t packet_count, uint32_t octet_count)
+{
+    ov::StoreBE<uint32_t>(&packet[4], ssrc);
+    ov::StoreBE<uint32_t>(&packet[16], rtp_timestamp);
+    ov::StoreBE<uint32_t>(&packet[20], packet_count);
+    ov::StoreBE<uint32_t>(&packet[24], octet_count);
+}
+
+//====================================================================================================
+// APP type packet Make
+/*
+        0                   1                   2                   3
+        0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+       |V=2|P| subtype |   PT=APP=204  |             length            |
+       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+       |                           SSRC/CSRC                           |
+       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+       |                          name (ASCII)                         |
+       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+       |                   application-dependent data                ...
+       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ */
+//====================================================================================================
+std::shared_ptr<ov::Data> RtcpPacket::MakeAppPacket(uint32_t ssrc, uint8_t subtype, const char *name, const void *data, size_t length)
+{
+    if ((length % 4) != 0)
+    {
+        return nullptr;
+    }
+
+    auto app_packet = std::make_shared<ov::Data>(DEFAULT_MAX_PACKET_SIZE);
+
+    ov::ByteStream stream(app_packet.get());
+
+    stream.Write8(static_cast<uint8_t>((RTCP_HEADER_VERSION << 6) | (subtype & RTCP_MAX_BLOCK_COUNT)));
+    stream.Write8(static_cast<uint8_t>(RtcpPacketType::APP));
+
+    // length (32 bit words - 1): SSRC(4) name(4) data
+    stream.WriteBE16(static_cast<uint16_t>((8 + length) / 4));
+    stream.WriteBE32(ssrc);
+    stream.Write(name, 4);
+    stream.Write(data, length);
+
+    return app_packet;
+}
+
+//====================================================================================================
+// RR type packet Make
+// - see the format of RR above
+//====================================================================================================
+std::shared_ptr<ov::Data> RtcpPacket::MakeRrPacket(uint32_t ssrc, const std::vector<RtcpReceiverReport> &reports)
+{
+    size_t report_count = std::min(reports.size(), static_cast<size_t>(RTCP_MAX_BLOCK_COUNT));
+
+    auto rr_packet = std::make_shared<ov::Data>(RTCP_HEADER_SIZE + 4 + (RTCP_REPORT_BLOCK_LENGTH * report_count));
+
+    ov::ByteStream stream(rr_packet.get());
+
+    stream.Write8(static_cast<uint8_t>((RTCP_HEADER_VERSION << 6) | report_count));
+    stream.Write8(static_cast<uint8_t>(RtcpPacketType::RR));
+
+    // length (32 bit words - 1): SSRC(4) report blocks
+    stream.WriteBE16(static_cast<uint16_t>((4 + (RTCP_REPORT_BLOCK_LENGTH * report_count)) / 4));
+    stream.WriteBE32(ssrc);
+
+    for(size_t index = 0; index < report_count; index++)
+    {
+        auto &report = reports[index];
+        // 24 bits signed
+        int32_t packet_lost = std::max(std::min(report.packet_lost, 0x7FFFFF), -0x800000);
+
+        stream.WriteBE32(report.ssrc_1);
+        stream.Write8(report.fraction_lost);
+        stream.Write8(static_cast<uint8_t>((packet_lost >> 16) & 0xFF));
+        stream.Write8(static_cast<uint8_t>((packet_lost >> 8) & 0xFF));
+        stream.Write8(static_cast<uint8_t>(packet_lost & 0xFF));
+        stream.WriteBE16(report.sequence_number_cycle);
+        stream.WriteBE16(report.highest_sequence_number);
+        stream.WriteBE32(report.jitter);
+        stream.WriteBE32(report.lsr);
+        stream.WriteBE32(report.dlsr);
+    }
+
+    return rr_packet;
+}
+
+//====================================================================================================
+// Generic NACK packet Make
+// - see the format of NACK above
+//====================================================================================================
+std::shared_ptr<ov::Data> RtcpPacket::MakeNackPacket(uint32_t sender_ssrc, uint32_t media_ssrc, const std::vector<uint16_t> &sequence_numbers)
+{
+    if(sequence_numbers.empty())
+    {
+        return nullptr;
+    }
+
+    // PID, BLP
+    std::vector<std::pair<uint16_t, uint16_t>> fci_list;
+
+    for(auto sequence_number : sequence_numbers)
+    {
+        if(fci_list.empty() == false)
+        {
+            auto &fci = fci_list.back();
+            auto distance = static_cast<uint16_t>(sequence_number - fci.first);
+
+            if((distance >= 1) && (distance <= 16))
+            {
+                fci.second |= static_cast<uint16_t>(1 << (distance - 1));
+                continue;
+            }
+        }
+
+        fci_list.emplace_back(sequence_number, 0);
+    }
+
+    auto nack_packet = std::make_shared<ov::Data>(RTCP_FEEDBACK_HEADER_SIZE + (RTCP_NACK_FCI_SIZE * fci_list.size()));
+
+    ov::ByteStream stream(nack_packet.get());
+
+    stream.Write8(static_cast<uint8_t>((RTCP_HEADER_VERSION << 6) | RTCP_RTPFB_FMT_NACK));
+    stream.Write8(static_cast<uint8_t>(RtcpPacketType::RTPFB));
+
+    // length (32 bit words - 1): SSRC(4) media SSRC(4) FCI
+    stream.WriteBE16(static_cast<uint16_t>((8 + (RTCP_NACK_FCI_SIZE * fci_list.size())) / 4));
+    stream.WriteBE32(sender_ssrc);
+    stream.WriteBE32(media_ssrc);
+
+    for(auto &fci : fci_list)
+    {
+        stream.WriteBE16(fci.first);
+        stream.WriteBE16(fci.second);
+    }
+
+    return nack_packet;
+}
+
+//====================================================================================================
+// PLI packet Make
+// - PSFB(FMT=1) without FCI (RFC 4585 6.3.1)
+//====================================================================================================
+std::shared_ptr<ov::Data> RtcpPacket::MakePliPacket(uint32_t sender_ssrc, uint32_t media_ssrc)
+{
+    auto pli_packet = std::make_shared<ov::Data>(RTCP_FEEDBACK_HEADER_SIZE);
+
+    ov::ByteStream stream(pli_packet.get());
+
+    stream.Write8(static_cast<uint8_t>((RTCP_HEADER_VERSION << 6) | RTCP_PSFB_FMT_PLI));
+    stream.Write8(static_cast<uint8_t>(RtcpPacketType::PSFB));
+    stream.WriteBE16(2);
+    stream.WriteBE32(sender_ssrc);
+    stream.WriteBE32(media_ssrc);
+
+    return pli_packet;
+}
+
 #define GETTIMEOFDAY_TO_NTP_OFFSET 2208988800 //  Number of seconds between 1-Jan-1900 and 1-Jan-1970
 
 void RtcpPacket::GetNtpTime(uint32_t &msw, uint32_t &lsw)
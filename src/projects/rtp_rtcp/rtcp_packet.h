@@ -13,6 +13,7 @@
 #define RTCP_HEADER_SIZE            (4)
 #define RTCP_REPORT_BLOCK_LENGTH    (24)
 #define RTCP_MAX_BLOCK_COUNT        (0x1F)
+#define RTCP_SR_PACKET_SIZE         (28)    // header + SSRC(4) NTP(8) RTP timestamp(4) packet count(4) octet count(4)
 
 // packet type
 enum class RtcpPacketType
@@ -22,8 +23,23 @@ enum class RtcpPacketType
     SDES = 202, // Source Description message
     BYE = 203,  // Bye message
     APP = 204,  // Application specfic RTCP
+    RTPFB = 205,    // Transport layer feedback message
+    PSFB = 206,     // Payload-specific feedback message
 };
 
+// RTPFB feedback message type
+#define RTCP_RTPFB_FMT_NACK         (1)     // Generic NACK
+#define RTCP_FEEDBACK_HEADER_SIZE   (12)    // header + SSRC of packet sender + SSRC of media source
+#define RTCP_NACK_FCI_SIZE          (4)     // PID(2) + BLP(2)
+#define RTCP_RTPFB_FMT_TRANSPORT_CC (15)    // Transport-wide congestion control feedback
+#define RTCP_TRANSPORT_CC_MIN_SIZE  (20)    // feedback header + base seq(2) + status count(2) + reference time(3) + fb count(1)
+// PSFB feedback message type
+#define RTCP_PSFB_FMT_PLI           (1)     // Picture Loss Indication
+#define RTCP_PSFB_FMT_FIR           (4)     // Full Intra Request
+#define RTCP_FIR_FCI_SIZE           (8)     // SSRC(4) + Seq nr.(1) + Reserved(3)
+#define RTCP_PSFB_FMT_AFB           (15)    // Application layer feedback (REMB)
+#define RTCP_REMB_MIN_SIZE          (20)    // feedback header + 'REMB'(4) + Num SSRC(1) + BR Exp/Mantissa(3)
+
 struct RtcpReceiverReport
 {
     time_t create_time = time(nullptr);
@@ -42,6 +58,45 @@ struct RtcpReceiverReport
     double rtt = 0; // (Round Trip Time) calculation form rr packet
 };
 
+// SR which is made once per report interval and shared by the sessions of a stream,
+// each session copies the packet and patches its SSRC, RTP timestamp and counters (see RtcpPacket::PatchSrPacket())
+struct RtcpSrTemplate
+{
+    int64_t time = 0;                       // ms (monotonic) when the NTP timestamp is taken
+    uint8_t packet[RTCP_SR_PACKET_SIZE] = { 0 };
+};
+
+struct RtcpNack
+{
+    uint32_t sender_ssrc = 0;               // SSRC of packet sender
+    uint32_t media_ssrc = 0;                // SSRC of media source
+    std::vector<uint16_t> lost_sequence_numbers;
+};
+
+struct RtcpTransportCc
+{
+    struct PacketStatus
+    {
+        uint16_t sequence_number = 0;       // Transport-wide sequence number
+        bool received = false;
+        int64_t receive_time_us = 0;        // Arrival time (reference time + deltas) if received
+    };
+
+    uint32_t sender_ssrc = 0;               // SSRC of packet sender
+    uint32_t media_ssrc = 0;                // SSRC of media source
+    uint16_t base_sequence_number = 0;
+    uint16_t packet_status_count = 0;
+    int64_t reference_time_us = 0;          // 24 bits signed, multiples of 64ms
+    uint8_t feedback_count = 0;
+    std::vector<PacketStatus> packets;
+};
+
+struct RtcpRemb
+{
+    uint32_t sender_ssrc = 0;               // SSRC of packet sender
+    uint64_t bitrate = 0;                   // Estimated max bitrate (bps)
+};
+
 //====================================================================================================
 // RtcpPacket
 //====================================================================================================
@@ -65,7 +120,39 @@ public :
                             const std::shared_ptr<const ov::Data> &data,
                             std::vector<std::shared_ptr<RtcpReceiverReport>> &receiver_reports);
 
+    // report_count is FMT in case of the feedback message
+    static bool NackParsing(int report_count,
+                            const std::shared_ptr<const ov::Data> &data,
+                            RtcpNack &nack);
+
+    // report_count is FMT in case of the feedback message
+    static bool TransportCcParsing(int report_count,
+                                   const std::shared_ptr<const ov::Data> &data,
+                                   RtcpTransportCc &transport_cc);
+
+    // report_count is FMT in case of the feedback message
+    static bool RembParsing(int report_count,
+                            const std::shared_ptr<const ov::Data> &data,
+                            RtcpRemb &remb);
+
+    // PLI or FIR (report_count is FMT), media_ssrcs: the SSRCs which the key frame is requested for
+    static bool KeyFrameRequestParsing(int report_count,
+                                       const std::shared_ptr<const ov::Data> &data,
+                                       std::vector<uint32_t> &media_ssrcs);
+
     static std::shared_ptr<ov::Data> MakeSrPacket(uint32_t ssrc);
+    // The SSRC and the counters of the template are 0
+    static void MakeSrTemplate(int64_t time, RtcpSrTemplate &sr_template);
+    // packet: a copy of RtcpSrTemplate::packet
+    static void PatchSrPacket(uint8_t *packet, uint32_t ssrc, uint32_t rtp_timestamp, uint32_t packet_count, uint32_t octet_count);
+    // name: 4 ASCII characters, the length of data must be a multiple of 4
+    static std::shared_ptr<ov::Data> MakeAppPacket(uint32_t ssrc, uint8_t subtype, const char *name, const void *data, size_t length);
+
+    // Receiver report of the received sources (ssrc_1 is the source of the block, at most RTCP_MAX_BLOCK_COUNT blocks)
+    static std::shared_ptr<ov::Data> MakeRrPacket(uint32_t ssrc, const std::vector<RtcpReceiverReport> &reports);
+    // Generic NACK of the lost packets, the following numbers (within 16) are packed into the BLP of a FCI
+    static std::shared_ptr<ov::Data> MakeNackPacket(uint32_t sender_ssrc, uint32_t media_ssrc, const std::vector<uint16_t> &sequence_numbers);
+    static std::shared_ptr<ov::Data> MakePliPacket(uint32_t sender_ssrc, uint32_t media_ssrc);
 
     static double DelayCalculation(uint32_t lsr, uint32_t dlsr);
 private :
@@ -0,0 +1,97 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtp_depacketizer.h"
+#include "rtp_depacketizer_h264.h"
+#include "rtp_depacketizer_vp8.h"
+#include "rtp_packet.h"
+
+#include <base/ovlibrary/byte_io.h>
+
+#define OV_LOG_TAG "RtpDepacketizer"
+
+bool RtpReceivedPacket::Parse(const std::shared_ptr<const ov::Data> &packet)
+{
+	auto buffer = packet->GetDataAs<uint8_t>();
+	size_t length = packet->GetLength();
+
+	if((length < FIXED_HEADER_SIZE) || ((buffer[0] >> 6) != RTP_VERSION))
+	{
+		return false;
+	}
+
+	bool has_padding = (buffer[0] & 0x20) != 0;
+	bool has_extension = (buffer[0] & 0x10) != 0;
+	size_t header_size = FIXED_HEADER_SIZE + (buffer[0] & 0x0F) * 4;
+
+	if(has_extension)
+	{
+		if(header_size + 4 > length)
+		{
+			return false;
+		}
+
+		// profile(2) + length in 32 bits(2)
+		header_size += 4 + ByteReader<uint16_t>::ReadBigEndian(&buffer[header_size + 2]) * 4;
+	}
+
+	size_t padding_size = 0;
+
+	if(has_padding && (length > header_size))
+	{
+		padding_size = buffer[length - 1];
+	}
+
+	if(header_size + padding_size > length)
+	{
+		return false;
+	}
+
+	data = packet;
+	payload_offset = header_size;
+	payload_size = length - header_size - padding_size;
+
+	marker = (buffer[1] & 0x80) != 0;
+	payload_type = buffer[1] & 0x7F;
+	sequence_number = ByteReader<uint16_t>::ReadBigEndian(&buffer[2]);
+	timestamp = ByteReader<uint32_t>::ReadBigEndian(&buffer[4]);
+	ssrc = ByteReader<uint32_t>::ReadBigEndian(&buffer[8]);
+
+	return true;
+}
+
+std::unique_ptr<RtpDepacketizer> RtpDepacketizer::Create(common::MediaCodecId codec_id)
+{
+	switch(codec_id)
+	{
+		case common::MediaCodecId::H264:
+			return std::make_unique<RtpDepacketizerH264>();
+
+		case common::MediaCodecId::Vp8:
+			return std::make_unique<RtpDepacketizerVp8>();
+
+		case common::MediaCodecId::Opus:
+			return std::make_unique<RtpDepacketizerOpus>();
+
+		default:
+			break;
+	}
+
+	return nullptr;
+}
+
+std::shared_ptr<ov::Data> RtpDepacketizerOpus::Depacketize(const std::vector<const RtpReceivedPacket *> &packets, bool &is_key_frame)
+{
+	if((packets.size() != 1) || (packets[0]->payload_size == 0))
+	{
+		return nullptr;
+	}
+
+	is_key_frame = true;
+
+	return std::make_shared<ov::Data>(packets[0]->GetPayload(), packets[0]->payload_size);
+}
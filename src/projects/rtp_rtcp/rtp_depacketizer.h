@@ -0,0 +1,81 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+#include <base/media_route/media_type.h>
+
+#include <memory>
+#include <vector>
+
+// A RTP packet which is received from the peer (the payload refers to the decrypted packet)
+struct RtpReceivedPacket
+{
+	// Parses the fixed header, the CSRCs, the header extension and the padding (false if the packet is invalid)
+	bool Parse(const std::shared_ptr<const ov::Data> &packet);
+
+	const uint8_t *GetPayload() const
+	{
+		return data->GetDataAs<uint8_t>() + payload_offset;
+	}
+
+	std::shared_ptr<const ov::Data> data;
+	size_t payload_offset = 0;
+	size_t payload_size = 0;
+
+	bool marker = false;
+	uint8_t payload_type = 0;
+	uint16_t sequence_number = 0;
+	uint32_t timestamp = 0;
+	uint32_t ssrc = 0;
+
+	// ms (monotonic) when the packet is received
+	int64_t arrival_time = 0;
+};
+
+// Makes the frames from the payloads of the received packets (the reverse of RtpPacketizer)
+//
+// - The packets of a frame are given in the order of the sequence number by RtpJitterBuffer
+// - The frame is in the format which the providers pass to the media router (H.264: Annex-B)
+class RtpDepacketizer
+{
+public:
+	// nullptr if the codec is not supported
+	static std::unique_ptr<RtpDepacketizer> Create(common::MediaCodecId codec_id);
+
+	virtual ~RtpDepacketizer() = default;
+
+	// true if the payload starts a frame (used to resume after the lost packets)
+	virtual bool IsFrameStart(const uint8_t *payload, size_t payload_size) = 0;
+
+	// true if the packet is the last packet of a frame
+	virtual bool IsFrameEnd(const RtpReceivedPacket &packet)
+	{
+		return packet.marker;
+	}
+
+	// nullptr if the payloads are invalid
+	virtual std::shared_ptr<ov::Data> Depacketize(const std::vector<const RtpReceivedPacket *> &packets, bool &is_key_frame) = 0;
+};
+
+// RFC 7587: a packet is a frame
+class RtpDepacketizerOpus : public RtpDepacketizer
+{
+public:
+	bool IsFrameStart(const uint8_t *payload, size_t payload_size) override
+	{
+		return true;
+	}
+
+	bool IsFrameEnd(const RtpReceivedPacket &packet) override
+	{
+		return true;
+	}
+
+	std::shared_ptr<ov::Data> Depacketize(const std::vector<const RtpReceivedPacket *> &packets, bool &is_key_frame) override;
+};
@@ -0,0 +1,152 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtp_depacketizer_h264.h"
+
+#include <base/ovlibrary/byte_io.h>
+
+#define OV_LOG_TAG "RtpDepacketizer"
+
+static const uint8_t kH264StartCode[4] = { 0x00, 0x00, 0x00, 0x01 };
+
+bool RtpDepacketizerH264::IsFrameStart(const uint8_t *payload, size_t payload_size)
+{
+	if(payload_size < 2)
+	{
+		return false;
+	}
+
+	uint8_t nal_type = payload[0] & 0x1F;
+
+	if(nal_type == H264_NAL_TYPE_FU_A)
+	{
+		// Start bit of the FU header
+		return (payload[1] & 0x80) != 0;
+	}
+
+	return (nal_type == H264_NAL_TYPE_STAP_A) || ((nal_type >= 1) && (nal_type <= 23));
+}
+
+void RtpDepacketizerH264::AppendNalUnit(const std::shared_ptr<ov::Data> &frame, const uint8_t *nal, size_t nal_size, bool &is_key_frame)
+{
+	if((nal[0] & 0x1F) == H264_NAL_TYPE_IDR)
+	{
+		is_key_frame = true;
+	}
+
+	frame->Append(kH264StartCode, sizeof(kH264StartCode));
+	frame->Append(nal, nal_size);
+}
+
+std::shared_ptr<ov::Data> RtpDepacketizerH264::Depacketize(const std::vector<const RtpReceivedPacket *> &packets, bool &is_key_frame)
+{
+	size_t frame_size = 0;
+
+	for(auto packet : packets)
+	{
+		// The start codes of the aggregated NAL units are larger than their sizes (2 bytes)
+		frame_size += packet->payload_size * 2;
+	}
+
+	auto frame = std::make_shared<ov::Data>(frame_size);
+	// Whether a FU-A is being assembled
+	bool is_fragmented = false;
+
+	is_key_frame = false;
+
+	for(auto packet : packets)
+	{
+		auto payload = packet->GetPayload();
+		size_t payload_size = packet->payload_size;
+
+		if(payload_size < 1)
+		{
+			return nullptr;
+		}
+
+		uint8_t nal_type = payload[0] & 0x1F;
+
+		if((nal_type >= 1) && (nal_type <= 23))
+		{
+			AppendNalUnit(frame, payload, payload_size, is_key_frame);
+			is_fragmented = false;
+		}
+		else if(nal_type == H264_NAL_TYPE_STAP_A)
+		{
+			// STAP-A NAL HDR(1) + [NALU size(2) + NALU]...
+			size_t offset = 1;
+
+			while(offset + 2 <= payload_size)
+			{
+				size_t nal_size = ByteReader<uint16_t>::ReadBigEndian(&payload[offset]);
+				offset += 2;
+
+				if((nal_size == 0) || (offset + nal_size > payload_size))
+				{
+					logtd("Invalid STAP-A (NALU size: %zu, remained: %zu)", nal_size, payload_size - offset);
+					return nullptr;
+				}
+
+				AppendNalUnit(frame, &payload[offset], nal_size, is_key_frame);
+				offset += nal_size;
+			}
+
+			is_fragmented = false;
+		}
+		else if(nal_type == H264_NAL_TYPE_FU_A)
+		{
+			// FU indicator(1) + FU header(1) + fragment
+			if(payload_size < 2)
+			{
+				return nullptr;
+			}
+
+			uint8_t fu_header = payload[1];
+
+			if((fu_header & 0x80) != 0)
+			{
+				// The NAL header is restored from the F/NRI of the indicator and the type of the FU header
+				uint8_t nal_header = (payload[0] & 0xE0) | (fu_header & 0x1F);
+
+				if((nal_header & 0x1F) == H264_NAL_TYPE_IDR)
+				{
+					is_key_frame = true;
+				}
+
+				frame->Append(kH264StartCode, sizeof(kH264StartCode));
+				frame->Append(&nal_header, 1);
+
+				is_fragmented = true;
+			}
+			else if(is_fragmented == false)
+			{
+				// The start of the fragments is lost
+				logtd("FU-A without the start fragment (seq: %u)", packet->sequence_number);
+				return nullptr;
+			}
+
+			frame->Append(&payload[2], payload_size - 2);
+
+			if((fu_header & 0x40) != 0)
+			{
+				// End bit
+				is_fragmented = false;
+			}
+		}
+		else
+		{
+			logtd("Unsupported NAL unit type of the payload: %u", nal_type);
+		}
+	}
+
+	if(frame->GetLength() == 0)
+	{
+		return nullptr;
+	}
+
+	return frame;
+}
@@ -0,0 +1,29 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "rtp_depacketizer.h"
+
+// NAL unit types of the payload (RFC 6184 5.2)
+#define H264_NAL_TYPE_IDR			5
+#define H264_NAL_TYPE_STAP_A		24
+#define H264_NAL_TYPE_FU_A			28
+
+// Packetization mode 1 (RFC 6184): single NAL unit, STAP-A and FU-A packets
+// - The NAL units are written with the start codes (Annex-B), same as the MPEG-TS of SRT
+// - STAP-B, MTAP and FU-B (interleaved mode) are not supported
+class RtpDepacketizerH264 : public RtpDepacketizer
+{
+public:
+	bool IsFrameStart(const uint8_t *payload, size_t payload_size) override;
+
+	std::shared_ptr<ov::Data> Depacketize(const std::vector<const RtpReceivedPacket *> &packets, bool &is_key_frame) override;
+
+private:
+	static void AppendNalUnit(const std::shared_ptr<ov::Data> &frame, const uint8_t *nal, size_t nal_size, bool &is_key_frame);
+};
@@ -0,0 +1,132 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtp_depacketizer_vp8.h"
+
+#define OV_LOG_TAG "RtpDepacketizer"
+
+//        0 1 2 3 4 5 6 7
+//       +-+-+-+-+-+-+-+-+
+//       |X|R|N|S|R| PID | (REQUIRED)
+//       +-+-+-+-+-+-+-+-+
+//  X:   |I|L|T|K| RSV   | (OPTIONAL)
+//       +-+-+-+-+-+-+-+-+
+//  I:   |M| PictureID   | (OPTIONAL)
+//       +-+-+-+-+-+-+-+-+
+//  M:   | PictureID     | (OPTIONAL, 15 bits)
+//       +-+-+-+-+-+-+-+-+
+//  L:   |   TL0PICIDX   | (OPTIONAL)
+//       +-+-+-+-+-+-+-+-+
+//  T/K: |TID|Y| KEYIDX  | (OPTIONAL)
+//       +-+-+-+-+-+-+-+-+
+size_t RtpDepacketizerVp8::GetDescriptorSize(const uint8_t *payload, size_t payload_size)
+{
+	if(payload_size < 1)
+	{
+		return 0;
+	}
+
+	size_t size = 1;
+
+	if((payload[0] & 0x80) != 0)
+	{
+		if(payload_size < 2)
+		{
+			return 0;
+		}
+
+		uint8_t extension = payload[1];
+		size++;
+
+		if((extension & 0x80) != 0)
+		{
+			// PictureID (the M bit extends it to 15 bits)
+			if(payload_size < size + 1)
+			{
+				return 0;
+			}
+
+			size += ((payload[size] & 0x80) != 0) ? 2 : 1;
+		}
+
+		if((extension & 0x40) != 0)
+		{
+			// TL0PICIDX
+			size++;
+		}
+
+		if((extension & 0x30) != 0)
+		{
+			// TID/Y/KEYIDX
+			size++;
+		}
+	}
+
+	return (size < payload_size) ? size : 0;
+}
+
+bool RtpDepacketizerVp8::IsFrameStart(const uint8_t *payload, size_t payload_size)
+{
+	// S bit and the partition index 0
+	return (payload_size > 0) && ((payload[0] & 0x10) != 0) && ((payload[0] & 0x07) == 0);
+}
+
+bool RtpDepacketizerVp8::GetKeyFrameSize(const uint8_t *frame, size_t frame_size, int32_t &width, int32_t &height)
+{
+	// frame tag(3) + start code(3) + width(2) + height(2)
+	if((frame_size < 10) || ((frame[0] & 0x01) != 0))
+	{
+		return false;
+	}
+
+	if((frame[3] != 0x9D) || (frame[4] != 0x01) || (frame[5] != 0x2A))
+	{
+		return false;
+	}
+
+	// The upper 2 bits are the scaling
+	width = (frame[6] | (frame[7] << 8)) & 0x3FFF;
+	height = (frame[8] | (frame[9] << 8)) & 0x3FFF;
+
+	return (width > 0) && (height > 0);
+}
+
+std::shared_ptr<ov::Data> RtpDepacketizerVp8::Depacketize(const std::vector<const RtpReceivedPacket *> &packets, bool &is_key_frame)
+{
+	size_t frame_size = 0;
+
+	for(auto packet : packets)
+	{
+		frame_size += packet->payload_size;
+	}
+
+	auto frame = std::make_shared<ov::Data>(frame_size);
+
+	for(auto packet : packets)
+	{
+		auto payload = packet->GetPayload();
+		size_t descriptor_size = GetDescriptorSize(payload, packet->payload_size);
+
+		if(descriptor_size == 0)
+		{
+			logtd("Invalid VP8 payload descriptor (seq: %u)", packet->sequence_number);
+			return nullptr;
+		}
+
+		frame->Append(&payload[descriptor_size], packet->payload_size - descriptor_size);
+	}
+
+	if(frame->GetLength() == 0)
+	{
+		return nullptr;
+	}
+
+	// P bit of the frame tag (0: key frame)
+	is_key_frame = (frame->GetDataAs<uint8_t>()[0] & 0x01) == 0;
+
+	return frame;
+}
@@ -0,0 +1,26 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "rtp_depacketizer.h"
+
+// RFC 7741: the payload descriptor is removed, and the partitions are concatenated
+class RtpDepacketizerVp8 : public RtpDepacketizer
+{
+public:
+	bool IsFrameStart(const uint8_t *payload, size_t payload_size) override;
+
+	std::shared_ptr<ov::Data> Depacketize(const std::vector<const RtpReceivedPacket *> &packets, bool &is_key_frame) override;
+
+	// Resolution of the key frame (RFC 6386 9.1), false if the frame is not a key frame
+	static bool GetKeyFrameSize(const uint8_t *frame, size_t frame_size, int32_t &width, int32_t &height);
+
+private:
+	// Size of the payload descriptor (0 if it is invalid)
+	static size_t GetDescriptorSize(const uint8_t *payload, size_t payload_size);
+};
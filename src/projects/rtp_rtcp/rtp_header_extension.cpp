@@ -0,0 +1,164 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtp_header_extension.h"
+#include "rtp_packet.h"
+
+#include <base/ovlibrary/byte_io.h>
+
+#include <algorithm>
+
+#define OV_LOG_TAG "RtpRtcp.Extension"
+
+bool RtpHeaderExtensionMap::Register(RtpHeaderExtensionType type, uint8_t id)
+{
+	if((id == 0) || (id >= 15) || (type >= RtpHeaderExtensionType::NumberOfTypes))
+	{
+		return false;
+	}
+
+	for(size_t index = 0; index < static_cast<size_t>(RtpHeaderExtensionType::NumberOfTypes); index++)
+	{
+		if((_ids[index] == id) && (index != static_cast<size_t>(type)))
+		{
+			logtw("The extension id %u is already used by %s", id, GetUri(static_cast<RtpHeaderExtensionType>(index)));
+			return false;
+		}
+	}
+
+	_ids[static_cast<size_t>(type)] = id;
+	UpdateLayout();
+
+	return true;
+}
+
+bool RtpHeaderExtensionMap::Register(const ov::String &uri, uint8_t id)
+{
+	for(size_t index = 0; index < static_cast<size_t>(RtpHeaderExtensionType::NumberOfTypes); index++)
+	{
+		auto type = static_cast<RtpHeaderExtensionType>(index);
+
+		if(uri == GetUri(type))
+		{
+			return Register(type, id);
+		}
+	}
+
+	return false;
+}
+
+void RtpHeaderExtensionMap::Unregister(RtpHeaderExtensionType type)
+{
+	if(type < RtpHeaderExtensionType::NumberOfTypes)
+	{
+		_ids[static_cast<size_t>(type)] = 0;
+		UpdateLayout();
+	}
+}
+
+void RtpHeaderExtensionMap::SetPlayoutDelay(uint32_t min_delay, uint32_t max_delay)
+{
+	min_delay = std::min<uint32_t>(min_delay, RTP_PLAYOUT_DELAY_MAX_MS);
+	max_delay = std::min<uint32_t>(std::max(max_delay, min_delay), RTP_PLAYOUT_DELAY_MAX_MS);
+
+	_playout_delay_min = static_cast<uint16_t>((min_delay + 9) / 10);
+	_playout_delay_max = static_cast<uint16_t>((max_delay + 9) / 10);
+}
+
+void RtpHeaderExtensionMap::UpdateLayout()
+{
+	// [0xBEDE(2) length(2)] [ID|L(1) data(L+1)]... [padding]
+	size_t offset = RTP_EXTENSION_HEADER_SIZE;
+
+	for(size_t index = 0; index < static_cast<size_t>(RtpHeaderExtensionType::NumberOfTypes); index++)
+	{
+		if(_ids[index] == 0)
+		{
+			_offsets[index] = 0;
+			continue;
+		}
+
+		_offsets[index] = offset;
+		offset += 1 + GetDataSize(static_cast<RtpHeaderExtensionType>(index));
+	}
+
+	_size = (offset == RTP_EXTENSION_HEADER_SIZE) ? 0 : ((offset + 3) / 4 * 4);
+}
+
+void RtpHeaderExtensionMap::Write(uint8_t *buffer) const
+{
+	if(_size == 0)
+	{
+		return;
+	}
+
+	// The padding and the values are 0
+	::memset(buffer, 0, _size);
+
+	ByteWriter<uint16_t>::WriteBigEndian(&buffer[0], ONE_BYTE_EXTENSION_ID);
+	ByteWriter<uint16_t>::WriteBigEndian(&buffer[2], static_cast<uint16_t>((_size - RTP_EXTENSION_HEADER_SIZE) / 4));
+
+	for(size_t index = 0; index < static_cast<size_t>(RtpHeaderExtensionType::NumberOfTypes); index++)
+	{
+		if(_ids[index] == 0)
+		{
+			continue;
+		}
+
+		auto element = &buffer[_offsets[index]];
+		auto type = static_cast<RtpHeaderExtensionType>(index);
+
+		// ID + (length - 1)
+		element[0] = static_cast<uint8_t>((_ids[index] << 4) | (GetDataSize(type) - 1));
+
+		if(type == RtpHeaderExtensionType::PlayoutDelay)
+		{
+			// MIN delay(12) MAX delay(12)
+			element[1] = static_cast<uint8_t>(_playout_delay_min >> 4);
+			element[2] = static_cast<uint8_t>(((_playout_delay_min & 0x0F) << 4) | (_playout_delay_max >> 8));
+			element[3] = static_cast<uint8_t>(_playout_delay_max & 0xFF);
+		}
+	}
+}
+
+const char *RtpHeaderExtensionMap::GetUri(RtpHeaderExtensionType type)
+{
+	switch(type)
+	{
+		case RtpHeaderExtensionType::TransportCc:
+			return RTP_EXTENSION_URI_TRANSPORT_CC;
+		case RtpHeaderExtensionType::AbsSendTime:
+			return RTP_EXTENSION_URI_ABS_SEND_TIME;
+		case RtpHeaderExtensionType::PlayoutDelay:
+			return RTP_EXTENSION_URI_PLAYOUT_DELAY;
+		default:
+			return "";
+	}
+}
+
+size_t RtpHeaderExtensionMap::GetDataSize(RtpHeaderExtensionType type)
+{
+	switch(type)
+	{
+		case RtpHeaderExtensionType::TransportCc:
+			return 2;
+		case RtpHeaderExtensionType::AbsSendTime:
+		case RtpHeaderExtensionType::PlayoutDelay:
+			return 3;
+		default:
+			return 0;
+	}
+}
+
+uint32_t RtpHeaderExtensionMap::MakeAbsSendTime(int64_t time_us)
+{
+	// 6 bits of seconds + 18 bits of fraction
+	uint32_t seconds = static_cast<uint32_t>((time_us / 1000000) & 0x3F);
+	uint32_t fraction = static_cast<uint32_t>(((time_us % 1000000) << 18) / 1000000);
+
+	return (seconds << 18) | fraction;
+}
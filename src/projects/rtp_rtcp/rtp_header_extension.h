@@ -0,0 +1,99 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#define RTP_EXTENSION_URI_TRANSPORT_CC		"http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01"
+#define RTP_EXTENSION_URI_ABS_SEND_TIME		"http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time"
+#define RTP_EXTENSION_URI_PLAYOUT_DELAY		"http://www.webrtc.org/experiments/rtp-hdrext/playout-delay"
+
+// 0xBEDE(2) + length in 32 bits(2)
+#define RTP_EXTENSION_HEADER_SIZE			4
+// Maximum delay of the playout delay extension (12 bits of 10 ms)
+#define RTP_PLAYOUT_DELAY_MAX_MS			40950
+
+// In the order of the elements in the header extension
+enum class RtpHeaderExtensionType : uint8_t
+{
+	// Transport-wide sequence number (2 bytes), stamped by each session
+	TransportCc = 0,
+	// 6.18 fixed point seconds (3 bytes), stamped by each session when the packet is sent
+	AbsSendTime,
+	// Minimum/maximum delay of the jitter buffer of the receiver (12 + 12 bits, 10 ms), fixed in the template
+	PlayoutDelay,
+
+	NumberOfTypes
+};
+
+// Extensions of the packets (id -> type), negotiated by extmap of the SDP
+//
+// - Only the one-byte header (RFC 8285) is used, so the ids are 1~14
+// - The elements are laid out in the order of RtpHeaderExtensionType, so the offset of each element is fixed:
+//   the packetizer writes the block to the header template once,
+//   and the sessions stamp the values (or rewrite the ids) with a few stores at GetOffset()
+class RtpHeaderExtensionMap
+{
+public:
+	// false if the id is invalid or used by another type
+	bool Register(RtpHeaderExtensionType type, uint8_t id);
+	// false if the uri is not supported
+	bool Register(const ov::String &uri, uint8_t id);
+	void Unregister(RtpHeaderExtensionType type);
+
+	// 0 if not registered
+	uint8_t GetId(RtpHeaderExtensionType type) const
+	{
+		return _ids[static_cast<size_t>(type)];
+	}
+
+	bool IsRegistered(RtpHeaderExtensionType type) const
+	{
+		return GetId(type) != 0;
+	}
+
+	bool IsEmpty() const
+	{
+		return _size == 0;
+	}
+
+	// Offset of the element (the [ID|L] byte) from the start of the header extension (0xBEDE), 0 if not registered
+	size_t GetOffset(RtpHeaderExtensionType type) const
+	{
+		return _offsets[static_cast<size_t>(type)];
+	}
+
+	// Bytes of the header extension (a multiple of 4), 0 if no extension is registered
+	size_t GetSize() const
+	{
+		return _size;
+	}
+
+	// The value of the playout delay extension (ms, rounded up to 10 ms)
+	void SetPlayoutDelay(uint32_t min_delay, uint32_t max_delay);
+
+	// Writes the header extension to buffer (GetSize() bytes), the values are 0 except the playout delay
+	void Write(uint8_t *buffer) const;
+
+	static const char *GetUri(RtpHeaderExtensionType type);
+	// Bytes of the data of the element
+	static size_t GetDataSize(RtpHeaderExtensionType type);
+	// 24 bits of abs-send-time from the time (us)
+	static uint32_t MakeAbsSendTime(int64_t time_us);
+
+private:
+	void UpdateLayout();
+
+	uint8_t _ids[static_cast<size_t>(RtpHeaderExtensionType::NumberOfTypes)] = { 0 };
+	size_t _offsets[static_cast<size_t>(RtpHeaderExtensionType::NumberOfTypes)] = { 0 };
+	size_t _size = 0;
+
+	// 10 ms
+	uint16_t _playout_delay_min = 0;
+	uint16_t _playout_delay_max = 0;
+};
@@ -0,0 +1,338 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtp_jitter_buffer.h"
+
+#include <cmath>
+
+#define OV_LOG_TAG "RtpJitterBuffer"
+
+RtpJitterBuffer::RtpJitterBuffer(std::unique_ptr<RtpDepacketizer> depacketizer, uint32_t clock_rate, bool is_video, bool nack_enabled, int64_t max_delay)
+	: _depacketizer(std::move(depacketizer)),
+	  _clock_rate(clock_rate),
+	  _is_video(is_video),
+	  _nack_enabled(nack_enabled),
+	  _max_delay(max_delay),
+	  _wait_key_frame(is_video)
+{
+}
+
+int64_t RtpJitterBuffer::Unwrap(uint16_t sequence_number) const
+{
+	if(_highest_sequence < 0)
+	{
+		return 0x10000 + sequence_number;
+	}
+
+	auto delta = static_cast<int16_t>(sequence_number - static_cast<uint16_t>(_highest_sequence & 0xFFFF));
+
+	return _highest_sequence + delta;
+}
+
+void RtpJitterBuffer::Reset()
+{
+	_packets.clear();
+	_nack_list.clear();
+	_buffered_size = 0;
+
+	_base_sequence = -1;
+	_highest_sequence = -1;
+	_next_sequence = -1;
+	_frame_start_required = true;
+	_wait_key_frame = _is_video;
+	_late_packet_count = 0;
+
+	_received_count = 0;
+	_expected_prior = 0;
+	_received_prior = 0;
+	_has_transit = false;
+}
+
+void RtpJitterBuffer::UpdateJitter(const RtpReceivedPacket &packet, int64_t current_time)
+{
+	// Arrival time in the clock of the RTP timestamp
+	int64_t transit = (current_time * _clock_rate / 1000) - packet.timestamp;
+
+	if(_has_transit)
+	{
+		// The timestamp is wrapped in 32 bits
+		auto delta = static_cast<int32_t>(static_cast<uint32_t>(transit - _last_transit));
+
+		_jitter += (std::abs(static_cast<double>(delta)) - _jitter) / 16.0;
+	}
+
+	_has_transit = true;
+	_last_transit = transit;
+}
+
+bool RtpJitterBuffer::InsertPacket(RtpReceivedPacket &&packet, int64_t current_time)
+{
+	int64_t sequence = Unwrap(packet.sequence_number);
+
+	_statistics.received_packets++;
+
+	if((_next_sequence >= 0) && (sequence < _next_sequence))
+	{
+		_statistics.dropped_packets++;
+
+		if(++_late_packet_count >= RTP_JITTER_BUFFER_MAX_LATE_PACKETS)
+		{
+			logtw("The sequence number of the sender is reset (seq: %u)", packet.sequence_number);
+			Reset();
+		}
+
+		return false;
+	}
+
+	_late_packet_count = 0;
+
+	if(_packets.find(sequence) != _packets.end())
+	{
+		_statistics.dropped_packets++;
+		return false;
+	}
+
+	auto nack = _nack_list.find(sequence);
+
+	if(nack != _nack_list.end())
+	{
+		// Retransmitted by the NACK (the timestamp is not used for the jitter)
+		_statistics.recovered_packets++;
+		_nack_list.erase(nack);
+	}
+	else
+	{
+		if((_highest_sequence >= 0) && (sequence > _highest_sequence + 1))
+		{
+			int64_t missing_count = sequence - _highest_sequence - 1;
+
+			if(_nack_enabled && (missing_count <= RTP_JITTER_BUFFER_MAX_NACK_PACKETS))
+			{
+				for(int64_t missing = _highest_sequence + 1; missing < sequence; missing++)
+				{
+					_nack_list.emplace(missing, NackInfo());
+				}
+			}
+		}
+
+		if(sequence > _highest_sequence)
+		{
+			UpdateJitter(packet, current_time);
+		}
+	}
+
+	if(_base_sequence < 0)
+	{
+		_base_sequence = sequence;
+		_next_sequence = sequence;
+	}
+
+	_highest_sequence = std::max(_highest_sequence, sequence);
+	_received_count++;
+
+	packet.arrival_time = current_time;
+	_buffered_size += packet.data->GetLength();
+	_packets.emplace(sequence, std::move(packet));
+
+	if(_packets.size() > RTP_JITTER_BUFFER_MAX_PACKETS)
+	{
+		// The oldest packets are given up
+		auto first = _packets.begin();
+		auto last = std::next(first);
+
+		_statistics.dropped_packets++;
+		_statistics.lost_packets += first->first - _next_sequence;
+
+		ErasePackets(first, last, first->first + 1);
+		OnFrameLost();
+	}
+
+	return true;
+}
+
+void RtpJitterBuffer::ErasePackets(std::map<int64_t, RtpReceivedPacket>::iterator first, std::map<int64_t, RtpReceivedPacket>::iterator last, int64_t next_sequence)
+{
+	for(auto item = first; item != last; ++item)
+	{
+		_buffered_size -= item->second.data->GetLength();
+	}
+
+	_packets.erase(first, last);
+	_next_sequence = next_sequence;
+
+	// The packets before the next packet are not requested any more
+	_nack_list.erase(_nack_list.begin(), _nack_list.lower_bound(next_sequence));
+}
+
+void RtpJitterBuffer::OnFrameLost()
+{
+	_frame_start_required = true;
+
+	if(_is_video)
+	{
+		// The next frames cannot be decoded without the lost frame
+		_wait_key_frame = true;
+	}
+}
+
+void RtpJitterBuffer::PopFrames(int64_t current_time, std::vector<RtpFrame> &frames)
+{
+	while(_packets.empty() == false)
+	{
+		auto head = _packets.begin();
+
+		if(head->first != _next_sequence)
+		{
+			// The packets before the head are missing
+			if((current_time - head->second.arrival_time) < _max_delay)
+			{
+				break;
+			}
+
+			logtd("%" PRId64 " packets are lost (seq: %u)", head->first - _next_sequence, static_cast<uint16_t>(_next_sequence & 0xFFFF));
+
+			_statistics.lost_packets += head->first - _next_sequence;
+
+			ErasePackets(head, head, head->first);
+			OnFrameLost();
+			continue;
+		}
+
+		if(_frame_start_required)
+		{
+			if(_depacketizer->IsFrameStart(head->second.GetPayload(), head->second.payload_size) == false)
+			{
+				_statistics.dropped_packets++;
+				ErasePackets(head, std::next(head), head->first + 1);
+				continue;
+			}
+
+			_frame_start_required = false;
+		}
+
+		// The packets of the frame (the same timestamp, without a gap)
+		std::vector<const RtpReceivedPacket *> frame_packets;
+		uint32_t timestamp = head->second.timestamp;
+		int64_t sequence = head->first;
+		bool is_complete = false;
+		auto item = head;
+
+		for(; (item != _packets.end()) && (item->first == sequence) && (item->second.timestamp == timestamp); ++item, ++sequence)
+		{
+			frame_packets.push_back(&(item->second));
+
+			if(_depacketizer->IsFrameEnd(item->second))
+			{
+				is_complete = true;
+				++item;
+				++sequence;
+				break;
+			}
+		}
+
+		if((is_complete == false) && (item != _packets.end()) && (item->first == sequence))
+		{
+			// The next frame follows without a gap (the marker is not set by the sender)
+			is_complete = true;
+		}
+
+		if(is_complete == false)
+		{
+			if((current_time - head->second.arrival_time) < _max_delay)
+			{
+				break;
+			}
+
+			_statistics.dropped_packets += frame_packets.size();
+			_statistics.dropped_frames++;
+
+			ErasePackets(head, item, sequence);
+			OnFrameLost();
+			continue;
+		}
+
+		RtpFrame frame;
+
+		frame.timestamp = timestamp;
+		frame.arrival_time = head->second.arrival_time;
+		frame.data = _depacketizer->Depacketize(frame_packets, frame.is_key_frame);
+
+		ErasePackets(head, item, sequence);
+
+		if(frame.data == nullptr)
+		{
+			_statistics.dropped_frames++;
+			OnFrameLost();
+			continue;
+		}
+
+		if(_wait_key_frame)
+		{
+			if(frame.is_key_frame == false)
+			{
+				_statistics.dropped_frames++;
+				continue;
+			}
+
+			_wait_key_frame = false;
+		}
+
+		frames.push_back(std::move(frame));
+	}
+}
+
+void RtpJitterBuffer::GetNackList(int64_t current_time, std::vector<uint16_t> &sequence_numbers)
+{
+	for(auto item = _nack_list.begin(); item != _nack_list.end();)
+	{
+		auto &nack = item->second;
+
+		if(nack.retries >= RTP_JITTER_BUFFER_MAX_NACK_RETRIES)
+		{
+			// It is released as lost by PopFrames()
+			item = _nack_list.erase(item);
+			continue;
+		}
+
+		if((nack.sent_time == 0) || ((current_time - nack.sent_time) >= RTP_JITTER_BUFFER_NACK_INTERVAL_MS))
+		{
+			sequence_numbers.push_back(static_cast<uint16_t>(item->first & 0xFFFF));
+
+			nack.sent_time = current_time;
+			nack.retries++;
+
+			_statistics.nack_requests++;
+		}
+
+		++item;
+	}
+}
+
+void RtpJitterBuffer::MakeReceiverReport(uint32_t ssrc, RtcpReceiverReport &report)
+{
+	report.ssrc_1 = ssrc;
+
+	if(_base_sequence < 0)
+	{
+		return;
+	}
+
+	int64_t expected = _highest_sequence - _base_sequence + 1;
+	int64_t expected_interval = expected - _expected_prior;
+	int64_t received_interval = static_cast<int64_t>(_received_count - _received_prior);
+	int64_t lost_interval = expected_interval - received_interval;
+
+	_expected_prior = expected;
+	_received_prior = _received_count;
+
+	report.fraction_lost = ((expected_interval == 0) || (lost_interval <= 0)) ? 0 : static_cast<uint8_t>(std::min<int64_t>((lost_interval << 8) / expected_interval, 255));
+	report.packet_lost = static_cast<int32_t>(expected - static_cast<int64_t>(_received_count));
+	// The first cycle is 1 (see Unwrap())
+	report.sequence_number_cycle = static_cast<uint16_t>((_highest_sequence >> 16) - 1);
+	report.highest_sequence_number = static_cast<uint16_t>(_highest_sequence & 0xFFFF);
+	report.jitter = static_cast<uint32_t>(_jitter);
+}
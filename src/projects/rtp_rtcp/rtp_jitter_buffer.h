@@ -0,0 +1,135 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "rtp_depacketizer.h"
+#include "rtcp_packet.h"
+
+#include <map>
+
+// Time (ms) which the packets wait for the missing packets before them, the frames are released without them after it
+#define RTP_JITTER_BUFFER_DEFAULT_MAX_DELAY_MS		(150)
+// Interval (ms) of the NACK of a packet, and the number of the NACKs before it is given up
+#define RTP_JITTER_BUFFER_NACK_INTERVAL_MS			(30)
+#define RTP_JITTER_BUFFER_MAX_NACK_RETRIES			(5)
+// A larger gap is not requested by NACK (the stream is resumed from the next key frame)
+#define RTP_JITTER_BUFFER_MAX_NACK_PACKETS			(300)
+// The oldest frame is dropped if the buffer has more packets
+#define RTP_JITTER_BUFFER_MAX_PACKETS				(2000)
+// The sequence number of the sender is reset if the packets are late continuously
+#define RTP_JITTER_BUFFER_MAX_LATE_PACKETS			(100)
+
+// A frame which is made from the packets of a timestamp
+struct RtpFrame
+{
+	uint32_t timestamp = 0;
+	bool is_key_frame = false;
+	std::shared_ptr<ov::Data> data;
+	// ms (monotonic) when the first packet of the frame is received
+	int64_t arrival_time = 0;
+};
+
+struct RtpJitterBufferStatistics
+{
+	uint64_t received_packets = 0;
+	// Packets which are not recovered in time
+	uint64_t lost_packets = 0;
+	// Packets which are requested by NACK (including the retries)
+	uint64_t nack_requests = 0;
+	uint64_t recovered_packets = 0;
+	// Duplicated or late packets, and the packets of the dropped frames
+	uint64_t dropped_packets = 0;
+	// Incomplete frames, or the video frames before a key frame
+	uint64_t dropped_frames = 0;
+};
+
+// Reorders the packets of a SSRC, and releases the frames in the order of the sequence number
+//
+// - A missing packet is requested by NACK, and the frames after it wait for at most max_delay
+// - The video is released from a key frame (at the start, and after a frame is lost)
+// - Not thread-safe (RtpReceiver guards it)
+class RtpJitterBuffer
+{
+public:
+	RtpJitterBuffer(std::unique_ptr<RtpDepacketizer> depacketizer, uint32_t clock_rate, bool is_video, bool nack_enabled, int64_t max_delay);
+
+	// false if the packet is dropped (current_time: ms)
+	bool InsertPacket(RtpReceivedPacket &&packet, int64_t current_time);
+	// Appends the frames which can be released
+	void PopFrames(int64_t current_time, std::vector<RtpFrame> &frames);
+
+	// Sequence numbers of the packets to be requested now
+	void GetNackList(int64_t current_time, std::vector<uint16_t> &sequence_numbers);
+	// true while the video waits for a key frame (the sender must be asked by PLI)
+	bool IsKeyFrameRequired() const
+	{
+		return _wait_key_frame;
+	}
+
+	// Report block of the SSRC since the previous report (RFC 3550 6.4.1)
+	void MakeReceiverReport(uint32_t ssrc, RtcpReceiverReport &report);
+
+	const RtpJitterBufferStatistics &GetStatistics() const
+	{
+		return _statistics;
+	}
+
+	// Bytes of the packets in the buffer
+	size_t GetBufferedSize() const
+	{
+		return _buffered_size;
+	}
+
+private:
+	struct NackInfo
+	{
+		// ms when the NACK is sent last (0: not sent)
+		int64_t sent_time = 0;
+		uint32_t retries = 0;
+	};
+
+	// Extended sequence number (the first packet is 65536 + its sequence number, so it is not negative by the reordering)
+	int64_t Unwrap(uint16_t sequence_number) const;
+	void Reset();
+	void UpdateJitter(const RtpReceivedPacket &packet, int64_t current_time);
+	// Removes the packets in [first, last), and the next packet is last
+	void ErasePackets(std::map<int64_t, RtpReceivedPacket>::iterator first, std::map<int64_t, RtpReceivedPacket>::iterator last, int64_t next_sequence);
+	// The frame is lost, so the packets are waited from the start of a frame (and a key frame for video)
+	void OnFrameLost();
+
+	std::unique_ptr<RtpDepacketizer> _depacketizer;
+	uint32_t _clock_rate;
+	bool _is_video;
+	bool _nack_enabled;
+	int64_t _max_delay;
+
+	// key: extended sequence number
+	std::map<int64_t, RtpReceivedPacket> _packets;
+	std::map<int64_t, NackInfo> _nack_list;
+	size_t _buffered_size = 0;
+
+	// -1 until the first packet is received
+	int64_t _base_sequence = -1;
+	int64_t _highest_sequence = -1;
+	// Next sequence number which is released
+	int64_t _next_sequence = -1;
+	// The next frame is released from a packet which starts a frame
+	bool _frame_start_required = true;
+	bool _wait_key_frame;
+	uint32_t _late_packet_count = 0;
+
+	// RTCP RR (RFC 3550 A.3, A.8)
+	uint64_t _received_count = 0;
+	int64_t _expected_prior = 0;
+	uint64_t _received_prior = 0;
+	bool _has_transit = false;
+	int64_t _last_transit = 0;
+	double _jitter = 0.0;
+
+	RtpJitterBufferStatistics _statistics;
+};
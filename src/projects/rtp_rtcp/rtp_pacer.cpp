@@ -0,0 +1,105 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtp_pacer.h"
+
+#include <algorithm>
+
+#define OV_LOG_TAG "RtpRtcp.Pacer"
+
+void RtpPacer::SetEstimatedBitrate(uint64_t estimated_bitrate)
+{
+	if(estimated_bitrate == 0)
+	{
+		_pacing_rate = RTP_PACER_DEFAULT_RATE;
+	}
+	else
+	{
+		_pacing_rate = std::max<uint64_t>(static_cast<uint64_t>(estimated_bitrate * RTP_PACER_PACING_FACTOR), RTP_PACER_MIN_RATE);
+	}
+
+	if(_max_rate > 0)
+	{
+		_pacing_rate = std::min(_pacing_rate, std::max<uint64_t>(_max_rate, RTP_PACER_MIN_RATE));
+	}
+}
+
+uint64_t RtpPacer::GetPacingRate() const
+{
+	// Drain the queue within the max queue time even if the estimate is lower
+	uint64_t drain_rate = static_cast<uint64_t>(_queued_bytes) * 8 * 1000 / RTP_PACER_MAX_QUEUE_TIME_MS;
+
+	return std::max(_pacing_rate, drain_rate);
+}
+
+void RtpPacer::UpdateBudget(int64_t current_time)
+{
+	uint64_t rate = GetPacingRate();
+	int64_t max_budget = static_cast<int64_t>(rate * RTP_PACER_BURST_INTERVAL_MS / 8 / 1000);
+
+	if(_last_update_time < 0)
+	{
+		// A burst is allowed at first
+		_budget = max_budget;
+		_last_update_time = current_time;
+		return;
+	}
+
+	int64_t elapsed = std::max<int64_t>(current_time - _last_update_time, 0);
+
+	_budget = std::min(_budget + static_cast<int64_t>(rate * elapsed / 8 / 1000), max_budget);
+	_last_update_time = current_time;
+}
+
+void RtpPacer::Enqueue(const std::shared_ptr<const ov::Data> &packet, bool rebase)
+{
+	_packets.push_back({ packet, rebase });
+	_queued_bytes += packet->GetLength();
+}
+
+bool RtpPacer::Dequeue(int64_t current_time, PacedPacket &paced_packet)
+{
+	if(_packets.empty())
+	{
+		return false;
+	}
+
+	UpdateBudget(current_time);
+
+	if(_budget <= 0)
+	{
+		return false;
+	}
+
+	paced_packet = std::move(_packets.front());
+	_packets.pop_front();
+
+	size_t length = paced_packet.packet->GetLength();
+
+	_queued_bytes -= length;
+	_budget -= static_cast<int64_t>(length);
+
+	return true;
+}
+
+int64_t RtpPacer::GetNextSendDelay() const
+{
+	if(_packets.empty())
+	{
+		return -1;
+	}
+
+	if(_budget > 0)
+	{
+		return 0;
+	}
+
+	uint64_t rate = std::max<uint64_t>(GetPacingRate(), 1);
+
+	// Time to recover the deficit (at least 1 ms)
+	return std::max<int64_t>(static_cast<int64_t>((static_cast<uint64_t>(1 - _budget) * 8 * 1000 + rate - 1) / rate), 1);
+}
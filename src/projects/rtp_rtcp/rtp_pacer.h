@@ -0,0 +1,87 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <deque>
+#include <memory>
+
+// The pacing rate is the estimated bitrate * factor (the frames are larger than the average)
+#define RTP_PACER_PACING_FACTOR			2.5
+// Rate of the session which has no estimate yet (bps)
+#define RTP_PACER_DEFAULT_RATE			(20 * 1000 * 1000)
+// Rate which always can be sent (bps)
+#define RTP_PACER_MIN_RATE				(300 * 1000)
+// Budget is accumulated at most for this interval (the size of a burst)
+#define RTP_PACER_BURST_INTERVAL_MS		5
+// The rate is increased to send the queued packets within this time
+#define RTP_PACER_MAX_QUEUE_TIME_MS		250
+
+// Spreads the packets of a session over time with a token bucket (the rate is given by the bandwidth estimation)
+//
+// - The packets are shared by all sessions, so only the references are queued
+//   (RtpRtcp copies them to the send buffers when they are released)
+// - The budget may be negative by the last packet, the next packet waits until it is recovered
+// - The rate is capped by the max rate (e.g. the quota of the application), but the queue is still drained
+//   within RTP_PACER_MAX_QUEUE_TIME_MS, so the session lowers its layer rather than delaying the frames
+// - Not thread-safe (RtpRtcp guards it)
+class RtpPacer
+{
+public:
+	struct PacedPacket
+	{
+		std::shared_ptr<const ov::Data> packet;
+		// The sequence number of the packet is rebased (the first packet of the switched layer)
+		bool rebase = false;
+	};
+
+	RtpPacer() = default;
+	~RtpPacer() = default;
+
+	// bps (0 if there is no estimate)
+	void SetEstimatedBitrate(uint64_t estimated_bitrate);
+	// bps (0: unlimited), applied from the next estimate
+	void SetMaxRate(uint64_t max_rate)
+	{
+		_max_rate = max_rate;
+	}
+
+	void Enqueue(const std::shared_ptr<const ov::Data> &packet, bool rebase);
+	// Pops the next packet if the budget allows (current_time: ms)
+	bool Dequeue(int64_t current_time, PacedPacket &paced_packet);
+
+	// ms until the next packet can be sent (-1 if there is no packet)
+	int64_t GetNextSendDelay() const;
+
+	bool IsEmpty() const
+	{
+		return _packets.empty();
+	}
+
+	size_t GetQueuedBytes() const
+	{
+		return _queued_bytes;
+	}
+
+	// bps (increased while the queue is long)
+	uint64_t GetPacingRate() const;
+
+private:
+	void UpdateBudget(int64_t current_time);
+
+	std::deque<PacedPacket> _packets;
+	size_t _queued_bytes = 0;
+
+	uint64_t _pacing_rate = RTP_PACER_DEFAULT_RATE;
+	uint64_t _max_rate = 0;
+
+	// bytes
+	int64_t _budget = 0;
+	int64_t _last_update_time = -1;
+};
@@ -25,6 +25,50 @@ RtpPacket::RtpPacket()
 	_buffer[0] = RTP_VERSION << 6;
 }
 
+RtpPacket::RtpPacket(const std::shared_ptr<ov::Data> &arena, uint8_t *buffer, size_t offset, size_t capacity)
+{
+	_marker = false;
+	_payload_type = 0;
+	_origin_payload_type = 0;
+	_is_fec = false;
+	_sequence_number = 0;
+	_timestamp = 0;
+	_ssrc = 0;
+	_payload_offset = FIXED_HEADER_SIZE;
+	_payload_size = 0;
+	_padding_size = 0;
+	_extension_size = 0;
+
+	_arena = arena;
+	_arena_offset = offset;
+	_arena_capacity = capacity;
+	_arena_length = FIXED_HEADER_SIZE;
+	_buffer = buffer;
+
+	::memset(_buffer, 0, FIXED_HEADER_SIZE);
+
+	// 버퍼에 RTP 버전 표기
+	_buffer[0] = RTP_VERSION << 6;
+}
+
+RtpPacket::RtpPacket(RtpPacket &header_template, const std::shared_ptr<ov::Data> &arena, uint8_t *buffer, size_t offset, size_t capacity)
+	: RtpPacket(arena, buffer, offset, capacity)
+{
+	_marker = header_template._marker;
+	_payload_type = header_template._payload_type;
+	_origin_payload_type = header_template._origin_payload_type;
+	_is_fec = header_template._is_fec;
+	_ssrc = header_template._ssrc;
+	_sequence_number = header_template._sequence_number;
+	_timestamp = header_template._timestamp;
+	_extension_size = header_template._extension_size;
+
+	// SSRC, PT, CSRCs and the extensions are pre-stamped in the template
+	_payload_offset = header_template._payload_offset;
+	_arena_length = _payload_offset;
+	::memcpy(_buffer, header_template.Header(), _payload_offset);
+}
+
 RtpPacket::RtpPacket(RtpPacket &src)
 {
 	_marker = src._marker;
@@ -38,8 +82,18 @@ RtpPacket::RtpPacket(RtpPacket &src)
 	_sequence_number = src._sequence_number;
 	_timestamp = src._timestamp;
 
-	_data = src._data->Clone();
-	_data->SetLength(src._data->GetLength());
+	if(src._arena != nullptr)
+	{
+		// Do not keep the buffer of the frame
+		_data = std::make_shared<ov::Data>(DEFAULT_MAX_PACKET_SIZE);
+		_data->Append(src._buffer, src._arena_length);
+	}
+	else
+	{
+		_data = src._data->Clone();
+		_data->SetLength(src._data->GetLength());
+	}
+
 	_buffer = _data->GetWritableDataAs<uint8_t>();
 }
 
@@ -50,9 +104,45 @@ RtpPacket::~RtpPacket()
 
 std::shared_ptr<ov::Data> RtpPacket::GetData()
 {
+	if((_arena != nullptr) && (_data == nullptr))
+	{
+		_data = _arena->Subdata(_arena_offset, _arena_length);
+	}
+
 	return _data;
 }
 
+bool RtpPacket::SetDataLength(size_t length)
+{
+	if(_arena == nullptr)
+	{
+		if(_data->SetLength(length) == false)
+		{
+			return false;
+		}
+
+		_buffer = _data->GetWritableDataAs<uint8_t>();
+		return true;
+	}
+
+	if(length > _arena_capacity)
+	{
+		OV_ASSERT(false, "Slot capacity must be greater than %zu (capacity: %zu)", length, _arena_capacity);
+		return false;
+	}
+
+	_arena_length = length;
+	// The region is referred again by GetData()
+	_data = nullptr;
+
+	return true;
+}
+
+size_t RtpPacket::GetCapacity()
+{
+	return (_arena != nullptr) ? _arena_capacity : _data->GetCapacity();
+}
+
 // Getter
 bool RtpPacket::Marker()
 {
@@ -168,8 +258,7 @@ void RtpPacket::SetCsrcs(const std::vector<uint32_t>& csrcs)
 	_buffer[0] = (_buffer[0] & 0xF0) | csrcs.size();
 
 	// _buffer 사이즈 조정
-	_data->SetLength(_payload_offset);
-	_buffer = _data->GetWritableDataAs<uint8_t>();
+	SetDataLength(_payload_offset);
 
 	// 4 bytes 짜리 csrc를 buffer에 BIG ENDIAN으로 넣는다.
 	size_t offset = FIXED_HEADER_SIZE;
@@ -180,6 +269,35 @@ void RtpPacket::SetCsrcs(const std::vector<uint32_t>& csrcs)
 	}
 }
 
+bool RtpPacket::SetHeaderExtensions(const RtpHeaderExtensionMap &extension_map)
+{
+	if((_extension_size != 0) || (_payload_size != 0) || extension_map.IsEmpty())
+	{
+		return false;
+	}
+
+	size_t offset = _payload_offset;
+
+	_payload_offset += extension_map.GetSize();
+	_extension_size = extension_map.GetSize();
+
+	SetDataLength(_payload_offset);
+
+	// X bit
+	_buffer[0] |= 0x10;
+
+	extension_map.Write(&_buffer[offset]);
+
+	return true;
+}
+
+bool RtpPacket::SetTransportCcExtension(uint8_t id)
+{
+	RtpHeaderExtensionMap extension_map;
+
+	return extension_map.Register(RtpHeaderExtensionType::TransportCc, id) && SetHeaderExtensions(extension_map);
+}
+
 size_t RtpPacket::HeadersSize()
 {
 	return _payload_offset;
@@ -216,15 +334,14 @@ bool RtpPacket::SetPayload(const uint8_t *payload, size_t payload_size)
 
 uint8_t* RtpPacket::SetPayloadSize(size_t size_bytes)
 {
-	if (_payload_offset + size_bytes > _data->GetCapacity())
+	if (_payload_offset + size_bytes > GetCapacity())
 	{
-		OV_ASSERT(false, "Data capacity must be greater than %ld (offset: %ld + bytes: %ld)", _data->GetCapacity(), _payload_offset, size_bytes, _payload_offset + size_bytes);
+		OV_ASSERT(false, "Data capacity must be greater than %ld (offset: %ld + bytes: %ld)", GetCapacity(), _payload_offset, size_bytes, _payload_offset + size_bytes);
 		return nullptr;
 	}
 
 	_payload_size = size_bytes;
-	_data->SetLength(_payload_offset + _payload_size);
-	_buffer = _data->GetWritableDataAs<uint8_t>();
+	SetDataLength(_payload_offset + _payload_size);
 
 	return &_buffer[_payload_offset];
 }
@@ -4,6 +4,8 @@
 #include <memory>
 #include <base/ovlibrary/ovlibrary.h>
 
+#include "rtp_header_extension.h"
+
 #define RTP_VERSION					2
 #define FIXED_HEADER_SIZE			12
 #define RED_HEADER_SIZE				1
@@ -39,6 +41,10 @@ class RtpPacket
 public:
 	RtpPacket();
 	RtpPacket(RtpPacket &src);
+	// The packet is written to arena (buffer: writable pointer of arena at offset), see RtpPacketArena
+	RtpPacket(const std::shared_ptr<ov::Data> &arena, uint8_t *buffer, size_t offset, size_t capacity);
+	// Same as above, and the header of header_template is copied
+	RtpPacket(RtpPacket &header_template, const std::shared_ptr<ov::Data> &arena, uint8_t *buffer, size_t offset, size_t capacity);
 	virtual ~RtpPacket();
 
 	// Getter
@@ -64,6 +70,11 @@ public:
 	
 	// 버퍼에 남은 공간이 충분하고 extension, Payload, padding이 들어가기 전에 호출되어야 함
 	void		SetCsrcs(const std::vector<uint32_t>& csrcs);
+	// Adds the header extension of the map (the per-packet values are written by each session, see RtpRtcp)
+	// Must be called after SetCsrcs() and before the payload is allocated
+	bool		SetHeaderExtensions(const RtpHeaderExtensionMap &extension_map);
+	// Only the transport-wide sequence number extension
+	bool		SetTransportCcExtension(uint8_t id);
 
 	size_t		HeadersSize();
 	size_t		PayloadSize();
@@ -78,9 +89,14 @@ public:
 	uint8_t*	Payload();
 
 	// Data
+	// If the packet is in the arena, it refers the region of the packet (copy-on-write)
 	std::shared_ptr<ov::Data> GetData();
 
 protected:
+	// Resizes the packet, and updates _buffer
+	bool		SetDataLength(size_t length);
+	size_t		GetCapacity();
+
 	size_t		_payload_offset;	// Header Start Point (Header size)
 	bool		_marker;
 	uint8_t		_payload_type;
@@ -99,5 +115,11 @@ protected:
 	// std::vector<uint8_t>	_buffer;
 	uint8_t *					_buffer;
 	std::shared_ptr<ov::Data>	_data;
+
+	// The buffer of the frame which has this packet (nullptr if the packet has its own _data)
+	std::shared_ptr<ov::Data>	_arena;
+	size_t						_arena_offset = 0;
+	size_t						_arena_capacity = 0;
+	size_t						_arena_length = 0;
 };
 
@@ -0,0 +1,61 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtp_packet_arena.h"
+
+#define OV_LOG_TAG "RtpRtcp.Arena"
+
+bool RtpPacketArena::Reset(size_t slot_count)
+{
+	_buffer = nullptr;
+	_base = nullptr;
+	_slot_count = 0;
+	_next_slot = 0;
+
+	if(slot_count == 0)
+	{
+		return true;
+	}
+
+	auto buffer = std::make_shared<ov::Data>(slot_count * DEFAULT_MAX_PACKET_SIZE);
+
+	if(buffer->SetLength(slot_count * DEFAULT_MAX_PACKET_SIZE) == false)
+	{
+		logte("Could not allocate the arena for %zu packets", slot_count);
+		return false;
+	}
+
+	_base = buffer->GetWritableDataAs<uint8_t>();
+	_buffer = buffer;
+	_slot_count = slot_count;
+
+	return true;
+}
+
+std::shared_ptr<RtpPacket> RtpPacketArena::AllocatePacket(RtpPacket &header_template)
+{
+	if(_next_slot >= _slot_count)
+	{
+		return nullptr;
+	}
+
+	size_t offset = (_next_slot++) * DEFAULT_MAX_PACKET_SIZE;
+
+	return std::make_shared<RtpPacket>(header_template, _buffer, _base + offset, offset, DEFAULT_MAX_PACKET_SIZE);
+}
+
+std::shared_ptr<RedRtpPacket> RtpPacketArena::AllocateRedPacket(uint8_t red_payload_type, RtpPacket &src)
+{
+	if(_next_slot >= _slot_count)
+	{
+		return nullptr;
+	}
+
+	size_t offset = (_next_slot++) * DEFAULT_MAX_PACKET_SIZE;
+
+	return std::make_shared<RedRtpPacket>(red_payload_type, src, _buffer, _base + offset, offset, DEFAULT_MAX_PACKET_SIZE);
+}
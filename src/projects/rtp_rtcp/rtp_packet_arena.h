@@ -0,0 +1,42 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "rtp_packet.h"
+#include "red_rtp_packet.h"
+
+#include <memory>
+
+// Contiguous buffer of the packets of a frame
+//
+// - A slot of DEFAULT_MAX_PACKET_SIZE bytes is carved for each packet, and the header is copied from the template
+//   (only the sequence number, the marker and the timestamp are patched by the packetizer)
+// - RtpPacket::GetData() of the packets refers the slots, so the packets are broadcasted without copying them
+// - The buffer is released when the last packet (or the data of it) is released, Reset() allocates a new buffer
+//   for the next frame (the packets of the previous frames may be still referred by the sessions)
+class RtpPacketArena
+{
+public:
+	RtpPacketArena() = default;
+	~RtpPacketArena() = default;
+
+	// Prepares slot_count slots for the next frame
+	bool Reset(size_t slot_count);
+
+	// nullptr if all slots are used (the caller allocates the packet as usual)
+	std::shared_ptr<RtpPacket> AllocatePacket(RtpPacket &header_template);
+	std::shared_ptr<RedRtpPacket> AllocateRedPacket(uint8_t red_payload_type, RtpPacket &src);
+
+private:
+	std::shared_ptr<ov::Data> _buffer;
+	// The writable pointer is taken once, the regions are referred by the packets after that
+	uint8_t *_base = nullptr;
+
+	size_t _slot_count = 0;
+	size_t _next_slot = 0;
+};
@@ -0,0 +1,102 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtp_packet_history.h"
+#include "rtp_packet.h"
+
+#include <chrono>
+#include <base/ovlibrary/byte_io.h>
+
+#define OV_LOG_TAG "RtpRtcp"
+
+void RtpPacketHistory::Store(const std::shared_ptr<const ov::Data> &packet, int64_t current_time)
+{
+	if((packet == nullptr) || (packet->GetLength() < FIXED_HEADER_SIZE))
+	{
+		return;
+	}
+
+	Store(packet, current_time, ByteReader<uint16_t>::ReadBigEndian(&(packet->GetDataAs<uint8_t>()[2])));
+}
+
+void RtpPacketHistory::Store(const std::shared_ptr<const ov::Data> &packet, int64_t current_time, uint16_t sequence_number)
+{
+	if((packet == nullptr) || (packet->GetLength() < FIXED_HEADER_SIZE))
+	{
+		return;
+	}
+
+	uint32_t ssrc = ByteReader<uint32_t>::ReadBigEndian(&(packet->GetDataAs<uint8_t>()[8]));
+
+	auto &history = _history_map[ssrc];
+
+	if(history.empty())
+	{
+		history.resize(RTP_HISTORY_SIZE);
+	}
+
+	auto &entry = history[sequence_number & (RTP_HISTORY_SIZE - 1)];
+
+	entry.packet = packet;
+	entry.sequence_number = sequence_number;
+	entry.stored_time = current_time;
+	entry.retransmitted_time = 0;
+}
+
+std::shared_ptr<const ov::Data> RtpPacketHistory::GetForRetransmit(uint32_t ssrc, uint16_t sequence_number, int64_t current_time)
+{
+	auto item = _history_map.find(ssrc);
+
+	if(item == _history_map.end())
+	{
+		return nullptr;
+	}
+
+	auto &entry = item->second[sequence_number & (RTP_HISTORY_SIZE - 1)];
+
+	if((entry.packet == nullptr) || (entry.sequence_number != sequence_number))
+	{
+		// Already overwritten by a newer packet
+		return nullptr;
+	}
+
+	if((current_time - entry.stored_time) > RTP_HISTORY_MAX_AGE_MS)
+	{
+		return nullptr;
+	}
+
+	if((entry.retransmitted_time != 0) && ((current_time - entry.retransmitted_time) < RTP_RETRANSMIT_MIN_INTERVAL_MS))
+	{
+		return nullptr;
+	}
+
+	entry.retransmitted_time = current_time;
+
+	return entry.packet;
+}
+
+void RtpPacketHistory::Clear()
+{
+	_history_map.clear();
+}
+
+size_t RtpPacketHistory::GetMemoryUsage() const
+{
+	size_t memory_usage = 0;
+
+	for(const auto &item : _history_map)
+	{
+		memory_usage += item.second.capacity() * sizeof(Entry);
+	}
+
+	return memory_usage;
+}
+
+int64_t RtpPacketHistory::GetCurrentMilliseconds()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,61 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+// Number of packets kept for each SSRC (must be a power of 2)
+#define RTP_HISTORY_SIZE				1024
+// Packets older than this are not retransmitted because the player has already given up on them
+#define RTP_HISTORY_MAX_AGE_MS			1000
+// The same packet is not retransmitted again within this interval (the player repeats NACK until RTT elapses)
+#define RTP_RETRANSMIT_MIN_INTERVAL_MS	100
+
+// Keeps the recently sent RTP packets of a session so that they can be retransmitted when a NACK is received.
+//
+// - The packets are shared by all sessions of the stream, so only the reference of the unprotected packet is kept
+//   (SRTP protection is applied again when the packet is retransmitted)
+// - Each SSRC has a ring buffer indexed by the sequence number
+// - Not thread-safe (RtpRtcp guards it)
+class RtpPacketHistory
+{
+public:
+	RtpPacketHistory() = default;
+	~RtpPacketHistory() = default;
+
+	// packet must be a complete RTP packet
+	void Store(const std::shared_ptr<const ov::Data> &packet, int64_t current_time);
+	// The packet is sent with sequence_number instead of the sequence number of the packet (RtpRtcp rewrites it)
+	void Store(const std::shared_ptr<const ov::Data> &packet, int64_t current_time, uint16_t sequence_number);
+
+	// Returns the packet to retransmit.
+	// Returns nullptr if the packet has been overwritten, is too old or has been retransmitted recently
+	std::shared_ptr<const ov::Data> GetForRetransmit(uint32_t ssrc, uint16_t sequence_number, int64_t current_time);
+
+	void Clear();
+
+	// Bytes of the rings (the packets are shared with the stream, so they are not counted)
+	size_t GetMemoryUsage() const;
+
+	static int64_t GetCurrentMilliseconds();
+
+private:
+	struct Entry
+	{
+		std::shared_ptr<const ov::Data> packet;
+		uint16_t sequence_number = 0;
+		int64_t stored_time = 0;
+		int64_t retransmitted_time = 0;
+	};
+
+	std::map<uint32_t, std::vector<Entry>> _history_map;
+};
@@ -3,7 +3,10 @@
 #include <memory>
 #include "rtp_packet.h"
 #include "red_rtp_packet.h"
+#include "rtp_packet_arena.h"
 #include "rtp_packetizing_manager.h"
+#include "rtp_packetizer_vp8.h"
+#include "rtp_packetizer_h264.h"
 #include "rtp_packetizer.h"
 
 #define OV_LOG_TAG "RtpRtcp"
@@ -27,16 +30,31 @@ RtpPacketizer::~RtpPacketizer()
 void RtpPacketizer::SetPayloadType(uint8_t payload_type)
 {
 	_payload_type = payload_type;
+	_header_template = nullptr;
+}
+
+void RtpPacketizer::SetVideoCodec(RtpVideoCodecType codec)
+{
+	_video_codec = codec;
+	SelectVideoPipeline();
 }
 
 void RtpPacketizer::SetSSRC(const uint32_t ssrc)
 {
 	_ssrc = ssrc;
+	_header_template = nullptr;
 }
 
 void RtpPacketizer::SetCsrcs(const std::vector<uint32_t> &csrcs)
 {
 	_csrcs = csrcs;
+	_header_template = nullptr;
+}
+
+void RtpPacketizer::SetHeaderExtensions(const RtpHeaderExtensionMap &extension_map)
+{
+	_extension_map = extension_map;
+	_header_template = nullptr;
 }
 
 void RtpPacketizer::SetUlpfec(uint8_t red_payload_type, uint8_t ulpfec_payload_type)
@@ -44,6 +62,22 @@ void RtpPacketizer::SetUlpfec(uint8_t red_payload_type, uint8_t ulpfec_payload_t
 	_ulpfec_enabled = true;
 	_red_payload_type = red_payload_type;
 	_ulpfec_payload_type = ulpfec_payload_type;
+	SelectVideoPipeline();
+}
+
+void RtpPacketizer::SetFlexfec(uint8_t flexfec_payload_type, uint32_t flexfec_ssrc)
+{
+	_flexfec_enabled = true;
+	_flexfec_payload_type = flexfec_payload_type;
+	_flexfec_ssrc = flexfec_ssrc;
+	_flexfec_sequence_number = (uint16_t)rand();
+	SelectVideoPipeline();
+}
+
+void RtpPacketizer::SetFecProtectionRate(uint32_t rate)
+{
+	_ulpfec_generator.SetProtectionRate(rate);
+	_flexfec_generator.SetProtectionRate(rate);
 }
 
 bool RtpPacketizer::Packetize(FrameType frame_type,
@@ -62,14 +96,66 @@ bool RtpPacketizer::Packetize(FrameType frame_type,
 	{
 		return PacketizeAudio(frame_type, rtp_timestamp, payload_data, payload_size);
 	}
-	else
+
+	if(rtp_header == nullptr)
+	{
+		logte("Video header is required to packetize the frame");
+		return false;
+	}
+
+	auto pipeline = _video_pipeline;
+
+	if((pipeline == nullptr) || (rtp_header->codec != _video_codec))
+	{
+		// The codec of the track is not set (or the frame is not of the codec)
+		pipeline = GetVideoPipeline(rtp_header->codec);
+
+		if(pipeline == nullptr)
+		{
+			// 지원하지 못하는 Frame이 들어옴, critical error
+			logte("Cannot create _packetizers (codec: %d)", static_cast<int>(rtp_header->codec));
+			return false;
+		}
+	}
+
+	return (this->*pipeline)(frame_type, rtp_timestamp, payload_data, payload_size, fragmentation, rtp_header);
+}
+
+RtpPacketizer::PacketizeVideoFunction RtpPacketizer::GetVideoPipeline(RtpVideoCodecType codec) const
+{
+	switch(codec)
+	{
+		case RtpVideoCodecType::Vp8:
+			return GetVideoPipeline<RtpPacketizerVp8>();
+
+		case RtpVideoCodecType::H264:
+			return GetVideoPipeline<RtpPacketizerH264>();
+
+		case RtpVideoCodecType::None:
+			break;
+	}
+
+	return nullptr;
+}
+
+template<typename TCodecPacketizer>
+RtpPacketizer::PacketizeVideoFunction RtpPacketizer::GetVideoPipeline() const
+{
+	if(_ulpfec_enabled)
 	{
-		return PacketizeVideo(rtp_header->codec, frame_type, rtp_timestamp, payload_data, payload_size, fragmentation, rtp_header);
+		return _flexfec_enabled ? &RtpPacketizer::PacketizeVideo<TCodecPacketizer, true, true> : &RtpPacketizer::PacketizeVideo<TCodecPacketizer, true, false>;
 	}
+
+	return _flexfec_enabled ? &RtpPacketizer::PacketizeVideo<TCodecPacketizer, false, true> : &RtpPacketizer::PacketizeVideo<TCodecPacketizer, false, false>;
+}
+
+void RtpPacketizer::SelectVideoPipeline()
+{
+	_video_pipeline = GetVideoPipeline(_video_codec);
 }
 
-bool RtpPacketizer::PacketizeVideo(RtpVideoCodecType video_type,
-                                   FrameType frame_type,
+template<typename TCodecPacketizer, bool ulpfec, bool flexfec>
+bool RtpPacketizer::PacketizeVideo(FrameType frame_type,
                                    uint32_t rtp_timestamp,
                                    const uint8_t *payload_data,
                                    size_t payload_size,
@@ -77,55 +163,44 @@ bool RtpPacketizer::PacketizeVideo(RtpVideoCodecType video_type,
                                    const RTPVideoHeader *video_header)
 {
 
-	std::shared_ptr<RtpPacket> rtp_header_template, red_rtp_header_template;
-	std::shared_ptr<RtpPacket> last_rtp_header, last_red_rtp_header;
-
-	// 기본 패킷 헤더를 생성
-	rtp_header_template = AllocatePacket();
-	rtp_header_template->SetTimestamp(rtp_timestamp);
+	// 기본 패킷 헤더 (SSRC, PT, CSRC, extension이 미리 기록되어 있음)
+	RtpPacket &rtp_header_template = GetHeaderTemplate();
 
-	// 마지막 패킷 헤더를 생성, 마지막 패킷에 extension과 marker=1을 보낸다.
-	last_rtp_header = AllocatePacket();
-	last_rtp_header->SetTimestamp(rtp_timestamp);
-
-
-	// TODO: 향후 다음 Extension을 추가한다.
+	// TODO: 향후 다음 Extension을 추가한다. (마지막 패킷에 extension을 보내게 되면 마지막 패킷용 template이 필요함)
+	// (The extensions of RtpHeaderExtensionMap are in all packets, so they are in the template)
 	// Rotation Extension
 	// Video Content Type Extension
 	// Video Timing Extension
 
 	// -20 is for FEC
-	size_t max_data_payload_length = DEFAULT_MAX_PACKET_SIZE - rtp_header_template->HeadersSize() - 100;
-	size_t last_packet_reduction_len = last_rtp_header->HeadersSize() - rtp_header_template->HeadersSize();
-
-	// Packetizer 생성
-	std::unique_ptr<RtpPacketizingManager> packetizer(RtpPacketizingManager::Create(video_type,
-	                                                                max_data_payload_length,
-	                                                                last_packet_reduction_len,
-	                                                                video_header ? &(video_header->codec_header) : nullptr, frame_type));
-	if(!packetizer)
-	{
-		// 지원하지 못하는 Frame이 들어옴, critical error
-		logte("Cannot create _packetizers");
-		return false;
-	}
+	size_t max_data_payload_length = DEFAULT_MAX_PACKET_SIZE - rtp_header_template.HeadersSize() - 100;
+	// Packetizer 생성 (마지막 패킷도 같은 헤더를 사용한다, and the calls of it are not virtual because the type is final)
+	TCodecPacketizer packetizer(video_header->codec_header, max_data_payload_length);
 
 	// Paketizer에 Payload를 셋팅
-	size_t num_packets = packetizer->SetPayloadData(payload_data, payload_size, fragmentation);
+	size_t num_packets = packetizer.SetPayloadData(payload_data, payload_size, fragmentation);
 	if(num_packets == 0)
 	{
 		logte("Packetizer returns 0 packet");
 		return false;
 	}
 
+	// All packets of the frame (and the RED packets of them) are carved from one buffer
+	_arena.Reset(num_packets * (ulpfec ? 2 : 1));
+
 	// 생성된 Packet 만큼 전송한다.
-	// 마지막 패킷은 특수하게 처리한다. (Extension 포함, Marker=1)
 	for(size_t i = 0; i < num_packets; ++i)
 	{
-		bool last = (i + 1) == num_packets;
-		auto packet = last ? std::move(last_rtp_header) : std::make_shared<RtpPacket>(*rtp_header_template);
+		auto packet = _arena.AllocatePacket(rtp_header_template);
 
-		if(!packetizer->NextPacket(packet.get()))
+		if(packet == nullptr)
+		{
+			packet = std::make_shared<RtpPacket>(rtp_header_template);
+		}
+
+		packet->SetTimestamp(rtp_timestamp);
+
+		if(!packetizer.NextPacket(packet.get()))
 		{
 			return false;
 		}
@@ -137,8 +212,14 @@ bool RtpPacketizer::PacketizeVideo(RtpVideoCodecType video_type,
 
 		_stream->OnRtpPacketized(packet);
 
+		// FlexFEC protects the media packets without RED
+		if(flexfec)
+		{
+			GenerateFlexfecPackets(packet);
+		}
+
 		// RED First
-		if(_ulpfec_enabled)
+		if(ulpfec)
 		{
 			GenerateRedAndFecPackets(packet);
 		}
@@ -184,6 +265,27 @@ bool RtpPacketizer::GenerateRedAndFecPackets(std::shared_ptr<RtpPacket> packet)
 	return true;
 }
 
+bool RtpPacketizer::GenerateFlexfecPackets(const std::shared_ptr<RtpPacket> &packet)
+{
+	_flexfec_generator.AddRtpPacketAndGenerateFec(packet);
+
+	while(_flexfec_generator.IsAvailableFecPackets())
+	{
+		auto fec_packet = AllocateFlexfecPacket();
+
+		// Timestamp is same as last packet
+		fec_packet->SetTimestamp(packet->Timestamp());
+		fec_packet->SetSequenceNumber(_flexfec_sequence_number++);
+
+		_flexfec_generator.NextPacket(fec_packet.get());
+
+		// Send FlexFEC
+		_stream->OnRtpPacketized(fec_packet);
+	}
+
+	return true;
+}
+
 bool RtpPacketizer::PacketizeAudio(FrameType frame_type,
                                    uint32_t rtp_timestamp,
                                    const uint8_t *payload_data,
@@ -230,9 +332,27 @@ bool RtpPacketizer::PacketizeAudio(FrameType frame_type,
 
 std::shared_ptr<RedRtpPacket> RtpPacketizer::PackageAsRed(std::shared_ptr<RtpPacket> rtp_packet)
 {
+	auto red_packet = _arena.AllocateRedPacket(_red_payload_type, *rtp_packet);
+
+	if(red_packet != nullptr)
+	{
+		return red_packet;
+	}
+
 	return std::make_shared<RedRtpPacket>(_red_payload_type, *rtp_packet);
 }
 
+RtpPacket &RtpPacketizer::GetHeaderTemplate()
+{
+	if(_header_template == nullptr)
+	{
+		// Made again when the session information is changed
+		_header_template = AllocatePacket();
+	}
+
+	return *_header_template;
+}
+
 std::shared_ptr<RtpPacket> RtpPacketizer::AllocatePacket(bool ulpfec)
 {
 	std::shared_ptr<RedRtpPacket> red_packet;
@@ -244,6 +364,12 @@ std::shared_ptr<RtpPacket> RtpPacketizer::AllocatePacket(bool ulpfec)
 
 		red_packet->SetSsrc(_ssrc);
 		red_packet->SetCsrcs(_csrcs);
+
+		if(_extension_map.IsEmpty() == false)
+		{
+			red_packet->SetHeaderExtensions(_extension_map);
+		}
+
 		red_packet->SetPayloadType(_ulpfec_payload_type);
 		red_packet->SetUlpfec(true, _payload_type);
 
@@ -256,12 +382,37 @@ std::shared_ptr<RtpPacket> RtpPacketizer::AllocatePacket(bool ulpfec)
 		rtp_packet = std::make_shared<RtpPacket>();
 		rtp_packet->SetSsrc(_ssrc);
 		rtp_packet->SetCsrcs(_csrcs);
+
+		if(_extension_map.IsEmpty() == false)
+		{
+			rtp_packet->SetHeaderExtensions(_extension_map);
+		}
+
 		rtp_packet->SetPayloadType(_payload_type);
 
 		return rtp_packet;
 	}
 }
 
+std::shared_ptr<RtpPacket> RtpPacketizer::AllocateFlexfecPacket()
+{
+	auto fec_packet = std::make_shared<RtpPacket>();
+
+	fec_packet->SetSsrc(_flexfec_ssrc);
+	// The protected SSRC
+	fec_packet->SetCsrcs({ _ssrc });
+
+	if(_extension_map.IsEmpty() == false)
+	{
+		fec_packet->SetHeaderExtensions(_extension_map);
+	}
+
+	fec_packet->SetPayloadType(_flexfec_payload_type);
+	fec_packet->SetUlpfec(true, _payload_type);
+
+	return fec_packet;
+}
+
 bool RtpPacketizer::AssignSequenceNumber(RtpPacket *packet, bool red)
 {
 	if(!red)
@@ -4,6 +4,8 @@
 #include "rtp_packetizing_manager.h"
 #include "rtp_rtcp_defines.h"
 #include "ulpfec_generator.h"
+#include "flexfec_generator.h"
+#include "rtp_packet_arena.h"
 #include <memory>
 
 class RtpPacketizer
@@ -13,9 +15,18 @@ public:
 	~RtpPacketizer();
 
 	void SetUlpfec(uint8_t _red_payload_type, uint8_t _ulpfec_payload_type);
+	// FlexFEC packets are sent on fec_ssrc, the CSRC of them is the SSRC of the media (RFC 8627)
+	void SetFlexfec(uint8_t flexfec_payload_type, uint32_t flexfec_ssrc);
+	// FEC packets per 100 media packets of ULPFEC and FlexFEC (0: RED only)
+	void SetFecProtectionRate(uint32_t rate);
 	void SetPayloadType(uint8_t payload_type);
+	// Codec of the video track, the pipeline of the packets is selected with the FEC of the track
+	// (None: selected by the codec of each frame)
+	void SetVideoCodec(RtpVideoCodecType codec);
 	void SetSSRC(uint32_t ssrc);
 	void SetCsrcs(const std::vector<uint32_t> &csrcs);
+	// Header extension of the packets (written to the header template once)
+	void SetHeaderExtensions(const RtpHeaderExtensionMap &extension_map);
 
 	// RTP Packet
 	bool Packetize(FrameType frame_type,
@@ -26,15 +37,33 @@ public:
 	               const RTPVideoHeader *rtp_header);
 
 private:
+	// The video pipeline specialized by the codec and the FEC, so the loop of the packets has no branch of them
+	using PacketizeVideoFunction = bool (RtpPacketizer::*)(FrameType frame_type,
+	                                                      uint32_t rtp_timestamp,
+	                                                      const uint8_t *payload_data,
+	                                                      size_t payload_size,
+	                                                      const FragmentationHeader *fragmentation,
+	                                                      const RTPVideoHeader *video_header);
+
+	// nullptr if the codec is not supported
+	PacketizeVideoFunction GetVideoPipeline(RtpVideoCodecType codec) const;
+	template<typename TCodecPacketizer>
+	PacketizeVideoFunction GetVideoPipeline() const;
+	// Called when the codec or the FEC is changed
+	void SelectVideoPipeline();
+
 	// Basic
 	std::shared_ptr<RtpPacket> AllocatePacket(bool ulpfec=false);
+	std::shared_ptr<RtpPacket> AllocateFlexfecPacket();
 	std::shared_ptr<RedRtpPacket> PackageAsRed(std::shared_ptr<RtpPacket> rtp_packet);
+	// The header of the media packets (made by AllocatePacket())
+	RtpPacket &GetHeaderTemplate();
 	bool AssignSequenceNumber(RtpPacket *packet, bool red = false);
 	bool MarkerBit(FrameType frame_type, int8_t payload_type);
 
 	// Video Packet Sender Interface
-	bool PacketizeVideo(RtpVideoCodecType video_type,
-	                    FrameType frame_type,
+	template<typename TCodecPacketizer, bool ulpfec, bool flexfec>
+	bool PacketizeVideo(FrameType frame_type,
 	                    uint32_t rtp_timestamp,
 	                    const uint8_t *payload_data,
 	                    size_t payload_size,
@@ -42,6 +71,7 @@ private:
 	                    const RTPVideoHeader *video_header);
 
 	bool GenerateRedAndFecPackets(std::shared_ptr<RtpPacket> packet);
+	bool GenerateFlexfecPackets(const std::shared_ptr<RtpPacket> &packet);
 
 	// Audio Pakcet Sender Interface
 	bool PacketizeAudio(FrameType frame_type,
@@ -56,9 +86,12 @@ private:
 	// Session Information
 	uint32_t _ssrc;
 	uint8_t _payload_type;
+	RtpVideoCodecType _video_codec = RtpVideoCodecType::None;
+	PacketizeVideoFunction _video_pipeline = nullptr;
 	std::vector<uint32_t> _csrcs;
 	// Sequence Number
 	uint16_t _sequence_number;
+	RtpHeaderExtensionMap _extension_map;
 	uint16_t _red_sequence_number;
 
 	bool _ulpfec_enabled;
@@ -67,6 +100,17 @@ private:
 
 	UlpfecGenerator _ulpfec_generator;
 
+	bool _flexfec_enabled = false;
+	uint8_t _flexfec_payload_type = 0;
+	uint32_t _flexfec_ssrc = 0;
+	uint16_t _flexfec_sequence_number = 0;
+
+	FlexfecGenerator _flexfec_generator;
+
+	std::shared_ptr<RtpPacket> _header_template;
+	// Buffer of the packets of the current frame
+	RtpPacketArena _arena;
+
 	// Session Descriptor
 	std::shared_ptr<RtpRtcpPacketizerInterface> _stream;
 };
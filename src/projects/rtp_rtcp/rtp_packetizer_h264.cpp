@@ -36,14 +36,19 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "rtp_packetizer_h264.h"
 #include "base/ovlibrary/byte_io.h"
+#include "base/ovlibrary/nal_utilities.h"
 
 RtpPacketizerH264::RtpPacketizerH264(size_t max_payload_len,
                                      size_t last_packet_reduction_len,
-                                     H264PacketizationMode packetization_mode)
+                                     H264PacketizationMode packetization_mode,
+                                     const ov::NalUnit* nal_units,
+                                     size_t nal_unit_count)
 	: max_payload_len_(max_payload_len),
 	  last_packet_reduction_len_(last_packet_reduction_len),
 	  num_packets_left_(0),
-	  packetization_mode_(packetization_mode)
+	  packetization_mode_(packetization_mode),
+	  nal_units_(nal_units),
+	  nal_unit_count_(nal_unit_count)
 {
 }
 
@@ -60,6 +65,22 @@ size_t RtpPacketizerH264::SetPayloadData(
 	const uint8_t* payload_data,
 	size_t payload_size,
 	const FragmentationHeader* fragmentation) {
+	if (fragmentation->fragmentation_vector_size == 0) {
+		// More than MAX_FRAG_COUNT NAL units (e.g. SEI + SPS + PPS + IDR)
+		if (nal_units_ != nullptr) {
+			// Found once per frame, and shared with the other publishers
+			for (size_t i = 0; i < nal_unit_count_; ++i) {
+				if (nal_units_[i].offset + nal_units_[i].length > payload_size) {
+					break;
+				}
+				input_fragments_.push_back(
+					Fragment(&payload_data[nal_units_[i].offset], nal_units_[i].length));
+			}
+		} else {
+			// Find them from the start codes
+			SetFragmentsFromStartCodes(payload_data, payload_size);
+		}
+	}
 	for (int i = 0; i < fragmentation->fragmentation_vector_size; ++i) {
 		const uint8_t* buffer =
 			&payload_data[fragmentation->fragmentation_offset[i]];
@@ -77,6 +98,27 @@ size_t RtpPacketizerH264::SetPayloadData(
 	return num_packets_left_;
 }
 
+void RtpPacketizerH264::SetFragmentsFromStartCodes(const uint8_t* payload_data,
+                                                    size_t payload_size) {
+	const uint8_t* end = payload_data + payload_size;
+	const uint8_t* start_code = ov::FindNalStartCode(payload_data, end);
+
+	while (start_code < end) {
+		const uint8_t* nal = start_code + 3;
+		start_code = ov::FindNalStartCode(nal, end);
+
+		// Exclude the leading zeros of the next start code
+		const uint8_t* nal_end = start_code;
+		while ((nal_end > nal) && (nal_end[-1] == 0x00)) {
+			--nal_end;
+		}
+
+		if (nal_end > nal) {
+			input_fragments_.push_back(Fragment(nal, nal_end - nal));
+		}
+	}
+}
+
 bool RtpPacketizerH264::GeneratePackets() {
 	for (size_t i = 0; i < input_fragments_.size();) {
 		switch (packetization_mode_) {
@@ -203,8 +245,6 @@ bool RtpPacketizerH264::NextPacket(RtpPacket* rtp_packet) {
 	} else {
 		NextFragmentPacket(rtp_packet);
 	}
-	if (packets_.empty()) {
-	}
 	rtp_packet->SetMarker(packets_.empty());
 	--num_packets_left_;
 	return true;
@@ -215,12 +255,18 @@ void RtpPacketizerH264::NextAggregatePacket(RtpPacket* rtp_packet,
 	uint8_t* buffer = rtp_packet->AllocatePayload(
 		last ? max_payload_len_ - last_packet_reduction_len_ : max_payload_len_);
 	PacketUnit* packet = &packets_.front();
-	// STAP-A NALU header.
+	// STAP-A NALU header, the NRI is the maximum of the aggregated NAL units
+	// (RFC 6184 5.7.1) so that SPS/PPS aggregated after a SEI are not
+	// considered disposable.
 	buffer[0] = (packet->header & (kFBit | kNriMask)) | NaluType::kStapA;
 	size_t index = kNalHeaderSize;
 	bool is_last_fragment = packet->last_fragment;
 	while (packet->aggregated) {
 		const Fragment& fragment = packet->source_fragment;
+		if ((packet->header & kNriMask) > (buffer[0] & kNriMask)) {
+			buffer[0] = (buffer[0] & ~kNriMask) | (packet->header & kNriMask);
+		}
+		buffer[0] |= packet->header & kFBit;
 		// Add NAL unit length field.
 		ByteWriter<uint16_t>::WriteBigEndian(&buffer[index], fragment.length);
 		index += kLengthFieldSize;
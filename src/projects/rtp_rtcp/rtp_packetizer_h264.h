@@ -50,11 +50,19 @@ const size_t kLengthFieldSize = 2;
 enum NalDefs : uint8_t { kFBit = 0x80, kNriMask = 0x60, kTypeMask = 0x1F };
 enum FuDefs : uint8_t { kSBit = 0x80, kEBit = 0x40, kRBit = 0x20 };
 
-class RtpPacketizerH264 : public RtpPacketizingManager {
+class RtpPacketizerH264 final : public RtpPacketizingManager {
 public:
 	RtpPacketizerH264(size_t max_payload_len,
 	                  size_t last_packet_reduction_len,
-	                  H264PacketizationMode packetization_mode);
+	                  H264PacketizationMode packetization_mode,
+	                  const ov::NalUnit* nal_units = nullptr,
+	                  size_t nal_unit_count = 0);
+	// Made on the stack of each frame by the video pipeline of RtpPacketizer
+	RtpPacketizerH264(const RTPVideoTypeHeader& codec_header, size_t max_payload_len)
+		: RtpPacketizerH264(max_payload_len, 0, codec_header.h264.packetization_mode,
+		                    codec_header.h264.nal_units, codec_header.h264.nal_unit_count)
+	{
+	}
 
 	~RtpPacketizerH264() override;
 
@@ -92,6 +100,9 @@ private:
 		uint8_t header;
 	};
 
+	// Used when the fragmentation header has no NAL unit (and the NAL units are not given)
+	void SetFragmentsFromStartCodes(const uint8_t* payload_data,
+	                                size_t payload_size);
 	bool GeneratePackets();
 	void PacketizeFuA(size_t fragment_index);
 	size_t PacketizeStapA(size_t fragment_index);
@@ -103,6 +114,8 @@ private:
 	const size_t last_packet_reduction_len_;
 	size_t num_packets_left_;
 	const H264PacketizationMode packetization_mode_;
+	const ov::NalUnit* nal_units_;
+	const size_t nal_unit_count_;
 	std::deque<Fragment> input_fragments_;
 	std::queue<PacketUnit> packets_;
 };
\ No newline at end of file
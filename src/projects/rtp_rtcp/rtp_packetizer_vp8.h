@@ -42,12 +42,17 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
 // Packetizer for VP8.
-class RtpPacketizerVp8 : public RtpPacketizingManager 
+class RtpPacketizerVp8 final : public RtpPacketizingManager 
 {
 public:
 	// Initialize with Payload from encoder.
 	// The payload_data must be exactly one encoded VP8 frame.
 	RtpPacketizerVp8(const RTPVideoHeaderVP8& hdr_info, size_t max_payload_len, size_t last_packet_reduction_len);
+	// Made on the stack of each frame by the video pipeline of RtpPacketizer
+	RtpPacketizerVp8(const RTPVideoTypeHeader& codec_header, size_t max_payload_len)
+		: RtpPacketizerVp8(codec_header.vp8, max_payload_len, 0)
+	{
+	}
 
 	virtual ~RtpPacketizerVp8();
 
@@ -14,7 +14,8 @@ RtpPacketizingManager *RtpPacketizingManager::Create(RtpVideoCodecType type,
 			return new RtpPacketizerVp8(rtp_type_header->vp8, max_payload_len, last_packet_reduction_len);
 
 		case RtpVideoCodecType::H264:
-			return new RtpPacketizerH264(max_payload_len, last_packet_reduction_len, rtp_type_header->h264.packetization_mode);
+			return new RtpPacketizerH264(max_payload_len, last_packet_reduction_len, rtp_type_header->h264.packetization_mode,
+			                             rtp_type_header->h264.nal_units, rtp_type_header->h264.nal_unit_count);
 
 		case RtpVideoCodecType::None:
 			break;
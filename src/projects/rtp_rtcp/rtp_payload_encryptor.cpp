@@ -0,0 +1,105 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtp_payload_encryptor.h"
+#include "rtcp_packet.h"
+
+#include <base/ovlibrary/byte_io.h>
+#include <openssl/rand.h>
+
+#define OV_LOG_TAG "RtpRtcp.Encryptor"
+
+RtpPayloadEncryptor::~RtpPayloadEncryptor()
+{
+	if(_context != nullptr)
+	{
+		::EVP_CIPHER_CTX_free(_context);
+		_context = nullptr;
+	}
+
+	::OPENSSL_cleanse(_key, sizeof(_key));
+}
+
+bool RtpPayloadEncryptor::Initialize()
+{
+	if((::RAND_bytes(_key, sizeof(_key)) != 1) || (::RAND_bytes(_salt, sizeof(_salt)) != 1))
+	{
+		logte("Could not generate the media key");
+		return false;
+	}
+
+	_context = ::EVP_CIPHER_CTX_new();
+
+	// The key is scheduled once, only the IV is set for each packet
+	if((_context == nullptr) ||
+	   (::EVP_EncryptInit_ex(_context, ::EVP_aes_128_gcm(), nullptr, nullptr, nullptr) != 1) ||
+	   (::EVP_CIPHER_CTX_ctrl(_context, EVP_CTRL_GCM_SET_IVLEN, RTP_PAYLOAD_ENCRYPTION_SALT_SIZE, nullptr) != 1) ||
+	   (::EVP_EncryptInit_ex(_context, nullptr, nullptr, _key, nullptr) != 1))
+	{
+		logte("Could not initialize AES-128-GCM");
+		return false;
+	}
+
+	return true;
+}
+
+bool RtpPayloadEncryptor::Encrypt(RtpPacket *packet)
+{
+	if(_context == nullptr)
+	{
+		return false;
+	}
+
+	size_t payload_size = packet->PayloadSize();
+
+	if(packet->SetPayloadSize(payload_size + RTP_PAYLOAD_ENCRYPTION_OVERHEAD) == nullptr)
+	{
+		return false;
+	}
+
+	uint8_t *payload = packet->Payload();
+	uint64_t counter = _counter++;
+
+	// IV: salt XOR (0 (4) + counter (8))
+	uint8_t iv[RTP_PAYLOAD_ENCRYPTION_SALT_SIZE];
+
+	::memcpy(iv, _salt, sizeof(iv));
+
+	for(int index = 0; index < RTP_PAYLOAD_ENCRYPTION_COUNTER_SIZE; index++)
+	{
+		iv[sizeof(iv) - 1 - index] ^= static_cast<uint8_t>(counter >> (index * 8));
+	}
+
+	int length = 0;
+
+	if((::EVP_EncryptInit_ex(_context, nullptr, nullptr, nullptr, iv) != 1) ||
+	   (::EVP_EncryptUpdate(_context, payload, &length, payload, static_cast<int>(payload_size)) != 1) ||
+	   (::EVP_EncryptFinal_ex(_context, payload + length, &length) != 1) ||
+	   (::EVP_CIPHER_CTX_ctrl(_context, EVP_CTRL_GCM_GET_TAG, RTP_PAYLOAD_ENCRYPTION_TAG_SIZE, payload + payload_size) != 1))
+	{
+		logte("Could not encrypt the payload (seq: %u)", packet->SequenceNumber());
+		return false;
+	}
+
+	ByteWriter<uint64_t>::WriteBigEndian(payload + payload_size + RTP_PAYLOAD_ENCRYPTION_TAG_SIZE, counter);
+
+	return true;
+}
+
+std::shared_ptr<ov::Data> RtpPayloadEncryptor::MakeKeyPacket(uint32_t ssrc) const
+{
+	uint8_t key_salt[RTP_PAYLOAD_ENCRYPTION_KEY_SIZE + RTP_PAYLOAD_ENCRYPTION_SALT_SIZE];
+
+	::memcpy(key_salt, _key, RTP_PAYLOAD_ENCRYPTION_KEY_SIZE);
+	::memcpy(key_salt + RTP_PAYLOAD_ENCRYPTION_KEY_SIZE, _salt, RTP_PAYLOAD_ENCRYPTION_SALT_SIZE);
+
+	auto packet = RtcpPacket::MakeAppPacket(ssrc, RTP_PAYLOAD_ENCRYPTION_APP_SUBTYPE, RTP_PAYLOAD_ENCRYPTION_APP_NAME, key_salt, sizeof(key_salt));
+
+	::OPENSSL_cleanse(key_salt, sizeof(key_salt));
+
+	return packet;
+}
@@ -0,0 +1,58 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "rtp_packet.h"
+
+#include <openssl/evp.h>
+
+#define RTP_PAYLOAD_ENCRYPTION_KEY_SIZE		16
+#define RTP_PAYLOAD_ENCRYPTION_SALT_SIZE		12
+#define RTP_PAYLOAD_ENCRYPTION_TAG_SIZE		16
+#define RTP_PAYLOAD_ENCRYPTION_COUNTER_SIZE	8
+// Bytes which are appended to the payload
+#define RTP_PAYLOAD_ENCRYPTION_OVERHEAD		(RTP_PAYLOAD_ENCRYPTION_TAG_SIZE + RTP_PAYLOAD_ENCRYPTION_COUNTER_SIZE)
+
+// RTCP APP of the media key
+#define RTP_PAYLOAD_ENCRYPTION_APP_NAME		"OMEK"
+// AES-128-GCM
+#define RTP_PAYLOAD_ENCRYPTION_APP_SUBTYPE	1
+
+// Encrypt-once of the payloads which are shared by the sessions of a stream (research mode)
+//
+// - The payload of each media packet is encrypted once by the media key of the stream (AES-128-GCM)
+//       [RTP header] [encrypted payload] [tag (16)] [counter (8)]
+//   the IV is (salt XOR counter), and the header is not authenticated because the sessions rewrite it
+// - RED/FEC packets are made from the encrypted packets, so the receiver recovers the lost packets before decrypting
+// - The key is delivered to each session by RTCP APP (see MakeKeyPacket()) which is protected by SRTCP,
+//   so the SRTP of the sessions only needs to authenticate RTP (the hop-by-hop layer)
+class RtpPayloadEncryptor
+{
+public:
+	RtpPayloadEncryptor() = default;
+	~RtpPayloadEncryptor();
+
+	// Generates the media key
+	bool Initialize();
+
+	// The packet must be able to have RTP_PAYLOAD_ENCRYPTION_OVERHEAD more bytes
+	bool Encrypt(RtpPacket *packet);
+
+	// RTCP APP (name: RTP_PAYLOAD_ENCRYPTION_APP_NAME, subtype: RTP_PAYLOAD_ENCRYPTION_APP_SUBTYPE)
+	//     [key (16)] [salt (12)]
+	std::shared_ptr<ov::Data> MakeKeyPacket(uint32_t ssrc) const;
+
+private:
+	EVP_CIPHER_CTX *_context = nullptr;
+
+	uint8_t _key[RTP_PAYLOAD_ENCRYPTION_KEY_SIZE] = { 0 };
+	uint8_t _salt[RTP_PAYLOAD_ENCRYPTION_SALT_SIZE] = { 0 };
+
+	// Never repeated by the key (the packets of all tracks of the stream use it)
+	uint64_t _counter = 0;
+};
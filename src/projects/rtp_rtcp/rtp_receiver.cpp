@@ -0,0 +1,305 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "rtp_receiver.h"
+#include "../dtls_srtp/srtp_transport.h"
+
+#include <base/ovlibrary/byte_io.h>
+
+#include <chrono>
+
+#define OV_LOG_TAG "RtpReceiver"
+
+static int64_t GetCurrentMilliseconds()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RtpReceiver::RtpReceiver(uint32_t id, std::shared_ptr<Session> session)
+	: SessionNode(id, SessionNodeType::RtpRtcp, std::move(session))
+{
+	_ssrc = ov::Random::GenerateUInt32();
+}
+
+bool RtpReceiver::AddPayload(uint8_t payload_type, common::MediaCodecId codec_id, uint32_t clock_rate, bool nack_enabled, int64_t max_delay)
+{
+	auto depacketizer = RtpDepacketizer::Create(codec_id);
+
+	if((depacketizer == nullptr) || (clock_rate == 0))
+	{
+		logte("Cannot receive the payload type %u (codec: %d, clock rate: %u)", payload_type, static_cast<int>(codec_id), clock_rate);
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	auto &stream = _streams[payload_type];
+	stream.payload_type = payload_type;
+	stream.is_video = (codec_id == common::MediaCodecId::H264) || (codec_id == common::MediaCodecId::Vp8);
+	stream.jitter_buffer = std::make_unique<RtpJitterBuffer>(std::move(depacketizer), clock_rate, stream.is_video, nack_enabled, max_delay);
+
+	return true;
+}
+
+void RtpReceiver::SetFrameHandler(FrameHandler handler)
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	_frame_handler = std::move(handler);
+}
+
+void RtpReceiver::RequestKeyFrame()
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	for(auto &item : _streams)
+	{
+		if(item.second.is_video)
+		{
+			item.second.key_frame_requested = true;
+		}
+	}
+}
+
+std::vector<RtpReceiverStatistics> RtpReceiver::GetStatistics()
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	std::vector<RtpReceiverStatistics> statistics_list;
+
+	for(auto &item : _streams)
+	{
+		RtpReceiverStatistics statistics;
+
+		statistics.payload_type = item.first;
+		statistics.ssrc = item.second.ssrc;
+		statistics.received_bytes = item.second.received_bytes;
+		statistics.jitter_buffer = item.second.jitter_buffer->GetStatistics();
+
+		statistics_list.push_back(statistics);
+	}
+
+	return statistics_list;
+}
+
+size_t RtpReceiver::GetBufferedSize()
+{
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
+	size_t size = 0;
+
+	for(auto &item : _streams)
+	{
+		size += item.second.jitter_buffer->GetBufferedSize();
+	}
+
+	return size;
+}
+
+bool RtpReceiver::SendData(SessionNodeType from_node, const std::shared_ptr<ov::Data> &data)
+{
+	return false;
+}
+
+bool RtpReceiver::OnDataReceived(SessionNodeType from_node, const std::shared_ptr<const ov::Data> &data)
+{
+	// nothing to do before node start
+	if(GetState() != SessionNode::NodeState::Started)
+	{
+		logtd("SessionNode has not started, so the received data has been canceled.");
+		return false;
+	}
+
+	if(data->GetLength() < 2)
+	{
+		return false;
+	}
+
+	int64_t current_time = GetCurrentMilliseconds();
+	uint8_t packet_type = data->GetDataAs<uint8_t>()[1];
+
+	std::vector<std::pair<uint8_t, RtpFrame>> frames;
+	FrameHandler frame_handler;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		// RFC 5761 4: the payload type of RTCP is 192~223 (SR/RR/SDES/BYE/APP/RTPFB/PSFB)
+		if((packet_type >= 192) && (packet_type <= 223))
+		{
+			ProcessRtcp(data, current_time);
+			SendFeedbacks(current_time);
+
+			return true;
+		}
+
+		RtpReceivedPacket packet;
+
+		if(packet.Parse(data) == false)
+		{
+			logtd("Invalid RTP packet (%zu bytes)", data->GetLength());
+			return false;
+		}
+
+		auto item = _streams.find(packet.payload_type);
+
+		if(item == _streams.end())
+		{
+			logtd("The payload type %u is not negotiated", packet.payload_type);
+			return false;
+		}
+
+		auto &stream = item->second;
+
+		if(stream.ssrc != packet.ssrc)
+		{
+			if(stream.ssrc != 0)
+			{
+				logti("SSRC of the payload type %u is changed (%u -> %u)", packet.payload_type, stream.ssrc, packet.ssrc);
+			}
+
+			stream.ssrc = packet.ssrc;
+		}
+
+		stream.received_bytes += data->GetLength();
+
+		if(stream.jitter_buffer->InsertPacket(std::move(packet), current_time))
+		{
+			std::vector<RtpFrame> stream_frames;
+
+			stream.jitter_buffer->PopFrames(current_time, stream_frames);
+
+			for(auto &frame : stream_frames)
+			{
+				frames.emplace_back(stream.payload_type, std::move(frame));
+			}
+		}
+
+		SendFeedbacks(current_time);
+
+		frame_handler = _frame_handler;
+	}
+
+	// The frames are passed without the lock (the handler sends them to the media router)
+	if(frame_handler != nullptr)
+	{
+		for(auto &frame : frames)
+		{
+			frame_handler(frame.first, frame.second);
+		}
+	}
+
+	return true;
+}
+
+void RtpReceiver::ProcessRtcp(const std::shared_ptr<const ov::Data> &data, int64_t current_time)
+{
+	RtcpPacketType packet_type;
+	uint32_t payload_size;
+	int report_count;
+	size_t offset = 0;
+
+	// A compound RTCP packet can contain several RTCP packets (e.g. SR + SDES)
+	while(offset + RTCP_HEADER_SIZE <= data->GetLength())
+	{
+		auto packet = data->Subdata(offset);
+
+		if(RtcpPacket::IsRtcpPacket(packet, packet_type, payload_size, report_count) == false)
+		{
+			break;
+		}
+
+		// SSRC(4) NTP timestamp(8) RTP timestamp(4) packet count(4) octet count(4)
+		if((packet_type == RtcpPacketType::SR) && (payload_size >= 24))
+		{
+			auto buffer = packet->GetDataAs<uint8_t>();
+			uint32_t ssrc = ByteReader<uint32_t>::ReadBigEndian(&buffer[4]);
+
+			for(auto &item : _streams)
+			{
+				if(item.second.ssrc == ssrc)
+				{
+					item.second.last_sr = ByteReader<uint32_t>::ReadBigEndian(&buffer[10]);
+					item.second.last_sr_time = current_time;
+				}
+			}
+		}
+
+		offset += RTCP_HEADER_SIZE + payload_size;
+	}
+}
+
+void RtpReceiver::SendFeedbacks(int64_t current_time)
+{
+	std::vector<RtcpReceiverReport> reports;
+	bool send_report = (current_time - _last_rr_time) >= RTP_RECEIVER_RR_INTERVAL_MS;
+
+	for(auto &item : _streams)
+	{
+		auto &stream = item.second;
+
+		if(stream.ssrc == 0)
+		{
+			continue;
+		}
+
+		std::vector<uint16_t> sequence_numbers;
+
+		stream.jitter_buffer->GetNackList(current_time, sequence_numbers);
+
+		if(sequence_numbers.empty() == false)
+		{
+			SendRtcp(RtcpPacket::MakeNackPacket(_ssrc, stream.ssrc, sequence_numbers));
+		}
+
+		if(stream.is_video && (stream.key_frame_requested || stream.jitter_buffer->IsKeyFrameRequired()) &&
+		   ((current_time - stream.last_pli_time) >= RTP_RECEIVER_PLI_INTERVAL_MS))
+		{
+			logtd("PLI is sent (ssrc: %u)", stream.ssrc);
+
+			SendRtcp(RtcpPacket::MakePliPacket(_ssrc, stream.ssrc));
+
+			stream.last_pli_time = current_time;
+			stream.key_frame_requested = false;
+		}
+
+		if(send_report)
+		{
+			RtcpReceiverReport report;
+
+			stream.jitter_buffer->MakeReceiverReport(stream.ssrc, report);
+
+			if(stream.last_sr_time > 0)
+			{
+				report.lsr = stream.last_sr;
+				// 1/65536 seconds
+				report.dlsr = static_cast<uint32_t>((current_time - stream.last_sr_time) * 65536 / 1000);
+			}
+
+			reports.push_back(report);
+		}
+	}
+
+	if(send_report && (reports.empty() == false))
+	{
+		SendRtcp(RtcpPacket::MakeRrPacket(_ssrc, reports));
+		_last_rr_time = current_time;
+	}
+}
+
+bool RtpReceiver::SendRtcp(const std::shared_ptr<ov::Data> &packet)
+{
+	auto node = GetLowerNode();
+	auto srtp_transport = dynamic_cast<SrtpTransport *>(node.get());
+
+	if((packet == nullptr) || (srtp_transport == nullptr))
+	{
+		return false;
+	}
+
+	return srtp_transport->SendRtcpData(GetNodeType(), packet);
+}
@@ -0,0 +1,93 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/publisher/session_node.h>
+
+#include "rtp_jitter_buffer.h"
+
+#include <functional>
+#include <mutex>
+
+// Interval (ms) of RTCP RR
+#define RTP_RECEIVER_RR_INTERVAL_MS			(1000)
+// Interval (ms) of PLI while the video waits for a key frame
+#define RTP_RECEIVER_PLI_INTERVAL_MS		(500)
+
+// Statistics of a payload (for monitoring)
+struct RtpReceiverStatistics
+{
+	uint8_t payload_type = 0;
+	uint32_t ssrc = 0;
+	uint64_t received_bytes = 0;
+	RtpJitterBufferStatistics jitter_buffer;
+};
+
+// Receives the RTP/RTCP of the media which the peer sends (the top node of an ingest session, the reverse of RtpRtcp)
+//
+// - The packets of each payload type are reordered by RtpJitterBuffer, and the frames are passed to the frame handler
+// - NACK of the lost packets, PLI while the video waits for a key frame and RR are sent to the lower node (SRTP)
+// - The packets are processed by the thread of the ICE port, the feedbacks are sent when a packet is received
+class RtpReceiver : public SessionNode
+{
+public:
+	using FrameHandler = std::function<void(uint8_t payload_type, RtpFrame &frame)>;
+
+	RtpReceiver(uint32_t id, std::shared_ptr<Session> session);
+	~RtpReceiver() override = default;
+
+	// Media of the peer (the packets of the other payload types are dropped), must be called before Start()
+	bool AddPayload(uint8_t payload_type, common::MediaCodecId codec_id, uint32_t clock_rate, bool nack_enabled, int64_t max_delay = RTP_JITTER_BUFFER_DEFAULT_MAX_DELAY_MS);
+	void SetFrameHandler(FrameHandler handler);
+
+	// Asks the peer for a key frame of the video (e.g. a new viewer)
+	void RequestKeyFrame();
+
+	std::vector<RtpReceiverStatistics> GetStatistics();
+	size_t GetBufferedSize();
+
+	// Implement SessionNode Interface
+	// RtpReceiver는 최상위 노드로 SendData를 사용하지 않는다.
+	bool SendData(SessionNodeType from_node, const std::shared_ptr<ov::Data> &data) override;
+	// Lower Node(SRTP)로부터 데이터를 받는다.
+	bool OnDataReceived(SessionNodeType from_node, const std::shared_ptr<const ov::Data> &data) override;
+
+private:
+	struct ReceiveStream
+	{
+		uint8_t payload_type = 0;
+		bool is_video = false;
+		// 0 until the first packet is received
+		uint32_t ssrc = 0;
+		std::unique_ptr<RtpJitterBuffer> jitter_buffer;
+
+		uint64_t received_bytes = 0;
+		int64_t last_pli_time = 0;
+		bool key_frame_requested = false;
+
+		// The middle 32 bits of the NTP timestamp of the last SR, and the time (ms) when it is received
+		uint32_t last_sr = 0;
+		int64_t last_sr_time = 0;
+	};
+
+	// RTCP of the sender (SR is used for LSR/DLSR of RR) (_mutex must be locked)
+	void ProcessRtcp(const std::shared_ptr<const ov::Data> &data, int64_t current_time);
+	// Sends NACK, PLI and RR if needed (_mutex must be locked)
+	void SendFeedbacks(int64_t current_time);
+	bool SendRtcp(const std::shared_ptr<ov::Data> &packet);
+
+	std::mutex _mutex;
+
+	// key: payload type
+	std::map<uint8_t, ReceiveStream> _streams;
+	FrameHandler _frame_handler;
+
+	// SSRC of the RTCP which this receiver sends
+	uint32_t _ssrc;
+	int64_t _last_rr_time = 0;
+};
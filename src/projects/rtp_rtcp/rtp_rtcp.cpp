@@ -1,10 +1,10 @@
 #include "rtp_rtcp.h"
 #include "../webrtc/rtc_application.h"
 #include "../webrtc/rtc_stream.h"
+#include "../dtls_srtp/srtp_egress_path.h"
 #include <base/ovlibrary/byte_io.h>
 
 #define OV_LOG_TAG "RtpRtcp"
-#define RTCP_AA_SEND_SEQUENCE (1000)
 
 RtpRtcp::RtpRtcp(uint32_t id, std::shared_ptr<Session> session, const std::vector<uint32_t> &ssrc_list)
 	        : SessionNode(id, SessionNodeType::RtpRtcp, session)
@@ -20,49 +20,368 @@ RtpRtcp::~RtpRtcp()
 {
 }
 
-bool RtpRtcp::SendOutgoingData(std::shared_ptr<ov::Data> packet)
+bool RtpRtcp::SendOutgoingData(const std::shared_ptr<const ov::Data> &packet)
 {
-	// Lower Node is SRTP
-	auto node = GetLowerNode();
+	std::lock_guard<std::mutex> lock(_send_mutex);
 
-	if(!node)
+	// Lower Node is SRTP (not used once the egress path is compiled)
+	std::shared_ptr<SessionNode> node;
+
+	if((_egress_path == nullptr) && ((node = GetLowerNode()) == nullptr))
 	{
 		return false;
 	}
 
-	if(_first_receiver_report_time != 0)
-    {
-        auto byte_buffer = packet->GetDataAs<uint8_t>();
-        uint32_t ssrc = ByteReader<uint32_t>::ReadBigEndian(&byte_buffer[8]);
+	EnqueuePacket(packet);
 
-        // rtcp aa packet send ( per 1000)
-        for(auto &rtcp_info : _rtcp_infos)
-        {
-            if(rtcp_info->ssrc == ssrc)
-            {
-                if (rtcp_info->sequence_number == 0)
-                {
-                    logtd("Send rtcp sr packet - ssrc(%u)", ssrc);
+	//logtd("RtpRtcp Send next node : %d", packet->GetData()->GetLength());
+	SendPacedPackets(node);
 
-                    if (!dynamic_cast<SrtpTransport *>(node.get())->SendRtcpData(GetNodeType(),
-                            RtcpPacket::MakeSrPacket(ssrc)))
-                    {
-                        logtw("Rtcp sr packet send fail - ssrc(%u)", ssrc);
-                    }
-                }
+	return true;
+}
 
-                rtcp_info->sequence_number++;
+bool RtpRtcp::SendOutgoingData(const std::vector<std::shared_ptr<const ov::Data>> &packets)
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
 
-                if(rtcp_info->sequence_number >= RTCP_AA_SEND_SEQUENCE)
-                    rtcp_info->sequence_number = 0;
+	// Lower Node is SRTP (not used once the egress path is compiled)
+	std::shared_ptr<SessionNode> node;
 
-                break;
-            }
-        }
-    }
+	if((_egress_path == nullptr) && ((node = GetLowerNode()) == nullptr))
+	{
+		return false;
+	}
 
-	//logtd("RtpRtcp Send next node : %d", packet->GetData()->GetLength());
-	return node->SendData(GetNodeType(), packet);
+	for(auto &packet : packets)
+	{
+		EnqueuePacket(packet);
+	}
+
+	SendPacedPackets(node);
+
+	return true;
+}
+
+int64_t RtpRtcp::ProcessPacing()
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	std::shared_ptr<SessionNode> node;
+
+	if((_egress_path == nullptr) && ((node = GetLowerNode()) == nullptr))
+	{
+		return -1;
+	}
+
+	SendPacedPackets(node);
+
+	return _pacer.GetNextSendDelay();
+}
+
+void RtpRtcp::EnqueuePacket(const std::shared_ptr<const ov::Data> &packet)
+{
+	bool rebase = false;
+
+	if(packet->GetLength() >= FIXED_HEADER_SIZE)
+	{
+		uint32_t ssrc = ByteReader<uint32_t>::ReadBigEndian(&(packet->GetDataAs<uint8_t>()[8]));
+		auto rewrite_item = _sequence_rewrite_infos.find(ssrc);
+
+		if(rewrite_item != _sequence_rewrite_infos.end())
+		{
+			// The packets of the previous layer in the queue keep their sequence numbers
+			rebase = rewrite_item->second.rebase;
+			rewrite_item->second.rebase = false;
+		}
+	}
+
+	_pacer.Enqueue(packet, rebase);
+}
+
+bool RtpRtcp::SendPacedPackets(const std::shared_ptr<SessionNode> &node)
+{
+	int64_t current_time_us = BandwidthEstimator::GetCurrentMicroseconds();
+
+	_pacer.SetEstimatedBitrate(_bandwidth_estimator.HasEstimate(current_time_us) ? _bandwidth_estimator.GetEstimatedBitrate(current_time_us) : 0);
+
+	// The kernel smooths the bursts of the pacer with the same rate (updated only when it is changed enough)
+	uint64_t pacing_rate = _pacer.GetPacingRate();
+	uint64_t rate_difference = (pacing_rate > _kernel_pacing_rate) ? (pacing_rate - _kernel_pacing_rate) : (_kernel_pacing_rate - pacing_rate);
+
+	if(rate_difference > (_kernel_pacing_rate / RTP_RTCP_KERNEL_PACING_RATE_STEP))
+	{
+		_kernel_pacing_rate = pacing_rate;
+		std::static_pointer_cast<RtcSession>(GetSession())->SetPacingRate(pacing_rate);
+	}
+
+	_send_batch.clear();
+
+	RtpPacer::PacedPacket paced_packet;
+	int64_t current_time = current_time_us / 1000;
+
+	while(_pacer.Dequeue(current_time, paced_packet))
+	{
+		auto send_buffer = PrepareSendBuffer(node, _send_batch.size(), paced_packet.packet, paced_packet.rebase);
+
+		if(send_buffer != nullptr)
+		{
+			_send_batch.push_back(send_buffer);
+		}
+	}
+
+	if(_send_batch.empty())
+	{
+		return false;
+	}
+
+	// SRTP protects all packets in one pass, and ICE sends them with a single syscall
+	if(_egress_path != nullptr)
+	{
+		return _egress_path->SendRtp(_send_batch);
+	}
+
+	return node->SendDataBatch(GetNodeType(), _send_batch);
+}
+
+std::shared_ptr<ov::Data> RtpRtcp::PrepareSendBuffer(const std::shared_ptr<SessionNode> &node, size_t index, const std::shared_ptr<const ov::Data> &packet, bool rebase)
+{
+	auto byte_buffer = packet->GetDataAs<uint8_t>();
+	uint32_t ssrc = ByteReader<uint32_t>::ReadBigEndian(&byte_buffer[8]);
+	uint16_t sequence_number = ByteReader<uint16_t>::ReadBigEndian(&byte_buffer[2]);
+	uint16_t sequence_number_offset = 0;
+	uint16_t sn_base_offset = 0;
+
+	auto rewrite_item = _sequence_rewrite_infos.find(ssrc);
+
+	if(rewrite_item != _sequence_rewrite_infos.end())
+	{
+		auto &rewrite_info = rewrite_item->second;
+
+		if(rebase && rewrite_info.sent)
+		{
+			rewrite_info.offset = static_cast<uint16_t>(rewrite_info.last_sequence_number + 1 - sequence_number);
+		}
+
+		if(rebase || (rewrite_info.sent == false))
+		{
+			rewrite_info.rebase_sequence_number = sequence_number;
+		}
+
+		rewrite_info.sent = true;
+
+		sequence_number_offset = rewrite_info.offset;
+		sequence_number += sequence_number_offset;
+		rewrite_info.last_sequence_number = sequence_number;
+	}
+
+	if((_flexfec_ssrc != 0) && (ssrc == _flexfec_ssrc) && (PrepareFlexfecPacket(packet, sn_base_offset) == false))
+	{
+		return nullptr;
+	}
+
+	if(_retransmit_infos.find(ssrc) != _retransmit_infos.end())
+	{
+		// Keep the packet for retransmission (only the reference is kept because the packet is immutable)
+		_rtp_history.Store(packet, RtpPacketHistory::GetCurrentMilliseconds(), sequence_number);
+	}
+
+	for(auto &rtcp_info : _rtcp_infos)
+	{
+		if(rtcp_info->ssrc == ssrc)
+		{
+			size_t header_size = GetRtpHeaderSize(byte_buffer, packet->GetLength());
+			size_t padding_size = ((byte_buffer[0] & 0x20) != 0) ? byte_buffer[packet->GetLength() - 1] : 0;
+
+			rtcp_info->packet_count++;
+			if(packet->GetLength() >= header_size + padding_size)
+			{
+				rtcp_info->octet_count += static_cast<uint32_t>(packet->GetLength() - header_size - padding_size);
+			}
+			rtcp_info->rtp_timestamp = ByteReader<uint32_t>::ReadBigEndian(&byte_buffer[4]);
+			rtcp_info->send_time = RtpPacketHistory::GetCurrentMilliseconds();
+			break;
+		}
+	}
+
+	while(_send_buffers.size() <= index)
+	{
+		_send_buffers.push_back(std::make_shared<ov::Data>(DEFAULT_MAX_PACKET_SIZE + RTP_SEND_BUFFER_TRAILER_SIZE));
+	}
+
+	auto &send_buffer = _send_buffers[index];
+
+	// Copy the shared packet to the send buffer of this session.
+	// If a lower node still holds the previous data, copy-on-write keeps it intact.
+	send_buffer->SetLength(0);
+	if((send_buffer->Reserve(packet->GetLength() + RTP_SEND_BUFFER_TRAILER_SIZE) == false) ||
+	   (send_buffer->Append(packet.get()) == false))
+	{
+		logte("Could not copy the packet to the send buffer (%zu bytes)", packet->GetLength());
+		return nullptr;
+	}
+
+	if(sequence_number_offset != 0)
+	{
+		ApplySequenceNumberOffset(send_buffer, sequence_number_offset);
+	}
+
+	ApplyPayloadTypeMap(send_buffer);
+
+	if(sn_base_offset != 0)
+	{
+		// [RTP header] [FlexFEC header: R/F/P/X/CC(1) M/PT recovery(1) length recovery(2) TS recovery(4) SN base(2) ...]
+		auto sn_base = &(send_buffer->GetWritableDataAs<uint8_t>()[GetRtpHeaderSize(byte_buffer, packet->GetLength()) + 8]);
+		ByteWriter<uint16_t>::WriteBigEndian(sn_base, ByteReader<uint16_t>::ReadBigEndian(sn_base) + sn_base_offset);
+	}
+
+	if(_extension_map.IsEmpty() == false)
+	{
+		StampHeaderExtensions(send_buffer);
+	}
+
+	return send_buffer;
+}
+
+bool RtpRtcp::PrepareFlexfecPacket(const std::shared_ptr<const ov::Data> &packet, uint16_t &sn_base_offset)
+{
+	auto buffer = packet->GetDataAs<uint8_t>();
+	size_t header_size = GetRtpHeaderSize(buffer, packet->GetLength());
+
+	if((header_size == 0) || (packet->GetLength() < header_size + 10))
+	{
+		return false;
+	}
+
+	auto media_item = _sequence_rewrite_infos.find(_flexfec_media_ssrc);
+
+	if(media_item == _sequence_rewrite_infos.end())
+	{
+		sn_base_offset = 0;
+		return true;
+	}
+
+	auto &media_info = media_item->second;
+	uint16_t sn_base = ByteReader<uint16_t>::ReadBigEndian(&buffer[header_size + 8]);
+
+	// The block started before the session joined or the layer was switched
+	if((media_info.sent == false) || (static_cast<int16_t>(sn_base - media_info.rebase_sequence_number) < 0))
+	{
+		auto fec_item = _sequence_rewrite_infos.find(_flexfec_ssrc);
+
+		if(fec_item != _sequence_rewrite_infos.end())
+		{
+			// The next FEC packet continues the sequence number
+			fec_item->second.offset--;
+			fec_item->second.last_sequence_number--;
+		}
+
+		return false;
+	}
+
+	sn_base_offset = media_info.offset;
+
+	return true;
+}
+
+void RtpRtcp::SetEgressPath(const std::shared_ptr<SrtpEgressPath> &egress_path)
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	_egress_path = egress_path;
+}
+
+void RtpRtcp::SetMediaKeyPacket(const std::shared_ptr<const ov::Data> &key_packet)
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	_media_key_packet = key_packet;
+}
+
+void RtpRtcp::SetClockRate(uint32_t ssrc, uint32_t clock_rate)
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	for(auto &rtcp_info : _rtcp_infos)
+	{
+		if(rtcp_info->ssrc == ssrc)
+		{
+			rtcp_info->clock_rate = clock_rate;
+		}
+	}
+}
+
+bool RtpRtcp::SendSenderReports(const RtcpSrTemplate &sr_template)
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	std::shared_ptr<SessionNode> node;
+
+	if((_first_receiver_report_time == 0) || ((_egress_path == nullptr) && ((node = GetLowerNode()) == nullptr)))
+	{
+		return false;
+	}
+
+	if(_report_buffer == nullptr)
+	{
+		_report_buffer = std::make_shared<ov::Data>(DEFAULT_MAX_PACKET_SIZE);
+	}
+
+	_report_buffer->SetLength(0);
+
+	for(auto &rtcp_info : _rtcp_infos)
+	{
+		if(rtcp_info->packet_count == 0)
+		{
+			continue;
+		}
+
+		uint32_t rtp_timestamp = rtcp_info->rtp_timestamp;
+
+		if((rtcp_info->clock_rate != 0) && (sr_template.time > rtcp_info->send_time))
+		{
+			rtp_timestamp += static_cast<uint32_t>((sr_template.time - rtcp_info->send_time) * rtcp_info->clock_rate / 1000);
+		}
+
+		size_t offset = _report_buffer->GetLength();
+
+		_report_buffer->Append(sr_template.packet, RTCP_SR_PACKET_SIZE);
+		RtcpPacket::PatchSrPacket(_report_buffer->GetWritableDataAs<uint8_t>() + offset, rtcp_info->ssrc,
+		                          rtp_timestamp, rtcp_info->packet_count, rtcp_info->octet_count);
+	}
+
+	if(_report_buffer->GetLength() == 0)
+	{
+		return false;
+	}
+
+	// RTCP may be lost, so the key is sent again with each SR
+	if(_media_key_packet != nullptr)
+	{
+		_report_buffer->Append(_media_key_packet.get());
+	}
+
+	// SRTCP is protected in place
+	if(_report_buffer->Reserve(_report_buffer->GetLength() + RTCP_SEND_BUFFER_TRAILER_SIZE) == false)
+	{
+		return false;
+	}
+
+	bool sent = (_egress_path != nullptr) ? _egress_path->SendRtcp(_report_buffer) :
+	            dynamic_cast<SrtpTransport *>(node.get())->SendRtcpData(GetNodeType(), _report_buffer);
+
+	if(sent == false)
+	{
+		logtw("Could not send the RTCP sender reports (%zu bytes)", _report_buffer->GetLength());
+	}
+
+	return sent;
+}
+
+bool RtpRtcp::HasEgressPath()
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	return (_egress_path != nullptr);
 }
 
 bool RtpRtcp::SendData(SessionNodeType from_node, const std::shared_ptr<ov::Data> &data)
@@ -86,24 +405,59 @@ bool RtpRtcp::OnDataReceived(SessionNodeType from_node, const std::shared_ptr<co
     RtcpPacketType packet_type;
     uint32_t payload_size;
     int report_count;
+    bool processed = false;
+    size_t offset = 0;
 
-    // rtcp packet check
-    if (!RtcpPacket::IsRtcpPacket(data, packet_type, payload_size, report_count) || report_count <= 0)
+    // A compound RTCP packet can contain several RTCP packets (e.g. RR + NACK)
+    while(offset + RTCP_HEADER_SIZE <= data->GetLength())
     {
-        logtd("Packet is not RTCP",RtcpPacket::GetPacketTypeString(packet_type).CStr());
-        return false;
+        auto packet = data->Subdata(offset);
+
+        // rtcp packet check
+        if (!RtcpPacket::IsRtcpPacket(packet, packet_type, payload_size, report_count))
+        {
+            logtd("Packet is not RTCP");
+            break;
+        }
+
+        if(RtcpPacketProcess(packet_type, payload_size, report_count, packet))
+        {
+            processed = true;
+        }
+
+        offset += RTCP_HEADER_SIZE + payload_size;
     }
 
-    return RtcpPacketProcess(packet_type, payload_size, report_count, data);
+    return processed;
 }
 
 // rtcp packet process
-// - current process only RR type
+// - RR, Generic NACK, Transport-wide CC, REMB and PLI/FIR
 bool RtpRtcp::RtcpPacketProcess(RtcpPacketType packet_type,
                                uint32_t payload_size,
                                int report_count,
                                const std::shared_ptr<const ov::Data> &data)
 {
+    if(packet_type == RtcpPacketType::RTPFB)
+    {
+        if(report_count == RTCP_RTPFB_FMT_TRANSPORT_CC)
+        {
+            return TransportCcProcess(data, report_count);
+        }
+
+        return NackProcess(data, report_count);
+    }
+
+    if(packet_type == RtcpPacketType::PSFB)
+    {
+        if(report_count == RTCP_PSFB_FMT_PLI || report_count == RTCP_PSFB_FMT_FIR)
+        {
+            return KeyFrameRequestProcess(data, report_count);
+        }
+
+        return RembProcess(data, report_count);
+    }
+
     // Receiver Report
     if (packet_type != RtcpPacketType::RR)
     {
@@ -111,6 +465,12 @@ bool RtpRtcp::RtcpPacketProcess(RtcpPacketType packet_type,
         return false;
     }
 
+    if(report_count <= 0)
+    {
+        // RR without report block (player has not received any packet yet)
+        return false;
+    }
+
     std::vector<std::shared_ptr<RtcpReceiverReport>> receiver_reports;
 
     if (!RtcpPacket::RrParseing(report_count, data,  receiver_reports) )
@@ -131,6 +491,9 @@ bool RtpRtcp::RtcpPacketProcess(RtcpPacketType packet_type,
     //      data->GetLength(),
     //      report_count);
 
+    // All reports feed the histograms of the stream, the details are kept only for the sampled sessions
+    auto qoe_statistics = GetSession()->GetStream()->GetQoeStatistics();
+
     for(const auto &receiver_report : receiver_reports)
     {
         // RR info setting
@@ -139,6 +502,516 @@ bool RtpRtcp::RtcpPacketProcess(RtcpPacketType packet_type,
             GetSession()->GetId(),
             _first_receiver_report_time,
             receiver_report);
+
+        uint32_t clock_rate = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(_send_mutex);
+            _bandwidth_estimator.OnFractionLost(receiver_report->fraction_lost);
+
+            for(const auto &rtcp_info : _rtcp_infos)
+            {
+                if(rtcp_info->ssrc == receiver_report->ssrc_1)
+                {
+                    clock_rate = rtcp_info->clock_rate;
+                    break;
+                }
+            }
+        }
+
+        if(qoe_statistics != nullptr)
+        {
+            // The jitter is in the RTP timestamp units, and RTT can be calculated only if the player reports LSR
+            int64_t jitter = (clock_rate > 0) ? static_cast<int64_t>(receiver_report->jitter) * 1000000 / clock_rate : -1;
+            int64_t rtt = (receiver_report->lsr != 0) ? static_cast<int64_t>(receiver_report->rtt * 1000000.0) : -1;
+
+            qoe_statistics->OnReceiverReport(GetSession()->GetId(), receiver_report->fraction_lost, receiver_report->packet_lost, jitter, rtt);
+        }
+
+        // The loss rate is used to select the video layer
+        std::static_pointer_cast<RtcSession>(GetSession())->OnReceiverReport(receiver_report);
 	}
     return true;
 }
+
+bool RtpRtcp::RembProcess(const std::shared_ptr<const ov::Data> &data, int report_count)
+{
+	RtcpRemb remb;
+
+	if(RtcpPacket::RembParsing(report_count, data, remb) == false)
+	{
+		logtd("RTCP(psfb) packet is not a REMB (fmt: %d)", report_count);
+		return false;
+	}
+
+	uint64_t estimated_bitrate;
+
+	{
+		std::lock_guard<std::mutex> lock(_send_mutex);
+		int64_t current_time = BandwidthEstimator::GetCurrentMicroseconds();
+
+		_bandwidth_estimator.OnRemb(remb.bitrate, current_time);
+		estimated_bitrate = _bandwidth_estimator.GetEstimatedBitrate(current_time);
+	}
+
+	// The session may switch the layer (which locks _send_mutex)
+	std::static_pointer_cast<RtcSession>(GetSession())->OnEstimatedBitrate(estimated_bitrate);
+
+	return true;
+}
+
+bool RtpRtcp::KeyFrameRequestProcess(const std::shared_ptr<const ov::Data> &data, int report_count)
+{
+	std::vector<uint32_t> media_ssrcs;
+
+	if(RtcpPacket::KeyFrameRequestParsing(report_count, data, media_ssrcs) == false)
+	{
+		logtd("RTCP(psfb) key frame request parsing fail (fmt: %d)", report_count);
+		return false;
+	}
+
+	auto session = std::static_pointer_cast<RtcSession>(GetSession());
+
+	for(auto media_ssrc : media_ssrcs)
+	{
+		session->OnKeyFrameRequested(media_ssrc);
+	}
+
+	return true;
+}
+
+bool RtpRtcp::TransportCcProcess(const std::shared_ptr<const ov::Data> &data, int report_count)
+{
+	RtcpTransportCc transport_cc;
+
+	if(RtcpPacket::TransportCcParsing(report_count, data, transport_cc) == false)
+	{
+		logtd("RTCP(rtpfb) transport-wide CC feedback parsing fail");
+		return false;
+	}
+
+	uint64_t estimated_bitrate;
+
+	{
+		std::lock_guard<std::mutex> lock(_send_mutex);
+		int64_t current_time = BandwidthEstimator::GetCurrentMicroseconds();
+
+		_bandwidth_estimator.OnTransportFeedback(transport_cc, current_time);
+		estimated_bitrate = _bandwidth_estimator.GetEstimatedBitrate(current_time);
+	}
+
+	std::static_pointer_cast<RtcSession>(GetSession())->OnEstimatedBitrate(estimated_bitrate);
+
+	return true;
+}
+
+void RtpRtcp::SetHeaderExtensions(const RtpHeaderExtensionMap &stream_map, const RtpHeaderExtensionMap &peer_map)
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	_extension_map = stream_map;
+
+	for(size_t index = 0; index < static_cast<size_t>(RtpHeaderExtensionType::NumberOfTypes); index++)
+	{
+		_peer_extension_ids[index] = peer_map.GetId(static_cast<RtpHeaderExtensionType>(index));
+	}
+}
+
+uint64_t RtpRtcp::GetEstimatedBitrate()
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	return _bandwidth_estimator.GetEstimatedBitrate(BandwidthEstimator::GetCurrentMicroseconds());
+}
+
+void RtpRtcp::SetMaxPacingRate(uint64_t rate)
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	_pacer.SetMaxRate(rate);
+}
+
+size_t RtpRtcp::GetMemoryUsage()
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	size_t memory_usage = _rtp_history.GetMemoryUsage() + _pacer.GetQueuedBytes();
+
+	for(const auto &send_buffer : _send_buffers)
+	{
+		memory_usage += send_buffer->GetCapacity();
+	}
+
+	if(_retransmit_buffer != nullptr)
+	{
+		memory_usage += _retransmit_buffer->GetCapacity();
+	}
+
+	if(_rewrite_buffer != nullptr)
+	{
+		memory_usage += _rewrite_buffer->GetCapacity();
+	}
+
+	return memory_usage;
+}
+
+void RtpRtcp::StampHeaderExtensions(const std::shared_ptr<ov::Data> &packet)
+{
+	auto buffer = packet->GetWritableDataAs<uint8_t>();
+	size_t length = packet->GetLength();
+
+	if((length < FIXED_HEADER_SIZE) || ((buffer[0] & 0x10) == 0))
+	{
+		return;
+	}
+
+	// [fixed header] [CSRCs] [0xBEDE(2) length(2)] [ID(4) L(4) data(L+1)]...
+	size_t offset = FIXED_HEADER_SIZE + (buffer[0] & 0x0F) * 4;
+	size_t extension_size = _extension_map.GetSize();
+
+	// All packets of the stream have the same layout (the packetizers use the stream map)
+	if((length < offset + extension_size) ||
+	   (ByteReader<uint16_t>::ReadBigEndian(&buffer[offset]) != ONE_BYTE_EXTENSION_ID) ||
+	   (static_cast<size_t>(ByteReader<uint16_t>::ReadBigEndian(&buffer[offset + 2])) * 4 + RTP_EXTENSION_HEADER_SIZE != extension_size))
+	{
+		return;
+	}
+
+	auto extension = &buffer[offset];
+
+	for(size_t index = 0; index < static_cast<size_t>(RtpHeaderExtensionType::NumberOfTypes); index++)
+	{
+		auto type = static_cast<RtpHeaderExtensionType>(index);
+		uint8_t id = _extension_map.GetId(type);
+
+		if(id == 0)
+		{
+			continue;
+		}
+
+		auto element = &extension[_extension_map.GetOffset(type)];
+		uint8_t peer_id = _peer_extension_ids[index];
+
+		if((element[0] >> 4) != id)
+		{
+			// Erased already (e.g. the packet is retransmitted)
+			continue;
+		}
+
+		if(peer_id == 0)
+		{
+			// The peer didn't negotiate it, so it becomes the padding (the id of the stream may mean another extension for the peer)
+			::memset(element, 0, 1 + RtpHeaderExtensionMap::GetDataSize(type));
+			continue;
+		}
+
+		switch(type)
+		{
+			case RtpHeaderExtensionType::TransportCc:
+			{
+				uint16_t sequence_number = _transport_sequence_number++;
+
+				ByteWriter<uint16_t>::WriteBigEndian(&element[1], sequence_number);
+				_bandwidth_estimator.OnPacketSent(sequence_number, length, BandwidthEstimator::GetCurrentMicroseconds());
+				break;
+			}
+
+			case RtpHeaderExtensionType::AbsSendTime:
+			{
+				uint32_t abs_send_time = RtpHeaderExtensionMap::MakeAbsSendTime(BandwidthEstimator::GetCurrentMicroseconds());
+
+				element[1] = static_cast<uint8_t>(abs_send_time >> 16);
+				element[2] = static_cast<uint8_t>(abs_send_time >> 8);
+				element[3] = static_cast<uint8_t>(abs_send_time);
+				break;
+			}
+
+			default:
+				break;
+		}
+
+		if(peer_id != id)
+		{
+			element[0] = static_cast<uint8_t>((peer_id << 4) | (element[0] & 0x0F));
+		}
+	}
+}
+
+void RtpRtcp::EnableNack(uint32_t media_ssrc)
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	_retransmit_infos[media_ssrc];
+}
+
+void RtpRtcp::EnableFlexfec(uint32_t flexfec_ssrc, uint32_t media_ssrc)
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	_flexfec_ssrc = flexfec_ssrc;
+	_flexfec_media_ssrc = media_ssrc;
+}
+
+void RtpRtcp::EnableSequenceNumberRewriting(uint32_t ssrc)
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	_sequence_rewrite_infos[ssrc];
+}
+
+void RtpRtcp::RebaseSequenceNumber(uint32_t ssrc)
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	auto item = _sequence_rewrite_infos.find(ssrc);
+
+	if(item != _sequence_rewrite_infos.end())
+	{
+		item->second.rebase = true;
+	}
+}
+
+void RtpRtcp::SetPayloadTypeMap(const std::map<uint8_t, uint8_t> &payload_type_map)
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	_payload_type_map = payload_type_map;
+}
+
+void RtpRtcp::ApplyPayloadTypeMap(const std::shared_ptr<ov::Data> &packet)
+{
+	if(_payload_type_map.empty() || (packet->GetLength() < FIXED_HEADER_SIZE))
+	{
+		return;
+	}
+
+	// [V/P/X/CC(1)] [M/PT(1)] ...
+	auto &marker_payload_type = packet->GetWritableDataAs<uint8_t>()[1];
+	auto item = _payload_type_map.find(marker_payload_type & 0x7F);
+
+	if(item != _payload_type_map.end())
+	{
+		marker_payload_type = static_cast<uint8_t>((marker_payload_type & 0x80) | (item->second & 0x7F));
+	}
+}
+
+void RtpRtcp::EnableRtx(uint32_t media_ssrc, uint32_t rtx_ssrc, uint8_t rtx_payload_type)
+{
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	auto &rtx_info = _retransmit_infos[media_ssrc];
+
+	rtx_info.ssrc = rtx_ssrc;
+	rtx_info.payload_type = rtx_payload_type;
+	rtx_info.sequence_number = static_cast<uint16_t>(rand());
+}
+
+bool RtpRtcp::NackProcess(const std::shared_ptr<const ov::Data> &data, int report_count)
+{
+	RtcpNack nack;
+
+	if(RtcpPacket::NackParsing(report_count, data, nack) == false)
+	{
+		logtd("RTCP(rtpfb) packet is not a generic NACK (fmt: %d)", report_count);
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(_send_mutex);
+
+	std::shared_ptr<SessionNode> node;
+
+	if((_egress_path == nullptr) && ((node = GetLowerNode()) == nullptr))
+	{
+		return false;
+	}
+
+	if(_retransmit_infos.find(nack.media_ssrc) == _retransmit_infos.end())
+	{
+		logtd("NACK is not enabled for ssrc(%u)", nack.media_ssrc);
+		return false;
+	}
+
+	int64_t current_time = RtpPacketHistory::GetCurrentMilliseconds();
+	size_t retransmit_count = 0;
+
+	for(auto sequence_number : nack.lost_sequence_numbers)
+	{
+		if(CheckRetransmitRate(current_time) == false)
+		{
+			logtd("Retransmission rate limit is exceeded - ssrc(%u)", nack.media_ssrc);
+			break;
+		}
+
+		if(RetransmitPacket(node, nack.media_ssrc, sequence_number, current_time))
+		{
+			retransmit_count++;
+		}
+	}
+
+	logtd("NACK received - ssrc(%u) requested(%zu) retransmitted(%zu)",
+	      nack.media_ssrc, nack.lost_sequence_numbers.size(), retransmit_count);
+
+	return true;
+}
+
+bool RtpRtcp::CheckRetransmitRate(int64_t current_time)
+{
+	if((current_time - _retransmit_window_start_time) >= 1000)
+	{
+		_retransmit_window_start_time = current_time;
+		_retransmit_count_in_window = 0;
+	}
+
+	return (_retransmit_count_in_window < RTP_MAX_RETRANSMIT_PER_SECOND);
+}
+
+bool RtpRtcp::RetransmitPacket(const std::shared_ptr<SessionNode> &node, uint32_t media_ssrc, uint16_t sequence_number, int64_t current_time)
+{
+	auto packet = _rtp_history.GetForRetransmit(media_ssrc, sequence_number, current_time);
+
+	if(packet == nullptr)
+	{
+		return false;
+	}
+
+	// The packet in the history has the sequence number of the packetizer
+	auto sequence_number_offset = static_cast<uint16_t>(sequence_number - ByteReader<uint16_t>::ReadBigEndian(&(packet->GetDataAs<uint8_t>()[2])));
+
+	if(sequence_number_offset != 0)
+	{
+		if(_rewrite_buffer == nullptr)
+		{
+			_rewrite_buffer = std::make_shared<ov::Data>(DEFAULT_MAX_PACKET_SIZE);
+		}
+
+		_rewrite_buffer->SetLength(0);
+
+		if(_rewrite_buffer->Append(packet.get()) == false)
+		{
+			return false;
+		}
+
+		ApplySequenceNumberOffset(_rewrite_buffer, sequence_number_offset);
+		packet = _rewrite_buffer;
+	}
+
+	if(_retransmit_buffer == nullptr)
+	{
+		_retransmit_buffer = std::make_shared<ov::Data>(DEFAULT_MAX_PACKET_SIZE + RTX_OSN_SIZE + RTP_SEND_BUFFER_TRAILER_SIZE);
+	}
+
+	auto &rtx_info = _retransmit_infos[media_ssrc];
+
+	_retransmit_buffer->SetLength(0);
+
+	if(rtx_info.payload_type != 0)
+	{
+		if(MakeRtxPacket(packet, rtx_info, _retransmit_buffer) == false)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		// Retransmit the original packet as it is
+		if((_retransmit_buffer->Reserve(packet->GetLength() + RTP_SEND_BUFFER_TRAILER_SIZE) == false) ||
+		   (_retransmit_buffer->Append(packet.get()) == false))
+		{
+			return false;
+		}
+
+		ApplyPayloadTypeMap(_retransmit_buffer);
+	}
+
+	_retransmit_count_in_window++;
+
+	if(_extension_map.IsEmpty() == false)
+	{
+		// The retransmitted packet is also a new packet of the transport
+		StampHeaderExtensions(_retransmit_buffer);
+	}
+
+	if(_egress_path != nullptr)
+	{
+		return _egress_path->SendRtp(_retransmit_buffer);
+	}
+
+	return node->SendData(GetNodeType(), _retransmit_buffer);
+}
+
+bool RtpRtcp::MakeRtxPacket(const std::shared_ptr<const ov::Data> &packet, RtxInfo &rtx_info, const std::shared_ptr<ov::Data> &rtx_packet)
+{
+	auto buffer = packet->GetDataAs<uint8_t>();
+	size_t length = packet->GetLength();
+	size_t header_size = GetRtpHeaderSize(buffer, length);
+
+	if(header_size == 0)
+	{
+		logtw("Invalid RTP packet to retransmit (length: %zu)", length);
+		return false;
+	}
+
+	uint8_t osn[RTX_OSN_SIZE];
+	// Original sequence number
+	osn[0] = buffer[2];
+	osn[1] = buffer[3];
+
+	if((rtx_packet->Reserve(length + RTX_OSN_SIZE + RTP_SEND_BUFFER_TRAILER_SIZE) == false) ||
+	   (rtx_packet->Append(buffer, header_size) == false) ||
+	   (rtx_packet->Append(osn, RTX_OSN_SIZE) == false) ||
+	   (rtx_packet->Append(buffer + header_size, length - header_size) == false))
+	{
+		return false;
+	}
+
+	auto rtx_buffer = rtx_packet->GetWritableDataAs<uint8_t>();
+
+	// Keep the marker bit, and replace PT, SN and SSRC
+	rtx_buffer[1] = (rtx_buffer[1] & 0x80) | (rtx_info.payload_type & 0x7F);
+	ByteWriter<uint16_t>::WriteBigEndian(&rtx_buffer[2], rtx_info.sequence_number++);
+	ByteWriter<uint32_t>::WriteBigEndian(&rtx_buffer[8], rtx_info.ssrc);
+
+	return true;
+}
+
+size_t RtpRtcp::GetRtpHeaderSize(const uint8_t *buffer, size_t length)
+{
+	if(length < FIXED_HEADER_SIZE)
+	{
+		return 0;
+	}
+
+	// fixed header + CSRCs
+	size_t header_size = FIXED_HEADER_SIZE + (buffer[0] & 0x0F) * 4;
+
+	if((buffer[0] & 0x10) && (length >= header_size + 4))
+	{
+		// header extension
+		header_size += 4 + ByteReader<uint16_t>::ReadBigEndian(&buffer[header_size + 2]) * 4;
+	}
+
+	return (length >= header_size) ? header_size : 0;
+}
+
+void RtpRtcp::ApplySequenceNumberOffset(const std::shared_ptr<ov::Data> &packet, uint16_t offset)
+{
+	auto buffer = packet->GetWritableDataAs<uint8_t>();
+	size_t length = packet->GetLength();
+
+	ByteWriter<uint16_t>::WriteBigEndian(&buffer[2], ByteReader<uint16_t>::ReadBigEndian(&buffer[2]) + offset);
+
+	if((buffer[1] & 0x7F) != RED_PAYLOAD_TYPE)
+	{
+		return;
+	}
+
+	// [RTP header] [RED header (the last block, 1 byte)] [ULPFEC header: E/L/P/X/CC(1) M/PT recovery(1) SN base(2) ...]
+	size_t header_size = GetRtpHeaderSize(buffer, length);
+
+	if((header_size != 0) && (length >= header_size + 1 + 4) && ((buffer[header_size] & 0x7F) == ULPFEC_PAYLOAD_TYPE))
+	{
+		// The protected packets are rewritten with the same offset
+		auto sn_base = &buffer[header_size + 1 + 2];
+		ByteWriter<uint16_t>::WriteBigEndian(sn_base, ByteReader<uint16_t>::ReadBigEndian(sn_base) + offset);
+	}
+}
@@ -6,23 +6,64 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <mutex>
 #include "rtcp_packet.h"
+#include "rtp_packet_history.h"
+#include "bandwidth_estimator.h"
+#include "rtp_pacer.h"
 
+// Extra space reserved at the end of the send buffer for the SRTP auth tag
+#define RTP_SEND_BUFFER_TRAILER_SIZE	16
+// Size of the original sequence number (OSN) field of the RTX payload (RFC 4588)
+#define RTX_OSN_SIZE					2
+// Maximum number of retransmitted packets per second per session
+#define RTP_MAX_RETRANSMIT_PER_SECOND	500
+// The pacing rate of the kernel is updated when the rate of the pacer is changed more than 1/step
+#define RTP_RTCP_KERNEL_PACING_RATE_STEP	8
+// Extra space reserved at the end of the RTCP send buffer: SRTCP index (4B) + auth tag
+#define RTCP_SEND_BUFFER_TRAILER_SIZE	32
+
+class SrtpEgressPath;
+
+// Counters of a sending SSRC for the SR (updated by each sent packet)
 struct RtcpInfo
 {
     RtcpInfo(uint32_t ssrc_)
     {
         ssrc = ssrc_;
-        sequence_number = 0;
     }
 
     uint32_t ssrc = 0;
-    uint32_t sequence_number = 0;
-    // uint32_t rtp_packet_size = 0;
-    // time_t rtp_packt_send_time = time(nullptr);
-    // uint32_t rtp_packt_timestamp = 0;
+    // 0 if unknown (the RTP timestamp of the last packet is reported as is)
+    uint32_t clock_rate = 0;
+    uint32_t packet_count = 0;
+    // Payload octets (the headers and the padding are not counted)
+    uint32_t octet_count = 0;
+    uint32_t rtp_timestamp = 0;
+    // ms (monotonic) when the last packet is sent
+    int64_t send_time = 0;
  };
 
+// The sequence numbers of a SSRC are rewritten to be continuous when the source packetizer is changed
+// (e.g. the simulcast layer of RtcSession is switched)
+struct SequenceRewriteInfo
+{
+	// Set by RebaseSequenceNumber(), and taken by the next packet queued to the pacer
+	bool rebase = false;
+	bool sent = false;
+	uint16_t offset = 0;
+	uint16_t last_sequence_number = 0;
+	// Sequence number (of the packetizer) of the first packet after the last rebase
+	uint16_t rebase_sequence_number = 0;
+};
+
+struct RtxInfo
+{
+	uint32_t ssrc = 0;
+	uint8_t payload_type = 0;
+	uint16_t sequence_number = 0;
+};
+
 class RtpRtcp : public SessionNode
 {
 public:
@@ -31,7 +72,27 @@ public:
 	~RtpRtcp() override;
 
 	// 패킷을 전송한다. 성능을 위해 상위에서 Packetizing을 하는 경우 사용한다.
-	bool SendOutgoingData(std::shared_ptr<ov::Data> packet);
+	// packet is shared by all sessions, so it is copied to the send buffer of this session before being protected
+	// The packets are queued to the pacer, and sent as much as the budget allows
+	bool SendOutgoingData(const std::shared_ptr<const ov::Data> &packet);
+	// 여러개의 패킷을 한번에 전송한다. (usually all packets of a frame)
+	bool SendOutgoingData(const std::vector<std::shared_ptr<const ov::Data>> &packets);
+	// Sends the queued packets which the budget allows,
+	// returns the delay (ms) until the next packet can be sent (-1 if the queue is empty)
+	int64_t ProcessPacing();
+
+	// The packets are sent by the egress path instead of the lower nodes (nullptr: the lower nodes are used again)
+	void SetEgressPath(const std::shared_ptr<SrtpEgressPath> &egress_path);
+	bool HasEgressPath();
+
+	// RTCP packet of the media key of the payloads (see RtpPayloadEncryptor), it is sent with each SR
+	void SetMediaKeyPacket(const std::shared_ptr<const ov::Data> &key_packet);
+
+	// The RTP timestamp of the SR is extrapolated to the time of the report by the clock rate of the SSRC
+	void SetClockRate(uint32_t ssrc, uint32_t clock_rate);
+	// Sends the SRs of all SSRCs (and the media key packet) as one compound RTCP packet (one SRTCP protection and one send).
+	// sr_template is shared by the sessions of the stream, returns false if nothing is sent (e.g. RR is not received yet)
+	bool SendSenderReports(const RtcpSrTemplate &sr_template);
 
 	// Implement SessionNode Interface
 	// RtpRtcp는 최상위 노드로 SendData를 사용하지 않는다. SendOutgoingData를 사용한다.
@@ -43,10 +104,115 @@ public:
                             uint32_t payload_size,
                             int report_count,
                             const std::shared_ptr<const ov::Data> &data);
+
+	// Retransmits the packets of media_ssrc requested by NACK (the packets are kept in the history)
+	void EnableNack(uint32_t media_ssrc);
+	// Retransmits the packets of media_ssrc using RTX (RFC 4588) instead of the original SSRC
+	void EnableRtx(uint32_t media_ssrc, uint32_t rtx_ssrc, uint8_t rtx_payload_type);
+
+	// FlexFEC packets of flexfec_ssrc protect media_ssrc, so their SN base follows the rewriting of media_ssrc
+	void EnableFlexfec(uint32_t flexfec_ssrc, uint32_t media_ssrc);
+
+	// Rewrites the sequence numbers of the packets of ssrc
+	void EnableSequenceNumberRewriting(uint32_t ssrc);
+	// The next packet of ssrc continues from the last sequence number (the packets are from another packetizer)
+	void RebaseSequenceNumber(uint32_t ssrc);
+
+	// Rewrites the payload types of the packets (the peer made the offer with its own payload types)
+	// key: payload type of the packetizer, value: payload type of the peer
+	void SetPayloadTypeMap(const std::map<uint8_t, uint8_t> &payload_type_map);
+
+	// Header extensions of the packets of the stream (stream_map), and the ids which the peer negotiated (peer_map)
+	// - The elements are rewritten to the ids of the peer, and the ones which the peer didn't negotiate are erased (padding)
+	// - The transport-wide sequence number is stamped if the peer negotiated it, and the bandwidth is estimated from the feedback
+	// - abs-send-time is stamped when the packet is sent
+	void SetHeaderExtensions(const RtpHeaderExtensionMap &stream_map, const RtpHeaderExtensionMap &peer_map);
+	// bps (from the transport-wide CC feedback, REMB and the loss of RR)
+	uint64_t GetEstimatedBitrate();
+	// Upper bound of the pacing rate regardless of the estimate (bps, 0: unlimited)
+	void SetMaxPacingRate(uint64_t rate);
+	// Bytes of the buffers of the session (send buffers, RTX, the history and the pacer queue)
+	size_t GetMemoryUsage();
+
 private:
+	bool NackProcess(const std::shared_ptr<const ov::Data> &data, int report_count);
+	bool RembProcess(const std::shared_ptr<const ov::Data> &data, int report_count);
+	// PLI/FIR of the players are passed to the session (the requests are coalesced in the media router)
+	bool KeyFrameRequestProcess(const std::shared_ptr<const ov::Data> &data, int report_count);
+	bool TransportCcProcess(const std::shared_ptr<const ov::Data> &data, int report_count);
+	// Rewrites the ids of the header extension, and writes the transport-wide sequence number and abs-send-time
+	// at the fixed offsets of the stream map (_send_mutex must be locked)
+	void StampHeaderExtensions(const std::shared_ptr<ov::Data> &packet);
+	bool RetransmitPacket(const std::shared_ptr<SessionNode> &node, uint32_t media_ssrc, uint16_t sequence_number, int64_t current_time);
+	// Returns false if the retransmission exceeds the rate limit
+	bool CheckRetransmitRate(int64_t current_time);
+	// Makes the RTX packet: [RTP header (RTX PT, SSRC, SN)] [OSN] [original payload]
+	bool MakeRtxPacket(const std::shared_ptr<const ov::Data> &packet, RtxInfo &rtx_info, const std::shared_ptr<ov::Data> &rtx_packet);
+
+	// Size of the fixed header + CSRCs + header extension (0 if the packet is invalid)
+	static size_t GetRtpHeaderSize(const uint8_t *buffer, size_t length);
+	// Adds offset to the sequence number (and the SN base of the ULPFEC packet in RED)
+	static void ApplySequenceNumberOffset(const std::shared_ptr<ov::Data> &packet, uint16_t offset);
+	// _send_mutex must be locked
+	void ApplyPayloadTypeMap(const std::shared_ptr<ov::Data> &packet);
+	// Returns false if the FlexFEC packet protects the packets which this session didn't send (_send_mutex must be locked)
+	bool PrepareFlexfecPacket(const std::shared_ptr<const ov::Data> &packet, uint16_t &sn_base_offset);
+
+	// Counts the packet for the SR, and copies the packet to the index-th send buffer
+	std::shared_ptr<ov::Data> PrepareSendBuffer(const std::shared_ptr<SessionNode> &node, size_t index, const std::shared_ptr<const ov::Data> &packet, bool rebase);
+	// _send_mutex must be locked
+	void EnqueuePacket(const std::shared_ptr<const ov::Data> &packet);
+	bool SendPacedPackets(const std::shared_ptr<SessionNode> &node);
+
     time_t _first_receiver_report_time = 0; // 0 - not received RR packet
 
     time_t _last_sender_report_time = 0;
     uint64_t _send_packet_sequence_number = 0;
     std::vector<std::shared_ptr<RtcpInfo>> _rtcp_infos;
+
+	// Per-session scratch buffers that SRTP encrypts in place (one for each packet of a batch).
+	// They are reused for every batch because the lower nodes send the data synchronously.
+	std::vector<std::shared_ptr<ov::Data>> _send_buffers;
+	std::vector<std::shared_ptr<ov::Data>> _send_batch;
+	// Compound RTCP packet of the SRs, reused for every report (guarded by _send_mutex)
+	std::shared_ptr<ov::Data> _report_buffer;
+
+	// NACK is processed in the application thread while media packets are sent in the stream worker,
+	// so the SRTP context, the send buffers and the history are guarded by this mutex
+	std::mutex _send_mutex;
+
+	// Compiled after DTLS is connected (guarded by _send_mutex)
+	std::shared_ptr<SrtpEgressPath> _egress_path;
+	// nullptr if the payloads are not encrypted by the stream (guarded by _send_mutex)
+	std::shared_ptr<const ov::Data> _media_key_packet;
+
+	RtpPacketHistory _rtp_history;
+	// media ssrc -> RTX info (payload_type is 0 if RTX is not used)
+	std::map<uint32_t, RtxInfo> _retransmit_infos;
+	std::shared_ptr<ov::Data> _retransmit_buffer;
+
+	// ssrc -> sequence number rewriting
+	std::map<uint32_t, SequenceRewriteInfo> _sequence_rewrite_infos;
+	// The rewritten copy of the stored packet to retransmit
+	std::shared_ptr<ov::Data> _rewrite_buffer;
+
+	// payload type of the packetizer -> payload type of the peer (empty if not rewritten)
+	std::map<uint8_t, uint8_t> _payload_type_map;
+
+	// 0 if FlexFEC is not used
+	uint32_t _flexfec_ssrc = 0;
+	uint32_t _flexfec_media_ssrc = 0;
+
+	// Layout of the header extension of the packets (empty: the packets are sent as they are)
+	RtpHeaderExtensionMap _extension_map;
+	// Id of the peer for each type (0: the element is erased)
+	uint8_t _peer_extension_ids[static_cast<size_t>(RtpHeaderExtensionType::NumberOfTypes)] = { 0 };
+	uint16_t _transport_sequence_number = 0;
+	BandwidthEstimator _bandwidth_estimator;
+	RtpPacer _pacer;
+	// Pacing rate which is given to the kernel (SO_TXTIME/SO_MAX_PACING_RATE)
+	uint64_t _kernel_pacing_rate = 0;
+
+	int64_t _retransmit_window_start_time = 0;
+	uint32_t _retransmit_count_in_window = 0;
 };
@@ -62,6 +62,9 @@ struct RTPVideoHeaderH264 {
 	NaluInfo nalus[kMaxNalusPerPacket];
 	size_t nalus_length;
 	H264PacketizationMode packetization_mode;
+	// NAL units of the frame which are already found (used when the fragmentation header is empty)
+	const ov::NalUnit *nal_units;
+	size_t nal_unit_count;
 };
 
 struct RTPVideoHeaderVP8
@@ -1,5 +1,6 @@
 #include "ulpfec_generator.h"
 #include "base/ovlibrary/byte_io.h"
+#include "fec_xor.h"
 
 #include <string.h>
 
@@ -11,24 +12,50 @@ constexpr size_t	kFecLevelHeaderSizeLbitSet		= 2 + kMaskSizeLbitSet;
 constexpr size_t 	kUlpfecMaxMediaPacketsLbitClear	= 16;
 constexpr size_t 	kUlpfecMaxMediaPacketsLbitSet	= 48;
 
-constexpr size_t    kMediaPacketNumMakeFec          = 100 / 25; // 25% Rate, 1 fec packet per 4 media packets.
-
 UlpfecGenerator::UlpfecGenerator()
 {
-	_high_level = false;
 }
 
 UlpfecGenerator::~UlpfecGenerator()
 {
 }
 
-void UlpfecGenerator::SetHighRateProtection(bool high_level)
+void UlpfecGenerator::SetProtectionRate(uint32_t rate)
+{
+	_protection_rate = std::min<uint32_t>(rate, ULPFEC_MAX_PROTECTION_RATE);
+}
+
+uint32_t UlpfecGenerator::GetProtectionRate(uint8_t fraction_lost)
 {
-	_high_level = high_level;
+	// 1 FEC packet recovers 1 lost packet of the protected packets
+	if(fraction_lost < 3)
+	{
+		// < 1%, NACK is enough
+		return 0;
+	}
+	else if(fraction_lost < 13)
+	{
+		// < 5%
+		return 10;
+	}
+	else if(fraction_lost < 26)
+	{
+		// < 10%
+		return ULPFEC_DEFAULT_PROTECTION_RATE;
+	}
+
+	return ULPFEC_MAX_PROTECTION_RATE;
 }
 
 bool UlpfecGenerator::AddRtpPacketAndGenerateFec(std::shared_ptr<RedRtpPacket> packet)
 {
+	if(_protection_rate == 0)
+	{
+		// FEC is not needed for any session
+		_media_packets.clear();
+		return true;
+	}
+
 	_media_packets.push_back(packet);
 
 	if(packet->Marker())
@@ -60,8 +87,16 @@ bool UlpfecGenerator::NextPacket(RtpPacket *packet)
 bool UlpfecGenerator::Encode()
 {
 	size_t media_size = _media_packets.size();
-	//uint32_t rate = static_cast<uint32_t>(kMediaPacketNumMakeFec / (_high_level?2:1));
-	uint32_t fec_packet_count = static_cast<uint32_t>(std::ceil((float)media_size / (float)kMediaPacketNumMakeFec));
+	uint32_t protection_rate = _protection_rate;
+
+	if(protection_rate == 0)
+	{
+		_media_packets.clear();
+		return true;
+	}
+
+	// e.g. 25% Rate, 1 fec packet per 4 media packets.
+	uint32_t fec_packet_count = static_cast<uint32_t>((media_size * protection_rate + 99) / 100);
 	uint32_t media_packet_idx = 0;
 	size_t mask_len = 0;
 
@@ -100,7 +135,10 @@ bool UlpfecGenerator::Encode()
 		{
 			auto media_packet = _media_packets[media_packet_idx];
 
-			size_t fec_packet_length = fec_header_size + media_packet->PayloadSize();
+			// CSRCs and header extensions (after the fixed header, except the RED header) are protected with the payload
+			size_t protected_header_len = media_packet->HeadersSize() - FIXED_HEADER_SIZE - RED_HEADER_SIZE;
+			size_t protected_len = protected_header_len + media_packet->PayloadSize();
+			size_t fec_packet_length = fec_header_size + protected_len;
 
 			if(fec_packet->GetLength() < fec_packet_length)
 			{
@@ -132,9 +170,10 @@ bool UlpfecGenerator::Encode()
 				// Write timestamp recovery field.
 				ByteWriter<uint32_t>::WriteBigEndian(&fec_buffer[4], media_packet->Timestamp());
 				// Write length recovery field.
-				ByteWriter<uint16_t>::WriteBigEndian(&fec_buffer[8], (uint16_t)media_packet->PayloadSize());
-				// Write Payload.
-				memcpy(&fec_buffer[fec_header_size], media_packet->Payload(), media_packet->PayloadSize());
+				ByteWriter<uint16_t>::WriteBigEndian(&fec_buffer[8], (uint16_t)protected_len);
+				// Write CSRCs, header extensions and Payload.
+				memcpy(&fec_buffer[fec_header_size], media_packet->Buffer() + FIXED_HEADER_SIZE, protected_header_len);
+				memcpy(&fec_buffer[fec_header_size + protected_header_len], media_packet->Payload(), media_packet->PayloadSize());
 
 				sn_base = media_packet->SequenceNumber();
 
@@ -166,6 +205,7 @@ void UlpfecGenerator::XorFecPacket(uint8_t *fec_packet, size_t fec_header_len, R
 	auto rtp_header_len = media_packet->HeadersSize();
 	auto rtp_payload = media_packet->Payload();
 	auto rtp_payload_len = media_packet->PayloadSize();
+	auto protected_header_len = rtp_header_len - FIXED_HEADER_SIZE - RED_HEADER_SIZE;
 
 	// XOR the first 2 bytes of the header: V, P, X, CC
 	fec_packet[0] ^= rtp_header[0];
@@ -189,15 +229,15 @@ void UlpfecGenerator::XorFecPacket(uint8_t *fec_packet, size_t fec_header_len, R
 
 	// XOR Length recovery
 	uint8_t rtp_payload_length_network_order[2];
-	ByteWriter<uint16_t>::WriteBigEndian(rtp_payload_length_network_order, (uint16_t)rtp_payload_len);
+	ByteWriter<uint16_t>::WriteBigEndian(rtp_payload_length_network_order, (uint16_t)(protected_header_len + rtp_payload_len));
 	fec_packet[8] ^= rtp_payload_length_network_order[0];
 	fec_packet[9] ^= rtp_payload_length_network_order[1];
 
+	// XOR CSRCs and header extensions
+	XorFecBytes(&fec_packet[fec_header_len], &rtp_header[FIXED_HEADER_SIZE], protected_header_len);
+
 	// XOR Payload
-	for(size_t i = 0; i < rtp_payload_len; i++)
-	{
-		fec_packet[fec_header_len + i] ^= rtp_payload[i];
-	}
+	XorFecBytes(&fec_packet[fec_header_len + protected_header_len], rtp_payload, rtp_payload_len);
 }
 
 void UlpfecGenerator::FinalizeFecHeader(uint8_t *fec_packet, const size_t fec_payload_len, const uint8_t *mask, const size_t mask_len)
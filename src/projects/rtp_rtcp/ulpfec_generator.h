@@ -7,6 +7,12 @@
 #include "base/common_types.h"
 #include "red_rtp_packet.h"
 
+#include <atomic>
+
+// Protection rate: number of FEC packets per 100 media packets (0: FEC is not generated)
+#define ULPFEC_DEFAULT_PROTECTION_RATE		25
+#define ULPFEC_MAX_PROTECTION_RATE			50
+
 /*
 * RTP + RED + FEC
     0                   1                    2                   3
@@ -38,7 +44,8 @@
  *  and one media packet only protects with one FEC packet.
  *  Fec packets is generated by a frame.
  *  Current version generates only one fec packet, near future we will apply bursty mask model.
- *  The session determines whether the FEC PACKET is sent according to the network status (using RTCP RR).
+ *  The session determines whether the FEC PACKET is sent according to the network status (using RTCP RR),
+ *  and the protection rate follows the loss of the sessions (GetProtectionRate()).
  */
 
 class UlpfecGenerator
@@ -47,7 +54,11 @@ public:
 	UlpfecGenerator();
 	~UlpfecGenerator();
 
-	void SetHighRateProtection(bool high_level);
+	// rate: FEC packets per 100 media packets (applied from the next frame, it can be called from another thread)
+	void SetProtectionRate(uint32_t rate);
+	// The protection rate for the fraction lost (1/256) of RTCP RR
+	static uint32_t GetProtectionRate(uint8_t fraction_lost);
+
 	// Because RTP is already being sent out, we execute ulpfec using the newly created red packet.
 	// I used this technique to reduce the copying and improve performance.
 	bool AddRtpPacketAndGenerateFec(std::shared_ptr<RedRtpPacket> packet);
@@ -61,5 +72,5 @@ private:
 
 	std::queue<std::shared_ptr<ov::Data>>	    _generated_fec_packets;
 	std::vector<std::shared_ptr<RedRtpPacket>>	_media_packets;
-	bool                                        _high_level;
+	std::atomic<uint32_t>                       _protection_rate { ULPFEC_DEFAULT_PROTECTION_RATE };
 };
\ No newline at end of file
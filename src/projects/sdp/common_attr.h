@@ -21,7 +21,7 @@ protected:
 	~CommonAttr();
 
 	bool			SerializeCommonAttr(ov::String &sdp);
-	bool			ParsingCommonAttrLine(char type, std::string content);
+	bool			ParsingCommonAttrLine(char type, const ov::StringView &content);
 
 public:
 	// a=fingerprint:sha-256 D7:81:CF:01:46:FB:2D
@@ -9,8 +9,7 @@
 
 #include "media_description.h"
 #include "session_description.h"
-
-#include <regex>
+#include "sdp_tokenizer.h"
 
 MediaDescription::MediaDescription(const std::shared_ptr<SessionDescription> &session_desc)
 {
@@ -79,6 +78,11 @@ bool MediaDescription::UpdateData(ov::String &sdp)
 		sdp.AppendFormat("a=rtcp-mux\r\n");
 	}
 
+	for(auto &extmap : _extmaps)
+	{
+		sdp.AppendFormat("a=extmap:%d %s\r\n", extmap.first, extmap.second.CStr());
+	}
+
 	// Payloads
 	for(auto &payload : _payload_list)
 	{
@@ -107,7 +111,7 @@ bool MediaDescription::UpdateData(ov::String &sdp)
 
 		if(payload->IsRtcpFbEnabled(PayloadAttr::RtcpFbType::GoogRemb))
 		{
-			sdp.AppendFormat("a=rtcp-fb:%d goog_remb\r\n", payload_id);
+			sdp.AppendFormat("a=rtcp-fb:%d goog-remb\r\n", payload_id);
 		}
 		if(payload->IsRtcpFbEnabled(PayloadAttr::RtcpFbType::TransportCc))
 		{
@@ -130,7 +134,27 @@ bool MediaDescription::UpdateData(ov::String &sdp)
 	// SSRCs
 	if(_cname.IsEmpty() == false)
 	{
+		if(_rtx_ssrc != 0)
+		{
+			sdp.AppendFormat("a=ssrc-group:FID %u %u\r\n", _ssrc, _rtx_ssrc);
+		}
+
+		if(_fec_ssrc != 0)
+		{
+			sdp.AppendFormat("a=ssrc-group:FEC-FR %u %u\r\n", _ssrc, _fec_ssrc);
+		}
+
 		sdp.AppendFormat("a=ssrc:%u cname:%s\r\n", _ssrc, _cname.CStr());
+
+		if(_rtx_ssrc != 0)
+		{
+			sdp.AppendFormat("a=ssrc:%u cname:%s\r\n", _rtx_ssrc, _cname.CStr());
+		}
+
+		if(_fec_ssrc != 0)
+		{
+			sdp.AppendFormat("a=ssrc:%u cname:%s\r\n", _fec_ssrc, _cname.CStr());
+		}
 	}
 
 	return true;
@@ -162,22 +186,24 @@ bool MediaDescription::SetMediaType(const ov::String &type)
 
 bool MediaDescription::FromString(const ov::String &desc)
 {
-	std::stringstream sdpstream(desc.CStr());
-	std::string line;
+	const char *position = desc.CStr();
+	const char *end = position + desc.GetLength();
+	const char *line;
+	size_t length;
 
-	while(std::getline(sdpstream, line, '\n'))
+	while(SdpTokenizer::NextLine(position, end, line, length))
 	{
-		if(line.size() && line[line.length() - 1] == '\r')
+		if((length < 2) || (line[1] != '='))
 		{
-			line.pop_back();
+			continue;
 		}
 
 		char type = line[0];
-		std::string content = line.substr(2);
+		ov::StringView content(line + 2, length - 2);
 
 		if(ParsingMediaLine(type, content) == false)
 		{
-			logw("SDP", "Could not parse line: %c: %s (%s)", type, content.c_str(), line.c_str());
+			logw("SDP", "Could not parse line: %c: %.*s", type, static_cast<int>(content.GetLength()), content.GetData());
 			return false;
 		}
 	}
@@ -211,205 +237,221 @@ bool MediaDescription::SetDirection(const ov::String &dir)
 	return true;
 }
 
-bool MediaDescription::ParsingMediaLine(char type, std::string content)
+bool MediaDescription::ParsingMediaLine(char type, const ov::StringView &content)
 {
 	bool parsing_error = false;
-	std::smatch matches;
+	SdpTokenizer tokenizer(content);
 
 	switch(type)
 	{
 		case 'm':
+		{
 			// m=video 9 UDP/TLS/RTP/SAVPF 97
+			uint16_t port;
 
-			if(std::regex_search(content, matches, std::regex("^(\\w*) (\\d*) ([\\w\\/]*)(?: (.*))?")))
-			{
-				if(matches.size() < 4 + 1)
-				{
-					parsing_error = true;
-					break;
-				}
+			ov::String media_type = tokenizer.ReadToken();
 
-				if(!SetMediaType(std::string(matches[1]).c_str()))
-				{
-					parsing_error = true;
-					break;
-				}
+			if((tokenizer.Expect(' ') && tokenizer.ReadNumber(port) && tokenizer.Expect(' ')) == false)
+			{
+				// 필수값 이므로 m이 에러가 나면 실패
+				parsing_error = true;
+				break;
+			}
 
-				SetPort(std::stoul(matches[2]));
+			if(!SetMediaType(media_type))
+			{
+				parsing_error = true;
+				break;
+			}
 
-				ov::String protocol = std::string(matches[3]).c_str();
-				if(protocol.UpperCaseString() == "UDP/TLS/RTP/SAVPF")
-				{
-					UseDtls(true);
-				}
-				else if(protocol.UpperCaseString() == "RTP/AVPF")
-				{
-					UseDtls(false);
-				}
-				else
-				{
-					loge("SDP", "Cannot support %s protocol", protocol.CStr());
-					parsing_error = true;
-					break;
-				}
+			SetPort(port);
 
-				// Payload를 모두 생성하여 넣는다.
-				// 나중에 Payload에 관련된 정보(rtpmap, fmtp, rtcp-fb)가 나오면 파싱하여 해당 Payload에 값을 설정한다.
-				std::string payload_number;
-				std::stringstream payload_numbers(matches[4]);
-				while(std::getline(payload_numbers, payload_number, ' '))
-				{
-					auto payload = std::make_shared<PayloadAttr>();
-					payload->SetId(static_cast<uint8_t>(std::stoul(payload_number)));
-					AddPayload(payload);
-				}
+			ov::String protocol = tokenizer.ReadToken();
+			if(protocol.UpperCaseString() == "UDP/TLS/RTP/SAVPF")
+			{
+				UseDtls(true);
+			}
+			else if(protocol.UpperCaseString() == "RTP/AVPF")
+			{
+				UseDtls(false);
 			}
 			else
 			{
-				// 필수값 이므로 m이 에러가 나면 실패
+				loge("SDP", "Cannot support %s protocol", protocol.CStr());
 				parsing_error = true;
+				break;
 			}
-			break;
-		case 'c':
-			// c=IN IP4 0.0.0.0
-			if(std::regex_search(content, matches, std::regex("^IN IP(\\d) (\\S*)")))
+
+			// Payload를 모두 생성하여 넣는다.
+			// 나중에 Payload에 관련된 정보(rtpmap, fmtp, rtcp-fb)가 나오면 파싱하여 해당 Payload에 값을 설정한다.
+			tokenizer.SkipSpaces();
+
+			while(tokenizer.IsEnd() == false)
 			{
-				if(matches.size() != 2 + 1)
+				uint8_t payload_type;
+
+				if(tokenizer.ReadNumber(payload_type) == false)
 				{
 					parsing_error = true;
 					break;
 				}
 
-				SetConnection(std::stoul(matches[1]), std::string(matches[2]).c_str());
+				auto payload = std::make_shared<PayloadAttr>();
+				payload->SetId(payload_type);
+				AddPayload(payload);
+
+				tokenizer.SkipSpaces();
+			}
+			break;
+		}
+		case 'c':
+		{
+			// c=IN IP4 0.0.0.0
+			uint8_t ip_version;
+
+			if(tokenizer.Expect("IN IP") && tokenizer.ReadNumber(ip_version) && tokenizer.Expect(' '))
+			{
+				SetConnection(ip_version, tokenizer.ReadToken());
 			}
 			else
 			{
-				// 필수값 이므로 m이 에러가 나면 실패
+				// 필수값 이므로 c가 에러가 나면 실패
 				parsing_error = true;
 			}
 
 			break;
+		}
 
 		case 'a':
-			// For Performance
-			if(content.compare(0, OV_COUNTOF("rtp") - 1,"rtp") == 0)
+			if(tokenizer.Expect("rtpmap:"))
 			{
 				// a=rtpmap:96 VP8/50000/?
-				if(std::regex_search(content,
-				                     matches,
-				                     std::regex("rtpmap:(\\d*) ([\\w\\-\\.]*)(?:\\s*\\/(\\d*)(?:\\s*\\/(\\S*))?)?")))
+				uint8_t payload_type;
+				uint32_t rate = 0;
+				ov::String parameters;
+
+				if((tokenizer.ReadNumber(payload_type) && tokenizer.Expect(' ')) == false)
 				{
-					if(matches.size() < 3 + 1)
+					break;
+				}
+
+				ov::String codec = tokenizer.ReadToken('/');
+
+				if(tokenizer.Expect('/'))
+				{
+					tokenizer.ReadNumber(rate);
+
+					if(tokenizer.Expect('/'))
 					{
-						parsing_error = true;
-						break;
+						parameters = tokenizer.ReadToken();
 					}
-
-					//TODO(getroot): matches[4]가 없는 경우에도 메모리는 할당 되는지 확인
-					AddRtpmap(static_cast<uint8_t>(std::stoul(matches[1])), std::string(matches[2]).c_str(),
-					          static_cast<uint32_t>(std::stoul(matches[3])), std::string(matches[4]).c_str());
 				}
+
+				AddRtpmap(payload_type, codec, rate, parameters);
 			}
-				// a=rtcp-mux
-			else if(content.compare(0, OV_COUNTOF("rtcp-m") - 1,"rtcp-m") == 0)
+			else if(tokenizer.Expect("rtcp-mux"))
 			{
-				if(std::regex_search(content, matches, std::regex("^(rtcp-mux)")))
-				{
-					UseRtcpMux(true);
-				}
+				// a=rtcp-mux
+				UseRtcpMux(true);
 			}
-			else if(content.compare(0, OV_COUNTOF("rtcp-f") - 1, "rtcp-f") == 0)
+			else if(tokenizer.Expect("rtcp-fb:"))
 			{
 				// a=rtcp-fb:96 nack pli
 				// pli는 subtype으로 구분해야 하지만 여기서는 type-subtype 형태로 구분한다.
-				if(std::regex_search(content,
-				                     matches,
-				                     std::regex("rtcp-fb:(\\*|\\d*) (.*)")))
+				uint8_t payload_type;
+
+				if(tokenizer.Expect('*'))
 				{
-					if(matches.size() != 2 + 1)
+					if(tokenizer.Expect(' '))
 					{
-						parsing_error = true;
-						break;
-					}
+						// a=rtcp-fb:* nack (all payloads)
+						auto rtcp_fb = tokenizer.ReadRest();
 
-					EnableRtcpFb(static_cast<uint8_t>(std::stoul(matches[1])), std::string(matches[2]).c_str(), true);
+						for(auto &payload : _payload_list)
+						{
+							payload->EnableRtcpFb(rtcp_fb, true);
+						}
+					}
+				}
+				else if(tokenizer.ReadNumber(payload_type) && tokenizer.Expect(' '))
+				{
+					EnableRtcpFb(payload_type, tokenizer.ReadRest(), true);
 				}
 			}
-			else if(content.compare(0, OV_COUNTOF("mid") - 1, "mid") == 0)
+			else if(tokenizer.Expect("fmtp:"))
 			{
-				// a=mid:video,
-				if(std::regex_search(content, matches, std::regex("^mid:([^\\s]*)")))
+				// a=fmtp:97 level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42e01f
+				uint8_t payload_type;
+
+				if(tokenizer.ReadNumber(payload_type) && tokenizer.Expect(' '))
 				{
-					if(matches.size() != 1 + 1)
+					auto payload = GetPayload(payload_type);
+
+					if(payload != nullptr)
 					{
-						parsing_error = true;
-						break;
+						payload->SetFmtp(tokenizer.ReadRest());
 					}
-
-					SetMid(std::string(matches[1]).c_str());
 				}
 			}
-			else if(content.compare(0, OV_COUNTOF("set") - 1, "set") == 0)
+			else if(tokenizer.Expect("extmap:"))
 			{
-				// a=setup:actpass
-				if(std::regex_search(content, matches, std::regex("^setup:(\\w*)")))
+				// a=extmap:5 http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01
+				// a=extmap:5/sendrecv http://...
+				uint8_t id;
+
+				if(tokenizer.ReadNumber(id))
 				{
-					if(matches.size() != 1 + 1)
+					if(tokenizer.Expect('/'))
 					{
-						parsing_error = true;
-						break;
+						tokenizer.ReadToken();
 					}
 
-					SetSetup(std::string(matches[1]).c_str());
+					if(tokenizer.Expect(' '))
+					{
+						AddExtmap(id, tokenizer.ReadToken());
+					}
 				}
 			}
-			else if(content.compare(0, OV_COUNTOF("ss") - 1, "ss") == 0)
+			else if(tokenizer.Expect("mid:"))
+			{
+				// a=mid:video,
+				SetMid(tokenizer.ReadToken());
+			}
+			else if(tokenizer.Expect("setup:"))
+			{
+				// a=setup:actpass
+				SetSetup(tokenizer.ReadToken());
+			}
+			else if(tokenizer.Expect("ssrc:"))
 			{
 				// a=ssrc:2064629418 cname:{b2266c86-259f-4853-8662-ea94cf0835a3}
-				if(std::regex_search(content, matches, std::regex("ssrc:(\\d*) cname(?::(.*))?")))
-				{
-					if(matches.size() != 2 + 1)
-					{
-						parsing_error = true;
-						break;
-					}
+				uint32_t ssrc;
 
-					SetCname(stoul(matches[1]), std::string(matches[2]).c_str());
+				if(tokenizer.ReadNumber(ssrc) && tokenizer.Expect(" cname"))
+				{
+					SetCname(ssrc, tokenizer.Expect(':') ? tokenizer.ReadRest() : "");
 				}
 			}
-			else if(content.compare(0, OV_COUNTOF("fra") - 1, "fra") == 0)
+			else if(tokenizer.Expect("ssrc-group:"))
+			{
+				// a=ssrc-group:FID 2064629418 3834849021 (the SSRCs of the player are not used)
+			}
+			else if(tokenizer.Expect("framerate:"))
 			{
 				// a=framerate:29.97
-				if(std::regex_search(content, matches, std::regex("^framerate:(\\d+(?:$|\\.\\d+))")))
-				{
-					if(matches.size() != 1 + 1)
-					{
-						parsing_error = true;
-						break;
-					}
+				auto framerate = tokenizer.ReadToken();
+				char *framerate_end = nullptr;
+				float value = ::strtof(framerate.CStr(), &framerate_end);
 
-					SetFramerate(std::stof(matches[1]));
+				if((framerate.IsEmpty() == false) && (framerate_end == (framerate.CStr() + framerate.GetLength())))
+				{
+					SetFramerate(value);
 				}
 			}
-				// a=sendonly
-			else if(content.compare(0, OV_COUNTOF("se") - 1, "se") == 0 ||
-			        content.compare(0, OV_COUNTOF("re") - 1, "re") == 0 ||
-			        content.compare(0, OV_COUNTOF("in") - 1, "in") == 0)
+			else if(content == "sendrecv" || content == "recvonly" || content == "sendonly" || content == "inactive")
 			{
-				if(std::regex_search(content, matches, std::regex("^(sendrecv|recvonly|sendonly|inactive)")))
-				{
-					if(matches.size() != 1 + 1)
-					{
-						parsing_error = true;
-						break;
-					}
-
-					if(!SetDirection(std::string(matches[1]).c_str()))
-					{
-						parsing_error = true;
-						break;
-					}
-				}
+				// a=sendonly
+				SetDirection(content.ToString());
 			}
 			else if(ParsingCommonAttrLine(type, content))
 			{
@@ -418,19 +460,18 @@ bool MediaDescription::ParsingMediaLine(char type, std::string content)
 			else
 			{
 				//TODO: Implementing of unknown attributes
-            	//a=fmtp:112 minptime=10;useinbandfec=1
-				logw("SDP", "Unknown Attributes : %c=%s", type, content.c_str());
+				logw("SDP", "Unknown Attributes : %c=%.*s", type, static_cast<int>(content.GetLength()), content.GetData());
 			}
 
 			break;
 		default:
-			logw("SDP", "Unknown Attributes : %c=%s", type, content.c_str());
+			logw("SDP", "Unknown Attributes : %c=%.*s", type, static_cast<int>(content.GetLength()), content.GetData());
 			break;
 	}
 
 	if(parsing_error)
 	{
-		loge("SDP", "Sdp parsing error : %c=%s", type, content.c_str());
+		loge("SDP", "Sdp parsing error : %c=%.*s", type, static_cast<int>(content.GetLength()), content.GetData());
 		return false;
 	}
 
@@ -515,6 +556,11 @@ const std::shared_ptr<PayloadAttr> MediaDescription::GetFirstPayload()
 	return _payload_list[0];
 }
 
+const std::vector<std::shared_ptr<PayloadAttr>> &MediaDescription::GetPayloadList() const
+{
+	return _payload_list;
+}
+
 // a=rtcp-mux
 void MediaDescription::UseRtcpMux(bool flag)
 {
@@ -626,6 +672,30 @@ const float MediaDescription::GetFramerate()
 	return _framerate;
 }
 
+// a=extmap:5 http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01
+void MediaDescription::AddExtmap(uint8_t id, const ov::String &uri)
+{
+	_extmaps[id] = uri;
+}
+
+const std::map<uint8_t, ov::String> &MediaDescription::GetExtmaps() const
+{
+	return _extmaps;
+}
+
+uint8_t MediaDescription::GetExtmapId(const ov::String &uri)
+{
+	for(auto &extmap : _extmaps)
+	{
+		if(extmap.second == uri)
+		{
+			return extmap.first;
+		}
+	}
+
+	return 0;
+}
+
 // a=ssrc:2064629418 cname:{b2266c86-259f-4853-8662-ea94cf0835a3}
 void MediaDescription::SetCname(uint32_t ssrc, const ov::String &cname)
 {
@@ -643,6 +713,28 @@ const ov::String MediaDescription::GetCname()
 	return _cname;
 }
 
+// a=ssrc-group:FID 2064629418 3834849021
+void MediaDescription::SetRtxSsrc(uint32_t rtx_ssrc)
+{
+	_rtx_ssrc = rtx_ssrc;
+}
+
+uint32_t MediaDescription::GetRtxSsrc()
+{
+	return _rtx_ssrc;
+}
+
+// a=ssrc-group:FEC-FR 2064629418 1252236788
+void MediaDescription::SetFecSsrc(uint32_t fec_ssrc)
+{
+	_fec_ssrc = fec_ssrc;
+}
+
+uint32_t MediaDescription::GetFecSsrc()
+{
+	return _fec_ssrc;
+}
+
 // a=rtpmap:96 VP8/50000
 bool MediaDescription::AddRtpmap(uint8_t payload_type, const ov::String &codec,
                                  uint32_t rate, const ov::String &parameters)
@@ -62,6 +62,7 @@ public:
 	void AddPayload(const std::shared_ptr<PayloadAttr> &payload);
 	const std::shared_ptr<PayloadAttr> GetPayload(uint8_t id);
 	const std::shared_ptr<PayloadAttr> GetFirstPayload();
+	const std::vector<std::shared_ptr<PayloadAttr>> &GetPayloadList() const;
 
 	// a=rtcp-mux
 	void UseRtcpMux(bool flag = true);
@@ -95,15 +96,34 @@ public:
 	bool EnableRtcpFb(uint8_t id, const ov::String &type, bool on);
 	void EnableRtcpFb(uint8_t id, const PayloadAttr::RtcpFbType &type, bool on);
 
+	// a=extmap:5 http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01
+	void AddExtmap(uint8_t id, const ov::String &uri);
+	// 0 if the uri is not in the extmaps
+	uint8_t GetExtmapId(const ov::String &uri);
+	// id -> uri
+	const std::map<uint8_t, ov::String> &GetExtmaps() const;
+
 	// a=ssrc:2064629418 cname:{b2266c86-259f-4853-8662-ea94cf0835a3}
 	void SetCname(uint32_t ssrc, const ov::String &cname);
 
 	uint32_t GetSsrc();
 	const ov::String GetCname();
 
+	// a=ssrc-group:FID 2064629418 3834849021
+	// a=ssrc:3834849021 cname:{b2266c86-259f-4853-8662-ea94cf0835a3}
+	void SetRtxSsrc(uint32_t rtx_ssrc);
+	uint32_t GetRtxSsrc();
+
+	// a=ssrc-group:FEC-FR 2064629418 1252236788
+	// a=ssrc:1252236788 cname:{b2266c86-259f-4853-8662-ea94cf0835a3}
+	void SetFecSsrc(uint32_t fec_ssrc);
+	uint32_t GetFecSsrc();
+
+	// Parses a line of the media level (SessionDescription passes the lines after the m line)
+	bool ParsingMediaLine(char type, const ov::StringView &content);
+
 private:
 	bool UpdateData(ov::String &sdp) override;
-	bool ParsingMediaLine(char type, std::string content);
 
 	MediaType _media_type = MediaType::Unknown;
 	ov::String _media_type_str = "UNKNOWN";
@@ -128,8 +148,13 @@ private:
 	float _framerate = 0.0f;
 
 	uint32_t _ssrc = 0;
+	uint32_t _rtx_ssrc = 0;
+	uint32_t _fec_ssrc = 0;
 	ov::String _cname;
 
+	// key: id, value: uri
+	std::map<uint8_t, ov::String> _extmaps;
+
 
 	std::shared_ptr<SessionDescription> _session_description;
 	std::vector<std::shared_ptr<PayloadAttr>> _payload_list;
@@ -71,11 +71,12 @@ bool PayloadAttr::EnableRtcpFb(const ov::String &type, const bool on)
 {
 	ov::String type_name = type.UpperCaseString();
 
-	if(type_name == "GOOG_REMB")
+	// "goog-remb" is written by the browsers
+	if((type_name == "GOOG-REMB") || (type_name == "GOOG_REMB"))
 	{
 		_rtcpfb_support_flag[(int)(RtcpFbType::GoogRemb)] = on;
 	}
-	else if(type_name == "TRANSPORT_CC")
+	else if((type_name == "TRANSPORT-CC") || (type_name == "TRANSPORT_CC"))
 	{
 		_rtcpfb_support_flag[(int)(RtcpFbType::TransportCc)] = on;
 	}
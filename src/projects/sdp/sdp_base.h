@@ -36,6 +36,12 @@ public:
 		return true;
 	}
 
+	// Sets the text which is serialized by the caller (e.g. from a template), Update() serializes it again
+	void SetSdpText(const ov::String &sdp)
+	{
+		_sdp_text = sdp;
+	}
+
 protected:
 	virtual bool UpdateData(ov::String &sdp) = 0;
 
@@ -0,0 +1,158 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#pragma once
+
+#include "base/ovlibrary/ovlibrary.h"
+
+#include <string.h>
+
+// Reads the tokens of a SDP line from the front (no copy until a token is taken)
+class SdpTokenizer
+{
+public:
+	SdpTokenizer(const char *data, size_t length)
+		: _current(data),
+		  _end(data + length)
+	{
+	}
+
+	explicit SdpTokenizer(const ov::StringView &content)
+		: SdpTokenizer(content.GetData(), content.GetLength())
+	{
+	}
+
+	// Splits the text into the lines (CRLF or LF), returns false at the end of the text
+	static bool NextLine(const char *&position, const char *end, const char *&line, size_t &length)
+	{
+		if(position >= end)
+		{
+			return false;
+		}
+
+		auto line_end = static_cast<const char *>(::memchr(position, '\n', end - position));
+
+		if(line_end == nullptr)
+		{
+			line_end = end;
+		}
+
+		line = position;
+		length = line_end - position;
+		position = (line_end < end) ? (line_end + 1) : end;
+
+		if((length > 0) && (line[length - 1] == '\r'))
+		{
+			length--;
+		}
+
+		return true;
+	}
+
+	bool IsEnd() const
+	{
+		return _current >= _end;
+	}
+
+	// Skips the prefix if the rest starts with it
+	bool Expect(const char *prefix)
+	{
+		size_t length = ::strlen(prefix);
+
+		if((static_cast<size_t>(_end - _current) < length) || (::memcmp(_current, prefix, length) != 0))
+		{
+			return false;
+		}
+
+		_current += length;
+
+		return true;
+	}
+
+	bool Expect(char c)
+	{
+		if(IsEnd() || (*_current != c))
+		{
+			return false;
+		}
+
+		_current++;
+
+		return true;
+	}
+
+	// Decimal digits (at least one, the upper digits are discarded if it overflows)
+	bool ReadNumber(uint64_t &value)
+	{
+		const char *start = _current;
+
+		value = 0;
+
+		while((IsEnd() == false) && (*_current >= '0') && (*_current <= '9'))
+		{
+			value = (value * 10) + (*_current - '0');
+			_current++;
+		}
+
+		return _current > start;
+	}
+
+	template<typename T>
+	bool ReadNumber(T &value)
+	{
+		uint64_t number;
+
+		if(ReadNumber(number) == false)
+		{
+			return false;
+		}
+
+		value = static_cast<T>(number);
+
+		return true;
+	}
+
+	// Characters until a whitespace or the delimiter (may be empty)
+	ov::String ReadToken(char delimiter = ' ')
+	{
+		const char *start = _current;
+
+		while((IsEnd() == false) && (*_current != delimiter) && (IsSpace(*_current) == false))
+		{
+			_current++;
+		}
+
+		return ov::String(start, _current - start);
+	}
+
+	ov::String ReadRest()
+	{
+		const char *start = _current;
+
+		_current = _end;
+
+		return ov::String(start, _end - start);
+	}
+
+	void SkipSpaces()
+	{
+		while((IsEnd() == false) && IsSpace(*_current))
+		{
+			_current++;
+		}
+	}
+
+protected:
+	static bool IsSpace(char c)
+	{
+		return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+	}
+
+	const char *_current;
+	const char *_end;
+};
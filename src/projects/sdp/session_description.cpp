@@ -1,14 +1,13 @@
 /*
  *
- * The REGEX pattern in this source code is refers to libsdptransform.
+ * The grammar of the lines in this source code is refers to libsdptransform.
  * https://github.com/ibc/libsdptransform [MIT LICENSE]
  *
  *
  */
 
 #include "session_description.h"
-#include <sstream>
-#include <regex>
+#include "sdp_tokenizer.h"
 
 SessionDescription::SessionDescription()
 {
@@ -34,6 +33,12 @@ bool SessionDescription::UpdateData(ov::String &sdp)
 
 	for(auto &t : _media_list)
 	{
+		if(t->GetPort() == 0)
+		{
+			// A rejected m= line is not a part of the BUNDLE group (RFC 8843 - 7.3.3)
+			continue;
+		}
+
 		sdp.AppendFormat(" %s", t->GetMid().CStr());
 	}
 
@@ -74,173 +79,135 @@ bool SessionDescription::UpdateData(ov::String &sdp)
 
 bool SessionDescription::FromString(const ov::String &sdp)
 {
-	static const std::regex ValidLineRegex("^([a-z])=(.*)");
-	std::stringstream sdpstream(sdp.CStr());
-	std::string line;
+	const char *position = sdp.CStr();
+	const char *end = position + sdp.GetLength();
+	const char *line;
+	size_t length;
 
-	ov::String media_desc_sdp;
-	bool media_level = false;
+	std::shared_ptr<MediaDescription> media_desc;
 
-	while(std::getline(sdpstream, line, '\n'))
+	// 한 번에 모든 줄을 읽는다. m을 만나면 다음 m을 만날때까지 media description에 넘긴다.
+	while(SdpTokenizer::NextLine(position, end, line, length))
 	{
-		if(line.size() && line[line.length() - 1] == '\r')
-		{
-			line.pop_back();
-		}
-
-		if(!std::regex_search(line, ValidLineRegex))
+		// <type>=<value>
+		if((length < 2) || (line[0] < 'a') || (line[0] > 'z') || (line[1] != '='))
 		{
 			continue;
 		}
+
 		char type = line[0];
-		std::string content = line.substr(2);
+		// Refers to the line of sdp (not copied)
+		ov::StringView content(line + 2, length - 2);
 
-		// media라면 다음 m을 만날때까지 또는 stream이 끝날때까지 모아서 media description에 넘긴다.
 		if(type == 'm')
 		{
-			// 새로운 m을 만나면 기존 m level을 파싱
-			if(media_level == true)
-			{
-				auto media_desc = std::make_shared<MediaDescription>(GetSharedPtr());
-				if(media_desc->FromString(media_desc_sdp) == false)
-				{
-					return false;
-				}
-				AddMedia(media_desc);
-			}
-
-			// 초기화
-			media_desc_sdp.Clear();
-			media_desc_sdp.AppendFormat("%s\n", line.c_str());
-			media_level = true;
+			media_desc = std::make_shared<MediaDescription>(GetSharedPtr());
+			AddMedia(media_desc);
 		}
-			// media level이면 계속 모은다.
-		else if(media_level == true)
-		{
-			media_desc_sdp.AppendFormat("%s\n", line.c_str());
 
-			// 만약 sdp의 끝이면 생성
-			if(sdpstream.rdbuf()->in_avail() == 0)
-			{
-				auto media_desc = std::make_shared<MediaDescription>(GetSharedPtr());
-				if(media_desc->FromString(media_desc_sdp) == false)
-				{
-					return false;
-				}
-				AddMedia(media_desc);
-			}
-		}
-			// media level이 아니면 파싱하여 저장
-		else
+		if(media_desc != nullptr)
 		{
-			if(ParsingSessionLine(type, content) == false)
+			// media level
+			if(media_desc->ParsingMediaLine(type, content) == false)
 			{
 				return false;
 			}
 		}
+		else if(ParsingSessionLine(type, content) == false)
+		{
+			// media level이 아니면 파싱하여 저장
+			return false;
+		}
 	}
 
 	return true;
 }
 
-bool SessionDescription::ParsingSessionLine(char type, std::string content)
+bool SessionDescription::ParsingSessionLine(char type, const ov::StringView &content)
 {
-	bool parsing_error = false;
-	std::smatch matches;
+	SdpTokenizer tokenizer(content);
 
 	switch(type)
 	{
 		case 'v':
+		{
 			// v=0
-			if(std::regex_search(content, matches, std::regex("^(\\d*)$")))
+			uint8_t version;
+
+			if(tokenizer.ReadNumber(version) && tokenizer.IsEnd())
 			{
-				if(matches.size() != 1 + 1)
-				{
-					parsing_error = true;
-					break;
-				}
-				SetVersion(static_cast<uint8_t>(std::stoi(matches[1])));
+				SetVersion(version);
 			}
 			break;
+		}
 		case 'o':
+		{
 			// o=OvenMediaEngine 1882243660 2 IN IP4 127.0.0.1
-			if(std::regex_search(content, matches, std::regex("^(\\S*) (\\d*) (\\d*) (\\S*) IP(\\d) (\\S*)")))
+			uint32_t session_id;
+			uint32_t session_version;
+			uint8_t ip_version;
+
+			ov::String user_name = tokenizer.ReadToken();
+
+			if(tokenizer.Expect(' ') && tokenizer.ReadNumber(session_id) &&
+			   tokenizer.Expect(' ') && tokenizer.ReadNumber(session_version) &&
+			   tokenizer.Expect(' '))
 			{
-				if(matches.size() != 6 + 1)
+				ov::String net_type = tokenizer.ReadToken();
+
+				if(tokenizer.Expect(" IP") && tokenizer.ReadNumber(ip_version) && tokenizer.Expect(' '))
 				{
-					parsing_error = true;
-					break;
+					SetOrigin(user_name, session_id, session_version, net_type, ip_version, tokenizer.ReadToken());
 				}
-
-				SetOrigin(std::string(matches[1]).c_str(),
-				          static_cast<uint32_t>(std::stoul(matches[2])),
-				          static_cast<uint32_t>(std::stoul(matches[3])),
-				          std::string(matches[4]).c_str(),
-				          static_cast<uint8_t>(std::stoul(matches[5])),
-				          std::string(matches[6]).c_str());
 			}
 			break;
+		}
 		case 's':
 			// s=-
-			if(std::regex_search(content, matches, std::regex("^(.*)")))
-			{
-				if(matches.size() != 1 + 1)
-				{
-					parsing_error = true;
-					break;
-				}
-
-				SetSessionName(std::string(matches[1]).c_str());
-			}
+			SetSessionName(tokenizer.ReadRest());
 			break;
 		case 't':
+		{
 			// t=0 0
-			if(std::regex_search(content, matches, std::regex("^(\\d*) (\\d*)")))
-			{
-				if(matches.size() != 2 + 1)
-				{
-					parsing_error = true;
-					break;
-				}
+			uint32_t start;
+			uint32_t stop;
 
-				SetTiming(static_cast<uint32_t>(std::stoul(matches[1])),
-				          static_cast<uint32_t>(std::stoul(matches[2])));
+			if(tokenizer.ReadNumber(start) && tokenizer.Expect(' ') && tokenizer.ReadNumber(stop))
+			{
+				SetTiming(start, stop);
 			}
-
 			break;
+		}
 		case 'a':
 			// a=group:BUNDLE video audio ...
-			if(content.compare(0, OV_COUNTOF("gr") - 1, "gr") == 0)
+			if(tokenizer.Expect("group:"))
 			{
-				if(std::regex_search(content, matches, std::regex("^group:BUNDLE (.*)")))
+				if(tokenizer.Expect("BUNDLE "))
 				{
-					if(matches.size() != 1 + 1)
+					while(tokenizer.IsEnd() == false)
 					{
-						parsing_error = true;
-						break;
-					}
+						auto bundle = tokenizer.ReadToken();
 
-					std::string bundle;
-					std::stringstream bundles(matches[1]);
-					while(std::getline(bundles, bundle, ' '))
-					{
-						// 당장은 사용하는 곳이 없다. bundle only 이므로...
-						_bundles.emplace_back(bundle.c_str());
+						if(bundle.IsEmpty() == false)
+						{
+							// 당장은 사용하는 곳이 없다. bundle only 이므로...
+							_bundles.emplace_back(bundle);
+						}
+
+						tokenizer.SkipSpaces();
 					}
 				}
 			}
 			// a=msid-semantic:WMS *
-			else if(content.compare(0, OV_COUNTOF("ms") - 1, "ms") == 0)
+			else if(tokenizer.Expect("msid-semantic:"))
 			{
-				if(std::regex_search(content, matches, std::regex(R"(^msid-semantic:\s?(\w*) (\S*))")))
-				{
-					if(matches.size() != 2 + 1)
-					{
-						parsing_error = true;
-						break;
-					}
+				tokenizer.Expect(' ');
+
+				ov::String semantic = tokenizer.ReadToken();
 
-					SetMsidSemantic(std::string(matches[1]).c_str(), std::string(matches[2]).c_str());
+				if(tokenizer.Expect(' '))
+				{
+					SetMsidSemantic(semantic, tokenizer.ReadToken());
 				}
 			}
 			else if(ParsingCommonAttrLine(type, content))
@@ -249,18 +216,12 @@ bool SessionDescription::ParsingSessionLine(char type, std::string content)
 			}
 			else
 			{
-				logw("SDP", "Unknown Attributes : %c=%s", type, content.c_str());
+				logw("SDP", "Unknown Attributes : %c=%.*s", type, static_cast<int>(content.GetLength()), content.GetData());
 			}
 
 			break;
 		default:
-			logw("SDP", "Unknown Attributes : %c=%s", type, content.c_str());
-	}
-
-	if(parsing_error)
-	{
-		loge("SDP", "Sdp parsing error : %c=%s", type, content.c_str());
-		return false;
+			logw("SDP", "Unknown Attributes : %c=%.*s", type, static_cast<int>(content.GetLength()), content.GetData());
 	}
 
 	return true;
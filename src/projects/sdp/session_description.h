@@ -104,7 +104,7 @@ public:
 
 private:
 	bool UpdateData(ov::String &sdp) override;
-	bool ParsingSessionLine(char type, std::string content);
+	bool ParsingSessionLine(char type, const ov::StringView &content);
 
 	// version
 	uint8_t _version = 0;
@@ -19,41 +19,56 @@ BitWriter::BitWriter(uint32_t data_size)
 }
 
 //====================================================================================================
-// Destructor
+// Write
+// - The bits are accumulated in a 64-bit word, and written by the bytes when it is full
 //====================================================================================================
 void BitWriter::Write(uint32_t bit_count, uint32_t value)
 {
-	uint8_t     *data 	= nullptr;
-	uint32_t    space 	= 0;
-	
-	data = _data->data();
-	
-	if (_bit_count + bit_count > _data->size()*8)
+	if ((bit_count == 0) || (bit_count > 32) || (_bit_count + bit_count > _data->size()*8))
 	{
 		return;
 	}
 
-	data += _bit_count/8;
+	if (_accumulated_bits + bit_count > 64)
+	{
+		Flush();
+	}
+
+	uint64_t mask = (1ULL << bit_count) - 1;
+
+	_accumulator = (_accumulator << bit_count) | (value & mask);
+	_accumulated_bits += bit_count;
+	_bit_count += bit_count;
+}
 
-	space = 8-(_bit_count%8);
+//====================================================================================================
+// Flush
+//====================================================================================================
+void BitWriter::Flush()
+{
+	uint8_t *data = _data->data();
 
-	while (bit_count) 
+	while (_accumulated_bits >= 8)
 	{
-		uint32_t mask = bit_count==32 ? 0xFFFFFFFF : ((1<<bit_count)-1);
-		
-		if (bit_count <= space)
-		{
-			*data |= ((value&mask) << (space -bit_count));
-			_bit_count += bit_count;
-			return;
-		}
-		else
-		{
-			*data |= ((value&mask) >> (bit_count- space));
-			++data;
-			_bit_count	+= space;
-			bit_count	-= space;
-			space		= 8;
-		}
+		_accumulated_bits -= 8;
+		data[_byte_offset++] = static_cast<uint8_t>(_accumulator >> _accumulated_bits);
 	}
-}
\ No newline at end of file
+
+	_accumulator &= (1ULL << _accumulated_bits) - 1;
+}
+
+//====================================================================================================
+// GetData
+// - The last partial byte is written too (it is overwritten if more bits are written)
+//====================================================================================================
+const uint8_t *BitWriter::GetData()
+{
+	Flush();
+
+	if (_accumulated_bits > 0)
+	{
+		(*_data)[_byte_offset] = static_cast<uint8_t>(_accumulator << (8 - _accumulated_bits));
+	}
+
+	return _data->data();
+}
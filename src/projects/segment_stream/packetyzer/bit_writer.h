@@ -23,13 +23,23 @@ public :
 	~BitWriter() = default;
 
 public :
+	// bit_count: 0 ~ 32
 	void 			Write(uint32_t bit_count, uint32_t value);
 	uint32_t 		GetBitCount(){ return _bit_count; }
-	const uint8_t*	GetData() { return _data->data(); }
+	const uint8_t*	GetData();
 	size_t			GetDataSize(){ return _data->size(); }
 
 private :
+	// Writes the whole bytes of the accumulator
+	void			Flush();
+
 	std::unique_ptr<std::vector<uint8_t>> _data;
 	uint32_t  _bit_count;
+
+	// The bits which are not written to _data yet (aligned to LSB, up to 64 bits)
+	uint64_t  _accumulator = 0;
+	uint32_t  _accumulated_bits = 0;
+	// Next byte of _data to be written by Flush()
+	size_t    _byte_offset = 0;
 };
 
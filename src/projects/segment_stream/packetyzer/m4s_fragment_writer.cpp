@@ -49,29 +49,50 @@ M4sFragmentWriter::~M4sFragmentWriter( )
 //====================================================================================================
 int M4sFragmentWriter::CreateData()
 {
-	int moof_size = 0;
-	int mdata_size = 0;
+	// 한번에 쓸 수 있도록 전체 크기를 미리 할당
+	// - moof: header(mfhd/traf/tfhd/tfdt/trun) + sample entry(video 16Byte, audio 8Byte)
+	// - mdat: header + samples(+ 4Byte length prefix)
+	size_t total_size = MP4_FRAGMENT_HEADER_RESERVE_SIZE + _sample_datas.size() * 16;
 
-	moof_size += MoofBoxWrite(_data_stream);
+	for (auto &sample_data : _sample_datas)
+	{
+		total_size += sample_data->data.GetLength() + 4;
+	}
+
+	_data_stream->reserve(_data_stream->size() + total_size);
+
+	int moof_size = MoofBoxWrite(_data_stream);
+
+	// trun data offset 값 변경(moof 시작 기준, mdat header 다음)
+	OverwriteUint32(_data_offset_position, moof_size + MP4_BOX_HEADER_SIZE, _data_stream);
+
+	int mdat_size = MdatBoxWrite(_data_stream);
+
+	return moof_size + mdat_size;
+}
 
-	//trun data offset 값 변경
-	uint32_t data_offset = _data_stream->size() + 8;
-	uint32_t position = 0;
+//====================================================================================================
+//  CreateHeaderData
+//====================================================================================================
+int M4sFragmentWriter::CreateHeaderData()
+{
+	size_t mdat_size = MP4_BOX_HEADER_SIZE;
 
-	if (_media_type == M4sMediaType::VideoMediaType)
-	    position = _data_stream->size() - _sample_datas.size() * 16 - 4;
-	else if (_media_type == M4sMediaType::AudioMediaType)
-	    position = _data_stream->size() - _sample_datas.size() * 8 - 4;
+	for (auto &sample_data : _sample_datas)
+	{
+		mdat_size += sample_data->data.GetLength();
+	}
+
+	_data_stream->reserve(_data_stream->size() + MP4_FRAGMENT_HEADER_RESERVE_SIZE + _sample_datas.size() * 16 + MP4_BOX_HEADER_SIZE);
 
+	int moof_size = MoofBoxWrite(_data_stream);
 
-	(*_data_stream)[position] = ((uint8_t)(data_offset >> 24 & 0xFF));
-	(*_data_stream)[position + 1] = ((uint8_t)(data_offset >> 16 & 0xFF));
-	(*_data_stream)[position + 2] = ((uint8_t)(data_offset >> 8 & 0xFF));
-	(*_data_stream)[position + 3] = ((uint8_t)(data_offset & 0xFF));
+	OverwriteUint32(_data_offset_position, moof_size + MP4_BOX_HEADER_SIZE, _data_stream);
 
-	mdata_size += MdatBoxWrite(_data_stream);
+	WriteUint32(mdat_size, _data_stream);
+	WriteText("mdat", _data_stream);
 
-	return moof_size + mdata_size;
+	return moof_size + MP4_BOX_HEADER_SIZE;
 }
 
 //====================================================================================================
@@ -79,12 +100,12 @@ int M4sFragmentWriter::CreateData()
 //====================================================================================================
 int M4sFragmentWriter::MoofBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("moof", data_stream);
 
-	MfhdBoxWrite(data);
-	TrafBoxWrite(data);
+	MfhdBoxWrite(data_stream);
+	TrafBoxWrite(data_stream);
 	
-	return BoxDataWrite("moof", data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -92,11 +113,11 @@ int M4sFragmentWriter::MoofBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_
 //====================================================================================================
 int M4sFragmentWriter::MfhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("mfhd", 0, 0, data_stream);
 
-	WriteUint32(_sequence_number, data);	// Sequence Number
+	WriteUint32(_sequence_number, data_stream);	// Sequence Number
 
-	return BoxDataWrite("mfhd", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -104,13 +125,13 @@ int M4sFragmentWriter::MfhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_
 //====================================================================================================
 int M4sFragmentWriter::TrafBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("traf", data_stream);
 
-	TfhdBoxWrite(data);
-	TfdtBoxWrite(data);
-	TrunBoxWrite(data);
+	TfhdBoxWrite(data_stream);
+	TfdtBoxWrite(data_stream);
+	TrunBoxWrite(data_stream);
 
-	return BoxDataWrite("traf", data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -125,12 +146,12 @@ int M4sFragmentWriter::TrafBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_
 #define TFHD_FLAG_DEFAULT_BASE_IS_MOOF              (0x20000)
 int M4sFragmentWriter::TfhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
 	uint32_t flag = TFHD_FLAG_DEFAULT_BASE_IS_MOOF;
+	size_t box_position = BoxBegin("tfhd", 0, flag, data_stream);
 
-	WriteUint32(_track_id, data);	// track id
+	WriteUint32(_track_id, data_stream);	// track id
 
-	return BoxDataWrite("tfhd", 0, flag, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -138,11 +159,11 @@ int M4sFragmentWriter::TfhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_
 //====================================================================================================
 int M4sFragmentWriter::TfdtBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("tfdt", 1, 0, data_stream);
 	
-	WriteUint64(_start_timestamp, data);    // Base media decode time
+	WriteUint64(_start_timestamp, data_stream);    // Base media decode time
 
-	return BoxDataWrite("tfdt", 1, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -156,7 +177,6 @@ int M4sFragmentWriter::TfdtBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_
 #define TRUN_FLAG_SAMPLE_COMPOSITION_TIME_OFFSET_PRESENT (0x0800)
 int M4sFragmentWriter::TrunBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
 	uint32_t flag = 0;
 
 	if (M4sMediaType::VideoMediaType == _media_type)
@@ -168,26 +188,29 @@ int M4sFragmentWriter::TrunBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_
 		flag = TRUN_FLAG_DATA_OFFSET_PRESENT | TRUN_FLAG_SAMPLE_DURATION_PRESENT | TRUN_FLAG_SAMPLE_SIZE_PRESENT;
 	}
 
-	WriteUint32(_sample_datas.size(), data);	// Sample Item Count;
-	WriteUint32(0x11111111, data);	            // Data offset - temp 0 setting
+	size_t box_position = BoxBegin("trun", 0, flag, data_stream);
+
+	WriteUint32(_sample_datas.size(), data_stream);	// Sample Item Count;
+	_data_offset_position = data_stream->size();
+	WriteUint32(0, data_stream);	            // Data offset - CreateData()에서 moof 크기로 변경
 
 	for (auto &sample_data : _sample_datas)
 	{
-		WriteUint32(sample_data->duration, data);					// duration
+		WriteUint32(sample_data->duration, data_stream);					// duration
 
 		if (_media_type == M4sMediaType::VideoMediaType)
 		{
-			WriteUint32(sample_data->data->GetLength() + 4, data);			// size + sample
-			WriteUint32(sample_data->flag, data);;						// flag
-			WriteUint32(sample_data->composition_time_offset, data);	// compoistion timeoffset 
+			WriteUint32(sample_data->data.GetLength() + (sample_data->length_prefixed ? 0 : 4), data_stream);			// size + sample
+			WriteUint32(sample_data->flag, data_stream);;						// flag
+			WriteUint32(sample_data->composition_time_offset, data_stream);	// compoistion timeoffset 
 		}
 		else if (_media_type == M4sMediaType::AudioMediaType)
 		{
-			WriteUint32(sample_data->data->GetLength(), data);				// sample
+			WriteUint32(sample_data->data.GetLength(), data_stream);				// sample
 		}
 	}
 
-	return BoxDataWrite("trun", 0, flag, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -195,16 +218,16 @@ int M4sFragmentWriter::TrunBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_
 //====================================================================================================
 int M4sFragmentWriter::MdatBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("mdat", data_stream);
 
 	for (auto &sample_data : _sample_datas)
 	{
-		if (_media_type == M4sMediaType::VideoMediaType)
+		if ((_media_type == M4sMediaType::VideoMediaType) && (sample_data->length_prefixed == false))
 		{
-			WriteUint32(sample_data->data->GetLength(), data);	// size
+			WriteUint32(sample_data->data.GetLength(), data_stream);	// size
 		}
 
-		WriteData(sample_data->data, data);
+		WriteData(sample_data->data.GetDataAs<uint8_t>(), sample_data->data.GetLength(), data_stream);
 	}
-	return BoxDataWrite("mdat", data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
\ No newline at end of file
@@ -12,25 +12,32 @@
 #include "m4s_writer.h"
 #include "packetyzer_define.h"
 
+// Size of the boxes of moof except the sample entries of trun
+#define MP4_FRAGMENT_HEADER_RESERVE_SIZE	(128)
+
 //====================================================================================================
 // Fragment Sample Data
 //====================================================================================================
 struct FragmentSampleData
 {
 public:
-	FragmentSampleData(uint64_t duration_, uint32_t flag_, uint32_t composition_time_offset_, std::shared_ptr<ov::Data> &data_)
+	FragmentSampleData(uint64_t duration_, uint32_t flag_, uint32_t composition_time_offset_, const ov::DataView &data_, bool length_prefixed_ = false)
 	{
 		duration                =  duration_;
 		flag                    = flag_;
 		composition_time_offset = composition_time_offset_;
 		data		            = data_;
+		length_prefixed         = length_prefixed_;
 	}
 
 public:
 	uint64_t duration;
 	uint32_t flag;
 	uint32_t composition_time_offset;
-	std::shared_ptr<ov::Data> data;
+	// The range of the frame (e.g. without the start code), the buffer of the frame is shared
+	ov::DataView data;
+	// true: the video sample is already a sequence of the length-prefixed NAL units (otherwise it is a single NAL unit)
+	bool length_prefixed;
 };
 
 //====================================================================================================
@@ -51,6 +58,10 @@ public:
 public :
 	int CreateData();
 
+	// moof + header of mdat only, the samples are sent after it by the caller (scatter-gather, no copy)
+	// - the video samples must be length-prefixed
+	int CreateHeaderData();
+
 protected :
 
 	int MoofBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream);
@@ -68,4 +79,7 @@ private :
 	uint32_t _track_id;
 	uint64_t _start_timestamp;
 	std::vector<std::shared_ptr<FragmentSampleData>> _sample_datas;
+
+	// data offset field of trun(written by CreateData() after the size of moof is known)
+	size_t _data_offset_position = 0;
 };
\ No newline at end of file
@@ -0,0 +1,98 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#include "m4s_init_cache.h"
+#include "packetyzer.h"
+
+std::mutex M4sInitCache::_guard;
+std::unordered_map<std::string, std::weak_ptr<SegmentData>> M4sInitCache::_init_segments;
+
+//====================================================================================================
+// Append(value)
+// - 8 bytes(big endian)
+//====================================================================================================
+M4sInitCacheKey &M4sInitCacheKey::Append(uint64_t value)
+{
+    for (int shift = 56; shift >= 0; shift -= 8)
+        _data.push_back(static_cast<char>((value >> shift) & 0xFF));
+
+    return *this;
+}
+
+//====================================================================================================
+// Append(data)
+//====================================================================================================
+M4sInitCacheKey &M4sInitCacheKey::Append(const std::shared_ptr<std::vector<uint8_t>> &data)
+{
+    if (data == nullptr)
+        return Append(static_cast<uint64_t>(0));
+
+    Append(static_cast<uint64_t>(data->size()));
+    _data.append(reinterpret_cast<const char *>(data->data()), data->size());
+
+    return *this;
+}
+
+//====================================================================================================
+// Append(string)
+//====================================================================================================
+M4sInitCacheKey &M4sInitCacheKey::Append(const ov::String &value)
+{
+    Append(static_cast<uint64_t>(value.GetLength()));
+    _data.append(value.CStr(), value.GetLength());
+
+    return *this;
+}
+
+//====================================================================================================
+// Init Segment
+// - the creator is called with the guard locked : the renditions started at the same time create it once
+//====================================================================================================
+std::shared_ptr<SegmentData> M4sInitCache::GetInitSegment(const ov::String &file_name,
+                                                          const M4sInitCacheKey &key,
+                                                          const ov::String &cache_control,
+                                                          const std::function<std::shared_ptr<std::vector<uint8_t>>()> &creator)
+{
+    std::string cache_key = M4sInitCacheKey(key).Append(file_name).Append(cache_control).GetData();
+
+    std::lock_guard<std::mutex> lock(_guard);
+
+    auto item = _init_segments.find(cache_key);
+
+    if (item != _init_segments.end())
+    {
+        auto init_segment = item->second.lock();
+
+        if (init_segment != nullptr)
+            return init_segment;
+    }
+
+    auto data = creator();
+
+    if (data == nullptr || data->empty())
+        return nullptr;
+
+    auto init_segment = std::make_shared<SegmentData>(0, file_name, 0, 0, data);
+
+    init_segment->etag.Format("\"i-%llx\"", static_cast<unsigned long long>(ov::HashBytes(data->data(), data->size())));
+    init_segment->last_modified = Packetyzer::MakeHttpDateString(init_segment->create_time);
+    init_segment->cache_control = cache_control;
+
+    // the released init segments are removed
+    for (auto iterator = _init_segments.begin(); iterator != _init_segments.end();)
+    {
+        if (iterator->second.expired())
+            iterator = _init_segments.erase(iterator);
+        else
+            ++iterator;
+    }
+
+    _init_segments[cache_key] = init_segment;
+
+    return init_segment;
+}
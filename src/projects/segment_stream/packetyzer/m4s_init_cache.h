@@ -0,0 +1,58 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include "../base/ovlibrary/ovlibrary.h"
+#include "packetyzer_define.h"
+
+//====================================================================================================
+// M4sInitCacheKey
+// - configuration of an init segment : the parameters of M4sInitWriter and the codec configuration(SPS/PPS/VPS)
+//====================================================================================================
+class M4sInitCacheKey
+{
+public:
+    M4sInitCacheKey &Append(uint64_t value);
+
+    // length + bytes(nullptr : the length only)
+    M4sInitCacheKey &Append(const std::shared_ptr<std::vector<uint8_t>> &data);
+
+    M4sInitCacheKey &Append(const ov::String &value);
+
+    const std::string &GetData() const { return _data; }
+
+private:
+    std::string _data;
+};
+
+//====================================================================================================
+// M4sInitCache
+// - process-wide cache of the init segments(DASH initialization, HLS(CMAF) EXT-X-MAP)
+// - identical renditions and the restarted streams share the same immutable buffer and ETag,
+//   the init segment is released when no packetyzer uses it
+// - ETag is the hash of the init segment, so it is not changed by a restart of the stream
+//====================================================================================================
+class M4sInitCache
+{
+public:
+    // init segment of the configuration, the creator is called only if it is not cached(nullptr : failed)
+    // - the returned segment must not be modified
+    static std::shared_ptr<SegmentData> GetInitSegment(const ov::String &file_name,
+                                                       const M4sInitCacheKey &key,
+                                                       const ov::String &cache_control,
+                                                       const std::function<std::shared_ptr<std::vector<uint8_t>>()> &creator);
+
+private:
+    static std::mutex _guard;
+    // key : file name + configuration
+    static std::unordered_map<std::string, std::weak_ptr<SegmentData>> _init_segments;
+};
@@ -9,6 +9,8 @@
 
 #include "m4s_init_writer.h"
 #include "bit_writer.h"
+#include "packetyzer_define.h"
+#include <sstream>
 
 //Fragmented MP4
 // init m4s
@@ -32,6 +34,8 @@
 //                        - stsd(Sample Description)
 //                            - avc1(AVC Sample)
 //                                - avcC(AVC Decoder Configuration Record)
+//                            - hvc1(HEVC Sample)
+//                                - hvcC(HEVC Decoder Configuration Record)
 //                        - mp4a(MPEG4 Audio Sample Entry)
 //                            - esds(ES Descriptor)
 //                        - stts(Decoding TIme to Sample)
@@ -45,6 +49,57 @@
 const int g_sample_rate_table[] = {96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350, 0, 0, 0};
 #define SAMPLERATE_TABLE_SIZE (16)
 
+// Enough for the fields before bit_depth_chroma_minus8
+#define HEVC_SPS_MAX_PARSE_SIZE	(128)
+
+namespace
+{
+	// Bit reader of the RBSP(the emulation prevention bytes are removed)
+	class RbspReader
+	{
+	public:
+		RbspReader(const std::vector<uint8_t> &nal, size_t header_size)
+		{
+			size_t zero_count = 0;
+
+			for(size_t index = header_size; (index < nal.size()) && (_data.size() < HEVC_SPS_MAX_PARSE_SIZE); index++)
+			{
+				if((zero_count >= 2) && (nal[index] == 0x03))
+				{
+					// emulation_prevention_three_byte
+					zero_count = 0;
+					continue;
+				}
+
+				zero_count = (nal[index] == 0x00) ? (zero_count + 1) : 0;
+				_data.push_back(nal[index]);
+			}
+
+			_reader = ov::BitReader(_data.data(), _data.size());
+		}
+
+		uint32_t ReadBits(int count)
+		{
+			return _reader.ReadBits(count);
+		}
+
+		// ue(v)
+		uint32_t ReadUe()
+		{
+			return _reader.ReadUe();
+		}
+
+		bool IsOverflow() const
+		{
+			return _reader.IsOverflow();
+		}
+
+	private:
+		std::vector<uint8_t> _data;
+		ov::BitReader _reader;
+	};
+}
+
 //====================================================================================================
 // Constructor
 //====================================================================================================
@@ -119,13 +174,13 @@ int M4sInitWriter::FtypBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 {
 	std::string major_brand = "mp42";
 	std::string compatible_brands = "isommp42iso5dash";// isom(4)mp42(4)iso5(4)dash(4)
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>(); 
+	size_t box_position = BoxBegin("ftyp", data_stream);
 
-	WriteText(major_brand, data);         // Major brand
-	WriteUint32(0, data);                   // Minor version
-	WriteText(compatible_brands, data);   // Compatible brands
+	WriteText(major_brand, data_stream);         // Major brand
+	WriteUint32(0, data_stream);                   // Minor version
+	WriteText(compatible_brands, data_stream);   // Compatible brands
 	
-	return BoxDataWrite("ftyp", data, data_stream);
+	return BoxEnd(box_position, data_stream);
 
 }
 
@@ -134,13 +189,13 @@ int M4sInitWriter::FtypBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::MoovBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("moov", data_stream);
 
-	MvhdBoxWrite(data);
-	MvexBoxWrite(data);
-	TrakBoxWrite(data);
+	MvhdBoxWrite(data_stream);
+	MvexBoxWrite(data_stream);
+	TrakBoxWrite(data_stream);
 	
-	return BoxDataWrite("moov", data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -148,7 +203,7 @@ int M4sInitWriter::MoovBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::MvhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("mvhd", 0, 0, data_stream);
 	std::vector<uint8_t> metrix = {0, 0x01, 0, 0,
 								   0, 0, 0, 0,
 								   0, 0, 0, 0,
@@ -159,18 +214,18 @@ int M4sInitWriter::MvhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 								   0, 0, 0, 0,
 								   0x40, 0, 0, 0};
 
-	WriteUint32(0, data);               // Create Time
-	WriteUint32(0, data);               // Modification Time
-	WriteUint32(_timescale, data);      // Timescale
-	WriteUint32(_duration, data);       // Duration
-	WriteUint32(0x01 << 16, data);      // rate version
-	WriteUint16(0x01 << 8, data);          // volme version
-	WriteInit(0, 10, data);             // Reserve(10Byte)
-	WriteData(metrix, data);            // Matrix
-	WriteInit(0, 24, data);             // pre-defined(24byte)
-	WriteUint32(0XFFFFFFFF, data);   // Next Track ID
-
-	return BoxDataWrite("mvhd", 0, 0, data, data_stream);
+	WriteUint32(0, data_stream);               // Create Time
+	WriteUint32(0, data_stream);               // Modification Time
+	WriteUint32(_timescale, data_stream);      // Timescale
+	WriteUint32(_duration, data_stream);       // Duration
+	WriteUint32(0x01 << 16, data_stream);      // rate version
+	WriteUint16(0x01 << 8, data_stream);          // volme version
+	WriteInit(0, 10, data_stream);             // Reserve(10Byte)
+	WriteData(metrix, data_stream);            // Matrix
+	WriteInit(0, 24, data_stream);             // pre-defined(24byte)
+	WriteUint32(0XFFFFFFFF, data_stream);   // Next Track ID
+
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -178,12 +233,12 @@ int M4sInitWriter::MvhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::TrakBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("trak", data_stream);
 
-	TkhdBoxWrite(data);
-	MdiaBoxWrite(data);
+	TkhdBoxWrite(data_stream);
+	MdiaBoxWrite(data_stream);
 
-	return BoxDataWrite("trak", data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -191,7 +246,7 @@ int M4sInitWriter::TrakBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::TkhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("tkhd", 0, 7, data_stream);
 	std::vector<uint8_t> metrix = {0, 0x01, 0, 0,
 								   0, 0, 0, 0,
 								   0, 0, 0, 0,
@@ -202,30 +257,30 @@ int M4sInitWriter::TkhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 								   0, 0, 0, 0,
 								   0x40, 0, 0, 0};
 
-	WriteUint32(0, data);					// Create Time
-	WriteUint32(0, data);					// Modification Time
-	WriteUint32(_track_id, data);			// Track ID
-	WriteInit(0, 4, data);					// Reserve(4Byte)
-	WriteUint32(_duration, data);			// Duration
-	WriteInit(0, 8, data);					// Reserve(8Byte)
-	WriteUint16(0, data);					// layer
-	WriteUint16(0, data);					// alternate group
-	WriteUint16(0, data);					// volume
-	WriteInit(0, 2, data);					// Reserve(2Byte)
-	WriteData(metrix, data);				// Matrix
+	WriteUint32(0, data_stream);					// Create Time
+	WriteUint32(0, data_stream);					// Modification Time
+	WriteUint32(_track_id, data_stream);			// Track ID
+	WriteInit(0, 4, data_stream);					// Reserve(4Byte)
+	WriteUint32(_duration, data_stream);			// Duration
+	WriteInit(0, 8, data_stream);					// Reserve(8Byte)
+	WriteUint16(0, data_stream);					// layer
+	WriteUint16(0, data_stream);					// alternate group
+	WriteUint16(0, data_stream);					// volume
+	WriteInit(0, 2, data_stream);					// Reserve(2Byte)
+	WriteData(metrix, data_stream);				// Matrix
 
 	if(_media_type == M4sMediaType::VideoMediaType)
 	{
-		WriteUint32(_video_width << 16, data);  // Width
-		WriteUint32(_video_height << 16, data); // Height
+		WriteUint32(_video_width << 16, data_stream);  // Width
+		WriteUint32(_video_height << 16, data_stream); // Height
 	}
 	else
 	{
-		WriteUint32(0, data);  // Width
-		WriteUint32(0, data); // Height
+		WriteUint32(0, data_stream);  // Width
+		WriteUint32(0, data_stream); // Height
 	}
 
-	return BoxDataWrite("tkhd", 0, 7, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -233,13 +288,13 @@ int M4sInitWriter::TkhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::MdiaBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("mdia", data_stream);
 
-	MdhdBoxWrite(data);
-	HdlrBoxWrite(data);
-	MinfBoxWrite(data);
+	MdhdBoxWrite(data_stream);
+	HdlrBoxWrite(data_stream);
+	MinfBoxWrite(data_stream);
 
-	return BoxDataWrite("mdia", data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -247,26 +302,26 @@ int M4sInitWriter::MdiaBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::MdhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("mdhd", 0, 0, data_stream);
 
-	WriteUint32(0, data);               // Create Time
-	WriteUint32(0, data);               // Modification Time
+	WriteUint32(0, data_stream);               // Create Time
+	WriteUint32(0, data_stream);               // Modification Time
 	if (_media_type == M4sMediaType::VideoMediaType)
 	{
-		WriteUint32(_timescale, data);      // Timescale
-		WriteUint32(_duration, data);       // Duration
+		WriteUint32(_timescale, data_stream);      // Timescale
+		WriteUint32(_duration, data_stream);       // Duration
 	}
 	else if(_media_type == M4sMediaType::AudioMediaType)
 	{
-		WriteUint32(_audio_sample_rate, data);  // Timescale
-		WriteUint32(_duration, data);					// Duration
+		WriteUint32(_audio_sample_rate, data_stream);  // Timescale
+		WriteUint32(_duration, data_stream);					// Duration
 	}
 
-	WriteUint8((((_language[0] - 0x60) << 2) | (_language[1] - 0x60) >> 3) & 0xFF , data); // Language 1
-	WriteUint8((((_language[1] - 0x60) << 5) |  (_language[2] - 0x60)) & 0xFF , data);          // Language 2
-	WriteUint16(0, data);					// Pre Define 
+	WriteUint8((((_language[0] - 0x60) << 2) | (_language[1] - 0x60) >> 3) & 0xFF , data_stream); // Language 1
+	WriteUint8((((_language[1] - 0x60) << 5) |  (_language[2] - 0x60)) & 0xFF , data_stream);          // Language 2
+	WriteUint16(0, data_stream);					// Pre Define 
 
-	return BoxDataWrite("mdhd", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -274,15 +329,15 @@ int M4sInitWriter::MdhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::HdlrBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("hdlr", 0, 0, data_stream);
 
-	WriteUint32(0, data);				// Pre Define
-	WriteText(_handler_type, data);		// Handler Type
-	WriteInit(0, 12, data);	            // Reserve(12Byte)
-	WriteText(_compressor_name, data);  // Handler Name
-	WriteUint8(0, data);				// null
+	WriteUint32(0, data_stream);				// Pre Define
+	WriteText(_handler_type, data_stream);		// Handler Type
+	WriteInit(0, 12, data_stream);	            // Reserve(12Byte)
+	WriteText(_compressor_name, data_stream);  // Handler Name
+	WriteUint8(0, data_stream);				// null
 
-	return BoxDataWrite("hdlr", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -290,15 +345,15 @@ int M4sInitWriter::HdlrBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::MinfBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("minf", data_stream);
 
-	if(_media_type == M4sMediaType::VideoMediaType)     	VmhdBoxWrite(data);
-	else if(_media_type == M4sMediaType::AudioMediaType)	SmhdBoxWrite(data);
+	if(_media_type == M4sMediaType::VideoMediaType)     	VmhdBoxWrite(data_stream);
+	else if(_media_type == M4sMediaType::AudioMediaType)	SmhdBoxWrite(data_stream);
 
-	DinfBoxWrite(data); 
-	StblBoxWrite(data);
+	DinfBoxWrite(data_stream); 
+	StblBoxWrite(data_stream);
 
-	return BoxDataWrite("minf", data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -306,12 +361,12 @@ int M4sInitWriter::MinfBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::VmhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("vmhd", 0, 1, data_stream);
 
-	WriteUint16(0, data);	// Graphics Mode
-	WriteInit(0, 6, data);	// Op Color
+	WriteUint16(0, data_stream);	// Graphics Mode
+	WriteInit(0, 6, data_stream);	// Op Color
 
-	return BoxDataWrite("vmhd", 0, 1, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -319,12 +374,12 @@ int M4sInitWriter::VmhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::SmhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("smhd", 0, 0, data_stream);
 
-	WriteUint16(0, data);	// Balance
-	WriteUint16(0, data);	// Reserved
+	WriteUint16(0, data_stream);	// Balance
+	WriteUint16(0, data_stream);	// Reserved
 
-	return BoxDataWrite("smhd", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -332,11 +387,11 @@ int M4sInitWriter::SmhdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::DinfBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("dinf", data_stream);
 
-	DrefBoxWrite(data);
+	DrefBoxWrite(data_stream);
 
-	return BoxDataWrite("dinf", data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -344,13 +399,13 @@ int M4sInitWriter::DinfBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::DrefBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("dref", 0, 0, data_stream);
 
-	WriteUint32(1, data); // child count
-	UrlBoxWrite(data);    // url child
+	WriteUint32(1, data_stream); // child count
+	UrlBoxWrite(data_stream);    // url child
    
 
-	return BoxDataWrite("dref", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -358,9 +413,9 @@ int M4sInitWriter::DrefBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::UrlBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = nullptr;
+	size_t box_position = BoxBegin("url ", 0, 1, data_stream);
 
-	return BoxDataWrite("url ", 0, 1, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -368,15 +423,15 @@ int M4sInitWriter::UrlBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_strea
 //====================================================================================================
 int M4sInitWriter::StblBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("stbl", data_stream);
 
-	StsdBoxWrite(data);
-	SttsBoxWrite(data);
-	StscBoxWrite(data);
-	StszBoxWrite(data);
-	StcoBoxWrite(data);
+	StsdBoxWrite(data_stream);
+	SttsBoxWrite(data_stream);
+	StscBoxWrite(data_stream);
+	StszBoxWrite(data_stream);
+	StcoBoxWrite(data_stream);
 
-	return BoxDataWrite("stbl", data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -384,14 +439,41 @@ int M4sInitWriter::StblBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::StsdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("stsd", 0, 0, data_stream);
+
+	WriteUint32(1, data_stream); // Child Count
+
+	if(_media_type == M4sMediaType::VideoMediaType)
+	{
+		if(_hevc_vps != nullptr)	Hvc1BoxWrite(data_stream);
+		else						Avc1BoxWrite(data_stream);
+	}
 
-	WriteUint32(1, data); // Child Count
+	if(_media_type == M4sMediaType::AudioMediaType)	Mp4aBoxWrite(data_stream);
 
-	if(_media_type == M4sMediaType::VideoMediaType)	Avc1BoxWrite(data);
-	if(_media_type == M4sMediaType::AudioMediaType)	Mp4aBoxWrite(data);
+	return BoxEnd(box_position, data_stream);
+}
 
-	return BoxDataWrite("stsd", 0, 0, data, data_stream);
+//====================================================================================================
+// Visual Sample Entry(avc1/hvc1 공통)
+//====================================================================================================
+void M4sInitWriter::VisualSampleEntryWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
+{
+	WriteUint32(1, data_stream);								// Child Count
+	WriteUint16(0, data_stream);								// Pre Define
+	WriteUint16(0, data_stream);								// Reserve(2Byte)
+	WriteInit(0, 12, data_stream);								// Pre Define(12byte) 
+	WriteUint16((uint16_t)_video_width, data_stream);					// Width
+	WriteUint16((uint16_t)_video_height, data_stream);					// Height
+	WriteUint32(0x00480000, data_stream);						// Horiz Resolution
+	WriteUint32(0x00480000, data_stream);						// Vert Resolution
+	WriteUint32(0, data_stream);								// Reserve(4Byte)
+	WriteUint16(1, data_stream);								// Frame Count
+	WriteUint8((uint8_t)_compressor_name.size(), data_stream); // Compressor Name Size(Max 31Byte) 
+	WriteText(_compressor_name, data_stream);					// Compressor Name 
+	WriteInit(0, 31 - _compressor_name.size(), data_stream);	// Padding(31 - Compressor Name Size) 
+	WriteUint16(0x0018, data_stream);							// Depth
+	WriteUint16(0xFFFF, data_stream);							// Pre Define
 }
 
 //====================================================================================================
@@ -399,27 +481,12 @@ int M4sInitWriter::StsdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::Avc1BoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
-
-	WriteUint32(1, data);								// Child Count
-	WriteUint16(0, data);								// Pre Define
-	WriteUint16(0, data);								// Reserve(2Byte)
-	WriteInit(0, 12, data);								// Pre Define(12byte) 
-	WriteUint16((uint16_t)_video_width, data);					// Width
-	WriteUint16((uint16_t)_video_height, data);					// Height
-	WriteUint32(0x00480000, data);						// Horiz Resolution
-	WriteUint32(0x00480000, data);						// Vert Resolution
-	WriteUint32(0, data);								// Reserve(4Byte)
-	WriteUint16(1, data);								// Frame Count
-	WriteUint8((uint8_t)_compressor_name.size(), data); // Compressor Name Size(Max 31Byte) 
-	WriteText(_compressor_name, data);					// Compressor Name 
-	WriteInit(0, 31 - _compressor_name.size(), data);	// Padding(31 - Compressor Name Size) 
-	WriteUint16(0x0018, data);							// Depth
-	WriteUint16(0xFFFF, data);							// Pre Define
+	size_t box_position = BoxBegin("avc1", 0, 0, data_stream);
 
-	AvccBoxWrite(data); 
+	VisualSampleEntryWrite(data_stream);
+	AvccBoxWrite(data_stream); 
 
-	return BoxDataWrite("avc1", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -427,46 +494,248 @@ int M4sInitWriter::Avc1BoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::AvccBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("avcC", data_stream);
 	uint8_t avc_profile 				= _avc_sps->at(1);
 	uint8_t avc_profile_compatibility 	= _avc_sps->at(2);
 	uint8_t avc_level 					= _avc_sps->at(3);
 	uint8_t avc_nal_unit_size			= 4;
 
-	WriteUint8(1, data);							// Configuration Version
-	WriteUint8(avc_profile, data);					// Profile
-	WriteUint8(avc_profile_compatibility, data);	// Profile Compatibillity
-	WriteUint8(avc_level, data);					// Level
-	WriteUint8((uint8_t)((avc_nal_unit_size - 1) | 0xFC), data);	// Nal Unit Size
-	WriteUint8(1 | 0xE0, data);						// SPS Count
-	WriteUint16(_avc_sps->size(), data);				// SPS Size
-	WriteData(*_avc_sps, data);						// SPS
-	WriteUint8(1, data);							// PPS Count
-	WriteUint16(_avc_pps->size(), data);				// PPS Size
-	WriteData(*_avc_pps, data);						// PPS
+	WriteUint8(1, data_stream);							// Configuration Version
+	WriteUint8(avc_profile, data_stream);					// Profile
+	WriteUint8(avc_profile_compatibility, data_stream);	// Profile Compatibillity
+	WriteUint8(avc_level, data_stream);					// Level
+	WriteUint8((uint8_t)((avc_nal_unit_size - 1) | 0xFC), data_stream);	// Nal Unit Size
+	WriteUint8(1 | 0xE0, data_stream);						// SPS Count
+	WriteUint16(_avc_sps->size(), data_stream);				// SPS Size
+	WriteData(*_avc_sps, data_stream);						// SPS
+	WriteUint8(1, data_stream);							// PPS Count
+	WriteUint16(_avc_pps->size(), data_stream);				// PPS Size
+	WriteData(*_avc_pps, data_stream);						// PPS
+
+	return BoxEnd(box_position, data_stream);
+}
+
+//====================================================================================================
+// HEVC Parameter Sets
+//====================================================================================================
+void M4sInitWriter::SetHevcParameterSets(const std::shared_ptr<std::vector<uint8_t>> &vps,
+										 const std::shared_ptr<std::vector<uint8_t>> &sps,
+										 const std::shared_ptr<std::vector<uint8_t>> &pps)
+{
+	_hevc_vps = vps;
+	_hevc_sps = sps;
+	_hevc_pps = pps;
+}
+
+//====================================================================================================
+// HEVC SPS Parsing(ITU-T H.265 7.3.2.2.1)
+// - profile_tier_level ~ bit_depth_chroma_minus8
+//====================================================================================================
+bool M4sInitWriter::ParseHevcSps(const std::vector<uint8_t> &sps, HevcSpsInfo &info)
+{
+	// NAL header(2Byte)
+	RbspReader reader(sps, 2);
+	HevcSpsInfo parsed;
+
+	reader.ReadBits(4);													// sps_video_parameter_set_id
+	parsed.max_sub_layers_minus1 = (uint8_t)reader.ReadBits(3);
+	parsed.temporal_id_nesting_flag = (uint8_t)reader.ReadBits(1);
+
+	// profile_tier_level(1, sps_max_sub_layers_minus1)
+	parsed.profile_space = (uint8_t)reader.ReadBits(2);
+	parsed.tier_flag = (uint8_t)reader.ReadBits(1);
+	parsed.profile_idc = (uint8_t)reader.ReadBits(5);
+	parsed.profile_compatibility_flags = reader.ReadBits(32);
+
+	for(auto &constraint_flag : parsed.constraint_indicator_flags)
+	{
+		constraint_flag = (uint8_t)reader.ReadBits(8);
+	}
+
+	parsed.level_idc = (uint8_t)reader.ReadBits(8);
+
+	bool sub_layer_profile_present[8] = { false, };
+	bool sub_layer_level_present[8] = { false, };
+
+	for(int index = 0; index < parsed.max_sub_layers_minus1; index++)
+	{
+		sub_layer_profile_present[index] = (reader.ReadBits(1) != 0);
+		sub_layer_level_present[index] = (reader.ReadBits(1) != 0);
+	}
+
+	if(parsed.max_sub_layers_minus1 > 0)
+	{
+		for(int index = parsed.max_sub_layers_minus1; index < 8; index++)
+		{
+			reader.ReadBits(2);											// reserved_zero_2bits
+		}
+	}
+
+	for(int index = 0; index < parsed.max_sub_layers_minus1; index++)
+	{
+		if(sub_layer_profile_present[index])
+		{
+			// sub_layer_profile_space ~ sub_layer_inbld_flag(88bit)
+			reader.ReadBits(32);
+			reader.ReadBits(32);
+			reader.ReadBits(24);
+		}
+
+		if(sub_layer_level_present[index])
+		{
+			reader.ReadBits(8);											// sub_layer_level_idc
+		}
+	}
+
+	reader.ReadUe();													// sps_seq_parameter_set_id
+	parsed.chroma_format_idc = (uint8_t)reader.ReadUe();
+
+	if(parsed.chroma_format_idc == 3)
+	{
+		reader.ReadBits(1);												// separate_colour_plane_flag
+	}
+
+	reader.ReadUe();													// pic_width_in_luma_samples
+	reader.ReadUe();													// pic_height_in_luma_samples
+
+	if(reader.ReadBits(1) != 0)											// conformance_window_flag
+	{
+		reader.ReadUe();
+		reader.ReadUe();
+		reader.ReadUe();
+		reader.ReadUe();
+	}
+
+	parsed.bit_depth_luma_minus8 = (uint8_t)reader.ReadUe();
+	parsed.bit_depth_chroma_minus8 = (uint8_t)reader.ReadUe();
+
+	if(reader.IsOverflow() || (parsed.max_sub_layers_minus1 > 7) || (parsed.chroma_format_idc > 3))
+	{
+		return false;
+	}
+
+	info = parsed;
+
+	return true;
+}
+
+//====================================================================================================
+// HEVC codecs parameter
+// - hvc1.[profile_space][profile_idc].[compatibility flags(reverse)].[tier][level_idc].[constraint flags]
+//====================================================================================================
+std::string M4sInitWriter::MakeHevcCodecString(const HevcSpsInfo &info)
+{
+	std::ostringstream codec_string;
+	uint32_t compatibility_flags = 0;
+
+	for(int index = 0; index < 32; index++)
+	{
+		compatibility_flags |= ((info.profile_compatibility_flags >> index) & 0x01) << (31 - index);
+	}
+
+	codec_string << "hvc1.";
+
+	if(info.profile_space > 0)
+	{
+		codec_string << (char)('A' + info.profile_space - 1);
+	}
+
+	codec_string << (int)info.profile_idc << "."
+				 << std::hex << std::uppercase << compatibility_flags << std::dec << "."
+				 << ((info.tier_flag != 0) ? "H" : "L") << (int)info.level_idc;
+
+	// the trailing zero bytes are omitted
+	int constraint_count = 6;
+
+	while((constraint_count > 0) && (info.constraint_indicator_flags[constraint_count - 1] == 0))
+	{
+		constraint_count--;
+	}
+
+	for(int index = 0; index < constraint_count; index++)
+	{
+		codec_string << "." << std::hex << std::uppercase << (int)info.constraint_indicator_flags[index] << std::dec;
+	}
+
+	return codec_string.str();
+}
+
+//====================================================================================================
+// hvc1(HEVC Sample Entry)
+//====================================================================================================
+int M4sInitWriter::Hvc1BoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
+{
+	size_t box_position = BoxBegin("hvc1", 0, 0, data_stream);
+
+	VisualSampleEntryWrite(data_stream);
+	HvccBoxWrite(data_stream);
+
+	return BoxEnd(box_position, data_stream);
+}
+
+//====================================================================================================
+// hvcC(HEVC Decoder Configuration Record)
+// - the parameter sets are in the sample entry(hvc1), array_completeness is 1
+//====================================================================================================
+int M4sInitWriter::HvccBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
+{
+	size_t box_position = BoxBegin("hvcC", data_stream);
+	HevcSpsInfo info;
+	uint8_t hevc_nal_unit_size = 4;
+
+	// the default profile(Main) is used if the parsing is failed
+	ParseHevcSps(*_hevc_sps, info);
+
+	WriteUint8(1, data_stream);																// Configuration Version
+	WriteUint8((uint8_t)((info.profile_space << 6) | (info.tier_flag << 5) | info.profile_idc), data_stream);	// Profile Space/Tier/Profile
+	WriteUint32(info.profile_compatibility_flags, data_stream);								// Profile Compatibility
+	WriteData(info.constraint_indicator_flags, sizeof(info.constraint_indicator_flags), data_stream);	// Constraint Indicator
+	WriteUint8(info.level_idc, data_stream);													// Level
+	WriteUint16(0xF000, data_stream);															// Min Spatial Segmentation(0)
+	WriteUint8(0xFC, data_stream);																// Parallelism Type(0)
+	WriteUint8((uint8_t)(0xFC | info.chroma_format_idc), data_stream);							// Chroma Format
+	WriteUint8((uint8_t)(0xF8 | info.bit_depth_luma_minus8), data_stream);						// Bit Depth Luma
+	WriteUint8((uint8_t)(0xF8 | info.bit_depth_chroma_minus8), data_stream);					// Bit Depth Chroma
+	WriteUint16(0, data_stream);																// Avg Frame Rate
+	WriteUint8((uint8_t)(((info.max_sub_layers_minus1 + 1) << 3) | (info.temporal_id_nesting_flag << 2) | (hevc_nal_unit_size - 1)), data_stream);	// Temporal Layers/Nal Unit Size
+	WriteUint8(3, data_stream);																// Array Count
+
+	const std::pair<uint8_t, std::shared_ptr<std::vector<uint8_t>>> arrays[] = {
+		{ HEVC_NAL_TYPE_VPS, _hevc_vps },
+		{ HEVC_NAL_TYPE_SPS, _hevc_sps },
+		{ HEVC_NAL_TYPE_PPS, _hevc_pps },
+	};
+
+	for(const auto &array : arrays)
+	{
+		WriteUint8((uint8_t)(0x80 | array.first), data_stream);								// Array Completeness + Nal Unit Type
+		WriteUint16(1, data_stream);															// Nal Unit Count
+		WriteUint16((uint16_t)array.second->size(), data_stream);								// Nal Unit Size
+		WriteData(*array.second, data_stream);													// Nal Unit
+	}
 
-	return BoxDataWrite("avcC", data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 //====================================================================================================
 // Mp4a(MPEG-4 Audio Sample Entry)
 //====================================================================================================
 int M4sInitWriter::Mp4aBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("mp4a", 0, 0, data_stream);
 
-	WriteUint32(1, data);				            // Child Count
-	WriteUint16(0, data);				            // QT version
-	WriteUint16(0, data);				            // QT revision
-	WriteUint32(0, data);				            // QT vendor
-	WriteUint16(_audio_channels, data);        // channel count
-	WriteUint16(_audio_sample_size, data);	        // sample size
-	WriteUint16(0, data);				            // QT compression ID
-	WriteUint16(0, data);				            // QT packet size
-	WriteUint32(_audio_sample_rate << 16, data);	// sample rate
+	WriteUint32(1, data_stream);				            // Child Count
+	WriteUint16(0, data_stream);				            // QT version
+	WriteUint16(0, data_stream);				            // QT revision
+	WriteUint32(0, data_stream);				            // QT vendor
+	WriteUint16(_audio_channels, data_stream);        // channel count
+	WriteUint16(_audio_sample_size, data_stream);	        // sample size
+	WriteUint16(0, data_stream);				            // QT compression ID
+	WriteUint16(0, data_stream);				            // QT packet size
+	WriteUint32(_audio_sample_rate << 16, data_stream);	// sample rate
 
-	EsdsBoxWrite(data);
+	EsdsBoxWrite(data_stream);
 
-	return BoxDataWrite("mp4a", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -474,22 +743,22 @@ int M4sInitWriter::Mp4aBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::EsdsBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("esds", 0, 0, data_stream);
 
 	// es id(3)
-	WriteUint8(3, data);							// tag
-	WriteUint8(0x19, data);							// tag size
-	WriteUint16(0, data);							// es id ??? track id
-	WriteUint8(0, data);							// flag
+	WriteUint8(3, data_stream);							// tag
+	WriteUint8(0x19, data_stream);							// tag size
+	WriteUint16(0, data_stream);							// es id ??? track id
+	WriteUint8(0, data_stream);							// flag
 
 	// decoder config(13)
-	WriteUint8(4, data);							// tag
-	WriteUint8(0x11, data);							// tag size
-	WriteUint8(0x40, data);							// Object type indication  - MPEG-4 audio (0X40)
-	WriteUint8(0x15, data);							// Stream type( <<2)  / Up Stream ( << 1) / Reserve(0x01)
-	WriteUint24(0, data);							// Buffer Size
-	WriteUint32(0, data);							// MaxBitrate
-	WriteUint32(0, data);							// AverageBitreate
+	WriteUint8(4, data_stream);							// tag
+	WriteUint8(0x11, data_stream);							// tag size
+	WriteUint8(0x40, data_stream);							// Object type indication  - MPEG-4 audio (0X40)
+	WriteUint8(0x15, data_stream);							// Stream type( <<2)  / Up Stream ( << 1) / Reserve(0x01)
+	WriteUint24(0, data_stream);							// Buffer Size
+	WriteUint32(0, data_stream);							// MaxBitrate
+	WriteUint32(0, data_stream);							// AverageBitreate
 
 	// DecoderSpecific info descriptor
 	/*
@@ -512,17 +781,17 @@ int M4sInitWriter::EsdsBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 	bit_writer.Write(4, _audio_sample_index);	// frequency index
 	bit_writer.Write(4, _audio_channels);		// channel configuration
 
-	WriteUint8(5, data);						// tag
-	WriteUint8(2, data);						// tag size
+	WriteUint8(5, data_stream);						// tag
+	WriteUint8(2, data_stream);						// tag size
 
-	WriteData(bit_writer.GetData(), (int)bit_writer.GetDataSize(), data);    //
+	WriteData(bit_writer.GetData(), (int)bit_writer.GetDataSize(), data_stream);    //
 
 	// sl config(1)
-	WriteUint8(6, data);	// tag
-	WriteUint8(1, data);	// tag size
-	WriteUint8(2, data);	// always 2 refer from mov_write_esds_tag
+	WriteUint8(6, data_stream);	// tag
+	WriteUint8(1, data_stream);	// tag size
+	WriteUint8(2, data_stream);	// always 2 refer from mov_write_esds_tag
 
-	return BoxDataWrite("esds", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -530,11 +799,11 @@ int M4sInitWriter::EsdsBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::SttsBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("stts", 0, 0, data_stream);
 
-	WriteUint32(0, data); // Entry Count
+	WriteUint32(0, data_stream); // Entry Count
 
-	return BoxDataWrite("stts", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -542,11 +811,11 @@ int M4sInitWriter::SttsBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::StscBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("stsc", 0, 0, data_stream);
 
-	WriteUint32(0, data); // Entry Count
+	WriteUint32(0, data_stream); // Entry Count
 
-	return BoxDataWrite("stsc", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -554,12 +823,12 @@ int M4sInitWriter::StscBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::StszBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("stsz", 0, 0, data_stream);
 
-	WriteUint32(0, data); // Sample Size
-	WriteUint32(0, data); // Sample Count
+	WriteUint32(0, data_stream); // Sample Size
+	WriteUint32(0, data_stream); // Sample Count
 
-	return BoxDataWrite("stsz", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -567,11 +836,11 @@ int M4sInitWriter::StszBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::StcoBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("stco", 0, 0, data_stream);
 
-	WriteUint32(0, data); // Entry Count
+	WriteUint32(0, data_stream); // Entry Count
 
-	return BoxDataWrite("stco", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -579,12 +848,12 @@ int M4sInitWriter::StcoBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::MvexBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("mvex", data_stream);
 
-	//MehdBoxWrite(data);
-	TrexBoxWrite(data);
+	//MehdBoxWrite(data_stream);
+	TrexBoxWrite(data_stream);
 
-	return BoxDataWrite("mvex", data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -592,9 +861,9 @@ int M4sInitWriter::MvexBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::MehdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("mehd", 0, 0, data_stream);
 
-	return BoxDataWrite("mehd", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
 
 //====================================================================================================
@@ -602,13 +871,13 @@ int M4sInitWriter::MehdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stre
 //====================================================================================================
 int M4sInitWriter::TrexBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>();
+	size_t box_position = BoxBegin("trex", 0, 0, data_stream);
 
-	WriteUint32(_track_id, data);   // Track ID
-	WriteUint32(1, data);			// Sample Description Index
-	WriteUint32(1, data);			// Sample Duration
-	WriteUint32(1, data);			// Sample Size
-	WriteUint32(0, data);			// Sample Flags
+	WriteUint32(_track_id, data_stream);   // Track ID
+	WriteUint32(1, data_stream);			// Sample Description Index
+	WriteUint32(1, data_stream);			// Sample Duration
+	WriteUint32(1, data_stream);			// Sample Size
+	WriteUint32(0, data_stream);			// Sample Flags
 
-	return BoxDataWrite("trex", 0, 0, data, data_stream);
+	return BoxEnd(box_position, data_stream);
 }
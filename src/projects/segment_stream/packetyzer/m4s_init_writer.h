@@ -11,6 +11,24 @@
 
 #include "m4s_writer.h"
 
+//====================================================================================================
+// HEVC SPS 정보(hvcC/codecs 생성)
+//====================================================================================================
+struct HevcSpsInfo
+{
+	uint8_t profile_space = 0;
+	uint8_t tier_flag = 0;
+	uint8_t profile_idc = 1;
+	uint32_t profile_compatibility_flags = 0x60000000;
+	uint8_t constraint_indicator_flags[6] = { 0x90, 0, 0, 0, 0, 0 };
+	uint8_t level_idc = 120;
+	uint8_t chroma_format_idc = 1;
+	uint8_t bit_depth_luma_minus8 = 0;
+	uint8_t bit_depth_chroma_minus8 = 0;
+	uint8_t max_sub_layers_minus1 = 0;
+	uint8_t temporal_id_nesting_flag = 1;
+};
+
 //====================================================================================================
 // M4sWriter
 //====================================================================================================
@@ -36,6 +54,16 @@ public:
 public :
 	int CreateData();
 
+	// hvc1(hvcC) is written instead of avc1(avcC) if the parameter sets are set
+	void SetHevcParameterSets(const std::shared_ptr<std::vector<uint8_t>> &vps,
+							  const std::shared_ptr<std::vector<uint8_t>> &sps,
+							  const std::shared_ptr<std::vector<uint8_t>> &pps);
+
+	// sps: NAL unit(including the NAL header), the default values are kept if the parsing is failed
+	static bool ParseHevcSps(const std::vector<uint8_t> &sps, HevcSpsInfo &info);
+	// codecs parameter (ISO/IEC 14496-15 E.3, e.g. hvc1.1.6.L120.90)
+	static std::string MakeHevcCodecString(const HevcSpsInfo &info);
+
 protected :
 	int FtypBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream);
 	int MoovBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream);
@@ -61,8 +89,11 @@ protected :
 	int StblBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream);
 	int StsdBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream);
 
+	void VisualSampleEntryWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream);
 	int Avc1BoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream);
 	int AvccBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream);
+	int Hvc1BoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream);
+	int HvccBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream);
 	int Mp4aBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream);
 	int EsdsBoxWrite(std::shared_ptr<std::vector<uint8_t>> &data_stream);
 
@@ -86,6 +117,10 @@ private :
 	// avc Configuration
 	std::shared_ptr<std::vector<uint8_t>> _avc_sps;
 	std::shared_ptr<std::vector<uint8_t>> _avc_pps;
+	// hevc Configuration
+	std::shared_ptr<std::vector<uint8_t>> _hevc_vps;
+	std::shared_ptr<std::vector<uint8_t>> _hevc_sps;
+	std::shared_ptr<std::vector<uint8_t>> _hevc_pps;
 	 
 	uint16_t    _audio_channels;
 	uint16_t    _audio_sample_size;
@@ -9,9 +9,6 @@
 
 #include "m4s_writer.h"
 
-#define MP4_BOX_HEADER_SIZE  (8)        // size(4) + type(4)
-#define MP4_BOX_EXT_HEADER_SIZE (12)    // size(4) + type(4) + version(1) + flag(3)
-
 //====================================================================================================
 // Constructor
 //====================================================================================================
@@ -25,7 +22,7 @@ M4sWriter::M4sWriter(M4sMediaType media_type, int data_init_size)
 //====================================================================================================
 // Text Write 
 //====================================================================================================
-bool M4sWriter::WriteText(std::string text, std::shared_ptr<std::vector<uint8_t>> &data_stream)
+bool M4sWriter::WriteText(const std::string &text, std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
 	data_stream->insert(data_stream->end(), text.begin(), text.end());
 	return true; 
@@ -131,41 +128,56 @@ bool M4sWriter::WriteUint8(uint8_t value, std::shared_ptr<std::vector<uint8_t>>
 }
 
 //====================================================================================================
-// Box 데이터
-// - return : data write size
-// - 필요시 64bit size 구현
+// uint32_t overwrite
 //====================================================================================================
-int M4sWriter::BoxDataWrite(std::string type, std::shared_ptr<std::vector<uint8_t>> &data, std::shared_ptr<std::vector<uint8_t>> &data_stream)
+void M4sWriter::OverwriteUint32(size_t position, uint32_t value, std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	uint32_t box_size = (data != nullptr) ? MP4_BOX_HEADER_SIZE + data->size() : MP4_BOX_HEADER_SIZE;
+	uint8_t *data = data_stream->data() + position;
 
-	WriteUint32(box_size, data_stream); // box size write
-	WriteText(type, data_stream);	    // type write
+	data[0] = (uint8_t)(value >> 24 & 0xFF);
+	data[1] = (uint8_t)(value >> 16 & 0xFF);
+	data[2] = (uint8_t)(value >> 8 & 0xFF);
+	data[3] = (uint8_t)(value & 0xFF);
+}
 
-	if(data != nullptr)
-	{
-		data_stream->insert(data_stream->end(), data->begin(), data->end());// data write
-	}
+//====================================================================================================
+// Box 시작
+// - return : box position
+// - size는 BoxEnd()에서 기록
+//====================================================================================================
+size_t M4sWriter::BoxBegin(const char *type, std::shared_ptr<std::vector<uint8_t>> &data_stream)
+{
+	size_t box_position = data_stream->size();
+
+	WriteUint32(0, data_stream);                                 // box size(BoxEnd()에서 기록)
+	WriteData((const uint8_t *)type, 4, data_stream);            // type write
 
-	return data_stream->size();
+	return box_position;
 }
 
 //====================================================================================================
-// Box 데이터
+// Box 시작(version/flag)
 //====================================================================================================
-int M4sWriter::BoxDataWrite(std::string type, uint8_t version, uint32_t flags, std::shared_ptr<std::vector<uint8_t>> &data, std::shared_ptr<std::vector<uint8_t>> &data_stream)
+size_t M4sWriter::BoxBegin(const char *type, uint8_t version, uint32_t flags, std::shared_ptr<std::vector<uint8_t>> &data_stream)
 {
-	uint32_t box_size = (data != nullptr) ? MP4_BOX_EXT_HEADER_SIZE + data->size() : MP4_BOX_EXT_HEADER_SIZE;
+	size_t box_position = BoxBegin(type, data_stream);
 
-	WriteUint32(box_size, data_stream);    // box size write
-	WriteText(type, data_stream);          // type write
 	WriteUint8(version, data_stream);	   // version write
 	WriteUint24(flags, data_stream);       // flag write
 
-	if(data != nullptr)
-	{
-		data_stream->insert(data_stream->end(), data->begin(), data->end());// data write
-	}
+	return box_position;
+}
+
+//====================================================================================================
+// Box 종료
+// - return : box size
+// - 필요시 64bit size 구현
+//====================================================================================================
+int M4sWriter::BoxEnd(size_t box_position, std::shared_ptr<std::vector<uint8_t>> &data_stream)
+{
+	auto box_size = (uint32_t)(data_stream->size() - box_position);
+
+	OverwriteUint32(box_position, box_size, data_stream);
 
-	return data_stream->size();
+	return box_size;
 }
@@ -15,6 +15,9 @@
 #include <memory>
 #include <base/common_types.h>
 
+#define MP4_BOX_HEADER_SIZE  (8)        // size(4) + type(4)
+#define MP4_BOX_EXT_HEADER_SIZE (12)    // size(4) + type(4) + version(1) + flag(3)
+
 enum class M4sMediaType
 {
 	VideoMediaType, 
@@ -35,7 +38,7 @@ public :
 	const std::shared_ptr<std::vector<uint8_t>> &GetDataStream(){ return _data_stream; };
 
 protected :
-	bool WriteText(std::string text, std::shared_ptr<std::vector<uint8_t>> &data_stream);
+	bool WriteText(const std::string &text, std::shared_ptr<std::vector<uint8_t>> &data_stream);
 	bool WriteData(const std::vector<uint8_t> &data,  std::shared_ptr<std::vector<uint8_t>> &data_stream);
     bool WriteData(const std::shared_ptr<ov::Data> &data,  std::shared_ptr<std::vector<uint8_t>> &data_stream);
 	bool WriteData(const uint8_t *data,  int data_size, std::shared_ptr<std::vector<uint8_t>> &data_stream);
@@ -46,8 +49,16 @@ protected :
 	bool WriteUint16(uint16_t value, std::shared_ptr<std::vector<uint8_t>> &data_stream);
 	bool WriteUint8(uint8_t value, std::shared_ptr<std::vector<uint8_t>> &data_stream);
 
-	int BoxDataWrite(std::string type, std::shared_ptr<std::vector<uint8_t>> &data, std::shared_ptr<std::vector<uint8_t>> &data_stream);
-	int BoxDataWrite(std::string type, uint8_t version, uint32_t flags, std::shared_ptr<std::vector<uint8_t>> &data, std::shared_ptr<std::vector<uint8_t>> &data_stream);
+	// Changes the value which is already written (e.g. offsets which are known after the following boxes are written)
+	void OverwriteUint32(size_t position, uint32_t value, std::shared_ptr<std::vector<uint8_t>> &data_stream);
+
+	// The children of a box are written to the same stream between BoxBegin() and BoxEnd(),
+	// and the size of the box is backpatched by BoxEnd() (no copy per nesting level)
+	// - BoxBegin() return : position of the box
+	// - BoxEnd() return : box size
+	size_t BoxBegin(const char *type, std::shared_ptr<std::vector<uint8_t>> &data_stream);
+	size_t BoxBegin(const char *type, uint8_t version, uint32_t flags, std::shared_ptr<std::vector<uint8_t>> &data_stream);
+	int BoxEnd(size_t box_position, std::shared_ptr<std::vector<uint8_t>> &data_stream);
 
 protected :
 	M4sMediaType							_media_type;
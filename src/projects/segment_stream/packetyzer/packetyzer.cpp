@@ -10,9 +10,14 @@
 #include "packetyzer.h"
 #include <sstream>
 #include <algorithm>
+#include <iterator>
 #include <sys/time.h>
+#include "segment_uploader.h"
 #include "../segment_stream_private.h"
 
+std::atomic<uint64_t> Packetyzer::_total_memory_limit { 0 };
+std::atomic<uint64_t> Packetyzer::_total_memory_usage { 0 };
+
 //====================================================================================================
 // Constructor
 //====================================================================================================
@@ -42,6 +47,16 @@ Packetyzer::Packetyzer(const ov::String &app_name,
 
     _init_segment_count_complete = false;
 
+    // bitrate : bps
+    _expected_segment_size = (static_cast<size_t>(_media_info.video_bitrate) + _media_info.audio_bitrate) / 8 *
+                            _segment_duration * SEGMENT_BUFFER_MARGIN_PERCENT / 100;
+
+    // ETag must be changed when the stream is recreated
+    _etag_prefix = static_cast<uint64_t>(GetCurrentMilliseconds());
+
+    // half target duration
+    _play_list_max_age = std::max(static_cast<uint32_t>(_segment_duration / 2), 1u);
+
     // init nullptr
     for(uint32_t index = 0; index < _segment_save_count ;  index++)
     {
@@ -58,7 +73,13 @@ Packetyzer::Packetyzer(const ov::String &app_name,
 //====================================================================================================
 Packetyzer::~Packetyzer()
 {
+    // the held requests are responded(404)
+    NotifyMissWaiters(true);
 
+    _total_memory_usage -= _memory_usage;
+
+    if(_dvr_store != nullptr)
+        _dvr_store->Stop();
 }
 
 //====================================================================================================
@@ -105,6 +126,21 @@ std::string Packetyzer::MakeUtcTimeString(time_t value)
     return buf;
 }
 
+//====================================================================================================
+// MakeHttpDateString
+// - RFC7231 IMF-fixdate ex) Sun, 06 Nov 1994 08:49:37 GMT
+//====================================================================================================
+ov::String Packetyzer::MakeHttpDateString(time_t value)
+{
+    std::tm now_tm;
+    char buf[64];
+
+    gmtime_r(&value, &now_tm);
+    strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &now_tm);
+
+    return buf;
+}
+
 //====================================================================================================
 // TimeScale에 따라 시간값(Timestamp) 변경
 //====================================================================================================
@@ -118,34 +154,468 @@ uint64_t Packetyzer::ConvertTimeScale(uint64_t time, uint32_t from_timescale, ui
 }
 
 
+//====================================================================================================
+// PlayList Snapshot
+// - called by the packetyzer thread only
+//====================================================================================================
+std::shared_ptr<const PlayListSnapshot> Packetyzer::MakePlayListSnapshot(ov::String &play_list)
+{
+    _play_list_version++;
+
+    auto snapshot = MakePlayListSnapshot(play_list,
+                                         ov::String::FormatString("\"%llx-%llx\"",
+                                                                  static_cast<unsigned long long>(_etag_prefix),
+                                                                  static_cast<unsigned long long>(_play_list_version)),
+                                         _play_list_max_age);
+
+    snapshot->version = _play_list_version;
+
+    return snapshot;
+}
+
+std::shared_ptr<PlayListSnapshot> Packetyzer::MakePlayListSnapshot(const ov::String &play_list,
+                                                                   const ov::String &etag,
+                                                                   uint32_t max_age)
+{
+    auto snapshot = std::make_shared<PlayListSnapshot>();
+
+    snapshot->data = play_list.ToData(false);
+    snapshot->content_length = ov::Converter::ToString(snapshot->data->GetLength());
+    snapshot->etag = etag;
+    snapshot->create_time = time(nullptr);
+    snapshot->last_modified = MakeHttpDateString(snapshot->create_time);
+
+    if(max_age > 0)
+        snapshot->cache_control.Format("public, max-age=%u", max_age);
+    else
+        snapshot->cache_control = "no-cache";
+
+    return snapshot;
+}
+
 //====================================================================================================
 // PlayList
-// - thread safe
+// - thread safe(called by the packetyzer thread only)
+// - a new snapshot is made and swapped, requests hold the previous one until the response is sent
 //====================================================================================================
 void Packetyzer::SetPlayList(ov::String &play_list)
 {
-    // playlist mutex
-    std::unique_lock<std::mutex> lock(_play_list_guard);
-    _play_list = play_list;
+    std::atomic_store(&_play_list, MakePlayListSnapshot(play_list));
+
+    UploadPlayList(_play_list_file_name, _play_list);
+
+    // the held playlist requests are released with the first complete playlist
+    if(_init_segment_count_complete && !_play_list_ready)
+    {
+        _play_list_ready = true;
+        NotifyMissWaiters();
+    }
 }
 
 //====================================================================================================
 // PlayList
 // - thread safe
+// - no copy(the snapshot is shared)
 //====================================================================================================
-bool Packetyzer::GetPlayList(ov::String &play_list)
+bool Packetyzer::GetPlayList(std::shared_ptr<const PlayListSnapshot> &play_list)
 {
     if(!_init_segment_count_complete)
         return false;
 
-    // playlist mutex
-    std::unique_lock<std::mutex> lock(_play_list_guard);
+    play_list = std::atomic_load(&_play_list);
+
+    return (play_list != nullptr);
+}
+
+//====================================================================================================
+// Wait Segment(request coalescing)
+// - the requests of the same segment are held on one waiter list
+// - checked and registered under _miss_waiter_guard, so the segment stored in the meantime is never missed
+//====================================================================================================
+PacketyzerWaitResult Packetyzer::WaitSegmentData(const ov::String &file_name, const PacketyzerWaitCallback &callback)
+{
+    std::unique_lock<std::mutex> lock(_miss_waiter_guard);
+
+    if(!IsSegmentComing(file_name))
+        return PacketyzerWaitResult::Available;
+
+    auto item = _segment_miss_waiters.find(file_name);
+
+    if(item == _segment_miss_waiters.end())
+    {
+        item = _segment_miss_waiters.emplace(file_name, MissWaiter()).first;
+        item->second.deadline = GetCurrentMilliseconds() + (double)_segment_duration * 1000 * MISS_WAIT_TIMEOUT_SEGMENT_COUNT;
+    }
+
+    item->second.callbacks.push_back(callback);
+
+    return PacketyzerWaitResult::Waiting;
+}
+
+//====================================================================================================
+// Wait PlayList(request coalescing)
+// - the requests before the first complete playlist is made(ready) are held
+//====================================================================================================
+PacketyzerWaitResult Packetyzer::WaitPlayListData(const PacketyzerWaitCallback &callback)
+{
+    std::unique_lock<std::mutex> lock(_miss_waiter_guard);
+
+    if(_play_list_ready)
+        return PacketyzerWaitResult::Available;
+
+    if(_play_list_miss_waiter.callbacks.empty())
+        _play_list_miss_waiter.deadline = GetCurrentMilliseconds() + (double)_segment_duration * 1000 * MISS_WAIT_TIMEOUT_SEGMENT_COUNT;
+
+    _play_list_miss_waiter.callbacks.push_back(callback);
+
+    return PacketyzerWaitResult::Waiting;
+}
+
+//====================================================================================================
+// Notify Miss Waiters
+// - stored(or no longer coming) segment/ready playlist/timeout
+// - callbacks are called without lock
+//====================================================================================================
+void Packetyzer::NotifyMissWaiters(bool expire_all)
+{
+    std::vector<PacketyzerWaitCallback> callbacks;
+
+    {
+        std::unique_lock<std::mutex> lock(_miss_waiter_guard);
+
+        if(_segment_miss_waiters.empty() && _play_list_miss_waiter.callbacks.empty())
+            return;
+
+        double current_time = GetCurrentMilliseconds();
+
+        for(auto item = _segment_miss_waiters.begin(); item != _segment_miss_waiters.end();)
+        {
+            if(expire_all || current_time >= item->second.deadline || !IsSegmentComing(item->first))
+            {
+                logtd("Coalesced segment requests are released - file(%s) count(%zu)",
+                      item->first.CStr(), item->second.callbacks.size());
+
+                std::move(item->second.callbacks.begin(), item->second.callbacks.end(), std::back_inserter(callbacks));
+                item = _segment_miss_waiters.erase(item);
+            }
+            else
+            {
+                item++;
+            }
+        }
+
+        if(!_play_list_miss_waiter.callbacks.empty() &&
+           (expire_all || current_time >= _play_list_miss_waiter.deadline || _play_list_ready))
+        {
+            std::move(_play_list_miss_waiter.callbacks.begin(), _play_list_miss_waiter.callbacks.end(), std::back_inserter(callbacks));
+            _play_list_miss_waiter.callbacks.clear();
+        }
+    }
+
+    for(const auto &callback : callbacks)
+    {
+        callback();
+    }
+}
+
+//====================================================================================================
+// Memory Limit
+// - byte(0 : unlimited)
+//====================================================================================================
+void Packetyzer::SetMemoryLimit(uint64_t limit)
+{
+    _memory_limit = limit;
+}
+
+uint64_t Packetyzer::GetMemoryUsage() const
+{
+    return _memory_usage;
+}
+
+//====================================================================================================
+// Segment Alignment
+//====================================================================================================
+void Packetyzer::SetSegmentAlignment(bool aligned)
+{
+    _segment_alignment = aligned;
+}
+
+void Packetyzer::SetSegmentTolerance(uint32_t tolerance)
+{
+    _segment_tolerance = tolerance;
+}
+
+bool Packetyzer::IsSegmentCutTimestamp(uint64_t start_timestamp, uint64_t timestamp, uint32_t timescale)
+{
+    uint64_t duration = _segment_duration * timescale;
+    uint64_t tolerance = std::min(static_cast<uint64_t>(_segment_tolerance) * timescale / 1000, duration / 2);
+
+    // the segment starts at a key frame
+    uint64_t last_key_frame_timestamp = std::max(_last_key_frame_timestamp, start_timestamp);
+
+    if (timestamp > last_key_frame_timestamp)
+    {
+        _key_frame_interval = timestamp - last_key_frame_timestamp;
+        _last_key_frame_timestamp = timestamp;
+    }
+
+    if (duration == 0 || timestamp < start_timestamp)
+        return false;
+
+    // the boundary does not depend on where the segment started(the first frame of each rendition)
+    // - same for all the renditions(the key frame interval is not used)
+    if (_segment_alignment)
+        return ((timestamp + tolerance) / duration) > ((start_timestamp + tolerance) / duration);
 
-    play_list = _play_list;
+    uint64_t elapsed = timestamp - start_timestamp;
+
+    if (elapsed >= duration)
+        return true;
+
+    if (elapsed + tolerance < duration || _key_frame_interval == 0)
+        return false;
+
+    // the nearest key frame to the segment duration
+    return (elapsed + _key_frame_interval - duration) > (duration - elapsed);
+}
+
+//====================================================================================================
+// Aligned Sequence Number
+//====================================================================================================
+uint32_t Packetyzer::GetFirstSequenceNumber(uint64_t timestamp, uint32_t timescale) const
+{
+    uint64_t duration = _segment_duration * timescale;
+
+    if (!_segment_alignment || duration == 0)
+        return 1;
+
+    return static_cast<uint32_t>(timestamp / duration) + 1;
+}
+
+void Packetyzer::AlignSequenceNumber(uint64_t timestamp, uint32_t timescale)
+{
+    if (_sequence_number_aligned)
+        return;
+
+    _sequence_number_aligned = true;
+    _sequence_number = GetFirstSequenceNumber(timestamp, timescale);
+    _first_sequence_number = _sequence_number;
+}
+
+//====================================================================================================
+// Total Memory Limit
+// - the smallest limit is used when it is set by several publishers
+//====================================================================================================
+void Packetyzer::SetTotalMemoryLimit(uint64_t limit)
+{
+    if(limit == 0)
+        return;
+
+    uint64_t current_limit = _total_memory_limit;
+
+    while((current_limit == 0 || limit < current_limit) &&
+          !_total_memory_limit.compare_exchange_weak(current_limit, limit))
+    {
+    }
+}
+
+uint64_t Packetyzer::GetTotalMemoryUsage()
+{
+    return _total_memory_usage;
+}
+
+bool Packetyzer::IsMemoryLimitExceeded() const
+{
+    uint64_t total_memory_limit = _total_memory_limit;
+
+    return (_memory_limit > 0 && _memory_usage > _memory_limit) ||
+           (total_memory_limit > 0 && _total_memory_usage > total_memory_limit);
+}
+
+//====================================================================================================
+// DVR
+// - must be called before the first segment is stored
+// - duration : TS segment(90kHz)
+//====================================================================================================
+bool Packetyzer::EnableDvr(const ov::String &path, uint64_t window_duration)
+{
+    if(window_duration == 0 || _dvr_store != nullptr)
+        return false;
+
+    // the files of the recreated stream are not overwritten
+    auto name = ov::String::FormatString("%s_%s_%llx",
+                                         _app_name.CStr(),
+                                         _segment_prefix.CStr(),
+                                         static_cast<unsigned long long>(_etag_prefix));
+
+    auto dvr_store = std::make_shared<SegmentDvrStore>(path, name, window_duration, PACKTYZER_DEFAULT_TIMESCALE);
+
+    if(!dvr_store->Start())
+        return false;
+
+    _dvr_store = dvr_store;
 
     return true;
 }
 
+bool Packetyzer::GetDvrSegmentData(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data)
+{
+    if(_dvr_store == nullptr)
+        return false;
+
+    return _dvr_store->GetSegmentData(file_name, segment_data);
+}
+
+//====================================================================================================
+// Uploader
+// - thread safe
+//====================================================================================================
+void Packetyzer::SetUploader(const std::shared_ptr<SegmentUploader> &uploader)
+{
+    std::shared_ptr<SegmentUploader> expected = nullptr;
+
+    std::atomic_compare_exchange_strong(&_uploader, &expected, uploader);
+}
+
+void Packetyzer::UploadSegmentData(const std::shared_ptr<SegmentData> &segment_data)
+{
+    auto uploader = std::atomic_load(&_uploader);
+
+    if(uploader != nullptr)
+        uploader->UploadSegment(_app_name, _stream_name, segment_data);
+}
+
+void Packetyzer::UploadPlayList(const ov::String &file_name, const std::shared_ptr<const PlayListSnapshot> &play_list)
+{
+    auto uploader = std::atomic_load(&_uploader);
+
+    if(uploader == nullptr || play_list == nullptr || file_name.IsEmpty())
+        return;
+
+    uploader->UploadPlayList(_app_name, _stream_name, file_name, play_list->data, play_list->cache_control);
+}
+
+void Packetyzer::AddMemoryUsage(int64_t size)
+{
+    _memory_usage += size;
+    _total_memory_usage += size;
+}
+
+//====================================================================================================
+// Store Segment
+// - ring(_segment_save_count) : the segments are overwritten in order
+// - the buffer of the overwritten segment is reused(no allocation/free per segment)
+//====================================================================================================
+void Packetyzer::StoreSegmentData(std::vector<std::shared_ptr<SegmentData>> &segment_datas,
+                                  uint32_t &current_index,
+                                  ov::String &file_name,
+                                  uint64_t duration,
+                                  uint64_t timestamp,
+                                  const std::shared_ptr<std::vector<uint8_t>> &data)
+{
+    ov::MemoryTagScope memory_tag(ov::MemoryTag::Segment);
+
+    auto &slot = segment_datas[current_index];
+    std::shared_ptr<ov::Data> buffer = nullptr;
+
+    if(slot != nullptr)
+    {
+        // the request(being sent) is still using the segment
+        if(slot->data.use_count() == 1)
+            buffer = slot->data;
+        else
+            AddMemoryUsage(-static_cast<int64_t>(slot->data->GetCapacity()));
+    }
+
+    if(buffer == nullptr)
+    {
+        buffer = std::make_shared<ov::Data>(std::max(data->size(), _expected_segment_size));
+    }
+
+    size_t old_capacity = buffer->GetCapacity();
+
+    buffer->SetLength(0);
+    buffer->Append(data->data(), data->size());
+
+    if(slot == nullptr || slot->data != buffer)
+        AddMemoryUsage(static_cast<int64_t>(buffer->GetCapacity()));
+    else
+        AddMemoryUsage(static_cast<int64_t>(buffer->GetCapacity()) - static_cast<int64_t>(old_capacity));
+
+    slot = std::make_shared<SegmentData>(_sequence_number++, file_name, duration, timestamp, buffer);
+    SetSegmentCacheInfo(slot);
+
+    // written by the DVR writer thread(the buffer is not recycled until it is written)
+    if(_dvr_store != nullptr)
+        _dvr_store->AppendSegment(slot);
+
+    // the buffer is not recycled until it is uploaded either
+    UploadSegmentData(slot);
+
+    // under the memory pressure, all the saved segments outside the playlist are evicted
+    bool shrink = ov::MemoryGovernor::Instance()->IsLevel(ov::MemoryGovernorLevel::Shrink);
+
+    if(shrink || IsMemoryLimitExceeded())
+        EvictSegmentData(segment_datas, current_index, shrink);
+
+    current_index++;
+
+    if(_segment_save_count <= current_index)
+        current_index = 0;
+}
+
+//====================================================================================================
+// Segment Cache Info
+// - strong ETag : the file name has the sequence number(or timestamp), the prefix changes when the stream is recreated
+// - immutable : cached while the segment is kept in the ring
+//====================================================================================================
+void Packetyzer::SetSegmentCacheInfo(const std::shared_ptr<SegmentData> &segment_data)
+{
+    segment_data->etag.Format("\"%llx-%s\"",
+                              static_cast<unsigned long long>(_etag_prefix),
+                              segment_data->file_name.CStr());
+    segment_data->last_modified = MakeHttpDateString(segment_data->create_time);
+    segment_data->cache_control = MakeSegmentCacheControl();
+}
+
+//====================================================================================================
+// Segment Cache-Control
+//====================================================================================================
+ov::String Packetyzer::MakeSegmentCacheControl() const
+{
+    return ov::String::FormatString("public, max-age=%llu, immutable",
+                                    static_cast<unsigned long long>(_segment_duration * _segment_save_count));
+}
+
+//====================================================================================================
+// Evict Segment
+// - the oldest saved segments first(the segments of the playlist are not evicted)
+// - evict_all : all the saved segments(memory governor)
+//====================================================================================================
+void Packetyzer::EvictSegmentData(std::vector<std::shared_ptr<SegmentData>> &segment_datas, uint32_t current_index, bool evict_all)
+{
+    for(uint32_t offset = 1; offset <= _segment_save_count - _segment_count && (evict_all || IsMemoryLimitExceeded()); offset++)
+    {
+        auto &slot = segment_datas[(current_index + offset) % _segment_save_count];
+
+        if(slot == nullptr)
+            continue;
+
+        AddMemoryUsage(-static_cast<int64_t>(slot->data->GetCapacity()));
+        slot = nullptr;
+    }
+
+    if(IsMemoryLimitExceeded())
+    {
+        logtw("Segment memory limit exceeded - prefix(%s) usage(%llu) limit(%llu) total usage(%llu) total limit(%llu)",
+              _segment_prefix.CStr(),
+              static_cast<unsigned long long>(_memory_usage),
+              static_cast<unsigned long long>(_memory_limit),
+              static_cast<unsigned long long>(_total_memory_usage),
+              static_cast<unsigned long long>(_total_memory_limit));
+    }
+}
+
 //====================================================================================================
 // Last (segment count) Video(or Video+Audio) Segments
 // - thread safe
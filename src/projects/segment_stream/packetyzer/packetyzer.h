@@ -11,12 +11,40 @@
 #include <map>
 #include "../base/ovlibrary/ovlibrary.h"
 #include "packetyzer_define.h"
+#include "segment_dvr_store.h"
+
+class SegmentUploader;
 
 #define MPD_AUDIO_SUFFIX            "_audio.m4s"
 #define MPD_VIDEO_SUFFIX            "_video.m4s"
 #define MPD_VIDEO_INIT_FILE_NAME    "init_video.m4s"
 #define MPD_AUDIO_INIT_FILE_NAME    "init_audio.m4s"
 
+// Reserved segment buffer size = expected size(bitrate * duration) * 125%
+#define SEGMENT_BUFFER_MARGIN_PERCENT   (125)
+
+// Segments are immutable, so they can be cached while they are kept(segment duration * save count)
+// Playlists are cached for half of the segment duration(0 : low latency, revalidated every time)
+
+// The coalesced requests of a missing segment/playlist are responded(404) after (segment duration * count)
+#define MISS_WAIT_TIMEOUT_SEGMENT_COUNT (2)
+
+//====================================================================================================
+// PlayListSnapshot
+// - immutable(shared by all requests until the playlist is updated)
+// - body/Content-Length/ETag/Last-Modified/Cache-Control are made once per update
+//====================================================================================================
+struct PlayListSnapshot
+{
+    uint64_t version = 0;
+    std::shared_ptr<const ov::Data> data;
+    ov::String content_length;
+    ov::String etag;
+    time_t create_time = 0;
+    ov::String last_modified;
+    ov::String cache_control;
+};
+
 //====================================================================================================
 // Packetyzer
 //====================================================================================================
@@ -39,7 +67,7 @@ public :
 
     virtual bool AppendAudioFrame(std::shared_ptr<PacketyzerFrameData> &frame_data) = 0;
 
-    virtual bool GetSegmentData(const ov::String &file_name, std::shared_ptr<ov::Data> &data) = 0;
+    virtual bool GetSegmentData(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data) = 0;
 
     virtual bool SetSegmentData(ov::String file_name,
                                 uint64_t duration,
@@ -50,17 +78,118 @@ public :
 
     void SetPlayList(ov::String &play_list);
 
-    bool GetPlayList(ov::String &play_list);
+    bool GetPlayList(std::shared_ptr<const PlayListSnapshot> &play_list);
 
     bool GetVideoPlaySegments(std::vector<std::shared_ptr<SegmentData>> &segment_datas);
 
     bool GetAudioPlaySegments(std::vector<std::shared_ptr<SegmentData>> &segment_datas);
 
+    // Segment memory budget(byte, 0 : unlimited)
+    // - the saved segments outside the playlist are evicted(oldest first) when the budget is exceeded
+    void SetMemoryLimit(uint64_t limit);
+    uint64_t GetMemoryUsage() const;
+
+    // shared by all the streams(HLS/DASH)
+    static void SetTotalMemoryLimit(uint64_t limit);
+    static uint64_t GetTotalMemoryUsage();
+
+    // DVR(second, 0 : disabled)
+    // - all the segments are also written to the DVR files, the segments out of memory are served from the files
+    bool EnableDvr(const ov::String &path, uint64_t window_duration);
+    bool IsDvrEnabled() const { return _dvr_store != nullptr; }
+
+    // Segment alignment(the key frames of the renditions are synchronized)
+    // - the segments are cut at the first key frame of every segment duration slot of the timestamp,
+    //   so all the renditions have the same segment boundaries
+    void SetSegmentAlignment(bool aligned);
+    bool IsSegmentAligned() const { return _segment_alignment; }
+
+    // Segment tolerance(millisecond, 0 : the first key frame after the segment duration)
+    // - the segment can be cut at a key frame up to the tolerance before the segment duration,
+    //   if the next key frame(estimated by the last key frame interval) is farther from the duration
+    // - segment alignment : the slot boundaries are moved ahead by the tolerance
+    void SetSegmentTolerance(uint32_t tolerance);
+
+    // Push of the segments and the playlists to the ingest endpoints(shared by the streams of the application)
+    // - the first uploader is kept(the packetyzer shared by HLS(CMAF)/DASH)
+    void SetUploader(const std::shared_ptr<SegmentUploader> &uploader);
+
+    // second(0 : no-cache)
+    uint32_t GetPlayListMaxAge() const { return _play_list_max_age; }
+
+    // Request coalescing(single flight)
+    // - the requests of the segment being made(or the playlist not ready yet) are held on one waiter list
+    //   and released together when it is stored(or timeout)
+    // - Available : respond now(found or never coming)
+    PacketyzerWaitResult WaitSegmentData(const ov::String &file_name, const PacketyzerWaitCallback &callback);
+    PacketyzerWaitResult WaitPlayListData(const PacketyzerWaitCallback &callback);
+
     static uint32_t Gcd(uint32_t n1, uint32_t n2);
     static std::string MakeUtcTimeString(time_t value);
+    static ov::String MakeHttpDateString(time_t value);
     static double GetCurrentMilliseconds();
 
+    // playlist which is not made by a packetyzer(ex: master playlist of the renditions)
+    static std::shared_ptr<PlayListSnapshot> MakePlayListSnapshot(const ov::String &play_list,
+                                                                  const ov::String &etag,
+                                                                  uint32_t max_age);
+
 protected :
+    // body/Content-Length/ETag/Last-Modified/Cache-Control of a new playlist version
+    std::shared_ptr<const PlayListSnapshot> MakePlayListSnapshot(ov::String &play_list);
+
+    // store the segment at the current index of the ring(the segment guard must be locked)
+    // - the buffer of the overwritten segment is recycled if no request is using it
+    void StoreSegmentData(std::vector<std::shared_ptr<SegmentData>> &segment_datas,
+                          uint32_t &current_index,
+                          ov::String &file_name,
+                          uint64_t duration,
+                          uint64_t timestamp,
+                          const std::shared_ptr<std::vector<uint8_t>> &data);
+
+    // queued to the uploader(if any)
+    void UploadSegmentData(const std::shared_ptr<SegmentData> &segment_data);
+
+    // queued to the uploader(if any) after the segments stored before it
+    void UploadPlayList(const ov::String &file_name, const std::shared_ptr<const PlayListSnapshot> &play_list);
+
+    // ETag/Last-Modified/Cache-Control of the segment
+    void SetSegmentCacheInfo(const std::shared_ptr<SegmentData> &segment_data);
+
+    // Cache-Control of the segments(immutable while they are kept)
+    ov::String MakeSegmentCacheControl() const;
+
+    void EvictSegmentData(std::vector<std::shared_ptr<SegmentData>> &segment_datas, uint32_t current_index, bool evict_all = false);
+
+    bool IsMemoryLimitExceeded() const;
+
+    // whether the segment started at start_timestamp is cut at the key frame of timestamp
+    // - called at every key frame(the key frame interval is measured)
+    bool IsSegmentCutTimestamp(uint64_t start_timestamp, uint64_t timestamp, uint32_t timescale);
+
+    // sequence number of the first segment started at timestamp
+    // - segment alignment : segment duration slot of the timestamp + 1, so the renditions which are started
+    //   at different times have the same numbers for the same segments
+    // - 1 otherwise
+    uint32_t GetFirstSequenceNumber(uint64_t timestamp, uint32_t timescale) const;
+
+    // _sequence_number of the first segment(called when the first segment is started, ignored after that)
+    void AlignSequenceNumber(uint64_t timestamp, uint32_t timescale);
+
+    // the segment written to the DVR file(thread safe)
+    bool GetDvrSegmentData(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data);
+
+    // true : the segment is not stored yet but will be soon(thread safe, the segment guard is locked inside)
+    virtual bool IsSegmentComing(const ov::String &file_name)
+    {
+        return false;
+    }
+
+    // called after the segment(or playlist) is stored(the segment guard must not be locked)
+    void NotifyMissWaiters(bool expire_all = false);
+
+    void AddMemoryUsage(int64_t size);
+
     ov::String _app_name;
     ov::String _stream_name;
     PacketyzerType _packetyzer_type;
@@ -73,8 +202,14 @@ protected :
     PacketyzerMediaInfo _media_info;
 
     uint32_t _sequence_number;
+    uint32_t _first_sequence_number = 1;
+    bool _sequence_number_aligned = false;
     bool _init_segment_count_complete;
-    ov::String _play_list;
+    std::shared_ptr<const PlayListSnapshot> _play_list; // std::atomic_load/atomic_store only
+    ov::String _play_list_file_name; // uploaded name of _play_list
+    uint64_t _play_list_version = 0;
+    uint64_t _etag_prefix = 0;
+    uint32_t _play_list_max_age = 0; // second(0 : no-cache)
 
     bool _video_init;
     bool _audio_init;
@@ -85,7 +220,35 @@ protected :
     std::vector<std::shared_ptr<SegmentData>> _video_segment_datas; // m4s : video , ts : video+audio
     std::vector<std::shared_ptr<SegmentData>> _audio_segment_datas; // m4s : audio
 
+    uint64_t _memory_limit = 0;
+    std::atomic<uint64_t> _memory_usage { 0 };
+    size_t _expected_segment_size = 0;
+
+    std::shared_ptr<SegmentDvrStore> _dvr_store = nullptr;
+    std::shared_ptr<SegmentUploader> _uploader = nullptr; // std::atomic_load/atomic_store only
+
+    bool _segment_alignment = false;
+    uint32_t _segment_tolerance = 0; // millisecond
+    uint64_t _last_key_frame_timestamp = 0;
+    uint64_t _key_frame_interval = 0; // timescale of the key frames
+
+    static std::atomic<uint64_t> _total_memory_limit;
+    static std::atomic<uint64_t> _total_memory_usage;
+
     std::mutex _video_segment_guard;
     std::mutex _audio_segment_guard;
-    std::mutex _play_list_guard;
+
+    // Request coalescing
+    struct MissWaiter
+    {
+        double deadline;        // milliseconds
+        std::vector<PacketyzerWaitCallback> callbacks;
+    };
+
+    // _miss_waiter_guard : _segment_miss_waiters, _play_list_miss_waiter
+    // (lock order : _miss_waiter_guard -> segment guard)
+    std::map<ov::String, MissWaiter> _segment_miss_waiters;
+    MissWaiter _play_list_miss_waiter;
+    std::atomic<bool> _play_list_ready { false };
+    std::mutex _miss_waiter_guard;
 };
@@ -14,11 +14,17 @@
 #include <deque>
 #include <mutex>
 #include <string.h>
+#include <functional>
 #include "../base/ovlibrary/ovlibrary.h"
 #include "bit_writer.h"
+#include <base/media_route/media_bitstream.h>
 
 #define PACKTYZER_DEFAULT_TIMESCALE                (90000)//90MHz
 #define AVC_NAL_START_PATTERN_SIZE    (4) //0x00000001
+// HEVC NAL unit type(ITU-T H.265 Table 7-1)
+#define HEVC_NAL_TYPE_VPS           (32)
+#define HEVC_NAL_TYPE_SPS           (33)
+#define HEVC_NAL_TYPE_PPS           (34)
 #define ADTS_HEADER_SIZE            (7)
 
 #pragma pack(1)
@@ -42,8 +48,18 @@ enum class PlayListType : int32_t {
 enum class SegmentType : int32_t {
     MpegTs,
     M4S,
+    Thumbnail,  // JPEG of the latest key frame
 };
 
+// Result of a blocking request of low latency streaming
+enum class PacketyzerWaitResult : int32_t {
+    Available,  // No need to wait
+    Waiting,    // The callback will be called when the data is available (or timed out)
+    Invalid,    // The request can never be satisfied (e.g. too far in the future)
+};
+
+using PacketyzerWaitCallback = std::function<void()>;
+
 enum class SegmentDataType : int32_t {
     Ts,        // Video + Audio
     Mp4Video,
@@ -93,6 +109,22 @@ public :
     uint64_t duration;
     uint64_t timestamp;
     std::shared_ptr<ov::Data> data;
+
+    // Scatter-gather : sent after data in order, without copying(e.g. samples of the mapped VOD file)
+    std::vector<std::shared_ptr<const ov::Data>> gather_datas;
+
+    // HTTP cache validators(made once per segment)
+    ov::String etag;
+    ov::String last_modified;
+    ov::String cache_control;
+
+    // Byte range window(HLS EXT-X-BYTERANGE)
+    // - segment : window_offset is the offset of the segment in the window file
+    // - window file(made for the request) : window_offset is the offset of data(the previous segments are evicted),
+    //   is_growing : the next segments are appended to the file
+    ov::String window_file_name;
+    uint64_t window_offset = 0;
+    bool is_growing = false;
 };
 
 //====================================================================================================
@@ -139,6 +171,9 @@ public:
     uint64_t time_offset;
     uint32_t timescale;
     std::shared_ptr<ov::Data> data;
+
+    // Shared NAL index/AVCC form of the video frame (nullptr if it is not provided)
+    std::shared_ptr<VideoBitstream> bitstream;
 };
 
 
@@ -150,6 +185,7 @@ enum class SegmentCodecType
     UnknownCodec,
     Vp8Codec,
     H264Codec,
+    H265Codec,
     OpusCodec,
     AacCodec,
 };
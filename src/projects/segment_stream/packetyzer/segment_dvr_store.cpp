@@ -0,0 +1,302 @@
+﻿//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Created by Jaejong Bong
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#include "segment_dvr_store.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include "../segment_stream_private.h"
+
+//====================================================================================================
+// DvrFile Destructor
+// - the last segment of the file is released
+//====================================================================================================
+DvrFile::~DvrFile()
+{
+    if(fd >= 0)
+    {
+        ::close(fd);
+        ::unlink(path.CStr());
+    }
+}
+
+//====================================================================================================
+// Constructor
+// - path : DVR directory, name : file name prefix(unique per stream)
+//====================================================================================================
+SegmentDvrStore::SegmentDvrStore(const ov::String &path,
+                                 const ov::String &name,
+                                 uint64_t window_duration,
+                                 uint32_t timescale)
+{
+    _path = path;
+    _name = name;
+    _window_duration = window_duration;
+    _timescale = timescale;
+    _stop_thread_flag = true;
+}
+
+//====================================================================================================
+// Destructor
+//====================================================================================================
+SegmentDvrStore::~SegmentDvrStore()
+{
+    Stop();
+}
+
+//====================================================================================================
+// Start
+//====================================================================================================
+bool SegmentDvrStore::Start()
+{
+    if(!_stop_thread_flag)
+        return true;
+
+    if(!ov::PathManager::MakeDirectory(_path.CStr()))
+    {
+        logte("Cannot create the dvr directory - path(%s) error(%s)", _path.CStr(), strerror(errno));
+        return false;
+    }
+
+    _stop_thread_flag = false;
+    _writer_thread = std::thread(&SegmentDvrStore::WriterThread, this);
+
+    logti("Dvr started - path(%s/%s) window(%llus)",
+          _path.CStr(), _name.CStr(), static_cast<unsigned long long>(_window_duration));
+
+    return true;
+}
+
+//====================================================================================================
+// Stop
+// - the files are deleted when the mapped segments(being sent) are released
+//====================================================================================================
+void SegmentDvrStore::Stop()
+{
+    if(_stop_thread_flag)
+        return;
+
+    _stop_thread_flag = true;
+    _queue_event.Notify();
+    _writer_thread.join();
+
+    {
+        std::unique_lock<std::mutex> lock(_write_queue_guard);
+        _write_queue = std::queue<std::shared_ptr<SegmentData>>();
+    }
+
+    std::unique_lock<std::mutex> lock(_index_guard);
+    _indexes.clear();
+    _index_duration = 0;
+    _current_file = nullptr;
+}
+
+//====================================================================================================
+// Append Segment
+// - called by the packetyzer thread(no disk I/O)
+//====================================================================================================
+void SegmentDvrStore::AppendSegment(const std::shared_ptr<SegmentData> &segment_data)
+{
+    if(_stop_thread_flag || segment_data == nullptr || segment_data->data == nullptr)
+        return;
+
+    std::unique_lock<std::mutex> lock(_write_queue_guard);
+    _write_queue.push(segment_data);
+
+    _queue_event.Notify();
+}
+
+//====================================================================================================
+// Writer Thread
+//====================================================================================================
+void SegmentDvrStore::WriterThread()
+{
+    while(!_stop_thread_flag)
+    {
+        _queue_event.Wait();
+
+        while(!_stop_thread_flag)
+        {
+            std::shared_ptr<SegmentData> segment_data = nullptr;
+
+            {
+                std::unique_lock<std::mutex> lock(_write_queue_guard);
+
+                if(_write_queue.empty())
+                    break;
+
+                segment_data = _write_queue.front();
+                _write_queue.pop();
+            }
+
+            WriteSegment(segment_data);
+        }
+    }
+}
+
+//====================================================================================================
+// Open File
+// - [Name]_[File Id].dvr
+//====================================================================================================
+std::shared_ptr<DvrFile> SegmentDvrStore::OpenFile()
+{
+    ov::String file_path = ov::PathManager::Combine(_path,
+            ov::String::FormatString("%s_%u.%s", _name.CStr(), _file_id, DVR_FILE_EXTENSION));
+
+    int fd = ::open(file_path.CStr(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if(fd < 0)
+    {
+        logte("Cannot open the dvr file - path(%s) error(%s)", file_path.CStr(), strerror(errno));
+        return nullptr;
+    }
+
+    return std::make_shared<DvrFile>(_file_id++, file_path, fd);
+}
+
+//====================================================================================================
+// Write Segment
+// - append to the current file, then the index is updated(readable after it is written)
+// - the oldest segments are removed from the index when the window is exceeded
+//====================================================================================================
+bool SegmentDvrStore::WriteSegment(const std::shared_ptr<SegmentData> &segment_data)
+{
+    if(_current_file == nullptr || _current_file->segment_count >= DVR_FILE_SEGMENT_COUNT)
+    {
+        _current_file = OpenFile();
+
+        if(_current_file == nullptr)
+            return false;
+    }
+
+    auto data = segment_data->data->GetDataAs<uint8_t>();
+    size_t length = segment_data->data->GetLength();
+    size_t written = 0;
+
+    while(written < length)
+    {
+        ssize_t result = ::pwrite(_current_file->fd, data + written, length - written, _current_file->size + written);
+
+        if(result < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            logte("Dvr write fail - path(%s) error(%s)", _current_file->path.CStr(), strerror(errno));
+
+            // the next segment is written to a new file
+            _current_file = nullptr;
+            return false;
+        }
+
+        written += result;
+    }
+
+    auto index = std::make_shared<DvrSegmentIndex>();
+
+    index->sequence_number = segment_data->sequence_number;
+    index->file_name = segment_data->file_name;
+    index->create_time = segment_data->create_time;
+    index->duration = segment_data->duration;
+    index->timestamp = segment_data->timestamp;
+    index->etag = segment_data->etag;
+    index->last_modified = segment_data->last_modified;
+    index->cache_control = segment_data->cache_control;
+    index->file = _current_file;
+    index->offset = _current_file->size;
+    index->length = length;
+
+    _current_file->size += length;
+    _current_file->segment_count++;
+
+    std::unique_lock<std::mutex> lock(_index_guard);
+
+    _indexes.push_back(index);
+    _index_duration += index->duration;
+
+    // window(the file is deleted with its last segment)
+    while(_indexes.size() > 1 && _index_duration - _indexes.front()->duration >= _window_duration * _timescale)
+    {
+        _index_duration -= _indexes.front()->duration;
+        _indexes.pop_front();
+    }
+
+    return true;
+}
+
+//====================================================================================================
+// Get Segment
+// - mapped(no copy), the mapping is released with the last reference of the data
+//====================================================================================================
+bool SegmentDvrStore::GetSegmentData(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data)
+{
+    std::shared_ptr<const DvrSegmentIndex> index = nullptr;
+
+    {
+        std::unique_lock<std::mutex> lock(_index_guard);
+
+        auto item = std::find_if(_indexes.rbegin(), _indexes.rend(),
+                                 [&file_name](const std::shared_ptr<const DvrSegmentIndex> &value) -> bool
+        {
+            return value->file_name == file_name;
+        });
+
+        if(item == _indexes.rend())
+            return false;
+
+        index = *item;
+    }
+
+    // the file is not deleted during the mapping(index->file is referenced)
+    static const off_t page_size = ::sysconf(_SC_PAGESIZE);
+    off_t map_offset = index->offset - (index->offset % page_size);
+    size_t map_delta = static_cast<size_t>(index->offset - map_offset);
+    size_t map_length = index->length + map_delta;
+
+    void *address = ::mmap(nullptr, map_length, PROT_READ, MAP_SHARED, index->file->fd, map_offset);
+
+    if(address == MAP_FAILED)
+    {
+        logte("Dvr mmap fail - path(%s) file(%s) error(%s)", index->file->path.CStr(), file_name.CStr(), strerror(errno));
+        return false;
+    }
+
+    std::shared_ptr<ov::Data> data(new ov::Data(static_cast<uint8_t *>(address) + map_delta, index->length, true),
+                                   [address, map_length](ov::Data *value)
+    {
+        delete value;
+        ::munmap(address, map_length);
+    });
+
+    ov::String segment_file_name = index->file_name;
+
+    segment_data = std::make_shared<SegmentData>(index->sequence_number,
+                                                 segment_file_name,
+                                                 index->duration,
+                                                 index->timestamp,
+                                                 data);
+    segment_data->create_time = index->create_time;
+    segment_data->etag = index->etag;
+    segment_data->last_modified = index->last_modified;
+    segment_data->cache_control = index->cache_control;
+
+    return true;
+}
+
+//====================================================================================================
+// Segment Indexes
+// - oldest first
+//====================================================================================================
+void SegmentDvrStore::GetSegmentIndexes(std::vector<std::shared_ptr<const DvrSegmentIndex>> &indexes)
+{
+    std::unique_lock<std::mutex> lock(_index_guard);
+
+    indexes.assign(_indexes.begin(), _indexes.end());
+}
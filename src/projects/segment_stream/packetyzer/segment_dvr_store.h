@@ -0,0 +1,124 @@
+﻿//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Created by Jaejong Bong
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#pragma once
+
+#include <deque>
+#include <queue>
+#include <thread>
+#include "../base/ovlibrary/ovlibrary.h"
+#include "../base/ovlibrary/semaphore.h"
+#include "packetyzer_define.h"
+
+// segments per DVR file(the file is deleted when all of its segments are out of the window)
+#define DVR_FILE_SEGMENT_COUNT      (100)
+#define DVR_FILE_EXTENSION          "dvr"
+
+//====================================================================================================
+// DvrFile
+// - append only, deleted(unlink) when the last segment is released(mapped segments are still readable)
+//====================================================================================================
+struct DvrFile
+{
+    DvrFile(uint32_t id_, const ov::String &path_, int fd_)
+    {
+        id = id_;
+        path = path_;
+        fd = fd_;
+    }
+
+    ~DvrFile();
+
+    uint32_t id;
+    ov::String path;
+    int fd;
+    size_t size = 0;
+    uint32_t segment_count = 0;
+};
+
+//====================================================================================================
+// DvrSegmentIndex
+// - segment written to the DVR file(the data is mapped when it is requested)
+//====================================================================================================
+struct DvrSegmentIndex
+{
+    int sequence_number = 0;
+    ov::String file_name;
+    time_t create_time = 0;
+    uint64_t duration = 0;
+    uint64_t timestamp = 0;
+
+    ov::String etag;
+    ov::String last_modified;
+    ov::String cache_control;
+
+    std::shared_ptr<DvrFile> file;
+    off_t offset = 0;
+    size_t length = 0;
+};
+
+//====================================================================================================
+// SegmentDvrStore
+// - tiered segment store : the recent segments are kept in memory(Packetyzer), all the segments are
+//   written to the DVR files by the writer thread
+// - the segments out of the window(duration) are removed from the index
+// - GetSegmentData : mmap(no copy, no memory budget)
+//====================================================================================================
+class SegmentDvrStore
+{
+public:
+    SegmentDvrStore(const ov::String &path,
+                    const ov::String &name,
+                    uint64_t window_duration,
+                    uint32_t timescale);
+
+    ~SegmentDvrStore();
+
+public :
+    bool Start();
+    void Stop();
+
+    // written asynchronously(the segment is referenced until it is written)
+    void AppendSegment(const std::shared_ptr<SegmentData> &segment_data);
+
+    // thread safe
+    bool GetSegmentData(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data);
+
+    // thread safe(oldest first)
+    void GetSegmentIndexes(std::vector<std::shared_ptr<const DvrSegmentIndex>> &indexes);
+
+    uint64_t GetWindowDuration() const { return _window_duration; }
+
+private:
+    void WriterThread();
+    bool WriteSegment(const std::shared_ptr<SegmentData> &segment_data);
+    std::shared_ptr<DvrFile> OpenFile();
+
+private :
+    ov::String _path;
+    ov::String _name;
+    uint64_t _window_duration; // second
+    uint32_t _timescale;
+
+    // writer thread only
+    std::shared_ptr<DvrFile> _current_file = nullptr;
+    uint32_t _file_id = 0;
+
+    std::queue<std::shared_ptr<SegmentData>> _write_queue;
+    std::mutex _write_queue_guard;
+    ov::Semaphore _queue_event;
+
+    bool _stop_thread_flag;
+    std::thread _writer_thread;
+
+    // _index_guard : _indexes, _index_duration
+    std::deque<std::shared_ptr<const DvrSegmentIndex>> _indexes;
+    uint64_t _index_duration = 0; // timescale
+    std::mutex _index_guard;
+};
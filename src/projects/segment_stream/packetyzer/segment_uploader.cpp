@@ -0,0 +1,629 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#include "segment_uploader.h"
+#include "packetyzer.h"
+#include "../segment_stream_private.h"
+#include "config/items/items.h"
+
+#include <chrono>
+
+static double GetUploadMilliseconds()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//====================================================================================================
+// Parse
+// - http only(the TLS client is not supported)
+//====================================================================================================
+bool SegmentUploadTarget::Parse(const ov::String &url, SegmentUploadTarget &target)
+{
+    if (!url.HasPrefix("http://"))
+        return false;
+
+    auto address = url.Substring(7);
+    auto path_index = address.IndexOf('/');
+    auto host_port = (path_index >= 0) ? address.Substring(0, static_cast<size_t>(path_index)) : address;
+
+    target.url = url;
+    target.path = (path_index >= 0) ? address.Substring(path_index) : "";
+    target.port = 80;
+
+    // no trailing slash : <path>/<app>/<stream>/<file>
+    while (target.path.HasSuffix("/"))
+        target.path = target.path.Substring(0, target.path.GetLength() - 1);
+
+    auto port_index = host_port.IndexOfRev(':');
+
+    if (port_index > 0)
+    {
+        target.port = ov::Converter::ToUInt16(host_port.Substring(port_index + 1));
+        host_port = host_port.Substring(0, static_cast<size_t>(port_index));
+    }
+
+    target.host = host_port;
+
+    return !target.host.IsEmpty() && target.port != 0;
+}
+
+//====================================================================================================
+// SegmentUploadConnection
+//====================================================================================================
+SegmentUploadConnection::SegmentUploadConnection(const SegmentUploadTarget &target) : _target(target)
+{
+    _recv_data = std::make_shared<ov::Data>(SEGMENT_UPLOAD_RECV_BUFFER_SIZE);
+}
+
+SegmentUploadConnection::~SegmentUploadConnection()
+{
+    Close();
+}
+
+bool SegmentUploadConnection::Connect()
+{
+    _socket = std::make_shared<ov::ClientSocket>();
+
+    if (!_socket->Create(ov::SocketType::Tcp))
+    {
+        logte("Could not create a socket for %s", _target.url.CStr());
+        _socket = nullptr;
+        return false;
+    }
+
+    // The lookup isn't blocked by a slow DNS server longer than the timeout (the reconnection uses the cache)
+    auto addresses = ov::DnsResolver::Instance()->Resolve(_target.host, _target.port, SEGMENT_UPLOAD_TIMEOUT);
+
+    if (addresses.empty())
+    {
+        logtw("Could not resolve %s", _target.host.CStr());
+        Close();
+        return false;
+    }
+
+    auto error = _socket->Connect(addresses, SEGMENT_UPLOAD_TIMEOUT);
+
+    if (error != nullptr)
+    {
+        logtw("Could not connect to %s:%u: %s", _target.host.CStr(), _target.port, error->ToString().CStr());
+        Close();
+        return false;
+    }
+
+    timeval timeout {};
+    timeout.tv_sec = SEGMENT_UPLOAD_TIMEOUT / 1000;
+    timeout.tv_usec = (SEGMENT_UPLOAD_TIMEOUT % 1000) * 1000;
+
+    // The connected socket is a new one (see ov::Socket::Connect())
+    _socket->SetSockOpt(SO_SNDTIMEO, timeout);
+    _socket->SetSockOpt(SO_RCVTIMEO, timeout);
+
+    return true;
+}
+
+void SegmentUploadConnection::Close()
+{
+    if (_socket != nullptr)
+    {
+        _socket->Close();
+        _socket = nullptr;
+    }
+}
+
+//====================================================================================================
+// Request
+// - the connection is made if it is not connected
+//====================================================================================================
+bool SegmentUploadConnection::Request(const ov::String &method,
+                                      const ov::String &path,
+                                      const ov::String &content_type,
+                                      const ov::String &cache_control,
+                                      const std::shared_ptr<const ov::Data> &data,
+                                      int &status_code)
+{
+    status_code = 0;
+
+    if (_socket == nullptr && !Connect())
+        return false;
+
+    ov::String header;
+
+    header.Format("%s %s HTTP/1.1\r\n"
+                  "Host: %s:%u\r\n"
+                  "Content-Type: %s\r\n"
+                  "Content-Length: %zu\r\n",
+                  method.CStr(), path.CStr(), _target.host.CStr(), _target.port, content_type.CStr(), data->GetLength());
+
+    if (!cache_control.IsEmpty())
+        header.AppendFormat("Cache-Control: %s\r\n", cache_control.CStr());
+
+    header.Append("Connection: keep-alive\r\n\r\n");
+
+    bool keep_alive = false;
+
+    if (_socket->Send(header.CStr(), header.GetLength()) != static_cast<ssize_t>(header.GetLength()) ||
+        _socket->Send(data->GetData(), data->GetLength()) != static_cast<ssize_t>(data->GetLength()) ||
+        !ReadResponse(status_code, keep_alive))
+    {
+        Close();
+        return false;
+    }
+
+    _last_use_time = GetUploadMilliseconds();
+
+    if (!keep_alive)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+//====================================================================================================
+// ReadResponse
+// - keep_alive : false if the body length is unknown or the server closes the connection
+//====================================================================================================
+bool SegmentUploadConnection::ReadResponse(int &status_code, bool &keep_alive)
+{
+    ov::String response;
+    off_t header_end = -1;
+
+    while ((header_end = response.IndexOf("\r\n\r\n")) < 0)
+    {
+        auto error = _socket->Recv(_recv_data);
+
+        if (error != nullptr || _recv_data->GetLength() == 0)
+        {
+            logtw("No response from %s", _target.url.CStr());
+            return false;
+        }
+
+        response.Append(_recv_data->GetDataAs<char>(), _recv_data->GetLength());
+
+        if (response.GetLength() > SEGMENT_UPLOAD_RECV_BUFFER_SIZE * 4)
+        {
+            logtw("Too long response header from %s", _target.url.CStr());
+            return false;
+        }
+    }
+
+    auto lines = response.Substring(0, static_cast<size_t>(header_end)).Split("\r\n");
+    auto status_line = lines[0].Split(" ");
+
+    if (status_line.size() < 2 || !status_line[0].HasPrefix("HTTP/1."))
+    {
+        logtw("Invalid response from %s: %s", _target.url.CStr(), lines[0].CStr());
+        return false;
+    }
+
+    status_code = ov::Converter::ToInt32(status_line[1]);
+    keep_alive = (status_line[0] == "HTTP/1.1");
+
+    int64_t content_length = -1;
+
+    for (size_t index = 1; index < lines.size(); index++)
+    {
+        auto colon = lines[index].IndexOf(':');
+
+        if (colon <= 0)
+            continue;
+
+        auto name = lines[index].Substring(0, static_cast<size_t>(colon)).Trim().LowerCaseString();
+        auto value = lines[index].Substring(colon + 1).Trim().LowerCaseString();
+
+        if (name == "content-length")
+            content_length = ov::Converter::ToInt64(value);
+        else if (name == "connection")
+            keep_alive = (value == "keep-alive") || (keep_alive && value != "close");
+        else if (name == "transfer-encoding")
+            keep_alive = false;
+    }
+
+    // no body : 1xx/204/304
+    if (content_length < 0 && (status_code == 204 || status_code == 304 || status_code / 100 == 1))
+        content_length = 0;
+
+    if (content_length < 0)
+    {
+        keep_alive = false;
+        return true;
+    }
+
+    // the body is not used
+    int64_t remaining = content_length - static_cast<int64_t>(response.GetLength() - (header_end + 4));
+
+    while (keep_alive && remaining > 0)
+    {
+        auto error = _socket->Recv(_recv_data);
+
+        if (error != nullptr || _recv_data->GetLength() == 0)
+            keep_alive = false;
+        else
+            remaining -= _recv_data->GetLength();
+    }
+
+    return true;
+}
+
+//====================================================================================================
+// SegmentUploader
+//====================================================================================================
+SegmentUploader::SegmentUploader(const ov::String &name,
+                                 const std::vector<SegmentUploadTarget> &targets,
+                                 const ov::String &method,
+                                 int worker_count,
+                                 int retry_count)
+                                 : _name(name),
+                                   _targets(targets),
+                                   _method(method.UpperCaseString()),
+                                   _worker_count(std::max(worker_count, 1)),
+                                   _retry_count(std::max(retry_count, 0))
+{
+    if (_method != "PUT" && _method != "POST")
+    {
+        logtw("Upload method %s is not supported, PUT is used (%s)", method.CStr(), _name.CStr());
+        _method = "PUT";
+    }
+
+    _idle_connections.resize(_targets.size());
+}
+
+SegmentUploader::~SegmentUploader()
+{
+    Stop();
+}
+
+//====================================================================================================
+// Create
+// - the invalid targets are ignored
+//====================================================================================================
+std::shared_ptr<SegmentUploader> SegmentUploader::Create(const ov::String &name, const cfg::SegmentUpload &upload_config)
+{
+    std::vector<SegmentUploadTarget> targets;
+
+    for (const auto &url_item : upload_config.GetUrls())
+    {
+        SegmentUploadTarget target;
+
+        if (!SegmentUploadTarget::Parse(url_item.GetUrl().Trim(), target))
+        {
+            logtw("Invalid upload url(only http is supported): %s (%s)", url_item.GetUrl().CStr(), name.CStr());
+            continue;
+        }
+
+        targets.push_back(target);
+    }
+
+    if (targets.empty())
+        return nullptr;
+
+    auto uploader = std::make_shared<SegmentUploader>(name,
+                                                      targets,
+                                                      upload_config.GetMethod(),
+                                                      upload_config.GetWorkerCount(),
+                                                      upload_config.GetRetryCount());
+
+    if (!uploader->Start())
+        return nullptr;
+
+    return uploader;
+}
+
+bool SegmentUploader::Start()
+{
+    if (_targets.empty())
+        return false;
+
+    _stop_flag = false;
+
+    for (int index = 0; index < _worker_count; index++)
+        _workers.emplace_back(&SegmentUploader::WorkerThread, this);
+
+    for (const auto &target : _targets)
+        logti("Segments of %s are uploaded to %s (%s, %d workers)", _name.CStr(), target.url.CStr(), _method.CStr(), _worker_count);
+
+    return true;
+}
+
+void SegmentUploader::Stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(_guard);
+
+        if (_stop_flag)
+            return;
+
+        _stop_flag = true;
+    }
+
+    _condition.notify_all();
+
+    for (auto &worker : _workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+
+    _workers.clear();
+
+    std::unique_lock<std::mutex> lock(_guard);
+
+    if (!_jobs.empty())
+        logtw("%zu uploads of %s are discarded", _jobs.size(), _name.CStr());
+
+    _jobs.clear();
+    _pending_segment_counts.clear();
+}
+
+//====================================================================================================
+// UploadSegment
+//====================================================================================================
+void SegmentUploader::UploadSegment(const ov::String &app_name, const ov::String &stream_name, const std::shared_ptr<SegmentData> &segment_data)
+{
+    for (size_t index = 0; index < _targets.size(); index++)
+    {
+        Job job;
+
+        job.target_index = index;
+        job.stream_key.Format("%zu/%s/%s", index, app_name.CStr(), stream_name.CStr());
+        job.path.Format("%s/%s/%s/%s", _targets[index].path.CStr(), app_name.CStr(), stream_name.CStr(), segment_data->file_name.CStr());
+        job.content_type = GetContentType(segment_data->file_name);
+        job.cache_control = segment_data->cache_control;
+        job.data = segment_data->data;
+        job.segment_data = segment_data;
+        job.is_play_list = false;
+
+        Enqueue(job);
+    }
+}
+
+//====================================================================================================
+// UploadPlayList
+// - the queued version of the playlist is replaced
+//====================================================================================================
+void SegmentUploader::UploadPlayList(const ov::String &app_name,
+                                     const ov::String &stream_name,
+                                     const ov::String &file_name,
+                                     const std::shared_ptr<const ov::Data> &data,
+                                     const ov::String &cache_control)
+{
+    for (size_t index = 0; index < _targets.size(); index++)
+    {
+        Job job;
+
+        job.target_index = index;
+        job.stream_key.Format("%zu/%s/%s", index, app_name.CStr(), stream_name.CStr());
+        job.path.Format("%s/%s/%s/%s", _targets[index].path.CStr(), app_name.CStr(), stream_name.CStr(), file_name.CStr());
+        job.content_type = GetContentType(file_name);
+        job.cache_control = cache_control;
+        job.data = data;
+        job.is_play_list = true;
+
+        Enqueue(job);
+    }
+}
+
+void SegmentUploader::Enqueue(const Job &job)
+{
+    {
+        std::unique_lock<std::mutex> lock(_guard);
+
+        if (_stop_flag)
+            return;
+
+        if (job.is_play_list)
+        {
+            for (auto &queued_job : _jobs)
+            {
+                // latest version only(the retry state is kept)
+                if (queued_job.is_play_list && queued_job.path == job.path)
+                {
+                    queued_job.data = job.data;
+                    queued_job.cache_control = job.cache_control;
+                    return;
+                }
+            }
+        }
+        else
+        {
+            _pending_segment_counts[job.stream_key]++;
+        }
+
+        if (_jobs.size() >= SEGMENT_UPLOAD_MAX_QUEUE_SIZE)
+        {
+            auto oldest = std::find_if(_jobs.begin(), _jobs.end(), [](const Job &item) { return !item.is_play_list; });
+
+            if (oldest != _jobs.end())
+            {
+                logtw("Upload queue of %s is full, %s is dropped", _name.CStr(), oldest->path.CStr());
+
+                if (--_pending_segment_counts[oldest->stream_key] <= 0)
+                    _pending_segment_counts.erase(oldest->stream_key);
+
+                _jobs.erase(oldest);
+            }
+        }
+
+        _jobs.push_back(job);
+    }
+
+    _condition.notify_one();
+}
+
+//====================================================================================================
+// PopJob
+// - the first job which is due, a playlist waits for the segments of its stream
+//====================================================================================================
+bool SegmentUploader::PopJob(Job &job, double &wait_time)
+{
+    double current_time = GetUploadMilliseconds();
+
+    wait_time = SEGMENT_UPLOAD_TIMEOUT;
+
+    for (auto item = _jobs.begin(); item != _jobs.end(); ++item)
+    {
+        if (item->is_play_list && _pending_segment_counts.find(item->stream_key) != _pending_segment_counts.end())
+            continue;
+
+        if (item->next_time > current_time)
+        {
+            wait_time = std::min(wait_time, item->next_time - current_time);
+            continue;
+        }
+
+        job = *item;
+        _jobs.erase(item);
+
+        return true;
+    }
+
+    return false;
+}
+
+void SegmentUploader::FinishJob(const Job &job, bool succeeded)
+{
+    if (!succeeded && job.retry < _retry_count)
+    {
+        Job retry_job = job;
+
+        retry_job.retry++;
+        retry_job.next_time = GetUploadMilliseconds() + SEGMENT_UPLOAD_RETRY_INTERVAL * static_cast<double>(1 << std::min(retry_job.retry - 1, 10));
+
+        std::unique_lock<std::mutex> lock(_guard);
+
+        if (!_stop_flag)
+        {
+            // a newer version of the playlist is queued
+            if (retry_job.is_play_list &&
+                std::any_of(_jobs.begin(), _jobs.end(), [&retry_job](const Job &item) { return item.is_play_list && item.path == retry_job.path; }))
+            {
+                return;
+            }
+
+            _jobs.push_back(retry_job);
+            return;
+        }
+    }
+
+    if (!succeeded)
+        logtw("Could not upload %s to %s (%d retries)", job.path.CStr(), _targets[job.target_index].url.CStr(), job.retry);
+
+    if (!job.is_play_list)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_guard);
+
+            auto count = _pending_segment_counts.find(job.stream_key);
+
+            if (count != _pending_segment_counts.end() && --count->second <= 0)
+                _pending_segment_counts.erase(count);
+        }
+
+        // the playlist which waits for the segment
+        _condition.notify_all();
+    }
+}
+
+void SegmentUploader::WorkerThread()
+{
+    while (true)
+    {
+        Job job;
+
+        {
+            std::unique_lock<std::mutex> lock(_guard);
+            double wait_time = 0;
+
+            while (!_stop_flag && !PopJob(job, wait_time))
+                _condition.wait_for(lock, std::chrono::microseconds(static_cast<int64_t>(wait_time * 1000)));
+
+            if (_stop_flag)
+                break;
+        }
+
+        FinishJob(job, Upload(job));
+    }
+}
+
+//====================================================================================================
+// Upload
+// - a reused connection may be closed by the server already, so it is tried again with a new connection
+//====================================================================================================
+bool SegmentUploader::Upload(const Job &job)
+{
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        auto connection = GetConnection(job.target_index);
+        bool reused = connection->IsConnected();
+        int status_code = 0;
+
+        bool reusable = connection->Request(_method, job.path, job.content_type, job.cache_control, job.data, status_code);
+
+        if (reusable)
+            ReleaseConnection(job.target_index, connection);
+
+        if (status_code >= 200 && status_code < 300)
+            return true;
+
+        if (status_code != 0)
+        {
+            logtw("Upload of %s is failed: %d (%s)", job.path.CStr(), status_code, _targets[job.target_index].url.CStr());
+            return false;
+        }
+
+        if (!reused)
+            return false;
+    }
+
+    return false;
+}
+
+std::shared_ptr<SegmentUploadConnection> SegmentUploader::GetConnection(size_t target_index)
+{
+    {
+        std::unique_lock<std::mutex> lock(_connection_guard);
+
+        auto &connections = _idle_connections[target_index];
+        double current_time = GetUploadMilliseconds();
+
+        while (!connections.empty())
+        {
+            auto connection = connections.back();
+            connections.pop_back();
+
+            if (current_time - connection->GetLastUseTime() < SEGMENT_UPLOAD_IDLE_TIMEOUT)
+                return connection;
+        }
+    }
+
+    return std::make_shared<SegmentUploadConnection>(_targets[target_index]);
+}
+
+void SegmentUploader::ReleaseConnection(size_t target_index, const std::shared_ptr<SegmentUploadConnection> &connection)
+{
+    std::unique_lock<std::mutex> lock(_connection_guard);
+
+    // at most a connection per worker
+    if (_idle_connections[target_index].size() < static_cast<size_t>(_worker_count))
+        _idle_connections[target_index].push_back(connection);
+}
+
+ov::String SegmentUploader::GetContentType(const ov::String &file_name)
+{
+    if (file_name.HasSuffix(".m3u8"))
+        return "application/x-mpegURL";
+    else if (file_name.HasSuffix(".mpd"))
+        return "application/dash+xml";
+    else if (file_name.HasSuffix(".ts"))
+        return "video/MP2T";
+    else if (file_name.HasSuffix(MPD_AUDIO_SUFFIX) || file_name == MPD_AUDIO_INIT_FILE_NAME)
+        return "audio/mp4";
+
+    return "video/mp4";
+}
@@ -0,0 +1,167 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <thread>
+#include "../base/ovlibrary/ovlibrary.h"
+#include "../base/ovsocket/ovsocket.h"
+#include "packetyzer_define.h"
+
+namespace cfg
+{
+    struct SegmentUpload;
+}
+
+// Timeout of the connection/request/response of an upload(ms)
+#define SEGMENT_UPLOAD_TIMEOUT              (5000)
+// The first retry interval(ms), doubled for every retry
+#define SEGMENT_UPLOAD_RETRY_INTERVAL       (500)
+// Idle connections older than this are closed instead of reused(ms)
+#define SEGMENT_UPLOAD_IDLE_TIMEOUT         (30 * 1000)
+// Queued uploads of all the targets, the oldest segment is dropped when it is exceeded
+#define SEGMENT_UPLOAD_MAX_QUEUE_SIZE       (1024)
+#define SEGMENT_UPLOAD_RECV_BUFFER_SIZE     (16 * 1024)
+
+//====================================================================================================
+// SegmentUploadTarget
+// - http://<host>[:<port>][/<path>], the files are uploaded to <path>/<app>/<stream>/<file>
+//====================================================================================================
+struct SegmentUploadTarget
+{
+    ov::String url;
+    ov::String host;
+    uint16_t port = 80;
+    ov::String path;
+
+    static bool Parse(const ov::String &url, SegmentUploadTarget &target);
+};
+
+//====================================================================================================
+// SegmentUploadConnection
+// - keep-alive connection to a target(blocking socket, bounded by SEGMENT_UPLOAD_TIMEOUT)
+//====================================================================================================
+class SegmentUploadConnection
+{
+public:
+    explicit SegmentUploadConnection(const SegmentUploadTarget &target);
+    ~SegmentUploadConnection();
+
+    // status_code : status of the response(0 : no response)
+    // false : the connection is not reusable any more
+    bool Request(const ov::String &method,
+                 const ov::String &path,
+                 const ov::String &content_type,
+                 const ov::String &cache_control,
+                 const std::shared_ptr<const ov::Data> &data,
+                 int &status_code);
+
+    bool IsConnected() const { return _socket != nullptr; }
+
+    double GetLastUseTime() const { return _last_use_time; }
+
+private:
+    bool Connect();
+    void Close();
+
+    // the status line and the headers, the body is skipped(Content-Length)
+    bool ReadResponse(int &status_code, bool &keep_alive);
+
+    const SegmentUploadTarget &_target;
+    std::shared_ptr<ov::ClientSocket> _socket = nullptr;
+    std::shared_ptr<ov::Data> _recv_data = nullptr;
+    double _last_use_time = 0; // millisecond
+};
+
+//====================================================================================================
+// SegmentUploader
+// - pushes the finished segments and the playlists to the ingest endpoints(CDN push/object storage)
+// - shared by the streams of an application : worker threads(parallel uploads) + connection pool per target
+// - the playlist of a stream is uploaded after the segments queued before it(the players never see
+//   a segment which is not uploaded yet), only the latest version of a queued playlist is uploaded
+// - failed uploads are retried with backoff(SEGMENT_UPLOAD_RETRY_INTERVAL * 2^n)
+//====================================================================================================
+class SegmentUploader
+{
+public:
+    // method : PUT or POST
+    SegmentUploader(const ov::String &name,
+                    const std::vector<SegmentUploadTarget> &targets,
+                    const ov::String &method,
+                    int worker_count,
+                    int retry_count);
+    ~SegmentUploader();
+
+    // started uploader of <Upload>(nullptr : no valid target)
+    static std::shared_ptr<SegmentUploader> Create(const ov::String &name, const cfg::SegmentUpload &upload_config);
+
+    bool Start();
+    void Stop();
+
+    // called by the packetyzer when the segment is stored(the segment is kept until it is uploaded)
+    void UploadSegment(const ov::String &app_name, const ov::String &stream_name, const std::shared_ptr<SegmentData> &segment_data);
+
+    void UploadPlayList(const ov::String &app_name,
+                        const ov::String &stream_name,
+                        const ov::String &file_name,
+                        const std::shared_ptr<const ov::Data> &data,
+                        const ov::String &cache_control);
+
+private:
+    struct Job
+    {
+        size_t target_index;
+        ov::String stream_key;
+        ov::String path;
+        ov::String content_type;
+        ov::String cache_control;
+        std::shared_ptr<const ov::Data> data;
+        // the segment is kept(its buffer is not recycled) until it is uploaded
+        std::shared_ptr<SegmentData> segment_data;
+        bool is_play_list;
+        int retry = 0;
+        double next_time = 0; // millisecond
+    };
+
+    void Enqueue(const Job &job);
+    void WorkerThread();
+
+    // _guard must be locked, false : no job is ready(wait_time : until the next job is ready)
+    bool PopJob(Job &job, double &wait_time);
+    void FinishJob(const Job &job, bool succeeded);
+
+    bool Upload(const Job &job);
+
+    std::shared_ptr<SegmentUploadConnection> GetConnection(size_t target_index);
+    void ReleaseConnection(size_t target_index, const std::shared_ptr<SegmentUploadConnection> &connection);
+
+    static ov::String GetContentType(const ov::String &file_name);
+
+    ov::String _name;
+    std::vector<SegmentUploadTarget> _targets;
+    ov::String _method;
+    int _worker_count;
+    int _retry_count;
+
+    std::vector<std::thread> _workers;
+    bool _stop_flag = true;
+
+    // _guard : _jobs, _pending_segment_counts
+    std::mutex _guard;
+    std::condition_variable _condition;
+    std::deque<Job> _jobs;
+    // segments which are queued or being uploaded(key : stream key)
+    std::map<ov::String, int> _pending_segment_counts;
+
+    // idle connections(index of the target)
+    std::mutex _connection_guard;
+    std::vector<std::vector<std::shared_ptr<SegmentUploadConnection>>> _idle_connections;
+};
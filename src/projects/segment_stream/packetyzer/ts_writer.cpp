@@ -15,6 +15,7 @@
 
 #define TS_STREAM_TYPE_ISO_IEC_13818_7 		(0x0F)
 #define TS_STREAM_TYPE_AVC             		(0x1B)
+#define TS_STREAM_TYPE_HEVC            		(0x24)
 #define PES_HEADER_SIZE						(14)
 #define PES_HEADER_WIDTH_DTS_SIZE			(19)
 #define TS_DEFAULT_PMT_PID         			(0xFFF)
@@ -106,6 +107,9 @@ static uint32_t const HLS_CRC_TABLE[256] =
 };
 #define H264_AUD_SIZE (6)
 static const uint8_t g_aud[H264_AUD_SIZE] = { 0x00 ,0x00 ,0x00 ,0x01 ,0x09 ,0xe0 };
+// HEVC AUD : NAL header(2Byte, type 35) + pic_type(3bit, I/P/B) + rbsp_trailing_bits
+#define H265_AUD_SIZE (7)
+static const uint8_t g_hevc_aud[H265_AUD_SIZE] = { 0x00 ,0x00 ,0x00 ,0x01 ,0x46 ,0x01 ,0x50 };
 
 //====================================================================================================
 // CRC 생성 
@@ -125,7 +129,7 @@ uint32_t TsWriter::MakeCrc(const uint8_t *data, uint32_t data_size)
 //====================================================================================================
 // Constructor
 //====================================================================================================
-TsWriter::TsWriter(bool video_enable, bool audio_enable)
+TsWriter::TsWriter(bool video_enable, bool audio_enable, SegmentCodecType video_codec_type)
 {
 	_data_stream = std::make_shared<std::vector<uint8_t>>();
 	_data_stream->reserve(4096);
@@ -133,13 +137,28 @@ TsWriter::TsWriter(bool video_enable, bool audio_enable)
 	_audio_continuity_count	= 0;
 	_video_continuity_count	= 0;
 
+	MakeTsHeaderTemplate(TS_DEFAULT_VIDEO_PID, _video_ts_header);
+	MakeTsHeaderTemplate(TS_DEFAULT_AUDIO_PID, _audio_ts_header);
+
     _video_enable = video_enable;
     _audio_enable = audio_enable;
+    _video_codec_type = video_codec_type;
 
     WritePAT();
 	WritePMT();
 }
 
+//====================================================================================================
+// Sample Data 크기 만큼 버퍼 미리 할당
+// - data_size : ES 데이터 총합, sample_count : PES 개수(PES 헤더/PCR/Stuffing 패킷 고려)
+//====================================================================================================
+void TsWriter::ReserveSampleData(size_t data_size, size_t sample_count)
+{
+	size_t packet_count = (data_size / TS_PACKET_PAYLOAD_SIZE) + (sample_count * 2);
+
+	_data_stream->reserve(_data_stream->size() + packet_count * TS_PACKET_SIZE);
+}
+
 //====================================================================================================
 // Stream Data 버퍼에 데이터 추가
 //====================================================================================================
@@ -157,9 +176,12 @@ bool TsWriter::WritePAT()
 {
 	uint32_t payload_size 	= TS_PACKET_PAYLOAD_SIZE;
 	uint32_t crc			= 0;
+	uint8_t ts_header[TS_HEADER_SIZE + TS_PCR_ADAPTATION_SIZE + 2] = {0, };
+	uint8_t ts_header_template[TS_HEADER_SIZE] = {0, };
 
 	// TS Header 설정
-	MakeTsHeader(0, 0, true, payload_size, false, 0, false);
+	MakeTsHeaderTemplate(0, ts_header_template);
+	WriteDataStream((int)MakeTsHeader(ts_header, ts_header_template, 0, true, payload_size, false, 0, false), ts_header);
 
 	//PAT Header 설정(13Byte)
 	BitWriter pat_bit(TS_PAT_SIZE);
@@ -203,9 +225,12 @@ bool TsWriter::WritePMT()
 	uint32_t section_size 	= 13;
 	uint32_t pid			= 0;
 	uint32_t crc			= 0;
+	uint8_t ts_header[TS_HEADER_SIZE + TS_PCR_ADAPTATION_SIZE + 2] = {0, };
+	uint8_t ts_header_template[TS_HEADER_SIZE] = {0, };
 
 	// TS Header 설정
-	MakeTsHeader(TS_DEFAULT_PMT_PID, 0, true, payload_size, false, 0, false);
+	MakeTsHeaderTemplate(TS_DEFAULT_PMT_PID, ts_header_template);
+	WriteDataStream((int)MakeTsHeader(ts_header, ts_header_template, 0, true, payload_size, false, 0, false), ts_header);
 
 	if(_audio_enable)
 	{
@@ -240,7 +265,7 @@ bool TsWriter::WritePMT()
 
 	if(_video_enable)
 	{
-		pmt_bit.Write(8,		TS_STREAM_TYPE_AVC); 			// stream_type
+		pmt_bit.Write(8,		(_video_codec_type == SegmentCodecType::H265Codec) ? TS_STREAM_TYPE_HEVC : TS_STREAM_TYPE_AVC); // stream_type
 		pmt_bit.Write(3,		0x7);                   		// reserved
 		pmt_bit.Write(13,	TS_DEFAULT_VIDEO_PID);    		// elementary_PID
 		pmt_bit.Write(4,		0xF);                   		// reserved
@@ -276,6 +301,8 @@ bool TsWriter::WritePMT()
 // - PES 헤더 추가 (DTS 사용 않함)
 //    Header(9Byte) + PTS(5Byte) + [DTS(5Byte)] 
 // - TS 헤더 추가 
+// - 출력 버퍼를 한번에 할당 후 패킷 단위로 직접 기록(PID별 TS 헤더 템플릿 사용)
+//    첫 패킷 : PES 헤더(+AUD) + PCR, 중간 패킷 : 184Byte 복사, 마지막 패킷 : Stuffing
 //====================================================================================================
 bool TsWriter::WriteSample(bool is_video,
                             bool is_keyframe,
@@ -283,80 +310,80 @@ bool TsWriter::WriteSample(bool is_video,
                             uint64_t time_offset,
                             std::shared_ptr<ov::Data> &data)
 {
-	uint8_t pes_header[PES_HEADER_WIDTH_DTS_SIZE] = {0, };
-	uint32_t pes_header_size = 0;
-	uint32_t rest_data_size = 0;
-	uint32_t payload_size = 0;
-	const uint8_t *data_pos = nullptr;
-	bool first_payload = true;
-
-	//Video(H264) - access unit delimiter(AUD) 정보 추가
+	uint8_t prefix[PES_HEADER_WIDTH_DTS_SIZE + H265_AUD_SIZE] = {0, };
+	uint32_t prefix_size = 0;
+	const uint8_t *ts_header = is_video ? _video_ts_header : _audio_ts_header;
+	uint32_t &continuity_count = is_video ? _video_continuity_count : _audio_continuity_count;
+	bool use_pcr = is_video ? true : (!_video_enable && _audio_enable);
+	size_t rest_data_size = data->GetLength();
+	const uint8_t *data_pos = data->GetDataAs<uint8_t>();
+	bool is_hevc = (_video_codec_type == SegmentCodecType::H265Codec);
+	const uint8_t *aud = is_hevc ? g_hevc_aud : g_aud;
+	uint32_t aud_size = is_video ? (is_hevc ? H265_AUD_SIZE : H264_AUD_SIZE) : 0;
+
+	// PES Header 생성 
+	// - Video(H264/H265) : access unit delimiter(AUD) 정보 추가(프레임 데이터 앞에 삽입하지 않고 PES 헤더 뒤에 기록)
+	MakePesHeader((int)(rest_data_size + aud_size), is_video, timestamp, time_offset, prefix, prefix_size);
+
 	if(is_video)
 	{
-		data->Insert(g_aud, 0, H264_AUD_SIZE);
+		memcpy(prefix + prefix_size, aud, aud_size);
+		prefix_size += aud_size;
 	}
 
-	data_pos = data->GetDataAs<uint8_t>();
+	// 패킷 개수 계산
+	size_t first_payload_capacity = TS_PACKET_PAYLOAD_SIZE - (use_pcr ? (2 + TS_PCR_ADAPTATION_SIZE) : 0);
+	size_t total_size = prefix_size + rest_data_size;
+	size_t packet_count = 1;
 
-	// PES Header 생성 
-	MakePesHeader(data->GetLength(), is_video, timestamp, time_offset, pes_header, pes_header_size);
-	
-	// TS Header + Payload 설정 
-	rest_data_size = pes_header_size + data->GetLength();
-			
-	// Buffer 공간 체크 
-	// (Payload 개수 + 2)*  TS_PACKET_SIZE
-	
-	while(rest_data_size > 0)
+	if(total_size > first_payload_capacity)
 	{
-		payload_size = rest_data_size;
+		packet_count += (total_size - first_payload_capacity + TS_PACKET_PAYLOAD_SIZE - 1) / TS_PACKET_PAYLOAD_SIZE;
+	}
 
-		if(payload_size > TS_PACKET_PAYLOAD_SIZE)
-		{
-			payload_size = TS_PACKET_PAYLOAD_SIZE;
-		}
-		
-		if(first_payload)
-		{
-			first_payload = false;
-	
-			// TS Header 설정 
-			if(is_video)
-			    MakeTsHeader(TS_DEFAULT_VIDEO_PID,
-			            _video_continuity_count++,
-			            true,
-			            payload_size,
-			            true,
-			            timestamp*300,
-			            is_keyframe);
-			else
-			    MakeTsHeader(TS_DEFAULT_AUDIO_PID,
-			            _audio_continuity_count++,
-			            true,
-			            payload_size,
-			            (!_video_enable && _audio_enable),
-			            timestamp*300,
-			            is_keyframe);
-						
-			// PES헤더 설정 
-			WriteDataStream(pes_header_size, pes_header); 
-			rest_data_size -= pes_header_size;
-			payload_size -= pes_header_size; 
-		}
-		else
-		{
-			// TS Header 설정 
-			if(is_video)
-			    MakeTsHeader(TS_DEFAULT_VIDEO_PID, _video_continuity_count++, false, payload_size, false, 0, is_keyframe);
-			else
-			    MakeTsHeader(TS_DEFAULT_AUDIO_PID, _audio_continuity_count++, false, payload_size, false, 0, is_keyframe);
-		}
-
-		// Data 설정
-		WriteDataStream(payload_size, data_pos);
-		data_pos += payload_size;
-		rest_data_size -= payload_size;
-	};
+	// Buffer 공간 확보 
+	size_t offset = _data_stream->size();
+	size_t required_size = offset + packet_count * TS_PACKET_SIZE;
+
+	if(required_size > _data_stream->capacity())
+	{
+		_data_stream->reserve(std::max(required_size, _data_stream->capacity() * 2));
+	}
+
+	_data_stream->resize(required_size);
+
+	uint8_t *packet = _data_stream->data() + offset;
+
+	// 첫 패킷(PES 헤더 + PCR)
+	auto payload_size = (uint32_t)std::min(total_size, first_payload_capacity);
+	uint32_t header_size = MakeTsHeader(packet, ts_header, continuity_count++, true, payload_size, use_pcr, timestamp*300, is_keyframe);
+	size_t copy_size = payload_size - prefix_size;
+
+	memcpy(packet + header_size, prefix, prefix_size);
+	memcpy(packet + header_size + prefix_size, data_pos, copy_size);
+	data_pos += copy_size;
+	rest_data_size -= copy_size;
+	packet += TS_PACKET_SIZE;
+
+	// 중간 패킷(Adaptation Field 없음)
+	while(rest_data_size >= TS_PACKET_PAYLOAD_SIZE)
+	{
+		memcpy(packet, ts_header, TS_HEADER_SIZE);
+		packet[3] = (uint8_t)(1<<4 | (continuity_count++ & 0x0F));
+		memcpy(packet + TS_HEADER_SIZE, data_pos, TS_PACKET_PAYLOAD_SIZE);
+
+		data_pos += TS_PACKET_PAYLOAD_SIZE;
+		rest_data_size -= TS_PACKET_PAYLOAD_SIZE;
+		packet += TS_PACKET_SIZE;
+	}
+
+	// 마지막 패킷(Stuffing)
+	if(rest_data_size > 0)
+	{
+		payload_size = (uint32_t)rest_data_size;
+		header_size = MakeTsHeader(packet, ts_header, continuity_count++, false, payload_size, false, 0, is_keyframe);
+		memcpy(packet + header_size, data_pos, payload_size);
+	}
 
 	return true; 
 }
@@ -449,28 +476,44 @@ bool TsWriter::MakePesHeader(int data_size,
 	return true;
 }
 
+//====================================================================================================
+// TS Header 템플릿 생성
+// - Sync Byte/PID 고정, Payload Start/Adaptation Field/Continuity counter 는 패킷 마다 설정
+//====================================================================================================
+void TsWriter::MakeTsHeaderTemplate(int pid, uint8_t *header)
+{
+	header[0] = TS_SYNC_BYTE;
+	header[1] = (uint8_t)(pid >> 8);
+	header[2] = (uint8_t)(pid & 0xFF);
+	header[3] = 0;
+}
+
 //====================================================================================================
 // TS Header 설정 
 // - PCR : Program Clock Reference
 // - Adaptation field control : Playload의 위치가 확인 
 // - Continuity counter : 0~15 순환되며  각각 패킷에 부여 
+// - packet 에 TS 헤더 + Adaptation Field 기록 후 크기 반환(payload 는 packet + 반환값 위치)
 //====================================================================================================
-bool TsWriter::MakeTsHeader(int pid,
-                            uint32_t continuity_count,
-                            bool payload_start,
-                            uint32_t & payload_size,
-                            bool use_pcr,
-                            uint64_t pcr,
-                            bool is_keyframe)
+uint32_t TsWriter::MakeTsHeader(uint8_t *packet,
+                                const uint8_t *ts_header,
+                                uint32_t continuity_count,
+                                bool payload_start,
+                                uint32_t & payload_size,
+                                bool use_pcr,
+                                uint64_t pcr,
+                                bool is_keyframe)
 {
-	uint8_t		header[TS_HEADER_SIZE] 					= {0,};
-	uint8_t		adaptation_data[TS_PCR_ADAPTATION_SIZE] = {0,};
-	uint32_t	adaptation_field_size 					= 0;
-	uint32_t	pcr_size 								= 0;
+	uint8_t		*adaptation_data		= packet + TS_HEADER_SIZE;
+	uint32_t	adaptation_field_size 	= 0;
+	uint32_t	pcr_size 				= 0;
 
-	header[0] = TS_SYNC_BYTE;
-	header[1] = (uint8_t)(((payload_start ? 1 : 0)<<6) | (pid >> 8));
-	header[2] = (uint8_t)(pid & 0xFF);
+	memcpy(packet, ts_header, TS_HEADER_SIZE);
+
+	if(payload_start)
+	{
+		packet[1] = (uint8_t)(packet[1] | 1<<6);
+	}
 
 	if(use_pcr)
 	{
@@ -492,30 +535,19 @@ bool TsWriter::MakeTsHeader(int pid,
 	// no adaptation field
 	if(adaptation_field_size == 0)
 	{
-		header[3] = (uint8_t)(1<<4 | (continuity_count & 0x0F));
+		packet[3] = (uint8_t)(1<<4 | (continuity_count & 0x0F));
 
-		//Segment 데이터 설정 
-		WriteDataStream(4, header); 
-		
-		return true; 
-  
+		return TS_HEADER_SIZE; 
 	}
 	
 	// adaptation field present
-	header[3] = (uint8_t)(3<<4 | (continuity_count & 0x0F));
-	
-	//Segment 데이터 설정 
-	WriteDataStream(4, header); 
+	packet[3] = (uint8_t)(3<<4 | (continuity_count & 0x0F));
 
-	
 	if(adaptation_field_size == 1) 
 	{
 		adaptation_data[0] = 0; 
 
-		//Segment 데이터 설정 
-		WriteDataStream(1, adaptation_data); 
-
-		return true; 		
+		return TS_HEADER_SIZE + 1; 		
 	} 
 
 	// two or more bytes (stuffing and/or PCR)
@@ -526,23 +558,19 @@ bool TsWriter::MakeTsHeader(int pid,
 	{	
 		adaptation_data[1] =  (uint8_t)(adaptation_data[1] | 1<<6);
 	}
-	
-	//Segment 데이터 설정 
-	WriteDataStream(2, adaptation_data); 
 
 	if(use_pcr)
 	{
-		BitWriter 	pcr_bit(TS_PCR_ADAPTATION_SIZE); 
+		// base(33bit) + reserved(6bit) + extension(9bit)
 		uint64_t	pcr_base = pcr/300;
 		uint32_t 	pcr_ext  = (uint32_t)(pcr%300);
-		
-		pcr_bit.Write(1, 	(uint32_t)(pcr_base>>32));
-		pcr_bit.Write(32, 	(uint32_t)pcr_base);
-		pcr_bit.Write(6, 	0x3F);
-		pcr_bit.Write(9, 	pcr_ext);
-			
-		//Segment 데이터 설정 
-		WriteDataStream((int)pcr_bit.GetDataSize(), pcr_bit.GetData());
+
+		adaptation_data[2] = (uint8_t)(pcr_base >> 25);
+		adaptation_data[3] = (uint8_t)(pcr_base >> 17);
+		adaptation_data[4] = (uint8_t)(pcr_base >> 9);
+		adaptation_data[5] = (uint8_t)(pcr_base >> 1);
+		adaptation_data[6] = (uint8_t)(((pcr_base & 0x01) << 7) | 0x7E | ((pcr_ext >> 8) & 0x01));
+		adaptation_data[7] = (uint8_t)(pcr_ext & 0xFF);
 
 		//PCR 사이즈 저장 
 		pcr_size = TS_PCR_ADAPTATION_SIZE; 
@@ -551,9 +579,8 @@ bool TsWriter::MakeTsHeader(int pid,
 	//Stuffing Bytes 	
 	if (adaptation_field_size > 2) 
 	{
-		
-		WriteDataStream(adaptation_field_size - pcr_size - 2, HLS_STUFFING_BYTES); 
+		memset(adaptation_data + 2 + pcr_size, 0xFF, adaptation_field_size - pcr_size - 2); 
 	}
    
-	return true;
-} 
+	return TS_HEADER_SIZE + adaptation_field_size;
+}
@@ -19,7 +19,7 @@
 class TsWriter
 {
 public:
-	TsWriter(bool video_enable, bool audio_enable);
+	TsWriter(bool video_enable, bool audio_enable, SegmentCodecType video_codec_type = SegmentCodecType::H264Codec);
 	virtual ~TsWriter() = default;
 	
 public :
@@ -29,8 +29,14 @@ public :
                    uint64_t time_offset,
                    std::shared_ptr<ov::Data> &frame_data);
 
+	// 여러 Sample 을 연속으로 기록할 때 버퍼 재할당 방지
+	void ReserveSampleData(size_t data_size, size_t sample_count);
+
 	const std::shared_ptr<std::vector<uint8_t>> &GetDataStream(){ return _data_stream; };
 
+	// 기록된 데이터 삭제(continuity count 는 유지되므로 하나의 TS 스트림을 나누어 가져갈 수 있음)
+	void ClearDataStream(){ _data_stream->clear(); };
+
 protected : 	
 	static uint32_t	MakeCrc(const uint8_t * data, uint32_t data_size);
 	bool WritePAT();
@@ -42,7 +48,10 @@ protected :
                         uint8_t * header,
                         uint32_t & header_size);
 
-	bool MakeTsHeader(int pid,
+	static void MakeTsHeaderTemplate(int pid, uint8_t *header);
+
+	static uint32_t MakeTsHeader(uint8_t *packet,
+                        const uint8_t *ts_header,
                         uint32_t continuity_count,
                         bool payload_start,
                         uint32_t & payload_size,
@@ -55,10 +64,15 @@ protected :
 protected :
     bool _video_enable;
     bool _audio_enable;
+    SegmentCodecType _video_codec_type;
 
     std::shared_ptr<std::vector<uint8_t>> _data_stream;
 	uint32_t _audio_continuity_count;
 	uint32_t _video_continuity_count;
 
+	// PID별 TS 헤더 템플릿
+	uint8_t _audio_ts_header[4];
+	uint8_t _video_ts_header[4];
+
 
 };
\ No newline at end of file
@@ -16,7 +16,7 @@ using namespace common;
 
 //====================================================================================================
 // SegmentStream
-// - DASH/HLS : H264/AAC only
+// - DASH/HLS : H264(H265)/AAC only
 // TODO : 다중 트랜스코딩/다중 트랙 구분 및 처리 필요
 //====================================================================================================
 SegmentStream::SegmentStream(const std::shared_ptr<Application> application, const StreamInfo &info)
@@ -45,7 +45,8 @@ bool SegmentStream::Start(int segment_count, int segment_duration, uint32_t work
     {
         auto &track = track_item.second;
 
-        if(track->GetMediaType() == MediaType::Video &&  track->GetCodecId() == MediaCodecId::H264)
+        if(track->GetMediaType() == MediaType::Video &&
+            (track->GetCodecId() == MediaCodecId::H264 || track->GetCodecId() == MediaCodecId::H265))
         {
             video_track = track;
         }
@@ -57,9 +58,10 @@ bool SegmentStream::Start(int segment_count, int segment_duration, uint32_t work
 
     PacketyzerMediaInfo media_info;
 
-    if (video_track != nullptr && video_track->GetCodecId() == MediaCodecId::H264)
+    if (video_track != nullptr)
     {
-        media_info.video_codec_type = SegmentCodecType::H264Codec;
+        media_info.video_codec_type = (video_track->GetCodecId() == MediaCodecId::H265) ?
+                                        SegmentCodecType::H265Codec : SegmentCodecType::H264Codec;
         media_info.video_framerate = video_track->GetFrameRate();
         media_info.video_width = video_track->GetWidth();
         media_info.video_height = video_track->GetHeight();
@@ -67,6 +69,12 @@ bool SegmentStream::Start(int segment_count, int segment_duration, uint32_t work
         media_info.video_bitrate = video_track->GetBitrate();
 
         _media_tracks[video_track->GetId()] = video_track;
+
+        if (_thumbnail_enabled)
+        {
+            _thumbnailer = std::make_unique<SegmentThumbnailer>(video_track->GetCodecId(), _thumbnail_width);
+            _thumbnail_etag_prefix = static_cast<uint64_t>(Packetyzer::GetCurrentMilliseconds());
+        }
     }
 
     if (audio_track != nullptr && audio_track->GetCodecId() == MediaCodecId::Aac)
@@ -95,6 +103,19 @@ bool SegmentStream::Start(int segment_count, int segment_duration, uint32_t work
                                                     GetName(), // stream name --> prefix
                                                     stream_type,
                                                     media_info);
+
+        if (_stream_packetyzer != nullptr)
+        {
+            _stream_packetyzer->SetSegmentMemoryLimit(_segment_memory_limit);
+
+            // the key frames of the renditions are synchronized by the transcoder(<KeyFrameSync>)
+            _stream_packetyzer->SetSegmentAlignment(GetApplication()->IsKeyFrameSyncEnabled());
+            _stream_packetyzer->SetSegmentTolerance(_segment_tolerance);
+            _stream_packetyzer->SetUploader(_uploader);
+
+            if (_dvr_window_duration > 0 && !_stream_packetyzer->EnableDvr(_dvr_path, _dvr_window_duration))
+                logtw("Dvr is disabled - stream(%s)", GetName().CStr());
+        }
     }
     else
     {
@@ -102,14 +123,84 @@ bool SegmentStream::Start(int segment_count, int segment_duration, uint32_t work
         //logtw("For output DASH/HLS, one of H264(video) or AAC(audio) codecs must be encoded.");
     }
 
+    // the encoder of the input(transcoder) is asked for the key frames at the segment duration
+    if (video_track != nullptr)
+    {
+        const auto &origin_stream_name = GetOriginStreamName().IsEmpty() ? GetName() : GetOriginStreamName();
+
+        _key_frame_advice = StreamKeyFrameAdvisory::Instance()->GetAdvice(GetApplication()->GetId(), origin_stream_name);
+        _key_frame_advice_interval = static_cast<int64_t>(segment_duration > 0 ? segment_duration : DEFAULT_SEGMENT_DURATION) * 1000;
+        _key_frame_advice->Add(_key_frame_advice_interval);
+    }
+
     return Stream::Start(worker_count);
 }
 
+//====================================================================================================
+// Segment Memory Limit
+//====================================================================================================
+void SegmentStream::SetSegmentMemoryLimit(uint64_t limit)
+{
+    _segment_memory_limit = limit;
+}
+
+size_t SegmentStream::GetStoreMemoryUsage()
+{
+    if (_stream_packetyzer != nullptr)
+    {
+        return _stream_packetyzer->GetMemoryUsage();
+    }
+
+    return 0;
+}
+
+//====================================================================================================
+// DVR
+//====================================================================================================
+void SegmentStream::SetDvr(const ov::String &path, uint64_t window_duration)
+{
+    _dvr_path = path;
+    _dvr_window_duration = window_duration;
+}
+
+//====================================================================================================
+// Thumbnail
+//====================================================================================================
+void SegmentStream::SetThumbnail(bool enabled, uint32_t width)
+{
+    _thumbnail_enabled = enabled;
+    _thumbnail_width = width;
+}
+
+//====================================================================================================
+// Segment Tolerance
+// - millisecond(0 : the first key frame after the segment duration)
+//====================================================================================================
+void SegmentStream::SetSegmentTolerance(uint32_t tolerance)
+{
+    _segment_tolerance = tolerance;
+}
+
+//====================================================================================================
+// Uploader
+// - the segments and the playlists are pushed to the ingest endpoints of the application
+//====================================================================================================
+void SegmentStream::SetUploader(const std::shared_ptr<SegmentUploader> &uploader)
+{
+    _uploader = uploader;
+}
+
 //====================================================================================================
 // Stop
 //====================================================================================================
 bool SegmentStream::Stop()
 {
+    if (_key_frame_advice != nullptr)
+    {
+        _key_frame_advice->Remove(_key_frame_advice_interval);
+        _key_frame_advice = nullptr;
+    }
+
     return Stream::Stop();
 }
 
@@ -120,15 +211,19 @@ bool SegmentStream::Stop()
 //
 //====================================================================================================
 void SegmentStream::SendVideoFrame(std::shared_ptr<MediaTrack> track,
-                                   std::unique_ptr<EncodedFrame> encoded_frame,
-                                   std::unique_ptr<CodecSpecificInfo> codec_info,
-                                   std::unique_ptr<FragmentationHeader> fragmentation)
+                                   std::unique_ptr<EncodedFrameDescriptor> frame)
 {
-    //logtd("Video Timestamp : %d" , encoded_frame->_time_stamp);
+    auto &encoded_frame = frame->encoded_frame;
+
+    //logtd("Video Timestamp : %d" , encoded_frame._time_stamp);
 
     if (_stream_packetyzer != nullptr && _media_tracks.find(track->GetId()) != _media_tracks.end())
     {
-        _stream_packetyzer->AppendVideoData(std::move(encoded_frame), track->GetTimeBase().GetDen(), 0);
+        // only the reference of the key frame is kept
+        if (_thumbnailer != nullptr)
+            _thumbnailer->AppendVideoFrame(encoded_frame);
+
+        _stream_packetyzer->AppendVideoData(encoded_frame, track->GetTimeBase().GetDen(), 0);
     }
 }
 
@@ -137,15 +232,13 @@ void SegmentStream::SendVideoFrame(std::shared_ptr<MediaTrack> track,
 // - Packetyzer에 Audio데이터 추가
 //====================================================================================================
 void SegmentStream::SendAudioFrame(std::shared_ptr<MediaTrack> track,
-                                   std::unique_ptr<EncodedFrame> encoded_frame,
-                                   std::unique_ptr<CodecSpecificInfo> codec_info,
-                                   std::unique_ptr<FragmentationHeader> fragmentation)
+                                   std::unique_ptr<EncodedFrameDescriptor> frame)
 {
-    //logtd("Audio Timestamp : %d", encoded_frame->_time_stamp);
+    //logtd("Audio Timestamp : %d", frame->encoded_frame._time_stamp);
 
     if (_stream_packetyzer != nullptr && _media_tracks.find(track->GetId()) != _media_tracks.end())
     {
-        _stream_packetyzer->AppendAudioData(std::move(encoded_frame), track->GetTimeBase().GetDen());
+        _stream_packetyzer->AppendAudioData(frame->encoded_frame, track->GetTimeBase().GetDen());
     }
 }
 
@@ -153,7 +246,7 @@ void SegmentStream::SendAudioFrame(std::shared_ptr<MediaTrack> track,
 // GetPlayList
 // - M3U8/MPD
 //====================================================================================================
-bool SegmentStream::GetPlayList(ov::String &play_list)
+bool SegmentStream::GetPlayList(std::shared_ptr<const PlayListSnapshot> &play_list)
 {
     if (_stream_packetyzer != nullptr)
     {
@@ -163,16 +256,158 @@ bool SegmentStream::GetPlayList(ov::String &play_list)
     return false;
 }
 
+//====================================================================================================
+// GetPlayList
+// - multiple playlists of a stream(HLS CMAF)
+//====================================================================================================
+bool SegmentStream::GetPlayList(const ov::String &file_name, std::shared_ptr<const PlayListSnapshot> &play_list)
+{
+    if (_stream_packetyzer != nullptr)
+    {
+        return _stream_packetyzer->GetPlayList(file_name, play_list);
+    }
+
+    return false;
+}
+
 //====================================================================================================
 // GetSegment
-// - TS/M4S(mp4)
+// - TS/M4S(mp4), thumbnail(jpg)
+//====================================================================================================
+bool SegmentStream::GetSegment(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data)
+{
+    if (file_name == THUMBNAIL_FILE_NAME)
+        return GetThumbnail(segment_data);
+
+    if (_stream_packetyzer != nullptr)
+    {
+        return _stream_packetyzer->GetSegment(file_name, segment_data);
+    }
+
+    return false;
+}
+
 //====================================================================================================
-bool SegmentStream::GetSegment(const ov::String &file_name, std::shared_ptr<ov::Data> &data)
+// GetThumbnail
+// - JPEG of the latest key frame(decoded on the first request after the key frame)
+// - no-cache : revalidated by the ETag, which changes with the key frame
+//====================================================================================================
+bool SegmentStream::GetThumbnail(std::shared_ptr<SegmentData> &segment_data)
+{
+    if (_thumbnailer == nullptr)
+        return false;
+
+    auto thumbnail = _thumbnailer->GetThumbnail();
+
+    if (thumbnail == nullptr)
+        return false;
+
+    auto data = thumbnail->data;
+    ov::String file_name = THUMBNAIL_FILE_NAME;
+
+    segment_data = std::make_shared<SegmentData>(0, file_name, 0, 0, data);
+    segment_data->create_time = thumbnail->create_time;
+    segment_data->etag.Format("\"%llx-%llx\"",
+                              static_cast<unsigned long long>(_thumbnail_etag_prefix),
+                              static_cast<unsigned long long>(thumbnail->sequence));
+    segment_data->last_modified = Packetyzer::MakeHttpDateString(thumbnail->create_time);
+    segment_data->cache_control = "no-cache";
+
+    return true;
+}
+
+//====================================================================================================
+// WaitPlayList
+// - low latency blocking playlist reload
+//====================================================================================================
+PacketyzerWaitResult SegmentStream::WaitPlayList(int64_t sequence_number,
+                                                 int64_t part_index,
+                                                 const PacketyzerWaitCallback &callback)
 {
     if (_stream_packetyzer != nullptr)
     {
-        return _stream_packetyzer->GetSegment(file_name, data);
+        return _stream_packetyzer->WaitPlayList(sequence_number, part_index, callback);
+    }
+
+    return PacketyzerWaitResult::Available;
+}
+
+//====================================================================================================
+// WaitSegment
+// - low latency blocking segment request
+//====================================================================================================
+PacketyzerWaitResult SegmentStream::WaitSegment(const ov::String &file_name, const PacketyzerWaitCallback &callback)
+{
+    if (_stream_packetyzer != nullptr)
+    {
+        return _stream_packetyzer->WaitSegment(file_name, callback);
+    }
+
+    return PacketyzerWaitResult::Available;
+}
+
+//====================================================================================================
+// GetChunkedSegment
+// - low latency chunked transfer
+//====================================================================================================
+bool SegmentStream::GetChunkedSegment(const ov::String &file_name,
+                                      size_t offset,
+                                      std::vector<std::shared_ptr<const ov::Data>> &chunks,
+                                      bool &is_completed)
+{
+    if (_stream_packetyzer != nullptr)
+    {
+        return _stream_packetyzer->GetChunkedSegment(file_name, offset, chunks, is_completed);
     }
 
     return false;
-}
\ No newline at end of file
+}
+
+//====================================================================================================
+// WaitChunkedSegment
+// - low latency chunked transfer
+//====================================================================================================
+PacketyzerWaitResult SegmentStream::WaitChunkedSegment(const ov::String &file_name,
+                                                       size_t offset,
+                                                       const PacketyzerWaitCallback &callback)
+{
+    if (_stream_packetyzer != nullptr)
+    {
+        return _stream_packetyzer->WaitChunkedSegment(file_name, offset, callback);
+    }
+
+    return PacketyzerWaitResult::Available;
+}
+
+//====================================================================================================
+// GetSegmentTracks
+// - H264/H265 video and AAC audio of the segments(set by Start())
+//====================================================================================================
+void SegmentStream::GetSegmentTracks(std::shared_ptr<MediaTrack> &video_track, std::shared_ptr<MediaTrack> &audio_track) const
+{
+    video_track = nullptr;
+    audio_track = nullptr;
+
+    for (const auto &track_item : _media_tracks)
+    {
+        auto &track = track_item.second;
+
+        if (track->GetMediaType() == MediaType::Video && video_track == nullptr)
+            video_track = track;
+        else if (track->GetMediaType() == MediaType::Audio && audio_track == nullptr)
+            audio_track = track;
+    }
+}
+
+//====================================================================================================
+// GetVideoCodecString
+//====================================================================================================
+std::string SegmentStream::GetVideoCodecString()
+{
+    if (_stream_packetyzer != nullptr)
+    {
+        return _stream_packetyzer->GetVideoCodecString();
+    }
+
+    return "";
+}
@@ -11,7 +11,9 @@
 
 #include "base/common_types.h"
 #include "base/publisher/stream.h"
+#include "base/application/stream_key_frame_advisory.h"
 #include "stream_packetyzer.h"
+#include "segment_thumbnailer.h"
 #include <map>
 
 //====================================================================================================
@@ -26,22 +28,58 @@ public:
 
 public :
     void SendVideoFrame(std::shared_ptr<MediaTrack> track,
-                        std::unique_ptr<EncodedFrame> encoded_frame,
-                        std::unique_ptr<CodecSpecificInfo> codec_info,
-                        std::unique_ptr<FragmentationHeader> fragmentation) override;
+                        std::unique_ptr<EncodedFrameDescriptor> frame) override;
 
     void SendAudioFrame(std::shared_ptr<MediaTrack> track,
-                        std::unique_ptr<EncodedFrame> encoded_frame,
-                        std::unique_ptr<CodecSpecificInfo> codec_info,
-                        std::unique_ptr<FragmentationHeader> fragmentation) override;
+                        std::unique_ptr<EncodedFrameDescriptor> frame) override;
 
     bool Start(int segment_count, int segment_duration, uint32_t worker_count);
 
     bool Stop() override;
 
-    bool GetPlayList(ov::String &play_list);
+    // byte(0 : unlimited), must be called before Start()
+    void SetSegmentMemoryLimit(uint64_t limit);
 
-    bool GetSegment(const ov::String &file_name, std::shared_ptr<ov::Data> &data);
+    // byte of the stored segments
+    size_t GetStoreMemoryUsage() override;
+
+    // second(0 : disabled), must be called before Start()
+    void SetDvr(const ov::String &path, uint64_t window_duration);
+
+    // width(0 : width of the stream), must be called before Start()
+    void SetThumbnail(bool enabled, uint32_t width);
+
+    // millisecond(0 : the first key frame after the segment duration), must be called before Start()
+    void SetSegmentTolerance(uint32_t tolerance);
+
+    // shared by the streams of the application(nullptr : disabled), must be called before Start()
+    void SetUploader(const std::shared_ptr<SegmentUploader> &uploader);
+
+    bool GetPlayList(std::shared_ptr<const PlayListSnapshot> &play_list);
+
+    bool GetPlayList(const ov::String &file_name, std::shared_ptr<const PlayListSnapshot> &play_list);
+
+    bool GetSegment(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data);
+
+    // JPEG of the latest key frame(THUMBNAIL_FILE_NAME)
+    bool GetThumbnail(std::shared_ptr<SegmentData> &segment_data);
+
+    PacketyzerWaitResult WaitPlayList(int64_t sequence_number, int64_t part_index, const PacketyzerWaitCallback &callback);
+
+    PacketyzerWaitResult WaitSegment(const ov::String &file_name, const PacketyzerWaitCallback &callback);
+
+    bool GetChunkedSegment(const ov::String &file_name,
+                           size_t offset,
+                           std::vector<std::shared_ptr<const ov::Data>> &chunks,
+                           bool &is_completed);
+
+    PacketyzerWaitResult WaitChunkedSegment(const ov::String &file_name, size_t offset, const PacketyzerWaitCallback &callback);
+
+    // tracks of the segments(nullptr : no track)
+    void GetSegmentTracks(std::shared_ptr<MediaTrack> &video_track, std::shared_ptr<MediaTrack> &audio_track) const;
+
+    // codecs of the video(empty : unknown)
+    std::string GetVideoCodecString();
 
     virtual std::shared_ptr<StreamPacketyzer> CreateStreamPacketyzer(int segment_count,
                                                                     int segment_duration,
@@ -49,9 +87,28 @@ public :
                                                                     PacketyzerStreamType stream_type,
                                                                     PacketyzerMediaInfo media_info) = 0;
 
+protected :
+    const std::shared_ptr<StreamPacketyzer> &GetStreamPacketyzer() const
+    {
+        return _stream_packetyzer;
+    }
+
 private :
     std::shared_ptr<StreamPacketyzer> _stream_packetyzer = nullptr;
     std::map<uint32_t, std::shared_ptr<MediaTrack>> _media_tracks;
+    uint64_t _segment_memory_limit = 0;
+    ov::String _dvr_path;
+    uint64_t _dvr_window_duration = 0;
+    bool _thumbnail_enabled = false;
+    uint32_t _thumbnail_width = 0;
+    uint32_t _segment_tolerance = 0;
+    std::shared_ptr<SegmentUploader> _uploader = nullptr;
+    // key frame interval asked to the transcoder(segment duration, millisecond)
+    std::shared_ptr<StreamKeyFrameAdvice> _key_frame_advice = nullptr;
+    int64_t _key_frame_advice_interval = 0;
+    std::unique_ptr<SegmentThumbnailer> _thumbnailer = nullptr;
+    // changes when the stream is recreated(same as the segments)
+    uint64_t _thumbnail_etag_prefix = 0;
 };
 
 
@@ -38,6 +38,16 @@ void SegmentStreamInterceptor::Start(int thread_count, const SegmentProcessHandl
     _worker_manager.Start(thread_count, process_handler);
 }
 
+//====================================================================================================
+// ResumeWork
+// - (add thread) --> (SegmentStreamServer::ProcessRequest) function call without waiting
+//====================================================================================================
+void SegmentStreamInterceptor::ResumeWork(const std::shared_ptr<HttpRequest> &request,
+                                          const std::shared_ptr<HttpResponse> &response)
+{
+    _worker_manager.AddWork(request, response, true);
+}
+
 //====================================================================================================
 // OnHttpData
 // - (add thread) --> (SegmentStreamServer::ProcessRequest) function call
@@ -24,6 +24,9 @@ public:
 public:
     void Start(int thread_count, const SegmentProcessHandler &process_handler);
 
+    // Blocking request(low latency) is processed again
+    void ResumeWork(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response);
+
 	bool OnHttpData(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response, const std::shared_ptr<const ov::Data> &data) override;
 
     void SetCrossdomainBlock() { _is_crossdomain_block = false; }
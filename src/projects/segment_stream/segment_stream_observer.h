@@ -24,11 +24,57 @@ public:
     OnPlayListRequest(const ov::String &app_name,
                     const ov::String &stream_name,
                     const ov::String &file_name,
-                    ov::String &play_list) = 0;
+                    std::shared_ptr<const PlayListSnapshot> &play_list) = 0;
 
     // Segment 요청
     virtual bool OnSegmentRequest(const ov::String &app_name,
                                 const ov::String &stream_name,
                                 const ov::String &file_name,
-                                std::shared_ptr<ov::Data> &segment_data) = 0;
+                                std::shared_ptr<SegmentData> &segment_data) = 0;
+
+    // Low latency blocking PlayList 요청
+    // - sequence number -1 : request coalescing(held until the playlist is ready)
+    // - Waiting : callback is called when the playlist is updated(or timeout)
+    virtual PacketyzerWaitResult OnPlayListWaitRequest(const ov::String &app_name,
+                                                       const ov::String &stream_name,
+                                                       const ov::String &file_name,
+                                                       int64_t sequence_number,
+                                                       int64_t part_index,
+                                                       const PacketyzerWaitCallback &callback)
+    {
+        return PacketyzerWaitResult::Available;
+    }
+
+    // Low latency blocking Segment 요청
+    // - the requests of the segment being made are coalesced(released together when it is stored)
+    virtual PacketyzerWaitResult OnSegmentWaitRequest(const ov::String &app_name,
+                                                      const ov::String &stream_name,
+                                                      const ov::String &file_name,
+                                                      const PacketyzerWaitCallback &callback)
+    {
+        return PacketyzerWaitResult::Available;
+    }
+
+    // Low latency chunked Segment 요청
+    // - false : chunked transfer is not supported(or the segment is not found)
+    virtual bool OnChunkedSegmentRequest(const ov::String &app_name,
+                                         const ov::String &stream_name,
+                                         const ov::String &file_name,
+                                         size_t offset,
+                                         std::vector<std::shared_ptr<const ov::Data>> &chunks,
+                                         bool &is_completed)
+    {
+        return false;
+    }
+
+    // Low latency chunked Segment 대기
+    // - Waiting : callback is called when the next chunk is written(or the segment is completed)
+    virtual PacketyzerWaitResult OnChunkedSegmentWaitRequest(const ov::String &app_name,
+                                                             const ov::String &stream_name,
+                                                             const ov::String &file_name,
+                                                             size_t offset,
+                                                             const PacketyzerWaitCallback &callback)
+    {
+        return PacketyzerWaitResult::Available;
+    }
 };
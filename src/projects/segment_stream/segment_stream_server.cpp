@@ -10,6 +10,7 @@
 #include "segment_stream_server.h"
 #include <sstream>
 #include <regex>
+#include <ctime>
 #include "segment_stream_private.h"
 
 SegmentStreamServer::SegmentStreamServer()
@@ -50,10 +51,12 @@ bool SegmentStreamServer::Start(const ov::SocketAddress &address,
                                      std::placeholders::_1,
                                      std::placeholders::_2,
                                      std::placeholders::_3,
-                                     std::placeholders::_4);
+                                     std::placeholders::_4,
+                                     std::placeholders::_5);
 
     auto segment_stream_interceptor = CreateInterceptor();
     segment_stream_interceptor->Start(thread_count, process_handler);
+    _interceptor = segment_stream_interceptor;
 
 //    auto process_func = std::bind(&SegmentStreamServer::ProcessRequest,
 //                                this,
@@ -71,6 +74,7 @@ bool SegmentStreamServer::Start(const ov::SocketAddress &address,
         segment_stream_interceptor->SetCrossdomainBlock();
         http_server->AddInterceptor(segment_stream_interceptor);
         _http_server = http_server;
+        _is_http_server_owner = false;
 
         return true;
     }
@@ -82,6 +86,8 @@ bool SegmentStreamServer::Start(const ov::SocketAddress &address,
         https_server->SetLocalCertificate(certificate);
         https_server->SetChainCertificate(chain_certificate);
         https_server->SetTlsWriteToResponse(true);
+        // The publishers which share the port use the setting of the first one
+        https_server->SetHttp2Enabled(_http2_enabled);
         _http_server = https_server;
     }
     else
@@ -90,6 +96,10 @@ bool SegmentStreamServer::Start(const ov::SocketAddress &address,
     }
 
     http_server_manager[address.Port()] = _http_server;
+    _is_http_server_owner = true;
+
+    // The publishers which share the port use the setting of the first one
+    _http_server->SetMaxPacingRate(_max_pacing_rate);
 
     _http_server->AddInterceptor(segment_stream_interceptor);
 
@@ -102,7 +112,25 @@ bool SegmentStreamServer::Start(const ov::SocketAddress &address,
 //====================================================================================================
 bool SegmentStreamServer::Stop()
 {
-    return false;
+    if (_http_server == nullptr)
+    {
+        return false;
+    }
+
+    _http_server->RemoveInterceptor(_interceptor);
+
+    // The workers are stopped by the destructor of the interceptor
+    _interceptor = nullptr;
+
+    // The shared server is stopped by the publisher which started it
+    if (_is_http_server_owner)
+    {
+        _http_server->Stop();
+    }
+
+    _http_server = nullptr;
+
+    return true;
 }
 
 //====================================================================================================
@@ -178,51 +206,36 @@ bool SegmentStreamServer::RequestUrlParsing(const ov::String &request_url,
                                             ov::String &file_name,
                                             ov::String &file_ext)
 {
-    ov::String request_path;
-    ov::String request_param;
+    // 토큰은 request_url을 참조함 (결과만 복사)
+    ov::StringView url(request_url);
 
     // 확장자 확인
     // 파라메터 분리  directory/file.ext?param=test
-    auto tokens = request_url.Split("?");
-    if (tokens.size() == 0) {
-        return false;
-    }
+    auto tokens = url.Split("?");
 
-    request_path = tokens[0];
-    request_param = tokens.size() == 2 ? tokens[1] : "";
+    ov::StringView request_path = tokens[0];
 
     // ...../app_name/stream_name/file_name.ext_name 분리
-    tokens.clear();
     tokens = request_path.Split("/");
 
     if (tokens.size() < 3) {
         return false;
     }
 
-    app_name = tokens[tokens.size() - 3];
-    stream_name = tokens[tokens.size() - 2];
-    file_name = tokens[tokens.size() - 1];
+    ov::StringView name = tokens[tokens.size() - 1];
+
+    app_name = tokens[tokens.size() - 3].ToString();
+    stream_name = tokens[tokens.size() - 2].ToString();
+    file_name = name.ToString();
 
     // file_name.ext_name 분리
-    tokens.clear();
-    tokens = file_name.Split(".");
+    tokens = name.Split(".");
 
     if (tokens.size() != 2) {
         return false;
     }
 
-    file_ext = tokens[1];
-
-    /*
-    logtd("request : %s\n"\
-         "request path : %s\n"\
-         "request param : %s\n"\
-         "app name : %s\n"\
-         "stream name : %s\n"\
-         "file name : %s\n"\
-         "file ext : %s\n",
-          request_url.CStr(), request_path.CStr(), request_param.CStr(),  app_name.CStr(), stream_name.CStr(), file_name.CStr(),file_ext.CStr());
-    */
+    file_ext = tokens[1].ToString();
 
     return true;
 }
@@ -234,11 +247,15 @@ bool SegmentStreamServer::RequestUrlParsing(const ov::String &request_url,
 bool SegmentStreamServer::ProcessRequest(const std::shared_ptr<HttpRequest> &request,
                                          const std::shared_ptr<HttpResponse> &response,
                                          int retry_count,
+                                         bool is_resumed,
                                          bool &is_retry)
 {
     // prcess
     if(retry_count == 0)
     {
+        // HTTP/1.1 persistent connection
+        response->SetKeepAlive(_http_server->IsKeepAliveEnabled() && request->IsKeepAlive());
+
         do
         {
             ov::String app_name;
@@ -246,6 +263,13 @@ bool SegmentStreamServer::ProcessRequest(const std::shared_ptr<HttpRequest> &req
             ov::String file_name;
             ov::String file_ext;
 
+            // Low latency chunked transfer : the next chunks(header is already sent)
+            if (response->IsChunkedTransfer())
+            {
+                ContinueChunkedTransfer(request, response);
+                break;
+            }
+
             // Crossdomain 확인
             if (request->GetRequestTarget().IndexOf("crossdomain.xml") >= 0)
             {
@@ -278,6 +302,24 @@ bool SegmentStreamServer::ProcessRequest(const std::shared_ptr<HttpRequest> &req
                 break;
             }
 
+            // Low latency blocking request
+            // - the worker thread is not blocked, the request is resumed by the packetyzer(or timeout)
+            // - resumed request is responded with the current data
+            if (!is_resumed)
+            {
+                auto wait_result = WaitRequest(request, response, app_name, stream_name, file_name, file_ext);
+
+                if (wait_result == PacketyzerWaitResult::Waiting)
+                {
+                    return true;
+                }
+                else if (wait_result == PacketyzerWaitResult::Invalid)
+                {
+                    response->SetStatusCode(HttpStatusCode::BadRequest);
+                    break;
+                }
+            }
+
             ProcessRequestStream(request, response, app_name, stream_name, file_name, file_ext);
 
         }while(false);
@@ -286,6 +328,10 @@ bool SegmentStreamServer::ProcessRequest(const std::shared_ptr<HttpRequest> &req
     // response
     ssize_t sent = response->Response(is_retry);
 
+    // the whole segment has been queued to the socket(recorded when the socket has sent it)
+    if(!is_retry && sent >= 0 && !response->IsChunkedTransfer())
+        RecordSegmentQoe(request, response);
+
     if(is_retry)
     {
         logtd("Segment response result is retry - url(%s) retry(%d/max:%d) send(%u)",
@@ -298,13 +344,38 @@ bool SegmentStreamServer::ProcessRequest(const std::shared_ptr<HttpRequest> &req
     // disconnect
     if(!is_retry || retry_count >= _max_retry_count)
     {
-        _http_server->Disconnect(request->GetRemote());
+        // Low latency chunked transfer : the connection is kept until the last chunk is sent
+        if(!is_retry && sent >= 0 && response->IsChunkedTransfer() && !response->IsLastChunkAppended())
+        {
+            WaitChunkedTransfer(request, response);
+            return true;
+        }
+
+        // keep-alive : the connection waits for the next request
+        if(!is_retry && sent >= 0)
+            _http_server->FinishResponse(request, response);
+        else
+            _http_server->Disconnect(request->GetRemote());
+
         is_retry = false;
     }
 
     return true;
 }
 
+//====================================================================================================
+// ResumeRequest
+// - called by the packetyzer when the blocking request is available(or timeout)
+//====================================================================================================
+void SegmentStreamServer::ResumeRequest(const std::shared_ptr<HttpRequest> &request,
+                                        const std::shared_ptr<HttpResponse> &response)
+{
+    if (_interceptor != nullptr)
+    {
+        _interceptor->ResumeWork(request, response);
+    }
+}
+
 //====================================================================================================
 // SetOriginUrl
 //====================================================================================================
@@ -343,14 +414,22 @@ bool SegmentStreamServer::SetAllowOrigin(const ov::String &origin_url, const std
 //====================================================================================================
 // PlayListRequest
 // - m3u8/mpd
+// - NotModified : the playlist is not updated since the request(If-None-Match/If-Modified-Since)
 //====================================================================================================
 void SegmentStreamServer::PlayListRequest(const ov::String &app_name,
                                           const ov::String &stream_name,
                                           const ov::String &file_name,
                                           PlayListType play_list_type,
+                                          const std::shared_ptr<HttpRequest> &request,
                                           const std::shared_ptr<HttpResponse> &response)
 {
-    ov::String play_list;
+    // Draining: the players are moved to the other nodes gradually (the segments are still served)
+    if (MoveDrainingPlayer(request, response))
+    {
+        return;
+    }
+
+    std::shared_ptr<const PlayListSnapshot> play_list = nullptr;
 
     auto item = std::find_if(_observers.begin(), _observers.end(),
                              [&app_name, &stream_name, &file_name, &play_list](
@@ -358,7 +437,7 @@ void SegmentStreamServer::PlayListRequest(const ov::String &app_name,
                                  return observer->OnPlayListRequest(app_name, stream_name, file_name, play_list);
                              });
 
-    if (item == _observers.end() || play_list.IsEmpty())
+    if (item == _observers.end() || play_list == nullptr || play_list->data->GetLength() == 0)
     {
         logtd("PlayList Serarch Fail : %s/%s/%s", app_name.CStr(), stream_name.CStr(), file_name.CStr());
         response->SetStatusCode(HttpStatusCode::NotFound);
@@ -368,13 +447,73 @@ void SegmentStreamServer::PlayListRequest(const ov::String &app_name,
     // header setting
     if (play_list_type == PlayListType::M3u8) response->SetHeader("Content-Type", "application/x-mpegURL");
     else if (play_list_type == PlayListType::Mpd) response->SetHeader("Content-Type", "application/dash+xml");
-    //response->SetHeader("Content-Length", ov::Converter::ToString(play_list.GetLength()).CStr());
 
-    response->SetHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-    response->SetHeader("Pragma", "no-cache");
-    response->SetHeader("Expires", "0");
+    response->SetHeader("Cache-Control", play_list->cache_control);
+    response->SetHeader("ETag", play_list->etag);
+    response->SetHeader("Last-Modified", play_list->last_modified);
+
+    // not changed since the last request
+    if (IsNotModified(request, play_list->etag, play_list->create_time, false))
+    {
+        response->SetStatusCode(HttpStatusCode::NotModified);
+        return;
+    }
+
+    response->SetHeader("Content-Length", play_list->content_length);
 
-    response->AppendString(play_list);
+    // snapshot data is shared(no copy)
+    response->AppendData(play_list->data);
+}
+
+//====================================================================================================
+// MoveDrainingPlayer
+// - redirect(RedirectUrl of <Drain>) or 503 with Retry-After
+// - the address of the player is the key, so a moved player keeps being moved
+//====================================================================================================
+bool SegmentStreamServer::MoveDrainingPlayer(const std::shared_ptr<HttpRequest> &request,
+                                             const std::shared_ptr<HttpResponse> &response)
+{
+    auto drain_mode = ov::DrainMode::Instance();
+
+    if (drain_mode->IsDraining() == false)
+    {
+        return false;
+    }
+
+    auto remote = request->GetRemote();
+    auto remote_address = (remote != nullptr) ? remote->GetRemoteAddress() : nullptr;
+    ov::String address = (remote_address != nullptr) ? remote_address->GetIpAddress() : "";
+
+    if (drain_mode->ShouldMove(std::hash<std::string>()(address.CStr())) == false)
+    {
+        return false;
+    }
+
+    const auto &config = drain_mode->GetConfig();
+
+    if (config.redirect_url.empty() == false)
+    {
+        ov::String url = config.redirect_url.c_str();
+
+        if (url.HasSuffix("/"))
+        {
+            url = url.Substring(0, url.GetLength() - 1);
+        }
+
+        url.Append(request->GetRequestTarget());
+
+        response->SetStatusCode(HttpStatusCode::TemporaryRedirect);
+        response->SetHeader("Location", url);
+    }
+    else
+    {
+        response->SetStatusCode(HttpStatusCode::ServiceUnavailable);
+        response->SetHeader("Retry-After", ov::Converter::ToString(config.retry_after));
+    }
+
+    response->SetHeader("Cache-Control", "no-cache");
+
+    return true;
 }
 
 //====================================================================================================
@@ -385,9 +524,31 @@ void SegmentStreamServer::SegmentRequest(const ov::String &app_name,
                                          const ov::String &stream_name,
                                          const ov::String &file_name,
                                          SegmentType segment_type,
+                                         const std::shared_ptr<HttpRequest> &request,
                                          const std::shared_ptr<HttpResponse> &response)
 {
-    std::shared_ptr<ov::Data> segment_data = nullptr;
+    std::shared_ptr<SegmentData> segment_data = nullptr;
+    int64_t start_time = ov::LatencyHistogram::GetCurrentMicroseconds();
+
+    // header setting
+    auto set_content_type = [&]()
+    {
+        if (segment_type == SegmentType::MpegTs)
+            response->SetHeader("Content-Type", "video/MP2T");
+        else if (segment_type == SegmentType::M4S && file_name.HasSuffix(MPD_VIDEO_SUFFIX))
+            response->SetHeader("Content-Type", "video/mp4");
+        else if (segment_type == SegmentType::M4S && file_name.HasSuffix(MPD_AUDIO_SUFFIX))
+            response->SetHeader("Content-Type", "audio/mp4");
+        else if (segment_type == SegmentType::Thumbnail)
+            response->SetHeader("Content-Type", "image/jpeg");
+    };
+
+    // Low latency chunked transfer
+    if (ChunkedSegmentRequest(app_name, stream_name, file_name, response))
+    {
+        set_content_type();
+        return;
+    }
 
     auto item = std::find_if(_observers.begin(), _observers.end(),
                              [&app_name, &stream_name, &file_name, &segment_data](
@@ -402,17 +563,370 @@ void SegmentStreamServer::SegmentRequest(const ov::String &app_name,
         return;
     }
 
-    // header setting
-    if (segment_type == SegmentType::MpegTs)
-        response->SetHeader("Content-Type", "video/MP2T");
-    else if (segment_type == SegmentType::M4S && file_name.HasSuffix(MPD_VIDEO_SUFFIX))
-        response->SetHeader("Content-Type", "video/mp4");
-    else if (segment_type == SegmentType::M4S && file_name.HasSuffix(MPD_AUDIO_SUFFIX))
-        response->SetHeader("Content-Type", "audio/mp4");
+    uint64_t size = segment_data->data->GetLength();
+
+    for (const auto &gather_data : segment_data->gather_datas)
+        size += gather_data->GetLength();
+
+    uint64_t start = segment_data->window_offset;
+    uint64_t begin = start;
+    uint64_t end = start + size;
+    bool is_satisfiable = true;
+    bool is_range = (segment_type != SegmentType::Thumbnail) && request->IsHeaderExists("Range") &&
+                    ParseRange(request->GetHeader("Range"), start, size, begin, end, is_satisfiable);
+
+    // immutable(the thumbnail changes with the key frame)
+    // - growing window file : the ranges are immutable, the whole file is not
+    response->SetHeader("Cache-Control", (segment_data->is_growing && !is_range) ? "no-cache" : segment_data->cache_control.CStr());
+    response->SetHeader("ETag", segment_data->etag);
+    response->SetHeader("Last-Modified", segment_data->last_modified);
+
+    if (segment_type != SegmentType::Thumbnail)
+        response->SetHeader("Accept-Ranges", "bytes");
+
+    if (IsNotModified(request, segment_data->etag, segment_data->create_time, segment_type != SegmentType::Thumbnail))
+    {
+        response->SetStatusCode(HttpStatusCode::NotModified);
+        return;
+    }
+
+    // the complete length is unknown while the window file grows
+    ov::String complete_length = segment_data->is_growing ? "*" : ov::Converter::ToString(start + size);
+
+    if (is_range && !is_satisfiable)
+    {
+        response->SetHeader("Content-Range", ov::String::FormatString("bytes */%s", complete_length.CStr()));
+        response->SetStatusCode(HttpStatusCode::RangeNotSatisfiable);
+        return;
+    }
+
+    // the evicted head of the window file
+    if ((is_range && begin < start) || (!is_range && start > 0))
+    {
+        logtd("Segment Range Evicted : %s/%s/%s", app_name.CStr(), stream_name.CStr(), file_name.CStr());
+        response->SetStatusCode(HttpStatusCode::NotFound);
+        return;
+    }
+
+    set_content_type();
 
     //response->SetHeader("Content-Length", ov::Converter::ToString(segment_data->GetLength()).CStr());
 
-    response->AppendData(segment_data);
+    if (segment_type != SegmentType::Thumbnail)
+        SetSegmentQoeRequest(app_name, stream_name, file_name, segment_data, start_time, request);
+
+    if (!is_range)
+    {
+        response->AppendData(segment_data->data);
+
+        for (const auto &gather_data : segment_data->gather_datas)
+            response->AppendData(gather_data);
+
+        return;
+    }
+
+    response->SetStatusCode(HttpStatusCode::PartialContent);
+    response->SetHeader("Content-Range", ov::String::FormatString("bytes %llu-%llu/%s",
+                                                                  static_cast<unsigned long long>(begin),
+                                                                  static_cast<unsigned long long>(end - 1),
+                                                                  complete_length.CStr()));
+
+    // the parts of the buffers in the range(not copied)
+    uint64_t position = start;
+
+    auto append_range = [&](const std::shared_ptr<const ov::Data> &data)
+    {
+        uint64_t data_begin = std::max(begin, position);
+        uint64_t data_end = std::min(end, position + data->GetLength());
+
+        if (data_begin < data_end)
+            response->AppendData(data->Subdata(static_cast<off_t>(data_begin - position), static_cast<size_t>(data_end - data_begin)));
+
+        position += data->GetLength();
+    };
+
+    append_range(segment_data->data);
+
+    for (const auto &gather_data : segment_data->gather_datas)
+        append_range(gather_data);
+}
+
+//====================================================================================================
+// SetSegmentQoeRequest
+// - all the requests feed the histograms of the stream, the players are sampled by StreamQoeStatistics
+// - the rebuffer is estimated by the video segments(the duration of the audio segments of DASH is not in
+//   PACKTYZER_DEFAULT_TIMESCALE), the byte range window files are not counted either(the ranges are the segments)
+//====================================================================================================
+void SegmentStreamServer::SetSegmentQoeRequest(const ov::String &app_name,
+                                               const ov::String &stream_name,
+                                               const ov::String &file_name,
+                                               const std::shared_ptr<SegmentData> &segment_data,
+                                               int64_t start_time,
+                                               const std::shared_ptr<HttpRequest> &request)
+{
+    auto statistics = StreamQoe::Instance()->FindStatistics(app_name, stream_name);
+
+    if (statistics == nullptr)
+        return;
+
+    auto remote = request->GetRemote();
+    auto remote_address = (remote != nullptr) ? remote->GetRemoteAddress() : nullptr;
+
+    if (remote_address == nullptr)
+        return;
+
+    auto qoe_request = std::make_shared<SegmentQoeRequest>();
+
+    qoe_request->statistics = statistics;
+    qoe_request->player = remote_address->GetIpAddress();
+    qoe_request->segment = file_name;
+    qoe_request->start_time = start_time;
+
+    if (!file_name.HasSuffix(MPD_AUDIO_SUFFIX) && segment_data->window_file_name != file_name)
+        qoe_request->duration = static_cast<int64_t>(segment_data->duration * 1000000 / PACKTYZER_DEFAULT_TIMESCALE);
+
+    request->SetExtra(qoe_request);
+}
+
+//====================================================================================================
+// RecordSegmentQoe
+// - Response() only queues the segment to the socket, so the download time is recorded when the send queue
+//   of the socket has been drained up to the segment(not recorded if the data is discarded, e.g. disconnected)
+//====================================================================================================
+void SegmentStreamServer::RecordSegmentQoe(const std::shared_ptr<HttpRequest> &request,
+                                           const std::shared_ptr<HttpResponse> &response)
+{
+    auto qoe_request = request->GetExtraAs<SegmentQoeRequest>();
+    auto remote = response->GetRemote();
+
+    if (qoe_request == nullptr || remote == nullptr)
+        return;
+
+    request->SetExtra(nullptr);
+
+    const char *protocol = (GetPublisherType() == cfg::PublisherType::Dash) ? "dash" : "hls";
+
+    remote->NotifyWhenSent([qoe_request, protocol](bool is_sent) {
+        if (!is_sent)
+            return;
+
+        qoe_request->statistics->OnSegmentRequest(protocol,
+                                                  qoe_request->player,
+                                                  qoe_request->segment,
+                                                  qoe_request->duration,
+                                                  ov::LatencyHistogram::GetCurrentMicroseconds() - qoe_request->start_time);
+    });
+}
+
+//====================================================================================================
+// ParseRange
+// - bytes=first-last, bytes=first-, bytes=-suffix(the last bytes)
+// - the last byte position is limited to the end of the file
+//====================================================================================================
+bool SegmentStreamServer::ParseRange(const ov::String &range,
+                                     uint64_t start,
+                                     uint64_t size,
+                                     uint64_t &begin,
+                                     uint64_t &end,
+                                     bool &is_satisfiable)
+{
+    ov::String value = range.Trim();
+
+    if (!value.HasPrefix("bytes=") || value.IndexOf(",") >= 0)
+        return false;
+
+    value = value.Substring(6).Trim();
+
+    off_t separator = value.IndexOf("-");
+
+    if (separator < 0)
+        return false;
+
+    ov::String first = value.Substring(0, static_cast<size_t>(separator)).Trim();
+    ov::String last = value.Substring(separator + 1).Trim();
+    uint64_t file_end = start + size;
+
+    is_satisfiable = true;
+
+    if (first.IsEmpty())
+    {
+        if (last.IsEmpty())
+            return false;
+
+        uint64_t suffix_length = ov::Converter::ToUInt64(last);
+
+        if (suffix_length == 0)
+        {
+            is_satisfiable = false;
+            return true;
+        }
+
+        begin = (suffix_length < file_end) ? (file_end - suffix_length) : 0;
+        end = file_end;
+
+        return true;
+    }
+
+    begin = ov::Converter::ToUInt64(first);
+    end = last.IsEmpty() ? file_end : std::min(ov::Converter::ToUInt64(last) + 1, file_end);
+
+    if (!last.IsEmpty() && ov::Converter::ToUInt64(last) < begin)
+        return false;
+
+    is_satisfiable = (begin < file_end);
+
+    return true;
+}
+
+//====================================================================================================
+// IsNotModified
+// - RFC7232 : If-None-Match is evaluated instead of If-Modified-Since when both exist
+//====================================================================================================
+bool SegmentStreamServer::IsNotModified(const std::shared_ptr<HttpRequest> &request,
+                                        const ov::String &etag,
+                                        time_t last_modified,
+                                        bool is_immutable)
+{
+    if (request->IsHeaderExists("If-None-Match"))
+    {
+        // "a", W/"b", *
+        for (auto request_etag : request->GetHeader("If-None-Match").Split(","))
+        {
+            request_etag = request_etag.Trim();
+
+            if (request_etag.HasPrefix("W/"))
+                request_etag = request_etag.Substring(2);
+
+            if (request_etag == "*" || request_etag == etag)
+                return true;
+        }
+
+        return false;
+    }
+
+    if (request->IsHeaderExists("If-Modified-Since"))
+    {
+        // IMF-fixdate only(ex: Sun, 06 Nov 1994 08:49:37 GMT)
+        std::tm since_tm = {};
+
+        if (strptime(request->GetHeader("If-Modified-Since").CStr(), "%a, %d %b %Y %H:%M:%S GMT", &since_tm) == nullptr)
+            return false;
+
+        time_t since = timegm(&since_tm);
+
+        return is_immutable ? (last_modified <= since) : (last_modified < since);
+    }
+
+    return false;
+}
+
+//====================================================================================================
+// ChunkedSegmentRequest
+// - the first chunks of the segment(low latency)
+// - false : chunked transfer is not supported(or the segment is not found)
+//====================================================================================================
+bool SegmentStreamServer::ChunkedSegmentRequest(const ov::String &app_name,
+                                                const ov::String &stream_name,
+                                                const ov::String &file_name,
+                                                const std::shared_ptr<HttpResponse> &response)
+{
+    std::vector<std::shared_ptr<const ov::Data>> chunks;
+    bool is_completed = false;
+
+    auto item = std::find_if(_observers.begin(), _observers.end(),
+                             [&](auto &observer) -> bool {
+                                 return observer->OnChunkedSegmentRequest(app_name, stream_name, file_name, 0, chunks, is_completed);
+                             });
+
+    if (item == _observers.end())
+    {
+        return false;
+    }
+
+    response->SetChunkedTransfer();
+
+    for (const auto &chunk : chunks)
+    {
+        response->AppendChunk(chunk);
+    }
+
+    if (is_completed)
+    {
+        response->AppendLastChunk();
+    }
+
+    return true;
+}
+
+//====================================================================================================
+// ContinueChunkedTransfer
+// - the chunks written after the previous round
+// - no more chunk(timeout or stream deleted) : the transfer is terminated
+//====================================================================================================
+void SegmentStreamServer::ContinueChunkedTransfer(const std::shared_ptr<HttpRequest> &request,
+                                                  const std::shared_ptr<HttpResponse> &response)
+{
+    ov::String app_name;
+    ov::String stream_name;
+    ov::String file_name;
+    ov::String file_ext;
+    std::vector<std::shared_ptr<const ov::Data>> chunks;
+    bool is_completed = true;
+
+    if (RequestUrlParsing(request->GetRequestTarget(), app_name, stream_name, file_name, file_ext))
+    {
+        for (const auto &observer : _observers)
+        {
+            if (observer->OnChunkedSegmentRequest(app_name, stream_name, file_name,
+                                                  response->GetChunkedBodyLength(), chunks, is_completed))
+            {
+                break;
+            }
+        }
+    }
+
+    for (const auto &chunk : chunks)
+    {
+        response->AppendChunk(chunk);
+    }
+
+    if (is_completed || chunks.empty())
+    {
+        response->AppendLastChunk();
+    }
+}
+
+//====================================================================================================
+// WaitChunkedTransfer
+// - the request is resumed when the next chunk is written
+//====================================================================================================
+void SegmentStreamServer::WaitChunkedTransfer(const std::shared_ptr<HttpRequest> &request,
+                                              const std::shared_ptr<HttpResponse> &response)
+{
+    ov::String app_name;
+    ov::String stream_name;
+    ov::String file_name;
+    ov::String file_ext;
+
+    if (RequestUrlParsing(request->GetRequestTarget(), app_name, stream_name, file_name, file_ext))
+    {
+        auto callback = [this, request, response]()
+        {
+            ResumeRequest(request, response);
+        };
+
+        for (const auto &observer : _observers)
+        {
+            if (observer->OnChunkedSegmentWaitRequest(app_name, stream_name, file_name,
+                                                      response->GetChunkedBodyLength(), callback) == PacketyzerWaitResult::Waiting)
+            {
+                return;
+            }
+        }
+    }
+
+    // already available(or terminated)
+    ResumeRequest(request, response);
 }
 
 //====================================================================================================
@@ -17,6 +17,23 @@
 #include "http_server/interceptors/http_request_interceptors.h"
 #include "config/config_manager.h"
 #include "segment_stream_interceptor.h"
+#include "base/application/stream_qoe.h"
+
+//====================================================================================================
+// SegmentQoeRequest
+// - QoE of a segment request(HttpRequest extra), recorded when the socket has sent the whole segment to the kernel
+//====================================================================================================
+struct SegmentQoeRequest
+{
+    std::shared_ptr<StreamQoeStatistics> statistics;
+    // address of the player(the players behind a NAT are counted as one player)
+    ov::String player;
+    ov::String segment;
+    // microseconds of the media(0 : not counted for the rebuffer)
+    int64_t duration = 0;
+    // microseconds(ov::LatencyHistogram::GetCurrentMicroseconds)
+    int64_t start_time = 0;
+};
 
 //====================================================================================================
 // SegmentStreamServer
@@ -49,6 +66,18 @@ public :
 
     void SetCrossDomain(const std::vector<cfg::Url> &url_list);
 
+    // bps (0: unlimited), must be called before Start()
+    void SetMaxPacingRate(uint64_t rate)
+    {
+        _max_pacing_rate = rate;
+    }
+
+    // HTTP/2 of HTTPS (ALPN), must be called before Start()
+    void SetHttp2Enabled(bool http2_enabled)
+    {
+        _http2_enabled = http2_enabled;
+    }
+
     bool GetMonitoringCollectionData(std::vector<std::shared_ptr<MonitoringCollectionData>> &collections);
 
     virtual cfg::PublisherType GetPublisherType() = 0;
@@ -64,8 +93,25 @@ protected:
     bool ProcessRequest(const std::shared_ptr<HttpRequest> &request,
                         const std::shared_ptr<HttpResponse> &response,
                         int retry_count,
+                        bool is_resumed,
                         bool &is_retry);
 
+    // Blocking request(low latency) is processed again by the worker thread
+    void ResumeRequest(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response);
+
+    // Low latency blocking request/request coalescing check
+    // - Waiting : the request is held(not responded) until ResumeRequest() is called
+    // - Invalid : 400 Bad Request
+    virtual PacketyzerWaitResult WaitRequest(const std::shared_ptr<HttpRequest> &request,
+                                             const std::shared_ptr<HttpResponse> &response,
+                                             const ov::String &app_name,
+                                             const ov::String &stream_name,
+                                             const ov::String &file_name,
+                                             const ov::String &file_ext)
+    {
+        return PacketyzerWaitResult::Available;
+    }
+
     virtual void ProcessRequestStream(const std::shared_ptr<HttpRequest> &request,
                                    const std::shared_ptr<HttpResponse> &response,
                                    const ov::String &app_name,
@@ -75,26 +121,77 @@ protected:
 
     bool SetAllowOrigin(const ov::String &origin_url, const std::shared_ptr<HttpResponse> &response);
 
+    // Returns true if the player is moved to another node while draining (the response is prepared)
+    bool MoveDrainingPlayer(const std::shared_ptr<HttpRequest> &request,
+                            const std::shared_ptr<HttpResponse> &response);
+
     void PlayListRequest(const ov::String &app_name,
                          const ov::String &stream_name,
                          const ov::String &file_name,
                          PlayListType play_list_type,
+                         const std::shared_ptr<HttpRequest> &request,
                          const std::shared_ptr<HttpResponse> &response);
 
     void SegmentRequest(const ov::String &app_name,
                         const ov::String &stream_name,
                         const ov::String &file_name,
                         SegmentType segment_type,
+                        const std::shared_ptr<HttpRequest> &request,
                         const std::shared_ptr<HttpResponse> &response);
 
+    // Range request(RFC7233, single byte range)
+    // - representation : [start, start + size) of the file(start > 0 : the head of the window file is evicted)
+    // - [begin, end) of the range, false : no Range header(or not a single byte range, the whole file is responded)
+    static bool ParseRange(const ov::String &range,
+                           uint64_t start,
+                           uint64_t size,
+                           uint64_t &begin,
+                           uint64_t &end,
+                           bool &is_satisfiable);
+
+    // Conditional request(If-None-Match/If-Modified-Since)
+    // - immutable : not modified when Last-Modified <= If-Modified-Since
+    //   (otherwise Last-Modified < If-Modified-Since, the playlist can be updated several times in a second)
+    bool IsNotModified(const std::shared_ptr<HttpRequest> &request,
+                       const ov::String &etag,
+                       time_t last_modified,
+                       bool is_immutable);
+
+    // Low latency chunked transfer
+    // - the segment being written is sent chunk by chunk(Transfer-Encoding: chunked)
+    bool ChunkedSegmentRequest(const ov::String &app_name,
+                               const ov::String &stream_name,
+                               const ov::String &file_name,
+                               const std::shared_ptr<HttpResponse> &response);
+
+    void ContinueChunkedTransfer(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response);
+
+    void WaitChunkedTransfer(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response);
+
     bool UrlExistCheck(const std::vector<ov::String> &url_list, const ov::String &check_url);
 
+    // QoE of the segment(not recorded if the stream doesn't have the statistics)
+    void SetSegmentQoeRequest(const ov::String &app_name,
+                              const ov::String &stream_name,
+                              const ov::String &file_name,
+                              const std::shared_ptr<SegmentData> &segment_data,
+                              int64_t start_time,
+                              const std::shared_ptr<HttpRequest> &request);
+
+    void RecordSegmentQoe(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response);
+
 protected :
     ov::String _app_name;
     std::shared_ptr<HttpServer> _http_server;
+    std::shared_ptr<SegmentStreamInterceptor> _interceptor;
     std::vector<std::shared_ptr<SegmentStreamObserver>> _observers;
     std::vector<ov::String> _cors_urls;  // key : url  value : flag(hls/dash allow flag)
     ov::String _cross_domain_xml;
 
     int _max_retry_count = 3;
+    uint64_t _max_pacing_rate = 0;
+    bool _http2_enabled = false;
+
+    // false: the server is shared with another publisher of the same port
+    bool _is_http_server_owner = false;
 };
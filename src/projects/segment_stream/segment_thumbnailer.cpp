@@ -0,0 +1,227 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#include "segment_thumbnailer.h"
+#include "segment_stream_private.h"
+
+#include <transcode/codec/transcode_decoder.h>
+
+extern "C"
+{
+#include <libswscale/swscale.h>
+}
+
+// RecvBuffer() calls : the packet, the flush of the parser/codec and the delayed frames
+#define THUMBNAIL_MAX_DECODE_COUNT      16
+
+using namespace common;
+
+//====================================================================================================
+// SegmentThumbnailer
+//====================================================================================================
+SegmentThumbnailer::SegmentThumbnailer(MediaCodecId codec_id, uint32_t width)
+                                      : _codec_id(codec_id), _width(width)
+{
+
+}
+
+//====================================================================================================
+// AppendVideoFrame
+// - the reference of the key frame is kept(no copy), the cached image becomes stale
+//====================================================================================================
+void SegmentThumbnailer::AppendVideoFrame(const EncodedFrame &encoded_frame)
+{
+    if (encoded_frame._frame_type != FrameType::VideoFrameKey || encoded_frame._buffer == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock_guard(_key_frame_mutex);
+
+    _key_frame = encoded_frame._buffer;
+    _key_frame_timestamp = encoded_frame._time_stamp;
+    _key_frame_sequence++;
+}
+
+//====================================================================================================
+// GetThumbnail
+// - the latest key frame is decoded only if its image is not made yet
+//====================================================================================================
+std::shared_ptr<const SegmentThumbnail> SegmentThumbnailer::GetThumbnail()
+{
+    // the other requests wait here while the first one decodes the key frame
+    std::lock_guard<std::mutex> thumbnail_lock(_thumbnail_mutex);
+
+    std::shared_ptr<ov::Data> key_frame;
+    int64_t timestamp = 0;
+    uint64_t sequence = 0;
+    {
+        std::lock_guard<std::mutex> key_frame_lock(_key_frame_mutex);
+
+        key_frame = _key_frame;
+        timestamp = _key_frame_timestamp;
+        sequence = _key_frame_sequence;
+    }
+
+    if (key_frame == nullptr)
+        return nullptr;
+
+    if (_thumbnail != nullptr && _thumbnail->sequence == sequence)
+        return _thumbnail;
+
+    // not retried until the next key frame
+    if (_failed_sequence == sequence)
+        return _thumbnail;
+
+    std::shared_ptr<void> picture;
+    std::shared_ptr<ov::Data> image;
+
+    if (Decode(key_frame, timestamp, picture))
+        image = Encode(static_cast<const AVFrame *>(picture.get()));
+
+    if (image == nullptr)
+    {
+        logtw("Could not make the thumbnail of the key frame(%lld)", static_cast<long long>(timestamp));
+
+        // the previous image is served until the next key frame
+        _failed_sequence = sequence;
+        return _thumbnail;
+    }
+
+    auto thumbnail = std::make_shared<SegmentThumbnail>();
+
+    thumbnail->data = image;
+    thumbnail->sequence = sequence;
+    thumbnail->create_time = time(nullptr);
+
+    _thumbnail = thumbnail;
+
+    return _thumbnail;
+}
+
+//====================================================================================================
+// Decode
+// - a decoder per key frame : the end of stream is sent after the key frame to get the picture without the next frame
+//====================================================================================================
+bool SegmentThumbnailer::Decode(const std::shared_ptr<ov::Data> &key_frame, int64_t timestamp, std::shared_ptr<void> &picture)
+{
+    auto decoder = TranscodeDecoder::CreateDecoder(_codec_id);
+
+    if (decoder == nullptr)
+    {
+        logte("Could not create the decoder of the thumbnail");
+        return false;
+    }
+
+    // the key frame is shared with the packetyzer(not modified by the decoder)
+    decoder->SendBuffer(std::make_unique<MediaPacket>(MediaType::Video, 0, std::shared_ptr<ov::Data>(key_frame), timestamp, MediaPacketFlag::Key));
+    decoder->SendEndOfStream();
+
+    for (int count = 0; count < THUMBNAIL_MAX_DECODE_COUNT; count++)
+    {
+        TranscodeResult result;
+        auto decoded_frame = decoder->RecvBuffer(&result);
+
+        if (result == TranscodeResult::NoData)
+            continue;
+
+        if (result != TranscodeResult::DataReady && result != TranscodeResult::FormatChanged)
+            break;
+
+        picture = decoded_frame->GetNativeFrame();
+        return picture != nullptr;
+    }
+
+    logtw("The key frame is not decoded(%zu bytes)", key_frame->GetLength());
+    return false;
+}
+
+//====================================================================================================
+// Encode
+// - JPEG(MJPEG encoder), the picture is converted to full range YUV 4:2:0(and scaled down) by swscale
+//====================================================================================================
+std::shared_ptr<ov::Data> SegmentThumbnailer::Encode(const AVFrame *picture)
+{
+    int width = picture->width;
+    int height = picture->height;
+
+    if (width <= 0 || height <= 0)
+        return nullptr;
+
+    if (_width > 0 && static_cast<int>(_width) < width)
+    {
+        height = std::max(static_cast<int>(static_cast<int64_t>(height) * _width / width), 2);
+        width = static_cast<int>(_width);
+    }
+
+    // the chroma of 4:2:0
+    width &= ~1;
+    height &= ~1;
+
+    AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+
+    if (codec == nullptr)
+    {
+        logte("MJPEG encoder is not found");
+        return nullptr;
+    }
+
+    AVCodecContext *context = avcodec_alloc_context3(codec);
+    AVFrame *frame = av_frame_alloc();
+    AVPacket *packet = av_packet_alloc();
+    SwsContext *sws_context = nullptr;
+    std::shared_ptr<ov::Data> image;
+
+    if (context == nullptr || frame == nullptr || packet == nullptr)
+    {
+        logte("Could not allocate the encoder of the thumbnail");
+    }
+    else
+    {
+        context->width = width;
+        context->height = height;
+        context->pix_fmt = AV_PIX_FMT_YUVJ420P;
+        context->time_base = {1, 1};
+        context->flags |= AV_CODEC_FLAG_QSCALE;
+        context->global_quality = FF_QP2LAMBDA * THUMBNAIL_JPEG_QSCALE;
+
+        frame->format = AV_PIX_FMT_YUVJ420P;
+        frame->width = width;
+        frame->height = height;
+        frame->pts = 0;
+        frame->quality = context->global_quality;
+
+        sws_context = sws_getContext(picture->width, picture->height, static_cast<AVPixelFormat>(picture->format),
+                                     width, height, AV_PIX_FMT_YUVJ420P,
+                                     SWS_BICUBIC, nullptr, nullptr, nullptr);
+
+        if (avcodec_open2(context, codec, nullptr) < 0)
+        {
+            logte("Could not open the MJPEG encoder(%dx%d)", width, height);
+        }
+        else if (sws_context == nullptr || av_frame_get_buffer(frame, 32) < 0)
+        {
+            logte("Could not convert the picture(%s, %dx%d)",
+                  av_get_pix_fmt_name(static_cast<AVPixelFormat>(picture->format)), picture->width, picture->height);
+        }
+        else
+        {
+            sws_scale(sws_context, picture->data, picture->linesize, 0, picture->height, frame->data, frame->linesize);
+
+            if (avcodec_send_frame(context, frame) == 0 && avcodec_receive_packet(context, packet) == 0)
+                image = std::make_shared<ov::Data>(packet->data, packet->size);
+            else
+                logte("Could not encode the thumbnail");
+        }
+    }
+
+    sws_freeContext(sws_context);
+    av_packet_free(&packet);
+    av_frame_free(&frame);
+    avcodec_free_context(&context);
+
+    return image;
+}
@@ -0,0 +1,73 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+
+#pragma once
+
+#include "base/common_types.h"
+
+#include <mutex>
+
+struct AVFrame;
+
+// File name of the thumbnail of the stream(ex: http://host/app/stream/thumb.jpg)
+#define THUMBNAIL_FILE_NAME             "thumb.jpg"
+
+// JPEG quality(qscale of the MJPEG encoder, 2(best) ~ 31(worst))
+#define THUMBNAIL_JPEG_QSCALE           5
+
+//====================================================================================================
+// SegmentThumbnail
+// - JPEG image of a key frame
+//====================================================================================================
+struct SegmentThumbnail
+{
+    std::shared_ptr<ov::Data> data;
+
+    // sequence of the key frame(changes when the next key frame arrives)
+    uint64_t sequence;
+    time_t create_time;
+};
+
+//====================================================================================================
+// SegmentThumbnailer
+// - only the reference of the latest key frame is kept, no frame is decoded until the thumbnail is requested
+// - the key frame is decoded once by TranscodeDecoder, the image is cached until the next key frame
+// - concurrent requests are coalesced : the requests wait for the decoding of the first request
+//====================================================================================================
+class SegmentThumbnailer
+{
+public:
+    // width : width of the image(0 : width of the stream), the aspect ratio is kept
+    SegmentThumbnailer(common::MediaCodecId codec_id, uint32_t width);
+
+    // called by the worker of the stream(Annex-B H264/H265)
+    void AppendVideoFrame(const EncodedFrame &encoded_frame);
+
+    // nullptr : no key frame yet, or the key frame could not be decoded
+    std::shared_ptr<const SegmentThumbnail> GetThumbnail();
+
+private:
+    bool Decode(const std::shared_ptr<ov::Data> &key_frame, int64_t timestamp, std::shared_ptr<void> &picture);
+
+    std::shared_ptr<ov::Data> Encode(const AVFrame *picture);
+
+private:
+    common::MediaCodecId _codec_id;
+    uint32_t _width;
+
+    // latest key frame
+    std::mutex _key_frame_mutex;
+    std::shared_ptr<ov::Data> _key_frame;
+    int64_t _key_frame_timestamp = 0;
+    uint64_t _key_frame_sequence = 0;
+
+    // decoding(single flight) and the cached image
+    std::mutex _thumbnail_mutex;
+    std::shared_ptr<const SegmentThumbnail> _thumbnail;
+    uint64_t _failed_sequence = 0;
+};
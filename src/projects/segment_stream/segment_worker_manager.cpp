@@ -4,8 +4,9 @@
 //====================================================================================================
 // SegmentWorker constructorc
 //====================================================================================================
-SegmentWorker::SegmentWorker()
+SegmentWorker::SegmentWorker(SegmentWorkerManager *manager)
 {
+    _manager = manager;
     _stop_thread_flag = true;
 }
 
@@ -40,44 +41,51 @@ bool SegmentWorker::Start(const SegmentProcessHandler &process_handler)
 //====================================================================================================
 bool SegmentWorker::Stop()
 {
-    if(_stop_thread_flag)
+    SetStopFlag();
+
+    if(_worker_thread.joinable())
     {
-        return true;
+        // Generate Event(the semaphore is shared, so all the workers are woken up)
+        _manager->NotifyWorkers();
+        _worker_thread.join();
     }
 
-    _stop_thread_flag = true;
-    // Generate Event
-    _queue_event.Notify();
-    _worker_thread.join();
-
     return true;
 }
 
 //====================================================================================================
-// add work info
+// SegmentWorker stop flag
+// - the thread exits when it is woken up
 //====================================================================================================
-bool SegmentWorker::AddWorkInfo(std::shared_ptr<SegmentWorkInfo> work_info)
+void SegmentWorker::SetStopFlag()
 {
-    std::unique_lock<std::mutex> lock(_work_info_guard);
-    _work_infos.push(work_info);
+    _stop_thread_flag = true;
+}
 
-    _queue_event.Notify();
+//====================================================================================================
+// push work info
+//====================================================================================================
+void SegmentWorker::PushWorkInfo(const std::shared_ptr<SegmentWorkInfo> &work_info)
+{
+    std::unique_lock<std::mutex> lock(_work_info_guard);
 
-    return true;
+    _work_infos[static_cast<int>(work_info->priority)].push_back(work_info);
 }
 
 //====================================================================================================
 // pop work info
 //====================================================================================================
-std::shared_ptr<SegmentWorkInfo> SegmentWorker::PopWorkInfo()
+std::shared_ptr<SegmentWorkInfo> SegmentWorker::PopWorkInfo(SegmentWorkPriority priority)
 {
     std::unique_lock<std::mutex> lock(_work_info_guard);
 
-    if(_work_infos.empty())
+    auto &work_infos = _work_infos[static_cast<int>(priority)];
+
+    if(work_infos.empty())
         return nullptr;
 
-    auto work_info = _work_infos.front();
-    _work_infos.pop();
+    auto work_info = work_infos.front();
+    work_infos.pop_front();
 
     return work_info;
 }
@@ -87,12 +95,12 @@ std::shared_ptr<SegmentWorkInfo> SegmentWorker::PopWorkInfo()
 //====================================================================================================
 void SegmentWorker::WorkerThread()
 {
+    ov::ThreadTopology::Instance()->BindCurrentThread(OV_THREAD_POOL_SEGMENT_WORKER);
+
     while(!_stop_thread_flag)
     {
-        // quequ event wait
-        _queue_event.Wait();
-
-        auto work_info = PopWorkInfo();
+        // quequ event wait(own queue or stolen)
+        auto work_info = _manager->WaitWorkInfo(this);
 
         if(work_info == nullptr)
         {
@@ -101,7 +109,7 @@ void SegmentWorker::WorkerThread()
 
         bool is_retry = false;// in/out value
 
-        _process_handler(work_info->request, work_info->response, work_info->retry_count, is_retry);
+        _process_handler(work_info->request, work_info->response, work_info->retry_count, work_info->is_resumed, is_retry);
 
 //        logtd("Segment Worker Process : url(%s) retry(%d:%d) result(%d)",
 //              work_info->request->GetRequestTarget().CStr(),
@@ -112,8 +120,21 @@ void SegmentWorker::WorkerThread()
         if(is_retry)
         {
             // retry work input;
+            // (the send queue is full, so the work is added again after the data is sent to the client)
             work_info->retry_count++;
-            AddWorkInfo(work_info);
+
+            std::weak_ptr<SegmentWorker> weak_worker = GetSharedPtr();
+
+            ov::SharedTimerWheel::Instance()->Schedule(SEGMENT_WORKER_RETRY_DELAY, [weak_worker, work_info]() -> int64_t {
+                auto worker = weak_worker.lock();
+
+                if(worker != nullptr)
+                {
+                    worker->_manager->AddWorkInfo(worker, work_info);
+                }
+
+                return 0;
+            });
         }
     }
 }
@@ -128,14 +149,15 @@ bool SegmentWorkerManager::Start(int worker_count, const SegmentProcessHandler &
 
     _worker_count = worker_count;
 
-    // Create WorkerThread
+    // Create WorkerThread(the workers are listed before the threads steal from them)
     for(int index = 0; index < _worker_count ; index++)
     {
-        auto worker = std::make_shared<SegmentWorker>();
-        worker->Start(process_handler);
-        _workers.push_back(worker);
+        _workers.push_back(std::make_shared<SegmentWorker>(this));
     }
 
+    for(const auto &worker : _workers)
+        worker->Start(process_handler);
+
     return true;
 }
 
@@ -144,6 +166,10 @@ bool SegmentWorkerManager::Start(int worker_count, const SegmentProcessHandler &
 //====================================================================================================
 bool SegmentWorkerManager::Stop()
 {
+    // all the flags are set first : a notification is not consumed by a worker which keeps running
+    for(const auto &worker : _workers)
+        worker->SetStopFlag();
+
     for(const auto &worker : _workers)
         worker->Stop();
 
@@ -153,19 +179,96 @@ bool SegmentWorkerManager::Stop()
 //====================================================================================================
 // Worker Add
 //====================================================================================================
-#define MAX_WORKER_INDEX 100000000
 bool SegmentWorkerManager::AddWork(const std::shared_ptr<HttpRequest> &request,
-                                   const std::shared_ptr<HttpResponse> &response)
+                                   const std::shared_ptr<HttpResponse> &response,
+                                   bool is_resumed)
 {
-    auto work_info = std::make_shared<SegmentWorkInfo>(request, response);
+    if(_workers.empty())
+        return false;
 
-    // insert thread
-    _workers[(_worker_index % _worker_count)]->AddWorkInfo(work_info);
+    auto work_info = std::make_shared<SegmentWorkInfo>(request, response, is_resumed,
+                                                       GetWorkPriority(request, response, is_resumed));
 
-    if(_worker_index < MAX_WORKER_INDEX)
-        _worker_index++;
-    else
-        _worker_index = 0;
+    // insert thread
+    AddWorkInfo(_workers[_worker_index++ % _worker_count], work_info);
 
     return true;
 }
+
+//====================================================================================================
+// Work Info Add
+//====================================================================================================
+void SegmentWorkerManager::AddWorkInfo(const std::shared_ptr<SegmentWorker> &worker, const std::shared_ptr<SegmentWorkInfo> &work_info)
+{
+    worker->PushWorkInfo(work_info);
+
+    _work_event.Notify();
+}
+
+//====================================================================================================
+// Work Info Wait
+// - high priority works of all the queues(own queue first) -> low priority works
+// - the semaphore is notified once per queued work, so the work is found in one of the queues
+//   unless it is woken up to stop
+//====================================================================================================
+std::shared_ptr<SegmentWorkInfo> SegmentWorkerManager::WaitWorkInfo(const SegmentWorker *worker)
+{
+    _work_event.Wait();
+
+    size_t own_index = 0;
+
+    for(size_t index = 0; index < _workers.size(); index++)
+    {
+        if(_workers[index].get() == worker)
+        {
+            own_index = index;
+            break;
+        }
+    }
+
+    for(int priority = 0; priority < SEGMENT_WORK_PRIORITY_COUNT; priority++)
+    {
+        for(size_t offset = 0; offset < _workers.size(); offset++)
+        {
+            auto work_info = _workers[(own_index + offset) % _workers.size()]->PopWorkInfo(static_cast<SegmentWorkPriority>(priority));
+
+            if(work_info != nullptr)
+                return work_info;
+        }
+    }
+
+    return nullptr;
+}
+
+//====================================================================================================
+// Notify Workers
+// - wakes up all the workers(stop), the workers which find no work wait again
+//====================================================================================================
+void SegmentWorkerManager::NotifyWorkers()
+{
+    for(int index = 0; index < _worker_count; index++)
+        _work_event.Notify();
+}
+
+//====================================================================================================
+// Work Priority
+// - playlist(m3u8/mpd), LL-HLS part, resumed blocking request, next chunks of the low latency segment : High
+//====================================================================================================
+SegmentWorkPriority SegmentWorkerManager::GetWorkPriority(const std::shared_ptr<HttpRequest> &request,
+                                                          const std::shared_ptr<HttpResponse> &response,
+                                                          bool is_resumed)
+{
+    if(is_resumed || response->IsChunkedTransfer())
+        return SegmentWorkPriority::High;
+
+    ov::String target = request->GetRequestTarget();
+    auto query_index = target.IndexOf('?');
+
+    if(query_index >= 0)
+        target = target.Left(static_cast<size_t>(query_index));
+
+    if(target.HasSuffix(".m3u8") || target.HasSuffix(".mpd") || target.IndexOf("_part") >= 0)
+        return SegmentWorkPriority::High;
+
+    return SegmentWorkPriority::Low;
+}
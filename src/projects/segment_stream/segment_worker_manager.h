@@ -10,52 +10,82 @@
 #pragma once
 
 #include <string>
-#include <queue>
+#include <deque>
+#include <atomic>
 #include "base/ovlibrary/ovlibrary.h"
 #include "base/ovlibrary/semaphore.h"
 #include "http_server/http_request.h"
 #include "http_server/http_response.h"
+
+// The response is retried after the delay (ms) while the send queue of the client is full
+#define SEGMENT_WORKER_RETRY_DELAY 100
+
+// Priority classes of the works(processed in this order)
+// - High : playlists, LL-HLS parts, resumed blocking requests and low latency chunks(small, latency critical)
+// - Low : segments
+enum class SegmentWorkPriority : int32_t
+{
+    High = 0,
+    Low,
+};
+#define SEGMENT_WORK_PRIORITY_COUNT 2
+
 struct SegmentWorkInfo
 {
     SegmentWorkInfo(const std::shared_ptr<HttpRequest> &request_,
-                    const std::shared_ptr<HttpResponse> &response_)
+                    const std::shared_ptr<HttpResponse> &response_,
+                    bool is_resumed_ = false,
+                    SegmentWorkPriority priority_ = SegmentWorkPriority::Low)
     {
         request = request_;
         response = response_;
+        is_resumed = is_resumed_;
+        priority = priority_;
     }
     std::shared_ptr<HttpRequest> request = nullptr;
     std::shared_ptr<HttpResponse> response = nullptr;
     int retry_count = 0;
+    bool is_resumed = false; // blocking request(low latency) resumed
+    SegmentWorkPriority priority = SegmentWorkPriority::Low;
 };
 
 using SegmentProcessHandler = std::function<bool(const std::shared_ptr<HttpRequest> &request,
                                             const std::shared_ptr<HttpResponse> &response,
                                             int retry_count,
+                                            bool is_resumed,
                                             bool &is_retry)>;
+class SegmentWorkerManager;
+
 //====================================================================================================
 // SegmentWorker
+// - local queues of the priority classes, the idle workers steal the works of the others
 //====================================================================================================
-class SegmentWorker
+class SegmentWorker : public ov::EnableSharedFromThis<SegmentWorker>
 {
 public:
-    SegmentWorker();
+    explicit SegmentWorker(SegmentWorkerManager *manager);
     ~SegmentWorker();
 
     bool Start(const SegmentProcessHandler &process_handler);
     bool Stop();
+    void SetStopFlag();
 
-    bool AddWorkInfo(std::shared_ptr<SegmentWorkInfo> work_info);
-    std::shared_ptr<SegmentWorkInfo> PopWorkInfo();
+    // queued to the local queue(not notified : see SegmentWorkerManager::AddWorkInfo())
+    void PushWorkInfo(const std::shared_ptr<SegmentWorkInfo> &work_info);
+
+    // the oldest work of the priority class(nullptr : empty)
+    std::shared_ptr<SegmentWorkInfo> PopWorkInfo(SegmentWorkPriority priority);
 
 private:
     void WorkerThread();
 
 private :
-    std::queue<std::shared_ptr<SegmentWorkInfo>> _work_infos;
+    SegmentWorkerManager *_manager;
+
+    std::deque<std::shared_ptr<SegmentWorkInfo>> _work_infos[SEGMENT_WORK_PRIORITY_COUNT];
     std::mutex _work_info_guard;
-    ov::Semaphore _queue_event;
 
-    bool _stop_thread_flag;
+    std::atomic<bool> _stop_thread_flag;
     std::thread _worker_thread;
 
     SegmentProcessHandler _process_handler;
@@ -63,6 +93,10 @@ private :
 
 //====================================================================================================
 // SegmentWorkerManager
+// - work-stealing pool : the works are queued to the workers round-robin, a worker processes
+//   the high priority works of all the queues(its own first) before the low priority works,
+//   so a worker stuck on a slow client does not hold the works queued to it
+// - one semaphore for the pool(count : queued works), any idle worker is woken up
 //====================================================================================================
 class SegmentWorkerManager
 {
@@ -74,11 +108,25 @@ public :
     bool Start(int worker_count, const SegmentProcessHandler &process_handler);
     bool Stop();
     bool AddWork(const std::shared_ptr<HttpRequest> &request,
-                 const std::shared_ptr<HttpResponse> &response);
+                 const std::shared_ptr<HttpResponse> &response,
+                 bool is_resumed = false);
+
+    // queued to the worker(retry : the worker which processed it)
+    void AddWorkInfo(const std::shared_ptr<SegmentWorker> &worker, const std::shared_ptr<SegmentWorkInfo> &work_info);
+
+    // blocked until a work is queued(nullptr : no work, e.g. woken up to stop)
+    std::shared_ptr<SegmentWorkInfo> WaitWorkInfo(const SegmentWorker *worker);
+
+    void NotifyWorkers();
+
+    static SegmentWorkPriority GetWorkPriority(const std::shared_ptr<HttpRequest> &request,
+                                               const std::shared_ptr<HttpResponse> &response,
+                                               bool is_resumed);
 
 private:
     int _worker_count = 0;
-    int _worker_index = 0;
+    std::atomic<uint32_t> _worker_index { 0 };
 
     std::vector<std::shared_ptr<SegmentWorker>> _workers;
+    ov::Semaphore _work_event;
 };
\ No newline at end of file
@@ -49,10 +49,13 @@ StreamPacketyzer::~StreamPacketyzer()
 //====================================================================================================
 // Append Video Data
 //====================================================================================================
-bool StreamPacketyzer::AppendVideoData(std::unique_ptr<EncodedFrame> encoded_frame,
+bool StreamPacketyzer::AppendVideoData(EncodedFrame &encoded_frame,
                                         uint32_t timescale,
                                         uint64_t time_offset)
 {
+    ov::MemoryTagScope memory_tag(ov::MemoryTag::Packetizer);
+    OV_TRACE_SCOPE("packetizer", "SegmentVideo");
+
     if(_stream_type == PacketyzerStreamType::AudioOnly)
         return true;
 
@@ -62,23 +65,25 @@ bool StreamPacketyzer::AppendVideoData(std::unique_ptr<EncodedFrame> encoded_fra
     // timestamp change
     if (timescale != _video_timescale)
     {
-        encoded_frame->_time_stamp = Packetyzer::ConvertTimeScale(encoded_frame->_time_stamp, timescale, _video_timescale);
+        encoded_frame._time_stamp = Packetyzer::ConvertTimeScale(encoded_frame._time_stamp, timescale, _video_timescale);
 
         if (time_offset != 0)
             time_offset = Packetyzer::ConvertTimeScale(time_offset, timescale, _video_timescale);
     }
 
-    PacketyzerFrameType frame_type = (encoded_frame->_frame_type == FrameType::VideoFrameKey) ?
+    PacketyzerFrameType frame_type = (encoded_frame._frame_type == FrameType::VideoFrameKey) ?
                                      PacketyzerFrameType::VideoIFrame : PacketyzerFrameType::VideoPFrame;
 
     auto frame_data = std::make_shared<PacketyzerFrameData>(frame_type,
-                                                            encoded_frame->_time_stamp,
+                                                            encoded_frame._time_stamp,
                                                             time_offset,
                                                             _video_timescale,
-                                                            encoded_frame->_buffer);
+                                                            encoded_frame._buffer);
+
+    frame_data->bitstream = encoded_frame._bitstream;
 
     AppendVideoFrame(frame_data);
-    _last_video_timestamp = encoded_frame->_time_stamp;
+    _last_video_timestamp = encoded_frame._time_stamp;
     _last_video_append_time = time(nullptr);
     return true;
 }
@@ -86,25 +91,80 @@ bool StreamPacketyzer::AppendVideoData(std::unique_ptr<EncodedFrame> encoded_fra
 //====================================================================================================
 // Append Audio Data
 //====================================================================================================
-bool StreamPacketyzer::AppendAudioData(std::unique_ptr<EncodedFrame> encoded_frame, uint32_t timescale)
+bool StreamPacketyzer::AppendAudioData(EncodedFrame &encoded_frame, uint32_t timescale)
 {
+    ov::MemoryTagScope memory_tag(ov::MemoryTag::Packetizer);
+    OV_TRACE_SCOPE("packetizer", "SegmentAudio");
+
     if(_stream_type == PacketyzerStreamType::VideoOnly)
         return true;
 
     // timestamp change
     if (timescale != _audio_timescale)
     {
-        encoded_frame->_time_stamp = Packetyzer::ConvertTimeScale(encoded_frame->_time_stamp, timescale, _audio_timescale);
+        encoded_frame._time_stamp = Packetyzer::ConvertTimeScale(encoded_frame._time_stamp, timescale, _audio_timescale);
     }
 
     auto frame_data = std::make_shared<PacketyzerFrameData>(PacketyzerFrameType::AudioFrame,
-                                                            encoded_frame->_time_stamp,
+                                                            encoded_frame._time_stamp,
                                                             0,
                                                             _audio_timescale,
-                                                            encoded_frame->_buffer);
+                                                            encoded_frame._buffer);
 
     AppendAudioFrame(frame_data);
-    _last_audio_timestamp = encoded_frame->_time_stamp;
+    _last_audio_timestamp = encoded_frame._time_stamp;
     _last_audio_append_time = time(nullptr);
     return true;
 }
+
+//====================================================================================================
+// Segment Memory Limit
+//====================================================================================================
+void StreamPacketyzer::SetSegmentMemoryLimit(uint64_t limit)
+{
+    if(_packetyzer != nullptr)
+        _packetyzer->SetMemoryLimit(limit);
+}
+
+uint64_t StreamPacketyzer::GetMemoryUsage() const
+{
+    return (_packetyzer != nullptr) ? _packetyzer->GetMemoryUsage() : 0;
+}
+
+//====================================================================================================
+// Segment Alignment
+//====================================================================================================
+void StreamPacketyzer::SetSegmentAlignment(bool aligned)
+{
+    if(_packetyzer != nullptr)
+        _packetyzer->SetSegmentAlignment(aligned);
+}
+
+//====================================================================================================
+// Segment Tolerance
+//====================================================================================================
+void StreamPacketyzer::SetSegmentTolerance(uint32_t tolerance)
+{
+    if(_packetyzer != nullptr)
+        _packetyzer->SetSegmentTolerance(tolerance);
+}
+
+//====================================================================================================
+// Uploader
+//====================================================================================================
+void StreamPacketyzer::SetUploader(const std::shared_ptr<SegmentUploader> &uploader)
+{
+    if(_packetyzer != nullptr && uploader != nullptr)
+        _packetyzer->SetUploader(uploader);
+}
+
+//====================================================================================================
+// DVR
+//====================================================================================================
+bool StreamPacketyzer::EnableDvr(const ov::String &path, uint64_t window_duration)
+{
+    if(_packetyzer == nullptr)
+        return false;
+
+    return _packetyzer->EnableDvr(path, window_duration);
+}
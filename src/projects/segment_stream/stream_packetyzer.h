@@ -36,15 +36,77 @@ public:
     virtual ~StreamPacketyzer();
 
 public :
-    bool AppendVideoData(std::unique_ptr<EncodedFrame> encoded_frame, uint32_t timescale, uint64_t time_offset);
+    bool AppendVideoData(EncodedFrame &encoded_frame, uint32_t timescale, uint64_t time_offset);
 
-    bool AppendAudioData(std::unique_ptr<EncodedFrame> encoded_frame, uint32_t timescale);
+    bool AppendAudioData(EncodedFrame &encoded_frame, uint32_t timescale);
+
+    // byte(0 : unlimited)
+    void SetSegmentMemoryLimit(uint64_t limit);
+    uint64_t GetMemoryUsage() const;
+
+    // DVR(second, 0 : disabled)
+    bool EnableDvr(const ov::String &path, uint64_t window_duration);
+
+    // segment boundaries at the same timestamps for all the renditions
+    void SetSegmentAlignment(bool aligned);
+
+    // millisecond(0 : the first key frame after the segment duration)
+    void SetSegmentTolerance(uint32_t tolerance);
+
+    // push of the segments and the playlists(nullptr : disabled)
+    void SetUploader(const std::shared_ptr<SegmentUploader> &uploader);
 
     // Child must implement this function
     virtual bool AppendVideoFrame(std::shared_ptr<PacketyzerFrameData> &dEncodedFrameata) = 0;
     virtual bool AppendAudioFrame(std::shared_ptr<PacketyzerFrameData> &data)  = 0;
-    virtual bool GetPlayList(ov::String &play_list)  = 0;
-    virtual bool GetSegment(const ov::String &file_name, std::shared_ptr<ov::Data> &data)  = 0;
+    virtual bool GetPlayList(std::shared_ptr<const PlayListSnapshot> &play_list)  = 0;
+    virtual bool GetSegment(const ov::String &file_name, std::shared_ptr<SegmentData> &segment_data)  = 0;
+
+    // codecs of the video(RFC 6381, empty : unknown), used by the master playlist of the renditions
+    virtual std::string GetVideoCodecString()
+    {
+        return "";
+    }
+
+    // Multiple playlists(HLS CMAF : multivariant/media playlists)
+    virtual bool GetPlayList(const ov::String &file_name, std::shared_ptr<const PlayListSnapshot> &play_list)
+    {
+        return GetPlayList(play_list);
+    }
+
+    // Low latency streaming(blocking request), request coalescing(sequence number -1)
+    // - Waiting : callback is called when the requested data is available(or timeout)
+    virtual PacketyzerWaitResult WaitPlayList(int64_t sequence_number, int64_t part_index, const PacketyzerWaitCallback &callback)
+    {
+        if (sequence_number >= 0 || _packetyzer == nullptr)
+            return PacketyzerWaitResult::Available;
+
+        return _packetyzer->WaitPlayListData(callback);
+    }
+
+    virtual PacketyzerWaitResult WaitSegment(const ov::String &file_name, const PacketyzerWaitCallback &callback)
+    {
+        if (_packetyzer == nullptr)
+            return PacketyzerWaitResult::Available;
+
+        return _packetyzer->WaitSegmentData(file_name, callback);
+    }
+
+    // Low latency chunked transfer
+    // - chunks of the segment after offset(byte), is_completed : no more chunk
+    // - false : chunked transfer is not supported(or the segment is not found)
+    virtual bool GetChunkedSegment(const ov::String &file_name,
+                                   size_t offset,
+                                   std::vector<std::shared_ptr<const ov::Data>> &chunks,
+                                   bool &is_completed)
+    {
+        return false;
+    }
+
+    virtual PacketyzerWaitResult WaitChunkedSegment(const ov::String &file_name, size_t offset, const PacketyzerWaitCallback &callback)
+    {
+        return PacketyzerWaitResult::Available;
+    }
 
 protected :
     std::shared_ptr<Packetyzer> _packetyzer = nullptr;
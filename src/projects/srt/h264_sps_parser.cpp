@@ -0,0 +1,256 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "h264_sps_parser.h"
+
+#define OV_LOG_TAG "H264SpsParser"
+
+// Enough for the fields before the VUI timing information
+#define H264_SPS_MAX_PARSE_SIZE         (256)
+
+namespace
+{
+	void SkipScalingList(ov::BitReader &reader, int size)
+	{
+		int32_t last_scale = 8;
+		int32_t next_scale = 8;
+
+		for(int index = 0; index < size; index++)
+		{
+			if(next_scale != 0)
+			{
+				next_scale = (last_scale + reader.ReadSe() + 256) % 256;
+			}
+
+			last_scale = (next_scale == 0) ? last_scale : next_scale;
+		}
+	}
+}
+
+bool H264SpsParser::Parse(const uint8_t *nal, size_t nal_size, H264SpsInfo &info)
+{
+	if((nal_size < 4) || ((nal[0] & 0x1F) != 7))
+	{
+		return false;
+	}
+
+	// Remove the emulation prevention bytes (00 00 03 -> 00 00)
+	uint8_t rbsp[H264_SPS_MAX_PARSE_SIZE];
+	size_t rbsp_size = 0;
+	int zero_count = 0;
+
+	for(size_t index = 1; (index < nal_size) && (rbsp_size < sizeof(rbsp)); index++)
+	{
+		if((zero_count == 2) && (nal[index] == 0x03))
+		{
+			zero_count = 0;
+			continue;
+		}
+
+		zero_count = (nal[index] == 0x00) ? (zero_count + 1) : 0;
+		rbsp[rbsp_size++] = nal[index];
+	}
+
+	ov::BitReader reader(rbsp, rbsp_size);
+
+	uint32_t profile_idc = reader.ReadBits(8);
+	// constraint_set_flags, reserved_zero_2bits, level_idc
+	reader.ReadBits(16);
+	// seq_parameter_set_id
+	reader.ReadUe();
+
+	uint32_t chroma_format_idc = 1;
+	bool separate_colour_plane_flag = false;
+
+	switch(profile_idc)
+	{
+		case 100:
+		case 110:
+		case 122:
+		case 244:
+		case 44:
+		case 83:
+		case 86:
+		case 118:
+		case 128:
+		case 138:
+		case 139:
+		case 134:
+		case 135:
+			chroma_format_idc = reader.ReadUe();
+
+			if(chroma_format_idc == 3)
+			{
+				separate_colour_plane_flag = reader.ReadBit();
+			}
+
+			// bit_depth_luma_minus8, bit_depth_chroma_minus8
+			reader.ReadUe();
+			reader.ReadUe();
+			// qpprime_y_zero_transform_bypass_flag
+			reader.ReadBit();
+
+			if(reader.ReadBit())
+			{
+				// seq_scaling_matrix_present_flag
+				int count = (chroma_format_idc != 3) ? 8 : 12;
+
+				for(int index = 0; index < count; index++)
+				{
+					if(reader.ReadBit())
+					{
+						SkipScalingList(reader, (index < 6) ? 16 : 64);
+					}
+				}
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	// log2_max_frame_num_minus4
+	reader.ReadUe();
+
+	uint32_t pic_order_cnt_type = reader.ReadUe();
+
+	if(pic_order_cnt_type == 0)
+	{
+		// log2_max_pic_order_cnt_lsb_minus4
+		reader.ReadUe();
+	}
+	else if(pic_order_cnt_type == 1)
+	{
+		// delta_pic_order_always_zero_flag, offset_for_non_ref_pic, offset_for_top_to_bottom_field
+		reader.ReadBit();
+		reader.ReadSe();
+		reader.ReadSe();
+
+		uint32_t num_ref_frames_in_pic_order_cnt_cycle = reader.ReadUe();
+
+		for(uint32_t index = 0; (index < num_ref_frames_in_pic_order_cnt_cycle) && (reader.IsOverflow() == false); index++)
+		{
+			reader.ReadSe();
+		}
+	}
+
+	// max_num_ref_frames, gaps_in_frame_num_value_allowed_flag
+	reader.ReadUe();
+	reader.ReadBit();
+
+	uint32_t pic_width_in_mbs_minus1 = reader.ReadUe();
+	uint32_t pic_height_in_map_units_minus1 = reader.ReadUe();
+	bool frame_mbs_only_flag = reader.ReadBit();
+
+	if(frame_mbs_only_flag == false)
+	{
+		// mb_adaptive_frame_field_flag
+		reader.ReadBit();
+	}
+
+	// direct_8x8_inference_flag
+	reader.ReadBit();
+
+	uint32_t crop_left = 0;
+	uint32_t crop_right = 0;
+	uint32_t crop_top = 0;
+	uint32_t crop_bottom = 0;
+
+	if(reader.ReadBit())
+	{
+		// frame_cropping_flag
+		crop_left = reader.ReadUe();
+		crop_right = reader.ReadUe();
+		crop_top = reader.ReadUe();
+		crop_bottom = reader.ReadUe();
+	}
+
+	if(reader.IsOverflow())
+	{
+		return false;
+	}
+
+	// 7.4.2.1.1 (CropUnitX, CropUnitY)
+	uint32_t chroma_array_type = separate_colour_plane_flag ? 0 : chroma_format_idc;
+	uint32_t crop_unit_x = 1;
+	uint32_t crop_unit_y = frame_mbs_only_flag ? 1 : 2;
+
+	if(chroma_array_type != 0)
+	{
+		crop_unit_x = (chroma_array_type == 3) ? 1 : 2;
+		crop_unit_y *= (chroma_array_type == 1) ? 2 : 1;
+	}
+
+	uint32_t width = (pic_width_in_mbs_minus1 + 1) * 16;
+	uint32_t height = (pic_height_in_map_units_minus1 + 1) * 16 * (frame_mbs_only_flag ? 1 : 2);
+	uint32_t crop_width = (crop_left + crop_right) * crop_unit_x;
+	uint32_t crop_height = (crop_top + crop_bottom) * crop_unit_y;
+
+	if((crop_width >= width) || (crop_height >= height))
+	{
+		return false;
+	}
+
+	info.width = width - crop_width;
+	info.height = height - crop_height;
+	info.framerate = 0.0;
+
+	if(reader.ReadBit())
+	{
+		// vui_parameters_present_flag (E.1.1)
+		if(reader.ReadBit())
+		{
+			// aspect_ratio_info_present_flag
+			if(reader.ReadBits(8) == 255)
+			{
+				// Extended_SAR: sar_width, sar_height
+				reader.ReadBits(16);
+				reader.ReadBits(16);
+			}
+		}
+
+		if(reader.ReadBit())
+		{
+			// overscan_info_present_flag: overscan_appropriate_flag
+			reader.ReadBit();
+		}
+
+		if(reader.ReadBit())
+		{
+			// video_signal_type_present_flag: video_format, video_full_range_flag
+			reader.ReadBits(4);
+
+			if(reader.ReadBit())
+			{
+				// colour_description_present_flag: colour_primaries, transfer_characteristics, matrix_coefficients
+				reader.ReadBits(24);
+			}
+		}
+
+		if(reader.ReadBit())
+		{
+			// chroma_loc_info_present_flag
+			reader.ReadUe();
+			reader.ReadUe();
+		}
+
+		if(reader.ReadBit())
+		{
+			// timing_info_present_flag
+			uint32_t num_units_in_tick = reader.ReadBits(32);
+			uint32_t time_scale = reader.ReadBits(32);
+
+			if((reader.IsOverflow() == false) && (num_units_in_tick > 0))
+			{
+				// A frame consists of 2 fields (ticks)
+				info.framerate = static_cast<double>(time_scale) / (2.0 * num_units_in_tick);
+			}
+		}
+	}
+
+	return true;
+}
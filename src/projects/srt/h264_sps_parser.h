@@ -0,0 +1,29 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+struct H264SpsInfo
+{
+	uint32_t width = 0;
+	uint32_t height = 0;
+	// 0 if the SPS has no timing information
+	double framerate = 0.0;
+};
+
+//====================================================================================================
+// H264SpsParser
+// - Parses the resolution and the framerate (VUI timing_info) of a SPS (ITU-T H.264 7.3.2.1.1)
+//====================================================================================================
+class H264SpsParser
+{
+public:
+	// nal: SPS NAL unit without the start code (including the NAL header)
+	static bool Parse(const uint8_t *nal, size_t nal_size, H264SpsInfo &info);
+};
@@ -0,0 +1,31 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "srt_application.h"
+#include "srt_stream.h"
+
+#define OV_LOG_TAG "SrtApplication"
+
+std::shared_ptr<SrtApplication> SrtApplication::Create(const info::Application *application_info)
+{
+	auto application = std::make_shared<SrtApplication>(application_info);
+	return application;
+}
+
+SrtApplication::SrtApplication(const info::Application *application_info)
+	: Application(application_info)
+{
+}
+
+std::shared_ptr<Stream> SrtApplication::OnCreateStream()
+{
+	logtd("OnCreateStream");
+
+	auto stream = SrtStream::Create();
+
+	return stream;
+}
@@ -0,0 +1,27 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "base/common_types.h"
+
+#include "base/provider/application.h"
+#include "base/provider/stream.h"
+
+using namespace pvd;
+
+class SrtApplication : public Application
+{
+public:
+	static std::shared_ptr<SrtApplication> Create(const info::Application *application_info);
+
+	explicit SrtApplication(const info::Application *info);
+	~SrtApplication() override = default;
+
+public:
+	std::shared_ptr<Stream> OnCreateStream() override;
+};
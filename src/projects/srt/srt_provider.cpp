@@ -0,0 +1,461 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include <config/config.h>
+
+#include "srt_provider.h"
+#include "srt_application.h"
+#include "srt_stream.h"
+
+#define OV_LOG_TAG "SrtProvider"
+
+// Options of the listening sockets which are shared by the applications (key: address of the port)
+static std::mutex g_port_option_mutex;
+static std::map<ov::String, std::pair<int, ov::String>> g_port_options;
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<SrtProvider> SrtProvider::Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+{
+	auto provider = std::make_shared<SrtProvider>(application_info, router);
+
+	if(provider->Start() == false)
+	{
+		return nullptr;
+	}
+
+	return provider;
+}
+
+//====================================================================================================
+// SrtProvider
+//====================================================================================================
+SrtProvider::SrtProvider(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+	: Provider(application_info, router)
+{
+	logtd("Created Srt Provider modules.");
+}
+
+//====================================================================================================
+// ~SrtProvider
+//====================================================================================================
+SrtProvider::~SrtProvider()
+{
+	Stop();
+	logtd("Terminated Srt Provider modules.");
+}
+
+//====================================================================================================
+// Start
+//====================================================================================================
+bool SrtProvider::Start()
+{
+	_provider_info = _application_info->GetProvider<cfg::SrtProvider>();
+
+	if((_provider_info == nullptr) || (_provider_info->IsParsed() == false))
+	{
+		logte("Cannot initialize SrtProvider using config information");
+		return false;
+	}
+
+	auto host = _application_info->GetParentAs<cfg::Host>("Host");
+
+	if(host == nullptr)
+	{
+		OV_ASSERT2(false);
+		return false;
+	}
+
+	// The port of the application takes precedence over the port of the host
+	const cfg::Port &port = _provider_info->GetPort().IsParsed() ? _provider_info->GetPort() : host->GetPorts().GetSrtProviderPort();
+
+	if(port.GetSocketType() != ov::SocketType::Srt)
+	{
+		logte("Invalid SRT provider port: %d (the type must be srt)", port.GetPort());
+		return false;
+	}
+
+	auto srt_address = ov::SocketAddress(host->GetIp(), static_cast<uint16_t>(port.GetPort()));
+
+	_physical_port = PhysicalPortManager::Instance()->CreatePort(ov::SocketType::Srt, srt_address);
+
+	if(_physical_port == nullptr)
+	{
+		logte("Could not initialize phyiscal port for SRT provider: %s", srt_address.ToString().CStr());
+		return false;
+	}
+
+	if(SetSocketOptions(srt_address) == false)
+	{
+		PhysicalPortManager::Instance()->DeletePort(_physical_port);
+		_physical_port = nullptr;
+		return false;
+	}
+
+	_physical_port->AddObserver(this);
+
+	logti("SRT Provider is listening on %s (application: %s, latency: %d ms, encryption: %s)...",
+	      srt_address.ToString().CStr(), _application_info->GetName().CStr(),
+	      _provider_info->GetLatency(), _provider_info->GetPassphrase().IsEmpty() ? "off" : "on");
+
+	return Provider::Start();
+}
+
+//====================================================================================================
+// Stop
+//====================================================================================================
+bool SrtProvider::Stop()
+{
+	if(_physical_port != nullptr)
+	{
+		_physical_port->RemoveObserver(this);
+
+		{
+			std::lock_guard<std::mutex> lock(_stream_mutex);
+
+			for(auto &item : _streams)
+			{
+				Disconnect(item.second->GetRemote());
+				DeleteStream(item.second);
+			}
+
+			_streams.clear();
+		}
+
+		PhysicalPortManager::Instance()->DeletePort(_physical_port);
+		_physical_port = nullptr;
+	}
+
+	return Provider::Stop();
+}
+
+//====================================================================================================
+// SetSocketOptions
+// - Latency/passphrase of the application, which are inherited by the accepted sockets
+// - The options can be set after listen (they are checked only for the connected sockets)
+//====================================================================================================
+bool SrtProvider::SetSocketOptions(const ov::SocketAddress &address)
+{
+	auto latency = static_cast<int32_t>(_provider_info->GetLatency());
+	auto passphrase = _provider_info->GetPassphrase();
+
+	if((passphrase.IsEmpty() == false) &&
+	   ((passphrase.GetLength() < SRT_PROVIDER_MIN_PASSPHRASE_LENGTH) || (passphrase.GetLength() > SRT_PROVIDER_MAX_PASSPHRASE_LENGTH)))
+	{
+		logte("The passphrase of SRT must be %d~%d characters (application: %s)",
+		      SRT_PROVIDER_MIN_PASSPHRASE_LENGTH, SRT_PROVIDER_MAX_PASSPHRASE_LENGTH, _application_info->GetName().CStr());
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(g_port_option_mutex);
+
+	auto key = address.ToString();
+	auto item = g_port_options.find(key);
+
+	if(item != g_port_options.end())
+	{
+		if((item->second.first != latency) || (item->second.second != passphrase))
+		{
+			logtw("The options of %s are already set by another application, the latency/passphrase of %s are ignored",
+			      key.CStr(), _application_info->GetName().CStr());
+		}
+
+		return true;
+	}
+
+	bool result = true;
+
+	result &= _physical_port->SetSrtSocketOption(SRTO_RCVLATENCY, &latency, static_cast<int>(sizeof(latency)));
+	result &= _physical_port->SetSrtSocketOption(SRTO_PEERLATENCY, &latency, static_cast<int>(sizeof(latency)));
+
+	if(passphrase.IsEmpty() == false)
+	{
+		result &= _physical_port->SetSrtSocketOption(SRTO_PASSPHRASE, passphrase.CStr(), static_cast<int>(passphrase.GetLength()));
+	}
+
+	if(result == false)
+	{
+		logte("Could not set the options of SRT provider: %s", key.CStr());
+		return false;
+	}
+
+	g_port_options[key] = std::make_pair(latency, passphrase);
+
+	return true;
+}
+
+//====================================================================================================
+// GetConnectionMemoryData
+// - 미디어 정보를 기다리는 동안 보관하는 패킷 크기
+//====================================================================================================
+bool SrtProvider::GetConnectionMemoryData(std::vector<std::shared_ptr<pvd::ConnectionMemoryData>> &memories)
+{
+	std::lock_guard<std::mutex> lock(_stream_mutex);
+
+	for(const auto &item : _streams)
+	{
+		auto memory_data = std::make_shared<pvd::ConnectionMemoryData>();
+
+		memory_data->app_name = _application_info->GetName();
+		memory_data->stream_name = item.second->GetName();
+		memory_data->remote = item.second->GetRemote()->ToString();
+		memory_data->message_buffer_size = item.second->GetBufferedSize();
+
+		memories.push_back(memory_data);
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// GetTransportStatisticsData
+// - srt_bstats() of each connection
+//====================================================================================================
+bool SrtProvider::GetTransportStatisticsData(std::vector<std::shared_ptr<pvd::TransportStatisticsData>> &statistics)
+{
+	std::lock_guard<std::mutex> lock(_stream_mutex);
+
+	for(const auto &item : _streams)
+	{
+		auto &remote = item.second->GetRemote();
+		SRT_TRACEBSTATS stats {};
+
+		if(::srt_bstats(remote->GetSocket().GetSocket(), &stats, 0) == SRT_ERROR)
+		{
+			logtd("Could not get the statistics of %s: %s", remote->ToString().CStr(), srt_getlasterror_str());
+			continue;
+		}
+
+		auto statistics_data = std::make_shared<pvd::TransportStatisticsData>();
+
+		statistics_data->app_name = _application_info->GetName();
+		statistics_data->stream_name = item.second->GetName();
+		statistics_data->remote = remote->ToString();
+		statistics_data->rtt = stats.msRTT;
+		statistics_data->receive_rate = stats.mbpsRecvRate;
+		statistics_data->received_packets = stats.pktRecvTotal;
+		statistics_data->lost_packets = stats.pktRcvLossTotal;
+		statistics_data->retransmission_requests = stats.pktSentNAKTotal;
+		statistics_data->dropped_packets = stats.pktRcvDropTotal;
+
+		statistics.push_back(statistics_data);
+	}
+
+	return true;
+}
+
+std::shared_ptr<Application> SrtProvider::OnCreateApplication(const info::Application *application_info)
+{
+	return SrtApplication::Create(application_info);
+}
+
+//====================================================================================================
+// OnConnected
+// - PhysicalPortObserver 구현
+//====================================================================================================
+void SrtProvider::OnConnected(const std::shared_ptr<ov::Socket> &remote)
+{
+	char stream_id_buffer[SRT_PROVIDER_MAX_STREAM_ID_LENGTH + 1] = { 0 };
+	int stream_id_length = SRT_PROVIDER_MAX_STREAM_ID_LENGTH;
+
+	if(remote->GetSockOpt(SRTO_STREAMID, stream_id_buffer, &stream_id_length) == false)
+	{
+		Disconnect(remote);
+		return;
+	}
+
+	ov::String stream_id(stream_id_buffer, static_cast<size_t>(std::max(stream_id_length, 0)));
+	ov::String app_name;
+	ov::String stream_name;
+
+	if(SrtStreamId::Parse(stream_id, app_name, stream_name) == false)
+	{
+		logtw("Invalid stream id (%s) - remote(%s)", stream_id.CStr(), remote->ToString().CStr());
+		Disconnect(remote);
+		return;
+	}
+
+	if(app_name != _application_info->GetName())
+	{
+		// The connection is for another application which shares the port
+		return;
+	}
+
+	auto application = std::dynamic_pointer_cast<SrtApplication>(GetApplicationByName(app_name.CStr()));
+
+	if(application == nullptr)
+	{
+		logte("Cannot Find Applicaton - app(%s) stream(%s)", app_name.CStr(), stream_name.CStr());
+		Disconnect(remote);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_stream_mutex);
+
+	for(auto item = _streams.begin(); item != _streams.end(); ++item)
+	{
+		if(item->second->GetName() != stream_name)
+		{
+			continue;
+		}
+
+		if(_provider_info->IsBlockDuplicateStreamName())
+		{
+			logti("Duplicate Stream Input(reject) - app(%s) stream(%s) remote(%s)", app_name.CStr(), stream_name.CStr(), remote->ToString().CStr());
+			Disconnect(remote);
+			return;
+		}
+
+		logti("Duplicate Stream Input(change) - app(%s) stream(%s) remote(%s)", app_name.CStr(), stream_name.CStr(), remote->ToString().CStr());
+
+		Disconnect(item->second->GetRemote());
+		DeleteStream(item->second);
+		_streams.erase(item);
+		break;
+	}
+
+	auto stream = std::dynamic_pointer_cast<SrtStream>(application->MakeStream());
+
+	if(stream == nullptr)
+	{
+		logte("can not create stream - app(%s) stream(%s)", app_name.CStr(), stream_name.CStr());
+		Disconnect(remote);
+		return;
+	}
+
+	stream->SetName(stream_name.CStr());
+	stream->SetRemote(remote);
+
+	_streams[remote.get()] = stream;
+
+	logti("Srt input stream connected - stream(%s/%s) remote(%s)", app_name.CStr(), stream_name.CStr(), remote->ToString().CStr());
+}
+
+//====================================================================================================
+// OnDataReceived
+// - PhysicalPortObserver 구현
+// - The stream is created to the router when the media information is known
+//====================================================================================================
+void SrtProvider::OnDataReceived(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data)
+{
+	ov::MemoryTagScope memory_tag(ov::MemoryTag::Ingest);
+	OV_TRACE_SCOPE("provider", "SrtReceive");
+	std::lock_guard<std::mutex> lock(_stream_mutex);
+
+	auto item = _streams.find(remote.get());
+
+	if(item == _streams.end())
+	{
+		return;
+	}
+
+	auto stream = item->second;
+
+	stream->ParseData(data);
+
+	if(stream->IsCreated() == false)
+	{
+		if(stream->IsMediaInfoReady() == false)
+		{
+			return;
+		}
+
+		auto application = std::dynamic_pointer_cast<SrtApplication>(GetApplicationById(_application_info->GetId()));
+
+		if((application == nullptr) || (stream->AddTracks() == false))
+		{
+			logte("Could not create the stream - app(%s) stream(%s)", _application_info->GetName().CStr(), stream->GetName().CStr());
+
+			Disconnect(remote);
+			_streams.erase(item);
+			return;
+		}
+
+		// 라우터에 스트림이 생성되었다고 알림
+		if(application->CreateStream2(stream) == false)
+		{
+			Disconnect(remote);
+			_streams.erase(item);
+			return;
+		}
+
+		stream->SetCreated(true);
+
+		logti("Srt input stream create completed - stream(%s/%s) id(%u/%u) remote(%s)",
+		      _application_info->GetName().CStr(), stream->GetName().CStr(),
+		      _application_info->GetId(), stream->GetId(), remote->ToString().CStr());
+	}
+
+	auto &packets = stream->GetPackets();
+
+	if(packets.empty() == false)
+	{
+		auto application = std::dynamic_pointer_cast<SrtApplication>(GetApplicationById(_application_info->GetId()));
+
+		if(application != nullptr)
+		{
+			for(auto &packet : packets)
+			{
+				application->SendFrame(stream, std::move(packet));
+			}
+		}
+
+		stream->ClearPackets();
+	}
+}
+
+//====================================================================================================
+// OnDisconnected
+// - PhysicalPortObserver 구현
+//====================================================================================================
+void SrtProvider::OnDisconnected(const std::shared_ptr<ov::Socket> &remote, PhysicalPortDisconnectReason reason, const std::shared_ptr<const ov::Error> &error)
+{
+	std::lock_guard<std::mutex> lock(_stream_mutex);
+
+	auto item = _streams.find(remote.get());
+
+	if(item == _streams.end())
+	{
+		return;
+	}
+
+	logti("Srt input stream disconnected - stream(%s/%s) remote(%s) errors(%llu)",
+	      _application_info->GetName().CStr(), item->second->GetName().CStr(), remote->ToString().CStr(),
+	      static_cast<unsigned long long>(item->second->GetErrorCount()));
+
+	DeleteStream(item->second);
+	_streams.erase(item);
+}
+
+void SrtProvider::DeleteStream(const std::shared_ptr<SrtStream> &stream)
+{
+	if(stream->IsCreated() == false)
+	{
+		return;
+	}
+
+	auto application = std::dynamic_pointer_cast<SrtApplication>(GetApplicationById(_application_info->GetId()));
+
+	if(application != nullptr)
+	{
+		// 라우터에 스트림이 삭제되었다고 알림
+		application->DeleteStream2(stream);
+	}
+
+	stream->SetCreated(false);
+}
+
+void SrtProvider::Disconnect(const std::shared_ptr<ov::Socket> &remote)
+{
+	auto client_socket = std::dynamic_pointer_cast<ov::ClientSocket>(remote);
+
+	if((_physical_port != nullptr) && (client_socket != nullptr))
+	{
+		_physical_port->DisconnectClient(client_socket.get());
+	}
+}
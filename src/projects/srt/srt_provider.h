@@ -0,0 +1,69 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include "base/provider/provider.h"
+#include "base/provider/application.h"
+#include "physical_port/physical_port_manager.h"
+
+#include "srt_stream.h"
+#include "srt_stream_id.h"
+
+//====================================================================================================
+// SrtProvider
+// - Receives MPEG-TS (H.264/AAC) over SRT, the stream is specified with the stream id of the caller
+//   (see SrtStreamId)
+// - The latency/passphrase are set to the listening socket, and the accepted sockets inherit them
+//   (SRT 1.3.1 doesn't have the listen callback to set the options per connection), so the applications
+//   which share a port share the options of the first application
+//====================================================================================================
+class SrtProvider : public pvd::Provider, public PhysicalPortObserver
+{
+public:
+	static std::shared_ptr<SrtProvider> Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+
+	explicit SrtProvider(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+	~SrtProvider() override;
+
+	cfg::ProviderType GetProviderType() override
+	{
+		return cfg::ProviderType::Srt;
+	}
+
+	bool Start() override;
+	bool Stop() override;
+
+	bool GetConnectionMemoryData(std::vector<std::shared_ptr<pvd::ConnectionMemoryData>> &memories) override;
+	bool GetTransportStatisticsData(std::vector<std::shared_ptr<pvd::TransportStatisticsData>> &statistics) override;
+
+	std::shared_ptr<pvd::Application> OnCreateApplication(const info::Application *application_info) override;
+
+	//--------------------------------------------------------------------
+	// Implementation of PhysicalPortObserver
+	//--------------------------------------------------------------------
+	void OnConnected(const std::shared_ptr<ov::Socket> &remote) override;
+	void OnDataReceived(const std::shared_ptr<ov::Socket> &remote, const ov::SocketAddress &address, const std::shared_ptr<const ov::Data> &data) override;
+	void OnDisconnected(const std::shared_ptr<ov::Socket> &remote, PhysicalPortDisconnectReason reason, const std::shared_ptr<const ov::Error> &error) override;
+
+private:
+	bool SetSocketOptions(const ov::SocketAddress &address);
+
+	// _stream_mutex must be locked
+	void DeleteStream(const std::shared_ptr<SrtStream> &stream);
+	void Disconnect(const std::shared_ptr<ov::Socket> &remote);
+
+	const cfg::SrtProvider *_provider_info = nullptr;
+
+	std::shared_ptr<PhysicalPort> _physical_port;
+
+	std::mutex _stream_mutex;
+	// key: remote socket
+	std::map<ov::Socket *, std::shared_ptr<SrtStream>> _streams;
+};
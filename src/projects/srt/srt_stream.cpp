@@ -0,0 +1,283 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "srt_stream.h"
+
+#define OV_LOG_TAG "SrtStream"
+
+using namespace common;
+
+// ADTS sampling_frequency_index (ISO/IEC 14496-3 Table 1.18)
+static const int32_t kAdtsSampleRates[16] = {
+	96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050,
+	16000, 12000, 11025, 8000, 7350, 0, 0, 0
+};
+
+// Samples of an AAC frame
+#define SRT_STREAM_AAC_FRAME_SAMPLES        (1024)
+
+std::shared_ptr<SrtStream> SrtStream::Create()
+{
+	auto stream = std::make_shared<SrtStream>();
+	return stream;
+}
+
+SrtStream::SrtStream()
+	: _demuxer(std::bind(&SrtStream::OnPesPacket, this, std::placeholders::_1))
+{
+}
+
+SrtStream::~SrtStream()
+{
+}
+
+bool SrtStream::ParseData(const std::shared_ptr<const ov::Data> &data)
+{
+	return _demuxer.Parse(data->GetDataAs<uint8_t>(), data->GetLength());
+}
+
+bool SrtStream::IsMediaInfoReady() const
+{
+	if((_demuxer.IsProgramReady() == false) || ((_demuxer.HasVideo() == false) && (_demuxer.HasAudio() == false)))
+	{
+		return false;
+	}
+
+	return ((_demuxer.HasVideo() == false) || _has_video_info) &&
+	       ((_demuxer.HasAudio() == false) || _has_audio_info);
+}
+
+//====================================================================================================
+// AddTracks
+// - Track ids are same as RTMP (video: 0, audio: 1)
+//====================================================================================================
+bool SrtStream::AddTracks()
+{
+	if(IsMediaInfoReady() == false)
+	{
+		return false;
+	}
+
+	if(_demuxer.HasVideo())
+	{
+		auto new_track = std::make_shared<MediaTrack>();
+
+		new_track->SetId(0);
+		new_track->SetMediaType(MediaType::Video);
+		new_track->SetCodecId(MediaCodecId::H264);
+		new_track->SetWidth(static_cast<int32_t>(_sps_info.width));
+		new_track->SetHeight(static_cast<int32_t>(_sps_info.height));
+		new_track->SetFrameRate((_sps_info.framerate > 0.0) ? _sps_info.framerate : SRT_STREAM_DEFAULT_FRAMERATE);
+		new_track->SetTimeBase(1, 1000);
+
+		AddTrack(new_track);
+	}
+
+	if(_demuxer.HasAudio())
+	{
+		auto new_track = std::make_shared<MediaTrack>();
+
+		new_track->SetId(1);
+		new_track->SetMediaType(MediaType::Audio);
+		new_track->SetCodecId(MediaCodecId::Aac);
+		new_track->SetSampleRate(_audio_samplerate);
+		new_track->SetTimeBase(1, 1000);
+		new_track->GetSample().SetFormat(common::AudioSample::Format::S16);
+
+		if(_audio_channels == 1)
+		{
+			new_track->GetChannel().SetLayout(common::AudioChannel::Layout::LayoutMono);
+		}
+		else
+		{
+			new_track->GetChannel().SetLayout(common::AudioChannel::Layout::LayoutStereo);
+		}
+
+		AddTrack(new_track);
+	}
+
+	return true;
+}
+
+void SrtStream::OnPesPacket(const TsPesPacket &pes)
+{
+	if(pes.dts < 0)
+	{
+		// The timestamp is required for every access unit
+		return;
+	}
+
+	switch(pes.type)
+	{
+		case TsElementaryType::H264:
+			ProcessH264(pes);
+			break;
+
+		case TsElementaryType::Aac:
+			ProcessAac(pes);
+			break;
+
+		default:
+			break;
+	}
+}
+
+//====================================================================================================
+// ProcessH264
+// - A PES is an access unit (Annex-B), MediaRouteStream passes the Annex-B bitstream as it is
+//====================================================================================================
+void SrtStream::ProcessH264(const TsPesPacket &pes)
+{
+	const uint8_t *end = pes.data + pes.data_size;
+	bool is_key_frame = false;
+
+	for(auto start_code = ov::FindNalStartCode(pes.data, end); start_code < end;)
+	{
+		auto nal = start_code + 3;
+		auto next_start_code = ov::FindNalStartCode(nal, end);
+
+		if(nal < end)
+		{
+			int nal_type = nal[0] & 0x1F;
+
+			if(nal_type == 5)
+			{
+				// IDR
+				is_key_frame = true;
+			}
+			else if((nal_type == 7) && (_has_video_info == false))
+			{
+				if(H264SpsParser::Parse(nal, static_cast<size_t>(next_start_code - nal), _sps_info))
+				{
+					logtd("SPS is parsed (%ux%u, %.2f fps)", _sps_info.width, _sps_info.height, _sps_info.framerate);
+					_has_video_info = true;
+				}
+			}
+		}
+
+		start_code = next_start_code;
+	}
+
+	int64_t dts = GetMilliseconds(pes.dts);
+	// PTS - DTS (33 bits)
+	int64_t composition_time = (pes.pts - pes.dts) & TS_TIMESTAMP_MASK;
+
+	if(composition_time > (TS_TIMESTAMP_MASK / 2))
+	{
+		composition_time -= (TS_TIMESTAMP_MASK + 1);
+	}
+
+	if((dts < 0) || (composition_time < 0))
+	{
+		return;
+	}
+
+	AppendPacket(std::make_unique<MediaPacket>(MediaType::Video,
+	                                           0,
+	                                           pes.data,
+	                                           static_cast<int32_t>(pes.data_size),
+	                                           dts,
+	                                           is_key_frame ? MediaPacketFlag::Key : MediaPacketFlag::NoFlag,
+	                                           composition_time * 1000 / TS_TIMESTAMP_TIMEBASE));
+}
+
+//====================================================================================================
+// ProcessAac
+// - A PES can contain several ADTS frames, each frame is sent as a packet (same as RTMP)
+//====================================================================================================
+void SrtStream::ProcessAac(const TsPesPacket &pes)
+{
+	const uint8_t *data = pes.data;
+	size_t remained = pes.data_size;
+	int64_t frame_index = 0;
+
+	while(remained >= 7)
+	{
+		if((data[0] != 0xFF) || ((data[1] & 0xF0) != 0xF0))
+		{
+			logtd("Invalid ADTS sync word");
+			return;
+		}
+
+		int sampling_frequency_index = (data[2] >> 2) & 0x0F;
+		int channel_configuration = ((data[2] & 0x01) << 2) | ((data[3] >> 6) & 0x03);
+		size_t frame_length = (static_cast<size_t>(data[3] & 0x03) << 11) | (static_cast<size_t>(data[4]) << 3) | (data[5] >> 5);
+		int32_t samplerate = kAdtsSampleRates[sampling_frequency_index];
+
+		if((frame_length < 7) || (frame_length > remained) || (samplerate == 0))
+		{
+			logtd("Invalid ADTS frame (length: %zu, remained: %zu)", frame_length, remained);
+			return;
+		}
+
+		if(_has_audio_info == false)
+		{
+			_audio_samplerate = samplerate;
+			_audio_channels = channel_configuration;
+			_has_audio_info = true;
+
+			logtd("ADTS header is parsed (%d Hz, %d channels)", _audio_samplerate, _audio_channels);
+		}
+
+		int64_t pts = GetMilliseconds(pes.pts + (frame_index * SRT_STREAM_AAC_FRAME_SAMPLES * TS_TIMESTAMP_TIMEBASE / samplerate));
+
+		if(pts >= 0)
+		{
+			AppendPacket(std::make_unique<MediaPacket>(MediaType::Audio,
+			                                           1,
+			                                           data,
+			                                           static_cast<int32_t>(frame_length),
+			                                           pts,
+			                                           MediaPacketFlag::Key));
+		}
+
+		data += frame_length;
+		remained -= frame_length;
+		frame_index++;
+	}
+}
+
+void SrtStream::AppendPacket(std::unique_ptr<MediaPacket> packet)
+{
+	if((_is_created == false) && (_packets.size() >= SRT_STREAM_MAX_PENDING_PACKETS))
+	{
+		_buffered_size -= _packets.front()->GetData()->GetLength();
+		_packets.erase(_packets.begin());
+	}
+
+	// The packets which wait for the stream to be created are also counted to the Ingest latency
+	packet->SetIngestTime(ov::LatencyHistogram::GetCurrentMicroseconds());
+
+	_buffered_size += packet->GetData()->GetLength();
+	_packets.push_back(std::move(packet));
+}
+
+int64_t SrtStream::GetMilliseconds(int64_t timestamp)
+{
+	if(_last_timestamp < 0)
+	{
+		_base_timestamp = timestamp;
+		_last_timestamp = timestamp;
+	}
+
+	// The difference from the last timestamp (the timestamps of the tracks can be decreased slightly)
+	int64_t delta = (timestamp - _last_timestamp) & TS_TIMESTAMP_MASK;
+
+	if(delta > (TS_TIMESTAMP_MASK / 2))
+	{
+		delta -= (TS_TIMESTAMP_MASK + 1);
+	}
+
+	int64_t unwrapped = _last_timestamp + delta;
+
+	if(delta > 0)
+	{
+		_last_timestamp = unwrapped;
+	}
+
+	return (unwrapped - _base_timestamp) * 1000 / TS_TIMESTAMP_TIMEBASE;
+}
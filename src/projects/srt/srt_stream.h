@@ -0,0 +1,117 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "base/common_types.h"
+#include "base/provider/stream.h"
+#include "base/media_route/media_buffer.h"
+#include "base/ovsocket/ovsocket.h"
+
+#include "ts_demuxer.h"
+#include "h264_sps_parser.h"
+
+// Packets which are kept until the media information is known (the older packets are dropped)
+#define SRT_STREAM_MAX_PENDING_PACKETS      (300)
+// Framerate of the video if the SPS has no timing information
+#define SRT_STREAM_DEFAULT_FRAMERATE        (30.0)
+
+using namespace pvd;
+
+//====================================================================================================
+// SrtStream
+// - A stream of a SRT connection, demuxes the MPEG-TS to the MediaPackets
+// - The stream is created to the router after the media information (SPS, ADTS header) is known
+// - Timestamps are converted to 1/1000 (same as RTMP) from the 33 bits of 90kHz
+//====================================================================================================
+class SrtStream : public Stream
+{
+public:
+	static std::shared_ptr<SrtStream> Create();
+
+public:
+	explicit SrtStream();
+	~SrtStream() final;
+
+	void SetRemote(const std::shared_ptr<ov::Socket> &remote)
+	{
+		_remote = remote;
+	}
+
+	const std::shared_ptr<ov::Socket> &GetRemote() const
+	{
+		return _remote;
+	}
+
+	// Demuxes the TS packets, the MediaPackets are appended to the packet list
+	bool ParseData(const std::shared_ptr<const ov::Data> &data);
+
+	// true if the tracks can be made (the PMT and the first frame of each elementary stream are parsed)
+	bool IsMediaInfoReady() const;
+	bool AddTracks();
+
+	bool IsCreated() const
+	{
+		return _is_created;
+	}
+
+	void SetCreated(bool created)
+	{
+		_is_created = created;
+	}
+
+	std::vector<std::unique_ptr<MediaPacket>> &GetPackets()
+	{
+		return _packets;
+	}
+
+	void ClearPackets()
+	{
+		_packets.clear();
+		_buffered_size = 0;
+	}
+
+	uint64_t GetErrorCount() const
+	{
+		return _demuxer.GetErrorCount();
+	}
+
+	// Bytes of the packets which are waiting for the media information
+	size_t GetBufferedSize() const
+	{
+		return _buffered_size;
+	}
+
+private:
+	void OnPesPacket(const TsPesPacket &pes);
+	void ProcessH264(const TsPesPacket &pes);
+	void ProcessAac(const TsPesPacket &pes);
+
+	void AppendPacket(std::unique_ptr<MediaPacket> packet);
+
+	// Converts the timestamp (90kHz) to the milliseconds from the first timestamp of the stream
+	int64_t GetMilliseconds(int64_t timestamp);
+
+	std::shared_ptr<ov::Socket> _remote;
+	TsDemuxer _demuxer;
+
+	bool _is_created = false;
+
+	bool _has_video_info = false;
+	H264SpsInfo _sps_info;
+
+	bool _has_audio_info = false;
+	int32_t _audio_samplerate = 0;
+	int32_t _audio_channels = 0;
+
+	// First/last timestamp (90kHz, unwrapped)
+	int64_t _base_timestamp = -1;
+	int64_t _last_timestamp = -1;
+
+	std::vector<std::unique_ptr<MediaPacket>> _packets;
+	size_t _buffered_size = 0;
+};
@@ -0,0 +1,46 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "srt_stream_id.h"
+
+//====================================================================================================
+// Parse
+// - "<app>/<stream>"
+// - "#!::r=<app>/<stream>[,key=value...]" (SRT Access Control, https://github.com/Haivision/srt/blob/master/docs/AccessControl.md)
+//====================================================================================================
+bool SrtStreamId::Parse(const ov::String &stream_id, ov::String &app_name, ov::String &stream_name)
+{
+	ov::String resource = stream_id;
+
+	if(stream_id.IndexOf("#!::") == 0)
+	{
+		resource = "";
+
+		for(auto &token : stream_id.Substring(4).Split(","))
+		{
+			auto position = token.IndexOf('=');
+
+			if((position > 0) && (token.Substring(0, static_cast<size_t>(position)) == "r"))
+			{
+				resource = token.Substring(position + 1);
+				break;
+			}
+		}
+	}
+
+	auto position = resource.IndexOf('/');
+
+	if(position <= 0)
+	{
+		return false;
+	}
+
+	app_name = resource.Substring(0, static_cast<size_t>(position));
+	stream_name = resource.Substring(position + 1);
+
+	return (stream_name.IsEmpty() == false) && (stream_name.IndexOf('/') < 0);
+}
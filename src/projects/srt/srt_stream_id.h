@@ -0,0 +1,27 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+// Length of SRTO_STREAMID (SRT limits it to 512 bytes)
+#define SRT_PROVIDER_MAX_STREAM_ID_LENGTH   (512)
+// Range of SRTO_PASSPHRASE
+#define SRT_PROVIDER_MIN_PASSPHRASE_LENGTH  (10)
+#define SRT_PROVIDER_MAX_PASSPHRASE_LENGTH  (79)
+
+//====================================================================================================
+// SrtStreamId
+// - The stream id of the callers, which is shared by SRT provider and the SRT listener of MPEG-TS publisher
+//   ("<app>/<stream>" or "#!::r=<app>/<stream>,...")
+//====================================================================================================
+class SrtStreamId
+{
+public:
+	static bool Parse(const ov::String &stream_id, ov::String &app_name, ov::String &stream_name);
+};
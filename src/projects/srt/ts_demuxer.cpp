@@ -0,0 +1,427 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "ts_demuxer.h"
+
+#include <string.h>
+
+#define OV_LOG_TAG "TsDemuxer"
+
+TsDemuxer::TsDemuxer(PesCallback callback)
+	: _callback(std::move(callback))
+{
+}
+
+//====================================================================================================
+// Parse
+// - SRT delivers 7 TS packets in a message usually, so the data are parsed without copying
+//   unless a packet is split between the inputs
+//====================================================================================================
+bool TsDemuxer::Parse(const uint8_t *data, size_t data_size)
+{
+	if(_remained_size > 0)
+	{
+		size_t copy_size = std::min(data_size, TS_PACKET_SIZE - _remained_size);
+
+		::memcpy(_remained + _remained_size, data, copy_size);
+		_remained_size += copy_size;
+		data += copy_size;
+		data_size -= copy_size;
+
+		if(_remained_size < TS_PACKET_SIZE)
+		{
+			return true;
+		}
+
+		ParsePacket(_remained);
+		_remained_size = 0;
+	}
+
+	while(data_size >= TS_PACKET_SIZE)
+	{
+		if(data[0] != TS_SYNC_BYTE)
+		{
+			// Lost the sync, find the next sync byte
+			_error_count++;
+
+			auto sync = static_cast<const uint8_t *>(::memchr(data + 1, TS_SYNC_BYTE, data_size - 1));
+
+			if(sync == nullptr)
+			{
+				return false;
+			}
+
+			data_size -= (sync - data);
+			data = sync;
+			continue;
+		}
+
+		ParsePacket(data);
+
+		data += TS_PACKET_SIZE;
+		data_size -= TS_PACKET_SIZE;
+	}
+
+	if(data_size > 0)
+	{
+		::memcpy(_remained, data, data_size);
+		_remained_size = data_size;
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// ParsePacket
+// - ISO/IEC 13818-1 2.4.3.2 Transport Stream packet layer
+//====================================================================================================
+bool TsDemuxer::ParsePacket(const uint8_t *packet)
+{
+	bool transport_error = (packet[1] & 0x80) != 0;
+	bool unit_start = (packet[1] & 0x40) != 0;
+	auto pid = static_cast<uint16_t>(((packet[1] & 0x1F) << 8) | packet[2]);
+	int adaptation_field_control = (packet[3] >> 4) & 0x03;
+	int continuity_counter = packet[3] & 0x0F;
+
+	if(transport_error)
+	{
+		_error_count++;
+		return false;
+	}
+
+	if((pid == TS_PID_NULL) || ((adaptation_field_control & 0x01) == 0))
+	{
+		// No payload
+		return true;
+	}
+
+	size_t offset = 4;
+
+	if(adaptation_field_control & 0x02)
+	{
+		offset += 1 + packet[4];
+
+		if(offset >= TS_PACKET_SIZE)
+		{
+			_error_count++;
+			return false;
+		}
+	}
+
+	const uint8_t *payload = packet + offset;
+	size_t payload_size = TS_PACKET_SIZE - offset;
+
+	if(pid == TS_PID_PAT)
+	{
+		ParsePat(payload, payload_size, unit_start);
+		return true;
+	}
+
+	if(pid == _pmt_pid)
+	{
+		ParsePmt(payload, payload_size, unit_start);
+		return true;
+	}
+
+	auto item = _pes_buffers.find(pid);
+
+	if(item == _pes_buffers.end())
+	{
+		// Not a elementary stream of interest
+		return true;
+	}
+
+	auto &buffer = item->second;
+
+	if((buffer.continuity_counter >= 0) && (((buffer.continuity_counter + 1) & 0x0F) != continuity_counter))
+	{
+		if(buffer.continuity_counter != continuity_counter)
+		{
+			// Some packets are lost, the PES being assembled is broken
+			logtd("Discontinuity detected (pid: %u, expected: %d, actual: %d)", pid, (buffer.continuity_counter + 1) & 0x0F, continuity_counter);
+
+			_error_count++;
+			buffer.broken = true;
+		}
+		else
+		{
+			// Duplicated packet
+			return true;
+		}
+	}
+
+	buffer.continuity_counter = continuity_counter;
+
+	ParsePes(buffer, pid, payload, payload_size, unit_start);
+
+	return true;
+}
+
+//====================================================================================================
+// ParsePat
+// - ISO/IEC 13818-1 2.4.4.3 Program association Table
+// - The first program is used
+//====================================================================================================
+void TsDemuxer::ParsePat(const uint8_t *payload, size_t payload_size, bool unit_start)
+{
+	if((unit_start == false) || (payload_size < 1))
+	{
+		return;
+	}
+
+	size_t pointer_field = payload[0];
+
+	if((1 + pointer_field + 8) > payload_size)
+	{
+		return;
+	}
+
+	const uint8_t *section = payload + 1 + pointer_field;
+	size_t section_size = payload_size - 1 - pointer_field;
+
+	if(section[0] != 0x00)
+	{
+		// table_id must be 0x00 (program_association_section)
+		return;
+	}
+
+	size_t section_length = static_cast<size_t>(((section[1] & 0x0F) << 8) | section[2]);
+
+	// section_length includes CRC_32
+	if((section_length < (5 + 4)) || ((3 + section_length) > section_size))
+	{
+		_error_count++;
+		return;
+	}
+
+	const uint8_t *entry = section + 8;
+	const uint8_t *end = section + 3 + section_length - 4;
+
+	for(; (entry + 4) <= end; entry += 4)
+	{
+		auto program_number = static_cast<uint16_t>((entry[0] << 8) | entry[1]);
+		auto pid = static_cast<uint16_t>(((entry[2] & 0x1F) << 8) | entry[3]);
+
+		if(program_number == 0)
+		{
+			// network_PID
+			continue;
+		}
+
+		if(_pmt_pid != pid)
+		{
+			logtd("PMT pid: %u (program: %u)", pid, program_number);
+			_pmt_pid = pid;
+		}
+
+		break;
+	}
+}
+
+//====================================================================================================
+// ParsePmt
+// - ISO/IEC 13818-1 2.4.4.8 Program Map Table
+// - The elementary streams are not changed after the PMT is parsed once
+//====================================================================================================
+void TsDemuxer::ParsePmt(const uint8_t *payload, size_t payload_size, bool unit_start)
+{
+	if(_program_ready || (unit_start == false) || (payload_size < 1))
+	{
+		return;
+	}
+
+	size_t pointer_field = payload[0];
+
+	if((1 + pointer_field + 12) > payload_size)
+	{
+		return;
+	}
+
+	const uint8_t *section = payload + 1 + pointer_field;
+	size_t section_size = payload_size - 1 - pointer_field;
+
+	if(section[0] != 0x02)
+	{
+		// table_id must be 0x02 (TS_program_map_section)
+		return;
+	}
+
+	size_t section_length = static_cast<size_t>(((section[1] & 0x0F) << 8) | section[2]);
+
+	if((section_length < (9 + 4)) || ((3 + section_length) > section_size))
+	{
+		_error_count++;
+		return;
+	}
+
+	size_t program_info_length = static_cast<size_t>(((section[10] & 0x0F) << 8) | section[11]);
+	const uint8_t *entry = section + 12 + program_info_length;
+	const uint8_t *end = section + 3 + section_length - 4;
+
+	for(; (entry + 5) <= end;)
+	{
+		uint8_t stream_type = entry[0];
+		auto pid = static_cast<uint16_t>(((entry[1] & 0x1F) << 8) | entry[2]);
+		size_t es_info_length = static_cast<size_t>(((entry[3] & 0x0F) << 8) | entry[4]);
+
+		if((stream_type == TS_STREAM_TYPE_H264) && (_video_pid == TS_PID_NULL))
+		{
+			_video_pid = pid;
+			_pes_buffers[pid].type = TsElementaryType::H264;
+		}
+		else if((stream_type == TS_STREAM_TYPE_AAC_ADTS) && (_audio_pid == TS_PID_NULL))
+		{
+			_audio_pid = pid;
+			_pes_buffers[pid].type = TsElementaryType::Aac;
+		}
+		else
+		{
+			logtd("Unsupported elementary stream is ignored (pid: %u, stream_type: 0x%02X)", pid, stream_type);
+		}
+
+		entry += 5 + es_info_length;
+	}
+
+	logtd("PMT is parsed (video pid: %u, audio pid: %u)", _video_pid, _audio_pid);
+
+	_program_ready = true;
+}
+
+//====================================================================================================
+// ParsePes
+// - Assembles the PES, the PES is flushed when the next PES is started or PES_packet_length is reached
+//====================================================================================================
+void TsDemuxer::ParsePes(PesBuffer &buffer, uint16_t pid, const uint8_t *payload, size_t payload_size, bool unit_start)
+{
+	if(unit_start)
+	{
+		FlushPes(buffer, pid);
+
+		buffer.broken = false;
+
+		if((payload_size >= 6) && (payload[0] == 0x00) && (payload[1] == 0x00) && (payload[2] == 0x01))
+		{
+			size_t pes_packet_length = static_cast<size_t>((payload[4] << 8) | payload[5]);
+			buffer.expected_size = (pes_packet_length > 0) ? (pes_packet_length + 6) : 0;
+		}
+		else
+		{
+			_error_count++;
+			buffer.broken = true;
+		}
+	}
+	else if(buffer.data.empty())
+	{
+		// Waiting for the start of a PES
+		return;
+	}
+
+	if(buffer.broken)
+	{
+		buffer.data.clear();
+		return;
+	}
+
+	if((buffer.data.size() + payload_size) > TS_MAX_PES_SIZE)
+	{
+		logtw("PES is too large, dropped (pid: %u, size: %zu)", pid, buffer.data.size() + payload_size);
+
+		_error_count++;
+		buffer.data.clear();
+		buffer.broken = true;
+		return;
+	}
+
+	buffer.data.insert(buffer.data.end(), payload, payload + payload_size);
+
+	if((buffer.expected_size > 0) && (buffer.data.size() >= buffer.expected_size))
+	{
+		FlushPes(buffer, pid);
+	}
+}
+
+//====================================================================================================
+// FlushPes
+// - ISO/IEC 13818-1 2.4.3.6 PES packet
+//====================================================================================================
+void TsDemuxer::FlushPes(PesBuffer &buffer, uint16_t pid)
+{
+	if(buffer.data.empty())
+	{
+		return;
+	}
+
+	if(buffer.broken || (buffer.data.size() < 9))
+	{
+		buffer.data.clear();
+		return;
+	}
+
+	const uint8_t *pes = buffer.data.data();
+	size_t pes_size = buffer.data.size();
+
+	if(buffer.expected_size > 0)
+	{
+		if(pes_size < buffer.expected_size)
+		{
+			// The rest of the PES is lost
+			_error_count++;
+			buffer.data.clear();
+			return;
+		}
+
+		// Stuffing bytes of the last TS packet
+		pes_size = buffer.expected_size;
+	}
+
+	int pts_dts_flags = (pes[7] >> 6) & 0x03;
+	size_t header_data_length = pes[8];
+	size_t payload_offset = 9 + header_data_length;
+
+	if(payload_offset > pes_size)
+	{
+		_error_count++;
+		buffer.data.clear();
+		return;
+	}
+
+	TsPesPacket packet;
+
+	packet.type = buffer.type;
+	packet.pid = pid;
+
+	if((pts_dts_flags & 0x02) && (header_data_length >= 5))
+	{
+		packet.pts = ReadTimestamp(pes + 9);
+		packet.dts = packet.pts;
+
+		if((pts_dts_flags == 0x03) && (header_data_length >= 10))
+		{
+			packet.dts = ReadTimestamp(pes + 14);
+		}
+	}
+
+	packet.data = pes + payload_offset;
+	packet.data_size = pes_size - payload_offset;
+
+	if(packet.data_size > 0)
+	{
+		_callback(packet);
+	}
+
+	buffer.data.clear();
+}
+
+int64_t TsDemuxer::ReadTimestamp(const uint8_t *data)
+{
+	// '001x' + PTS[32..30] + marker, PTS[29..15] + marker, PTS[14..0] + marker
+	return (static_cast<int64_t>(data[0] & 0x0E) << 29) |
+	       (static_cast<int64_t>(data[1]) << 22) |
+	       (static_cast<int64_t>(data[2] & 0xFE) << 14) |
+	       (static_cast<int64_t>(data[3]) << 7) |
+	       (static_cast<int64_t>(data[4]) >> 1);
+}
@@ -0,0 +1,122 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <functional>
+#include <map>
+
+#define TS_PACKET_SIZE                  (188)
+#define TS_SYNC_BYTE                    (0x47)
+#define TS_PID_PAT                      (0x0000)
+#define TS_PID_NULL                     (0x1FFF)
+
+// stream_type of the PMT (ISO/IEC 13818-1 Table 2-34)
+#define TS_STREAM_TYPE_AAC_ADTS         (0x0F)
+#define TS_STREAM_TYPE_H264             (0x1B)
+
+// The PES which is larger than this is dropped (broken stream)
+#define TS_MAX_PES_SIZE                 (8 * 1024 * 1024)
+
+// The timestamps of the PES are 33 bits of 90kHz
+#define TS_TIMESTAMP_MASK               (0x1FFFFFFFFLL)
+#define TS_TIMESTAMP_TIMEBASE           (90000)
+
+enum class TsElementaryType : int32_t
+{
+	Unknown,
+	H264,
+	Aac,
+};
+
+struct TsPesPacket
+{
+	TsElementaryType type = TsElementaryType::Unknown;
+	uint16_t pid = 0;
+
+	// 90kHz, -1 if the PES has no timestamp (dts is same as pts if the PES has no DTS)
+	int64_t pts = -1;
+	int64_t dts = -1;
+
+	// Payload of the PES (elementary stream)
+	const uint8_t *data = nullptr;
+	size_t data_size = 0;
+};
+
+//====================================================================================================
+// TsDemuxer
+// - Parses the PAT/PMT, and assembles the PES of the first H.264 and AAC(ADTS) elementary streams
+// - The input don't need to be aligned to the TS packets (the remainder is kept until the next input)
+// - The PSI sections are expected to fit in a TS packet (which is true for the encoders in practice)
+//====================================================================================================
+class TsDemuxer
+{
+public:
+	typedef std::function<void(const TsPesPacket &pes)> PesCallback;
+
+	explicit TsDemuxer(PesCallback callback);
+
+	bool Parse(const uint8_t *data, size_t data_size);
+
+	// true if the PMT is parsed (the elementary streams are known)
+	bool IsProgramReady() const
+	{
+		return _program_ready;
+	}
+
+	bool HasVideo() const
+	{
+		return _video_pid != TS_PID_NULL;
+	}
+
+	bool HasAudio() const
+	{
+		return _audio_pid != TS_PID_NULL;
+	}
+
+	// Number of the TS packets which are lost (continuity counter) or broken
+	uint64_t GetErrorCount() const
+	{
+		return _error_count;
+	}
+
+private:
+	struct PesBuffer
+	{
+		TsElementaryType type = TsElementaryType::Unknown;
+		std::vector<uint8_t> data;
+		// PES_packet_length + 6, 0 if unbounded (video)
+		size_t expected_size = 0;
+		int continuity_counter = -1;
+		bool broken = false;
+	};
+
+	bool ParsePacket(const uint8_t *packet);
+	void ParsePat(const uint8_t *payload, size_t payload_size, bool unit_start);
+	void ParsePmt(const uint8_t *payload, size_t payload_size, bool unit_start);
+	void ParsePes(PesBuffer &buffer, uint16_t pid, const uint8_t *payload, size_t payload_size, bool unit_start);
+	void FlushPes(PesBuffer &buffer, uint16_t pid);
+
+	static int64_t ReadTimestamp(const uint8_t *data);
+
+	PesCallback _callback;
+
+	// Remainder of the input which is not a whole TS packet
+	uint8_t _remained[TS_PACKET_SIZE];
+	size_t _remained_size = 0;
+
+	uint16_t _pmt_pid = TS_PID_NULL;
+	uint16_t _video_pid = TS_PID_NULL;
+	uint16_t _audio_pid = TS_PID_NULL;
+	bool _program_ready = false;
+
+	std::map<uint16_t, PesBuffer> _pes_buffers;
+
+	uint64_t _error_count = 0;
+};
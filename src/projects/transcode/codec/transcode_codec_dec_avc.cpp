@@ -7,6 +7,7 @@
 //
 //==============================================================================
 #include "transcode_codec_dec_avc.h"
+#include "transcode_frame.h"
 
 #define OV_LOG_TAG "TranscodeCodec"
 
@@ -21,6 +22,13 @@ std::unique_ptr<MediaFrame> OvenCodecImplAvcodecDecAVC::RecvBuffer(TranscodeResu
 	}
 	else if(ret == AVERROR_EOF)
 	{
+		if(_draining)
+		{
+			// All frames are returned after SendEndOfStream()
+			*result = TranscodeResult::EndOfFile;
+			return nullptr;
+		}
+
 		logtw("Error receiving a packet for decoding : AVERROR_EOF");
 		*result = TranscodeResult::DataError;
 		return nullptr;
@@ -58,16 +66,26 @@ std::unique_ptr<MediaFrame> OvenCodecImplAvcodecDecAVC::RecvBuffer(TranscodeResu
 		decoded_frame->SetWidth(_frame->width);
 		decoded_frame->SetHeight(_frame->height);
 		decoded_frame->SetFormat(_frame->format);
-        decoded_frame->SetPts(_parser->pts - (33 * 2));
-		//decoded_frame->SetPts((_frame->pts == AV_NOPTS_VALUE) ? -1 : _frame->pts);
+		// The pts of the packet is returned with the picture (the pictures are reordered by the codec)
+		decoded_frame->SetPts((_frame->pts == AV_NOPTS_VALUE) ? -1 : _frame->pts);
 
 		decoded_frame->SetStride(_frame->linesize[0], 0);
 		decoded_frame->SetStride(_frame->linesize[1], 1);
 		decoded_frame->SetStride(_frame->linesize[2], 2);
 
-		decoded_frame->SetBuffer(_frame->data[0], decoded_frame->GetStride(0) * decoded_frame->GetHeight(), 0);        // Y-Plane
-		decoded_frame->SetBuffer(_frame->data[1], decoded_frame->GetStride(1) * decoded_frame->GetHeight() / 2, 1);    // Cb Plane
-		decoded_frame->SetBuffer(_frame->data[2], decoded_frame->GetStride(2) * decoded_frame->GetHeight() / 2, 2);        // Cr Plane
+		// Keep the reference of the decoded picture instead of copying the planes
+		// (if the hardware decoder is used, the picture is in the memory of the device)
+		auto native_frame = TranscodeFrame::MakeReference(_frame);
+
+		if(native_frame == nullptr)
+		{
+			logte("Could not reference the decoded frame");
+			av_frame_unref(_frame);
+			*result = TranscodeResult::DataError;
+			return nullptr;
+		}
+
+		decoded_frame->SetNativeFrame(std::move(native_frame));
 
 #if DEBUG_PREVIEW_ENABLE && DEBUG_PREVIEW    // DEBUG for OpenCV
 		Mat *display_frame = nullptr;
@@ -107,79 +125,54 @@ std::unique_ptr<MediaFrame> OvenCodecImplAvcodecDecAVC::RecvBuffer(TranscodeResu
 		auto buffer = std::move(_input_buffer.front());
 		_input_buffer.erase(_input_buffer.begin(), _input_buffer.begin() + 1);
 
-		auto packet_data = buffer->GetData();
-
-		int64_t remained = packet_data->GetLength();
-		off_t offset = 0LL;
-		int64_t pts = buffer->GetPts();
-        int64_t cts  = buffer->GetCts();
-		auto data = packet_data->GetDataAs<uint8_t>();
-
-		static int64_t first_pts = -1;
-
-		if(first_pts == -1)
+		// The providers deliver the complete access units, so the packet is sent without the parser
+		if(MakePacketReference(buffer->GetData(), _pkt) == false)
 		{
-			first_pts = pts;
+			logte("Could not make a packet for decoding");
+			*result = TranscodeResult::DataError;
+			return nullptr;
 		}
 
-        // logtd("decode frame - pts(%lld) cts(%lld)", buffer->GetPts(), buffer->GetCts());
-
-		while(remained > 0)
-		{
-			av_init_packet(_pkt);
-
-			int parsed_size = av_parser_parse2(_parser, _context, &_pkt->data, &_pkt->size,
-			                                   data + offset, static_cast<int>(remained), pts, pts, 0);
-
-			if(parsed_size < 0)
-			{
-				logte("An error occurred while parsing: %d", parsed_size);
-				*result = TranscodeResult::ParseError;
-				return nullptr;
-			}
+		_pkt->pts = buffer->GetPts();
+		_pkt->dts = buffer->GetPts();
+		_pkt->flags = (buffer->GetFlags() == MediaPacketFlag::Key) ? AV_PKT_FLAG_KEY : 0;
 
-			if(_pkt->size > 0)
-			{
-				_pkt->pts = _parser->pts;
-				_pkt->flags = (_parser->key_frame == 1) ? AV_PKT_FLAG_KEY : 0;
-
-				ret = avcodec_send_packet(_context, _pkt);
-
-				if(ret == AVERROR(EAGAIN))
-				{
-					// Need more data
-				}
-				else if(ret == AVERROR_EOF)
-				{
-					logte("An error occurred while sending a packet for decoding: End of file (%d)", ret);
-				}
-				else if(ret == AVERROR(EINVAL))
-				{
-					logte("An error occurred while sending a packet for decoding: Invalid argument (%d)", ret);
-					*result = TranscodeResult::DataError;
-					return nullptr;
-				}
-				else if(ret == AVERROR(ENOMEM))
-				{
-					logte("An error occurred while sending a packet for decoding: No memory (%d)", ret);
-				}
-				else if(ret < 0)
-				{
-					logte("An error occurred while sending a packet for decoding: Unhandled error (%d)", ret);
-					*result = TranscodeResult::DataError;
-					return nullptr;
-				}
-			}
+		ret = avcodec_send_packet(_context, _pkt);
 
-			OV_ASSERT(
-				remained >= parsed_size,
-				"Current data size MUST greater than parsed_size, but data size: %ld, parsed_size: %ld",
-				remained, parsed_size
-			);
+		// The codec has its own reference if it is needed
+		av_packet_unref(_pkt);
 
-			offset += parsed_size;
-			remained -= parsed_size;
+		if(ret == AVERROR(EAGAIN))
+		{
+			// Need more data
+		}
+		else if(ret == AVERROR_EOF)
+		{
+			logte("An error occurred while sending a packet for decoding: End of file (%d)", ret);
+		}
+		else if(ret == AVERROR(EINVAL))
+		{
+			logte("An error occurred while sending a packet for decoding: Invalid argument (%d)", ret);
+			*result = TranscodeResult::DataError;
+			return nullptr;
 		}
+		else if(ret == AVERROR(ENOMEM))
+		{
+			logte("An error occurred while sending a packet for decoding: No memory (%d)", ret);
+		}
+		else if(ret < 0)
+		{
+			logte("An error occurred while sending a packet for decoding: Unhandled error (%d)", ret);
+			*result = TranscodeResult::DataError;
+			return nullptr;
+		}
+	}
+	else if(_end_of_stream && (_draining == false))
+	{
+		_draining = true;
+
+		// Enters the draining mode of the codec, the delayed frames are returned
+		avcodec_send_packet(_context, nullptr);
 	}
 
 	*result = TranscodeResult::NoData;
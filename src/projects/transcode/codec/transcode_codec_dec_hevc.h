@@ -0,0 +1,20 @@
+//==============================================================================
+//
+//  Transcode
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "transcode_codec_dec_avc.h"
+
+// The decoding/parsing flow of the Annex-B bitstream is same as AVC
+class OvenCodecImplAvcodecDecHEVC : public OvenCodecImplAvcodecDecAVC
+{
+public:
+	AVCodecID GetCodecID() const noexcept override
+	{
+		return AV_CODEC_ID_HEVC;
+	}
+};
@@ -7,6 +7,7 @@
 //
 //==============================================================================
 #include "transcode_codec_enc_avc.h"
+#include "transcode_frame.h"
 #include <unistd.h>
 
 #define OV_LOG_TAG "TranscodeCodec"
@@ -47,7 +48,7 @@ bool OvenCodecImplAvcodecEncAVC::Configure(std::shared_ptr<TranscodeContext> con
 	param.bEnableFrameSkip = false;
 	param.bEnableLongTermReference = false;
 	param.iLtrMarkPeriod = 30;
-	param.uiIntraPeriod = 30; // KeyFrame Interval (1 sec)
+	param.uiIntraPeriod = context->GetGOP(); // KeyFrame Interval (30: 1 sec)
 	param.eSpsPpsIdStrategy = CONSTANT_ID;
 	param.bPrefixNalAddingCtrl = false;
 	param.sSpatialLayers[0].iVideoWidth = param.iPicWidth;
@@ -58,6 +59,63 @@ bool OvenCodecImplAvcodecEncAVC::Configure(std::shared_ptr<TranscodeContext> con
 	param.sSpatialLayers[0].uiProfileIdc = PRO_BASELINE;
 	param.sSpatialLayers[0].uiLevelIdc = LEVEL_3_1;     // baseline & lvl 3.1 => profile-level-id=42e01f
 
+	const auto &preset = context->GetEncoderPreset();
+
+	param.iUsageType = preset.screen_content ? SCREEN_CONTENT_REAL_TIME : CAMERA_VIDEO_REAL_TIME;
+	param.bEnableFrameSkip = preset.frame_skip;
+
+	if(preset.GetThreadCount() > 0)
+	{
+		param.iMultipleThreadIdc = static_cast<unsigned short>(preset.GetThreadCount());
+	}
+
+	if(preset.GetSliceCount() > 1)
+	{
+		// Each thread encodes a slice
+		param.sSpatialLayers[0].sSliceArgument.uiSliceMode = SM_FIXEDSLCNUM_SLICE;
+		param.sSpatialLayers[0].sSliceArgument.uiSliceNum = static_cast<unsigned int>(preset.GetSliceCount());
+	}
+
+	switch(preset.complexity)
+	{
+		case TranscodeEncoderComplexity::Low:
+			param.iComplexityMode = LOW_COMPLEXITY;
+			break;
+
+		case TranscodeEncoderComplexity::Medium:
+			param.iComplexityMode = MEDIUM_COMPLEXITY;
+			break;
+
+		case TranscodeEncoderComplexity::High:
+			param.iComplexityMode = HIGH_COMPLEXITY;
+			break;
+
+		case TranscodeEncoderComplexity::Default:
+			break;
+	}
+
+	switch(preset.rate_control)
+	{
+		case TranscodeRateControl::Bitrate:
+			param.iRCMode = RC_BITRATE_MODE;
+			break;
+
+		case TranscodeRateControl::Quality:
+			param.iRCMode = RC_QUALITY_MODE;
+			break;
+
+		case TranscodeRateControl::Buffer:
+			param.iRCMode = RC_BUFFERBASED_MODE;
+			break;
+
+		case TranscodeRateControl::Default:
+		case TranscodeRateControl::Off:
+			param.iRCMode = RC_OFF_MODE;
+			break;
+	}
+
+	_complexity_mode = param.iComplexityMode;
+
 	if(_encoder->InitializeExt(&param))
 	{
 		logte("H264 encoder initialize failed");
@@ -70,6 +128,13 @@ bool OvenCodecImplAvcodecEncAVC::Configure(std::shared_ptr<TranscodeContext> con
 	return true;
 }
 
+bool OvenCodecImplAvcodecEncAVC::SetFastMode(bool enable)
+{
+	ECOMPLEXITY_MODE complexity_mode = enable ? LOW_COMPLEXITY : _complexity_mode;
+
+	return (_encoder->SetOption(ENCODER_OPTION_COMPLEXITY, &complexity_mode) == cmResultSuccess);
+}
+
 void OvenCodecImplAvcodecEncAVC::SendBuffer(std::unique_ptr<const MediaFrame> frame)
 {
 	TranscodeEncoder::SendBuffer(std::move(frame));
@@ -98,15 +163,38 @@ std::unique_ptr<MediaPacket> OvenCodecImplAvcodecEncAVC::RecvBuffer(TranscodeRes
 		SSourcePicture sp = { 0 };
 		size_t required_size = 0, fragments_count = 0;
 
+		// Encode the planes of the filter directly if the picture has not been copied
+		auto native_frame = TranscodeFrame::GetAVFrame(frame);
+
+		if((native_frame != nullptr) && (native_frame->hw_frames_ctx != nullptr))
+		{
+			logte("OpenH264 cannot encode the frame in the memory of the device");
+			*result = TranscodeResult::DataError;
+			return nullptr;
+		}
+
 		sp.iColorFormat = videoFormatI420;
 		for(int i = 0; i < 3; ++i)
 		{
-			sp.iStride[i] = frame->GetStride(i);
-			sp.pData[i] = (__u_char *)frame->GetBuffer(i);
+			if(native_frame != nullptr)
+			{
+				sp.iStride[i] = native_frame->linesize[i];
+				sp.pData[i] = native_frame->data[i];
+			}
+			else
+			{
+				sp.iStride[i] = frame->GetStride(i);
+				sp.pData[i] = (__u_char *)frame->GetBuffer(i);
+			}
 		}
 		sp.iPicWidth = frame->GetWidth();
 		sp.iPicHeight = frame->GetHeight();
 
+		if(PopKeyFrameRequest())
+		{
+			_encoder->ForceIntraFrame(true);
+		}
+
 		if(_encoder->EncodeFrame(&sp, &fbi) != cmResultSuccess)
 		{
 			logte("Encode Frame Error");
@@ -135,17 +223,26 @@ std::unique_ptr<MediaPacket> OvenCodecImplAvcodecEncAVC::RecvBuffer(TranscodeRes
 			return nullptr;
 		}
 
-		auto encoded = std::make_unique<uint8_t[]>(required_size);
-		auto frag_hdr = std::make_unique<FragmentationHeader>();
+		// The layers are written to the buffer of the packet, which has the headroom for the publishers
+		auto encoded = std::make_shared<ov::Data>();
 
-		if(fragments_count > MAX_FRAG_COUNT)
+		if(encoded->ReserveHeadroom(MEDIA_PACKET_HEADROOM, required_size) == false)
 		{
-			logte("Unexpected H264 fragments_count=%d", fragments_count);
+			logte("Could not allocate the buffer of the encoded frame (%zu bytes)", required_size);
 			*result = TranscodeResult::DataError;
 			return nullptr;
 		}
 
-		frag_hdr->VerifyAndAllocateFragmentationHeader(fragments_count);
+		auto frag_hdr = std::make_unique<FragmentationHeader>();
+
+		// Too many NAL units, the publishers find them from the start codes
+		bool has_fragments = (fragments_count <= MAX_FRAG_COUNT);
+
+		if(has_fragments)
+		{
+			frag_hdr->VerifyAndAllocateFragmentationHeader(fragments_count);
+		}
+
 		size_t frag = 0;
 		size_t encoded_length = 0;
 		for(int layer = 0; layer < fbi.iLayerNum; ++layer)
@@ -154,13 +251,19 @@ std::unique_ptr<MediaPacket> OvenCodecImplAvcodecEncAVC::RecvBuffer(TranscodeRes
 			size_t layer_len = 0;
 			for(int nal = 0; nal < layerInfo.iNalCount; ++nal, ++frag)
 			{
-				frag_hdr->fragmentation_offset[frag] =
-					encoded_length + layer_len + sizeof(start_code);
-				frag_hdr->fragmentation_length[frag] =
-					layerInfo.pNalLengthInByte[nal] - sizeof(start_code);
+				if(has_fragments)
+				{
+					frag_hdr->fragmentation_offset[frag] =
+						encoded_length + layer_len + sizeof(start_code);
+					frag_hdr->fragmentation_length[frag] =
+						layerInfo.pNalLengthInByte[nal] - sizeof(start_code);
+					// NAL unit type
+					frag_hdr->fragmentation_pl_type[frag] =
+						layerInfo.pBsBuf[layer_len + sizeof(start_code)] & 0x1F;
+				}
 				layer_len += layerInfo.pNalLengthInByte[nal];
 			}
-			::memcpy(encoded.get() + encoded_length, layerInfo.pBsBuf, layer_len);
+			encoded->Append(layerInfo.pBsBuf, layer_len);
 			encoded_length += layer_len;
 		}
 
@@ -177,8 +280,7 @@ std::unique_ptr<MediaPacket> OvenCodecImplAvcodecEncAVC::RecvBuffer(TranscodeRes
 		auto packet_buffer = std::make_unique<MediaPacket>(
 			common::MediaType::Video,
 			0,
-			encoded.get(),
-			encoded_length,
+			std::move(encoded),
 			(pts == 0) ? -1 : pts,
 			(fbi.eFrameType == videoFrameTypeIDR) ? MediaPacketFlag::Key : MediaPacketFlag::NoFlag);
 		packet_buffer->_frag_hdr = std::move(frag_hdr);
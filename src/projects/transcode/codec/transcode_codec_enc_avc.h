@@ -28,6 +28,11 @@ public:
 
 	std::unique_ptr<MediaPacket> RecvBuffer(TranscodeResult *result) override;
 
+	bool SetFastMode(bool enable) override;
+
 private:
 	ISVCEncoder* _encoder;
+
+	// iComplexityMode of the preset, which is restored when the fast mode is disabled
+	ECOMPLEXITY_MODE _complexity_mode = MEDIUM_COMPLEXITY;
 };
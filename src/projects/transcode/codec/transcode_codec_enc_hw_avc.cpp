@@ -0,0 +1,229 @@
+//==============================================================================
+//
+//  Transcode
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "transcode_codec_enc_hw_avc.h"
+#include "transcode_hardware.h"
+#include "transcode_frame.h"
+
+#define OV_LOG_TAG "TranscodeCodec"
+
+OvenCodecImplAvcodecEncHwAVC::~OvenCodecImplAvcodecEncHwAVC()
+{
+	av_buffer_unref(&_device_context);
+}
+
+bool OvenCodecImplAvcodecEncHwAVC::Configure(std::shared_ptr<TranscodeContext> context)
+{
+	if(TranscodeEncoder::Configure(context) == false)
+	{
+		return false;
+	}
+
+	_hardware_type = _transcode_context->GetHardwareType();
+
+	auto encoder_name = TranscodeHardware::GetEncoderName(_hardware_type, _transcode_context->GetCodecId());
+
+	if(encoder_name == nullptr)
+	{
+		return false;
+	}
+
+	_codec = avcodec_find_encoder_by_name(encoder_name);
+
+	if(_codec == nullptr)
+	{
+		logte("Codec not found: %s", encoder_name);
+		return false;
+	}
+
+	_device_context = TranscodeHardware::GetDeviceContext(_hardware_type);
+
+	return (_device_context != nullptr);
+}
+
+bool OvenCodecImplAvcodecEncHwAVC::OpenCodec(const AVFrame *hardware_frame)
+{
+	_context = avcodec_alloc_context3(_codec);
+
+	if(_context == nullptr)
+	{
+		logte("Could not allocate video codec context");
+		return false;
+	}
+
+	_context->bit_rate = _transcode_context->GetBitrate();
+	_context->rc_max_rate = _context->bit_rate;
+	_context->rc_buffer_size = static_cast<int>(_context->bit_rate * 2);
+	_context->sample_aspect_ratio = (AVRational){ 1, 1 };
+	_context->time_base = (AVRational){
+		_transcode_context->GetTimeBase().GetNum(), _transcode_context->GetTimeBase().GetDen()
+	};
+	_context->framerate = av_d2q(_transcode_context->GetFrameRate(), AV_TIME_BASE);
+	_context->gop_size = _transcode_context->GetGOP();
+	// WebRTC does not support B-frames
+	_context->max_b_frames = 0;
+	_context->width = _transcode_context->GetVideoWidth();
+	_context->height = _transcode_context->GetVideoHeight();
+
+	if(hardware_frame != nullptr)
+	{
+		// Encodes the frames in the memory of the device
+		_context->pix_fmt = static_cast<AVPixelFormat>(hardware_frame->format);
+		_context->hw_frames_ctx = av_buffer_ref(hardware_frame->hw_frames_ctx);
+	}
+	else if(_hardware_type == TranscodeHardwareType::Nvidia)
+	{
+		// NVENC uploads the frames in the system memory by itself
+		_context->pix_fmt = AV_PIX_FMT_YUV420P;
+		_context->hw_device_ctx = av_buffer_ref(_device_context);
+	}
+	else
+	{
+		logte("%s encoder can only encode the frames in the memory of the device", _codec->name);
+		return false;
+	}
+
+	AVDictionary *opts = nullptr;
+
+	switch(_hardware_type)
+	{
+		case TranscodeHardwareType::Nvidia:
+			av_dict_set(&opts, "preset", (_transcode_context->GetEncoderPreset().complexity == TranscodeEncoderComplexity::Low) ? "llhp" : "llhq", 0);
+			av_dict_set(&opts, "profile", "baseline", 0);
+			av_dict_set(&opts, "rc", "cbr", 0);
+			av_dict_set(&opts, "zerolatency", "1", 0);
+			// Encode the requested key frames as IDR
+			av_dict_set(&opts, "forced-idr", "1", 0);
+			break;
+
+		case TranscodeHardwareType::Qsv:
+			av_dict_set(&opts, "preset", "veryfast", 0);
+			av_dict_set(&opts, "profile", "baseline", 0);
+			av_dict_set(&opts, "async_depth", "1", 0);
+			av_dict_set(&opts, "look_ahead", "0", 0);
+			break;
+
+		case TranscodeHardwareType::Vaapi:
+			_context->profile = FF_PROFILE_H264_CONSTRAINED_BASELINE;
+			break;
+
+		case TranscodeHardwareType::None:
+			break;
+	}
+
+	int ret = avcodec_open2(_context, _codec, &opts);
+
+	av_dict_free(&opts);
+
+	if(ret < 0)
+	{
+		logte("Could not open codec: %s (%d)", _codec->name, ret);
+		return false;
+	}
+
+	return true;
+}
+
+std::unique_ptr<MediaPacket> OvenCodecImplAvcodecEncHwAVC::RecvBuffer(TranscodeResult *result)
+{
+	if(_context != nullptr)
+	{
+		int ret = avcodec_receive_packet(_context, _pkt);
+
+		if(ret == AVERROR(EAGAIN))
+		{
+			// Need more frames
+		}
+		else if(ret == AVERROR_EOF)
+		{
+			logte("Error receiving a packet for encoding : AVERROR_EOF");
+			*result = TranscodeResult::DataError;
+			return nullptr;
+		}
+		else if(ret < 0)
+		{
+			logte("Error receiving a packet for encoding : %d", ret);
+			*result = TranscodeResult::DataError;
+			return nullptr;
+		}
+		else
+		{
+			_coded_frame_count++;
+			_coded_data_size += _pkt->size;
+
+			auto packet_buffer = std::make_unique<MediaPacket>(
+				common::MediaType::Video,
+				0,
+				_pkt->data,
+				_pkt->size,
+				(_pkt->pts == AV_NOPTS_VALUE) ? -1 : _pkt->pts,
+				(_pkt->flags & AV_PKT_FLAG_KEY) ? MediaPacketFlag::Key : MediaPacketFlag::NoFlag);
+
+			bool has_fragments = MakeFragmentationHeader(_pkt->data, static_cast<size_t>(_pkt->size), packet_buffer->_frag_hdr.get());
+
+			av_packet_unref(_pkt);
+
+			if(has_fragments == false)
+			{
+				logte("Could not find any NAL unit from the encoded packet");
+				*result = TranscodeResult::DataError;
+				return nullptr;
+			}
+
+			*result = TranscodeResult::DataReady;
+			return std::move(packet_buffer);
+		}
+	}
+
+	while(_input_buffer.size() > 0)
+	{
+		auto frame_buffer = std::move(_input_buffer[0]);
+		_input_buffer.erase(_input_buffer.begin(), _input_buffer.begin() + 1);
+
+		const MediaFrame *frame = frame_buffer.get();
+		OV_ASSERT2(frame != nullptr);
+
+		auto native_frame = TranscodeFrame::GetAVFrame(frame);
+
+		if(_context == nullptr)
+		{
+			// The frames context is needed only if the frame is in the memory of the device
+			auto hardware_frame = ((native_frame != nullptr) && (native_frame->hw_frames_ctx != nullptr)) ? native_frame : nullptr;
+
+			if(_open_failed || (OpenCodec(hardware_frame) == false))
+			{
+				// Do not try again for every frame
+				_open_failed = true;
+				avcodec_free_context(&_context);
+
+				*result = TranscodeResult::DataError;
+				return nullptr;
+			}
+		}
+
+		if(TranscodeFrame::MakeAVFrame(frame, _frame) == false)
+		{
+			*result = TranscodeResult::DataError;
+			return nullptr;
+		}
+
+		// The picture type of the referenced picture is not used, the encoder decides it unless a key frame is requested
+		_frame->pict_type = PopKeyFrameRequest() ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+
+		int ret = avcodec_send_frame(_context, _frame);
+
+		if(ret < 0)
+		{
+			logte("Error sending a frame for encoding : %d", ret);
+		}
+
+		av_frame_unref(_frame);
+	}
+
+	*result = TranscodeResult::NoData;
+	return nullptr;
+}
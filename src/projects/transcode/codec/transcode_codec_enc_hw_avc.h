@@ -0,0 +1,37 @@
+//==============================================================================
+//
+//  Transcode
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "transcode_encoder.h"
+
+// H.264 encoder using the hardware accelerator (h264_nvenc, h264_qsv, h264_vaapi)
+//
+// - The codec is opened when the first frame is received, because the frames context of the device
+//   (which is made by the decoder or the filter) is needed to encode the frames in the memory of the device
+class OvenCodecImplAvcodecEncHwAVC : public TranscodeEncoder
+{
+public:
+	~OvenCodecImplAvcodecEncHwAVC() override;
+
+	AVCodecID GetCodecID() const noexcept override
+	{
+		return AV_CODEC_ID_H264;
+	}
+
+	bool Configure(std::shared_ptr<TranscodeContext> context) override;
+
+	std::unique_ptr<MediaPacket> RecvBuffer(TranscodeResult *result) override;
+
+private:
+	bool OpenCodec(const AVFrame *hardware_frame);
+
+	AVCodec *_codec = nullptr;
+	TranscodeHardwareType _hardware_type = TranscodeHardwareType::None;
+	AVBufferRef *_device_context = nullptr;
+	bool _open_failed = false;
+};
@@ -54,9 +54,21 @@ bool OvenCodecImplAvcodecEncOpus::Configure(std::shared_ptr <TranscodeContext> c
 		return false;
 	}
 
-	// Enable FEC
-	::opus_encoder_ctl(_encoder, OPUS_SET_INBAND_FEC(1));
-	::opus_encoder_ctl(_encoder, OPUS_SET_PACKET_LOSS_PERC(10));
+	const auto &options = context->GetOpusOptions();
+
+	if(options.complexity >= 0)
+	{
+		::opus_encoder_ctl(_encoder, OPUS_SET_COMPLEXITY(options.complexity));
+	}
+
+	::opus_encoder_ctl(_encoder, OPUS_SET_DTX(options.dtx ? 1 : 0));
+	::opus_encoder_ctl(_encoder, OPUS_SET_INBAND_FEC(options.fec ? 1 : 0));
+	::opus_encoder_ctl(_encoder, OPUS_SET_PACKET_LOSS_PERC(options.expected_loss));
+
+	_frame_samples = options.GetFrameSamples(context->GetAudioSampleRate());
+
+	logtd("OPUS encoder is created - frame(%d samples) complexity(%d) dtx(%d) fec(%d) loss(%d%%)",
+	      _frame_samples, options.complexity, options.dtx, options.fec, options.expected_loss);
 
 	_transcode_context = context;
 
@@ -85,9 +97,10 @@ std::unique_ptr <MediaPacket> OvenCodecImplAvcodecEncOpus::RecvBuffer(TranscodeR
 {
 	OV_ASSERT2(_transcode_context);
 
-	// 200ms
-	const unsigned int frame_count_to_encode = 480 * 2;
-	const unsigned int bytes_to_encode = frame_count_to_encode * _transcode_context->GetAudioChannel().GetCounts() * _transcode_context->GetAudioSample().GetSampleSize();
+	// Samples of a frame (20 ms by default)
+	const unsigned int frame_count_to_encode = static_cast<unsigned int>(_frame_samples);
+	// The samples are always stored as interleaved S16 in the buffer
+	const unsigned int bytes_to_encode = frame_count_to_encode * _transcode_context->GetAudioChannel().GetCounts() * sizeof(opus_int16);
 
 	while((_input_buffer.empty() == false) && (_buffer->GetLength() < bytes_to_encode))
 	{
@@ -99,67 +112,71 @@ std::unique_ptr <MediaPacket> OvenCodecImplAvcodecEncOpus::RecvBuffer(TranscodeR
 
 		OV_ASSERT2(frame != nullptr);
 
-		// Store frame informations
-		_format = frame->GetFormat<common::AudioSample::Format>();
+		auto input_format = frame->GetFormat<common::AudioSample::Format>();
 
 		if(_current_pts == -1)
 		{
 			_current_pts = frame->GetPts();
 		}
 
-		// Append frame data into the buffer
+		// Currently, OME's OPUS encoder supports up to 2 channels
+		int channels = std::min(frame->GetChannels(), 2);
+		int samples = frame->GetNbSamples();
 
-		if(frame->GetChannels() == 1)
+		if(channels <= 0)
 		{
-			// Just copy data into buffer
-			_buffer->Append(frame->GetBuffer(0), frame->GetBufferSize(0));
+			continue;
 		}
-		else if(frame->GetChannels() >= 2)
+
+		// Append frame data into the buffer (interleaving and converting in one pass)
+		off_t current_offset = _buffer->GetLength();
+		_buffer->SetLength(current_offset + samples * channels * sizeof(opus_int16));
+
+		auto destination = _buffer->GetWritableDataAs<uint8_t>() + current_offset;
+
+		switch(input_format)
 		{
-			// Currently, OME's OPUS encoder supports up to 2 channels
-			switch(_format)
-			{
-				case common::AudioSample::Format::S16P:
-				case common::AudioSample::Format::FltP:
+			case common::AudioSample::Format::S16P:
+				if(channels == 2)
 				{
-					// Need to interleave if sample type is planar
-
-					off_t current_offset = _buffer->GetLength();
-
-					// Reserve extra spaces
-					size_t total_bytes = frame->GetBufferSize(0) + frame->GetBufferSize(1);
-					_buffer->SetLength(current_offset + total_bytes);
-
-					if(_format == common::AudioSample::Format::S16P)
-					{
-						// S16P
-						ov::Interleave<int16_t>(_buffer->GetWritableDataAs<uint8_t>() + current_offset, frame->GetBuffer(0), frame->GetBuffer(1), frame->GetNbSamples());
-						_format = common::AudioSample::Format::S16;
-					}
-					else
-					{
-						// FltP
-						ov::Interleave<float>(_buffer->GetWritableDataAs<uint8_t>() + current_offset, frame->GetBuffer(0), frame->GetBuffer(1), frame->GetNbSamples());
-						_format = common::AudioSample::Format::Flt;
-					}
-
+					ov::Interleave<int16_t>(destination, frame->GetBuffer(0), frame->GetBuffer(1), samples);
 					break;
 				}
 
-				case common::AudioSample::Format::S16:
-				case common::AudioSample::Format::Flt:
-					// Do not need to interleave if sample type is non-planar
-					_buffer->Append(frame->GetBuffer(0), frame->GetBufferSize(0));
+				// Mono planar is the same as the non-planar
+				::memcpy(destination, frame->GetBuffer(0), samples * sizeof(opus_int16));
+				break;
+
+			case common::AudioSample::Format::S16:
+				// Do not need to interleave if sample type is non-planar
+				::memcpy(destination, frame->GetBuffer(0), samples * channels * sizeof(opus_int16));
+				break;
+
+			case common::AudioSample::Format::FltP:
+				if(channels == 2)
+				{
+					// The frames of the AAC decoder are resampled without converting the format, so this is the common path
+					ov::InterleaveFloatToS16(destination, frame->GetBuffer(0), frame->GetBuffer(1), samples);
 					break;
+				}
+
+				ov::ConvertFloatToS16(destination, frame->GetBuffer(0), samples);
+				break;
+
+			case common::AudioSample::Format::Flt:
+				ov::ConvertFloatToS16(destination, frame->GetBuffer(0), samples * channels);
+				break;
 
-				default:
-					logte("Not supported format: %d", _format);
-					*result = TranscodeResult::DataError;
+			default:
+				logte("Not supported format: %d", input_format);
+				_buffer->SetLength(current_offset);
+				*result = TranscodeResult::DataError;
 
-					OV_ASSERT2(false);
-					return nullptr;
-			}
+				OV_ASSERT2(false);
+				return nullptr;
 		}
+
+		_format = common::AudioSample::Format::S16;
 	}
 
 	if(_buffer->GetLength() < bytes_to_encode)
@@ -180,20 +197,7 @@ std::unique_ptr <MediaPacket> OvenCodecImplAvcodecEncOpus::RecvBuffer(TranscodeR
 	encoded->SetLength(encoded->GetCapacity());
 
 	// Encode
-	switch(_format)
-	{
-		case common::AudioSample::Format::S16:
-			encoded_bytes = ::opus_encode(_encoder, _buffer->GetDataAs<const opus_int16>(), frame_count_to_encode, encoded->GetWritableDataAs<unsigned char>(), static_cast<opus_int32>(encoded->GetCapacity()));
-			break;
-
-		case common::AudioSample::Format::Flt:
-			encoded_bytes = ::opus_encode_float(_encoder, _buffer->GetDataAs<float>(), frame_count_to_encode, encoded->GetWritableDataAs<unsigned char>(), static_cast<opus_int32>(encoded->GetCapacity()));
-			break;
-
-		default:
-			*result = TranscodeResult::DataError;
-			return nullptr;
-	}
+	encoded_bytes = ::opus_encode(_encoder, _buffer->GetDataAs<const opus_int16>(), frame_count_to_encode, encoded->GetWritableDataAs<unsigned char>(), static_cast<opus_int32>(encoded->GetCapacity()));
 
 	if(encoded_bytes < 0)
 	{
@@ -32,6 +32,8 @@ protected:
 
 	common::AudioSample::Format _format;
 	int64_t _current_pts;
+	// Samples (per channel) of a frame from the frame duration
+	int _frame_samples = 0;
 
 	OpusEncoder *_encoder;
 };
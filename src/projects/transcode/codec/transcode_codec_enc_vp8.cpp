@@ -7,9 +7,15 @@
 //
 //==============================================================================
 #include "transcode_codec_enc_vp8.h"
+#include "transcode_frame.h"
+#include "base/application/video_track.h"
 
 #define OV_LOG_TAG "TranscodeCodec"
 
+// Temporal layers of the frames in the pattern of ts_layering_mode (same order as libvpxenc)
+static const uint8_t kTemporalPattern2[] = { 0, 1 };
+static const uint8_t kTemporalPattern3[] = { 0, 2, 1, 2 };
+
 bool OvenCodecImplAvcodecEncVP8::Configure(std::shared_ptr<TranscodeContext> context)
 {
 	_transcode_context = context;
@@ -51,19 +57,126 @@ bool OvenCodecImplAvcodecEncVP8::Configure(std::shared_ptr<TranscodeContext> con
 	_context->rc_initial_buffer_occupancy = static_cast<int>(500 * _context->bit_rate / 1000);
 	_context->rc_buffer_size = static_cast<int>(1000 * _context->bit_rate / 1000);
 
+	const auto &preset = _transcode_context->GetEncoderPreset();
+
+	if(preset.GetThreadCount() > 0)
+	{
+		_context->thread_count = preset.GetThreadCount();
+	}
+
+	// Token partitions, so that the partitions can be decoded in parallel
+	_context->slices = preset.GetSliceCount();
+
+	switch(preset.rate_control)
+	{
+		case TranscodeRateControl::Off:
+		case TranscodeRateControl::Quality:
+			// Constrained quality, the bitrate is used as the maximum
+			_context->rc_min_rate = 0;
+			break;
+
+		case TranscodeRateControl::Buffer:
+			_context->rc_min_rate = 0;
+			_context->rc_max_rate = _context->bit_rate * 3 / 2;
+			break;
+
+		case TranscodeRateControl::Default:
+		case TranscodeRateControl::Bitrate:
+			break;
+	}
+
 	AVDictionary *opts = nullptr;
 
-	av_dict_set(&opts, "quality", "realtime", AV_OPT_FLAG_ENCODING_PARAM);
+	av_dict_set(&opts, "quality", (preset.complexity == TranscodeEncoderComplexity::High) ? "good" : "realtime", AV_OPT_FLAG_ENCODING_PARAM);
+
+	switch(preset.complexity)
+	{
+		case TranscodeEncoderComplexity::Low:
+			av_dict_set(&opts, "cpu-used", "8", AV_OPT_FLAG_ENCODING_PARAM);
+			break;
+
+		case TranscodeEncoderComplexity::Medium:
+			av_dict_set(&opts, "cpu-used", "4", AV_OPT_FLAG_ENCODING_PARAM);
+			break;
+
+		case TranscodeEncoderComplexity::High:
+			av_dict_set(&opts, "cpu-used", "2", AV_OPT_FLAG_ENCODING_PARAM);
+			break;
+
+		case TranscodeEncoderComplexity::Default:
+			break;
+	}
+
+	if((preset.rate_control == TranscodeRateControl::Off) || (preset.rate_control == TranscodeRateControl::Quality))
+	{
+		av_dict_set(&opts, "crf", "10", AV_OPT_FLAG_ENCODING_PARAM);
+	}
+
+	if(preset.frame_skip)
+	{
+		// Drops the frames when the buffer is lower than 25%
+		av_dict_set(&opts, "drop-threshold", "25", AV_OPT_FLAG_ENCODING_PARAM);
+	}
+
+	if(preset.name != "default")
+	{
+		// Do not keep the frames in the encoder
+		av_dict_set(&opts, "lag-in-frames", "0", AV_OPT_FLAG_ENCODING_PARAM);
+	}
+
+	_temporal_layer_count = _transcode_context->GetTemporalLayerCount();
+
+	if(_temporal_layer_count > 1)
+	{
+		ov::String target_bitrates;
+
+		for(uint8_t layer = 0; layer < _temporal_layer_count; layer++)
+		{
+			// kbps of the layers up to the layer
+			target_bitrates.AppendFormat("%s%lld", (layer > 0) ? "," : "",
+			                             static_cast<long long>(_context->bit_rate) * VideoTrack::GetTemporalLayerBitrateRatio(_temporal_layer_count, layer) / 100 / 1000);
+		}
+
+		auto ts_parameters = ov::String::FormatString("ts_number_layers=%d:ts_target_bitrate=%s:ts_layering_mode=%d",
+		                                              _temporal_layer_count, target_bitrates.CStr(), _temporal_layer_count);
+
+		av_dict_set(&opts, "ts-parameters", ts_parameters.CStr(), AV_OPT_FLAG_ENCODING_PARAM);
+		// The players which drop the upper layers must decode the base layer (the entropy context is not carried between the frames)
+		av_dict_set(&opts, "error-resilient", "default", AV_OPT_FLAG_ENCODING_PARAM);
+		av_dict_set(&opts, "lag-in-frames", "0", AV_OPT_FLAG_ENCODING_PARAM);
+	}
 
 	if(avcodec_open2(_context, codec, &opts) < 0)
 	{
 		logte("Could not open codec");
+		av_dict_free(&opts);
 		return false;
 	}
 
+	if((_temporal_layer_count > 1) && (av_dict_get(opts, "ts-parameters", nullptr, 0) != nullptr))
+	{
+		// The option is not consumed by the encoder
+		logtw("VP8 encoder does not support the temporal layers, the frames are encoded with a single layer");
+		_temporal_layer_count = 1;
+	}
+
+	av_dict_free(&opts);
+
 	return true;
 }
 
+uint8_t OvenCodecImplAvcodecEncVP8::PopTemporalLayer(int64_t pts, bool key_frame)
+{
+	auto item = _temporal_layers.find(pts);
+	uint8_t temporal_layer = (item != _temporal_layers.end()) ? item->second : 0;
+
+	// The frames before the PTS were dropped by the encoder
+	_temporal_layers.erase(_temporal_layers.begin(), _temporal_layers.upper_bound(pts));
+
+	// A key frame does not reference any frame, the players which receive the base layer only must receive it
+	return key_frame ? 0 : temporal_layer;
+}
+
 std::unique_ptr<MediaPacket> OvenCodecImplAvcodecEncVP8::RecvBuffer(TranscodeResult *result)
 {
 	int ret;
@@ -103,6 +216,11 @@ std::unique_ptr<MediaPacket> OvenCodecImplAvcodecEncVP8::RecvBuffer(TranscodeRes
 
 		auto packet_buffer = std::make_unique<MediaPacket>(common::MediaType::Video, 0, _pkt->data, _pkt->size, _pkt->dts, (_pkt->flags & AV_PKT_FLAG_KEY) ? MediaPacketFlag::Key : MediaPacketFlag::NoFlag);
 
+		if(_temporal_layer_count > 1)
+		{
+			packet_buffer->SetTemporalLayer(PopTemporalLayer(_pkt->pts, (_pkt->flags & AV_PKT_FLAG_KEY) != 0));
+		}
+
 		av_packet_unref(_pkt);
 
 		*result = TranscodeResult::DataReady;
@@ -120,34 +238,17 @@ std::unique_ptr<MediaPacket> OvenCodecImplAvcodecEncVP8::RecvBuffer(TranscodeRes
 		const MediaFrame *frame = frame_buffer.get();
 		OV_ASSERT2(frame != nullptr);
 
-		_frame->format = frame->GetFormat();
-		_frame->width = frame->GetWidth();
-		_frame->height = frame->GetHeight();
-		_frame->pts = frame->GetPts();
-
-		_frame->linesize[0] = frame->GetStride(0);
-		_frame->linesize[1] = frame->GetStride(1);
-		_frame->linesize[2] = frame->GetStride(2);
-
-		if(av_frame_get_buffer(_frame, 32) < 0)
+		// The picture of the decoder/filter is referenced if possible
+		if(TranscodeFrame::MakeAVFrame(frame, _frame) == false)
 		{
-			logte("Could not allocate the video frame data");
 			*result = TranscodeResult::DataError;
 			return nullptr;
 		}
 
-		if(av_frame_make_writable(_frame) < 0)
-		{
-			logte("Could not make sure the frame data is writable");
-			*result = TranscodeResult::DataError;
-			return nullptr;
-		}
-
-		// Copy packet data into frame
-		memcpy(_frame->data[0], frame->GetBuffer(0), frame->GetBufferSize(0));
-		memcpy(_frame->data[1], frame->GetBuffer(1), frame->GetBufferSize(1));
-		memcpy(_frame->data[2], frame->GetBuffer(2), frame->GetBufferSize(2));
+		// The picture type of the referenced picture is not used, the encoder decides it unless a key frame is requested
+		_frame->pict_type = PopKeyFrameRequest() ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
 
+		int64_t pts = _frame->pts;
 		int ret = avcodec_send_frame(_context, _frame);
 
 		if(ret < 0)
@@ -155,6 +256,13 @@ std::unique_ptr<MediaPacket> OvenCodecImplAvcodecEncVP8::RecvBuffer(TranscodeRes
 			logte("Error sending a frame for encoding : %d", ret);
 			// TODO(soulk): 에러 처리 안해도 되는지?
 		}
+		else if(_temporal_layer_count > 1)
+		{
+			// libvpxenc moves to the next frame of the pattern for each frame
+			_temporal_layers[pts] = (_temporal_layer_count == 2) ? kTemporalPattern2[_temporal_pattern_index % OV_COUNTOF(kTemporalPattern2)]
+			                                                      : kTemporalPattern3[_temporal_pattern_index % OV_COUNTOF(kTemporalPattern3)];
+			_temporal_pattern_index++;
+		}
 
 		av_frame_unref(_frame);
 	}
@@ -10,6 +10,15 @@
 
 #include "transcode_encoder.h"
 
+#include <map>
+
+// The temporal layers need ts_layering_mode of libvpxenc (FFmpeg 4.4), which sets the reference pattern of the layers
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 134, 100)
+#define TRANSCODE_VP8_MAX_TEMPORAL_LAYERS		3
+#else
+#define TRANSCODE_VP8_MAX_TEMPORAL_LAYERS		1
+#endif
+
 class OvenCodecImplAvcodecEncVP8 : public TranscodeEncoder
 {
 public:
@@ -21,4 +30,14 @@ public:
 	bool Configure(std::shared_ptr<TranscodeContext> context) override;
 
 	std::unique_ptr<MediaPacket> RecvBuffer(TranscodeResult *result) override;
+
+private:
+	// Temporal layer of the packet which is encoded from the frame of the PTS (0 if key frame)
+	uint8_t PopTemporalLayer(int64_t pts, bool key_frame);
+
+	uint8_t _temporal_layer_count = 1;
+	// Index of the next frame in the pattern of the layers
+	uint32_t _temporal_pattern_index = 0;
+	// key: PTS of the frame which is being encoded, value: temporal layer
+	std::map<int64_t, uint8_t> _temporal_layers;
 };
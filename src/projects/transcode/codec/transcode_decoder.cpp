@@ -10,6 +10,8 @@
 
 #include "transcode_codec_dec_aac.h"
 #include "transcode_codec_dec_avc.h"
+#include "transcode_codec_dec_hevc.h"
+#include "transcode_hardware.h"
 
 #define OV_LOG_TAG "TranscodeCodec"
 
@@ -43,6 +45,10 @@ std::unique_ptr<TranscodeDecoder> TranscodeDecoder::CreateDecoder(common::MediaC
 			decoder = std::make_unique<OvenCodecImplAvcodecDecAVC>();
 			break;
 
+		case common::MediaCodecId::H265:
+			decoder = std::make_unique<OvenCodecImplAvcodecDecHEVC>();
+			break;
+
 		case common::MediaCodecId::Aac:
 			decoder = std::make_unique<OvenCodecImplAvcodecDecAAC>();
 			break;
@@ -67,11 +73,82 @@ bool TranscodeDecoder::Configure(std::shared_ptr<TranscodeContext> context)
 {
 	_transcode_context = context;
 
-	_codec = avcodec_find_decoder(GetCodecID());
+	auto hardware_type = (context != nullptr) ? context->GetHardwareType() : TranscodeHardwareType::None;
+
+	if(hardware_type != TranscodeHardwareType::None)
+	{
+		if(OpenCodec(hardware_type))
+		{
+			logti("%s hardware decoder is used", TranscodeHardware::GetTypeString(hardware_type));
+			return true;
+		}
+
+		logtw("Could not use %s hardware decoder, software decoder will be used", TranscodeHardware::GetTypeString(hardware_type));
+	}
+
+	return OpenCodec(TranscodeHardwareType::None);
+}
+
+// Selects the format of the device if the stream can be decoded by the device
+static AVPixelFormat GetHardwarePixelFormat(AVCodecContext *context, const AVPixelFormat *formats)
+{
+	auto hardware_format = *(static_cast<const AVPixelFormat *>(context->opaque));
+
+	for(auto format = formats; *format != AV_PIX_FMT_NONE; format++)
+	{
+		if(*format == hardware_format)
+		{
+			return *format;
+		}
+	}
+
+	// The stream is not supported by the device (e.g. 4:4:4 profile), decodes to the system memory
+	for(auto format = formats; *format != AV_PIX_FMT_NONE; format++)
+	{
+		if((av_pix_fmt_desc_get(*format)->flags & AV_PIX_FMT_FLAG_HWACCEL) == 0)
+		{
+			logtw("The stream cannot be decoded by the device, %s is used", av_get_pix_fmt_name(*format));
+			return *format;
+		}
+	}
+
+	return AV_PIX_FMT_NONE;
+}
+
+bool TranscodeDecoder::OpenCodec(TranscodeHardwareType hardware_type)
+{
+	avcodec_free_context(&_context);
+
+	if(_parser != nullptr)
+	{
+		av_parser_close(_parser);
+		_parser = nullptr;
+	}
+
+	AVBufferRef *device_context = nullptr;
+
+	if(hardware_type != TranscodeHardwareType::None)
+	{
+		device_context = TranscodeHardware::GetDeviceContext(hardware_type);
+
+		if(device_context == nullptr)
+		{
+			return false;
+		}
+
+		auto decoder_name = TranscodeHardware::GetDecoderName(hardware_type, _transcode_context->GetCodecId());
+
+		_codec = (decoder_name != nullptr) ? avcodec_find_decoder_by_name(decoder_name) : avcodec_find_decoder(GetCodecID());
+	}
+	else
+	{
+		_codec = avcodec_find_decoder(GetCodecID());
+	}
 
 	if(_codec == nullptr)
 	{
 		logte("Codec not found");
+		av_buffer_unref(&device_context);
 		return false;
 	}
 
@@ -81,9 +158,20 @@ bool TranscodeDecoder::Configure(std::shared_ptr<TranscodeContext> context)
 	if(_context == nullptr)
 	{
 		logte("Could not allocate video codec context");
+		av_buffer_unref(&device_context);
 		return false;
 	}
 
+	if(device_context != nullptr)
+	{
+		// The reference is owned by the codec context
+		_context->hw_device_ctx = device_context;
+
+		_hardware_pixel_format = TranscodeHardware::GetPixelFormat(hardware_type);
+		_context->opaque = &_hardware_pixel_format;
+		_context->get_format = GetHardwarePixelFormat;
+	}
+
 	if(avcodec_open2(_context, _codec, nullptr) < 0)
 	{
 		logte("Could not open codec");
@@ -101,11 +189,66 @@ bool TranscodeDecoder::Configure(std::shared_ptr<TranscodeContext> context)
 	return true;
 }
 
+static void ReleasePacketData(void *opaque, uint8_t *data)
+{
+	delete static_cast<std::shared_ptr<const ov::Data> *>(opaque);
+}
+
+bool TranscodeDecoder::MakePacketReference(const std::shared_ptr<const ov::Data> &data, AVPacket *packet)
+{
+	size_t length = data->GetLength();
+
+	av_packet_unref(packet);
+
+	if((data->GetHeadroom() + length + AV_INPUT_BUFFER_PADDING_SIZE) > data->GetCapacity())
+	{
+		// Referenced data, or the buffer is full
+		if(av_new_packet(packet, static_cast<int>(length)) < 0)
+		{
+			return false;
+		}
+
+		::memcpy(packet->data, data->GetData(), length);
+
+		return true;
+	}
+
+	auto holder = new std::shared_ptr<const ov::Data>(data);
+	auto buffer = const_cast<uint8_t *>(data->GetDataAs<uint8_t>());
+
+	// The buffer holds the reference of the data until the codec releases the packet
+	packet->buf = av_buffer_create(buffer, static_cast<int>(length + AV_INPUT_BUFFER_PADDING_SIZE), ReleasePacketData, holder, AV_BUFFER_FLAG_READONLY);
+
+	if(packet->buf == nullptr)
+	{
+		delete holder;
+		return false;
+	}
+
+	packet->data = buffer;
+	packet->size = static_cast<int>(length);
+
+	return true;
+}
+
 void TranscodeDecoder::SendBuffer(std::unique_ptr<const MediaPacket> packet)
 {
 	_input_buffer.push_back(std::move(packet));
 }
 
+void TranscodeDecoder::SendEndOfStream()
+{
+	_end_of_stream = true;
+}
+
+void TranscodeDecoder::SetSkipNonReference(bool skip)
+{
+	if((_context != nullptr) && (_context->codec_type == AVMEDIA_TYPE_VIDEO))
+	{
+		_context->skip_frame = skip ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+	}
+}
+
 void TranscodeDecoder::ShowCodecParameters(const AVCodecParameters *parameters)
 {
 	ov::String message;
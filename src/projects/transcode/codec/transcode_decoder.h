@@ -22,18 +22,38 @@ public:
 
 	void SendBuffer(std::unique_ptr<const MediaPacket> packet) override;
 
+	// No more packet is sent, the frames remaining in the parser/codec are returned by RecvBuffer(),
+	// and then TranscodeResult::EndOfFile is returned (e.g. to decode a single key frame)
+	void SendEndOfStream();
+
+	// The codec discards the frames which are not referenced by the other frames (to decode faster when it is overloaded)
+	void SetSkipNonReference(bool skip);
+
 protected:
+	// Opens the codec using the device of hardware_type (TranscodeHardwareType::None: software codec)
+	bool OpenCodec(TranscodeHardwareType hardware_type);
+
 	void ShowCodecParameters(const AVCodecParameters *parameters);
 
+	// Makes the packet which refers the data of the access unit without copying it
+	// (the data is copied only if there is no room for the padding which the codec reads beyond the end)
+	static bool MakePacketReference(const std::shared_ptr<const ov::Data> &data, AVPacket *packet);
+
 	AVCodec *_codec = nullptr;
 	AVCodecContext *_context = nullptr;
 	AVCodecParserContext *_parser = nullptr;
 	AVCodecParameters *_codec_par = avcodec_parameters_alloc();
 
+	// Used by get_format() of the codec context if the hardware decoder is used
+	AVPixelFormat _hardware_pixel_format = AV_PIX_FMT_NONE;
+
 	std::shared_ptr<TranscodeContext> _transcode_context;
 
 	bool _change_format = false;
 
+	bool _end_of_stream = false;
+	bool _draining = false;
+
 	AVPacket *_pkt;
 	AVFrame *_frame;
 	int _decoded_frame_num = 0;
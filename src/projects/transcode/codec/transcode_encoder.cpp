@@ -14,6 +14,8 @@
 #include "transcode_codec_enc_aac.h"
 #include "transcode_codec_enc_vp8.h"
 #include "transcode_codec_enc_opus.h"
+#include "transcode_codec_enc_hw_avc.h"
+#include "transcode_hardware.h"
 
 #define OV_LOG_TAG "TranscodeCodec"
 
@@ -44,6 +46,23 @@ std::unique_ptr<TranscodeEncoder> TranscodeEncoder::CreateEncoder(common::MediaC
 	switch(codec_id)
 	{
 		case common::MediaCodecId::H264:
+			if((transcode_context != nullptr) && (transcode_context->GetHardwareType() != TranscodeHardwareType::None))
+			{
+				auto hardware_type = transcode_context->GetHardwareType();
+				auto hardware_encoder = std::make_unique<OvenCodecImplAvcodecEncHwAVC>();
+
+				if(hardware_encoder->Configure(transcode_context))
+				{
+					logti("%s hardware encoder is used", TranscodeHardware::GetTypeString(hardware_type));
+					return std::move(hardware_encoder);
+				}
+
+				logtw("Could not use %s hardware encoder, software encoder will be used", TranscodeHardware::GetTypeString(hardware_type));
+
+				// The filter must pass the frames in the system memory to the software encoder
+				transcode_context->SetHardwareType(TranscodeHardwareType::None);
+			}
+
 			encoder = std::make_unique<OvenCodecImplAvcodecEncAVC>();
 			break;
 
@@ -75,6 +94,11 @@ std::unique_ptr<TranscodeEncoder> TranscodeEncoder::CreateEncoder(common::MediaC
 	return std::move(encoder);
 }
 
+uint8_t TranscodeEncoder::GetMaxTemporalLayerCount(common::MediaCodecId codec_id)
+{
+	return (codec_id == common::MediaCodecId::Vp8) ? TRANSCODE_VP8_MAX_TEMPORAL_LAYERS : 1;
+}
+
 bool TranscodeEncoder::Configure(std::shared_ptr<TranscodeContext> context)
 {
 	_transcode_context = context;
@@ -84,5 +108,95 @@ bool TranscodeEncoder::Configure(std::shared_ptr<TranscodeContext> context)
 
 void TranscodeEncoder::SendBuffer(std::unique_ptr<const MediaFrame> frame)
 {
+	_input_times.emplace_back(frame->GetPts(), TranscodeStageStatistics::GetCurrentMicroseconds());
+
+	// The encoder may drop the frames (or change the PTS), so keep the recent frames only
+	while(_input_times.size() > TRANSCODE_ENCODER_LATENCY_FRAME_COUNT)
+	{
+		_input_times.pop_front();
+	}
+
 	_input_buffer.push_back(std::move(frame));
-}
\ No newline at end of file
+}
+
+void TranscodeEncoder::UpdateLatency(int64_t pts)
+{
+	// The skipped frames are dropped
+	while((_input_times.empty() == false) && (_input_times.front().first < pts))
+	{
+		_input_times.pop_front();
+	}
+
+	if((_input_times.empty() == false) && (_input_times.front().first == pts))
+	{
+		_latency_statistics.AddFrame(TranscodeStageStatistics::GetCurrentMicroseconds() - _input_times.front().second);
+		_input_times.pop_front();
+	}
+}
+
+const TranscodeStageStatistics &TranscodeEncoder::GetLatencyStatistics() const
+{
+	return _latency_statistics;
+}
+
+void TranscodeEncoder::RequestKeyFrame()
+{
+	_key_frame_requested = true;
+}
+
+bool TranscodeEncoder::SetFastMode(bool enable)
+{
+	return false;
+}
+
+bool TranscodeEncoder::PopKeyFrameRequest()
+{
+	return _key_frame_requested.exchange(false);
+}
+
+bool TranscodeEncoder::MakeFragmentationHeader(const uint8_t *data, size_t length, FragmentationHeader *fragmentation_header)
+{
+	size_t fragment_count = 0;
+	const uint8_t *end = data + length;
+	const uint8_t *position = ov::FindNalStartCode(data, end);
+
+	fragmentation_header->VerifyAndAllocateFragmentationHeader(MAX_FRAG_COUNT);
+	fragmentation_header->fragmentation_vector_size = 0;
+
+	while(position < end)
+	{
+		if(fragment_count > 0)
+		{
+			// Exclude the leading zero of the 4-byte start code from the previous NAL unit
+			size_t nal_end = ((position > data) && (position[-1] == 0x00)) ? (position - data - 1) : (position - data);
+
+			fragmentation_header->fragmentation_length[fragment_count - 1] = nal_end - fragmentation_header->fragmentation_offset[fragment_count - 1];
+		}
+
+		if(fragment_count >= MAX_FRAG_COUNT)
+		{
+			// Too many NAL units, the publishers find them from the start codes
+			fragmentation_header->fragmentation_vector_size = 0;
+			return true;
+		}
+
+		position += 3;
+
+		fragmentation_header->fragmentation_offset[fragment_count] = position - data;
+		// NAL unit type, so the publishers do not need to parse the NAL header again
+		fragmentation_header->fragmentation_pl_type[fragment_count] = (position < end) ? (position[0] & 0x1F) : 0;
+		fragment_count++;
+
+		position = ov::FindNalStartCode(position, end);
+	}
+
+	if(fragment_count == 0)
+	{
+		return false;
+	}
+
+	fragmentation_header->fragmentation_length[fragment_count - 1] = length - fragmentation_header->fragmentation_offset[fragment_count - 1];
+	fragmentation_header->fragmentation_vector_size = static_cast<uint16_t>(fragment_count);
+
+	return true;
+}
@@ -9,6 +9,13 @@
 #pragma once
 
 #include "transcode_base.h"
+#include "../transcode_statistics.h"
+
+#include <atomic>
+#include <deque>
+
+// Maximum number of the frames kept to measure the latency of the encoder
+#define TRANSCODE_ENCODER_LATENCY_FRAME_COUNT		256
 
 class TranscodeEncoder : public TranscodeBase<MediaFrame, MediaPacket>
 {
@@ -17,16 +24,37 @@ public:
 	~TranscodeEncoder() override;
 
 	static std::unique_ptr<TranscodeEncoder> CreateEncoder(common::MediaCodecId codec_id, std::shared_ptr<TranscodeContext> transcode_context = nullptr);
+	// Temporal layers which the encoder of the codec can make (1: no layer)
+	static uint8_t GetMaxTemporalLayerCount(common::MediaCodecId codec_id);
 
 	bool Configure(std::shared_ptr<TranscodeContext> context) override;
 
 	void SendBuffer(std::unique_ptr<const MediaFrame> frame) override;
 
+	// The next frame is encoded as a key frame (can be called by any thread)
+	void RequestKeyFrame();
+
+	// Uses the fastest settings instead of the preset (to encode faster when it is overloaded)
+	// - returns false if the encoder can't change the settings while encoding
+	virtual bool SetFastMode(bool enable);
+
+	// Called when a packet is encoded, the latency is from SendBuffer() of the frame which has the same PTS
+	void UpdateLatency(int64_t pts);
+	// The time in the encoder (including the frames kept by the encoder)
+	const TranscodeStageStatistics &GetLatencyStatistics() const;
+
+	// Makes the fragmentation header from the NAL units of the annex-b stream
+	// (fragmentation_vector_size is 0 if there are more than MAX_FRAG_COUNT)
+	static bool MakeFragmentationHeader(const uint8_t *data, size_t length, FragmentationHeader *fragmentation_header);
+
 protected:
+	// Returns true once after RequestKeyFrame() is called
+	bool PopKeyFrameRequest();
+
 	std::shared_ptr<TranscodeContext> _transcode_context = nullptr;
 
-	AVCodecContext *_context;
-	AVCodecParserContext *_parser;
+	AVCodecContext *_context = nullptr;
+	AVCodecParserContext *_parser = nullptr;
 	AVCodecParameters *_codec_par;
 
 	bool _change_format = false;
@@ -36,6 +64,12 @@ protected:
 
 	int _decoded_frame_num = 0;
 
+	std::atomic<bool> _key_frame_requested { false };
+
+	// PTS and the time (in microseconds) of the frames which are not encoded yet
+	std::deque<std::pair<int64_t, int64_t>> _input_times;
+	TranscodeStageStatistics _latency_statistics;
+
 	// 디버깅
 	uint64_t _coded_frame_count = 0;
 	uint64_t _coded_data_size = 0;
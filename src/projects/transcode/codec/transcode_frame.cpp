@@ -0,0 +1,77 @@
+//==============================================================================
+//
+//  Transcode
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "transcode_frame.h"
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#define OV_LOG_TAG "TranscodeFrame"
+
+std::shared_ptr<void> TranscodeFrame::MakeReference(const AVFrame *frame)
+{
+	AVFrame *cloned_frame = av_frame_clone(frame);
+
+	if(cloned_frame == nullptr)
+	{
+		return nullptr;
+	}
+
+	return std::shared_ptr<void>(cloned_frame, [](void *pointer) {
+		auto frame_to_free = static_cast<AVFrame *>(pointer);
+		av_frame_free(&frame_to_free);
+	});
+}
+
+const AVFrame *TranscodeFrame::GetAVFrame(const MediaFrame *frame)
+{
+	return static_cast<const AVFrame *>(frame->GetNativeFrame().get());
+}
+
+bool TranscodeFrame::MakeAVFrame(const MediaFrame *frame, AVFrame *av_frame)
+{
+	auto native_frame = GetAVFrame(frame);
+
+	if(native_frame != nullptr)
+	{
+		if(av_frame_ref(av_frame, native_frame) < 0)
+		{
+			logte("Could not reference the frame");
+			return false;
+		}
+
+		av_frame->pts = frame->GetPts();
+
+		return true;
+	}
+
+	av_frame->format = frame->GetFormat();
+	av_frame->width = frame->GetWidth();
+	av_frame->height = frame->GetHeight();
+	av_frame->pts = frame->GetPts();
+
+	av_frame->linesize[0] = frame->GetStride(0);
+	av_frame->linesize[1] = frame->GetStride(1);
+	av_frame->linesize[2] = frame->GetStride(2);
+
+	if(av_frame_get_buffer(av_frame, 32) < 0)
+	{
+		logte("Could not allocate the video frame data");
+		return false;
+	}
+
+	if(av_frame_make_writable(av_frame) < 0)
+	{
+		logte("Could not make sure the frame data is writable");
+		return false;
+	}
+
+	::memcpy(av_frame->data[0], frame->GetBuffer(0), frame->GetBufferSize(0));
+	::memcpy(av_frame->data[1], frame->GetBuffer(1), frame->GetBufferSize(1));
+	::memcpy(av_frame->data[2], frame->GetBuffer(2), frame->GetBufferSize(2));
+
+	return true;
+}
@@ -0,0 +1,35 @@
+//==============================================================================
+//
+//  Transcode
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+extern "C"
+{
+#include <libavutil/frame.h>
+}
+
+#include <memory>
+
+#include <base/media_route/media_buffer.h>
+
+// Passes the pictures between the decoder, the filter and the encoder without copying the planes
+//
+// - The native frame of MediaFrame holds a reference of the ref-counted buffers of the AVFrame,
+//   so the buffers are released when the last MediaFrame (including the clones for each rendition) is released
+// - The planes of the buffers must not be modified, because they are shared by all renditions
+class TranscodeFrame
+{
+public:
+	// Makes a new reference of the buffers of the frame
+	static std::shared_ptr<void> MakeReference(const AVFrame *frame);
+
+	// Returns nullptr if the planes of the frame are copied to MediaFrame
+	static const AVFrame *GetAVFrame(const MediaFrame *frame);
+
+	// Makes the frame to send to the codec/filter (the buffers are referenced if possible, or copied from the planes)
+	static bool MakeAVFrame(const MediaFrame *frame, AVFrame *av_frame);
+};
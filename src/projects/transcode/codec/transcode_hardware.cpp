@@ -0,0 +1,203 @@
+//==============================================================================
+//
+//  Transcode
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "transcode_hardware.h"
+
+#include <map>
+#include <mutex>
+
+#define OV_LOG_TAG "TranscodeHardware"
+
+namespace
+{
+	std::mutex device_mutex;
+	// Keeps the result of the creation even if it is failed, to avoid trying to open the unavailable device for every stream
+	std::map<TranscodeHardwareType, AVBufferRef *> device_map;
+}
+
+TranscodeHardwareType TranscodeHardware::ParseType(const ov::String &name)
+{
+	ov::String type = name.LowerCaseString();
+
+	if((type == "nvenc") || (type == "nvidia") || (type == "cuda"))
+	{
+		return TranscodeHardwareType::Nvidia;
+	}
+	else if(type == "qsv")
+	{
+		return TranscodeHardwareType::Qsv;
+	}
+	else if(type == "vaapi")
+	{
+		return TranscodeHardwareType::Vaapi;
+	}
+	else if((type.IsEmpty() == false) && (type != "none"))
+	{
+		logtw("Unknown hardware acceleration: %s", name.CStr());
+	}
+
+	return TranscodeHardwareType::None;
+}
+
+const char *TranscodeHardware::GetTypeString(TranscodeHardwareType type)
+{
+	switch(type)
+	{
+		case TranscodeHardwareType::None:
+			return "none";
+		case TranscodeHardwareType::Nvidia:
+			return "nvidia";
+		case TranscodeHardwareType::Qsv:
+			return "qsv";
+		case TranscodeHardwareType::Vaapi:
+			return "vaapi";
+	}
+
+	return "unknown";
+}
+
+AVBufferRef *TranscodeHardware::GetDeviceContext(TranscodeHardwareType type)
+{
+	AVHWDeviceType device_type = AV_HWDEVICE_TYPE_NONE;
+	const char *device = nullptr;
+
+	switch(type)
+	{
+		case TranscodeHardwareType::None:
+			return nullptr;
+
+		case TranscodeHardwareType::Nvidia:
+			device_type = AV_HWDEVICE_TYPE_CUDA;
+			break;
+
+		case TranscodeHardwareType::Qsv:
+			device_type = AV_HWDEVICE_TYPE_QSV;
+			device = "auto";
+			break;
+
+		case TranscodeHardwareType::Vaapi:
+			device_type = AV_HWDEVICE_TYPE_VAAPI;
+			device = TRANSCODE_VAAPI_DEVICE;
+			break;
+	}
+
+	std::lock_guard<std::mutex> lock(device_mutex);
+
+	auto item = device_map.find(type);
+
+	if(item == device_map.end())
+	{
+		AVBufferRef *device_context = nullptr;
+
+		int ret = av_hwdevice_ctx_create(&device_context, device_type, device, nullptr, 0);
+
+		if(ret < 0)
+		{
+			logte("Could not open the %s device: %d", GetTypeString(type), ret);
+			device_context = nullptr;
+		}
+		else
+		{
+			logti("The %s device is opened", GetTypeString(type));
+		}
+
+		item = device_map.emplace(type, device_context).first;
+	}
+
+	return (item->second != nullptr) ? av_buffer_ref(item->second) : nullptr;
+}
+
+AVPixelFormat TranscodeHardware::GetPixelFormat(TranscodeHardwareType type)
+{
+	switch(type)
+	{
+		case TranscodeHardwareType::None:
+			break;
+		case TranscodeHardwareType::Nvidia:
+			return AV_PIX_FMT_CUDA;
+		case TranscodeHardwareType::Qsv:
+			return AV_PIX_FMT_QSV;
+		case TranscodeHardwareType::Vaapi:
+			return AV_PIX_FMT_VAAPI;
+	}
+
+	return AV_PIX_FMT_NONE;
+}
+
+const char *TranscodeHardware::GetDecoderName(TranscodeHardwareType type, common::MediaCodecId codec_id)
+{
+	if(type == TranscodeHardwareType::Qsv)
+	{
+		// QSV does not provide the hwaccel for the native decoder
+		switch(codec_id)
+		{
+			case common::MediaCodecId::H264:
+				return "h264_qsv";
+			case common::MediaCodecId::H265:
+				return "hevc_qsv";
+			default:
+				break;
+		}
+	}
+
+	return nullptr;
+}
+
+const char *TranscodeHardware::GetEncoderName(TranscodeHardwareType type, common::MediaCodecId codec_id)
+{
+	if(codec_id != common::MediaCodecId::H264)
+	{
+		return nullptr;
+	}
+
+	switch(type)
+	{
+		case TranscodeHardwareType::None:
+			break;
+		case TranscodeHardwareType::Nvidia:
+			return "h264_nvenc";
+		case TranscodeHardwareType::Qsv:
+			return "h264_qsv";
+		case TranscodeHardwareType::Vaapi:
+			return "h264_vaapi";
+	}
+
+	return nullptr;
+}
+
+const char *TranscodeHardware::GetScaleFilterName(TranscodeHardwareType type)
+{
+	switch(type)
+	{
+		case TranscodeHardwareType::None:
+			break;
+		case TranscodeHardwareType::Nvidia:
+			return "scale_npp";
+		case TranscodeHardwareType::Qsv:
+			return "scale_qsv";
+		case TranscodeHardwareType::Vaapi:
+			return "scale_vaapi";
+	}
+
+	return "scale";
+}
+
+const char *TranscodeHardware::GetUploadFilter(TranscodeHardwareType type)
+{
+	switch(type)
+	{
+		case TranscodeHardwareType::None:
+			break;
+		case TranscodeHardwareType::Nvidia:
+			return "hwupload_cuda";
+		case TranscodeHardwareType::Qsv:
+		case TranscodeHardwareType::Vaapi:
+			return "format=nv12,hwupload";
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,49 @@
+//==============================================================================
+//
+//  Transcode
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "../transcode_context.h"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavutil/hwcontext.h>
+}
+
+// Render node used by VA-API
+#define TRANSCODE_VAAPI_DEVICE				"/dev/dri/renderD128"
+
+// Helpers of the hardware accelerators (NVDEC/NVENC, QSV, VA-API)
+//
+// - A device context is created once for each type and shared by all decoders, filters and encoders,
+//   so the decoded frames stay in the memory of the device until they are encoded
+// - The frame in the device is passed between the modules as the native frame of MediaFrame (see TranscodeFrame)
+class TranscodeHardware
+{
+public:
+	// "none", "nvenc" (or "nvidia", "cuda"), "qsv", "vaapi"
+	static TranscodeHardwareType ParseType(const ov::String &name);
+	static const char *GetTypeString(TranscodeHardwareType type);
+
+	// Returns a new reference of the device context (must be released using av_buffer_unref())
+	// Returns nullptr if the device is not available
+	static AVBufferRef *GetDeviceContext(TranscodeHardwareType type);
+
+	// Pixel format of the frames in the memory of the device
+	static AVPixelFormat GetPixelFormat(TranscodeHardwareType type);
+
+	// Name of the libavcodec decoder (nullptr: the native decoder is used with the hwaccel of the device)
+	static const char *GetDecoderName(TranscodeHardwareType type, common::MediaCodecId codec_id);
+	// Name of the libavcodec encoder (nullptr: not supported)
+	static const char *GetEncoderName(TranscodeHardwareType type, common::MediaCodecId codec_id);
+
+	// Name of the avfilter which scales the frames in the memory of the device
+	static const char *GetScaleFilterName(TranscodeHardwareType type);
+	// Filters which upload the frames in the system memory to the device
+	static const char *GetUploadFilter(TranscodeHardwareType type);
+};
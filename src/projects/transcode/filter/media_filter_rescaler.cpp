@@ -10,6 +10,15 @@
 #include "media_filter_rescaler.h"
 #include <base/ovlibrary/ovlibrary.h>
 
+#include "../codec/transcode_hardware.h"
+#include "../codec/transcode_frame.h"
+
+extern "C"
+{
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+}
+
 #define OV_LOG_TAG "MediaFilter"
 
 #define DEBUG_RESCALER    0
@@ -25,6 +34,8 @@ MediaFilterRescaler::MediaFilterRescaler()
 	avfilter_register_all();
 
 	_frame = av_frame_alloc();
+	_software_frame = av_frame_alloc();
+	_scaled_frame = av_frame_alloc();
 
 	// _frame_out = av_frame_alloc();
 
@@ -51,6 +62,14 @@ MediaFilterRescaler::~MediaFilterRescaler()
 	// 	av_frame_free(&_frame_out); 
 	// }
 
+	av_frame_free(&_software_frame);
+	av_frame_free(&_scaled_frame);
+
+	sws_freeContext(_sws_context);
+
+	// The buffers which are used by the encoders are freed when they are released
+	av_buffer_pool_uninit(&_buffer_pool);
+
 	if(_outputs)
 	{
 		avfilter_inout_free(&_outputs);
@@ -69,12 +88,197 @@ MediaFilterRescaler::~MediaFilterRescaler()
 
 
 bool MediaFilterRescaler::Configure(std::shared_ptr<MediaTrack> input_media_track, std::shared_ptr<TranscodeContext> context)
+{
+	_input_media_track = std::move(input_media_track);
+	_context = std::move(context);
+
+	// The filter graph is created when the first frame is received,
+	// because the frames context of the device is needed if the frames are decoded by the device
+	return (_input_media_track != nullptr) && (_context != nullptr);
+}
+
+bool MediaFilterRescaler::InitializeFilterGraph(const AVFrame *input_frame)
+{
+	auto hardware_type = _context->GetHardwareType();
+
+	if(hardware_type != TranscodeHardwareType::None)
+	{
+		if(CreateFilterGraph(input_frame, hardware_type))
+		{
+			logti("%s scaler is used for track[%u]", TranscodeHardware::GetScaleFilterName(hardware_type), _input_media_track->GetId());
+			return true;
+		}
+
+		logtw("Could not create %s scaler, software scaler will be used", TranscodeHardware::GetScaleFilterName(hardware_type));
+
+		avfilter_graph_free(&_filter_graph);
+		_buffersrc_ctx = nullptr;
+		_buffersink_ctx = nullptr;
+	}
+
+	// The frames decoded by the device are downloaded, and swscale scales and converts them in one pass
+	_direct_scaling = true;
+	_scale_flags = GetScaleFlags(_input_media_track->GetWidth(), _input_media_track->GetHeight(), _context->GetVideoWidth(), _context->GetVideoHeight());
+
+	logti("swscale (%s) is used for track[%u] (%dx%d -> %dx%d)", GetScaleFlagsName(_scale_flags), _input_media_track->GetId(),
+		  _input_media_track->GetWidth(), _input_media_track->GetHeight(), _context->GetVideoWidth(), _context->GetVideoHeight());
+
+	return true;
+}
+
+int MediaFilterRescaler::GetScaleFlags(int input_width, int input_height, int output_width, int output_height)
+{
+	if((input_width == output_width) && (input_height == output_height))
+	{
+		// Only the pixel format is converted
+		return SWS_POINT;
+	}
+
+	if((output_width > input_width) || (output_height > input_height))
+	{
+		return SWS_BICUBIC;
+	}
+
+	if(((output_width * 2) <= input_width) && ((output_height * 2) <= input_height))
+	{
+		// Averages the source pixels of each output pixel, which is cheap and doesn't alias
+		return SWS_AREA;
+	}
+
+	return SWS_BILINEAR;
+}
+
+const char *MediaFilterRescaler::GetScaleFlagsName(int flags)
+{
+	switch(flags)
+	{
+		case SWS_POINT:
+			return "point";
+		case SWS_BICUBIC:
+			return "bicubic";
+		case SWS_AREA:
+			return "area";
+		case SWS_BILINEAR:
+			return "bilinear";
+		default:
+			return "unknown";
+	}
+}
+
+bool MediaFilterRescaler::AllocateScaledFrame(int width, int height)
+{
+	int buffer_size = av_image_get_buffer_size(AV_PIX_FMT_YUV420P, width, height, 32);
+
+	if(buffer_size < 0)
+	{
+		return false;
+	}
+
+	if((_buffer_pool == nullptr) || (_buffer_size != buffer_size))
+	{
+		av_buffer_pool_uninit(&_buffer_pool);
+
+		_buffer_pool = av_buffer_pool_init(buffer_size, nullptr);
+		_buffer_size = buffer_size;
+
+		if(_buffer_pool == nullptr)
+		{
+			return false;
+		}
+	}
+
+	_scaled_frame->buf[0] = av_buffer_pool_get(_buffer_pool);
+
+	if(_scaled_frame->buf[0] == nullptr)
+	{
+		return false;
+	}
+
+	_scaled_frame->width = width;
+	_scaled_frame->height = height;
+	_scaled_frame->format = AV_PIX_FMT_YUV420P;
+
+	return av_image_fill_arrays(_scaled_frame->data, _scaled_frame->linesize, _scaled_frame->buf[0]->data, AV_PIX_FMT_YUV420P, width, height, 32) >= 0;
+}
+
+std::unique_ptr<MediaFrame> MediaFilterRescaler::ScaleFrame(AVFrame *frame, TranscodeResult *result)
+{
+	AVFrame *source = frame;
+
+	if(frame->hw_frames_ctx != nullptr)
+	{
+		if((av_hwframe_transfer_data(_software_frame, frame, 0) < 0) || (av_frame_copy_props(_software_frame, frame) < 0))
+		{
+			logte("Could not download the frame from the device");
+			av_frame_unref(_software_frame);
+			av_frame_unref(frame);
+			*result = TranscodeResult::DataError;
+			return nullptr;
+		}
+
+		source = _software_frame;
+	}
+
+	int width = _context->GetVideoWidth();
+	int height = _context->GetVideoHeight();
+	bool succeeded = true;
+
+	if((source->width == width) && (source->height == height) && (source->format == AV_PIX_FMT_YUV420P))
+	{
+		// Nothing to do, the picture is passed as is
+		succeeded = (av_frame_ref(_scaled_frame, source) == 0);
+	}
+	else
+	{
+		_sws_context = sws_getCachedContext(_sws_context,
+											source->width, source->height, static_cast<AVPixelFormat>(source->format),
+											width, height, AV_PIX_FMT_YUV420P,
+											_scale_flags, nullptr, nullptr, nullptr);
+
+		succeeded = (_sws_context != nullptr) && AllocateScaledFrame(width, height) && (av_frame_copy_props(_scaled_frame, source) == 0) &&
+					(sws_scale(_sws_context, source->data, source->linesize, 0, source->height, _scaled_frame->data, _scaled_frame->linesize) > 0);
+	}
+
+	// The same as settb of the filter graph
+	AVRational input_time_base = { _input_media_track->GetTimeBase().GetNum(), _input_media_track->GetTimeBase().GetDen() };
+	AVRational output_time_base = { _context->GetTimeBase().GetNum(), _context->GetTimeBase().GetDen() };
+
+	_scaled_frame->pts = (frame->pts == AV_NOPTS_VALUE) ? AV_NOPTS_VALUE : av_rescale_q(frame->pts, input_time_base, output_time_base);
+
+	av_frame_unref(_software_frame);
+	av_frame_unref(frame);
+
+	if(succeeded == false)
+	{
+		logte("Could not scale the frame of track[%u]", _input_media_track->GetId());
+		av_frame_unref(_scaled_frame);
+		*result = TranscodeResult::DataError;
+		return nullptr;
+	}
+
+	return MakeOutputFrame(_scaled_frame, result);
+}
+
+bool MediaFilterRescaler::CreateFilterGraph(const AVFrame *input_frame, TranscodeHardwareType hardware_type)
 {
 	int ret;
 	const AVFilter *buffersrc = avfilter_get_by_name("buffer");
 	const AVFilter *buffersink = avfilter_get_by_name("buffersink");
 
+	if(_filter_graph != nullptr)
+	{
+		// Clean up the graph which is failed to create
+		avfilter_graph_free(&_filter_graph);
+		_buffersrc_ctx = nullptr;
+		_buffersink_ctx = nullptr;
+	}
+
+	avfilter_inout_free(&_outputs);
+	avfilter_inout_free(&_inputs);
+
 	_filter_graph = avfilter_graph_alloc();
+	_outputs = avfilter_inout_alloc();
+	_inputs = avfilter_inout_alloc();
 
 	if(!_outputs || !_inputs || !_filter_graph)
 	{
@@ -82,16 +286,20 @@ bool MediaFilterRescaler::Configure(std::shared_ptr<MediaTrack> input_media_trac
 		return false;
 	}
 
-    AVRational ifr = av_d2q((double)input_media_track->GetFrameRate(), INT_MAX);
+	AVBufferRef *input_frames_context = (input_frame != nullptr) ? input_frame->hw_frames_ctx : nullptr;
+	// The planes copied to MediaFrame are always YUV420P
+	int input_pixel_format = (input_frame != nullptr) ? input_frame->format : AV_PIX_FMT_YUV420P;
+
+	AVRational ifr = av_d2q((double)_input_media_track->GetFrameRate(), INT_MAX);
 
 	// 입력 트랙의 정보를 설정함
 	ov::String input_formats = ov::String::FormatString(
 		"video_size=%dx%d:pix_fmt=%d:time_base=%d/%d:pixel_aspect=%d/%d:frame_rate=%d/%d:sws_param=flags=bicubic",
-		input_media_track->GetWidth(), input_media_track->GetHeight(),
-		AV_PIX_FMT_YUV420P,
-		input_media_track->GetTimeBase().GetNum(), input_media_track->GetTimeBase().GetDen(),
+		_input_media_track->GetWidth(), _input_media_track->GetHeight(),
+		input_pixel_format,
+		_input_media_track->GetTimeBase().GetNum(), _input_media_track->GetTimeBase().GetDen(),
 		1, 1,
-        ifr.num, ifr.den
+		ifr.num, ifr.den
 	);
 
 	ret = avfilter_graph_create_filter(&_buffersrc_ctx, buffersrc, "in", input_formats.CStr(), nullptr, _filter_graph);
@@ -101,17 +309,44 @@ bool MediaFilterRescaler::Configure(std::shared_ptr<MediaTrack> input_media_trac
 		return false;
 	}
 
+	if(input_frames_context != nullptr)
+	{
+		// The frames are in the memory of the device
+		AVBufferSrcParameters *parameters = av_buffersrc_parameters_alloc();
+
+		parameters->hw_frames_ctx = input_frames_context;
+		ret = av_buffersrc_parameters_set(_buffersrc_ctx, parameters);
+		av_free(parameters);
+
+		if(ret < 0)
+		{
+			logte("Cannot set the frames context to buffer source");
+			return false;
+		}
+	}
+
+	ov::String output_filter_descr;
+
+	if(hardware_type != TranscodeHardwareType::None)
+	{
+		if(input_frames_context == nullptr)
+		{
+			// Upload the frames decoded by software
+			output_filter_descr.AppendFormat("%s,", TranscodeHardware::GetUploadFilter(hardware_type));
+		}
+
+		output_filter_descr.AppendFormat("%s=w=%d:h=%d,", TranscodeHardware::GetScaleFilterName(hardware_type), _context->GetVideoWidth(), _context->GetVideoHeight());
+	}
+
 	// TODO: Timebase의 값을 설정이 가능하도록 할지, 기본값으로 고정할지 정해야함.
-	ov::String output_filter_descr = ov::String::FormatString(
-		"scale=%dx%d:flags=bicubic,settb=expr=%f",
-		context->GetVideoWidth(),
-        context->GetVideoHeight(),
-		context->GetTimeBase().GetExpr()
-	);
+	output_filter_descr.AppendFormat("settb=expr=%f", _context->GetTimeBase().GetExpr());
 
-	logtd("rescale track[%u] %s -> %s", input_media_track->GetId(), input_formats.CStr(), output_filter_descr.CStr());
+	logtd("rescale track[%u] %s -> %s", _input_media_track->GetId(), input_formats.CStr(), output_filter_descr.CStr());
 
-	enum AVPixelFormat pix_fmts[] = { AV_PIX_FMT_YUV420P, AV_PIX_FMT_NONE };
+	enum AVPixelFormat pix_fmts[] = {
+		(hardware_type != TranscodeHardwareType::None) ? TranscodeHardware::GetPixelFormat(hardware_type) : AV_PIX_FMT_YUV420P,
+		AV_PIX_FMT_NONE
+	};
 
 	ret = avfilter_graph_create_filter(&_buffersink_ctx, buffersink, "out", nullptr, nullptr, _filter_graph);
 	if(ret < 0)
@@ -147,6 +382,24 @@ bool MediaFilterRescaler::Configure(std::shared_ptr<MediaTrack> input_media_trac
 		return false;
 	}
 
+	if(hardware_type != TranscodeHardwareType::None)
+	{
+		// hwupload uses the device of the graph
+		AVBufferRef *device_context = TranscodeHardware::GetDeviceContext(hardware_type);
+
+		if(device_context == nullptr)
+		{
+			return false;
+		}
+
+		for(unsigned int index = 0; index < _filter_graph->nb_filters; index++)
+		{
+			_filter_graph->filters[index]->hw_device_ctx = av_buffer_ref(device_context);
+		}
+
+		av_buffer_unref(&device_context);
+	}
+
 	if((ret = avfilter_graph_config(_filter_graph, nullptr)) < 0)
 	{
 		logte("Cannot validation filter graph");
@@ -165,10 +418,45 @@ int32_t MediaFilterRescaler::SendBuffer(std::unique_ptr<MediaFrame> buffer)
 	return 0;
 }
 
+std::unique_ptr<MediaFrame> MediaFilterRescaler::MakeOutputFrame(AVFrame *frame, TranscodeResult *result)
+{
+	auto out_buf = std::make_unique<MediaFrame>();
+
+	out_buf->SetWidth(frame->width);
+	out_buf->SetHeight(frame->height);
+	out_buf->SetFormat(frame->format);
+
+	out_buf->SetPts((frame->pts == AV_NOPTS_VALUE) ? -1LL : frame->pts);
+
+	out_buf->SetStride(frame->linesize[0], 0);
+	out_buf->SetStride(frame->linesize[1], 1);
+	out_buf->SetStride(frame->linesize[2], 2);
+
+	// Pass the reference of the scaled picture to the encoder instead of copying the planes
+	// (if the hardware scaler is used, the picture is in the memory of the device)
+	auto native_frame = TranscodeFrame::MakeReference(frame);
+
+	if(native_frame == nullptr)
+	{
+		logte("Could not reference the scaled frame");
+		av_frame_unref(frame);
+		*result = TranscodeResult::DataError;
+		return nullptr;
+	}
+
+	out_buf->SetNativeFrame(std::move(native_frame));
+
+	av_frame_unref(frame);
+
+	*result = TranscodeResult::DataReady;
+	return std::move(out_buf);
+}
+
 std::unique_ptr<MediaFrame> MediaFilterRescaler::RecvBuffer(TranscodeResult *result)
 {
 	// 출력될 프레임이 있는지 확인함
-	int ret = av_buffersink_get_frame(_buffersink_ctx, _frame);
+	// (The graph is not created until the first frame is received)
+	int ret = (_buffersink_ctx != nullptr) ? av_buffersink_get_frame(_buffersink_ctx, _frame) : AVERROR(EAGAIN);
 
 	if(ret == AVERROR(EAGAIN))
 	{
@@ -188,26 +476,7 @@ std::unique_ptr<MediaFrame> MediaFilterRescaler::RecvBuffer(TranscodeResult *res
 	}
 	else
 	{
-		auto out_buf = std::make_unique<MediaFrame>();
-
-		out_buf->SetWidth(_frame->width);
-		out_buf->SetHeight(_frame->height);
-		out_buf->SetFormat(_frame->format);
-
-		out_buf->SetPts((_frame->pts == AV_NOPTS_VALUE) ? -1LL : _frame->pts);
-
-		out_buf->SetStride(_frame->linesize[0], 0);
-		out_buf->SetStride(_frame->linesize[1], 1);
-		out_buf->SetStride(_frame->linesize[2], 2);
-
-		out_buf->SetBuffer(_frame->data[0], out_buf->GetStride(0) * out_buf->GetHeight(), 0);        // Y-Plane
-		out_buf->SetBuffer(_frame->data[1], out_buf->GetStride(1) * out_buf->GetHeight() / 2, 1);    // Cb Plane
-		out_buf->SetBuffer(_frame->data[2], out_buf->GetStride(2) * out_buf->GetHeight() / 2, 2);        // Cr Plane
-
-		av_frame_unref(_frame);
-
-		*result = TranscodeResult::DataReady;
-		return std::move(out_buf);
+		return MakeOutputFrame(_frame, result);
 	}
 
 	while(_pkt_buf.empty() == false)
@@ -216,34 +485,22 @@ std::unique_ptr<MediaFrame> MediaFilterRescaler::RecvBuffer(TranscodeResult *res
 		auto cur_pkt = std::move(_pkt_buf[0]);
 		_pkt_buf.erase(_pkt_buf.begin(), _pkt_buf.begin() + 1);
 
-		_frame->format = cur_pkt->GetFormat();
-		_frame->width = cur_pkt->GetWidth();
-		_frame->height = cur_pkt->GetHeight();
-		_frame->pts = cur_pkt->GetPts();
-
-		_frame->linesize[0] = cur_pkt->GetStride(0);
-		_frame->linesize[1] = cur_pkt->GetStride(1);
-		_frame->linesize[2] = cur_pkt->GetStride(2);
-
-		if(av_frame_get_buffer(_frame, 32) < 0)
+		if((_filter_graph == nullptr) && (_direct_scaling == false))
 		{
-			logte("Could not allocate the video frame data\n");
-			*result = TranscodeResult::DataError;
-			return nullptr;
+			if(InitializeFilterGraph(TranscodeFrame::GetAVFrame(cur_pkt.get())) == false)
+			{
+				*result = TranscodeResult::DataError;
+				return nullptr;
+			}
 		}
 
-		if(av_frame_make_writable(_frame) < 0)
+		// The picture of the decoder is referenced if possible
+		if(TranscodeFrame::MakeAVFrame(cur_pkt.get(), _frame) == false)
 		{
-			logte("Could not make sure the frame data is writable\n");
 			*result = TranscodeResult::DataError;
 			return nullptr;
 		}
 
-		// Copy data of cur_pkt to _frame
-		memcpy(_frame->data[0], cur_pkt->GetBuffer(0), cur_pkt->GetBufferSize(0));
-		memcpy(_frame->data[1], cur_pkt->GetBuffer(1), cur_pkt->GetBufferSize(1));
-		memcpy(_frame->data[2], cur_pkt->GetBuffer(2), cur_pkt->GetBufferSize(2));
-
 #if DEBUG_PREVIEW_ENABLE && DEBUG_RESCALER    // DEBUG for OpenCV
 		Mat *display_frame = nullptr;
 
@@ -254,6 +511,12 @@ std::unique_ptr<MediaFrame> MediaFilterRescaler::RecvBuffer(TranscodeResult *res
 		delete display_frame;
 #endif
 
+		if(_direct_scaling)
+		{
+			// A frame for each input frame
+			return ScaleFrame(_frame, result);
+		}
+
 		if(av_buffersrc_add_frame_flags(_buffersrc_ctx, _frame, AV_BUFFERSRC_FLAG_KEEP_REF) < 0)
 		{
 			logte("Error while feeding the audio filtergraph. frame.format(%d), buffer.pts(%lld) buffer.linesize(%d), buf.size(%d)\n", _frame->format, _frame->pts, _frame->linesize[0], _pkt_buf.size());
@@ -15,6 +15,11 @@
 
 #include "../transcode_context.h"
 
+extern "C"
+{
+#include <libswscale/swscale.h>
+}
+
 class MediaFilterRescaler : public MediaFilterImpl
 {
 public:
@@ -27,6 +32,26 @@ public:
 	std::unique_ptr<MediaFrame> RecvBuffer(TranscodeResult *result) override;
 
 private:
+	// Creates the graph using the hardware scaler of the context if possible,
+	// or the frames are scaled by swscale directly (the graph is not needed to scale the pictures by software)
+	// input_frame: the first native frame of the decoder (nullptr if the planes are copied to MediaFrame)
+	bool InitializeFilterGraph(const AVFrame *input_frame);
+	bool CreateFilterGraph(const AVFrame *input_frame, TranscodeHardwareType hardware_type);
+
+	// Scales the frame into YUV420P (the format of the software encoders) in one pass, the frame is unreferenced
+	std::unique_ptr<MediaFrame> ScaleFrame(AVFrame *frame, TranscodeResult *result);
+	// Allocates the planes of _scaled_frame from the pool
+	bool AllocateScaledFrame(int width, int height);
+	// The cheapest scaler which keeps the quality of the ratio
+	static int GetScaleFlags(int input_width, int input_height, int output_width, int output_height);
+	static const char *GetScaleFlagsName(int flags);
+
+	// Makes the output frame which refers the picture of the frame, the frame is unreferenced
+	std::unique_ptr<MediaFrame> MakeOutputFrame(AVFrame *frame, TranscodeResult *result);
+
+	std::shared_ptr<MediaTrack> _input_media_track;
+	std::shared_ptr<TranscodeContext> _context;
+
 	AVFrame *_frame;
 	AVFilterContext *_buffersink_ctx;
 	AVFilterContext *_buffersrc_ctx;
@@ -35,4 +60,15 @@ private:
 	AVFilterInOut *_inputs;
 
 	std::vector<std::unique_ptr<MediaFrame>> _pkt_buf;
+
+	// true: swscale is used instead of the filter graph
+	bool _direct_scaling = false;
+	SwsContext *_sws_context = nullptr;
+	int _scale_flags = 0;
+	// The frame downloaded from the device (NV12 of the hardware decoder)
+	AVFrame *_software_frame = nullptr;
+	AVFrame *_scaled_frame = nullptr;
+	// The scaled pictures go to the encoders by reference, so their buffers return to the pool when the encoders release them
+	AVBufferPool *_buffer_pool = nullptr;
+	int _buffer_size = 0;
 };
@@ -67,12 +67,12 @@ bool TranscodeApplication::OnDeleteStream(std::shared_ptr<StreamInfo> stream_inf
 	return true;
 }
 
-bool TranscodeApplication::OnSendVideoFrame(std::shared_ptr<StreamInfo> stream_info, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrame> encoded_frame, std::unique_ptr<CodecSpecificInfo> codec_info, std::unique_ptr<FragmentationHeader> fragmentation)
+bool TranscodeApplication::OnSendVideoFrame(std::shared_ptr<StreamInfo> stream_info, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrameDescriptor> frame)
 {
 	return true;
 }
 
-bool TranscodeApplication::OnSendAudioFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrame> encoded_frame, std::unique_ptr<CodecSpecificInfo> codec_info, std::unique_ptr<FragmentationHeader> fragmentation)
+bool TranscodeApplication::OnSendAudioFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrameDescriptor> frame)
 {
 	return true;
 }
@@ -92,3 +92,62 @@ bool TranscodeApplication::OnSendFrame(std::shared_ptr<StreamInfo> stream_info,
 
 	return stream->Push(std::move(packet));
 }
+
+bool TranscodeApplication::OnKeyFrameRequested(const std::shared_ptr<StreamInfo> &stream_info, int32_t track_id)
+{
+	uint32_t input_stream_id = 0;
+	MediaTrackId bypass_track_id = -1;
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		auto stream_item = std::find_if(_streams.begin(), _streams.end(), [&](const std::pair<const int32_t, std::shared_ptr<TranscodeStream>> &item) -> bool {
+			return item.second->RequestKeyFrame(stream_info->GetId(), track_id, bypass_track_id);
+		});
+
+		if(stream_item == _streams.end())
+		{
+			return false;
+		}
+
+		if(bypass_track_id < 0)
+		{
+			return true;
+		}
+
+		input_stream_id = stream_item->second->GetInputStreamId();
+	}
+
+	// The packets of the track are not encoded here, the request goes upstream (without the lock)
+	return RequestKeyFrame(input_stream_id, bypass_track_id);
+}
+
+void TranscodeApplication::Stop()
+{
+	std::map<int32_t, std::shared_ptr<TranscodeStream>> streams;
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		streams = std::move(_streams);
+		_streams.clear();
+	}
+
+	for(auto &stream : streams)
+	{
+		stream.second->Stop();
+	}
+}
+
+std::shared_ptr<TranscodeStream> TranscodeApplication::GetStream(uint32_t stream_id)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	auto stream_bucket = _streams.find(stream_id);
+
+	if(stream_bucket == _streams.end())
+	{
+		return nullptr;
+	}
+
+	return stream_bucket->second;
+}
@@ -58,17 +58,29 @@ public:
 	bool OnSendVideoFrame(
 		std::shared_ptr<StreamInfo> stream_info,
 		std::shared_ptr<MediaTrack> track,
-		std::unique_ptr<EncodedFrame> encoded_frame,
-		std::unique_ptr<CodecSpecificInfo> codec_info,
-		std::unique_ptr<FragmentationHeader> fragmentation) override;
+		std::unique_ptr<EncodedFrameDescriptor> frame) override;
 
-	bool OnSendAudioFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrame> encoded_frame, std::unique_ptr<CodecSpecificInfo> codec_info, std::unique_ptr<FragmentationHeader> fragmentation) override;
+	bool OnSendAudioFrame(std::shared_ptr<StreamInfo> stream, std::shared_ptr<MediaTrack> track, std::unique_ptr<EncodedFrameDescriptor> frame) override;
 
 	bool OnSendFrame(
 		std::shared_ptr<StreamInfo> stream_info,
 		std::unique_ptr<MediaPacket> packet
 	) override;
 
+	// The players of an output stream ask for a key frame (the bypassed tracks ask the provider of the input)
+	bool OnKeyFrameRequested(const std::shared_ptr<StreamInfo> &stream_info, int32_t track_id) override;
+
+	// nullptr if the stream is not transcoded by this application
+	std::shared_ptr<TranscodeStream> GetStream(uint32_t stream_id);
+
+	const info::Application *GetApplicationInfo() const
+	{
+		return _application_info;
+	}
+
+	// Stops all the streams (the application is deleted by the config reload)
+	void Stop();
+
 private:
 	std::map<int32_t, std::shared_ptr<TranscodeStream>> _streams;
 	std::mutex _mutex;
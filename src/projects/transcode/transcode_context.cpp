@@ -7,7 +7,9 @@
 //
 //==============================================================================
 
+#include <algorithm>
 #include <iostream>
+#include <thread>
 #include <unistd.h>
 
 #include "transcode_context.h"
@@ -134,3 +136,164 @@ common::MediaType TranscodeContext::GetMediaType() const
 	return _media_type;
 }
 
+
+void TranscodeContext::SetHardwareType(TranscodeHardwareType type)
+{
+	_hardware_type = type;
+}
+
+TranscodeHardwareType TranscodeContext::GetHardwareType() const
+{
+	return _hardware_type;
+}
+
+void TranscodeContext::SetBypass(bool bypass)
+{
+	_is_bypass = bypass;
+}
+
+bool TranscodeContext::IsBypass() const
+{
+	return _is_bypass;
+}
+
+void TranscodeContext::SetEncoderPreset(const TranscodeEncoderPreset &preset)
+{
+	_encoder_preset = preset;
+}
+
+const TranscodeEncoderPreset &TranscodeContext::GetEncoderPreset() const
+{
+	return _encoder_preset;
+}
+
+void TranscodeContext::SetTemporalLayerCount(uint8_t count)
+{
+	_temporal_layer_count = count;
+}
+
+uint8_t TranscodeContext::GetTemporalLayerCount() const
+{
+	return _temporal_layer_count;
+}
+
+void TranscodeContext::SetOpusOptions(const TranscodeOpusOptions &options)
+{
+	_opus_options = options;
+}
+
+const TranscodeOpusOptions &TranscodeContext::GetOpusOptions() const
+{
+	return _opus_options;
+}
+
+bool TranscodeOpusOptions::IsValidFrameDuration(int frame_duration)
+{
+	switch(frame_duration)
+	{
+		case 2500:
+		case 5000:
+		case 10000:
+		case 20000:
+		case 40000:
+		case 60000:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+bool TranscodeEncoderPreset::Find(const ov::String &name, TranscodeEncoderPreset *preset)
+{
+	auto lower_name = name.LowerCaseString();
+	TranscodeEncoderPreset new_preset;
+
+	new_preset.name = lower_name;
+
+	if(lower_name.IsEmpty() || (lower_name == "default"))
+	{
+		new_preset.name = "default";
+	}
+	else if((lower_name == "low-latency") || (lower_name == "screen"))
+	{
+		new_preset.screen_content = (lower_name == "screen");
+		new_preset.thread_count = 0;
+		new_preset.slice_count = 0;
+		new_preset.complexity = TranscodeEncoderComplexity::Low;
+		new_preset.rate_control = TranscodeRateControl::Bitrate;
+		new_preset.frame_skip = true;
+	}
+	else if(lower_name == "balanced")
+	{
+		new_preset.thread_count = 0;
+		new_preset.slice_count = 0;
+		new_preset.complexity = TranscodeEncoderComplexity::Medium;
+		new_preset.rate_control = TranscodeRateControl::Bitrate;
+	}
+	else if(lower_name == "quality")
+	{
+		new_preset.thread_count = 0;
+		new_preset.slice_count = 1;
+		new_preset.complexity = TranscodeEncoderComplexity::High;
+		new_preset.rate_control = TranscodeRateControl::Buffer;
+	}
+	else
+	{
+		return false;
+	}
+
+	*preset = new_preset;
+
+	return true;
+}
+
+bool TranscodeEncoderPreset::ParseRateControl(const ov::String &name, TranscodeRateControl *rate_control)
+{
+	auto lower_name = name.LowerCaseString();
+
+	if(lower_name == "off")
+	{
+		*rate_control = TranscodeRateControl::Off;
+	}
+	else if((lower_name == "bitrate") || (lower_name == "cbr"))
+	{
+		*rate_control = TranscodeRateControl::Bitrate;
+	}
+	else if(lower_name == "quality")
+	{
+		*rate_control = TranscodeRateControl::Quality;
+	}
+	else if((lower_name == "buffer") || (lower_name == "vbr"))
+	{
+		*rate_control = TranscodeRateControl::Buffer;
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+int TranscodeEncoderPreset::GetThreadCount() const
+{
+	if(thread_count != 0)
+	{
+		return thread_count;
+	}
+
+	int core_count = static_cast<int>(std::thread::hardware_concurrency());
+
+	return std::min(std::max(core_count, 1), TRANSCODE_ENCODER_MAX_THREAD_COUNT);
+}
+
+int TranscodeEncoderPreset::GetSliceCount() const
+{
+	if(slice_count > 0)
+	{
+		return slice_count;
+	}
+
+	return std::max(GetThreadCount(), 1);
+}
@@ -14,6 +14,107 @@
 #include <base/ovlibrary/ovlibrary.h>
 #include "base/media_route/media_type.h"
 
+// Hardware accelerator used to decode/scale/encode the video (<HWAcceleration> of the video profile)
+enum class TranscodeHardwareType : int8_t
+{
+	None,
+	// NVDEC/NVENC (CUDA)
+	Nvidia,
+	// Intel Quick Sync Video
+	Qsv,
+	// VA-API
+	Vaapi
+};
+
+// Maximum number of the threads of a video encoder if the thread count is automatic
+#define TRANSCODE_ENCODER_MAX_THREAD_COUNT		4
+
+// Rate control of the video encoder (<RateControl> of the video profile)
+enum class TranscodeRateControl : int8_t
+{
+	// The setting of each encoder before the presets (OpenH264: off, VP8: constant bitrate)
+	Default,
+	// The bitrate is not controlled (the quantizer decides the bitrate)
+	Off,
+	// Keeps the bitrate, the quality changes by the content
+	Bitrate,
+	// Keeps the quality, the bitrate is the upper limit
+	Quality,
+	// Keeps the average bitrate using the buffer (smoother than Bitrate)
+	Buffer
+};
+
+// Speed against the quality of the video encoder
+enum class TranscodeEncoderComplexity : int8_t
+{
+	// The default of the encoder
+	Default,
+	Low,
+	Medium,
+	High
+};
+
+// Performance preset of the video encoder (<Preset> of the video profile)
+//
+// - default: the settings before the presets
+// - low-latency: fastest, the slices are encoded in parallel, the frames are skipped to keep the bitrate
+// - balanced: multi-threaded, the bitrate is controlled
+// - quality: multi-threaded, slower, the bitrate is controlled using the buffer
+// - screen: low-latency for the screen contents
+struct TranscodeEncoderPreset
+{
+	ov::String name = "default";
+
+	// The input is the screen contents (OpenH264 uses the tools for the screen)
+	bool screen_content = false;
+	// -1: the default of the encoder, 0: number of the cores (up to TRANSCODE_ENCODER_MAX_THREAD_COUNT)
+	int thread_count = -1;
+	// Slices of a picture (0: same as the thread count)
+	int slice_count = 1;
+	TranscodeEncoderComplexity complexity = TranscodeEncoderComplexity::Default;
+	TranscodeRateControl rate_control = TranscodeRateControl::Default;
+	bool frame_skip = false;
+
+	// Returns false if the preset is not found
+	static bool Find(const ov::String &name, TranscodeEncoderPreset *preset);
+	static bool ParseRateControl(const ov::String &name, TranscodeRateControl *rate_control);
+
+	// The thread count to use (-1 if the encoder decides)
+	int GetThreadCount() const;
+	int GetSliceCount() const;
+};
+
+// Options of the OPUS encoder (<Opus> of the audio profile)
+struct TranscodeOpusOptions
+{
+	// us (2500, 5000, 10000, 20000, 40000, 60000)
+	int frame_duration = 20000;
+	// 0~10 (-1: the default of libopus)
+	int complexity = -1;
+	bool dtx = false;
+	bool fec = true;
+	// 0~100 (%)
+	int expected_loss = 10;
+
+	bool operator==(const TranscodeOpusOptions &options) const
+	{
+		return (frame_duration == options.frame_duration) &&
+		       (complexity == options.complexity) &&
+		       (dtx == options.dtx) &&
+		       (fec == options.fec) &&
+		       (expected_loss == options.expected_loss);
+	}
+
+	// Returns false if the duration is not a frame size of OPUS
+	static bool IsValidFrameDuration(int frame_duration);
+
+	// Samples (per channel) of a frame
+	int GetFrameSamples(int sample_rate) const
+	{
+		return static_cast<int>(static_cast<int64_t>(sample_rate) * frame_duration / 1000000);
+	}
+};
+
 class TranscodeContext
 {
 public:
@@ -88,6 +189,23 @@ public:
 
 	common::MediaType GetMediaType() const;
 
+	void SetHardwareType(TranscodeHardwareType type);
+	TranscodeHardwareType GetHardwareType() const;
+
+	// true: the packets of the input track are sent without decoding/encoding
+	void SetBypass(bool bypass);
+	bool IsBypass() const;
+
+	void SetEncoderPreset(const TranscodeEncoderPreset &preset);
+	const TranscodeEncoderPreset &GetEncoderPreset() const;
+
+	// Temporal layers of the video encoder (1: no layer)
+	void SetTemporalLayerCount(uint8_t count);
+	uint8_t GetTemporalLayerCount() const;
+
+	void SetOpusOptions(const TranscodeOpusOptions &options);
+	const TranscodeOpusOptions &GetOpusOptions() const;
+
 private:
 	//--------------------------------------------------------------------
 	// Video transcoding options
@@ -117,5 +235,15 @@ private:
 
 	// Channel
 	common::AudioChannel _audio_channel;
+
+	TranscodeHardwareType _hardware_type = TranscodeHardwareType::None;
+
+	bool _is_bypass = false;
+
+	TranscodeEncoderPreset _encoder_preset;
+
+	uint8_t _temporal_layer_count = 1;
+
+	TranscodeOpusOptions _opus_options;
 };
 
@@ -0,0 +1,299 @@
+//==============================================================================
+//
+//  Transcode
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "transcode_scheduler.h"
+
+#include <chrono>
+
+#define OV_LOG_TAG "TranscodeScheduler"
+
+namespace
+{
+	// Index of the worker which is running on the current thread (-1: not a worker)
+	thread_local int current_worker_index = -1;
+}
+
+TranscodeScheduler::~TranscodeScheduler()
+{
+	Stop();
+}
+
+void TranscodeScheduler::SetWorkerCount(int worker_count)
+{
+	std::lock_guard<std::mutex> lock(_start_mutex);
+
+	if(_running)
+	{
+		logtw("Transcode scheduler is already started with %zu workers, the worker count (%d) is ignored", _workers.size(), worker_count);
+		return;
+	}
+
+	_worker_count = std::max(worker_count, 0);
+}
+
+int TranscodeScheduler::GetWorkerCount() const
+{
+	return (_worker_count > 0) ? _worker_count : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+}
+
+bool TranscodeScheduler::Start()
+{
+	std::lock_guard<std::mutex> lock(_start_mutex);
+
+	if(_running)
+	{
+		// Already started by another host
+		return true;
+	}
+
+	int worker_count = GetWorkerCount();
+
+	for(int index = 0; index < worker_count; index++)
+	{
+		_workers.push_back(std::make_unique<Worker>());
+	}
+
+	_running = true;
+
+	try
+	{
+		for(int index = 0; index < worker_count; index++)
+		{
+			_workers[index]->thread = std::thread(&TranscodeScheduler::WorkerThread, this, index);
+		}
+	}
+	catch(const std::system_error &e)
+	{
+		logte("Failed to start transcode worker thread.");
+
+		_running = false;
+		_idle_condition.notify_all();
+
+		for(auto &worker : _workers)
+		{
+			if(worker->thread.joinable())
+			{
+				worker->thread.join();
+			}
+		}
+
+		_workers.clear();
+
+		return false;
+	}
+
+	logti("Transcode scheduler is started with %d workers", worker_count);
+
+	return true;
+}
+
+bool TranscodeScheduler::Stop()
+{
+	std::lock_guard<std::mutex> lock(_start_mutex);
+
+	if(_running == false)
+	{
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> idle_lock(_idle_mutex);
+
+		_running = false;
+		_idle_condition.notify_all();
+	}
+
+	for(auto &worker : _workers)
+	{
+		if(worker->thread.joinable())
+		{
+			worker->thread.join();
+		}
+	}
+
+	_workers.clear();
+	_task_count = 0;
+
+	logtd("Transcode scheduler is stopped");
+
+	return true;
+}
+
+bool TranscodeScheduler::Post(Task task, const std::shared_ptr<ApplicationQuotaStatistics> &quota)
+{
+	if(_running == false)
+	{
+		logtw("Transcode scheduler is not started, the task is ignored");
+		return false;
+	}
+
+	int worker_index = current_worker_index;
+
+	if(worker_index < 0)
+	{
+		worker_index = static_cast<int>(_next_worker_index++ % _workers.size());
+	}
+
+	// Counted before queueing, so that PopTask() never makes the count negative
+	_task_count++;
+
+	{
+		auto &worker = _workers[worker_index];
+		std::lock_guard<std::mutex> lock(worker->mutex);
+
+		worker->tasks.push_back({ std::move(task), quota });
+	}
+
+	{
+		// Take the lock, so that the worker which is going to sleep does not miss the notification
+		std::lock_guard<std::mutex> lock(_idle_mutex);
+		_idle_condition.notify_one();
+	}
+
+	return true;
+}
+
+template<typename Tfilter>
+bool TranscodeScheduler::PopTask(int worker_index, QueuedTask &task, Tfilter filter)
+{
+	size_t worker_count = _workers.size();
+
+	// Own tasks are run in the posted order, other tasks are stolen from the newest one
+	for(size_t offset = 0; offset < worker_count; offset++)
+	{
+		auto &worker = _workers[(worker_index + offset) % worker_count];
+		std::lock_guard<std::mutex> lock(worker->mutex);
+
+		auto &tasks = worker->tasks;
+		size_t count = tasks.size();
+
+		for(size_t index = 0; index < count; index++)
+		{
+			auto item = (offset == 0) ? (tasks.begin() + index) : (tasks.end() - 1 - index);
+
+			if(filter(*item) == false)
+			{
+				continue;
+			}
+
+			task = std::move(*item);
+			tasks.erase(item);
+
+			_task_count--;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool TranscodeScheduler::PopTask(int worker_index, QueuedTask &task, bool &is_throttled)
+{
+	auto quota = ApplicationQuota::Instance();
+	int64_t current_time = ApplicationQuota::GetCurrentMilliseconds();
+	uint32_t worker_count = static_cast<uint32_t>(_workers.size());
+
+	// The quota of the first task which is skipped
+	std::shared_ptr<ApplicationQuotaStatistics> deferred_quota;
+
+	is_throttled = false;
+
+	// The applications under their share first
+	if(PopTask(worker_index, task, [&](const QueuedTask &item) -> bool {
+		   if(quota->IsOverShare(item.quota, ApplicationQuotaScheduler::Transcoder, current_time, worker_count))
+		   {
+			   deferred_quota = (deferred_quota == nullptr) ? item.quota : deferred_quota;
+			   return false;
+		   }
+
+		   return true;
+	   }))
+	{
+		if(deferred_quota != nullptr)
+		{
+			deferred_quota->AddDeferredCount(ApplicationQuotaScheduler::Transcoder);
+		}
+
+		return true;
+	}
+
+	deferred_quota.reset();
+
+	// Then the idle workers are used by the others, unless they reach the limits
+	if(PopTask(worker_index, task, [&](const QueuedTask &item) -> bool {
+		   if(ApplicationQuota::IsOverLimit(item.quota, ApplicationQuotaScheduler::Transcoder, current_time, worker_count))
+		   {
+			   deferred_quota = (deferred_quota == nullptr) ? item.quota : deferred_quota;
+			   return false;
+		   }
+
+		   return true;
+	   }))
+	{
+		return true;
+	}
+
+	if(deferred_quota != nullptr)
+	{
+		deferred_quota->AddDeferredCount(ApplicationQuotaScheduler::Transcoder);
+		is_throttled = true;
+	}
+
+	return false;
+}
+
+void TranscodeScheduler::WorkerThread(int worker_index)
+{
+	current_worker_index = worker_index;
+
+	ov::ThreadTopology::Instance()->BindCurrentThread(OV_THREAD_POOL_TRANSCODER, worker_index);
+
+	logtd("Transcode worker #%d is started", worker_index);
+
+	while(_running)
+	{
+		QueuedTask task;
+		bool is_throttled = false;
+
+		if(PopTask(worker_index, task, is_throttled))
+		{
+			if(task.quota == nullptr)
+			{
+				task.task();
+				continue;
+			}
+
+			auto start_time = std::chrono::steady_clock::now();
+
+			task.task();
+
+			auto end_time = std::chrono::steady_clock::now();
+
+			task.quota->AddBusyTime(ApplicationQuotaScheduler::Transcoder, ApplicationQuota::GetCurrentMilliseconds(),
+									std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count());
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_idle_mutex);
+
+		if(is_throttled)
+		{
+			// The tasks over the limits are resumed by the next window
+			_idle_condition.wait_for(lock, std::chrono::milliseconds(APPLICATION_QUOTA_WINDOW_MS - (ApplicationQuota::GetCurrentMilliseconds() % APPLICATION_QUOTA_WINDOW_MS)));
+			continue;
+		}
+
+		_idle_condition.wait(lock, [this]() -> bool {
+			return (_running == false) || (_task_count > 0);
+		});
+	}
+
+	current_worker_index = -1;
+
+	logtd("Transcode worker #%d is terminated", worker_index);
+}
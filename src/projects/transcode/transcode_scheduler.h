@@ -0,0 +1,88 @@
+//==============================================================================
+//
+//  Transcode
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+#include <base/application/application_quota.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Maximum number of items processed by a stage of a stream before yielding the worker to other streams
+#define TRANSCODE_STAGE_BATCH_COUNT				8
+
+// Work-stealing thread pool shared by all transcode streams
+//
+// - Each worker has its own deque. The tasks posted by a worker go to its own deque (to keep the frames in the cache),
+//   and the tasks posted by other threads are distributed in round-robin
+// - A worker runs its own tasks in the posted order, and steals the newest task of the other workers when it has nothing to do
+// - The scheduler does not order the tasks, so the caller must not post the tasks which must be run sequentially
+//   at the same time (see TranscodeStream::ScheduleStage())
+// - The tasks of an application which exceeds its weighted share of the window (see ApplicationQuota) are skipped
+//   while the other applications have tasks, and the tasks over <MaxTranscodeShare> wait for the next window
+class TranscodeScheduler : public ov::Singleton<TranscodeScheduler>
+{
+public:
+	friend class ov::Singleton<TranscodeScheduler>;
+
+	typedef std::function<void()> Task;
+
+	~TranscodeScheduler() override;
+
+	// Number of the workers (0: number of the cores), must be called before Start()
+	void SetWorkerCount(int worker_count);
+	int GetWorkerCount() const;
+
+	bool Start();
+	bool Stop();
+
+	// Returns false if the scheduler is not running (the task is not run)
+	// - The run time of the task is accounted to the quota (nullptr: not accounted)
+	bool Post(Task task, const std::shared_ptr<ApplicationQuotaStatistics> &quota = nullptr);
+
+protected:
+	TranscodeScheduler() = default;
+
+	struct QueuedTask
+	{
+		Task task;
+		std::shared_ptr<ApplicationQuotaStatistics> quota;
+	};
+
+	struct Worker
+	{
+		std::mutex mutex;
+		std::deque<QueuedTask> tasks;
+		std::thread thread;
+	};
+
+	void WorkerThread(int worker_index);
+	// is_throttled: the queued tasks are over the limits of their quotas (nothing can be run in this window)
+	bool PopTask(int worker_index, QueuedTask &task, bool &is_throttled);
+	// Pops the first task which is accepted by the filter (own tasks from the oldest one, other tasks from the newest one)
+	template<typename Tfilter>
+	bool PopTask(int worker_index, QueuedTask &task, Tfilter filter);
+
+	int _worker_count = 0;
+
+	std::mutex _start_mutex;
+	std::atomic<bool> _running { false };
+	std::vector<std::unique_ptr<Worker>> _workers;
+
+	std::atomic<uint32_t> _next_worker_index { 0 };
+	std::atomic<size_t> _task_count { 0 };
+
+	std::mutex _idle_mutex;
+	std::condition_variable _idle_condition;
+};
@@ -0,0 +1,107 @@
+//==============================================================================
+//
+//  Transcode
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "transcode_statistics.h"
+
+#include <algorithm>
+
+TranscodeStageStatistics::TranscodeStageStatistics()
+{
+	_latency_samples.reserve(TRANSCODE_STATISTICS_SAMPLE_COUNT);
+}
+
+int64_t TranscodeStageStatistics::GetCurrentMicroseconds()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TranscodeStageStatistics::AddFrame(int64_t latency)
+{
+	int64_t now = GetCurrentMicroseconds();
+
+	if(_first_frame_time < 0)
+	{
+		_first_frame_time = now;
+	}
+
+	_last_frame_time = now;
+	_frame_count++;
+
+	if(latency > _max_latency)
+	{
+		_max_latency = latency;
+	}
+
+	std::lock_guard<std::mutex> lock(_sample_mutex);
+
+	if(_latency_samples.size() < TRANSCODE_STATISTICS_SAMPLE_COUNT)
+	{
+		_latency_samples.push_back(latency);
+	}
+	else
+	{
+		_latency_samples[_next_sample_index] = latency;
+		_next_sample_index = (_next_sample_index + 1) % TRANSCODE_STATISTICS_SAMPLE_COUNT;
+	}
+}
+
+uint64_t TranscodeStageStatistics::GetFrameCount() const
+{
+	return _frame_count;
+}
+
+double TranscodeStageStatistics::GetFps() const
+{
+	int64_t first_frame_time = _first_frame_time;
+	int64_t elapsed = _last_frame_time - first_frame_time;
+
+	if((first_frame_time < 0) || (elapsed <= 0))
+	{
+		return 0.0;
+	}
+
+	// The first frame is the start of the measurement
+	return static_cast<double>(_frame_count - 1) * 1000000.0 / static_cast<double>(elapsed);
+}
+
+int64_t TranscodeStageStatistics::GetLatencyPercentile(double percentile) const
+{
+	std::vector<int64_t> samples;
+
+	{
+		std::lock_guard<std::mutex> lock(_sample_mutex);
+		samples = _latency_samples;
+	}
+
+	if(samples.empty())
+	{
+		return 0;
+	}
+
+	percentile = std::min(std::max(percentile, 0.0), 100.0);
+
+	auto index = static_cast<size_t>(percentile * static_cast<double>(samples.size() - 1) / 100.0);
+
+	std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+
+	return samples[index];
+}
+
+int64_t TranscodeStageStatistics::GetMaxLatency() const
+{
+	return _max_latency;
+}
+
+ov::String TranscodeStageStatistics::ToString() const
+{
+	return ov::String::FormatString("frames: %llu, fps: %.2f, latency(us) p50: %lld, p90: %lld, p99: %lld, max: %lld",
+	                                static_cast<unsigned long long>(GetFrameCount()), GetFps(),
+	                                static_cast<long long>(GetLatencyPercentile(50.0)),
+	                                static_cast<long long>(GetLatencyPercentile(90.0)),
+	                                static_cast<long long>(GetLatencyPercentile(99.0)),
+	                                static_cast<long long>(GetMaxLatency()));
+}
@@ -0,0 +1,53 @@
+//==============================================================================
+//
+//  Transcode
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+// Number of the recent latencies kept to calculate the percentiles
+#define TRANSCODE_STATISTICS_SAMPLE_COUNT		4096
+
+// Throughput and latency of a stage of TranscodeStream
+//
+// - AddFrame() is called by the stage (one thread at a time), the getters can be called by any thread
+// - The percentiles are calculated from the last TRANSCODE_STATISTICS_SAMPLE_COUNT frames
+class TranscodeStageStatistics
+{
+public:
+	TranscodeStageStatistics();
+
+	// latency: time to process an item of the stage (in microseconds)
+	void AddFrame(int64_t latency);
+
+	uint64_t GetFrameCount() const;
+	// Processed frames per second since the first frame
+	double GetFps() const;
+
+	// percentile: 0 ~ 100 (in microseconds, 0 if there is no frame)
+	int64_t GetLatencyPercentile(double percentile) const;
+	int64_t GetMaxLatency() const;
+
+	ov::String ToString() const;
+
+	static int64_t GetCurrentMicroseconds();
+
+private:
+	std::atomic<uint64_t> _frame_count { 0 };
+	std::atomic<int64_t> _first_frame_time { -1 };
+	std::atomic<int64_t> _last_frame_time { -1 };
+	std::atomic<int64_t> _max_latency { 0 };
+
+	mutable std::mutex _sample_mutex;
+	std::vector<int64_t> _latency_samples;
+	size_t _next_sample_index = 0;
+};
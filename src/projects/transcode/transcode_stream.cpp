@@ -8,10 +8,16 @@
 //==============================================================================
 
 #include <unistd.h>
+#include <algorithm>
+#include <chrono>
 
 #include "transcode_stream.h"
 #include "transcode_application.h"
 #include "utilities.h"
+#include "transcode_scheduler.h"
+#include "base/application/stream_demand.h"
+#include "codec/transcode_hardware.h"
+#include "codec/transcode_frame.h"
 
 #include <config/config_manager.h>
 
@@ -89,24 +95,32 @@ TranscodeStream::TranscodeStream(const info::Application *application_info, std:
 
 	_stats_queue_full_count = 0;
 
+	for(auto &stage_scheduled : _stage_scheduled)
+	{
+		stage_scheduled = false;
+	}
+
 	// 부모 클래스
 	_parent = parent;
 
 	// 입력 스트림 정보
 	_stream_info_input = stream_info;
 
-	_stream_list[_application_info->GetId()];
+	// The stages are reported with the latencies of the input stream (see StreamLatency)
+	_latency_statistics = StreamLatency::Instance()->GetStatistics(application_info->GetId(), application_info->GetName(), stream_info->GetName());
+	_memory_statistics = StreamMemory::Instance()->GetStatistics(application_info->GetId(), application_info->GetName(), stream_info->GetName());
+	_overload_statistics = StreamOverload::Instance()->GetStatistics(application_info->GetId(), application_info->GetName(), stream_info->GetName());
+	_quota_statistics = ApplicationQuota::Instance()->GetStatistics(*application_info);
 
-	// Prepare decoders
-	for(auto &track : _stream_info_input->GetTracks())
-	{
-		CreateDecoder(track.second->GetId());
-	}
+	_queue.SetAlias(ov::String::FormatString("%s/packet", stream_info->GetName().CStr()));
+	_queue_decoded.SetAlias(ov::String::FormatString("%s/decoded", stream_info->GetName().CStr()));
+	_queue_filterd.SetAlias(ov::String::FormatString("%s/filtered", stream_info->GetName().CStr()));
 
-	if(_decoders.empty())
-	{
-		return;
-	}
+	_stream_list[_application_info->GetId()];
+
+	_key_frame_sync = _application_info->IsKeyFrameSyncEnabled();
+	_key_frame_interval = std::max(_application_info->GetKeyFrameSyncInterval(), 0);
+	_key_frame_advice = StreamKeyFrameAdvisory::Instance()->GetAdvice(application_info->GetId(), stream_info->GetName());
 
 	// Generate track list by profile(=encode name)
 	auto encodes = _application_info->GetEncodes();
@@ -126,12 +140,31 @@ TranscodeStream::TranscodeStream(const info::Application *application_info, std:
 
 		if((video_profile != nullptr) && (video_profile->IsActive()))
 		{
-			auto context = std::make_shared<TranscodeContext>(
-				GetCodecId(video_profile->GetCodec()),
-				GetBitrate(video_profile->GetBitrate()),
-				video_profile->GetWidth(), video_profile->GetHeight(),
-				video_profile->GetFramerate()
-			);
+			std::shared_ptr<TranscodeContext> context;
+			auto input_track = GetInputTrack(common::MediaType::Video);
+
+			if(IsBypass(*video_profile, input_track))
+			{
+				context = CreateBypassContext(input_track);
+			}
+			else
+			{
+				context = std::make_shared<TranscodeContext>(
+					GetCodecId(video_profile->GetCodec()),
+					GetBitrate(video_profile->GetBitrate()),
+					video_profile->GetWidth(), video_profile->GetHeight(),
+					video_profile->GetFramerate()
+				);
+				context->SetHardwareType(GetHardwareType(*video_profile));
+				context->SetEncoderPreset(GetEncoderPreset(*video_profile));
+				context->SetTemporalLayerCount(GetTemporalLayerCount(*video_profile));
+
+				if(_key_frame_sync)
+				{
+					context->SetGOP(TRANSCODE_KEY_FRAME_SYNC_GOP);
+				}
+			}
+
 			uint8_t track_id = AddContext(common::MediaType::Video, context);
 			if(track_id)
 			{
@@ -141,12 +174,47 @@ TranscodeStream::TranscodeStream(const info::Application *application_info, std:
 
 		if((audio_profile != nullptr) && (audio_profile->IsActive()))
 		{
-			auto context = std::make_shared<TranscodeContext>(
-				GetCodecId(audio_profile->GetCodec()),
-				GetBitrate(audio_profile->GetBitrate()),
-				audio_profile->GetSamplerate()
-			);
-			uint8_t track_id = AddContext(common::MediaType::Audio, context);
+			std::shared_ptr<TranscodeContext> context;
+			auto input_track = GetInputTrack(common::MediaType::Audio);
+
+			if(IsBypass(*audio_profile, input_track))
+			{
+				context = CreateBypassContext(input_track);
+			}
+			else
+			{
+				context = std::make_shared<TranscodeContext>(
+					GetCodecId(audio_profile->GetCodec()),
+					GetBitrate(audio_profile->GetBitrate()),
+					audio_profile->GetSamplerate()
+				);
+
+				if(context->GetCodecId() == common::MediaCodecId::Opus)
+				{
+					// Keeps the planar float of the decoder, so the resampler only changes the sample rate
+					// and the OPUS encoder interleaves/converts the samples into S16 in one pass
+					context->SetAudioSampleFormat(common::AudioSample::Format::FltP);
+					context->SetOpusOptions(GetOpusOptions(*audio_profile));
+				}
+			}
+			// The renditions usually carry the same audio, so they share the encoder (and its resampler)
+			uint8_t track_id = 0;
+
+			for(const auto &context_item : _contexts)
+			{
+				if(IsSameEncoderOutput(context_item.second, context))
+				{
+					track_id = context_item.first;
+					logtd("The audio of %s uses the encoder of track[%d]", profile_name.CStr(), track_id);
+					break;
+				}
+			}
+
+			if(track_id == 0)
+			{
+				track_id = AddContext(common::MediaType::Audio, context);
+			}
+
 			if(track_id)
 			{
 				tracks.push_back(track_id);
@@ -178,6 +246,15 @@ TranscodeStream::TranscodeStream(const info::Application *application_info, std:
 			continue;
 		}
 
+		// The sessions of the output stream are counted for the input stream too
+		StreamDemand::Instance()->SetInputStream(_application_info->GetId(), stream_name, stream_info->GetName());
+
+		if(stream.IsOnDemand())
+		{
+			// The encoders start when the first session is attached to the stream
+			_on_demand_streams[stream_name].idle_timeout = stream.GetOnDemandIdleTimeout();
+		}
+
 		auto profiles = stream.GetProfiles();
 
 		for(const auto &profile : profiles)
@@ -188,8 +265,14 @@ TranscodeStream::TranscodeStream(const info::Application *application_info, std:
 				logtw("Encoder for [%s] does not exist in Server.xml", profile.GetName().CStr());
 				continue;
 			}
-			tracks.push_back(item->second[0]);  // Video
-			tracks.push_back(item->second[1]);  // Audio
+			for(auto track_id : item->second)
+			{
+				// The profiles of the stream may share the audio track
+				if(std::find(tracks.begin(), tracks.end(), track_id) == tracks.end())
+				{
+					tracks.push_back(track_id);
+				}
+			}
 		}
 		_stream_tracks[stream_name] = tracks;
 		tracks.clear();
@@ -220,6 +303,20 @@ TranscodeStream::TranscodeStream(const info::Application *application_info, std:
 		_contexts.erase(track);
 	}
 
+	// Prepare decoders (only for the tracks which are transcoded)
+	for(auto &track : _stream_info_input->GetTracks())
+	{
+		if(IsDecodingNeeded(track.second->GetMediaType()))
+		{
+			CreateDecoder(track.second->GetId());
+		}
+	}
+
+	if(_decoders.empty() && (IsDecodingNeeded(common::MediaType::Video) || IsDecodingNeeded(common::MediaType::Audio)))
+	{
+		return;
+	}
+
 	///////////////////////////////////////////////////////
 	// 트랜스코딩된 스트림을 생성함
 	///////////////////////////////////////////////////////
@@ -232,7 +329,7 @@ TranscodeStream::TranscodeStream(const info::Application *application_info, std:
 		CreateEncoders(cur_track);
 	}
 
-	if(_encoders.empty())
+	if(_encoders.empty() && _bypass_tracks.empty())
 	{
 		return;
 	}
@@ -240,25 +337,13 @@ TranscodeStream::TranscodeStream(const info::Application *application_info, std:
 	// _max_queue_size : 255
 	_max_queue_size = (_encoders.size() > 0x0F) ? 0xFF : _encoders.size() * 256;
 
-	logti("Transcoder Information / Encoders(%d) / Streams(%d)", _encoders.size(), _stream_tracks.size());
-
-	// 패킷 저리 스레드 생성
-	try
-	{
-		_kill_flag = false;
-
-		_thread_decode = std::thread(&TranscodeStream::DecodeTask, this);
-		_thread_filter = std::thread(&TranscodeStream::FilterTask, this);
-		_thread_encode = std::thread(&TranscodeStream::EncodeTask, this);
-	}
-	catch(const std::system_error &e)
-	{
-		_kill_flag = true;
+	logti("Transcoder Information / Encoders(%d) / Bypass(%d) / Streams(%d)", _encoders.size(), _bypass_tracks.size(), _stream_tracks.size());
 
-		logte("Failed to start transcode stream thread.");
-	}
+	// The packets are processed by the workers of TranscodeScheduler after the output streams are created
+	CreateStreams();
+	_is_started = true;
 
-	logtd("Started transcode stream thread.");
+	logtd("Started transcode stream.");
 }
 
 TranscodeStream::~TranscodeStream()
@@ -276,25 +361,31 @@ void TranscodeStream::Stop()
 {
 	_kill_flag = true;
 
-	logtd("wait for terminated trancode stream thread. kill_flag(%s)", _kill_flag ? "true" : "false");
-
-	_queue.abort();
+	logtd("wait for terminated trancode stream tasks. kill_flag(%s)", _kill_flag ? "true" : "false");
 
-	if(_thread_decode.joinable())
 	{
-		_thread_decode.join();
-	}
-	_queue_decoded.abort();
+		// The running tasks stop after the current item, and no more tasks are posted
+		std::unique_lock<std::mutex> lock(_stage_task_mutex);
 
-	if(_thread_filter.joinable())
-	{
-		_thread_filter.join();
+		_stage_task_condition.wait(lock, [this]() -> bool {
+			return (_stage_task_count == 0);
+		});
 	}
+
+	_queue.abort();
+	_queue_decoded.abort();
 	_queue_filterd.abort();
 
-	if(_thread_encode.joinable())
+	// The items which are left in the queues are not counted any more
+	StreamMemory::Instance()->RemoveStatistics(_application_info->GetId(), _stream_info_input->GetName());
+	StreamOverload::Instance()->RemoveStatistics(_application_info->GetId(), _stream_info_input->GetName());
+	StreamKeyFrameAdvisory::Instance()->RemoveAdvice(_application_info->GetId(), _stream_info_input->GetName());
+
+	if(_is_started)
 	{
-		_thread_encode.join();
+		// 스트림 삭제 전송
+		DeleteStreams();
+		_is_started = false;
 	}
 }
 
@@ -303,18 +394,42 @@ bool TranscodeStream::Push(std::unique_ptr<MediaPacket> packet)
 	// logtd("Stage-1-1 : %f", (float)frame->GetPts());
 	// 변경된 스트림을 큐에 넣음
 
-	if(_encoders.empty())
+	if(_is_started == false)
 	{
 		return false;
 	}
 
-	if(_queue.size() > _max_queue_size)
+	bool is_bypassed = false;
+
+	if(_bypass_tracks.find(packet->GetTrackId()) != _bypass_tracks.end())
+	{
+		SendBypassPacket(packet.get());
+		is_bypassed = true;
+	}
+
+	// Decodes the packet only if some output tracks need the frames
+	if(_encoders.empty() || (_decoders.find(packet->GetTrackId()) == _decoders.end()))
+	{
+		return is_bypassed;
+	}
+
+	if(_queue.size() > GetMaxQueueSize())
 	{
 		logti("Queue(stream) is full, please check your system");
 		return false;
 	}
 
-	_queue.push(std::move(packet));
+	auto memory_usage = static_cast<int64_t>(packet->GetData()->GetCapacity());
+
+	// The decode stage measures the waiting time (the stages behind it are waited for by the backpressure)
+	packet->SetQueuedTime(ov::LatencyHistogram::GetCurrentMicroseconds());
+
+	if(_queue.push(std::move(packet)))
+	{
+		_memory_statistics->Add(StreamMemoryComponent::TranscoderPacketQueue, memory_usage);
+	}
+
+	ScheduleStage(Stage::Decode);
 
 	return true;
 }
@@ -335,14 +450,272 @@ void TranscodeStream::CreateDecoder(int32_t media_track_id)
 		return;
 	}
 
+	std::shared_ptr<TranscodeContext> decoder_context = nullptr;
+
+	if(track->GetMediaType() == common::MediaType::Video)
+	{
+		// The frames can stay in the memory of the device only if all video profiles use the same device
+		auto hardware_type = GetDecoderHardwareType();
+
+		if(hardware_type != TranscodeHardwareType::None)
+		{
+			decoder_context = std::make_shared<TranscodeContext>();
+			decoder_context->SetCodecId(track->GetCodecId());
+			decoder_context->SetHardwareType(hardware_type);
+		}
+	}
+
 	// create decoder for codec id
-	auto decoder = std::move(TranscodeDecoder::CreateDecoder(track->GetCodecId()));
+	auto decoder = std::move(TranscodeDecoder::CreateDecoder(track->GetCodecId(), decoder_context));
 	if(decoder != nullptr)
 	{
 		_decoders[media_track_id] = std::move(decoder);
 	}
 }
 
+std::shared_ptr<MediaTrack> TranscodeStream::GetInputTrack(common::MediaType media_type)
+{
+	for(auto &track : _stream_info_input->GetTracks())
+	{
+		if(track.second->GetMediaType() == media_type)
+		{
+			return track.second;
+		}
+	}
+
+	return nullptr;
+}
+
+bool TranscodeStream::IsBypass(const cfg::VideoProfile &video_profile, const std::shared_ptr<MediaTrack> &input_track)
+{
+	if(input_track == nullptr)
+	{
+		return false;
+	}
+
+	if(video_profile.GetBypass())
+	{
+		return true;
+	}
+
+	// Re-encoding with the same codec and resolution only degrades the quality
+	return (GetCodecId(video_profile.GetCodec()) == input_track->GetCodecId()) &&
+	       (video_profile.GetWidth() == input_track->GetWidth()) &&
+	       (video_profile.GetHeight() == input_track->GetHeight());
+}
+
+bool TranscodeStream::IsBypass(const cfg::AudioProfile &audio_profile, const std::shared_ptr<MediaTrack> &input_track)
+{
+	if(input_track == nullptr)
+	{
+		return false;
+	}
+
+	if(audio_profile.IsBypass())
+	{
+		return true;
+	}
+
+	return (GetCodecId(audio_profile.GetCodec()) == input_track->GetCodecId()) &&
+	       (audio_profile.GetSamplerate() == input_track->GetSampleRate());
+}
+
+std::shared_ptr<TranscodeContext> TranscodeStream::CreateBypassContext(const std::shared_ptr<MediaTrack> &input_track)
+{
+	std::shared_ptr<TranscodeContext> context;
+
+	if(input_track->GetMediaType() == common::MediaType::Video)
+	{
+		context = std::make_shared<TranscodeContext>(
+			input_track->GetCodecId(),
+			input_track->GetBitrate(),
+			input_track->GetWidth(), input_track->GetHeight(),
+			static_cast<float>(input_track->GetFrameRate())
+		);
+	}
+	else
+	{
+		context = std::make_shared<TranscodeContext>(
+			input_track->GetCodecId(),
+			input_track->GetBitrate(),
+			input_track->GetSampleRate()
+		);
+		context->SetAudioSampleFormat(input_track->GetSample().GetFormat());
+		context->GetAudioChannel().SetLayout(input_track->GetChannel().GetLayout());
+	}
+
+	// The packets keep the timestamps of the input track
+	context->SetTimeBase(input_track->GetTimeBase().GetNum(), input_track->GetTimeBase().GetDen());
+	context->SetBypass(true);
+
+	logti("%s track[%u] is bypassed", (input_track->GetMediaType() == common::MediaType::Video) ? "Video" : "Audio", input_track->GetId());
+
+	return context;
+}
+
+bool TranscodeStream::IsDecodingNeeded(common::MediaType media_type) const
+{
+	for(const auto &context_item : _contexts)
+	{
+		if((context_item.second->GetMediaType() == media_type) && (context_item.second->IsBypass() == false))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void TranscodeStream::SendBypassPacket(MediaPacket *packet)
+{
+	auto bypass_item = _bypass_tracks.find(packet->GetTrackId());
+	if(bypass_item == _bypass_tracks.end())
+	{
+		return;
+	}
+
+	auto input_track = _stream_info_input->GetTrack(packet->GetTrackId());
+
+	for(auto output_track_id : bypass_item->second)
+	{
+		auto bypass_packet = packet->ClonePacket();
+		bypass_packet->SetTrackId(output_track_id);
+
+		if((input_track != nullptr) && (input_track->GetCodecId() == common::MediaCodecId::H264) &&
+		   (bypass_packet->_frag_hdr->fragmentation_vector_size == 0))
+		{
+			// The WebRTC packetizer needs the NAL units, which are made by the encoder for the transcoded tracks
+			TranscodeEncoder::MakeFragmentationHeader(bypass_packet->GetData()->GetDataAs<uint8_t>(), bypass_packet->GetData()->GetLength(), bypass_packet->_frag_hdr.get());
+		}
+
+		SendFrame(std::move(bypass_packet));
+	}
+}
+
+TranscodeHardwareType TranscodeStream::GetHardwareType(const cfg::VideoProfile &video_profile)
+{
+	auto hardware_type = TranscodeHardware::ParseType(video_profile.GetHWAcceleration());
+
+	if((hardware_type != TranscodeHardwareType::None) &&
+	   (TranscodeHardware::GetEncoderName(hardware_type, GetCodecId(video_profile.GetCodec())) == nullptr))
+	{
+		logtw("%s hardware encoder does not support %s, software encoder will be used",
+		      TranscodeHardware::GetTypeString(hardware_type), video_profile.GetCodec().CStr());
+
+		return TranscodeHardwareType::None;
+	}
+
+	return hardware_type;
+}
+
+uint8_t TranscodeStream::GetTemporalLayerCount(const cfg::VideoProfile &video_profile)
+{
+	int temporal_layers = video_profile.GetTemporalLayers();
+
+	if(temporal_layers <= 1)
+	{
+		return 1;
+	}
+
+	int max_temporal_layers = TranscodeEncoder::GetMaxTemporalLayerCount(GetCodecId(video_profile.GetCodec()));
+
+	if(temporal_layers > max_temporal_layers)
+	{
+		logtw("%s encoder supports up to %d temporal layers (TemporalLayers: %d)", video_profile.GetCodec().CStr(), max_temporal_layers, temporal_layers);
+		temporal_layers = max_temporal_layers;
+	}
+
+	return static_cast<uint8_t>(temporal_layers);
+}
+
+TranscodeOpusOptions TranscodeStream::GetOpusOptions(const cfg::AudioProfile &audio_profile)
+{
+	const auto &opus_profile = audio_profile.GetOpus();
+	TranscodeOpusOptions options;
+
+	int frame_duration = static_cast<int>(opus_profile.GetFrameDuration() * 1000.0f + 0.5f);
+
+	if(TranscodeOpusOptions::IsValidFrameDuration(frame_duration))
+	{
+		options.frame_duration = frame_duration;
+	}
+	else
+	{
+		logtw("Invalid OPUS frame duration: %.1f ms (2.5, 5, 10, 20, 40, 60 are supported), %.1f ms will be used",
+		      opus_profile.GetFrameDuration(), options.frame_duration / 1000.0f);
+	}
+
+	if(opus_profile.GetComplexity() > 10)
+	{
+		logtw("Invalid OPUS complexity: %d (0~10)", opus_profile.GetComplexity());
+	}
+	else
+	{
+		options.complexity = opus_profile.GetComplexity();
+	}
+
+	options.dtx = opus_profile.IsDtx();
+	options.fec = opus_profile.IsFec();
+	options.expected_loss = std::min(std::max(opus_profile.GetExpectedLoss(), 0), 100);
+
+	return options;
+}
+
+TranscodeEncoderPreset TranscodeStream::GetEncoderPreset(const cfg::VideoProfile &video_profile)
+{
+	TranscodeEncoderPreset preset;
+
+	if(TranscodeEncoderPreset::Find(video_profile.GetPreset(), &preset) == false)
+	{
+		logtw("Unknown encoder preset: %s, default preset will be used", video_profile.GetPreset().CStr());
+	}
+
+	if(video_profile.GetThreadCount() >= 0)
+	{
+		preset.thread_count = video_profile.GetThreadCount();
+	}
+
+	if((video_profile.GetRateControl().IsEmpty() == false) &&
+	   (TranscodeEncoderPreset::ParseRateControl(video_profile.GetRateControl(), &preset.rate_control) == false))
+	{
+		logtw("Unknown rate control: %s, the rate control of the preset will be used", video_profile.GetRateControl().CStr());
+	}
+
+	return preset;
+}
+
+TranscodeHardwareType TranscodeStream::GetDecoderHardwareType()
+{
+	TranscodeHardwareType decoder_hardware_type = TranscodeHardwareType::None;
+	bool is_first = true;
+
+	for(const auto &context_item : _contexts)
+	{
+		auto &context = context_item.second;
+
+		// The bypassed tracks do not use the decoded frames
+		if((context->GetMediaType() != common::MediaType::Video) || context->IsBypass())
+		{
+			continue;
+		}
+
+		auto hardware_type = context->GetHardwareType();
+
+		if(is_first)
+		{
+			decoder_hardware_type = hardware_type;
+			is_first = false;
+		}
+		else if(decoder_hardware_type != hardware_type)
+		{
+			// The frames are decoded to the system memory, and uploaded to the device by the filter if needed
+			return TranscodeHardwareType::None;
+		}
+	}
+
+	return decoder_hardware_type;
+}
+
 void TranscodeStream::CreateEncoder(std::shared_ptr<MediaTrack> media_track, std::shared_ptr<TranscodeContext> transcode_context)
 {
 	if(media_track == nullptr)
@@ -416,23 +789,53 @@ TranscodeResult TranscodeStream::DecodePacket(int32_t track_id, std::unique_ptr<
 
 			case TranscodeResult::DataReady:
 				decoded_frame->SetTrackId(track_id);
+				// The decoder may output the frame of the previous packet, but the flow of the last input is close enough
+				decoded_frame->SetTraceId(ov::Tracer::GetCurrentFlowId());
 
 				logtp("[#%d] A packet is decoded (PTS: %lld)", track_id, decoded_frame->GetPts());
 
+				if(_key_frame_sync && (_key_frame_interval == 0) && (track_id == (int32_t)common::MediaType::Video))
+				{
+					auto native_frame = TranscodeFrame::GetAVFrame(decoded_frame.get());
+
+					if((native_frame != nullptr) && native_frame->key_frame)
+					{
+						AddSourceKeyFrame(decoded_frame->GetPts());
+					}
+				}
+
 				_stats_decoded_frame_count++;
 
 				if(_stats_decoded_frame_count % 300 == 0)
 				{
 					logtd("Decode stats: queue(%d), decoded_queue(%d), filtered_queue(%d)", _queue.size(), _queue_decoded.size(), _queue_filterd.size());
+
+					for(int stage = 0; stage < static_cast<int>(Stage::NumberOfStages); stage++)
+					{
+						logtd("%s stats: %s", GetStageName(static_cast<Stage>(stage)), _stage_statistics[stage].ToString().CStr());
+					}
+
+					for(const auto &statistics_item : GetEncoderStatistics())
+					{
+						logtd("[#%d] Encoder latency (%s): %s", statistics_item.first,
+						      _contexts[statistics_item.first]->GetEncoderPreset().name.CStr(), statistics_item.second->ToString().CStr());
+					}
 				}
 
-				if(_queue_decoded.size() > _max_queue_size)
+				if(_queue_decoded.size() > GetMaxQueueSize())
 				{
 					logti("Decoded frame queue is full, please check your system");
 					return result;
 				}
 
-				_queue_decoded.push(std::move(decoded_frame));
+				{
+					auto memory_usage = static_cast<int64_t>(decoded_frame->GetMemoryUsage());
+
+					if(_queue_decoded.push(std::move(decoded_frame)))
+					{
+						_memory_statistics->Add(StreamMemoryComponent::TranscoderDecodedQueue, memory_usage);
+					}
+				}
 
 				break;
 
@@ -444,16 +847,19 @@ TranscodeResult TranscodeStream::DecodePacket(int32_t track_id, std::unique_ptr<
 	}
 }
 
-TranscodeResult TranscodeStream::FilterFrame(int32_t track_id, std::unique_ptr<MediaFrame> frame)
+TranscodeResult TranscodeStream::FilterFrame(int32_t rung_id, std::unique_ptr<MediaFrame> frame)
 {
-	auto filter_item = _filters.find(track_id);
-	if(filter_item == _filters.end())
+	auto rung_item = _filter_rungs.find(rung_id);
+	if(rung_item == _filter_rungs.end())
 	{
 		return TranscodeResult::NoData;
 	}
-	auto filter = filter_item->second.get();
+	auto &rung = rung_item->second;
+	auto filter = rung.filter.get();
+	// The frames to filter have the media type as the track id
+	auto input_track_id = frame->GetTrackId();
 
-	logtp("[#%d] Trying to apply a filter to the frame (PTS: %lld)", track_id, frame->GetPts());
+	logtp("[#%d] Trying to apply a filter to the frame (PTS: %lld)", rung_id, frame->GetPts());
 	filter->SendBuffer(std::move(frame));
 
 	while(true)
@@ -465,11 +871,27 @@ TranscodeResult TranscodeStream::FilterFrame(int32_t track_id, std::unique_ptr<M
 		switch(result)
 		{
 			case TranscodeResult::DataReady:
-				filtered_frame->SetTrackId(track_id);
+				filtered_frame->SetTrackId(input_track_id);
+
+				logtp("[#%d] A frame is filtered (PTS: %lld)", rung_id, filtered_frame->GetPts());
+
+				// Smaller rungs scale the filtered frame instead of the decoded frame
+				for(auto child_rung_id : rung.child_rung_ids)
+				{
+					if(IsRungActive(child_rung_id) == false)
+					{
+						continue;
+					}
+
+					auto frame_clone = filtered_frame->CloneFrame();
 
-				logtp("[#%d] A frame is filtered (PTS: %lld)", track_id, filtered_frame->GetPts());
+					if(frame_clone != nullptr)
+					{
+						FilterFrame(child_rung_id, std::move(frame_clone));
+					}
+				}
 
-				if(_queue_filterd.size() > _max_queue_size)
+				if(_queue_filterd.size() > GetMaxQueueSize())
 				{
 					_stats_queue_full_count++;
 
@@ -478,10 +900,41 @@ TranscodeResult TranscodeStream::FilterFrame(int32_t track_id, std::unique_ptr<M
 						logti("Filtered frame queue is full, please decrease encoding options (resolution, bitrate, framerate)");
 					}
 
-					return result;
+					break;
 				}
 
-				_queue_filterd.push(std::move(filtered_frame));
+				{
+					std::vector<MediaTrackId> active_track_ids;
+
+					for(auto output_track_id : rung.track_ids)
+					{
+						if(IsTrackActive(output_track_id))
+						{
+							active_track_ids.push_back(output_track_id);
+						}
+					}
+
+					// The encoders of the same output share the picture (only the reference is cloned)
+					for(size_t index = 0; index < active_track_ids.size(); index++)
+					{
+						auto output_frame = (index == (active_track_ids.size() - 1)) ? std::move(filtered_frame) : filtered_frame->CloneFrame();
+
+						if(output_frame == nullptr)
+						{
+							continue;
+						}
+
+						output_frame->SetTrackId(active_track_ids[index]);
+						output_frame->SetTraceId(ov::Tracer::GetCurrentFlowId());
+
+						auto memory_usage = static_cast<int64_t>(output_frame->GetMemoryUsage());
+
+						if(_queue_filterd.push(std::move(output_frame)))
+						{
+							_memory_statistics->Add(StreamMemoryComponent::TranscoderFilteredQueue, memory_usage);
+						}
+					}
+				}
 
 				break;
 
@@ -500,6 +953,37 @@ TranscodeResult TranscodeStream::EncodeFrame(int32_t track_id, std::unique_ptr<c
 	}
 	auto encoder = encoder_item->second.get();
 
+	if(_contexts[track_id]->GetMediaType() == common::MediaType::Video)
+	{
+		bool fast_mode = (_overload_statistics->GetLevel() >= StreamOverloadLevel::FastEncoding);
+
+		if(fast_mode != (_fast_track_ids.find(track_id) != _fast_track_ids.end()))
+		{
+			if(encoder->SetFastMode(fast_mode))
+			{
+				logti("[#%d] The fast mode of the encoder is %s", track_id, fast_mode ? "enabled" : "disabled");
+			}
+
+			// Not retried for each frame if the encoder doesn't support it
+			if(fast_mode)
+			{
+				_fast_track_ids.insert(track_id);
+			}
+			else
+			{
+				_fast_track_ids.erase(track_id);
+			}
+		}
+
+		auto key_frame_interval = GetKeyFrameInterval();
+
+		if((key_frame_interval >= 0) && IsSyncPoint(track_id, frame->GetPts(), key_frame_interval))
+		{
+			// All renditions have the key frame at this point, so the segments can be cut at the same timestamp
+			encoder->RequestKeyFrame();
+		}
+	}
+
 	logtp("[#%d] Trying to encode the frame (PTS: %lld)", track_id, frame->GetPts());
 	encoder->SendBuffer(std::move(frame));
 
@@ -515,7 +999,13 @@ TranscodeResult TranscodeStream::EncodeFrame(int32_t track_id, std::unique_ptr<c
 
 		if(result == TranscodeResult::DataReady)
 		{
+			if(encoded_packet->GetMediaType() == common::MediaType::Video)
+			{
+				encoder->UpdateLatency(encoded_packet->GetPts());
+			}
+
 			encoded_packet->SetTrackId(track_id);
+			encoded_packet->SetTraceId(ov::Tracer::GetCurrentFlowId());
 
 			logtp("[#%d] A packet is encoded (PTS: %lld)", track_id, encoded_packet->GetPts());
 
@@ -525,77 +1015,455 @@ TranscodeResult TranscodeStream::EncodeFrame(int32_t track_id, std::unique_ptr<c
 	}
 }
 
-// 디코딩 & 인코딩 스레드
-void TranscodeStream::DecodeTask()
+bool TranscodeStream::RequestKeyFrame(uint32_t output_stream_id, MediaTrackId track_id, MediaTrackId &bypass_track_id)
 {
-	CreateStreams();
+	bypass_track_id = -1;
+
+	// The outputs, the encoders and the bypassed tracks are not changed after the stream is started
+	auto output_item = std::find_if(_stream_info_outputs.begin(), _stream_info_outputs.end(), [output_stream_id](const std::pair<const ov::String, std::shared_ptr<StreamInfo>> &item) -> bool {
+		return item.second->GetId() == output_stream_id;
+	});
+
+	if(output_item == _stream_info_outputs.end())
+	{
+		return false;
+	}
+
+	auto encoder_item = _encoders.find(track_id);
+
+	if(encoder_item != _encoders.end())
+	{
+		encoder_item->second->RequestKeyFrame();
+		logtd("Key frame is requested for track[%d] of %s", track_id, output_item->first.CStr());
 
-	logtd("Started transcode stream decode thread");
+		return true;
+	}
 
-	while(!_kill_flag)
+	for(const auto &bypass_item : _bypass_tracks)
 	{
-		// 큐에 있는 인코딩된 패킷을 읽어옴
-		auto packet = _queue.pop_unique();
-		if(packet == nullptr)
+		if(std::find(bypass_item.second.begin(), bypass_item.second.end(), track_id) != bypass_item.second.end())
 		{
-			// logtw("invliad media buffer");
-			continue;
+			bypass_track_id = bypass_item.first;
+			break;
 		}
+	}
+
+	return true;
+}
+
+void TranscodeStream::AddSourceKeyFrame(int64_t pts)
+{
+	std::lock_guard<std::mutex> lock(_source_key_frame_mutex);
 
-		// 패킷의 트랙 아이디를 조회
-		int32_t track_id = packet->GetTrackId();
+	_source_key_frame_pts.push_back(pts);
+
+	while(_source_key_frame_pts.size() > TRANSCODE_SOURCE_KEY_FRAME_COUNT)
+	{
+		_source_key_frame_pts.pop_front();
+	}
+}
+
+int64_t TranscodeStream::GetKeyFrameInterval()
+{
+	if(_key_frame_interval > 0)
+	{
+		return _key_frame_interval;
+	}
 
-		DecodePacket(track_id, std::move(packet));
+	if(_key_frame_sync)
+	{
+		// The key frames of the input
+		return 0;
 	}
 
-	// 스트림 삭제 전송
-	DeleteStreams();
+	auto advised_key_frame_interval = _key_frame_advice->GetInterval();
+
+	if(advised_key_frame_interval != _advised_key_frame_interval)
+	{
+		logti("[%s/%s] The key frames are forced every %lld ms by the advice of the publishers (0: disabled)",
+			  _application_info->GetName().CStr(), _stream_info_input->GetName().CStr(), static_cast<long long>(advised_key_frame_interval));
+
+		_advised_key_frame_interval = advised_key_frame_interval;
+	}
 
-	logtd("Terminated transcode stream decode thread");
+	return (advised_key_frame_interval > 0) ? advised_key_frame_interval : -1;
 }
 
-void TranscodeStream::FilterTask()
+bool TranscodeStream::IsSyncPoint(MediaTrackId track_id, int64_t pts, int64_t key_frame_interval)
 {
-	logtd("Transcode filter thread is started");
+	if(pts < 0)
+	{
+		return false;
+	}
+
+	// The filtered frames have the time base of the output track
+	auto &time_base = _contexts[track_id]->GetTimeBase();
+	int64_t pts_ms = pts * time_base.GetNum() * 1000 / time_base.GetDen();
 
-	while(!_kill_flag)
+	int64_t sync_point = -1;
+
+	if(key_frame_interval > 0)
 	{
-		// 큐에 있는 인코딩된 패킷을 읽어옴
-		auto frame = _queue_decoded.pop_unique();
-		if(frame == nullptr)
+		sync_point = pts_ms - (pts_ms % key_frame_interval);
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(_source_key_frame_mutex);
+
+		// The latest key frame of the input which is not later than the frame
+		for(auto key_frame_pts : _source_key_frame_pts)
 		{
-			// logtw("invliad media buffer");
-			continue;
+			if(key_frame_pts <= pts_ms)
+			{
+				sync_point = key_frame_pts;
+			}
 		}
+	}
 
-		DoFilters(std::move(frame));
+	if(sync_point < 0)
+	{
+		return false;
 	}
 
-	logtd("Transcode filter thread is terminated");
+	auto last_sync_point = _last_sync_points.find(track_id);
+
+	if((last_sync_point != _last_sync_points.end()) && (last_sync_point->second >= sync_point))
+	{
+		return false;
+	}
+
+	_last_sync_points[track_id] = sync_point;
+
+	return true;
 }
 
-void TranscodeStream::EncodeTask()
+void TranscodeStream::ScheduleStage(Stage stage)
 {
-	logtd("Started transcode stream encode thread");
+	bool expected = false;
+
+	if(_stage_scheduled[static_cast<int>(stage)].compare_exchange_strong(expected, true) == false)
+	{
+		// The stage is already posted, and it checks the input again before finishing
+		return;
+	}
 
-	while(!_kill_flag)
 	{
-		// 큐에 있는 인코딩된 패킷을 읽어옴
-		auto frame = _queue_filterd.pop_unique();
-		if(frame == nullptr)
+		std::lock_guard<std::mutex> lock(_stage_task_mutex);
+
+		if(_kill_flag)
 		{
-			// logtw("invliad media buffer");
-			continue;
+			_stage_scheduled[static_cast<int>(stage)] = false;
+			return;
 		}
 
-		// 패킷의 트랙 아이디를 조회
-		int32_t track_id = frame->GetTrackId();
+		_stage_task_count++;
+	}
+
+	bool posted = TranscodeScheduler::Instance()->Post([this, stage]() {
+		RunStage(stage);
+		FinishStageTask();
+	}, _quota_statistics);
 
-		// logtd("Stage-1-2 : %f", (float)frame->GetPts());
-		EncodeFrame(track_id, std::move(frame));
+	if(posted == false)
+	{
+		_stage_scheduled[static_cast<int>(stage)] = false;
+		FinishStageTask();
 	}
+}
 
-	logtd("Terminated transcode stream encode thread");
+void TranscodeStream::FinishStageTask()
+{
+	// Notify while holding the lock, because the stream can be destroyed as soon as Stop() returns
+	std::lock_guard<std::mutex> lock(_stage_task_mutex);
+
+	_stage_task_count--;
+
+	if(_stage_task_count == 0)
+	{
+		_stage_task_condition.notify_all();
+	}
+}
+
+bool TranscodeStream::HasStageInput(Stage stage) const
+{
+	switch(stage)
+	{
+		case Stage::Decode:
+			return (_queue.size() > 0);
+		case Stage::Filter:
+			return (_queue_decoded.size() > 0);
+		case Stage::Encode:
+			return (_queue_filterd.size() > 0);
+		default:
+			return false;
+	}
+}
+
+uint64_t TranscodeStream::GetMaxQueueSize() const
+{
+	// The queues are shortened under the memory pressure (the frames are dropped earlier)
+	if(ov::MemoryGovernor::Instance()->IsLevel(ov::MemoryGovernorLevel::CapQueues))
+	{
+		return std::min<uint64_t>(_max_queue_size, OV_MEMORY_GOVERNOR_CAPPED_QUEUE_SIZE);
+	}
+
+	return _max_queue_size;
+}
+
+bool TranscodeStream::CanRunStage(Stage stage) const
+{
+	switch(stage)
+	{
+		case Stage::Decode:
+			// Wait until the filters consume the decoded frames
+			return (_queue_decoded.size() < GetMaxQueueSize());
+		case Stage::Filter:
+			// Wait until the encoders consume the filtered frames
+			return (_queue_filterd.size() < GetMaxQueueSize());
+		case Stage::Encode:
+			return true;
+		default:
+			return false;
+	}
+}
+
+const char *TranscodeStream::GetStageName(Stage stage)
+{
+	switch(stage)
+	{
+		case Stage::Decode:
+			return "Decode";
+
+		case Stage::Filter:
+			return "Filter";
+
+		case Stage::Encode:
+			return "Encode";
+
+		default:
+			return "Unknown";
+	}
+}
+
+const TranscodeStageStatistics &TranscodeStream::GetStageStatistics(Stage stage) const
+{
+	return _stage_statistics[static_cast<int>(stage)];
+}
+
+std::map<MediaTrackId, const TranscodeStageStatistics *> TranscodeStream::GetEncoderStatistics() const
+{
+	std::map<MediaTrackId, const TranscodeStageStatistics *> statistics;
+
+	for(const auto &encoder_item : _encoders)
+	{
+		auto context_item = _contexts.find(encoder_item.first);
+
+		if((context_item != _contexts.end()) && (context_item->second->GetMediaType() == common::MediaType::Video))
+		{
+			statistics[encoder_item.first] = &(encoder_item.second->GetLatencyStatistics());
+		}
+	}
+
+	return statistics;
+}
+
+size_t TranscodeStream::GetStageQueueSize(Stage stage) const
+{
+	switch(stage)
+	{
+		case Stage::Decode:
+			return _queue.size();
+
+		case Stage::Filter:
+			return _queue_decoded.size();
+
+		case Stage::Encode:
+			return _queue_filterd.size();
+
+		default:
+			return 0;
+	}
+}
+
+bool TranscodeStream::ProcessStage(Stage stage)
+{
+	ov::MemoryTagScope memory_tag(ov::MemoryTag::Transcoder);
+
+	switch(stage)
+	{
+		case Stage::Decode:
+		{
+			// 큐에 있는 인코딩된 패킷을 읽어옴
+			std::unique_ptr<MediaPacket> packet;
+			if(_queue.try_pop(packet) == false)
+			{
+				return false;
+			}
+
+			if(packet != nullptr)
+			{
+				_memory_statistics->Add(StreamMemoryComponent::TranscoderPacketQueue, -static_cast<int64_t>(packet->GetData()->GetCapacity()));
+
+				OV_TRACE_FLOW(packet->GetTraceId());
+				OV_TRACE_SCOPE("transcoder", "Decode");
+
+				UpdateOverload((ov::LatencyHistogram::GetCurrentMicroseconds() - packet->GetQueuedTime()) / 1000);
+
+				// 패킷의 트랙 아이디를 조회
+				int32_t track_id = packet->GetTrackId();
+				int64_t start_time = TranscodeStageStatistics::GetCurrentMicroseconds();
+
+				DecodePacket(track_id, std::move(packet));
+
+				RecordStageLatency(stage, TranscodeStageStatistics::GetCurrentMicroseconds() - start_time);
+			}
+
+			return true;
+		}
+
+		case Stage::Filter:
+		{
+			std::unique_ptr<MediaFrame> frame;
+			if(_queue_decoded.try_pop(frame) == false)
+			{
+				return false;
+			}
+
+			if(frame != nullptr)
+			{
+				_memory_statistics->Add(StreamMemoryComponent::TranscoderDecodedQueue, -static_cast<int64_t>(frame->GetMemoryUsage()));
+
+				OV_TRACE_FLOW(frame->GetTraceId());
+				OV_TRACE_SCOPE("transcoder", "Filter");
+
+				int64_t start_time = TranscodeStageStatistics::GetCurrentMicroseconds();
+
+				DoFilters(std::move(frame));
+
+				RecordStageLatency(stage, TranscodeStageStatistics::GetCurrentMicroseconds() - start_time);
+			}
+
+			return true;
+		}
+
+		case Stage::Encode:
+		{
+			std::unique_ptr<MediaFrame> frame;
+			if(_queue_filterd.try_pop(frame) == false)
+			{
+				return false;
+			}
+
+			if(frame != nullptr)
+			{
+				_memory_statistics->Add(StreamMemoryComponent::TranscoderFilteredQueue, -static_cast<int64_t>(frame->GetMemoryUsage()));
+
+				OV_TRACE_FLOW(frame->GetTraceId());
+				OV_TRACE_SCOPE("transcoder", "Encode");
+
+				// 패킷의 트랙 아이디를 조회
+				int32_t track_id = frame->GetTrackId();
+				int64_t start_time = TranscodeStageStatistics::GetCurrentMicroseconds();
+
+				EncodeFrame(track_id, std::move(frame));
+
+				RecordStageLatency(stage, TranscodeStageStatistics::GetCurrentMicroseconds() - start_time);
+			}
+
+			return true;
+		}
+
+		default:
+			return false;
+	}
+}
+
+void TranscodeStream::RecordStageLatency(Stage stage, int64_t latency)
+{
+	_stage_statistics[static_cast<int>(stage)].AddFrame(latency);
+
+	switch(stage)
+	{
+		case Stage::Decode:
+			_latency_statistics->Record(StreamLatencyStage::Decode, latency);
+			break;
+		case Stage::Filter:
+			_latency_statistics->Record(StreamLatencyStage::Filter, latency);
+			break;
+		case Stage::Encode:
+			_latency_statistics->Record(StreamLatencyStage::Encode, latency);
+			break;
+		default:
+			break;
+	}
+}
+
+void TranscodeStream::RunStage(Stage stage)
+{
+	int processed_count = 0;
+
+	// Yield the worker to other streams after a batch
+	while((processed_count < TRANSCODE_STAGE_BATCH_COUNT) && (_kill_flag == false) && CanRunStage(stage))
+	{
+		if(ProcessStage(stage) == false)
+		{
+			break;
+		}
+
+		processed_count++;
+	}
+
+	_stage_scheduled[static_cast<int>(stage)] = false;
+
+	if(_kill_flag)
+	{
+		return;
+	}
+
+	// An item may have been pushed after the last check, or the batch is finished
+	if(HasStageInput(stage) && CanRunStage(stage))
+	{
+		ScheduleStage(stage);
+	}
+
+	if(processed_count == 0)
+	{
+		return;
+	}
+
+	switch(stage)
+	{
+		case Stage::Decode:
+			if(HasStageInput(Stage::Filter))
+			{
+				ScheduleStage(Stage::Filter);
+			}
+			break;
+
+		case Stage::Filter:
+			if(HasStageInput(Stage::Encode))
+			{
+				ScheduleStage(Stage::Encode);
+			}
+
+			// The decoder may be waiting for the decoded queue to be consumed
+			if(HasStageInput(Stage::Decode))
+			{
+				ScheduleStage(Stage::Decode);
+			}
+			break;
+
+		case Stage::Encode:
+			// The filters may be waiting for the filtered queue to be consumed
+			if(HasStageInput(Stage::Filter))
+			{
+				ScheduleStage(Stage::Filter);
+			}
+			break;
+
+		default:
+			break;
+	}
 }
 
 bool TranscodeStream::AddStreamInfoOutput(ov::String stream_name)
@@ -617,6 +1485,8 @@ bool TranscodeStream::AddStreamInfoOutput(ov::String stream_name)
 
 	auto stream_info_output = std::make_shared<StreamInfo>();
 	stream_info_output->SetName(stream_name);
+	// The outputs of the input are grouped to the master playlist of HLS/DASH
+	stream_info_output->SetOriginStreamName(_stream_info_input->GetName());
 
 	_stream_info_outputs.insert(
 		std::make_pair(stream_name, stream_info_output)
@@ -637,6 +1507,7 @@ void TranscodeStream::DeleteStreams()
 	for(auto &iter : _stream_info_outputs)
 	{
 		_parent->DeleteStream(iter.second);
+		StreamDemand::Instance()->RemoveInputStream(_application_info->GetId(), iter.first);
 	}
 
 	_stream_info_outputs.clear();
@@ -675,30 +1546,42 @@ void TranscodeStream::CreateEncoders(std::shared_ptr<MediaTrack> media_track)
 			continue;
 		}
 
-		auto new_track = std::make_shared<MediaTrack>();
-		new_track->SetId((uint32_t)iter.first);
-		new_track->SetMediaType(media_track->GetMediaType());
-		new_track->SetCodecId(iter.second->GetCodecId());
-		new_track->SetTimeBase(iter.second->GetTimeBase().GetNum(), iter.second->GetTimeBase().GetDen());
-		new_track->SetBitrate(iter.second->GetBitrate());
+		std::shared_ptr<MediaTrack> new_track;
 
-		if(media_track->GetMediaType() == common::MediaType::Video)
+		if(iter.second->IsBypass())
 		{
-			new_track->SetWidth(iter.second->GetVideoWidth());
-			new_track->SetHeight(iter.second->GetVideoHeight());
-			new_track->SetFrameRate(iter.second->GetFrameRate());
-
-		}
-		else if(media_track->GetMediaType() == common::MediaType::Audio)
-		{
-			new_track->SetSampleRate(iter.second->GetAudioSampleRate());
-			new_track->GetSample().SetFormat(iter.second->GetAudioSample().GetFormat());
-			new_track->GetChannel().SetLayout(iter.second->GetAudioChannel().GetLayout());
+			// Same as the input track
+			new_track = std::make_shared<MediaTrack>(*media_track);
+			new_track->SetId((uint32_t)iter.first);
 		}
 		else
 		{
-			OV_ASSERT2(false);
-			continue;
+			new_track = std::make_shared<MediaTrack>();
+			new_track->SetId((uint32_t)iter.first);
+			new_track->SetMediaType(media_track->GetMediaType());
+			new_track->SetCodecId(iter.second->GetCodecId());
+			new_track->SetTimeBase(iter.second->GetTimeBase().GetNum(), iter.second->GetTimeBase().GetDen());
+			new_track->SetBitrate(iter.second->GetBitrate());
+
+			if(media_track->GetMediaType() == common::MediaType::Video)
+			{
+				new_track->SetWidth(iter.second->GetVideoWidth());
+				new_track->SetHeight(iter.second->GetVideoHeight());
+				new_track->SetFrameRate(iter.second->GetFrameRate());
+				new_track->SetTemporalLayerCount(iter.second->GetTemporalLayerCount());
+
+			}
+			else if(media_track->GetMediaType() == common::MediaType::Audio)
+			{
+				new_track->SetSampleRate(iter.second->GetAudioSampleRate());
+				new_track->GetSample().SetFormat(iter.second->GetAudioSample().GetFormat());
+				new_track->GetChannel().SetLayout(iter.second->GetAudioChannel().GetLayout());
+			}
+			else
+			{
+				OV_ASSERT2(false);
+				continue;
+			}
 		}
 
 		for(auto stream_track : _stream_tracks)
@@ -719,50 +1602,196 @@ void TranscodeStream::CreateEncoders(std::shared_ptr<MediaTrack> media_track)
 			logti("stream_name(%s), track_id(%d)", stream_track.first.CStr(), iter.first);
 		}
 
+		if(iter.second->IsBypass())
+		{
+			_bypass_tracks[media_track->GetId()].push_back(iter.first);
+			continue;
+		}
+
 		// av_log_set_level(AV_LOG_DEBUG);
 		CreateEncoder(new_track, iter.second);
 	}
 }
 
+bool TranscodeStream::IsSameEncoderOutput(const std::shared_ptr<TranscodeContext> &context1, const std::shared_ptr<TranscodeContext> &context2)
+{
+	if((context1->GetMediaType() != common::MediaType::Audio) || (context2->GetMediaType() != common::MediaType::Audio))
+	{
+		return false;
+	}
+
+	if(context1->IsBypass() || context2->IsBypass())
+	{
+		// The packets of the input
+		return context1->IsBypass() && context2->IsBypass();
+	}
+
+	return (context1->GetCodecId() == context2->GetCodecId()) &&
+	       (context1->GetBitrate() == context2->GetBitrate()) &&
+	       (context1->GetOpusOptions() == context2->GetOpusOptions()) &&
+	       IsSameFilterOutput(context1, context2);
+}
+
+bool TranscodeStream::IsSameFilterOutput(const std::shared_ptr<TranscodeContext> &context1, const std::shared_ptr<TranscodeContext> &context2)
+{
+	if((context1->GetMediaType() != context2->GetMediaType()) ||
+	   (context1->GetTimeBase().GetNum() != context2->GetTimeBase().GetNum()) ||
+	   (context1->GetTimeBase().GetDen() != context2->GetTimeBase().GetDen()))
+	{
+		return false;
+	}
+
+	if(context1->GetMediaType() == common::MediaType::Video)
+	{
+		return (context1->GetVideoWidth() == context2->GetVideoWidth()) &&
+		       (context1->GetVideoHeight() == context2->GetVideoHeight()) &&
+		       (context1->GetHardwareType() == context2->GetHardwareType());
+	}
+
+	return (context1->GetAudioSampleRate() == context2->GetAudioSampleRate()) &&
+	       (context1->GetAudioSample().GetFormat() == context2->GetAudioSample().GetFormat()) &&
+	       (context1->GetAudioChannel().GetLayout() == context2->GetAudioChannel().GetLayout());
+}
+
 void TranscodeStream::CreateFilters(std::shared_ptr<MediaTrack> media_track, MediaFrame *buffer)
 {
-	for(auto &context_item : _contexts)
+	auto media_type = media_track->GetMediaType();
+
+	if(media_type == common::MediaType::Video)
+	{
+		media_track->SetWidth(buffer->GetWidth());
+		media_track->SetHeight(buffer->GetHeight());
+	}
+	else if(media_type == common::MediaType::Audio)
+	{
+		media_track->SetSampleRate(buffer->GetSampleRate());
+		media_track->GetSample().SetFormat(buffer->GetFormat<common::AudioSample::Format>());
+		media_track->GetChannel().SetLayout(buffer->GetChannelLayout());
+	}
+	else
+	{
+		OV_ASSERT2(false);
+		return;
+	}
+
+	// The decoded frames have the timestamp in milliseconds
+	media_track->GetTimeBase().Set(1, 1000);
+
+	for(auto rung_item = _filter_rungs.begin(); rung_item != _filter_rungs.end();)
 	{
-		if(media_track->GetMediaType() != context_item.second->GetMediaType())
+		if(_contexts[rung_item->first]->GetMediaType() == media_type)
 		{
-			continue;
+			rung_item = _filter_rungs.erase(rung_item);
 		}
-
-		if(media_track->GetMediaType() == common::MediaType::Video)
+		else
 		{
-			media_track->SetWidth(buffer->GetWidth());
-			media_track->SetHeight(buffer->GetHeight());
+			++rung_item;
 		}
-		else if(media_track->GetMediaType() == common::MediaType::Audio)
+	}
+
+	// Group the output tracks which need the same filtered frames
+	std::vector<MediaTrackId> rung_ids;
+
+	for(auto &context_item : _contexts)
+	{
+		if((context_item.second->GetMediaType() != media_type) || context_item.second->IsBypass())
 		{
-			media_track->SetSampleRate(buffer->GetSampleRate());
-			media_track->GetSample().SetFormat(buffer->GetFormat<common::AudioSample::Format>());
-			media_track->GetChannel().SetLayout(buffer->GetChannelLayout());
+			continue;
 		}
-		else
+
+		auto rung_id = std::find_if(rung_ids.begin(), rung_ids.end(), [&](MediaTrackId id) -> bool {
+			return IsSameFilterOutput(_contexts[id], context_item.second);
+		});
+
+		if(rung_id != rung_ids.end())
 		{
-			OV_ASSERT2(false);
+			_filter_rungs[*rung_id].track_ids.push_back(context_item.first);
 			continue;
 		}
 
-		_filters[context_item.first] = std::make_unique<TranscodeFilter>(media_track, context_item.second);
+		rung_ids.push_back(context_item.first);
+		_filter_rungs[context_item.first].track_ids.push_back(context_item.first);
+	}
+
+	if(media_type == common::MediaType::Video)
+	{
+		// Larger rungs first, so that each rung can be scaled from the smallest larger rung
+		std::stable_sort(rung_ids.begin(), rung_ids.end(), [&](MediaTrackId id1, MediaTrackId id2) -> bool {
+			return ((uint64_t)_contexts[id1]->GetVideoWidth() * _contexts[id1]->GetVideoHeight()) >
+			       ((uint64_t)_contexts[id2]->GetVideoWidth() * _contexts[id2]->GetVideoHeight());
+		});
+	}
+
+	for(size_t index = 0; index < rung_ids.size(); index++)
+	{
+		auto rung_id = rung_ids[index];
+		auto &context = _contexts[rung_id];
+		auto &rung = _filter_rungs[rung_id];
+		auto input_track = media_track;
+
+		if(media_type == common::MediaType::Video)
+		{
+			for(size_t parent_index = index; parent_index > 0; parent_index--)
+			{
+				auto parent_rung_id = rung_ids[parent_index - 1];
+				auto &parent_context = _contexts[parent_rung_id];
+
+				// Downscaling only, and the frames of the parent must be in the same memory (system or device)
+				if((parent_context->GetVideoWidth() < context->GetVideoWidth()) ||
+				   (parent_context->GetVideoHeight() < context->GetVideoHeight()) ||
+				   (parent_context->GetHardwareType() != context->GetHardwareType()))
+				{
+					continue;
+				}
+
+				input_track = std::make_shared<MediaTrack>(*media_track);
+				input_track->SetWidth(parent_context->GetVideoWidth());
+				input_track->SetHeight(parent_context->GetVideoHeight());
+				input_track->SetTimeBase(parent_context->GetTimeBase().GetNum(), parent_context->GetTimeBase().GetDen());
+
+				rung.is_root = false;
+				_filter_rungs[parent_rung_id].child_rung_ids.push_back(rung_id);
+
+				logti("Track[%u] (%ux%u) is scaled from track[%u] (%ux%u)",
+				      rung_id, context->GetVideoWidth(), context->GetVideoHeight(),
+				      parent_rung_id, parent_context->GetVideoWidth(), parent_context->GetVideoHeight());
+
+				break;
+			}
+		}
+
+		rung.filter = std::make_unique<TranscodeFilter>(input_track, context);
 	}
 }
 
 void TranscodeStream::DoFilters(std::unique_ptr<MediaFrame> frame)
 {
+	UpdateParkedTracks();
+	UpdateSuspendedTracks();
+
 	// 패킷의 트랙 아이디를 조회
 	int32_t track_id = frame->GetTrackId();
 
-	for(auto &iter: _contexts)
+	if((track_id == (int32_t)common::MediaType::Video) && (_overload_statistics->GetLevel() >= StreamOverloadLevel::ReduceFrameRate))
 	{
-		if(track_id != (int32_t)iter.second->GetMediaType())
+		// Half of the frame rate for all renditions
+		if((_overload_frame_index++ % 2) == 1)
+		{
+			_overload_statistics->AddDroppedFrame();
+			return;
+		}
+	}
+
+	for(auto &iter: _filter_rungs)
+	{
+		if((iter.second.is_root == false) || (track_id != (int32_t)_contexts[iter.first]->GetMediaType()))
+		{
+			continue;
+		}
+
+		if(IsRungActive(iter.first) == false)
 		{
+			// Nobody watches the outputs of this rung
 			continue;
 		}
 
@@ -777,6 +1806,290 @@ void TranscodeStream::DoFilters(std::unique_ptr<MediaFrame> frame)
 	}
 }
 
+void TranscodeStream::UpdateParkedTracks()
+{
+	if(_on_demand_streams.empty())
+	{
+		return;
+	}
+
+	int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	uint64_t version = StreamDemand::Instance()->GetVersion();
+
+	if((version == _demand_version) && ((now - _last_demand_check_time) < TRANSCODE_ON_DEMAND_CHECK_INTERVAL))
+	{
+		return;
+	}
+
+	_demand_version = version;
+	_last_demand_check_time = now;
+
+	for(auto &on_demand_item : _on_demand_streams)
+	{
+		auto &on_demand_stream = on_demand_item.second;
+
+		if(StreamDemand::Instance()->GetSessionCount(_application_info->GetId(), on_demand_item.first) > 0)
+		{
+			on_demand_stream.idle_since = -1;
+			on_demand_stream.is_active = true;
+		}
+		else if(on_demand_stream.is_active)
+		{
+			if(on_demand_stream.idle_since < 0)
+			{
+				on_demand_stream.idle_since = now;
+			}
+			else if((now - on_demand_stream.idle_since) >= on_demand_stream.idle_timeout)
+			{
+				on_demand_stream.idle_since = -1;
+				on_demand_stream.is_active = false;
+			}
+		}
+	}
+
+	// A track is parked if all streams which use it are inactive on-demand streams
+	std::set<MediaTrackId> parked_track_ids;
+
+	for(auto &encoder_item : _encoders)
+	{
+		auto track_id = encoder_item.first;
+		bool is_used = false;
+
+		for(auto &stream_track : _stream_tracks)
+		{
+			if(std::find(stream_track.second.begin(), stream_track.second.end(), track_id) == stream_track.second.end())
+			{
+				continue;
+			}
+
+			auto on_demand_item = _on_demand_streams.find(stream_track.first);
+
+			if((on_demand_item == _on_demand_streams.end()) || on_demand_item->second.is_active)
+			{
+				is_used = true;
+				break;
+			}
+		}
+
+		bool was_parked = (_parked_track_ids.find(track_id) != _parked_track_ids.end());
+
+		if(is_used == false)
+		{
+			parked_track_ids.insert(track_id);
+
+			if(was_parked == false)
+			{
+				logti("Track[%d] is parked (no session)", track_id);
+			}
+		}
+		else if(was_parked)
+		{
+			// The players can start as soon as possible
+			encoder_item.second->RequestKeyFrame();
+
+			logti("Track[%d] is activated", track_id);
+		}
+	}
+
+	_parked_track_ids = std::move(parked_track_ids);
+}
+
+bool TranscodeStream::IsRungActive(MediaTrackId rung_id) const
+{
+	auto rung_item = _filter_rungs.find(rung_id);
+	if(rung_item == _filter_rungs.end())
+	{
+		return false;
+	}
+
+	for(auto track_id : rung_item->second.track_ids)
+	{
+		if(IsTrackActive(track_id))
+		{
+			return true;
+		}
+	}
+
+	for(auto child_rung_id : rung_item->second.child_rung_ids)
+	{
+		if(IsRungActive(child_rung_id))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool TranscodeStream::IsTrackActive(MediaTrackId track_id) const
+{
+	return (_parked_track_ids.find(track_id) == _parked_track_ids.end()) &&
+		   (_suspended_track_ids.find(track_id) == _suspended_track_ids.end());
+}
+
+void TranscodeStream::UpdateOverload(int64_t queue_delay)
+{
+	int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	_overload_max_delay = std::max(_overload_max_delay, queue_delay);
+
+	if(_overload_check_time < 0)
+	{
+		_overload_check_time = now;
+		return;
+	}
+
+	if((now - _overload_check_time) < TRANSCODE_OVERLOAD_CHECK_INTERVAL)
+	{
+		return;
+	}
+
+	int64_t max_delay = _overload_max_delay;
+
+	_overload_check_time = now;
+	_overload_max_delay = 0;
+	_overload_statistics->SetQueueDelay(max_delay);
+
+	auto level = _overload_statistics->GetLevel();
+	auto suspended_count = _overload_statistics->GetSuspendedRenditionCount();
+	auto new_level = level;
+	auto new_suspended_count = suspended_count;
+
+	if(max_delay > TRANSCODE_OVERLOAD_DEADLINE)
+	{
+		_overload_recovery_count = 0;
+
+		if(level < StreamOverloadLevel::SuspendRenditions)
+		{
+			new_level = static_cast<StreamOverloadLevel>(static_cast<int>(level) + 1);
+		}
+
+		if((new_level == StreamOverloadLevel::SuspendRenditions) && (suspended_count < GetSuspendableTracks().size()))
+		{
+			// One more rendition for each interval
+			new_suspended_count++;
+		}
+	}
+	else if((max_delay < (TRANSCODE_OVERLOAD_DEADLINE / 4)) && (level != StreamOverloadLevel::Normal))
+	{
+		if(++_overload_recovery_count < TRANSCODE_OVERLOAD_RECOVERY_COUNT)
+		{
+			return;
+		}
+
+		_overload_recovery_count = 0;
+
+		if(suspended_count > 0)
+		{
+			// The renditions are resumed one by one before the other steps
+			new_suspended_count--;
+
+			if(new_suspended_count == 0)
+			{
+				new_level = StreamOverloadLevel::FastEncoding;
+			}
+		}
+		else
+		{
+			new_level = static_cast<StreamOverloadLevel>(static_cast<int>(level) - 1);
+		}
+	}
+	else
+	{
+		_overload_recovery_count = 0;
+	}
+
+	if((new_level == level) && (new_suspended_count == suspended_count))
+	{
+		return;
+	}
+
+	bool skip_non_reference = (new_level >= StreamOverloadLevel::SkipNonReference);
+
+	if(skip_non_reference != (level >= StreamOverloadLevel::SkipNonReference))
+	{
+		for(auto &decoder_item : _decoders)
+		{
+			decoder_item.second->SetSkipNonReference(skip_non_reference);
+		}
+	}
+
+	_overload_statistics->SetSuspendedRenditionCount(new_suspended_count);
+	_overload_statistics->SetLevel(new_level);
+
+	if((new_level > level) || (new_suspended_count > suspended_count))
+	{
+		logtw("[%s/%s] Transcoding is overloaded (the packets waited %lld ms), degradation: %s, suspended renditions: %u",
+			  _application_info->GetName().CStr(), _stream_info_input->GetName().CStr(), max_delay,
+			  StreamOverloadStatistics::GetLevelName(new_level), new_suspended_count);
+	}
+	else
+	{
+		logti("[%s/%s] Transcoding is recovering (the packets waited %lld ms), degradation: %s, suspended renditions: %u",
+			  _application_info->GetName().CStr(), _stream_info_input->GetName().CStr(), max_delay,
+			  StreamOverloadStatistics::GetLevelName(new_level), new_suspended_count);
+	}
+}
+
+std::vector<MediaTrackId> TranscodeStream::GetSuspendableTracks() const
+{
+	std::vector<MediaTrackId> track_ids;
+
+	// The output tracks are numbered in the order of <Encodes>
+	for(const auto &encoder_item : _encoders)
+	{
+		auto context_item = _contexts.find(encoder_item.first);
+
+		if((context_item != _contexts.end()) && (context_item->second->GetMediaType() == common::MediaType::Video))
+		{
+			track_ids.push_back(encoder_item.first);
+		}
+	}
+
+	if(track_ids.empty() == false)
+	{
+		track_ids.erase(track_ids.begin());
+	}
+
+	std::reverse(track_ids.begin(), track_ids.end());
+
+	return track_ids;
+}
+
+void TranscodeStream::UpdateSuspendedTracks()
+{
+	auto track_ids = GetSuspendableTracks();
+	size_t count = std::min(static_cast<size_t>(_overload_statistics->GetSuspendedRenditionCount()), track_ids.size());
+
+	std::set<MediaTrackId> suspended_track_ids(track_ids.begin(), track_ids.begin() + count);
+
+	if(suspended_track_ids == _suspended_track_ids)
+	{
+		return;
+	}
+
+	for(auto track_id : _suspended_track_ids)
+	{
+		if(suspended_track_ids.find(track_id) == suspended_track_ids.end())
+		{
+			// The players of the rendition can continue as soon as possible
+			_encoders[track_id]->RequestKeyFrame();
+
+			logti("Track[%d] is resumed", track_id);
+		}
+	}
+
+	for(auto track_id : suspended_track_ids)
+	{
+		if(_suspended_track_ids.find(track_id) == _suspended_track_ids.end())
+		{
+			logtw("Track[%d] is suspended (overloaded)", track_id);
+		}
+	}
+
+	_suspended_track_ids = std::move(suspended_track_ids);
+}
+
 uint8_t TranscodeStream::AddContext(common::MediaType media_type, std::shared_ptr<TranscodeContext> context)
 {
 	uint8_t last_index = 0;
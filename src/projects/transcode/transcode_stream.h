@@ -11,10 +11,15 @@
 #include "codec/transcode_decoder.h"
 #include "codec/transcode_encoder.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <queue>
+#include <set>
 
 #include "base/media_route/media_buffer.h"
 #include "base/media_route/media_queue.h"
@@ -23,11 +28,33 @@
 
 #include "transcode_context.h"
 #include "transcode_filter.h"
+#include "transcode_statistics.h"
 
 #include "codec/transcode_encoder.h"
 #include "codec/transcode_decoder.h"
 
 #include <base/application/application.h>
+#include <base/application/stream_latency.h>
+#include <base/application/stream_memory.h>
+#include <base/application/stream_overload.h>
+#include <base/application/stream_key_frame_advisory.h>
+#include <base/application/application_quota.h>
+
+// Interval to check the idle timeout of the on-demand streams (in milliseconds)
+#define TRANSCODE_ON_DEMAND_CHECK_INTERVAL		1000
+
+// GOP of the encoders if the key frames are synchronized (the key frames are forced at the synchronization points,
+// so the encoders make the key frames by themselves only if the input does not have any key frame for a long time)
+#define TRANSCODE_KEY_FRAME_SYNC_GOP			600
+// Number of the key frames of the input kept to synchronize the renditions
+#define TRANSCODE_SOURCE_KEY_FRAME_COUNT		16
+
+// The degradation is raised by a level for each interval which the input packets wait longer than this (in milliseconds)
+#define TRANSCODE_OVERLOAD_DEADLINE				500
+// Interval to change the level of the degradation (in milliseconds)
+#define TRANSCODE_OVERLOAD_CHECK_INTERVAL		1000
+// The level is lowered after the packets wait less than (TRANSCODE_OVERLOAD_DEADLINE / 4) for this number of intervals
+#define TRANSCODE_OVERLOAD_RECOVERY_COUNT		5
 
 class TranscodeApplication;
 
@@ -45,6 +72,34 @@ public:
 
 	static std::map<uint32_t, std::set<ov::String>> _stream_list;
 
+	// The stages run on the workers of TranscodeScheduler
+	enum class Stage : int
+	{
+		Decode = 0,
+		Filter,
+		Encode,
+
+		NumberOfStages
+	};
+
+	static const char *GetStageName(Stage stage);
+
+	// Throughput and latency of the stage (used by the stats log and the benchmark)
+	const TranscodeStageStatistics &GetStageStatistics(Stage stage) const;
+	// Number of the items waiting in the input queue of the stage
+	size_t GetStageQueueSize(Stage stage) const;
+	// Latency of the video encoders (key: output track id)
+	std::map<MediaTrackId, const TranscodeStageStatistics *> GetEncoderStatistics() const;
+
+	// Asks the encoder of the output track for a key frame (returns false if the output stream is not made by this stream)
+	// - bypass_track_id: the input track if the output track is bypassed (the request goes to the provider), -1 if encoded
+	bool RequestKeyFrame(uint32_t output_stream_id, MediaTrackId track_id, MediaTrackId &bypass_track_id);
+
+	uint32_t GetInputStreamId() const
+	{
+		return _stream_info_input->GetId();
+	}
+
 private:
 
 	// 입력 스트림 정보
@@ -72,30 +127,146 @@ private:
 	// 인코더
 	std::map<MediaTrackId, std::unique_ptr<TranscodeEncoder>> _encoders;
 
+	// Output tracks which use the packets of the input track as-is (key: input track id)
+	std::map<MediaTrackId, std::vector<MediaTrackId>> _bypass_tracks;
+
 	// 필터
-	std::map<MediaTrackId, std::unique_ptr<TranscodeFilter>> _filters;
+	// A rung of the scaling ladder, which is shared by the output tracks that need the same filtered frames
+	struct FilterRung
+	{
+		std::unique_ptr<TranscodeFilter> filter;
+
+		// Output tracks (encoders) which use the frames of this rung
+		std::vector<MediaTrackId> track_ids;
+
+		// Smaller rungs which scale the frames of this rung again (e.g. 1080p -> 720p -> 480p -> 360p)
+		std::vector<MediaTrackId> child_rung_ids;
+
+		// true: fed by the decoder, false: fed by the parent rung
+		bool is_root = true;
+	};
+
+	// key: the first output track of the rung
+	std::map<MediaTrackId, FilterRung> _filter_rungs;
 
 	// 스트림별 트랙집합
 	std::map <ov::String, std::vector <uint8_t >> _stream_tracks;
 
+	// State of the output stream which enables <OnDemand>
+	struct OnDemandStream
+	{
+		int64_t idle_timeout = 0;
 
-private:
-	volatile bool _kill_flag;
+		// Time when the stream is found without sessions (-1: the stream has sessions)
+		int64_t idle_since = -1;
+
+		bool is_active = false;
+	};
+
+	// key: name of the output stream
+	std::map<ov::String, OnDemandStream> _on_demand_streams;
+
+	// Output tracks which are used only by the inactive on-demand streams (their frames are neither filtered nor encoded)
+	std::set<MediaTrackId> _parked_track_ids;
 
-	void DecodeTask();
-	std::thread _thread_decode;
+	uint64_t _demand_version = 0;
+	int64_t _last_demand_check_time = 0;
 
-	void FilterTask();
-	std::thread _thread_filter;
+	// The key frames of all video renditions are forced at the same timestamps (<KeyFrameSync>)
+	bool _key_frame_sync = false;
+	// Interval of the synchronization points (milliseconds, 0: the key frames of the input)
+	int64_t _key_frame_interval = 0;
 
-	void EncodeTask();
-	std::thread _thread_encode;
+	// Key frame interval asked by the publishers of the outputs (e.g. the segment duration of HLS/DASH),
+	// used when neither <KeyFrameSync> nor <KeyFrameInterval> is set
+	std::shared_ptr<StreamKeyFrameAdvice> _key_frame_advice;
+	int64_t _advised_key_frame_interval = 0;
+
+	// Timestamps of the recent key frames of the input (in milliseconds, added by the decode stage)
+	std::mutex _source_key_frame_mutex;
+	std::deque<int64_t> _source_key_frame_pts;
+
+	// The last synchronization point forced to each encoder (key: output track id, used by the encode stage)
+	std::map<MediaTrackId, int64_t> _last_sync_points;
+
+	// Degradation when the stages can't keep up with the input (see UpdateOverload())
+	std::shared_ptr<StreamOverloadStatistics> _overload_statistics;
+	// The stages are run with the share of the application in TranscodeScheduler
+	std::shared_ptr<ApplicationQuotaStatistics> _quota_statistics;
+	// Used by the decode stage
+	int64_t _overload_check_time = -1;
+	int64_t _overload_max_delay = 0;
+	int _overload_recovery_count = 0;
+	// Used by the filter stage
+	uint64_t _overload_frame_index = 0;
+	std::set<MediaTrackId> _suspended_track_ids;
+	// Output tracks whose encoders use the fast mode (used by the encode stage)
+	std::set<MediaTrackId> _fast_track_ids;
+
+
+private:
+	std::atomic<bool> _kill_flag { false };
+
+	// true if the output streams are created (they are deleted by Stop())
+	bool _is_started = false;
+
+	// Each stage of a stream is posted only once at a time, so the packets/frames of a stage are processed in order
+	void ScheduleStage(Stage stage);
+	void RunStage(Stage stage);
+	void FinishStageTask();
+
+	// Whether the stage has an input to process
+	bool HasStageInput(Stage stage) const;
+	// Whether the output queue of the stage can accept more items (backpressure from the slower stages)
+	bool CanRunStage(Stage stage) const;
+	// _max_queue_size, or less if it is capped by ov::MemoryGovernor
+	uint64_t GetMaxQueueSize() const;
+	// Processes an item of the input queue of the stage (returns false if there is no input)
+	bool ProcessStage(Stage stage);
+	// latency: processing time of an item (in microseconds), recorded to both of the statistics
+	void RecordStageLatency(Stage stage, int64_t latency);
+
+	std::atomic<bool> _stage_scheduled[static_cast<int>(Stage::NumberOfStages)];
+	TranscodeStageStatistics _stage_statistics[static_cast<int>(Stage::NumberOfStages)];
+	std::shared_ptr<StreamLatencyStatistics> _latency_statistics;
+	// Bytes of the items in _queue, _queue_decoded and _queue_filterd
+	std::shared_ptr<StreamMemoryStatistics> _memory_statistics;
+
+	// Number of the tasks which are posted and not finished yet (Stop() waits for them)
+	int _stage_task_count = 0;
+	std::mutex _stage_task_mutex;
+	std::condition_variable _stage_task_condition;
 
 	TranscodeApplication *_parent;
 
 	// 디코더 생성
 	void CreateDecoder(int32_t track_id);
 
+	// Hardware accelerator of the video profile (TranscodeHardwareType::None if the codec is not supported by the device)
+	static TranscodeHardwareType GetHardwareType(const cfg::VideoProfile &video_profile);
+	// <Preset> of the video profile, overridden by <ThreadCount> and <RateControl>
+	static TranscodeEncoderPreset GetEncoderPreset(const cfg::VideoProfile &video_profile);
+	// <TemporalLayers> of the video profile, limited by the encoder of the codec
+	static uint8_t GetTemporalLayerCount(const cfg::VideoProfile &video_profile);
+	// <Opus> of the audio profile, the invalid values are replaced with the defaults
+	static TranscodeOpusOptions GetOpusOptions(const cfg::AudioProfile &audio_profile);
+	// The decoder uses the device only if all active video profiles use the same device
+	TranscodeHardwareType GetDecoderHardwareType();
+
+	// The first input track of the media type
+	std::shared_ptr<MediaTrack> GetInputTrack(common::MediaType media_type);
+
+	// The packets of the input track are bypassed if <Bypass> is set, or the profile is the same as the input
+	static bool IsBypass(const cfg::VideoProfile &video_profile, const std::shared_ptr<MediaTrack> &input_track);
+	static bool IsBypass(const cfg::AudioProfile &audio_profile, const std::shared_ptr<MediaTrack> &input_track);
+	static std::shared_ptr<TranscodeContext> CreateBypassContext(const std::shared_ptr<MediaTrack> &input_track);
+
+	// Whether any output track needs the decoded frames of the media type
+	bool IsDecodingNeeded(common::MediaType media_type) const;
+
+	// Sends the packet to the bypass output tracks of the input track
+	void SendBypassPacket(MediaPacket *packet);
+
 	// 인코더 생성
 	void CreateEncoders(std::shared_ptr<MediaTrack> media_track);
 	void CreateEncoder(std::shared_ptr<MediaTrack> media_track, std::shared_ptr<TranscodeContext> transcode_context);
@@ -104,15 +275,40 @@ private:
 	void ChangeOutputFormat(MediaFrame *buffer);
 
 	void CreateFilters(std::shared_ptr<MediaTrack> media_track, MediaFrame *buffer);
+	// Whether the audio output tracks can share the encoded packets (the output streams use the same track)
+	static bool IsSameEncoderOutput(const std::shared_ptr<TranscodeContext> &context1, const std::shared_ptr<TranscodeContext> &context2);
+	// Whether the output tracks can share the filtered frames
+	static bool IsSameFilterOutput(const std::shared_ptr<TranscodeContext> &context1, const std::shared_ptr<TranscodeContext> &context2);
 	void DoFilters(std::unique_ptr<MediaFrame> frame);
 
+	// Parks/activates the encoders according to the sessions of the on-demand streams (called by the filter stage)
+	void UpdateParkedTracks();
+	// Whether any output track of the rung (or its children) is active
+	bool IsRungActive(MediaTrackId rung_id) const;
+	// Whether the output track is neither parked nor suspended
+	bool IsTrackActive(MediaTrackId track_id) const;
+
+	// Changes the level of the degradation by the waiting time of the input packets (called by the decode stage)
+	void UpdateOverload(int64_t queue_delay);
+	// The video output tracks which can be suspended, from the lowest priority (the first rendition is never suspended)
+	std::vector<MediaTrackId> GetSuspendableTracks() const;
+	// Suspends/resumes the renditions by the level of the degradation (called by the filter stage)
+	void UpdateSuspendedTracks();
+
 	// 1. 디코딩
 	TranscodeResult DecodePacket(int32_t track_id, std::unique_ptr<const MediaPacket> packet);
-	// 2. 필터링
-	TranscodeResult FilterFrame(int32_t track_id, std::unique_ptr<MediaFrame> frame);
+	// 2. 필터링 (rung_id: key of _filter_rungs)
+	TranscodeResult FilterFrame(int32_t rung_id, std::unique_ptr<MediaFrame> frame);
+
 	// 3. 인코딩
 	TranscodeResult EncodeFrame(int32_t track_id, std::unique_ptr<const MediaFrame> frame);
 
+	void AddSourceKeyFrame(int64_t pts);
+	// Interval of the synchronization points of the encode stage (milliseconds, 0: the key frames of the input, -1: no synchronization point)
+	int64_t GetKeyFrameInterval();
+	// Whether the frame is the first frame at or after the next synchronization point of the track
+	bool IsSyncPoint(MediaTrackId track_id, int64_t pts, int64_t key_frame_interval);
+
 	// 출력(변화된) 스트림 정보
 	bool AddStreamInfoOutput(ov::String stream_name);
 	std::map<ov::String, std::shared_ptr<StreamInfo>> _stream_info_outputs;
@@ -13,6 +13,7 @@
 #include <unistd.h>
 
 #include "transcoder.h"
+#include "transcode_scheduler.h"
 #include "config/config_manager.h"
 
 #define OV_LOG_TAG "Transcoder"
@@ -37,6 +38,13 @@ bool Transcoder::Start()
 {
 	logtd("Started media trancode modules.");
 
+	if(TranscodeScheduler::Instance()->Start() == false)
+	{
+		logte("Failed to start media transcode modules. could not start the workers.");
+
+		return false;
+	}
+
 	if(CreateApplications() == false)
 	{
 		logte("Failed to start media transcode modules. invalid application.");
@@ -65,17 +73,57 @@ bool Transcoder::CreateApplications()
 {
 	for(auto const &application_info : _app_info_list)
 	{
-		info::application_id_t application_id = application_info.GetId();
+		CreateApplication(&application_info);
+	}
+
+	return true;
+}
+
+bool Transcoder::CreateApplication(const info::Application *application_info)
+{
+	info::application_id_t application_id = application_info->GetId();
 
-		auto trans_app = std::make_shared<TranscodeApplication>(&application_info);
+	auto trans_app = std::make_shared<TranscodeApplication>(application_info);
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
 
 		// 라우터 어플리케이션 관리 항목에 추가
 		_tracode_apps[application_id] = trans_app;
+	}
 
-		_router->RegisterObserverApp(&application_info, trans_app);
-		_router->RegisterConnectorApp(&application_info, trans_app);
+	_router->RegisterObserverApp(application_info, trans_app);
+	_router->RegisterConnectorApp(application_info, trans_app);
+
+	return true;
+}
+
+bool Transcoder::DeleteApplication(info::application_id_t application_id)
+{
+	std::shared_ptr<TranscodeApplication> trans_app;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_mutex);
+
+		auto item = _tracode_apps.find(application_id);
+
+		if(item == _tracode_apps.end())
+		{
+			return false;
+		}
+
+		trans_app = item->second;
+		_tracode_apps.erase(item);
 	}
 
+	auto application_info = trans_app->GetApplicationInfo();
+
+	_router->UnregisterConnectorApp(application_info, trans_app);
+	_router->UnregisterObserverApp(application_info, trans_app);
+
+	// The transcode streams of the application are stopped
+	trans_app->Stop();
+
 	return true;
 }
 
@@ -88,6 +136,8 @@ bool Transcoder::DeleteApplication()
 //  Application Name으로 TranscodeApplication 찾음
 std::shared_ptr<TranscodeApplication> Transcoder::GetApplicationById(info::application_id_t application_id)
 {
+	std::lock_guard<std::mutex> lock_guard(_mutex);
+
 	auto obj = _tracode_apps.find(application_id);
 
 	if(obj == _tracode_apps.end())
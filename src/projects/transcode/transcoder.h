@@ -45,6 +45,11 @@ public:
 	bool CreateApplications();
 	bool DeleteApplication();
 
+	// Adds/removes an application after Start() (config reload)
+	// - application_info must be valid until the application is deleted
+	bool CreateApplication(const info::Application *application_info);
+	bool DeleteApplication(info::application_id_t application_id);
+
 	// Application Name으로 RouteApplication을 찾음
 	std::shared_ptr<TranscodeApplication> GetApplicationById(info::application_id_t application_id);
 
@@ -52,6 +57,7 @@ private:
 	std::vector<info::Application> _app_info_list;
 
 	std::map<info::application_id_t, std::shared_ptr<TranscodeApplication>> _tracode_apps;
+	std::mutex _mutex;
 
 	std::shared_ptr<MediaRouteInterface> _router;
 };
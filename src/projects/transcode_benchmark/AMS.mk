@@ -0,0 +1,30 @@
+LOCAL_PATH := $(call get_local_path)
+include $(DEFAULT_VARIABLES)
+
+LOCAL_STATIC_LIBRARIES := \
+	transcoder \
+	application \
+	ovcrypto \
+	config \
+	ovlibrary \
+	jsoncpp
+
+LOCAL_PREBUILT_LIBRARIES := \
+	libpugixml.a
+
+LOCAL_LDFLAGS := \
+	-lpthread \
+	-ldl \
+	`pkg-config --libs libavformat` \
+	`pkg-config --libs libavfilter` \
+	`pkg-config --libs libavcodec` \
+	`pkg-config --libs libswresample` \
+	`pkg-config --libs libswscale` \
+	`pkg-config --libs libavutil` \
+	`pkg-config --libs openssl` \
+	`pkg-config --libs vpx` \
+	`pkg-config --libs opus`
+
+LOCAL_TARGET := transcode_benchmark
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,202 @@
+//==============================================================================
+//
+//  TranscodeBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "elementary_stream_reader.h"
+
+#include <fstream>
+
+#define OV_LOG_TAG "TranscodeBenchmark"
+
+#define ADTS_HEADER_SIZE				7
+#define AAC_SAMPLES_PER_FRAME			1024
+
+namespace
+{
+	enum class H264NalType : uint8_t
+	{
+		Slice = 1,
+		IdrSlice = 5,
+		Sei = 6,
+		Sps = 7,
+		Pps = 8,
+		Aud = 9
+	};
+
+	const int32_t adts_sample_rates[] =
+	{
+		96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350
+	};
+}
+
+bool ElementaryStreamReader::ReadFile(const ov::String &file_path, std::vector<uint8_t> &buffer)
+{
+	std::ifstream file(file_path.CStr(), std::ios::binary);
+
+	if(file.is_open() == false)
+	{
+		logte("Could not open file: %s", file_path.CStr());
+		return false;
+	}
+
+	buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+	return true;
+}
+
+bool ElementaryStreamReader::ReadH264(const ov::String &file_path, double frame_rate, std::vector<ElementaryFrame> &frames)
+{
+	std::vector<uint8_t> buffer;
+
+	if((frame_rate <= 0.0) || (ReadFile(file_path, buffer) == false))
+	{
+		return false;
+	}
+
+	// Offsets of the NAL units (after the start code)
+	std::vector<size_t> nal_offsets;
+	size_t size = buffer.size();
+
+	for(size_t offset = 0; offset + 3 <= size; offset++)
+	{
+		if((buffer[offset] == 0x00) && (buffer[offset + 1] == 0x00) && (buffer[offset + 2] == 0x01))
+		{
+			nal_offsets.push_back(offset + 3);
+			offset += 2;
+		}
+	}
+
+	static const uint8_t start_code[] = { 0x00, 0x00, 0x00, 0x01 };
+
+	ElementaryFrame frame;
+	bool has_slice = false;
+
+	auto flush_frame = [&]() {
+		if(frame.data.empty() == false)
+		{
+			frame.media_type = common::MediaType::Video;
+			frame.pts = static_cast<int64_t>(static_cast<double>(frames.size()) * 1000.0 / frame_rate);
+
+			frames.push_back(std::move(frame));
+		}
+
+		frame = ElementaryFrame();
+		has_slice = false;
+	};
+
+	for(size_t index = 0; index < nal_offsets.size(); index++)
+	{
+		size_t nal_offset = nal_offsets[index];
+		size_t nal_end = (index + 1 < nal_offsets.size()) ? (nal_offsets[index + 1] - 3) : size;
+
+		// Trailing zeros belong to the next start code (00 00 00 01)
+		while((nal_end > nal_offset) && (buffer[nal_end - 1] == 0x00))
+		{
+			nal_end--;
+		}
+
+		if(nal_end <= nal_offset)
+		{
+			continue;
+		}
+
+		auto nal_type = static_cast<H264NalType>(buffer[nal_offset] & 0x1F);
+		bool is_slice = (nal_type == H264NalType::Slice) || (nal_type == H264NalType::IdrSlice);
+
+		if(has_slice)
+		{
+			// first_mb_in_slice == 0 (ue(v) of 0 is a single '1' bit): the first slice of a new picture
+			bool is_first_slice = is_slice && (nal_end - nal_offset > 1) && (buffer[nal_offset + 1] & 0x80);
+
+			if(is_first_slice || (nal_type == H264NalType::Aud) || (nal_type == H264NalType::Sps) ||
+			   (nal_type == H264NalType::Pps) || (nal_type == H264NalType::Sei))
+			{
+				flush_frame();
+			}
+		}
+
+		frame.data.insert(frame.data.end(), start_code, start_code + sizeof(start_code));
+		frame.data.insert(frame.data.end(), buffer.begin() + nal_offset, buffer.begin() + nal_end);
+
+		if(is_slice)
+		{
+			has_slice = true;
+		}
+
+		if(nal_type == H264NalType::IdrSlice)
+		{
+			frame.is_key_frame = true;
+		}
+	}
+
+	flush_frame();
+
+	logti("%zu video frames are read from %s", frames.size(), file_path.CStr());
+
+	return (frames.empty() == false);
+}
+
+bool ElementaryStreamReader::ReadAac(const ov::String &file_path, std::vector<ElementaryFrame> &frames, int32_t *sample_rate, int32_t *channels)
+{
+	std::vector<uint8_t> buffer;
+
+	if(ReadFile(file_path, buffer) == false)
+	{
+		return false;
+	}
+
+	size_t size = buffer.size();
+	size_t offset = 0;
+	int64_t sample_count = 0;
+
+	*sample_rate = 0;
+	*channels = 0;
+
+	while(offset + ADTS_HEADER_SIZE <= size)
+	{
+		const uint8_t *header = buffer.data() + offset;
+
+		// syncword: 0xFFF
+		if((header[0] != 0xFF) || ((header[1] & 0xF0) != 0xF0))
+		{
+			offset++;
+			continue;
+		}
+
+		int sample_rate_index = (header[2] >> 2) & 0x0F;
+		int channel_configuration = ((header[2] & 0x01) << 2) | (header[3] >> 6);
+		size_t frame_length = ((header[3] & 0x03) << 11) | (header[4] << 3) | (header[5] >> 5);
+		int block_count = (header[6] & 0x03) + 1;
+
+		if((sample_rate_index >= static_cast<int>(OV_COUNTOF(adts_sample_rates))) || (frame_length < ADTS_HEADER_SIZE) || (offset + frame_length > size))
+		{
+			offset++;
+			continue;
+		}
+
+		if(*sample_rate == 0)
+		{
+			*sample_rate = adts_sample_rates[sample_rate_index];
+			*channels = channel_configuration;
+		}
+
+		ElementaryFrame frame;
+
+		frame.media_type = common::MediaType::Audio;
+		frame.pts = sample_count * 1000 / *sample_rate;
+		frame.is_key_frame = true;
+		frame.data.assign(header, header + frame_length);
+
+		frames.push_back(std::move(frame));
+
+		sample_count += AAC_SAMPLES_PER_FRAME * block_count;
+		offset += frame_length;
+	}
+
+	logti("%zu audio frames are read from %s (%d Hz, %d channels)", frames.size(), file_path.CStr(), *sample_rate, *channels);
+
+	return (frames.empty() == false);
+}
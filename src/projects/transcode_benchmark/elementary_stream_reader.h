@@ -0,0 +1,41 @@
+//==============================================================================
+//
+//  TranscodeBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+#include <base/common_types.h>
+
+#include <memory>
+#include <vector>
+
+// A frame of the elementary stream (timestamp in milliseconds, same as the RTMP provider)
+struct ElementaryFrame
+{
+	common::MediaType media_type = common::MediaType::Unknown;
+	int64_t pts = 0;
+	bool is_key_frame = false;
+
+	std::vector<uint8_t> data;
+};
+
+// Splits the recorded elementary streams into the frames which are pushed to TranscodeStream
+//
+// - H.264: Annex-B byte stream, split into access units (AUD/SPS/PPS/SEI or the first slice of a picture)
+// - AAC: ADTS stream, each ADTS frame is a frame
+class ElementaryStreamReader
+{
+public:
+	// The timestamps are made from the frame rate, because the byte stream does not have them
+	static bool ReadH264(const ov::String &file_path, double frame_rate, std::vector<ElementaryFrame> &frames);
+
+	// sample_rate/channels: taken from the first ADTS header
+	static bool ReadAac(const ov::String &file_path, std::vector<ElementaryFrame> &frames, int32_t *sample_rate, int32_t *channels);
+
+protected:
+	static bool ReadFile(const ov::String &file_path, std::vector<uint8_t> &buffer);
+};
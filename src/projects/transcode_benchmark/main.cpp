@@ -0,0 +1,601 @@
+//==============================================================================
+//
+//  TranscodeBenchmark
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+#include <unistd.h>
+
+#include <config/config_manager.h>
+#include <transcode/transcode_application.h>
+#include <transcode/transcode_scheduler.h>
+#include <base/media_route/media_route_application_interface.h>
+#include <base/ovlibrary/log_write.h>
+#include <base/ovlibrary/json.h>
+
+#include "elementary_stream_reader.h"
+
+#define OV_LOG_TAG "TranscodeBenchmark"
+
+// The pushing is paused while the input queue of TranscodeStream has more packets than this
+#define BENCHMARK_MAX_PENDING_PACKETS		100
+// Interval to sample the queue depths and RSS (in milliseconds)
+#define BENCHMARK_SAMPLE_INTERVAL			100
+// The pipeline is drained if no packet is made during this period after all inputs are pushed (in milliseconds)
+#define BENCHMARK_DRAIN_IDLE_TIME			2000
+
+struct ParseOption
+{
+	// -c <config_path>
+	ov::String config_path = "";
+	// -n <application name> (default: the first application which has <Encodes>)
+	ov::String application_name = "";
+
+	// -v <H.264 Annex-B file>, -a <AAC ADTS file>
+	ov::String video_path = "";
+	ov::String audio_path = "";
+
+	// -s <width>x<height>, -f <frame rate> (the byte stream does not have them)
+	uint32_t video_width = 1280;
+	uint32_t video_height = 720;
+	double video_frame_rate = 30.0;
+
+	// -l <loop count> (each loop continues the timestamps of the previous loop)
+	int loop_count = 1;
+	// -r: push the frames in real time (soak), otherwise as fast as the transcoder can process
+	bool real_time = false;
+	// -i <seconds>: prints the statistics periodically (0: only at the end)
+	int report_interval = 0;
+
+	// -o <json path> (default: stdout)
+	ov::String output_path = "";
+};
+
+bool TryParseOption(int argc, char *argv[], ParseOption *parse_option)
+{
+	constexpr const char *opt_string = "hc:n:v:a:s:f:l:ri:o:";
+
+	while(true)
+	{
+		int name = getopt(argc, argv, opt_string);
+
+		switch(name)
+		{
+			case -1:
+				// end of arguments
+				return (parse_option->video_path.IsEmpty() == false) || (parse_option->audio_path.IsEmpty() == false);
+
+			case 'c':
+				parse_option->config_path = optarg;
+				break;
+
+			case 'n':
+				parse_option->application_name = optarg;
+				break;
+
+			case 'v':
+				parse_option->video_path = optarg;
+				break;
+
+			case 'a':
+				parse_option->audio_path = optarg;
+				break;
+
+			case 's':
+				if(::sscanf(optarg, "%ux%u", &(parse_option->video_width), &(parse_option->video_height)) != 2)
+				{
+					return false;
+				}
+				break;
+
+			case 'f':
+				parse_option->video_frame_rate = ::atof(optarg);
+				break;
+
+			case 'l':
+				parse_option->loop_count = std::max(::atoi(optarg), 1);
+				break;
+
+			case 'r':
+				parse_option->real_time = true;
+				break;
+
+			case 'i':
+				parse_option->report_interval = std::max(::atoi(optarg), 0);
+				break;
+
+			case 'o':
+				parse_option->output_path = optarg;
+				break;
+
+			case 'h':
+			default: // '?'
+				printf("Usage: %s [OPTION]...\n", argv[0]);
+				printf("    -c <path>             Specify a path of config files\n");
+				printf("    -n <name>             Application to benchmark (default: the first application with <Encodes>)\n");
+				printf("    -v <path>             H.264 Annex-B elementary stream\n");
+				printf("    -a <path>             AAC ADTS elementary stream\n");
+				printf("    -s <width>x<height>   Resolution of the video (default: 1280x720)\n");
+				printf("    -f <fps>              Frame rate of the video (default: 30)\n");
+				printf("    -l <count>            Number of loops of the inputs (default: 1)\n");
+				printf("    -r                    Push the frames in real time (soak test)\n");
+				printf("    -i <seconds>          Print the statistics periodically\n");
+				printf("    -o <path>             Path of the JSON result (default: stdout)\n");
+				return false;
+		}
+	}
+}
+
+int64_t GetCurrentMilliseconds()
+{
+	return TranscodeStageStatistics::GetCurrentMicroseconds() / 1000;
+}
+
+// Resident set size of the process (in bytes)
+uint64_t GetResidentSetSize()
+{
+	std::ifstream statm("/proc/self/statm");
+	uint64_t total_pages = 0;
+	uint64_t resident_pages = 0;
+
+	statm >> total_pages >> resident_pages;
+
+	if(statm.fail())
+	{
+		return 0;
+	}
+
+	return resident_pages * static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+}
+
+// Receives the output streams of the transcoder instead of MediaRouter
+class BenchmarkRouteApplication : public MediaRouteApplicationInterface
+{
+public:
+	bool OnCreateStream(std::shared_ptr<MediaRouteApplicationConnector> application, std::shared_ptr<StreamInfo> stream) override
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		_stream_names[stream->GetId()] = stream->GetName();
+
+		return true;
+	}
+
+	bool OnDeleteStream(std::shared_ptr<MediaRouteApplicationConnector> application, std::shared_ptr<StreamInfo> stream) override
+	{
+		return true;
+	}
+
+	bool OnReceiveBuffer(std::shared_ptr<MediaRouteApplicationConnector> application, std::shared_ptr<StreamInfo> stream, std::unique_ptr<MediaPacket> packet) override
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		auto &output = _outputs[stream->GetId()][packet->GetTrackId()];
+
+		output.packet_count++;
+		output.byte_count += packet->GetData()->GetLength();
+
+		if(packet->GetFlags() == MediaPacketFlag::Key)
+		{
+			output.key_frame_count++;
+		}
+
+		_total_packet_count++;
+
+		return true;
+	}
+
+	std::shared_ptr<RelayClient> GetOriginConnector() override
+	{
+		return nullptr;
+	}
+
+	const std::map<uint32_t, std::shared_ptr<MediaRouteStream>> GetStreams() const override
+	{
+		return {};
+	}
+
+	uint64_t GetTotalPacketCount()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		return _total_packet_count;
+	}
+
+	Json::Value ToJson()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		Json::Value outputs(Json::ValueType::objectValue);
+
+		for(const auto &stream_item : _outputs)
+		{
+			Json::Value &stream_value = outputs[_stream_names[stream_item.first].CStr()];
+
+			for(const auto &track_item : stream_item.second)
+			{
+				Json::Value &track_value = stream_value[ov::Converter::ToString(static_cast<int>(track_item.first)).CStr()];
+
+				track_value["packets"] = static_cast<Json::UInt64>(track_item.second.packet_count);
+				track_value["key_frames"] = static_cast<Json::UInt64>(track_item.second.key_frame_count);
+				track_value["bytes"] = static_cast<Json::UInt64>(track_item.second.byte_count);
+			}
+		}
+
+		return outputs;
+	}
+
+protected:
+	struct OutputTrack
+	{
+		uint64_t packet_count = 0;
+		uint64_t key_frame_count = 0;
+		uint64_t byte_count = 0;
+	};
+
+	std::mutex _mutex;
+
+	std::map<uint32_t, ov::String> _stream_names;
+	std::map<uint32_t, std::map<int32_t, OutputTrack>> _outputs;
+	uint64_t _total_packet_count = 0;
+};
+
+// Queue depths and RSS sampled every BENCHMARK_SAMPLE_INTERVAL
+struct BenchmarkSamples
+{
+	uint64_t sample_count = 0;
+
+	size_t max_queue_size[static_cast<int>(TranscodeStream::Stage::NumberOfStages)] = {};
+	uint64_t total_queue_size[static_cast<int>(TranscodeStream::Stage::NumberOfStages)] = {};
+
+	uint64_t start_rss = 0;
+	uint64_t peak_rss = 0;
+	uint64_t last_rss = 0;
+
+	void Sample(const std::shared_ptr<TranscodeStream> &stream)
+	{
+		for(int stage = 0; stage < static_cast<int>(TranscodeStream::Stage::NumberOfStages); stage++)
+		{
+			size_t queue_size = stream->GetStageQueueSize(static_cast<TranscodeStream::Stage>(stage));
+
+			max_queue_size[stage] = std::max(max_queue_size[stage], queue_size);
+			total_queue_size[stage] += queue_size;
+		}
+
+		last_rss = GetResidentSetSize();
+		peak_rss = std::max(peak_rss, last_rss);
+
+		sample_count++;
+	}
+};
+
+Json::Value MakeResult(const ParseOption &parse_option, const std::shared_ptr<TranscodeStream> &stream, const BenchmarkSamples &samples,
+                       const std::shared_ptr<BenchmarkRouteApplication> &route_application, size_t pushed_packet_count, int64_t elapsed)
+{
+	Json::Value result(Json::ValueType::objectValue);
+
+	Json::Value &input = result["input"];
+	input["video"] = parse_option.video_path.CStr();
+	input["audio"] = parse_option.audio_path.CStr();
+	input["loops"] = parse_option.loop_count;
+	input["real_time"] = parse_option.real_time;
+	input["packets"] = static_cast<Json::UInt64>(pushed_packet_count);
+
+	result["elapsed_ms"] = static_cast<Json::Int64>(elapsed);
+	result["workers"] = TranscodeScheduler::Instance()->GetWorkerCount();
+
+	Json::Value &stages = result["stages"];
+
+	for(int stage = 0; stage < static_cast<int>(TranscodeStream::Stage::NumberOfStages); stage++)
+	{
+		auto stage_type = static_cast<TranscodeStream::Stage>(stage);
+		const auto &statistics = stream->GetStageStatistics(stage_type);
+		Json::Value &stage_value = stages[ov::String(TranscodeStream::GetStageName(stage_type)).LowerCaseString().CStr()];
+
+		stage_value["frames"] = static_cast<Json::UInt64>(statistics.GetFrameCount());
+		stage_value["fps"] = statistics.GetFps();
+
+		Json::Value &latency = stage_value["latency_us"];
+		latency["p50"] = static_cast<Json::Int64>(statistics.GetLatencyPercentile(50.0));
+		latency["p90"] = static_cast<Json::Int64>(statistics.GetLatencyPercentile(90.0));
+		latency["p99"] = static_cast<Json::Int64>(statistics.GetLatencyPercentile(99.0));
+		latency["max"] = static_cast<Json::Int64>(statistics.GetMaxLatency());
+
+		Json::Value &queue = stage_value["queue"];
+		queue["current"] = static_cast<Json::UInt64>(stream->GetStageQueueSize(stage_type));
+		queue["max"] = static_cast<Json::UInt64>(samples.max_queue_size[stage]);
+		queue["average"] = (samples.sample_count > 0) ? (static_cast<double>(samples.total_queue_size[stage]) / samples.sample_count) : 0.0;
+	}
+
+	// Time from SendBuffer() to the encoded packet of each video encoder
+	Json::Value &encoders = result["encoders"];
+	encoders = Json::Value(Json::ValueType::objectValue);
+
+	for(const auto &statistics_item : stream->GetEncoderStatistics())
+	{
+		const auto &statistics = *(statistics_item.second);
+		Json::Value &encoder_value = encoders[ov::Converter::ToString(static_cast<int>(statistics_item.first)).CStr()];
+
+		encoder_value["frames"] = static_cast<Json::UInt64>(statistics.GetFrameCount());
+
+		Json::Value &latency = encoder_value["latency_us"];
+		latency["p50"] = static_cast<Json::Int64>(statistics.GetLatencyPercentile(50.0));
+		latency["p90"] = static_cast<Json::Int64>(statistics.GetLatencyPercentile(90.0));
+		latency["p99"] = static_cast<Json::Int64>(statistics.GetLatencyPercentile(99.0));
+		latency["max"] = static_cast<Json::Int64>(statistics.GetMaxLatency());
+	}
+
+	Json::Value &rss = result["rss_bytes"];
+	rss["start"] = static_cast<Json::UInt64>(samples.start_rss);
+	rss["peak"] = static_cast<Json::UInt64>(samples.peak_rss);
+	rss["last"] = static_cast<Json::UInt64>(samples.last_rss);
+
+	result["outputs"] = route_application->ToJson();
+
+	return result;
+}
+
+const cfg::Application *FindApplication(const std::vector<cfg::Host> &hosts, const ov::String &application_name, const cfg::Host **found_host)
+{
+	for(const auto &host : hosts)
+	{
+		for(const auto &application : host.GetApplications())
+		{
+			bool is_matched = application_name.IsEmpty() ? (application.GetEncodes().empty() == false) : (application.GetName() == application_name);
+
+			if(is_matched)
+			{
+				*found_host = &host;
+				return &application;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+int main(int argc, char *argv[])
+{
+	ParseOption parse_option;
+
+	if(TryParseOption(argc, argv, &parse_option) == false)
+	{
+		return 1;
+	}
+
+	ov::LogWrite::Initialize(false);
+
+	if(cfg::ConfigManager::Instance()->LoadConfigs(parse_option.config_path) == false)
+	{
+		logte("An error occurred while load config");
+		return 1;
+	}
+
+	auto hosts = cfg::ConfigManager::Instance()->GetServer()->GetHosts();
+	const cfg::Host *host = nullptr;
+	auto application = FindApplication(hosts, parse_option.application_name, &host);
+
+	if(application == nullptr)
+	{
+		logte("Could not find the application to benchmark (%s)", parse_option.application_name.CStr());
+		return 1;
+	}
+
+	info::Application application_info(*application);
+
+	// Reads all inputs before the measurement, so that the disk I/O is not measured
+	std::vector<ElementaryFrame> video_frames;
+	std::vector<ElementaryFrame> audio_frames;
+	int32_t audio_sample_rate = 0;
+	int32_t audio_channels = 0;
+
+	if((parse_option.video_path.IsEmpty() == false) &&
+	   (ElementaryStreamReader::ReadH264(parse_option.video_path, parse_option.video_frame_rate, video_frames) == false))
+	{
+		logte("Could not read the video: %s", parse_option.video_path.CStr());
+		return 1;
+	}
+
+	if((parse_option.audio_path.IsEmpty() == false) &&
+	   (ElementaryStreamReader::ReadAac(parse_option.audio_path, audio_frames, &audio_sample_rate, &audio_channels) == false))
+	{
+		logte("Could not read the audio: %s", parse_option.audio_path.CStr());
+		return 1;
+	}
+
+	// Merges the inputs in the order of the timestamps
+	std::vector<const ElementaryFrame *> frames;
+	int64_t loop_duration = 0;
+
+	for(const auto *frame_list : { &video_frames, &audio_frames })
+	{
+		for(const auto &frame : *frame_list)
+		{
+			frames.push_back(&frame);
+		}
+
+		if(frame_list->size() > 1)
+		{
+			// The duration of the last frame is the same as the previous one
+			int64_t duration = frame_list->back().pts + (frame_list->back().pts - (*frame_list)[frame_list->size() - 2].pts);
+			loop_duration = std::max(loop_duration, duration);
+		}
+	}
+
+	std::stable_sort(frames.begin(), frames.end(), [](const ElementaryFrame *frame1, const ElementaryFrame *frame2) -> bool {
+		return frame1->pts < frame2->pts;
+	});
+
+	TranscodeScheduler::Instance()->SetWorkerCount(host->GetTranscodeWorkerCount());
+
+	if(TranscodeScheduler::Instance()->Start() == false)
+	{
+		return 1;
+	}
+
+	auto route_application = std::make_shared<BenchmarkRouteApplication>();
+	auto transcode_application = TranscodeApplication::Create(&application_info);
+
+	transcode_application->SetMediaRouterApplication(route_application);
+
+	// The same tracks as the RTMP provider
+	auto stream_info = std::make_shared<StreamInfo>();
+	stream_info->SetName("benchmark");
+
+	if(video_frames.empty() == false)
+	{
+		auto new_track = std::make_shared<MediaTrack>();
+
+		new_track->SetId(static_cast<uint32_t>(common::MediaType::Video));
+		new_track->SetMediaType(common::MediaType::Video);
+		new_track->SetCodecId(common::MediaCodecId::H264);
+		new_track->SetWidth(parse_option.video_width);
+		new_track->SetHeight(parse_option.video_height);
+		new_track->SetFrameRate(parse_option.video_frame_rate);
+		new_track->SetTimeBase(1, 1000);
+
+		stream_info->AddTrack(new_track);
+	}
+
+	if(audio_frames.empty() == false)
+	{
+		auto new_track = std::make_shared<MediaTrack>();
+
+		new_track->SetId(static_cast<uint32_t>(common::MediaType::Audio));
+		new_track->SetMediaType(common::MediaType::Audio);
+		new_track->SetCodecId(common::MediaCodecId::Aac);
+		new_track->SetSampleRate(audio_sample_rate);
+		new_track->SetTimeBase(1, 1000);
+		new_track->GetSample().SetFormat(common::AudioSample::Format::S16);
+		new_track->GetChannel().SetLayout((audio_channels == 1) ? common::AudioChannel::Layout::LayoutMono : common::AudioChannel::Layout::LayoutStereo);
+
+		stream_info->AddTrack(new_track);
+	}
+
+	transcode_application->OnCreateStream(stream_info);
+
+	auto stream = transcode_application->GetStream(stream_info->GetId());
+
+	if(stream == nullptr)
+	{
+		logte("Could not create the transcode stream");
+		return 1;
+	}
+
+	BenchmarkSamples samples;
+	samples.start_rss = GetResidentSetSize();
+
+	int64_t start_time = GetCurrentMilliseconds();
+	int64_t last_sample_time = start_time;
+	int64_t last_report_time = start_time;
+	size_t pushed_packet_count = 0;
+
+	auto sample = [&](int64_t now) {
+		if((now - last_sample_time) >= BENCHMARK_SAMPLE_INTERVAL)
+		{
+			samples.Sample(stream);
+			last_sample_time = now;
+		}
+
+		if((parse_option.report_interval > 0) && ((now - last_report_time) >= (parse_option.report_interval * 1000)))
+		{
+			// One line per report, so that the soak results can be collected by line
+			logti("Report: %s", ov::Json::Stringify(MakeResult(parse_option, stream, samples, route_application, pushed_packet_count, now - start_time)).Replace("\n", "").CStr());
+			last_report_time = now;
+		}
+	};
+
+	for(int loop = 0; loop < parse_option.loop_count; loop++)
+	{
+		int64_t pts_offset = loop * loop_duration;
+
+		for(const auto *frame : frames)
+		{
+			int64_t pts = frame->pts + pts_offset;
+
+			while(true)
+			{
+				int64_t now = GetCurrentMilliseconds();
+
+				sample(now);
+
+				bool is_ready = parse_option.real_time ? ((now - start_time) >= pts) : (stream->GetStageQueueSize(TranscodeStream::Stage::Decode) < BENCHMARK_MAX_PENDING_PACKETS);
+
+				if(is_ready)
+				{
+					break;
+				}
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+			auto packet = std::make_unique<MediaPacket>(frame->media_type,
+			                                            static_cast<int32_t>(frame->media_type),
+			                                            frame->data.data(),
+			                                            static_cast<int32_t>(frame->data.size()),
+			                                            pts,
+			                                            frame->is_key_frame ? MediaPacketFlag::Key : MediaPacketFlag::NoFlag);
+
+			transcode_application->OnSendFrame(stream_info, std::move(packet));
+			pushed_packet_count++;
+		}
+	}
+
+	// Waits until all stages are drained
+	uint64_t last_packet_count = route_application->GetTotalPacketCount();
+	int64_t last_output_time = GetCurrentMilliseconds();
+
+	while(true)
+	{
+		int64_t now = GetCurrentMilliseconds();
+		uint64_t packet_count = route_application->GetTotalPacketCount();
+
+		sample(now);
+
+		if(packet_count != last_packet_count)
+		{
+			last_packet_count = packet_count;
+			last_output_time = now;
+		}
+		else if((now - last_output_time) >= BENCHMARK_DRAIN_IDLE_TIME)
+		{
+			break;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	// The idle time is not a part of the measurement
+	int64_t elapsed = last_output_time - start_time;
+
+	auto result = ov::Json::Stringify(MakeResult(parse_option, stream, samples, route_application, pushed_packet_count, elapsed));
+
+	transcode_application->OnDeleteStream(stream_info);
+	stream = nullptr;
+
+	TranscodeScheduler::Instance()->Stop();
+
+	if(parse_option.output_path.IsEmpty())
+	{
+		printf("%s\n", result.CStr());
+	}
+	else
+	{
+		std::ofstream output(parse_option.output_path.CStr());
+
+		if(output.is_open() == false)
+		{
+			logte("Could not open the output: %s", parse_option.output_path.CStr());
+			return 1;
+		}
+
+		output << result.CStr() << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,877 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "vod_mp4_file.h"
+#include "vod_private.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#define VOD_MP4_BOX_HEADER_SIZE				(8)		// size(4) + type(4)
+#define VOD_MP4_BOX_LARGE_HEADER_SIZE		(16)	// size(4) + type(4) + large size(8)
+#define VOD_MP4_FULL_BOX_HEADER_SIZE		(4)		// version(1) + flags(3)
+
+// Size of the fields of the sample entries before the child boxes
+#define VOD_MP4_VISUAL_SAMPLE_ENTRY_SIZE	(78)
+#define VOD_MP4_AUDIO_SAMPLE_ENTRY_SIZE		(28)
+
+static const uint32_t g_vod_sample_rate_table[] = {96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350, 0, 0, 0};
+
+// The samples of the file are referred with the file, so the file is kept mapped while they are being sent
+struct VodMappedData
+{
+	VodMappedData(const std::shared_ptr<VodMp4File> &file_, const void *data_, size_t length_)
+		: file(file_),
+		  data(data_, length_, true)
+	{
+	}
+
+	std::shared_ptr<VodMp4File> file;
+	ov::Data data;
+};
+
+static inline uint16_t ReadUint16(const uint8_t *data)
+{
+	return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+static inline uint32_t ReadUint32(const uint8_t *data)
+{
+	return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | data[3];
+}
+
+static inline uint64_t ReadUint64(const uint8_t *data)
+{
+	return (static_cast<uint64_t>(ReadUint32(data)) << 32) | ReadUint32(data + 4);
+}
+
+static constexpr uint32_t BoxType(const char *type)
+{
+	return (static_cast<uint32_t>(type[0]) << 24) | (static_cast<uint32_t>(type[1]) << 16) | (static_cast<uint32_t>(type[2]) << 8) | static_cast<uint32_t>(type[3]);
+}
+
+//====================================================================================================
+// Box of [position, end)
+// - payload : after the header, position : the next box
+//====================================================================================================
+static bool NextBox(const uint8_t *&position, const uint8_t *end, uint32_t &type, const uint8_t *&payload, size_t &payload_size)
+{
+	size_t rest_size = end - position;
+
+	if(rest_size < VOD_MP4_BOX_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	uint64_t box_size = ReadUint32(position);
+	size_t header_size = VOD_MP4_BOX_HEADER_SIZE;
+
+	type = ReadUint32(position + 4);
+
+	if(box_size == 1)
+	{
+		if(rest_size < VOD_MP4_BOX_LARGE_HEADER_SIZE)
+		{
+			return false;
+		}
+
+		box_size = ReadUint64(position + 8);
+		header_size = VOD_MP4_BOX_LARGE_HEADER_SIZE;
+	}
+	else if(box_size == 0)
+	{
+		// The box extends to the end of the file
+		box_size = rest_size;
+	}
+
+	if((box_size < header_size) || (box_size > rest_size))
+	{
+		return false;
+	}
+
+	payload = position + header_size;
+	payload_size = box_size - header_size;
+	position += box_size;
+
+	return true;
+}
+
+static bool FindBox(const uint8_t *data, size_t size, uint32_t type, const uint8_t *&payload, size_t &payload_size)
+{
+	const uint8_t *position = data;
+	const uint8_t *end = data + size;
+	uint32_t box_type;
+
+	while(NextBox(position, end, box_type, payload, payload_size))
+	{
+		if(box_type == type)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//====================================================================================================
+// Descriptor of esds (ISO/IEC 14496-1)
+// - the length is written with 1~4 bytes (7 bits per byte)
+//====================================================================================================
+static bool NextDescriptor(const uint8_t *&position, const uint8_t *end, uint8_t &tag, const uint8_t *&payload, size_t &payload_size)
+{
+	if(position >= end)
+	{
+		return false;
+	}
+
+	tag = *position++;
+
+	size_t length = 0;
+
+	for(int index = 0; index < 4; index++)
+	{
+		if(position >= end)
+		{
+			return false;
+		}
+
+		uint8_t value = *position++;
+		length = (length << 7) | (value & 0x7F);
+
+		if((value & 0x80) == 0)
+		{
+			break;
+		}
+	}
+
+	if(length > static_cast<size_t>(end - position))
+	{
+		return false;
+	}
+
+	payload = position;
+	payload_size = length;
+	position += length;
+
+	return true;
+}
+
+//====================================================================================================
+// Open
+// - the sample index is made from moov (the samples are read when they are packaged)
+//====================================================================================================
+std::shared_ptr<VodMp4File> VodMp4File::Open(const ov::String &path, uint32_t segment_duration)
+{
+	auto file = std::make_shared<VodMp4File>();
+
+	if(file->Map(path) == false)
+	{
+		return nullptr;
+	}
+
+	const uint8_t *moov = nullptr;
+	size_t moov_size = 0;
+
+	if(FindBox(file->_mapped_data, file->_mapped_size, BoxType("moov"), moov, moov_size) == false)
+	{
+		logte("Could not find moov: %s", path.CStr());
+		return nullptr;
+	}
+
+	if(file->ParseMoov(moov, moov_size) == false)
+	{
+		logte("Could not find any H.264/AAC track: %s", path.CStr());
+		return nullptr;
+	}
+
+	file->MakeSegments(std::max(segment_duration, 1U));
+
+	logti("VOD file is opened: %s (video: %zu samples, audio: %zu samples, %zu segments, %.3f seconds)",
+		  path.CStr(), file->_video_track.samples.size(), file->_audio_track.samples.size(),
+		  file->_segments.size(), file->_duration);
+
+	return file;
+}
+
+VodMp4File::~VodMp4File()
+{
+	if(_mapped_data != nullptr)
+	{
+		::munmap(_mapped_data, _mapped_size);
+		_mapped_data = nullptr;
+	}
+}
+
+bool VodMp4File::Map(const ov::String &path)
+{
+	int fd = ::open(path.CStr(), O_RDONLY | O_CLOEXEC);
+
+	if(fd < 0)
+	{
+		logtd("Could not open %s: %s", path.CStr(), ::strerror(errno));
+		return false;
+	}
+
+	struct stat file_stat {};
+
+	if((::fstat(fd, &file_stat) != 0) || (file_stat.st_size <= 0))
+	{
+		logte("Could not get the size of %s", path.CStr());
+		::close(fd);
+		return false;
+	}
+
+	void *mapped_data = ::mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping is kept after the file is closed
+	::close(fd);
+
+	if(mapped_data == MAP_FAILED)
+	{
+		logte("Could not map %s: %s", path.CStr(), ::strerror(errno));
+		return false;
+	}
+
+	_path = path;
+	_modified_time = file_stat.st_mtim;
+	_file_size = file_stat.st_size;
+	_mapped_data = static_cast<uint8_t *>(mapped_data);
+	_mapped_size = static_cast<size_t>(file_stat.st_size);
+
+	return true;
+}
+
+bool VodMp4File::IsModified(const struct stat &file_stat) const
+{
+	return (file_stat.st_size != _file_size) ||
+		   (file_stat.st_mtim.tv_sec != _modified_time.tv_sec) ||
+		   (file_stat.st_mtim.tv_nsec != _modified_time.tv_nsec);
+}
+
+std::shared_ptr<const ov::Data> VodMp4File::GetMappedData(uint64_t offset, size_t length)
+{
+	if((length == 0) || (offset > _mapped_size) || (length > (_mapped_size - offset)))
+	{
+		return nullptr;
+	}
+
+	auto mapped_data = std::make_shared<VodMappedData>(GetSharedPtr(), _mapped_data + offset, length);
+
+	// Aliasing: the data is released with the holder
+	return std::shared_ptr<const ov::Data>(mapped_data, &(mapped_data->data));
+}
+
+//====================================================================================================
+// moov(Movie)
+// - the first H.264 track and the first AAC track are used
+//====================================================================================================
+bool VodMp4File::ParseMoov(const uint8_t *data, size_t size)
+{
+	const uint8_t *position = data;
+	const uint8_t *end = data + size;
+	uint32_t type;
+	const uint8_t *payload;
+	size_t payload_size;
+
+	while(NextBox(position, end, type, payload, payload_size))
+	{
+		if(type == BoxType("trak"))
+		{
+			ParseTrak(payload, payload_size);
+		}
+	}
+
+	return (GetVideoTrack() != nullptr) || (GetAudioTrack() != nullptr);
+}
+
+bool VodMp4File::ParseTrak(const uint8_t *data, size_t size)
+{
+	const uint8_t *box;
+	size_t box_size;
+	const uint8_t *mdia;
+	size_t mdia_size;
+	VodTrack track;
+
+	// tkhd(Track Header)
+	if(FindBox(data, size, BoxType("tkhd"), box, box_size) && (box_size >= 24))
+	{
+		track.track_id = (box[0] == 1) ? ReadUint32(box + 20) : ReadUint32(box + 12);
+	}
+
+	if(FindBox(data, size, BoxType("mdia"), mdia, mdia_size) == false)
+	{
+		return false;
+	}
+
+	// mdhd(Media Header)
+	if(FindBox(mdia, mdia_size, BoxType("mdhd"), box, box_size) == false)
+	{
+		return false;
+	}
+
+	if((box_size >= 32) && (box[0] == 1))
+	{
+		track.timescale = ReadUint32(box + 20);
+	}
+	else if(box_size >= 20)
+	{
+		track.timescale = ReadUint32(box + 12);
+	}
+
+	if(track.timescale == 0)
+	{
+		return false;
+	}
+
+	// hdlr(Handler Reference)
+	if((FindBox(mdia, mdia_size, BoxType("hdlr"), box, box_size) == false) || (box_size < 12))
+	{
+		return false;
+	}
+
+	uint32_t handler_type = ReadUint32(box + 8);
+
+	if(handler_type == BoxType("vide"))
+	{
+		if(GetVideoTrack() != nullptr)
+		{
+			// The other video tracks are ignored
+			return false;
+		}
+
+		track.is_video = true;
+	}
+	else if(handler_type == BoxType("soun"))
+	{
+		if(GetAudioTrack() != nullptr)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		return false;
+	}
+
+	const uint8_t *minf;
+	size_t minf_size;
+	const uint8_t *stbl;
+	size_t stbl_size;
+
+	if((FindBox(mdia, mdia_size, BoxType("minf"), minf, minf_size) == false) ||
+	   (FindBox(minf, minf_size, BoxType("stbl"), stbl, stbl_size) == false))
+	{
+		return false;
+	}
+
+	if((FindBox(stbl, stbl_size, BoxType("stsd"), box, box_size) == false) ||
+	   (ParseStsd(box, box_size, track) == false))
+	{
+		return false;
+	}
+
+	if(ParseStbl(stbl, stbl_size, track) == false)
+	{
+		logtw("Invalid sample table of the track %u: %s", track.track_id, _path.CStr());
+		return false;
+	}
+
+	if(track.is_video)
+	{
+		_video_track = std::move(track);
+	}
+	else
+	{
+		_audio_track = std::move(track);
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// stsd(Sample Description)
+// - avc1(avcC) / mp4a(esds)
+//====================================================================================================
+bool VodMp4File::ParseStsd(const uint8_t *data, size_t size, VodTrack &track)
+{
+	if(size < (VOD_MP4_FULL_BOX_HEADER_SIZE + 4))
+	{
+		return false;
+	}
+
+	const uint8_t *position = data + VOD_MP4_FULL_BOX_HEADER_SIZE + 4;
+	uint32_t type;
+	const uint8_t *entry;
+	size_t entry_size;
+	const uint8_t *box;
+	size_t box_size;
+
+	if(NextBox(position, data + size, type, entry, entry_size) == false)
+	{
+		return false;
+	}
+
+	if(track.is_video)
+	{
+		if((type != BoxType("avc1")) || (entry_size < VOD_MP4_VISUAL_SAMPLE_ENTRY_SIZE))
+		{
+			logtw("Unsupported video codec (%.4s): %s", reinterpret_cast<const char *>(entry - 4), _path.CStr());
+			return false;
+		}
+
+		track.width = ReadUint16(entry + 24);
+		track.height = ReadUint16(entry + 26);
+
+		return FindBox(entry + VOD_MP4_VISUAL_SAMPLE_ENTRY_SIZE, entry_size - VOD_MP4_VISUAL_SAMPLE_ENTRY_SIZE, BoxType("avcC"), box, box_size) &&
+			   ParseAvcC(box, box_size, track);
+	}
+
+	if((type != BoxType("mp4a")) || (entry_size < VOD_MP4_AUDIO_SAMPLE_ENTRY_SIZE))
+	{
+		logtw("Unsupported audio codec (%.4s): %s", reinterpret_cast<const char *>(entry - 4), _path.CStr());
+		return false;
+	}
+
+	// QuickTime sound sample description version 1/2 have more fields
+	uint16_t version = ReadUint16(entry + 8);
+	size_t entry_header_size = VOD_MP4_AUDIO_SAMPLE_ENTRY_SIZE + ((version == 1) ? 16 : ((version == 2) ? 36 : 0));
+
+	if(entry_size < entry_header_size)
+	{
+		return false;
+	}
+
+	track.audio_channels = ReadUint16(entry + 16);
+	track.audio_sample_rate = ReadUint32(entry + 24) >> 16;
+
+	return FindBox(entry + entry_header_size, entry_size - entry_header_size, BoxType("esds"), box, box_size) &&
+		   ParseEsds(box, box_size, track);
+}
+
+//====================================================================================================
+// avcC(AVC Decoder Configuration Record)
+//====================================================================================================
+bool VodMp4File::ParseAvcC(const uint8_t *data, size_t size, VodTrack &track)
+{
+	if(size < 7)
+	{
+		return false;
+	}
+
+	track.avc_profile = data[1];
+	track.avc_compatibility = data[2];
+	track.avc_level = data[3];
+	track.nal_length_size = static_cast<uint8_t>((data[4] & 0x03) + 1);
+
+	size_t position = 5;
+
+	// SPS, PPS
+	for(int list_index = 0; list_index < 2; list_index++)
+	{
+		if(position >= size)
+		{
+			return false;
+		}
+
+		int count = (list_index == 0) ? (data[position] & 0x1F) : data[position];
+		position++;
+
+		for(int index = 0; index < count; index++)
+		{
+			if((position + 2) > size)
+			{
+				return false;
+			}
+
+			size_t length = ReadUint16(data + position);
+			position += 2;
+
+			if((position + length) > size)
+			{
+				return false;
+			}
+
+			auto &parameter_set = (list_index == 0) ? track.sps : track.pps;
+
+			if((parameter_set == nullptr) && (length > 0))
+			{
+				parameter_set = std::make_shared<std::vector<uint8_t>>(data + position, data + position + length);
+			}
+
+			position += length;
+		}
+	}
+
+	return (track.sps != nullptr) && (track.pps != nullptr);
+}
+
+//====================================================================================================
+// esds(Elementary Stream Descriptor)
+// - ES_Descriptor(3) > DecoderConfigDescriptor(4) > DecoderSpecificInfo(5): AudioSpecificConfig
+//====================================================================================================
+bool VodMp4File::ParseEsds(const uint8_t *data, size_t size, VodTrack &track)
+{
+	if(size < VOD_MP4_FULL_BOX_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	const uint8_t *position = data + VOD_MP4_FULL_BOX_HEADER_SIZE;
+	uint8_t tag;
+	const uint8_t *payload;
+	size_t payload_size;
+
+	if((NextDescriptor(position, data + size, tag, payload, payload_size) == false) || (tag != 3) || (payload_size < 3))
+	{
+		return false;
+	}
+
+	// ES_ID(2) + flags(1) + optional fields
+	uint8_t flags = payload[2];
+	size_t skip_size = 3;
+
+	if(flags & 0x80)
+	{
+		// dependsOn_ES_ID
+		skip_size += 2;
+	}
+
+	if((flags & 0x40) && (skip_size < payload_size))
+	{
+		// URL
+		skip_size += 1 + payload[skip_size];
+	}
+
+	if(flags & 0x20)
+	{
+		// OCR_ES_Id
+		skip_size += 2;
+	}
+
+	if(skip_size > payload_size)
+	{
+		return false;
+	}
+
+	position = payload + skip_size;
+	const uint8_t *end = payload + payload_size;
+
+	// objectTypeIndication(1) + streamType(1) + bufferSizeDB(3) + maxBitrate(4) + avgBitrate(4)
+	if((NextDescriptor(position, end, tag, payload, payload_size) == false) || (tag != 4) || (payload_size < 13) || (payload[0] != 0x40))
+	{
+		logtw("Unsupported audio object type: %s", _path.CStr());
+		return false;
+	}
+
+	position = payload + 13;
+	end = payload + payload_size;
+
+	if((NextDescriptor(position, end, tag, payload, payload_size) == false) || (tag != 5) || (payload_size < 2))
+	{
+		return false;
+	}
+
+	// AudioSpecificConfig: object type(5) + frequency index(4) + channel configuration(4)
+	uint8_t object_type = payload[0] >> 3;
+	uint8_t sample_rate_index = static_cast<uint8_t>(((payload[0] & 0x07) << 1) | (payload[1] >> 7));
+	uint8_t channels = (payload[1] >> 3) & 0x0F;
+
+	if((object_type == 0) || (object_type == 31) || (g_vod_sample_rate_table[sample_rate_index] == 0))
+	{
+		logtw("Unsupported AudioSpecificConfig (object type: %d, frequency index: %d): %s", object_type, sample_rate_index, _path.CStr());
+		return false;
+	}
+
+	track.audio_object_type = object_type;
+	track.audio_sample_rate_index = sample_rate_index;
+	track.audio_sample_rate = g_vod_sample_rate_table[sample_rate_index];
+
+	if(channels != 0)
+	{
+		track.audio_channels = channels;
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// stbl(Sample Table)
+// - stsz(size), stts(decoding time), ctts(composition offset), stss(sync sample), stsc/stco/co64(offset)
+//====================================================================================================
+bool VodMp4File::ParseStbl(const uint8_t *data, size_t size, VodTrack &track)
+{
+	const uint8_t *box;
+	size_t box_size;
+
+	// stsz(Sample Size)
+	if((FindBox(data, size, BoxType("stsz"), box, box_size) == false) || (box_size < 12))
+	{
+		return false;
+	}
+
+	uint32_t fixed_size = ReadUint32(box + 4);
+	uint32_t sample_count = ReadUint32(box + 8);
+
+	if((sample_count == 0) || (sample_count > VOD_MP4_MAX_SAMPLE_COUNT) || ((fixed_size == 0) && (box_size < (12 + static_cast<size_t>(sample_count) * 4))))
+	{
+		return false;
+	}
+
+	auto &samples = track.samples;
+	samples.resize(sample_count);
+
+	for(uint32_t index = 0; index < sample_count; index++)
+	{
+		samples[index].size = (fixed_size != 0) ? fixed_size : ReadUint32(box + 12 + index * 4);
+		samples[index].composition_offset = 0;
+		samples[index].is_keyframe = true;
+	}
+
+	// stts(Decoding Time to Sample)
+	if((FindBox(data, size, BoxType("stts"), box, box_size) == false) || (box_size < 8))
+	{
+		return false;
+	}
+
+	uint32_t entry_count = ReadUint32(box + 4);
+	uint32_t sample_index = 0;
+	uint64_t dts = 0;
+
+	for(uint32_t entry_index = 0; (entry_index < entry_count) && ((8 + (entry_index + 1) * 8) <= box_size); entry_index++)
+	{
+		uint32_t count = ReadUint32(box + 8 + entry_index * 8);
+		uint32_t delta = ReadUint32(box + 8 + entry_index * 8 + 4);
+
+		for(uint32_t index = 0; (index < count) && (sample_index < sample_count); index++)
+		{
+			samples[sample_index++].dts = dts;
+			dts += delta;
+		}
+	}
+
+	if(sample_index < sample_count)
+	{
+		return false;
+	}
+
+	track.duration = dts;
+
+	// ctts(Composition Time to Sample), optional
+	if(FindBox(data, size, BoxType("ctts"), box, box_size) && (box_size >= 8))
+	{
+		entry_count = ReadUint32(box + 4);
+		sample_index = 0;
+
+		for(uint32_t entry_index = 0; (entry_index < entry_count) && ((8 + (entry_index + 1) * 8) <= box_size); entry_index++)
+		{
+			uint32_t count = ReadUint32(box + 8 + entry_index * 8);
+			// signed in version 1 (the offsets of version 0 don't exceed 2^31 in practice)
+			auto offset = static_cast<int32_t>(ReadUint32(box + 8 + entry_index * 8 + 4));
+
+			for(uint32_t index = 0; (index < count) && (sample_index < sample_count); index++)
+			{
+				samples[sample_index++].composition_offset = offset;
+			}
+		}
+	}
+
+	// stss(Sync Sample), optional: all the samples are sync samples if not exists
+	if(FindBox(data, size, BoxType("stss"), box, box_size) && (box_size >= 8))
+	{
+		entry_count = ReadUint32(box + 4);
+
+		for(auto &sample : samples)
+		{
+			sample.is_keyframe = false;
+		}
+
+		for(uint32_t entry_index = 0; (entry_index < entry_count) && ((8 + (entry_index + 1) * 4) <= box_size); entry_index++)
+		{
+			// 1-based
+			uint32_t number = ReadUint32(box + 8 + entry_index * 4);
+
+			if((number >= 1) && (number <= sample_count))
+			{
+				samples[number - 1].is_keyframe = true;
+			}
+		}
+	}
+
+	// stco(Chunk Offset) / co64(64-bit Chunk Offset)
+	const uint8_t *chunk_box;
+	size_t chunk_box_size;
+	size_t offset_size = 4;
+
+	if(FindBox(data, size, BoxType("co64"), chunk_box, chunk_box_size))
+	{
+		offset_size = 8;
+	}
+	else if(FindBox(data, size, BoxType("stco"), chunk_box, chunk_box_size) == false)
+	{
+		return false;
+	}
+
+	if(chunk_box_size < 8)
+	{
+		return false;
+	}
+
+	uint32_t chunk_count = ReadUint32(chunk_box + 4);
+
+	if(chunk_box_size < (8 + static_cast<size_t>(chunk_count) * offset_size))
+	{
+		return false;
+	}
+
+	// stsc(Sample To Chunk)
+	if((FindBox(data, size, BoxType("stsc"), box, box_size) == false) || (box_size < 8))
+	{
+		return false;
+	}
+
+	entry_count = ReadUint32(box + 4);
+
+	if(box_size < (8 + static_cast<size_t>(entry_count) * 12))
+	{
+		return false;
+	}
+
+	sample_index = 0;
+
+	for(uint32_t entry_index = 0; entry_index < entry_count; entry_index++)
+	{
+		// 1-based, the entry is applied until the first chunk of the next entry
+		uint32_t first_chunk = ReadUint32(box + 8 + entry_index * 12);
+		uint32_t samples_per_chunk = ReadUint32(box + 8 + entry_index * 12 + 4);
+		uint32_t last_chunk = ((entry_index + 1) < entry_count) ? (ReadUint32(box + 8 + (entry_index + 1) * 12) - 1) : chunk_count;
+
+		if(first_chunk == 0)
+		{
+			return false;
+		}
+
+		for(uint32_t chunk = first_chunk; (chunk <= last_chunk) && (chunk <= chunk_count); chunk++)
+		{
+			const uint8_t *offset_position = chunk_box + 8 + (chunk - 1) * offset_size;
+			uint64_t offset = (offset_size == 8) ? ReadUint64(offset_position) : ReadUint32(offset_position);
+
+			for(uint32_t index = 0; (index < samples_per_chunk) && (sample_index < sample_count); index++)
+			{
+				auto &sample = samples[sample_index++];
+
+				if((offset > _mapped_size) || (sample.size > (_mapped_size - offset)))
+				{
+					// Truncated file
+					return false;
+				}
+
+				sample.offset = offset;
+				offset += sample.size;
+			}
+		}
+	}
+
+	return (sample_index == sample_count);
+}
+
+//====================================================================================================
+// Segments
+// - cut at the first key frame after the segment duration of the video track (all the tracks have the same boundaries)
+// - audio only : cut at the first sample after the segment duration
+//====================================================================================================
+void VodMp4File::MakeSegments(uint32_t segment_duration)
+{
+	const VodTrack *video_track = GetVideoTrack();
+	const VodTrack *audio_track = GetAudioTrack();
+	const VodTrack *reference_track = (video_track != nullptr) ? video_track : audio_track;
+	const auto &reference_samples = reference_track->samples;
+	uint64_t target_duration = static_cast<uint64_t>(segment_duration) * reference_track->timescale;
+
+	// First samples of the segments
+	std::vector<size_t> boundaries;
+	uint64_t start_dts = 0;
+
+	for(size_t index = 0; index < reference_samples.size(); index++)
+	{
+		const auto &sample = reference_samples[index];
+
+		if(boundaries.empty() || (sample.is_keyframe && ((sample.dts - start_dts) >= target_duration)))
+		{
+			boundaries.push_back(index);
+			start_dts = sample.dts;
+		}
+	}
+
+	_segments.clear();
+	_segments.reserve(boundaries.size());
+
+	size_t audio_index = 0;
+
+	for(size_t index = 0; index < boundaries.size(); index++)
+	{
+		VodSegment segment;
+		size_t begin = boundaries[index];
+		size_t end = ((index + 1) < boundaries.size()) ? boundaries[index + 1] : reference_samples.size();
+		uint64_t begin_dts = reference_samples[begin].dts;
+		uint64_t end_dts = (end < reference_samples.size()) ? reference_samples[end].dts : reference_track->duration;
+
+		segment.start_time = static_cast<double>(begin_dts) / reference_track->timescale;
+		segment.duration = static_cast<double>(end_dts - begin_dts) / reference_track->timescale;
+
+		if(video_track != nullptr)
+		{
+			segment.video_begin = begin;
+			segment.video_end = end;
+			segment.video_start_dts = begin_dts;
+			segment.video_duration = end_dts - begin_dts;
+		}
+
+		if(audio_track != nullptr)
+		{
+			const auto &audio_samples = audio_track->samples;
+
+			if(reference_track == audio_track)
+			{
+				segment.audio_begin = begin;
+				segment.audio_end = end;
+			}
+			else
+			{
+				// The audio samples before the next boundary of the video
+				segment.audio_begin = audio_index;
+
+				if(end < reference_samples.size())
+				{
+					uint64_t audio_end_dts = end_dts * audio_track->timescale / reference_track->timescale;
+
+					while((audio_index < audio_samples.size()) && (audio_samples[audio_index].dts < audio_end_dts))
+					{
+						audio_index++;
+					}
+				}
+				else
+				{
+					audio_index = audio_samples.size();
+				}
+
+				segment.audio_end = audio_index;
+			}
+
+			segment.audio_start_dts = (segment.audio_begin < audio_samples.size()) ? audio_samples[segment.audio_begin].dts : audio_track->duration;
+
+			uint64_t audio_end_dts = (segment.audio_end < audio_samples.size()) ? audio_samples[segment.audio_end].dts : audio_track->duration;
+			segment.audio_duration = audio_end_dts - segment.audio_start_dts;
+		}
+
+		_segments.push_back(segment);
+	}
+
+	_duration = static_cast<double>(reference_track->duration) / reference_track->timescale;
+}
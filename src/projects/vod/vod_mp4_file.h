@@ -0,0 +1,169 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include <sys/stat.h>
+
+#include <memory>
+#include <vector>
+
+// Upper limit of the samples of a track (the index is made from the moov of the file, which can be broken)
+#define VOD_MP4_MAX_SAMPLE_COUNT			(50 * 1000 * 1000)
+
+//====================================================================================================
+// VodSample
+// - location of the sample in the file, the data is not read until the sample is packaged
+//====================================================================================================
+struct VodSample
+{
+	uint64_t offset;
+	uint64_t dts;
+	uint32_t size;
+	int32_t composition_offset;
+	bool is_keyframe;
+};
+
+//====================================================================================================
+// VodTrack
+// - H.264 (avc1) or AAC (mp4a), the other tracks are ignored
+//====================================================================================================
+struct VodTrack
+{
+	bool is_video = false;
+
+	uint32_t track_id = 0;
+	uint32_t timescale = 0;
+	uint64_t duration = 0;
+
+	// Video
+	uint32_t width = 0;
+	uint32_t height = 0;
+	// Size of the length field of the NAL units (avcC)
+	uint8_t nal_length_size = 4;
+	uint8_t avc_profile = 0;
+	uint8_t avc_compatibility = 0;
+	uint8_t avc_level = 0;
+	// NAL units (including the NAL header), the first SPS/PPS of avcC
+	std::shared_ptr<std::vector<uint8_t>> sps;
+	std::shared_ptr<std::vector<uint8_t>> pps;
+
+	// Audio (AudioSpecificConfig of esds)
+	uint8_t audio_object_type = 2;
+	uint8_t audio_sample_rate_index = 0;
+	uint32_t audio_sample_rate = 0;
+	uint16_t audio_channels = 0;
+
+	std::vector<VodSample> samples;
+};
+
+//====================================================================================================
+// VodSegment
+// - [begin, end) ranges of the samples of the tracks
+// - the segments start at the key frames of the video track (or any sample of the audio only file)
+//====================================================================================================
+struct VodSegment
+{
+	// Timescale of the track
+	uint64_t video_start_dts = 0;
+	uint64_t video_duration = 0;
+	uint64_t audio_start_dts = 0;
+	uint64_t audio_duration = 0;
+
+	// Second
+	double start_time = 0.0;
+	double duration = 0.0;
+
+	size_t video_begin = 0;
+	size_t video_end = 0;
+	size_t audio_begin = 0;
+	size_t audio_end = 0;
+};
+
+//====================================================================================================
+// VodMp4File
+// - The file is mapped to the memory, and moov is parsed once by Open() to make the sample index
+// - The samples are not copied: GetMappedData() refers to the mapped memory, and the file is kept mapped
+//   until all the references are released (so the cached file can be replaced while it is being sent)
+// - Edit lists (elst) are not applied, the first sample of the tracks starts at 0
+//====================================================================================================
+class VodMp4File : public ov::EnableSharedFromThis<VodMp4File>
+{
+public:
+	static std::shared_ptr<VodMp4File> Open(const ov::String &path, uint32_t segment_duration);
+
+	VodMp4File() = default;
+	~VodMp4File() override;
+
+	const ov::String &GetPath() const
+	{
+		return _path;
+	}
+
+	// Whether the file is changed after it is opened (the cached index is not valid)
+	bool IsModified(const struct stat &file_stat) const;
+
+	// nullptr if not exists
+	const VodTrack *GetVideoTrack() const
+	{
+		return (_video_track.timescale != 0) ? &_video_track : nullptr;
+	}
+
+	const VodTrack *GetAudioTrack() const
+	{
+		return (_audio_track.timescale != 0) ? &_audio_track : nullptr;
+	}
+
+	const std::vector<VodSegment> &GetSegments() const
+	{
+		return _segments;
+	}
+
+	// Second
+	double GetDuration() const
+	{
+		return _duration;
+	}
+
+	// The sample is in the mapped memory (validated by Open()), valid while the file is referred
+	const uint8_t *GetSampleData(const VodSample &sample) const
+	{
+		return _mapped_data + sample.offset;
+	}
+
+	// The bytes of the file (no copy), nullptr if out of the file
+	std::shared_ptr<const ov::Data> GetMappedData(uint64_t offset, size_t length);
+
+protected:
+	bool Map(const ov::String &path);
+
+	bool ParseMoov(const uint8_t *data, size_t size);
+	bool ParseTrak(const uint8_t *data, size_t size);
+	bool ParseStsd(const uint8_t *data, size_t size, VodTrack &track);
+	bool ParseAvcC(const uint8_t *data, size_t size, VodTrack &track);
+	bool ParseEsds(const uint8_t *data, size_t size, VodTrack &track);
+
+	// Makes the samples from stts/ctts/stss/stsc/stsz/stco(co64)
+	bool ParseStbl(const uint8_t *data, size_t size, VodTrack &track);
+
+	void MakeSegments(uint32_t segment_duration);
+
+	ov::String _path;
+	struct timespec _modified_time {};
+	off_t _file_size = 0;
+
+	uint8_t *_mapped_data = nullptr;
+	size_t _mapped_size = 0;
+
+	VodTrack _video_track;
+	VodTrack _audio_track;
+
+	std::vector<VodSegment> _segments;
+	double _duration = 0.0;
+};
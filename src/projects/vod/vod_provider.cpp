@@ -0,0 +1,807 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "vod_provider.h"
+#include "vod_private.h"
+
+#include <config/config.h>
+#include <segment_stream/packetyzer/packetyzer.h>
+#include <segment_stream/packetyzer/ts_writer.h>
+#include <segment_stream/packetyzer/m4s_init_writer.h>
+#include <segment_stream/packetyzer/m4s_fragment_writer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#define VOD_PROVIDER_ADTS_HEADER_SIZE		(7)
+#define VOD_PROVIDER_START_CODE_SIZE		(4)
+
+static const uint8_t g_vod_start_code[VOD_PROVIDER_START_CODE_SIZE] = { 0x00, 0x00, 0x00, 0x01 };
+
+// The stream buffer of the writer is referred by the segment (no copy)
+struct VodStreamData
+{
+	explicit VodStreamData(const std::shared_ptr<std::vector<uint8_t>> &stream_)
+		: stream(stream_),
+		  data(stream_->data(), stream_->size(), true)
+	{
+	}
+
+	std::shared_ptr<std::vector<uint8_t>> stream;
+	ov::Data data;
+};
+
+static uint64_t ConvertTimescale(uint64_t value, uint32_t from_timescale, uint32_t to_timescale)
+{
+	if((from_timescale == 0) || (from_timescale == to_timescale))
+	{
+		return value;
+	}
+
+	return value * to_timescale / from_timescale;
+}
+
+// <prefix>_<number><suffix>
+static bool ParseSegmentNumber(const ov::String &file_name, const ov::String &suffix, uint64_t &number)
+{
+	ov::String prefix = VOD_PROVIDER_SEGMENT_PREFIX "_";
+
+	if((file_name.HasPrefix(prefix) == false) || (file_name.HasSuffix(suffix) == false) ||
+	   (file_name.GetLength() <= (prefix.GetLength() + suffix.GetLength())))
+	{
+		return false;
+	}
+
+	number = 0;
+
+	for(size_t index = prefix.GetLength(); index < (file_name.GetLength() - suffix.GetLength()); index++)
+	{
+		char c = file_name[index];
+
+		if((c < '0') || (c > '9'))
+		{
+			return false;
+		}
+
+		number = number * 10 + (c - '0');
+	}
+
+	return true;
+}
+
+// Length-prefixed NAL units (avcC) to Annex-B, the parameter sets are inserted before the key frames
+static void WriteAnnexB(const VodTrack &track, const VodSample &sample, const uint8_t *data, const std::shared_ptr<ov::Data> &frame_data)
+{
+	frame_data->Clear();
+
+	if(sample.is_keyframe)
+	{
+		frame_data->Append(g_vod_start_code, VOD_PROVIDER_START_CODE_SIZE);
+		frame_data->Append(track.sps->data(), track.sps->size());
+		frame_data->Append(g_vod_start_code, VOD_PROVIDER_START_CODE_SIZE);
+		frame_data->Append(track.pps->data(), track.pps->size());
+	}
+
+	size_t position = 0;
+
+	while((position + track.nal_length_size) <= sample.size)
+	{
+		size_t length = 0;
+
+		for(int index = 0; index < track.nal_length_size; index++)
+		{
+			length = (length << 8) | data[position + index];
+		}
+
+		position += track.nal_length_size;
+
+		if((length == 0) || (length > (sample.size - position)))
+		{
+			break;
+		}
+
+		// AUD is written by TsWriter
+		if((data[position] & 0x1F) != 9)
+		{
+			frame_data->Append(g_vod_start_code, VOD_PROVIDER_START_CODE_SIZE);
+			frame_data->Append(data + position, length);
+		}
+
+		position += length;
+	}
+}
+
+// Length field of the NAL units to 4 bytes (avcC of the init segment)
+static std::shared_ptr<ov::Data> ConvertNalLength(const VodTrack &track, const VodSample &sample, const uint8_t *data)
+{
+	auto frame_data = std::make_shared<ov::Data>(sample.size * 2);
+	size_t position = 0;
+
+	while((position + track.nal_length_size) <= sample.size)
+	{
+		uint32_t length = 0;
+
+		for(int index = 0; index < track.nal_length_size; index++)
+		{
+			length = (length << 8) | data[position + index];
+		}
+
+		position += track.nal_length_size;
+
+		if(length > (sample.size - position))
+		{
+			break;
+		}
+
+		uint8_t length_field[4] = { static_cast<uint8_t>(length >> 24), static_cast<uint8_t>(length >> 16), static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length) };
+
+		frame_data->Append(length_field, sizeof(length_field));
+		frame_data->Append(data + position, length);
+
+		position += length;
+	}
+
+	return frame_data;
+}
+
+std::shared_ptr<VodProvider> VodProvider::Create(const info::Application *application_info)
+{
+	auto config = application_info->GetProvider<cfg::VodProvider>();
+
+	if((config == nullptr) || (config->IsParsed() == false) || config->GetRootPath().IsEmpty())
+	{
+		logte("<Providers><VOD><RootPath> is required for the VOD application [%s]", application_info->GetName().CStr());
+		return nullptr;
+	}
+
+	return std::make_shared<VodProvider>(application_info, *config);
+}
+
+VodProvider::VodProvider(const info::Application *application_info, const cfg::VodProvider &config)
+	: _application_info(application_info),
+	  _root_path(config.GetRootPath()),
+	  _segment_duration(static_cast<uint32_t>(std::max(config.GetSegmentDuration(), 1))),
+	  _cache_count(static_cast<size_t>(std::max(config.GetCacheCount(), 1)))
+{
+	logti("VOD provider is created for application [%s] (root: %s, segment duration: %u)",
+		  application_info->GetName().CStr(), _root_path.CStr(), _segment_duration);
+}
+
+//====================================================================================================
+// GetFile
+// - the stream name is a file name of the root path (the other directories can't be referred)
+//====================================================================================================
+std::shared_ptr<VodProvider::VodFileEntry> VodProvider::GetFile(const ov::String &app_name, const ov::String &stream_name)
+{
+	if(app_name != _application_info->GetName())
+	{
+		return nullptr;
+	}
+
+	if(stream_name.IsEmpty() || stream_name.HasPrefix(".") || (stream_name.IndexOf('/') >= 0) || (stream_name.IndexOf('\\') >= 0))
+	{
+		return nullptr;
+	}
+
+	ov::String path = _root_path + "/" + stream_name;
+
+	if(stream_name.HasSuffix(".mp4") == false)
+	{
+		path.Append(".mp4");
+	}
+
+	struct stat file_stat {};
+
+	if((::stat(path.CStr(), &file_stat) != 0) || (S_ISREG(file_stat.st_mode) == false))
+	{
+		return nullptr;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_file_mutex);
+
+		auto item = _files.find(path);
+
+		if((item != _files.end()) && (item->second->file->IsModified(file_stat) == false))
+		{
+			item->second->last_access = ++_access_count;
+			return item->second;
+		}
+	}
+
+	// The moov is parsed without the lock (the other files are served meanwhile)
+	auto file = VodMp4File::Open(path, _segment_duration);
+
+	if(file == nullptr)
+	{
+		return nullptr;
+	}
+
+	auto entry = std::make_shared<VodFileEntry>();
+
+	entry->file = file;
+	entry->etag_prefix.Format("%llx-%llx",
+							  static_cast<unsigned long long>(file_stat.st_mtim.tv_sec),
+							  static_cast<unsigned long long>(file_stat.st_size));
+	entry->modified_time = file_stat.st_mtim.tv_sec;
+	entry->hls_play_list = MakePlayListSnapshot(*entry, MakeHlsPlayList(*file));
+	entry->dash_play_list = MakePlayListSnapshot(*entry, MakeDashPlayList(*file));
+
+	std::lock_guard<std::mutex> lock(_file_mutex);
+
+	entry->last_access = ++_access_count;
+	_files[path] = entry;
+
+	// The least recently used files are closed (the file is unmapped when the segments being sent are released)
+	while(_files.size() > _cache_count)
+	{
+		auto oldest = std::min_element(_files.begin(), _files.end(), [](const auto &item1, const auto &item2) -> bool {
+			return item1.second->last_access < item2.second->last_access;
+		});
+
+		_files.erase(oldest);
+	}
+
+	return entry;
+}
+
+std::shared_ptr<const PlayListSnapshot> VodProvider::MakePlayListSnapshot(const VodFileEntry &entry, const ov::String &play_list) const
+{
+	auto snapshot = std::make_shared<PlayListSnapshot>();
+
+	snapshot->version = 1;
+	snapshot->data = play_list.ToData(false);
+	snapshot->content_length = ov::Converter::ToString(snapshot->data->GetLength());
+	snapshot->etag.Format("\"%s\"", entry.etag_prefix.CStr());
+	snapshot->create_time = entry.modified_time;
+	snapshot->last_modified = Packetyzer::MakeHttpDateString(entry.modified_time);
+	snapshot->cache_control.Format("public, max-age=%d", VOD_PROVIDER_CACHE_MAX_AGE);
+
+	return snapshot;
+}
+
+std::shared_ptr<SegmentData> VodProvider::MakeSegmentData(const VodFileEntry &entry,
+														  const ov::String &file_name,
+														  int sequence_number,
+														  double duration,
+														  const std::shared_ptr<std::vector<uint8_t>> &data_stream) const
+{
+	if((data_stream == nullptr) || data_stream->empty())
+	{
+		return nullptr;
+	}
+
+	auto stream_data = std::make_shared<VodStreamData>(data_stream);
+	std::shared_ptr<ov::Data> data(stream_data, &(stream_data->data));
+	ov::String name = file_name;
+
+	auto segment_data = std::make_shared<SegmentData>(sequence_number,
+													  name,
+													  static_cast<uint64_t>(duration * PACKTYZER_DEFAULT_TIMESCALE),
+													  0,
+													  data);
+
+	segment_data->create_time = entry.modified_time;
+	segment_data->etag.Format("\"%s-%s\"", entry.etag_prefix.CStr(), file_name.CStr());
+	segment_data->last_modified = Packetyzer::MakeHttpDateString(entry.modified_time);
+	segment_data->cache_control.Format("public, max-age=%d, immutable", VOD_PROVIDER_CACHE_MAX_AGE);
+
+	return segment_data;
+}
+
+//====================================================================================================
+// HLS PlayList (VOD)
+//====================================================================================================
+ov::String VodProvider::MakeHlsPlayList(const VodMp4File &file) const
+{
+	std::ostringstream m3u8_play_list;
+	double max_duration = 0;
+	const auto &segments = file.GetSegments();
+
+	for(size_t index = 0; index < segments.size(); index++)
+	{
+		m3u8_play_list << "#EXTINF:" << std::fixed << std::setprecision(3) << segments[index].duration << ",\r\n"
+					   << VOD_PROVIDER_SEGMENT_PREFIX << "_" << index << ".ts" << "\r\n";
+
+		max_duration = std::max(max_duration, segments[index].duration);
+	}
+
+	std::ostringstream play_list_stream;
+
+	play_list_stream << "#EXTM3U" << "\r\n"
+					 << "#EXT-X-VERSION:3" << "\r\n"
+					 << "#EXT-X-PLAYLIST-TYPE:VOD" << "\r\n"
+					 << "#EXT-X-MEDIA-SEQUENCE:0" << "\r\n"
+					 << "#EXT-X-TARGETDURATION:" << static_cast<int>(std::ceil(max_duration)) << "\r\n"
+					 << m3u8_play_list.str()
+					 << "#EXT-X-ENDLIST" << "\r\n";
+
+	return play_list_stream.str().c_str();
+}
+
+//====================================================================================================
+// DASH PlayList (static)
+// - $Time$ of the segments: decoding time of the first sample (the timescale of the audio is the sample rate, see M4sInitWriter)
+//====================================================================================================
+ov::String VodProvider::MakeDashPlayList(const VodMp4File &file) const
+{
+	const auto video_track = file.GetVideoTrack();
+	const auto audio_track = file.GetAudioTrack();
+	const auto &segments = file.GetSegments();
+	double duration = std::max(file.GetDuration(), 0.001);
+
+	std::ostringstream play_list_stream;
+
+	play_list_stream << std::fixed << std::setprecision(3)
+					 << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+					 << "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\"\n"
+					 << "    profiles=\"urn:mpeg:dash:profile:isoff-live:2011\"\n"
+					 << "    type=\"static\"\n"
+					 << "    mediaPresentationDuration=\"PT" << file.GetDuration() << "S\"\n"
+					 << "    minBufferTime=\"PT" << _segment_duration << "S\">\n"
+					 << "<Period id=\"0\" start=\"PT0S\">\n";
+
+	if(video_track != nullptr)
+	{
+		uint64_t total_size = 0;
+
+		for(const auto &sample : video_track->samples)
+		{
+			total_size += sample.size;
+		}
+
+		char codec_string[32];
+		::snprintf(codec_string, sizeof(codec_string), "avc1.%02x%02x%02x", video_track->avc_profile, video_track->avc_compatibility, video_track->avc_level);
+
+		play_list_stream << "\t<AdaptationSet id=\"0\" group=\"1\" mimeType=\"video/mp4\" width=\"" << video_track->width
+						 << "\" height=\"" << video_track->height
+						 << "\" segmentAlignment=\"true\" startWithSAP=\"1\">\n"
+						 << "\t\t<SegmentTemplate timescale=\"" << video_track->timescale
+						 << "\" initialization=\"" << MPD_VIDEO_INIT_FILE_NAME << "\" media=\"" << VOD_PROVIDER_SEGMENT_PREFIX << "_$Time$" << MPD_VIDEO_SUFFIX << "\">\n"
+						 << "\t\t\t<SegmentTimeline>\n";
+
+		for(const auto &segment : segments)
+		{
+			play_list_stream << "\t\t\t\t<S t=\"" << segment.video_start_dts << "\" d=\"" << segment.video_duration << "\"/>\n";
+		}
+
+		play_list_stream << "\t\t\t</SegmentTimeline>\n"
+						 << "\t\t</SegmentTemplate>\n"
+						 << "\t\t<Representation id=\"video\" codecs=\"" << codec_string << "\" sar=\"1:1\" bandwidth=\""
+						 << static_cast<uint64_t>(total_size * 8 / duration) << "\" />\n"
+						 << "\t</AdaptationSet>\n";
+	}
+
+	if(audio_track != nullptr)
+	{
+		uint64_t total_size = 0;
+
+		for(const auto &sample : audio_track->samples)
+		{
+			total_size += sample.size;
+		}
+
+		play_list_stream << "\t<AdaptationSet id=\"1\" group=\"2\" mimeType=\"audio/mp4\" lang=\"und\" segmentAlignment=\"true\" startWithSAP=\"1\">\n"
+						 << "\t\t<AudioChannelConfiguration schemeIdUri=\"urn:mpeg:dash:23003:3:audio_channel_configuration:2011\" value=\""
+						 << audio_track->audio_channels << "\"/>\n"
+						 << "\t\t<SegmentTemplate timescale=\"" << audio_track->audio_sample_rate
+						 << "\" initialization=\"" << MPD_AUDIO_INIT_FILE_NAME << "\" media=\"" << VOD_PROVIDER_SEGMENT_PREFIX << "_$Time$" << MPD_AUDIO_SUFFIX << "\">\n"
+						 << "\t\t\t<SegmentTimeline>\n";
+
+		for(const auto &segment : segments)
+		{
+			if(segment.audio_begin == segment.audio_end)
+			{
+				continue;
+			}
+
+			uint64_t start_time = ConvertTimescale(segment.audio_start_dts, audio_track->timescale, audio_track->audio_sample_rate);
+			uint64_t end_time = ConvertTimescale(segment.audio_start_dts + segment.audio_duration, audio_track->timescale, audio_track->audio_sample_rate);
+
+			play_list_stream << "\t\t\t\t<S t=\"" << start_time << "\" d=\"" << (end_time - start_time) << "\"/>\n";
+		}
+
+		play_list_stream << "\t\t\t</SegmentTimeline>\n"
+						 << "\t\t</SegmentTemplate>\n"
+						 << "\t\t<Representation id=\"audio\" codecs=\"mp4a.40.2\" audioSamplingRate=\"" << audio_track->audio_sample_rate
+						 << "\" bandwidth=\"" << static_cast<uint64_t>(total_size * 8 / duration) << "\" />\n"
+						 << "\t</AdaptationSet>\n";
+	}
+
+	play_list_stream << "</Period>\n"
+					 << "</MPD>\n";
+
+	return play_list_stream.str().c_str();
+}
+
+//====================================================================================================
+// TS Segment (vod_<index>.ts)
+// - the samples of the tracks are interleaved by the decoding time (90kHz)
+//====================================================================================================
+std::shared_ptr<SegmentData> VodProvider::MakeTsSegment(const VodFileEntry &entry, const ov::String &file_name)
+{
+	const auto &file = entry.file;
+	const auto &segments = file->GetSegments();
+	uint64_t index;
+
+	if((ParseSegmentNumber(file_name, ".ts", index) == false) || (index >= segments.size()))
+	{
+		return nullptr;
+	}
+
+	const auto &segment = segments[index];
+	const auto video_track = file->GetVideoTrack();
+	const auto audio_track = file->GetAudioTrack();
+
+	size_t data_size = 0;
+	size_t sample_count = 0;
+	size_t max_sample_size = 0;
+
+	if(video_track != nullptr)
+	{
+		for(size_t sample_index = segment.video_begin; sample_index < segment.video_end; sample_index++)
+		{
+			data_size += video_track->samples[sample_index].size;
+			max_sample_size = std::max<size_t>(max_sample_size, video_track->samples[sample_index].size);
+		}
+
+		sample_count += segment.video_end - segment.video_begin;
+		max_sample_size += video_track->sps->size() + video_track->pps->size();
+	}
+
+	if(audio_track != nullptr)
+	{
+		for(size_t sample_index = segment.audio_begin; sample_index < segment.audio_end; sample_index++)
+		{
+			data_size += audio_track->samples[sample_index].size + VOD_PROVIDER_ADTS_HEADER_SIZE;
+			max_sample_size = std::max<size_t>(max_sample_size, audio_track->samples[sample_index].size + VOD_PROVIDER_ADTS_HEADER_SIZE);
+		}
+
+		sample_count += segment.audio_end - segment.audio_begin;
+	}
+
+	auto ts_writer = std::make_unique<TsWriter>(video_track != nullptr, audio_track != nullptr, SegmentCodecType::H264Codec);
+	ts_writer->ReserveSampleData(data_size, sample_count);
+
+	// Reused for all the samples (TsWriter copies the sample)
+	auto frame_data = std::make_shared<ov::Data>(max_sample_size * 2);
+
+	size_t video_index = segment.video_begin;
+	size_t audio_index = segment.audio_begin;
+
+	while((video_index < segment.video_end) || (audio_index < segment.audio_end))
+	{
+		uint64_t video_timestamp = (video_index < segment.video_end) ?
+								   ConvertTimescale(video_track->samples[video_index].dts, video_track->timescale, PACKTYZER_DEFAULT_TIMESCALE) : UINT64_MAX;
+		uint64_t audio_timestamp = (audio_index < segment.audio_end) ?
+								   ConvertTimescale(audio_track->samples[audio_index].dts, audio_track->timescale, PACKTYZER_DEFAULT_TIMESCALE) : UINT64_MAX;
+
+		if(video_timestamp <= audio_timestamp)
+		{
+			const auto &sample = video_track->samples[video_index++];
+			uint64_t time_offset = ConvertTimescale(static_cast<uint64_t>(std::max(sample.composition_offset, 0)), video_track->timescale, PACKTYZER_DEFAULT_TIMESCALE);
+
+			WriteAnnexB(*video_track, sample, file->GetSampleData(sample), frame_data);
+
+			if(frame_data->GetLength() > 0)
+			{
+				ts_writer->WriteSample(true, sample.is_keyframe, video_timestamp, time_offset, frame_data);
+			}
+		}
+		else
+		{
+			const auto &sample = audio_track->samples[audio_index++];
+			size_t frame_length = sample.size + VOD_PROVIDER_ADTS_HEADER_SIZE;
+			uint8_t adts_header[VOD_PROVIDER_ADTS_HEADER_SIZE];
+
+			// ADTS: MPEG-4, no CRC
+			adts_header[0] = 0xFF;
+			adts_header[1] = 0xF1;
+			adts_header[2] = static_cast<uint8_t>((((audio_track->audio_object_type - 1) & 0x03) << 6) | (audio_track->audio_sample_rate_index << 2) | ((audio_track->audio_channels >> 2) & 0x01));
+			adts_header[3] = static_cast<uint8_t>(((audio_track->audio_channels & 0x03) << 6) | ((frame_length >> 11) & 0x03));
+			adts_header[4] = static_cast<uint8_t>((frame_length >> 3) & 0xFF);
+			adts_header[5] = static_cast<uint8_t>(((frame_length & 0x07) << 5) | 0x1F);
+			adts_header[6] = 0xFC;
+
+			frame_data->Clear();
+			frame_data->Append(adts_header, sizeof(adts_header));
+			frame_data->Append(file->GetSampleData(sample), sample.size);
+
+			ts_writer->WriteSample(false, true, audio_timestamp, 0, frame_data);
+		}
+	}
+
+	return MakeSegmentData(entry, file_name, static_cast<int>(index), segment.duration, ts_writer->GetDataStream());
+}
+
+//====================================================================================================
+// Init Segment (init_video.m4s/init_audio.m4s)
+//====================================================================================================
+std::shared_ptr<SegmentData> VodProvider::MakeInitSegment(const VodFileEntry &entry, const ov::String &file_name)
+{
+	std::unique_ptr<M4sInitWriter> writer;
+	std::shared_ptr<std::vector<uint8_t>> empty = nullptr;
+
+	if(file_name == MPD_VIDEO_INIT_FILE_NAME)
+	{
+		auto track = entry.file->GetVideoTrack();
+
+		if(track == nullptr)
+		{
+			return nullptr;
+		}
+
+		auto sps = track->sps;
+		auto pps = track->pps;
+
+		writer = std::make_unique<M4sInitWriter>(M4sMediaType::VideoMediaType,
+												 1024,
+												 0,
+												 track->timescale,
+												 VOD_PROVIDER_VIDEO_TRACK_ID,
+												 track->width,
+												 track->height,
+												 sps,
+												 pps,
+												 0,
+												 0,
+												 0);
+	}
+	else if(file_name == MPD_AUDIO_INIT_FILE_NAME)
+	{
+		auto track = entry.file->GetAudioTrack();
+
+		if(track == nullptr)
+		{
+			return nullptr;
+		}
+
+		writer = std::make_unique<M4sInitWriter>(M4sMediaType::AudioMediaType,
+												 1024,
+												 0,
+												 track->audio_sample_rate,
+												 VOD_PROVIDER_AUDIO_TRACK_ID,
+												 0,
+												 0,
+												 empty,
+												 empty,
+												 track->audio_channels,
+												 16,
+												 track->audio_sample_rate);
+	}
+	else
+	{
+		return nullptr;
+	}
+
+	if(writer->CreateData() <= 0)
+	{
+		logte("Could not create %s of %s", file_name.CStr(), entry.file->GetPath().CStr());
+		return nullptr;
+	}
+
+	return MakeSegmentData(entry, file_name, 0, 0, writer->GetDataStream());
+}
+
+//====================================================================================================
+// Media Segment (vod_<time>_video.m4s/vod_<time>_audio.m4s)
+// - moof/mdat header is written, and the samples are sent from the mapped file
+//   (the contiguous samples are sent as a range)
+//====================================================================================================
+std::shared_ptr<SegmentData> VodProvider::MakeM4sSegment(const VodFileEntry &entry, const ov::String &file_name)
+{
+	const auto &file = entry.file;
+	const auto &segments = file->GetSegments();
+	bool is_video = file_name.HasSuffix(MPD_VIDEO_SUFFIX);
+	const VodTrack *track = is_video ? file->GetVideoTrack() : file->GetAudioTrack();
+	uint64_t start_time;
+
+	if((track == nullptr) || (ParseSegmentNumber(file_name, is_video ? MPD_VIDEO_SUFFIX : MPD_AUDIO_SUFFIX, start_time) == false))
+	{
+		return nullptr;
+	}
+
+	// Timescale of the fMP4
+	uint32_t timescale = is_video ? track->timescale : track->audio_sample_rate;
+
+	auto item = std::lower_bound(segments.begin(), segments.end(), start_time, [&](const VodSegment &segment, uint64_t time) -> bool {
+		uint64_t segment_start_time = is_video ? segment.video_start_dts : ConvertTimescale(segment.audio_start_dts, track->timescale, timescale);
+		return segment_start_time < time;
+	});
+
+	if(item == segments.end())
+	{
+		return nullptr;
+	}
+
+	const auto &segment = *item;
+	size_t begin = is_video ? segment.video_begin : segment.audio_begin;
+	size_t end = is_video ? segment.video_end : segment.audio_end;
+
+	if((begin >= end) || (ConvertTimescale(track->samples[begin].dts, track->timescale, timescale) != start_time))
+	{
+		return nullptr;
+	}
+
+	std::vector<std::shared_ptr<FragmentSampleData>> sample_datas;
+	std::vector<std::shared_ptr<const ov::Data>> gather_datas;
+	bool convert_nal_length = is_video && (track->nal_length_size != 4);
+
+	// Range of the contiguous samples
+	uint64_t range_offset = 0;
+	size_t range_length = 0;
+
+	auto flush_range = [&]() -> bool {
+		if(range_length > 0)
+		{
+			auto mapped_data = file->GetMappedData(range_offset, range_length);
+
+			if(mapped_data == nullptr)
+			{
+				return false;
+			}
+
+			gather_datas.push_back(mapped_data);
+			range_length = 0;
+		}
+
+		return true;
+	};
+
+	sample_datas.reserve(end - begin);
+
+	for(size_t index = begin; index < end; index++)
+	{
+		const auto &sample = track->samples[index];
+		uint64_t next_dts = ((index + 1) < track->samples.size()) ? track->samples[index + 1].dts : track->duration;
+		uint64_t duration = ConvertTimescale(next_dts, track->timescale, timescale) - ConvertTimescale(sample.dts, track->timescale, timescale);
+		std::shared_ptr<ov::Data> data;
+
+		if(convert_nal_length)
+		{
+			data = ConvertNalLength(*track, sample, file->GetSampleData(sample));
+
+			if(flush_range() == false)
+			{
+				return nullptr;
+			}
+
+			gather_datas.push_back(data);
+		}
+		else
+		{
+			// Only the length is used by the writer
+			data = std::make_shared<ov::Data>(file->GetSampleData(sample), sample.size, true);
+
+			if((range_length > 0) && ((range_offset + range_length) == sample.offset))
+			{
+				range_length += sample.size;
+			}
+			else
+			{
+				if(flush_range() == false)
+				{
+					return nullptr;
+				}
+
+				range_offset = sample.offset;
+				range_length = sample.size;
+			}
+		}
+
+		if(is_video)
+		{
+			sample_datas.push_back(std::make_shared<FragmentSampleData>(duration,
+																		sample.is_keyframe ? 0X02000000 : 0X01010000,
+																		static_cast<uint32_t>(std::max(sample.composition_offset, 0)),
+																		ov::DataView(data),
+																		true));
+		}
+		else
+		{
+			sample_datas.push_back(std::make_shared<FragmentSampleData>(duration, 0, 0, ov::DataView(data)));
+		}
+	}
+
+	if(flush_range() == false)
+	{
+		return nullptr;
+	}
+
+	auto fragment_writer = std::make_unique<M4sFragmentWriter>(is_video ? M4sMediaType::VideoMediaType : M4sMediaType::AudioMediaType,
+															   1024,
+															   static_cast<uint32_t>(item - segments.begin()) + 1,
+															   is_video ? VOD_PROVIDER_VIDEO_TRACK_ID : VOD_PROVIDER_AUDIO_TRACK_ID,
+															   start_time,
+															   sample_datas);
+
+	fragment_writer->CreateHeaderData();
+
+	auto segment_data = MakeSegmentData(entry, file_name, static_cast<int>(item - segments.begin()), segment.duration, fragment_writer->GetDataStream());
+
+	if(segment_data != nullptr)
+	{
+		segment_data->gather_datas = std::move(gather_datas);
+	}
+
+	return segment_data;
+}
+
+//====================================================================================================
+// OnPlayListRequest
+//  - SegmentStreamObserver Implementation
+//====================================================================================================
+bool VodProvider::OnPlayListRequest(const ov::String &app_name,
+									const ov::String &stream_name,
+									const ov::String &file_name,
+									std::shared_ptr<const PlayListSnapshot> &play_list)
+{
+	if((file_name != VOD_PROVIDER_HLS_PLAY_LIST_FILE_NAME) && (file_name != VOD_PROVIDER_DASH_PLAY_LIST_FILE_NAME))
+	{
+		return false;
+	}
+
+	auto entry = GetFile(app_name, stream_name);
+
+	if(entry == nullptr)
+	{
+		return false;
+	}
+
+	play_list = (file_name == VOD_PROVIDER_HLS_PLAY_LIST_FILE_NAME) ? entry->hls_play_list : entry->dash_play_list;
+
+	return true;
+}
+
+//====================================================================================================
+// OnSegmentRequest
+//  - SegmentStreamObserver Implementation
+//====================================================================================================
+bool VodProvider::OnSegmentRequest(const ov::String &app_name,
+								   const ov::String &stream_name,
+								   const ov::String &file_name,
+								   std::shared_ptr<SegmentData> &segment_data)
+{
+	bool is_ts = file_name.HasSuffix(".ts");
+	bool is_init = (file_name == MPD_VIDEO_INIT_FILE_NAME) || (file_name == MPD_AUDIO_INIT_FILE_NAME);
+	bool is_m4s = file_name.HasSuffix(MPD_VIDEO_SUFFIX) || file_name.HasSuffix(MPD_AUDIO_SUFFIX);
+
+	if((is_ts || is_init || is_m4s) == false)
+	{
+		return false;
+	}
+
+	auto entry = GetFile(app_name, stream_name);
+
+	if(entry == nullptr)
+	{
+		return false;
+	}
+
+	if(is_ts)
+	{
+		segment_data = MakeTsSegment(*entry, file_name);
+	}
+	else if(is_init)
+	{
+		segment_data = MakeInitSegment(*entry, file_name);
+	}
+	else
+	{
+		segment_data = MakeM4sSegment(*entry, file_name);
+	}
+
+	if(segment_data == nullptr)
+	{
+		// The file is of this provider, so the other observers are not asked (404)
+		logtd("Could not find the segment: %s/%s/%s", app_name.CStr(), stream_name.CStr(), file_name.CStr());
+	}
+
+	return true;
+}
@@ -0,0 +1,100 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/application/application.h>
+#include <segment_stream/segment_stream_observer.h>
+
+#include "vod_mp4_file.h"
+
+#include <map>
+#include <mutex>
+
+#define VOD_PROVIDER_SEGMENT_PREFIX				"vod"
+#define VOD_PROVIDER_HLS_PLAY_LIST_FILE_NAME	"playlist.m3u8"
+#define VOD_PROVIDER_DASH_PLAY_LIST_FILE_NAME	"manifest.mpd"
+
+// Track ID of the fMP4 (same as the live DASH)
+#define VOD_PROVIDER_VIDEO_TRACK_ID				(1)
+#define VOD_PROVIDER_AUDIO_TRACK_ID				(2)
+
+// The playlists/segments are made from the file, so they are cached until the file is changed
+#define VOD_PROVIDER_CACHE_MAX_AGE				(86400)
+
+//====================================================================================================
+// VodProvider
+// - Packages the MP4 files of the VOD application to HLS(TS)/DASH(fMP4) just in time
+//   (<RootPath>/<stream>.mp4 is requested as /<app>/<stream>/playlist.m3u8 or /<app>/<stream>/manifest.mpd)
+// - The files are mapped and the sample index is kept (see VodMp4File), nothing is written to the disk
+// - The samples of the DASH segments are sent from the mapped file (scatter-gather),
+//   the TS segments are copied since the samples are packetized to 188 bytes
+// - Registered to the stream servers of the HLS/DASH publishers of the application
+//====================================================================================================
+class VodProvider : public SegmentStreamObserver
+{
+public:
+	static std::shared_ptr<VodProvider> Create(const info::Application *application_info);
+
+	VodProvider(const info::Application *application_info, const cfg::VodProvider &config);
+	~VodProvider() = default;
+
+	// SegmentStreamObserver Implementation
+	bool OnPlayListRequest(const ov::String &app_name,
+						   const ov::String &stream_name,
+						   const ov::String &file_name,
+						   std::shared_ptr<const PlayListSnapshot> &play_list) override;
+
+	bool OnSegmentRequest(const ov::String &app_name,
+						  const ov::String &stream_name,
+						  const ov::String &file_name,
+						  std::shared_ptr<SegmentData> &segment_data) override;
+
+protected:
+	struct VodFileEntry
+	{
+		std::shared_ptr<VodMp4File> file;
+
+		// ETag prefix/Last-Modified of the file
+		ov::String etag_prefix;
+		time_t modified_time = 0;
+
+		// Made once per file
+		std::shared_ptr<const PlayListSnapshot> hls_play_list;
+		std::shared_ptr<const PlayListSnapshot> dash_play_list;
+
+		uint64_t last_access = 0;
+	};
+
+	// nullptr if not exists (the file is opened, or reopened if it is changed)
+	std::shared_ptr<VodFileEntry> GetFile(const ov::String &app_name, const ov::String &stream_name);
+
+	std::shared_ptr<const PlayListSnapshot> MakePlayListSnapshot(const VodFileEntry &entry, const ov::String &play_list) const;
+	std::shared_ptr<SegmentData> MakeSegmentData(const VodFileEntry &entry,
+												 const ov::String &file_name,
+												 int sequence_number,
+												 double duration,
+												 const std::shared_ptr<std::vector<uint8_t>> &data_stream) const;
+
+	ov::String MakeHlsPlayList(const VodMp4File &file) const;
+	ov::String MakeDashPlayList(const VodMp4File &file) const;
+
+	std::shared_ptr<SegmentData> MakeTsSegment(const VodFileEntry &entry, const ov::String &file_name);
+	std::shared_ptr<SegmentData> MakeInitSegment(const VodFileEntry &entry, const ov::String &file_name);
+	std::shared_ptr<SegmentData> MakeM4sSegment(const VodFileEntry &entry, const ov::String &file_name);
+
+	const info::Application *_application_info;
+
+	ov::String _root_path;
+	uint32_t _segment_duration;
+	size_t _cache_count;
+
+	std::mutex _file_mutex;
+	// key: path of the file
+	std::map<ov::String, std::shared_ptr<VodFileEntry>> _files;
+	uint64_t _access_count = 0;
+};
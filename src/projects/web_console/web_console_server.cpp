@@ -15,7 +15,9 @@ WebConsoleServer::WebConsoleServer(const info::Application *application_info, Pr
 {
 }
 
-std::shared_ptr<WebConsoleServer> WebConsoleServer::Create(const info::Application *application_info)
+std::shared_ptr<WebConsoleServer> WebConsoleServer::Create(const info::Application *application_info,
+                                                           const std::shared_ptr<MediaRouter> &router,
+                                                           const std::vector<std::shared_ptr<Publisher>> &publishers)
 {
 	auto instance = std::make_shared<WebConsoleServer>(application_info, (PrivateToken){});
 
@@ -23,6 +25,8 @@ std::shared_ptr<WebConsoleServer> WebConsoleServer::Create(const info::Applicati
 	{
 		const auto &web_console = application_info->GetWebConsole();
 		instance->_web_console = web_console;
+		instance->_router = router;
+		instance->_publishers = publishers;
 
 		auto host = web_console.GetParentAs<cfg::Host>("Host");
 		auto address = ov::SocketAddress(host->GetIp(), static_cast<uint16_t>(web_console.GetListenPort()));
@@ -70,7 +74,16 @@ bool WebConsoleServer::Start(const ov::SocketAddress &address)
 		_http_server = std::make_shared<HttpServer>();
 	}
 
-	return InitializeServer() && _http_server->Start(address);
+	if((InitializeServer() && _http_server->Start(address)) == false)
+	{
+		return false;
+	}
+
+	_stats_timer_id = ov::SharedTimerWheel::Instance()->Schedule(WEB_CONSOLE_STATS_INTERVAL, [this]() -> int64_t {
+		return PushStats();
+	});
+
+	return true;
 }
 
 bool WebConsoleServer::Stop()
@@ -80,6 +93,19 @@ bool WebConsoleServer::Stop()
 		return false;
 	}
 
+	if(_stats_timer_id != 0)
+	{
+		ov::SharedTimerWheel::Instance()->Cancel(_stats_timer_id);
+		_stats_timer_id = 0;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_stats_mutex);
+
+		_stats_clients.clear();
+		_last_stats.clear();
+	}
+
 	if(_http_server->Stop())
 	{
 		_http_server = nullptr;
@@ -92,6 +118,12 @@ bool WebConsoleServer::Stop()
 
 bool WebConsoleServer::InitializeServer()
 {
+	// The WebSocket interceptor is checked first, and the other requests are handled by the HTTP interceptor
+	if(InitializeStatsSocket() == false)
+	{
+		return false;
+	}
+
 	auto http_interceptor = std::make_shared<HttpDefaultInterceptor>();
 	ov::String document_root = ov::PathManager::GetCanonicalPath(_web_console.GetDocumentPath());
 
@@ -170,3 +202,233 @@ bool WebConsoleServer::InitializeServer()
 	return _http_server->AddInterceptor(http_interceptor);
 }
 
+
+bool WebConsoleServer::InitializeStatsSocket()
+{
+	auto web_socket = std::make_shared<WebSocketInterceptor>();
+
+	web_socket->SetConnectionHandler([this](const std::shared_ptr<WebSocketClient> &client) -> bool {
+		ov::JsonWriter writer;
+
+		writer.BeginObject()
+			.Member("type", "snapshot")
+			.Member("interval", WEB_CONSOLE_STATS_INTERVAL)
+			.Key("streams")
+			.BeginObject();
+
+		{
+			std::lock_guard<std::mutex> lock_guard(_stats_mutex);
+
+			// The values of the last push, so the console doesn't trigger another walk of the streams
+			for(const auto &item : _last_stats)
+			{
+				WriteStreamStats(writer, item.first, item.second, nullptr);
+			}
+
+			_stats_clients.push_back(client);
+		}
+
+		writer.EndObject().EndObject();
+
+		logti("A console is connected: %s", client->ToString().CStr());
+
+		return client->Send(writer) >= 0;
+	});
+
+	web_socket->SetMessageHandler([](const std::shared_ptr<WebSocketClient> &client, const std::shared_ptr<const WebSocketFrame> &message) -> bool {
+		// The stats are pushed only
+		return true;
+	});
+
+	web_socket->SetErrorHandler([](const std::shared_ptr<WebSocketClient> &client, const std::shared_ptr<const ov::Error> &error) -> void {
+		logtw("An error occurred: %s", error->ToString().CStr());
+	});
+
+	web_socket->SetCloseHandler([this](const std::shared_ptr<WebSocketClient> &client) -> void {
+		std::lock_guard<std::mutex> lock_guard(_stats_mutex);
+
+		_stats_clients.erase(std::remove(_stats_clients.begin(), _stats_clients.end(), client), _stats_clients.end());
+
+		if(_stats_clients.empty())
+		{
+			// The counters are not read until the next console is connected
+			_last_stats.clear();
+		}
+	});
+
+	return _http_server->AddInterceptor(web_socket);
+}
+
+int64_t WebConsoleServer::PushStats()
+{
+	std::vector<std::shared_ptr<WebSocketClient>> clients;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_stats_mutex);
+
+		if(_stats_clients.empty())
+		{
+			return WEB_CONSOLE_STATS_INTERVAL;
+		}
+	}
+
+	// Reads the counters without the lock of the consoles
+	StreamStatsMap stats;
+	CollectStats(stats);
+
+	_stats_writer.Clear();
+	_stats_writer.BeginObject()
+		.Member("type", "delta")
+		.Key("streams")
+		.BeginObject();
+
+	bool has_changes = false;
+
+	{
+		std::lock_guard<std::mutex> lock_guard(_stats_mutex);
+
+		for(const auto &item : stats)
+		{
+			auto last = _last_stats.find(item.first);
+
+			has_changes |= WriteStreamStats(_stats_writer, item.first, item.second, (last != _last_stats.end()) ? &(last->second) : nullptr);
+		}
+
+		_stats_writer.EndObject()
+			.Key("removed")
+			.BeginArray();
+
+		for(const auto &item : _last_stats)
+		{
+			if(stats.find(item.first) == stats.end())
+			{
+				_stats_writer.Value(item.first);
+				has_changes = true;
+			}
+		}
+
+		_stats_writer.EndArray().EndObject();
+
+		_last_stats = std::move(stats);
+		clients = _stats_clients;
+	}
+
+	if(has_changes)
+	{
+		for(const auto &client : clients)
+		{
+			client->Send(_stats_writer);
+		}
+	}
+
+	return WEB_CONSOLE_STATS_INTERVAL;
+}
+
+void WebConsoleServer::CollectStats(StreamStatsMap &stats) const
+{
+	if(_router != nullptr)
+	{
+		auto route_application = _router->GetRouteApplicationById(_application_info->GetId());
+
+		if(route_application != nullptr)
+		{
+			std::vector<std::shared_ptr<MediaRouteStreamMetricsData>> streams;
+
+			route_application->GetStreamMetricsData(streams);
+
+			for(const auto &stream : streams)
+			{
+				stats[stream->stream_name].received_bytes += stream->metrics.received_bytes;
+			}
+		}
+	}
+
+	std::vector<std::shared_ptr<PublisherApplicationMetricsData>> applications;
+	std::vector<std::shared_ptr<PublisherStreamMetricsData>> streams;
+
+	for(const auto &publisher : _publishers)
+	{
+		applications.clear();
+		streams.clear();
+
+		publisher->GetMetricsData(applications, streams);
+
+		for(const auto &stream : streams)
+		{
+			auto &stream_stats = stats[stream->stream_name];
+
+			stream_stats.session_count += stream->metrics.session_count;
+			stream_stats.sent_packet_count += stream->metrics.sent_packet_count;
+			stream_stats.sent_bytes += stream->metrics.sent_bytes;
+			stream_stats.dropped_packet_count += stream->metrics.dropped_packet_count;
+		}
+	}
+}
+
+bool WebConsoleServer::WriteStreamStats(ov::JsonWriter &writer, const ov::String &name, const StreamStats &stats, const StreamStats *last)
+{
+	// The counters are decreased if the stream is recreated with the same name
+	bool reset = (last != nullptr) &&
+	             ((stats.received_bytes < last->received_bytes) ||
+	              (stats.sent_packet_count < last->sent_packet_count) ||
+	              (stats.sent_bytes < last->sent_bytes) ||
+	              (stats.dropped_packet_count < last->dropped_packet_count));
+
+	if(reset)
+	{
+		last = nullptr;
+	}
+
+	StreamStats base;
+
+	if(last != nullptr)
+	{
+		if((stats.session_count == last->session_count) &&
+		   (stats.received_bytes == last->received_bytes) &&
+		   (stats.sent_packet_count == last->sent_packet_count) &&
+		   (stats.sent_bytes == last->sent_bytes) &&
+		   (stats.dropped_packet_count == last->dropped_packet_count))
+		{
+			// Nothing is changed
+			return false;
+		}
+
+		base = *last;
+	}
+
+	writer.Key(name).BeginObject();
+
+	if(reset)
+	{
+		writer.Member("reset", true);
+	}
+
+	if((last == nullptr) || (stats.session_count != base.session_count))
+	{
+		writer.Member("sessions", stats.session_count);
+	}
+
+	if((last == nullptr) || (stats.received_bytes != base.received_bytes))
+	{
+		writer.Member("receivedBytes", stats.received_bytes - base.received_bytes);
+	}
+
+	if((last == nullptr) || (stats.sent_packet_count != base.sent_packet_count))
+	{
+		writer.Member("sentPackets", stats.sent_packet_count - base.sent_packet_count);
+	}
+
+	if((last == nullptr) || (stats.sent_bytes != base.sent_bytes))
+	{
+		writer.Member("sentBytes", stats.sent_bytes - base.sent_bytes);
+	}
+
+	if((last == nullptr) || (stats.dropped_packet_count != base.dropped_packet_count))
+	{
+		writer.Member("droppedPackets", stats.dropped_packet_count - base.dropped_packet_count);
+	}
+
+	writer.EndObject();
+
+	return true;
+}
@@ -8,7 +8,10 @@
 //==============================================================================
 #pragma once
 
+#include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <base/application/application.h>
 #include <base/media_route/media_route_interface.h>
@@ -17,9 +20,13 @@
 #include <http_server/https_server.h>
 #include <http_server/interceptors/http_request_interceptors.h>
 #include <media_router/media_route_application.h>
+#include <media_router/media_router.h>
 #include <relay/relay.h>
 #include "../base/publisher/publisher.h"
 
+// Interval (ms) of the stats which are pushed to the consoles over WebSocket
+#define WEB_CONSOLE_STATS_INTERVAL			1000
+
 class WebConsoleServer : public ov::EnableSharedFromThis<WebConsoleServer>
 {
 protected:
@@ -28,16 +35,56 @@ public:
 	WebConsoleServer(const info::Application *application_info, PrivateToken token);
 	~WebConsoleServer() override = default;
 
-	static std::shared_ptr<WebConsoleServer> Create(const info::Application *application_info);
+	// The stats of the router and the publishers of the application are pushed to the consoles
+	static std::shared_ptr<WebConsoleServer> Create(const info::Application *application_info,
+	                                                const std::shared_ptr<MediaRouter> &router,
+	                                                const std::vector<std::shared_ptr<Publisher>> &publishers);
 
 	bool Start(const ov::SocketAddress &address);
 	bool Stop();
 
 protected:
+	// Counters of a stream (the publishers are summed up)
+	struct StreamStats
+	{
+		size_t session_count = 0;
+		uint64_t received_bytes = 0;
+		uint64_t sent_packet_count = 0;
+		uint64_t sent_bytes = 0;
+		uint64_t dropped_packet_count = 0;
+	};
+
+	// key: stream name
+	typedef std::map<ov::String, StreamStats> StreamStatsMap;
+
 	bool InitializeServer();
+	// The consoles connect with WebSocket to receive the stats:
+	//   {"type": "snapshot", "interval": <ms>, "streams": {<name>: {<all values>}, ...}} after the connection, then
+	//   {"type": "delta", "streams": {<name>: {<changed values>}, ...}, "removed": [<name>, ...]} every interval
+	// - "sessions" is the current value, and the others are the increments since the last message
+	// - "reset": true means the stream is recreated, and the values replace the old ones
+	bool InitializeStatsSocket();
+
+	// Called by the timer: the counters are read once, and the same message is sent to all consoles
+	int64_t PushStats();
+	void CollectStats(StreamStatsMap &stats) const;
+	// last: the values which are sent before (nullptr: a new stream)
+	static bool WriteStreamStats(ov::JsonWriter &writer, const ov::String &name, const StreamStats &stats, const StreamStats *last);
 
 	const info::Application *_application_info;
 	cfg::WebConsole _web_console;
 
 	std::shared_ptr<HttpServer> _http_server;
+
+	std::shared_ptr<MediaRouter> _router;
+	std::vector<std::shared_ptr<Publisher>> _publishers;
+
+	// Protects _stats_clients and _last_stats
+	std::mutex _stats_mutex;
+	std::vector<std::shared_ptr<WebSocketClient>> _stats_clients;
+	// The values which are sent to the consoles (a new console receives them as the snapshot)
+	StreamStatsMap _last_stats;
+	// Used by the timer only
+	ov::JsonWriter _stats_writer;
+	uint64_t _stats_timer_id = 0;
 };
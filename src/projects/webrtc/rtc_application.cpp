@@ -20,6 +20,27 @@ RtcApplication::RtcApplication(const info::Application *application_info,
 {
 	_ice_port = ice_port;
 	_rtc_signalling = rtc_signalling;
+
+	_extension_map.Register(RtpHeaderExtensionType::TransportCc, RTC_TRANSPORT_CC_EXTENSION_ID);
+	_extension_map.Register(RtpHeaderExtensionType::AbsSendTime, RTC_ABS_SEND_TIME_EXTENSION_ID);
+
+	auto publisher_info = application_info->GetPublisher<cfg::WebrtcPublisher>();
+
+	if(publisher_info != nullptr)
+	{
+		SetQueueConfig(publisher_info->GetQueue());
+		_payload_encryption_enabled = publisher_info->GetPayloadEncryption().IsEnabled();
+
+		auto &playout_delay = publisher_info->GetPlayoutDelay();
+
+		if(playout_delay.IsEnabled())
+		{
+			_extension_map.Register(RtpHeaderExtensionType::PlayoutDelay, RTC_PLAYOUT_DELAY_EXTENSION_ID);
+			_extension_map.SetPlayoutDelay(static_cast<uint32_t>(std::max(playout_delay.GetMin(), 0)), static_cast<uint32_t>(std::max(playout_delay.GetMax(), 0)));
+
+			logti("The playout delay of the players is %d~%d ms", playout_delay.GetMin(), playout_delay.GetMax());
+		}
+	}
 }
 
 RtcApplication::~RtcApplication()
@@ -33,6 +54,16 @@ std::shared_ptr<Certificate> RtcApplication::GetCertificate()
 	return _certificate;
 }
 
+bool RtcApplication::IsPayloadEncryptionEnabled() const
+{
+	return _payload_encryption_enabled;
+}
+
+const RtpHeaderExtensionMap &RtcApplication::GetHeaderExtensionMap() const
+{
+	return _extension_map;
+}
+
 std::shared_ptr<Stream> RtcApplication::CreateStream(std::shared_ptr<StreamInfo> info, uint32_t worker_count)
 {
 	// Stream Class 생성할때는 복사를 사용한다.
@@ -80,26 +111,21 @@ bool RtcApplication::DeleteStream(std::shared_ptr<StreamInfo> info)
 // 전송
 void RtcApplication::SendVideoFrame(std::shared_ptr<StreamInfo> info,
                                     std::shared_ptr<MediaTrack> track,
-                                    std::unique_ptr<EncodedFrame> encoded_frame,
-                                    std::unique_ptr<CodecSpecificInfo> codec_info,
-                                    std::unique_ptr<FragmentationHeader> fragmentation)
+                                    std::unique_ptr<EncodedFrameDescriptor> frame)
 {
 	// 향후 필요한 경우 추가 동작을 구현한다.
 
-	Application::SendVideoFrame(info, track, std::move(encoded_frame), std::move(codec_info), std::move(fragmentation));
+	Application::SendVideoFrame(info, track, std::move(frame));
 }
 
 bool RtcApplication::Start()
 {
 	if(_certificate == nullptr)
 	{
-		// 인증서를 생성한다.
-		_certificate = std::make_shared<Certificate>();
+		_certificate = GetDtlsCertificate();
 
-		auto error = _certificate->Generate();
-		if(error != nullptr)
+		if(_certificate == nullptr)
 		{
-			logte("Cannot create certificate: %s", error->ToString().CStr());
 			return false;
 		}
 
@@ -109,6 +135,31 @@ bool RtcApplication::Start()
 	return Application::Start();
 }
 
+std::shared_ptr<Certificate> RtcApplication::GetDtlsCertificate()
+{
+	static std::mutex certificate_mutex;
+	static std::shared_ptr<Certificate> certificate;
+
+	std::lock_guard<std::mutex> lock_guard(certificate_mutex);
+
+	if(certificate == nullptr)
+	{
+		// 인증서를 생성한다.
+		auto new_certificate = std::make_shared<Certificate>();
+
+		auto error = new_certificate->Generate();
+		if(error != nullptr)
+		{
+			logte("Cannot create certificate: %s", error->ToString().CStr());
+			return nullptr;
+		}
+
+		certificate = new_certificate;
+	}
+
+	return certificate;
+}
+
 bool RtcApplication::Stop()
 {
 	// TODO(dimiden): Application이 종료되는 경우는 향후 Application 단위의 재시작 기능이 개발되면 필요함
@@ -21,6 +21,10 @@ public:
 	~RtcApplication() final;
 
 	std::shared_ptr<Certificate> GetCertificate();
+	// true if the payloads are encrypted once per stream (research mode, see RtpPayloadEncryptor)
+	bool IsPayloadEncryptionEnabled() const;
+	// RTP header extensions of the streams (transport-wide CC, abs-send-time and the playout delay if it is configured)
+	const RtpHeaderExtensionMap &GetHeaderExtensionMap() const;
 
     void OnReceiverReport(uint32_t stream_id,
                         uint32_t session_id,
@@ -31,12 +35,14 @@ private:
 	bool Start() override;
 	bool Stop() override;
 
+	// The self-signed certificate for DTLS is generated once, and shared by all WebRTC applications
+	// (the fingerprint is sent by the SDP of each session, so it doesn't need to be different per application)
+	static std::shared_ptr<Certificate> GetDtlsCertificate();
+
 
 	void SendVideoFrame(std::shared_ptr<StreamInfo> info,
 	                    std::shared_ptr<MediaTrack> track,
-	                    std::unique_ptr<EncodedFrame> encoded_frame,
-	                    std::unique_ptr<CodecSpecificInfo> codec_info,
-	                    std::unique_ptr<FragmentationHeader> fragmentation) override;
+	                    std::unique_ptr<EncodedFrameDescriptor> frame) override;
 
 	// Application Implementation
 	std::shared_ptr<Stream> CreateStream(std::shared_ptr<StreamInfo> info, uint32_t worker_count) override;
@@ -45,4 +51,6 @@ private:
 	std::shared_ptr<IcePort> _ice_port;
 	std::shared_ptr<RtcSignallingServer> _rtc_signalling;
 	std::shared_ptr<Certificate> _certificate;
+	bool _payload_encryption_enabled = false;
+	RtpHeaderExtensionMap _extension_map;
 };
\ No newline at end of file
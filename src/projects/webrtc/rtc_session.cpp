@@ -9,10 +9,14 @@ std::shared_ptr<RtcSession> RtcSession::Create(std::shared_ptr<Application> appl
                                                std::shared_ptr<Stream> stream,
                                                std::shared_ptr<SessionDescription> offer_sdp,
                                                std::shared_ptr<SessionDescription> peer_sdp,
-                                               std::shared_ptr<IcePort> ice_port)
+                                               std::shared_ptr<IcePort> ice_port,
+                                               const std::map<uint8_t, uint8_t> &payload_type_map,
+                                               const RtpHeaderExtensionMap &peer_extension_map)
 {
 	auto session_info = SessionInfo(peer_sdp->GetSessionId());
 	auto session = std::make_shared<RtcSession>(session_info, application, stream, offer_sdp, peer_sdp, ice_port);
+	session->_payload_type_map = payload_type_map;
+	session->_peer_extension_map = peer_extension_map;
 	if(!session->Start())
 	{
 		return nullptr;
@@ -79,11 +83,20 @@ bool RtcSession::Start()
 		if(peer_media_desc->GetMediaType() == MediaDescription::MediaType::Audio)
 		{
 			_audio_payload_type = first_payload->GetId();
+			_audio_ssrc = offer_media_desc->GetSsrc();
 		}
 		else
 		{
+			// FlexFEC is preferred because the media packets are not wrapped
+			if((peer_media_desc->GetPayload(FLEXFEC_PAYLOAD_TYPE) != nullptr) && (offer_media_desc->GetFecSsrc() != 0) &&
+			   (first_payload->GetId() != RED_PAYLOAD_TYPE))
+			{
+				_video_payload_type = first_payload->GetId();
+				_flexfec_payload_type = FLEXFEC_PAYLOAD_TYPE;
+				_flexfec_ssrc = offer_media_desc->GetFecSsrc();
+			}
 			// If there is a RED
-			if(peer_media_desc->GetPayload(RED_PAYLOAD_TYPE))
+			else if(peer_media_desc->GetPayload(RED_PAYLOAD_TYPE))
 			{
 				_video_payload_type = RED_PAYLOAD_TYPE;
 				_red_block_pt = first_payload->GetId();
@@ -99,6 +112,58 @@ bool RtcSession::Start()
 		// peer에서 받기 거부한 m= line이 있는지 체크하여 track에서 뺀다, 현재는 다 받기 때문에 모두 보낸다.
 	}
 
+	// Video tracks of the stream can be switched if the peer receives several of them
+	auto stream = std::static_pointer_cast<RtcStream>(GetStream());
+
+	for(size_t i = 0; i < peer_media_desc_list.size(); i++)
+	{
+		auto peer_media_desc = peer_media_desc_list[i];
+
+		if(peer_media_desc->GetMediaType() != MediaDescription::MediaType::Video)
+		{
+			continue;
+		}
+
+		uint8_t current_payload_type = (_video_payload_type == RED_PAYLOAD_TYPE) ? _red_block_pt : _video_payload_type;
+
+		for(const auto &layer : stream->GetVideoLayers())
+		{
+			if(peer_media_desc->GetPayload(layer.payload_type) == nullptr)
+			{
+				continue;
+			}
+
+			if(layer.payload_type == current_payload_type)
+			{
+				_current_layer = _video_layers.size();
+			}
+
+			_video_layers.push_back(layer);
+		}
+
+		if((_video_layers.empty() == false) && (_video_layers[_current_layer].payload_type != current_payload_type))
+		{
+			// The peer selected the payload which is not a layer (switching is disabled)
+			_video_layers.clear();
+		}
+
+		_video_ssrc = offer_media_desc_list[i]->GetSsrc();
+		break;
+	}
+
+	if(_video_layers.size() > 1)
+	{
+		_target_layer = _current_layer;
+		_loss_layer = _current_layer;
+
+		logtd("Video layers of the session: %zu (current: %zu)", _video_layers.size(), _current_layer);
+	}
+
+	if(_video_layers.empty() == false)
+	{
+		_loss_temporal_layer = std::max(_video_layers[0].temporal_layer_count, static_cast<uint8_t>(1)) - 1;
+	}
+
 	// SessionNode를 생성하고 연결한다.
 	std::vector<uint32_t> ssrc_list;
 	for(auto media : _offer_sdp->GetMediaList())
@@ -109,9 +174,92 @@ bool RtcSession::Start()
     // RTP RTCP 생성
 	_rtp_rtcp = std::make_shared<RtpRtcp>((uint32_t)SessionNodeType::RtpRtcp, session, ssrc_list);
 
+	for(auto &media : _offer_sdp->GetMediaList())
+	{
+		auto first_payload = media->GetFirstPayload();
+
+		if(first_payload != nullptr)
+		{
+			_rtp_rtcp->SetClockRate(media->GetSsrc(), first_payload->GetCodecRate());
+		}
+	}
+
+	if(_payload_type_map.empty() == false)
+	{
+		_rtp_rtcp->SetPayloadTypeMap(_payload_type_map);
+	}
+
+	if(IsLayered() || (_video_payload_type == RED_PAYLOAD_TYPE) || (_flexfec_payload_type != 0))
+	{
+		// The packetizers of the layers have their own sequence numbers,
+		// and the FEC packets and the temporal layers which are not sent must not make a gap
+		_rtp_rtcp->EnableSequenceNumberRewriting(_video_ssrc);
+	}
+
+	if(_flexfec_payload_type != 0)
+	{
+		_rtp_rtcp->EnableSequenceNumberRewriting(_flexfec_ssrc);
+		_rtp_rtcp->EnableFlexfec(_flexfec_ssrc, _video_ssrc);
+
+		logtd("FlexFEC is used for the session(%u) (ssrc: %u)", GetId(), _flexfec_ssrc);
+	}
+
+	// NACK/RTX
+	for(size_t i = 0; i < peer_media_desc_list.size(); i++)
+	{
+		auto peer_media_desc = peer_media_desc_list[i];
+		auto offer_media_desc = offer_media_desc_list[i];
+
+		if(peer_media_desc->GetMediaType() != MediaDescription::MediaType::Video)
+		{
+			continue;
+		}
+
+		auto first_payload = peer_media_desc->GetFirstPayload();
+
+		if((_video_payload_type == RED_PAYLOAD_TYPE) && (offer_media_desc->GetRtxSsrc() != 0) &&
+		   (peer_media_desc->GetPayload(RTX_PAYLOAD_TYPE) != nullptr))
+		{
+			_rtp_rtcp->EnableRtx(offer_media_desc->GetSsrc(), offer_media_desc->GetRtxSsrc(), RTX_PAYLOAD_TYPE);
+		}
+		else if(first_payload->IsRtcpFbEnabled(PayloadAttr::RtcpFbType::Nack))
+		{
+			_rtp_rtcp->EnableNack(offer_media_desc->GetSsrc());
+		}
+	}
+
+	// Header extensions (the transport-wide sequence number is shared by all media of the session)
+	auto peer_extension_map = _peer_extension_map;
+
+	if(peer_extension_map.IsEmpty())
+	{
+		// The peer answered the offer of the stream, so the ids of the answer are used
+		for(auto &peer_media_desc : peer_media_desc_list)
+		{
+			for(auto &extmap : peer_media_desc->GetExtmaps())
+			{
+				peer_extension_map.Register(extmap.second, extmap.first);
+			}
+		}
+	}
+
+	if(stream->GetHeaderExtensionMap().IsEmpty() == false)
+	{
+		_rtp_rtcp->SetHeaderExtensions(stream->GetHeaderExtensionMap(), peer_extension_map);
+	}
+
 	// SRTP 생성
 	_srtp_transport = std::make_shared<SrtpTransport>((uint32_t)SessionNodeType::Srtp, session);
 
+	// The payloads are encrypted by the stream, so only the key is delivered to the session (research mode)
+	auto media_key_packet = stream->MakeMediaKeyPacket(ssrc_list.empty() ? 0 : ssrc_list[0]);
+
+	if(media_key_packet != nullptr)
+	{
+		_rtp_rtcp->SetMediaKeyPacket(media_key_packet);
+		_srtp_transport->SetRtpAuthenticationOnly(true);
+	}
+
 	// DTLS 생성
 	_dtls_transport = std::make_shared<DtlsTransport>((uint32_t)SessionNodeType::Dtls, session);
 	std::shared_ptr<RtcApplication> application = std::static_pointer_cast<RtcApplication>(GetApplication());
@@ -147,6 +295,18 @@ bool RtcSession::Stop()
 		return true;
 	}
 
+	// The packets are not sent by the egress path any more, and it is not compiled again
+	{
+		std::lock_guard<std::mutex> lock(_egress_path_mutex);
+
+		_egress_path_compiled = true;
+
+		if(_rtp_rtcp != nullptr)
+		{
+			_rtp_rtcp->SetEgressPath(nullptr);
+		}
+	}
+
 	// 연결된 세션을 정리한다.
 	if(_rtp_rtcp != nullptr)
 	{
@@ -194,12 +354,18 @@ void RtcSession::OnPacketReceived(std::shared_ptr<SessionInfo> session_info, std
 	_dtls_ice_transport->OnDataReceived(SessionNodeType::None, data);
 }
 
-bool RtcSession::SendOutgoingData(uint32_t packet_type, std::shared_ptr<ov::Data> packet)
+bool RtcSession::IsAcceptablePacket(uint32_t packet_type)
 {
 	auto rtp_payload_type = static_cast<uint8_t>(packet_type & 0xFF);
 	auto red_block_pt = static_cast<uint8_t>((packet_type & 0xFF00) >> 8);
 	auto origin_pt_of_fec = static_cast<uint8_t>((packet_type & 0xFF0000) >> 16);
 
+	if((_flexfec_payload_type != 0) && (rtp_payload_type == _flexfec_payload_type))
+	{
+		// FlexFEC packet of the current layer
+		return (origin_pt_of_fec == _video_payload_type);
+	}
+
 	if(rtp_payload_type != _video_payload_type && rtp_payload_type != _audio_payload_type)
 	{
 		return false;
@@ -217,5 +383,617 @@ bool RtcSession::SendOutgoingData(uint32_t packet_type, std::shared_ptr<ov::Data
 	//printf("pt:%d session v pt:%d red pt:%d session red pt : %d origin pt:%d  session a pt:%d\n",
 	//	   rtp_payload_type, _video_payload_type, red_block_pt, _red_block_pt, origin_pt_of_fec, _audio_payload_type);
 
+	return true;
+}
+
+bool RtcSession::IsDroppedFecPacket(uint32_t packet_type)
+{
+	if(_fec_enabled)
+	{
+		return false;
+	}
+
+	auto rtp_payload_type = static_cast<uint8_t>(packet_type & 0xFF);
+	auto red_block_pt = static_cast<uint8_t>((packet_type & 0xFF00) >> 8);
+
+	if(_flexfec_payload_type != 0)
+	{
+		return (rtp_payload_type == _flexfec_payload_type);
+	}
+
+	return (_video_payload_type == RED_PAYLOAD_TYPE) && (rtp_payload_type == RED_PAYLOAD_TYPE) && (red_block_pt == ULPFEC_PAYLOAD_TYPE);
+}
+
+uint32_t RtcSession::GetFecSsrc()
+{
+	return (_flexfec_payload_type != 0) ? _flexfec_ssrc : _video_ssrc;
+}
+
+void RtcSession::UpdateFecProtection(uint8_t fraction_lost)
+{
+	_fec_fraction_lost = (_fec_fraction_lost * 3 + fraction_lost) / 4;
+
+	uint32_t protection_rate = UlpfecGenerator::GetProtectionRate(static_cast<uint8_t>(_fec_fraction_lost));
+	bool fec_enabled = (protection_rate > 0);
+
+	if(_fec_enabled.exchange(fec_enabled) != fec_enabled)
+	{
+		logtd("FEC of the session(%u) is %s (fraction lost: %u/256)", GetId(), fec_enabled ? "enabled" : "disabled", _fec_fraction_lost);
+	}
+
+	std::static_pointer_cast<RtcStream>(GetStream())->UpdateFecProtectionRate(protection_rate);
+}
+
+bool RtcSession::IsLayered() const
+{
+	return (_video_layers.size() > 1) || ((_video_layers.empty() == false) && (_video_layers[0].temporal_layer_count > 1));
+}
+
+bool RtcSession::IsDroppedTemporalLayerPacket(uint32_t packet_type)
+{
+	uint8_t target_temporal_layer = _target_temporal_layer;
+
+	if(target_temporal_layer < _current_temporal_layer)
+	{
+		// The lower layers do not reference the upper layers
+		_current_temporal_layer = target_temporal_layer;
+	}
+	else if((target_temporal_layer > _current_temporal_layer) &&
+	        ((packet_type & (RTC_PACKET_FLAG_KEY_FRAME | RTC_PACKET_FLAG_FRAME_START)) == (RTC_PACKET_FLAG_KEY_FRAME | RTC_PACKET_FLAG_FRAME_START)))
+	{
+		// The frames of the upper layers may reference the frames which the peer did not receive
+		_current_temporal_layer = target_temporal_layer;
+	}
+
+	return ((packet_type & RTC_PACKET_TEMPORAL_LAYER_MASK) >> RTC_PACKET_TEMPORAL_LAYER_SHIFT) > _current_temporal_layer;
+}
+
+bool RtcSession::SwitchVideoLayer(uint32_t packet_type)
+{
+	if(_video_layers.size() < 2)
+	{
+		return false;
+	}
+
+	size_t target_layer = _target_layer;
+
+	if((target_layer == _current_layer) ||
+	   ((packet_type & (RTC_PACKET_FLAG_KEY_FRAME | RTC_PACKET_FLAG_FRAME_START)) != (RTC_PACKET_FLAG_KEY_FRAME | RTC_PACKET_FLAG_FRAME_START)))
+	{
+		return false;
+	}
+
+	auto rtp_payload_type = static_cast<uint8_t>(packet_type & 0xFF);
+	auto red_block_pt = static_cast<uint8_t>((packet_type & 0xFF00) >> 8);
+	uint8_t target_payload_type = _video_layers[target_layer].payload_type;
+
+	if(_video_payload_type == RED_PAYLOAD_TYPE)
+	{
+		if((rtp_payload_type != RED_PAYLOAD_TYPE) || (red_block_pt != target_payload_type))
+		{
+			return false;
+		}
+
+		_red_block_pt = target_payload_type;
+	}
+	else
+	{
+		if(rtp_payload_type != target_payload_type)
+		{
+			return false;
+		}
+
+		_video_payload_type = target_payload_type;
+	}
+
+	logtd("Video layer of the session(%u) is switched: %zu -> %zu (payload type: %d)", GetId(), _current_layer, target_layer, target_payload_type);
+
+	_current_layer = target_layer;
+
+	return true;
+}
+
+void RtcSession::UpdateTargetLayer(int64_t current_time)
+{
+	size_t target_layer = _loss_layer;
+	// The estimated bitrate, limited by the share of the quota of the application (0: unknown)
+	uint64_t available_bitrate = ((_estimated_bitrate > 0) && ((current_time - _estimated_bitrate_time) <= RTC_LAYER_REMB_TIMEOUT_MS)) ? _estimated_bitrate : 0;
+	uint64_t egress_bitrate_limit = _egress_bitrate_limit;
+
+	if((egress_bitrate_limit > 0) && ((available_bitrate == 0) || (egress_bitrate_limit < available_bitrate)))
+	{
+		available_bitrate = egress_bitrate_limit;
+	}
+
+	if(available_bitrate > 0)
+	{
+		// The highest layer which the estimated bitrate can afford (the lowest layer if nothing)
+		size_t bitrate_layer = 0;
+
+		for(size_t index = 0; index < _video_layers.size(); index++)
+		{
+			if(static_cast<uint64_t>(std::max(_video_layers[index].bitrate, 0)) <= available_bitrate)
+			{
+				bitrate_layer = index;
+			}
+		}
+
+		target_layer = std::min(target_layer, bitrate_layer);
+	}
+
+	int32_t max_video_height = _max_video_height;
+
+	if(max_video_height > 0)
+	{
+		// The highest layer which is not taller than the cap of the subscription (the lowest layer if nothing)
+		size_t height_layer = 0;
+
+		for(size_t index = 0; index < _video_layers.size(); index++)
+		{
+			if(_video_layers[index].height <= max_video_height)
+			{
+				height_layer = index;
+			}
+		}
+
+		target_layer = std::min(target_layer, height_layer);
+	}
+
+	if(_target_layer.exchange(target_layer) != target_layer)
+	{
+		logtd("Target video layer of the session(%u) is changed to %zu (loss layer: %zu, estimated bitrate: %llu, limit: %llu)",
+			  GetId(), target_layer, _loss_layer, _estimated_bitrate, static_cast<unsigned long long>(egress_bitrate_limit));
+
+		// The layer is switched at the next key frame of the target layer
+		if(target_layer != _current_layer)
+		{
+			RequestKeyFrame(_video_layers[target_layer].payload_type);
+		}
+	}
+
+	uint8_t temporal_layer_count = std::max(_video_layers[target_layer].temporal_layer_count, static_cast<uint8_t>(1));
+	uint8_t temporal_layer = temporal_layer_count - 1;
+
+	if((target_layer == 0) && (temporal_layer_count > 1))
+	{
+		temporal_layer = std::min(temporal_layer, _loss_temporal_layer);
+
+		if(available_bitrate > 0)
+		{
+			// The highest temporal layer which the estimated bitrate can afford (the base layer if nothing)
+			uint8_t bitrate_temporal_layer = 0;
+			auto bitrate = static_cast<uint64_t>(std::max(_video_layers[0].bitrate, 0));
+
+			for(uint8_t layer = 1; layer < temporal_layer_count; layer++)
+			{
+				if((bitrate * VideoTrack::GetTemporalLayerBitrateRatio(temporal_layer_count, layer) / 100) <= available_bitrate)
+				{
+					bitrate_temporal_layer = layer;
+				}
+			}
+
+			temporal_layer = std::min(temporal_layer, bitrate_temporal_layer);
+		}
+	}
+
+	uint8_t previous_temporal_layer = _target_temporal_layer.exchange(temporal_layer);
+
+	if(previous_temporal_layer != temporal_layer)
+	{
+		logtd("Target temporal layer of the session(%u) is changed to %d (loss layer: %d)", GetId(), temporal_layer, _loss_temporal_layer);
+
+		// The upper layers are added at the next key frame
+		if(temporal_layer > previous_temporal_layer)
+		{
+			RequestKeyFrame(_video_layers[target_layer].payload_type);
+		}
+	}
+}
+
+bool RtcSession::IsUnsubscribedPacket(uint32_t packet_type)
+{
+	auto rtp_payload_type = static_cast<uint8_t>(packet_type & 0xFF);
+	auto red_block_pt = static_cast<uint8_t>((packet_type & 0xFF00) >> 8);
+
+	if(rtp_payload_type == _audio_payload_type)
+	{
+		if(_audio_subscribed == false)
+		{
+			_audio_sending = false;
+			return true;
+		}
+
+		if(_audio_sending == false)
+		{
+			// The sequence continues from the last packet before the pause
+			_rtp_rtcp->RebaseSequenceNumber(_audio_ssrc);
+			_audio_sending = true;
+		}
+
+		return false;
+	}
+
+	// The packets of the video (including FEC)
+	if(_video_subscribed == false)
+	{
+		_video_sending = false;
+		return true;
+	}
+
+	if(_video_sending)
+	{
+		return false;
+	}
+
+	bool is_fec_packet = ((_flexfec_payload_type != 0) && (rtp_payload_type == _flexfec_payload_type)) ||
+	                     ((rtp_payload_type == RED_PAYLOAD_TYPE) && (red_block_pt == ULPFEC_PAYLOAD_TYPE));
+
+	if(is_fec_packet ||
+	   ((packet_type & (RTC_PACKET_FLAG_KEY_FRAME | RTC_PACKET_FLAG_FRAME_START)) != (RTC_PACKET_FLAG_KEY_FRAME | RTC_PACKET_FLAG_FRAME_START)))
+	{
+		// The frames before the key frame reference the frames which the peer did not receive
+		return true;
+	}
+
+	_rtp_rtcp->RebaseSequenceNumber(_video_ssrc);
+
+	if(_flexfec_payload_type != 0)
+	{
+		_rtp_rtcp->RebaseSequenceNumber(_flexfec_ssrc);
+	}
+
+	_video_sending = true;
+
+	logtd("Video of the session(%u) is resumed", GetId());
+
+	return false;
+}
+
+void RtcSession::SetSubscription(bool audio, bool video, int32_t max_height)
+{
+	if(_rtp_rtcp == nullptr)
+	{
+		// Not started
+		return;
+	}
+
+	// The packets which are not sent must not make a gap of the sequence
+	if((audio == false) && (_audio_ssrc != 0))
+	{
+		_rtp_rtcp->EnableSequenceNumberRewriting(_audio_ssrc);
+	}
+
+	if((video == false) && (_video_ssrc != 0))
+	{
+		_rtp_rtcp->EnableSequenceNumberRewriting(_video_ssrc);
+
+		if(_flexfec_payload_type != 0)
+		{
+			_rtp_rtcp->EnableSequenceNumberRewriting(_flexfec_ssrc);
+		}
+	}
+
+	_audio_subscribed = audio;
+	_max_video_height = std::max(max_height, 0);
+
+	if((_video_subscribed.exchange(video) == false) && video && (_video_ssrc != 0))
+	{
+		// The video is resumed at the key frame
+		OnKeyFrameRequested(_video_ssrc);
+	}
+
+	logti("Subscription of the session(%u) is changed (audio: %s, video: %s, max height: %d)", GetId(), audio ? "true" : "false", video ? "true" : "false", max_height);
+}
+
+void RtcSession::OnKeyFrameRequested(uint32_t media_ssrc)
+{
+	if((_video_ssrc == 0) || (media_ssrc != _video_ssrc))
+	{
+		logtd("Key frame request of the session(%u) is not for the video (ssrc: %u)", GetId(), media_ssrc);
+		return;
+	}
+
+	uint8_t payload_type;
+
+	if(_video_layers.size() > 1)
+	{
+		// The player waits for the key frame of the layer which it will receive
+		payload_type = _video_layers[_target_layer].payload_type;
+	}
+	else
+	{
+		payload_type = (_video_payload_type == RED_PAYLOAD_TYPE) ? _red_block_pt : _video_payload_type;
+	}
+
+	RequestKeyFrame(payload_type);
+}
+
+void RtcSession::RequestKeyFrame(uint8_t payload_type)
+{
+	auto stream = std::static_pointer_cast<RtcStream>(GetStream());
+
+	if((stream == nullptr) || (stream->RequestKeyFrame(payload_type) == false))
+	{
+		logtd("Key frame of the track(%d) is not requested by the session(%u)", payload_type, GetId());
+	}
+}
+
+void RtcSession::OnReceiverReport(const std::shared_ptr<RtcpReceiverReport> &receiver_report)
+{
+	if(((_video_payload_type == RED_PAYLOAD_TYPE) || (_flexfec_payload_type != 0)) && (receiver_report->ssrc_1 == _video_ssrc))
+	{
+		UpdateFecProtection(receiver_report->fraction_lost);
+	}
+
+	if((IsLayered() == false) || (receiver_report->ssrc_1 != _video_ssrc))
+	{
+		return;
+	}
+
+	int64_t current_time = RtpPacketHistory::GetCurrentMilliseconds();
+	int64_t elapsed = current_time - _loss_layer_changed_time;
+
+	// The temporal layers of the lowest layer are dropped after the other layers, and restored before them
+	if(receiver_report->fraction_lost >= RTC_LAYER_LOSS_HIGH_THRESHOLD)
+	{
+		if((_loss_layer > 0) && (elapsed >= RTC_LAYER_DOWN_INTERVAL_MS))
+		{
+			_loss_layer--;
+			_loss_layer_changed_time = current_time;
+		}
+		else if((_loss_layer == 0) && (_loss_temporal_layer > 0) && (elapsed >= RTC_LAYER_DOWN_INTERVAL_MS))
+		{
+			_loss_temporal_layer--;
+			_loss_layer_changed_time = current_time;
+		}
+	}
+	else if(receiver_report->fraction_lost <= RTC_LAYER_LOSS_LOW_THRESHOLD)
+	{
+		if(((_loss_temporal_layer + 1) < _video_layers[0].temporal_layer_count) && (elapsed >= RTC_LAYER_UP_INTERVAL_MS))
+		{
+			_loss_temporal_layer++;
+			_loss_layer_changed_time = current_time;
+		}
+		else if(((_loss_layer + 1) < _video_layers.size()) && (elapsed >= RTC_LAYER_UP_INTERVAL_MS))
+		{
+			_loss_layer++;
+			_loss_layer_changed_time = current_time;
+		}
+	}
+
+	UpdateTargetLayer(current_time);
+}
+
+void RtcSession::OnEstimatedBitrate(uint64_t bitrate)
+{
+	if(IsLayered() == false)
+	{
+		return;
+	}
+
+	int64_t current_time = RtpPacketHistory::GetCurrentMilliseconds();
+
+	_estimated_bitrate = bitrate;
+	_estimated_bitrate_time = current_time;
+
+	UpdateTargetLayer(current_time);
+}
+
+void RtcSession::SetPacingRate(uint64_t rate)
+{
+	_ice_port->SetPacingRate(GetId(), rate);
+}
+
+uint64_t RtcSession::GetEstimatedBitrate()
+{
+	if(_rtp_rtcp == nullptr)
+	{
+		return 0;
+	}
+
+	return _rtp_rtcp->GetEstimatedBitrate();
+}
+
+size_t RtcSession::GetMemoryUsage()
+{
+	size_t memory_usage = _outgoing_packets.capacity() * sizeof(std::shared_ptr<const ov::Data>);
+
+	if(_rtp_rtcp != nullptr)
+	{
+		memory_usage += _rtp_rtcp->GetMemoryUsage();
+	}
+
+	return memory_usage;
+}
+
+int64_t RtcSession::ProcessPacing()
+{
+	if(_rtp_rtcp == nullptr)
+	{
+		return -1;
+	}
+
+	return _rtp_rtcp->ProcessPacing();
+}
+
+bool RtcSession::SendReport(int64_t current_time)
+{
+	if(_rtp_rtcp == nullptr)
+	{
+		return false;
+	}
+
+	auto stream = std::static_pointer_cast<RtcStream>(GetStream());
+
+	if(stream == nullptr)
+	{
+		return false;
+	}
+
+	// The SR is sent after the first RR of the peer, the timer keeps running until then
+	_rtp_rtcp->SendSenderReports(*stream->GetSrTemplate(current_time));
+
+	return true;
+}
+
+void RtcSession::SetEgressBitrateLimit(uint64_t bitrate)
+{
+	if((_egress_bitrate_limit.exchange(bitrate) == bitrate) || (_rtp_rtcp == nullptr))
+	{
+		return;
+	}
+
+	_rtp_rtcp->SetMaxPacingRate(bitrate);
+}
+
+bool RtcSession::IsReadyToSend()
+{
+	return (_srtp_transport != nullptr) && _srtp_transport->IsSendReady();
+}
+
+void RtcSession::CompileEgressPath()
+{
+	std::lock_guard<std::mutex> lock(_egress_path_mutex);
+
+	if(_egress_path_compiled || (IsReadyToSend() == false))
+	{
+		return;
+	}
+
+	auto send_session = _srtp_transport->GetSendSession();
+	auto connection = _ice_port->GetConnection(GetId());
+
+	if((send_session == nullptr) || (connection == nullptr))
+	{
+		return;
+	}
+
+	_rtp_rtcp->SetEgressPath(std::make_shared<SrtpEgressPath>(send_session, _ice_port, connection));
+	_egress_path_compiled = true;
+
+	logtd("Egress path is compiled - session(%d)", GetId());
+}
+
+bool RtcSession::SendOutgoingData(uint32_t packet_type, const std::shared_ptr<const ov::Data> &packet)
+{
+	ov::MemoryTagScope memory_tag(ov::MemoryTag::Session);
+
+	if(_egress_path_compiled == false)
+	{
+		CompileEgressPath();
+	}
+
+	if(SwitchVideoLayer(packet_type))
+	{
+		_rtp_rtcp->RebaseSequenceNumber(_video_ssrc);
+
+		if(_flexfec_payload_type != 0)
+		{
+			_rtp_rtcp->RebaseSequenceNumber(_flexfec_ssrc);
+		}
+	}
+
+	if(IsAcceptablePacket(packet_type) == false)
+	{
+		return false;
+	}
+
+	if(IsUnsubscribedPacket(packet_type))
+	{
+		return false;
+	}
+
+	if(IsDroppedFecPacket(packet_type))
+	{
+		// The next packet continues the sequence number
+		_rtp_rtcp->RebaseSequenceNumber(GetFecSsrc());
+		return false;
+	}
+
+	if(IsDroppedTemporalLayerPacket(packet_type))
+	{
+		_rtp_rtcp->RebaseSequenceNumber(((packet_type & 0xFF) == FLEXFEC_PAYLOAD_TYPE) ? _flexfec_ssrc : _video_ssrc);
+		return false;
+	}
+
 	return _rtp_rtcp->SendOutgoingData(packet);
+}
+
+bool RtcSession::SendOutgoingData(const std::vector<std::shared_ptr<StreamPacket>> &packets)
+{
+	ov::MemoryTagScope memory_tag(ov::MemoryTag::Session);
+
+	if(_egress_path_compiled == false)
+	{
+		CompileEgressPath();
+	}
+
+	// Collect the packets that the peer receives, and send them at once
+	_outgoing_packets.clear();
+
+	for(auto &packet : packets)
+	{
+		// The worker dropped the stale video packets before this packet, so the sequence must continue without the gap
+		if(SwitchVideoLayer(packet->_type) || packet->_discontinuity)
+		{
+			// The packets of the previous layer keep their sequence numbers
+			if(_outgoing_packets.empty() == false)
+			{
+				_rtp_rtcp->SendOutgoingData(_outgoing_packets);
+				_outgoing_packets.clear();
+			}
+
+			_rtp_rtcp->RebaseSequenceNumber(_video_ssrc);
+
+			if(_flexfec_payload_type != 0)
+			{
+				_rtp_rtcp->RebaseSequenceNumber(_flexfec_ssrc);
+			}
+		}
+
+		if(IsAcceptablePacket(packet->_type) == false)
+		{
+			continue;
+		}
+
+		// The collected packets are not of the resumed track (its packets before were dropped), so they keep their sequence numbers
+		if(IsUnsubscribedPacket(packet->_type))
+		{
+			continue;
+		}
+
+		if(IsDroppedFecPacket(packet->_type))
+		{
+			// The collected packets keep their sequence numbers, and the next packet continues them
+			if(_outgoing_packets.empty() == false)
+			{
+				_rtp_rtcp->SendOutgoingData(_outgoing_packets);
+				_outgoing_packets.clear();
+			}
+
+			_rtp_rtcp->RebaseSequenceNumber(GetFecSsrc());
+			continue;
+		}
+
+		if(IsDroppedTemporalLayerPacket(packet->_type))
+		{
+			if(_outgoing_packets.empty() == false)
+			{
+				_rtp_rtcp->SendOutgoingData(_outgoing_packets);
+				_outgoing_packets.clear();
+			}
+
+			_rtp_rtcp->RebaseSequenceNumber(((packet->_type & 0xFF) == FLEXFEC_PAYLOAD_TYPE) ? _flexfec_ssrc : _video_ssrc);
+			continue;
+		}
+
+		_outgoing_packets.push_back(packet->_data);
+	}
+
+	if(_outgoing_packets.empty())
+	{
+		return false;
+	}
+
+	return _rtp_rtcp->SendOutgoingData(_outgoing_packets);
 }
\ No newline at end of file
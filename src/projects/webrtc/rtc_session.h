@@ -9,6 +9,20 @@
 #include "rtp_rtcp/rtp_rtcp.h"
 #include "rtp_rtcp/rtp_rtcp_interface.h"
 #include "dtls_srtp/dtls_transport.h"
+#include "dtls_srtp/srtp_egress_path.h"
+
+#include <atomic>
+
+// Video layer selection by the RTCP feedback of the peer
+// - fraction lost (1/256) of RR: the layer is lowered above HIGH (about 10%), raised below LOW (about 2%)
+#define RTC_LAYER_LOSS_HIGH_THRESHOLD		(26)
+#define RTC_LAYER_LOSS_LOW_THRESHOLD		(5)
+#define RTC_LAYER_DOWN_INTERVAL_MS			(2000)
+#define RTC_LAYER_UP_INTERVAL_MS			(10000)
+// REMB is ignored if it has not been received for this time
+#define RTC_LAYER_REMB_TIMEOUT_MS			(5000)
+// All temporal layers of the video are sent
+#define RTC_TEMPORAL_LAYER_ALL				(0xFF)
 
 /*
  *
@@ -40,6 +54,18 @@
 class RtcApplication;
 class RtcStream;
 
+// A video track (rendition) which a session can select
+struct RtcVideoLayer
+{
+	uint8_t payload_type;
+	// bps (0 if unknown)
+	int32_t bitrate;
+	// Temporal layers of the track (1: no layer)
+	uint8_t temporal_layer_count;
+	// Used by the resolution cap of the subscription (0 if unknown)
+	int32_t height;
+};
+
 class RtcSession : public Session
 {
 public:
@@ -47,7 +73,11 @@ public:
 	                                          std::shared_ptr<Stream> stream,
 	                                          std::shared_ptr<SessionDescription> offer_sdp,
 	                                          std::shared_ptr<SessionDescription> peer_sdp,
-	                                          std::shared_ptr<IcePort> ice_port);
+	                                          std::shared_ptr<IcePort> ice_port,
+	                                          // The payload types of the peer if it made the offer (WHEP)
+	                                          const std::map<uint8_t, uint8_t> &payload_type_map = {},
+	                                          // The header extensions with the ids of the peer if it made the offer (WHEP)
+	                                          const RtpHeaderExtensionMap &peer_extension_map = RtpHeaderExtensionMap());
 
 	RtcSession(SessionInfo &session_info,
 			std::shared_ptr<Application> application,
@@ -62,13 +92,62 @@ public:
 
 	std::shared_ptr<SessionDescription> GetPeerSDP();
 
-	bool SendOutgoingData(uint32_t packet_type, std::shared_ptr<ov::Data> packet) override;
+	bool SendOutgoingData(uint32_t packet_type, const std::shared_ptr<const ov::Data> &packet) override;
+	bool SendOutgoingData(const std::vector<std::shared_ptr<StreamPacket>> &packets) override;
 	void OnPacketReceived(std::shared_ptr<SessionInfo> session_info, std::shared_ptr<const ov::Data> data) override;
+	int64_t ProcessPacing() override;
+	// RTCP SRs from the template of the stream
+	bool SendReport(int64_t current_time) override;
+	// true after the SRTP keys are negotiated by DTLS
+	bool IsReadyToSend() override;
+	// Share of the quota of the application: caps the pacing rate, and the video layer by the next RTCP feedback
+	void SetEgressBitrateLimit(uint64_t bitrate) override;
 
 	uint8_t GetVideoPayloadType();
 	uint8_t GetAudioPayloadType();
 
+	// Track subscription of the peer (signalling "subscribe" command)
+	// - The packets of an unsubscribed track are not sent (e.g. the video of a player in the background)
+	// - The video is resumed at the next key frame, which is requested when it is subscribed again
+	// - max_height: the highest video layer which is not taller than it is selected (0: unlimited),
+	//   it is applied by the next RTCP feedback and only when the peer receives several layers
+	void SetSubscription(bool audio, bool video, int32_t max_height);
+
+	// RTCP feedback of the peer (called by RtpRtcp), the target video layer is updated
+	void OnReceiverReport(const std::shared_ptr<RtcpReceiverReport> &receiver_report);
+	void OnEstimatedBitrate(uint64_t bitrate);
+	// PLI/FIR of the peer, the key frame of the video track which the session receives is requested
+	void OnKeyFrameRequested(uint32_t media_ssrc);
+	// Pacing rate of RtpRtcp (bps), the kernel paces the packets of the session with it
+	void SetPacingRate(uint64_t rate);
+	// Available bandwidth of the peer (bps)
+	uint64_t GetEstimatedBitrate();
+	size_t GetMemoryUsage() override;
+
 private:
+	// Checks whether the peer receives the payload type of the packet
+	bool IsAcceptablePacket(uint32_t packet_type);
+	// true if the packet is a FEC packet which this session doesn't need (the loss is low)
+	bool IsDroppedFecPacket(uint32_t packet_type);
+	// SSRC of the FEC packets (the media SSRC if RED/ULPFEC is used)
+	uint32_t GetFecSsrc();
+	void UpdateFecProtection(uint8_t fraction_lost);
+
+	// true if the video which the session receives can be changed (several layers, or the temporal layers of the lowest layer)
+	bool IsLayered() const;
+	// Switches to the target layer if the packet is the first packet of its key frame (true if switched)
+	bool SwitchVideoLayer(uint32_t packet_type);
+	// true if the packet is in a temporal layer above the target (the upper layers are added at a key frame)
+	bool IsDroppedTemporalLayerPacket(uint32_t packet_type);
+	// true if the packet is in a track which the peer doesn't subscribe, or the video waits for the key frame to resume
+	bool IsUnsubscribedPacket(uint32_t packet_type);
+	void UpdateTargetLayer(int64_t current_time);
+	// The payload type of the video layer is the id of its track
+	void RequestKeyFrame(uint8_t payload_type);
+
+	// Compiles the egress path of RtpRtcp once the SRTP keys are negotiated (called by the stream worker)
+	void CompileEgressPath();
+
 	std::shared_ptr<RtpRtcp>            _rtp_rtcp;
 	std::shared_ptr<SrtpTransport>      _srtp_transport;
 	std::shared_ptr<DtlsTransport>      _dtls_transport;
@@ -77,8 +156,59 @@ private:
 	std::shared_ptr<SessionDescription> _offer_sdp;
 	std::shared_ptr<SessionDescription> _peer_sdp;
 	std::shared_ptr<IcePort>            _ice_port;
+	// key: payload type of the stream, value: payload type of the peer (empty: the same)
+	std::map<uint8_t, uint8_t>          _payload_type_map;
+	// Header extensions with the ids of the peer (empty: the ids of the answer of the peer are used)
+	RtpHeaderExtensionMap               _peer_extension_map;
 
 	uint8_t                             _video_payload_type;
 	uint8_t 							_red_block_pt;
 	uint8_t                             _audio_payload_type;
+	uint32_t                            _audio_ssrc = 0;
+	// FlexFEC is used instead of RED/ULPFEC if the peer supports it (0: not used)
+	uint8_t                             _flexfec_payload_type = 0;
+	uint32_t                            _flexfec_ssrc = 0;
+
+	// Reused by SendOutgoingData() to avoid allocation for each batch
+	std::vector<std::shared_ptr<const ov::Data>> _outgoing_packets;
+
+	// Video layers which the peer can receive (ascending order of the bitrate), the layers share the SSRC
+	std::vector<RtcVideoLayer> _video_layers;
+	uint32_t _video_ssrc = 0;
+	// Used by the stream worker
+	size_t _current_layer = 0;
+	// Updated by the RTCP feedback
+	std::atomic<size_t> _target_layer { 0 };
+
+	// Highest temporal layer which is sent (the upper layers are dropped only while the lowest layer is sent)
+	std::atomic<uint8_t> _target_temporal_layer { RTC_TEMPORAL_LAYER_ALL };
+	// Used by the stream worker
+	uint8_t _current_temporal_layer = RTC_TEMPORAL_LAYER_ALL;
+
+	// Upper bound of the layer by the loss rate
+	size_t _loss_layer = 0;
+	// Upper bound of the temporal layer of the lowest layer by the loss rate
+	uint8_t _loss_temporal_layer = RTC_TEMPORAL_LAYER_ALL;
+	int64_t _loss_layer_changed_time = 0;
+	uint64_t _estimated_bitrate = 0;
+	int64_t _estimated_bitrate_time = 0;
+
+	// FEC packets are sent only if the peer loses the packets (updated by RR)
+	std::atomic<bool> _fec_enabled { true };
+	// Smoothed fraction lost (1/256)
+	uint32_t _fec_fraction_lost = 0;
+
+	// Updated by the signalling
+	std::atomic<bool> _audio_subscribed { true };
+	std::atomic<bool> _video_subscribed { true };
+	std::atomic<int32_t> _max_video_height { 0 };
+	// bps (0: unlimited), updated by the report timer of the stream worker
+	std::atomic<uint64_t> _egress_bitrate_limit { 0 };
+	// Used by the stream worker (false while the track is paused, the sequence is rebased when it is resumed)
+	bool _audio_sending = true;
+	bool _video_sending = true;
+
+	// true if the egress path is compiled (or the session is stopped)
+	std::atomic<bool> _egress_path_compiled { false };
+	std::mutex _egress_path_mutex;
 };
\ No newline at end of file
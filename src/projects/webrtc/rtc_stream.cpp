@@ -3,6 +3,8 @@
 #include "rtc_application.h"
 #include "rtc_session.h"
 
+#include <base/media_route/media_bitstream.h>
+
 using namespace common;
 
 std::shared_ptr<RtcStream> RtcStream::Create(const std::shared_ptr<Application> application,
@@ -33,6 +35,9 @@ RtcStream::~RtcStream()
 
 bool RtcStream::Start(uint32_t worker_count)
 {
+	// The packetizers and the offer use the same extensions
+	_extension_map = GetApplication()->GetSharedPtrAs<RtcApplication>()->GetHeaderExtensionMap();
+
 	// OFFER SDP 생성
 	_offer_sdp = std::make_shared<SessionDescription>();
 	_offer_sdp->SetOrigin("OvenMediaEngine", ov::Random::GenerateUInt32(), 2, "IN", 4, "127.0.0.1");
@@ -65,14 +70,17 @@ bool RtcStream::Start(uint32_t worker_count)
 			case MediaType::Video:
 			{
 				auto payload = std::make_shared<PayloadAttr>();
+				RtpVideoCodecType video_codec;
 
 				switch(track->GetCodecId())
 				{
 					case MediaCodecId::Vp8:
 						codec = "VP8";
+						video_codec = RtpVideoCodecType::Vp8;
 						break;
 					case MediaCodecId::H264:
 						codec = "H264";
+						video_codec = RtpVideoCodecType::H264;
 
 						payload->SetFmtp(ov::String::FormatString(
 							// NonInterleaved => packetization-mode=1
@@ -99,6 +107,7 @@ bool RtcStream::Start(uint32_t worker_count)
 					video_media_desc->SetDirection(MediaDescription::Direction::SendOnly);
 					video_media_desc->SetMediaType(MediaDescription::MediaType::Video);
 					video_media_desc->SetCname(ov::Random::GenerateUInt32(), ov::Random::GenerateString(16));
+					AddExtmaps(video_media_desc);
 
 					_offer_sdp->AddMedia(video_media_desc);
 
@@ -107,11 +116,18 @@ bool RtcStream::Start(uint32_t worker_count)
 
 				//TODO(getroot): WEBRTC에서는 TIMEBASE를 무조건 90000을 쓰는 것으로 보임, 정확히 알아볼것
 				payload->SetRtpmap(track->GetId(), codec, 90000);
+				// Lost packets are retransmitted when NACK is received
+				payload->EnableRtcpFb(PayloadAttr::RtcpFbType::Nack, true);
+				// The estimated bitrate is used to select the layer
+				payload->EnableRtcpFb(PayloadAttr::RtcpFbType::GoogRemb, true);
+				payload->EnableRtcpFb(PayloadAttr::RtcpFbType::TransportCc, true);
 
 				video_media_desc->AddPayload(payload);
 
+				_video_layers.push_back({ payload->GetId(), track->GetBitrate(), track->GetTemporalLayerCount(), track->GetHeight() });
+
 				// RTP Packetizer를 추가한다.
-				AddPacketizer(false, payload->GetId(), video_media_desc->GetSsrc());
+				AddPacketizer(false, payload->GetId(), video_media_desc->GetSsrc(), video_codec);
 
 				break;
 			}
@@ -148,12 +164,14 @@ bool RtcStream::Start(uint32_t worker_count)
 					audio_media_desc->SetDirection(MediaDescription::Direction::SendOnly);
 					audio_media_desc->SetMediaType(MediaDescription::MediaType::Audio);
 					audio_media_desc->SetCname(ov::Random::GenerateUInt32(), ov::Random::GenerateString(16));
+					AddExtmaps(audio_media_desc);
 					_offer_sdp->AddMedia(audio_media_desc);
 					first_audio_desc = false;
 				}
 
 				// TODO(dimiden): Need to change to transcoding profile's bitrate and channel
 				payload->SetRtpmap(track->GetId(), codec, 48000, "2");
+				payload->EnableRtcpFb(PayloadAttr::RtcpFbType::TransportCc, true);
 
 				audio_media_desc->AddPayload(payload);
 
@@ -170,6 +188,10 @@ bool RtcStream::Start(uint32_t worker_count)
 		}
 	}
 
+	std::stable_sort(_video_layers.begin(), _video_layers.end(), [](const RtcVideoLayer &layer1, const RtcVideoLayer &layer2) -> bool {
+		return layer1.bitrate < layer2.bitrate;
+	});
+
 	if (video_media_desc)
 	{
         // RED & ULPFEC
@@ -180,10 +202,48 @@ bool RtcStream::Start(uint32_t worker_count)
 
         video_media_desc->AddPayload(red_payload);
         video_media_desc->AddPayload(ulpfec_payload);
+
+        // RTX for RED (a player that does not support RTX receives the retransmitted packets with the original SSRC)
+        auto rtx_payload = std::make_shared<PayloadAttr>();
+        rtx_payload->SetRtpmap(RTX_PAYLOAD_TYPE, "rtx", 90000);
+        rtx_payload->SetFmtp(ov::String::FormatString("apt=%d", RED_PAYLOAD_TYPE));
+
+        video_media_desc->AddPayload(rtx_payload);
+        video_media_desc->SetRtxSsrc(ov::Random::GenerateUInt32());
+
+        // FlexFEC on its own SSRC (the player which supports it doesn't need RED)
+        auto flexfec_payload = std::make_shared<PayloadAttr>();
+        flexfec_payload->SetRtpmap(FLEXFEC_PAYLOAD_TYPE, "flexfec", 90000);
+        flexfec_payload->SetFmtp(ov::String::FormatString("repair-window=%d", FLEXFEC_REPAIR_WINDOW));
+
+        video_media_desc->AddPayload(flexfec_payload);
+        video_media_desc->SetFecSsrc(ov::Random::GenerateUInt32());
+
+        for(const auto &layer : _video_layers)
+        {
+            auto packetizer = GetPacketizer(layer.payload_type);
+
+            if(packetizer != nullptr)
+            {
+                packetizer->SetFlexfec(FLEXFEC_PAYLOAD_TYPE, video_media_desc->GetFecSsrc());
+            }
+        }
     }
 
-	ov::String offer_sdp_text;
-	_offer_sdp->ToString(offer_sdp_text);
+	MakeOfferSdpTemplate();
+
+	if(GetApplication()->GetSharedPtrAs<RtcApplication>()->IsPayloadEncryptionEnabled())
+	{
+		_payload_encryptor = std::make_unique<RtpPayloadEncryptor>();
+
+		if(_payload_encryptor->Initialize() == false)
+		{
+			logte("Could not create the payload encryptor of the stream: %s/%u", GetName().CStr(), GetId());
+			return false;
+		}
+
+		logtw("The payloads of the stream are encrypted by the media key (research mode): %s/%u", GetName().CStr(), GetId());
+	}
 
 	logti("Stream is created : %s/%u", GetName().CStr(), GetId());
 
@@ -202,6 +262,244 @@ std::shared_ptr<SessionDescription> RtcStream::GetSessionDescription()
 	return _offer_sdp;
 }
 
+void RtcStream::MakeOfferSdpTemplate()
+{
+	ov::String offer_sdp_text;
+
+	_offer_sdp->Update();
+	_offer_sdp->ToString(offer_sdp_text);
+
+	// The offers of the sessions differ only in ice-ufrag, so the text is split at the value
+	ov::String ice_ufrag = _offer_sdp->GetIceUfrag();
+	ov::String ufrag_line = ov::String::FormatString("a=ice-ufrag:%s\r\n", ice_ufrag.CStr());
+	off_t position = offer_sdp_text.IndexOf(ufrag_line);
+
+	if(position < 0)
+	{
+		logtw("Could not find ice-ufrag from the offer SDP, the offer is serialized for each session");
+		_offer_sdp_head.Clear();
+		_offer_sdp_tail.Clear();
+		return;
+	}
+
+	off_t value_position = position + ::strlen("a=ice-ufrag:");
+
+	_offer_sdp_head = offer_sdp_text.Left(value_position);
+	_offer_sdp_tail = offer_sdp_text.Substring(value_position + ice_ufrag.GetLength());
+}
+
+std::shared_ptr<SessionDescription> RtcStream::CreateOfferSdp(const ov::String &ice_ufrag)
+{
+	auto session_description = std::make_shared<SessionDescription>(*_offer_sdp);
+
+	session_description->SetIceUfrag(ice_ufrag);
+
+	if(_offer_sdp_head.IsEmpty())
+	{
+		session_description->Update();
+		return session_description;
+	}
+
+	ov::String offer_sdp_text = _offer_sdp_head;
+
+	offer_sdp_text.Append(ice_ufrag);
+	offer_sdp_text.Append(_offer_sdp_tail);
+
+	session_description->SetSdpText(offer_sdp_text);
+
+	return session_description;
+}
+
+bool RtcStream::CreateAnswerSdp(const ov::String &ice_ufrag, const std::shared_ptr<SessionDescription> &remote_offer_sdp, RtcAnswerSdp &answer)
+{
+	answer.answer_sdp = std::make_shared<SessionDescription>();
+	answer.local_sdp = std::make_shared<SessionDescription>();
+	answer.peer_sdp = std::make_shared<SessionDescription>();
+	answer.payload_type_map.clear();
+	answer.extension_map = RtpHeaderExtensionMap();
+
+	for(const auto &local_sdp : { answer.answer_sdp, answer.local_sdp })
+	{
+		local_sdp->SetOrigin("OvenMediaEngine", ov::Random::GenerateUInt32(), 2, "IN", 4, "127.0.0.1");
+		local_sdp->SetTiming(0, 0);
+		local_sdp->SetIceUfrag(ice_ufrag);
+		local_sdp->SetIcePwd(_offer_sdp->GetIcePwd());
+		local_sdp->SetMsidSemantic("WMS", "*");
+		local_sdp->SetFingerprint("sha-256", _certificate->GetFingerprint("sha-256"));
+	}
+
+	// The session is identified by the session id of the peer (see RtcSession::Create())
+	answer.peer_sdp->SetOrigin(remote_offer_sdp->GetUserName(), remote_offer_sdp->GetSessionId(), remote_offer_sdp->GetSessionVersion(),
+	                           remote_offer_sdp->GetNetType(), remote_offer_sdp->GetIpVersion(), remote_offer_sdp->GetAddress());
+	answer.peer_sdp->SetIceUfrag(remote_offer_sdp->GetIceUfrag());
+	answer.peer_sdp->SetIcePwd(remote_offer_sdp->GetIcePwd());
+	answer.peer_sdp->SetFingerprint(remote_offer_sdp->GetFingerprintAlgorithm(), remote_offer_sdp->GetFingerprintValue());
+
+	bool accepted = false;
+
+	for(const auto &remote_media_desc : remote_offer_sdp->GetMediaList())
+	{
+		std::shared_ptr<MediaDescription> stream_media_desc = nullptr;
+
+		for(const auto &media_desc : _offer_sdp->GetMediaList())
+		{
+			if(media_desc->GetMediaType() == remote_media_desc->GetMediaType())
+			{
+				stream_media_desc = media_desc;
+				break;
+			}
+		}
+
+		// Payloads of the stream which the peer can receive (the payload of the peer is the preferred one)
+		std::vector<std::pair<std::shared_ptr<PayloadAttr>, std::shared_ptr<PayloadAttr>>> payload_pairs;
+
+		if((stream_media_desc != nullptr) &&
+		   ((remote_media_desc->GetDirection() == MediaDescription::Direction::RecvOnly) || (remote_media_desc->GetDirection() == MediaDescription::Direction::SendRecv)))
+		{
+			for(const auto &stream_payload : stream_media_desc->GetPayloadList())
+			{
+				ov::String codec = stream_payload->GetCodecStr().UpperCaseString();
+
+				if((codec != "VP8") && (codec != "H264") && (codec != "OPUS"))
+				{
+					continue;
+				}
+
+				for(const auto &remote_payload : remote_media_desc->GetPayloadList())
+				{
+					if((remote_payload->GetCodecStr().UpperCaseString() != codec) || (remote_payload->GetCodecRate() != stream_payload->GetCodecRate()))
+					{
+						continue;
+					}
+
+					if((codec == "H264") && (remote_payload->GetFmtp().IndexOf("packetization-mode=1") < 0))
+					{
+						continue;
+					}
+
+					payload_pairs.emplace_back(stream_payload, remote_payload);
+					break;
+				}
+			}
+		}
+
+		auto answer_media_desc = std::make_shared<MediaDescription>(answer.answer_sdp);
+
+		answer_media_desc->SetMediaType(remote_media_desc->GetMediaType());
+		answer_media_desc->SetConnection(4, "0.0.0.0");
+		answer_media_desc->SetMid(remote_media_desc->GetMid());
+		answer_media_desc->SetSetup(MediaDescription::SetupType::Passive);
+		answer_media_desc->UseDtls(true);
+		answer_media_desc->UseRtcpMux(true);
+
+		if(payload_pairs.empty())
+		{
+			logtw("The m= line (mid: %s) of the offer cannot be served by the stream %s", remote_media_desc->GetMid().CStr(), GetName().CStr());
+
+			// Rejected (RFC 3264 - 6)
+			answer_media_desc->SetPort(0);
+			answer_media_desc->SetDirection(MediaDescription::Direction::Inactive);
+			answer_media_desc->AddPayload(remote_media_desc->GetFirstPayload());
+			answer.answer_sdp->AddMedia(answer_media_desc);
+
+			continue;
+		}
+
+		auto local_media_desc = std::make_shared<MediaDescription>(answer.local_sdp);
+		auto peer_media_desc = std::make_shared<MediaDescription>(answer.peer_sdp);
+
+		for(const auto &media_desc : { answer_media_desc, local_media_desc })
+		{
+			media_desc->SetMediaType(remote_media_desc->GetMediaType());
+			media_desc->SetConnection(4, "0.0.0.0");
+			media_desc->SetMid(remote_media_desc->GetMid());
+			media_desc->SetSetup(MediaDescription::SetupType::Passive);
+			media_desc->UseDtls(true);
+			media_desc->UseRtcpMux(true);
+			media_desc->SetDirection(MediaDescription::Direction::SendOnly);
+			media_desc->SetCname(stream_media_desc->GetSsrc(), stream_media_desc->GetCname());
+		}
+
+		peer_media_desc->SetMediaType(remote_media_desc->GetMediaType());
+		peer_media_desc->SetMid(remote_media_desc->GetMid());
+		peer_media_desc->SetSetup(MediaDescription::SetupType::Active);
+		peer_media_desc->UseDtls(true);
+		peer_media_desc->UseRtcpMux(true);
+		peer_media_desc->SetDirection(MediaDescription::Direction::RecvOnly);
+
+		// The packets of the stream have the fixed extension ids, they are rewritten to the ids of the peer
+		for(size_t index = 0; index < static_cast<size_t>(RtpHeaderExtensionType::NumberOfTypes); index++)
+		{
+			auto type = static_cast<RtpHeaderExtensionType>(index);
+			const char *uri = RtpHeaderExtensionMap::GetUri(type);
+			uint8_t remote_id = remote_media_desc->GetExtmapId(uri);
+
+			// The bundled media must use the same id (RFC 8285)
+			if((_extension_map.IsRegistered(type) == false) || (answer.extension_map.Register(type, remote_id) == false))
+			{
+				continue;
+			}
+
+			answer_media_desc->AddExtmap(remote_id, uri);
+
+			for(const auto &media_desc : { local_media_desc, peer_media_desc })
+			{
+				media_desc->AddExtmap(_extension_map.GetId(type), uri);
+			}
+		}
+
+		for(const auto &payload_pair : payload_pairs)
+		{
+			auto &stream_payload = payload_pair.first;
+			auto &remote_payload = payload_pair.second;
+
+			bool use_nack = stream_payload->IsRtcpFbEnabled(PayloadAttr::RtcpFbType::Nack) && remote_payload->IsRtcpFbEnabled(PayloadAttr::RtcpFbType::Nack);
+			bool use_remb = stream_payload->IsRtcpFbEnabled(PayloadAttr::RtcpFbType::GoogRemb) && remote_payload->IsRtcpFbEnabled(PayloadAttr::RtcpFbType::GoogRemb);
+			bool use_transport_cc_fb = answer.extension_map.IsRegistered(RtpHeaderExtensionType::TransportCc) && stream_payload->IsRtcpFbEnabled(PayloadAttr::RtcpFbType::TransportCc) && remote_payload->IsRtcpFbEnabled(PayloadAttr::RtcpFbType::TransportCc);
+
+			// The layers of the stream are sent with the same payload type of the peer
+			if(answer_media_desc->GetPayload(remote_payload->GetId()) == nullptr)
+			{
+				auto payload = std::make_shared<PayloadAttr>();
+
+				payload->SetRtpmap(remote_payload->GetId(), stream_payload->GetCodecStr(), stream_payload->GetCodecRate(), stream_payload->GetCodecParams());
+				payload->SetFmtp(stream_payload->GetFmtp());
+				payload->EnableRtcpFb(PayloadAttr::RtcpFbType::Nack, use_nack);
+				payload->EnableRtcpFb(PayloadAttr::RtcpFbType::GoogRemb, use_remb);
+				payload->EnableRtcpFb(PayloadAttr::RtcpFbType::TransportCc, use_transport_cc_fb);
+
+				answer_media_desc->AddPayload(payload);
+			}
+
+			auto payload = std::make_shared<PayloadAttr>();
+
+			payload->SetRtpmap(stream_payload->GetId(), stream_payload->GetCodecStr(), stream_payload->GetCodecRate(), stream_payload->GetCodecParams());
+			payload->SetFmtp(stream_payload->GetFmtp());
+			payload->EnableRtcpFb(PayloadAttr::RtcpFbType::Nack, use_nack);
+			payload->EnableRtcpFb(PayloadAttr::RtcpFbType::GoogRemb, use_remb);
+			payload->EnableRtcpFb(PayloadAttr::RtcpFbType::TransportCc, use_transport_cc_fb);
+
+			local_media_desc->AddPayload(payload);
+			peer_media_desc->AddPayload(payload);
+
+			answer.payload_type_map[stream_payload->GetId()] = remote_payload->GetId();
+		}
+
+		answer.answer_sdp->AddMedia(answer_media_desc);
+		answer.local_sdp->AddMedia(local_media_desc);
+		answer.peer_sdp->AddMedia(peer_media_desc);
+
+		accepted = true;
+	}
+
+	if(accepted == false)
+	{
+		return false;
+	}
+
+	return answer.answer_sdp->Update();
+}
+
 bool RtcStream::OnRtpPacketized(std::shared_ptr<RtpPacket> packet)
 {
 	uint32_t rtp_payload_type = packet->PayloadType();
@@ -218,12 +516,48 @@ bool RtcStream::OnRtpPacketized(std::shared_ptr<RtpPacket> packet)
 			origin_pt_of_fec = packet->OriginPayloadType();
 		}
 	}
+	else if(packet->IsUlpfec())
+	{
+		// FlexFEC packet
+		origin_pt_of_fec = packet->OriginPayloadType();
+	}
+	else if((_payload_encryptor != nullptr) && (_payload_encryptor->Encrypt(packet.get()) == false))
+	{
+		// The media packet is encrypted before RED/FEC packets are made from it
+		return false;
+	}
 
 	// We make payload_type with the following structure:
 	// 0               8                 16             24                 32
 	//                 | origin_pt_of_fec | red block_pt | rtp_payload_type |
 	uint32_t payload_type = rtp_payload_type | (red_block_pt << 8) | (origin_pt_of_fec << 16);
-	BroadcastPacket(payload_type, packet->GetData());
+
+	// The FEC packets of the frame are dropped with the frame
+	payload_type |= (static_cast<uint32_t>(_temporal_layer_packetizing) << RTC_PACKET_TEMPORAL_LAYER_SHIFT) & RTC_PACKET_TEMPORAL_LAYER_MASK;
+
+	// Sessions switch the video layer at the first packet of the key frame
+	if(origin_pt_of_fec == 0)
+	{
+		bool &is_frame_start = (rtp_payload_type == RED_PAYLOAD_TYPE) ? _is_red_frame_start : _is_rtp_frame_start;
+
+		if(is_frame_start)
+		{
+			payload_type |= RTC_PACKET_FLAG_FRAME_START;
+			is_frame_start = false;
+		}
+
+		if(_is_key_frame_packetizing)
+		{
+			payload_type |= RTC_PACKET_FLAG_KEY_FRAME;
+		}
+	}
+
+	// Audio is not delayed by the video, and the workers can restart the lagging video from a key frame
+	// (the RTP packet of a frame is packetized before its RED packet, so the sync point is the RTP packet)
+	auto priority = _is_audio_packetizing ? StreamPacketPriority::High : StreamPacketPriority::Video;
+	bool is_sync_point = (_is_audio_packetizing == false) && (rtp_payload_type != RED_PAYLOAD_TYPE) && (payload_type & RTC_PACKET_FLAG_KEY_FRAME) && (payload_type & RTC_PACKET_FLAG_FRAME_START);
+
+	BroadcastPacket(payload_type, packet->GetData(), priority, is_sync_point);
 
 	return true;
 }
@@ -234,19 +568,46 @@ bool RtcStream::OnRtcpPacketized(std::shared_ptr<RtcpPacket> packet)
 }
 
 void RtcStream::SendVideoFrame(std::shared_ptr<MediaTrack> track,
-                               std::unique_ptr<EncodedFrame> encoded_frame,
-                               std::unique_ptr<CodecSpecificInfo> codec_info,
-                               std::unique_ptr<FragmentationHeader> fragmentation)
+                               std::unique_ptr<EncodedFrameDescriptor> frame)
 {
+	ov::MemoryTagScope memory_tag(ov::MemoryTag::Packetizer);
+	OV_TRACE_SCOPE("packetizer", "RtpVideo");
+
 	// VideoFrame 데이터를 Protocol에 맞게 변환한다.
 
 	// RTP Video Header를 생성한다. 사용한 CodecSpecificInfo는 버린다. (자동 삭제 됨)
 	RTPVideoHeader rtp_video_header;
 	memset(&rtp_video_header, 0, sizeof(RTPVideoHeader));
 
-	if(codec_info)
+	auto encoded_frame = &(frame->encoded_frame);
+	auto fragmentation = &(frame->fragmentation);
+
+	MakeRtpVideoHeader(&(frame->codec_info), &rtp_video_header);
+
+	_temporal_layer_packetizing = 0;
+
+	if((rtp_video_header.codec == RtpVideoCodecType::Vp8) && (track->GetTemporalLayerCount() > 1))
 	{
-		MakeRtpVideoHeader(codec_info.get(), &rtp_video_header);
+		// TL0PICIDX is increased at the frames of the base layer, so the players can tell the dropped frames were in the upper layers
+		auto &tl0_pic_idx = _vp8_tl0_pic_idx[track->GetId()];
+
+		if(rtp_video_header.codec_header.vp8.temporal_idx == 0)
+		{
+			tl0_pic_idx++;
+		}
+
+		rtp_video_header.codec_header.vp8.tl0_pic_idx = tl0_pic_idx;
+		_temporal_layer_packetizing = rtp_video_header.codec_header.vp8.temporal_idx;
+	}
+
+	if((rtp_video_header.codec == RtpVideoCodecType::H264) && (fragmentation->fragmentation_vector_size == 0) &&
+	   (encoded_frame->_bitstream != nullptr) && (encoded_frame->_bitstream->GetAnnexB() == encoded_frame->_buffer))
+	{
+		// The NAL units are found once per frame, instead of scanning the start codes again in the packetizer
+		auto &nal_units = encoded_frame->_bitstream->GetNalUnits();
+
+		rtp_video_header.codec_header.h264.nal_units = nal_units.data();
+		rtp_video_header.codec_header.h264.nal_unit_count = nal_units.size();
 	}
 
 	// RTP Packetizing
@@ -256,22 +617,32 @@ void RtcStream::SendVideoFrame(std::shared_ptr<MediaTrack> track,
 	{
 		return;
 	}
+	_is_key_frame_packetizing = (encoded_frame->_frame_type == FrameType::VideoFrameKey);
+	_is_rtp_frame_start = true;
+	_is_red_frame_start = true;
+
 	// RTP_SENDER에 등록된 RtpRtcpSession에 의해서 Packetizing이 완료되면 OnRtpPacketized 함수가 호출된다.
 	packetizer->Packetize(encoded_frame->_frame_type,
 	                      encoded_frame->_time_stamp,
 	                      encoded_frame->_buffer->GetDataAs<uint8_t>(),
 	                      encoded_frame->_length,
-	                      fragmentation.get(),
+	                      fragmentation,
 	                      &rtp_video_header);
+
+	_is_key_frame_packetizing = false;
+	_temporal_layer_packetizing = 0;
 }
 
 void RtcStream::SendAudioFrame(std::shared_ptr<MediaTrack> track,
-                               std::unique_ptr<EncodedFrame> encoded_frame,
-                               std::unique_ptr<CodecSpecificInfo> codec_info,
-                               std::unique_ptr<FragmentationHeader> fragmentation)
+                               std::unique_ptr<EncodedFrameDescriptor> frame)
 {
+	ov::MemoryTagScope memory_tag(ov::MemoryTag::Packetizer);
+	OV_TRACE_SCOPE("packetizer", "RtpAudio");
+
 	// AudioFrame 데이터를 Protocol에 맞게 변환한다.
-	OV_ASSERT2(encoded_frame != nullptr);
+	OV_ASSERT2(frame != nullptr);
+
+	auto encoded_frame = &(frame->encoded_frame);
 	OV_ASSERT2(encoded_frame->_buffer != nullptr);
 
 	// RTP Packetizing
@@ -282,12 +653,16 @@ void RtcStream::SendAudioFrame(std::shared_ptr<MediaTrack> track,
 		return;
 	}
 
+	_is_audio_packetizing = true;
+
 	packetizer->Packetize(encoded_frame->_frame_type,
 	                      encoded_frame->_time_stamp,
 	                      encoded_frame->_buffer->GetDataAs<uint8_t>(),
 	                      encoded_frame->_length,
-	                      fragmentation.get(),
+	                      &(frame->fragmentation),
 	                      nullptr);
+
+	_is_audio_packetizing = false;
 }
 
 uint16_t RtcStream::AllocateVP8PictureID()
@@ -340,20 +715,109 @@ void RtcStream::MakeRtpVideoHeader(const CodecSpecificInfo *info, RTPVideoHeader
 	}
 }
 
-void RtcStream::AddPacketizer(bool audio, uint8_t payload_type, uint32_t ssrc)
+void RtcStream::AddPacketizer(bool audio, uint8_t payload_type, uint32_t ssrc, RtpVideoCodecType video_codec)
 {
 	auto packetizer = std::make_shared<RtpPacketizer>(audio, RtpRtcpPacketizerInterface::GetSharedPtr());
 	packetizer->SetPayloadType(payload_type);
 	packetizer->SetSSRC(ssrc);
+	packetizer->SetHeaderExtensions(_extension_map);
 
 	if(!audio)
 	{
+		// The pipeline of the track is selected once (and again by SetFlexfec())
+		packetizer->SetVideoCodec(video_codec);
 		packetizer->SetUlpfec(RED_PAYLOAD_TYPE, ULPFEC_PAYLOAD_TYPE);
 	}
 
 	_packetizers[payload_type] = packetizer;
 }
 
+void RtcStream::UpdateFecProtectionRate(uint32_t protection_rate)
+{
+	std::lock_guard<std::mutex> lock(_fec_rate_guard);
+
+	int64_t current_time = RtpPacketHistory::GetCurrentMilliseconds();
+
+	if(protection_rate >= _fec_protection_rate)
+	{
+		// Keep the highest rate
+		_fec_protection_rate_time = current_time;
+	}
+	else if((current_time - _fec_protection_rate_time) < RTC_FEC_RATE_HOLD_MS)
+	{
+		// Another session may still require the current rate
+		return;
+	}
+
+	if(protection_rate == _fec_protection_rate)
+	{
+		return;
+	}
+
+	logtd("FEC protection rate of the stream(%s) is changed: %u -> %u", GetName().CStr(), _fec_protection_rate, protection_rate);
+
+	_fec_protection_rate = protection_rate;
+	_fec_protection_rate_time = current_time;
+
+	for(const auto &layer : _video_layers)
+	{
+		auto packetizer = GetPacketizer(layer.payload_type);
+
+		if(packetizer != nullptr)
+		{
+			packetizer->SetFecProtectionRate(protection_rate);
+		}
+	}
+}
+
+std::shared_ptr<ov::Data> RtcStream::MakeMediaKeyPacket(uint32_t ssrc)
+{
+	return (_payload_encryptor != nullptr) ? _payload_encryptor->MakeKeyPacket(ssrc) : nullptr;
+}
+
+bool RtcStream::RequestKeyFrame(int32_t track_id)
+{
+	auto application = GetApplication();
+
+	if(application == nullptr)
+	{
+		return false;
+	}
+
+	return application->RequestKeyFrame(GetId(), track_id);
+}
+
+void RtcStream::AddExtmaps(const std::shared_ptr<MediaDescription> &media_desc)
+{
+	for(size_t index = 0; index < static_cast<size_t>(RtpHeaderExtensionType::NumberOfTypes); index++)
+	{
+		auto type = static_cast<RtpHeaderExtensionType>(index);
+
+		if(_extension_map.IsRegistered(type))
+		{
+			media_desc->AddExtmap(_extension_map.GetId(type), RtpHeaderExtensionMap::GetUri(type));
+		}
+	}
+}
+
+std::shared_ptr<const RtcpSrTemplate> RtcStream::GetSrTemplate(int64_t report_time)
+{
+	std::lock_guard<std::mutex> lock_guard(_sr_template_guard);
+
+	if((_sr_template == nullptr) || (_sr_template_report_time != report_time))
+	{
+		// The workers of the stream use the template of the same interval, so it is not modified after this
+		auto sr_template = std::make_shared<RtcpSrTemplate>();
+
+		RtcpPacket::MakeSrTemplate(StreamWorker::GetCurrentMilliseconds(), *sr_template);
+
+		_sr_template = sr_template;
+		_sr_template_report_time = report_time;
+	}
+
+	return _sr_template;
+}
+
 std::shared_ptr<RtpPacketizer> RtcStream::GetPacketizer(uint8_t payload_type)
 {
 	if(!_packetizers.count(payload_type))
@@ -1 +1,157 @@
-#pragma once#include <base/ovcrypto/certificate.h>#include <base/common_types.h>#include <base/publisher/stream.h>#include "ice/ice_port.h"#include "sdp/session_description.h"#include "rtp_rtcp/rtp_rtcp_defines.h"#include "rtc_session.h"#define RED_PAYLOAD_TYPE		123#define	ULPFEC_PAYLOAD_TYPE		114class RtcStream : public Stream, public RtpRtcpPacketizerInterface{public:	static std::shared_ptr<RtcStream> Create(const std::shared_ptr<Application> application,	                                         const StreamInfo &info,	                                         uint32_t worker_count);	explicit RtcStream(const std::shared_ptr<Application> application,	                   const StreamInfo &info);	~RtcStream() final;	// SDP를 생성하고 관리한다.	std::shared_ptr<SessionDescription> GetSessionDescription();	void SendVideoFrame(std::shared_ptr<MediaTrack> track,	                    std::unique_ptr<EncodedFrame> encoded_frame,	                    std::unique_ptr<CodecSpecificInfo> codec_info,	                    std::unique_ptr<FragmentationHeader> fragmentation) override;	void SendAudioFrame(std::shared_ptr<MediaTrack> track,	                    std::unique_ptr<EncodedFrame> encoded_frame,	                    std::unique_ptr<CodecSpecificInfo> codec_info,	                    std::unique_ptr<FragmentationHeader> fragmentation) override;	// RTP Packetizer를 생성하여 추가한다.	void AddPacketizer(bool audio, uint8_t payload_type, uint32_t ssrc);	std::shared_ptr<RtpPacketizer> GetPacketizer(uint8_t payload_type);	// RtpRtcpPacketizerInterface Implementation	// RtpSender, RtcpSender 등에 RtpRtcpSession을 넘겨서 전송 이 함수를 통해 하도록 한다.	bool OnRtpPacketized(std::shared_ptr<RtpPacket> packet) override;	bool OnRtcpPacketized(std::shared_ptr<RtcpPacket> packet) override;private:	bool Start(uint32_t worker_count) override;	bool Stop() override;	// WebRTC의 RTP 에서 사용하는 형태로 변환한다.	void MakeRtpVideoHeader(const CodecSpecificInfo *info, RTPVideoHeader *rtp_video_header);	uint16_t AllocateVP8PictureID();	// VP8 Picture ID	uint16_t _vp8_picture_id;	std::shared_ptr<SessionDescription> _offer_sdp;	std::shared_ptr<Certificate> _certificate;	// Packetizing을 위해 RtpSender를 이용한다.	std::map<uint8_t, std::shared_ptr<RtpPacketizer>> _packetizers;};
\ No newline at end of file
+#pragma once
+
+#include <base/ovcrypto/certificate.h>
+#include <base/common_types.h>
+#include <base/publisher/stream.h>
+#include "ice/ice_port.h"
+#include "sdp/session_description.h"
+#include "rtp_rtcp/rtp_rtcp_defines.h"
+#include "rtp_rtcp/rtp_header_extension.h"
+#include "rtp_rtcp/rtp_payload_encryptor.h"
+#include "rtc_session.h"
+
+#define RED_PAYLOAD_TYPE		123
+#define	ULPFEC_PAYLOAD_TYPE		114
+// RTX (RFC 4588) for the retransmission of RED packets
+#define RTX_PAYLOAD_TYPE		124
+// FlexFEC (RFC 8627) on its own SSRC, an alternative to RED/ULPFEC
+#define FLEXFEC_PAYLOAD_TYPE	125
+// us of the media packets which the receiver keeps for the recovery
+#define FLEXFEC_REPAIR_WINDOW	200000
+
+// RTP header extension of the transport-wide sequence number (the session stamps it for the congestion control)
+#define RTC_TRANSPORT_CC_EXTENSION_ID	5
+// RTP header extensions of the packets of the stream (see RtpHeaderExtensionMap)
+#define RTC_ABS_SEND_TIME_EXTENSION_ID	3
+#define RTC_PLAYOUT_DELAY_EXTENSION_ID	6
+
+// Flags of the packet type (the lower 24 bits are the payload types, see OnRtpPacketized())
+#define RTC_PACKET_FLAG_KEY_FRAME		(1u << 24)
+// The first packet of a frame (for each of the RTP and the RED)
+#define RTC_PACKET_FLAG_FRAME_START		(1u << 25)
+// Temporal layer of the frame (0: the base layer, the sessions may drop the packets of the upper layers)
+#define RTC_PACKET_TEMPORAL_LAYER_SHIFT	(26)
+#define RTC_PACKET_TEMPORAL_LAYER_MASK	(0x3u << RTC_PACKET_TEMPORAL_LAYER_SHIFT)
+
+// The FEC protection rate of the stream is decreased if no session requires the rate for this time
+#define RTC_FEC_RATE_HOLD_MS			(5000)
+
+// Answer of OME for the offer of the peer (WHEP)
+struct RtcAnswerSdp
+{
+	// Sent to the peer (with the payload types of the peer)
+	std::shared_ptr<SessionDescription> answer_sdp;
+	// The answer and the offer with the payload types of the stream (for RtcSession and IcePort)
+	std::shared_ptr<SessionDescription> local_sdp;
+	std::shared_ptr<SessionDescription> peer_sdp;
+	// key: payload type of the stream, value: payload type of the peer
+	std::map<uint8_t, uint8_t> payload_type_map;
+	// Header extensions of the stream with the ids of the peer (the ones which the peer doesn't offer are not registered)
+	RtpHeaderExtensionMap extension_map;
+};
+
+class RtcStream : public Stream, public RtpRtcpPacketizerInterface
+{
+public:
+	static std::shared_ptr<RtcStream> Create(const std::shared_ptr<Application> application,
+	                                         const StreamInfo &info,
+	                                         uint32_t worker_count);
+	explicit RtcStream(const std::shared_ptr<Application> application,
+	                   const StreamInfo &info);
+	~RtcStream() final;
+
+	// SDP를 생성하고 관리한다.
+	std::shared_ptr<SessionDescription> GetSessionDescription();
+	// Makes the offer of a session from the pre-serialized SDP of the stream (only ice-ufrag is replaced)
+	std::shared_ptr<SessionDescription> CreateOfferSdp(const ov::String &ice_ufrag);
+	// Answers the offer of the peer with the media of the stream (the m= lines which cannot be served are rejected)
+	// - Only the media codecs are answered (RED/ULPFEC, RTX and FlexFEC use the fixed payload types of the stream)
+	// - Returns false if none of the m= lines can be served
+	bool CreateAnswerSdp(const ov::String &ice_ufrag, const std::shared_ptr<SessionDescription> &remote_offer_sdp, RtcAnswerSdp &answer);
+
+	void SendVideoFrame(std::shared_ptr<MediaTrack> track,
+	                    std::unique_ptr<EncodedFrameDescriptor> frame) override;
+
+	void SendAudioFrame(std::shared_ptr<MediaTrack> track,
+	                    std::unique_ptr<EncodedFrameDescriptor> frame) override;
+
+	// RTP Packetizer를 생성하여 추가한다.
+	// video_codec: the packetization pipeline of the track is specialized by it
+	void AddPacketizer(bool audio, uint8_t payload_type, uint32_t ssrc, RtpVideoCodecType video_codec = RtpVideoCodecType::None);
+	std::shared_ptr<RtpPacketizer> GetPacketizer(uint8_t payload_type);
+
+	// Video tracks in the ascending order of the bitrate, each layer is packetized once for all sessions
+	const std::vector<RtcVideoLayer> &GetVideoLayers() const
+	{
+		return _video_layers;
+	}
+
+	// RtpRtcpPacketizerInterface Implementation
+	// RtpSender, RtcpSender 등에 RtpRtcpSession을 넘겨서 전송 이 함수를 통해 하도록 한다.
+	bool OnRtpPacketized(std::shared_ptr<RtpPacket> packet) override;
+	bool OnRtcpPacketized(std::shared_ptr<RtcpPacket> packet) override;
+
+	// The protection rate which a session requires (by its loss), the highest rate of the sessions is used
+	void UpdateFecProtectionRate(uint32_t protection_rate);
+
+	// RTCP APP of the media key for a session (nullptr if the payloads are not encrypted by the stream)
+	std::shared_ptr<ov::Data> MakeMediaKeyPacket(uint32_t ssrc);
+
+	// Asks the provider (or the encoder) of the track for a key frame, the requests of the sessions are coalesced
+	bool RequestKeyFrame(int32_t track_id);
+
+	// Header extensions of the packets (the ids of the offer of the stream)
+	const RtpHeaderExtensionMap &GetHeaderExtensionMap() const
+	{
+		return _extension_map;
+	}
+
+	// SR of the report interval (report_time: see Session::SendReport()), it is made once for all sessions of the stream
+	std::shared_ptr<const RtcpSrTemplate> GetSrTemplate(int64_t report_time);
+
+private:
+	bool Start(uint32_t worker_count) override;
+	bool Stop() override;
+
+	// WebRTC의 RTP 에서 사용하는 형태로 변환한다.
+	void MakeRtpVideoHeader(const CodecSpecificInfo *info, RTPVideoHeader *rtp_video_header);
+	uint16_t AllocateVP8PictureID();
+	// Serializes the offer SDP once, and keeps the text around the ice-ufrag value
+	void MakeOfferSdpTemplate();
+	// a=extmap of the extensions of _extension_map
+	void AddExtmaps(const std::shared_ptr<MediaDescription> &media_desc);
+
+	// VP8 Picture ID
+	uint16_t _vp8_picture_id;
+	std::shared_ptr<SessionDescription> _offer_sdp;
+	// The offer SDP text before/after the ice-ufrag value (empty if the template is not available)
+	ov::String _offer_sdp_head;
+	ov::String _offer_sdp_tail;
+	std::shared_ptr<Certificate> _certificate;
+
+	// Packetizing을 위해 RtpSender를 이용한다.
+	std::map<uint8_t, std::shared_ptr<RtpPacketizer>> _packetizers;
+	RtpHeaderExtensionMap _extension_map;
+
+	std::vector<RtcVideoLayer> _video_layers;
+
+	// State of the frame which is being packetized
+	bool _is_key_frame_packetizing = false;
+	bool _is_rtp_frame_start = false;
+	bool _is_red_frame_start = false;
+	bool _is_audio_packetizing = false;
+	uint8_t _temporal_layer_packetizing = 0;
+	// key: payload type of the layered VP8 track, value: TL0PICIDX of the last frame of the base layer
+	std::map<uint8_t, uint8_t> _vp8_tl0_pic_idx;
+
+	// The payloads are encrypted once for all sessions (nullptr if PayloadEncryption is disabled)
+	std::unique_ptr<RtpPayloadEncryptor> _payload_encryptor;
+
+	std::mutex _sr_template_guard;
+	std::shared_ptr<const RtcpSrTemplate> _sr_template;
+	int64_t _sr_template_report_time = -1;
+
+	std::mutex _fec_rate_guard;
+	uint32_t _fec_protection_rate = ULPFEC_DEFAULT_PROTECTION_RATE;
+	int64_t _fec_protection_rate_time = 0;
+};
\ No newline at end of file
@@ -105,16 +105,53 @@ std::shared_ptr<SessionDescription> WebRtcPublisher::OnRequestOffer(const ov::St
 		return nullptr;
 	}
 
-	auto &candidates = _ice_port->GetIceCandidateList();
+	auto ufrag = _ice_port->GenerateUfrag();
 
-	ice_candidates->insert(ice_candidates->end(), candidates.cbegin(), candidates.cend());
+	// The least loaded port is offered, so the sessions are spread over the threads of the ports
+	_ice_port->SelectIceCandidates(ufrag, ice_candidates);
 
-	auto session_description = std::make_shared<SessionDescription>(*stream->GetSessionDescription());
+	return stream->CreateOfferSdp(ufrag);
+}
+
+// The player sent its offer (WHEP), so the session is created here with the answer
+std::shared_ptr<SessionDescription> WebRtcPublisher::OnRequestAnswer(const ov::String &application_name,
+                                                                     const ov::String &stream_name,
+                                                                     const std::shared_ptr<SessionDescription> &offer_sdp,
+                                                                     std::vector<RtcIceCandidate> *ice_candidates)
+{
+	auto application = GetApplicationByName(application_name);
+	auto stream = std::static_pointer_cast<RtcStream>(GetStream(application_name, stream_name));
+
+	if(stream == nullptr)
+	{
+		return nullptr;
+	}
+
+	RtcAnswerSdp answer;
+
+	if(stream->CreateAnswerSdp(_ice_port->GenerateUfrag(), offer_sdp, answer) == false)
+	{
+		logtw("Could not answer the offer for stream (%s/%s)", application_name.CStr(), stream_name.CStr());
+		return nullptr;
+	}
 
-	session_description->SetIceUfrag(_ice_port->GenerateUfrag());
-	session_description->Update();
+	auto session = RtcSession::Create(application, stream, answer.local_sdp, answer.peer_sdp, _ice_port, answer.payload_type_map, answer.extension_map);
 
-	return session_description;
+	if(session == nullptr)
+	{
+		logte("Cannot create session");
+		return nullptr;
+	}
+
+	stream->AddSession(session);
+
+	// The ports are assigned before AddSession(), which takes them over
+	_ice_port->SelectIceCandidates(answer.local_sdp->GetIceUfrag(), ice_candidates);
+
+	// OME answered, so the peer is the controlling agent
+	_ice_port->AddSession(session, answer.local_sdp, answer.peer_sdp, false);
+
+	return answer.answer_sdp;
 }
 
 // 클라이언트가 자신의 SDP를 보내면 다음 함수를 호출한다.
@@ -188,6 +225,30 @@ bool WebRtcPublisher::OnStopCommand(const ov::String &application_name, const ov
 	return true;
 }
 
+bool WebRtcPublisher::OnSubscribeCommand(const ov::String &application_name, const ov::String &stream_name,
+                                         const std::shared_ptr<SessionDescription> &offer_sdp,
+                                         const std::shared_ptr<SessionDescription> &peer_sdp,
+                                         bool audio, bool video, int32_t max_height)
+{
+	auto stream = std::static_pointer_cast<RtcStream>(GetStream(application_name, stream_name));
+	if(!stream)
+	{
+		logte("To change the subscription failed. Cannot find stream (%s/%s)", application_name.CStr(), stream_name.CStr());
+		return false;
+	}
+
+	auto session = std::static_pointer_cast<RtcSession>(stream->GetSession(peer_sdp->GetSessionId()));
+	if(session == nullptr)
+	{
+		logte("To change the subscription failed. Cannot find session by peer sdp session id (%u)", peer_sdp->GetSessionId());
+		return false;
+	}
+
+	session->SetSubscription(audio, video, max_height);
+
+	return true;
+}
+
 // bitrate info(frome signalling)
 uint32_t WebRtcPublisher::OnGetBitrate(const ov::String &application_name, const ov::String &stream_name)
 {
@@ -214,6 +275,30 @@ uint32_t WebRtcPublisher::OnGetBitrate(const ov::String &application_name, const
 	return bitrate;
 }
 
+uint64_t WebRtcPublisher::OnGetSendLatency(const ov::String &application_name, const ov::String &stream_name)
+{
+	auto stream = GetStream(application_name, stream_name);
+
+	if(stream == nullptr)
+	{
+		return 0;
+	}
+
+	std::vector<StreamWorkerLoad> loads;
+	stream->GetWorkerLoads(loads);
+
+	// A new session is assigned to the idlest worker (see Stream::SelectWorkerIndex())
+	uint64_t latency = UINT64_MAX;
+
+	for(const auto &load : loads)
+	{
+		latency = std::min(latency, static_cast<uint64_t>(load.session_count * load.send_time_per_session));
+	}
+
+	// ns -> us
+	return (latency == UINT64_MAX) ? 0 : (latency / 1000);
+}
+
 
 // It does not be used because
 bool WebRtcPublisher::OnIceCandidate(const ov::String &application_name,
@@ -27,6 +27,11 @@ public:
 	std::shared_ptr<SessionDescription> OnRequestOffer(const ov::String &application_name,
 	                                                   const ov::String &stream_name,
 	                                                   std::vector<RtcIceCandidate> *ice_candidates) override;
+	// The player sent its offer (WHEP)
+	std::shared_ptr<SessionDescription> OnRequestAnswer(const ov::String &application_name,
+	                                                    const ov::String &stream_name,
+	                                                    const std::shared_ptr<SessionDescription> &offer_sdp,
+	                                                    std::vector<RtcIceCandidate> *ice_candidates) override;
 	// 클라이언트가 자신의 SDP를 보내면 다음 함수를 호출한다.
 	bool OnAddRemoteDescription(const ov::String &application_name,
 	                            const ov::String &stream_name,
@@ -49,8 +54,15 @@ public:
 	                   const std::shared_ptr<SessionDescription> &offer_sdp,
 	                   const std::shared_ptr<SessionDescription> &peer_sdp) override;
 
+	bool OnSubscribeCommand(const ov::String &application_name, const ov::String &stream_name,
+	                        const std::shared_ptr<SessionDescription> &offer_sdp,
+	                        const std::shared_ptr<SessionDescription> &peer_sdp,
+	                        bool audio, bool video, int32_t max_height) override;
+
     uint32_t OnGetBitrate(const ov::String &application_name, const ov::String &stream_name);
 
+	uint64_t OnGetSendLatency(const ov::String &application_name, const ov::String &stream_name) override;
+
     bool GetMonitoringCollectionData(std::vector<std::shared_ptr<MonitoringCollectionData>> &collections) override;
 
 private:
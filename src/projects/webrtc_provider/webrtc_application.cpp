@@ -0,0 +1,44 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "webrtc_application.h"
+#include "webrtc_stream.h"
+
+#define OV_LOG_TAG "WebrtcApplication"
+
+std::shared_ptr<WebrtcApplication> WebrtcApplication::Create(const info::Application *application_info)
+{
+	auto application = std::make_shared<WebrtcApplication>(application_info);
+	return application;
+}
+
+WebrtcApplication::WebrtcApplication(const info::Application *application_info)
+	: Application(application_info)
+{
+}
+
+std::shared_ptr<pvd::Stream> WebrtcApplication::OnCreateStream()
+{
+	logtd("OnCreateStream");
+
+	auto stream = WebrtcStream::Create();
+
+	return stream;
+}
+
+bool WebrtcApplication::OnKeyFrameRequested(const std::shared_ptr<StreamInfo> &stream_info, int32_t track_id)
+{
+	auto stream = std::dynamic_pointer_cast<WebrtcStream>(GetStreamById(stream_info->GetId()));
+
+	// Video track is 0 (see WebrtcStream::AddTracks())
+	if((stream == nullptr) || (track_id != 0))
+	{
+		return false;
+	}
+
+	return stream->RequestKeyFrame();
+}
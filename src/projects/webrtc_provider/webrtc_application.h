@@ -0,0 +1,28 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "base/common_types.h"
+
+#include "base/provider/application.h"
+#include "base/provider/stream.h"
+
+class WebrtcApplication : public pvd::Application
+{
+public:
+	static std::shared_ptr<WebrtcApplication> Create(const info::Application *application_info);
+
+	explicit WebrtcApplication(const info::Application *info);
+	~WebrtcApplication() override = default;
+
+public:
+	std::shared_ptr<pvd::Stream> OnCreateStream() override;
+
+	// The key frame is requested to the contributor by PLI (e.g. the bypassed H.264 of a new WebRTC viewer)
+	bool OnKeyFrameRequested(const std::shared_ptr<StreamInfo> &stream_info, int32_t track_id) override;
+};
@@ -0,0 +1,164 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "webrtc_ingest_session.h"
+
+#define OV_LOG_TAG "WebrtcIngestSession"
+
+std::shared_ptr<WebrtcIngestSession> WebrtcIngestSession::Create(const std::shared_ptr<SessionDescription> &peer_sdp,
+                                                                 const std::shared_ptr<IcePort> &ice_port,
+                                                                 const std::shared_ptr<Certificate> &certificate)
+{
+	// The session is identified by the session id of the peer (same as RtcSession)
+	auto session_info = SessionInfo(peer_sdp->GetSessionId());
+	auto session = std::make_shared<WebrtcIngestSession>(session_info, peer_sdp, ice_port, certificate);
+
+	return session;
+}
+
+WebrtcIngestSession::WebrtcIngestSession(const SessionInfo &session_info,
+                                         const std::shared_ptr<SessionDescription> &peer_sdp,
+                                         const std::shared_ptr<IcePort> &ice_port,
+                                         const std::shared_ptr<Certificate> &certificate)
+	: Session(session_info, nullptr, nullptr),
+	  _peer_sdp(peer_sdp),
+	  _ice_port(ice_port),
+	  _certificate(certificate)
+{
+}
+
+WebrtcIngestSession::~WebrtcIngestSession()
+{
+	Stop();
+	logtd("WebrtcIngestSession(%d) has been terminated finally", GetId());
+}
+
+bool WebrtcIngestSession::AddPayload(uint8_t payload_type, common::MediaCodecId codec_id, uint32_t clock_rate, bool nack_enabled, int64_t max_delay)
+{
+	if(_rtp_receiver == nullptr)
+	{
+		_rtp_receiver = std::make_shared<RtpReceiver>((uint32_t)SessionNodeType::RtpRtcp, std::static_pointer_cast<Session>(GetSharedPtr()));
+	}
+
+	return _rtp_receiver->AddPayload(payload_type, codec_id, clock_rate, nack_enabled, max_delay);
+}
+
+void WebrtcIngestSession::SetFrameHandler(RtpReceiver::FrameHandler handler)
+{
+	if(_rtp_receiver != nullptr)
+	{
+		_rtp_receiver->SetFrameHandler(std::move(handler));
+	}
+}
+
+bool WebrtcIngestSession::Start()
+{
+	if((GetState() != SessionState::Ready) || (_rtp_receiver == nullptr) || (_certificate == nullptr))
+	{
+		return false;
+	}
+
+	auto session = std::static_pointer_cast<Session>(GetSharedPtr());
+
+	_srtp_transport = std::make_shared<SrtpTransport>((uint32_t)SessionNodeType::Srtp, session);
+
+	// OME answered the offer, so it waits for the ClientHello of the peer (a=setup:passive)
+	_dtls_transport = std::make_shared<DtlsTransport>((uint32_t)SessionNodeType::Dtls, session);
+	_dtls_transport->SetLocalCertificate(_certificate);
+	_dtls_transport->StartDTLS();
+
+	_dtls_ice_transport = std::make_shared<DtlsIceTransport>((uint32_t)SessionNodeType::Ice, session, _ice_port);
+
+	// 노드를 연결한다.
+	_rtp_receiver->RegisterUpperNode(nullptr);
+	_rtp_receiver->RegisterLowerNode(_srtp_transport);
+	_rtp_receiver->Start();
+	_srtp_transport->RegisterUpperNode(_rtp_receiver);
+	_srtp_transport->RegisterLowerNode(_dtls_transport);
+	_srtp_transport->Start();
+	_dtls_transport->RegisterUpperNode(_srtp_transport);
+	_dtls_transport->RegisterLowerNode(_dtls_ice_transport);
+	_dtls_transport->Start();
+	_dtls_ice_transport->RegisterUpperNode(_dtls_transport);
+	_dtls_ice_transport->RegisterLowerNode(nullptr);
+	_dtls_ice_transport->Start();
+
+	return Session::Start();
+}
+
+bool WebrtcIngestSession::Stop()
+{
+	if(GetState() != SessionState::Started)
+	{
+		return true;
+	}
+
+	// 연결된 세션을 정리한다.
+	if(_rtp_receiver != nullptr)
+	{
+		_rtp_receiver->SetFrameHandler(nullptr);
+		_rtp_receiver->Stop();
+	}
+
+	if(_dtls_ice_transport != nullptr)
+	{
+		_dtls_ice_transport->Stop();
+	}
+
+	if(_dtls_transport != nullptr)
+	{
+		_dtls_transport->Stop();
+	}
+
+	if(_srtp_transport != nullptr)
+	{
+		_srtp_transport->Stop();
+	}
+
+	return Session::Stop();
+}
+
+void WebrtcIngestSession::RequestKeyFrame()
+{
+	if(_rtp_receiver != nullptr)
+	{
+		_rtp_receiver->RequestKeyFrame();
+	}
+}
+
+std::vector<RtpReceiverStatistics> WebrtcIngestSession::GetStatistics()
+{
+	if(_rtp_receiver == nullptr)
+	{
+		return {};
+	}
+
+	return _rtp_receiver->GetStatistics();
+}
+
+size_t WebrtcIngestSession::GetMemoryUsage()
+{
+	return (_rtp_receiver != nullptr) ? _rtp_receiver->GetBufferedSize() : 0;
+}
+
+void WebrtcIngestSession::OnPacketReceived(std::shared_ptr<SessionInfo> session_info, std::shared_ptr<const ov::Data> data)
+{
+	if(GetState() != SessionState::Started)
+	{
+		return;
+	}
+
+	// ICE -> DTLS -> SRTP -> RTP|RTCP
+	_dtls_ice_transport->OnDataReceived(SessionNodeType::None, data);
+}
+
+void WebrtcIngestSession::Terminate(ov::String reason)
+{
+	logtd("WebrtcIngestSession(%d) is terminated: %s", GetId(), reason.CStr());
+
+	_ice_port->RemoveSession(GetId());
+}
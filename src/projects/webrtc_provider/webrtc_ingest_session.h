@@ -0,0 +1,88 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "base/publisher/session.h"
+#include "sdp/session_description.h"
+#include "ice/ice_port.h"
+#include "dtls_srtp/dtls_ice_transport.h"
+#include "dtls_srtp/dtls_transport.h"
+#include "dtls_srtp/srtp_transport.h"
+#include "rtp_rtcp/rtp_receiver.h"
+
+//====================================================================================================
+// WebrtcIngestSession
+// - A WHIP contributor, the media of the peer is received by the session nodes
+//
+//   [ RtpReceiver ] <- [    SRTP   ] <- [    DTLS   ] <- [  ICE/STUN ]
+//
+// - The session isn't a session of a publisher (no application/stream), so it is owned by WebrtcProvider
+//====================================================================================================
+class WebrtcIngestSession : public Session
+{
+public:
+	static std::shared_ptr<WebrtcIngestSession> Create(const std::shared_ptr<SessionDescription> &peer_sdp,
+	                                                   const std::shared_ptr<IcePort> &ice_port,
+	                                                   const std::shared_ptr<Certificate> &certificate);
+
+	WebrtcIngestSession(const SessionInfo &session_info,
+	                    const std::shared_ptr<SessionDescription> &peer_sdp,
+	                    const std::shared_ptr<IcePort> &ice_port,
+	                    const std::shared_ptr<Certificate> &certificate);
+	~WebrtcIngestSession() override;
+
+	// Payloads of the answer, must be called before Start()
+	bool AddPayload(uint8_t payload_type, common::MediaCodecId codec_id, uint32_t clock_rate, bool nack_enabled, int64_t max_delay);
+	void SetFrameHandler(RtpReceiver::FrameHandler handler);
+
+	bool Start() override;
+	bool Stop() override;
+
+	void RequestKeyFrame();
+
+	// Answer of OME
+	void SetLocalSdp(const std::shared_ptr<SessionDescription> &local_sdp)
+	{
+		_local_sdp = local_sdp;
+	}
+
+	const std::shared_ptr<SessionDescription> &GetLocalSdp() const
+	{
+		return _local_sdp;
+	}
+
+	const std::shared_ptr<SessionDescription> &GetPeerSdp() const
+	{
+		return _peer_sdp;
+	}
+
+	std::vector<RtpReceiverStatistics> GetStatistics();
+	size_t GetMemoryUsage() override;
+
+	// Nothing is sent to the contributor except the RTCP of RtpReceiver
+	bool SendOutgoingData(uint32_t packet_type, const std::shared_ptr<const ov::Data> &packet) override
+	{
+		return false;
+	}
+
+	void OnPacketReceived(std::shared_ptr<SessionInfo> session_info, std::shared_ptr<const ov::Data> data) override;
+
+	// There is no stream which owns the session, WebrtcProvider removes it by the state of the ICE port
+	void Terminate(ov::String reason) override;
+
+private:
+	std::shared_ptr<SessionDescription> _local_sdp;
+	std::shared_ptr<SessionDescription> _peer_sdp;
+	std::shared_ptr<IcePort> _ice_port;
+	std::shared_ptr<Certificate> _certificate;
+
+	std::shared_ptr<RtpReceiver> _rtp_receiver;
+	std::shared_ptr<SrtpTransport> _srtp_transport;
+	std::shared_ptr<DtlsTransport> _dtls_transport;
+	std::shared_ptr<DtlsIceTransport> _dtls_ice_transport;
+};
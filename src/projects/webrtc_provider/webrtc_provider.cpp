@@ -0,0 +1,741 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include <config/config.h>
+
+#include "webrtc_provider.h"
+#include "webrtc_application.h"
+#include "webrtc_stream.h"
+
+#include "rtc_signalling/rtc_signalling_server.h"
+
+#define OV_LOG_TAG "WebrtcProvider"
+
+//====================================================================================================
+// Create
+//====================================================================================================
+std::shared_ptr<WebrtcProvider> WebrtcProvider::Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+{
+	auto provider = std::make_shared<WebrtcProvider>(application_info, router);
+
+	if(provider->Start() == false)
+	{
+		return nullptr;
+	}
+
+	return provider;
+}
+
+//====================================================================================================
+// WebrtcProvider
+//====================================================================================================
+WebrtcProvider::WebrtcProvider(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router)
+	: Provider(application_info, router)
+{
+	logtd("Created WebRTC Provider modules.");
+}
+
+//====================================================================================================
+// ~WebrtcProvider
+//====================================================================================================
+WebrtcProvider::~WebrtcProvider()
+{
+	Stop();
+	logtd("Terminated WebRTC Provider modules.");
+}
+
+//====================================================================================================
+// Start
+//====================================================================================================
+bool WebrtcProvider::Start()
+{
+	_provider_info = _application_info->GetProvider<cfg::WebrtcProvider>();
+
+	if((_provider_info == nullptr) || (_provider_info->IsParsed() == false))
+	{
+		logte("Cannot initialize WebrtcProvider using config information");
+		return false;
+	}
+
+	auto host = _application_info->GetParentAs<cfg::Host>("Host");
+
+	if(host == nullptr)
+	{
+		OV_ASSERT2(false);
+		return false;
+	}
+
+	if(_provider_info->GetIceCandidates().IsParsed() == false)
+	{
+		// The default candidates are used by the WebRTC publisher
+		logte("IceCandidates of the WebRTC provider must be specified (application: %s)", _application_info->GetName().CStr());
+		return false;
+	}
+
+	_certificate = std::make_shared<Certificate>();
+
+	auto error = _certificate->Generate();
+
+	if(error != nullptr)
+	{
+		logte("Cannot create certificate: %s", error->ToString().CStr());
+		_certificate = nullptr;
+		return false;
+	}
+
+	_ice_port = IcePortManager::Instance()->CreatePort(_provider_info->GetIceCandidates(), IcePortObserver::GetSharedPtr());
+
+	if(_ice_port == nullptr)
+	{
+		logte("Cannot initialize ICE Port. Check your ICE configuration");
+		return false;
+	}
+
+	auto certificate = _application_info->GetCertificate();
+
+	if(certificate != nullptr)
+	{
+		auto https_server = std::make_shared<HttpsServer>();
+
+		https_server->SetLocalCertificate(certificate);
+		https_server->SetChainCertificate(_application_info->GetChainCertificate());
+
+		_http_server = https_server;
+	}
+	else
+	{
+		_http_server = std::make_shared<HttpServer>();
+	}
+
+	auto signalling_address = ov::SocketAddress(host->GetIp(), static_cast<uint16_t>(_provider_info->GetSignallingPort().GetPort()));
+
+	if((InitializeWhipServer() == false) || (_http_server->Start(signalling_address) == false))
+	{
+		logte("Could not start WHIP server on %s", signalling_address.ToString().CStr());
+
+		Stop();
+		return false;
+	}
+
+	logti("WebRTC Provider is listening on %s (application: %s, jitter buffer: %d ms)...",
+	      signalling_address.ToString().CStr(), _application_info->GetName().CStr(), _provider_info->GetJitterBufferDelay());
+
+	return Provider::Start();
+}
+
+//====================================================================================================
+// Stop
+//====================================================================================================
+bool WebrtcProvider::Stop()
+{
+	if(_http_server != nullptr)
+	{
+		_http_server->Stop();
+		_http_server = nullptr;
+	}
+
+	std::map<session_id_t, std::shared_ptr<WebrtcStream>> streams;
+
+	{
+		std::lock_guard<std::mutex> lock(_stream_mutex);
+
+		streams.swap(_streams);
+	}
+
+	for(auto &item : streams)
+	{
+		CloseStream(item.second);
+	}
+
+	if(_ice_port != nullptr)
+	{
+		IcePortManager::Instance()->ReleasePort(_ice_port, IcePortObserver::GetSharedPtr());
+		_ice_port->Close();
+		_ice_port = nullptr;
+	}
+
+	return Provider::Stop();
+}
+
+//====================================================================================================
+// GetConnectionMemoryData
+// - 미디어 정보를 기다리는 동안 보관하는 패킷 크기, jitter buffer의 패킷 크기
+//====================================================================================================
+bool WebrtcProvider::GetConnectionMemoryData(std::vector<std::shared_ptr<pvd::ConnectionMemoryData>> &memories)
+{
+	std::lock_guard<std::mutex> lock(_stream_mutex);
+
+	for(const auto &item : _streams)
+	{
+		auto &stream = item.second;
+		auto memory_data = std::make_shared<pvd::ConnectionMemoryData>();
+
+		memory_data->app_name = _application_info->GetName();
+		memory_data->stream_name = stream->GetName();
+		memory_data->remote = ov::String::FormatString("whip/%d", item.first);
+		memory_data->receive_buffer_size = stream->GetSession()->GetMemoryUsage();
+		memory_data->message_buffer_size = stream->GetBufferedSize();
+
+		memories.push_back(memory_data);
+	}
+
+	return true;
+}
+
+//====================================================================================================
+// GetTransportStatisticsData
+// - Statistics of the jitter buffers of each session (the payloads are summed)
+//====================================================================================================
+bool WebrtcProvider::GetTransportStatisticsData(std::vector<std::shared_ptr<pvd::TransportStatisticsData>> &statistics)
+{
+	std::lock_guard<std::mutex> lock(_stream_mutex);
+
+	for(const auto &item : _streams)
+	{
+		auto &stream = item.second;
+		auto statistics_data = std::make_shared<pvd::TransportStatisticsData>();
+
+		statistics_data->app_name = _application_info->GetName();
+		statistics_data->stream_name = stream->GetName();
+		statistics_data->remote = ov::String::FormatString("whip/%d", item.first);
+
+		for(const auto &payload_statistics : stream->GetSession()->GetStatistics())
+		{
+			auto &jitter_buffer = payload_statistics.jitter_buffer;
+
+			statistics_data->received_packets += jitter_buffer.received_packets;
+			statistics_data->lost_packets += jitter_buffer.lost_packets;
+			statistics_data->retransmission_requests += jitter_buffer.nack_requests;
+			statistics_data->dropped_packets += jitter_buffer.dropped_packets;
+		}
+
+		statistics.push_back(statistics_data);
+	}
+
+	return true;
+}
+
+std::shared_ptr<pvd::Application> WebrtcProvider::OnCreateApplication(const info::Application *application_info)
+{
+	return WebrtcApplication::Create(application_info);
+}
+
+bool WebrtcProvider::InitializeWhipServer()
+{
+	auto whip = std::make_shared<HttpDefaultInterceptor>();
+
+	whip->Register(HttpMethod::Post, R"(/[^/?#]+/[^/?#]+/whip([?#].*)?)", std::bind(&WebrtcProvider::OnWhipOffer, this, std::placeholders::_1, std::placeholders::_2));
+	whip->Register(HttpMethod::Delete, R"(/[^/?#]+/[^/?#]+/whip/-?[0-9]+([?#].*)?)", std::bind(&WebrtcProvider::OnWhipDelete, this, std::placeholders::_1, std::placeholders::_2));
+
+	// Preflight of the browsers (the contributors of the other origins send application/sdp)
+	whip->Register(HttpMethod::Options, R"(/[^/?#]+/[^/?#]+/whip(/-?[0-9]+)?([?#].*)?)", [](const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response) -> void
+	{
+		SetWhipCorsHeaders(response);
+		response->SetStatusCode(HttpStatusCode::NoContent);
+		response->Response();
+	});
+
+	return _http_server->AddInterceptor(whip);
+}
+
+void WebrtcProvider::SetWhipCorsHeaders(const std::shared_ptr<HttpResponse> &response)
+{
+	response->SetHeader("Access-Control-Allow-Origin", "*");
+	response->SetHeader("Access-Control-Allow-Methods", "POST, DELETE, OPTIONS");
+	response->SetHeader("Access-Control-Allow-Headers", "Content-Type");
+	response->SetHeader("Access-Control-Expose-Headers", "Location");
+}
+
+void WebrtcProvider::OnWhipOffer(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response)
+{
+	SetWhipCorsHeaders(response);
+
+	// "/<app>/<stream>/whip"
+	auto tokens = request->GetUri().Split("?")[0].Split("/");
+
+	if(tokens.size() < 4)
+	{
+		response->SetStatusCode(HttpStatusCode::BadRequest);
+		response->Response();
+		return;
+	}
+
+	ov::String app_name = tokens[1];
+	ov::String stream_name = tokens[2];
+	ov::String remote = request->GetRemote()->ToString();
+	ov::String content_type = request->GetHeader("CONTENT-TYPE");
+
+	if(app_name != _application_info->GetName())
+	{
+		logtw("Cannot find application - app(%s) stream(%s) remote(%s)", app_name.CStr(), stream_name.CStr(), remote.CStr());
+
+		response->SetStatusCode(HttpStatusCode::NotFound);
+		response->Response();
+		return;
+	}
+
+	if(ov::MemoryGovernor::Instance()->IsLevel(ov::MemoryGovernorLevel::RefuseNew))
+	{
+		logtw("The WHIP client is refused by the memory governor - app(%s) stream(%s) remote(%s)", app_name.CStr(), stream_name.CStr(), remote.CStr());
+
+		response->SetStatusCode(HttpStatusCode::ServiceUnavailable);
+		response->Response();
+		return;
+	}
+
+	if(ov::DrainMode::Instance()->IsDraining())
+	{
+		logtw("The WHIP client is refused while draining - app(%s) stream(%s) remote(%s)", app_name.CStr(), stream_name.CStr(), remote.CStr());
+
+		response->SetStatusCode(HttpStatusCode::ServiceUnavailable);
+		response->SetHeader("Retry-After", ov::Converter::ToString(ov::DrainMode::Instance()->GetConfig().retry_after));
+		response->Response();
+		return;
+	}
+
+	if((content_type.IsEmpty() == false) && (content_type.LowerCaseString().HasPrefix("application/sdp") == false))
+	{
+		response->SetStatusCode(HttpStatusCode::UnsupportedMediaType);
+		response->Response();
+		return;
+	}
+
+	auto body = request->GetRequestBody();
+	auto offer_sdp = std::make_shared<SessionDescription>();
+
+	if((body == nullptr) || (offer_sdp->FromString(ov::String(body->GetDataAs<char>(), body->GetLength())) == false))
+	{
+		logtw("Invalid offer from the WHIP client %s", remote.CStr());
+
+		response->SetStatusCode(HttpStatusCode::BadRequest);
+		response->Response();
+		return;
+	}
+
+	auto application = std::dynamic_pointer_cast<WebrtcApplication>(GetApplicationById(_application_info->GetId()));
+	auto stream = (application != nullptr) ? std::dynamic_pointer_cast<WebrtcStream>(application->MakeStream()) : nullptr;
+
+	if(stream == nullptr)
+	{
+		logte("can not create stream - app(%s) stream(%s)", app_name.CStr(), stream_name.CStr());
+
+		response->SetStatusCode(HttpStatusCode::InternalServerError);
+		response->Response();
+		return;
+	}
+
+	// The ICE port finds the session by the ufrag of OME
+	auto ice_ufrag = _ice_port->GenerateUfrag();
+	auto session = WebrtcIngestSession::Create(offer_sdp, _ice_port, _certificate);
+	auto answer_sdp = CreateAnswerSdp(offer_sdp, ice_ufrag, session, stream);
+	ov::String answer_sdp_text;
+
+	if((answer_sdp == nullptr) || (answer_sdp->ToString(answer_sdp_text) == false))
+	{
+		logtw("Could not answer the offer of the WHIP client %s for stream (%s/%s)", remote.CStr(), app_name.CStr(), stream_name.CStr());
+
+		response->SetStatusCode(HttpStatusCode::NotAcceptable);
+		response->Response();
+		return;
+	}
+
+	session_id_t session_id = session->GetId();
+
+	stream->SetName(stream_name.CStr());
+	stream->SetSession(session);
+
+	session->SetLocalSdp(answer_sdp);
+	session->SetFrameHandler([this, session_id](uint8_t payload_type, RtpFrame &frame) {
+		OnFrame(session_id, payload_type, frame);
+	});
+
+	if(session->Start() == false)
+	{
+		logte("Cannot start the session of the WHIP client %s", remote.CStr());
+
+		response->SetStatusCode(HttpStatusCode::InternalServerError);
+		response->Response();
+		return;
+	}
+
+	std::shared_ptr<WebrtcStream> replaced_stream = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(_stream_mutex);
+
+		for(auto item = _streams.begin(); item != _streams.end(); ++item)
+		{
+			if(item->second->GetName() != stream_name)
+			{
+				continue;
+			}
+
+			if(_provider_info->IsBlockDuplicateStreamName())
+			{
+				logti("Duplicate Stream Input(reject) - app(%s) stream(%s) remote(%s)", app_name.CStr(), stream_name.CStr(), remote.CStr());
+
+				response->SetStatusCode(HttpStatusCode::Conflict);
+				response->Response();
+				return;
+			}
+
+			logti("Duplicate Stream Input(change) - app(%s) stream(%s) remote(%s)", app_name.CStr(), stream_name.CStr(), remote.CStr());
+
+			replaced_stream = item->second;
+			_streams.erase(item);
+			break;
+		}
+
+		if(_streams.find(session_id) != _streams.end())
+		{
+			logtw("The session id %d of the WHIP client %s is already used", session_id, remote.CStr());
+
+			response->SetStatusCode(HttpStatusCode::Conflict);
+			response->Response();
+			return;
+		}
+
+		_streams[session_id] = stream;
+	}
+
+	if(replaced_stream != nullptr)
+	{
+		CloseStream(replaced_stream);
+	}
+
+	std::vector<RtcIceCandidate> local_candidates;
+
+	// The ports are assigned before AddSession(), which takes them over
+	_ice_port->SelectIceCandidates(ice_ufrag, &local_candidates);
+
+	// OME answered, so the contributor is the controlling agent
+	_ice_port->AddSession(session, answer_sdp, offer_sdp, false);
+
+	logti("WebRTC input stream is answered - stream(%s/%s) session(%d) remote(%s)", app_name.CStr(), stream_name.CStr(), session_id, remote.CStr());
+
+	response->SetStatusCode(HttpStatusCode::Created);
+	response->SetHeader("Content-Type", "application/sdp");
+	response->SetHeader("Location", ov::String::FormatString("/%s/%s/whip/%d", app_name.CStr(), stream_name.CStr(), session_id));
+	response->AppendString(RtcSignallingServer::AddCandidatesToSdp(answer_sdp_text, local_candidates));
+	response->Response();
+}
+
+void WebrtcProvider::OnWhipDelete(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response)
+{
+	SetWhipCorsHeaders(response);
+
+	// "/<app>/<stream>/whip/<id>"
+	auto tokens = request->GetUri().Split("?")[0].Split("/");
+	std::shared_ptr<WebrtcStream> stream = nullptr;
+
+	if((tokens.size() >= 5) && (tokens[1] == _application_info->GetName()))
+	{
+		session_id_t session_id = ov::Converter::ToInt32(tokens[4]);
+
+		std::lock_guard<std::mutex> lock(_stream_mutex);
+
+		auto item = _streams.find(session_id);
+
+		if((item != _streams.end()) && (item->second->GetName() == tokens[2]))
+		{
+			stream = item->second;
+			_streams.erase(item);
+		}
+	}
+
+	if(stream == nullptr)
+	{
+		response->SetStatusCode(HttpStatusCode::NotFound);
+		response->Response();
+		return;
+	}
+
+	logti("WebRTC input stream is deleted by %s - stream(%s/%s) session(%d)",
+	      request->GetRemote()->ToString().CStr(), _application_info->GetName().CStr(), stream->GetName().CStr(), stream->GetSession()->GetId());
+
+	CloseStream(stream);
+
+	response->SetStatusCode(HttpStatusCode::OK);
+	response->Response();
+}
+
+std::shared_ptr<SessionDescription> WebrtcProvider::CreateAnswerSdp(const std::shared_ptr<SessionDescription> &offer_sdp, const ov::String &ice_ufrag,
+                                                                    const std::shared_ptr<WebrtcIngestSession> &session, const std::shared_ptr<WebrtcStream> &stream)
+{
+	auto answer_sdp = std::make_shared<SessionDescription>();
+	int64_t max_delay = _provider_info->GetJitterBufferDelay();
+	bool has_video = false;
+	bool has_audio = false;
+
+	answer_sdp->SetOrigin("OvenMediaEngine", ov::Random::GenerateUInt32(), 2, "IN", 4, "127.0.0.1");
+	answer_sdp->SetTiming(0, 0);
+	answer_sdp->SetIceUfrag(ice_ufrag);
+	answer_sdp->SetIcePwd(ov::Random::GenerateString(32));
+	answer_sdp->SetMsidSemantic("WMS", "*");
+	answer_sdp->SetFingerprint("sha-256", _certificate->GetFingerprint("sha-256"));
+
+	for(const auto &offer_media_desc : offer_sdp->GetMediaList())
+	{
+		auto media_type = offer_media_desc->GetMediaType();
+		bool is_video = (media_type == MediaDescription::MediaType::Video);
+		std::shared_ptr<PayloadAttr> offer_payload = nullptr;
+
+		// Only a video and an audio are received (the first m= line of each)
+		if(((media_type == MediaDescription::MediaType::Video) && (has_video == false)) ||
+		   ((media_type == MediaDescription::MediaType::Audio) && (has_audio == false)))
+		{
+			if((offer_media_desc->GetDirection() == MediaDescription::Direction::SendOnly) || (offer_media_desc->GetDirection() == MediaDescription::Direction::SendRecv))
+			{
+				for(const auto &payload : offer_media_desc->GetPayloadList())
+				{
+					ov::String codec = payload->GetCodecStr().UpperCaseString();
+
+					if(is_video)
+					{
+						// H.264 is preferred, it can be bypassed to the WebRTC publisher without the transcoding
+						if((codec == "H264") && (payload->GetCodecRate() == 90000) && (payload->GetFmtp().IndexOf("packetization-mode=1") >= 0))
+						{
+							offer_payload = payload;
+							break;
+						}
+
+						if((codec == "VP8") && (payload->GetCodecRate() == 90000) && (offer_payload == nullptr))
+						{
+							offer_payload = payload;
+						}
+					}
+					else if((codec == "OPUS") && (payload->GetCodecRate() == 48000))
+					{
+						offer_payload = payload;
+						break;
+					}
+				}
+			}
+		}
+
+		auto answer_media_desc = std::make_shared<MediaDescription>(answer_sdp);
+
+		answer_media_desc->SetMediaType(media_type);
+		answer_media_desc->SetConnection(4, "0.0.0.0");
+		answer_media_desc->SetMid(offer_media_desc->GetMid());
+		answer_media_desc->SetSetup(MediaDescription::SetupType::Passive);
+		answer_media_desc->UseDtls(true);
+		answer_media_desc->UseRtcpMux(true);
+
+		if(offer_payload == nullptr)
+		{
+			logtw("The m= line (mid: %s) of the offer cannot be received", offer_media_desc->GetMid().CStr());
+
+			// Rejected (RFC 3264 - 6)
+			answer_media_desc->SetPort(0);
+			answer_media_desc->SetDirection(MediaDescription::Direction::Inactive);
+			answer_media_desc->AddPayload(offer_media_desc->GetFirstPayload());
+			answer_sdp->AddMedia(answer_media_desc);
+
+			continue;
+		}
+
+		ov::String codec = offer_payload->GetCodecStr().UpperCaseString();
+		bool use_nack = is_video && offer_payload->IsRtcpFbEnabled(PayloadAttr::RtcpFbType::Nack);
+		auto payload = std::make_shared<PayloadAttr>();
+
+		payload->SetRtpmap(offer_payload->GetId(), offer_payload->GetCodecStr(), offer_payload->GetCodecRate(), offer_payload->GetCodecParams());
+		payload->SetFmtp(offer_payload->GetFmtp());
+		payload->EnableRtcpFb(PayloadAttr::RtcpFbType::Nack, use_nack);
+		payload->EnableRtcpFb(PayloadAttr::RtcpFbType::NackPli, is_video && offer_payload->IsRtcpFbEnabled(PayloadAttr::RtcpFbType::NackPli));
+
+		answer_media_desc->SetDirection(MediaDescription::Direction::RecvOnly);
+		answer_media_desc->AddPayload(payload);
+		answer_sdp->AddMedia(answer_media_desc);
+
+		if(is_video)
+		{
+			auto codec_id = (codec == "H264") ? common::MediaCodecId::H264 : common::MediaCodecId::Vp8;
+
+			session->AddPayload(offer_payload->GetId(), codec_id, offer_payload->GetCodecRate(), use_nack, max_delay);
+			stream->SetVideoPayload(offer_payload->GetId(), codec_id);
+
+			has_video = true;
+		}
+		else
+		{
+			// a=rtpmap:<pt> opus/48000/2 (the channels of the decoded audio)
+			int32_t channels = offer_payload->GetCodecParams().IsEmpty() ? 2 : ov::Converter::ToInt32(offer_payload->GetCodecParams());
+
+			session->AddPayload(offer_payload->GetId(), common::MediaCodecId::Opus, offer_payload->GetCodecRate(), false, max_delay);
+			stream->SetAudioPayload(offer_payload->GetId(), static_cast<int32_t>(offer_payload->GetCodecRate()), channels);
+
+			has_audio = true;
+		}
+	}
+
+	if((has_video == false) && (has_audio == false))
+	{
+		return nullptr;
+	}
+
+	return answer_sdp->Update() ? answer_sdp : nullptr;
+}
+
+//====================================================================================================
+// OnFrame
+// - The frames of a session are called by the thread of the ICE port which receives the session
+//====================================================================================================
+void WebrtcProvider::OnFrame(session_id_t session_id, uint8_t payload_type, RtpFrame &frame)
+{
+	ov::MemoryTagScope memory_tag(ov::MemoryTag::Ingest);
+	OV_TRACE_SCOPE("provider", "WebrtcReceive");
+	std::lock_guard<std::mutex> lock(_stream_mutex);
+
+	auto item = _streams.find(session_id);
+
+	if(item == _streams.end())
+	{
+		return;
+	}
+
+	auto stream = item->second;
+	auto application = std::dynamic_pointer_cast<WebrtcApplication>(GetApplicationById(_application_info->GetId()));
+
+	stream->OnFrame(payload_type, frame);
+
+	if(application == nullptr)
+	{
+		return;
+	}
+
+	if(stream->IsCreated() == false)
+	{
+		if(stream->IsMediaInfoReady() == false)
+		{
+			return;
+		}
+
+		if(stream->AddTracks() == false)
+		{
+			logte("Could not create the stream - app(%s) stream(%s)", _application_info->GetName().CStr(), stream->GetName().CStr());
+			return;
+		}
+
+		// 라우터에 스트림이 생성되었다고 알림
+		if(application->CreateStream2(stream) == false)
+		{
+			return;
+		}
+
+		stream->SetCreated(true);
+
+		logti("WebRTC input stream create completed - stream(%s/%s) id(%u/%u) session(%d)",
+		      _application_info->GetName().CStr(), stream->GetName().CStr(),
+		      _application_info->GetId(), stream->GetId(), session_id);
+	}
+
+	auto &packets = stream->GetPackets();
+
+	for(auto &packet : packets)
+	{
+		application->SendFrame(stream, std::move(packet));
+	}
+
+	stream->ClearPackets();
+}
+
+void WebrtcProvider::CloseStream(const std::shared_ptr<WebrtcStream> &stream)
+{
+	auto session = stream->GetSession();
+
+	if(session != nullptr)
+	{
+		session->Stop();
+
+		if(_ice_port != nullptr)
+		{
+			_ice_port->RemoveSession(session->GetId());
+		}
+	}
+
+	if(stream->IsCreated())
+	{
+		auto application = std::dynamic_pointer_cast<WebrtcApplication>(GetApplicationById(_application_info->GetId()));
+
+		if(application != nullptr)
+		{
+			// 라우터에 스트림이 삭제되었다고 알림
+			application->DeleteStream2(stream);
+		}
+
+		stream->SetCreated(false);
+	}
+}
+
+//====================================================================================================
+// OnStateChanged
+// - IcePortObserver 구현
+//====================================================================================================
+void WebrtcProvider::OnStateChanged(IcePort &port, const std::shared_ptr<SessionInfo> &session_info, IcePortConnectionState state)
+{
+	logtd("IcePort OnStateChanged : %d", state);
+
+	switch(state)
+	{
+		case IcePortConnectionState::Failed:
+		case IcePortConnectionState::Disconnected:
+		case IcePortConnectionState::Closed:
+			break;
+
+		default:
+			// 연결되었을때는 할일이 없다.
+			return;
+	}
+
+	std::shared_ptr<WebrtcStream> stream = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(_stream_mutex);
+
+		auto item = _streams.find(session_info->GetId());
+
+		if(item == _streams.end())
+		{
+			return;
+		}
+
+		stream = item->second;
+		_streams.erase(item);
+	}
+
+	logti("WebRTC input stream disconnected - stream(%s/%s) session(%d) state(%d)",
+	      _application_info->GetName().CStr(), stream->GetName().CStr(), session_info->GetId(), static_cast<int>(state));
+
+	CloseStream(stream);
+}
+
+//====================================================================================================
+// OnDataReceived
+// - IcePortObserver 구현
+// - STUN을 제외한 모든 Packet이 들어온다 (DTLS, SRTP, SRTCP)
+//====================================================================================================
+void WebrtcProvider::OnDataReceived(IcePort &port, const std::shared_ptr<SessionInfo> &session_info, std::shared_ptr<const ov::Data> data)
+{
+	std::shared_ptr<WebrtcIngestSession> session = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(_stream_mutex);
+
+		auto item = _streams.find(session_info->GetId());
+
+		if(item == _streams.end())
+		{
+			return;
+		}
+
+		session = item->second->GetSession();
+	}
+
+	// The frames are sent by OnFrame(), which locks _stream_mutex
+	session->OnPacketReceived(session, std::move(data));
+}
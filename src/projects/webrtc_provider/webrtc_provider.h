@@ -0,0 +1,84 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include <base/ovlibrary/ovlibrary.h>
+
+#include "base/provider/provider.h"
+#include "base/provider/application.h"
+#include "ice/ice.h"
+#include "http_server/http_server.h"
+#include "http_server/https_server.h"
+#include "http_server/interceptors/http_request_interceptors.h"
+
+#include "webrtc_stream.h"
+
+//====================================================================================================
+// WebrtcProvider
+// - Receives H.264/VP8 and Opus from the browsers by WHIP (WebRTC-HTTP Ingestion Protocol)
+//   - POST /<app>/<stream>/whip: the body is the offer of the contributor, and the answer is responded
+//     with the candidates of OME (201 Created, Location: /<app>/<stream>/whip/<id>)
+//   - DELETE /<app>/<stream>/whip/<id>: stops the session
+// - The ICE port is not shared with the WebRTC publisher (IceCandidates of the provider must be specified)
+// - The packets are processed by the threads of the ICE port, the frames are sent to the router by them
+//====================================================================================================
+class WebrtcProvider : public pvd::Provider, public IcePortObserver
+{
+public:
+	static std::shared_ptr<WebrtcProvider> Create(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+
+	explicit WebrtcProvider(const info::Application *application_info, std::shared_ptr<MediaRouteInterface> router);
+	~WebrtcProvider() override;
+
+	cfg::ProviderType GetProviderType() override
+	{
+		return cfg::ProviderType::Webrtc;
+	}
+
+	bool Start() override;
+	bool Stop() override;
+
+	bool GetConnectionMemoryData(std::vector<std::shared_ptr<pvd::ConnectionMemoryData>> &memories) override;
+	bool GetTransportStatisticsData(std::vector<std::shared_ptr<pvd::TransportStatisticsData>> &statistics) override;
+
+	std::shared_ptr<pvd::Application> OnCreateApplication(const info::Application *application_info) override;
+
+	//--------------------------------------------------------------------
+	// Implementation of IcePortObserver
+	//--------------------------------------------------------------------
+	void OnStateChanged(IcePort &port, const std::shared_ptr<SessionInfo> &session_info, IcePortConnectionState state) override;
+	void OnDataReceived(IcePort &port, const std::shared_ptr<SessionInfo> &session_info, std::shared_ptr<const ov::Data> data) override;
+
+private:
+	bool InitializeWhipServer();
+	void OnWhipOffer(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response);
+	void OnWhipDelete(const std::shared_ptr<HttpRequest> &request, const std::shared_ptr<HttpResponse> &response);
+	static void SetWhipCorsHeaders(const std::shared_ptr<HttpResponse> &response);
+
+	// Answers the media which OME can receive (the first H.264 (packetization-mode=1) or VP8 of the video, Opus of the audio)
+	// - The payloads are added to the session and the stream
+	std::shared_ptr<SessionDescription> CreateAnswerSdp(const std::shared_ptr<SessionDescription> &offer_sdp, const ov::String &ice_ufrag,
+	                                                    const std::shared_ptr<WebrtcIngestSession> &session, const std::shared_ptr<WebrtcStream> &stream);
+
+	// Frames of RtpReceiver, the stream is created to the router when the media information is known
+	void OnFrame(session_id_t session_id, uint8_t payload_type, RtpFrame &frame);
+
+	// Removes the stream from the router and stops the session (_stream_mutex must not be locked, the ICE port notifies the state)
+	void CloseStream(const std::shared_ptr<WebrtcStream> &stream);
+
+	const cfg::WebrtcProvider *_provider_info = nullptr;
+
+	std::shared_ptr<IcePort> _ice_port;
+	std::shared_ptr<HttpServer> _http_server;
+	// Self-signed certificate of DTLS
+	std::shared_ptr<Certificate> _certificate;
+
+	std::mutex _stream_mutex;
+	// key: session id
+	std::map<session_id_t, std::shared_ptr<WebrtcStream>> _streams;
+};
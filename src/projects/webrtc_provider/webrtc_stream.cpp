@@ -0,0 +1,276 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#include "webrtc_stream.h"
+
+#include "srt/h264_sps_parser.h"
+#include "rtp_rtcp/rtp_depacketizer_vp8.h"
+
+#define OV_LOG_TAG "WebrtcStream"
+
+using namespace common;
+
+// Clock rate of the RTP timestamp of the video (RFC 6184, RFC 7741)
+#define WEBRTC_STREAM_VIDEO_CLOCK_RATE      (90000)
+
+std::shared_ptr<WebrtcStream> WebrtcStream::Create()
+{
+	auto stream = std::make_shared<WebrtcStream>();
+	return stream;
+}
+
+WebrtcStream::WebrtcStream()
+{
+}
+
+WebrtcStream::~WebrtcStream()
+{
+}
+
+void WebrtcStream::SetVideoPayload(uint8_t payload_type, common::MediaCodecId codec_id)
+{
+	_video_payload_type = payload_type;
+	_video_codec_id = codec_id;
+}
+
+void WebrtcStream::SetAudioPayload(uint8_t payload_type, int32_t samplerate, int32_t channels)
+{
+	_audio_payload_type = payload_type;
+	_audio_samplerate = samplerate;
+	_audio_channels = channels;
+}
+
+bool WebrtcStream::RequestKeyFrame()
+{
+	if((_session == nullptr) || (_video_payload_type == 0))
+	{
+		return false;
+	}
+
+	_session->RequestKeyFrame();
+
+	return true;
+}
+
+bool WebrtcStream::IsMediaInfoReady() const
+{
+	return (_video_payload_type == 0) || _has_video_info;
+}
+
+//====================================================================================================
+// AddTracks
+// - Track ids are same as RTMP (video: 0, audio: 1)
+//====================================================================================================
+bool WebrtcStream::AddTracks()
+{
+	if(IsMediaInfoReady() == false)
+	{
+		return false;
+	}
+
+	if(_video_payload_type != 0)
+	{
+		auto new_track = std::make_shared<MediaTrack>();
+
+		new_track->SetId(0);
+		new_track->SetMediaType(MediaType::Video);
+		new_track->SetCodecId(_video_codec_id);
+		new_track->SetWidth(_video_width);
+		new_track->SetHeight(_video_height);
+		new_track->SetFrameRate(WEBRTC_STREAM_DEFAULT_FRAMERATE);
+		new_track->SetTimeBase(1, 1000);
+
+		AddTrack(new_track);
+	}
+
+	if(_audio_payload_type != 0)
+	{
+		auto new_track = std::make_shared<MediaTrack>();
+
+		new_track->SetId(1);
+		new_track->SetMediaType(MediaType::Audio);
+		new_track->SetCodecId(MediaCodecId::Opus);
+		new_track->SetSampleRate(_audio_samplerate);
+		new_track->SetTimeBase(1, 1000);
+		new_track->GetSample().SetFormat(common::AudioSample::Format::S16);
+
+		if(_audio_channels == 1)
+		{
+			new_track->GetChannel().SetLayout(common::AudioChannel::Layout::LayoutMono);
+		}
+		else
+		{
+			new_track->GetChannel().SetLayout(common::AudioChannel::Layout::LayoutStereo);
+		}
+
+		AddTrack(new_track);
+	}
+
+	return true;
+}
+
+void WebrtcStream::OnFrame(uint8_t payload_type, RtpFrame &frame)
+{
+	if(frame.data == nullptr)
+	{
+		return;
+	}
+
+	if(_base_arrival_time < 0)
+	{
+		_base_arrival_time = frame.arrival_time;
+	}
+
+	if((_video_payload_type != 0) && (payload_type == _video_payload_type))
+	{
+		ProcessVideo(frame);
+	}
+	else if((_audio_payload_type != 0) && (payload_type == _audio_payload_type))
+	{
+		ProcessAudio(frame);
+	}
+}
+
+//====================================================================================================
+// ProcessVideo
+// - H.264 is an access unit of Annex-B (MediaRouteStream converts it as SRT), VP8 is a frame
+// - WebRTC doesn't use B-frames, so the cts is 0
+//====================================================================================================
+void WebrtcStream::ProcessVideo(RtpFrame &frame)
+{
+	if((_has_video_info == false) && frame.is_key_frame)
+	{
+		ParseVideoInfo(frame);
+	}
+
+	if(_has_video_info == false)
+	{
+		// The frames before the first key frame cannot be decoded
+		return;
+	}
+
+	int64_t pts = GetMilliseconds(_video_timestamp, frame, WEBRTC_STREAM_VIDEO_CLOCK_RATE);
+
+	if(pts < 0)
+	{
+		return;
+	}
+
+	AppendPacket(std::make_unique<MediaPacket>(MediaType::Video,
+	                                           0,
+	                                           std::move(frame.data),
+	                                           pts,
+	                                           frame.is_key_frame ? MediaPacketFlag::Key : MediaPacketFlag::NoFlag));
+}
+
+void WebrtcStream::ProcessAudio(RtpFrame &frame)
+{
+	if(IsMediaInfoReady() == false)
+	{
+		// Dropped with the video before the first key frame, so the stream starts with both tracks
+		return;
+	}
+
+	int64_t pts = GetMilliseconds(_audio_timestamp, frame, static_cast<uint32_t>(_audio_samplerate));
+
+	if(pts < 0)
+	{
+		return;
+	}
+
+	AppendPacket(std::make_unique<MediaPacket>(MediaType::Audio,
+	                                           1,
+	                                           std::move(frame.data),
+	                                           pts,
+	                                           MediaPacketFlag::Key));
+}
+
+void WebrtcStream::ParseVideoInfo(const RtpFrame &frame)
+{
+	auto data = frame.data->GetDataAs<uint8_t>();
+	size_t length = frame.data->GetLength();
+
+	if(_video_codec_id == MediaCodecId::Vp8)
+	{
+		if(RtpDepacketizerVp8::GetKeyFrameSize(data, length, _video_width, _video_height))
+		{
+			logtd("VP8 key frame is parsed (%dx%d)", _video_width, _video_height);
+			_has_video_info = true;
+		}
+
+		return;
+	}
+
+	const uint8_t *end = data + length;
+
+	for(auto start_code = ov::FindNalStartCode(data, end); start_code < end;)
+	{
+		auto nal = start_code + 3;
+		auto next_start_code = ov::FindNalStartCode(nal, end);
+
+		// SPS
+		if((nal < end) && ((nal[0] & 0x1F) == 7))
+		{
+			H264SpsInfo sps_info;
+
+			if(H264SpsParser::Parse(nal, static_cast<size_t>(next_start_code - nal), sps_info))
+			{
+				logtd("SPS is parsed (%ux%u)", sps_info.width, sps_info.height);
+
+				_video_width = static_cast<int32_t>(sps_info.width);
+				_video_height = static_cast<int32_t>(sps_info.height);
+				_has_video_info = true;
+			}
+
+			return;
+		}
+
+		start_code = next_start_code;
+	}
+
+	logtw("The key frame of the stream %s has no SPS", GetName().CStr());
+}
+
+void WebrtcStream::AppendPacket(std::unique_ptr<MediaPacket> packet)
+{
+	if((_is_created == false) && (_packets.size() >= WEBRTC_STREAM_MAX_PENDING_PACKETS))
+	{
+		_buffered_size -= _packets.front()->GetData()->GetLength();
+		_packets.erase(_packets.begin());
+	}
+
+	// The packets which wait for the stream to be created are also counted to the Ingest latency
+	packet->SetIngestTime(ov::LatencyHistogram::GetCurrentMicroseconds());
+
+	_buffered_size += packet->GetData()->GetLength();
+	_packets.push_back(std::move(packet));
+}
+
+int64_t WebrtcStream::GetMilliseconds(TrackTimestamp &track, const RtpFrame &frame, uint32_t clock_rate)
+{
+	if(clock_rate == 0)
+	{
+		return -1;
+	}
+
+	int64_t timestamp = frame.timestamp;
+
+	if(track.last_timestamp < 0)
+	{
+		track.base_timestamp = timestamp;
+		track.offset = frame.arrival_time - _base_arrival_time;
+	}
+	else
+	{
+		// The RTP timestamp is wrapped in 32 bits
+		timestamp = track.last_timestamp + static_cast<int32_t>(frame.timestamp - static_cast<uint32_t>(track.last_timestamp & 0xFFFFFFFF));
+	}
+
+	track.last_timestamp = timestamp;
+
+	return track.offset + (timestamp - track.base_timestamp) * 1000 / clock_rate;
+}
@@ -0,0 +1,128 @@
+//==============================================================================
+//
+//  OvenMediaEngine
+//
+//  Copyright (c) 2019 AirenSoft. All rights reserved.
+//
+//==============================================================================
+#pragma once
+
+#include "base/common_types.h"
+#include "base/provider/stream.h"
+#include "base/media_route/media_buffer.h"
+
+#include "webrtc_ingest_session.h"
+
+// Frames which are kept until the media information is known (the older frames are dropped)
+#define WEBRTC_STREAM_MAX_PENDING_PACKETS       (300)
+// Framerate of the video if it is unknown (the contributors change the framerate by the bandwidth)
+#define WEBRTC_STREAM_DEFAULT_FRAMERATE         (30.0)
+
+//====================================================================================================
+// WebrtcStream
+// - A stream of a WHIP session, the frames of RtpReceiver are converted to the MediaPackets
+// - The stream is created to the router after the size of the video is known (the first key frame)
+// - Timestamps are converted to 1/1000 (same as RTMP), the tracks are aligned by the arrival time
+//   of their first frames (the RTP timestamps of the tracks have the random offsets)
+//====================================================================================================
+class WebrtcStream : public pvd::Stream
+{
+public:
+	static std::shared_ptr<WebrtcStream> Create();
+
+public:
+	explicit WebrtcStream();
+	~WebrtcStream() final;
+
+	// Payloads of the answer (payload_type 0: not received)
+	void SetVideoPayload(uint8_t payload_type, common::MediaCodecId codec_id);
+	void SetAudioPayload(uint8_t payload_type, int32_t samplerate, int32_t channels);
+
+	void SetSession(const std::shared_ptr<WebrtcIngestSession> &session)
+	{
+		_session = session;
+	}
+
+	const std::shared_ptr<WebrtcIngestSession> &GetSession() const
+	{
+		return _session;
+	}
+
+	// The packets of the frame are appended to the packet list
+	void OnFrame(uint8_t payload_type, RtpFrame &frame);
+
+	// Asks the contributor for a key frame (PLI)
+	bool RequestKeyFrame();
+
+	// true if the tracks can be made (the first key frame of the video is received)
+	bool IsMediaInfoReady() const;
+	bool AddTracks();
+
+	bool IsCreated() const
+	{
+		return _is_created;
+	}
+
+	void SetCreated(bool created)
+	{
+		_is_created = created;
+	}
+
+	std::vector<std::unique_ptr<MediaPacket>> &GetPackets()
+	{
+		return _packets;
+	}
+
+	void ClearPackets()
+	{
+		_packets.clear();
+		_buffered_size = 0;
+	}
+
+	// Bytes of the packets which are waiting for the media information
+	size_t GetBufferedSize() const
+	{
+		return _buffered_size;
+	}
+
+private:
+	struct TrackTimestamp
+	{
+		// First RTP timestamp and the last one (unwrapped)
+		int64_t base_timestamp = -1;
+		int64_t last_timestamp = -1;
+		// ms from the first frame of the stream to the first frame of the track
+		int64_t offset = 0;
+	};
+
+	void ProcessVideo(RtpFrame &frame);
+	void ProcessAudio(RtpFrame &frame);
+	void ParseVideoInfo(const RtpFrame &frame);
+
+	void AppendPacket(std::unique_ptr<MediaPacket> packet);
+
+	// Converts the RTP timestamp to the milliseconds from the first frame of the stream
+	int64_t GetMilliseconds(TrackTimestamp &track, const RtpFrame &frame, uint32_t clock_rate);
+
+	std::shared_ptr<WebrtcIngestSession> _session;
+
+	bool _is_created = false;
+
+	uint8_t _video_payload_type = 0;
+	common::MediaCodecId _video_codec_id = common::MediaCodecId::None;
+	bool _has_video_info = false;
+	int32_t _video_width = 0;
+	int32_t _video_height = 0;
+
+	uint8_t _audio_payload_type = 0;
+	int32_t _audio_samplerate = 0;
+	int32_t _audio_channels = 0;
+
+	// ms (monotonic) when the first frame of the stream is received
+	int64_t _base_arrival_time = -1;
+	TrackTimestamp _video_timestamp;
+	TrackTimestamp _audio_timestamp;
+
+	std::vector<std::unique_ptr<MediaPacket>> _packets;
+	size_t _buffered_size = 0;
+};